@@ -37,3 +37,11 @@ void run_tests() {
 
     write("All sscanf 'from' tests passed!");
 }
+
+// Timed by driver --test: one parse of a numbered "get X from Y"
+int bench_sscanf_from() {
+    string item;
+    string container;
+
+    return sscanf("sword 3 from bag 2", "%s from %s", item, container);
+}
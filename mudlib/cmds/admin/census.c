@@ -0,0 +1,60 @@
+// census.c - Count loaded objects and estimate their memory
+// Usage: census [start]
+// "census start" begins a census, which the driver carries out a slice
+// per tick. "census" prints the last finished one: clones and estimated
+// bytes per blueprint, with the change since the census before, and the
+// largest single objects.
+
+string kb(int bytes) {
+    return sprintf("%d.%d", bytes / 1024, (bytes % 1024) * 10 / 1024);
+}
+
+string change(int n) {
+    return n > 0 ? "+" + n : "" + n;
+}
+
+void main(string args) {
+    mapping census;
+    mixed *blueprints;
+    mixed *largest;
+    int i;
+
+    if (args == "start") {
+        if (object_census(1)) {
+            write("Census started.\n");
+        } else {
+            write("A census is already running.\n");
+        }
+        return;
+    }
+
+    census = object_census();
+    if (!census) {
+        write("No census has finished yet. Use 'census start'.\n");
+        return;
+    }
+
+    write(sprintf("Census of %s: %d objects, %sKB (took %dms, %dms busy)\n",
+        ctime(census["finished"]), census["objects"], kb(census["bytes"]),
+        census["took_ms"], census["busy_ms"]));
+    if (census["running"]) {
+        write(sprintf("A new census is running: %d of %d objects.\n", census["done"], census["total"]));
+    }
+
+    blueprints = census["blueprints"];
+    write(sprintf("  %-40s %7s %7s %10s %9s\n", "blueprint", "clones", "change", "KB", "change"));
+    for (i = 0; i < sizeof(blueprints) && i < 20; i++) {
+        write(sprintf("  %-40s %7d %7s %10s %9s\n", blueprints[i]["name"], blueprints[i]["clones"],
+            change(blueprints[i]["clone_delta"]), kb(blueprints[i]["bytes"]),
+            change(blueprints[i]["byte_delta"] / 1024)));
+    }
+    if (sizeof(blueprints) > 20) {
+        write(sprintf("  ... and %d more blueprints\n", sizeof(blueprints) - 20));
+    }
+
+    largest = census["largest"];
+    write("Largest objects:\n");
+    for (i = 0; i < sizeof(largest); i++) {
+        write(sprintf("  %10sKB %s\n", kb(largest[i]["bytes"]), largest[i]["object"]));
+    }
+}
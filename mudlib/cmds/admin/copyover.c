@@ -0,0 +1,9 @@
+// /cmds/admin/copyover.c
+// Copyover command - restart the driver without disconnecting anyone (Admin only)
+
+void main(string args) {
+    write("Starting copyover...");
+
+    // The driver saves everyone and hands the connections to the new process
+    copyover();
+}
@@ -0,0 +1,47 @@
+// cpu.c - Show which objects, blueprints and domains use the most LPC time
+// Usage: cpu [count]
+// Lists the busiest objects, blueprints and domains (a wizard's directory
+// or a world area) by instructions in the last minute, with their totals
+// since boot. Objects whose heart_beat() is being slowed for going over
+// the CPU budget show how many turns they skipped.
+
+void show(string title, mixed *accounts, int objects) {
+    int i;
+
+    write(sprintf("%s:\n", title));
+    write(sprintf("  %-44s %11s %9s %13s %9s%s\n", "name", "recent", "ms", "total", "ms",
+        objects ? "  skipped" : ""));
+    for (i = 0; i < sizeof(accounts); i++) {
+        write(sprintf("  %-44s %11d %9d %13d %9d%s\n", accounts[i]["name"],
+            accounts[i]["recent_instructions"], accounts[i]["recent_us"] / 1000,
+            accounts[i]["instructions"], accounts[i]["us"] / 1000,
+            objects ? sprintf(" %8d", accounts[i]["throttled"]) : ""));
+    }
+}
+
+void main(string args) {
+    mapping stats;
+    int count;
+
+    count = 10;
+    if (args && args != "" && (sscanf(args, "%d", count) != 1 || count < 1)) {
+        write("Usage: cpu [count]\n");
+        return;
+    }
+
+    stats = cpu_stats(count);
+    if (!stats) {
+        write("CPU accounting is not available.\n");
+        return;
+    }
+
+    write(sprintf("Instructions in the last %d seconds, and since boot. ", stats["window"]));
+    if (stats["budget"]) {
+        write(sprintf("Budget: %d instructions a minute per object.\n", stats["budget"]));
+    } else {
+        write("No CPU budget.\n");
+    }
+    show("Objects", stats["objects"], 1);
+    show("Blueprints", stats["blueprints"], 0);
+    show("Domains", stats["domains"], 0);
+}
@@ -0,0 +1,19 @@
+// jit.c - Switch the tiered JIT on or off
+// Usage: jit [on | off]
+// With the JIT off, hot functions stay on the bytecode VM, so the same
+// command can be run both ways to compare results and timings.
+
+void main(string args) {
+    int was;
+
+    if (args == "on" || args == "off") {
+        was = jit_enable(args == "on");
+        write(sprintf("JIT %s (was %s).\n", args, was ? "on" : "off"));
+        return;
+    }
+
+    // jit_enable() reports the previous state, so put it straight back
+    was = jit_enable(1);
+    jit_enable(was);
+    write(sprintf("JIT is %s.\n", was ? "on" : "off"));
+}
@@ -0,0 +1,77 @@
+// profile.c - LPC function profiler
+// Usage: profile                     - status and hot spots in living, room and the daemons
+//        profile on | off | clear
+//        profile top [n] [prefix]    - top n functions (default 20), optionally under a path
+//        profile dump <file> [time]  - write folded stacks for flamegraph.pl / speedscope
+
+void show_top(int n, string prefix) {
+    mixed *top;
+    mapping f;
+    int i;
+
+    top = profile_stats(n, prefix);
+    if (sizeof(top) == 0) {
+        write("  (nothing recorded)\n");
+        return;
+    }
+
+    write(sprintf("  %10s %12s %12s %10s %10s  %s\n",
+        "calls", "self instr", "instr", "self ms", "ms", "function"));
+    for (i = 0; i < sizeof(top); i++) {
+        f = top[i];
+        write(sprintf("  %10d %12d %12d %10d %10d  %s:%s\n", f["calls"], f["self_instructions"],
+            f["instructions"], f["self_us"] / 1000, f["us"] / 1000, f["program"], f["function"]));
+    }
+}
+
+void main(string args) {
+    mixed *parts;
+    string path;
+    string folded;
+    int n;
+
+    if (args == 0 || args == "") {
+        // profile_enable() reports the previous state, so put it straight back
+        n = profile_enable(1);
+        profile_enable(n);
+        write("Profiler is " + (n ? "on" : "off") + ".\n");
+        write("/std/living:\n");
+        show_top(10, "/std/living");
+        write("/std/room:\n");
+        show_top(10, "/std/room");
+        write("Daemons:\n");
+        show_top(10, "/secure/daemon/");
+        return;
+    }
+
+    parts = explode(args, " ");
+
+    if (parts[0] == "on") {
+        profile_enable(1);
+        write("Profiler on.\n");
+    } else if (parts[0] == "off") {
+        profile_enable(0);
+        write("Profiler off.\n");
+    } else if (parts[0] == "clear") {
+        profile_clear();
+        write("Profiler data cleared.\n");
+    } else if (parts[0] == "top") {
+        n = sizeof(parts) > 1 ? to_int(parts[1]) : 20;
+        if (n <= 0) n = 20;
+        show_top(n, sizeof(parts) > 2 ? parts[2] : "");
+    } else if (parts[0] == "dump" && sizeof(parts) > 1) {
+        path = call_other(this_player(), "resolve_path", parts[1]);
+        folded = profile_folded(sizeof(parts) > 2 && parts[2] == "time");
+        if (folded == "") {
+            write("Nothing recorded yet.\n");
+            return;
+        }
+        if (write_file(path, folded)) {
+            write("Wrote folded stacks to " + path + "\n");
+        } else {
+            write("Could not write " + path + "\n");
+        }
+    } else {
+        write("Usage: profile [on|off|clear|top [n] [prefix]|dump <file> [time]]\n");
+    }
+}
@@ -0,0 +1,85 @@
+// snoop.c - Watch what other players see
+// Usage: snoop [<player> | stop [<player>]]
+// A player's name may be abbreviated to any unambiguous prefix.
+// "snoop <player>" copies everything the player is sent to you as well,
+// marked with their name; you can watch several at once. "snoop stop"
+// ends all of them. With no argument, lists who you are watching.
+
+// The player an abbreviated name means, or 0 after saying why there is none
+object find_target(string name) {
+    mixed found;
+    string *names;
+    int i;
+
+    found = resolve_living(name, 1);
+    if (objectp(found)) {
+        return found;
+    }
+    if (!found) {
+        write("No player named " + name + " is on.\n");
+        return 0;
+    }
+    names = ({ });
+    for (i = 0; i < sizeof(found); i++) {
+        names = names + ({ found[i]->query_name() });
+    }
+    write("Which one: " + implode(names, ", ") + "?\n");
+    return 0;
+}
+
+void main(string args) {
+    object me;
+    object target;
+    object *watching;
+    string *names;
+    int i;
+    int ended;
+
+    me = this_player();
+    if (!args || args == "") {
+        watching = query_snooping(me);
+        if (sizeof(watching) == 0) {
+            write("You are not snooping anyone.\n");
+            return;
+        }
+        names = ({ });
+        for (i = 0; i < sizeof(watching); i++) {
+            names = names + ({ watching[i]->query_name() });
+        }
+        write("You are snooping: " + implode(names, ", ") + ".\n");
+        return;
+    }
+
+    if (args == "stop") {
+        ended = unsnoop(me);
+        write(ended ? "You stop snooping.\n" : "You are not snooping anyone.\n");
+        return;
+    }
+
+    if (strlen(args) > 5 && args[0..4] == "stop ") {
+        target = find_target(args[5..]);
+        if (!target) {
+            return;
+        }
+        if (!unsnoop(me, target)) {
+            write("You are not snooping " + args[5..] + ".\n");
+            return;
+        }
+        write("You stop snooping " + target->query_name() + ".\n");
+        return;
+    }
+
+    target = find_target(args);
+    if (!target) {
+        return;
+    }
+    if (target == me) {
+        write("You already see what you see.\n");
+        return;
+    }
+    if (!snoop(me, target)) {
+        write("You can't snoop " + target->query_name() + " (already watching, or not connected).\n");
+        return;
+    }
+    write("You start snooping " + target->query_name() + ".\n");
+}
@@ -0,0 +1,79 @@
+// ticks.c - Show game loop timings from the tick profiler
+// Usage: ticks [clear]
+// Prints per-phase timings and allocations, garbage collections during
+// ticks, the functions that allocated most, the overrun count and the
+// most recent slow ticks with the objects and functions that took the
+// longest.
+// "ticks clear" starts the profiler over after printing.
+
+string ms(int us) {
+    return sprintf("%d.%d", us / 1000, (us % 1000) / 100);
+}
+
+string kb(int bytes) {
+    return sprintf("%d", bytes / 1024);
+}
+
+void show_histogram(string name, mapping h) {
+    write(sprintf("  %-11s %8d %8s %8s %8s %8s %8s %10s\n", name, h["count"],
+        ms(h["avg_us"]), ms(h["p50_us"]), ms(h["p95_us"]), ms(h["p99_us"]), ms(h["max_us"]), kb(h["bytes"])));
+}
+
+void main(string args) {
+    mapping stats;
+    mixed *slow;
+    mixed *top;
+    mapping tick;
+    mapping phases;
+    mapping gc;
+    mixed *allocators;
+    int i;
+    int j;
+
+    stats = tick_stats(args == "clear");
+
+    write(sprintf("Ticks: %d, overruns: %d (budget %sms)\n",
+        stats["ticks"], stats["overruns"], ms(stats["budget_us"])));
+    write(sprintf("  %-11s %8s %8s %8s %8s %8s %8s %10s\n", "phase", "count", "avg ms", "p50", "p95", "p99", "max", "alloc KB"));
+    show_histogram("tick", stats["tick"]);
+    show_histogram("commands", stats["commands"]);
+    show_histogram("heartbeats", stats["heartbeats"]);
+    show_histogram("timers", stats["timers"]);
+    show_histogram("saves", stats["saves"]);
+
+    gc = stats["gc"];
+    write(sprintf("GCs during ticks: gen0 %d, gen1 %d, gen2 %d (in %d ticks)\n",
+        gc["gen0"], gc["gen1"], gc["gen2"], gc["gen2_ticks"]));
+    allocators = stats["allocators"];
+    if (sizeof(allocators) > 0) {
+        write("Top allocators:\n");
+        for (i = 0; i < sizeof(allocators); i++) {
+            write(sprintf("  %10sKB x%-6d %s->%s\n", kb(allocators[i]["bytes"]), allocators[i]["calls"],
+                allocators[i]["program"], allocators[i]["function"]));
+        }
+    }
+
+    slow = stats["slow_ticks"];
+    if (sizeof(slow) == 0) {
+        write("No slow ticks.\n");
+    } else {
+        write("Slow ticks (most recent last):\n");
+        for (i = 0; i < sizeof(slow); i++) {
+            tick = slow[i];
+            phases = tick["phases"];
+            write(sprintf("  %s  %sms (commands %s, heartbeats %s, timers %s, saves %s) %sKB, gc %d/%d/%d\n",
+                ctime(tick["when"]), ms(tick["us"]), ms(phases["commands"]),
+                ms(phases["heartbeats"]), ms(phases["timers"]), ms(phases["saves"]),
+                kb(tick["bytes"]), tick["gc"][0], tick["gc"][1], tick["gc"][2]));
+            top = tick["top"];
+            for (j = 0; j < sizeof(top); j++) {
+                write(sprintf("    %8sms x%-4d %6sKB %s->%s\n", ms(top[j]["us"]), top[j]["calls"],
+                    kb(top[j]["bytes"]), top[j]["object"], top[j]["function"]));
+            }
+        }
+    }
+
+    if (args == "clear") {
+        write("Tick profiler cleared.\n");
+    }
+}
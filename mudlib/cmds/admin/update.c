@@ -5,9 +5,25 @@
  *
  * Recompiles an object and all objects that inherit from it.
  * Existing clones keep their old code (conservative strategy).
+ * Lists any performance warnings the compiler found in it.
  * Supports relative paths.
  */
 
+// Print the costly patterns the compiler found in path
+void show_perf_warnings(string path) {
+    mixed warnings;
+    int i;
+
+    warnings = perf_warnings(path);
+    if (!pointerp(warnings) || sizeof(warnings) == 0) {
+        return;
+    }
+    write("Performance warnings:");
+    for (i = 0; i < sizeof(warnings); i++) {
+        write("  " + warnings[i]);
+    }
+}
+
 void main(string arg) {
     object player;
     string path;
@@ -38,4 +54,5 @@ void main(string arg) {
     } else {
         write("Update failed or no objects found.");
     }
+    show_perf_warnings(path);
 }
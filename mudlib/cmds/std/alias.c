@@ -11,8 +11,8 @@ int main(string args)
 {
     string arg;
     mapping aliases;
-    string *keys;
-    int i;
+    string name;
+    string expansion;
     int count;
 
     args = trim(args);
@@ -21,8 +21,7 @@ int main(string args)
     if (args == "")
     {
         aliases = query_aliases();
-        keys = m_indices(aliases);
-        count = sizeof(keys);
+        count = sizeof(aliases);
 
         if (count == 0)
         {
@@ -31,9 +30,9 @@ int main(string args)
         }
 
         write("Your aliases:\n");
-        for (i = 0; i < count; i++)
+        foreach (name, expansion in aliases)
         {
-            write(sprintf("  %-12s = %s\n", keys[i], aliases[keys[i]]));
+            write(sprintf("  %-12s = %s\n", name, expansion));
         }
         write(sprintf("\nTotal: %d aliases\n", count));
         return 1;
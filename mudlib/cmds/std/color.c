@@ -0,0 +1,43 @@
+// /cmds/std/color.c
+// Color command - show or choose how output is colored
+// Usage: color [auto|none|ansi|256]
+
+void main(string args) {
+    object player;
+    mapping term;
+
+    player = this_player();
+    if (!player) {
+        return;
+    }
+
+    if (args == "auto" || args == "none" || args == "ansi" || args == "256") {
+        player->set_color_mode(args);
+    } else if (args && args != "") {
+        write("Usage: color [auto|none|ansi|256]");
+        return;
+    }
+
+    term = terminal_info(player);
+    if (!term) {
+        return;
+    }
+    if (term["client"] != "") {
+        write(sprintf("Your client reports itself as %s (%s).", term["client"], term["terminal"]));
+    } else {
+        write("Your client hasn't said what terminal it has.");
+    }
+    if (term["width"]) {
+        write(sprintf("Your window is %d x %d; output is wrapped to fit it.", term["width"], term["height"]));
+    }
+    if (term["color"] == "none") {
+        write("Color is off.");
+    } else if (term["color"] == "ansi") {
+        write("Color is %^GREEN%^on%^RESET%^, in the 16 ANSI colors.");
+    } else {
+        write("Color is %^F208%^on%^RESET%^, in 256 colors.");
+    }
+    if (player->query_color_mode() != "") {
+        write("You chose this; 'color auto' goes by what your client reports.");
+    }
+}
@@ -5,7 +5,6 @@ void main(string args) {
     object room;
     object player;
     object destination;
-    string exit_path;
     string dir;
 
     if (args == 0) {
@@ -27,24 +26,16 @@ void main(string args) {
         return;
     }
 
-    // Query the exit in the given direction
-    exit_path = call_other(room, "query_exit", dir);
-
-    if (exit_path == "") {
-        write("You cannot go that way.");
-        return;
-    }
-
-    // Load the destination room
-    destination = load_object(exit_path);
+    // The room's exit table loads and keeps the destination
+    destination = exit_destination(room, dir);
     if (destination == 0) {
-        write("That exit leads nowhere.");
+        write("You cannot go that way.");
         return;
     }
 
     // Check if this is a hidden exit
     int is_hidden;
-    is_hidden = call_other(room, "is_hidden_exit", dir);
+    is_hidden = exit_is_hidden(room, dir);
 
     // Notify old room and player
     if (is_hidden) {
@@ -1,79 +1,73 @@
 // /cmds/std/help.c
 // In-game help system - displays help topics and command documentation
+// Help files are served from the driver's help index, which reloads
+// itself when files under /help change.
 
-string *get_help_files(string dir) {
-    string *files;
-    string *result;
+string list_section(string title, string underline, string section) {
+    string *names;
+    string output;
     int i;
     int count;
 
-    files = get_dir(dir);
-    if (!files || sizeof(files) == 0) {
-        return ({});
+    names = help_topics(section);
+    if (sizeof(names) == 0) {
+        return "";
     }
 
-    result = ({});
-    count = sizeof(files);
+    output = title + "\n";
+    output = output + underline + "\n";
+    count = sizeof(names);
     i = 0;
     while (i < count) {
-        // Skip directories and hidden files
-        if (files[i] != "." && files[i] != "..") {
-            result = result + ({ files[i] });
-        }
+        output = output + "  " + names[i] + "\n";
         i = i + 1;
     }
-    return result;
+    return output + "\n";
 }
 
 void show_index() {
-    string *topics;
-    string *commands;
     string output;
-    int i;
-    int count;
 
     output = "";
     output = output + "===============================================================================\n";
     output = output + "                         LPMud Revival - Help System\n";
     output = output + "===============================================================================\n\n";
-    output = output + "Type 'help <topic>' to learn more about any topic listed below.\n\n";
+    output = output + "Type 'help <topic>' to learn more about any topic listed below.\n";
+    output = output + "Type 'help search <word>' to find topics that mention a word.\n\n";
 
-    // Show topics
-    topics = get_help_files("/help/topics");
-    if (sizeof(topics) > 0) {
-        output = output + "TOPICS\n";
-        output = output + "------\n";
-        count = sizeof(topics);
-        i = 0;
-        while (i < count) {
-            output = output + "  " + topics[i] + "\n";
-            i = i + 1;
-        }
-        output = output + "\n";
-    }
-
-    // Show commands
-    commands = get_help_files("/help/commands");
-    if (sizeof(commands) > 0) {
-        output = output + "COMMANDS\n";
-        output = output + "--------\n";
-        count = sizeof(commands);
-        i = 0;
-        while (i < count) {
-            output = output + "  " + commands[i] + "\n";
-            i = i + 1;
-        }
-        output = output + "\n";
-    }
+    output = output + list_section("TOPICS", "------", "topics");
+    output = output + list_section("COMMANDS", "--------", "commands");
 
     output = output + "===============================================================================\n";
     write(output);
 }
 
+// Comma-separated, at most limit of them
+void show_matches(string *matches, int limit) {
+    int i;
+    int count;
+    string output;
+
+    output = "";
+    count = sizeof(matches);
+    if (count > limit) {
+        count = limit;
+    }
+    i = 0;
+    while (i < count) {
+        if (i > 0) {
+            output = output + ", ";
+        }
+        output = output + matches[i];
+        i = i + 1;
+    }
+    write(output + "\n");
+}
+
 void main(string args) {
     string topic;
     string content;
-    string path;
+    string *matches;
 
     // Show dynamic index if no argument
     if (args == "" || args == 0) {
@@ -83,23 +77,28 @@ void main(string args) {
 
     topic = lower_case(args);
 
-    // Try to find help file in order: commands, topics, then root help
-    path = "/help/commands/" + topic;
-    content = read_file(path);
-
-    if (content == 0 || content == "") {
-        path = "/help/topics/" + topic;
-        content = read_file(path);
-    }
-
-    if (content == 0 || content == "") {
-        path = "/help/" + topic;
-        content = read_file(path);
+    if (strlen(topic) > 7 && topic[0..6] == "search ") {
+        topic = topic[7..];
+        matches = help_search(topic);
+        if (sizeof(matches) == 0) {
+            write("No help topics mention '" + topic + "'.\n");
+            return;
+        }
+        write("Help topics for '" + topic + "':\n");
+        show_matches(matches, sizeof(matches));
+        return;
     }
 
+    content = help_lookup(topic);
     if (content == 0 || content == "") {
         write("No help available for '" + topic + "'.\n");
-        write("Type 'help' for a list of topics, or 'help <topic>' for specific help.\n");
+        matches = help_search(topic);
+        if (sizeof(matches) > 0) {
+            write("Perhaps you meant: ");
+            show_matches(matches, 5);
+        } else {
+            write("Type 'help' for a list of topics, or 'help <topic>' for specific help.\n");
+        }
         return;
     }
 
@@ -0,0 +1,27 @@
+// /cmds/std/lag.c
+// Lag command - show how far behind the game is running
+
+void main(string args) {
+    mapping lag;
+    int ms;
+
+    lag = query_lag();
+    if (!lag) {
+        write("The game is not running.");
+        return;
+    }
+
+    ms = lag["lag_ms"];
+    if (ms < 50) {
+        write("The game is keeping up.");
+    } else {
+        write(sprintf("The game is running about %d.%d seconds behind.", ms / 1000, (ms % 1000) / 100));
+    }
+    if (lag["heartbeats_behind"] > 0) {
+        write(sprintf("Background activity (healing, wandering monsters) is %d ticks behind.",
+            lag["heartbeats_behind"]));
+    }
+    if (lag["resets_waiting"] > 0) {
+        write(sprintf("%d area resets are waiting for a quieter moment.", lag["resets_waiting"]));
+    }
+}
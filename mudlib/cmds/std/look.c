@@ -5,11 +5,15 @@
 void look_at_object(object target) {
     string short_desc;
     string long_desc;
+    mixed *info;
     object *contents;
+    string *items;
     int i;
 
-    short_desc = call_other(target, "query_short");
-    long_desc = call_other(target, "query_long");
+    // One batched call instead of a call_other per property
+    info = call_other_many(target, ({ "query_short", "query_long", "is_living", "query_health_desc", "query_name" }));
+    short_desc = info[0];
+    long_desc = info[1];
 
     // Show object description
     if (short_desc && short_desc != "") {
@@ -22,11 +26,11 @@ void look_at_object(object target) {
     }
 
     // Show health status for living things
-    if (call_other(target, "is_living")) {
+    if (info[2]) {
         string health;
-        health = call_other(target, "query_health_desc");
+        health = info[3];
         if (health && health != "") {
-            write(capitalize(call_other(target, "query_name")) + " is " + health + ".");
+            write(capitalize(info[4]) + " is " + health + ".");
         }
     }
 
@@ -35,73 +39,85 @@ void look_at_object(object target) {
     if (sizeof(contents) > 0) {
         write("");
         write("It contains:");
+        items = map_call(contents, "query_short");
         for (i = 0; i < sizeof(contents); i++) {
-            string item_desc;
-            item_desc = call_other(contents[i], "query_short");
-            if (item_desc && item_desc != "") {
-                write("  " + capitalize(item_desc));
+            if (items[i] && items[i] != "") {
+                write("  " + capitalize(items[i]));
             }
         }
     }
 }
 
-// Look at the current room
-void look_at_room() {
-    object player;
-    object room;
-    string short_desc;
-    string long_desc;
-    string exits;
+// Render the current room and store it for the next look. Every object
+// gets its line, the viewer included; room_render() leaves the viewer out.
+void render_room(object room) {
+    string heading;
     object *contents;
+    int *living;
+    string *shorts;
+    mixed *info;
+    object *listed;
+    string *lines;
     int i;
 
-    player = this_player();
-    room = environment(player);
-
-    // Get room descriptions
-    short_desc = call_other(room, "query_short");
-    long_desc = call_other(room, "query_long");
-    exits = call_other(room, "query_exits");
-
-    // Display the room
-    write(short_desc);
-    write(long_desc);
-    write("");
-    write(exits);
+    info = call_other_many(room, ({ "query_short", "query_long", "query_exits" }));
+    heading = info[0] + "\n" + info[1] + "\n\n" + info[2];
 
-    // Show other players and livings in room
     contents = all_inventory(room);
+    living = map_call(contents, "is_living");
+    shorts = map_call(contents, "query_short");
+    listed = ({ });
+    lines = ({ });
+
+    // Other players and livings first
     for (i = 0; i < sizeof(contents); i++) {
-        if (contents[i] != player) {
-            if (call_other(contents[i], "is_living")) {
-                string name;
-                string health;
-                name = call_other(contents[i], "query_short");
-                if (!name || name == "") {
-                    name = call_other(contents[i], "query_name");
-                }
-                health = call_other(contents[i], "query_health_desc");
-                if (name && name != "") {
-                    if (health && health != "in perfect health") {
-                        write(capitalize(name) + " is here, " + health + ".");
-                    } else {
-                        write(capitalize(name) + " is here.");
-                    }
+        if (living[i]) {
+            string name;
+            string health;
+            name = shorts[i];
+            info = call_other_many(contents[i], ({ "query_name", "query_health_desc" }));
+            if (!name || name == "") {
+                name = info[0];
+            }
+            health = info[1];
+            if (name && name != "") {
+                listed = listed + ({ contents[i] });
+                if (health && health != "in perfect health") {
+                    lines = lines + ({ capitalize(name) + " is here, " + health + "." });
+                } else {
+                    lines = lines + ({ capitalize(name) + " is here." });
                 }
             }
         }
     }
 
-    // Show items on the ground
+    // Then items on the ground
     for (i = 0; i < sizeof(contents); i++) {
-        if (contents[i] != player && !call_other(contents[i], "is_living")) {
-            string item_desc;
-            item_desc = call_other(contents[i], "query_short");
-            if (item_desc && item_desc != "") {
-                write(capitalize(item_desc) + " is lying here.");
-            }
+        if (!living[i] && shorts[i] && shorts[i] != "") {
+            listed = listed + ({ contents[i] });
+            lines = lines + ({ capitalize(shorts[i]) + " is lying here." });
         }
     }
+
+    set_room_render(room, heading, listed, lines);
+}
+
+// Look at the current room. The rendering is cached by the driver until
+// the room, its contents or how any of them describe themselves change.
+void look_at_room() {
+    object player;
+    object room;
+    string text;
+
+    player = this_player();
+    room = environment(player);
+
+    text = room_render(room, player);
+    if (!text) {
+        render_room(room);
+        text = room_render(room, player);
+    }
+    write(text);
 }
 
 void main(string args) {
@@ -1,22 +1,70 @@
 // /cmds/std/who.c
 // Who command - list players currently in the game
+// "who <prefix>" lists only those whose names begin with prefix.
+
+// The players whose names begin with prefix
+object *named(object *players, string prefix) {
+    object *result;
+    int i;
+
+    result = ({ });
+    for (i = 0; i < sizeof(players); i++) {
+        if (strsrch(lower_case(players[i]->query_name()), prefix) == 0) {
+            result = result + ({ players[i] });
+        }
+    }
+    return result;
+}
 
 void main(string args) {
     object *active;
     object *linkdead;
+    mapping elsewhere;
+    string *remote;
     object player;
     string name;
     int i;
     int total;
+    int columns;
+    string row;
+    string rule;
+    string prefix;
+    string *matching;
 
-    active = users();
     linkdead = linkdead_users();
-    total = sizeof(active) + sizeof(linkdead);
+    elsewhere = cluster_users();
+    remote = keys(elsewhere);
+    if (args && args != "") {
+        prefix = lower_case(args);
+        active = match_living(prefix, 1);
+        linkdead = named(linkdead, prefix);
+        matching = ({ });
+        for (i = 0; i < sizeof(remote); i++) {
+            if (strsrch(remote[i], prefix) == 0) {
+                matching = matching + ({ remote[i] });
+            }
+        }
+        remote = matching;
+    } else {
+        active = users();
+    }
+    total = sizeof(active) + sizeof(linkdead) + sizeof(remote);
+
+    // Active players go in 16-character columns, as many as fit the window
+    columns = (screen_width(this_player()) - 2) / 16;
+    if (columns < 1) {
+        columns = 1;
+    }
+    rule = "";
+    for (i = 0; i < columns * 16; i++) {
+        rule = rule + "-";
+    }
 
     write("Players online: " + total);
-    write("----------------------------------------");
+    write(rule);
 
     // Show active players
+    row = "";
     for (i = 0; i < sizeof(active); i++) {
         player = active[i];
         if (player != 0) {
@@ -24,9 +72,16 @@ void main(string args) {
             if (name == 0 || name == "") {
                 name = "Unknown";
             }
-            write("  " + name);
+            row = row + sprintf("%-16s", name);
+            if (strlen(row) >= columns * 16) {
+                write("  " + row);
+                row = "";
+            }
         }
     }
+    if (row != "") {
+        write("  " + row);
+    }
 
     // Show linkdead players
     for (i = 0; i < sizeof(linkdead); i++) {
@@ -40,5 +95,10 @@ void main(string args) {
         }
     }
 
-    write("----------------------------------------");
+    // Players on the other nodes of a cluster
+    for (i = 0; i < sizeof(remote); i++) {
+        write("  " + capitalize(remote[i]) + " (" + elsewhere[remote[i]] + ")");
+    }
+
+    write(rule);
 }
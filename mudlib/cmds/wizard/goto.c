@@ -1,13 +1,15 @@
 // goto.c - Teleport to a room
-// Usage: goto <room_path>
-// Teleports the wizard to the specified room.
-// Supports relative paths.
+// Usage: goto <room_path> | goto <player>
+// Teleports the wizard to the specified room, or to the room a player is
+// in. Supports relative paths; a name without a '/' is tried as a
+// player's first, abbreviated to any unambiguous prefix.
 
 void main(string args) {
     object player;
     object room;
     object old_room;
     string path;
+    mixed found;
 
     player = this_player();
     if (!player) {
@@ -16,16 +18,33 @@ void main(string args) {
     }
 
     if (!args || args == "") {
-        write("Usage: goto <room_path>");
+        write("Usage: goto <room_path> | goto <player>");
         write("Example: goto /world/rooms/town/square");
         write("Example: goto ../forest/edge");
         return;
     }
 
-    // Resolve relative path
-    path = call_other(player, "resolve_path", args);
+    if (strsrch(args, "/") < 0) {
+        found = resolve_living(args, 1);
+        if (pointerp(found)) {
+            write("Which player do you mean? " + sizeof(found) + " names begin with " + args + ".");
+            return;
+        }
+        if (found) {
+            room = environment(found);
+            if (!room || found == player) {
+                write(call_other(found, "query_name") + " isn't anywhere you can go.");
+                return;
+            }
+            path = file_name(room);
+        }
+    }
 
-    room = load_object(path);
+    if (!room) {
+        // Resolve relative path
+        path = call_other(player, "resolve_path", args);
+        room = load_object(path);
+    }
 
     if (!room) {
         write("Failed to load room: " + path);
@@ -81,8 +81,9 @@ void create() {
     enable_reset(60);
 
     // add_spawn(path) - Add a monster to spawn on reset
-    // The room checks if a monster of this type is already present.
-    // If not, it clones a new one and moves it here.
+    // The driver keeps track of the monsters this room spawned. On reset,
+    // any that have died are cloned again and moved here. Add a path twice
+    // to keep two.
     add_spawn("/world/mobs/rat");
 
     // For multiple different monsters:
@@ -13,7 +13,6 @@
 // Channels are stored in the `channels` mapping:
 //   channels[name] = ([
 //       "prefix": "[Chat]",           // Display prefix
-//       "history": ({ ... }),         // Array of message mappings
 //       "restricted": 0,              // If 1, requires permission check
 //       "permission_func": "...",     // Function to call on player to check access
 //   ])
@@ -25,7 +24,15 @@
 //   set_chat_subscription(channel, enabled) -> sets subscription
 //   query_chat_enabled() -> legacy, returns subscription to "chat" channel
 //
-// The daemon calls these functions when sending messages.
+// The daemon reads these when a player logs in or changes a subscription
+// (refresh_player), and records who may hear each channel in the driver's
+// channel registry with channel_subscribe()/channel_unsubscribe(). Sending a
+// message is then a single channel_publish(), which queues it for every
+// connected listener without calling back into LPC per player.
+//
+// player.c calls refresh_player() from restore_player(), the subscription
+// setters and add_guild()/remove_guild(). A permission_func that depends on
+// anything else must call refresh_player() when that changes.
 //
 // ADDING NEW CHANNELS:
 // --------------------
@@ -51,7 +58,11 @@
 // Messages are stored as mappings:
 //   ([ "time": timestamp, "sender": "Name", "message": "text" ])
 //
-// History is saved to /secure/data/chat_<channel>.json
+// History is kept by the driver in a ring buffer of the last max_history
+// messages per channel (history_open/history_add/history_get), logged
+// append-only to /secure/data/chat_<channel>.json and compacted by the
+// driver in the background. Older files of "time|sender|message" lines are
+// still read; they come back as strings and are parsed by parse_entry().
 //
 
 inherit "/std/object";
@@ -74,9 +85,6 @@ void create() {
     // Register default channels
     register_channel("chat", "[Chat]", 0, "");
     register_channel("ooc", "[OOC]", 0, "");
-
-    // Load history for all channels
-    load_all_history();
 }
 
 // Register a new channel
@@ -90,26 +98,33 @@ void register_channel(string name, string prefix, int restricted, string permiss
     channels = channels + ([
         name: ([
             "prefix": prefix,
-            "history": ({}),
             "restricted": restricted,
             "permission_func": permission_func
         ])
     ]);
+
+    history_open(history_name(name), data_dir + "/chat_" + name + ".json", max_history);
+    refresh_channel(name);
+}
+
+// Name of a channel's history in the driver
+string history_name(string channel) {
+    return "chat:" + channel;
 }
 
 // Unregister a channel (e.g., when a guild is disbanded)
 void unregister_channel(string name) {
     mapping new_channels;
-    string *names;
-    int i;
+    string channel;
+    mixed info;
 
     if (!channels[name]) return;
 
+    channel_remove(name);
     new_channels = ([]);
-    names = keys(channels);
-    for (i = 0; i < sizeof(names); i++) {
-        if (names[i] != name) {
-            new_channels = new_channels + ([ names[i]: channels[names[i]] ]);
+    foreach (channel, info in channels) {
+        if (channel != name) {
+            new_channels = new_channels + ([ channel: info ]);
         }
     }
     channels = new_channels;
@@ -143,79 +158,43 @@ int can_access(string channel, object player) {
     return call_other(player, func);
 }
 
-// Load history for a specific channel
-void load_channel_history(string channel) {
-    mapping ch;
-    string data;
-    string filename;
-
-    ch = channels[channel];
-    if (!ch) return;
-
-    filename = data_dir + "/chat_" + channel + ".json";
-    data = read_file(filename);
-
-    if (data && data != "") {
-        string *lines;
-        mixed *history;
-        int i;
-
-        lines = explode(data, "\n");
-        history = ({});
-
-        for (i = 0; i < sizeof(lines); i++) {
-            string *parts;
-            if (lines[i] == "") continue;
-
-            parts = explode(lines[i], "|");
-            if (sizeof(parts) >= 3) {
-                mapping entry;
-                entry = ([
-                    "time": to_int(parts[0]),
-                    "sender": parts[1],
-                    "message": implode(parts[2..], "|")
-                ]);
-                history = history + ({ entry });
-            }
-        }
-
-        ch["history"] = history;
-    }
+// Whether a player should hear a channel
+int query_listening(string channel, object player) {
+    return query_player_subscribed(player, channel) && can_access(channel, player);
 }
 
-// Load history for all channels
-void load_all_history() {
+// Bring a player's channel subscriptions in step with their preferences
+// and access. Called on login and whenever either changes.
+void refresh_player(object player) {
     string *names;
     int i;
 
+    if (!player) return;
+
     names = keys(channels);
     for (i = 0; i < sizeof(names); i++) {
-        load_channel_history(names[i]);
+        if (query_listening(names[i], player)) {
+            channel_subscribe(names[i], player);
+        } else {
+            channel_unsubscribe(names[i], player);
+        }
     }
 }
 
-// Save history for a specific channel
-void save_channel_history(string channel) {
-    mapping ch;
-    mixed *history;
-    string data;
-    string filename;
+// Subscribe everyone online who should hear a channel (on registration,
+// including when this daemon is reloaded)
+void refresh_channel(string channel) {
+    object *players;
     int i;
 
-    ch = channels[channel];
-    if (!ch) return;
-
-    history = ch["history"];
-    data = "";
-
-    for (i = 0; i < sizeof(history); i++) {
-        mapping entry;
-        entry = history[i];
-        data = data + entry["time"] + "|" + entry["sender"] + "|" + entry["message"] + "\n";
+    players = users();
+    for (i = 0; i < sizeof(players); i++) {
+        if (query_listening(channel, players[i])) {
+            channel_subscribe(channel, players[i]);
+        } else {
+            channel_unsubscribe(channel, players[i]);
+        }
     }
-
-    filename = data_dir + "/chat_" + channel + ".json";
-    write_file(filename, data, 1);
 }
 
 // Send a message to a channel
@@ -223,11 +202,8 @@ void save_channel_history(string channel) {
 int send_message(string channel, string sender, string message) {
     mapping ch;
     mapping entry;
-    mixed *history;
-    object *players;
     string formatted;
     string prefix;
-    int i;
 
     ch = channels[channel];
     if (!ch) return 0;
@@ -243,32 +219,15 @@ int send_message(string channel, string sender, string message) {
         "message": message
     ]);
 
-    // Add to history
-    history = ch["history"];
-    history = history + ({ entry });
-
-    // Trim if too long
-    if (sizeof(history) > max_history) {
-        history = history[sizeof(history) - max_history..];
-    }
-    ch["history"] = history;
-
-    // Save to disk
-    save_channel_history(channel);
+    // Add to history (the driver drops the oldest and logs it to disk)
+    history_add(history_name(channel), entry);
 
     // Format message
     prefix = ch["prefix"];
-    formatted = prefix + " " + sender + ": " + message + "\n";
+    formatted = "%^CYAN%^" + prefix + "%^RESET%^ " + sender + ": " + message + "\n";
 
-    // Send to all subscribed players who can access this channel
-    players = users();
-    for (i = 0; i < sizeof(players); i++) {
-        if (players[i] &&
-            query_player_subscribed(players[i], channel) &&
-            can_access(channel, players[i])) {
-            tell_object(players[i], formatted);
-        }
-    }
+    // Send to everyone subscribed (see refresh_player)
+    channel_publish(channel, formatted);
 
     return 1;
 }
@@ -280,8 +239,8 @@ int query_player_subscribed(object player, string channel) {
     // Try the new subscription system first
     subs = call_other(player, "query_chat_subscriptions");
     if (subs) {
-        // Check if channel key exists in mapping (member returns index or -1)
-        if (member(subs, channel) != -1) {
+        // Check if channel key exists in mapping (member returns 1 or 0)
+        if (member(subs, channel)) {
             // Explicit subscription setting exists - return it directly
             return subs[channel];
         }
@@ -303,19 +262,26 @@ int query_player_subscribed(object player, string channel) {
 // Get history for a channel
 // count = number of messages (0 = all)
 mixed *get_history(string channel, int count) {
-    mapping ch;
-    mixed *history;
+    if (!channels[channel]) return ({});
 
-    ch = channels[channel];
-    if (!ch) return ({});
+    return map_array(history_get(history_name(channel), count), "parse_entry");
+}
 
-    history = ch["history"];
+// Entries from old history files are "time|sender|message" strings
+mapping parse_entry(mixed entry) {
+    string *parts;
 
-    if (count <= 0 || count >= sizeof(history)) {
-        return history;
-    }
+    if (mappingp(entry)) return entry;
 
-    return history[sizeof(history) - count..];
+    parts = explode(entry, "|");
+    if (sizeof(parts) < 3) {
+        return ([ "time": 0, "sender": "", "message": entry ]);
+    }
+    return ([
+        "time": to_int(parts[0]),
+        "sender": parts[1],
+        "message": implode(parts[2..], "|")
+    ]);
 }
 
 // Format a single history entry
@@ -30,11 +30,11 @@ string query_corpse_name() {
 
 // Called when corpse is created - schedule decay
 void start_decay() {
-    call_out("decay", decay_time);
+    add_effect(this_object(), "decay", decay_time, 0, "decay");
 }
 
-// Corpse decays - drop all contents and destruct
-void decay() {
+// Decay effect expired - drop all contents and destruct
+void decay(object ob, string id) {
     object *contents;
     object env;
     int i;
@@ -44,7 +44,7 @@ void decay() {
     // Only decay if we're in a room, not in someone's inventory
     if (env && !call_other(env, "is_room")) {
         // Reschedule decay check for later
-        call_out("decay", 60);
+        add_effect(this_object(), "decay", 60, 0, "decay");
         return;
     }
 
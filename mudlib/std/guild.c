@@ -73,6 +73,7 @@ void list_available_spells(object player) {
     int player_skill;
     int can_learn;
     int already_knows;
+    mixed *info;
 
     if (!player) return;
 
@@ -98,9 +99,10 @@ void list_available_spells(object player) {
         spell = load_object(taught_spells[i]);
         if (!spell) continue;
 
-        spell_name = call_other(spell, "query_spell_name");
-        spell_school = call_other(spell, "query_spell_school");
-        learn_req = call_other(spell, "query_learn_skill");
+        info = call_other_many(spell, ({ "query_spell_name", "query_spell_school", "query_learn_skill" }));
+        spell_name = info[0];
+        spell_school = info[1];
+        learn_req = info[2];
         player_skill = call_other(player, "query_skill", spell_school);
         already_knows = call_other(player, "knows_spell", taught_spells[i]);
 
@@ -17,10 +17,16 @@ int cha;
 int hp;
 int max_hp;
 
+// Health description others last saw (see note_health)
+string health_shown;
+
 // Mana pool
 int mana;
 int max_mana;
 
+// Vitals last sent to a GMCP client (0 until sent)
+mapping vitals_sent;
+
 // Combat state
 object attacker;
 int in_combat;
@@ -29,19 +35,24 @@ int is_dying;  // Prevents double-death when damage triggers die()
 // Regeneration (HP per heartbeat when not in combat)
 int regen_rate;
 
-// Intoxication (0-100, affects regen and combat)
-int intoxication;
+// Intoxication (0-100, affects regen and combat). It wears off at a point
+// per second, so only the time it reaches 0 is kept
+int sober_at;
 
 // Equipment
 object wielded_weapon;
 mapping worn_armor;
 
-// Skills - mapping of skill_name to skill_value
-mapping skills;
+// Temporary armor from spells and the like, by source
+mapping armor_bonuses;
+
+// Skills and allowed skills (granted by guilds) live in the driver's skill
+// table for this object: set_skill_level(), set_skill_allowed() and friends.
+// If none are allowed, all skills are allowed (for monsters).
 
-// Allowed skills (granted by guilds) - array of skill names
-// If empty, all skills are allowed (for backwards compatibility with monsters)
-string *allowed_skills;
+// Skills from save files written before the skill table, moved into it by
+// restore_skills()
+mapping skills;
 
 // Known spells - array of spell paths this living has learned
 string *known_spells;
@@ -49,6 +60,9 @@ string *known_spells;
 void create() {
     ::create();
 
+    // Lets the driver keep each room's livings on their own list (all_livings)
+    set_living(1);
+
     // Initialize stats to 1
     str = 1;
     dex = 1;
@@ -75,18 +89,12 @@ void create() {
     regen_rate = 1;
 
     // Start sober
-    intoxication = 0;
+    sober_at = 0;
 
     // Equipment
     wielded_weapon = 0;
     worn_armor = ([]);
-
-    // Skills - start with empty skills
-    skills = ([]);
-
-    // Allowed skills - empty means all allowed (for monsters)
-    // Players/guild members will have specific skills added
-    allowed_skills = ({});
+    armor_bonuses = ([]);
 
     // Known spells - empty initially
     known_spells = ({});
@@ -123,6 +131,7 @@ void set_con(int val) {
     if (hp > max_hp) {
         hp = max_hp;
     }
+    note_health();
 }
 
 void set_int(int val) {
@@ -148,6 +157,7 @@ void set_hp(int val) {
     if (hp < 0) {
         hp = 0;
     }
+    note_health();
 }
 
 void set_max_hp(int val) {
@@ -155,6 +165,7 @@ void set_max_hp(int val) {
     if (hp > max_hp) {
         hp = max_hp;
     }
+    note_health();
 }
 
 // Get a description of health status based on HP percentage
@@ -174,6 +185,19 @@ string query_health_desc() {
     return "near death";
 }
 
+// Call after hp or max_hp change. Rooms showing this living are rendered
+// again when its health description moves to another band, not on every
+// point of damage or regeneration.
+void note_health() {
+    string desc;
+
+    desc = query_health_desc();
+    if (desc != health_shown) {
+        health_shown = desc;
+        description_changed();
+    }
+}
+
 // Mana getters/setters
 int query_mana() { return mana; }
 int query_max_mana() { return max_mana; }
@@ -217,33 +241,54 @@ void heal(int amount) {
     if (hp > max_hp) {
         hp = max_hp;
     }
+    note_health();
 }
 
 // Intoxication functions
 int query_intoxication() {
-    return intoxication;
+    int left;
+    left = sober_at - time();
+    return left > 0 ? left : 0;
 }
 
 // Add intoxication from drinking
 // Returns new intoxication level
 int add_intoxication(int amount) {
-    intoxication = intoxication + amount;
-    if (intoxication > 100) {
-        intoxication = 100;
+    int level;
+
+    level = query_intoxication() + amount;
+    if (level > 100) {
+        level = 100;
     }
-    if (intoxication < 0) {
-        intoxication = 0;
+    if (level < 0) {
+        level = 0;
     }
-    return intoxication;
+
+    // The driver tells us when it has worn off; nothing runs until then
+    sober_at = time() + level;
+    if (level > 0) {
+        add_effect(this_object(), "intoxication", level, 0, "sober_up");
+    } else {
+        remove_effect(this_object(), "intoxication");
+    }
+    return level;
+}
+
+// Intoxication effect expired
+void sober_up(object ob, string id) {
+    tell_object(this_object(), "You feel sober again.\n");
 }
 
 // Check if too drunk to fight effectively
 int is_too_drunk() {
-    return intoxication >= 50;
+    return query_intoxication() >= 50;
 }
 
 // Get intoxication status message
 string query_intoxication_status() {
+    int intoxication;
+
+    intoxication = query_intoxication();
     if (intoxication == 0) {
         return "sober";
     } else if (intoxication < 20) {
@@ -270,37 +315,65 @@ mapping query_worn_armor() { return worn_armor; }
 // Calculate total armor value from all worn pieces
 int query_total_armor() {
     int total;
-    string *slots;
-    int i;
+    string slot;
+    object armor;
+    int bonus;
 
     total = 0;
-    slots = keys(worn_armor);
-
-    for (i = 0; i < sizeof(slots); i++) {
-        object armor;
-        armor = worn_armor[slots[i]];
+    foreach (slot, armor in worn_armor) {
         // Check object is valid (not null, not destructed)
         if (armor && objectp(armor)) {
             total = total + call_other(armor, "query_armor_class");
         }
     }
 
+    if (armor_bonuses) {
+        foreach (slot, bonus in armor_bonuses) {
+            total = total + bonus;
+        }
+    }
+
     return total;
 }
 
+// Temporary armor from source (a spell, say); 0 removes it
+void set_armor_bonus(string source, int amount) {
+    if (!armor_bonuses) {
+        armor_bonuses = ([]);
+    }
+    if (amount) {
+        armor_bonuses[source] = amount;
+    } else {
+        armor_bonuses = m_delete(armor_bonuses, source);
+    }
+}
+
+int query_armor_bonus(string source) {
+    return armor_bonuses ? armor_bonuses[source] : 0;
+}
+
+// Armor bonus from source for a number of seconds; casting it again
+// replaces it
+void add_timed_armor(string source, int amount, int seconds) {
+    set_armor_bonus(source, amount);
+    add_effect(this_object(), source, seconds, 0, "armor_bonus_ended");
+}
+
+// Timed armor effect expired
+void armor_bonus_ended(object ob, string source) {
+    set_armor_bonus(source, 0);
+    tell_object(this_object(), "Your " + source + " fades away.\n");
+}
+
 // Calculate total spell failure chance from all worn armor
 // Returns percentage (0-100+)
 int query_total_spell_failure() {
     int total;
-    string *slots;
-    int i;
+    string slot;
+    object armor;
 
     total = 0;
-    slots = keys(worn_armor);
-
-    for (i = 0; i < sizeof(slots); i++) {
-        object armor;
-        armor = worn_armor[slots[i]];
+    foreach (slot, armor in worn_armor) {
         // Check object is valid (not null, not destructed)
         if (armor && objectp(armor)) {
             total = total + call_other(armor, "query_spell_failure");
@@ -314,15 +387,11 @@ int query_total_spell_failure() {
 // Returns percentage reduction to dodge effectiveness
 int query_total_dodge_penalty() {
     int total;
-    string *slots;
-    int i;
+    string slot;
+    object armor;
 
     total = 0;
-    slots = keys(worn_armor);
-
-    for (i = 0; i < sizeof(slots); i++) {
-        object armor;
-        armor = worn_armor[slots[i]];
+    foreach (slot, armor in worn_armor) {
         // Check object is valid (not null, not destructed)
         if (armor && objectp(armor)) {
             total = total + call_other(armor, "query_dodge_penalty");
@@ -395,7 +464,7 @@ int query_hit_chance(object target) {
     // Dodge is reduced by armor penalty
     if (target) {
         target_agi = call_other(target, "query_agi");
-        target_dodge = call_other(target, "query_skill", "dodge");
+        target_dodge = query_skill_level(target, "dodge");
         target_dodge_penalty = call_other(target, "query_total_dodge_penalty");
 
         // Apply armor penalty to dodge skill effectiveness
@@ -406,8 +475,8 @@ int query_hit_chance(object target) {
     }
 
     // Drunk penalty: lose 1% hit chance per 2 intoxication
-    if (intoxication > 0) {
-        chance = chance - (intoxication / 2);
+    if (query_intoxication() > 0) {
+        chance = chance - (query_intoxication() / 2);
     }
 
     // Clamp to reasonable range
@@ -539,21 +608,18 @@ int can_advance_skill(string skill_name) {
         }
     }
 
-    // For non-players (monsters/NPCs), allow all skills if allowed_skills is empty
+    // Check if skill is allowed (from current guild membership)
+    if (query_skill_allowed(this_object(), skill_name)) {
+        return 1;
+    }
+
+    // For non-players (monsters/NPCs), allow all skills if none are allowed
     // Players must join guilds to gain access to guild-gated skills
-    if (sizeof(allowed_skills) == 0) {
+    if (sizeof(query_skills_allowed(this_object())) == 0) {
         if (!call_other(this_object(), "is_player")) {
             return 1;  // Monster/NPC with no restrictions
         }
         // Player with no guilds - can only use basic skills (checked above)
-        return 0;
-    }
-
-    // Check if skill is in allowed list (from current guild membership)
-    for (i = 0; i < sizeof(allowed_skills); i++) {
-        if (allowed_skills[i] == skill_name) {
-            return 1;
-        }
     }
 
     return 0;
@@ -584,11 +650,7 @@ int query_skill(string skill_name) {
         return 0;
     }
 
-    if (!skills[skill_name]) {
-        return 0;
-    }
-
-    return skills[skill_name];
+    return query_skill_level(this_object(), skill_name);
 }
 
 // Set skill value directly (for admin/testing)
@@ -601,8 +663,7 @@ void set_skill(string skill_name, int value) {
         value = 0;
     }
 
-    // Use mapping concatenation as workaround for index assignment
-    skills = skills + ([ skill_name: value ]);
+    set_skill_level(skill_name, value);
 }
 
 // Advance a skill through use (with logarithmic diminishing returns)
@@ -668,48 +729,50 @@ int advance_skill(string skill_name, int difficulty) {
 
 // Add a skill to the allowed list (called by guilds)
 void add_allowed_skill(string skill_name) {
-    int i;
-
     if (!skill_name || skill_name == "") {
         return;
     }
 
-    // Check if already allowed
-    for (i = 0; i < sizeof(allowed_skills); i++) {
-        if (allowed_skills[i] == skill_name) {
-            return;
-        }
-    }
-
-    allowed_skills = allowed_skills + ({ skill_name });
+    set_skill_allowed(skill_name, 1);
 }
 
 // Remove a skill from the allowed list (when leaving a guild)
 void remove_allowed_skill(string skill_name) {
-    int i;
-    string *new_list;
-
     if (!skill_name || skill_name == "") {
         return;
     }
 
-    new_list = ({});
-    for (i = 0; i < sizeof(allowed_skills); i++) {
-        if (allowed_skills[i] != skill_name) {
-            new_list = new_list + ({ allowed_skills[i] });
-        }
-    }
-    allowed_skills = new_list;
+    set_skill_allowed(skill_name, 0);
+}
+
+// Stop allowing every skill (before rebuilding the list from guilds)
+void clear_allowed_skills() {
+    set_skill_allowed(0, 0);
 }
 
 // Get all allowed skills
 string *query_allowed_skills() {
-    return allowed_skills;
+    return query_skills_allowed(this_object());
 }
 
-// Get all skills (the mapping)
+// Get all skills (a mapping of skill name to value)
 mapping query_skills() {
-    return skills;
+    return query_skill_levels(this_object());
+}
+
+// Move skills restored from an old save file into the skill table
+void restore_skills() {
+    string name;
+    int level;
+
+    if (!skills) {
+        return;
+    }
+
+    foreach (name, level in skills) {
+        set_skill(name, level);
+    }
+    skills = 0;
 }
 
 // =============================================================================
@@ -960,12 +1023,12 @@ void start_combat(object target) {
 
     attacker = target;
     in_combat = 1;
+    set_attacking(target);
 
     // Make target fight back if they're not in combat,
     // or if their current opponent is not in the same room (stale combat)
-    target_current_attacker = call_other(target, "query_attacker");
-    if (!call_other(target, "query_in_combat") ||
-        !target_current_attacker ||
+    target_current_attacker = query_attacking(target);
+    if (!target_current_attacker ||
         environment(target_current_attacker) != environment(target)) {
         call_other(target, "start_combat", this_object());
     }
@@ -973,31 +1036,12 @@ void start_combat(object target) {
 
 // Find another hostile creature attacking us in the same room
 object find_next_attacker() {
-    object *contents;
-    object room;
-    int i;
+    object *attackers;
 
-    room = environment(this_object());
-    if (!room) {
-        return 0;
-    }
-
-    contents = all_inventory(room);
-    for (i = 0; i < sizeof(contents); i++) {
-        object other;
-        other = contents[i];
-
-        // Skip self
-        if (other == this_object()) {
-            continue;
-        }
-
-        // Check if it's a living that's attacking us
-        if (call_other(other, "is_living") &&
-            call_other(other, "query_in_combat") &&
-            call_other(other, "query_attacker") == this_object()) {
-            return other;
-        }
+    // The driver tracks who is fighting whom
+    attackers = query_attackers(this_object());
+    if (sizeof(attackers)) {
+        return attackers[0];
     }
 
     return 0;
@@ -1013,11 +1057,13 @@ void stop_combat() {
     if (next) {
         // Switch to the next attacker
         attacker = next;
+        set_attacking(next);
         // Stay in combat, keep heartbeat
     } else {
         // No more attackers, end combat
         in_combat = 0;
         attacker = 0;
+        set_attacking(0);
     }
 }
 
@@ -1038,6 +1084,8 @@ int receive_damage(int amount, object from) {
     }
 
     hp = hp - actual;
+    note_health();
+    emit("damage", actual, from);
 
     if (hp <= 0) {
         hp = 0;
@@ -1047,6 +1095,7 @@ int receive_damage(int amount, object from) {
         // is_dying flag prevents double-death if attacker also checks.
         if (!is_dying) {
             is_dying = 1;
+            emit("death", from);
             call_out("die", 0);
         }
     } else {
@@ -1133,16 +1182,8 @@ void do_attack() {
 
         // Tell room (excluding combatants)
         if (room) {
-            object *others;
-            int i;
-            others = all_inventory(room);
-            for (i = 0; i < sizeof(others); i++) {
-                if (others[i] != this_object() && others[i] != attacker) {
-                    if (call_other(others[i], "is_living")) {
-                        tell_object(others[i], capitalize(my_name) + " hits " + target_name + ".\n");
-                    }
-                }
-            }
+            tell_room_tmpl(room, "$N hits " + target_name + ".\n", my_name, 0,
+                ({ this_object(), attacker }));
         }
         // Death is handled by receive_damage() - no need to check here
     } else {
@@ -1161,16 +1202,8 @@ void do_attack() {
 
         // Tell room
         if (room) {
-            object *others;
-            int i;
-            others = all_inventory(room);
-            for (i = 0; i < sizeof(others); i++) {
-                if (others[i] != this_object() && others[i] != attacker) {
-                    if (call_other(others[i], "is_living")) {
-                        tell_object(others[i], capitalize(my_name) + " misses " + target_name + ".\n");
-                    }
-                }
-            }
+            tell_room_tmpl(room, "$N misses " + target_name + ".\n", my_name, 0,
+                ({ this_object(), attacker }));
         }
     }
 }
@@ -1179,35 +1212,20 @@ void do_attack() {
 // Handles combat rounds and regeneration
 void heart_beat() {
     int bonus_regen;
-    int was_drunk;
+    int beats;
+
+    // Beats this call stands for: 1, plus any slept through in an empty room
+    beats = 1 + query_dormant_elapsed() / 2;
 
     // If in combat, execute an attack
     if (in_combat && attacker) {
         do_attack();
-        // Still process sobering while fighting
-        if (intoxication > 0) {
-            intoxication = intoxication - 2;
-            if (intoxication < 0) intoxication = 0;
-        }
+        send_vitals();
         return;
     }
 
-    // Track if we were drunk before sobering
-    was_drunk = intoxication;
-
-    // Sober up over time (2 points per heartbeat = ~1 minute to sober from one drink)
-    if (intoxication > 0) {
-        intoxication = intoxication - 2;
-        if (intoxication <= 0) {
-            intoxication = 0;
-            if (was_drunk > 0) {
-                tell_object(this_object(), "You feel sober again.\n");
-            }
-        }
-    }
-
     // Calculate bonus regen from intoxication (intoxication/10)
-    bonus_regen = intoxication / 10;
+    bonus_regen = query_intoxication() / 10;
 
     // Not in combat - regenerate HP and mana
     int hp_full;
@@ -1221,10 +1239,11 @@ void heart_beat() {
         int total_regen;
         total_regen = regen_rate + bonus_regen;
 
-        hp = hp + total_regen;
+        hp = hp + total_regen * beats;
         if (hp > max_hp) {
             hp = max_hp;
         }
+        note_health();
 
         // Notify player of healing (only when fully healed)
         if (hp >= max_hp) {
@@ -1237,7 +1256,7 @@ void heart_beat() {
         int mana_regen;
         mana_regen = query_mana_regen();
 
-        mana = mana + mana_regen;
+        mana = mana + mana_regen * beats;
         if (mana > max_mana) {
             mana = max_mana;
         }
@@ -1247,6 +1266,39 @@ void heart_beat() {
             tell_object(this_object(), "Your mana is fully restored.\n");
         }
     }
+
+    send_vitals();
+}
+
+// Send a GMCP client the vitals that changed since it last heard (Char.Vitals),
+// so it can keep its HP and mana bars current without polling "hp"
+void send_vitals() {
+    mapping now;
+    mapping changed;
+    string name;
+    int value;
+
+    if (!has_gmcp(this_object())) {
+        if (vitals_sent) vitals_sent = 0;
+        return;
+    }
+
+    now = ([ "hp": hp, "maxhp": max_hp, "mana": mana, "maxmana": max_mana ]);
+    if (!vitals_sent) {
+        changed = now;
+    } else {
+        changed = ([]);
+        foreach (name, value in now) {
+            if (vitals_sent[name] != value) {
+                changed = changed + ([ name: value ]);
+            }
+        }
+    }
+
+    if (sizeof(changed)) {
+        send_gmcp(this_object(), "Char.Vitals", changed);
+        vitals_sent = now;
+    }
 }
 
 // Virtual die function - override in subclasses
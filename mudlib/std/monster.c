@@ -5,6 +5,7 @@ inherit "/std/living";
 
 string monster_name;
 int aggressive;
+object watched_room;  // the room whose "enter" events we hear, while aggressive
 string *drop_items;
 int drop_chance;  // Percentage chance to drop (default 100)
 
@@ -15,6 +16,9 @@ void create() {
     aggressive = 0;
     drop_items = ({});
     drop_chance = 100;
+
+    // Asleep until something happens to it (see watch_room())
+    set_heart_beat(0);
 }
 
 // Add an item that this monster drops on death
@@ -54,6 +58,7 @@ string query_name() {
 
 void set_name(string n) {
     monster_name = n;
+    description_changed();
 }
 
 // Override id() to also match monster name
@@ -73,8 +78,10 @@ int query_aggressive() {
     return aggressive;
 }
 
+// Starts (or stops) listening to the room at once, not at the next move
 void set_aggressive(int val) {
     aggressive = val;
+    watch_room();
 }
 
 // Monsters don't advance skills - they're static
@@ -92,43 +99,65 @@ void try_dodge_advancement(int difficulty) {
     // Do nothing
 }
 
-// Called when something enters the monster's environment
-// or when the monster enters an environment
-void init() {
-    object player;
-
-    ::init();
-
-    player = this_player();
-
-    // If aggressive, attack any player that enters
-    if (aggressive) {
-        if (player && player != this_object()) {
-            // Check if player is a living and not already fighting
-            if (call_other(player, "is_living") && !query_in_combat()) {
-                // Announce aggression
-                tell_object(player, capitalize(query_short()) + " attacks you!\n");
-
-                // Tell the room
-                object room;
-                room = environment(this_object());
-                if (room) {
-                    object *others;
-                    int i;
-                    others = all_inventory(room);
-                    for (i = 0; i < sizeof(others); i++) {
-                        if (others[i] != player && others[i] != this_object()) {
-                            if (call_other(others[i], "is_living")) {
-                                tell_object(others[i], capitalize(query_short()) + " attacks " + call_other(player, "query_name") + "!\n");
-                            }
-                        }
-                    }
-                }
-
-                // Start combat
-                start_combat(player);
+// Aggressive monsters hear who walks into their room through the room's
+// "enter" event, and follow their own moves ("move") to keep listening to
+// the right room. Nothing else in the room is called, and a monster with
+// no one to fight has no heartbeat.
+void watch_room() {
+    object room;
+
+    room = aggressive ? environment(this_object()) : 0;
+    if (room == watched_room) return;
+
+    if (watched_room) unsubscribe(watched_room, "enter");
+    watched_room = room;
+    if (room) subscribe(room, "enter", "arrived");
+}
+
+void moved(object self, object from, object to) {
+    watch_room();
+}
+
+// Something entered our room: attack it if it is a player
+void arrived(object room, object player, object from) {
+    if (!aggressive || player == this_object()) return;
+
+    // Only players (since room spawns): monsters spawned together, NPCs and
+    // pets are left alone
+    if (call_other(player, "is_player") && !query_in_combat()) {
+        // Announce aggression
+        tell_object(player, capitalize(query_short()) + " attacks you!\n");
+
+        // Tell the room
+        object *others;
+        int i;
+        others = all_livings(room);
+        for (i = 0; i < sizeof(others); i++) {
+            if (others[i] != player && others[i] != this_object()) {
+                tell_object(others[i], capitalize(query_short()) + " attacks " + call_other(player, "query_name") + "!\n");
             }
         }
+
+        // Start combat
+        start_combat(player);
+    }
+}
+
+// Woken by a fight or a wound; heart_beat() sleeps again once both are over
+void start_combat(object target) {
+    set_heart_beat(1);
+    ::start_combat(target);
+}
+
+int receive_damage(int amount, object from) {
+    set_heart_beat(1);
+    return ::receive_damage(amount, from);
+}
+
+void heart_beat() {
+    ::heart_beat();
+    if (!query_in_combat() && query_hp() >= query_max_hp() && query_mana() >= query_max_mana()) {
+        set_heart_beat(0);
     }
 }
 
@@ -184,4 +213,8 @@ void reset() {
     if (sizeof(all_inventory(this_object())) == 0) {
         setup_drops();
     }
+
+    // Follow our own moves; watch_room() decides what to listen to
+    subscribe(this_object(), "move", "moved");
+    watch_room();
 }
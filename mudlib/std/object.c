@@ -13,6 +13,14 @@ void create() {
     short_desc = "something";
     long_desc = "";
     mass = 1;
+    declare_ids();
+}
+
+// declare_ids() - Tell the driver what id() below matches, so present()
+// can find this object without calling it. Subclasses that override id()
+// are still asked through id().
+void declare_ids() {
+    set_ids(ids, short_desc);
 }
 
 // set_name() - Set the primary name of this object
@@ -24,6 +32,8 @@ void set_name(string str) {
     if (member(ids, name) < 0) {
         ids = ({ name }) + ids;
     }
+    declare_ids();
+    description_changed();
 }
 
 // query_name() - Get the primary name
@@ -39,6 +49,7 @@ void add_id(string str) {
     if (member(ids, str) < 0) {
         ids = ids + ({ str });
     }
+    declare_ids();
 }
 
 // query_ids() - Get all identifiers for this object
@@ -58,6 +69,8 @@ string query_short() {
 
 void set_short(string desc) {
     short_desc = desc;
+    declare_ids();
+    description_changed();
 }
 
 string query_long() {
@@ -66,6 +79,7 @@ string query_long() {
 
 void set_long(string desc) {
     long_desc = desc;
+    description_changed();
 }
 
 int query_mass() {
@@ -150,8 +164,6 @@ string format_msg(string msg, object actor) {
 //
 varargs void act(object actor, string actor_msg, string others_msg, object room) {
     object target_room;
-    object *contents;
-    int i;
 
     if (!actor) return;
 
@@ -167,17 +179,10 @@ varargs void act(object actor, string actor_msg, string others_msg, object room)
         tell_object(actor, actor_msg + "\n");
     }
 
-    // Send formatted message to others in room
+    // Send formatted message to others in room; the driver fills in $N
+    // and friends for each player there
     if (others_msg && others_msg != "" && target_room) {
-        string formatted;
-        formatted = format_msg(others_msg, actor);
-
-        contents = all_inventory(target_room);
-        for (i = 0; i < sizeof(contents); i++) {
-            if (contents[i] != actor && call_other(contents[i], "is_living")) {
-                tell_object(contents[i], formatted + "\n");
-            }
-        }
+        tell_room_tmpl(target_room, others_msg + "\n", actor, 0, actor);
     }
 }
 
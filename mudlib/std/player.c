@@ -19,6 +19,9 @@ string saved_location;      // Room path for login location
 int chat_enabled;           // Legacy: 1 = receive chat messages, 0 = opted out
 mapping chat_subscriptions; // Channel subscriptions: channel_name -> 1/0
 
+// Color: "" to go by what the client reports, else a set_color() mode
+string color_mode;
+
 void create() {
     ::create();
     set_short("a player");
@@ -33,6 +36,7 @@ void create() {
     saved_location = "";
     chat_enabled = 1;  // Legacy: chat on by default
     chat_subscriptions = ([]);  // Empty = default subscriptions
+    color_mode = "";
 }
 
 // Identify as a player (not a monster)
@@ -66,10 +70,30 @@ void set_cwd(string path) { cwd = path; }
 string query_saved_location() { return saved_location; }
 void set_saved_location(string path) { saved_location = path; }
 
+// Color mode, applied to each new connection at login
+string query_color_mode() { return color_mode; }
+void set_color_mode(string mode) {
+    color_mode = mode == "auto" ? "" : mode;
+    set_color(this_object(), mode);
+}
+
 // Chat preferences
 // Legacy single-channel support
 int query_chat_enabled() { return chat_enabled; }
-void set_chat_enabled(int val) { chat_enabled = val; }
+void set_chat_enabled(int val) {
+    chat_enabled = val;
+    refresh_chat();
+}
+
+// Tell the chat daemon (if loaded) to recheck which channels we hear
+void refresh_chat() {
+    object chat;
+
+    chat = find_object("/secure/daemon/chat");
+    if (chat) {
+        call_other(chat, "refresh_player", this_object());
+    }
+}
 
 // Multi-channel subscription system
 mapping query_chat_subscriptions() { return chat_subscriptions; }
@@ -83,14 +107,15 @@ void set_chat_subscription(string channel, int enabled) {
     if (channel == "chat") {
         chat_enabled = enabled;
     }
+    refresh_chat();
 }
 
 // Check if subscribed to a specific channel
 // Returns 1 if subscribed, 0 if not
 // Defaults to 1 (subscribed) if not explicitly set
 int query_chat_subscription(string channel) {
-    // Check if channel key exists in mapping (member returns index or -1)
-    if (member(chat_subscriptions, channel) != -1) {
+    // Check if channel key exists in mapping (member returns 1 or 0)
+    if (member(chat_subscriptions, channel)) {
         return chat_subscriptions[channel];
     }
     // Legacy fallback for "chat" channel
@@ -172,6 +197,7 @@ int is_guild_member(string guild_path) {
 void add_guild(string guild_path) {
     if (!is_guild_member(guild_path)) {
         guilds = guilds + ({ guild_path });
+        refresh_chat();
     }
 }
 
@@ -186,6 +212,7 @@ void remove_guild(string guild_path) {
         }
     }
     guilds = new_guilds;
+    refresh_chat();
 }
 
 // Save player data to file
@@ -257,7 +284,7 @@ void refresh_guild_skills() {
     string *guild_skills;
 
     // Clear current allowed skills and rebuild from guilds
-    allowed_skills = ({});
+    clear_allowed_skills();
 
     if (!guilds) {
         return;
@@ -291,11 +318,23 @@ int restore_player() {
 
     path = "/secure/players/" + lower_case(player_name);
     result = restore_object(path);
+    declare_ids();
+    restore_skills();
 
     // Clear live equipment references first
     wielded_weapon = 0;
     worn_armor = ([]);
 
+    // Spell armor ended with the session that cast it
+    armor_bonuses = ([]);
+
+    // This connection's client hasn't been sent any vitals yet
+    vitals_sent = 0;
+
+    if (color_mode && color_mode != "") {
+        set_color(this_object(), color_mode);
+    }
+
     // Refresh skills from guilds (picks up any guild changes)
     refresh_guild_skills();
 
@@ -326,6 +365,9 @@ int restore_player() {
         }
     }
 
+    // Join the chat channels this player listens to
+    refresh_chat();
+
     return result;
 }
 
@@ -351,6 +393,7 @@ void die() {
     // Stop combat
     in_combat = 0;
     attacker = 0;
+    set_attacking(0);
 
     // Create a corpse at the death location
     if (death_location) {
@@ -10,21 +10,6 @@ string long_desc;
 // Monster spawning
 string *spawn_monsters;
 
-// Exits - each direction stores a destination path or empty string
-string exit_north;
-string exit_south;
-string exit_east;
-string exit_west;
-string exit_northeast;
-string exit_northwest;
-string exit_southeast;
-string exit_southwest;
-string exit_up;
-string exit_down;
-
-// Hidden exits - stores the hidden direction (simple for now)
-string hidden_exit_dir;
-
 void create() {
     ::create();
     set_short("A room");
@@ -32,20 +17,6 @@ void create() {
 
     // Initialize monster spawns
     spawn_monsters = ({});
-
-    // Initialize all exits to empty
-    exit_north = "";
-    exit_south = "";
-    exit_east = "";
-    exit_west = "";
-    exit_northeast = "";
-    exit_northwest = "";
-    exit_southeast = "";
-    exit_southwest = "";
-    exit_up = "";
-    exit_down = "";
-
-    hidden_exit_dir = "";
 }
 
 // Identify this as a room
@@ -56,178 +27,90 @@ int is_room() {
 // Set the long description
 void set_long(string desc) {
     long_desc = desc;
+    description_changed();
 }
 
 string query_long() {
     return long_desc;
 }
 
+// Exits live in the driver's exit table for this room (set_exit()), so
+// any direction works and movement doesn't need to call into the room.
+// Short directions ("n", "sw", "u") mean the same as their long names.
+
 // Add an exit in a direction
 void add_exit(string direction, string destination) {
-    if (direction == "n") { exit_north = destination; return; }
-    if (direction == "north") { exit_north = destination; return; }
-    if (direction == "s") { exit_south = destination; return; }
-    if (direction == "south") { exit_south = destination; return; }
-    if (direction == "e") { exit_east = destination; return; }
-    if (direction == "east") { exit_east = destination; return; }
-    if (direction == "w") { exit_west = destination; return; }
-    if (direction == "west") { exit_west = destination; return; }
-    if (direction == "ne") { exit_northeast = destination; return; }
-    if (direction == "northeast") { exit_northeast = destination; return; }
-    if (direction == "nw") { exit_northwest = destination; return; }
-    if (direction == "northwest") { exit_northwest = destination; return; }
-    if (direction == "se") { exit_southeast = destination; return; }
-    if (direction == "southeast") { exit_southeast = destination; return; }
-    if (direction == "sw") { exit_southwest = destination; return; }
-    if (direction == "southwest") { exit_southwest = destination; return; }
-    if (direction == "u") { exit_up = destination; return; }
-    if (direction == "up") { exit_up = destination; return; }
-    if (direction == "d") { exit_down = destination; return; }
-    if (direction == "down") { exit_down = destination; return; }
+    set_exit(direction, destination);
 }
 
 // Add a hidden exit
 void add_hidden_exit(string direction, string destination) {
-    add_exit(direction, destination);
-    hidden_exit_dir = direction;
+    set_exit(direction, destination, 1);
+}
+
+// Remove an exit
+void remove_exit(string direction) {
+    set_exit(direction, 0);
 }
 
 // Check if a direction is a hidden exit
 int is_hidden_exit(string direction) {
-    // Normalize short forms to long forms
-    if (direction == "n") direction = "north";
-    if (direction == "s") direction = "south";
-    if (direction == "e") direction = "east";
-    if (direction == "w") direction = "west";
-    if (direction == "ne") direction = "northeast";
-    if (direction == "nw") direction = "northwest";
-    if (direction == "se") direction = "southeast";
-    if (direction == "sw") direction = "southwest";
-    if (direction == "u") direction = "up";
-    if (direction == "d") direction = "down";
-
-    return hidden_exit_dir == direction;
+    return exit_is_hidden(this_object(), direction);
 }
 
 // Query an exit destination
 string query_exit(string direction) {
-    if (direction == "n") { return exit_north; }
-    if (direction == "north") { return exit_north; }
-    if (direction == "s") { return exit_south; }
-    if (direction == "south") { return exit_south; }
-    if (direction == "e") { return exit_east; }
-    if (direction == "east") { return exit_east; }
-    if (direction == "w") { return exit_west; }
-    if (direction == "west") { return exit_west; }
-    if (direction == "ne") { return exit_northeast; }
-    if (direction == "northeast") { return exit_northeast; }
-    if (direction == "nw") { return exit_northwest; }
-    if (direction == "northwest") { return exit_northwest; }
-    if (direction == "se") { return exit_southeast; }
-    if (direction == "southeast") { return exit_southeast; }
-    if (direction == "sw") { return exit_southwest; }
-    if (direction == "southwest") { return exit_southwest; }
-    if (direction == "u") { return exit_up; }
-    if (direction == "up") { return exit_up; }
-    if (direction == "d") { return exit_down; }
-    if (direction == "down") { return exit_down; }
-    return "";
+    string path;
+
+    path = exit_path(this_object(), direction);
+    if (path == 0) {
+        return "";
+    }
+    return path;
 }
 
 // Get the obvious exits line for display
 string query_exits() {
-    string result;
-    int count;
-
-    result = "";
-    count = 0;
-
-    if (exit_north != "") {
-        if (hidden_exit_dir != "north") {
-            if (count > 0) { result = result + ", "; }
-            result = result + "north";
-            count = count + 1;
-        }
-    }
-    if (exit_south != "") {
-        if (hidden_exit_dir != "south") {
-            if (count > 0) { result = result + ", "; }
-            result = result + "south";
-            count = count + 1;
-        }
-    }
-    if (exit_east != "") {
-        if (hidden_exit_dir != "east") {
-            if (count > 0) { result = result + ", "; }
-            result = result + "east";
-            count = count + 1;
-        }
-    }
-    if (exit_west != "") {
-        if (hidden_exit_dir != "west") {
-            if (count > 0) { result = result + ", "; }
-            result = result + "west";
-            count = count + 1;
-        }
-    }
-    if (exit_northeast != "") {
-        if (hidden_exit_dir != "northeast") {
-            if (count > 0) { result = result + ", "; }
-            result = result + "northeast";
-            count = count + 1;
-        }
-    }
-    if (exit_northwest != "") {
-        if (hidden_exit_dir != "northwest") {
-            if (count > 0) { result = result + ", "; }
-            result = result + "northwest";
-            count = count + 1;
-        }
-    }
-    if (exit_southeast != "") {
-        if (hidden_exit_dir != "southeast") {
-            if (count > 0) { result = result + ", "; }
-            result = result + "southeast";
-            count = count + 1;
-        }
-    }
-    if (exit_southwest != "") {
-        if (hidden_exit_dir != "southwest") {
-            if (count > 0) { result = result + ", "; }
-            result = result + "southwest";
-            count = count + 1;
-        }
-    }
-    if (exit_up != "") {
-        if (hidden_exit_dir != "up") {
-            if (count > 0) { result = result + ", "; }
-            result = result + "up";
-            count = count + 1;
-        }
-    }
-    if (exit_down != "") {
-        if (hidden_exit_dir != "down") {
-            if (count > 0) { result = result + ", "; }
-            result = result + "down";
-            count = count + 1;
-        }
-    }
+    string *dirs;
 
-    if (count == 0) {
+    dirs = exit_dirs(this_object());
+    if (sizeof(dirs) == 0) {
         return "There are no obvious exits.";
     }
 
-    return "Obvious exits: " + result;
+    return "Obvious exits: " + implode(dirs, ", ");
+}
+
+// How many times path appears in the spawn list
+int spawn_count(string path) {
+    int i;
+    int n;
+
+    for (i = 0; i < sizeof(spawn_monsters); i++) {
+        if (spawn_monsters[i] == path) {
+            n++;
+        }
+    }
+    return n;
 }
 
-// Add a monster type to spawn in this room
+// Add a monster type to spawn in this room; adding it twice keeps two
 void add_spawn(string monster_path) {
     spawn_monsters = spawn_monsters + ({ monster_path });
+    set_spawn(monster_path, spawn_count(monster_path));
 }
 
 // Set multiple monster spawns at once
 void set_spawns(string *monsters) {
+    int i;
+
+    for (i = 0; i < sizeof(spawn_monsters); i++) {
+        set_spawn(spawn_monsters[i], 0);
+    }
     spawn_monsters = monsters;
+    for (i = 0; i < sizeof(spawn_monsters); i++) {
+        set_spawn(spawn_monsters[i], spawn_count(spawn_monsters[i]));
+    }
 }
 
 // Query what monsters spawn here
@@ -244,7 +127,7 @@ void enable_reset(int interval) {
     }
     set_reset(interval);
     // Spawn monsters immediately - add_spawn() must be called before this!
-    reset();
+    respawn(1);
 }
 
 // Check if a monster of the given type already exists in the room
@@ -263,18 +146,21 @@ int has_monster(string path) {
     return 0;
 }
 
-// Reset is called periodically to respawn monsters
-void reset() {
-    int i;
-    object mob;
-
-    // Spawn any missing monsters
-    for (i = 0; i < sizeof(spawn_monsters); i++) {
-        if (!has_monster(spawn_monsters[i])) {
-            mob = clone_object(spawn_monsters[i]);
-            if (mob) {
-                move_object(mob, this_object());
-            }
-        }
+// Called by the driver when the room has gone unused for a while.
+// Unloading takes the contents too; the next visit loads the room afresh
+// and create() respawns its monsters.
+int clean_up(int inherited) {
+    // Rooms other rooms inherit from stay loaded, and needn't be asked again
+    if (inherited) {
+        return 0;
     }
+    destruct(this_object());
+    return 1;
+}
+
+// Reset is called periodically to respawn monsters. The driver knows
+// which of this room's monsters are still alive and clones the missing
+// ones over the next few ticks.
+void reset() {
+    respawn();
 }
@@ -0,0 +1,62 @@
+namespace Driver.Benchmarks;
+
+/// <summary>
+/// A throwaway mudlib in the temp directory for benchmarks that need their
+/// own LPC, and the path of the real one for those that measure it.
+/// </summary>
+public sealed class BenchMudlib : IDisposable
+{
+    public string Path { get; }
+
+    public BenchMudlib(string name)
+    {
+        Path = System.IO.Path.Combine(System.IO.Path.GetTempPath(), $"mudlib_bench_{name}_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path);
+    }
+
+    /// <summary>
+    /// Write an LPC file; path is mudlib-relative ("/std/thing.c").
+    /// </summary>
+    public BenchMudlib Write(string path, string source)
+    {
+        var fullPath = System.IO.Path.Combine(Path, path.TrimStart('/'));
+        Directory.CreateDirectory(System.IO.Path.GetDirectoryName(fullPath)!);
+        File.WriteAllText(fullPath, source);
+        return this;
+    }
+
+    /// <summary>
+    /// An object manager over this mudlib with its interpreter ready.
+    /// </summary>
+    public ObjectManager CreateManager()
+    {
+        var objectManager = new ObjectManager(Path);
+        objectManager.InitializeInterpreter(TextWriter.Null);
+        return objectManager;
+    }
+
+    /// <summary>
+    /// The repository's mudlib: MUDLIB_PATH if set, else the nearest
+    /// "mudlib" directory above the working directory.
+    /// </summary>
+    public static string FindRealMudlib()
+    {
+        var fromEnvironment = Environment.GetEnvironmentVariable("MUDLIB_PATH");
+        if (!string.IsNullOrEmpty(fromEnvironment)) return fromEnvironment;
+
+        for (var dir = new DirectoryInfo(Directory.GetCurrentDirectory()); dir != null; dir = dir.Parent)
+        {
+            var candidate = System.IO.Path.Combine(dir.FullName, "mudlib");
+            if (Directory.Exists(System.IO.Path.Combine(candidate, "std"))) return candidate;
+        }
+        throw new DirectoryNotFoundException("Set MUDLIB_PATH to the mudlib to benchmark");
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(Path))
+        {
+            Directory.Delete(Path, recursive: true);
+        }
+    }
+}
@@ -0,0 +1,21 @@
+using BenchmarkDotNet.Configs;
+using BenchmarkDotNet.Diagnosers;
+using BenchmarkDotNet.Exporters;
+using BenchmarkDotNet.Exporters.Json;
+
+namespace Driver.Benchmarks;
+
+/// <summary>
+/// Settings shared by every benchmark: allocations are measured, and results
+/// are written as full JSON (one file per benchmark class) alongside the
+/// markdown summary, so runs can be compared by a script.
+/// </summary>
+public class BenchmarkConfig : ManualConfig
+{
+    public BenchmarkConfig()
+    {
+        AddDiagnoser(MemoryDiagnoser.Default);
+        AddExporter(JsonExporter.Full);
+        AddExporter(MarkdownExporter.GitHub);
+    }
+}
@@ -0,0 +1,85 @@
+using BenchmarkDotNet.Attributes;
+
+namespace Driver.Benchmarks;
+
+/// <summary>
+/// LPC function-call overhead and expression evaluation on each engine.
+/// Each benchmark runs a loop inside LPC, so the figure is per iteration
+/// rather than per call from C#.
+/// </summary>
+public class CallBenchmarks
+{
+    private const int Iterations = 10_000;
+
+    public enum Engine { TreeWalker, Vm, Jit }
+
+    [Params(Engine.TreeWalker, Engine.Vm, Engine.Jit)]
+    public Engine Mode { get; set; }
+
+    private BenchMudlib _mudlib = null!;
+    private ObjectInterpreter _interpreter = null!;
+    private MudObject _bench = null!;
+    private readonly List<object> _args = new() { (long)Iterations };
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        _mudlib = new BenchMudlib("calls").Write("/bench/calls.c", @"
+int noop(int x) { return x; }
+
+int calls(int n) {
+    int i;
+    for (i = 0; i < n; i++) {
+        noop(i);
+    }
+    return n;
+}
+
+int arithmetic(int n) {
+    int i;
+    int hp = 100;
+    int total;
+    for (i = 0; i < n; i++) {
+        total += (hp * 3 + i % 7 - (i / 3)) & 1023;
+        if (total > 100000) total -= 100000;
+    }
+    return total;
+}
+
+int strings(int n) {
+    int i;
+    string line;
+    int total;
+    for (i = 0; i < n; i++) {
+        line = ""The goblin hits you for "" + i + "" damage ("" + (i % 10) + "" left)."";
+        total += strlen(line);
+    }
+    return total;
+}
+");
+        var objectManager = _mudlib.CreateManager();
+        _interpreter = objectManager.Interpreter!;
+        _interpreter.LimitsEnabled = false;
+        _interpreter.UseBytecode = Mode != Engine.TreeWalker;
+        _interpreter.UseJit = Mode == Engine.Jit;
+        _interpreter.JitThreshold = 1;
+        _bench = objectManager.LoadObject("/bench/calls");
+
+        // Warm every function up to its tier before measuring
+        Calls();
+        Arithmetic();
+        Strings();
+    }
+
+    [GlobalCleanup]
+    public void Cleanup() => _mudlib.Dispose();
+
+    [Benchmark(OperationsPerInvoke = Iterations)]
+    public object Calls() => _interpreter.CallFunctionOnObject(_bench, "calls", _args)!;
+
+    [Benchmark(OperationsPerInvoke = Iterations)]
+    public object Arithmetic() => _interpreter.CallFunctionOnObject(_bench, "arithmetic", _args)!;
+
+    [Benchmark(OperationsPerInvoke = Iterations)]
+    public object Strings() => _interpreter.CallFunctionOnObject(_bench, "strings", _args)!;
+}
@@ -0,0 +1,33 @@
+using BenchmarkDotNet.Attributes;
+
+namespace Driver.Benchmarks;
+
+/// <summary>
+/// Compiling the real mudlib from source (preprocess, parse, optimize,
+/// lower to bytecode), as a cold boot with no program cache does.
+/// </summary>
+public class CompileBenchmarks
+{
+    private string _mudlibPath = null!;
+
+    /// <summary>
+    /// Worker threads for Precompile: 1 is the serial cost, 0 uses every core.
+    /// </summary>
+    [Params(1, 0)]
+    public int Parallelism { get; set; }
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        _mudlibPath = BenchMudlib.FindRealMudlib();
+    }
+
+    [Benchmark]
+    public int CompileMudlib()
+    {
+        var objectManager = new ObjectManager(_mudlibPath);
+        objectManager.InitializeInterpreter(TextWriter.Null);
+        var report = objectManager.Precompile("/", Parallelism);
+        return report.Compiled;
+    }
+}
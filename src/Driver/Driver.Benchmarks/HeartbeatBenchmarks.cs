@@ -0,0 +1,63 @@
+using BenchmarkDotNet.Attributes;
+
+namespace Driver.Benchmarks;
+
+/// <summary>
+/// The game loop's heartbeat phase with N living clones. One operation is a
+/// full heartbeat cycle, in which every living beats once.
+/// </summary>
+public class HeartbeatBenchmarks
+{
+    [Params(100, 1000, 5000)]
+    public int Livings { get; set; }
+
+    private BenchMudlib _mudlib = null!;
+    private GameLoop _gameLoop = null!;
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        _mudlib = new BenchMudlib("heartbeat").Write("/bench/living.c", @"
+int hp = 50;
+int max_hp = 100;
+int sp = 10;
+int ticks;
+
+void heart_beat() {
+    ticks++;
+    if (hp < max_hp) {
+        hp += 1 + max_hp / 50;
+        if (hp > max_hp) hp = max_hp;
+    }
+    if (ticks % 10 == 0 && sp < 100) sp++;
+    if (hp >= max_hp) hp = 50;
+}
+");
+        var objectManager = _mudlib.CreateManager();
+        var interpreter = objectManager.Interpreter!;
+        interpreter.LimitsEnabled = false;
+        _gameLoop = new GameLoop(objectManager, new AccountManager(_mudlib.Path));
+        _gameLoop.InitializeInterpreter(interpreter);
+
+        for (int i = 0; i < Livings; i++)
+        {
+            _gameLoop.RegisterHeartbeat(objectManager.CloneObject("/bench/living"));
+        }
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        _gameLoop.Stop();
+        _mudlib.Dispose();
+    }
+
+    [Benchmark]
+    public void HeartbeatCycle()
+    {
+        for (int tick = 0; tick < GameLoop.HeartbeatIntervalTicks; tick++)
+        {
+            _gameLoop.ProcessHeartbeats();
+        }
+    }
+}
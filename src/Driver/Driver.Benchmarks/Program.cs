@@ -0,0 +1,7 @@
+using BenchmarkDotNet.Running;
+using Driver.Benchmarks;
+
+// Driver benchmarks. Run in Release:
+//   dotnet run -c Release --project src/Driver/Driver.Benchmarks -- --filter '*'
+// Results (including JSON for tracking over time) go to BenchmarkDotNet.Artifacts/results.
+BenchmarkSwitcher.FromAssembly(typeof(BenchmarkConfig).Assembly).Run(args, new BenchmarkConfig());
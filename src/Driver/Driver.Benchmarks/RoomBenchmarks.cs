@@ -0,0 +1,70 @@
+using BenchmarkDotNet.Attributes;
+
+namespace Driver.Benchmarks;
+
+/// <summary>
+/// Lookups that scan a room's contents: present() by id and collecting the
+/// add_action()s a command could match, in rooms of growing size.
+/// </summary>
+public class RoomBenchmarks
+{
+    [Params(10, 100, 1000)]
+    public int Crowd { get; set; }
+
+    private BenchMudlib _mudlib = null!;
+    private ObjectInterpreter _interpreter = null!;
+    private GameLoop _gameLoop = null!;
+    private MudObject _room = null!;
+    private MudObject _player = null!;
+    private MudObject _finder = null!;
+    private List<object> _findLast = null!;
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        _mudlib = new BenchMudlib("room")
+            .Write("/bench/room.c", "void create() { }\n")
+            .Write("/bench/player.c", "int id(string s) { return s == \"testplayer\"; }\n")
+            .Write("/bench/thing.c", @"
+string name;
+void set_name(string s) { name = s; }
+int id(string s) { return s == name; }
+int do_poke(string arg) { return 0; }
+")
+            .Write("/bench/finder.c", "object find(string name, object where) { return present(name, where); }\n");
+
+        var objectManager = _mudlib.CreateManager();
+        _interpreter = objectManager.Interpreter!;
+        _interpreter.LimitsEnabled = false;
+        _gameLoop = new GameLoop(objectManager, new AccountManager(_mudlib.Path));
+        _gameLoop.InitializeInterpreter(_interpreter);
+
+        _room = objectManager.LoadObject("/bench/room");
+        _finder = objectManager.LoadObject("/bench/finder");
+        for (int i = 0; i < Crowd; i++)
+        {
+            var thing = objectManager.CloneObject("/bench/thing");
+            _interpreter.CallFunctionOnObject(thing, "set_name", new List<object> { $"thing{i}" });
+            thing.AddAction("do_poke", "poke");
+            thing.MoveTo(_room);
+        }
+        _player = objectManager.CloneObject("/bench/player");
+        _player.MoveTo(_room);
+
+        // The worst case: the match is the last thing in the room
+        _findLast = new List<object> { $"thing{Crowd - 1}", _room };
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        _gameLoop.Stop();
+        _mudlib.Dispose();
+    }
+
+    [Benchmark]
+    public object Present() => _interpreter.CallFunctionOnObject(_finder, "find", _findLast)!;
+
+    [Benchmark]
+    public int CollectActions() => _gameLoop.CollectActions(_player, "poke").Count;
+}
@@ -0,0 +1,65 @@
+using BenchmarkDotNet.Attributes;
+
+namespace Driver.Benchmarks;
+
+/// <summary>
+/// save_object()/restore_object() of a large player-like file: a few
+/// hundred skills, an inventory list and nested quest data.
+/// </summary>
+public class SaveBenchmarks
+{
+    private BenchMudlib _mudlib = null!;
+    private ObjectInterpreter _interpreter = null!;
+    private MudObject _player = null!;
+    private readonly List<object> _none = new();
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        _mudlib = new BenchMudlib("save").Write("/bench/player.c", @"
+string name;
+int level;
+mapping skills;
+string *inventory;
+mapping quests;
+
+void fill() {
+    int i;
+    name = ""testplayer"";
+    level = 42;
+    skills = ([ ]);
+    inventory = ({ });
+    quests = ([ ]);
+    for (i = 0; i < 500; i++) {
+        skills[""skill_"" + i] = i * 7;
+    }
+    for (i = 0; i < 200; i++) {
+        inventory += ({ ""/world/items/thing_"" + i });
+    }
+    for (i = 0; i < 50; i++) {
+        quests[""quest_"" + i] = ([ ""stage"": i % 5, ""notes"": ({ ""started"", ""met the king"" }) ]);
+    }
+}
+
+int save() { return save_object(""/data/bench_player""); }
+int restore() { return restore_object(""/data/bench_player""); }
+");
+        Directory.CreateDirectory(Path.Combine(_mudlib.Path, "data"));
+
+        var objectManager = _mudlib.CreateManager();
+        _interpreter = objectManager.Interpreter!;
+        _interpreter.LimitsEnabled = false;
+        _player = objectManager.LoadObject("/bench/player");
+        _interpreter.CallFunctionOnObject(_player, "fill", _none);
+        _interpreter.CallFunctionOnObject(_player, "save", _none);
+    }
+
+    [GlobalCleanup]
+    public void Cleanup() => _mudlib.Dispose();
+
+    [Benchmark]
+    public object Save() => _interpreter.CallFunctionOnObject(_player, "save", _none)!;
+
+    [Benchmark]
+    public object Restore() => _interpreter.CallFunctionOnObject(_player, "restore", _none)!;
+}
@@ -16,6 +16,7 @@ public class AccountManagerTests : IDisposable
 
     public void Dispose()
     {
+        _accountManager.Flush();
         if (Directory.Exists(_testPath))
         {
             try
@@ -280,4 +281,26 @@ public class AccountManagerTests : IDisposable
         var homePath = _accountManager.GetWizardHomePath("testuser");
         Assert.True(Directory.Exists(homePath));
     }
+
+    [Fact]
+    public void Accounts_AreCachedAndWrittenThrough()
+    {
+        _accountManager.CreateAccount("cachetest", "cache@test.com", "password123");
+        _accountManager.Flush();
+        var path = Path.Combine(_testPath, "secure", "accounts", "cachetest.json");
+        Assert.True(File.Exists(path));
+
+        // Reads come from memory once loaded, so a changed file isn't reread
+        File.WriteAllText(path, "{}");
+        Assert.True(_accountManager.ValidateCredentials("cachetest", "password123"));
+
+        // Changes reach the disk in the same JSON shape as before
+        _accountManager.UpdateLastLogin("cachetest");
+        _accountManager.SetAccessLevel("cachetest", AccessLevel.Wizard);
+        _accountManager.Flush();
+        var reloaded = new AccountManager(_testPath);
+        Assert.Equal(AccessLevel.Wizard, reloaded.GetAccessLevel("cachetest"));
+        Assert.True(reloaded.ValidateCredentials("cachetest", "password123"));
+        Assert.Contains("\"LoginCount\": 2", File.ReadAllText(path));
+    }
 }
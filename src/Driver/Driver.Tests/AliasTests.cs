@@ -16,6 +16,7 @@ public class AliasTests : IDisposable
 
     public void Dispose()
     {
+        _accountManager.Flush();
         if (Directory.Exists(_testPath))
         {
             try
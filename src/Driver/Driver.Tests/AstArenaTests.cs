@@ -0,0 +1,95 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class AstArenaTests
+{
+    private const string Source = @"
+int counter;
+mapping table;
+
+varargs mixed everything(int n, string s) {
+    int i;
+    string *names;
+    names = ({ ""a"", ""b"" });
+    table = ([ ""x"": 1, ""y"": ({ 2, 3 }) ]);
+    for (i = 0; i < n; i++) {
+        if (i == 1) continue;
+        counter += i * -2;
+    }
+    foreach (s in names) counter++;
+    switch (counter) {
+        case 2: counter = counter ? 1 : 0; break;
+        default: counter = -1;
+    }
+    while (n-- > 0) names[0] = s[1..2] + ::query_name();
+    catch(this_object()->missing(table[""x""]));
+    return sizeof(names) + counter + 123456789012;
+}
+";
+
+    private static byte[] Serialize(List<Statement> statements)
+    {
+        var stream = new MemoryStream();
+        using (var writer = new BinaryWriter(stream))
+        {
+            AstSerializer.WriteStatements(writer, statements);
+        }
+        return stream.ToArray();
+    }
+
+    [Fact]
+    public void PackedBodies_ReadBackAsTheSameTree()
+    {
+        var statements = new Parser(new Lexer(Source)).ParseProgram();
+        var before = Serialize(statements);
+        var function = statements.OfType<FunctionDefinition>().Single();
+        int bodyLine = function.Body.Line;
+
+        AstArena.Pack(new[] { function });
+
+        Assert.True(function.IsPacked);
+        Assert.Equal(bodyLine, function.BodyLine);
+        Assert.IsType<BlockStatement>(function.ReadBody());
+        Assert.True(function.IsPacked);
+
+        // Serializing reads Body, which unpacks it for good
+        Assert.Equal(before, Serialize(statements));
+        Assert.False(function.IsPacked);
+    }
+
+    [Fact]
+    public void LoadedPrograms_RunFromPackedBodies()
+    {
+        var tempDir = Path.Combine(Path.GetTempPath(), $"ast_arena_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(tempDir);
+        try
+        {
+            var om = new ObjectManager(tempDir);
+            om.InitializeInterpreter();
+            var obj = om.LoadSource("/test/packed", @"
+int twice(int n) { return n * 2; }
+int fail(int n) {
+    return n / 0;
+}
+");
+            var interpreter = om.Interpreter!;
+            Assert.All(obj.Program.Functions.Values, function => Assert.True(function.IsPacked));
+
+            Assert.Equal(42L, interpreter.CallFunctionOnObject(obj, "twice", new List<object> { 21L }));
+            var error = Assert.Throws<ObjectInterpreterException>(() =>
+                interpreter.CallFunctionOnObject(obj, "fail", new List<object> { 1L }));
+            Assert.Contains("Division by zero", error.Message);
+            Assert.True(obj.Program.Functions["twice"].IsPacked);
+
+            // Without bytecode the tree walker unpacks what it runs
+            interpreter.UseBytecode = false;
+            Assert.Equal(8L, interpreter.CallFunctionOnObject(obj, "twice", new List<object> { 4L }));
+            Assert.False(obj.Program.Functions["twice"].IsPacked);
+        }
+        finally
+        {
+            Directory.Delete(tempDir, true);
+        }
+    }
+}
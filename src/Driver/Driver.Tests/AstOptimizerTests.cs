@@ -0,0 +1,126 @@
+namespace Driver.Tests;
+
+public class AstOptimizerTests
+{
+    /// <summary>
+    /// Parse and optimize a program, returning the body of its first function.
+    /// </summary>
+    private static List<Statement> OptimizeBody(string source)
+    {
+        var statements = AstOptimizer.Optimize(new Parser(new Lexer(source)).ParseProgram());
+        var func = Assert.IsType<FunctionDefinition>(statements.First(s => s is FunctionDefinition));
+        return Assert.IsType<BlockStatement>(func.Body).Statements;
+    }
+
+    private static Expression ReturnedExpression(string source)
+    {
+        var ret = Assert.IsType<ReturnStatement>(OptimizeBody(source).Last());
+        return ret.Value!;
+    }
+
+    [Fact]
+    public void FoldsIntArithmetic()
+    {
+        var num = Assert.IsType<NumberLiteral>(ReturnedExpression("int f() { return 60 * 60 * 24; }"));
+        Assert.Equal(86400L, num.Value);
+    }
+
+    [Fact]
+    public void FoldsStringConcatenation()
+    {
+        var str = Assert.IsType<StringLiteral>(ReturnedExpression("string f() { return \"foo\" + \"bar\" + 3; }"));
+        Assert.Equal("foobar3", str.Value);
+    }
+
+    [Fact]
+    public void FoldsGroupedAndUnary()
+    {
+        var num = Assert.IsType<NumberLiteral>(ReturnedExpression("int f() { return -(2 + 3) * ~0 + !\"\"; }"));
+        Assert.Equal(6L, num.Value);
+    }
+
+    [Fact]
+    public void FoldedLiteralKeepsLine()
+    {
+        var expr = ReturnedExpression("int f() {\n\n    return 1 + 2;\n}");
+        Assert.Equal(3, expr.Line);
+    }
+
+    [Fact]
+    public void LeavesDivisionByZeroForRunTime()
+    {
+        var bin = Assert.IsType<BinaryOp>(ReturnedExpression("int f() { return 1 / 0; }"));
+        Assert.Equal(BinaryOperator.Divide, bin.Operator);
+    }
+
+    [Fact]
+    public void LeavesNonConstantOperandsAlone()
+    {
+        var bin = Assert.IsType<BinaryOp>(ReturnedExpression("int f(int x) { return x + 2 * 3; }"));
+        Assert.IsType<Identifier>(bin.Left);
+        Assert.Equal(6L, Assert.IsType<NumberLiteral>(bin.Right).Value);
+    }
+
+    [Fact]
+    public void ConstantLeftSideShortCircuits()
+    {
+        var num = Assert.IsType<NumberLiteral>(ReturnedExpression("int f(int x) { return 0 && x; }"));
+        Assert.Equal(0L, num.Value);
+
+        num = Assert.IsType<NumberLiteral>(ReturnedExpression("int f(int x) { return 5 || x; }"));
+        Assert.Equal(1L, num.Value);
+
+        // The right side still decides, and must be normalized to 0/1 at run time
+        Assert.IsType<BinaryOp>(ReturnedExpression("int f(int x) { return 1 && x; }"));
+    }
+
+    [Fact]
+    public void DropsDeadIfBranch()
+    {
+        var body = OptimizeBody("void f() { if (0) { write(\"a\"); } else { write(\"b\"); } }");
+
+        var block = Assert.IsType<BlockStatement>(Assert.Single(body));
+        var stmt = Assert.IsType<ExpressionStatement>(Assert.Single(block.Statements));
+        var call = Assert.IsType<FunctionCall>(stmt.Expression);
+        Assert.Equal("b", Assert.IsType<StringLiteral>(call.Arguments[0]).Value);
+    }
+
+    [Fact]
+    public void DropsFalseLoopAndTernary()
+    {
+        var body = OptimizeBody("int f() { while (0) { write(\"x\"); } return 1 ? 7 : 8; }");
+
+        Assert.Empty(Assert.IsType<BlockStatement>(body[0]).Statements);
+        Assert.Equal(7L, Assert.IsType<NumberLiteral>(Assert.IsType<ReturnStatement>(body[1]).Value).Value);
+    }
+
+    [Fact]
+    public void KeepsDeadBranchThatDeclaresLocal()
+    {
+        var body = OptimizeBody("void f() { if (0) { int x; } }");
+
+        Assert.IsType<IfStatement>(Assert.Single(body));
+    }
+
+    [Fact]
+    public void DropsStatementsAfterReturn()
+    {
+        var body = OptimizeBody("int f() { return 1; write(\"never\"); }");
+
+        Assert.IsType<ReturnStatement>(Assert.Single(body));
+    }
+
+    [Fact]
+    public void FoldsCaseLabelsAndVariableInitializers()
+    {
+        var statements = AstOptimizer.Optimize(new Parser(new Lexer(
+            "int limit = 10 * 10;\nint f(int x) { switch (x) { case 2 * 3: return 1; } return 0; }")).ParseProgram());
+
+        var decl = Assert.IsType<VariableDeclaration>(statements[0]);
+        Assert.Equal(100L, Assert.IsType<NumberLiteral>(decl.Initializer).Value);
+
+        var func = Assert.IsType<FunctionDefinition>(statements[1]);
+        var sw = Assert.IsType<SwitchStatement>(Assert.IsType<BlockStatement>(func.Body).Statements[0]);
+        Assert.Equal(6L, Assert.IsType<NumberLiteral>(sw.Cases[0].Value).Value);
+    }
+}
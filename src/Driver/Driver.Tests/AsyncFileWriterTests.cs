@@ -0,0 +1,142 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class AsyncFileWriterTests : IDisposable
+{
+    private readonly string _mudlibPath;
+
+    public AsyncFileWriterTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_asyncio_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "secure", "accounts"));
+    }
+
+    public void Dispose()
+    {
+        AsyncFileWriter.Shared.Flush();
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private static void WaitUntil(Func<bool> condition)
+    {
+        var deadline = DateTime.UtcNow.AddSeconds(5);
+        while (!condition() && DateTime.UtcNow < deadline)
+        {
+            Thread.Sleep(10);
+        }
+    }
+
+    [Fact]
+    public void Writes_RunInOrderAndCreateDirectories()
+    {
+        var writer = new AsyncFileWriter();
+        var path = Path.Combine(_mudlibPath, "data", "log.txt");
+        var results = new List<bool>();
+
+        writer.Write(path, "old", append: false, ok => { lock (results) results.Add(ok); });
+        writer.Write(path, "a", append: false, ok => { lock (results) results.Add(ok); });
+        writer.Write(path, "b", append: true, ok => { lock (results) results.Add(ok); });
+        writer.Write(path, "c", append: true);
+        string? read = null;
+        writer.Read(path, text => read = text);
+        writer.Write(path, "d", append: true);
+        writer.Flush();
+
+        Assert.Equal("abcd", File.ReadAllText(path));
+        Assert.False(File.Exists(path + ".tmp"));
+        Assert.Equal("abc", read);
+        Assert.Equal(new[] { true, true, true }, results.ToArray());
+        Assert.Equal(0, writer.PendingCount);
+    }
+
+    [Fact]
+    public void Read_OfAMissingFileGivesNull()
+    {
+        var writer = new AsyncFileWriter();
+        string? read = "unset";
+        bool done = false;
+
+        writer.Read(Path.Combine(_mudlibPath, "nothing.txt"), text => { read = text; done = true; });
+        writer.Flush();
+
+        Assert.True(done);
+        Assert.Null(read);
+    }
+
+    [Fact]
+    public void SaveObject_IsWrittenBehindAndRestoreSeesIt()
+    {
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "saver.c"), @"
+int gold;
+void set_gold(int n) { gold = n; }
+int query_gold() { return gold; }
+int save(string path) { return save_object(path); }
+int load(string path) { return restore_object(path); }
+");
+        var objectManager = new ObjectManager(_mudlibPath);
+        objectManager.InitializeInterpreter();
+        var interpreter = objectManager.Interpreter!;
+
+        var saver = objectManager.CloneObject("/std/saver");
+        var loader = objectManager.CloneObject("/std/saver");
+        interpreter.CallFunctionOnObject(saver, "set_gold", new List<object> { 42L });
+        for (int i = 0; i < 20; i++)
+        {
+            Assert.Equal(1L, Convert.ToInt64(interpreter.CallFunctionOnObject(saver, "save", new List<object> { "/data/test_saver" })));
+        }
+
+        Assert.Equal(1L, Convert.ToInt64(interpreter.CallFunctionOnObject(loader, "load", new List<object> { "/data/test_saver" })));
+        Assert.Equal(42L, Convert.ToInt64(interpreter.CallFunctionOnObject(loader, "query_gold", new List<object>())));
+    }
+
+    [Fact]
+    public void WriteFileAsync_DeliversItsCallbackAsACallOut()
+    {
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "scribe.c"), @"
+string done_path;
+int done_ok;
+string contents;
+
+void start() {
+    write_file_async(""/data/notes.txt"", ""hello"", 0, ""wrote"");
+}
+void wrote(string path, int ok) {
+    done_path = path;
+    done_ok = ok;
+    read_file_async(path, ""got"");
+}
+void got(string path, string text) { contents = text; }
+
+string query_path() { return done_path; }
+int query_ok() { return done_ok; }
+string query_contents() { return contents; }
+");
+        var objectManager = new ObjectManager(_mudlibPath);
+        objectManager.InitializeInterpreter();
+        var gameLoop = new GameLoop(objectManager, new AccountManager(_mudlibPath));
+        gameLoop.InitializeInterpreter(new ObjectInterpreter(objectManager));
+        var scribe = objectManager.CloneObject("/std/scribe");
+
+        gameLoop.Start();
+        try
+        {
+            objectManager.Interpreter!.CallFunctionOnObject(scribe, "start", new List<object>());
+
+            object? Query(string function) => objectManager.Interpreter!.CallFunctionOnObject(scribe, function, new List<object>());
+            WaitUntil(() => Query("query_contents") is string);
+
+            Assert.Equal("/data/notes.txt", Query("query_path"));
+            Assert.Equal(1L, Convert.ToInt64(Query("query_ok")));
+            Assert.Equal("hello", Query("query_contents"));
+        }
+        finally
+        {
+            gameLoop.Stop();
+        }
+    }
+}
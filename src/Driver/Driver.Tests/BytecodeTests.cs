@@ -0,0 +1,939 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+/// <summary>
+/// Tests for the bytecode compiler and VM.
+/// Most tests run the same function on the VM and on the tree walker and
+/// check both give the same answer.
+/// </summary>
+public class BytecodeTests : IDisposable
+{
+    private readonly string _testMudlibPath;
+    private readonly ObjectManager _objectManager;
+    private readonly ObjectInterpreter _interpreter;
+
+    public BytecodeTests()
+    {
+        _testMudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_bytecode_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_testMudlibPath, "std"));
+        Directory.CreateDirectory(Path.Combine(_testMudlibPath, "test"));
+
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "base.c"), @"
+int base_value;
+
+void create() {
+    base_value = 10;
+}
+
+int describe(int x) {
+    return x * 2;
+}
+");
+
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "other.c"), @"
+int describe(int x) {
+    return x * 100;
+}
+");
+
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "vm.c"), @"
+inherit ""/std/base"";
+
+int counter;
+mapping data;
+int hp;
+
+int describe(int x) {
+    return ::describe(x) + 1;
+}
+
+int loops() {
+    int i;
+    int total = 0;
+    for (i = 0; i < 10; i++) {
+        if (i == 3) continue;
+        if (i == 8) break;
+        total += i;
+    }
+    while (total > 20) {
+        total--;
+    }
+    return total;
+}
+
+string switcher(int n) {
+    string out = """";
+    switch (n) {
+        case 1:
+            out += ""one"";
+        case 2:
+            out += ""two"";
+            break;
+        default:
+            out += ""other"";
+        case 3:
+            out += ""three"";
+    }
+    return out;
+}
+
+string verb(mixed v) {
+    switch (v) {
+        case ""look"": return ""L"";
+        case ""get"": case ""take"": return ""G"";
+        case 1000000: return ""big"";
+        case -7: return ""neg"";
+        case ""look"": return ""dup"";
+    }
+    return ""none"";
+}
+
+int dynamic_case(int n, int m) {
+    switch (n) {
+        case 1: return 10;
+        case m: return 20;
+        default: return 30;
+    }
+}
+
+int sum_foreach(mixed *arr) {
+    int total;
+    foreach (x in arr) {
+        if (x < 0) continue;
+        if (x > 100) break;
+        total += x;
+    }
+    return total;
+}
+
+mixed logic(int a, int b) {
+    return ({ a && b, a || b, !a, a ? ""yes"" : ""no"", -a, ~b });
+}
+
+mixed collections() {
+    mixed *arr = ({ 1, 2, 3, 4, 5 });
+    mapping m = ([ ""a"": 1, ""b"": 2 ]);
+    m[""c""] = 3;
+    arr[0] = 9;
+    return ({ arr[1..3], arr[..1], ""hello""[1..], m[""c""], arr[0], arr + ({ 6 }) });
+}
+
+mixed errors() {
+    mixed a = catch(throw(""boom""));
+    mixed b = catch(1 + 1);
+    mixed c = catch(undefined_function());
+    return ({ a, b, c });
+}
+
+int parse(string s) {
+    int n;
+    string word;
+    if (sscanf(s, ""%s %d"", word, n) == 2) {
+        return n;
+    }
+    return -1;
+}
+
+int bump() {
+    counter++;
+    ++counter;
+    counter += base_value;
+    return counter--;
+}
+
+int calls() {
+    return describe(4) + this_object()->describe(1);
+}
+
+int fib(int n) {
+    if (n < 2) return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+int shadow() {
+    int before = counter;
+    int counter = 100;
+    counter++;
+    return before + counter;
+}
+
+mixed early(mixed *arr) {
+    foreach (x in arr) {
+        while (1) {
+            if (x > 2) return x;
+            break;
+        }
+    }
+    return ""none"";
+}
+
+int accumulate(int n) {
+    int i;
+    int total;
+    for (i = 0; i < n; i++) {
+        total += i * 3;
+        counter = total;
+    }
+    return total;
+}
+
+mixed ask_all(mixed *targets) {
+    mixed *out = ({ });
+    foreach (t in targets) {
+        out = out + ({ t->describe(1), call_other(t, ""describe"", 2) });
+    }
+    return out;
+}
+
+int stray() {
+    break;
+}
+
+string chain(int n, string s) {
+    return s + n + 1 + "" "" + (n + 1) + "":"" + s;
+}
+
+mixed chain_mixed(int n, string s) {
+    return n + 1 + s + n + s;
+}
+
+mixed *chain_arrays() {
+    return ({ 1 }) + ({ 2 }) + ({ 3, 4 });
+}
+
+string table(string name, int hp) {
+    return sprintf(""%-8s|%5d|%03x|%O%%|%s"", name, hp, hp, ({ name }));
+}
+
+int remainder(int n, int m) { return n % m; }
+int twice(int n) { return n * 2; }
+int by_length(string a, string b) { return strlen(a) - strlen(b); }
+
+mixed *callbacks() {
+    return ({
+        filter_array(({ 1, 2, 3, 4, 5 }), ""remainder"", 2),
+        map_array(({ 1, 2, 3 }), ""twice""),
+        sort_array(({ ""ccc"", ""a"", ""bb"", ""d"" }), ""by_length""),
+        sort_array(({ 3, 1, 2 }), -1),
+        sort_array(({ ""b"", ""a"", 2, 1 }))
+    });
+}
+
+string dynamic_format(int width) {
+    return sprintf(""["" + ""%"" + width + ""s]"", ""ab"");
+}
+
+int typed(int a, int b) {
+    int total = a + b + 1;
+    total += a;
+    if (total < 100 && total != 7) return total - b;
+    return hp >= total;
+}
+
+mixed typed_lies(int a) {
+    int s = ""x"";
+    s += a;
+    return ({ s, a + 1, a == 1, a != 0 });
+}
+
+string split(string s) {
+    sscanf(s, ""%s=%s"", key, value);
+    return key + "":"" + value;
+}
+
+mixed *foreach_ranges(mixed *arr, string str, int from, int to) {
+    mixed *seen;
+    seen = ({ });
+    foreach (x in arr[from..to]) {
+        seen = seen + ({ x });
+    }
+    foreach (x in arr[from..]) {
+        seen = seen + ({ x });
+    }
+    foreach (c in str[..to]) {
+        seen = seen + ({ c });
+    }
+    foreach (c in str) {
+        seen = seen + ({ c });
+    }
+    return seen;
+}
+
+mixed *foreach_pairs(mapping m) {
+    mixed *seen;
+    seen = ({ });
+    foreach (k, v in m) {
+        if (v == 0) continue;
+        if (k == ""stop"") break;
+        seen = seen + ({ k, v });
+    }
+    return seen;
+}
+
+int foreach_pairs_array(mixed *arr) {
+    foreach (k, v in arr) return 1;
+    return 0;
+}
+
+mixed *scan_forms(string s, string dynamic) {
+    string a;
+    string b;
+    int n;
+    int m;
+    mixed *out;
+    out = ({ sscanf(s, ""%s with %s"", a, b), a, b });
+    a = 0;
+    b = 0;
+    out = out + ({ sscanf(s, ""%d/%d"", n, m), n, m });
+    out = out + ({ sscanf(s, ""get %s"", a), a });
+    out = out + ({ sscanf(s, ""%*s %d"", n), n });
+    out = out + ({ sscanf(s, ""%s%d"", b, m), b, m });
+    out = out + ({ sscanf(s, dynamic, a, b), a, b });
+    return out;
+}
+
+mixed *appends(int n) {
+    mixed *built;
+    mixed *kept;
+    mixed *seen;
+    mapping m;
+    int i;
+    built = ({ });
+    seen = ({ });
+    m = ([ ]);
+    for (i = 0; i < n; i++) {
+        built += ({ i });
+        if (i == 1) kept = built;
+        m = m + ([ i: built[i] ]);
+    }
+    foreach (i in built) {
+        built = built + ({ i * 10 });
+        seen += ({ i });
+    }
+    built -= ({ 0 });
+    return ({ built, kept, seen, m });
+}
+
+mixed *shared_append() {
+    mixed *a;
+    mixed *b;
+    a = ({ 1 });
+    a += ({ 2 });
+    b = a;
+    a += ({ 3 });
+    b += a;
+    return ({ a, b, grow(a), a });
+}
+
+mixed *grow(mixed *arr) {
+    arr += ({ 99 });
+    return arr;
+}
+");
+
+        _objectManager = new ObjectManager(_testMudlibPath);
+        _objectManager.InitializeInterpreter();
+        _interpreter = _objectManager.Interpreter!;
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_testMudlibPath))
+        {
+            Directory.Delete(_testMudlibPath, recursive: true);
+        }
+    }
+
+    private object? Call(string function, params object[] args)
+    {
+        var obj = _objectManager.LoadObject("/test/vm");
+        _interpreter.ResetInstructionCount();
+        return _interpreter.CallFunctionOnObject(obj, function, args.ToList());
+    }
+
+    /// <summary>
+    /// Run a function on the tree walker, the VM and the JIT and check they agree.
+    /// </summary>
+    private object? CallBoth(string function, params object[] args)
+    {
+        _interpreter.UseBytecode = false;
+        var treeResult = Call(function, args);
+        _interpreter.UseBytecode = true;
+        _interpreter.UseJit = false;
+        var vmResult = Call(function, args);
+        _interpreter.UseJit = true;
+        _interpreter.JitThreshold = 1;
+        var jitResult = Call(function, args);
+
+        Assert.Equal(Describe(treeResult), Describe(vmResult));
+        Assert.Equal(Describe(vmResult), Describe(jitResult));
+        return vmResult;
+    }
+
+    private static string Describe(object? value) => value switch
+    {
+        List<object> list => "({" + string.Join(",", list.Select(Describe)) + "})",
+        Dictionary<object, object> map => "([" + string.Join(",", map.Select(kv => $"{Describe(kv.Key)}:{Describe(kv.Value)}")) + "])",
+        string s => $"\"{s}\"",
+        null => "null",
+        _ => Convert.ToInt64(value).ToString()
+    };
+
+    [Fact]
+    public void Compile_LowersProgramFunctions()
+    {
+        var obj = _objectManager.LoadObject("/test/vm");
+
+        Assert.Contains("loops", obj.Program.CompiledFunctions);
+        Assert.Contains("switcher", obj.Program.CompiledFunctions);
+        Assert.Contains("errors", obj.Program.CompiledFunctions);
+        Assert.Same(obj.Program.Functions["fib"], obj.Program.CompiledFunctions["fib"].Definition);
+    }
+
+    [Fact]
+    public void Disassemble_ListsInstructions()
+    {
+        var obj = _objectManager.LoadObject("/test/vm");
+        var listing = obj.Program.CompiledFunctions["fib"].Disassemble();
+
+        Assert.Contains("fib(n)", listing);
+        Assert.Contains("Call", listing);
+        Assert.Contains("Return", listing);
+    }
+
+    [Fact]
+    public void AddChain_CompilesToOneConcat()
+    {
+        var obj = _objectManager.LoadObject("/test/vm");
+        var listing = obj.Program.CompiledFunctions["chain"].Disassemble();
+
+        Assert.Contains($"{OpCode.Concat,-16}7", listing);
+        Assert.Equal("x31 4:x", CallBoth("chain", 3L, "x"));
+        CallBoth("chain_mixed", 3L, "x");
+        Assert.Equal("({1,2,3,4})", Describe(CallBoth("chain_arrays")));
+    }
+
+    [Fact]
+    public void Sprintf_LiteralFormatsArePrecompiled()
+    {
+        var obj = _objectManager.LoadObject("/test/vm");
+        var table = obj.Program.CompiledFunctions["table"];
+
+        Assert.True(SprintfFormat.IsPrecompiled(table.Constants.OfType<string>().First()));
+        Assert.Equal("Testbob |   42|02a|({ \"Testbob\" })%|", CallBoth("table", "Testbob", 42L));
+        Assert.Equal("[   ab]", CallBoth("dynamic_format", 5L));
+        Assert.Equal("[ab]", CallBoth("dynamic_format", 1L));
+    }
+
+    [Fact]
+    public void ArrayCallbacks_FilterMapAndSort()
+    {
+        Assert.Equal("({({1,3,5}),({2,4,6}),({\"a\",\"d\",\"bb\",\"ccc\"}),({3,2,1}),({1,2,\"a\",\"b\"})})",
+            Describe(CallBoth("callbacks")));
+    }
+
+    [Fact]
+    public void AppendLocal_GrowsUnsharedLocalsInPlace()
+    {
+        var obj = _objectManager.LoadObject("/test/vm");
+        var listing = obj.Program.CompiledFunctions["appends"].Disassemble();
+
+        Assert.Contains("AppendLocal", listing);
+        Assert.Contains(" release", listing);
+        Assert.Equal("({({1,2,3,10,20,30}),({0,1}),({0,1,2,3}),([0:0,1:1,2:2,3:3])})",
+            Describe(CallBoth("appends", 4L)));
+    }
+
+    [Fact]
+    public void AppendLocal_CopiesOnceAValueIsShared()
+    {
+        // b and the caller's a keep what they were given; grow() copies its argument
+        Assert.Equal("({({1,2,3}),({1,2,1,2,3}),({1,2,3,99}),({1,2,3})})",
+            Describe(CallBoth("shared_append")));
+    }
+
+    [Fact]
+    public void Locals_ResolveToSlots()
+    {
+        var obj = _objectManager.LoadObject("/test/vm");
+        var fib = obj.Program.CompiledFunctions["fib"];
+
+        Assert.Equal(new[] { "n" }, fib.LocalNames);
+        Assert.Contains("LoadLocal", fib.Disassemble());
+        Assert.DoesNotContain("LoadGlobal", fib.Disassemble());
+    }
+
+    [Fact]
+    public void Locals_ShadowObjectVariableAfterDeclaration()
+    {
+        var obj = _objectManager.LoadObject("/test/vm");
+        obj.SetVariable("counter", 5L);
+
+        // 'before' reads the object variable; the local takes over once declared
+        Assert.Equal(106L, CallBoth("shadow"));
+        Assert.Equal(5L, obj.GetVariable("counter"));
+    }
+
+    [Fact]
+    public void Sscanf_CreatesLocalsForUndeclaredTargets()
+    {
+        Assert.Equal("name:value", CallBoth("split", "name=value"));
+    }
+
+    [Fact]
+    public void Loops_BreakAndContinue()
+    {
+        Assert.Equal(20L, CallBoth("loops"));
+    }
+
+    [Fact]
+    public void Switch_FallsThroughAndDefaults()
+    {
+        Assert.Equal("onetwo", CallBoth("switcher", 1L));
+        Assert.Equal("two", CallBoth("switcher", 2L));
+        Assert.Equal("three", CallBoth("switcher", 3L));
+        Assert.Equal("otherthree", CallBoth("switcher", 7L));
+    }
+
+    [Fact]
+    public void Switch_LiteralLabelsUseTable()
+    {
+        var obj = _objectManager.LoadObject("/test/vm");
+        Assert.Contains(OpCode.Switch + " ", obj.Program.CompiledFunctions["verb"].Disassemble());
+        Assert.DoesNotContain(OpCode.Switch + " ", obj.Program.CompiledFunctions["dynamic_case"].Disassemble());
+
+        Assert.Equal("L", CallBoth("verb", "look"));
+        Assert.Equal("G", CallBoth("verb", "take"));
+        Assert.Equal("big", CallBoth("verb", 1000000L));
+        Assert.Equal("neg", CallBoth("verb", -7L));
+        Assert.Equal("none", CallBoth("verb", "1000000"));
+        Assert.Equal("none", CallBoth("verb", new List<object>()));
+
+        Assert.Equal(10L, CallBoth("dynamic_case", 1L, 5L));
+        Assert.Equal(20L, CallBoth("dynamic_case", 5L, 5L));
+        Assert.Equal(30L, CallBoth("dynamic_case", 6L, 5L));
+    }
+
+    [Fact]
+    public void Foreach_BreakAndContinue()
+    {
+        var arr = new List<object> { 1L, -5L, 2L, 200L, 3L };
+        Assert.Equal(3L, CallBoth("sum_foreach", arr));
+    }
+
+    [Fact]
+    public void Foreach_WalksRangesAndStringsInPlace()
+    {
+        var arr = new List<object> { 1L, 2L, 3L, 4L };
+        var seen = Assert.IsType<List<object>>(CallBoth("foreach_ranges", arr, "héy", 1L, -2L));
+        Assert.Equal(new List<object> { 2L, 3L, 2L, 3L, 4L, "h", "é", "h", "é", "y" }, seen);
+
+        // Empty and backwards ranges visit nothing
+        seen = Assert.IsType<List<object>>(CallBoth("foreach_ranges", arr, "", 3L, 1L));
+        Assert.Equal(new List<object> { 4L }, seen);
+    }
+
+    [Fact]
+    public void Foreach_WalksMappingKeysAndValues()
+    {
+        var m = new LpcMapping { ["a"] = 1L, ["b"] = 0L, ["c"] = "x", ["stop"] = 2L, ["d"] = 3L };
+        Assert.Equal("({\"a\",1,\"c\",\"x\"})", Describe(CallBoth("foreach_pairs", m)));
+
+        var obj = _objectManager.LoadObject("/test/vm");
+        Assert.Contains("IterValue", obj.Program.CompiledFunctions["foreach_pairs"].Disassemble());
+        var error = Assert.Throws<ObjectInterpreterException>(() => Call("foreach_pairs_array", new List<object>()));
+        Assert.Contains("foreach with two variables needs a mapping", error.Message);
+    }
+
+    [Fact]
+    public void Operators_MatchTreeWalker()
+    {
+        CallBoth("logic", 1L, 0L);
+        CallBoth("logic", 0L, 5L);
+    }
+
+    [Fact]
+    public void Collections_IndexRangeAndAssignment()
+    {
+        var result = Assert.IsType<List<object>>(CallBoth("collections"));
+        Assert.Equal(9L, result[4]);
+        Assert.Equal(3L, result[3]);
+    }
+
+    [Fact]
+    public void Catch_ReturnsErrorOrZero()
+    {
+        var result = Assert.IsType<List<object>>(CallBoth("errors"));
+        Assert.Equal("boom", result[0]);
+        Assert.Equal(0L, result[1]);
+        Assert.Contains("undefined_function", (string)result[2]);
+    }
+
+    [Fact]
+    public void Sscanf_AssignsLocals()
+    {
+        // %d produces an int, not a long
+        Assert.Equal(42L, Convert.ToInt64(CallBoth("parse", "answer 42")));
+        Assert.Equal(-1L, CallBoth("parse", "nonsense"));
+    }
+
+    [Fact]
+    public void Sscanf_FormatPlansMatchLikeTheFormat()
+    {
+        Assert.Equal("({2,\"sword\",\"shield\",0,0,0,0,0,0,0,1,\"sword with shield\",0,2,\"sword\",\"shield\"})",
+            Describe(CallBoth("scan_forms", "sword with shield", "%s %*s %s")));
+        Assert.Equal("({1,\"3/4\",\"\",2,3,4,0,0,0,3,2,\"\",3,2,\"3\",\"4\"})",
+            Describe(CallBoth("scan_forms", "3/4", "%s/%s")));
+        Assert.Equal("({1,\"get lamp 2\",\"\",0,0,0,1,\"lamp 2\",0,0,2,\"get lamp \",2,1,\"get lamp 2\",\"get lamp \"})",
+            Describe(CallBoth("scan_forms", "get lamp 2", "%s")));
+        Assert.Equal("({1,\"x -5\",\"\",0,0,0,0,0,1,-5,2,\"x -\",5,1,\"x\",\"x -\"})",
+            Describe(CallBoth("scan_forms", "x -5", "%s%")));
+
+        var plan = SscanfFormat.Get("%d apples and %s");
+        Assert.Same(plan, SscanfFormat.Get("%d apples" + " and %s"));
+        var values = new object?[plan.Captures];
+        Assert.Equal(2, plan.Match("12 apples and pears", values));
+        Assert.Equal(12, values[0]);
+        Assert.Equal("pears", values[1]);
+        Assert.Equal(1, plan.Match("12 pears", values));
+    }
+
+    [Fact]
+    public void IncrementAndCompound_UpdateObjectVariables()
+    {
+        _interpreter.UseBytecode = true;
+        var obj = _objectManager.LoadObject("/test/vm");
+
+        Assert.Equal(12L, Call("bump"));
+        Assert.Equal(11L, obj.GetVariable("counter"));
+    }
+
+    [Fact]
+    public void Calls_ParentLocalAndArrow()
+    {
+        Assert.Equal(12L, CallBoth("calls"));
+    }
+
+    [Fact]
+    public void Recursion_Works()
+    {
+        Assert.Equal(55L, CallBoth("fib", 10L));
+    }
+
+    [Fact]
+    public void Return_LeavesNestedLoops()
+    {
+        Assert.Equal(5L, CallBoth("early", new List<object> { 1L, 5L, 7L }));
+        Assert.Equal("none", CallBoth("early", new List<object> { 1L }));
+    }
+
+    [Theory]
+    [InlineData(false)]
+    [InlineData(true)]
+    public void Break_OutsideLoop_IsRuntimeError(bool useBytecode)
+    {
+        _interpreter.UseBytecode = useBytecode;
+
+        var ex = Assert.Throws<LpcRuntimeException>(() => Call("stray"));
+        Assert.Contains("'break' outside of a loop", ex.Message);
+        Assert.Equal(151, ex.Line);
+    }
+
+    [Fact]
+    public void IntegerLoop_DoesNotAllocatePerIteration()
+    {
+        _interpreter.UseBytecode = true;
+        Call("accumulate", 10L); // warm up
+
+        var before = GC.GetAllocatedBytesForCurrentThread();
+        var result = Call("accumulate", 10_000L);
+        var allocated = GC.GetAllocatedBytesForCurrentThread() - before;
+
+        Assert.Equal(149_985_000L, result);
+        // Boxing each intermediate would be hundreds of KB; only call setup should allocate
+        Assert.True(allocated < 16_384, $"allocated {allocated} bytes");
+    }
+
+    [Fact]
+    public void CallSites_CacheEachTargetProgram()
+    {
+        _interpreter.UseBytecode = true;
+        var vm = _objectManager.LoadObject("/test/vm");
+        var other = _objectManager.LoadObject("/test/other");
+
+        var result = Call("ask_all", new List<object> { vm, other, vm });
+        Assert.Equal("({3,5,100,200,3,5})", Describe(result));
+
+        var fn = vm.Program.CompiledFunctions["ask_all"];
+        var arrowPc = Array.FindIndex(fn.Code, ins => ins.Op == OpCode.CallArrow);
+        var callOtherPc = Array.FindIndex(fn.Code, ins => ins.Op == OpCode.CallOther);
+        Assert.Equal(2, fn.GetCallSite(arrowPc).Count);
+        Assert.Equal(2, fn.GetCallSite(callOtherPc).Count);
+    }
+
+    [Fact]
+    public void EfunCalls_BindAtCompileTime_UnlessTheObjectDefinesTheName()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "measure.c"), @"
+int measure(mixed x) { return sizeof(x) * 100 + strlen(""ab"") * 10 + abs(-3) + intp(x) + stringp(x); }
+string kind(mixed x) { return typeof(x); }
+");
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "measuring.c"), @"
+inherit ""/std/measure"";
+int strlen(string s) { return 5; }
+");
+        var plain = _objectManager.LoadObject("/std/measure");
+        var child = _objectManager.LoadObject("/test/measuring");
+        Assert.Contains(OpCode.CallEfun + " ", plain.Program.CompiledFunctions["measure"].Disassemble());
+
+        foreach (var (bytecode, jit) in new[] { (false, false), (true, false), (true, true) })
+        {
+            _interpreter.UseBytecode = bytecode;
+            _interpreter.UseJit = jit;
+            _interpreter.JitThreshold = 1;
+            Assert.Equal(324L, _interpreter.CallFunctionOnObject(plain, "measure", new List<object> { "abc" }));
+            Assert.Equal(253L, _interpreter.CallFunctionOnObject(child, "measure", new List<object> { new List<object> { 1L, 2L } }));
+            Assert.Equal("int", _interpreter.CallFunctionOnObject(plain, "kind", new List<object> { 7L }));
+
+            var error = Assert.Throws<LpcRuntimeException>(() => _interpreter.CallFunctionOnObject(plain, "measure", new List<object> { 7L }));
+            Assert.Contains("sizeof() requires an array, string, or mapping", error.Message);
+        }
+    }
+
+    [Fact]
+    public void CallSites_SeeHotReloadedFunctions()
+    {
+        _interpreter.UseBytecode = true;
+        var other = _objectManager.LoadObject("/test/other");
+        var targets = new List<object> { other };
+        Assert.Equal(100L, Assert.IsType<List<object>>(Call("ask_all", targets))[0]);
+
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "other.c"), @"
+int describe(int x) {
+    return x * 7;
+}
+");
+        _objectManager.UpdateObject("/test/other");
+
+        var result = Assert.IsType<List<object>>(Call("ask_all", targets));
+        Assert.Equal(7L, result[0]);
+        Assert.Equal(14L, result[1]);
+    }
+
+    [Fact]
+    public void CallSites_GoThroughShadows()
+    {
+        _interpreter.UseBytecode = true;
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "curse.c"), @"
+int describe(int x) { return -x; }
+int attach(object o) { return shadow(o); }
+int detach() { return unshadow(); }
+");
+        var other = _objectManager.LoadObject("/test/other");
+        var curse = _objectManager.LoadObject("/test/curse");
+        var targets = new List<object> { other };
+
+        Assert.Equal(1L, _interpreter.CallFunctionOnObject(curse, "attach", new List<object> { other }));
+        Assert.Equal("({-1,-2})", Describe(Call("ask_all", targets)));
+
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "curse.c"), @"
+int describe(int x) { return x - 50; }
+int attach(object o) { return shadow(o); }
+int detach() { return unshadow(); }
+");
+        _objectManager.UpdateObject("/test/curse");
+        Assert.Equal("({-49,-48})", Describe(Call("ask_all", targets)));
+
+        Assert.Equal(1L, _interpreter.CallFunctionOnObject(curse, "detach", new List<object>()));
+        Assert.Equal("({100,200})", Describe(Call("ask_all", targets)));
+    }
+
+    [Fact]
+    public void InfiniteLoop_HitsInstructionLimit()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "spin.c"), @"
+void spin() {
+    while (1) { }
+}
+");
+        var obj = _objectManager.LoadObject("/test/spin");
+        _interpreter.MaxInstructions = 10_000;
+        _interpreter.ResetInstructionCount();
+
+        var ex = Assert.Throws<ExecutionLimitException>(() =>
+            _interpreter.CallFunctionOnObject(obj, "spin", new List<object>()));
+        Assert.Contains("/test/spin", ex.Message);
+    }
+
+    [Fact]
+    public void IntDeclarations_UseSpecializedOperators()
+    {
+        var obj = _objectManager.LoadObject("/test/vm");
+        var listing = obj.Program.CompiledFunctions["typed"].Disassemble();
+
+        Assert.Contains("AddInt", listing);
+        Assert.Contains("AddInt          op=", listing);
+        Assert.Contains("LessInt", listing);
+        Assert.Contains("NotEqualInt", listing);
+        Assert.Contains("SubtractInt", listing);
+        Assert.Contains("GreaterEqualInt", listing);
+        Assert.DoesNotContain("Concat", listing);
+        Assert.Equal(5L, CallBoth("typed", 2L, 3L));
+        Assert.Equal(0L, CallBoth("typed", 50L, 60L));
+    }
+
+    [Fact]
+    public void IntDeclarations_FallBackForOtherValues()
+    {
+        var listing = _objectManager.LoadObject("/test/vm").Program.CompiledFunctions["typed_lies"].Disassemble();
+        Assert.Contains("AddInt", listing);
+
+        var result = Assert.IsType<List<object>>(CallBoth("typed_lies", "abc"));
+        Assert.Equal("xabc", result[0]);
+        Assert.Equal("abc1", result[1]);
+        Assert.Equal(0L, Convert.ToInt64(result[2]));
+        Assert.Equal(1L, Convert.ToInt64(result[3]));
+        CallBoth("typed_lies", 1L);
+    }
+
+    [Fact]
+    public void Jit_TiersUpAtThreshold()
+    {
+        var fn = _objectManager.LoadObject("/test/vm").Program.CompiledFunctions["loops"];
+        _interpreter.JitThreshold = 3;
+
+        Assert.Equal(20L, Call("loops"));
+        Assert.Equal(20L, Call("loops"));
+        Assert.Null(fn.Jitted);
+
+        Assert.Equal(20L, Call("loops"));
+        Assert.NotNull(fn.Jitted);
+        Assert.Equal(20L, Call("loops"));
+        Assert.Contains(" jit", fn.Disassemble());
+    }
+
+    [Fact]
+    public void Jit_CatchAndSscanfStayOnVm()
+    {
+        _interpreter.JitThreshold = 1;
+        CallBoth("errors");
+        CallBoth("parse", "sword 5");
+
+        var program = _objectManager.LoadObject("/test/vm").Program;
+        Assert.True(program.CompiledFunctions["errors"].JitTried);
+        Assert.Null(program.CompiledFunctions["errors"].Jitted);
+        Assert.Null(program.CompiledFunctions["parse"].Jitted);
+    }
+
+    [Fact]
+    public void Jit_HotReloadDropsJittedCode()
+    {
+        _interpreter.JitThreshold = 1;
+        var other = _objectManager.LoadObject("/test/other");
+        Assert.Equal(300L, _interpreter.CallFunctionOnObject(other, "describe", new List<object> { 3L }));
+        Assert.NotNull(other.Program.CompiledFunctions["describe"].Jitted);
+
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "other.c"), @"
+int describe(int x) {
+    return x * 7;
+}
+");
+        _objectManager.UpdateObject("/test/other");
+        other = _objectManager.FindObject("/test/other")!;
+
+        var fn = other.Program.CompiledFunctions["describe"];
+        Assert.Null(fn.Jitted);
+        Assert.False(fn.JitTried);
+        Assert.Equal(21L, _interpreter.CallFunctionOnObject(other, "describe", new List<object> { 3L }));
+        Assert.NotNull(fn.Jitted);
+    }
+
+    [Fact]
+    public void Jit_InfiniteLoopHitsInstructionLimit()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "spin.c"), @"
+void spin() {
+    int i;
+    while (1) {
+        i++;
+    }
+}
+");
+        var obj = _objectManager.LoadObject("/test/spin");
+        _interpreter.MaxInstructions = 10_000;
+
+        ExecutionLimitException Spin()
+        {
+            _interpreter.ResetInstructionCount();
+            return Assert.Throws<ExecutionLimitException>(() =>
+                _interpreter.CallFunctionOnObject(obj, "spin", new List<object>()));
+        }
+
+        _interpreter.UseJit = false;
+        var vmError = Spin();
+        _interpreter.UseJit = true;
+        _interpreter.JitThreshold = 1;
+        var jitError = Spin();
+
+        Assert.NotNull(obj.Program.CompiledFunctions["spin"].Jitted);
+        Assert.Contains("/test/spin", jitError.Message);
+        Assert.Equal(vmError.Message, jitError.Message);
+    }
+
+    [Fact]
+    public void InheritedFunction_OnTwoLayoutsAtOnce_UsesEachLayoutsSlots()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "counter.c"), @"
+int count;
+int bump() { return ++count; }
+");
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "pad.c"), @"
+int a;
+int b;
+int c;
+");
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "one.c"), @"
+inherit ""/std/counter"";
+");
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "two.c"), @"
+inherit ""/test/pad"";
+inherit ""/std/counter"";
+");
+        var one = _objectManager.LoadObject("/test/one");
+        var two = _objectManager.LoadObject("/test/two");
+        Assert.NotEqual(one.VariableLayout.IndexOf("count"), two.VariableLayout.IndexOf("count"));
+
+        const int calls = 20_000;
+        void Hammer(MudObject obj)
+        {
+            var interpreter = new ObjectInterpreter(_objectManager) { UseJit = false };
+            for (int i = 0; i < calls; i++)
+            {
+                interpreter.ResetInstructionCount();
+                interpreter.CallFunctionOnObject(obj, "bump", new List<object>());
+            }
+        }
+
+        Parallel.Invoke(() => Hammer(one), () => Hammer(two));
+
+        Assert.Equal((long)calls, one.GetVariable("count"));
+        Assert.Equal((long)calls, two.GetVariable("count"));
+        Assert.All(new[] { "a", "b", "c" }, name => Assert.Equal(0, two.GetVariable(name)));
+
+        // The slot lookup itself, far faster than calls can drive it
+        var bump = _objectManager.LoadObject("/std/counter").Program.CompiledFunctions["bump"];
+        int name = Array.IndexOf(bump.Names, "count");
+        bool Lookup(MudObject obj)
+        {
+            int expected = obj.VariableLayout.IndexOf("count");
+            for (int i = 0; i < 2_000_000; i++)
+            {
+                if (bump.GetVariableSlots(obj.VariableLayout)[name] != expected) return false;
+            }
+            return true;
+        }
+        var lookups = new[] { Task.Run(() => Lookup(one)), Task.Run(() => Lookup(two)) };
+        Assert.All(lookups, lookup => Assert.True(lookup.Result));
+    }
+}
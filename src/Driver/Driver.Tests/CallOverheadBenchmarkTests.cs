@@ -0,0 +1,106 @@
+using System.Diagnostics;
+using Xunit;
+using Xunit.Abstractions;
+
+namespace Driver.Tests;
+
+/// <summary>
+/// Micro-benchmark for LPC function-call overhead on the tree walker.
+/// Return/break/continue used to be exceptions; the "before" figure replays
+/// that cost by throwing and catching one exception per call, the "after"
+/// figure is the real call. Timings go to the test output.
+/// </summary>
+public class CallOverheadBenchmarkTests : IDisposable
+{
+    private const int Iterations = 20_000;
+
+    private readonly ITestOutputHelper _output;
+    private readonly string _testMudlibPath;
+    private readonly ObjectManager _objectManager;
+    private readonly ObjectInterpreter _interpreter;
+
+    /// <summary>
+    /// Stand-in for the removed ReturnException.
+    /// </summary>
+    private sealed class OldReturnException : Exception
+    {
+        public object? Value { get; }
+        public OldReturnException(object? value) { Value = value; }
+    }
+
+    public CallOverheadBenchmarkTests(ITestOutputHelper output)
+    {
+        _output = output;
+        _testMudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_callbench_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_testMudlibPath, "test"));
+
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "bench.c"), @"
+int find(int n) {
+    int i;
+    for (i = 0; i < 10; i++) {
+        if (i == n) return i;
+        if (i > 5) continue;
+    }
+    return -1;
+}
+");
+
+        _objectManager = new ObjectManager(_testMudlibPath);
+        _objectManager.InitializeInterpreter();
+        _interpreter = _objectManager.Interpreter!;
+        _interpreter.UseBytecode = false;
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_testMudlibPath))
+        {
+            Directory.Delete(_testMudlibPath, recursive: true);
+        }
+    }
+
+    private double NsPerCall(Action call)
+    {
+        // Warm up so JIT and first-call costs don't skew the numbers
+        for (int i = 0; i < 1_000; i++) call();
+
+        var sw = Stopwatch.StartNew();
+        for (int i = 0; i < Iterations; i++) call();
+        sw.Stop();
+        return sw.Elapsed.TotalMilliseconds * 1_000_000 / Iterations;
+    }
+
+    [Fact]
+    public void Return_CostsLessThanAnException()
+    {
+        var obj = _objectManager.LoadObject("/test/bench");
+        var args = new List<object> { 3L };
+
+        object? Call()
+        {
+            _interpreter.ResetInstructionCount();
+            return _interpreter.CallFunctionOnObject(obj, "find", args);
+        }
+
+        Assert.Equal(3L, Call());
+
+        var after = NsPerCall(() => Call());
+        var before = NsPerCall(() =>
+        {
+            // Call plus the throw/catch every return used to pay
+            var result = Call();
+            try
+            {
+                throw new OldReturnException(result);
+            }
+            catch (OldReturnException)
+            {
+            }
+        });
+
+        _output.WriteLine($"find(3) on the tree walker: {after:F0} ns/call");
+        _output.WriteLine($"with an exception per return (old): {before:F0} ns/call");
+
+        Assert.True(after < before, $"call {after:F0} ns should be cheaper than call + exception {before:F0} ns");
+    }
+}
@@ -0,0 +1,86 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class ChannelRegistryTests : IDisposable
+{
+    private readonly string _mudlibPath;
+
+    public ChannelRegistryTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_channel_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "secure", "daemon"));
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "object.c"), "void create() { }\n");
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    [Fact]
+    public void Publish_ReachesConnectedSubscribersOnly()
+    {
+        var om = new ObjectManager(_mudlibPath);
+        om.InitializeInterpreter();
+        var players = Enumerable.Range(0, 4).Select(_ => om.CloneObject("/std/object")).ToList();
+        for (int i = 0; i < players.Count; i++)
+        {
+            om.SetInteractive(players[i], true);
+            players[i].ConnectionId = $"conn{i}";
+        }
+        var registry = om.Channels;
+
+        foreach (var player in players)
+        {
+            Assert.True(registry.Subscribe("chat", player));
+        }
+        Assert.False(registry.Subscribe("chat", players[0]));
+        Assert.True(registry.Unsubscribe("chat", players[1]));
+        players[2].ConnectionId = null;   // linkdead
+        om.DestructObject(players[3]);
+
+        var sent = new List<string>();
+        Assert.Equal(1, registry.Publish("chat", "hi", (id, msg) => sent.Add(id + ":" + msg)));
+        Assert.Equal(new[] { "conn0:hi" }, sent.ToArray());
+        Assert.Equal(new[] { players[0], players[2] }, registry.GetSubscribers("chat").ToArray());
+        Assert.Equal(0, registry.Publish("ooc", "hi", (_, _) => sent.Add("never")));
+    }
+
+    [Fact]
+    public void ChannelEfuns_PublishThroughTheOutputQueue()
+    {
+        File.WriteAllText(Path.Combine(_mudlibPath, "secure", "daemon", "relay.c"), @"
+int join(object who) { return channel_subscribe(""chat"", who); }
+int leave(object who) { return channel_unsubscribe(""chat"", who); }
+int count() { return sizeof(channel_subscribers(""chat"")); }
+int send(string msg) { return channel_publish(""chat"", msg); }
+");
+        var om = new ObjectManager(_mudlibPath);
+        om.InitializeInterpreter();
+        var gameLoop = new GameLoop(om, new AccountManager(_mudlibPath));
+        gameLoop.InitializeInterpreter(om.Interpreter!);
+        var relay = om.LoadObject("/secure/daemon/relay");
+        var listener = om.CloneObject("/std/object");
+        var other = om.CloneObject("/std/object");
+        om.SetInteractive(listener, true);
+        listener.ConnectionId = "testconn";
+        object? Call(string function, params object[] args) =>
+            om.Interpreter!.CallFunctionOnObject(relay, function, args.ToList());
+
+        Assert.Equal(1L, Convert.ToInt64(Call("join", listener)));
+        Assert.Equal(1L, Convert.ToInt64(Call("join", other)));
+        Assert.Equal(0L, Convert.ToInt64(Call("leave", relay)));
+        Assert.Equal(2L, Convert.ToInt64(Call("count")));
+        Assert.Equal(1L, Convert.ToInt64(Call("send", "[Chat] Testuser: hello\n")));
+
+        Assert.True(gameLoop.TryDequeueOutput(out var output));
+        Assert.Equal("testconn", output!.ConnectionId);
+        Assert.Equal("[Chat] Testuser: hello\n", output.Content);
+        Assert.False(gameLoop.TryDequeueOutput(out _));
+    }
+}
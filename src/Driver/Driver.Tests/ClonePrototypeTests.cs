@@ -0,0 +1,140 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class ClonePrototypeTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ObjectManager _objectManager;
+
+    public ClonePrototypeTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_prototype_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "obj"));
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "item.c"), @"
+string name;
+string *ids;
+mapping props;
+int weight;
+void set_name(string str) { name = lower_case(str); ids = ({ name }) + ids; set_ids(ids); }
+void add_id(string str) { ids = ids + ({ str }); set_ids(ids); }
+void set_prop(string key, mixed value) { props[key] = value; }
+void set_weight(int w) { weight = w; }
+int id(string str) { return member_array(str, ids) >= 0; }
+void create() {
+    ids = ({});
+    props = ([]);
+    weight = 1;
+    set_living(0);
+}
+mixed query(string var) {
+    switch (var) {
+        case ""name"": return name;
+        case ""ids"": return ids;
+        case ""props"": return props;
+        case ""weight"": return weight;
+    }
+    return 0;
+}
+");
+        File.WriteAllText(Path.Combine(_mudlibPath, "obj", "sword.c"), @"
+inherit ""/std/item"";
+void create() {
+    ::create();
+    set_name(""Sword"");
+    add_id(""blade"");
+    set_prop(""sharp"", ({ 1, 2 }));
+    set_weight(sizeof(ids) * 3);
+    set_skill_level(""cutting"", 4);
+    set_heart_beat(1);
+}
+");
+        File.WriteAllText(Path.Combine(_mudlibPath, "obj", "gem.c"), @"
+inherit ""/std/item"";
+void create() {
+    ::create();
+    set_name(""gem"");
+    set_weight(random(1000000) + 1);
+}
+");
+        File.WriteAllText(Path.Combine(_mudlibPath, "obj", "ring.c"), @"
+inherit ""/std/item"";
+int made;
+void create() {
+    ::create();
+    made = sizeof(users());
+    set_name(""ring"");
+}
+");
+
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter();
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private object? Query(MudObject obj, string variable)
+    {
+        var interpreter = _objectManager.Interpreter!;
+        interpreter.ResetInstructionCount();
+        return interpreter.CallFunctionOnObject(obj, "query", new List<object> { variable });
+    }
+
+    private (MudObject Clone, long Instructions) Clone(string path)
+    {
+        long before = _objectManager.Interpreter!.ThreadInstructions;
+        var clone = _objectManager.CloneObject(path);
+        return (clone, _objectManager.Interpreter!.ThreadInstructions - before);
+    }
+
+    [Fact]
+    public void DeclarativeCreate_LaterClonesCopyTheFirstOnesState()
+    {
+        var (first, firstCost) = Clone("/obj/sword");
+        var (second, secondCost) = Clone("/obj/sword");
+
+        Assert.True(firstCost > 0);
+        Assert.Equal(0, secondCost);
+
+        foreach (var clone in new[] { first, second })
+        {
+            Assert.Equal("sword", Query(clone, "name"));
+            Assert.Equal(new List<object> { "sword", "blade" }, Query(clone, "ids"));
+            Assert.Equal(6L, Convert.ToInt64(Query(clone, "weight")));
+            Assert.True(clone.MatchDeclaredId("blade") == true);
+            Assert.Equal(4, clone.Skills.Get("cutting"));
+            Assert.True(clone.HeartbeatEnabled);
+        }
+
+        // Each clone has its own arrays and mappings
+        var props = (Dictionary<object, object>)Query(second, "props")!;
+        ((List<object>)props["sharp"]).Add(3L);
+        second.Skills.Set("cutting", 9);
+        var firstProps = (Dictionary<object, object>)Query(first, "props")!;
+        Assert.Equal(2, ((List<object>)firstProps["sharp"]).Count);
+        Assert.Equal(4, first.Skills.Get("cutting"));
+        Assert.Equal(2, ((List<object>)((Dictionary<object, object>)Query(Clone("/obj/sword").Clone, "props")!)["sharp"]).Count);
+    }
+
+    [Fact]
+    public void CreateThatDependsOnTheWorld_RunsForEveryClone()
+    {
+        Clone("/obj/gem");
+        Assert.True(Clone("/obj/gem").Instructions > 0);
+        Clone("/obj/ring");
+        Assert.True(Clone("/obj/ring").Instructions > 0);
+
+        _objectManager.ClonePrototypes = false;
+        Clone("/obj/sword");
+        var (sword, cost) = Clone("/obj/sword");
+        Assert.True(cost > 0);
+        Assert.Equal(6L, Convert.ToInt64(Query(sword, "weight")));
+    }
+}
@@ -0,0 +1,200 @@
+using System.Net;
+using System.Net.Sockets;
+using System.Text;
+using Xunit;
+
+namespace Driver.Tests;
+
+public class ClusterTests : IDisposable
+{
+    private readonly TcpListener _town = new(IPAddress.Loopback, 0);
+    private readonly TcpListener _forest = new(IPAddress.Loopback, 0);
+    private readonly ClusterConfig _config;
+
+    public ClusterTests()
+    {
+        _town.Start();
+        _forest.Start();
+        _config = new ClusterConfig
+        {
+            Secret = "s3cret",
+            Nodes =
+            {
+                new ClusterNodeInfo { Name = "town", Port = ((IPEndPoint)_town.LocalEndpoint).Port },
+                new ClusterNodeInfo { Name = "forest", Port = ((IPEndPoint)_forest.LocalEndpoint).Port, Areas = { "/world/rooms/forest", "/world/rooms/town/gate" } }
+            }
+        };
+    }
+
+    public void Dispose()
+    {
+        _town.Stop();
+        _forest.Stop();
+    }
+
+    private static void WaitUntil(Func<bool> condition)
+    {
+        var deadline = DateTime.UtcNow.AddSeconds(5);
+        bool met;
+        while (!(met = condition()) && DateTime.UtcNow < deadline)
+        {
+            Thread.Sleep(10);
+        }
+        Assert.True(met);
+    }
+
+    private static string ReadLine(Socket socket)
+    {
+        var line = new StringBuilder();
+        var one = new byte[1];
+        while (socket.Receive(one) == 1 && one[0] != '\n')
+        {
+            line.Append((char)one[0]);
+        }
+        return line.ToString().TrimEnd('\r');
+    }
+
+    private static bool Closed(Socket socket)
+    {
+        try
+        {
+            return socket.Receive(new byte[16]) == 0;
+        }
+        catch (SocketException)
+        {
+            return true;
+        }
+    }
+
+    private static string Read(Socket socket, int count)
+    {
+        var buffer = new byte[count];
+        int read = 0;
+        while (read < count)
+        {
+            read += socket.Receive(buffer, read, count - read, SocketFlags.None);
+        }
+        return Encoding.ASCII.GetString(buffer);
+    }
+
+    [Fact]
+    public void OwnerOf_PicksTheLongestMatchingArea()
+    {
+        Assert.Equal("forest", _config.OwnerOf("/world/rooms/forest/edge"));
+        Assert.Equal("forest", _config.OwnerOf("/world/rooms/forest/edge#12"));
+        Assert.Equal("forest", _config.OwnerOf("/world/rooms/town/gate"));
+        Assert.Equal("town", _config.OwnerOf("/world/rooms/town/gate_house"));
+        Assert.Equal("town", _config.OwnerOf("/world/rooms/forestry"));
+        Assert.Equal("town", _config.OwnerOf("/std/player#3"));
+    }
+
+    [Fact]
+    public void Router_PassesClientsThroughAndMovesThemOnHandoff()
+    {
+        using var router = new ClusterRouter(_config, port: 0, linkPort: 0);
+        _config.LinkPort = router.LinkLocalPort;
+        _ = router.RunAsync();
+        using var townNode = new ClusterNode(_config, "town");
+        townNode.Start();
+        WaitUntil(() => townNode.Connected && router.NodeCount == 1);
+
+        // A new player goes to the first node, behind a route line
+        using var client = new Socket(SocketType.Stream, ProtocolType.Tcp);
+        client.Connect(IPAddress.Loopback, router.LocalPort);
+        using var town = _town.AcceptSocket();
+        var route = townNode.ParseRoute(ReadLine(town));
+        Assert.NotNull(route);
+        Assert.Null(route.User);
+        Assert.Null(townNode.ParseRoute("#route wrong r1 127.0.0.1"));
+
+        client.Send(Encoding.ASCII.GetBytes("look\n"));
+        Assert.Equal("look\n", Read(town, 5));
+        town.Send(Encoding.ASCII.GetBytes("A square.\n"));
+        Assert.Equal("A square.\n", Read(client, 10));
+
+        // Handoff: the forest node gets the player and room; the town's last output still arrives first
+        town.Send(Encoding.ASCII.GetBytes("You go south.\n"));
+        townNode.Send(new ClusterMessage { Type = "handoff", To = "forest", Route = route.RouteId, User = "testwalker", Room = "/world/rooms/forest/edge" });
+        using var forest = _forest.AcceptSocket();
+        var arrival = townNode.ParseRoute(ReadLine(forest));
+        Assert.Equal(route.RouteId, arrival!.RouteId);
+        Assert.Equal("testwalker", arrival.User);
+        Assert.Equal("/world/rooms/forest/edge", arrival.Room);
+
+        Assert.True(Closed(town));
+        town.Close();
+        forest.Send(Encoding.ASCII.GetBytes("A forest edge.\n"));
+        Assert.Equal("You go south.\nA forest edge.\n", Read(client, 29));
+        client.Send(Encoding.ASCII.GetBytes("north\n"));
+        Assert.Equal("north\n", Read(forest, 6));
+
+        // The client hanging up closes its node connection
+        client.Close();
+        Assert.True(Closed(forest));
+        WaitUntil(() => router.RouteCount == 0);
+    }
+
+    [Fact]
+    public void Router_KeepsTheDirectoryAndForwardsCalls()
+    {
+        using var router = new ClusterRouter(_config, port: 0, linkPort: 0);
+        _config.LinkPort = router.LinkLocalPort;
+        _ = router.RunAsync();
+        using var town = new ClusterNode(_config, "town");
+        using var forest = new ClusterNode(_config, "forest");
+        town.Start();
+        forest.Start();
+        WaitUntil(() => town.Connected && forest.Connected && router.NodeCount == 2);
+
+        town.PublishUsers(new List<string> { "testalice" });
+        forest.PublishUsers(new List<string> { "testbob" });
+        WaitUntil(() => town.RemoteUsers.Count == 1 && forest.RemoteUsers.Count == 1);
+        Assert.Equal("forest", town.RemoteUsers["testbob"]);
+        Assert.Equal("town", forest.RemoteUsers["testalice"]);
+
+        town.Send(new ClusterMessage
+        {
+            Type = "call",
+            To = "forest",
+            Id = 7,
+            Path = "/world/rooms/forest/edge",
+            Function = "query_short",
+            Value = ClusterNode.Encode(new List<object> { 1L, "two", new List<object> { 3L } })
+        });
+        ClusterMessage? call = null;
+        WaitUntil(() => forest.TryReceive(out call));
+        Assert.Equal("town", call!.From);
+        var args = (List<object>)ClusterNode.Decode(call.Value);
+        Assert.Equal(1L, Convert.ToInt64(args[0]));
+        Assert.Equal("two", args[1]);
+        Assert.Equal(3L, Convert.ToInt64(((List<object>)args[2])[0]));
+
+        // A call to a node that isn't linked is answered for it
+        forest.Dispose();
+        WaitUntil(() => router.NodeCount == 1 && town.RemoteUsers.Count == 0);
+        town.Send(new ClusterMessage { Type = "call", To = "forest", Id = 8, Path = "/world/rooms/forest/edge", Function = "query_short" });
+        ClusterMessage? reply = null;
+        WaitUntil(() => town.TryReceive(out reply));
+        Assert.Equal("reply", reply!.Type);
+        Assert.Equal(8, reply.Id);
+        Assert.NotNull(reply.Error);
+    }
+
+    [Fact]
+    public void Encode_MappingWithAnObjectAndItsNameAsKeys()
+    {
+        var sword = new MudObject(new LpcProgram("/obj/sword"));
+        var map = new Dictionary<object, object> { [sword] = 1L, ["/obj/sword"] = 2L, [sword.ObjectName + "#1"] = 3L };
+
+        var decoded = (Dictionary<object, object>)ClusterNode.Decode(ClusterNode.Encode(map));
+
+        // The plain key keeps its value; the object's name would have collided with it
+        Assert.Equal(2, decoded.Count);
+        Assert.Equal(2L, Convert.ToInt64(decoded["/obj/sword"]));
+        Assert.Equal(3L, Convert.ToInt64(decoded["/obj/sword#1"]));
+
+        // Without a collision the object goes by its name
+        var alone = (Dictionary<object, object>)ClusterNode.Decode(ClusterNode.Encode(new Dictionary<object, object> { [sword] = 1L }));
+        Assert.Equal(1L, Convert.ToInt64(alone["/obj/sword"]));
+    }
+}
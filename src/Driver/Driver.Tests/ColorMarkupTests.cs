@@ -0,0 +1,52 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class ColorMarkupTests
+{
+    [Fact]
+    public void Render_TurnsTokensIntoCodesForTheClass()
+    {
+        const string text = "%^RED%^Danger%^RESET%^ ahead";
+
+        Assert.Equal("Danger ahead", ColorMarkup.Render(text, ColorSupport.None));
+        Assert.Equal("\u001b[31mDanger\u001b[0m ahead", ColorMarkup.Render(text, ColorSupport.Ansi));
+        Assert.Equal("\u001b[38;5;208mhot\u001b[0m", ColorMarkup.Render("%^F208%^hot%^RESET%^", ColorSupport.Xterm256));
+
+        // Without the palette an xterm color becomes the nearest ANSI one: 196 is bright red
+        Assert.Equal("\u001b[1;31mhot\u001b[0m", ColorMarkup.Render("%^F196%^hot%^RESET%^", ColorSupport.Ansi));
+    }
+
+    [Fact]
+    public void Render_LeavesOtherTextAloneAndResetsALeftoverColor()
+    {
+        Assert.Equal("100%^ sure", ColorMarkup.Render("100%^ sure", ColorSupport.Ansi));
+        Assert.Equal("a %^NOTACOLOR%^ b", ColorMarkup.Render("a %^NOTACOLOR%^ b", ColorSupport.Ansi));
+        Assert.Equal("\u001b[1mbold\u001b[0m", ColorMarkup.Render("%^BOLD%^bold", ColorSupport.Ansi));
+        Assert.Equal("%^x", ColorMarkup.Render("%^%^RED%^x", ColorSupport.None));
+
+        const string plain = "no markup here";
+        Assert.Same(plain, ColorMarkup.Render(plain, ColorSupport.Xterm256));
+    }
+
+    [Fact]
+    public void Renderer_RendersABroadcastOncePerClass()
+    {
+        var renderer = new ColorRenderer();
+        var broadcast = "%^CYAN%^[Chat]%^RESET%^ Bob: hi\n";
+
+        for (int i = 0; i < 300; i++)
+        {
+            renderer.Render(broadcast, (ColorSupport)(i % 2));
+        }
+        Assert.Equal(2, renderer.Renders);
+
+        // Equal text in another string is another message
+        renderer.Render(new string(broadcast.AsSpan()), ColorSupport.None);
+        Assert.Equal(3, renderer.Renders);
+
+        renderer.Clear();
+        renderer.Render(broadcast, ColorSupport.None);
+        Assert.Equal(4, renderer.Renders);
+    }
+}
@@ -0,0 +1,93 @@
+using System.Diagnostics;
+using Xunit;
+
+namespace Driver.Tests;
+
+public class CommandLatencyTests
+{
+    private static long MillisecondsAgo(int ms) => Stopwatch.GetTimestamp() - Stopwatch.Frequency * ms / 1000;
+
+    [Fact]
+    public void Stages_AreRecordedWhenTheOutputIsSent()
+    {
+        var latency = new CommandLatency { SlowThresholdMs = 0 };
+
+        var trace = latency.Begin("conn-1", "look", MillisecondsAgo(3));
+        trace.Reached(CommandStage.Run);
+        trace.Reached(CommandStage.Output);
+        trace.Reached(CommandStage.Send);
+        Assert.Equal(0, latency.Read((total, stages, slow) => total.Count));
+
+        trace.Sent();
+
+        Assert.True(trace.Microseconds(CommandStage.Read) >= 3000);
+        Assert.True(trace.TotalMicroseconds >= trace.Microseconds(CommandStage.Read));
+        latency.Read((total, stages, slow) =>
+        {
+            Assert.Equal(1, total.Count);
+            Assert.All(stages, stage => Assert.Equal(1, stage.Count));
+            Assert.True(stages[(int)CommandStage.Read].MaxMicroseconds >= 3000);
+            Assert.Empty(slow);
+            return 0;
+        });
+    }
+
+    [Fact]
+    public void SlowCommand_IsKeptWithItsCalls()
+    {
+        var latency = new CommandLatency { SlowThresholdMs = 1 };
+        var trace = latency.Begin("conn-1", "kill rat", MillisecondsAgo(5));
+        trace.Calls = new CallTrace();
+        int outer = trace.Calls.Enter("/cmds/kill", "main", 1);
+        int inner = trace.Calls.Enter("/std/living", "start_combat", 2);
+        trace.Calls.Exit(inner);
+        trace.Calls.Exit(outer);
+        trace.Reached(CommandStage.Run);
+        trace.Reached(CommandStage.Output);
+        trace.Reached(CommandStage.Send);
+        trace.Sent();
+
+        var slow = Assert.Single(latency.Read((total, stages, slowCommands) => slowCommands.ToList()));
+        Assert.Equal("kill rat", slow.Input);
+        Assert.True(slow.Microseconds > 1000);
+        Assert.Equal(new[] { (1, "/cmds/kill:main"), (2, "/std/living:start_combat") },
+            slow.Calls.Select(call => (call.Depth, call.Name)).ToArray());
+
+        var logged = CommandLatency.FormatSlow(slow).Split('\n');
+        Assert.StartsWith("Slow command from conn-1: \"kill rat\"", logged[0]);
+        Assert.Contains("read ", logged[0]);
+        Assert.StartsWith("    /std/living:start_combat ", logged[2]);
+    }
+
+    [Fact]
+    public void CallTrace_KeepsTheFirstCallsAndCountsTheRest()
+    {
+        var tempDir = Path.Combine(Path.GetTempPath(), $"latency_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(tempDir);
+        try
+        {
+            var om = new ObjectManager(tempDir);
+            om.InitializeInterpreter();
+            var obj = om.LoadSource("/test/calls", @"
+int leaf(int n) { return n; }
+int run(int n) { int i; int total; for (i = 0; i < n; i++) total += leaf(i); return total; }
+");
+            var interpreter = om.Interpreter!;
+            var calls = new CallTrace();
+
+            interpreter.ThreadCallTrace = calls;
+            interpreter.CallFunctionOnObject(obj, "run", new List<object> { 100L });
+            interpreter.ThreadCallTrace = null;
+
+            var recorded = calls.Recorded();
+            Assert.Equal(CallTrace.MaxCalls, recorded.Count);
+            Assert.Equal((1, "/test/calls:run"), (recorded[0].Depth, recorded[0].Name));
+            Assert.Equal((2, "/test/calls:leaf"), (recorded[1].Depth, recorded[1].Name));
+            Assert.Equal(101 - CallTrace.MaxCalls, calls.Dropped);
+        }
+        finally
+        {
+            Directory.Delete(tempDir, true);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class CommandRecordingTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly string _recordingPath;
+
+    public CommandRecordingTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_recording_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "cmds", "std"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "secure", "accounts"));
+        _recordingPath = Path.Combine(_mudlibPath, "session.rec");
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "player.c"), "");
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "dice.c"), @"
+int *rolls = ({});
+void add(int n) { rolls = rolls + ({ n }); }
+int *query_rolls() { return rolls; }
+");
+        File.WriteAllText(Path.Combine(_mudlibPath, "cmds", "std", "roll.c"), @"
+void main(string args) { load_object(""/std/dice"")->add(random(1000000)); }
+");
+        File.WriteAllText(Path.Combine(_mudlibPath, "cmds", "std", "secret.c"), @"
+void main(string args) { input_to(""got_secret"", 1); }
+void got_secret(string input) { }
+");
+        new AccountManager(_mudlibPath).CreateAccount("testroller", "r@test.com", "password123");
+    }
+
+    public void Dispose()
+    {
+        EfunRegistry.SeedRandom(null);
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private (ObjectManager, GameLoop) NewWorld()
+    {
+        var objectManager = new ObjectManager(_mudlibPath);
+        objectManager.InitializeInterpreter();
+        var gameLoop = new GameLoop(objectManager, new AccountManager(_mudlibPath));
+        gameLoop.InitializeInterpreter(new ObjectInterpreter(objectManager));
+        return (objectManager, gameLoop);
+    }
+
+    private static List<long> Rolls(ObjectManager objectManager)
+    {
+        var dice = objectManager.FindObject("/std/dice");
+        if (dice == null) return new List<long>();
+        var rolls = (List<object>)objectManager.Interpreter!.CallFunctionOnObject(dice, "query_rolls", new List<object>())!;
+        return rolls.Select(Convert.ToInt64).ToList();
+    }
+
+    [Fact]
+    public void Recorder_KeepsInGameInputButNotHiddenAnswers()
+    {
+        var (_, gameLoop) = NewWorld();
+        using (var recorder = new CommandRecorder(_recordingPath, seed: 42))
+        {
+            gameLoop.Recorder = recorder;
+            gameLoop.ResumePlayerSession("c1", "127.0.0.1", "testroller");
+            gameLoop.Step();
+            gameLoop.QueueCommand("c1", "roll");
+            gameLoop.QueueCommand("c1", "secret");
+            gameLoop.Step();
+            gameLoop.QueueCommand("c1", "hunter2");
+            gameLoop.Step();
+            gameLoop.QueueCommand("c1", "say a\tb\\c");
+            gameLoop.RemovePlayerSession("c1");
+            recorder.Flush();
+        }
+
+        var recording = CommandRecording.Load(_recordingPath);
+        Assert.Equal(42, recording.Seed);
+        Assert.Equal(
+            new[] { "Login testroller", "Command roll", "Command secret", "Command say a\tb\\c", "Disconnect " },
+            recording.Events.Select(e => $"{e.Kind} {e.Text}").ToArray());
+        Assert.All(recording.Events, e => Assert.Equal("c1", e.ConnectionId));
+        Assert.True(recording.Events.Zip(recording.Events.Skip(1)).All(pair => pair.First.Ms <= pair.Second.Ms));
+    }
+
+    [Fact]
+    public void Replay_RunsTheSameCommandsOnTheSameTicksWithTheSameRandomNumbers()
+    {
+        File.WriteAllText(_recordingPath, string.Join("\n",
+            "#recording 1 seed 1234",
+            "0\tlogin\tc1\ttestroller",
+            "150\tcmd\tc1\troll",
+            "2000\tcmd\tc1\troll",
+            "2050\tcmd\tc1\troll",
+            "2100\tclose\tc1",
+            "2200\tcm"));
+        var recording = CommandRecording.Load(_recordingPath);
+        Assert.Equal(5, recording.Events.Count);
+
+        var (first, firstLoop) = NewWorld();
+        var report = CommandReplay.Run(firstLoop, recording);
+        Assert.Equal(23, report.Ticks);
+        Assert.Equal(1, report.Logins);
+        Assert.Equal(0, report.MissingAccounts);
+        Assert.Equal(3, report.Commands);
+        Assert.Equal(3, report.Latencies.Single(l => l.Command == "roll").Count);
+
+        var (second, secondLoop) = NewWorld();
+        CommandReplay.Run(secondLoop, recording);
+        Assert.Equal(3, Rolls(first).Count);
+        Assert.Equal(Rolls(first), Rolls(second));
+        Assert.Null(firstLoop.GetSession("c1"));
+        Assert.Throws<InvalidDataException>(() =>
+        {
+            File.WriteAllText(_recordingPath, "not a recording\n");
+            CommandRecording.Load(_recordingPath);
+        });
+    }
+}
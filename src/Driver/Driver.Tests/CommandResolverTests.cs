@@ -0,0 +1,99 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class CommandResolverTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly CommandResolver _resolver;
+
+    public CommandResolverTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_cmdres_test_{Guid.NewGuid():N}");
+        foreach (var tier in new[] { "std", "wizard", "admin" })
+        {
+            Directory.CreateDirectory(Path.Combine(_mudlibPath, "cmds", tier));
+        }
+        WriteCommand("std", "look");
+        WriteCommand("wizard", "look");
+        WriteCommand("wizard", "goto");
+        WriteCommand("admin", "shutdown");
+
+        _resolver = new CommandResolver(_mudlibPath);
+    }
+
+    public void Dispose()
+    {
+        _resolver.Dispose();
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private void WriteCommand(string tier, string verb)
+    {
+        File.WriteAllText(Path.Combine(_mudlibPath, "cmds", tier, verb + ".c"), "void main(string args) { }\n");
+    }
+
+    private static void WaitUntil(Func<bool> condition)
+    {
+        var deadline = DateTime.UtcNow.AddSeconds(5);
+        while (!condition() && DateTime.UtcNow < deadline)
+        {
+            Thread.Sleep(10);
+        }
+    }
+
+    [Fact]
+    public void Resolve_SearchesTheTiersForTheAccessLevel()
+    {
+        Assert.Equal(new[] { "/cmds/std/look" }, _resolver.Resolve("look", AccessLevel.Player));
+        Assert.Equal(new[] { "/cmds/wizard/look", "/cmds/std/look" }, _resolver.Resolve("look", AccessLevel.Wizard));
+        Assert.Empty(_resolver.Resolve("goto", AccessLevel.Player));
+        Assert.Equal(new[] { "/cmds/admin/shutdown" }, _resolver.Resolve("shutdown", AccessLevel.Admin));
+        Assert.Empty(_resolver.Resolve("shutdown", AccessLevel.Wizard));
+    }
+
+    [Fact]
+    public void Resolve_RejectsVerbsThatLeaveCmds()
+    {
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "secure"));
+        File.WriteAllText(Path.Combine(_mudlibPath, "secure", "login.c"), "");
+
+        Assert.Empty(_resolver.Resolve("../../secure/login", AccessLevel.Admin));
+        Assert.Empty(_resolver.Resolve("..", AccessLevel.Admin));
+        Assert.Empty(_resolver.Resolve("", AccessLevel.Admin));
+    }
+
+    [Fact]
+    public void NotWatching_DoesNotCache()
+    {
+        Assert.Empty(_resolver.Resolve("dance", AccessLevel.Player));
+        WriteCommand("std", "dance");
+
+        Assert.Equal(0, _resolver.CachedCount);
+        Assert.Single(_resolver.Resolve("dance", AccessLevel.Player));
+    }
+
+    [Fact]
+    public void Watching_CachesMissesUntilACommandAppears()
+    {
+        _resolver.StartWatching();
+        Assert.True(_resolver.IsWatching);
+
+        Assert.Empty(_resolver.Resolve("dance", AccessLevel.Player));
+        Assert.Equal(new[] { "/cmds/std/look" }, _resolver.Resolve("look", AccessLevel.Player));
+        Assert.Equal(2, _resolver.CachedCount);
+
+        WriteCommand("std", "dance");
+        WaitUntil(() => _resolver.CachedCount == 0);
+
+        Assert.Equal(new[] { "/cmds/std/dance" }, _resolver.Resolve("dance", AccessLevel.Player));
+
+        File.Delete(Path.Combine(_mudlibPath, "cmds", "std", "look.c"));
+        WaitUntil(() => _resolver.CachedCount == 0);
+
+        Assert.Empty(_resolver.Resolve("look", AccessLevel.Player));
+    }
+}
@@ -0,0 +1,91 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class CommandSchedulerTests
+{
+    private static PlayerCommand Command(string connectionId, string input) =>
+        new() { ConnectionId = connectionId, Input = input };
+
+    [Fact]
+    public void RunTick_TakesTurnsAcrossConnections()
+    {
+        var scheduler = new CommandScheduler();
+        for (int i = 0; i < 200; i++)
+        {
+            scheduler.Enqueue(Command("paster", $"say line {i}"));
+        }
+        scheduler.Enqueue(Command("walker", "look"));
+        scheduler.Enqueue(Command("walker", "north"));
+
+        var order = new List<string>();
+        scheduler.RunTick(cmd => order.Add(cmd.ConnectionId + ":" + cmd.Input), () => 0);
+
+        // The paster's script doesn't hold up the other player
+        Assert.Equal(new[] { "paster:say line 0", "walker:look", "paster:say line 1", "walker:north" }, order.Take(4));
+        Assert.Equal(100, order.Count);
+        Assert.Equal(102, scheduler.Depth);
+    }
+
+    [Fact]
+    public void RunTick_StopsAtTheInstructionBudget()
+    {
+        var scheduler = new CommandScheduler { MaxInstructionsPerTick = 1000 };
+        for (int i = 0; i < 5; i++)
+        {
+            scheduler.Enqueue(Command("conn" + i, "heavy"));
+        }
+
+        long instructions = 0;
+        int run = scheduler.RunTick(_ => instructions += 600, () => instructions);
+
+        Assert.Equal(2, run);
+        Assert.Equal(3, scheduler.Depth);
+        Assert.Equal(3, scheduler.RunTick(_ => { }, () => 0));
+        Assert.Equal(0, scheduler.Depth);
+    }
+
+    [Fact]
+    public void Speedwalk_RunsInBatchesAheadOfLaterInput()
+    {
+        var scheduler = new CommandScheduler { SpeedwalkStepsPerTurn = 2 };
+        scheduler.Enqueue(Command("walker", ".3n"));
+        scheduler.Enqueue(Command("walker", "look"));
+        scheduler.Enqueue(Command("other", "score"));
+
+        var order = new List<string>();
+        scheduler.RunTick(cmd =>
+        {
+            order.Add(cmd.ConnectionId + ":" + cmd.Input);
+            var steps = CommandScheduler.ParseSpeedwalk(cmd.Input);
+            if (steps != null)
+            {
+                scheduler.StartSpeedwalk(cmd, steps);
+            }
+        }, () => 0);
+
+        Assert.Equal(new[] { "walker:.3n", "other:score", "walker:n", "walker:n", "walker:n", "walker:look" }, order);
+    }
+
+    [Fact]
+    public void ParseSpeedwalk_ExpandsCountsAndRejectsOtherInput()
+    {
+        Assert.Equal(new[] { "n", "n", "n", "e", "e", "u" }, CommandScheduler.ParseSpeedwalk(".3n2eu"));
+        Assert.Null(CommandScheduler.ParseSpeedwalk("north"));
+        Assert.Null(CommandScheduler.ParseSpeedwalk(".3x"));
+        Assert.Null(CommandScheduler.ParseSpeedwalk(".3"));
+        Assert.Null(CommandScheduler.ParseSpeedwalk(".99n"));
+    }
+
+    [Fact]
+    public void Remove_DiscardsWaitingInput()
+    {
+        var scheduler = new CommandScheduler();
+        scheduler.Enqueue(Command("gone", "look"));
+        scheduler.Enqueue(Command("gone", "look"));
+        scheduler.Remove("gone");
+
+        Assert.Equal(0, scheduler.Depth);
+        Assert.Equal(0, scheduler.RunTick(_ => throw new InvalidOperationException(), () => 0));
+    }
+}
@@ -0,0 +1,161 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class CoroutineTests : IDisposable
+{
+    private readonly string _mudlibPath;
+
+    public CoroutineTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_coroutine_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "secure", "accounts"));
+        File.WriteAllText(Path.Combine(_mudlibPath, "scan.c"), @"
+int done;
+int slices;
+int total;
+mixed caught;
+
+int start(string function, int arg) { return start_coroutine(function, arg); }
+
+void count(int n) {
+    int i;
+    int j;
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < 1000; j++) total++;
+        slices++;
+        yield();
+    }
+    done = 1;
+}
+
+void nap(int ticks) {
+    slices++;
+    sleep(ticks);
+    slices++;
+    done = 1;
+}
+
+void stubborn(int n) {
+    while (1) {
+        slices++;
+        caught = catch(yield());
+    }
+}
+
+int stop(int id) { return stop_coroutine(id); }
+void die() { destruct(this_object()); }
+int query_done() { return done; }
+int query_slices() { return slices; }
+int query_total() { return total; }
+mixed try_yield() { return catch(yield()); }
+");
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private (ObjectInterpreter, GameLoop, MudObject) NewWorld()
+    {
+        var objectManager = new ObjectManager(_mudlibPath);
+        objectManager.InitializeInterpreter();
+        var gameLoop = new GameLoop(objectManager, new AccountManager(_mudlibPath));
+        gameLoop.InitializeInterpreter(objectManager.Interpreter!);
+        // Onto the stepped clock
+        gameLoop.Step();
+        return (objectManager.Interpreter!, gameLoop, objectManager.LoadObject("/scan"));
+    }
+
+    private static long Call(ObjectInterpreter interpreter, MudObject obj, string function, params object[] args)
+    {
+        return Convert.ToInt64(interpreter.CallFunctionOnObject(obj, function, args.ToList()));
+    }
+
+    [Fact]
+    public void Coroutine_RunsASliceEachTickWithItsOwnBudget()
+    {
+        var (interpreter, gameLoop, scan) = NewWorld();
+        // The whole job is over the limit; each slice is well under it
+        interpreter.MaxInstructions = 50_000;
+        Assert.True(Call(interpreter, scan, "start", "count", 20L) > 0);
+        Assert.Equal(0, Call(interpreter, scan, "query_slices"));
+
+        for (int tick = 1; tick <= 20; tick++)
+        {
+            gameLoop.Step();
+            Assert.Equal(tick, Call(interpreter, scan, "query_slices"));
+        }
+        Assert.Equal(0, Call(interpreter, scan, "query_done"));
+        Assert.Equal(1, gameLoop.Coroutines.Count);
+
+        gameLoop.Step();
+        Assert.Equal(1, Call(interpreter, scan, "query_done"));
+        Assert.Equal(20_000, Call(interpreter, scan, "query_total"));
+        Assert.Equal(0, gameLoop.Coroutines.Count);
+    }
+
+    [Fact]
+    public void Sleep_WaitsThatManyTicks()
+    {
+        var (interpreter, gameLoop, scan) = NewWorld();
+        Call(interpreter, scan, "start", "nap", 3L);
+
+        gameLoop.Step();
+        Assert.Equal(1, Call(interpreter, scan, "query_slices"));
+        gameLoop.Step();
+        gameLoop.Step();
+        Assert.Equal(0, Call(interpreter, scan, "query_done"));
+        gameLoop.Step();
+        Assert.Equal(1, Call(interpreter, scan, "query_done"));
+    }
+
+    [Fact]
+    public void StoppedCoroutines_UnwindPastCatch()
+    {
+        var (interpreter, gameLoop, scan) = NewWorld();
+        long id = Call(interpreter, scan, "start", "stubborn", 0L);
+        gameLoop.Step();
+        gameLoop.Step();
+        Assert.Equal(2, Call(interpreter, scan, "query_slices"));
+
+        Assert.Equal(0, Call(interpreter, scan, "stop", id + 1));
+        Assert.Equal(1, Call(interpreter, scan, "stop", id));
+        gameLoop.Step();
+
+        Assert.Equal(2, Call(interpreter, scan, "query_slices"));
+        Assert.Equal(0, gameLoop.Coroutines.Count);
+    }
+
+    [Fact]
+    public void DestructedOwners_AndStoppingTheLoop_EndCoroutines()
+    {
+        var (interpreter, gameLoop, scan) = NewWorld();
+        Call(interpreter, scan, "start", "stubborn", 0L);
+        Call(interpreter, scan, "start", "count", 100L);
+        gameLoop.Step();
+        Assert.Equal(2, gameLoop.Coroutines.Count);
+
+        gameLoop.Stop();
+        Assert.Equal(0, gameLoop.Coroutines.Count);
+
+        var (interpreter2, gameLoop2, scan2) = NewWorld();
+        Call(interpreter2, scan2, "start", "stubborn", 0L);
+        gameLoop2.Step();
+        interpreter2.CallFunctionOnObject(scan2, "die", new List<object>());
+        gameLoop2.Step();
+        Assert.Equal(0, gameLoop2.Coroutines.Count);
+    }
+
+    [Fact]
+    public void Yield_OutsideACoroutineIsAnError()
+    {
+        var (interpreter, _, scan) = NewWorld();
+        var error = interpreter.CallFunctionOnObject(scan, "try_yield", new List<object>());
+        Assert.Contains("yield() can only be called in a coroutine", Assert.IsType<string>(error));
+    }
+}
@@ -0,0 +1,105 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class CpuAccountsTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ObjectManager _objectManager;
+    private long _seconds;
+
+    public CpuAccountsTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_cpu_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "wizards", "ann", "castle"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "world", "mobs"));
+        File.WriteAllText(Path.Combine(_mudlibPath, "wizards", "ann", "castle", "guard.c"), "void create() { }\n");
+        File.WriteAllText(Path.Combine(_mudlibPath, "world", "mobs", "rat.c"), "void create() { }\n");
+
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter();
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    [Fact]
+    public void Charges_AddUpPerObjectBlueprintAndDomain_AndAgeOutOfTheWindow()
+    {
+        var cpu = new CpuAccounts(() => _seconds);
+        var guard = _objectManager.CloneObject("/wizards/ann/castle/guard");
+        var rats = new[] { _objectManager.CloneObject("/world/mobs/rat"), _objectManager.CloneObject("/world/mobs/rat") };
+
+        cpu.Charge(guard, 500, 40);
+        cpu.Charge(rats[0], 100, 10);
+        _seconds = 25;
+        cpu.Charge(rats[1], 200, 20);
+        cpu.Charge(rats[1], 300, 30);
+
+        Assert.Equal("/wizards/ann", CpuAccounts.DomainOf(guard.FilePath));
+        Assert.Equal("/world/mobs", CpuAccounts.DomainOf(rats[0].FilePath));
+
+        var rat = cpu.Objects.Single(account => account.Object == rats[1]).Account;
+        Assert.Equal((500L, 50L, 2L), (rat.Instructions, rat.Microseconds, rat.Calls));
+
+        var blueprint = cpu.Blueprints.Single(account => account.Name == "/world/mobs/rat");
+        Assert.Equal(600L, blueprint.Instructions);
+        Assert.Equal(3L, blueprint.Calls);
+        Assert.Equal(500L, cpu.Domains.Single(account => account.Name == "/wizards/ann").Instructions);
+        Assert.Equal((600L, 60L), cpu.Recent(blueprint));
+
+        // A minute after the first charges, only the later ones are recent
+        _seconds = 65;
+        Assert.Equal((500L, 50L), cpu.Recent(blueprint));
+        Assert.Equal((0L, 0L), cpu.Recent(cpu.Domains.Single(account => account.Name == "/wizards/ann")));
+        _seconds = 90;
+        Assert.Equal((0L, 0L), cpu.Recent(blueprint));
+        Assert.Equal(600L, blueprint.Instructions);
+
+        // Destructed objects leave their blueprint's totals behind
+        cpu.Forget(rats[1]);
+        Assert.DoesNotContain(cpu.Objects, account => account.Object == rats[1]);
+        Assert.Equal(600L, cpu.Blueprints.Single(account => account.Name == "/world/mobs/rat").Instructions);
+    }
+
+    [Fact]
+    public void SkipHeartbeat_SlowsObjectsOverBudget_UntilTheirUsageAgesOut()
+    {
+        var cpu = new CpuAccounts(() => _seconds);
+        var busy = _objectManager.CloneObject("/world/mobs/rat");
+        var quiet = _objectManager.CloneObject("/world/mobs/rat");
+        cpu.Charge(busy, 3500, 100);
+        cpu.Charge(quiet, 900, 100);
+
+        int Beats(MudObject obj)
+        {
+            int beats = 0;
+            for (int turn = 0; turn < 40; turn++)
+            {
+                if (!cpu.SkipHeartbeat(obj)) beats++;
+            }
+            return beats;
+        }
+
+        // No budget, no limit
+        Assert.Equal(40, Beats(busy));
+
+        // Three and a half times the budget: one turn in four
+        cpu.Budget = 1000;
+        Assert.Equal(10, Beats(busy));
+        Assert.Equal(30L, cpu.Objects.Single(account => account.Object == busy).Throttled);
+        Assert.Equal(40, Beats(quiet));
+
+        // Far over budget is capped at MaxSlowdown
+        cpu.Charge(busy, 100_000, 100);
+        Assert.Equal(40 / CpuAccounts.MaxSlowdown, Beats(busy));
+
+        _seconds = CpuAccounts.WindowSeconds + CpuAccounts.SlotSeconds;
+        Assert.Equal(40, Beats(busy));
+    }
+}
@@ -132,6 +132,70 @@ void main(string args) {
         Assert.Contains("main", ex.Message);
     }
 
+    [Fact]
+    public void NestedError_TraceListsCallsOutermostFirst()
+    {
+        var obj = _objectManager.LoadObject("/test/nested_error");
+
+        var ex = Assert.Throws<LpcRuntimeException>(() =>
+        {
+            _interpreter.ResetInstructionCount();
+            _interpreter.CallFunctionOnObject(obj, "main", new List<object> { "" });
+        });
+
+        var frames = ex.LpcStackTrace.Split('\n', StringSplitOptions.RemoveEmptyEntries | StringSplitOptions.TrimEntries);
+        Assert.Equal(new[]
+        {
+            "Stack trace:",
+            "/test/nested_error:16 in main()",
+            "/test/nested_error:12 in level1()",
+            "/test/nested_error:8 in level2()",
+            "/test/nested_error:4 in level3()"
+        }, frames);
+    }
+
+    [Fact]
+    public void ErrorAfterInclude_ReportsTheFileAndLineItIsOn()
+    {
+        Directory.CreateDirectory(Path.Combine(_testMudlibPath, "include"));
+        File.WriteAllText(Path.Combine(_testMudlibPath, "include", "helpers.c"), @"
+int helper_value() { return 1; }
+
+void helper_fail() {
+    unknown_helper();
+}
+");
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "after_include.c"), @"
+#include ""/include/helpers""
+
+void main(string args) {
+    int x;
+    helper_fail();
+}
+
+void late() {
+    x_unknown();
+}
+");
+
+        var obj = _objectManager.LoadObject("/test/after_include");
+        Assert.Equal(3, obj.Program.LineMap!.RunCount);
+
+        _interpreter.ResetInstructionCount();
+        var ex = Assert.Throws<LpcRuntimeException>(() =>
+            _interpreter.CallFunctionOnObject(obj, "late", new List<object>()));
+        Assert.Equal("/test/after_include", ex.File);
+        Assert.Equal(10, ex.Line);
+
+        _interpreter.ResetInstructionCount();
+        ex = Assert.Throws<LpcRuntimeException>(() =>
+            _interpreter.CallFunctionOnObject(obj, "main", new List<object> { "" }));
+        Assert.Equal("/include/helpers.c", ex.File);
+        Assert.Equal(5, ex.Line);
+        Assert.Contains("/test/after_include:4 in main()", ex.LpcStackTrace);
+        Assert.Equal("unknown_helper();", _objectManager.ReadSourceLine(ex.File, ex.Line));
+    }
+
     [Fact]
     public void ExecutionLimit_ErrorIncludesLineNumber()
     {
@@ -252,6 +316,31 @@ mixed query_result() {
         Assert.Contains("unknown_func", (string)result);
     }
 
+    [Fact]
+    public void Catch_ReturnsTheErrorLineWithoutTheTrace()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "test", "catch_deep.c"), @"
+mixed fail() {
+    return no_such_function();
+}
+
+mixed main() {
+    return catch(fail());
+}
+");
+
+        var obj = _objectManager.LoadObject("/test/catch_deep");
+        foreach (var bytecode in new[] { false, true })
+        {
+            _interpreter.UseBytecode = bytecode;
+            _interpreter.ResetInstructionCount();
+            var result = Assert.IsType<string>(_interpreter.CallFunctionOnObject(obj, "main", new List<object>()));
+
+            Assert.StartsWith("/test/catch_deep:3: ", result);
+            Assert.DoesNotContain("Stack trace", result);
+        }
+    }
+
     [Fact]
     public void UncaughtThrow_PropagatesAsException()
     {
@@ -0,0 +1,148 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class EventBusTests : IDisposable
+{
+    private readonly string _mudlibPath;
+
+    public EventBusTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_event_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "test"));
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "object.c"), @"
+int emitted(string event, int amount) { return emit(event, amount, this_object()); }
+");
+        File.WriteAllText(Path.Combine(_mudlibPath, "test", "watcher.c"), @"
+string *heard;
+void create() { heard = ({ }); }
+int watch(mixed source, string event) { return subscribe(source, event, ""on_event""); }
+int forget(mixed source, string event) { return unsubscribe(source, event); }
+varargs void on_event(object source, mixed a, mixed b) {
+    heard = heard + ({ object_name(source) + "":"" + (objectp(a) ? object_name(a) : a) });
+}
+string *query_heard() { return heard; }
+mixed subscriptions() { return query_subscriptions(); }
+");
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    [Fact]
+    public void Subscriptions_AreKeptPerSourceAndDroppedWithTheirObjects()
+    {
+        var om = new ObjectManager(_mudlibPath);
+        var a = om.CloneObject("/std/object");
+        var b = om.CloneObject("/std/object");
+        var c = om.CloneObject("/std/object");
+        var bus = om.Events;
+
+        Assert.True(bus.Subscribe(a, "ping", b, "f"));
+        Assert.False(bus.Subscribe(a, "ping", b, "f"));
+        Assert.True(bus.Subscribe(a, "ping", c, "g"));
+        Assert.True(bus.Subscribe(null, "ping", c, "h"));
+        Assert.True(bus.HasSubscribers("ping"));
+        Assert.False(bus.HasSubscribers("pong"));
+        Assert.Equal(new[] { "f", "g" }, bus.For(a, "ping").Select(s => s.Function).ToArray());
+
+        Assert.Equal(1, bus.Unsubscribe(a, "ping", b, null));
+        Assert.Equal(0, bus.Unsubscribe(a, "ping", b, null));
+
+        // The source going takes its subscriptions with it; c keeps its any-source one
+        om.DestructObject(a);
+        Assert.Empty(bus.For(a, "ping"));
+        Assert.Equal((null as MudObject, "ping", "h"), Assert.Single(bus.SubscriptionsOf(c)));
+        om.DestructObject(c);
+        Assert.Equal(0, bus.Count);
+        Assert.False(bus.HasSubscribers("ping"));
+    }
+
+    [Fact]
+    public void Emit_CallsSubscribersWithTheSource()
+    {
+        var om = new ObjectManager(_mudlibPath);
+        om.InitializeInterpreter();
+        var source = om.CloneObject("/std/object");
+        var other = om.CloneObject("/std/object");
+        var watcher = om.CloneObject("/test/watcher");
+        var any = om.CloneObject("/test/watcher");
+        object? Call(MudObject obj, string function, params object[] args) =>
+            om.Interpreter!.CallFunctionOnObject(obj, function, args.ToList());
+
+        Assert.Equal(1L, Call(watcher, "watch", source, "damage"));
+        Assert.Equal(0L, Call(watcher, "watch", source, "damage"));
+        Assert.Equal(1L, Call(any, "watch", 0L, "damage"));
+
+        Assert.Equal(2L, Call(source, "emitted", "damage", 5L));
+        Assert.Equal(1L, Call(other, "emitted", "damage", 7L));
+        Assert.Equal(0L, Call(source, "emitted", "healed", 1L));
+
+        Assert.Equal(new object[] { $"{source.ObjectName}:5" }, (List<object>)Call(watcher, "query_heard")!);
+        Assert.Equal(new object[] { $"{source.ObjectName}:5", $"{other.ObjectName}:7" }, (List<object>)Call(any, "query_heard")!);
+        var subscription = Assert.IsType<List<object>>(Assert.Single((List<object>)Call(watcher, "subscriptions")!));
+        Assert.Equal(new object[] { source, "damage", "on_event" }, subscription);
+
+        Assert.Equal(1L, Call(watcher, "forget", source, "damage"));
+        Assert.Equal(1L, Call(source, "emitted", "damage", 1L));
+
+        // The driver's own events can't be faked
+        var error = Assert.Throws<LpcRuntimeException>(() => Call(source, "emitted", "login", 0L));
+        Assert.Contains("emitted by the driver", error.Message);
+    }
+
+    [Fact]
+    public void MoveObject_EmitsLeaveAndEnter()
+    {
+        File.WriteAllText(Path.Combine(_mudlibPath, "test", "mover.c"), @"
+void move(object what, object where) { move_object(what, where); }
+");
+        var om = new ObjectManager(_mudlibPath);
+        om.InitializeInterpreter();
+        var first = om.CloneObject("/std/object");
+        var second = om.CloneObject("/std/object");
+        var thing = om.CloneObject("/std/object");
+        var watcher = om.CloneObject("/test/watcher");
+        var mover = om.LoadObject("/test/mover");
+        object? Call(MudObject obj, string function, params object[] args) =>
+            om.Interpreter!.CallFunctionOnObject(obj, function, args.ToList());
+
+        Call(watcher, "watch", first, "enter");
+        Call(watcher, "watch", first, "leave");
+        Call(watcher, "watch", second, "enter");
+        Call(mover, "move", thing, first);
+        Call(mover, "move", thing, second);
+
+        Assert.Equal(new object[]
+        {
+            $"{first.ObjectName}:{thing.ObjectName}",
+            $"{first.ObjectName}:{thing.ObjectName}",
+            $"{second.ObjectName}:{thing.ObjectName}"
+        }, (List<object>)Call(watcher, "query_heard")!);
+    }
+
+    [Fact]
+    public void Disconnecting_EmitsLogout()
+    {
+        var om = new ObjectManager(_mudlibPath);
+        om.InitializeInterpreter();
+        var player = om.CloneObject("/std/object");
+        var watcher = om.CloneObject("/test/watcher");
+        om.SetInteractive(player, true);
+        om.Interpreter!.CallFunctionOnObject(watcher, "watch", new List<object> { 0L, "logout" });
+
+        om.SetInteractive(player, false);
+        om.SetInteractive(player, false);
+        om.SetInteractive(player, true);
+        om.DestructObject(player);
+
+        var heard = (List<object>)om.Interpreter.CallFunctionOnObject(watcher, "query_heard", new List<object>())!;
+        Assert.Equal(2, heard.Count);
+    }
+}
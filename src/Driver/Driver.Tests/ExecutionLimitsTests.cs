@@ -132,6 +132,24 @@ int get_sum() {
         Assert.Contains("infinite loop", ex.Message);
     }
 
+    [Theory]
+    [InlineData(false)]
+    [InlineData(true)]
+    public void InfiniteLoop_ReportsLoopLine(bool useBytecode)
+    {
+        _interpreter.UseBytecode = useBytecode;
+        _interpreter.MaxInstructions = 10_000;
+        var obj = _objectManager.LoadObject("/test/infinite_loop");
+
+        _interpreter.ResetInstructionCount();
+        var ex = Assert.Throws<ExecutionLimitException>(() =>
+            _interpreter.CallFunctionOnObject(obj, "main", new List<object> { "" }));
+
+        // The line of the while, found from the loop's own instruction or node
+        Assert.Equal(5, ex.Line);
+        _interpreter.UseBytecode = true;
+    }
+
     [Fact]
     public void InfiniteRecursion_ThrowsExecutionLimitException()
     {
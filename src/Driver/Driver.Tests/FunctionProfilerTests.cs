@@ -0,0 +1,145 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class FunctionProfilerTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ObjectManager _objectManager;
+
+    public FunctionProfilerTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), "lpc_profiler_test_" + Guid.NewGuid().ToString("N")[..8]);
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "base.c"), @"
+int leaf(int n) {
+    int i;
+    int total;
+    for (i = 0; i < n; i++) {
+        total += i;
+    }
+    return total;
+}
+");
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "thing.c"), @"
+inherit ""/std/base"";
+
+int fib(int n) {
+    if (n < 2) return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+int run() {
+    return leaf(50) + leaf(10) + fib(5);
+}
+");
+
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter();
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private object? Run(MudObject obj)
+    {
+        _objectManager.Interpreter!.ResetInstructionCount();
+        return _objectManager.Interpreter.CallFunctionOnObject(obj, "run", new List<object>());
+    }
+
+    private static FunctionProfiler.FunctionStats Find(FunctionProfiler profiler, string function)
+    {
+        return profiler.GetTopFunctions().Single(stats => stats.Function == function);
+    }
+
+    [Fact]
+    public void Disabled_RecordsNothing()
+    {
+        var thing = _objectManager.LoadObject("/std/thing");
+
+        Run(thing);
+
+        Assert.Equal(0, _objectManager.Interpreter!.Profiler.FunctionCount);
+    }
+
+    [Fact]
+    public void Enabled_ChargesCallsAndInstructionsPerFunction()
+    {
+        var thing = _objectManager.LoadObject("/std/thing");
+        var profiler = _objectManager.Interpreter!.Profiler;
+        profiler.Enabled = true;
+
+        Assert.Equal(1225L + 45L + 5L, Run(thing));
+        profiler.Enabled = false;
+
+        var run = Find(profiler, "run");
+        var leaf = Find(profiler, "leaf");
+        var fib = Find(profiler, "fib");
+
+        Assert.Equal(1, run.Calls);
+        Assert.Equal(2, leaf.Calls);
+        Assert.Equal(15, fib.Calls);
+        Assert.StartsWith("/std/base", leaf.Program);
+        Assert.StartsWith("/std/thing", fib.Program);
+
+        // Inclusive cost of run covers everything; self costs add up to it
+        Assert.Equal(run.Instructions, run.SelfInstructions + leaf.Instructions + fib.Instructions);
+        Assert.Equal(run.Instructions, run.SelfInstructions + leaf.SelfInstructions + fib.SelfInstructions);
+
+        // Recursion isn't double counted: fib's inclusive cost is its outermost call
+        Assert.Equal(fib.Instructions, fib.SelfInstructions);
+
+        // leaf(50) loops the most, so it tops the list
+        Assert.Equal("leaf", profiler.GetTopFunctions(1).Single().Function);
+        Assert.Equal(new[] { "fib", "run" },
+            profiler.GetTopFunctions(programPrefix: "/std/thing").Select(stats => stats.Function).OrderBy(f => f).ToArray());
+    }
+
+    [Fact]
+    public void FoldedStacks_FollowTheCallTree()
+    {
+        var thing = _objectManager.LoadObject("/std/thing");
+        var profiler = _objectManager.Interpreter!.Profiler;
+        profiler.Enabled = true;
+        Run(thing);
+        profiler.Enabled = false;
+
+        var lines = profiler.ToFoldedStacks().Split('\n', StringSplitOptions.RemoveEmptyEntries);
+        var stacks = lines.Select(line => line[..line.LastIndexOf(' ')]).ToList();
+
+        var run = Find(profiler, "run").Name;
+        Assert.Contains(run, stacks);
+        Assert.Contains($"{run};{Find(profiler, "leaf").Name}", stacks);
+
+        var fib = Find(profiler, "fib").Name;
+        Assert.Contains($"{run};{fib};{fib};{fib};{fib}", stacks);
+
+        // Weights are self instructions and add up to the whole run
+        var total = lines.Sum(line => long.Parse(line[(line.LastIndexOf(' ') + 1)..]));
+        Assert.Equal(Find(profiler, "run").Instructions, total);
+    }
+
+    [Fact]
+    public void Clear_DropsRecordedFunctions()
+    {
+        var thing = _objectManager.LoadObject("/std/thing");
+        var profiler = _objectManager.Interpreter!.Profiler;
+        profiler.Enabled = true;
+        Run(thing);
+
+        profiler.Clear();
+
+        Assert.Equal(0, profiler.FunctionCount);
+        Assert.Equal("", profiler.ToFoldedStacks());
+
+        Run(thing);
+        Assert.Equal(1, Find(profiler, "run").Calls);
+    }
+}
@@ -93,9 +93,18 @@ void main(string args) {
             _gameLoop.QueueCommand(connectionId, username);
             // Process login commands
             Thread.Sleep(50);
-            // Queue the password
+            // Queue the password; it's checked off the game thread
             _gameLoop.QueueCommand(connectionId, "password123");
-            Thread.Sleep(50);
+            WaitUntil(() => session.LoginState == LoginState.Playing);
+        }
+    }
+
+    private static void WaitUntil(Func<bool> condition)
+    {
+        var deadline = DateTime.UtcNow.AddSeconds(5);
+        while (!condition() && DateTime.UtcNow < deadline)
+        {
+            Thread.Sleep(10);
         }
     }
 
@@ -388,7 +397,7 @@ void main(string args) {
 
         // Enter password
         _gameLoop.QueueCommand("conn-1", "password123");
-        Thread.Sleep(200);
+        WaitUntil(() => _gameLoop.GetSession("conn-1")?.LoginState == LoginState.Playing);
 
         _gameLoop.Stop();
 
@@ -399,6 +408,576 @@ void main(string args) {
         Assert.Equal("logintest", session.AuthenticatedUsername);
     }
 
+    [Fact]
+    public void LoginPrompts_RunWithoutTheGameLoop()
+    {
+        _accountManager.CreateAccount("prompttest", "prompt@test.com", "password123");
+        _gameLoop.CreatePlayerSession("conn-1");
+        _gameLoop.CreatePlayerSession("conn-2");
+
+        // Nothing steps the loop: the login thread handles names and passwords
+        _gameLoop.QueueCommand("conn-2", "new");
+        _gameLoop.QueueCommand("conn-1", "prompttest");
+        _gameLoop.QueueCommand("conn-1", "password123");
+        var session = _gameLoop.GetSession("conn-1")!;
+        WaitUntil(() => session.LoginState == LoginState.Authenticated);
+        Assert.Equal(LoginState.Authenticated, session.LoginState);
+        Assert.Equal(LoginState.RegistrationName, _gameLoop.GetSession("conn-2")!.LoginState);
+        Assert.Equal(0, _gameLoop.Commands.Depth);
+
+        // The game thread takes it from there
+        _gameLoop.Step();
+        Assert.Equal(LoginState.Playing, session.LoginState);
+        Assert.NotNull(session.PlayerObject);
+    }
+
+    [Fact]
+    public void Login_WithWrongPassword_ReturnsToNamePrompt()
+    {
+        _accountManager.CreateAccount("wrongpwtest", "wrong@test.com", "password123");
+        _gameLoop.CreatePlayerSession("conn-1", "10.0.0.1");
+        _gameLoop.Start();
+
+        _gameLoop.QueueCommand("conn-1", "wrongpwtest");
+        Thread.Sleep(100);
+        _gameLoop.QueueCommand("conn-1", "password124");
+        // Input while the hash runs gets a holding reply, not a second attempt
+        _gameLoop.QueueCommand("conn-1", "password123");
+        WaitUntil(() => _gameLoop.GetSession("conn-1")?.LoginState == LoginState.AwaitingName);
+        _gameLoop.Stop();
+
+        var outputs = new List<string>();
+        while (_gameLoop.TryDequeueOutput(out var output)) outputs.Add(output!.Content);
+        Assert.Contains(outputs, o => o.Contains("Invalid password."));
+        Assert.Null(_gameLoop.GetSession("conn-1")!.AuthenticatedUsername);
+        Assert.Equal(0, _gameLoop.LoginHasher.InFlight);
+    }
+
+    [Fact]
+    public void SendToPlayer_RoutesByPlayerObject()
+    {
+        _gameLoop.Start();
+        CreateAuthenticatedSession("conn-1", "routetesta");
+        CreateAuthenticatedSession("conn-2", "routetestb");
+        Thread.Sleep(100);
+        _gameLoop.Stop();
+
+        var first = _gameLoop.GetSession("conn-1")!.PlayerObject!;
+        var second = _gameLoop.GetSession("conn-2")!.PlayerObject!;
+        while (_gameLoop.TryDequeueOutput(out _)) { }
+
+        Assert.True(_gameLoop.SendToPlayer(second, "hello b"));
+        Assert.True(_gameLoop.TryDequeueOutput(out var output));
+        Assert.Equal("conn-2", output!.ConnectionId);
+        Assert.True(_gameLoop.SendToPlayer(first, "hello a"));
+        Assert.True(_gameLoop.TryDequeueOutput(out output));
+        Assert.Equal("conn-1", output!.ConnectionId);
+
+        // Linkdead players have no connection to route to
+        _gameLoop.RemovePlayerSession("conn-1");
+        Assert.False(_gameLoop.SendToPlayer(first, "hello a"));
+    }
+
+    [Fact]
+    public void TellRoomTmpl_FillsInNamesForEachViewer()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "crier.c"), @"
+int tell(object room, string template, mixed actor, mixed target, mixed exclude) {
+    return tell_room_tmpl(room, template, actor, target, exclude);
+}
+");
+        _gameLoop.Start();
+        CreateAuthenticatedSession("conn-1", "tmpltesta");
+        CreateAuthenticatedSession("conn-2", "tmpltestb");
+        CreateAuthenticatedSession("conn-3", "tmpltestc");
+        Thread.Sleep(100);
+        _gameLoop.Stop();
+
+        var players = new[] { "conn-1", "conn-2", "conn-3" }.Select(id => _gameLoop.GetSession(id)!.PlayerObject!).ToArray();
+        var room = _objectManager.CloneObject("/std/object");
+        var crier = _objectManager.CloneObject("/std/crier");
+        var names = new[] { "Alice", "bob", "Carol" };
+        for (int i = 0; i < players.Length; i++)
+        {
+            _objectManager.Interpreter!.ResetInstructionCount();
+            _objectManager.Interpreter.CallFunctionOnObject(players[i], "set_short", new List<object> { names[i] });
+            players[i].MoveTo(room);
+        }
+        while (_gameLoop.TryDequeueOutput(out _)) { }
+
+        Dictionary<string, string> Tell(string template, object actor, object target, object exclude)
+        {
+            _objectManager.Interpreter!.ResetInstructionCount();
+            var told = _objectManager.Interpreter.CallFunctionOnObject(crier, "tell", new List<object> { room, template, actor, target, exclude });
+            var seen = new Dictionary<string, string>();
+            while (_gameLoop.TryDequeueOutput(out var output)) seen[output!.ConnectionId] = output.Content;
+            Assert.Equal((long)seen.Count, Convert.ToInt64(told));
+            return seen;
+        }
+
+        var seen = Tell("$P sword grazes $t.", players[0], players[1], 0L);
+        Assert.Equal("Your sword grazes bob.", seen["conn-1"]);
+        Assert.Equal("Alice's sword grazes you.", seen["conn-2"]);
+        Assert.Equal("Alice's sword grazes bob.", seen["conn-3"]);
+
+        // Names given as strings are used as they are; excluded players hear nothing
+        seen = Tell("$N hits $T. $x$", "a grey wolf", players[2], new List<object> { players[0] });
+        Assert.Equal(new[] { "conn-2", "conn-3" }, seen.Keys.Order().ToArray());
+        Assert.Equal("A grey wolf hits Carol. $x$", seen["conn-2"]);
+        Assert.Equal("A grey wolf hits You. $x$", seen["conn-3"]);
+
+        // An object's name is kept until its description changes
+        _objectManager.Interpreter!.ResetInstructionCount();
+        _objectManager.Interpreter.CallFunctionOnObject(players[0], "set_short", new List<object> { "Alicia" });
+        Assert.Equal("Alice leaves.", Tell("$N leaves.", players[0], 0L, players[0])["conn-2"]);
+        players[0].DescriptionChanged();
+        Assert.Equal("Alicia leaves.", Tell("$N leaves.", players[0], 0L, players[0])["conn-2"]);
+    }
+
+    [Fact]
+    public void Callouts_FindAndRemove_UseTheObjectsEarliestMatch()
+    {
+        var first = _objectManager.LoadObject("/std/object");
+        var second = _objectManager.CloneObject("/std/object");
+
+        _gameLoop.ScheduleCallout(first, "set_short", new List<object> { "late" }, 60);
+        _gameLoop.ScheduleCallout(first, "set_short", new List<object> { "soon" }, 5);
+        var otherId = _gameLoop.ScheduleCallout(second, "set_short", new List<object> { "other" }, 1);
+
+        // Tick-granular: nothing has elapsed yet (allow for a tick boundary)
+        Assert.InRange(_gameLoop.FindCallout(first, "set_short"), 4, 5);
+        Assert.Equal(-1, _gameLoop.FindCallout(first, "query_short"));
+
+        // Removes the 5s callout; the 60s one is next
+        Assert.InRange(_gameLoop.RemoveCalloutByFunction(first, "set_short"), 4, 5);
+        Assert.InRange(_gameLoop.FindCallout(first, "set_short"), 59, 60);
+
+        Assert.InRange(_gameLoop.RemoveCalloutById(otherId), 0, 1);
+        Assert.Equal(-1, _gameLoop.RemoveCalloutById(otherId));
+        Assert.Equal(-1, _gameLoop.FindCallout(second, "set_short"));
+        Assert.Equal(1, _gameLoop.PendingTimerCount);
+    }
+
+    [Fact]
+    public void Callout_FiresFromTheRunningLoop()
+    {
+        var obj = _objectManager.LoadObject("/std/object");
+        _gameLoop.ScheduleCallout(obj, "set_short", new List<object> { "fired" }, 0);
+
+        _gameLoop.Start();
+        WaitUntil(() => _gameLoop.PendingTimerCount == 0);
+        Thread.Sleep(50);
+        _gameLoop.Stop();
+
+        _objectManager.Interpreter!.ResetInstructionCount();
+        Assert.Equal("fired", _objectManager.Interpreter.CallFunctionOnObject(obj, "query_short", new List<object>()));
+    }
+
+    [Fact]
+    public void Effects_ReplaceQueryAndRemove_OnePendingTimerEach()
+    {
+        var target = _objectManager.CloneObject("/std/object");
+        var caster = _objectManager.LoadObject("/std/object");
+
+        _gameLoop.AddEffect(target, caster, "shield", 60, "set_short", "set_short", 2);
+        _gameLoop.AddEffect(target, caster, "drunk", 30, null, "set_short", 2);
+        Assert.Equal(60, _gameLoop.QueryEffect(target, "shield"));
+        Assert.Equal(-1, _gameLoop.QueryEffect(caster, "shield"));
+
+        // Adding it again replaces it rather than stacking
+        _gameLoop.AddEffect(target, caster, "shield", 10, "set_short", "set_short", 2);
+        Assert.Equal(10, _gameLoop.QueryEffect(target, "shield"));
+        Assert.Equal(2, _gameLoop.PendingTimerCount);
+        Assert.Equal(new[] { "drunk", "shield" }, _gameLoop.QueryEffects(target).Keys.OrderBy(id => id));
+
+        Assert.InRange(_gameLoop.RemoveEffect(target, "shield"), 9, 10);
+        Assert.Equal(-1, _gameLoop.RemoveEffect(target, "shield"));
+        Assert.Equal(1, _gameLoop.PendingTimerCount);
+        Assert.Equal(1, _gameLoop.EffectTargets);
+    }
+
+    [Fact]
+    public void Effect_TicksThenExpires_FromTheRunningLoop()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "glow.c"), @"
+int ticks;
+string ended;
+void start(object ob) { add_effect(ob, ""glow"", 2, ""glow"", ""fade"", 1); }
+void glow(object ob, string id, int left) { ticks++; }
+void fade(object ob, string id) { ended = id; }
+int query_ticks() { return ticks; }
+string query_ended() { return ended; }
+");
+        var spell = _objectManager.LoadObject("/std/glow");
+        var target = _objectManager.CloneObject("/std/object");
+        var interpreter = _objectManager.Interpreter!;
+        interpreter.ResetInstructionCount();
+        interpreter.CallFunctionOnObject(spell, "start", new List<object> { target });
+
+        _gameLoop.Start();
+        WaitUntil(() => _gameLoop.PendingTimerCount == 0);
+        _gameLoop.Stop();
+
+        // One tick call a second in, then the expiry at two
+        interpreter.ResetInstructionCount();
+        Assert.Equal(1L, Convert.ToInt64(interpreter.CallFunctionOnObject(spell, "query_ticks", new List<object>())));
+        Assert.Equal("glow", interpreter.CallFunctionOnObject(spell, "query_ended", new List<object>()));
+        Assert.Equal(0, _gameLoop.EffectTargets);
+    }
+
+    [Fact]
+    public void DestructedObjects_AreReleasedAtTheEndOfTheTick()
+    {
+        var corpse = _objectManager.CloneObject("/std/object");
+        _gameLoop.ScheduleCallout(corpse, "set_short", new List<object> { "rotting" }, 60);
+        _gameLoop.RegisterReset(corpse, 600);
+        _gameLoop.AddEffect(corpse, corpse, "decay", 300, null, "set_short", 2);
+        Assert.Equal(3, _gameLoop.PendingTimerCount);
+
+        _objectManager.DestructObject(corpse);
+        Assert.True(corpse.HasVariable("short_desc"));
+
+        _gameLoop.Start();
+        WaitUntil(() => _gameLoop.PendingTimerCount == 0);
+        _gameLoop.Stop();
+
+        Assert.Equal(-1, _gameLoop.FindCallout(corpse, "set_short"));
+        Assert.Equal(-1, _gameLoop.QueryEffect(corpse, "decay"));
+        Assert.False(corpse.HasVariable("short_desc"));
+        Assert.True(corpse.IsDestructed);
+    }
+
+    [Fact]
+    public void CleanUp_UnloadsIdleRoomsAndTheirContents()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "room.c"), @"
+inherit ""/std/object"";
+int clean_up(int inherited) {
+    if (inherited) return 0;
+    destruct(this_object());
+    return 1;
+}
+");
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "cave.c"), @"
+inherit ""/std/room"";
+");
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "hall.c"), @"
+inherit ""/std/room"";
+");
+        _gameLoop.CleanUpIdleSeconds = 60;
+        var cave = _objectManager.LoadObject("/std/cave");
+        var hall = _objectManager.LoadObject("/std/hall");
+        var rock = _objectManager.CloneObject("/std/object");
+        var lamp = _objectManager.CloneObject("/std/object");
+        rock.MoveTo(cave);
+        lamp.MoveTo(hall);
+        var room = _objectManager.FindObject("/std/room")!;
+
+        long later = Environment.TickCount64 + 61_000;
+        lamp.LastReferenced = later;    // something in the hall was just used
+        Assert.Equal(1, _gameLoop.RunCleanUp(later));
+
+        Assert.True(cave.IsDestructed);
+        Assert.True(rock.IsDestructed);
+        Assert.Null(_objectManager.FindObject("/std/cave"));
+        Assert.False(hall.IsDestructed);
+        // Inherited: kept, and not asked again
+        Assert.False(room.IsDestructed);
+        Assert.True(room.NoCleanUp);
+    }
+
+    [Fact]
+    public void Snapshot_RestoresObjectsWhereTheyWere()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "box.c"), @"
+inherit ""/std/object"";
+object holder;
+");
+        var room = _objectManager.LoadObject("/std/box");
+        var chest = _objectManager.CloneObject("/std/box");
+        var coin = _objectManager.CloneObject("/std/object");
+        chest.MoveTo(room);
+        coin.MoveTo(chest);
+        chest.SetVariable("holder", room);
+        coin.SetVariable("short_desc", "a coin");
+        _gameLoop.ScheduleCallout(coin, "set_short", new List<object> { "a tarnished coin" }, 30);
+        _gameLoop.AddEffect(coin, chest, "tarnish", 90, null, "set_short", 2);
+        _gameLoop.RegisterReset(chest, 600);
+        _objectManager.Events.Subscribe(room, "enter", chest, "set_short");
+
+        var path = Path.Combine(_testMudlibPath, "world.snapshot");
+        var snapshot = new WorldSnapshot(path, _objectManager);
+        File.WriteAllBytes(path, snapshot.Capture(_gameLoop));
+
+        // Nothing changed, so the next snapshot reuses every object's encoding
+        snapshot.Capture(_gameLoop);
+        Assert.Equal(snapshot.LastObjectCount, snapshot.LastReusedCount);
+
+        var objectManager = new ObjectManager(_testMudlibPath);
+        objectManager.InitializeInterpreter();
+        var gameLoop = new GameLoop(objectManager, _accountManager);
+        gameLoop.InitializeInterpreter(new ObjectInterpreter(objectManager));
+        try
+        {
+            Assert.Equal(snapshot.LastObjectCount, WorldSnapshot.Restore(path, objectManager, gameLoop));
+
+            var newRoom = objectManager.FindObject("/std/box")!;
+            var newChest = objectManager.FindObject(chest.ObjectName)!;
+            var newCoin = objectManager.FindObject(coin.ObjectName)!;
+            Assert.Same(newRoom, newChest.Environment);
+            Assert.Same(newChest, newCoin.Environment);
+            Assert.Same(newRoom, newChest.GetVariable("holder"));
+            Assert.Equal("a coin", newCoin.GetVariable("short_desc"));
+            Assert.Equal(600, newChest.ResetInterval);
+            Assert.InRange(gameLoop.FindCallout(newCoin, "set_short"), 29, 30);
+            Assert.InRange(gameLoop.QueryEffect(newCoin, "tarnish"), 89, 90);
+            Assert.Equal(new EventBus.Subscription(newChest, "set_short"), Assert.Single(objectManager.Events.For(newRoom, "enter")));
+
+            // New clones are numbered after the restored ones
+            Assert.True(objectManager.CloneObject("/std/box").CloneNumber > chest.CloneNumber);
+        }
+        finally
+        {
+            gameLoop.Stop();
+        }
+    }
+
+    [Fact]
+    public void RunningLoop_FeedsTheTickProfiler()
+    {
+        _gameLoop.Start();
+        WaitUntil(() => _gameLoop.TickProfiler.Ticks >= 3);
+        _gameLoop.Stop();
+
+        var (ticks, phaseCounts) = _gameLoop.TickProfiler.Read((tick, phases, slow) =>
+            (tick.Count, phases.Select(phase => phase.Count).ToList()));
+        Assert.True(ticks >= 3);
+        Assert.Equal(Enumerable.Repeat(ticks, phaseCounts.Count), phaseCounts);
+    }
+
+    [Fact]
+    public void Post_RunsOnTheGameThread()
+    {
+        // Not running: the caller is the game thread
+        Thread? ranOn = null;
+        _gameLoop.Post(() => ranOn = Thread.CurrentThread);
+        Assert.Same(Thread.CurrentThread, ranOn);
+
+        _gameLoop.Start();
+        ranOn = null;
+        _gameLoop.Post(() => ranOn = Thread.CurrentThread);
+        WaitUntil(() => ranOn != null);
+        _gameLoop.Stop();
+
+        Assert.Equal("GameLoop", ranOn!.Name);
+        Assert.False(ReferenceEquals(Thread.CurrentThread, ranOn));
+    }
+
+    [Fact]
+    public void DisconnectSession_LogsOutOnTheGameThread()
+    {
+        _gameLoop.Start();
+        CreateAuthenticatedSession("conn-1", "overflowtest");
+        var player = _gameLoop.GetSession("conn-1")!.PlayerObject!;
+
+        // Hold the game thread; the network thread's call must not do the work itself
+        using var release = new ManualResetEventSlim();
+        _gameLoop.Post(() => release.Wait());
+        _gameLoop.DisconnectSession("conn-1");
+        Assert.NotNull(_gameLoop.GetSession("conn-1"));
+        Assert.False(player.IsDestructed);
+
+        release.Set();
+        WaitUntil(() => _gameLoop.GetSession("conn-1") == null && player.IsDestructed);
+        _gameLoop.Stop();
+
+        Assert.Null(_gameLoop.GetSession("conn-1"));
+        Assert.True(player.IsDestructed);
+        Assert.Empty(_gameLoop.GetLinkdeadSessions());
+    }
+
+    [Fact]
+    public void Linkdead_SchedulesExpiryAndReconnectCancelsIt()
+    {
+        _gameLoop.Start();
+        CreateAuthenticatedSession("conn-1", "expirytest");
+        WaitUntil(() => _gameLoop.GetSession("conn-1")?.LoginState == LoginState.Playing);
+        var session = _gameLoop.GetSession("conn-1")!;
+        var player = session.PlayerObject!;
+        Assert.Same(session, player.Session);
+
+        // The network thread's disconnect is handled on the game thread
+        _gameLoop.RemovePlayerSession("conn-1");
+        WaitUntil(() => _gameLoop.GetLinkdeadSessions().Count == 1 && _gameLoop.PendingTimerCount == 1);
+        Assert.Null(player.Session);
+        Assert.False(_gameLoop.SendToPlayer(player, "anyone there?\n"));
+
+        _gameLoop.CreatePlayerSession("conn-2");
+        _gameLoop.QueueCommand("conn-2", "expirytest");
+        Thread.Sleep(50);
+        _gameLoop.QueueCommand("conn-2", "password123");
+        WaitUntil(() => _gameLoop.GetLinkdeadSessions().Count == 0);
+        _gameLoop.Stop();
+
+        Assert.Empty(_gameLoop.GetLinkdeadSessions());
+        Assert.Equal(0, _gameLoop.PendingTimerCount);
+        Assert.Same(session, player.Session);
+        Assert.Equal("conn-2", player.ConnectionId);
+        Assert.True(_gameLoop.SendToPlayer(player, "welcome back\n"));
+    }
+
+    [Fact]
+    public void Status_IsPublishedEachTickWithPlayersAndLocations()
+    {
+        Assert.Empty(_gameLoop.Status.Players);
+        _gameLoop.Start();
+        CreateAuthenticatedSession("conn-1", "statustest");
+        var player = _gameLoop.GetSession("conn-1")!.PlayerObject!;
+        var room = _objectManager.CloneObject("/std/object");
+        _gameLoop.Post(() => player.MoveTo(room));
+
+        WaitUntil(() => _gameLoop.Status.Players.Any(p => p.Location != null));
+        var status = _gameLoop.Status;
+        var entry = Assert.Single(status.Players);
+        Assert.Equal("statustest", entry.Name);
+        Assert.Equal(room.ObjectName, entry.Location);
+        Assert.False(entry.Linkdead);
+        Assert.True(status.Ticks > 0);
+
+        // Published copies are never changed, only replaced
+        _gameLoop.RemovePlayerSession("conn-1");
+        WaitUntil(() => _gameLoop.Status.Players.Any(p => p.Linkdead));
+        Assert.False(entry.Linkdead);
+        _gameLoop.Stop();
+
+        var json = System.Text.Encoding.UTF8.GetString(_gameLoop.Status.ToJson());
+        Assert.Contains("\"name\":\"statustest\"", json);
+        Assert.Contains("\"linkdead\":true", json);
+        Assert.Contains("\"uptime_seconds\":", json);
+    }
+
+    [Fact]
+    public void Heartbeats_AreSpreadEvenlyAcrossTicks()
+    {
+        var objects = Enumerable.Range(0, 50).Select(_ => _objectManager.CloneObject("/std/object")).ToList();
+        foreach (var obj in objects)
+        {
+            _gameLoop.RegisterHeartbeat(obj);
+        }
+
+        var sizes = _gameLoop.GetHeartbeatBucketSizes();
+        Assert.Equal(50, sizes.Sum());
+        Assert.True(sizes.Max() - sizes.Min() <= 1);
+
+        // Unregistering from the middle of a bucket keeps the rest registered
+        _gameLoop.UnregisterHeartbeat(objects[0]);
+        _gameLoop.UnregisterHeartbeat(objects[20]);
+        Assert.False(_gameLoop.HasHeartbeat(objects[0]));
+        Assert.True(_gameLoop.HasHeartbeat(objects[40]));
+        Assert.Equal(48, _gameLoop.GetHeartbeatBucketSizes().Sum());
+
+        _gameLoop.RegisterHeartbeat(objects[0]);
+        _gameLoop.RegisterHeartbeat(objects[0]);
+        Assert.Equal(49, _gameLoop.GetHeartbeatBucketSizes().Sum());
+    }
+
+    [Fact]
+    public void Dormancy_SuspendsHeartbeatsUntilAPlayerArrives()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "beater.c"), @"
+int beats;
+int slept;
+void heart_beat() { beats++; slept = slept + query_dormant_elapsed(); }
+int query_beats() { return beats; }
+int query_slept() { return slept; }
+");
+        var emptyRoom = _objectManager.CloneObject("/std/object");
+        var occupiedRoom = _objectManager.CloneObject("/std/object");
+        var player = _objectManager.CloneObject("/std/object");
+        player.IsInteractive = true;
+        player.MoveTo(occupiedRoom);
+
+        var idle = _objectManager.CloneObject("/std/beater");
+        var watched = _objectManager.CloneObject("/std/beater");
+        var daemon = _objectManager.CloneObject("/std/beater");
+        idle.MoveTo(emptyRoom);
+        watched.MoveTo(occupiedRoom);
+
+        _gameLoop.HeartbeatDormancy = true;
+        foreach (var obj in new[] { idle, watched, daemon })
+        {
+            _gameLoop.RegisterHeartbeat(obj);
+        }
+
+        _gameLoop.Start();
+        Thread.Sleep(2300);
+        _gameLoop.Stop();
+
+        long Beats(MudObject obj)
+        {
+            _objectManager.Interpreter!.ResetInstructionCount();
+            return Convert.ToInt64(_objectManager.Interpreter.CallFunctionOnObject(obj, "query_beats", new List<object>()));
+        }
+        Assert.Equal(0L, Beats(idle));
+        Assert.True(Beats(watched) >= 1);
+        Assert.True(Beats(daemon) >= 1);
+        Assert.True(_gameLoop.IsDormant(idle));
+
+        // A player walks in: the next beat reports how long it slept
+        var visitor = _objectManager.CloneObject("/std/object");
+        visitor.IsInteractive = true;
+        visitor.MoveTo(emptyRoom);
+        Assert.False(_gameLoop.IsDormant(idle));
+
+        _gameLoop.Start();
+        Thread.Sleep(2300);
+        _gameLoop.Stop();
+
+        _objectManager.Interpreter!.ResetInstructionCount();
+        var slept = Convert.ToInt64(_objectManager.Interpreter.CallFunctionOnObject(idle, "query_slept", new List<object>()));
+        Assert.True(Beats(idle) >= 1);
+        Assert.True(slept >= 1, $"slept {slept}");
+    }
+
+    [Fact]
+    public void RegionThreads_RunAreaHeartbeatsOnWorkers()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "beater.c"), @"
+int beats;
+void heart_beat() { beats++; }
+int query_beats() { return beats; }
+");
+        Directory.CreateDirectory(Path.Combine(_testMudlibPath, "world", "rooms", "town"));
+        File.WriteAllText(Path.Combine(_testMudlibPath, "world", "rooms", "town", "square.c"), "void create() { }\n");
+
+        var square = _objectManager.LoadObject("/world/rooms/town/square");
+        var local = _objectManager.CloneObject("/std/beater");
+        var daemon = _objectManager.CloneObject("/std/beater");
+        local.MoveTo(square);
+        _gameLoop.RegisterHeartbeat(local);
+        _gameLoop.RegisterHeartbeat(daemon);
+
+        _gameLoop.RegionThreads = 2;
+        _gameLoop.Start();
+        Assert.Equal(2, _gameLoop.RegionWorkers!.Count);
+        Thread.Sleep(2300);
+        _gameLoop.Stop();
+        Assert.Null(_gameLoop.RegionWorkers);
+
+        long Beats(MudObject obj)
+        {
+            _objectManager.Interpreter!.ResetInstructionCount();
+            return Convert.ToInt64(_objectManager.Interpreter.CallFunctionOnObject(obj, "query_beats", new List<object>()));
+        }
+        Assert.True(Beats(local) >= 1, $"local {Beats(local)}");
+        Assert.True(Beats(daemon) >= 1, $"daemon {Beats(daemon)}");
+
+        // Charged to each object's CPU account whichever thread ran it
+        Assert.All(new[] { local, daemon }, obj =>
+            Assert.True(_gameLoop.Cpu.Objects.Single(account => account.Object == obj).Account.Instructions > 0));
+        Assert.Contains(_gameLoop.Cpu.Domains, account => account.Name == "/std");
+    }
+
     [Fact]
     public void Login_WithInvalidPassword_ShowsError()
     {
@@ -0,0 +1,160 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class HeartbeatSandboxTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ObjectManager _objectManager;
+
+    public HeartbeatSandboxTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_sandbox_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "counter.c"), @"
+int total;
+void bump() { total++; }
+int query_total() { return total; }
+");
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "mob.c"), @"
+int hp;
+object friend;
+mixed *notes;
+
+void set_friend(object ob) { friend = ob; }
+void set_notes(mixed *arr) { notes = arr; }
+int query_hp() { return hp; }
+
+void regen() { hp = hp + 3; }
+
+void heart_beat() {
+    regen();
+    if (hp >= 6) tell_object(this_object(), ""You are fully healed.\n"");
+    if (friend) call_other(friend, ""bump"");
+    if (notes) catch(notes[0] = hp);
+}
+");
+
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter();
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private long Call(MudObject obj, string function)
+    {
+        var interpreter = _objectManager.Interpreter!;
+        interpreter.ResetInstructionCount();
+        return Convert.ToInt64(interpreter.CallFunctionOnObject(obj, function, new List<object>()));
+    }
+
+    private void Set(MudObject obj, string function, object value)
+    {
+        _objectManager.Interpreter!.CallFunctionOnObject(obj, function, new List<object> { value });
+    }
+
+    private bool Speculate(HeartbeatSandbox sandbox, MudObject mob)
+    {
+        sandbox.Begin(mob);
+        _objectManager.Interpreter!.CallInSandbox(sandbox, mob, "heart_beat");
+        return sandbox.End();
+    }
+
+    [Fact]
+    public void SelfContainedHeartbeat_KeepsItsWritesAndDefersMessages()
+    {
+        var mob = _objectManager.CloneObject("/std/mob");
+        var sandbox = new HeartbeatSandbox();
+
+        Assert.True(Speculate(sandbox, mob));
+        Assert.True(Speculate(sandbox, mob));
+
+        Assert.Equal(6L, Call(mob, "query_hp"));
+        Assert.Null(sandbox.AbortReason);
+        Assert.Equal(1, sandbox.EffectCount);
+    }
+
+    [Fact]
+    public void DeferredSyslog_IsReplayedAsItsObject()
+    {
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "noisy.c"), @"
+void heart_beat() { syslog(""debug"", ""beat""); }
+");
+        var noisy = _objectManager.CloneObject("/std/noisy");
+        var sandbox = new HeartbeatSandbox();
+
+        Assert.True(Speculate(sandbox, noisy));
+        Assert.Equal(1, sandbox.EffectCount);
+
+        Assert.Equal(0, sandbox.ApplyEffects(_objectManager.Interpreter!));
+        Assert.Equal(0, sandbox.EffectCount);
+    }
+
+    [Fact]
+    public void CallIntoAnotherObject_RollsBackAndDropsMessages()
+    {
+        var mob = _objectManager.CloneObject("/std/mob");
+        var counter = _objectManager.CloneObject("/std/counter");
+        Set(mob, "set_friend", counter);
+        var sandbox = new HeartbeatSandbox();
+
+        Assert.False(Speculate(sandbox, mob));
+
+        Assert.Contains(counter.ObjectName, sandbox.AbortReason);
+        Assert.Equal(0L, Call(mob, "query_hp"));
+        Assert.Equal(0L, Call(counter, "query_total"));
+        Assert.Equal(0, sandbox.EffectCount);
+    }
+
+    [Fact]
+    public void ArrayAssignment_AbortsEvenInsideCatch()
+    {
+        var mob = _objectManager.CloneObject("/std/mob");
+        var notes = new List<object> { 0L };
+        Set(mob, "set_notes", notes);
+        var sandbox = new HeartbeatSandbox();
+
+        Assert.False(Speculate(sandbox, mob));
+
+        Assert.Equal(0L, notes[0]);
+        Assert.Equal(0L, Call(mob, "query_hp"));
+    }
+
+    [Fact]
+    public void GameLoop_RunsSandboxesInParallelAndRerunsTheRest()
+    {
+        var accountManager = new AccountManager(_mudlibPath);
+        var gameLoop = new GameLoop(_objectManager, accountManager) { ParallelHeartbeats = true };
+        gameLoop.InitializeInterpreter(new ObjectInterpreter(_objectManager));
+
+        var counter = _objectManager.CloneObject("/std/counter");
+        var mobs = Enumerable.Range(0, 400).Select(_ => _objectManager.CloneObject("/std/mob")).ToList();
+        foreach (var social in mobs.Take(20))
+        {
+            Set(social, "set_friend", counter);
+        }
+        mobs.ForEach(gameLoop.RegisterHeartbeat);
+
+        // Heartbeats are spread over the ticks of their period; 400 fill each tick enough to go parallel
+        gameLoop.Start();
+        Thread.Sleep(2300);
+        gameLoop.Stop();
+
+        // Every mob beats the same number of times, sandboxed or not
+        var hp = mobs.Select(mob => Call(mob, "query_hp")).ToList();
+        Assert.True(hp.Min() >= 3, $"hp {hp.Min()}");
+        Assert.True(gameLoop.SandboxedHeartbeats >= 380, $"sandboxed {gameLoop.SandboxedHeartbeats}");
+        Assert.True(gameLoop.SandboxAborts >= 20, $"aborts {gameLoop.SandboxAborts}");
+
+        // The social mobs' calls ran exactly once per beat, on the game thread
+        Assert.Equal(mobs.Take(20).Sum(mob => Call(mob, "query_hp")) / 3, Call(counter, "query_total"));
+    }
+}
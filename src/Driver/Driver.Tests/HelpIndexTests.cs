@@ -0,0 +1,43 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class HelpIndexTests
+{
+    [Fact]
+    public void Lookup_And_Search_FollowEditsUnderHelp()
+    {
+        var tempDir = Path.Combine(Path.GetTempPath(), "help_test_" + Guid.NewGuid().ToString("N")[..8]);
+        Directory.CreateDirectory(Path.Combine(tempDir, "help", "commands"));
+        Directory.CreateDirectory(Path.Combine(tempDir, "help", "topics"));
+        File.WriteAllText(Path.Combine(tempDir, "help", "commands", "look"), "Look at your surroundings.\n");
+        File.WriteAllText(Path.Combine(tempDir, "help", "topics", "look"), "Shadowed by the command.\n");
+        File.WriteAllText(Path.Combine(tempDir, "help", "topics", "combat"), "Fighting: see also look.\n");
+
+        try
+        {
+            using var help = new HelpIndex(tempDir, watch: true, TimeSpan.FromMilliseconds(50));
+
+            Assert.Equal("Look at your surroundings.\n", help.Lookup("LOOK"));
+            Assert.Null(help.Lookup("magic"));
+            Assert.Equal(new[] { "combat", "look" }, help.List("topics"));
+            Assert.Equal(new[] { "look", "combat" }, help.Search("look"));
+            Assert.Equal(new[] { "combat" }, help.Search("com"));
+
+            File.WriteAllText(Path.Combine(tempDir, "help", "topics", "magic"), "Casting spells.\n");
+
+            var deadline = DateTime.UtcNow.AddSeconds(10);
+            while (help.Lookup("magic") == null && DateTime.UtcNow < deadline)
+            {
+                Thread.Sleep(20);
+            }
+
+            Assert.Equal("Casting spells.\n", help.Lookup("magic"));
+            Assert.Equal(new[] { "magic" }, help.Search("spells"));
+        }
+        finally
+        {
+            Directory.Delete(tempDir, recursive: true);
+        }
+    }
+}
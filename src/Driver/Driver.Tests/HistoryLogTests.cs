@@ -0,0 +1,66 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class HistoryLogTests : IDisposable
+{
+    private readonly string _dir;
+
+    public HistoryLogTests()
+    {
+        _dir = Path.Combine(Path.GetTempPath(), $"history_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(_dir);
+    }
+
+    public void Dispose()
+    {
+        AsyncFileWriter.Shared.Flush();
+        Directory.Delete(_dir, recursive: true);
+    }
+
+    [Fact]
+    public void Ring_KeepsTheNewestEntries()
+    {
+        var log = new HistoryLog(3);
+        for (long i = 1; i <= 5; i++)
+        {
+            log.Add(i);
+        }
+
+        Assert.Equal(3, log.Count);
+        Assert.Equal(new object[] { 3L, 4L, 5L }, log.GetLast(0).ToArray());
+        Assert.Equal(new object[] { 4L, 5L }, log.GetLast(2).ToArray());
+
+        log.Resize(2);
+        Assert.Equal(new object[] { 4L, 5L }, log.GetLast(0).ToArray());
+        log.Resize(4);
+        log.Add(6L);
+        Assert.Equal(new object[] { 4L, 5L, 6L }, log.GetLast(10).ToArray());
+    }
+
+    [Fact]
+    public void Log_AppendsCompactsAndReloads()
+    {
+        var path = Path.Combine(_dir, "chat_test.json");
+        File.WriteAllText(path, "100|Testold|hi|there\n\n");
+
+        var log = new HistoryLog(4);
+        log.Attach(path);
+        Assert.Equal(new object[] { "100|Testold|hi|there" }, log.GetLast(0).ToArray());
+
+        log.Add(new Dictionary<object, object> { ["sender"] = "Testuser", ["message"] = "one" });
+        AsyncFileWriter.Shared.Flush();
+        Assert.Equal(3, File.ReadAllLines(path).Length);
+
+        for (long i = 0; i < 10; i++)
+        {
+            log.Add(i);
+        }
+        AsyncFileWriter.Shared.Flush();
+        Assert.True(File.ReadAllLines(path).Length <= 8);
+
+        var reloaded = new HistoryLog(4);
+        reloaded.Attach(path);
+        Assert.Equal(new object[] { 6L, 7L, 8L, 9L }, reloaded.GetLast(0).ToArray());
+    }
+}
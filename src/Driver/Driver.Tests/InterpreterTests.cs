@@ -678,6 +678,44 @@ public class InterpreterTests
         Assert.Equal(42L, Eval("to_int(42)"));
     }
 
+    [Fact]
+    public void Evaluate_ArrayScans()
+    {
+        Assert.Equal(2L, Eval("member_array(3, ({ 1, \"3\", 3 }))"));
+        Assert.Equal(1L, Eval("member_array(\"b\", ({ \"a\", \"b\" }))"));
+        Assert.Equal(-1L, Eval("member_array(({ 1 }), ({ ({ 1 }) }))"));
+        Assert.Equal(-2L, Eval("min(({ 4, -2, 7 }))"));
+        Assert.Equal(7L, Eval("max(({ 4, -2, 7 }))"));
+        Assert.Equal(9L, Eval("sum(({ 4, -2, 7 }))"));
+        Assert.Equal(0L, Eval("sum(({ }))"));
+    }
+
+    [Fact]
+    public void Evaluate_ExplodeAndImplode()
+    {
+        Assert.Equal(new List<object> { "a", "", "b", "" }, Eval("explode(\"a,,b,\", \",\")"));
+        Assert.Equal(new List<object> { "ab" }, Eval("explode(\"ab\", \"::\")"));
+        Assert.Equal(new List<object> { "x", "y" }, Eval("explode(\"x::y\", \"::\")"));
+        Assert.Equal("a-1-b", Eval("implode(({ \"a\", 1, \"b\" }), \"-\")"));
+    }
+
+    [Fact]
+    public void Evaluate_Copy_IsDeepButSharesNothing()
+    {
+        var interpreter = new Interpreter();
+        Evaluate(interpreter, "a = ({ 1, ({ 2 }), ([ \"k\": ({ 3 }) ]) })");
+        var original = (List<object>)Evaluate(interpreter, "a");
+        var copy = (List<object>)Evaluate(interpreter, "copy(a)");
+
+        copy[0] = 7L;
+        ((List<object>)copy[1])[0] = 9L;
+        ((List<object>)((Dictionary<object, object>)copy[2])["k"])[0] = 8L;
+
+        Assert.Equal(1L, original[0]);
+        Assert.Equal(2L, ((List<object>)original[1])[0]);
+        Assert.Equal(3L, ((List<object>)((Dictionary<object, object>)original[2])["k"])[0]);
+    }
+
     [Fact]
     public void Evaluate_EfunInExpression()
     {
@@ -883,37 +921,47 @@ public class InterpreterTests
     }
 
     [Fact]
-    public void Execute_Return_ThrowsReturnException()
+    public void Execute_Return_ReturnsValue()
     {
         var interpreter = new Interpreter();
 
-        var ex = Assert.Throws<ReturnException>(() => ExecStmt(interpreter, "return 42;"));
-        Assert.Equal(42L, ex.Value);
+        Assert.Equal(42L, ExecStmt(interpreter, "return 42;"));
     }
 
     [Fact]
-    public void Execute_ReturnVoid_ThrowsReturnExceptionWithNull()
+    public void Execute_ReturnVoid_ReturnsNull()
     {
         var interpreter = new Interpreter();
 
-        var ex = Assert.Throws<ReturnException>(() => ExecStmt(interpreter, "return;"));
-        Assert.Null(ex.Value);
+        Assert.Null(ExecStmt(interpreter, "return;"));
+    }
+
+    [Fact]
+    public void Execute_ReturnInsideLoop_StopsLoop()
+    {
+        var interpreter = new Interpreter();
+        ExecStmt(interpreter, "x = 0;");
+
+        Assert.Equal(3L, ExecStmt(interpreter, "while (1) { x = x + 1; if (x == 3) return x; }"));
+        Assert.Equal(3L, Evaluate(interpreter, "x"));
     }
 
     [Fact]
-    public void Execute_Break_OutsideLoop_ThrowsBreakException()
+    public void Execute_Break_OutsideLoop_Throws()
     {
         var interpreter = new Interpreter();
 
-        Assert.Throws<BreakException>(() => ExecStmt(interpreter, "break;"));
+        var ex = Assert.Throws<InterpreterException>(() => ExecStmt(interpreter, "break;"));
+        Assert.Contains("break outside of loop", ex.Message);
     }
 
     [Fact]
-    public void Execute_Continue_OutsideLoop_ThrowsContinueException()
+    public void Execute_Continue_OutsideLoop_Throws()
     {
         var interpreter = new Interpreter();
 
-        Assert.Throws<ContinueException>(() => ExecStmt(interpreter, "continue;"));
+        var ex = Assert.Throws<InterpreterException>(() => ExecStmt(interpreter, "continue;"));
+        Assert.Contains("continue outside of loop", ex.Message);
     }
 
     [Fact]
@@ -1329,7 +1377,7 @@ public class InterpreterTests
     public void Evaluate_MappingConcatenation()
     {
         var result = Eval("([ \"a\": 1 ]) + ([ \"b\": 2 ])");
-        var map = Assert.IsType<Dictionary<object, object>>(result);
+        var map = Assert.IsType<LpcMapping>(result);
         Assert.Equal(2, map.Count);
         Assert.Equal(1L, map["a"]);
         Assert.Equal(2L, map["b"]);
@@ -1339,7 +1387,7 @@ public class InterpreterTests
     public void Evaluate_MappingConcatenation_RightOverwritesLeft()
     {
         var result = Eval("([ \"a\": 1, \"b\": 2 ]) + ([ \"b\": 99, \"c\": 3 ])");
-        var map = Assert.IsType<Dictionary<object, object>>(result);
+        var map = Assert.IsType<LpcMapping>(result);
         Assert.Equal(3, map.Count);
         Assert.Equal(1L, map["a"]);
         Assert.Equal(99L, map["b"]);  // Overwritten by right mapping
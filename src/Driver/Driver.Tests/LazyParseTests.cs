@@ -0,0 +1,124 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class LazyParseTests
+{
+    private const string Source = @"
+int counter;
+
+int *numbers() { return ({ 1, 2, ({ 3 })[0] }); }
+
+mapping table() {
+    mapping m;
+    m = ([ ""a"": ({ }), ""b"": 2 * 3 ]);
+    if (counter) { counter--; } else { while (0) { } }
+    return m;
+}
+
+void bump(int n) { counter += n; }
+";
+
+    private static byte[] Serialize(List<Statement> statements)
+    {
+        var stream = new MemoryStream();
+        using (var writer = new BinaryWriter(stream))
+        {
+            AstSerializer.WriteStatements(writer, statements);
+        }
+        return stream.ToArray();
+    }
+
+    private static List<Statement> Parse(string source, bool lazy) =>
+        AstOptimizer.Optimize(new Parser(new Lexer(source)) { DeferBodies = lazy }.ParseProgram());
+
+    [Fact]
+    public void DeferredBodies_ParseToTheSameTree()
+    {
+        var eager = Parse(Source, lazy: false);
+        var lazy = Parse(Source, lazy: true);
+
+        var functions = lazy.OfType<FunctionDefinition>().ToList();
+        Assert.Equal(new[] { "numbers", "table", "bump" }, functions.Select(f => f.Name));
+        Assert.All(functions, function => Assert.True(function.IsDeferred));
+        Assert.Equal(6, functions[1].BodyLine);
+
+        // Serializing asks for every body
+        Assert.Equal(Serialize(eager), Serialize(lazy));
+        Assert.All(functions, function => Assert.False(function.IsDeferred));
+    }
+
+    [Fact]
+    public void UnbalancedBodies_AreStillLoadErrors()
+    {
+        var error = Assert.Throws<ParserException>(() => Parse("void f() { if (1) { }\n", lazy: true));
+        Assert.Contains("Expected '}' after block", error.Message);
+    }
+
+    [Fact]
+    public void LazyPrograms_LowerOnFirstCallAndReportSyntaxErrorsThen()
+    {
+        var tempDir = Path.Combine(Path.GetTempPath(), $"lazy_parse_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(tempDir);
+        try
+        {
+            var om = new ObjectManager(tempDir) { LazyParse = true };
+            om.InitializeInterpreter();
+            var obj = om.LoadSource("/test/lazy", @"
+int twice(int n) { return n * 2; }
+
+int broken(int n) {
+    return n +;
+}
+");
+            var interpreter = om.Interpreter!;
+            Assert.Empty(obj.Program.CompiledFunctions);
+
+            Assert.Equal(42L, interpreter.CallFunctionOnObject(obj, "twice", new List<object> { 21L }));
+            Assert.Equal(8L, interpreter.CallFunctionOnObject(obj, "twice", new List<object> { 4L }));
+            // Lowered bytecode is kept, the tree isn't
+            Assert.True(obj.Program.Functions["twice"].IsDeferred);
+
+            var error = Assert.Throws<ObjectInterpreterException>(() =>
+                interpreter.CallFunctionOnObject(obj, "broken", new List<object> { 1L }));
+            Assert.Contains("Syntax error in broken() of /test/lazy", error.Message);
+            Assert.Contains("line 5", error.Message);
+        }
+        finally
+        {
+            Directory.Delete(tempDir, true);
+        }
+    }
+
+    [Fact]
+    public void LazySyntaxErrors_ReadTheSameWithoutBytecode()
+    {
+        var tempDir = Path.Combine(Path.GetTempPath(), $"lazy_parse_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(tempDir);
+        try
+        {
+            var om = new ObjectManager(tempDir) { LazyParse = true };
+            om.InitializeInterpreter();
+            var interpreter = om.Interpreter!;
+            interpreter.UseBytecode = false;
+            var obj = om.LoadSource("/test/lazy", @"
+int twice(int n) { return n * 2; }
+
+int broken(int n) {
+    return n +;
+}
+");
+
+            Assert.Equal(42L, interpreter.CallFunctionOnObject(obj, "twice", new List<object> { 21L }));
+
+            var error = Assert.Throws<ObjectInterpreterException>(() =>
+                interpreter.CallFunctionOnObject(obj, "broken", new List<object> { 1L }));
+            Assert.Contains("Syntax error in broken() of /test/lazy", error.Message);
+            Assert.Contains("line 5", error.Message);
+        }
+        finally
+        {
+            Directory.Delete(tempDir, true);
+        }
+    }
+}
@@ -590,5 +590,21 @@ public class LexerTests
         Assert.Contains(tokens, t => t.Type == TokenType.LessEqual || t.Type == TokenType.Less);
     }
 
+        [Fact]
+    public void Tokenize_RecordsOffsetsAndSharesRepeatedNames()
+    {
+        var source = "string name = \"sword\"; name = name;";
+        var tokens = new Lexer(source).Tokenize();
+
+        foreach (var token in tokens.Where(t => t.Type is not (TokenType.Eof or TokenType.String)))
+        {
+            Assert.Equal(token.Lexeme, source.Substring(token.Offset, token.Lexeme.Length));
+        }
+        Assert.Equal(source.IndexOf('"'), tokens[3].Offset);
+        Assert.Equal("sword", tokens[3].Lexeme);
+        Assert.Same(tokens[1].Lexeme, tokens[5].Lexeme);
+        Assert.Same(tokens[5].Lexeme, tokens[7].Lexeme);
+    }
+
     #endregion
 }
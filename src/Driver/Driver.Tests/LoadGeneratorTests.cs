@@ -0,0 +1,144 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+/// <summary>
+/// Load scripts, and bots driving a real server over loopback.
+/// </summary>
+public class LoadGeneratorTests : IDisposable
+{
+    private readonly string _testMudlibPath;
+    private readonly AccountManager _accountManager;
+    private readonly GameLoop _gameLoop;
+    private readonly TelnetServer _server;
+    private readonly Thread _serverThread;
+
+    public LoadGeneratorTests()
+    {
+        _testMudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_loadgen_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_testMudlibPath, "secure", "accounts"));
+        Write("/std/player.c", "string name;\nvoid set_name(string s) { name = s; }\nstring query_name() { return name; }\n");
+        Write("/rooms/start.c", "void create() { }\n");
+        Write("/cmds/std/look.c", "void main(string args) { write(\"An empty room.\\n\"); }\n");
+        Write("/cmds/std/quit.c", "void main(string args) { write(\"Goodbye!\\n\"); destruct(this_player()); }\n");
+        Write("/cmds/admin/ticks.c", "void main(string args) { mapping s = tick_stats(); write(\"Ticks: \" + s[\"ticks\"] + \", overruns: \" + s[\"overruns\"] + \"\\n\"); }\n");
+
+        var objectManager = new ObjectManager(_testMudlibPath);
+        objectManager.InitializeInterpreter();
+        _accountManager = new AccountManager(_testMudlibPath);
+        _gameLoop = new GameLoop(objectManager, _accountManager) { StartingRoomPath = "/rooms/start" };
+        _gameLoop.InitializeInterpreter(new ObjectInterpreter(objectManager));
+        _gameLoop.Start();
+
+        _server = new TelnetServer(0, _gameLoop);
+        _serverThread = new Thread(_server.Run) { IsBackground = true };
+        _serverThread.Start();
+        Assert.True(_server.Listening.Wait(TimeSpan.FromSeconds(5)));
+    }
+
+    public void Dispose()
+    {
+        _server.Dispose();
+        _serverThread.Join(TimeSpan.FromSeconds(5));
+        _gameLoop.Stop();
+
+        if (Directory.Exists(_testMudlibPath))
+        {
+            Directory.Delete(_testMudlibPath, recursive: true);
+        }
+    }
+
+    private void Write(string path, string source)
+    {
+        var fullPath = Path.Combine(_testMudlibPath, path.TrimStart('/'));
+        Directory.CreateDirectory(Path.GetDirectoryName(fullPath)!);
+        File.WriteAllText(fullPath, source);
+    }
+
+    private LoadOptions Options(int bots) => new()
+    {
+        Port = _server.LocalPort,
+        Bots = bots,
+        Ramp = TimeSpan.FromMilliseconds(200),
+        Duration = TimeSpan.FromSeconds(2),
+        CommandTimeout = TimeSpan.FromSeconds(5)
+    };
+
+    [Fact]
+    public void Parse_SplitsStepsAndLoop()
+    {
+        var script = LoadScript.Parse("# walk\nlogin\nlook\n\nloop\nwait 100-200\nsay hi {name}\n");
+
+        Assert.Equal(4, script.Steps.Count);
+        Assert.Equal(2, script.LoopStart);
+        Assert.Equal(LoadStepKind.Login, script.Steps[0].Kind);
+        Assert.Equal(new LoadStep(LoadStepKind.Command, "look"), script.Steps[1]);
+        Assert.Equal(new LoadStep(LoadStepKind.Wait, MinMs: 100, MaxMs: 200), script.Steps[2]);
+        Assert.Equal("say hi {name}", script.Steps[3].Text);
+    }
+
+    [Fact]
+    public void Parse_RejectsBadScripts()
+    {
+        Assert.Throws<FormatException>(() => LoadScript.Parse("look\n"));
+        Assert.Throws<FormatException>(() => LoadScript.Parse("login\nwait soon\n"));
+        Assert.Throws<FormatException>(() => LoadScript.Parse("login\nwait 200-100\n"));
+        Assert.Throws<FormatException>(() => LoadScript.Parse("login\nloop\n"));
+    }
+
+    [Fact]
+    public void BotNames_AreLettersWithTheTestPrefix()
+    {
+        var generator = new LoadGenerator(LoadScript.Parse("login\n"), new LoadOptions());
+
+        Assert.Equal("testbotaaaa", generator.BotName(0));
+        Assert.Equal("testbotaabb", generator.BotName(27));
+        Assert.Throws<ArgumentException>(() => new LoadGenerator(LoadScript.Parse("login\n"), new LoadOptions { NamePrefix = "bot" }));
+    }
+
+    [Fact]
+    public async Task Bots_RegisterThenLogInAndReportLatencies()
+    {
+        var script = LoadScript.Parse("login\nlook\n");
+
+        var first = await new LoadGenerator(script, Options(3)).RunAsync();
+        Assert.Equal(0, first.Errors);
+        Assert.Equal(3, first.LoggedIn);
+        Assert.True(_accountManager.AccountExists("testbotaaac"));
+
+        // The accounts exist now, so the second run takes the password path
+        var second = await new LoadGenerator(script, Options(3)).RunAsync();
+        Assert.Equal(0, second.Errors);
+        Assert.Equal(3, second.LoggedIn);
+        Assert.Equal(3, second.Commands);
+        Assert.Equal(0, second.Timeouts);
+        Assert.Equal(3, second.Latencies.Single(l => l.Command == "look").Count);
+        Assert.Equal(3, second.Latencies.Single(l => l.Command == "login").Count);
+        Assert.Null(second.Ticks);
+    }
+
+    [Fact]
+    public async Task Bots_LoopUntilTheRunEnds()
+    {
+        var report = await new LoadGenerator(LoadScript.Parse("login\nloop\nlook\nwait 400\n"), Options(2)).RunAsync();
+
+        Assert.Equal(0, report.Errors);
+        Assert.True(report.Commands > 2, $"only {report.Commands} commands");
+        Assert.True(report.CommandsPerSecond > 0);
+        Assert.Contains("\"Latencies\"", report.ToJson());
+    }
+
+    [Fact]
+    public async Task AdminAccount_ReadsTickOverruns()
+    {
+        _accountManager.CreateAccount("testadmin", "admin@example.com", "adminpass1");
+        _accountManager.SetAccessLevel("testadmin", AccessLevel.Admin);
+
+        var report = await new LoadGenerator(LoadScript.Parse("login\nlook\n"),
+            Options(1) with { AdminName = "testadmin", AdminPassword = "adminpass1" }).RunAsync();
+
+        Assert.Equal(0, report.Errors);
+        Assert.True(report.Ticks > 0);
+        Assert.NotNull(report.TickOverruns);
+    }
+}
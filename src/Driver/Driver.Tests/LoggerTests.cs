@@ -0,0 +1,54 @@
+using System.Text.Json;
+using Xunit;
+
+namespace Driver.Tests;
+
+public class LoggerTests
+{
+    private sealed class Probe
+    {
+        public int Formatted;
+        public override string ToString()
+        {
+            Formatted++;
+            return "probe";
+        }
+    }
+
+    [Fact]
+    public void Debug_SkipsFormattingBelowMinLevel()
+    {
+        Assert.False(Logger.IsEnabled(LogLevel.Debug));
+        var probe = new Probe();
+
+        Logger.Debug($"value {probe}", LogCategory.System);
+
+        Assert.Equal(0, probe.Formatted);
+    }
+
+    [Fact]
+    public void LogFile_WritesJsonLinesAfterFlush()
+    {
+        var path = Path.Combine(Path.GetTempPath(), $"logger_test_{Guid.NewGuid():N}.log");
+        var marker = $"marker-{Guid.NewGuid():N}";
+        try
+        {
+            Logger.JsonLines = true;
+            Logger.SetLogFile(path);
+            Logger.Warning($"{marker} \"quoted\"\n", LogCategory.Network);
+            Logger.Flush();
+
+            var line = File.ReadLines(path).Single(l => l.Contains(marker));
+            using var doc = JsonDocument.Parse(line);
+            Assert.Equal("warning", doc.RootElement.GetProperty("level").GetString());
+            Assert.Equal("network", doc.RootElement.GetProperty("category").GetString());
+            Assert.Equal($"{marker} \"quoted\"\n", doc.RootElement.GetProperty("message").GetString());
+        }
+        finally
+        {
+            Logger.SetLogFile(null);
+            Logger.JsonLines = false;
+            File.Delete(path);
+        }
+    }
+}
@@ -0,0 +1,124 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class LoginAdmissionTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ObjectManager _objectManager;
+    private readonly GameLoop _gameLoop;
+
+    public LoginAdmissionTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_admission_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "secure", "accounts"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "secure", "players"));
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "player.c"), @"
+string player_name;
+int level;
+void set_name(string name) { player_name = name; }
+int restore_player() { return restore_object(""/secure/players/"" + lower_case(player_name)); }
+int query_level() { return level; }
+");
+        var accounts = new AccountManager(_mudlibPath);
+        for (int i = 0; i < 6; i++)
+        {
+            var name = "testqueue" + (char)('a' + i);
+            accounts.CreateAccount(name, "q@test.com", "password123");
+            File.WriteAllText(Path.Combine(_mudlibPath, "secure", "players", name + ".o"), $"level {i + 10}\n");
+        }
+
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter();
+        _gameLoop = new GameLoop(_objectManager, new AccountManager(_mudlibPath)) { MaxLoginsPerTick = 4 };
+        _gameLoop.InitializeInterpreter(new ObjectInterpreter(_objectManager));
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private List<OutputMessage> DrainOutput()
+    {
+        var output = new List<OutputMessage>();
+        while (_gameLoop.TryDequeueOutput(out var message))
+        {
+            output.Add(message!);
+        }
+        return output;
+    }
+
+    private long Level(string connectionId)
+    {
+        var player = _gameLoop.GetSession(connectionId)!.PlayerObject!;
+        return Convert.ToInt64(_objectManager.Interpreter!.CallFunctionOnObject(player, "query_level", new List<object>()));
+    }
+
+    private static void WaitUntil(Func<bool> condition)
+    {
+        var deadline = DateTime.UtcNow.AddSeconds(5);
+        while (!condition() && DateTime.UtcNow < deadline)
+        {
+            Thread.Sleep(10);
+        }
+    }
+
+    [Fact]
+    public void Logins_PastThePerTickLimitWaitInLine()
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            _gameLoop.ResumePlayerSession("c" + i, "127.0.0.1", "testqueue" + (char)('a' + i));
+        }
+        _gameLoop.Step();
+
+        var states = Enumerable.Range(0, 6).Select(i => _gameLoop.GetSession("c" + i)!.LoginState).ToArray();
+        Assert.Equal(4, states.Count(state => state == LoginState.Playing));
+        Assert.Equal(2, states.Count(state => state == LoginState.Admitting));
+        Assert.Equal(2, _gameLoop.LoginQueueDepth);
+        Assert.Contains(DrainOutput(), message => message.ConnectionId == "c5" && message.Content.Contains("number 6 in line"));
+
+        // Input while waiting gets the place in line, not the login prompt
+        _gameLoop.QueueCommand("c5", "look");
+        WaitUntil(() => _objectManager.Restores.Pending == 0);
+        _gameLoop.Step();
+
+        Assert.All(Enumerable.Range(0, 6), i => Assert.Equal(LoginState.Playing, _gameLoop.GetSession("c" + i)!.LoginState));
+        Assert.Equal(0, _gameLoop.LoginQueueDepth);
+        Assert.Equal(15L, Level("c5"));
+        Assert.Equal(10L, Level("c0"));
+
+        // The two who waited were restored from their prefetched saves
+        Assert.Equal(2, _objectManager.Restores.Hits);
+        Assert.Equal(0, _objectManager.Restores.Count);
+    }
+
+    [Fact]
+    public void Prefetch_IsDroppedWhenTheFileIsSavedOver()
+    {
+        var path = Path.Combine(_mudlibPath, "secure", "players", "testqueuea.o");
+        var release = new ManualResetEventSlim(false);
+        var prefetcher = new RestorePrefetcher(fullPath =>
+        {
+            release.Wait();
+            return File.ReadAllBytes(fullPath);
+        });
+
+        prefetcher.Prefetch(path);
+        Assert.Null(prefetcher.Take(path));
+
+        prefetcher.Prefetch(path);
+        prefetcher.Invalidate(path);
+        release.Set();
+        WaitUntil(() => prefetcher.Pending == 0);
+        Assert.Equal(0, prefetcher.Count);
+        Assert.Null(prefetcher.Take(path));
+        Assert.Equal(0, prefetcher.Hits);
+    }
+}
@@ -0,0 +1,54 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class LoginHasherTests
+{
+    [Fact]
+    public void Completions_RunOnlyFromRunCompletions()
+    {
+        var hasher = new LoginHasher();
+        int result = 0;
+
+        Assert.True(hasher.TryStart("10.0.0.1", () => 42, value => result = value));
+        SpinWait.SpinUntil(() => hasher.InFlight == 0, TimeSpan.FromSeconds(5));
+        Assert.Equal(0, result);
+
+        hasher.RunCompletions();
+        Assert.Equal(42, result);
+    }
+
+    [Fact]
+    public void TryStart_CapsHashesPerAddress()
+    {
+        var hasher = new LoginHasher { MaxPerAddress = 2 };
+        using var release = new ManualResetEventSlim();
+        Func<bool> blocked = () => release.Wait(TimeSpan.FromSeconds(5));
+
+        Assert.True(hasher.TryStart("10.0.0.1", blocked, _ => { }));
+        Assert.True(hasher.TryStart("10.0.0.1", blocked, _ => { }));
+        Assert.False(hasher.TryStart("10.0.0.1", blocked, _ => { }));
+        Assert.True(hasher.TryStart("10.0.0.2", blocked, _ => { }));
+        Assert.True(hasher.TryStart(null, blocked, _ => { }));
+        Assert.True(hasher.TryStart(null, blocked, _ => { }));
+        Assert.True(hasher.TryStart(null, blocked, _ => { }));
+        Assert.Equal(6, hasher.InFlight);
+
+        release.Set();
+        Assert.True(SpinWait.SpinUntil(() => hasher.InFlight == 0, TimeSpan.FromSeconds(5)));
+        Assert.True(hasher.TryStart("10.0.0.1", () => true, _ => { }));
+    }
+
+    [Fact]
+    public void FailedWork_CompletesWithDefault()
+    {
+        var hasher = new LoginHasher();
+        string? result = "unset";
+
+        hasher.TryStart<string?>("10.0.0.1", () => throw new InvalidOperationException("boom"), value => result = value);
+        SpinWait.SpinUntil(() => hasher.InFlight == 0, TimeSpan.FromSeconds(5));
+        hasher.RunCompletions();
+
+        Assert.Null(result);
+    }
+}
@@ -0,0 +1,58 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class LpcBenchmarkTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ObjectManager _objectManager;
+
+    public LpcBenchmarkTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_bench_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "sums.c"), @"
+int calls;
+int sum_to_ten() {
+    int total = 0;
+    int i;
+    calls++;
+    for (i = 1; i <= 10; i++) total += i;
+    return total;
+}
+int query_calls() { return calls; }
+");
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter();
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    [Fact]
+    public void Run_TimesTheCallsAfterWarmingUp()
+    {
+        var result = LpcBenchmark.Run(_objectManager, "/std/sums", "sum_to_ten", 2000);
+
+        Assert.Equal("/std/sums", result.Object);
+        Assert.Equal(2000, result.Iterations);
+        Assert.Equal(55L, Convert.ToInt64(result.Result));
+        Assert.True(result.NanosecondsPerCall > 0);
+        Assert.True(result.InstructionsPerCall > 10);
+
+        var sums = _objectManager.FindObject("/std/sums")!;
+        var calls = _objectManager.Interpreter!.CallFunctionOnObject(sums, "query_calls", new List<object>());
+        Assert.Equal(LpcBenchmark.WarmupCalls + 2000L, Convert.ToInt64(calls));
+    }
+
+    [Fact]
+    public void Run_RejectsAMissingFunction()
+    {
+        Assert.Throws<ObjectInterpreterException>(() => LpcBenchmark.Run(_objectManager, "/std/sums", "nosuch", 10));
+    }
+}
@@ -0,0 +1,86 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class LpcTestRunnerTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly string _testsPath;
+    private readonly ObjectManager _objectManager;
+
+    public LpcTestRunnerTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_lpctest_test_{Guid.NewGuid():N}");
+        _testsPath = Path.Combine(_mudlibPath, "..", Path.GetFileName(_mudlibPath) + "_tests");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        Directory.CreateDirectory(_testsPath);
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "math.c"), @"
+int square(int n) { return n * n; }
+");
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter(TextWriter.Null);
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath)) Directory.Delete(_mudlibPath, recursive: true);
+        if (Directory.Exists(_testsPath)) Directory.Delete(_testsPath, recursive: true);
+    }
+
+    [Fact]
+    public void Run_ReportsTestsAndTimesBenchFunctions()
+    {
+        File.WriteAllText(Path.Combine(_testsPath, "test_math.c"), @"
+void run_tests() {
+    assert(load_object(""/std/math"")->square(3) == 9, ""square"");
+}
+int bench_square() { return load_object(""/std/math"")->square(7); }
+");
+        File.WriteAllText(Path.Combine(_testsPath, "test_broken.c"), @"
+void run_tests() {
+    assert(load_object(""/std/math"")->square(2) == 5, ""two squared is five"");
+}
+");
+
+        var report = LpcTestRunner.Run(_objectManager, _testsPath, 50);
+
+        Assert.Equal(3, report.Results.Count);
+        var broken = report.Results[0];
+        Assert.Equal("test_broken.c", broken.File);
+        Assert.False(broken.Passed);
+        Assert.Contains("two squared is five", broken.Error);
+
+        Assert.True(report.Results[1].Passed);
+        var bench = report.Results[2].Bench;
+        Assert.NotNull(bench);
+        Assert.Equal(50, bench!.Iterations);
+        Assert.True(bench.InstructionsPerCall > 0);
+
+        Assert.Equal(1, report.Failed);
+        Assert.Contains("1 passed, 1 failed, 1 benchmarks", report.ToString());
+    }
+
+    [Fact]
+    public void Run_ReportsAFileThatDoesNotCompile()
+    {
+        File.WriteAllText(Path.Combine(_testsPath, "test_syntax.c"), "void run_tests() { int x = ; }");
+
+        var report = LpcTestRunner.Run(_objectManager, _testsPath, 10);
+
+        var result = Assert.Single(report.Results);
+        Assert.Equal("(compile)", result.Function);
+        Assert.False(result.Passed);
+    }
+
+    [Fact]
+    public void BenchEfun_ReturnsPerCallFigures()
+    {
+        var evaluator = new ScratchEvaluator(_objectManager);
+        evaluator.Evaluate("int sq() { return load_object(\"/std/math\")->square(4); }");
+
+        var result = Assert.IsType<LpcMapping>(evaluator.Evaluate("bench(\"sq\", 20)"));
+        Assert.Equal(20L, result["iterations"]);
+        Assert.Equal(16L, result["result"]);
+        Assert.True((long)result["instructions"] > 0);
+    }
+}
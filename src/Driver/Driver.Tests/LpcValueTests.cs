@@ -0,0 +1,78 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class LpcValueTests
+{
+    [Fact]
+    public void Default_IsIntZero()
+    {
+        LpcValue value = default;
+
+        Assert.True(value.IsInt);
+        Assert.Equal(0L, value.Int);
+        Assert.False(value.IsTrue);
+    }
+
+    [Fact]
+    public void FromObject_KeepsOriginalBox()
+    {
+        object boxedInt = 7;
+        object boxedLong = 123_456_789L;
+
+        Assert.Same(boxedInt, LpcValue.FromObject(boxedInt).ToObject());
+        Assert.Same(boxedLong, LpcValue.FromObject(boxedLong).ToObject());
+        Assert.Equal(7L, LpcValue.FromObject(boxedInt).Int);
+    }
+
+    [Fact]
+    public void FromInt_BoxesAsLongAndSharesSmallBoxes()
+    {
+        Assert.IsType<long>(LpcValue.FromInt(5000).ToObject());
+        Assert.Same(LpcValue.FromInt(42).ToObject(), LpcValue.FromInt(42).ToObject());
+    }
+
+    [Fact]
+    public void FromObject_TagsReferenceKinds()
+    {
+        Assert.Equal(LpcValueKind.String, LpcValue.FromObject("hi").Kind);
+        Assert.Equal(LpcValueKind.Array, LpcValue.FromObject(new List<object>()).Kind);
+        Assert.Equal(LpcValueKind.Mapping, LpcValue.FromObject(new Dictionary<object, object>()).Kind);
+        Assert.Equal(LpcValueKind.Null, LpcValue.FromObject(null).Kind);
+    }
+
+    [Fact]
+    public void IsTrue_FollowsLpcRules()
+    {
+        Assert.True(LpcValue.FromInt(-1).IsTrue);
+        Assert.False(LpcValue.FromObject("").IsTrue);
+        Assert.True(LpcValue.FromObject("x").IsTrue);
+        Assert.True(LpcValue.FromObject(new List<object>()).IsTrue);
+        Assert.False(LpcValue.Null.IsTrue);
+    }
+
+    [Fact]
+    public void MappingKeys_UseLpcEquality()
+    {
+        var obj = new object();
+        var array = new List<object> { 1L };
+        var map = new LpcMapping { [1L] = "long", ["sword"] = "string", [array] = "array" };
+
+        // An int key finds the long one and hashes the same
+        Assert.Equal("long", map[1]);
+        Assert.Equal(LpcValueComparer.Instance.GetHashCode(1L), LpcValueComparer.Instance.GetHashCode(1));
+        Assert.Equal("string", map[new string("sword".ToCharArray())]);
+
+        // Arrays are keys by identity, not contents
+        Assert.Equal("array", map[array]);
+        Assert.False(map.ContainsKey(new List<object> { 1L }));
+
+        Assert.True(LpcValueComparer.Instance.Equals(obj, obj));
+        Assert.False(LpcValueComparer.Instance.Equals(1L, "1"));
+        Assert.False(LpcValueComparer.Instance.Equals(null, 0L));
+
+        // Copies keep the comparer
+        var copy = new LpcMapping(map);
+        Assert.Equal("long", copy[1]);
+    }
+}
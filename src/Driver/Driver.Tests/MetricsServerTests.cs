@@ -0,0 +1,111 @@
+using System.Net;
+using System.Net.Sockets;
+using Xunit;
+
+namespace Driver.Tests;
+
+public class MetricsServerTests : IDisposable
+{
+    private readonly string _testMudlibPath;
+    private readonly ObjectManager _objectManager;
+    private readonly GameLoop _gameLoop;
+
+    public MetricsServerTests()
+    {
+        _testMudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_metrics_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_testMudlibPath, "std"));
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "thing.c"), @"
+int count(int n) {
+    int i;
+    int total;
+    for (i = 0; i < n; i++) total += i;
+    return total;
+}
+");
+
+        _objectManager = new ObjectManager(_testMudlibPath);
+        _objectManager.InitializeInterpreter();
+        _gameLoop = new GameLoop(_objectManager, new AccountManager(_testMudlibPath));
+        _gameLoop.InitializeInterpreter(new ObjectInterpreter(_objectManager));
+    }
+
+    public void Dispose()
+    {
+        _gameLoop.Stop();
+        if (Directory.Exists(_testMudlibPath))
+        {
+            Directory.Delete(_testMudlibPath, recursive: true);
+        }
+    }
+
+    private static int FreePort()
+    {
+        var listener = new TcpListener(IPAddress.Loopback, 0);
+        listener.Start();
+        int port = ((IPEndPoint)listener.LocalEndpoint).Port;
+        listener.Stop();
+        return port;
+    }
+
+    private static long Value(string metrics, string series)
+    {
+        var line = metrics.Split('\n').Single(l => l.StartsWith(series + " "));
+        return (long)double.Parse(line[(series.Length + 1)..], System.Globalization.CultureInfo.InvariantCulture);
+    }
+
+    [Fact]
+    public void Render_ReportsObjectsClonesAndQueues()
+    {
+        for (int i = 0; i < 3; i++) _objectManager.CloneObject("/std/thing");
+        using var metrics = new MetricsServer(FreePort(), _gameLoop, _objectManager, null);
+
+        var text = metrics.Render();
+
+        Assert.Equal(3, Value(text, "lpmud_clones{blueprint=\"/std/thing\"}"));
+        Assert.Equal(1, Value(text, "lpmud_blueprints"));
+        Assert.Equal(0, Value(text, "lpmud_command_queue_depth"));
+        Assert.Contains("# TYPE lpmud_tick_duration_seconds histogram", text);
+        Assert.Contains("lpmud_tick_phase_duration_seconds_count{phase=\"heartbeats\"} 0", text);
+        Assert.Contains("lpmud_gc_collections_total{generation=\"0\"}", text);
+        Assert.DoesNotContain("lpmud_connections", text);
+    }
+
+    [Fact]
+    public void Render_CountsInstructionsAndCommandLatency()
+    {
+        var thing = _objectManager.CloneObject("/std/thing");
+        var interpreter = _objectManager.Interpreter!;
+        using var metrics = new MetricsServer(FreePort(), _gameLoop, _objectManager, null);
+        long before = Value(metrics.Render(), "lpmud_lpc_instructions_total");
+
+        interpreter.ResetInstructionCount();
+        interpreter.CallFunctionOnObject(thing, "count", new List<object> { 1000L });
+        interpreter.ResetInstructionCount();
+        _gameLoop.TickProfiler.RecordCommand("say\"x", TimeSpan.FromMilliseconds(3));
+
+        var text = metrics.Render();
+        Assert.True(Value(text, "lpmud_lpc_instructions_total") - before >= 1000);
+        Assert.Equal(1, Value(text, "lpmud_command_latency_seconds_count{verb=\"say\\\"x\"}"));
+        Assert.Equal(0, Value(text, "lpmud_command_latency_seconds_bucket{verb=\"say\\\"x\",le=\"0.002048\"}"));
+        Assert.Equal(1, Value(text, "lpmud_command_latency_seconds_bucket{verb=\"say\\\"x\",le=\"0.004096\"}"));
+    }
+
+    [Fact]
+    public async Task Http_ServesMetricsAndStatusAndNothingElse()
+    {
+        int port = FreePort();
+        using var metrics = new MetricsServer(port, _gameLoop, _objectManager, null);
+        metrics.Start();
+        using var client = new HttpClient();
+
+        var response = await client.GetAsync($"http://localhost:{port}/metrics");
+        Assert.Equal(HttpStatusCode.OK, response.StatusCode);
+        Assert.Contains("lpmud_ticks_total", await response.Content.ReadAsStringAsync());
+
+        var status = await client.GetAsync($"http://localhost:{port}/status");
+        Assert.Equal("application/json", status.Content.Headers.ContentType?.MediaType);
+        Assert.Contains("\"players\":[]", await status.Content.ReadAsStringAsync());
+
+        Assert.Equal(HttpStatusCode.NotFound, (await client.GetAsync($"http://localhost:{port}/")).StatusCode);
+    }
+}
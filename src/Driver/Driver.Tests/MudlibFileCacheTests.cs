@@ -0,0 +1,70 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class MudlibFileCacheTests
+{
+    [Theory]
+    [InlineData(0)]
+    [InlineData(1024 * 1024)]
+    public void ReadLines_MatchesReadAllLines_CachedOrMapped(long largeFileThreshold)
+    {
+        var tempDir = Path.Combine(Path.GetTempPath(), "files_test_" + Guid.NewGuid().ToString("N")[..8]);
+        Directory.CreateDirectory(tempDir);
+        var path = Path.Combine(tempDir, "notes.txt");
+        File.WriteAllText(path, "\uFEFFone\r\ntwo\nthree\rfour\n\nsix\n");
+
+        try
+        {
+            var cache = new MudlibFileCache(tempDir) { LargeFileThreshold = largeFileThreshold };
+            var lines = File.ReadAllLines(path);
+
+            Assert.Equal(string.Join("\n", lines), cache.ReadLines(path));
+            for (int start = 1; start <= lines.Length + 1; start++)
+            {
+                for (int count = 0; count <= lines.Length; count++)
+                {
+                    Assert.Equal(string.Join("\n", lines.Skip(start - 1).Take(count)), cache.ReadLines(path, start, count));
+                }
+                Assert.Equal(string.Join("\n", lines.Skip(start - 1)), cache.ReadLines(path, start));
+            }
+            Assert.Null(cache.ReadLines(Path.Combine(tempDir, "missing.txt")));
+        }
+        finally
+        {
+            Directory.Delete(tempDir, recursive: true);
+        }
+    }
+
+    [Fact]
+    public void CachedText_AndListings_AreReadAgainAfterOutsideEdits()
+    {
+        var tempDir = Path.Combine(Path.GetTempPath(), "files_test_" + Guid.NewGuid().ToString("N")[..8]);
+        Directory.CreateDirectory(Path.Combine(tempDir, "sub"));
+        var path = Path.Combine(tempDir, "a.txt");
+        File.WriteAllText(path, "first\n");
+
+        try
+        {
+            var cache = new MudlibFileCache(tempDir);
+            Assert.Equal("first", cache.ReadLines(path));
+            Assert.Equal("first", cache.ReadLines(path));
+            Assert.Equal(1, cache.Hits);
+
+            File.WriteAllText(path, "second, longer\n");
+            Assert.Equal("second, longer", cache.ReadLines(path));
+
+            Assert.Equal(new[] { "a.txt", "sub/" }, cache.ListDirectory(tempDir));
+            File.WriteAllText(Path.Combine(tempDir, "b.txt"), "");
+            cache.Invalidate(Path.Combine(tempDir, "b.txt"));
+            Assert.Equal(new[] { "a.txt", "b.txt", "sub/" }, cache.ListDirectory(tempDir));
+
+            Assert.Equal(Path.Combine(tempDir, "sub", "x"), cache.Resolve("/sub/x"));
+            Assert.Null(cache.Resolve("/../outside"));
+        }
+        finally
+        {
+            Directory.Delete(tempDir, recursive: true);
+        }
+    }
+}
@@ -46,6 +46,24 @@ public class MudlibIntegrationTests
             "Set MUDLIB_PATH environment variable to the mudlib directory.");
     }
 
+    [Fact]
+    public void WholeMudlib_ShouldPrecompile()
+    {
+        var om = new ObjectManager(GetMudlibPath());
+        om.InitializeInterpreter();
+
+        var report = om.Precompile();
+
+        // /examples use adjacent string literal concatenation, which the parser doesn't support yet
+        var failures = report.Files
+            .Where(f => f.Error != null && !f.Path.StartsWith("/examples/"))
+            .Select(f => $"{f.Path}: {f.Error}")
+            .ToList();
+
+        Assert.True(report.Compiled > 0);
+        Assert.True(failures.Count == 0, string.Join("\n", failures));
+    }
+
     [Fact]
     public void AllStdFiles_ShouldCompile()
     {
@@ -186,4 +204,92 @@ public class MudlibIntegrationTests
         var name = player.GetVariable("player_name");
         Assert.Equal("TestPlayer", name);
     }
+
+    [Fact]
+    public void GroupFight_TracksAttackersInTheDriver()
+    {
+        var om = new ObjectManager(GetMudlibPath());
+        om.InitializeInterpreter();
+        var interpreter = om.Interpreter!;
+        var room = om.CloneObject("/std/object");
+        var player = om.CloneObject("/std/player");
+        var orcs = Enumerable.Range(0, 3).Select(_ => om.CloneObject("/std/monster")).ToList();
+        player.MoveTo(room);
+        foreach (var orc in orcs)
+        {
+            orc.MoveTo(room);
+            interpreter.CallFunctionOnObject(orc, "start_combat", new List<object> { player });
+        }
+
+        // The player fights back against the first, and all three are on it
+        Assert.Equal(orcs[0], player.CombatTarget);
+        Assert.Equal(orcs, player.Attackers);
+        Assert.Equal(new[] { player }, orcs[0].Attackers);
+
+        // With the first gone, stop_combat picks the next one still here
+        om.DestructObject(orcs[0]);
+        Assert.Null(player.CombatTarget);
+        orcs[1].MoveTo(null);
+        interpreter.CallFunctionOnObject(player, "stop_combat", new List<object>());
+        Assert.Equal(orcs[2], player.CombatTarget);
+        Assert.Equal(orcs[2], player.GetVariable("attacker"));
+    }
+
+    [Fact]
+    public void AggressiveMonster_HearsArrivalsAndSleepsWhenIdle()
+    {
+        var mudlibPath = GetMudlibPath();
+        var om = new ObjectManager(mudlibPath);
+        om.InitializeInterpreter();
+        var interpreter = om.Interpreter!;
+        // For reset() after create(), where a monster starts following its moves
+        var gameLoop = new GameLoop(om, new AccountManager(mudlibPath));
+        gameLoop.InitializeInterpreter(interpreter);
+        var room = om.CloneObject("/std/object");
+        var wolf = interpreter.SpawnInto("/world/mobs/wolf", room);
+        var rabbit = interpreter.SpawnInto("/world/mobs/rabbit", room);
+
+        // Nothing to do, so no heartbeats; only the aggressive one listens to the room
+        Assert.False(wolf.HeartbeatEnabled);
+        Assert.False(rabbit.HeartbeatEnabled);
+        Assert.Equal(new EventBus.Subscription(wolf, "arrived"), Assert.Single(om.Events.For(room, "enter")));
+
+        var player = interpreter.SpawnInto("/std/player", room);
+        Assert.Equal(player, wolf.CombatTarget);
+        Assert.True(wolf.HeartbeatEnabled);
+        Assert.Null(rabbit.CombatTarget);
+
+        // The wolf listens to whichever room it moves to
+        var den = om.CloneObject("/std/object");
+        interpreter.EvaluateInObject(wolf,
+            new Parser(new Lexer($"move_object(find_object(\"{den.ObjectName}\"))")).Parse());
+        Assert.Same(den, wolf.Environment);
+        Assert.Empty(om.Events.For(room, "enter"));
+        Assert.Single(om.Events.For(den, "enter"));
+    }
+
+    [Fact]
+    public void MonsterMadeAggressiveInPlace_AttacksTheNextArrival()
+    {
+        var mudlibPath = GetMudlibPath();
+        var om = new ObjectManager(mudlibPath);
+        om.InitializeInterpreter();
+        var interpreter = om.Interpreter!;
+        var gameLoop = new GameLoop(om, new AccountManager(mudlibPath));
+        gameLoop.InitializeInterpreter(interpreter);
+        var room = om.CloneObject("/std/object");
+        var rabbit = interpreter.SpawnInto("/world/mobs/rabbit", room);
+        Assert.Empty(om.Events.For(room, "enter"));
+
+        // Turned on where it stands, without moving
+        interpreter.CallFunctionOnObject(rabbit, "set_aggressive", new List<object> { 1L });
+        Assert.Equal(new EventBus.Subscription(rabbit, "arrived"), Assert.Single(om.Events.For(room, "enter")));
+
+        var player = interpreter.SpawnInto("/std/player", room);
+        Assert.Equal(player, rabbit.CombatTarget);
+
+        // And off again: it stops hearing the room
+        interpreter.CallFunctionOnObject(rabbit, "set_aggressive", new List<object> { 0L });
+        Assert.Empty(om.Events.For(room, "enter"));
+    }
 }
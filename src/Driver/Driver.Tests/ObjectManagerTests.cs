@@ -139,6 +139,140 @@ public class ObjectManagerTests
         CleanupTemp(tempDir);
     }
 
+    [Fact]
+    public void StateVersion_TracksVariableWritesAndMoves()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var weapon = om.CloneObject("/std/weapon");
+        var bag = om.CloneObject("/std/object");
+        Assert.True(weapon.IsDirty);
+
+        weapon.SavedVersion = weapon.StateVersion;
+        om.Interpreter!.CallFunctionOnObject(weapon, "query_damage", new List<object>());
+        Assert.False(weapon.IsDirty);
+
+        om.Interpreter.CallFunctionOnObject(weapon, "set_damage", new List<object> { 7L });
+        Assert.True(weapon.IsDirty);
+
+        weapon.SavedVersion = weapon.StateVersion;
+        weapon.MoveTo(bag);
+        Assert.True(weapon.IsDirty);
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void VariableLayout_PutsInheritedVariablesFirst()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var weapon = om.CloneObject("/std/weapon");
+
+        Assert.Equal(new[] { "short_desc", "mass", "damage", "weapon_type" }, weapon.VariableLayout.Names);
+        Assert.Same(om.LoadObject("/std/weapon").VariableLayout, weapon.VariableLayout);
+        Assert.Equal(10L, weapon.GetVariableAt(weapon.VariableLayout.IndexOf("mass")).Int);
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void UpdateObject_MigratesCloneVariablesToNewLayout()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var weapon = om.CloneObject("/std/weapon");
+        weapon.SetVariable("damage", 42L);
+
+        // Add a variable ahead of the existing ones so every slot moves
+        var path = Path.Combine(tempDir, "std", "weapon.c");
+        File.WriteAllText(path, File.ReadAllText(path).Replace("int damage;", "int sharpness;\nint damage;"));
+        om.UpdateObject("/std/weapon");
+
+        Assert.Same(weapon.Program.VariableLayout, weapon.VariableLayout);
+        Assert.Equal(42L, weapon.GetVariable("damage"));
+        Assert.Equal(0, weapon.GetVariable("sharpness"));
+        Assert.Equal(42L, om.Interpreter!.CallFunctionOnObject(weapon, "query_damage", new List<object>()));
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void UpdateObject_PatchesOnlyChangedFunctionsAndRebuildsChildren()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var weapon = om.CloneObject("/std/weapon");
+        weapon.SetVariable("damage", 42L);
+        var oldObject = om.LoadObject("/std/object").Program;
+        var oldWeapon = weapon.Program;
+        var layout = weapon.VariableLayout;
+
+        // Change one body at the end of the file; nothing above it moves
+        var path = Path.Combine(tempDir, "std", "object.c");
+        File.WriteAllText(path, File.ReadAllText(path).Replace("mass = m;", "mass = m * 2;"));
+        File.SetLastWriteTimeUtc(Path.Combine(tempDir, "std", "weapon.c"), DateTime.UtcNow.AddMinutes(-1));
+        Assert.Equal(2, om.UpdateObject("/std/object"));
+
+        var newObject = om.LoadObject("/std/object").Program;
+        Assert.NotSame(oldObject, newObject);
+        Assert.Same(oldObject.Functions["query_short"], newObject.Functions["query_short"]);
+        Assert.Same(oldObject.CompiledFunctions["query_short"], newObject.CompiledFunctions["query_short"]);
+        Assert.NotSame(oldObject.Functions["set_mass"], newObject.Functions["set_mass"]);
+
+        // The child is rebuilt onto the new parent from its existing definitions
+        Assert.NotSame(oldWeapon, weapon.Program);
+        Assert.Same(newObject, weapon.Program.InheritedPrograms[0]);
+        Assert.Same(oldWeapon.Functions["create"], weapon.Program.Functions["create"]);
+
+        // Same variables, so the clone keeps its layout and values
+        Assert.Same(layout, weapon.VariableLayout);
+        Assert.Equal(42L, weapon.GetVariable("damage"));
+        om.Interpreter!.CallFunctionOnObject(weapon, "set_mass", new List<object> { 3L });
+        Assert.Equal(6L, om.Interpreter.CallFunctionOnObject(weapon, "query_mass", new List<object>()));
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void StageReload_BuildsOffThreadAndAppliesBetweenTicks()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var weapon = om.CloneObject("/std/weapon");
+        var oldProgram = om.LoadObject("/std/object").Program;
+
+        var path = Path.Combine(tempDir, "std", "object.c");
+        File.WriteAllText(path, File.ReadAllText(path).Replace("return mass;", "return mass + 1;"));
+        Assert.True(Task.Run(() => om.StageReload("/std/object")).Result);
+
+        // Nothing changes until the staged program is applied
+        Assert.Same(oldProgram, om.LoadObject("/std/object").Program);
+        Assert.Equal(1, om.StagedReloadCount);
+
+        Assert.Equal(new List<string> { "/std/object" }, om.ApplyStagedReloads());
+        Assert.Equal(0, om.StagedReloadCount);
+        Assert.Equal(11L, om.Interpreter!.CallFunctionOnObject(weapon, "query_mass", new List<object>()));
+
+        // Unloaded and broken files are not staged
+        Assert.False(om.StageReload("/std/missing"));
+        File.WriteAllText(path, "int broken( {");
+        Assert.False(om.StageReload("/std/object"));
+        Assert.Empty(om.ApplyStagedReloads());
+
+        CleanupTemp(tempDir);
+    }
+
     [Fact]
     public void LoadObject_ExecutesVariableInitializers()
     {
@@ -166,6 +300,68 @@ void create() {
         CleanupTemp(tempDir);
     }
 
+    [Fact]
+    public void ConstantInitializers_ComeFromTheProgramImage()
+    {
+        var tempDir = CreateTempMudlib();
+        File.WriteAllText(Path.Combine(tempDir, "test.c"), @"
+int hp = 10 * 5;
+string race = ""orc"";
+string *loot = ({});
+mapping kills = ([]);
+int max_hp = hp * 2;
+int untouched;
+
+void create() { }
+");
+
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+        var program = om.LoadObject("/test").Program;
+
+        Assert.Equal("max_hp", Assert.Single(program.DynamicInitializers).Name);
+        Assert.Equal(50L, program.InitialVariables[program.VariableLayout.IndexOf("hp")].ToObject());
+        Assert.Equal(2, program.EmptyContainerSlots.Length);
+
+        var first = om.CloneObject("/test");
+        var second = om.CloneObject("/test");
+        Assert.Equal(50L, first.GetVariable("hp"));
+        Assert.Equal("orc", first.GetVariable("race"));
+        Assert.Equal(100L, first.GetVariable("max_hp"));
+        Assert.Equal(0, first.GetVariable("untouched"));
+
+        // Empty arrays and mappings are each object's own
+        Assert.Empty(Assert.IsType<List<object>>(first.GetVariable("loot")));
+        Assert.NotSame(first.GetVariable("loot"), second.GetVariable("loot"));
+        Assert.NotSame(first.GetVariable("kills"), second.GetVariable("kills"));
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void CloneNumbers_AreUniqueAcrossThreadsAndBlueprintReloads()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+        var blueprint = om.LoadObject("/std/object");
+
+        var numbers = new System.Collections.Concurrent.ConcurrentBag<int>();
+        Parallel.For(0, 200, _ => numbers.Add(blueprint.NextCloneNumber()));
+        Assert.Equal(Enumerable.Range(1, 200), numbers.OrderBy(n => n));
+
+        var clones = Enumerable.Range(0, 5).Select(_ => om.CloneObject("/std/object")).ToList();
+        om.DestructObject(clones[1]);
+        om.DestructObject(clones[4]);
+        Assert.Equal(new[] { clones[0], clones[2], clones[3] }, blueprint.Clones.OrderBy(c => c.CloneNumber));
+
+        // A blueprint loaded again after being destructed carries on numbering
+        om.DestructObject(blueprint);
+        Assert.Equal("/std/object#206", om.CloneObject("/std/object").ObjectName);
+
+        CleanupTemp(tempDir);
+    }
+
     [Fact]
     public void FindObject_ReturnsCorrectObject()
     {
@@ -203,6 +399,160 @@ void create() {
         CleanupTemp(tempDir);
     }
 
+    [Fact]
+    public void GetUsers_ListsInteractiveObjectsInConnectOrder()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var clones = Enumerable.Range(0, 50).Select(_ => om.CloneObject("/std/object")).ToList();
+        var first = clones[10];
+        var second = clones[3];
+        om.SetInteractive(first, true);
+        om.SetInteractive(second, true);
+        om.SetLivingName(second, "testuser");
+
+        Assert.Equal(new[] { first, second }, om.GetUsers().ToArray());
+        Assert.Same(second, om.FindPlayer("testuser"));
+
+        om.SetInteractive(second, false);
+        Assert.False(second.IsInteractive);
+        Assert.Null(om.FindPlayer("testuser"));
+
+        om.DestructObject(first);
+        Assert.Empty(om.GetUsers());
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void ObjectPaths_AreInternedAndFollowTheBlueprint()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var paths = new ObjectPathTable();
+        var canonical = paths.Get("/std/object");
+        Assert.Same(canonical, paths.Get("std/object.c"));
+        Assert.Same(canonical, paths.Get("/std/object.c"));
+        Assert.Equal("/std/object", canonical.Name);
+
+        // Every spelling finds the same blueprint, until it is destructed
+        var blueprint = om.LoadObject("std/object.c");
+        Assert.Same(blueprint, om.LoadObject("/std/object"));
+        Assert.Same(blueprint, om.FindObject("std/object"));
+        om.DestructObject(blueprint);
+        Assert.Null(om.FindObject("/std/object.c"));
+        var reloaded = om.LoadObject("std/object.c");
+        Assert.NotSame(blueprint, reloaded);
+        Assert.Same(reloaded, om.FindObject("/std/object"));
+
+        // Clones are found by name, which is only formatted on demand
+        var clone = om.CloneObject("/std/object.c");
+        var name = $"/std/object#{clone.CloneNumber}";
+        Assert.Same(clone, om.FindObject(name));
+        Assert.Same(clone, om.FindObject(name[1..]));
+        Assert.Equal(name, clone.ObjectName);
+        Assert.Null(om.FindObject("/std/object#0"));
+        Assert.Null(om.FindObject("/std/object#-1"));
+        Assert.Null(om.FindObject("/std/object#x"));
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void LivingNames_MatchAndResolveByPrefix()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        MudObject Living(string name, bool interactive)
+        {
+            var obj = om.CloneObject("/std/object");
+            om.SetLivingName(obj, name);
+            om.SetInteractive(obj, interactive);
+            return obj;
+        }
+
+        var bobby = Living("Bobby", true);
+        var bob = Living("bob", true);
+        var boris = Living("boris", false);
+        var alice = Living("alice", true);
+
+        Assert.Equal(new[] { bob, bobby, boris }, om.MatchLivings("BO", playersOnly: false).ToArray());
+        Assert.Equal(new[] { bob, bobby }, om.MatchLivings("bo", playersOnly: true).ToArray());
+        Assert.Equal(4, om.MatchLivings("", playersOnly: false).Count);
+
+        // An exact name wins over longer ones; otherwise the prefix must be unique
+        Assert.Same(bob, om.ResolveLiving("bob", playersOnly: true).Match);
+        Assert.Same(alice, om.ResolveLiving("al", playersOnly: true).Match);
+        Assert.Same(boris, om.ResolveLiving("bor", playersOnly: false).Match);
+        Assert.Null(om.ResolveLiving("bor", playersOnly: true).Match);
+        var (match, candidates) = om.ResolveLiving("b", playersOnly: false);
+        Assert.Null(match);
+        Assert.Equal(3, candidates.Count);
+
+        // A shared name finds the latest holder, and the earlier one when it goes
+        var monster = Living("alice", false);
+        Assert.Same(monster, om.FindLiving("alice"));
+        Assert.Same(alice, om.FindPlayer("alice"));
+        om.DestructObject(monster);
+        Assert.Same(alice, om.FindLiving("alice"));
+
+        // Renaming and destructing take names out of the index
+        om.SetLivingName(bobby, "robert");
+        om.DestructObject(boris);
+        Assert.Equal(new[] { bob }, om.MatchLivings("bo", playersOnly: false).ToArray());
+        Assert.Same(bobby, om.ResolveLiving("r", playersOnly: true).Match);
+
+        var test = om.LoadSource("/test/names", @"
+            mixed one() { return resolve_living(""ro"", 1); }
+            mixed many() { return resolve_living(""x""); }
+            int count() { return sizeof(match_living("""")); }
+        ");
+        var interpreter = om.Interpreter!;
+        Assert.Same(bobby, interpreter.CallFunctionOnObject(test, "one", new List<object>()));
+        Assert.Equal(0L, interpreter.CallFunctionOnObject(test, "many", new List<object>()));
+        Assert.Equal(3L, interpreter.CallFunctionOnObject(test, "count", new List<object>()));
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void PublishedState_IsWhatOtherThreadsSee()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var blueprint = om.LoadObject("/std/object");
+        var clone = om.CloneObject("/std/object");
+
+        // Blueprints are published as they load; counts only when asked
+        Assert.Same(blueprint, Task.Run(() => om.PublishedBlueprints["/std/object"]).Result);
+        Assert.Equal(0, om.Snapshot.Stats.TotalObjectCount);
+
+        var snapshot = om.PublishSnapshot();
+        Assert.Same(snapshot, om.Snapshot);
+        Assert.Equal(2, snapshot.Stats.TotalObjectCount);
+        Assert.Equal(1, snapshot.CloneCounts["/std/object"]);
+        Assert.Same(snapshot, om.PublishSnapshot());
+
+        // A published copy doesn't change under its reader
+        var published = om.PublishedBlueprints;
+        om.DestructObject(clone);
+        om.DestructObject(blueprint);
+        Assert.True(published.ContainsKey("/std/object"));
+        Assert.False(om.PublishedBlueprints.ContainsKey("/std/object"));
+        Assert.Equal(2, snapshot.Stats.TotalObjectCount);
+        Assert.Equal(0, om.PublishSnapshot().Stats.TotalObjectCount);
+
+        CleanupTemp(tempDir);
+    }
+
     [Fact]
     public void GetStats_ReturnsCorrectCounts()
     {
@@ -368,6 +718,65 @@ void verify_this() {
 
     // Helper methods
 
+    [Fact]
+    public void Census_CountsClonesAndSizes_WithDeltasBetweenRuns()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var clones = Enumerable.Range(0, 3).Select(_ => om.CloneObject("/std/object")).ToList();
+        clones[1].SetVariable("short_desc", new string('x', 10000));
+
+        var first = om.Census.Run(om.GetAllObjects());
+        var blueprint = Assert.Single(first.Blueprints, b => b.Name == "/std/object");
+        Assert.Equal(3, blueprint.Clones);
+        Assert.Equal(3, blueprint.CloneDelta);
+        Assert.Equal(clones[1].ObjectName, first.Largest[0].Name);
+        Assert.True(first.Largest[0].Bytes > 20000);
+        Assert.Equal(first.Blueprints.Sum(b => b.Bytes), first.Bytes);
+
+        om.CloneObject("/std/object");
+        om.DestructObject(clones[1]);
+        var second = om.Census.Run(om.GetAllObjects());
+        blueprint = Assert.Single(second.Blueprints, b => b.Name == "/std/object");
+        Assert.Equal(3, blueprint.Clones);
+        Assert.Equal(0, blueprint.CloneDelta);
+        Assert.True(blueprint.ByteDelta < -15000);
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void Census_SpreadsAcrossSteps_AndSkipsObjectsDestructedMeanwhile()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var clones = Enumerable.Range(0, 100).Select(_ => om.CloneObject("/std/object")).ToList();
+        var census = new ObjectCensus { StepBudget = TimeSpan.Zero };
+
+        Assert.True(census.Start(om.GetAllObjects()));
+        Assert.False(census.Start(om.GetAllObjects()));
+        Assert.False(census.Step());
+        Assert.True(census.Running);
+        Assert.Null(census.Latest);
+
+        // Only the objects the first step already sized are counted
+        var (done, total) = census.Progress;
+        Assert.True(done < total);
+        foreach (var clone in clones) om.DestructObject(clone);
+        int steps = 1;
+        while (!census.Step()) steps++;
+
+        Assert.True(steps > 1);
+        Assert.False(census.Running);
+        Assert.True(census.Latest!.Objects < total - 50);
+
+        CleanupTemp(tempDir);
+    }
+
     private string CreateTempMudlib()
     {
         var tempDir = Path.Combine(Path.GetTempPath(), "mudlib_test_" + Guid.NewGuid().ToString());
@@ -506,6 +915,36 @@ void set_weapon_type(string type) {
         CleanupTemp(tempDir);
     }
 
+    [Fact]
+    public void CallOtherMany_AndMapCall_FollowCallOtherVisibility()
+    {
+        var tempDir = CreateVisibilityMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var obj = om.LoadObject("/test/visibility");
+        var child = om.LoadObject("/test/child");
+
+        // Results come back in the order asked; hidden or missing functions give 0
+        var many = (List<object>)om.Interpreter!.CallEfun("call_other_many", new List<object>
+        {
+            obj, new List<object> { "public_func", "private_func", "no_such_func", "call_static_internal" }
+        });
+        Assert.Equal(new List<object> { 1L, 0L, 0L, 3L }, many);
+
+        var none = om.Interpreter.CallEfun("call_other_many", new List<object> { 0, new List<object> { "public_func", "static_func" } });
+        Assert.Equal(new List<object> { 0L, 0L }, none);
+
+        // Non-objects in the array give 0 rather than stopping the batch
+        var mapped = om.Interpreter.CallEfun("map_call", new List<object>
+        {
+            new List<object> { obj, 0, child, "not an object" }, "call_private_internal"
+        });
+        Assert.Equal(new List<object> { 2L, 0L, 100L, 0L }, mapped);
+
+        CleanupTemp(tempDir);
+    }
+
     [Fact]
     public void Inheritance_PrivateFunction_NotInherited()
     {
@@ -544,6 +983,208 @@ void set_weapon_type(string type) {
         CleanupTemp(tempDir);
     }
 
+    [Fact]
+    public void FunctionTable_FlattensInheritanceChain()
+    {
+        var tempDir = CreateVisibilityMudlib();
+        File.WriteAllText(Path.Combine(tempDir, "test", "grandchild.c"), @"
+inherit ""/test/child"";
+
+int public_func() {
+    return 10;
+}
+");
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var program = om.LoadObject("/test/grandchild").Program;
+        var parent = om.LoadObject("/test/visibility").Program;
+
+        // Own functions override, inherited ones report the program that defines them
+        Assert.Same(program, program.FindFunctionWithProgram("public_func").OwningProgram);
+        Assert.Same(parent, program.FindFunctionWithProgram("static_func").OwningProgram);
+        Assert.Equal(FunctionVisibility.Static, program.AllFunctions["static_func"].Visibility & FunctionVisibility.Static);
+
+        // Private functions stay with the program that declares them
+        Assert.Null(program.FindFunction("private_func"));
+        Assert.NotNull(om.LoadObject("/test/child").Program.FindFunction("private_func"));
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void FunctionTable_RebuiltForChildrenOnHotReload()
+    {
+        var tempDir = CreateVisibilityMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var child = om.LoadObject("/test/child");
+        Assert.Null(child.FindFunction("added_later"));
+
+        File.AppendAllText(Path.Combine(tempDir, "test", "visibility.c"), @"
+int added_later() {
+    return 5;
+}
+");
+        om.UpdateObject("/test/visibility");
+
+        Assert.NotNull(child.FindFunction("added_later"));
+        Assert.Equal(5L, om.Interpreter!.CallFunctionOnObject(child, "added_later", new List<object>()));
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void Precompile_BuildsProgramsWithoutLoadingThem()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var report = om.Precompile(maxParallelism: 2);
+
+        Assert.Equal(2, report.Compiled);
+        Assert.Equal(0, report.Failed);
+        Assert.Equal(new[] { "/std/object", "/std/weapon" }, report.Files.Select(f => f.Path).ToArray());
+        Assert.Null(om.FindObject("/std/weapon"));   // create() hasn't run
+        Assert.Equal(2, om.PrecompiledCount);
+
+        var weapon = om.LoadObject("/std/weapon");
+
+        // Loading consumes the precompiled programs (parent first) and runs create() as usual
+        Assert.Equal(0, om.PrecompiledCount);
+        Assert.Same(om.LoadObject("/std/object").Program, weapon.Program.InheritedPrograms[0]);
+        Assert.Equal(10L, om.Interpreter!.CallFunctionOnObject(weapon, "query_mass", new List<object>()));
+        Assert.Contains("/std/weapon", om.GetInheritanceChildren("/std/object"));
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void Precompile_ReportsBrokenFilesAndTheirChildren()
+    {
+        var tempDir = CreateTempMudlib();
+        File.WriteAllText(Path.Combine(tempDir, "std", "object.c"), "int broken( {");
+        var om = new ObjectManager(tempDir);
+
+        var report = om.Precompile();
+
+        Assert.Equal(0, report.Compiled);
+        Assert.Equal(2, report.Failed);
+        Assert.Contains("/std/object", report.Files.Single(f => f.Path == "/std/weapon").Error);
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void Precompile_EditedSourceIsRecompiledOnLoad()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+        om.Precompile();
+
+        File.WriteAllText(Path.Combine(tempDir, "std", "object.c"), @"
+void create() { }
+int query_mass() { return 99; }
+void set_mass(int m) { }
+");
+        var weapon = om.LoadObject("/std/weapon");
+
+        // The parent changed, so the child's precompiled program (built on the old parent) is discarded
+        Assert.Same(om.LoadObject("/std/object").Program, weapon.Program.InheritedPrograms[0]);
+        Assert.Equal(99L, om.Interpreter!.CallFunctionOnObject(weapon, "query_mass", new List<object>()));
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void Precompile_EditedIncludeIsRecompiledOnLoad()
+    {
+        var tempDir = CreateTempMudlib();
+        Directory.CreateDirectory(Path.Combine(tempDir, "include"));
+        Directory.CreateDirectory(Path.Combine(tempDir, "test"));
+        File.WriteAllText(Path.Combine(tempDir, "include", "mass.c"), "#define MASS 10\n");
+        File.WriteAllText(Path.Combine(tempDir, "test", "heavy.c"), @"
+#include ""/include/mass""
+int query_mass() { return MASS; }
+");
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+        om.Precompile();
+
+        // Only the header changed: the source text still matches the precompiled entry
+        File.WriteAllText(Path.Combine(tempDir, "include", "mass.c"), "#define MASS 20\n");
+        var heavy = om.LoadObject("/test/heavy");
+
+        Assert.Equal(20L, om.Interpreter!.CallFunctionOnObject(heavy, "query_mass", new List<object>()));
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void PlainClones_AllocateNoColdState()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+        var blueprint = om.LoadObject("/std/object");
+        new MudObject(blueprint, 1_000_000);
+
+        const int count = 1000;
+        long before = GC.GetAllocatedBytesForCurrentThread();
+        for (int i = 0; i < count; i++)
+        {
+            new MudObject(blueprint, 1_000_001 + i);
+        }
+        long perClone = (GC.GetAllocatedBytesForCurrentThread() - before) / count;
+
+        // The object, its two variable slots and its place in the blueprint's
+        // list; empty action tables and a clone list of its own came to ~800
+        Assert.True(perClone < 480, $"{perClone} bytes per clone");
+
+        var clone = blueprint.Clones[^1];
+        Assert.Empty(clone.Clones);
+        Assert.Empty(clone.Actions);
+        Assert.Null(clone.FindAction("look"));
+        clone.ShadowedBy = null;
+        clone.BindSession(null);
+        Assert.True(clone.TryResolveCall("query_short", out var target, out _));
+        Assert.Same(clone, target);
+
+        CleanupTemp(tempDir);
+    }
+
+    [Fact]
+    public void DestructedClones_HandTheirVariablesToTheNextClone()
+    {
+        var tempDir = CreateTempMudlib();
+        var om = new ObjectManager(tempDir);
+        om.InitializeInterpreter();
+
+        var corpse = om.CloneObject("/std/object");
+        om.Interpreter!.CallFunctionOnObject(corpse, "set_short", new List<object> { "a corpse" });
+        om.DestructObject(corpse);
+
+        // Not until the end of the tick: the destructed object still has its state
+        Assert.Equal(0, corpse.Blueprint!.PooledVariableArrays);
+        Assert.Equal("a corpse", corpse.GetVariable("short_desc"));
+
+        om.RecycleDestructed();
+        Assert.Equal(1, corpse.Blueprint.PooledVariableArrays);
+        Assert.False(corpse.HasVariable("short_desc"));
+
+        var next = om.CloneObject("/std/object");
+        Assert.Equal(0, next.Blueprint!.PooledVariableArrays);
+        Assert.NotSame(corpse, next);
+        Assert.True(corpse.IsDestructed);
+        Assert.Equal("something", om.Interpreter.CallFunctionOnObject(next, "query_short", new List<object>()));
+        Assert.Equal(1L, om.Interpreter.CallFunctionOnObject(next, "query_mass", new List<object>()));
+
+        CleanupTemp(tempDir);
+    }
+
     private string CreateVisibilityMudlib()
     {
         var tempDir = Path.Combine(Path.GetTempPath(), "lpc_vis_test_" + Guid.NewGuid().ToString("N")[..8]);
@@ -0,0 +1,138 @@
+using System.Net;
+using System.Net.Sockets;
+using System.Text;
+using Xunit;
+
+namespace Driver.Tests;
+
+public class OutboundRequestsTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly TcpListener _listener = new(IPAddress.Loopback, 0);
+
+    public OutboundRequestsTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_outbound_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "secure", "accounts"));
+        _listener.Start();
+    }
+
+    public void Dispose()
+    {
+        _listener.Stop();
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private int Port => ((IPEndPoint)_listener.LocalEndpoint).Port;
+
+    private static void WaitUntil(Func<bool> condition)
+    {
+        var deadline = DateTime.UtcNow.AddSeconds(5);
+        while (!condition() && DateTime.UtcNow < deadline)
+        {
+            Thread.Sleep(10);
+        }
+    }
+
+    /// <summary>
+    /// Answer connections by reading the request to its end and sending it
+    /// back upper-cased.
+    /// </summary>
+    private void ServeUpperCase()
+    {
+        _ = Task.Run(async () =>
+        {
+            while (true)
+            {
+                using var client = await _listener.AcceptTcpClientAsync();
+                var stream = client.GetStream();
+                var request = new MemoryStream();
+                await stream.CopyToAsync(request);
+                await stream.WriteAsync(Encoding.UTF8.GetBytes(Encoding.UTF8.GetString(request.ToArray()).ToUpperInvariant()));
+            }
+        });
+    }
+
+    [Fact]
+    public void TcpRequest_DeliversTheReplyThroughACallout()
+    {
+        File.WriteAllText(Path.Combine(_mudlibPath, "bridge.c"), @"
+mixed reply;
+int reply_id;
+
+int start(int port) { return tcp_request(""127.0.0.1"", port, ""hello"", ""answered""); }
+void answered(int id, mapping result) { reply_id = id; reply = result; }
+
+mixed query_reply() { return reply; }
+int query_reply_id() { return reply_id; }
+");
+        ServeUpperCase();
+        var objectManager = new ObjectManager(_mudlibPath);
+        objectManager.InitializeInterpreter();
+        var gameLoop = new GameLoop(objectManager, new AccountManager(_mudlibPath));
+        gameLoop.InitializeInterpreter(new ObjectInterpreter(objectManager));
+        var bridge = objectManager.LoadObject("/bridge");
+        object? Call(string function, params object[] args) =>
+            objectManager.Interpreter!.CallFunctionOnObject(bridge, function, args.ToList());
+
+        long id = Convert.ToInt64(Call("start", (long)Port));
+        Assert.True(id > 0);
+        WaitUntil(() => gameLoop.Requests.InFlight == 0);
+        Assert.Equal(0L, Convert.ToInt64(Call("query_reply_id")));
+
+        gameLoop.Step();
+
+        Assert.Equal(id, Convert.ToInt64(Call("query_reply_id")));
+        var reply = Assert.IsType<LpcMapping>(Call("query_reply"));
+        Assert.Equal("HELLO", reply["data"]);
+    }
+
+    [Fact]
+    public void Requests_AreLimitedPerObjectAndTimeOut()
+    {
+        var objectManager = new ObjectManager(_mudlibPath);
+        objectManager.InitializeInterpreter();
+        var first = objectManager.LoadSource("/first", "void create() {}");
+        var second = objectManager.LoadSource("/second", "void create() {}");
+        var requests = new OutboundRequests { MaxPerObject = 2 };
+        var results = new List<(int Id, LpcMapping Result)>();
+        void Done(int id, LpcMapping result)
+        {
+            lock (results) results.Add((id, result));
+        }
+
+        // Nothing answers: the listener's backlog accepts the connections
+        var timeout = TimeSpan.FromMilliseconds(200);
+        int a = requests.Tcp(first, "127.0.0.1", Port, "x", timeout, Done);
+        int b = requests.Tcp(first, "127.0.0.1", Port, "x", timeout, Done);
+        Assert.Equal(0, requests.Tcp(first, "127.0.0.1", Port, "x", timeout, Done));
+        int c = requests.Tcp(second, "127.0.0.1", Port, "x", timeout, Done);
+        Assert.True(a > 0 && b > a && c > b);
+
+        WaitUntil(() => requests.InFlight == 0);
+
+        Assert.Equal(new[] { a, b, c }, results.Select(r => r.Id).Order().ToArray());
+        Assert.All(results, r => Assert.Equal("timed out", r.Result["error"]));
+        Assert.True(requests.Tcp(first, "127.0.0.1", Port, "x", timeout, Done) > 0);
+    }
+
+    [Fact]
+    public void ResponsesOverTheLimit_AreErrors()
+    {
+        var objectManager = new ObjectManager(_mudlibPath);
+        objectManager.InitializeInterpreter();
+        var owner = objectManager.LoadSource("/owner", "void create() {}");
+        var requests = new OutboundRequests { MaxResponseBytes = 8 };
+        ServeUpperCase();
+        LpcMapping? result = null;
+
+        requests.Tcp(owner, "127.0.0.1", Port, "more than eight bytes", OutboundRequests.DefaultTimeout, (_, r) => result = r);
+        WaitUntil(() => requests.InFlight == 0);
+
+        Assert.NotNull(result);
+        Assert.Contains("over 8 bytes", (string)result!["error"]);
+    }
+}
@@ -0,0 +1,46 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class OutputObserversTests
+{
+    [Fact]
+    public void Add_CopiesATargetToEachObserverOnce()
+    {
+        var observers = new OutputObservers();
+
+        Assert.True(observers.Add("bob", "admin", "[Bob]\n"));
+        Assert.True(observers.Add("bob", "helper", "[Bob]\n"));
+        Assert.True(observers.Add("carol", "admin", "[Carol]\n"));
+        Assert.False(observers.Add("bob", "admin", "[Bob]\n"));
+        Assert.False(observers.Add("admin", "admin", "[Admin]\n"));
+
+        Assert.Equal(new[] { "admin", "helper" }, observers.For("bob").ToArray().Select(o => o.ConnectionId));
+        Assert.Equal("[Carol]\n", observers.For("carol")[0].Header);
+        Assert.True(observers.For("dave").IsEmpty);
+        Assert.Equal(new[] { "bob", "carol" }, observers.TargetsOf("admin").Order());
+        Assert.Equal(3, observers.Count);
+    }
+
+    [Fact]
+    public void Remove_EndsOneOrAllObservations()
+    {
+        var observers = new OutputObservers();
+        observers.Add("bob", "admin", "[Bob]\n");
+        observers.Add("carol", "admin", "[Carol]\n");
+        observers.Add("carol", "helper", "[Carol]\n");
+
+        Assert.Equal(1, observers.Remove("admin", "bob"));
+        Assert.Equal(0, observers.Remove("admin", "bob"));
+        Assert.True(observers.For("bob").IsEmpty);
+
+        observers.Add("bob", "admin", "[Bob]\n");
+        Assert.Equal(2, observers.Remove("admin"));
+        Assert.Equal(new[] { "helper" }, observers.ObserversOf("carol"));
+
+        // A closed connection drops out as observer and as target
+        observers.Add("helper", "bob", "[Helper]\n");
+        observers.RemoveConnection("helper");
+        Assert.Equal(0, observers.Count);
+    }
+}
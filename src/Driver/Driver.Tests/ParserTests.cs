@@ -52,6 +52,19 @@ public class ParserTests
         Assert.Equal("", str.Value);
     }
 
+    [Fact]
+    public void Parse_ShortStrings_ArePooled()
+    {
+        var first = Assert.IsType<StringLiteral>(Parse("\"sword\""));
+        var second = Assert.IsType<StringLiteral>(Parse("\"sword\""));
+        var longText = new string('x', StringPool.MaxLength + 1);
+        var firstLong = Assert.IsType<StringLiteral>(Parse($"\"{longText}\""));
+        var secondLong = Assert.IsType<StringLiteral>(Parse($"\"{longText}\""));
+
+        Assert.Same(first.Value, second.Value);
+        Assert.NotSame(firstLong.Value, secondLong.Value);
+    }
+
     #endregion
 
     #region Arithmetic Operators
@@ -700,6 +713,19 @@ public class ParserTests
         Assert.Null(forStmt.Increment);
     }
 
+    [Fact]
+    public void Parse_ForeachOverKeysAndValues()
+    {
+        var single = Assert.IsType<ForEachStatement>(ParseStmtOrExpr("foreach (k in m) x = k;"));
+        Assert.Equal("k", single.Variable);
+        Assert.Null(single.ValueVariable);
+
+        var pair = Assert.IsType<ForEachStatement>(ParseStmtOrExpr("foreach (k, v in m) x = v;"));
+        Assert.Equal("k", pair.Variable);
+        Assert.Equal("v", pair.ValueVariable);
+        Assert.IsType<Identifier>(pair.Collection);
+    }
+
     [Fact]
     public void Parse_ReturnStatement()
     {
@@ -812,6 +838,16 @@ public class ParserTests
         Assert.Equal("c", funcDef.Parameters[2]);
     }
 
+    [Fact]
+    public void Parse_FunctionDefinition_KeepsParameterTypes()
+    {
+        var result = ParseStmtOrExpr("int f(int a, string *names, b) { return a; }");
+
+        var funcDef = Assert.IsType<FunctionDefinition>(result);
+        Assert.Equal(new[] { "a", "names", "b" }, funcDef.Parameters);
+        Assert.Equal(new[] { "int", "string *", "mixed" }, funcDef.ParameterTypes);
+    }
+
     [Fact]
     public void Parse_FunctionDefinition_VoidType()
     {
@@ -864,5 +900,19 @@ public class ParserTests
         Assert.Equal("b", funcDef.Parameters[1]);
     }
 
+    [Fact]
+    public void ParseProgram_FromLexer_MatchesTokenList()
+    {
+        var source = string.Join("\n", Enumerable.Range(0, 40).Select(i =>
+            $"int f{i}(int a) {{ if (a > {i}) return a * 2 + {i}; else return ({{ a, \"x{i}\" }})[0]; }}"));
+
+        var fromList = new Parser(new Lexer(source).Tokenize()).ParseProgram();
+        var fromLexer = new Parser(new Lexer(source)).ParseProgram();
+
+        Assert.Equal(40, fromLexer.Count);
+        Assert.Equal(fromList.Select(s => ((FunctionDefinition)s).Name), fromLexer.Select(s => ((FunctionDefinition)s).Name));
+        Assert.Equal(fromList.Select(s => s.ToString()), fromLexer.Select(s => s.ToString()));
+    }
+
     #endregion
 }
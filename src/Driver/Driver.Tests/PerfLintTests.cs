@@ -0,0 +1,114 @@
+namespace Driver.Tests;
+
+public class PerfLintTests
+{
+    private static List<PerfWarning> Lint(string source)
+    {
+        return PerfLint.Check("/test/lint", new Parser(new Lexer(source)).ParseProgram(), null);
+    }
+
+    [Fact]
+    public void FlagsAppendingToAnArrayInALoop()
+    {
+        var warnings = Lint(@"
+string *result;
+mapping seen;
+string *f(string *names) {
+    string *local;
+    int i;
+    result = ({ });
+    for (i = 0; i < sizeof(names); i++) {
+        result = result + ({ names[i] });
+        seen = seen + ([ names[i]: 1 ]);
+        local = local + ({ names[i] });
+        names = names + ({ });
+    }
+    result = result + ({ ""done"" });
+    return result;
+}");
+
+        // Locals and parameters are grown in place, so only object variables are flagged
+        Assert.Equal(2, warnings.Count);
+        Assert.Equal(9, warnings[0].Line);
+        Assert.Equal("/test/lint", warnings[0].File);
+        Assert.Equal("f", warnings[0].Function);
+        Assert.Contains("result = result + ({ ... })", warnings[0].Message);
+        Assert.Contains("seen = seen + ([ ... ])", warnings[1].Message);
+        Assert.StartsWith("/test/lint:9: ", warnings[0].ToString());
+    }
+
+    [Fact]
+    public void FlagsCallsInAForCondition()
+    {
+        var warnings = Lint(@"
+void f(object room, string *names) {
+    int i;
+    for (i = 0; i < sizeof(names); i++) { }
+    for (i = 0; i < sizeof(all_inventory(room)); i++) { }
+    for (i = 0; i < room->query_count(); i++) { }
+}");
+
+        Assert.Equal(2, warnings.Count);
+        Assert.Contains("sizeof(all_inventory())", warnings[0].Message);
+        Assert.Contains("->query_count()", warnings[1].Message);
+    }
+
+    [Fact]
+    public void FlagsCallOtherInNestedLoopsOverAnInventory()
+    {
+        var warnings = Lint(@"
+void f(object room, object *players) {
+    object ob;
+    object player;
+    foreach (ob in all_inventory(room)) {
+        foreach (player in players) {
+            player->notice(ob);
+            call_other(player, ""notice"", ob);
+        }
+        ob->reset();
+    }
+    foreach (ob in players) {
+        foreach (player in players) {
+            player->notice(ob);
+        }
+    }
+}");
+
+        // One per inner loop; the outer loop's own call and loops not over an inventory are fine
+        var warning = Assert.Single(warnings);
+        Assert.Equal(7, warning.Line);
+        Assert.Contains("call_other in nested loops", warning.Message);
+    }
+
+    [Fact]
+    public void ProgramsKeepTheirWarnings()
+    {
+        var tempDir = Path.Combine(Path.GetTempPath(), $"perflint_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(tempDir);
+        try
+        {
+            var om = new ObjectManager(tempDir);
+            om.InitializeInterpreter();
+            var obj = om.LoadSource("/test/lint", @"
+int *result;
+int *squares(int n) {
+    int i;
+    result = ({ });
+    for (i = 0; i < n; i++) {
+        result = result + ({ i * i });
+    }
+    return result;
+}
+mixed warnings() { return perf_warnings(this_object()); }
+");
+
+            var warnings = Assert.IsType<List<object>>(
+                om.Interpreter!.CallFunctionOnObject(obj, "warnings", new List<object>()));
+            Assert.StartsWith("/test/lint:7: result = result + ({ ... }) in a loop", Assert.IsType<string>(Assert.Single(warnings)));
+        }
+        finally
+        {
+            Directory.Delete(tempDir, true);
+        }
+    }
+}
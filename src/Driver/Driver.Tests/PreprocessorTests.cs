@@ -357,6 +357,38 @@ int FOO = 30;";
         Assert.Contains("int 10 = 30;", result);
     }
 
+    [Fact]
+    public void Define_ExpandsValuesButNotLiteralsOrItself()
+    {
+        var source = @"#define BASE 10
+#define TOTAL BASE + 5
+#define LOOP LOOP + 1
+string s = ""TOTAL is 'BASE'""; int t = TOTAL; int l = LOOP;";
+
+        var result = _preprocessor.Process(source, "/test.c");
+
+        Assert.Contains("string s = \"TOTAL is 'BASE'\"; int t = 10 + 5; int l = LOOP + 1;", result);
+    }
+
+    [Fact]
+    public void Include_EditedHeaderIsReadAgain()
+    {
+        Directory.CreateDirectory(Path.Combine(_testDir, "include"));
+        var header = Path.Combine(_testDir, "include", "limits.c");
+        File.WriteAllText(header, "#define LIMIT 1");
+
+        var source = @"#include ""/include/limits""
+int x = LIMIT;";
+        Assert.Contains("int x = 1;", _preprocessor.Process(source, "/test.c"));
+        Assert.Contains("int x = 1;", _preprocessor.Fork().Process(source, "/other.c"));
+
+        File.WriteAllText(header, "#define LIMIT 22");
+        File.SetLastWriteTimeUtc(header, DateTime.UtcNow.AddMinutes(1));
+
+        Assert.Contains("int x = 22;", _preprocessor.Process(source, "/test.c"));
+        Assert.Equal(new[] { Path.GetFullPath(header) }, _preprocessor.IncludedFiles);
+    }
+
     [Fact]
     public void Predefine_CanSetMacrosBeforeProcessing()
     {
@@ -369,6 +401,17 @@ int FOO = 30;";
         Assert.Contains("int x = 999;", result);
     }
 
+    [Fact]
+    public void Defines_DoNotCarryOverBetweenFiles()
+    {
+        _preprocessor.Define("PREDEFINED", "999");
+        _preprocessor.Process("#define LOCAL 1\nint x = LOCAL;", "/first.c");
+
+        var result = _preprocessor.Process("int y = LOCAL + PREDEFINED;", "/second.c");
+
+        Assert.Contains("int y = LOCAL + 999;", result);
+    }
+
     [Fact]
     public void LinesPreservedForLineNumbers()
     {
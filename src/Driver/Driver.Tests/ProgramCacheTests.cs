@@ -0,0 +1,218 @@
+using Xunit;
+using System.IO;
+
+namespace Driver.Tests;
+
+public class ProgramCacheTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly string _cachePath;
+
+    public ProgramCacheTests()
+    {
+        var root = Path.Combine(Path.GetTempPath(), "lpc_progcache_test_" + Guid.NewGuid().ToString("N")[..8]);
+        _mudlibPath = Path.Combine(root, "mudlib");
+        _cachePath = Path.Combine(root, "cache");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "include"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "test"));
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "include", "values.c"), @"
+#define BASE 10
+");
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "base.c"), @"
+int base_value() { return 1; }
+");
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "test", "thing.c"), @"
+#include ""/include/values""
+inherit ""/std/base"";
+
+int counter;
+mapping table = ([ ""a"": 1, ""b"": ({ 2, 3 }) ]);
+
+int value() {
+    int i;
+    int total;
+    for (i = 0; i < 3; i++) {
+        if (i == 1) continue;
+        total += i;
+    }
+    switch (total) {
+        case 2: total = total * BASE; break;
+        default: total = -1;
+    }
+    return total + base_value() + (counter ? 100 : 0);
+}
+
+string slice(string s) { return s[1..2] + ::base_value(); }
+");
+    }
+
+    public void Dispose()
+    {
+        var root = Path.GetDirectoryName(_mudlibPath)!;
+        if (Directory.Exists(root))
+        {
+            Directory.Delete(root, recursive: true);
+        }
+    }
+
+    private ObjectManager CreateManager()
+    {
+        var om = new ObjectManager(_mudlibPath) { ProgramCache = new ProgramCache(_cachePath) };
+        om.InitializeInterpreter();
+        return om;
+    }
+
+    private static object? Call(ObjectManager om, MudObject obj, string name, params object[] args)
+    {
+        om.Interpreter!.ResetInstructionCount();
+        return om.Interpreter.CallFunctionOnObject(obj, name, args.ToList());
+    }
+
+    private static byte[] Serialize(LpcProgram program)
+    {
+        using var stream = new MemoryStream();
+        using (var writer = new BinaryWriter(stream))
+        {
+            var statements = new List<Statement>(program.VariableInitializers);
+            statements.AddRange(program.Functions.Values.OrderBy(f => f.Name));
+            AstSerializer.WriteStatements(writer, statements);
+        }
+        return stream.ToArray();
+    }
+
+    [Fact]
+    public void SecondStart_LoadsFromCache()
+    {
+        var first = CreateManager();
+        var thing = first.LoadObject("/test/thing");
+        Assert.Equal(21L, Call(first, thing, "value"));
+        Assert.Equal(0, first.ProgramCache!.Hits);
+        Assert.Equal(2, first.ProgramCache.Misses);
+
+        var second = CreateManager();
+        var cachedThing = second.LoadObject("/test/thing");
+
+        Assert.Equal(2, second.ProgramCache!.Hits);
+        Assert.Equal(0, second.ProgramCache.Misses);
+        Assert.Equal(21L, Call(second, cachedThing, "value"));
+        Assert.Equal("el1", Call(second, cachedThing, "slice", "hello"));
+        Assert.Equal(new[] { "string" }, cachedThing.Program.Functions["slice"].ParameterTypes);
+        Assert.Equal(Serialize(thing.Program), Serialize(cachedThing.Program));
+        Assert.Equal(thing.Program.LineMap!.Resolve(9), cachedThing.Program.LineMap!.Resolve(9));
+    }
+
+    [Fact]
+    public void ChangedSource_IsRecompiled()
+    {
+        CreateManager().LoadObject("/test/thing");
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "base.c"), @"
+int base_value() { return 5; }
+");
+
+        var second = CreateManager();
+        var thing = second.LoadObject("/test/thing");
+
+        Assert.Equal(1, second.ProgramCache!.Hits);   // /test/thing itself is unchanged
+        Assert.Equal(1, second.ProgramCache.Misses);  // /std/base was edited
+        Assert.Equal(25L, Call(second, thing, "value"));
+    }
+
+    [Fact]
+    public void ChangedInclude_IsRecompiled()
+    {
+        CreateManager().LoadObject("/test/thing");
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "include", "values.c"), @"
+#define BASE 20
+");
+
+        var second = CreateManager();
+        var thing = second.LoadObject("/test/thing");
+
+        Assert.Equal(1, second.ProgramCache!.Misses);
+        Assert.Equal(41L, Call(second, thing, "value"));
+    }
+
+    [Fact]
+    public void CorruptEntry_IsIgnored()
+    {
+        CreateManager().LoadObject("/test/thing");
+
+        foreach (var file in Directory.GetFiles(_cachePath, "*.lpcc"))
+        {
+            var bytes = File.ReadAllBytes(file);
+            File.WriteAllBytes(file, bytes[..(bytes.Length / 2)]);
+        }
+
+        var second = CreateManager();
+        var thing = second.LoadObject("/test/thing");
+
+        Assert.Equal(0, second.ProgramCache!.Hits);
+        Assert.Equal(21L, Call(second, thing, "value"));
+
+        // The recompile rewrote the entries
+        var third = CreateManager();
+        third.LoadObject("/test/thing");
+        Assert.Equal(2, third.ProgramCache!.Hits);
+    }
+
+    [Fact]
+    public void HotReload_UsesEditedSource()
+    {
+        var om = CreateManager();
+        var thing = om.LoadObject("/test/thing");
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "test", "thing.c"), @"
+int value() { return 7; }
+");
+        om.UpdateObject("/test/thing");
+
+        Assert.Equal(7L, Call(om, thing, "value"));
+    }
+
+    [Fact]
+    public void HotReload_LetsTheOldProgramGo()
+    {
+        var om = CreateManager();
+        var thing = om.LoadObject("/test/thing");
+        var clone = om.CloneObject("/test/thing");
+        Assert.Equal(21L, Call(om, clone, "value"));
+        var old = Unreferenced(thing);
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "test", "thing.c"), @"
+int value() { return 7; }
+");
+        om.UpdateObject("/test/thing");
+        Assert.Equal(7L, Call(om, clone, "value"));
+
+        GC.Collect();
+        GC.WaitForPendingFinalizers();
+        GC.Collect();
+        Assert.False(old.TryGetTarget(out _));
+    }
+
+    // Kept out of line so the JIT holds no stray reference to the program
+    [System.Runtime.CompilerServices.MethodImpl(System.Runtime.CompilerServices.MethodImplOptions.NoInlining)]
+    private static WeakReference<LpcProgram> Unreferenced(MudObject obj) => new(obj.Program);
+
+    [Fact]
+    public void HotReload_KeepsUnchangedFunctions()
+    {
+        var om = CreateManager();
+        var thing = om.LoadObject("/test/thing");
+        var slice = thing.Program.Functions["slice"];
+
+        var file = Path.Combine(_mudlibPath, "test", "thing.c");
+        File.WriteAllText(file, File.ReadAllText(file).Replace("total * BASE", "total * BASE + 1"));
+        om.UpdateObject("/test/thing");
+
+        Assert.Equal(22L, Call(om, thing, "value"));
+        // The unchanged function was carried over without keeping any source
+        Assert.Same(slice, thing.Program.Functions["slice"]);
+    }
+}
@@ -0,0 +1,116 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class QueryMemoTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ObjectManager _objectManager;
+    private readonly ObjectInterpreter _interpreter;
+
+    public QueryMemoTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_memo_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(_mudlibPath);
+        File.WriteAllText(Path.Combine(_mudlibPath, "thing.c"), @"
+string name;
+string *ids;
+int level;
+
+string query_name() { return name; }
+string *query_ids() { return ids; }
+string query_title() {
+    if (level > 5) return ""Lord "" + name;
+    return name;
+}
+int query_first_id() { return ids[0]; }
+string query_upper() { return upper_case(name); }
+int query_next(int n) { return level + n; }
+
+void set_name(string n) { name = n; }
+void set_level(int n) { level = n; }
+void add_id(string id) { ids = (ids ? ids : ({ })) + ({ id }); }
+");
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter();
+        _interpreter = _objectManager.Interpreter!;
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private object? Call(MudObject obj, string function, params object[] args) =>
+        _interpreter.CallFunctionOnObject(obj, function, args.ToList());
+
+    [Fact]
+    public void Compiler_MarksOnlyPureQueries()
+    {
+        var functions = _objectManager.LoadObject("/thing").Program.CompiledFunctions;
+
+        Assert.Equal(QueryMemoKind.Getter, functions["query_name"].Memo);
+        Assert.Equal(QueryMemoKind.Getter, functions["query_ids"].Memo);
+        Assert.Equal(QueryMemoKind.Scalar, functions["query_title"].Memo);
+        // Indexing, calls, arguments and writes all rule it out
+        Assert.Equal(QueryMemoKind.None, functions["query_first_id"].Memo);
+        Assert.Equal(QueryMemoKind.None, functions["query_upper"].Memo);
+        Assert.Equal(QueryMemoKind.None, functions["query_next"].Memo);
+        Assert.Equal(QueryMemoKind.None, functions["set_name"].Memo);
+    }
+
+    [Fact]
+    public void RepeatedQueries_SkipTheVmUntilAVariableIsWritten()
+    {
+        var thing = _objectManager.CloneObject("/thing");
+        Call(thing, "set_name", "bob");
+
+        Assert.Equal("bob", Call(thing, "query_title"));
+        Assert.Equal("bob", Call(thing, "query_name"));
+        long before = _interpreter.ThreadInstructions;
+        Assert.Equal("bob", Call(thing, "query_title"));
+        Assert.Equal("bob", Call(thing, "query_name"));
+        Assert.Equal(before, _interpreter.ThreadInstructions);
+
+        Call(thing, "set_level", 9L);
+        Assert.Equal("Lord bob", Call(thing, "query_title"));
+        Call(thing, "set_name", "ann");
+        Assert.Equal("Lord ann", Call(thing, "query_title"));
+        Assert.Equal("ann", Call(thing, "query_name"));
+
+        // Each object has its own results
+        var other = _objectManager.CloneObject("/thing");
+        Call(other, "set_name", "cat");
+        Assert.Equal("cat", Call(other, "query_name"));
+        Assert.Equal("ann", Call(thing, "query_name"));
+    }
+
+    [Fact]
+    public void Getters_ReturnTheVariablesOwnArray()
+    {
+        var thing = _objectManager.CloneObject("/thing");
+        Call(thing, "add_id", "sword");
+        var first = Assert.IsType<List<object>>(Call(thing, "query_ids"));
+        Assert.Same(first, Call(thing, "query_ids"));
+
+        Call(thing, "add_id", "blade");
+        var second = Assert.IsType<List<object>>(Call(thing, "query_ids"));
+        Assert.Equal(new object[] { "sword", "blade" }, second);
+    }
+
+    [Fact]
+    public void WithMemoizationOff_EveryCallRuns()
+    {
+        _interpreter.MemoizeQueries = false;
+        var thing = _objectManager.CloneObject("/thing");
+        Call(thing, "set_name", "bob");
+        Call(thing, "query_name");
+
+        long before = _interpreter.ThreadInstructions;
+        Assert.Equal("bob", Call(thing, "query_name"));
+        Assert.True(_interpreter.ThreadInstructions > before);
+    }
+}
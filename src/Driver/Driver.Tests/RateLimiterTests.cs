@@ -0,0 +1,65 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class RateLimiterTests
+{
+    [Fact]
+    public void AllowCommand_AllowsABurstThenLimits()
+    {
+        var limiter = new RateLimiter { MaxCommandsPerWindow = 5, WindowSeconds = 60 };
+        var rate = new CommandRate();
+
+        for (int i = 0; i < 5; i++)
+        {
+            Assert.True(limiter.AllowCommand(rate));
+        }
+        Assert.False(limiter.AllowCommand(rate));
+        Assert.Equal(0, limiter.GetRemainingCommands(rate));
+
+        // Buckets are per connection
+        var other = new CommandRate();
+        Assert.Equal(5, limiter.GetRemainingCommands(other));
+        Assert.True(limiter.AllowCommand(other));
+        Assert.Equal(4, limiter.GetRemainingCommands(other));
+    }
+
+    [Fact]
+    public void AllowCommand_RefillsOverTime()
+    {
+        var limiter = new RateLimiter { MaxCommandsPerWindow = 20, WindowSeconds = 1 };
+        var rate = new CommandRate();
+
+        while (limiter.AllowCommand(rate)) { }
+        Thread.Sleep(120);
+
+        // One command back every 50ms
+        Assert.True(limiter.AllowCommand(rate));
+        Assert.True(limiter.AllowCommand(rate));
+    }
+
+    [Fact]
+    public void AllowCommand_CountsEveryCommandUnderContention()
+    {
+        var limiter = new RateLimiter { MaxCommandsPerWindow = 1000, WindowSeconds = 3600 };
+        var rate = new CommandRate();
+        int allowed = 0;
+
+        Parallel.For(0, 4000, _ =>
+        {
+            if (limiter.AllowCommand(rate)) Interlocked.Increment(ref allowed);
+        });
+
+        Assert.Equal(1000, allowed);
+    }
+
+    [Fact]
+    public void Disabled_AllowsEverything()
+    {
+        var limiter = new RateLimiter { MaxCommandsPerWindow = 1, Enabled = false };
+        var rate = new CommandRate();
+
+        Assert.True(limiter.AllowCommand(rate));
+        Assert.True(limiter.AllowCommand(rate));
+    }
+}
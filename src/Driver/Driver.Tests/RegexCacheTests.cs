@@ -0,0 +1,59 @@
+using System.Text.RegularExpressions;
+using Xunit;
+
+namespace Driver.Tests;
+
+public class RegexCacheTests
+{
+    [Fact]
+    public void Get_ReusesPatternsAndCompilesHotOnes()
+    {
+        var pattern = $"^test_{Guid.NewGuid():N}[0-9]+$";
+        var first = RegexCache.Get(pattern);
+
+        Assert.Same(first, RegexCache.Get(pattern));
+        Assert.NotSame(first, RegexCache.Get(pattern, RegexOptions.IgnoreCase));
+        Assert.Equal(RegexCache.MatchTimeout, first.MatchTimeout);
+        Assert.False(first.Options.HasFlag(RegexOptions.Compiled));
+
+        Regex hot = first;
+        for (int i = 2; i <= RegexCache.HotUses; i++)
+        {
+            hot = RegexCache.Get(pattern);
+        }
+        Assert.True(hot.Options.HasFlag(RegexOptions.Compiled));
+        Assert.Same(hot, RegexCache.Get(pattern));
+    }
+
+    [Fact]
+    public void Get_DropsTheLeastRecentlyUsed()
+    {
+        var prefix = Guid.NewGuid().ToString("N");
+        var oldest = RegexCache.Get(prefix + "old");
+        var kept = RegexCache.Get(prefix + "kept");
+        for (int i = 0; i < RegexCache.Capacity - 1; i++)
+        {
+            RegexCache.Get(prefix + i);
+            if (i % 16 == 0) RegexCache.Get(prefix + "kept");
+        }
+
+        Assert.True(RegexCache.Count <= RegexCache.Capacity);
+        Assert.Same(kept, RegexCache.Get(prefix + "kept"));
+        Assert.NotSame(oldest, RegexCache.Get(prefix + "old"));
+    }
+
+    private static object Eval(string source)
+    {
+        return new Interpreter().Evaluate(new Parser(new Lexer(source).Tokenize()).Parse());
+    }
+
+    [Fact]
+    public void Regmatch_TimesOutOnCatastrophicPatterns()
+    {
+        var subject = new string('a', 40) + "!";
+
+        Assert.Equal(3L, Eval("regmatch(\"abcdef\", \"d+\")"));
+        var ex = Assert.Throws<InterpreterException>(() => Eval($"regmatch(\"{subject}\", \"^(a+)+$\")"));
+        Assert.Contains("timed out", ex.Message);
+    }
+}
@@ -0,0 +1,147 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class RegionWorkersTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ObjectManager _objectManager;
+
+    public RegionWorkersTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_region_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        foreach (var area in new[] { "north", "south", "east", "west" })
+        {
+            Directory.CreateDirectory(Path.Combine(_mudlibPath, "world", "rooms", area));
+            File.WriteAllText(Path.Combine(_mudlibPath, "world", "rooms", area, "room.c"), "void create() { }\n");
+        }
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "counter.c"), @"
+int total;
+void bump() { total++; }
+int query_total() { return total; }
+");
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "beater.c"), @"
+object counter;
+object destination;
+int beats;
+void set_counter(object ob) { counter = ob; }
+void set_destination(object ob) { destination = ob; }
+int query_beats() { return beats; }
+void heart_beat() {
+    beats++;
+    if (counter) call_other(counter, ""bump"");
+    if (destination) {
+        move_object(this_object(), destination);
+        destination = 0;
+    }
+}
+");
+
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter();
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private RegionWorkers CreateWorkers(int threads)
+    {
+        return new RegionWorkers(threads, () => new ObjectInterpreter(_objectManager));
+    }
+
+    private long Call(MudObject obj, string function)
+    {
+        _objectManager.Interpreter!.ResetInstructionCount();
+        return Convert.ToInt64(_objectManager.Interpreter.CallFunctionOnObject(obj, function, new List<object>()));
+    }
+
+    private static void Beat(ObjectInterpreter interpreter, MudObject obj)
+    {
+        interpreter.ResetInstructionCount();
+        interpreter.CallFunctionOnObject(obj, "heart_beat", new List<object>());
+    }
+
+    [Fact]
+    public void RegionOf_IsTheAreaOfTheOutermostEnvironment()
+    {
+        Assert.Equal("town", RegionGuard.AreaOf("/world/rooms/town/square"));
+        Assert.Equal("town", RegionGuard.AreaOf("/world/rooms/town/inn/cellar"));
+        Assert.Null(RegionGuard.AreaOf("/world/rooms/void"));
+        Assert.Null(RegionGuard.AreaOf("/std/room"));
+
+        var room = _objectManager.LoadObject("/world/rooms/north/room");
+        var bag = _objectManager.CloneObject("/std/counter");
+        var coin = _objectManager.CloneObject("/std/counter");
+        Assert.Null(RegionGuard.RegionOf(coin));
+
+        bag.MoveTo(room);
+        coin.MoveTo(bag);
+        Assert.Equal("north", RegionGuard.RegionOf(room));
+        Assert.Equal("north", RegionGuard.RegionOf(coin));
+    }
+
+    [Fact]
+    public void Run_BeatsEveryRegionAndSerializesCrossRegionCalls()
+    {
+        var counter = _objectManager.LoadObject("/std/counter");
+        var groups = new List<(string, List<MudObject>)>();
+        var beaters = new List<MudObject>();
+        foreach (var area in new[] { "north", "south", "east", "west" })
+        {
+            var room = _objectManager.LoadObject($"/world/rooms/{area}/room");
+            var group = new List<MudObject>();
+            for (int i = 0; i < 50; i++)
+            {
+                var beater = _objectManager.CloneObject("/std/beater");
+                beater.MoveTo(room);
+                _objectManager.Interpreter!.CallFunctionOnObject(beater, "set_counter", new List<object> { counter });
+                group.Add(beater);
+            }
+            groups.Add((area, group));
+            beaters.AddRange(group);
+        }
+
+        using var workers = CreateWorkers(4);
+        for (int round = 0; round < 10; round++)
+        {
+            workers.Run(groups, Beat);
+        }
+
+        // The shared counter lives outside every region: each bump ran alone
+        Assert.Equal(200L * 10, Call(counter, "query_total"));
+        Assert.Equal(Enumerable.Repeat(10L, beaters.Count).ToArray(), beaters.Select(b => Call(b, "query_beats")).ToArray());
+        Assert.True(workers.ExclusiveSections >= 200 * 10);
+    }
+
+    [Fact]
+    public void Run_MovesObjectsAcrossRegions()
+    {
+        var north = _objectManager.LoadObject("/world/rooms/north/room");
+        var south = _objectManager.LoadObject("/world/rooms/south/room");
+        var traveller = _objectManager.CloneObject("/std/beater");
+        var stayer = _objectManager.CloneObject("/std/beater");
+        traveller.MoveTo(north);
+        stayer.MoveTo(north);
+        _objectManager.Interpreter!.CallFunctionOnObject(traveller, "set_destination", new List<object> { south });
+
+        using var workers = CreateWorkers(2);
+        workers.Run(new[] { ("north", new List<MudObject> { traveller, stayer }) }, Beat);
+
+        Assert.Same(south, traveller.Environment);
+        Assert.Equal("south", RegionGuard.RegionOf(traveller));
+        Assert.Equal(1L, Call(stayer, "query_beats"));
+
+        // The lock was released: the next run isn't stuck behind the move
+        workers.Run(new[] { ("south", new List<MudObject> { traveller }), ("north", new List<MudObject> { stayer }) }, Beat);
+        Assert.Equal(2L, Call(traveller, "query_beats"));
+        Assert.Equal(2L, Call(stayer, "query_beats"));
+    }
+}
@@ -64,6 +64,287 @@ void create() { ::create(); set_short(""a room""); }
         Assert.Equal(room, player.Environment);
     }
 
+    [Fact]
+    public void InteractiveCount_FollowsPlayersAcrossMovesAndLinkdead()
+    {
+        var first = _objectManager.CloneObject("/std/room");
+        var second = _objectManager.CloneObject("/std/room");
+        var player = _objectManager.CloneObject("/std/player");
+        var npc = _objectManager.CloneObject("/std/player");
+
+        player.IsInteractive = true;
+        player.MoveTo(first);
+        npc.MoveTo(first);
+        Assert.Equal(1, first.InteractiveCount);
+
+        player.MoveTo(second);
+        Assert.Equal(0, first.InteractiveCount);
+        Assert.Equal(1, second.InteractiveCount);
+
+        // Going linkdead in place empties the room
+        player.IsInteractive = false;
+        Assert.Equal(0, second.InteractiveCount);
+        player.IsInteractive = true;
+        Assert.Equal(1, second.InteractiveCount);
+
+        player.MoveTo(null);
+        Assert.Equal(0, second.InteractiveCount);
+    }
+
+    [Fact]
+    public void Contents_KeepArrivalOrderAndLivingSubset()
+    {
+        var room = _objectManager.CloneObject("/std/room");
+        var items = Enumerable.Range(0, 5).Select(_ => _objectManager.CloneObject("/std/object")).ToList();
+        foreach (var item in items) item.MoveTo(room);
+        items[1].IsLiving = true;
+        items[3].IsLiving = true;
+
+        // Leaving from the middle keeps everyone else in order
+        items[2].MoveTo(null);
+        Assert.Equal(new[] { items[0], items[1], items[3], items[4] }, room.Contents.ToArray());
+        Assert.Equal(new[] { items[1], items[3] }, room.LivingContents.ToArray());
+        Assert.Equal(items[3], room.Contents[2]);
+        Assert.Equal(items[0], room.Contents.First);
+
+        // A living arriving or becoming living lands in content order
+        items[2].IsLiving = true;
+        items[2].MoveTo(room);
+        items[0].IsLiving = true;
+        Assert.Equal(new[] { items[0], items[1], items[3], items[2] }, room.LivingContents.ToArray());
+        items[1].IsLiving = false;
+        Assert.Equal(new[] { items[0], items[3], items[2] }, room.LivingContents.ToArray());
+        Assert.False(room.LivingContents.Contains(items[1]));
+        Assert.True(room.Contents.Contains(items[1]));
+
+        // Changing the contents while walking them is an error, as with a List
+        Assert.Throws<InvalidOperationException>(() =>
+        {
+            foreach (var obj in room.Contents) obj.MoveTo(null);
+        });
+    }
+
+    [Fact]
+    public void MoveTo_RefusesContainmentCycles()
+    {
+        var bag = _objectManager.CloneObject("/std/object");
+        var box = _objectManager.CloneObject("/std/object");
+        var coin = _objectManager.CloneObject("/std/object");
+        box.MoveTo(bag);
+        coin.MoveTo(box);
+
+        Assert.True(bag.Contains(coin));
+        Assert.False(coin.Contains(bag));
+        Assert.False(bag.MoveTo(coin));
+        Assert.False(bag.MoveTo(box));
+        Assert.Null(bag.Environment);
+        Assert.True(coin.MoveTo(bag));
+    }
+
+    [Fact]
+    public void InventoryEfuns_WalkContentsAndLivings()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "walker.c"), @"
+int count_all(object room) {
+    object ob;
+    int n;
+    for (ob = first_inventory(room); ob; ob = next_inventory(ob)) n++;
+    return n;
+}
+int count_livings(object room) { return sizeof(all_livings(room)); }
+int count_players(object room) { return sizeof(all_interactive(room)); }
+");
+        var room = _objectManager.CloneObject("/std/room");
+        var walker = _objectManager.LoadObject("/std/walker");
+        var npc = _objectManager.CloneObject("/std/player");
+        var player = _objectManager.CloneObject("/std/player");
+        _objectManager.CloneObject("/std/object").MoveTo(room);
+        npc.IsLiving = true;
+        player.IsLiving = true;
+        player.IsInteractive = true;
+        npc.MoveTo(room);
+        player.MoveTo(room);
+
+        var interpreter = _objectManager.Interpreter!;
+        var args = new List<object> { room };
+        Assert.Equal(3L, interpreter.CallFunctionOnObject(walker, "count_all", args));
+        Assert.Equal(2L, interpreter.CallFunctionOnObject(walker, "count_livings", args));
+        Assert.Equal(1L, interpreter.CallFunctionOnObject(walker, "count_players", args));
+    }
+
+    [Fact]
+    public void ExitTable_ListsInCompassOrder_AndLoadsDestinationsOnce()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "hall.c"), @"
+inherit ""/std/room"";
+void create() {
+    ::create();
+    set_exit(""portal"", ""/std/room"");
+    set_exit(""s"", ""/std/room"");
+    set_exit(""n"", ""/std/room"");
+    set_exit(""d"", ""/std/room"", 1);
+}
+mixed *dirs(int all) { return exit_dirs(this_object(), all); }
+object dest(string dir) { return exit_destination(this_object(), dir); }
+int hidden(string dir) { return exit_is_hidden(this_object(), dir); }
+mixed path(string dir) { return exit_path(this_object(), dir); }
+");
+        var hall = _objectManager.LoadObject("/std/hall");
+        var interpreter = _objectManager.Interpreter!;
+        object Call(string function, object arg) => interpreter.CallFunctionOnObject(hall, function, new List<object> { arg })!;
+
+        Assert.Equal(new List<object> { "north", "south", "portal" }, Call("dirs", 0L));
+        Assert.Equal(new List<object> { "north", "south", "down", "portal" }, Call("dirs", 1L));
+        Assert.Equal(1L, Call("hidden", "down"));
+        Assert.Equal(0L, Call("hidden", "north"));
+        Assert.Equal("/std/room", Call("path", "south"));
+        Assert.Equal(0L, Call("path", "west"));
+        Assert.Equal(0L, Call("dest", "west"));
+
+        var room = Call("dest", "n");
+        Assert.Same(_objectManager.FindObject("/std/room"), room);
+        Assert.Same(room, Call("dest", "north"));
+
+        // A destination that was destructed is loaded again
+        _objectManager.DestructObject((MudObject)room);
+        var reloaded = Assert.IsType<MudObject>(Call("dest", "north"));
+        Assert.NotSame(room, reloaded);
+        Assert.False(reloaded.IsDestructed);
+    }
+
+    [Fact]
+    public void RenderCache_ServesEveryViewer_UntilContentsOrDescriptionsChange()
+    {
+        var room = _objectManager.LoadObject("/std/room");
+        var alice = _objectManager.CloneObject("/std/player");
+        var bob = _objectManager.CloneObject("/std/player");
+        var sword = _objectManager.CloneObject("/std/object");
+        alice.MoveTo(room);
+        bob.MoveTo(room);
+        sword.MoveTo(room);
+
+        var cache = _objectManager.RenderCache;
+        Assert.Null(cache.Render(room, alice));
+        cache.Store(room, "A room", new[] { alice, bob, sword }, new[] { "Alice is here.", "Bob is here.", "A sword is lying here." });
+
+        // One entry, each viewer's own line left out
+        Assert.Equal("A room\nBob is here.\nA sword is lying here.", cache.Render(room, alice));
+        Assert.Equal("A room\nAlice is here.\nA sword is lying here.", cache.Render(room, bob));
+
+        // A description changing anywhere in the room drops the entry
+        sword.DescriptionChanged();
+        Assert.Null(cache.Render(room, alice));
+
+        cache.Store(room, "A room", new[] { alice, bob }, new[] { "Alice is here.", "Bob is here." });
+        Assert.NotNull(cache.Render(room, alice));
+        room.DescriptionChanged();
+        Assert.Null(cache.Render(room, alice));
+
+        // So does anything arriving or leaving
+        cache.Store(room, "A room", new[] { alice, bob }, new[] { "Alice is here.", "Bob is here." });
+        bob.MoveTo(null);
+        Assert.Null(cache.Render(room, alice));
+
+        cache.Store(room, "A room", new[] { alice }, new[] { "Alice is here." });
+        _objectManager.DestructObject(sword);
+        Assert.Null(cache.Render(room, alice));
+    }
+
+    [Fact]
+    public void WorldGraph_RoutesThroughUnloadedRooms_AndFollowsSetExit()
+    {
+        var rooms = Path.Combine(_testMudlibPath, "world", "rooms");
+        Directory.CreateDirectory(rooms);
+        void Room(string name, string exits) => File.WriteAllText(Path.Combine(rooms, name + ".c"),
+            "void create() {\n" + exits + "}\nvoid open(string dir, string to) { set_exit(dir, to); }\n");
+        Room("gate", @"set_exit(""n"", ""/world/rooms/road""); set_exit(""down"", ""/world/rooms/cellar"", 1);");
+        Room("road", @"set_exit(""south"", ""/world/rooms/gate""); set_exit(""north"", ""/world/rooms/keep.c"");");
+        Room("keep", @"set_exit(""south"", ""/world/rooms/road"");");
+        Room("cellar", @"set_exit(""up"", ""/world/rooms/gate"");");
+
+        var graph = _objectManager.WorldGraph;
+        graph.Build(_objectManager);
+
+        // Nothing was loaded to build it
+        Assert.Null(_objectManager.FindObject("/world/rooms/road"));
+        Assert.Equal(new[] { "north", "north" }, graph.FindPath("/world/rooms/gate", "/world/rooms/keep", 5));
+        Assert.Null(graph.FindPath("/world/rooms/gate", "/world/rooms/keep", 1));
+        Assert.Empty(graph.FindPath("/world/rooms/keep", "/world/rooms/keep", 0)!);
+        // The hidden way down isn't a route
+        Assert.Null(graph.FindPath("/world/rooms/gate", "/world/rooms/cellar", 5));
+        Assert.Equal(new[] { "/world/rooms/road", "/world/rooms/keep" }, graph.Within("/world/rooms/gate", 2));
+
+        // A loaded room's set_exit() changes its edges
+        var keep = _objectManager.LoadObject("/world/rooms/keep");
+        _objectManager.Interpreter!.CallFunctionOnObject(keep, "open", new List<object> { "down", "/world/rooms/cellar" });
+        Assert.Equal(new[] { "north", "north", "down" }, graph.FindPath("/world/rooms/gate", "/world/rooms/cellar", 5));
+    }
+
+    private static List<MudObject.ActionEntry> ContentActions(MudObject container, string verb, MudObject? exclude = null)
+    {
+        var actions = new List<MudObject.ActionEntry>();
+        container.CollectContentActions(verb, exclude, actions);
+        return actions;
+    }
+
+    [Fact]
+    public void ContentActionIndex_FollowsAddRemoveAndMoves()
+    {
+        var room = _objectManager.CloneObject("/std/room");
+        var other = _objectManager.CloneObject("/std/room");
+        var player = _objectManager.CloneObject("/std/player");
+        var sign = _objectManager.CloneObject("/std/object");
+        var lever = _objectManager.CloneObject("/std/object");
+
+        // Actions added before and after arriving are both indexed
+        sign.AddAction("do_read", "read");
+        sign.MoveTo(room);
+        player.MoveTo(room);
+        lever.MoveTo(room);
+        lever.AddAction("do_pull", "pull");
+        player.AddAction("do_read_self", "read");
+
+        Assert.Equal(new[] { sign, player }, ContentActions(room, "read").Select(a => a.Owner));
+        Assert.Equal(new[] { sign }, ContentActions(room, "read", exclude: player).Select(a => a.Owner));
+        Assert.Equal("do_pull", ContentActions(room, "pull").Single().Function);
+        Assert.Empty(ContentActions(room, "push"));
+
+        // Re-adding replaces the entry; removing and clearing unindex it
+        lever.AddAction("do_yank", "pull");
+        Assert.Equal("do_yank", ContentActions(room, "pull").Single().Function);
+        lever.RemoveAction("pull");
+        Assert.Empty(ContentActions(room, "pull"));
+        player.ClearActions();
+        Assert.Single(ContentActions(room, "read"));
+
+        // Moving carries the actions to the new environment
+        sign.MoveTo(other);
+        Assert.Empty(ContentActions(room, "read"));
+        Assert.Single(ContentActions(other, "read"));
+
+        _objectManager.DestructObject(sign);
+        Assert.Empty(ContentActions(other, "read"));
+    }
+
+    [Fact]
+    public void ContentActionIndex_PrefixActionsMatchLongerVerbs()
+    {
+        var room = _objectManager.CloneObject("/std/room");
+        var statue = _objectManager.CloneObject("/std/object");
+        var book = _objectManager.CloneObject("/std/object");
+        statue.MoveTo(room);
+        book.MoveTo(room);
+
+        statue.AddAction("do_look", "l", MudObject.ActionFlags.MatchPrefix);
+        book.AddAction("do_look_book", "l", MudObject.ActionFlags.MatchPrefix);
+        book.AddAction("do_look_exact", "look");
+
+        // The book answers "look" with its exact action, not the prefix one
+        var actions = ContentActions(room, "look");
+        Assert.Equal(new[] { "do_look_exact", "do_look" }, actions.Select(a => a.Function).ToArray());
+        Assert.Equal(new[] { "do_look", "do_look_book" }, ContentActions(room, "lo").Select(a => a.Function).ToArray());
+    }
+
     [Fact]
     public void MudObject_HasContentsProperty()
     {
@@ -310,6 +591,36 @@ int query_init_called() { return init_called; }
         var initCalled = _interpreter.CallFunctionOnObject(room, "query_init_called", new List<object>());
         Assert.Equal(0L, initCalled);
     }
+
+    [Fact]
+    public void InitContents_ListsOnlyObjectsWithAnInit()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "rock.c"), @"
+inherit ""/std/object"";
+void init() { ::init(); }
+");
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "object.c"), @"
+string short_desc;
+void create() { short_desc = ""something""; }
+void init() { }
+");
+        var room = _objectManager.LoadObject("/room/test_room");
+        var npc = _objectManager.CloneObject("/std/npc");
+        var rock = _objectManager.CloneObject("/std/rock");
+
+        Assert.False(rock.Program.HasInit);
+        Assert.True(npc.Program.HasInit);
+
+        _interpreter.CallEfun("move_object", new List<object> { npc, room });
+        _interpreter.CallEfun("move_object", new List<object> { rock, room });
+        Assert.Equal(new[] { npc }, room.InitContents);
+        Assert.Equal(2L, _interpreter.CallFunctionOnObject(room, "query_init_called", new List<object>()));
+        // Once entering, once when the rock entered
+        Assert.Equal(2L, _interpreter.CallFunctionOnObject(npc, "query_init_called", new List<object>()));
+
+        _interpreter.CallEfun("move_object", new List<object> { npc, 0 });
+        Assert.Empty(room.InitContents);
+    }
 }
 
 /// <summary>
@@ -454,6 +765,42 @@ void create() {
         Assert.Equal(sword, result);
     }
 
+    [Fact]
+    public void Present_UsesDeclaredIdsUnlessIdIsOverridden()
+    {
+        File.WriteAllText(Path.Combine(_testMudlibPath, "obj", "declared.c"), @"
+inherit ""/std/object"";
+int id_calls;
+void create() { ::create(); set_ids(({ ""gem"", ""Ruby"" }), ""a glowing red stone""); }
+int id(string name) { id_calls++; return name == ""gem""; }
+int query_id_calls() { return id_calls; }
+void rename() { set_ids(({ ""pebble"" })); }
+");
+        File.WriteAllText(Path.Combine(_testMudlibPath, "obj", "cursed.c"), @"
+inherit ""/obj/declared"";
+int id(string name) { return name == ""cursed""; }
+");
+        var room = _objectManager.LoadObject("/std/room");
+        var sword = _objectManager.CloneObject("/obj/sword");
+        var gem = _objectManager.CloneObject("/obj/declared");
+        var cursed = _objectManager.CloneObject("/obj/cursed");
+        var second = _objectManager.CloneObject("/obj/declared");
+        foreach (var obj in new[] { sword, gem, cursed, second })
+        {
+            obj.MoveTo(room);
+        }
+
+        Assert.Equal(gem, _interpreter.CallEfun("present", new List<object> { "ruby", room }));
+        Assert.Equal(second, _interpreter.CallEfun("present", new List<object> { "red stone 2", room }));
+        Assert.Equal(sword, _interpreter.CallEfun("present", new List<object> { "sword", room }));
+        Assert.Equal(cursed, _interpreter.CallEfun("present", new List<object> { "cursed", room }));
+        Assert.Equal(0L, Convert.ToInt64(_interpreter.CallFunctionOnObject(gem, "query_id_calls", new List<object>())));
+
+        _interpreter.CallFunctionOnObject(gem, "rename", new List<object>());
+        Assert.Equal(gem, _interpreter.CallEfun("present", new List<object> { "pebble", room }));
+        Assert.Equal(second, _interpreter.CallEfun("present", new List<object> { "gem", room }));
+    }
+
     [Fact]
     public void Present_ChecksIfObjectIsInContainer()
     {
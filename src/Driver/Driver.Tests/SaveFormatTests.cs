@@ -0,0 +1,111 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class SaveFormatTests
+{
+    private static List<KeyValuePair<string, object?>> Sample()
+    {
+        var skills = new Dictionary<object, object>
+        {
+            ["sword"] = 12L,
+            ["quote \"x\""] = new List<object> { -3L, "a,b:c", new Dictionary<object, object>() },
+            [7L] = "line\nbreak\ttab\\slash",
+        };
+        return new List<KeyValuePair<string, object?>>
+        {
+            new("name", "Testplayer"),
+            new("gold", long.MaxValue),
+            new("skills", skills),
+            new("empty", new List<object>()),
+        };
+    }
+
+    private static void AssertSample(List<KeyValuePair<string, object>> read)
+    {
+        Assert.Equal(new[] { "name", "gold", "skills", "empty" }, read.Select(v => v.Key).ToArray());
+        Assert.Equal("Testplayer", read[0].Value);
+        Assert.Equal(long.MaxValue, read[1].Value);
+
+        var skills = Assert.IsType<LpcMapping>(read[2].Value);
+        Assert.Equal(12L, skills["sword"]);
+        Assert.Equal("line\nbreak\ttab\\slash", skills[7L]);
+        var list = Assert.IsType<List<object>>(skills["quote \"x\""]);
+        Assert.Equal(-3L, list[0]);
+        Assert.Equal("a,b:c", list[1]);
+        Assert.Empty(Assert.IsType<LpcMapping>(list[2]));
+        Assert.Empty(Assert.IsType<List<object>>(read[3].Value));
+    }
+
+    [Fact]
+    public void Text_RoundTrips()
+    {
+        var text = SaveFormat.ToText(Sample());
+
+        Assert.StartsWith("name \"Testplayer\"\ngold 9223372036854775807\n", text);
+        AssertSample(SaveFormat.ReadText(text));
+    }
+
+    [Fact]
+    public void Binary_RoundTripsAndIsDetected()
+    {
+        var data = SaveFormat.Encode(Sample(), binary: true);
+
+        Assert.True(SaveFormat.IsBinary(data));
+        Assert.True(data.Length < SaveFormat.Encode(Sample(), binary: false).Length);
+        AssertSample(SaveFormat.Read(data));
+    }
+
+    [Fact]
+    public void Convert_RoundTripsBetweenFormats()
+    {
+        var text = SaveFormat.Encode(Sample(), binary: false);
+
+        var binary = SaveFormat.Convert(text, binary: true);
+        Assert.Equal(text, SaveFormat.Convert(binary, binary: false));
+    }
+
+    [Fact]
+    public void ReadText_AcceptsOlderAndLooserFiles()
+    {
+        var read = SaveFormat.ReadText("hp 30\r\n\nbroken\nitems ({ 1, \"x\", })\nhome /world/rooms/town/square#3\nbad ({ 1 ) (\n");
+
+        Assert.Equal(30L, read[0].Value);
+        Assert.Equal(new object[] { 1L, "x" }, Assert.IsType<List<object>>(read[1].Value).ToArray());
+        Assert.Equal("/world/rooms/town/square#3", read[2].Value);
+        Assert.Equal(new object[] { 1L }, Assert.IsType<List<object>>(read[3].Value).ToArray());
+    }
+
+    [Fact]
+    public void RestoreObject_ReadsBinarySaves()
+    {
+        var mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_save_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(mudlibPath, "std"));
+        Directory.CreateDirectory(Path.Combine(mudlibPath, "data"));
+        try
+        {
+            File.WriteAllText(Path.Combine(mudlibPath, "std", "saver.c"), @"
+mapping skills;
+string name;
+int load(string path) { return restore_object(path); }
+int query_skill(string s) { return skills[s]; }
+string query_name() { return name; }
+");
+            File.WriteAllBytes(Path.Combine(mudlibPath, "data", "test_saver.o"), SaveFormat.Encode(Sample(), binary: true));
+
+            var objectManager = new ObjectManager(mudlibPath);
+            objectManager.InitializeInterpreter();
+            var saver = objectManager.CloneObject("/std/saver");
+            object? Call(string function, params object[] args) =>
+                objectManager.Interpreter!.CallFunctionOnObject(saver, function, args.ToList());
+
+            Assert.Equal(1L, Convert.ToInt64(Call("load", "/data/test_saver")));
+            Assert.Equal("Testplayer", Call("query_name"));
+            Assert.Equal(12L, Convert.ToInt64(Call("query_skill", "sword")));
+        }
+        finally
+        {
+            Directory.Delete(mudlibPath, recursive: true);
+        }
+    }
+}
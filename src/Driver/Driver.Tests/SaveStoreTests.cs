@@ -0,0 +1,157 @@
+using System.Text;
+using Xunit;
+
+namespace Driver.Tests;
+
+public class SaveStoreTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly string _storePath;
+
+    public SaveStoreTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_savestore_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "data"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "secure", "accounts"));
+        _storePath = Path.Combine(_mudlibPath, "saves.db");
+    }
+
+    public void Dispose()
+    {
+        AsyncFileWriter.Shared.Flush();
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private static byte[] Bytes(string text) => Encoding.UTF8.GetBytes(text);
+
+    [Fact]
+    public void CommittedBatches_SurviveReopening()
+    {
+        using (var store = new SaveStore(_storePath))
+        {
+            store.Put("/secure/players/a.o", Bytes("one"));
+            store.Put("/secure/players/b.o", Bytes("two"));
+            Assert.Equal("one", Encoding.UTF8.GetString(store.Get("/secure/players/a.o")!));
+            store.Commit();
+
+            store.Put("/secure/players/a.o", Bytes("three"));
+            store.Delete("/secure/players/b.o");
+            Assert.Null(store.Get("/secure/players/b.o"));
+            store.Flush();
+            Assert.True(store.Commits >= 1);
+        }
+
+        using var reopened = new SaveStore(_storePath);
+        Assert.Equal(1, reopened.Count);
+        Assert.Equal("three", Encoding.UTF8.GetString(reopened.Get("/secure/players/a.o")!));
+        Assert.True(reopened.Any("/secure/players/"));
+        Assert.False(reopened.Any("/secure/accounts/"));
+    }
+
+    [Fact]
+    public void TornWriteAtTheEnd_IsDropped()
+    {
+        using (var store = new SaveStore(_storePath))
+        {
+            store.Put("/data/kept.o", Bytes("kept"));
+            store.Flush();
+        }
+        long good = new FileInfo(_storePath).Length;
+
+        // A record whose length runs past the end of the file, as a crash mid-write leaves it
+        using (var file = new FileStream(_storePath, FileMode.Append))
+        {
+            file.Write(BitConverter.GetBytes(500));
+            file.Write(new byte[20]);
+        }
+
+        using var reopened = new SaveStore(_storePath);
+        Assert.Equal("kept", Encoding.UTF8.GetString(reopened.Get("/data/kept.o")!));
+        Assert.Equal(good, reopened.LogBytes);
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "other.db"), "not a store");
+        Assert.Throws<InvalidDataException>(() => new SaveStore(Path.Combine(_mudlibPath, "other.db")));
+    }
+
+    [Fact]
+    public void RewrittenValues_CompactTheLog()
+    {
+        using (var store = new SaveStore(_storePath) { CompactMinBytes = 4096 })
+        {
+            for (int i = 0; i < 100; i++)
+            {
+                store.Put("/secure/players/a.o", new byte[1000]);
+                store.Put("/secure/players/b.o", Bytes($"save {i}"));
+                store.Flush();
+            }
+
+            Assert.True(store.Compactions > 0);
+            Assert.True(store.LogBytes < 20000);
+        }
+
+        using var reopened = new SaveStore(_storePath);
+        Assert.Equal("save 99", Encoding.UTF8.GetString(reopened.Get("/secure/players/b.o")!));
+        Assert.Equal(1000, reopened.Get("/secure/players/a.o")!.Length);
+    }
+
+    [Fact]
+    public void SaveAndRestoreObject_GoThroughTheStore()
+    {
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "saver.c"), @"
+int gold;
+void set_gold(int n) { gold = n; }
+int query_gold() { return gold; }
+int save(string path) { return save_object(path); }
+int load(string path) { return restore_object(path); }
+");
+        var legacy = new ObjectManager(_mudlibPath);
+        legacy.InitializeInterpreter();
+        var old = legacy.CloneObject("/std/saver");
+        legacy.Interpreter!.CallFunctionOnObject(old, "set_gold", new List<object> { 7L });
+        legacy.Interpreter!.CallFunctionOnObject(old, "save", new List<object> { "/data/old" });
+        AsyncFileWriter.Shared.Flush();
+
+        using var store = new SaveStore(_storePath);
+        var objectManager = new ObjectManager(_mudlibPath) { SaveStore = store };
+        objectManager.InitializeInterpreter();
+        var interpreter = objectManager.Interpreter!;
+        var saver = objectManager.CloneObject("/std/saver");
+        var loader = objectManager.CloneObject("/std/saver");
+
+        // A save made before the store is read from its file
+        Assert.Equal(1L, Convert.ToInt64(interpreter.CallFunctionOnObject(loader, "load", new List<object> { "/data/old" })));
+        Assert.Equal(7L, Convert.ToInt64(interpreter.CallFunctionOnObject(loader, "query_gold", new List<object>())));
+
+        interpreter.CallFunctionOnObject(saver, "set_gold", new List<object> { 42L });
+        Assert.Equal(1L, Convert.ToInt64(interpreter.CallFunctionOnObject(saver, "save", new List<object> { "/data/new" })));
+        Assert.Equal(1L, Convert.ToInt64(interpreter.CallFunctionOnObject(loader, "load", new List<object> { "/data/new" })));
+        Assert.Equal(42L, Convert.ToInt64(interpreter.CallFunctionOnObject(loader, "query_gold", new List<object>())));
+        Assert.NotNull(store.Get("/data/new.o"));
+        Assert.False(File.Exists(Path.Combine(_mudlibPath, "data", "new.o")));
+    }
+
+    [Fact]
+    public void Accounts_AreKeptInTheStore()
+    {
+        using (var store = new SaveStore(_storePath))
+        {
+            var accounts = new AccountManager(_mudlibPath, store);
+            Assert.True(accounts.CreateAccount("storetest", "s@x.org", "password123"));
+            Assert.Equal(AccessLevel.Admin, accounts.GetAccessLevel("storetest"));
+            accounts.Flush();
+        }
+        Assert.Empty(Directory.GetFiles(Path.Combine(_mudlibPath, "secure", "accounts")));
+
+        using var reopened = new SaveStore(_storePath);
+        var reloaded = new AccountManager(_mudlibPath, reopened);
+        Assert.True(reloaded.ValidateCredentials("storetest", "password123"));
+
+        // The first account in the store is still the first account
+        Assert.True(reloaded.CreateAccount("storetest2", "t@x.org", "password123"));
+        Assert.NotEqual(AccessLevel.Admin, reloaded.GetAccessLevel("storetest2"));
+    }
+}
@@ -0,0 +1,70 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class ScratchEvaluatorTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ScratchEvaluator _evaluator;
+
+    public ScratchEvaluatorTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_scratch_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "counter.c"), @"
+int count;
+int bump() { return ++count; }
+");
+        var objectManager = new ObjectManager(_mudlibPath);
+        objectManager.InitializeInterpreter();
+        _evaluator = new ScratchEvaluator(objectManager);
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    [Fact]
+    public void Evaluate_KeepsGlobalsAndFunctionsBetweenInputs()
+    {
+        Assert.Equal(11L, _evaluator.Evaluate("5 + 3 * 2"));
+        Assert.Equal(5L, _evaluator.Evaluate("x = 5"));
+        Assert.Equal(8L, _evaluator.Evaluate("x + 3"));
+        Assert.Equal(new List<object> { 1L, 2L }, _evaluator.Evaluate("int *pair = ({ 1, 2 });"));
+
+        Assert.Null(_evaluator.Evaluate("int twice(int n) { return n * 2; }"));
+        Assert.Equal(10L, _evaluator.Evaluate("twice(x)"));
+
+        // Redefining a function replaces it; the globals keep their values
+        _evaluator.Evaluate("int twice(int n) { return n * 2 + 1; }");
+        Assert.Equal(11L, _evaluator.Evaluate("twice(x)"));
+        Assert.Equal(2L, _evaluator.Evaluate("sizeof(pair)"));
+    }
+
+    [Fact]
+    public void Evaluate_RunsStatementsOnTheServersEngine()
+    {
+        _evaluator.Evaluate("total = 0");
+        Assert.Null(_evaluator.Evaluate("foreach (n in ({ 1, 2, 3 })) total += n;"));
+        Assert.Equal(6L, _evaluator.Evaluate("total"));
+        Assert.Equal("big", _evaluator.Evaluate("if (total > 5) return \"big\";"));
+
+        // Other mudlib objects load as usual
+        Assert.Equal(1L, _evaluator.Evaluate("load_object(\"/std/counter\")->bump()"));
+        Assert.Equal(ScratchEvaluator.ScratchPath, _evaluator.Evaluate("file_name(this_object())"));
+        Assert.Equal("({ 1, \"a\" })", ScratchEvaluator.Format(new List<object> { 1L, "a" }));
+    }
+
+    [Fact]
+    public void Evaluate_InputThatDoesNotCompileChangesNothing()
+    {
+        _evaluator.Evaluate("x = 1");
+
+        Assert.Throws<ParserException>(() => _evaluator.Evaluate("int broken( { return 1; }"));
+        Assert.Equal(1L, _evaluator.Evaluate("x"));
+    }
+}
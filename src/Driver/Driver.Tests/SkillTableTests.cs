@@ -0,0 +1,109 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class SkillTableTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ObjectManager _objectManager;
+
+    public SkillTableTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_skill_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "data"));
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "fighter.c"), @"
+string name;
+void create() { name = ""fighter""; }
+void train() {
+    set_skill_level(""sword"", 12);
+    set_skill_level(""dodge"", 3);
+    set_skill_allowed(""sword"", 1);
+    set_skill_allowed(""parry"", 1);
+}
+int save(string file) { return save_object(""/data/"" + file); }
+int load(string file) { return restore_object(""/data/"" + file); }
+int dodge_of(object ob) { return query_skill_level(ob, ""dodge""); }
+int allowed(string skill) { return query_skill_allowed(this_object(), skill); }
+");
+
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter();
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private object? Call(MudObject obj, string function, params object[] args)
+    {
+        var interpreter = _objectManager.Interpreter!;
+        interpreter.ResetInstructionCount();
+        return interpreter.CallFunctionOnObject(obj, function, args.ToList());
+    }
+
+    [Fact]
+    public void Table_SetsLevelsAndAllowedSkills_ByInternedId()
+    {
+        var table = new SkillTable();
+        table.Set("sword", 12);
+        table.Set("dodge", 3);
+        table.Set("dodge", 0);
+        table.Set("never-learned", 0);
+        table.SetAllowed("sword", true);
+        table.SetAllowed("sword", true);
+        table.SetAllowed("parry", true);
+
+        Assert.Equal(12, table.Get("sword"));
+        Assert.Equal(0, table.Get("dodge"));
+        Assert.Equal(0, table.Get("never-learned"));
+        Assert.Equal(1, table.LearnedCount);
+        Assert.Single(table.Levels());
+        Assert.True(table.IsAllowed("parry"));
+        Assert.False(table.IsAllowed("dodge"));
+        Assert.Equal(2, table.AllowedCount);
+
+        // Another table shares the ids but none of the values
+        var other = new SkillTable();
+        Assert.Equal(0, other.Get("sword"));
+        Assert.False(other.IsAllowed("sword"));
+
+        // Save entries hold only what is set, and restore into another table
+        var entries = table.SaveEntries().ToList();
+        Assert.Equal(new[] { SkillTable.LevelsKey, SkillTable.AllowedKey }, entries.Select(e => e.Key).ToArray());
+        foreach (var (key, value) in entries)
+        {
+            Assert.True(other.Restore(key, value));
+        }
+        Assert.Equal(12, other.Get("sword"));
+        Assert.Equal(new List<object> { "sword", "parry" }, other.Allowed());
+        Assert.False(other.Restore("skills", null));
+
+        table.ClearAllowed();
+        Assert.Equal(0, table.AllowedCount);
+        Assert.Empty(new SkillTable().SaveEntries());
+    }
+
+    [Fact]
+    public void SaveObject_RoundTripsTheSkillTable_AndOthersReadItDirectly()
+    {
+        var fighter = _objectManager.CloneObject("/std/fighter");
+        var reader = _objectManager.CloneObject("/std/fighter");
+        Call(fighter, "train");
+        Assert.Equal(3L, Convert.ToInt64(Call(reader, "dodge_of", fighter)));
+        Assert.Equal(0L, Convert.ToInt64(Call(reader, "dodge_of", reader)));
+
+        Assert.Equal(1L, Convert.ToInt64(Call(fighter, "save", "fighter")));
+        var restored = _objectManager.CloneObject("/std/fighter");
+        Assert.Equal(1L, Convert.ToInt64(Call(restored, "load", "fighter")));
+
+        Assert.Equal(12, restored.Skills.Get("sword"));
+        Assert.Equal(3L, Convert.ToInt64(Call(reader, "dodge_of", restored)));
+        Assert.Equal(1L, Convert.ToInt64(Call(restored, "allowed", "parry")));
+        Assert.Equal(0L, Convert.ToInt64(Call(restored, "allowed", "dodge")));
+    }
+}
@@ -0,0 +1,39 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class SourceWatcherTests
+{
+    [Fact]
+    public void EditedFile_IsStagedInTheBackground()
+    {
+        var tempDir = Path.Combine(Path.GetTempPath(), "watch_test_" + Guid.NewGuid().ToString("N")[..8]);
+        Directory.CreateDirectory(Path.Combine(tempDir, "test"));
+        var path = Path.Combine(tempDir, "test", "thing.c");
+        File.WriteAllText(path, "int query_value() { return 1; }\n");
+
+        try
+        {
+            var om = new ObjectManager(tempDir);
+            om.InitializeInterpreter();
+            var thing = om.LoadObject("/test/thing");
+
+            using var watcher = new SourceWatcher(om, TimeSpan.FromMilliseconds(50));
+            File.WriteAllText(path, "int query_value() { return 2; }\n");
+
+            var deadline = DateTime.UtcNow.AddSeconds(10);
+            while (om.StagedReloadCount == 0 && DateTime.UtcNow < deadline)
+            {
+                Thread.Sleep(20);
+            }
+
+            Assert.Equal(1L, om.Interpreter!.CallFunctionOnObject(thing, "query_value", new List<object>()));
+            Assert.Contains("/test/thing", om.ApplyStagedReloads());
+            Assert.Equal(2L, om.Interpreter.CallFunctionOnObject(thing, "query_value", new List<object>()));
+        }
+        finally
+        {
+            Directory.Delete(tempDir, recursive: true);
+        }
+    }
+}
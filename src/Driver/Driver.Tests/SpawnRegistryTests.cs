@@ -0,0 +1,105 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class SpawnRegistryTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ObjectManager _objectManager;
+
+    public SpawnRegistryTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_spawn_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "world", "mobs"));
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "world", "rooms"));
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "world", "mobs", "rat.c"), "void create() { }\n");
+        File.WriteAllText(Path.Combine(_mudlibPath, "world", "mobs", "wolf.c"), "void create() { }\n");
+        File.WriteAllText(Path.Combine(_mudlibPath, "world", "rooms", "den.c"), @"
+void create() {
+    set_spawn(""/world/mobs/rat"", 2);
+    set_spawn(""/world/mobs/wolf"", 1);
+}
+int stock() { return respawn(1); }
+int top_up() { return respawn(); }
+int rats() { return sizeof(query_spawned(""/world/mobs/rat"")); }
+int all() { return sizeof(query_spawned()); }
+");
+
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter();
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    private long Call(MudObject obj, string function)
+    {
+        var interpreter = _objectManager.Interpreter!;
+        interpreter.ResetInstructionCount();
+        return Convert.ToInt64(interpreter.CallFunctionOnObject(obj, function, new List<object>()));
+    }
+
+    [Fact]
+    public void Respawn_ClonesOnlyWhatDied_IntoTheRoom()
+    {
+        var den = _objectManager.LoadObject("/world/rooms/den");
+
+        Assert.Equal(3L, Call(den, "stock"));
+        Assert.Equal(3, den.Contents.Count);
+        Assert.Equal(2L, Call(den, "rats"));
+
+        // Nothing missing, nothing cloned; one that wanders off still counts
+        Assert.Equal(0L, Call(den, "stock"));
+        var elsewhere = _objectManager.CloneObject("/world/mobs/wolf");
+        var wanderer = den.Contents.First(obj => obj.FilePath == "/world/mobs/rat");
+        wanderer.MoveTo(elsewhere);
+        Assert.Equal(0L, Call(den, "stock"));
+
+        // A dead one is replaced
+        _objectManager.DestructObject(wanderer);
+        Assert.Equal(1L, Call(den, "rats"));
+        Assert.Equal(1L, Call(den, "stock"));
+        Assert.Equal(3L, Call(den, "all"));
+        Assert.Equal(3, den.Contents.Count);
+    }
+
+    [Fact]
+    public void QueuedRefills_RunInBatches_AndForgetDestructedRooms()
+    {
+        var spawns = _objectManager.Spawns;
+        var interpreter = _objectManager.Interpreter!;
+        var rooms = Enumerable.Range(0, 5).Select(_ => _objectManager.CloneObject("/world/rooms/den")).ToList();
+        foreach (var room in rooms)
+        {
+            Assert.Equal(3, spawns.Request(room));
+        }
+        spawns.Request(rooms[0]);
+        Assert.Equal(5, spawns.PendingRooms);
+
+        // Four clones a batch: the second room is cut short and stays first in line
+        Assert.Equal(4, spawns.RunQueued(4, interpreter.SpawnInto));
+        Assert.Equal(3, rooms[0].Contents.Count);
+        Assert.Equal(1, rooms[1].Contents.Count);
+        Assert.Equal(4, spawns.PendingRooms);
+
+        _objectManager.DestructObject(rooms[2]);
+        spawns.Forget(rooms[2]);
+        Assert.Equal(8, spawns.RunQueued(100, interpreter.SpawnInto));
+        Assert.Equal(0, spawns.PendingRooms);
+        Assert.All(new[] { rooms[0], rooms[1], rooms[3], rooms[4] }, room => Assert.Equal(0, spawns.Missing(room)));
+
+        // The four rooms left and the blueprint, whose create() registered its spawns too
+        Assert.Equal(5, spawns.RoomCount);
+
+        // Turning a spawn off leaves what it already made
+        spawns.Set(rooms[0], "/world/mobs/rat", 0);
+        Assert.Single(spawns.Live(rooms[0]));
+        Assert.Equal(3, rooms[0].Contents.Count);
+    }
+}
@@ -0,0 +1,66 @@
+namespace Driver.Tests;
+
+public class SwitchTableTests
+{
+    private static SwitchTable Table(params Expression?[] labels) =>
+        SwitchTable.Build(labels.Select(l => new SwitchCase(l, new List<Statement>())).ToList());
+
+    private static NumberLiteral Num(long value) => new(value);
+    private static StringLiteral Str(string value) => new(value);
+
+    [Fact]
+    public void CloseIntLabels_UseDenseArray()
+    {
+        var table = Table(Num(3), Num(1), Num(2), null, Num(5));
+
+        Assert.True(table.IsConstant);
+        Assert.True(table.IsDense);
+        Assert.Equal(0, table.Lookup(3L));
+        Assert.Equal(2, table.Lookup(2));
+        Assert.Equal(4, table.Lookup(5L));
+        Assert.Equal(3, table.Lookup(4L)); // default
+        Assert.Equal(3, table.Lookup(long.MinValue));
+    }
+
+    [Fact]
+    public void SpreadIntLabels_UseBinarySearch()
+    {
+        var table = Table(Num(1_000_000), Num(-5), Num(long.MaxValue), Num(long.MinValue));
+
+        Assert.False(table.IsDense);
+        Assert.Equal(0, table.Lookup(1_000_000L));
+        Assert.Equal(2, table.Lookup(LpcValue.FromInt(long.MaxValue)));
+        Assert.Equal(3, table.Lookup(long.MinValue));
+        Assert.Equal(-1, table.Lookup(7L));
+    }
+
+    [Fact]
+    public void StringLabels_FirstDuplicateWins()
+    {
+        var table = Table(Str("north"), Num(1), Str("south"), Str("north"));
+
+        Assert.Equal(2, table.StringLabels);
+        Assert.Equal(0, table.Lookup("north"));
+        Assert.Equal(2, table.Lookup(LpcValue.FromObject("south")));
+        Assert.Equal(-1, table.Lookup("1"));
+        Assert.Equal(-1, table.Lookup((object?)null));
+    }
+
+    [Fact]
+    public void NonLiteralLabel_IsNotConstant()
+    {
+        Assert.False(Table(Num(1), new Identifier("x")).IsConstant);
+    }
+
+    [Fact]
+    public void CopiedStatement_RebuildsForItsOwnCases()
+    {
+        var stmt = new SwitchStatement(new Identifier("x"),
+            new List<SwitchCase> { new(Num(1), new List<Statement>()) });
+        Assert.NotNull(stmt.GetTable());
+
+        var copy = stmt with { Cases = new List<SwitchCase> { new(new Identifier("y"), new List<Statement>()) } };
+        Assert.Null(copy.GetTable());
+        Assert.NotNull(stmt.GetTable());
+    }
+}
@@ -0,0 +1,103 @@
+using System.Text;
+using Xunit;
+
+namespace Driver.Tests;
+
+public class TelnetParserTests
+{
+    private readonly List<string> _lines = new();
+    private readonly List<(byte Command, byte Option)> _negotiations = new();
+    private readonly List<(byte Option, byte[] Data)> _subnegotiations = new();
+    private readonly TelnetParser _parser;
+
+    public TelnetParserTests()
+    {
+        _parser = new TelnetParser(
+            line => _lines.Add(Encoding.ASCII.GetString(line)),
+            (command, option) => _negotiations.Add((command, option)),
+            (option, data) => _subnegotiations.Add((option, data.ToArray())));
+    }
+
+    private static byte[] Bytes(params object[] parts)
+    {
+        var bytes = new List<byte>();
+        foreach (var part in parts)
+        {
+            if (part is string text) bytes.AddRange(Encoding.ASCII.GetBytes(text));
+            else bytes.Add(Convert.ToByte(part));
+        }
+        return bytes.ToArray();
+    }
+
+    [Fact]
+    public void Lines_AreSplitOnLineFeed()
+    {
+        _parser.Feed(Bytes("look\r\nsay hi\n"));
+
+        Assert.Equal("look|say hi", string.Join("|", _lines));
+    }
+
+    [Fact]
+    public void PartialLine_IsHeldUntilComplete()
+    {
+        _parser.Feed(Bytes("lo"));
+        Assert.Empty(_lines);
+
+        _parser.Feed(Bytes("ok\n"));
+        Assert.Equal("look", Assert.Single(_lines));
+    }
+
+    [Fact]
+    public void Backspace_ErasesAndControlBytesAreDropped()
+    {
+        _parser.Feed(Bytes("lookx", 8, "\t", 200, 127, "k\n"));
+
+        Assert.Equal("look", Assert.Single(_lines));
+    }
+
+    [Fact]
+    public void Negotiation_IsReportedAndRemovedFromInput()
+    {
+        _parser.Feed(Bytes("no", TelnetParser.IAC, TelnetParser.DO, 31, "rth\n"));
+
+        Assert.Equal("north", Assert.Single(_lines));
+        Assert.Equal((TelnetParser.DO, (byte)31), Assert.Single(_negotiations));
+    }
+
+    [Fact]
+    public void Subnegotiation_CollapsesDoubledIac()
+    {
+        _parser.Feed(Bytes(TelnetParser.IAC, TelnetParser.SB, 31, 0, 80, TelnetParser.IAC, TelnetParser.IAC, 24,
+            TelnetParser.IAC, TelnetParser.SE, "go\n"));
+
+        var (option, data) = Assert.Single(_subnegotiations);
+        Assert.Equal(31, option);
+        Assert.Equal(new byte[] { 0, 80, 255, 24 }, data);
+        Assert.Equal("go", Assert.Single(_lines));
+    }
+
+    [Fact]
+    public void SequencesSplitAcrossBuffers_AreParsed()
+    {
+        var input = Bytes("a", TelnetParser.IAC, TelnetParser.WILL, 24, "b",
+            TelnetParser.IAC, TelnetParser.SB, 24, 0, "xterm", TelnetParser.IAC, TelnetParser.SE, "c\r\n");
+
+        // One byte per Feed is the worst case for carrying state between reads
+        foreach (var b in input)
+        {
+            _parser.Feed(new[] { b });
+        }
+
+        Assert.Equal("abc", Assert.Single(_lines));
+        Assert.Equal((TelnetParser.WILL, (byte)24), Assert.Single(_negotiations));
+        Assert.Equal("\0xterm", Encoding.ASCII.GetString(Assert.Single(_subnegotiations).Data));
+    }
+
+    [Fact]
+    public void LongLine_IsTruncated()
+    {
+        _parser.Feed(Encoding.ASCII.GetBytes(new string('x', TelnetParser.MaxLineLength + 100) + "\n"));
+
+        Assert.Equal(TelnetParser.MaxLineLength, Assert.Single(_lines).Length);
+    }
+}
@@ -0,0 +1,473 @@
+using System.IO.Compression;
+using System.Net.Sockets;
+using System.Net.WebSockets;
+using System.Text;
+using Xunit;
+
+namespace Driver.Tests;
+
+/// <summary>
+/// End-to-end tests for the socket layer over loopback.
+/// </summary>
+public class TelnetServerTests : IDisposable
+{
+    private readonly string _testMudlibPath;
+    private readonly GameLoop _gameLoop;
+    private TelnetServer? _server;
+    private Thread? _serverThread;
+
+    public TelnetServerTests()
+    {
+        _testMudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_telnet_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_testMudlibPath, "secure", "accounts"));
+
+        var objectManager = new ObjectManager(_testMudlibPath);
+        objectManager.InitializeInterpreter();
+        _gameLoop = new GameLoop(objectManager, new AccountManager(_testMudlibPath));
+        _gameLoop.InitializeInterpreter(new ObjectInterpreter(objectManager));
+        _gameLoop.Start();
+    }
+
+    /// <summary>
+    /// The server under test, started on first use with default output limits.
+    /// </summary>
+    private TelnetServer Server => _server ?? StartServer();
+
+    private TelnetServer StartServer(OutputLimits? outputLimits = null, CompressionLevel? compression = null, int? webSocketPort = null)
+    {
+        _server = new TelnetServer(0, _gameLoop, outputLimits, compression) { WebSocketPort = webSocketPort };
+        _serverThread = new Thread(_server.Run) { IsBackground = true };
+        _serverThread.Start();
+        Assert.True(_server.Listening.Wait(TimeSpan.FromSeconds(5)));
+        return _server;
+    }
+
+    public void Dispose()
+    {
+        _server?.Dispose();
+        _serverThread?.Join(TimeSpan.FromSeconds(5));
+        _gameLoop.Stop();
+
+        if (Directory.Exists(_testMudlibPath))
+        {
+            Directory.Delete(_testMudlibPath, recursive: true);
+        }
+    }
+
+    private static string ReadUntil(NetworkStream stream, string expected)
+    {
+        var received = new StringBuilder();
+        var buffer = new byte[1024];
+        stream.ReadTimeout = 5000;
+
+        while (!received.ToString().Contains(expected))
+        {
+            int n = stream.Read(buffer, 0, buffer.Length);
+            if (n == 0) break;
+            // Latin1 keeps telnet command bytes visible (IAC is \u00ff)
+            received.Append(Encoding.Latin1.GetString(buffer, 0, n));
+        }
+        return received.ToString();
+    }
+
+    private static void WaitFor(Func<bool> condition)
+    {
+        var deadline = DateTime.UtcNow.AddSeconds(5);
+        while (!condition() && DateTime.UtcNow < deadline)
+        {
+            Thread.Sleep(10);
+        }
+    }
+
+    [Fact]
+    public void Connect_ReceivesBanner()
+    {
+        using var client = new TcpClient("127.0.0.1", Server.LocalPort);
+
+        var banner = ReadUntil(client.GetStream(), "type 'new'");
+
+        Assert.Contains("Welcome to LPMud Revival!", banner);
+    }
+
+    [Fact]
+    public void Input_IsQueuedToGameLoopAndAnswered()
+    {
+        using var client = new TcpClient("127.0.0.1", Server.LocalPort);
+        var stream = client.GetStream();
+        ReadUntil(stream, "type 'new'");
+
+        // Line split across two packets, with a telnet command in between
+        stream.Write(Encoding.ASCII.GetBytes("ne"));
+        stream.Flush();
+        Thread.Sleep(20);
+        stream.Write(new byte[] { 255, 251, 1 });
+        stream.Write(Encoding.ASCII.GetBytes("w\r\n"));
+
+        var reply = ReadUntil(stream, "Choose a username");
+        Assert.Contains("Choose a username", reply);
+    }
+
+    [Fact]
+    public void QueuedOutput_IsSentInOrderWithTelnetNewlines()
+    {
+        using var client = new TcpClient("127.0.0.1", Server.LocalPort);
+        var stream = client.GetStream();
+        ReadUntil(stream, "type 'new'");
+
+        var connectionId = _gameLoop.GetAllSessions().Single().ConnectionId;
+        _gameLoop.SendToPlayer(connectionId, "one\n");
+        _gameLoop.SendToPlayer(connectionId, "two\r\n");
+        _gameLoop.SendToPlayer(connectionId, "thr\u00e9e\n<end>");
+
+        var received = ReadUntil(stream, "<end>");
+
+        Assert.EndsWith("one\r\ntwo\r\nthr?e\r\n<end>", received);
+    }
+
+    /// <summary>
+    /// Connect with a tiny receive window and never read past the banner.
+    /// </summary>
+    private TcpClient ConnectSlowClient(TelnetServer server)
+    {
+        var client = new TcpClient { ReceiveBufferSize = 4096 };
+        client.Connect("127.0.0.1", server.LocalPort);
+        ReadUntil(client.GetStream(), "type 'new'");
+        return client;
+    }
+
+    /// <summary>
+    /// Queue far more output than the socket buffers can hold, spread over
+    /// many drains so it arrives as many batches.
+    /// </summary>
+    private void Flood(string connectionId)
+    {
+        var line = new string('x', 32 * 1024) + "\n";
+        for (int i = 0; i < 256; i++)
+        {
+            _gameLoop.SendToPlayer(connectionId, line);
+            Thread.Sleep(2);
+        }
+    }
+
+    [Fact]
+    public void SlowClient_OverLimit_IsClosedAndCounted()
+    {
+        var server = StartServer(new OutputLimits(64 * 1024, OutputOverflowPolicy.Linkdead));
+        using var client = ConnectSlowClient(server);
+        var connectionId = _gameLoop.GetAllSessions().Single().ConnectionId;
+
+        Flood(connectionId);
+
+        WaitFor(() => server.ConnectionCount == 0);
+        Assert.Equal(0, server.ConnectionCount);
+        Assert.Empty(_gameLoop.GetAllSessions());
+
+        var stats = server.GetOutputStats();
+        Assert.Equal(1, stats.Overflows);
+        Assert.True(stats.BytesDropped > 0);
+    }
+
+    [Fact]
+    public void SlowClient_DropOldest_StaysConnectedAndGetsLatestOutput()
+    {
+        var server = StartServer(new OutputLimits(64 * 1024, OutputOverflowPolicy.DropOldest));
+        using var client = ConnectSlowClient(server);
+        var connectionId = _gameLoop.GetAllSessions().Single().ConnectionId;
+
+        Flood(connectionId);
+        _gameLoop.SendToPlayer(connectionId, "<end>");
+        WaitFor(() => server.GetOutputStats().BytesDropped > 0);
+
+        var stats = server.GetOutputStats();
+        Assert.Equal(1, server.ConnectionCount);
+        Assert.Equal(0, stats.Overflows);
+        Assert.True(stats.BytesDropped > 0);
+
+        // Newest output survives; the client catches up once it reads
+        var received = ReadUntil(client.GetStream(), "<end>");
+        Assert.EndsWith("<end>", received);
+    }
+
+    /// <summary>
+    /// Inflate what has arrived of an MCCP2 stream so far.
+    /// </summary>
+    private static string Inflate(MemoryStream compressed)
+    {
+        using var zlib = new ZLibStream(new MemoryStream(compressed.GetBuffer(), 0, (int)compressed.Length), CompressionMode.Decompress);
+        using var reader = new StreamReader(zlib, Encoding.ASCII);
+        return reader.ReadToEnd();
+    }
+
+    [Fact]
+    public void Mccp2_AcceptedByClient_CompressesOutput()
+    {
+        var server = StartServer(compression: CompressionLevel.Optimal);
+        using var client = new TcpClient("127.0.0.1", server.LocalPort);
+        var stream = client.GetStream();
+        stream.ReadTimeout = 5000;
+
+        var offer = ReadUntil(stream, "type 'new'");
+        Assert.Contains("\u00ff\u00fbV", offer); // IAC WILL COMPRESS2
+
+        stream.Write(new byte[] { 255, 253, 86 }); // IAC DO COMPRESS2
+        var connection = server.GetConnections().Single();
+        WaitFor(() => connection.IsCompressing);
+
+        var room = string.Concat(Enumerable.Repeat("A long corridor stretches north and south.\n", 100));
+        _gameLoop.SendToPlayer(connection.Id, room + "<end>");
+
+        // Plain bytes up to IAC SB COMPRESS2 IAC SE, zlib after it
+        var raw = new List<byte>();
+        var buffer = new byte[4096];
+        byte[] marker = { 255, 250, 86, 255, 240 };
+        int start = -1;
+        var compressed = new MemoryStream();
+        while (true)
+        {
+            int n = stream.Read(buffer, 0, buffer.Length);
+            Assert.True(n > 0);
+            if (start < 0)
+            {
+                raw.AddRange(buffer.AsSpan(0, n).ToArray());
+                start = raw.ToArray().AsSpan().IndexOf(marker);
+                if (start < 0) continue;
+                compressed.Write(raw.ToArray(), start + marker.Length, raw.Count - start - marker.Length);
+            }
+            else
+            {
+                compressed.Write(buffer, 0, n);
+            }
+
+            if (Inflate(compressed).Contains("<end>")) break;
+        }
+
+        Assert.EndsWith(room.Replace("\n", "\r\n") + "<end>", Inflate(compressed));
+        Assert.True(connection.CompressionRatio > 10, $"ratio {connection.CompressionRatio}");
+        Assert.True(connection.CompressedBytes < connection.UncompressedBytes);
+    }
+
+    [Fact]
+    public void Mccp2_RefusedByClient_StaysPlain()
+    {
+        var server = StartServer(compression: CompressionLevel.Optimal);
+        using var client = new TcpClient("127.0.0.1", server.LocalPort);
+        var stream = client.GetStream();
+        ReadUntil(stream, "type 'new'");
+
+        stream.Write(new byte[] { 255, 254, 86 }); // IAC DONT COMPRESS2
+        var connection = server.GetConnections().Single();
+        _gameLoop.SendToPlayer(connection.Id, "plain<end>");
+
+        Assert.EndsWith("plain<end>", ReadUntil(stream, "<end>"));
+        Assert.False(connection.IsCompressing);
+    }
+
+    [Fact]
+    public void Gmcp_AcceptedByClient_ArrivesInOrderWithText()
+    {
+        var server = Server;
+        using var client = new TcpClient("127.0.0.1", server.LocalPort);
+        var stream = client.GetStream();
+
+        Assert.Contains("\u00ff\u00fb\u00c9", ReadUntil(stream, "type 'new'")); // IAC WILL GMCP
+        stream.Write(new byte[] { 255, 253, 201 });                        // IAC DO GMCP
+
+        var connection = server.GetConnections().Single();
+        WaitFor(() => connection.IsGmcp);
+        Assert.True(connection.IsGmcp);
+
+        connection.QueueOutput("before\n");
+        connection.QueueGmcp(Gmcp.Encode("Char.Vitals", new Dictionary<object, object> { ["hp"] = 7L }));
+        connection.QueueOutput("after<end>");
+        connection.FlushOutput();
+
+        Assert.EndsWith("before\r\n\u00ff\u00fa\u00c9Char.Vitals {\"hp\":7}\u00ff\u00f0after<end>", ReadUntil(stream, "<end>"));
+    }
+
+    [Fact]
+    public void Gmcp_EncodesLpcValuesAsJson()
+    {
+        var data = new Dictionary<object, object>
+        {
+            ["name"] = "Bob \"the\" Bold",
+            ["exits"] = new List<object> { "north", "south" },
+            [3L] = 0L
+        };
+        Assert.Equal("Room.Info {\"name\":\"Bob \\u0022the\\u0022 Bold\",\"exits\":[\"north\",\"south\"],\"3\":0}",
+            Gmcp.Encode("Room.Info", data));
+        Assert.Equal("Core.Ping", Gmcp.Encode("Core.Ping", null));
+
+        Assert.True(Gmcp.IsPackageName("Char.Vitals"));
+        Assert.False(Gmcp.IsPackageName("Char Vitals"));
+        Assert.False(Gmcp.IsPackageName(".Char"));
+    }
+
+    private static async Task<string> ReceiveUntil(ClientWebSocket socket, string expected)
+    {
+        var received = new StringBuilder();
+        var buffer = new byte[4096];
+        using var timeout = new CancellationTokenSource(TimeSpan.FromSeconds(5));
+        while (!received.ToString().Contains(expected))
+        {
+            var result = await socket.ReceiveAsync(buffer, timeout.Token);
+            if (result.MessageType == WebSocketMessageType.Close) break;
+            received.Append(Encoding.UTF8.GetString(buffer, 0, result.Count));
+        }
+        return received.ToString();
+    }
+
+    [Fact]
+    public async Task WebSocket_ClientPlaysThroughTheSameSessionPath()
+    {
+        var server = StartServer(compression: CompressionLevel.Optimal, webSocketPort: 0);
+        using var socket = new ClientWebSocket();
+        socket.Options.DangerousDeflateOptions = new WebSocketDeflateOptions();
+        socket.Options.CollectHttpResponseDetails = true;
+        await socket.ConnectAsync(new Uri($"ws://127.0.0.1:{server.WebSocketLocalPort}/"), CancellationToken.None);
+
+        Assert.Contains("permessage-deflate", socket.HttpResponseHeaders!["Sec-WebSocket-Extensions"].Single());
+        Assert.Contains("Welcome to LPMud Revival!", await ReceiveUntil(socket, "type 'new'"));
+
+        await socket.SendAsync(Encoding.UTF8.GetBytes("new"), WebSocketMessageType.Text, true, CancellationToken.None);
+        Assert.Contains("Choose a username", await ReceiveUntil(socket, "Choose a username"));
+
+        // Same output path, and the same newlines, as telnet
+        var connection = server.GetConnections().Single();
+        Assert.True(connection.IsWebSocket);
+        _gameLoop.SendToPlayer(connection.Id, "one\n");
+        _gameLoop.SendToPlayer(connection.Id, "two\n<end>");
+        Assert.Equal("one\r\ntwo\r\n<end>", await ReceiveUntil(socket, "<end>"));
+
+        await socket.CloseAsync(WebSocketCloseStatus.NormalClosure, null, CancellationToken.None);
+        WaitFor(() => server.ConnectionCount == 0);
+        Assert.Equal(0, server.ConnectionCount);
+    }
+
+    [Fact]
+    public void WebSocket_PlainHttpRequest_IsRefused()
+    {
+        var server = StartServer(webSocketPort: 0);
+        using var client = new TcpClient("127.0.0.1", server.WebSocketLocalPort);
+        var stream = client.GetStream();
+        stream.Write(Encoding.ASCII.GetBytes("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+
+        Assert.StartsWith("HTTP/1.1 400", ReadUntil(stream, "\r\n\r\n"));
+        Assert.Equal(0, server.ConnectionCount);
+    }
+
+    [Fact]
+    public void WebSocketHandshake_NegotiatesDeflateOffers()
+    {
+        // The example from RFC 6455 section 1.3
+        Assert.Equal("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=", WebSocketHandshake.AcceptKey("dGhlIHNhbXBsZSBub25jZQ=="));
+
+        Assert.Equal("permessage-deflate", WebSocketHandshake.NegotiateDeflate("permessage-deflate; client_max_window_bits")?.Response);
+
+        var agreed = WebSocketHandshake.NegotiateDeflate("x-webkit-deflate-frame, permessage-deflate; server_max_window_bits=10; server_no_context_takeover");
+        Assert.Equal("permessage-deflate; server_max_window_bits=10; server_no_context_takeover", agreed?.Response);
+        Assert.Equal(10, agreed?.Options.ServerMaxWindowBits);
+        Assert.False(agreed?.Options.ServerContextTakeover);
+
+        Assert.Null(WebSocketHandshake.NegotiateDeflate("permessage-deflate; server_max_window_bits=8"));
+    }
+
+    /// <summary>
+    /// Start the server as a copyover would, adopting a listener and a
+    /// connection logged in as player "testcopy"; returns the client end and
+    /// the listener's port.
+    /// </summary>
+    private (TcpClient Player, int Port) StartWithAdoptedPlayer()
+    {
+        Directory.CreateDirectory(Path.Combine(_testMudlibPath, "std"));
+        File.WriteAllText(Path.Combine(_testMudlibPath, "std", "player.c"), @"
+string name;
+void set_name(string n) { name = n; }
+");
+        new AccountManager(_testMudlibPath).CreateAccount("testcopy", "testcopy@example.com", "secret123");
+
+        // What the old process would have left: a listening socket, and a
+        // connection it had accepted for a player
+        var listener = new Socket(AddressFamily.InterNetwork, SocketType.Stream, ProtocolType.Tcp);
+        listener.Bind(new System.Net.IPEndPoint(System.Net.IPAddress.Loopback, 0));
+        listener.Listen();
+        int port = ((System.Net.IPEndPoint)listener.LocalEndPoint!).Port;
+        var player = new TcpClient("127.0.0.1", port);
+        var accepted = listener.Accept();
+
+        var state = new CopyoverState(port, (long)listener.Handle, new List<CopyoverConnection>
+        {
+            new((long)accepted.Handle, "127.0.0.1", "testcopy")
+        });
+        // The new server owns the descriptors now
+        listener.SafeHandle.SetHandleAsInvalid();
+        accepted.SafeHandle.SetHandleAsInvalid();
+
+        _server = new TelnetServer(state, _gameLoop);
+        _serverThread = new Thread(_server.Run) { IsBackground = true };
+        _serverThread.Start();
+        Assert.True(_server.Listening.Wait(TimeSpan.FromSeconds(5)));
+        return (player, port);
+    }
+
+    [Fact]
+    public void Copyover_AdoptedSockets_LogThePlayerBackIn()
+    {
+        var (player, port) = StartWithAdoptedPlayer();
+        using var _ = player;
+
+        var resumed = ReadUntil(player.GetStream(), "> ");
+        Assert.Contains("Copyover complete.", resumed);
+        Assert.Contains("Welcome, Testcopy", resumed);
+        var session = _gameLoop.GetAllSessions().Single();
+        Assert.Equal(LoginState.Playing, session.LoginState);
+        Assert.NotNull(session.PlayerObject);
+
+        // The inherited listener still takes new connections
+        using var newcomer = new TcpClient("127.0.0.1", port);
+        Assert.Contains("Welcome to LPMud Revival!", ReadUntil(newcomer.GetStream(), "type 'new'"));
+    }
+
+    [Fact]
+    public void PlayerCommand_IsTimedThroughEveryStage()
+    {
+        var (player, _) = StartWithAdoptedPlayer();
+        using var __ = player;
+        var stream = player.GetStream();
+        ReadUntil(stream, "> ");
+
+        stream.Write(Encoding.ASCII.GetBytes("xyzzy\r\n"));
+        ReadUntil(stream, "> ");
+
+        int Count() => _gameLoop.Latency.Read((total, stages, slow) => (int)total.Count);
+        WaitFor(() => Count() == 1);
+        _gameLoop.Latency.Read((total, stages, slow) =>
+        {
+            Assert.Equal(1, total.Count);
+            Assert.All(stages, stage => Assert.Equal(1, stage.Count));
+            return 0;
+        });
+    }
+
+    [Fact]
+    public void Copyover_RestartArguments_ReplaceAnEarlierStateFile()
+    {
+        var argv = Copyover.RestartArguments("/tmp/state.json");
+
+        Assert.Equal(Environment.ProcessPath, argv[0]);
+        Assert.Equal(new[] { "--copyover", "/tmp/state.json" }, argv[^2..]);
+        Assert.Single(argv, a => a == "--copyover");
+    }
+
+    [Fact]
+    public void ClientHangup_RemovesConnection()
+    {
+        var client = new TcpClient("127.0.0.1", Server.LocalPort);
+        ReadUntil(client.GetStream(), "type 'new'");
+        Assert.Equal(1, Server.ConnectionCount);
+
+        client.Close();
+
+        WaitFor(() => Server.ConnectionCount == 0);
+        Assert.Equal(0, Server.ConnectionCount);
+    }
+}
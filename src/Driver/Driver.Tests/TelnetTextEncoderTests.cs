@@ -0,0 +1,62 @@
+using System.Text;
+using Xunit;
+
+namespace Driver.Tests;
+
+public class TelnetTextEncoderTests
+{
+    private static string Encode(TelnetTextEncoder encoder, string text)
+    {
+        var buffer = new byte[TelnetTextEncoder.MaxEncodedLength(text.Length)];
+        int length = encoder.Encode(new StringBuilder(text), buffer);
+        return Encoding.ASCII.GetString(buffer, 0, length);
+    }
+
+    [Fact]
+    public void Encode_ConvertsNewlinesWithoutWrapping()
+    {
+        var encoder = new TelnetTextEncoder();
+        var longLine = new string('x', 300);
+
+        Assert.Equal("a\r\nb\r\ncé".Replace('é', '?'), Encode(encoder, "a\nb\r\ncé"));
+        Assert.Equal(longLine, Encode(encoder, longLine));
+    }
+
+    [Fact]
+    public void Encode_WrapsAtTheLastSpaceBeforeTheEdge()
+    {
+        var encoder = new TelnetTextEncoder { Width = 20 };
+
+        Assert.Equal("The quick brown fox\r\njumps over the lazy\r\ndog.\r\n",
+            Encode(encoder, "The quick brown fox jumps over the lazy dog.\n"));
+
+        // A word wider than the window is broken at the edge
+        Assert.Equal("aaaaaaaaaaaaaaaaaaaa\r\naaaaa", Encode(encoder, new string('a', 25)));
+    }
+
+    [Fact]
+    public void Encode_DoesNotCountOrSplitEscapeSequences()
+    {
+        var encoder = new TelnetTextEncoder { Width = 20 };
+        const string red = "\u001b[31m";
+        const string reset = "\u001b[0m";
+
+        Assert.Equal($"{red}The quick brown fox{reset}\r\njumps",
+            Encode(encoder, $"{red}The quick brown fox{reset} jumps"));
+        Assert.Equal($"0123456789012345678{red}\r\nabc",
+            Encode(new TelnetTextEncoder { Width = 20 }, $"0123456789012345678{red} abc"));
+    }
+
+    [Fact]
+    public void Encode_CarriesTheColumnBetweenBatches()
+    {
+        var encoder = new TelnetTextEncoder { Width = 20 };
+
+        Assert.Equal("> The quick brown", Encode(encoder, "> The quick brown"));
+        Assert.Equal("\r\nfox jumps", Encode(encoder, " fox jumps"));
+
+        // Too narrow to be a real window: no wrapping
+        encoder.Width = 5;
+        Assert.Equal(0, encoder.Width);
+    }
+}
@@ -0,0 +1,45 @@
+using System.Text;
+using Xunit;
+
+namespace Driver.Tests;
+
+public class TerminalTypeTests
+{
+    private static byte[] Is(string answer) => new byte[] { 0 }.Concat(Encoding.ASCII.GetBytes(answer)).ToArray();
+
+    [Fact]
+    public void Negotiation_ReadsClientTerminalAndMtts()
+    {
+        var negotiation = new TerminalTypeNegotiation();
+
+        Assert.True(negotiation.Reply(Is("MUDLET")));
+        Assert.True(negotiation.Reply(Is("ANSI-TRUECOLOR")));
+        Assert.False(negotiation.Reply(Is("MTTS 2317")));
+
+        Assert.Equal(new TerminalInfo("MUDLET", "ANSI-TRUECOLOR", 2317), negotiation.Result);
+        Assert.Equal(ColorSupport.Xterm256, negotiation.Result!.Color);
+    }
+
+    [Fact]
+    public void Negotiation_StopsWhenTheClientRepeatsItself()
+    {
+        var negotiation = new TerminalTypeNegotiation();
+
+        Assert.True(negotiation.Reply(Is("xterm")));
+        Assert.False(negotiation.Reply(Is("xterm")));
+
+        Assert.Equal(new TerminalInfo("xterm", "xterm", 0), negotiation.Result);
+        Assert.Equal(ColorSupport.Ansi, negotiation.Result!.Color);
+        Assert.False(negotiation.Reply(Is("again")));
+    }
+
+    [Fact]
+    public void Color_FollowsMttsBitsThenNames()
+    {
+        Assert.Equal(ColorSupport.None, new TerminalInfo("CLIENT", "DUMB", 0).Color);
+        Assert.Equal(ColorSupport.None, new TerminalInfo("CLIENT", "ANSI", 64).Color);
+        Assert.Equal(ColorSupport.Ansi, new TerminalInfo("CLIENT", "ANSI", TerminalInfo.MttsAnsi).Color);
+        Assert.Equal(ColorSupport.Xterm256, new TerminalInfo("PuTTY", "xterm-256color", 0).Color);
+        Assert.Equal(ColorSupport.Xterm256, new TerminalInfo("TINTIN++", "XTERM", 0).Color);
+    }
+}
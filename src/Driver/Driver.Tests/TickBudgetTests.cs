@@ -0,0 +1,93 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class TickBudgetTests
+{
+    private double _now;
+    private readonly TickBudget _budget;
+
+    public TickBudgetTests()
+    {
+        _budget = new TickBudget(100, 20, () => _now);
+    }
+
+    /// <summary>
+    /// Run one tick in which the work before heartbeats takes busyMs and each
+    /// heartbeat turn takes turnMs; returns the turns run.
+    /// </summary>
+    private int Tick(double busyMs, double turnMs = 1)
+    {
+        double start = _now;
+        _budget.BeginTick();
+        _now += busyMs;
+        int turns = 0;
+        while (_budget.NextHeartbeatTurn())
+        {
+            turns++;
+            _now += turnMs;
+        }
+        _budget.EndTick();
+        _now = Math.Max(_now, start + 100);
+        return turns;
+    }
+
+    [Fact]
+    public void QuietTicks_RunOneHeartbeatTurnEach_AndEverythingElse()
+    {
+        for (int i = 0; i < 30; i++)
+        {
+            Assert.Equal(1, Tick(10));
+        }
+
+        _budget.BeginTick();
+        Assert.True(_budget.MayRun(0));
+        Assert.Equal(0L, _budget.LagMs);
+        Assert.Equal(0L, _budget.Deferrals);
+    }
+
+    [Fact]
+    public void Overload_StretchesHeartbeats_ThenCatchesUpWithoutASpike()
+    {
+        // Three times the tick interval in commands: heartbeats every other tick
+        int turns = 0;
+        for (int i = 0; i < 20; i++)
+        {
+            turns += Tick(300);
+        }
+        Assert.Equal(20 / TickBudget.MaxHeartbeatStretch, turns);
+        Assert.Equal(10, _budget.HeartbeatsOwed);
+        Assert.True(_budget.LagMs > 1000, $"lag {_budget.LagMs}");
+
+        // Deferrable jobs wait, up to a limit
+        _budget.BeginTick();
+        _now += 300;
+        Assert.False(_budget.MayRun(5));
+        Assert.True(_budget.MayRun(TickBudget.MaxDeferTicks));
+        _budget.EndTick();
+
+        // The load passes: owed turns are made up a few at a time
+        Assert.Equal(TickBudget.MaxHeartbeatTurnsPerTick, Tick(10));
+        while (_budget.HeartbeatsOwed > 0)
+        {
+            Assert.InRange(Tick(10), 1, TickBudget.MaxHeartbeatTurnsPerTick);
+        }
+        for (int i = 0; i < 40; i++)
+        {
+            Tick(10);
+        }
+        Assert.True(_budget.LagMs < 20, $"lag {_budget.LagMs}");
+    }
+
+    [Fact]
+    public void SustainedOverload_OwesAtMostOneRotation()
+    {
+        for (int i = 0; i < 200; i++)
+        {
+            Tick(300);
+        }
+
+        Assert.True(_budget.HeartbeatsOwed <= 20);
+        Assert.True(_budget.HeartbeatTurnsDropped > 0);
+    }
+}
@@ -0,0 +1,148 @@
+using System.Diagnostics;
+using Xunit;
+
+namespace Driver.Tests;
+
+public class TickProfilerTests
+{
+    /// <summary>
+    /// A call start timestamp the given number of milliseconds in the past.
+    /// </summary>
+    private static long MillisecondsAgo(int ms) => Stopwatch.GetTimestamp() - Stopwatch.Frequency * ms / 1000;
+
+    [Fact]
+    public void Histogram_PercentilesReportBucketUpperBounds()
+    {
+        var histogram = new TickProfiler.Histogram();
+        for (int i = 0; i < 90; i++) histogram.Record(100);   // bucket [64, 128)
+        for (int i = 0; i < 10; i++) histogram.Record(5000);  // bucket [4096, 8192)
+
+        Assert.Equal(100, histogram.Count);
+        Assert.Equal(590, histogram.AverageMicroseconds);
+        Assert.Equal(5000, histogram.MaxMicroseconds);
+        Assert.Equal(128, histogram.Percentile(50));
+        Assert.Equal(128, histogram.Percentile(90));
+        Assert.Equal(5000, histogram.Percentile(95)); // clamped to the max seen
+    }
+
+    [Fact]
+    public void TickWithinBudget_IsNotReported()
+    {
+        var profiler = new TickProfiler(1000);
+
+        var start = profiler.BeginTick();
+        profiler.EndPhase(TickPhase.Commands, start);
+        profiler.RecordCall("/std/player#1", "command look", start);
+
+        Assert.Null(profiler.EndTick());
+        Assert.Equal(1, profiler.Ticks);
+        Assert.Equal(0, profiler.Overruns);
+        Assert.Equal(1, profiler.Read((tick, phases, slow) => phases[(int)TickPhase.Commands].Count));
+    }
+
+    [Fact]
+    public void Overrun_ReportsPhasesAndCostliestCalls()
+    {
+        var profiler = new TickProfiler(1);
+
+        var phaseStart = profiler.BeginTick();
+        profiler.RecordCall("/world/rooms/town#3", "heart_beat", MillisecondsAgo(1));
+        profiler.RecordCall("/world/mobs/rat#7", "heart_beat", MillisecondsAgo(2));
+        profiler.RecordCall("/world/mobs/rat#7", "heart_beat", MillisecondsAgo(2));
+        profiler.RecordCall("/world/mobs/dragon#2", "heart_beat", MillisecondsAgo(3));
+        Thread.Sleep(5);
+        profiler.EndPhase(TickPhase.Heartbeats, phaseStart);
+
+        var slow = profiler.EndTick();
+
+        Assert.NotNull(slow);
+        Assert.Equal(1, profiler.Overruns);
+        Assert.True(slow.Microseconds > profiler.BudgetMicroseconds);
+        Assert.True(slow.PhaseMicroseconds[(int)TickPhase.Heartbeats] >= 4000);
+        Assert.Equal(0, slow.PhaseMicroseconds[(int)TickPhase.Commands]);
+
+        // Calls are summed per object and function, costliest first
+        Assert.Equal(new[] { "/world/mobs/rat#7", "/world/mobs/dragon#2", "/world/rooms/town#3" },
+            slow.TopCalls.Select(call => call.Object));
+        Assert.Equal(2, slow.TopCalls[0].Calls);
+        Assert.InRange(slow.TopCalls[0].Microseconds, 4000, 5000);
+
+        Assert.Single(profiler.Read((tick, phases, slowTicks) => slowTicks.ToList()));
+    }
+
+    [Fact]
+    public void SlowTicks_KeepOnlyTheMostRecent()
+    {
+        var profiler = new TickProfiler(1);
+
+        for (int i = 0; i < TickProfiler.MaxSlowTicks + 3; i++)
+        {
+            var start = profiler.BeginTick();
+            profiler.RecordCall("/obj/thing#1", "call_" + i, MillisecondsAgo(2));
+            Thread.Sleep(2);
+            profiler.EndPhase(TickPhase.Timers, start);
+            profiler.EndTick();
+        }
+
+        var kept = profiler.Read((tick, phases, slow) => slow.Select(s => s.TopCalls.Single().Function).ToList());
+        Assert.Equal(TickProfiler.MaxSlowTicks, kept.Count);
+        Assert.Equal("call_3", kept[0]);
+        Assert.Equal(TickProfiler.MaxSlowTicks + 3, profiler.Overruns);
+
+        profiler.Clear();
+        Assert.Equal(0, profiler.Ticks);
+        Assert.Empty(profiler.Read((tick, phases, slow) => slow.ToList()));
+    }
+
+    [Fact]
+    public void Commands_KeepALatencyHistogramPerVerb()
+    {
+        var profiler = new TickProfiler(100);
+
+        profiler.RecordCommand("look", TimeSpan.FromMilliseconds(3));
+        profiler.RecordCommand("look", TimeSpan.FromMilliseconds(5));
+        for (int i = 0; i < TickProfiler.MaxCommandVerbs + 10; i++)
+        {
+            profiler.RecordCommand("verb" + i, TimeSpan.FromMilliseconds(1));
+        }
+
+        var counts = profiler.ReadCommands(commands => commands.ToDictionary(pair => pair.Key, pair => pair.Value.Count));
+        Assert.Equal(2, counts["look"]);
+        Assert.Equal(5000, profiler.ReadCommands(commands => commands["look"].MaxMicroseconds));
+
+        // Past the cap, new verbs share one histogram
+        Assert.Equal(TickProfiler.MaxCommandVerbs + 1, counts.Count);
+        Assert.Equal(11, counts["other"]);
+
+        profiler.Clear();
+        Assert.Equal(0, profiler.ReadCommands(commands => commands.Count));
+    }
+
+    [Fact]
+    public void Allocations_AreChargedToPhasesAndSummedByProgram()
+    {
+        var profiler = new TickProfiler(1000);
+
+        var start = profiler.BeginTick();
+        var garbage = new byte[64 * 1024];
+        profiler.RecordCall("/world/mobs/rat#7", "heart_beat", start, start, 1000);
+        profiler.RecordCall("/world/mobs/rat#9", "heart_beat", start, start, 500);
+        profiler.RecordCall("/world/rooms/town", "reset", start, start, 2000);
+        profiler.EndPhase(TickPhase.Heartbeats, start);
+        GC.KeepAlive(garbage);
+        profiler.EndTick();
+
+        var phaseBytes = profiler.PhaseBytes;
+        Assert.True(phaseBytes[(int)TickPhase.Heartbeats] >= 64 * 1024);
+        Assert.Equal(0, phaseBytes[(int)TickPhase.Saves]);
+
+        // Clones share their program's entry, biggest first
+        var top = profiler.TopAllocators(10);
+        Assert.Equal(new TickProfiler.Allocator("/world/rooms/town", "reset", 1, 2000), top[0]);
+        Assert.Equal(new TickProfiler.Allocator("/world/mobs/rat", "heart_beat", 2, 1500), top[1]);
+
+        profiler.Clear();
+        Assert.Empty(profiler.TopAllocators(10));
+        Assert.Equal(0, profiler.PhaseBytes.Sum());
+    }
+}
@@ -0,0 +1,126 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class TimingWheelTests
+{
+    private static List<string> AdvanceTo(TimingWheel<string> wheel, long tick)
+    {
+        var due = new List<string>();
+        wheel.Advance(tick, due);
+        return due;
+    }
+
+    [Theory]
+    [InlineData(0)]
+    [InlineData(1)]
+    [InlineData(255)]
+    [InlineData(256)]
+    [InlineData(300)]
+    [InlineData(16384)]
+    [InlineData(20000)]
+    [InlineData(2_000_000)]
+    public void Timer_FiresOnItsDueTick(long dueTick)
+    {
+        var wheel = new TimingWheel<string>();
+        wheel.Schedule("t", dueTick);
+
+        if (dueTick > 0)
+        {
+            Assert.Empty(AdvanceTo(wheel, dueTick - 1));
+        }
+        Assert.Equal(new[] { "t" }, AdvanceTo(wheel, dueTick).ToArray());
+        Assert.Equal(0, wheel.Count);
+    }
+
+    [Fact]
+    public void Timers_FireInDueOrderThenSchedulingOrder()
+    {
+        var wheel = new TimingWheel<string>(startTick: 100);
+        wheel.Schedule("far", 700);      // starts in an outer wheel, cascades down
+        wheel.Schedule("near", 150);
+        AdvanceTo(wheel, 600);
+        wheel.Schedule("late-same-tick", 700);
+        wheel.Schedule("early", 650);
+
+        Assert.Equal(new[] { "early", "far", "late-same-tick" }, AdvanceTo(wheel, 800).ToArray());
+    }
+
+    [Fact]
+    public void Cancel_StopsTimerFromFiring()
+    {
+        var wheel = new TimingWheel<string>();
+        var keep = wheel.Schedule("keep", 10);
+        var drop = wheel.Schedule("drop", 10);
+
+        Assert.True(wheel.Cancel(drop));
+        Assert.False(wheel.Cancel(drop));
+        Assert.False(drop.IsScheduled);
+        Assert.Equal(1, wheel.Count);
+
+        Assert.Equal(new[] { "keep" }, AdvanceTo(wheel, 10).ToArray());
+        Assert.False(keep.IsScheduled);
+    }
+
+    [Fact]
+    public void Reschedule_MovesTimerAndRevivesFiredOnes()
+    {
+        var wheel = new TimingWheel<string>();
+        var timer = wheel.Schedule("t", 5);
+
+        wheel.Reschedule(timer, 1000);
+        Assert.Empty(AdvanceTo(wheel, 999));
+        Assert.Equal(new[] { "t" }, AdvanceTo(wheel, 1000).ToArray());
+
+        wheel.Reschedule(timer, 1010);
+        Assert.True(timer.IsScheduled);
+        Assert.Equal(new[] { "t" }, AdvanceTo(wheel, 1010).ToArray());
+    }
+
+    [Fact]
+    public void PastDueTimer_FiresOnNextTick()
+    {
+        var wheel = new TimingWheel<string>();
+        AdvanceTo(wheel, 50);
+
+        var timer = wheel.Schedule("late", 10);
+
+        Assert.Equal(51, timer.DueTick);
+        Assert.Equal(new[] { "late" }, AdvanceTo(wheel, 51).ToArray());
+    }
+
+    [Fact]
+    public void ManyTimers_AcrossWraps_AllFireExactlyOnce()
+    {
+        var wheel = new TimingWheel<string>();
+        var random = new Random(1234);
+        var expected = new Dictionary<string, long>();
+        for (int i = 0; i < 5000; i++)
+        {
+            long due = random.Next(0, 100_000);
+            wheel.Schedule(i.ToString(), due);
+            expected[i.ToString()] = due;
+        }
+
+        var fired = new Dictionary<string, long>();
+        for (long tick = 0; tick <= 100_000; tick += random.Next(1, 700))
+        {
+            foreach (var value in AdvanceTo(wheel, tick))
+            {
+                fired.Add(value, tick);
+            }
+        }
+        foreach (var value in AdvanceTo(wheel, 100_000))
+        {
+            fired.Add(value, 100_000);
+        }
+
+        Assert.Equal(expected.Count, fired.Count);
+        foreach (var (value, due) in expected)
+        {
+            // Fired on the first Advance that reached its due tick
+            Assert.True(fired[value] >= due, $"{value} fired at {fired[value]}, due {due}");
+        }
+        Assert.Equal(0, wheel.Count);
+    }
+}
@@ -0,0 +1,103 @@
+using Xunit;
+
+namespace Driver.Tests;
+
+public class VmThreadTests : IDisposable
+{
+    private readonly string _mudlibPath;
+    private readonly ObjectManager _objectManager;
+
+    public VmThreadTests()
+    {
+        _mudlibPath = Path.Combine(Path.GetTempPath(), $"mudlib_vmthread_test_{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path.Combine(_mudlibPath, "std"));
+
+        File.WriteAllText(Path.Combine(_mudlibPath, "std", "worker.c"), @"
+int calls;
+
+int fib(int n) {
+    if (n < 2) return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+int run(int n) {
+    calls++;
+    return fib(n) + calls - calls;
+}
+
+object caller() { return previous_object(); }
+
+int spin() {
+    int i;
+    while (1) { i++; }
+    return i;
+}
+");
+
+        _objectManager = new ObjectManager(_mudlibPath);
+        _objectManager.InitializeInterpreter();
+    }
+
+    public void Dispose()
+    {
+        if (Directory.Exists(_mudlibPath))
+        {
+            Directory.Delete(_mudlibPath, recursive: true);
+        }
+    }
+
+    [Fact]
+    public void Threads_RunTheSameProgramConcurrentlyOnOneInterpreter()
+    {
+        var interpreter = _objectManager.Interpreter!;
+        interpreter.MaxInstructions = 200_000;
+        var clones = Enumerable.Range(0, 4).Select(_ => _objectManager.CloneObject("/std/worker")).ToArray();
+        var results = new long[clones.Length];
+        var errors = new List<string>();
+
+        var threads = clones.Select((clone, index) => new Thread(() =>
+        {
+            try
+            {
+                for (int i = 0; i < 50; i++)
+                {
+                    interpreter.ResetInstructionCount();
+                    results[index] += Convert.ToInt64(interpreter.CallFunctionOnObject(clone, "run", new List<object> { 15L }));
+                }
+
+                // A runaway loop here stops this thread only
+                interpreter.ResetInstructionCount();
+                Assert.Throws<ExecutionLimitException>(() => interpreter.CallFunctionOnObject(clone, "spin", new List<object>()));
+                interpreter.ReleaseThread();
+            }
+            catch (Exception ex)
+            {
+                lock (errors) errors.Add(ex.ToString());
+            }
+        })).ToList();
+
+        threads.ForEach(t => t.Start());
+        threads.ForEach(t => t.Join());
+
+        Assert.Empty(errors);
+        Assert.Equal(Enumerable.Repeat(610L * 50, clones.Length).ToArray(), results);
+    }
+
+    [Fact]
+    public void ReleaseThread_ReturnsCleanStateToThePool()
+    {
+        var interpreter = _objectManager.Interpreter!;
+        var worker = _objectManager.CloneObject("/std/worker");
+        interpreter.ResetInstructionCount();
+        interpreter.CallFunctionOnObject(worker, "run", new List<object> { 5L });
+
+        int pooled = VmThread.PooledCount;
+        interpreter.ReleaseThread();
+        Assert.True(VmThread.PooledCount >= pooled);
+
+        // The thread rents fresh state and carries on
+        interpreter.ResetInstructionCount();
+        Assert.Equal(5L, Convert.ToInt64(interpreter.CallFunctionOnObject(worker, "run", new List<object> { 5L })));
+        Assert.Equal(0L, Convert.ToInt64(interpreter.CallFunctionOnObject(worker, "caller", new List<object>())));
+    }
+}
@@ -1,26 +1,42 @@
+using System.Collections.Concurrent;
 using System.Security.Cryptography;
 using System.Text;
 using System.Text.Json;
+using System.Text.Json.Serialization;
 
 namespace Driver;
 
 /// <summary>
 /// Manages player accounts including registration, authentication, and persistence.
 /// Passwords are hashed using PBKDF2 with SHA256.
+///
+/// Accounts are read from disk once, on first use, and kept in memory, so a
+/// login loads its account file once however many fields it reads. Changes
+/// are written through: the account is serialized straight away and the file
+/// write queued on AsyncFileWriter.Shared, which merges rewrites of the same
+/// file. Reading an account that isn't cached settles its file first.
+///
+/// With a SaveStore, accounts are kept there under their file's mudlib path
+/// and go out with the tick's batch. Accounts not in the store yet are read
+/// from their files, and move into the store the next time they change.
 /// </summary>
 public class AccountManager
 {
     private readonly string _accountsPath;
     private readonly string _mudlibPath;
+    private readonly ConcurrentDictionary<string, AccountData> _accounts = new();
+    private readonly object _createLock = new();
+    private readonly SaveStore? _store;
 
     // PBKDF2 parameters
     private const int SaltSize = 16;
     private const int HashSize = 32;
     private const int Iterations = 100000;
 
-    public AccountManager(string mudlibPath)
+    public AccountManager(string mudlibPath, SaveStore? store = null)
     {
         _mudlibPath = mudlibPath;
+        _store = store;
         _accountsPath = Path.Combine(mudlibPath, "secure", "accounts");
         Directory.CreateDirectory(_accountsPath);
     }
@@ -30,8 +46,7 @@ public class AccountManager
     /// </summary>
     public bool AccountExists(string username)
     {
-        var path = GetAccountPath(username);
-        return File.Exists(path);
+        return LoadAccount(username) != null;
     }
 
     /// <summary>
@@ -46,26 +61,44 @@ public class AccountManager
             return false;
         }
 
-        var salt = RandomNumberGenerator.GetBytes(SaltSize);
-        var hash = HashPassword(password, salt);
-
-        // First registered user becomes Admin
-        var isFirstAccount = !Directory.EnumerateFiles(_accountsPath, "*.json").Any();
-        var accessLevel = isFirstAccount ? AccessLevel.Admin : AccessLevel.Player;
+        return CreateAccountWithHash(username, email, HashNewPassword(password));
+    }
 
-        var account = new AccountData
+    /// <summary>
+    /// Create an account from a hash made by HashNewPassword, so the slow
+    /// part of registration can run off the game thread.
+    /// </summary>
+    /// <returns>True if account was created, false if username already exists.</returns>
+    public bool CreateAccountWithHash(string username, string email, string passwordHash)
+    {
+        AccessLevel accessLevel;
+        lock (_createLock)
         {
-            Username = username.ToLowerInvariant(),
-            Email = email,
-            PasswordHash = Convert.ToBase64String(salt) + ":" + Convert.ToBase64String(hash),
-            CreatedAt = DateTime.UtcNow,
-            LastLogin = DateTime.UtcNow,
-            LoginCount = 1,
-            AccessLevel = accessLevel,
-            Aliases = GetDefaultAliases()
-        };
-
-        SaveAccount(account);
+            if (AccountExists(username))
+            {
+                return false;
+            }
+
+            // First registered user becomes Admin
+            var isFirstAccount = _accounts.IsEmpty && !Directory.EnumerateFiles(_accountsPath, "*.json").Any() &&
+                                 _store?.Any("/secure/accounts/") != true;
+            accessLevel = isFirstAccount ? AccessLevel.Admin : AccessLevel.Player;
+
+            var account = new AccountData
+            {
+                Username = username.ToLowerInvariant(),
+                Email = email,
+                PasswordHash = passwordHash,
+                CreatedAt = DateTime.UtcNow,
+                LastLogin = DateTime.UtcNow,
+                LoginCount = 1,
+                AccessLevel = accessLevel,
+                Aliases = GetDefaultAliases()
+            };
+
+            _accounts[GetAccountPath(username)] = account;
+            SaveAccount(account);
+        }
 
         // Create wizard home directory if Wizard or Admin
         if (accessLevel >= AccessLevel.Wizard)
@@ -82,13 +115,35 @@ public class AccountManager
     /// <returns>True if credentials are valid.</returns>
     public bool ValidateCredentials(string username, string password)
     {
-        var account = LoadAccount(username);
-        if (account == null)
-        {
-            return false;
-        }
+        var passwordHash = GetPasswordHash(username);
+        return passwordHash != null && VerifyPassword(passwordHash, password);
+    }
+
+    /// <summary>
+    /// The stored "salt:hash" for an account, or null if there's no such account.
+    /// </summary>
+    public string? GetPasswordHash(string username)
+    {
+        return LoadAccount(username)?.PasswordHash;
+    }
+
+    /// <summary>
+    /// Hash a new password with a fresh salt, as "salt:hash". Deliberately
+    /// slow (PBKDF2); safe to call from any thread.
+    /// </summary>
+    public static string HashNewPassword(string password)
+    {
+        var salt = RandomNumberGenerator.GetBytes(SaltSize);
+        return Convert.ToBase64String(salt) + ":" + Convert.ToBase64String(HashPassword(password, salt));
+    }
 
-        var parts = account.PasswordHash.Split(':');
+    /// <summary>
+    /// Check a password against a stored "salt:hash". Deliberately slow
+    /// (PBKDF2); safe to call from any thread.
+    /// </summary>
+    public static bool VerifyPassword(string passwordHash, string password)
+    {
+        var parts = passwordHash.Split(':');
         if (parts.Length != 2)
         {
             return false;
@@ -112,9 +167,12 @@ public class AccountManager
             return;
         }
 
-        account.LastLogin = DateTime.UtcNow;
-        account.LoginCount++;
-        SaveAccount(account);
+        lock (account)
+        {
+            account.LastLogin = DateTime.UtcNow;
+            account.LoginCount++;
+            SaveAccount(account);
+        }
     }
 
     /// <summary>
@@ -140,9 +198,13 @@ public class AccountManager
             return false;
         }
 
-        var previousLevel = account.AccessLevel;
-        account.AccessLevel = level;
-        SaveAccount(account);
+        AccessLevel previousLevel;
+        lock (account)
+        {
+            previousLevel = account.AccessLevel;
+            account.AccessLevel = level;
+            SaveAccount(account);
+        }
 
         // Create wizard home directory when promoting to Wizard or higher
         if (level >= AccessLevel.Wizard && previousLevel < AccessLevel.Wizard)
@@ -241,9 +303,15 @@ public class AccountManager
     public Dictionary<string, string> GetAliases(string username)
     {
         var account = LoadAccount(username);
-        if (account?.Aliases != null)
+        if (account != null)
         {
-            return new Dictionary<string, string>(account.Aliases, StringComparer.OrdinalIgnoreCase);
+            lock (account)
+            {
+                if (account.Aliases != null)
+                {
+                    return new Dictionary<string, string>(account.Aliases, StringComparer.OrdinalIgnoreCase);
+                }
+            }
         }
         return GetDefaultAliases();
     }
@@ -260,9 +328,12 @@ public class AccountManager
             return false;
         }
 
-        account.Aliases ??= GetDefaultAliases();
-        account.Aliases[alias.ToLowerInvariant()] = command;
-        SaveAccount(account);
+        lock (account)
+        {
+            account.Aliases ??= GetDefaultAliases();
+            account.Aliases[alias.ToLowerInvariant()] = command;
+            SaveAccount(account);
+        }
         return true;
     }
 
@@ -278,12 +349,15 @@ public class AccountManager
             return false;
         }
 
-        if (account.Aliases == null || !account.Aliases.Remove(alias.ToLowerInvariant()))
+        lock (account)
         {
-            return false;
-        }
+            if (account.Aliases == null || !account.Aliases.Remove(alias.ToLowerInvariant()))
+            {
+                return false;
+            }
 
-        SaveAccount(account);
+            SaveAccount(account);
+        }
         return true;
     }
 
@@ -299,14 +373,17 @@ public class AccountManager
             return false;
         }
 
-        account.Aliases = GetDefaultAliases();
-        SaveAccount(account);
+        lock (account)
+        {
+            account.Aliases = GetDefaultAliases();
+            SaveAccount(account);
+        }
         return true;
     }
 
     #endregion
 
-    private byte[] HashPassword(string password, byte[] salt)
+    private static byte[] HashPassword(string password, byte[] salt)
     {
         return Rfc2898DeriveBytes.Pbkdf2(
             Encoding.UTF8.GetBytes(password),
@@ -326,18 +403,33 @@ public class AccountManager
         return Path.Combine(_accountsPath, safe + ".json");
     }
 
+    /// <summary>
+    /// The cached account, reading it from disk the first time. Callers that
+    /// change it lock it and save it before unlocking.
+    /// </summary>
     private AccountData? LoadAccount(string username)
     {
         var path = GetAccountPath(username);
-        if (!File.Exists(path))
+        if (_accounts.TryGetValue(path, out var cached))
         {
-            return null;
+            return cached;
+        }
+
+        var data = _store?.Get(StoreKey(path));
+        if (data == null)
+        {
+            // A write queued by another manager on the same mudlib lands first
+            AsyncFileWriter.Shared.Settle(path);
+            if (!File.Exists(path))
+            {
+                return null;
+            }
         }
 
         try
         {
-            var json = File.ReadAllText(path);
-            return JsonSerializer.Deserialize<AccountData>(json);
+            var account = JsonSerializer.Deserialize(data ?? File.ReadAllBytes(path), AccountJsonContext.Default.AccountData);
+            return account == null ? null : _accounts.GetOrAdd(path, account);
         }
         catch
         {
@@ -345,14 +437,30 @@ public class AccountManager
         }
     }
 
+    /// <summary>
+    /// Serialize the account now and queue the file write.
+    /// </summary>
     private void SaveAccount(AccountData account)
     {
         var path = GetAccountPath(account.Username);
-        var json = JsonSerializer.Serialize(account, new JsonSerializerOptions
+        var json = JsonSerializer.SerializeToUtf8Bytes(account, AccountJsonContext.Default.AccountData);
+        if (_store != null)
         {
-            WriteIndented = true
-        });
-        File.WriteAllText(path, json);
+            _store.Put(StoreKey(path), json);
+            return;
+        }
+        AsyncFileWriter.Shared.Write(path, json);
+    }
+
+    private string StoreKey(string path) => SaveStore.KeyFor(_mudlibPath, path);
+
+    /// <summary>
+    /// Block until every queued account write is on disk.
+    /// </summary>
+    public void Flush()
+    {
+        AsyncFileWriter.Shared.Settle(_accountsPath, directory: true);
+        _store?.Flush();
     }
 }
 
@@ -375,3 +483,12 @@ public class AccountData
     /// </summary>
     public Dictionary<string, string>? Aliases { get; set; }
 }
+
+/// <summary>
+/// Source-generated serializers for account files.
+/// </summary>
+[JsonSourceGenerationOptions(WriteIndented = true)]
+[JsonSerializable(typeof(AccountData))]
+internal partial class AccountJsonContext : JsonSerializerContext
+{
+}
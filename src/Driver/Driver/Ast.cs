@@ -227,7 +227,26 @@ public record ForStatement(Expression? Init, Expression? Condition, Expression?
 /// <summary>
 /// Switch statement: switch (expr) { case val: ... default: ... }
 /// </summary>
-public record SwitchStatement(Expression Value, List<SwitchCase> Cases) : Statement;
+public record SwitchStatement(Expression Value, List<SwitchCase> Cases) : Statement
+{
+    private SwitchTable? _table;
+
+    /// <summary>
+    /// Dispatch table for the cases, built on first use. Null when a label
+    /// isn't a literal (the optimizer folds constant labels beforehand).
+    /// </summary>
+    public SwitchTable? GetTable()
+    {
+        var table = _table;
+        if (table == null || !ReferenceEquals(table.Cases, Cases))
+        {
+            // A copy made with 'with' carries the original's table; rebuild for our cases
+            table = SwitchTable.Build(Cases);
+            _table = table;
+        }
+        return table.IsConstant ? table : null;
+    }
+}
 
 /// <summary>
 /// A case in a switch statement. Value is null for 'default:'.
@@ -235,9 +254,11 @@ public record SwitchStatement(Expression Value, List<SwitchCase> Cases) : Statem
 public record SwitchCase(Expression? Value, List<Statement> Statements);
 
 /// <summary>
-/// Foreach statement: foreach (variable in collection) body
+/// Foreach statement: foreach (variable in collection) body, or with a
+/// ValueVariable, foreach (variable, valueVariable in mapping) body over a
+/// mapping's keys and values.
 /// </summary>
-public record ForEachStatement(string Variable, Expression Collection, Statement Body) : Statement;
+public record ForEachStatement(string Variable, Expression Collection, Statement Body, string? ValueVariable = null) : Statement;
 
 /// <summary>
 /// Break statement: break;
@@ -269,9 +290,12 @@ public record VariableDeclaration(string Type, string Name, Expression? Initiali
 /// <summary>
 /// Function definition: [visibility] [varargs] type name(params) { body }
 /// Type is stored as string for now (int, string, void, object, etc.)
-/// Parameters are stored as strings for now (will add types later).
+/// ParameterTypes parallels Parameters, with "mixed" for an untyped
+/// parameter; it is null for definitions built without types.
 /// Visibility defaults to Public if not specified.
 /// When Varargs is true, the function accepts variable number of arguments.
+/// Once the function has bytecode its body may be packed into its program's
+/// AstArena; Body rebuilds it on first use (see AstArena).
 /// </summary>
 public record FunctionDefinition(
     string ReturnType,
@@ -279,4 +303,145 @@ public record FunctionDefinition(
     List<string> Parameters,
     Statement Body,
     FunctionVisibility Visibility = FunctionVisibility.Public,
-    bool Varargs = false) : Statement;
+    bool Varargs = false,
+    List<string>? ParameterTypes = null) : Statement
+{
+    private volatile Statement? _body = Body;
+    private AstArena? _arena;
+    private DeferredBody? _deferred;
+    private int _offset;
+    private int _bodyLine;
+
+    public Statement Body
+    {
+        get => _body ?? (_body = Rebuild());
+        init => _body = value;
+    }
+
+    /// <summary>
+    /// The line the body starts on, without unpacking or parsing it.
+    /// </summary>
+    public int BodyLine => _body?.Line ?? _bodyLine;
+
+    /// <summary>
+    /// Whether the body is only in its arena right now.
+    /// </summary>
+    public bool IsPacked => _body == null && _arena != null;
+
+    /// <summary>
+    /// Whether the body is still unparsed source (lazy parsing) with no tree
+    /// or arena copy.
+    /// </summary>
+    public bool IsDeferred => _body == null && _arena == null;
+
+    /// <summary>
+    /// The body, rebuilt from the arena or parsed if need be but not kept,
+    /// for passes that look at it once.
+    /// </summary>
+    public Statement ReadBody() => _body ?? Rebuild();
+
+    private Statement Rebuild() => _arena != null ? _arena.Read(_offset) : _deferred!.Parse();
+
+    /// <summary>
+    /// Keep the body at offset in arena instead of as a tree (AstArena.Pack).
+    /// </summary>
+    internal void PackInto(AstArena arena, int offset)
+    {
+        _bodyLine = Body.Line;
+        _arena = arena;
+        _offset = offset;
+        _body = null;
+    }
+
+    /// <summary>
+    /// Leave the body as source to be parsed when first asked for
+    /// (Parser.DeferBodies).
+    /// </summary>
+    internal FunctionDefinition Defer(DeferredBody body)
+    {
+        _bodyLine = body.Line;
+        _deferred = body;
+        _body = null;
+        return this;
+    }
+}
+
+/// <summary>
+/// Walking expression trees, for passes that only look (PerfLint, the
+/// bytecode compiler's checks).
+/// </summary>
+public static class ExpressionTree
+{
+    /// <summary>
+    /// The direct subexpressions of expr, in evaluation order.
+    /// </summary>
+    public static IEnumerable<Expression> Children(Expression expr)
+    {
+        switch (expr)
+        {
+            case BinaryOp binary:
+                yield return binary.Left;
+                yield return binary.Right;
+                break;
+            case UnaryOp unary:
+                yield return unary.Operand;
+                break;
+            case GroupedExpression grouped:
+                yield return grouped.Inner;
+                break;
+            case TernaryOp ternary:
+                yield return ternary.Condition;
+                yield return ternary.ThenBranch;
+                yield return ternary.ElseBranch;
+                break;
+            case Assignment assign:
+                yield return assign.Value;
+                break;
+            case CompoundAssignment compound:
+                yield return compound.Value;
+                break;
+            case IndexAssignment indexAssign:
+                yield return indexAssign.Object;
+                yield return indexAssign.Index;
+                yield return indexAssign.Value;
+                break;
+            case FunctionCall call:
+                foreach (var arg in call.Arguments) yield return arg;
+                break;
+            case ArrowCall arrow:
+                yield return arrow.Target;
+                foreach (var arg in arrow.Arguments) yield return arg;
+                break;
+            case ArrayLiteral array:
+                foreach (var element in array.Elements) yield return element;
+                break;
+            case MappingLiteral mapping:
+                foreach (var (key, value) in mapping.Entries)
+                {
+                    yield return key;
+                    yield return value;
+                }
+                break;
+            case IndexExpression index:
+                yield return index.Target;
+                yield return index.Index;
+                break;
+            case RangeExpression range:
+                yield return range.Target;
+                if (range.Start != null) yield return range.Start;
+                if (range.End != null) yield return range.End;
+                break;
+            case CatchExpression catchExpr:
+                yield return catchExpr.Body;
+                break;
+        }
+    }
+
+    /// <summary>
+    /// Whether expr or any expression inside it matches.
+    /// </summary>
+    public static bool Any(Expression expr, Func<Expression, bool> match)
+    {
+        return match(expr) || Children(expr).Any(child => Any(child, match));
+    }
+}
@@ -0,0 +1,121 @@
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// The bodies of a program's compiled functions, packed into one byte array.
+///
+/// Once a function has bytecode, the VM never walks its syntax tree, but
+/// keeping the tree costs a heap object per node for every function in the
+/// mudlib, and every gen2 collection traces them all. Packing leaves one
+/// byte array and one name table per program instead. A body is rebuilt from
+/// its bytes the first time something asks for it: the tree-walking
+/// fallback, or a pass that looks at a loaded program (clone prototypes,
+/// init() detection); analyses that look once use FunctionDefinition.ReadBody
+/// and leave it packed.
+///
+/// Nodes are written as AstSerializer writes them for the program cache, with
+/// two changes: ints (lines, columns, counts, operators) take a 7-bit
+/// variable-length encoding, and each string is an index into the arena's
+/// name table, so an identifier used a hundred times is stored once and
+/// comes back as one shared instance.
+/// </summary>
+public sealed class AstArena
+{
+    private readonly byte[] _bytes;
+    private readonly string[] _names;
+
+    private AstArena(byte[] bytes, string[] names)
+    {
+        _bytes = bytes;
+        _names = names;
+    }
+
+    /// <summary>
+    /// Bytes the packed bodies take, names not counted.
+    /// </summary>
+    public int Size => _bytes.Length;
+
+    /// <summary>
+    /// Distinct strings in the bodies.
+    /// </summary>
+    public int NameCount => _names.Length;
+
+    /// <summary>
+    /// Pack the bodies of functions into a new arena and drop their trees.
+    /// Does nothing for an empty list.
+    /// </summary>
+    public static void Pack(IReadOnlyList<FunctionDefinition> functions)
+    {
+        if (functions.Count == 0) return;
+
+        var stream = new MemoryStream();
+        var offsets = new int[functions.Count];
+        var names = new Dictionary<string, int>(StringComparer.Ordinal);
+        using (var writer = new PackedWriter(stream, names))
+        {
+            for (int i = 0; i < functions.Count; i++)
+            {
+                writer.Flush();
+                offsets[i] = (int)stream.Position;
+                AstSerializer.WriteStatement(writer, functions[i].Body);
+            }
+        }
+
+        var table = new string[names.Count];
+        foreach (var (name, id) in names)
+        {
+            table[id] = StringPool.Intern(name);
+        }
+        var arena = new AstArena(stream.ToArray(), table);
+        for (int i = 0; i < functions.Count; i++)
+        {
+            functions[i].PackInto(arena, offsets[i]);
+        }
+    }
+
+    /// <summary>
+    /// Rebuild the statement packed at offset.
+    /// </summary>
+    internal Statement Read(int offset)
+    {
+        using var reader = new PackedReader(new MemoryStream(_bytes, offset, _bytes.Length - offset, writable: false), _names);
+        return AstSerializer.ReadStatement(reader) ?? throw new InvalidDataException("Packed function body is empty");
+    }
+
+    private sealed class PackedWriter : BinaryWriter
+    {
+        private readonly Dictionary<string, int> _names;
+
+        public PackedWriter(Stream output, Dictionary<string, int> names) : base(output, Encoding.UTF8, leaveOpen: true)
+        {
+            _names = names;
+        }
+
+        public override void Write(int value) => Write7BitEncodedInt(value);
+
+        public override void Write(string value)
+        {
+            if (!_names.TryGetValue(value, out int id))
+            {
+                id = _names.Count;
+                _names[value] = id;
+            }
+            Write7BitEncodedInt(id);
+        }
+    }
+
+    private sealed class PackedReader : BinaryReader
+    {
+        private readonly string[] _names;
+
+        public PackedReader(Stream input, string[] names) : base(input, Encoding.UTF8)
+        {
+            _names = names;
+        }
+
+        public override int ReadInt32() => Read7BitEncodedInt();
+
+        public override string ReadString() => _names[Read7BitEncodedInt()];
+    }
+}
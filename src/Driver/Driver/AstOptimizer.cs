@@ -0,0 +1,397 @@
+namespace Driver;
+
+/// <summary>
+/// Rewrites a parsed program before it is registered: folds constant
+/// expressions and drops branches whose condition is a constant.
+/// Run once per parse (see ObjectManager.ParseSource), so both the bytecode
+/// compiler and the tree walker see the simplified tree.
+///
+/// Folding only applies where the result is certain to equal what the
+/// interpreter would compute: int arithmetic (wrapping, like the runtime),
+/// string concatenation and comparison, and the logical operators. Anything
+/// that would raise at run time, like division by zero, is left alone so the
+/// error still happens, with its line, when the code runs.
+///
+/// A dead branch that declares a local is kept. The bytecode compiler binds
+/// locals by source order, so removing the declaration would change which
+/// variable later uses of the name refer to.
+/// </summary>
+public static class AstOptimizer
+{
+    /// <summary>
+    /// Optimize the top-level statements of a program.
+    /// </summary>
+    public static List<Statement> Optimize(List<Statement> statements)
+    {
+        var result = new List<Statement>(statements.Count);
+        foreach (var stmt in statements)
+        {
+            result.Add(stmt switch
+            {
+                FunctionDefinition { IsDeferred: true } => stmt,
+                FunctionDefinition func => func with { Body = OptimizeStatement(func.Body) },
+                VariableDeclaration { Initializer: not null } decl =>
+                    decl with { Initializer = OptimizeExpression(decl.Initializer) },
+                _ => stmt
+            });
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Optimize one function body parsed on its own (a deferred body).
+    /// </summary>
+    public static Statement OptimizeBody(Statement body) => OptimizeStatement(body);
+
+    #region Statements
+
+    private static Statement OptimizeStatement(Statement stmt)
+    {
+        switch (stmt)
+        {
+            case BlockStatement block:
+                return block with { Statements = OptimizeBlock(block.Statements) };
+
+            case ExpressionStatement exprStmt:
+                return exprStmt with { Expression = OptimizeExpression(exprStmt.Expression) };
+
+            case VariableDeclaration { Initializer: not null } decl:
+                return decl with { Initializer = OptimizeExpression(decl.Initializer) };
+
+            case IfStatement ifStmt:
+            {
+                var condition = OptimizeExpression(ifStmt.Condition);
+                var thenBranch = OptimizeStatement(ifStmt.ThenBranch);
+                var elseBranch = ifStmt.ElseBranch != null ? OptimizeStatement(ifStmt.ElseBranch) : null;
+
+                if (TryGetTruth(condition, out var taken))
+                {
+                    var live = taken ? thenBranch : elseBranch;
+                    var dead = taken ? elseBranch : thenBranch;
+                    if (dead == null || !DeclaresLocal(dead))
+                    {
+                        return live ?? Empty(ifStmt);
+                    }
+                }
+                return ifStmt with { Condition = condition, ThenBranch = thenBranch, ElseBranch = elseBranch };
+            }
+
+            case WhileStatement whileStmt:
+            {
+                var condition = OptimizeExpression(whileStmt.Condition);
+                var body = OptimizeStatement(whileStmt.Body);
+                if (TryGetTruth(condition, out var runs) && !runs && !DeclaresLocal(body))
+                {
+                    return Empty(whileStmt);
+                }
+                return whileStmt with { Condition = condition, Body = body };
+            }
+
+            case ForStatement forStmt:
+            {
+                var init = forStmt.Init != null ? OptimizeExpression(forStmt.Init) : null;
+                var condition = forStmt.Condition != null ? OptimizeExpression(forStmt.Condition) : null;
+                var increment = forStmt.Increment != null ? OptimizeExpression(forStmt.Increment) : null;
+                var body = OptimizeStatement(forStmt.Body);
+                if (condition != null && TryGetTruth(condition, out var runs) && !runs && !DeclaresLocal(body))
+                {
+                    // Only the initializer ever runs
+                    return init != null
+                        ? new ExpressionStatement(init) { Line = forStmt.Line, Column = forStmt.Column }
+                        : Empty(forStmt);
+                }
+                return forStmt with { Init = init, Condition = condition, Increment = increment, Body = body };
+            }
+
+            case ForEachStatement foreachStmt:
+                return foreachStmt with
+                {
+                    Collection = OptimizeExpression(foreachStmt.Collection),
+                    Body = OptimizeStatement(foreachStmt.Body)
+                };
+
+            case SwitchStatement switchStmt:
+            {
+                var cases = new List<SwitchCase>(switchStmt.Cases.Count);
+                foreach (var switchCase in switchStmt.Cases)
+                {
+                    cases.Add(new SwitchCase(
+                        switchCase.Value != null ? OptimizeExpression(switchCase.Value) : null,
+                        OptimizeBlock(switchCase.Statements)));
+                }
+                return switchStmt with { Value = OptimizeExpression(switchStmt.Value), Cases = cases };
+            }
+
+            case ReturnStatement { Value: not null } ret:
+                return ret with { Value = OptimizeExpression(ret.Value) };
+
+            default:
+                return stmt;
+        }
+    }
+
+    /// <summary>
+    /// Optimize a statement list, dropping what follows a return, break or
+    /// continue (nothing in the same list can be reached after one).
+    /// </summary>
+    private static List<Statement> OptimizeBlock(List<Statement> statements)
+    {
+        var result = new List<Statement>(statements.Count);
+        for (int i = 0; i < statements.Count; i++)
+        {
+            var stmt = OptimizeStatement(statements[i]);
+            result.Add(stmt);
+
+            if (stmt is ReturnStatement or BreakStatement or ContinueStatement &&
+                !statements.Skip(i + 1).Any(DeclaresLocal))
+            {
+                break;
+            }
+        }
+        return result;
+    }
+
+    private static BlockStatement Empty(Statement replaced) =>
+        new(new List<Statement>()) { Line = replaced.Line, Column = replaced.Column };
+
+    /// <summary>
+    /// Whether a statement declares a local anywhere inside it.
+    /// </summary>
+    private static bool DeclaresLocal(Statement stmt)
+    {
+        return stmt switch
+        {
+            VariableDeclaration => true,
+            BlockStatement block => block.Statements.Any(DeclaresLocal),
+            IfStatement ifStmt => DeclaresLocal(ifStmt.ThenBranch) ||
+                                  (ifStmt.ElseBranch != null && DeclaresLocal(ifStmt.ElseBranch)),
+            WhileStatement whileStmt => DeclaresLocal(whileStmt.Body),
+            ForStatement forStmt => DeclaresLocal(forStmt.Body),
+            ForEachStatement => true, // the loop variable is declared on first use
+            SwitchStatement switchStmt => switchStmt.Cases.Any(c => c.Statements.Any(DeclaresLocal)),
+            _ => false
+        };
+    }
+
+    #endregion
+
+    #region Expressions
+
+    private static Expression OptimizeExpression(Expression expr)
+    {
+        switch (expr)
+        {
+            case GroupedExpression grouped:
+            {
+                var inner = OptimizeExpression(grouped.Inner);
+                return IsLiteral(inner) ? inner : grouped with { Inner = inner };
+            }
+
+            case BinaryOp bin:
+                return FoldBinary(bin with { Left = OptimizeExpression(bin.Left), Right = OptimizeExpression(bin.Right) });
+
+            case UnaryOp unary:
+            {
+                var operand = OptimizeExpression(unary.Operand);
+                var folded = FoldUnary(unary.Operator, operand);
+                return folded != null ? At(folded, expr) : unary with { Operand = operand };
+            }
+
+            case TernaryOp ternary:
+            {
+                var condition = OptimizeExpression(ternary.Condition);
+                var thenBranch = OptimizeExpression(ternary.ThenBranch);
+                var elseBranch = OptimizeExpression(ternary.ElseBranch);
+                if (TryGetTruth(condition, out var taken))
+                {
+                    return taken ? thenBranch : elseBranch;
+                }
+                return ternary with { Condition = condition, ThenBranch = thenBranch, ElseBranch = elseBranch };
+            }
+
+            case Assignment assign:
+                return assign with { Value = OptimizeExpression(assign.Value) };
+
+            case CompoundAssignment compound:
+                return compound with { Value = OptimizeExpression(compound.Value) };
+
+            case IndexAssignment indexAssign:
+                return indexAssign with
+                {
+                    Object = OptimizeExpression(indexAssign.Object),
+                    Index = OptimizeExpression(indexAssign.Index),
+                    Value = OptimizeExpression(indexAssign.Value)
+                };
+
+            case FunctionCall call:
+                return call with { Arguments = OptimizeList(call.Arguments) };
+
+            case ArrowCall arrow:
+                return arrow with { Target = OptimizeExpression(arrow.Target), Arguments = OptimizeList(arrow.Arguments) };
+
+            case ArrayLiteral array:
+                return array with { Elements = OptimizeList(array.Elements) };
+
+            case MappingLiteral map:
+                return map with
+                {
+                    Entries = map.Entries
+                        .Select(e => (OptimizeExpression(e.Key), OptimizeExpression(e.Value)))
+                        .ToList()
+                };
+
+            case IndexExpression index:
+                return index with { Target = OptimizeExpression(index.Target), Index = OptimizeExpression(index.Index) };
+
+            case RangeExpression range:
+                return range with
+                {
+                    Target = OptimizeExpression(range.Target),
+                    Start = range.Start != null ? OptimizeExpression(range.Start) : null,
+                    End = range.End != null ? OptimizeExpression(range.End) : null
+                };
+
+            case CatchExpression catchExpr:
+                return catchExpr with { Body = OptimizeExpression(catchExpr.Body) };
+
+            default:
+                return expr;
+        }
+    }
+
+    private static List<Expression> OptimizeList(List<Expression> expressions)
+    {
+        var result = new List<Expression>(expressions.Count);
+        foreach (var expr in expressions)
+        {
+            result.Add(OptimizeExpression(expr));
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Fold a binary operation whose operands are already optimized.
+    /// Mirrors ObjectInterpreter.BinaryOpValues for the literal cases.
+    /// </summary>
+    private static Expression FoldBinary(BinaryOp bin)
+    {
+        // A constant left side decides && and || without the right
+        if (bin.Operator is BinaryOperator.LogicalAnd or BinaryOperator.LogicalOr &&
+            TryGetTruth(bin.Left, out var leftTruth))
+        {
+            bool decided = bin.Operator == BinaryOperator.LogicalAnd ? !leftTruth : leftTruth;
+            if (decided)
+            {
+                return At(leftTruth ? 1L : 0L, bin);
+            }
+            if (TryGetTruth(bin.Right, out var rightTruth))
+            {
+                return At(rightTruth ? 1L : 0L, bin);
+            }
+            return bin;
+        }
+
+        object? folded = (bin.Left, bin.Right) switch
+        {
+            (NumberLiteral l, NumberLiteral r) => FoldInts(bin.Operator, l.Value, r.Value),
+            (StringLiteral l, StringLiteral r) => bin.Operator switch
+            {
+                BinaryOperator.Add => l.Value + r.Value,
+                BinaryOperator.Equal => string.Equals(l.Value, r.Value) ? 1L : 0L,
+                BinaryOperator.NotEqual => !string.Equals(l.Value, r.Value) ? 1L : 0L,
+                _ => null
+            },
+            (StringLiteral l, NumberLiteral r) => bin.Operator switch
+            {
+                BinaryOperator.Add => l.Value + r.Value.ToString(),
+                BinaryOperator.Equal => 0L,
+                BinaryOperator.NotEqual => 1L,
+                _ => null
+            },
+            (NumberLiteral, StringLiteral) => bin.Operator switch
+            {
+                BinaryOperator.Equal => 0L,
+                BinaryOperator.NotEqual => 1L,
+                _ => null
+            },
+            _ => null
+        };
+
+        return folded != null ? At(folded, bin) : bin;
+    }
+
+    private static object? FoldInts(BinaryOperator op, long l, long r)
+    {
+        return op switch
+        {
+            BinaryOperator.Add => l + r,
+            BinaryOperator.Subtract => l - r,
+            BinaryOperator.Multiply => l * r,
+            BinaryOperator.Divide when r != 0 && !(l == long.MinValue && r == -1) => l / r,
+            BinaryOperator.Modulo when r != 0 && !(l == long.MinValue && r == -1) => l % r,
+            BinaryOperator.Less => l < r ? 1L : 0L,
+            BinaryOperator.LessEqual => l <= r ? 1L : 0L,
+            BinaryOperator.Greater => l > r ? 1L : 0L,
+            BinaryOperator.GreaterEqual => l >= r ? 1L : 0L,
+            BinaryOperator.Equal => l == r ? 1L : 0L,
+            BinaryOperator.NotEqual => l != r ? 1L : 0L,
+            BinaryOperator.BitwiseAnd => l & r,
+            BinaryOperator.BitwiseOr => l | r,
+            BinaryOperator.BitwiseXor => l ^ r,
+            BinaryOperator.LeftShift => l << (int)r,
+            BinaryOperator.RightShift => l >> (int)r,
+            _ => null
+        };
+    }
+
+    private static object? FoldUnary(UnaryOperator op, Expression operand)
+    {
+        return (op, operand) switch
+        {
+            (UnaryOperator.Negate, NumberLiteral num) => -num.Value,
+            (UnaryOperator.BitwiseNot, NumberLiteral num) => ~num.Value,
+            (UnaryOperator.LogicalNot, _) when TryGetTruth(operand, out var truth) => truth ? 0L : 1L,
+            _ => null
+        };
+    }
+
+    #endregion
+
+    #region Helpers
+
+    private static bool IsLiteral(Expression expr) => expr is NumberLiteral or StringLiteral;
+
+    /// <summary>
+    /// The truth value of a literal, as ObjectInterpreter.IsTrue would see it.
+    /// </summary>
+    private static bool TryGetTruth(Expression expr, out bool truth)
+    {
+        switch (expr)
+        {
+            case NumberLiteral num:
+                truth = num.Value != 0;
+                return true;
+            case StringLiteral str:
+                truth = str.Value.Length > 0;
+                return true;
+            default:
+                truth = false;
+                return false;
+        }
+    }
+
+    /// <summary>
+    /// A literal for a folded value, placed where the expression it replaces was.
+    /// </summary>
+    private static Expression At(object value, Expression replaced)
+    {
+        return value switch
+        {
+            string s => new StringLiteral(s) { Line = replaced.Line, Column = replaced.Column },
+            long l => new NumberLiteral(l) { Line = replaced.Line, Column = replaced.Column },
+            _ => throw new ArgumentException($"Cannot make a literal from {value.GetType().Name}")
+        };
+    }
+
+    #endregion
+}
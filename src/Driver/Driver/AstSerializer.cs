@@ -0,0 +1,484 @@
+namespace Driver;
+
+/// <summary>
+/// Binary reader/writer for parsed programs, used by the on-disk program cache.
+/// Every node is written as a tag byte, its line and column, then its fields in
+/// constructor order. Bump FormatVersion whenever a node's shape (or the
+/// layout of a ProgramCache entry) changes so stale cache files are ignored
+/// rather than misread.
+/// </summary>
+public static class AstSerializer
+{
+    public const int FormatVersion = 4;
+
+    private enum Tag : byte
+    {
+        Null,
+
+        // Expressions
+        NumberLiteral,
+        StringLiteral,
+        BinaryOp,
+        UnaryOp,
+        GroupedExpression,
+        TernaryOp,
+        Identifier,
+        Assignment,
+        CompoundAssignment,
+        IndexAssignment,
+        FunctionCall,
+        ArrowCall,
+        ArrayLiteral,
+        MappingLiteral,
+        IndexExpression,
+        RangeExpression,
+        CatchExpression,
+
+        // Statements
+        BlockStatement,
+        ExpressionStatement,
+        IfStatement,
+        WhileStatement,
+        ForStatement,
+        SwitchStatement,
+        ForEachStatement,
+        BreakStatement,
+        ContinueStatement,
+        ReturnStatement,
+        InheritStatement,
+        VariableDeclaration,
+        FunctionDefinition,
+    }
+
+    public static void WriteStatements(BinaryWriter writer, List<Statement> statements)
+    {
+        writer.Write(statements.Count);
+        foreach (var stmt in statements)
+        {
+            WriteStatement(writer, stmt);
+        }
+    }
+
+    public static List<Statement> ReadStatements(BinaryReader reader)
+    {
+        int count = reader.ReadInt32();
+        var statements = new List<Statement>(count);
+        for (int i = 0; i < count; i++)
+        {
+            statements.Add(ReadStatement(reader)
+                ?? throw new InvalidDataException("Null statement in statement list"));
+        }
+        return statements;
+    }
+
+    // ========================================================================
+    // Writing
+    // ========================================================================
+
+    private static void WriteHeader(BinaryWriter writer, Tag tag, int line, int column)
+    {
+        writer.Write((byte)tag);
+        writer.Write(line);
+        writer.Write(column);
+    }
+
+    private static void WriteExpressions(BinaryWriter writer, List<Expression> expressions)
+    {
+        writer.Write(expressions.Count);
+        foreach (var expr in expressions)
+        {
+            WriteExpression(writer, expr);
+        }
+    }
+
+    private static void WriteExpression(BinaryWriter writer, Expression? expr)
+    {
+        if (expr == null)
+        {
+            writer.Write((byte)Tag.Null);
+            return;
+        }
+
+        switch (expr)
+        {
+            case NumberLiteral num:
+                WriteHeader(writer, Tag.NumberLiteral, expr.Line, expr.Column);
+                writer.Write(num.Value);
+                break;
+            case StringLiteral str:
+                WriteHeader(writer, Tag.StringLiteral, expr.Line, expr.Column);
+                writer.Write(str.Value);
+                break;
+            case BinaryOp bin:
+                WriteHeader(writer, Tag.BinaryOp, expr.Line, expr.Column);
+                WriteExpression(writer, bin.Left);
+                writer.Write((int)bin.Operator);
+                WriteExpression(writer, bin.Right);
+                break;
+            case UnaryOp unary:
+                WriteHeader(writer, Tag.UnaryOp, expr.Line, expr.Column);
+                writer.Write((int)unary.Operator);
+                WriteExpression(writer, unary.Operand);
+                writer.Write(unary.IsPrefix);
+                break;
+            case GroupedExpression grouped:
+                WriteHeader(writer, Tag.GroupedExpression, expr.Line, expr.Column);
+                WriteExpression(writer, grouped.Inner);
+                break;
+            case TernaryOp ternary:
+                WriteHeader(writer, Tag.TernaryOp, expr.Line, expr.Column);
+                WriteExpression(writer, ternary.Condition);
+                WriteExpression(writer, ternary.ThenBranch);
+                WriteExpression(writer, ternary.ElseBranch);
+                break;
+            case Identifier id:
+                WriteHeader(writer, Tag.Identifier, expr.Line, expr.Column);
+                writer.Write(id.Name);
+                break;
+            case Assignment assign:
+                WriteHeader(writer, Tag.Assignment, expr.Line, expr.Column);
+                writer.Write(assign.Name);
+                WriteExpression(writer, assign.Value);
+                break;
+            case CompoundAssignment compound:
+                WriteHeader(writer, Tag.CompoundAssignment, expr.Line, expr.Column);
+                writer.Write(compound.Name);
+                writer.Write((int)compound.Operator);
+                WriteExpression(writer, compound.Value);
+                break;
+            case IndexAssignment indexAssign:
+                WriteHeader(writer, Tag.IndexAssignment, expr.Line, expr.Column);
+                WriteExpression(writer, indexAssign.Object);
+                WriteExpression(writer, indexAssign.Index);
+                WriteExpression(writer, indexAssign.Value);
+                break;
+            case FunctionCall call:
+                WriteHeader(writer, Tag.FunctionCall, expr.Line, expr.Column);
+                writer.Write(call.Name);
+                WriteExpressions(writer, call.Arguments);
+                writer.Write(call.IsParentCall);
+                break;
+            case ArrowCall arrow:
+                WriteHeader(writer, Tag.ArrowCall, expr.Line, expr.Column);
+                WriteExpression(writer, arrow.Target);
+                writer.Write(arrow.FunctionName);
+                WriteExpressions(writer, arrow.Arguments);
+                break;
+            case ArrayLiteral array:
+                WriteHeader(writer, Tag.ArrayLiteral, expr.Line, expr.Column);
+                WriteExpressions(writer, array.Elements);
+                break;
+            case MappingLiteral mapping:
+                WriteHeader(writer, Tag.MappingLiteral, expr.Line, expr.Column);
+                writer.Write(mapping.Entries.Count);
+                foreach (var (key, value) in mapping.Entries)
+                {
+                    WriteExpression(writer, key);
+                    WriteExpression(writer, value);
+                }
+                break;
+            case IndexExpression index:
+                WriteHeader(writer, Tag.IndexExpression, expr.Line, expr.Column);
+                WriteExpression(writer, index.Target);
+                WriteExpression(writer, index.Index);
+                break;
+            case RangeExpression range:
+                WriteHeader(writer, Tag.RangeExpression, expr.Line, expr.Column);
+                WriteExpression(writer, range.Target);
+                WriteExpression(writer, range.Start);
+                WriteExpression(writer, range.End);
+                break;
+            case CatchExpression catchExpr:
+                WriteHeader(writer, Tag.CatchExpression, expr.Line, expr.Column);
+                WriteExpression(writer, catchExpr.Body);
+                break;
+            default:
+                throw new NotSupportedException($"Cannot serialize expression type {expr.GetType().Name}");
+        }
+    }
+
+    internal static void WriteStatement(BinaryWriter writer, Statement? stmt)
+    {
+        if (stmt == null)
+        {
+            writer.Write((byte)Tag.Null);
+            return;
+        }
+
+        switch (stmt)
+        {
+            case BlockStatement block:
+                WriteHeader(writer, Tag.BlockStatement, stmt.Line, stmt.Column);
+                WriteStatements(writer, block.Statements);
+                break;
+            case ExpressionStatement exprStmt:
+                WriteHeader(writer, Tag.ExpressionStatement, stmt.Line, stmt.Column);
+                WriteExpression(writer, exprStmt.Expression);
+                break;
+            case IfStatement ifStmt:
+                WriteHeader(writer, Tag.IfStatement, stmt.Line, stmt.Column);
+                WriteExpression(writer, ifStmt.Condition);
+                WriteStatement(writer, ifStmt.ThenBranch);
+                WriteStatement(writer, ifStmt.ElseBranch);
+                break;
+            case WhileStatement whileStmt:
+                WriteHeader(writer, Tag.WhileStatement, stmt.Line, stmt.Column);
+                WriteExpression(writer, whileStmt.Condition);
+                WriteStatement(writer, whileStmt.Body);
+                break;
+            case ForStatement forStmt:
+                WriteHeader(writer, Tag.ForStatement, stmt.Line, stmt.Column);
+                WriteExpression(writer, forStmt.Init);
+                WriteExpression(writer, forStmt.Condition);
+                WriteExpression(writer, forStmt.Increment);
+                WriteStatement(writer, forStmt.Body);
+                break;
+            case SwitchStatement switchStmt:
+                WriteHeader(writer, Tag.SwitchStatement, stmt.Line, stmt.Column);
+                WriteExpression(writer, switchStmt.Value);
+                writer.Write(switchStmt.Cases.Count);
+                foreach (var switchCase in switchStmt.Cases)
+                {
+                    WriteExpression(writer, switchCase.Value);
+                    WriteStatements(writer, switchCase.Statements);
+                }
+                break;
+            case ForEachStatement forEach:
+                WriteHeader(writer, Tag.ForEachStatement, stmt.Line, stmt.Column);
+                writer.Write(forEach.Variable);
+                WriteExpression(writer, forEach.Collection);
+                WriteStatement(writer, forEach.Body);
+                writer.Write(forEach.ValueVariable ?? "");
+                break;
+            case BreakStatement:
+                WriteHeader(writer, Tag.BreakStatement, stmt.Line, stmt.Column);
+                break;
+            case ContinueStatement:
+                WriteHeader(writer, Tag.ContinueStatement, stmt.Line, stmt.Column);
+                break;
+            case ReturnStatement ret:
+                WriteHeader(writer, Tag.ReturnStatement, stmt.Line, stmt.Column);
+                WriteExpression(writer, ret.Value);
+                break;
+            case InheritStatement inherit:
+                WriteHeader(writer, Tag.InheritStatement, stmt.Line, stmt.Column);
+                writer.Write(inherit.Path);
+                break;
+            case VariableDeclaration varDecl:
+                WriteHeader(writer, Tag.VariableDeclaration, stmt.Line, stmt.Column);
+                writer.Write(varDecl.Type);
+                writer.Write(varDecl.Name);
+                WriteExpression(writer, varDecl.Initializer);
+                break;
+            case FunctionDefinition func:
+                WriteHeader(writer, Tag.FunctionDefinition, stmt.Line, stmt.Column);
+                writer.Write(func.ReturnType);
+                writer.Write(func.Name);
+                writer.Write(func.Parameters.Count);
+                foreach (var param in func.Parameters)
+                {
+                    writer.Write(param);
+                }
+                WriteStatement(writer, func.Body);
+                writer.Write((int)func.Visibility);
+                writer.Write(func.Varargs);
+                writer.Write(func.ParameterTypes != null);
+                if (func.ParameterTypes != null)
+                {
+                    foreach (var type in func.ParameterTypes)
+                    {
+                        writer.Write(type);
+                    }
+                }
+                break;
+            default:
+                throw new NotSupportedException($"Cannot serialize statement type {stmt.GetType().Name}");
+        }
+    }
+
+    // ========================================================================
+    // Reading
+    // ========================================================================
+
+    private static List<Expression> ReadExpressions(BinaryReader reader)
+    {
+        int count = reader.ReadInt32();
+        var expressions = new List<Expression>(count);
+        for (int i = 0; i < count; i++)
+        {
+            expressions.Add(ReadRequiredExpression(reader));
+        }
+        return expressions;
+    }
+
+    private static Expression ReadRequiredExpression(BinaryReader reader)
+    {
+        return ReadExpression(reader) ?? throw new InvalidDataException("Unexpected null expression");
+    }
+
+    private static Statement ReadRequiredStatement(BinaryReader reader)
+    {
+        return ReadStatement(reader) ?? throw new InvalidDataException("Unexpected null statement");
+    }
+
+    private static Expression? ReadExpression(BinaryReader reader)
+    {
+        var tag = (Tag)reader.ReadByte();
+        if (tag == Tag.Null)
+        {
+            return null;
+        }
+
+        int line = reader.ReadInt32();
+        int column = reader.ReadInt32();
+
+        Expression expr = tag switch
+        {
+            Tag.NumberLiteral => new NumberLiteral(reader.ReadInt64()),
+            Tag.StringLiteral => new StringLiteral(StringPool.Intern(reader.ReadString())),
+            Tag.BinaryOp => new BinaryOp(
+                ReadRequiredExpression(reader),
+                (BinaryOperator)reader.ReadInt32(),
+                ReadRequiredExpression(reader)),
+            Tag.UnaryOp => new UnaryOp(
+                (UnaryOperator)reader.ReadInt32(),
+                ReadRequiredExpression(reader),
+                reader.ReadBoolean()),
+            Tag.GroupedExpression => new GroupedExpression(ReadRequiredExpression(reader)),
+            Tag.TernaryOp => new TernaryOp(
+                ReadRequiredExpression(reader),
+                ReadRequiredExpression(reader),
+                ReadRequiredExpression(reader)),
+            Tag.Identifier => new Identifier(reader.ReadString()),
+            Tag.Assignment => new Assignment(reader.ReadString(), ReadRequiredExpression(reader)),
+            Tag.CompoundAssignment => new CompoundAssignment(
+                reader.ReadString(),
+                (BinaryOperator)reader.ReadInt32(),
+                ReadRequiredExpression(reader)),
+            Tag.IndexAssignment => new IndexAssignment(
+                ReadRequiredExpression(reader),
+                ReadRequiredExpression(reader),
+                ReadRequiredExpression(reader)),
+            Tag.FunctionCall => new FunctionCall(
+                reader.ReadString(),
+                ReadExpressions(reader),
+                reader.ReadBoolean()),
+            Tag.ArrowCall => new ArrowCall(
+                ReadRequiredExpression(reader),
+                reader.ReadString(),
+                ReadExpressions(reader)),
+            Tag.ArrayLiteral => new ArrayLiteral(ReadExpressions(reader)),
+            Tag.MappingLiteral => ReadMappingLiteral(reader),
+            Tag.IndexExpression => new IndexExpression(
+                ReadRequiredExpression(reader),
+                ReadRequiredExpression(reader)),
+            Tag.RangeExpression => new RangeExpression(
+                ReadRequiredExpression(reader),
+                ReadExpression(reader),
+                ReadExpression(reader)),
+            Tag.CatchExpression => new CatchExpression(ReadRequiredExpression(reader)),
+            _ => throw new InvalidDataException($"Unexpected expression tag {tag}")
+        };
+
+        return expr with { Line = line, Column = column };
+    }
+
+    private static MappingLiteral ReadMappingLiteral(BinaryReader reader)
+    {
+        int count = reader.ReadInt32();
+        var entries = new List<(Expression Key, Expression Value)>(count);
+        for (int i = 0; i < count; i++)
+        {
+            var key = ReadRequiredExpression(reader);
+            var value = ReadRequiredExpression(reader);
+            entries.Add((key, value));
+        }
+        return new MappingLiteral(entries);
+    }
+
+    internal static Statement? ReadStatement(BinaryReader reader)
+    {
+        var tag = (Tag)reader.ReadByte();
+        if (tag == Tag.Null)
+        {
+            return null;
+        }
+
+        int line = reader.ReadInt32();
+        int column = reader.ReadInt32();
+
+        Statement stmt = tag switch
+        {
+            Tag.BlockStatement => new BlockStatement(ReadStatements(reader)),
+            Tag.ExpressionStatement => new ExpressionStatement(ReadRequiredExpression(reader)),
+            Tag.IfStatement => new IfStatement(
+                ReadRequiredExpression(reader),
+                ReadRequiredStatement(reader),
+                ReadStatement(reader)),
+            Tag.WhileStatement => new WhileStatement(
+                ReadRequiredExpression(reader),
+                ReadRequiredStatement(reader)),
+            Tag.ForStatement => new ForStatement(
+                ReadExpression(reader),
+                ReadExpression(reader),
+                ReadExpression(reader),
+                ReadRequiredStatement(reader)),
+            Tag.SwitchStatement => ReadSwitchStatement(reader),
+            Tag.ForEachStatement => new ForEachStatement(
+                reader.ReadString(),
+                ReadRequiredExpression(reader),
+                ReadRequiredStatement(reader),
+                reader.ReadString() is { Length: > 0 } valueVariable ? valueVariable : null),
+            Tag.BreakStatement => new BreakStatement(),
+            Tag.ContinueStatement => new ContinueStatement(),
+            Tag.ReturnStatement => new ReturnStatement(ReadExpression(reader)),
+            Tag.InheritStatement => new InheritStatement(reader.ReadString()),
+            Tag.VariableDeclaration => new VariableDeclaration(
+                reader.ReadString(),
+                reader.ReadString(),
+                ReadExpression(reader)),
+            Tag.FunctionDefinition => ReadFunctionDefinition(reader),
+            _ => throw new InvalidDataException($"Unexpected statement tag {tag}")
+        };
+
+        return stmt with { Line = line, Column = column };
+    }
+
+    private static SwitchStatement ReadSwitchStatement(BinaryReader reader)
+    {
+        var value = ReadRequiredExpression(reader);
+        int count = reader.ReadInt32();
+        var cases = new List<SwitchCase>(count);
+        for (int i = 0; i < count; i++)
+        {
+            var caseValue = ReadExpression(reader);
+            cases.Add(new SwitchCase(caseValue, ReadStatements(reader)));
+        }
+        return new SwitchStatement(value, cases);
+    }
+
+    private static FunctionDefinition ReadFunctionDefinition(BinaryReader reader)
+    {
+        var returnType = reader.ReadString();
+        var name = reader.ReadString();
+        int paramCount = reader.ReadInt32();
+        var parameters = new List<string>(paramCount);
+        for (int i = 0; i < paramCount; i++)
+        {
+            parameters.Add(reader.ReadString());
+        }
+        var body = ReadRequiredStatement(reader);
+        var visibility = (FunctionVisibility)reader.ReadInt32();
+        var varargs = reader.ReadBoolean();
+        List<string>? parameterTypes = null;
+        if (reader.ReadBoolean())
+        {
+            parameterTypes = new List<string>(paramCount);
+            for (int i = 0; i < paramCount; i++)
+            {
+                parameterTypes.Add(reader.ReadString());
+            }
+        }
+        return new FunctionDefinition(returnType, name, parameters, body, visibility, varargs, parameterTypes);
+    }
+}
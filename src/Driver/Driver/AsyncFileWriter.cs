@@ -0,0 +1,279 @@
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// Does mudlib file I/O on a background thread so a slow disk doesn't stall
+/// the game loop.
+///
+/// Jobs for one file run in the order they were queued. Writes still waiting
+/// are merged: an overwrite replaces anything queued before it, and appends
+/// are joined onto what precedes them, so a file rewritten every chat message
+/// hits the disk once per pass of the writer, not once per message. Each
+/// job's completion callback runs on the writer thread; efuns use it to
+/// schedule a call_out back into LPC.
+///
+/// Synchronous file efuns call Settle() on their path first, so they never
+/// see a file older than a queued write to it. Overwrites go through a temp
+/// file and a rename, so a crash never leaves a half-written save file.
+/// </summary>
+public sealed class AsyncFileWriter
+{
+    private enum JobKind { Overwrite, Append, Read }
+
+    private sealed record Job(JobKind Kind, string Text, Action<bool, string?>? Done, byte[]? Data = null);
+
+    /// <summary>
+    /// The writer the file efuns share.
+    /// </summary>
+    public static AsyncFileWriter Shared { get; } = new();
+
+    // What File.WriteAllText writes: UTF-8 without a byte order mark
+    private static readonly Encoding Utf8 = new UTF8Encoding(false);
+
+    private readonly object _lock = new();
+    private readonly Dictionary<string, List<Job>> _pending = new();
+    private readonly Queue<string> _ready = new();
+    private readonly HashSet<string> _inFlight = new();
+    private Thread? _thread;
+    private long _completed;
+    private long _failed;
+
+    /// <summary>
+    /// Jobs queued or running.
+    /// </summary>
+    public int PendingCount
+    {
+        get
+        {
+            lock (_lock)
+            {
+                return _pending.Values.Sum(jobs => jobs.Count) + _inFlight.Count;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Write passes completed, and those that failed.
+    /// </summary>
+    public long Completed => Interlocked.Read(ref _completed);
+    public long Failed => Interlocked.Read(ref _failed);
+
+    /// <summary>
+    /// Queue writing text to fullPath (appending if append), creating the
+    /// directory if needed. done(ok, null) runs on the writer thread.
+    /// </summary>
+    public void Write(string fullPath, string text, bool append, Action<bool>? done = null)
+    {
+        Enqueue(fullPath, new Job(append ? JobKind.Append : JobKind.Overwrite, text,
+            done == null ? null : (ok, _) => done(ok)));
+    }
+
+    /// <summary>
+    /// Queue replacing fullPath with data (a binary save, say).
+    /// </summary>
+    public void Write(string fullPath, byte[] data, Action<bool>? done = null)
+    {
+        Enqueue(fullPath, new Job(JobKind.Overwrite, "",
+            done == null ? null : (ok, _) => done(ok), data));
+    }
+
+    /// <summary>
+    /// Queue reading fullPath, after any writes queued before it. done runs on
+    /// the writer thread with the contents, or null if there is no such file.
+    /// </summary>
+    public void Read(string fullPath, Action<string?> done)
+    {
+        Enqueue(fullPath, new Job(JobKind.Read, "", (_, text) => done(text)));
+    }
+
+    private void Enqueue(string fullPath, Job job)
+    {
+        var key = Path.GetFullPath(fullPath);
+        lock (_lock)
+        {
+            if (!_pending.TryGetValue(key, out var jobs))
+            {
+                _pending[key] = jobs = new List<Job>();
+                if (!_inFlight.Contains(key))
+                {
+                    _ready.Enqueue(key);
+                }
+            }
+            jobs.Add(job);
+
+            if (_thread == null)
+            {
+                _thread = new Thread(WriterLoop) { Name = "FileWriter", IsBackground = true };
+                _thread.Start();
+            }
+            Monitor.PulseAll(_lock);
+        }
+    }
+
+    /// <summary>
+    /// Block until nothing is queued or running for fullPath, and, with
+    /// directory, for any file under it.
+    /// </summary>
+    public void Settle(string fullPath, bool directory = false)
+    {
+        var key = Path.GetFullPath(fullPath);
+        var prefix = key.TrimEnd(Path.DirectorySeparatorChar) + Path.DirectorySeparatorChar;
+
+        bool Busy(string path) => path == key || (directory && path.StartsWith(prefix, StringComparison.Ordinal));
+
+        lock (_lock)
+        {
+            while (_pending.Keys.Any(Busy) || _inFlight.Any(Busy))
+            {
+                Monitor.Wait(_lock);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Block until every queued job has run. Called at shutdown.
+    /// </summary>
+    public void Flush()
+    {
+        lock (_lock)
+        {
+            while (_pending.Count > 0 || _inFlight.Count > 0)
+            {
+                Monitor.Wait(_lock);
+            }
+        }
+    }
+
+    private void WriterLoop()
+    {
+        while (true)
+        {
+            string path;
+            List<Job> jobs;
+            lock (_lock)
+            {
+                while (_ready.Count == 0)
+                {
+                    Monitor.Wait(_lock);
+                }
+                path = _ready.Dequeue();
+                jobs = _pending[path];
+                _pending.Remove(path);
+                _inFlight.Add(path);
+            }
+
+            try
+            {
+                Run(path, jobs);
+            }
+            finally
+            {
+                lock (_lock)
+                {
+                    _inFlight.Remove(path);
+                    if (_pending.ContainsKey(path))
+                    {
+                        // More came in while this pass ran
+                        _ready.Enqueue(path);
+                    }
+                    Monitor.PulseAll(_lock);
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Run a file's jobs in order, each run of writes as one write.
+    /// </summary>
+    private void Run(string path, List<Job> jobs)
+    {
+        int i = 0;
+        while (i < jobs.Count)
+        {
+            if (jobs[i].Kind == JobKind.Read)
+            {
+                string? contents = null;
+                try
+                {
+                    contents = File.Exists(path) ? File.ReadAllText(path) : null;
+                }
+                catch (IOException ex)
+                {
+                    Logger.Warning($"Async read of {path} failed: {ex.Message}", LogCategory.System);
+                }
+                Complete(jobs[i], contents != null, contents);
+                i++;
+                continue;
+            }
+
+            // Fold consecutive writes: start from the last overwrite, add the appends after it
+            int end = i;
+            int lastOverwrite = -1;
+            while (end < jobs.Count && jobs[end].Kind != JobKind.Read)
+            {
+                if (jobs[end].Kind == JobKind.Overwrite) lastOverwrite = end;
+                end++;
+            }
+
+            int from = lastOverwrite >= 0 ? lastOverwrite : i;
+            var merged = jobs.Skip(from).Take(end - from).ToList();
+            byte[] data = merged.Count == 1 && merged[0].Data != null
+                ? merged[0].Data!
+                : merged.SelectMany(job => job.Data ?? Utf8.GetBytes(job.Text)).ToArray();
+            bool ok = WriteFile(path, data, append: lastOverwrite < 0);
+
+            for (int j = i; j < end; j++)
+            {
+                Complete(jobs[j], ok, null);
+            }
+            i = end;
+        }
+    }
+
+    private bool WriteFile(string path, byte[] data, bool append)
+    {
+        try
+        {
+            var dir = Path.GetDirectoryName(path);
+            if (!string.IsNullOrEmpty(dir) && !Directory.Exists(dir))
+            {
+                Directory.CreateDirectory(dir);
+            }
+
+            if (append)
+            {
+                using var stream = new FileStream(path, FileMode.Append, FileAccess.Write);
+                stream.Write(data);
+            }
+            else
+            {
+                // Write a temp file and rename it over the old one, so a crash
+                // mid-write leaves either the old file or the new one
+                var temp = path + ".tmp";
+                File.WriteAllBytes(temp, data);
+                File.Move(temp, path, overwrite: true);
+            }
+            Interlocked.Increment(ref _completed);
+            return true;
+        }
+        catch (Exception ex) when (ex is IOException or UnauthorizedAccessException)
+        {
+            Interlocked.Increment(ref _failed);
+            Logger.Warning($"Async write of {path} failed: {ex.Message}", LogCategory.System);
+            return false;
+        }
+    }
+
+    private static void Complete(Job job, bool ok, string? text)
+    {
+        try
+        {
+            job.Done?.Invoke(ok, text);
+        }
+        catch (Exception ex)
+        {
+            Logger.Warning($"File completion failed: {ex.Message}", LogCategory.System);
+        }
+    }
+}
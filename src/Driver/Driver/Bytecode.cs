@@ -0,0 +1,346 @@
+using System.Runtime.CompilerServices;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// Opcodes for the LPC stack VM.
+/// Each instruction has up to two integer operands (A, B) whose meaning depends on the opcode.
+/// Stack effects are noted as (pops -> pushes).
+/// </summary>
+public enum OpCode : byte
+{
+    // Constants and stack manipulation
+    PushConst,      // A = constant index               (0 -> 1)
+    Pop,            //                                   (1 -> 0)
+    Dup,            //                                   (1 -> 2)
+
+    // Locals and parameters (A = frame slot)
+    LoadLocal,      // B = 1: the slot stops owning an array or mapping AppendLocal built (0 -> 1)
+    StoreLocal,     // assign, leaves value on stack     (1 -> 1)
+    DeclareLocal,   // initialize a declared local       (1 -> 0)
+    IncDecLocal,    // B = UnaryOperator                 (0 -> 1)
+
+    // Object variables (A = name index)
+    LoadGlobal,     //                                   (0 -> 1)
+    StoreGlobal,    // assign, leaves value on stack     (1 -> 1)
+    IncDecGlobal,   // B = UnaryOperator                 (0 -> 1)
+
+    // Operators
+    Binary,         // A = BinaryOperator                (2 -> 1)
+    Compound,       // A = BinaryOperator (op= rules)    (2 -> 1)
+    AppendLocal,    // A = slot: local += value (B = 1) or local = local + value (B = 0),
+                    // growing an array or mapping the frame owns in place (1 -> 0)
+    Concat,         // A = operand count, a chain of +   (A -> 1)
+    Unary,          // A = UnaryOperator                 (1 -> 1)
+    ToBool,         // normalize to 1L/0L                (1 -> 1)
+
+    // Operators on operands declared int. A = BinaryOperator and B = 1 for
+    // op=, used when an operand turns out not to be an int  (2 -> 1)
+    AddInt,
+    SubtractInt,
+    LessInt,
+    LessEqualInt,
+    GreaterInt,
+    GreaterEqualInt,
+    EqualInt,
+    NotEqualInt,
+
+    // Control flow (A = target pc)
+    Jump,
+    JumpIfFalse,    //                                   (1 -> 0)
+    JumpIfTrue,     //                                   (1 -> 0)
+    Return,         //                                   (1 -> exit)
+
+    // Aggregates
+    MakeArray,      // A = element count                 (A -> 1)
+    MakeMapping,    // A = pair count                    (2A -> 1)
+    Index,          //                                   (2 -> 1)
+    Range,          // A = 1 if start given, B = 1 if end given
+    StoreIndex,     // target, index, value              (3 -> 1)
+
+    // Calls (A = name index, B = argument count)
+    Call,           // object function, then efun        (B -> 1)
+    CallEfun,       // efun bound at compile time, unless the object defines name (B -> 1)
+    CallParent,     // ::name()                          (B -> 1)
+    CallArrow,      // target->name(), inline cached     (B+1 -> 1)
+    CallOther,      // call_other(target, name, ...), inline cached (B -> 1)
+
+    // Compound statements
+    IterInit,       // collection -> iterator; A = 1: over a mapping's keys and values (1 -> 1)
+    IterInitRange,  // collection[start..end] -> iterator, A/B as for Range
+    IterNext,       // A = slot, B = exit pc; iterator stays on stack
+    IterValue,      // A = slot: the mapping value under IterNext's key (0 -> 0)
+    SwitchEq,       // ValuesEqual(a, b)                 (2 -> 1)
+    Switch,         // A = switch table; jump to the case, value stays (1 -> 1)
+    Catch,          // A = pc of matching CatchEnd       (0 -> 1)
+    CatchEnd,       // end of a catch() body             (1 -> exit)
+    Sscanf,         // A = target count                  (2 -> 1 results)
+    SscanfStoreLocal,  // A = slot, B = result index     (0 -> 0)
+    SscanfStoreGlobal, // A = name, B = result index     (0 -> 0)
+    SscanfStoreIndex, // B = result index                (2 -> 0)
+    SscanfEnd,      // results -> assigned count         (1 -> 1)
+    Throw,          // break/continue outside any loop: A = 0 break, 1 continue
+}
+
+/// <summary>
+/// A single VM instruction. Line is the source line used for error messages.
+/// </summary>
+public readonly record struct Instruction(OpCode Op, int A, int B, int Line);
+
+/// <summary>
+/// A compiled function translated to IL (see ObjectInterpreter.CompileJit).
+/// Takes the function's frame with the arguments in place and returns its value.
+/// </summary>
+public delegate LpcValue JitCode(ObjectInterpreter interpreter, CompiledFunction fn, LpcValue[] frame);
+
+/// <summary>
+/// Bytecode for one LPC function, produced by <see cref="BytecodeCompiler"/>.
+/// Shared by every object running the owning program, so it must stay immutable.
+/// </summary>
+public sealed class CompiledFunction
+{
+    /// <summary>
+    /// The function this bytecode was lowered from.
+    /// Used to make sure a call resolved to this exact definition (hot reload swaps programs).
+    /// </summary>
+    public FunctionDefinition Definition { get; }
+
+    public Instruction[] Code { get; }
+
+    /// <summary>
+    /// Literal values referenced by PushConst.
+    /// </summary>
+    public object[] Constants { get; }
+
+    /// <summary>
+    /// Constants as VM values, so PushConst doesn't convert.
+    /// </summary>
+    public LpcValue[] ConstantValues { get; }
+
+    /// <summary>
+    /// Variable and function names referenced by name operands.
+    /// </summary>
+    public string[] Names { get; }
+
+    /// <summary>
+    /// The efun slot of each entry of Names (-1 where the name is no efun),
+    /// for CallEfun.
+    /// </summary>
+    public int[] EfunSlots { get; }
+
+    /// <summary>
+    /// Names of the frame's local slots: parameters first, then declared locals.
+    /// </summary>
+    public string[] LocalNames { get; }
+
+    /// <summary>
+    /// Tables for Switch instructions: the case lookup, and the pc of each case
+    /// body followed by the pc to go to when nothing (not even default) matches.
+    /// </summary>
+    public (SwitchTable Table, int[] Targets)[] Switches { get; }
+
+    /// <summary>
+    /// Whether calls may be answered from the object's QueryMemo.
+    /// </summary>
+    public QueryMemoKind Memo { get; init; }
+
+    /// <summary>
+    /// Maximum operand stack depth, computed at compile time.
+    /// </summary>
+    public int MaxStack { get; }
+
+    /// <summary>
+    /// Slots needed for one call: locals followed by the operand stack.
+    /// </summary>
+    public int FrameSize => LocalNames.Length + MaxStack;
+
+    /// <summary>
+    /// Names resolved to variable slots, per object layout. A function defined in
+    /// an inherited program runs against each inheriting program's layout, so one
+    /// function can see several. Weak keys let layouts from reloaded programs go.
+    /// </summary>
+    private readonly ConditionalWeakTable<VariableLayout, int[]> _variableSlots = new();
+    private VariableSlots? _lastVariableSlots;
+
+    /// <summary>
+    /// A layout and its slots, swapped in as one reference so a thread never
+    /// sees one layout paired with another's slots.
+    /// </summary>
+    private sealed class VariableSlots(VariableLayout layout, int[] slots)
+    {
+        public readonly VariableLayout Layout = layout;
+        public readonly int[] Slots = slots;
+    }
+
+    /// <summary>
+    /// Inline caches for CallArrow/CallOther, indexed by pc and created on first use.
+    /// </summary>
+    private CallSiteCache?[]? _callSites;
+
+    /// <summary>
+    /// Calls counted towards tiering up, and whether the JIT has been tried.
+    /// </summary>
+    private int _calls;
+    private int _jitTried;
+
+    /// <summary>
+    /// This function as IL, once it has been called often enough and the JIT
+    /// could translate it. Shared like the bytecode.
+    /// </summary>
+    public JitCode? Jitted { get; internal set; }
+
+    /// <summary>
+    /// True once the function reached the JIT threshold, whether or not it could be jitted.
+    /// </summary>
+    public bool JitTried => Volatile.Read(ref _jitTried) != 0;
+
+    public CompiledFunction(FunctionDefinition definition, Instruction[] code, object[] constants,
+        string[] names, string[] localNames, int maxStack, (SwitchTable, int[])[]? switches = null)
+    {
+        Definition = definition;
+        Code = code;
+        Constants = constants;
+        ConstantValues = Array.ConvertAll(constants, LpcValue.FromObject);
+        Names = names;
+        EfunSlots = Array.ConvertAll(names, EfunRegistry.SlotOf);
+        LocalNames = localNames;
+        MaxStack = maxStack;
+        Switches = switches ?? Array.Empty<(SwitchTable, int[])>();
+    }
+
+    /// <summary>
+    /// Slot in layout for each entry of Names (-1 where the layout has no such
+    /// variable). The last layout seen is checked first, which covers the usual
+    /// case of one program's objects calling their own functions.
+    /// </summary>
+    public int[] GetVariableSlots(VariableLayout layout)
+    {
+        var last = Volatile.Read(ref _lastVariableSlots);
+        if (last != null && ReferenceEquals(last.Layout, layout))
+        {
+            return last.Slots;
+        }
+
+        var slots = _variableSlots.GetValue(layout, l => Array.ConvertAll(Names, l.IndexOf));
+        Volatile.Write(ref _lastVariableSlots, new VariableSlots(layout, slots));
+        return slots;
+    }
+
+    /// <summary>
+    /// Count a call. True exactly once, for the caller that should jit the
+    /// function: the first to reach threshold calls.
+    /// </summary>
+    internal bool CountCall(int threshold)
+    {
+        if (Volatile.Read(ref _jitTried) != 0) return false;
+        if (Interlocked.Increment(ref _calls) < threshold) return false;
+        return Interlocked.Exchange(ref _jitTried, 1) == 0;
+    }
+
+    /// <summary>
+    /// The inline cache for the call instruction at pc.
+    /// </summary>
+    public CallSiteCache GetCallSite(int pc)
+    {
+        var sites = _callSites ??= new CallSiteCache?[Code.Length];
+        return sites[pc] ??= new CallSiteCache();
+    }
+
+    /// <summary>
+    /// Human-readable listing of the bytecode (for debugging and tests).
+    /// </summary>
+    public string Disassemble()
+    {
+        var sb = new StringBuilder();
+        sb.AppendLine($"{Definition.Name}({string.Join(", ", Definition.Parameters)}) locals={LocalNames.Length} stack={MaxStack}"
+            + (Jitted != null ? " jit" : ""));
+        for (int pc = 0; pc < Code.Length; pc++)
+        {
+            var ins = Code[pc];
+            sb.Append($"  {pc,4}  {ins.Op,-16}");
+            switch (ins.Op)
+            {
+                case OpCode.PushConst:
+                    sb.Append(FormatConstant(Constants[ins.A]));
+                    break;
+                case OpCode.LoadLocal:
+                case OpCode.StoreLocal:
+                case OpCode.DeclareLocal:
+                    sb.Append($"{ins.A} ({LocalNames[ins.A]})");
+                    if (ins.Op == OpCode.LoadLocal && ins.B != 0) sb.Append(" release");
+                    break;
+                case OpCode.AppendLocal:
+                    sb.Append($"{ins.A} ({LocalNames[ins.A]}) {(ins.B != 0 ? "+=" : "= +")}");
+                    break;
+                case OpCode.LoadGlobal:
+                case OpCode.StoreGlobal:
+                    sb.Append(Names[ins.A]);
+                    break;
+                case OpCode.IncDecLocal:
+                    sb.Append($"{ins.A} ({LocalNames[ins.A]}) {(UnaryOperator)ins.B}");
+                    break;
+                case OpCode.IncDecGlobal:
+                    sb.Append($"{Names[ins.A]} {(UnaryOperator)ins.B}");
+                    break;
+                case OpCode.Binary:
+                case OpCode.Compound:
+                    sb.Append((BinaryOperator)ins.A);
+                    break;
+                case >= OpCode.AddInt and <= OpCode.NotEqualInt:
+                    sb.Append(ins.B != 0 ? "op=" : "");
+                    break;
+                case OpCode.Unary:
+                    sb.Append((UnaryOperator)ins.A);
+                    break;
+                case OpCode.Call:
+                case OpCode.CallEfun:
+                case OpCode.CallParent:
+                case OpCode.CallArrow:
+                case OpCode.CallOther:
+                    sb.Append($"{Names[ins.A]}/{ins.B}");
+                    break;
+                case OpCode.IterNext:
+                    sb.Append($"{ins.A} ({LocalNames[ins.A]}) -> {ins.B}");
+                    break;
+                case OpCode.IterValue:
+                    sb.Append($"{ins.A} ({LocalNames[ins.A]})");
+                    break;
+                case OpCode.SscanfStoreLocal:
+                    sb.Append($"{ins.A} ({LocalNames[ins.A]}) [{ins.B}]");
+                    break;
+                case OpCode.SscanfStoreGlobal:
+                    sb.Append($"{Names[ins.A]} [{ins.B}]");
+                    break;
+                case OpCode.Jump:
+                case OpCode.JumpIfFalse:
+                case OpCode.JumpIfTrue:
+                case OpCode.Catch:
+                case OpCode.MakeArray:
+                case OpCode.MakeMapping:
+                case OpCode.Concat:
+                case OpCode.Sscanf:
+                    sb.Append(ins.A);
+                    break;
+                case OpCode.Range:
+                case OpCode.IterInitRange:
+                    sb.Append($"{ins.A} {ins.B}");
+                    break;
+                case OpCode.Switch:
+                    sb.Append($"{ins.A} -> {string.Join(",", Switches[ins.A].Targets)}");
+                    break;
+                case OpCode.SscanfStoreIndex:
+                    sb.Append($"[{ins.B}]");
+                    break;
+            }
+            sb.AppendLine();
+        }
+        return sb.ToString();
+    }
+
+    private static string FormatConstant(object value) => value switch
+    {
+        string s => $"\"{s}\"",
+        _ => value.ToString() ?? ""
+    };
+}
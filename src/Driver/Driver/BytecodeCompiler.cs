@@ -0,0 +1,939 @@
+namespace Driver;
+
+/// <summary>
+/// Lowers a FunctionDefinition's AST into bytecode for the stack VM.
+/// Run once per function when a program is compiled (see ObjectManager.CompileProgram).
+///
+/// Functions that use a construct the compiler doesn't handle return null from
+/// <see cref="Compile"/>; those keep running on the tree-walking interpreter,
+/// so the VM never has to be complete to be correct.
+///
+/// Parameters and locals are resolved to frame slots here. Like the tree walker's
+/// per-call scope, locals are function-wide: a name refers to the local from its
+/// first declaration (in source order) onward, and to the object variable before that.
+///
+/// Declared types are used for one thing: an operator whose operands are both
+/// declared or literal ints compiles to an int-specialized opcode. LPC doesn't
+/// enforce declarations at run time, so those opcodes still check their
+/// operands and take the generic path when one isn't an int.
+/// </summary>
+public sealed class BytecodeCompiler
+{
+    private readonly List<Instruction> _code = new();
+    private readonly List<object> _constants = new();
+    private readonly Dictionary<object, int> _constantIndex = new();
+    private readonly List<string> _names = new();
+    private readonly Dictionary<string, int> _nameIndex = new();
+    private readonly List<(SwitchTable, int[])> _switches = new();
+
+    /// <summary>
+    /// Local slot assignments: parameters first, then locals as they are declared.
+    /// </summary>
+    private readonly List<string> _localNames = new();
+    private readonly Dictionary<string, int> _localSlots = new();
+
+    /// <summary>
+    /// Declared type of each local, from its first declaration ("mixed" if untyped).
+    /// </summary>
+    private readonly Dictionary<string, string> _localTypes = new();
+
+    /// <summary>
+    /// Locals that AppendLocal builds into, and for every local the loads
+    /// emitted so far that hand its value on. Those loads release the array
+    /// or mapping the slot owns; they are patched to when a local first
+    /// becomes an append target.
+    /// </summary>
+    private readonly HashSet<int> _appendSlots = new();
+    private readonly Dictionary<int, List<int>> _releasingLoads = new();
+
+    /// <summary>
+    /// Object variables visible to the function (own and inherited), or null if unknown.
+    /// Only consulted for sscanf(), which creates a local when a target names neither.
+    /// </summary>
+    private readonly ISet<string>? _objectVariables;
+
+    /// <summary>
+    /// Declared types of the object variables, or null if unknown.
+    /// </summary>
+    private readonly IReadOnlyDictionary<string, string>? _variableTypes;
+
+    /// <summary>
+    /// Current and maximum operand stack depth, tracked as instructions are emitted.
+    /// </summary>
+    private int _depth;
+    private int _maxDepth;
+
+    /// <summary>
+    /// Enclosing loops and switches, innermost on top.
+    /// </summary>
+    private readonly Stack<JumpScope> _scopes = new();
+
+    private sealed class JumpScope
+    {
+        public bool IsLoop { get; init; }
+        public int BreakDepth { get; init; }
+        public int ContinueDepth { get; init; }
+        public List<int> BreakJumps { get; } = new();
+        public List<int> ContinueJumps { get; } = new();
+    }
+
+    /// <summary>
+    /// Thrown internally when a construct has no bytecode lowering.
+    /// </summary>
+    private sealed class UnsupportedConstructException : Exception
+    {
+        public UnsupportedConstructException(string message) : base(message) { }
+    }
+
+    private BytecodeCompiler(ISet<string>? objectVariables, IReadOnlyDictionary<string, string>? variableTypes)
+    {
+        _objectVariables = objectVariables;
+        _variableTypes = variableTypes;
+    }
+
+    /// <summary>
+    /// Compile a function body to bytecode.
+    /// Returns null if the function contains something the VM can't run.
+    /// </summary>
+    /// <param name="function">Function to compile</param>
+    /// <param name="objectVariables">All variable names of the owning program, including inherited ones</param>
+    /// <param name="variableTypes">Declared types of those variables</param>
+    public static CompiledFunction? Compile(FunctionDefinition function, ISet<string>? objectVariables = null,
+        IReadOnlyDictionary<string, string>? variableTypes = null)
+    {
+        var compiler = new BytecodeCompiler(objectVariables, variableTypes);
+        for (int i = 0; i < function.Parameters.Count; i++)
+        {
+            compiler.DeclareSlot(function.Parameters[i], function.ParameterTypes?[i] ?? "mixed");
+        }
+
+        // A deferred body is parsed for this and not kept
+        var body = function.ReadBody();
+        try
+        {
+            compiler.CompileStatement(body);
+
+            // Falling off the end returns 0
+            compiler.EmitConst(0L, body.Line);
+            compiler.Emit(OpCode.Return, 0, 0, body.Line, -1);
+        }
+        catch (UnsupportedConstructException ex)
+        {
+            Logger.Debug($"Function {function.Name}() left on tree walker: {ex.Message}", LogCategory.Object);
+            return null;
+        }
+
+        return new CompiledFunction(
+            function,
+            compiler._code.ToArray(),
+            compiler._constants.ToArray(),
+            compiler._names.ToArray(),
+            compiler._localNames.ToArray(),
+            compiler._maxDepth,
+            compiler._switches.ToArray())
+        {
+            Memo = QueryMemo.Classify(function, body)
+        };
+    }
+
+    #region Emission
+
+    private int Emit(OpCode op, int a, int b, int line, int stackEffect)
+    {
+        _code.Add(new Instruction(op, a, b, line));
+        _depth += stackEffect;
+        if (_depth > _maxDepth) _maxDepth = _depth;
+        return _code.Count - 1;
+    }
+
+    private void EmitConst(object value, int line)
+    {
+        if (!_constantIndex.TryGetValue(value, out var index))
+        {
+            index = _constants.Count;
+            _constants.Add(value);
+            _constantIndex[value] = index;
+        }
+        Emit(OpCode.PushConst, index, 0, line, 1);
+    }
+
+    private int Name(string name)
+    {
+        if (!_nameIndex.TryGetValue(name, out var index))
+        {
+            index = _names.Count;
+            _names.Add(name);
+            _nameIndex[name] = index;
+        }
+        return index;
+    }
+
+    private int Here => _code.Count;
+
+    /// <summary>
+    /// Get the slot for a local, allocating one the first time a name is declared.
+    /// </summary>
+    private int DeclareSlot(string name, string type = "mixed")
+    {
+        if (!_localSlots.TryGetValue(name, out var slot))
+        {
+            slot = _localNames.Count;
+            _localNames.Add(name);
+            _localSlots[name] = slot;
+            _localTypes[name] = type;
+        }
+        return slot;
+    }
+
+    /// <summary>
+    /// Whether name, as resolved at this point, is a variable declared int.
+    /// </summary>
+    private bool IsIntVariable(string name)
+    {
+        if (_localTypes.TryGetValue(name, out var type)) return type == "int";
+        return _variableTypes != null && _variableTypes.TryGetValue(name, out type) && type == "int";
+    }
+
+    /// <summary>
+    /// Whether expr is known from declarations to produce an int (when the
+    /// declarations are honoured). Comparisons and logical operators always do.
+    /// </summary>
+    private bool IsInt(Expression expr)
+    {
+        switch (expr)
+        {
+            case NumberLiteral:
+                return true;
+            case GroupedExpression grouped:
+                return IsInt(grouped.Inner);
+            case Identifier id:
+                return IsIntVariable(id.Name);
+            case Assignment assign:
+                return IsIntVariable(assign.Name) && IsInt(assign.Value);
+            case BinaryOp bin:
+                return bin.Operator switch
+                {
+                    BinaryOperator.Less or BinaryOperator.LessEqual or BinaryOperator.Greater
+                        or BinaryOperator.GreaterEqual or BinaryOperator.Equal or BinaryOperator.NotEqual
+                        or BinaryOperator.LogicalAnd or BinaryOperator.LogicalOr => true,
+                    _ => IsInt(bin.Left) && IsInt(bin.Right)
+                };
+            case UnaryOp unary:
+                return unary.Operator switch
+                {
+                    UnaryOperator.LogicalNot => true,
+                    UnaryOperator.Negate or UnaryOperator.BitwiseNot => IsInt(unary.Operand),
+                    _ => true // ++/-- always leave an int
+                };
+            default:
+                return false;
+        }
+    }
+
+    /// <summary>
+    /// The int-specialized opcode for op, if there is one.
+    /// </summary>
+    private static OpCode? IntOpCode(BinaryOperator op) => op switch
+    {
+        BinaryOperator.Add => OpCode.AddInt,
+        BinaryOperator.Subtract => OpCode.SubtractInt,
+        BinaryOperator.Less => OpCode.LessInt,
+        BinaryOperator.LessEqual => OpCode.LessEqualInt,
+        BinaryOperator.Greater => OpCode.GreaterInt,
+        BinaryOperator.GreaterEqual => OpCode.GreaterEqualInt,
+        BinaryOperator.Equal => OpCode.EqualInt,
+        BinaryOperator.NotEqual => OpCode.NotEqualInt,
+        _ => null
+    };
+
+    /// <param name="borrow">The value is only read here (indexed or sliced), not handed on</param>
+    private void EmitLoad(string name, int line, bool borrow = false)
+    {
+        if (_localSlots.TryGetValue(name, out var slot))
+        {
+            int pc = Emit(OpCode.LoadLocal, slot, !borrow && _appendSlots.Contains(slot) ? 1 : 0, line, 1);
+            if (!borrow)
+            {
+                if (!_releasingLoads.TryGetValue(slot, out var loads))
+                {
+                    _releasingLoads[slot] = loads = new List<int>();
+                }
+                loads.Add(pc);
+            }
+        }
+        else
+        {
+            Emit(OpCode.LoadGlobal, Name(name), 0, line, 1);
+        }
+    }
+
+    private void EmitStore(string name, int line)
+    {
+        if (_localSlots.TryGetValue(name, out var slot))
+        {
+            Emit(OpCode.StoreLocal, slot, 0, line, 0);
+        }
+        else
+        {
+            Emit(OpCode.StoreGlobal, Name(name), 0, line, 0);
+        }
+    }
+
+    /// <summary>
+    /// Point a previously emitted jump at the current position.
+    /// </summary>
+    private void PatchToHere(int jumpIndex)
+    {
+        var ins = _code[jumpIndex];
+        _code[jumpIndex] = ins with { A = Here };
+    }
+
+    /// <summary>
+    /// Pop down to a target stack depth and jump, without disturbing the tracked
+    /// depth of the (unreachable) code that follows.
+    /// </summary>
+    private int EmitScopeExit(int targetDepth, int line)
+    {
+        int savedDepth = _depth;
+        for (int d = _depth; d > targetDepth; d--)
+        {
+            Emit(OpCode.Pop, 0, 0, line, -1);
+        }
+        int jump = Emit(OpCode.Jump, -1, 0, line, 0);
+        _depth = savedDepth;
+        return jump;
+    }
+
+    #endregion
+
+    #region Statements
+
+    private void CompileStatement(Statement stmt)
+    {
+        switch (stmt)
+        {
+            case BlockStatement block:
+                foreach (var s in block.Statements)
+                {
+                    CompileStatement(s);
+                }
+                break;
+
+            case ExpressionStatement exprStmt:
+                CompileDiscarded(exprStmt.Expression, stmt.Line);
+                break;
+
+            case VariableDeclaration varDecl:
+                if (varDecl.Initializer != null)
+                {
+                    CompileExpression(varDecl.Initializer);
+                }
+                else
+                {
+                    EmitConst(varDecl.Type == "string" ? "" : 0L, stmt.Line);
+                }
+                Emit(OpCode.DeclareLocal, DeclareSlot(varDecl.Name, varDecl.Type), 0, stmt.Line, -1);
+                break;
+
+            case IfStatement ifStmt:
+                CompileIf(ifStmt);
+                break;
+
+            case WhileStatement whileStmt:
+                CompileWhile(whileStmt);
+                break;
+
+            case ForStatement forStmt:
+                CompileFor(forStmt);
+                break;
+
+            case ForEachStatement foreachStmt:
+                CompileForeach(foreachStmt);
+                break;
+
+            case SwitchStatement switchStmt:
+                CompileSwitch(switchStmt);
+                break;
+
+            case ReturnStatement ret:
+                if (ret.Value != null)
+                {
+                    CompileExpression(ret.Value);
+                }
+                else
+                {
+                    // Matches the tree walker: a bare return yields int 0
+                    EmitConst(0, stmt.Line);
+                }
+                Emit(OpCode.Return, 0, 0, stmt.Line, -1);
+                break;
+
+            case BreakStatement:
+                CompileBreak(stmt.Line);
+                break;
+
+            case ContinueStatement:
+                CompileContinue(stmt.Line);
+                break;
+
+            default:
+                throw new UnsupportedConstructException($"statement {stmt.GetType().Name}");
+        }
+    }
+
+    private void CompileIf(IfStatement stmt)
+    {
+        CompileExpression(stmt.Condition);
+        int jumpElse = Emit(OpCode.JumpIfFalse, -1, 0, stmt.Line, -1);
+        CompileStatement(stmt.ThenBranch);
+
+        if (stmt.ElseBranch != null)
+        {
+            int jumpEnd = Emit(OpCode.Jump, -1, 0, stmt.Line, 0);
+            PatchToHere(jumpElse);
+            CompileStatement(stmt.ElseBranch);
+            PatchToHere(jumpEnd);
+        }
+        else
+        {
+            PatchToHere(jumpElse);
+        }
+    }
+
+    private void CompileWhile(WhileStatement stmt)
+    {
+        var scope = new JumpScope { IsLoop = true, BreakDepth = _depth, ContinueDepth = _depth };
+        int top = Here;
+        CompileExpression(stmt.Condition);
+        int exit = Emit(OpCode.JumpIfFalse, -1, 0, stmt.Line, -1);
+
+        _scopes.Push(scope);
+        CompileStatement(stmt.Body);
+        _scopes.Pop();
+
+        Emit(OpCode.Jump, top, 0, stmt.Line, 0);
+        PatchToHere(exit);
+        foreach (var j in scope.BreakJumps) PatchToHere(j);
+        foreach (var j in scope.ContinueJumps) _code[j] = _code[j] with { A = top };
+    }
+
+    private void CompileFor(ForStatement stmt)
+    {
+        if (stmt.Init != null)
+        {
+            CompileExpression(stmt.Init);
+            Emit(OpCode.Pop, 0, 0, stmt.Line, -1);
+        }
+
+        var scope = new JumpScope { IsLoop = true, BreakDepth = _depth, ContinueDepth = _depth };
+        int top = Here;
+        int exit = -1;
+        if (stmt.Condition != null)
+        {
+            CompileExpression(stmt.Condition);
+            exit = Emit(OpCode.JumpIfFalse, -1, 0, stmt.Line, -1);
+        }
+
+        _scopes.Push(scope);
+        CompileStatement(stmt.Body);
+        _scopes.Pop();
+
+        // continue falls through to the increment
+        foreach (var j in scope.ContinueJumps) PatchToHere(j);
+        if (stmt.Increment != null)
+        {
+            CompileDiscarded(stmt.Increment, stmt.Line);
+        }
+        Emit(OpCode.Jump, top, 0, stmt.Line, 0);
+
+        if (exit >= 0) PatchToHere(exit);
+        foreach (var j in scope.BreakJumps) PatchToHere(j);
+    }
+
+    private void CompileForeach(ForEachStatement stmt)
+    {
+        if (stmt.Collection is RangeExpression range && stmt.ValueVariable == null)
+        {
+            // Walk the range in place instead of copying it out
+            CompileExpression(range.Target);
+            if (range.Start != null) CompileExpression(range.Start);
+            if (range.End != null) CompileExpression(range.End);
+            int operands = (range.Start != null ? 1 : 0) + (range.End != null ? 1 : 0);
+            Emit(OpCode.IterInitRange, range.Start != null ? 1 : 0, range.End != null ? 1 : 0, stmt.Line, -operands);
+        }
+        else
+        {
+            CompileExpression(stmt.Collection);
+            Emit(OpCode.IterInit, stmt.ValueVariable != null ? 1 : 0, 0, stmt.Line, 0);
+        }
+
+        // The iterator stays on the stack for the whole loop
+        var scope = new JumpScope { IsLoop = true, BreakDepth = _depth, ContinueDepth = _depth };
+        int top = Here;
+        // The loop variable is always a local, even if an object variable has the same name
+        int next = Emit(OpCode.IterNext, DeclareSlot(stmt.Variable), -1, stmt.Line, 0);
+        if (stmt.ValueVariable != null)
+        {
+            Emit(OpCode.IterValue, DeclareSlot(stmt.ValueVariable), 0, stmt.Line, 0);
+        }
+
+        _scopes.Push(scope);
+        CompileStatement(stmt.Body);
+        _scopes.Pop();
+
+        Emit(OpCode.Jump, top, 0, stmt.Line, 0);
+
+        // Exhausted iterator and break both land here, with the iterator still on the stack
+        _code[next] = _code[next] with { B = Here };
+        foreach (var j in scope.BreakJumps) PatchToHere(j);
+        foreach (var j in scope.ContinueJumps) _code[j] = _code[j] with { A = top };
+        Emit(OpCode.Pop, 0, 0, stmt.Line, -1);
+    }
+
+    private void CompileSwitch(SwitchStatement stmt)
+    {
+        CompileExpression(stmt.Value);
+
+        var table = stmt.GetTable();
+        if (table != null)
+        {
+            CompileTableSwitch(stmt, table);
+            return;
+        }
+
+        // Compare against each case in order; first match jumps into the bodies.
+        var caseJumps = new int[stmt.Cases.Count];
+        int defaultIndex = -1;
+        for (int i = 0; i < stmt.Cases.Count; i++)
+        {
+            var switchCase = stmt.Cases[i];
+            if (switchCase.Value == null)
+            {
+                defaultIndex = i;
+                caseJumps[i] = -1;
+                continue;
+            }
+
+            Emit(OpCode.Dup, 0, 0, stmt.Line, 1);
+            CompileExpression(switchCase.Value);
+            Emit(OpCode.SwitchEq, 0, 0, stmt.Line, -1);
+            caseJumps[i] = Emit(OpCode.JumpIfTrue, -1, 0, stmt.Line, -1);
+        }
+        int noMatch = Emit(OpCode.Jump, -1, 0, stmt.Line, 0);
+
+        // Case bodies are laid out in source order so execution falls through
+        var scope = new JumpScope { IsLoop = false, BreakDepth = _depth };
+        _scopes.Push(scope);
+        for (int i = 0; i < stmt.Cases.Count; i++)
+        {
+            if (caseJumps[i] >= 0)
+            {
+                PatchToHere(caseJumps[i]);
+            }
+            if (i == defaultIndex)
+            {
+                PatchToHere(noMatch);
+            }
+            foreach (var s in stmt.Cases[i].Statements)
+            {
+                CompileStatement(s);
+            }
+        }
+        _scopes.Pop();
+
+        if (defaultIndex < 0)
+        {
+            PatchToHere(noMatch);
+        }
+        foreach (var j in scope.BreakJumps) PatchToHere(j);
+        Emit(OpCode.Pop, 0, 0, stmt.Line, -1);
+    }
+
+    /// <summary>
+    /// A switch with literal labels: one Switch instruction looks the value up
+    /// in the statement's table and jumps straight to the case body.
+    /// </summary>
+    private void CompileTableSwitch(SwitchStatement stmt, SwitchTable table)
+    {
+        var targets = new int[stmt.Cases.Count + 1];
+        _switches.Add((table, targets));
+        Emit(OpCode.Switch, _switches.Count - 1, 0, stmt.Line, 0);
+
+        var scope = new JumpScope { IsLoop = false, BreakDepth = _depth };
+        _scopes.Push(scope);
+        for (int i = 0; i < stmt.Cases.Count; i++)
+        {
+            targets[i] = Here;
+            foreach (var s in stmt.Cases[i].Statements)
+            {
+                CompileStatement(s);
+            }
+        }
+        _scopes.Pop();
+
+        targets[^1] = Here;
+        foreach (var j in scope.BreakJumps) PatchToHere(j);
+        Emit(OpCode.Pop, 0, 0, stmt.Line, -1);
+    }
+
+    private void CompileBreak(int line)
+    {
+        if (_scopes.Count == 0)
+        {
+            // Outside any loop this is a runtime error, as in the tree walker
+            Emit(OpCode.Throw, 0, 0, line, 0);
+            return;
+        }
+
+        var scope = _scopes.Peek();
+        scope.BreakJumps.Add(EmitScopeExit(scope.BreakDepth, line));
+    }
+
+    private void CompileContinue(int line)
+    {
+        var scope = _scopes.FirstOrDefault(s => s.IsLoop);
+        if (scope == null)
+        {
+            Emit(OpCode.Throw, 1, 0, line, 0);
+            return;
+        }
+
+        scope.ContinueJumps.Add(EmitScopeExit(scope.ContinueDepth, line));
+    }
+
+    #endregion
+
+    #region Expressions
+
+    private void CompileExpression(Expression expr)
+    {
+        int line = expr.Line;
+        switch (expr)
+        {
+            case NumberLiteral num:
+                EmitConst(num.Value, line);
+                break;
+
+            case StringLiteral str:
+                EmitConst(str.Value, line);
+                break;
+
+            case GroupedExpression grouped:
+                CompileExpression(grouped.Inner);
+                break;
+
+            case Identifier id:
+                EmitLoad(id.Name, line);
+                break;
+
+            case Assignment assign:
+                CompileExpression(assign.Value);
+                EmitStore(assign.Name, line);
+                break;
+
+            case CompoundAssignment compound:
+                // The current value is read before the right side is evaluated
+                EmitLoad(compound.Name, line);
+                CompileExpression(compound.Value);
+                if (IntOpCode(compound.Operator) is { } compoundOp &&
+                    IsIntVariable(compound.Name) && IsInt(compound.Value))
+                {
+                    // B = 1: a non-int operand takes the op= rules, not the operator's
+                    Emit(compoundOp, (int)compound.Operator, 1, line, -1);
+                }
+                else
+                {
+                    Emit(OpCode.Compound, (int)compound.Operator, 0, line, -1);
+                }
+                EmitStore(compound.Name, line);
+                break;
+
+            case IndexAssignment indexAssign:
+                CompileExpression(indexAssign.Object);
+                CompileExpression(indexAssign.Index);
+                CompileExpression(indexAssign.Value);
+                Emit(OpCode.StoreIndex, 0, 0, line, -2);
+                break;
+
+            case BinaryOp bin:
+                CompileBinary(bin);
+                break;
+
+            case UnaryOp unary:
+                CompileUnary(unary);
+                break;
+
+            case TernaryOp ternary:
+                CompileExpression(ternary.Condition);
+                int jumpElse = Emit(OpCode.JumpIfFalse, -1, 0, line, -1);
+                CompileExpression(ternary.ThenBranch);
+                int jumpEnd = Emit(OpCode.Jump, -1, 0, line, 0);
+                _depth--; // only one branch's value is ever on the stack
+                PatchToHere(jumpElse);
+                CompileExpression(ternary.ElseBranch);
+                PatchToHere(jumpEnd);
+                break;
+
+            case ArrayLiteral arr:
+                foreach (var element in arr.Elements)
+                {
+                    CompileExpression(element);
+                }
+                Emit(OpCode.MakeArray, arr.Elements.Count, 0, line, 1 - arr.Elements.Count);
+                break;
+
+            case MappingLiteral map:
+                foreach (var (key, value) in map.Entries)
+                {
+                    CompileExpression(key);
+                    CompileExpression(value);
+                }
+                Emit(OpCode.MakeMapping, map.Entries.Count, 0, line, 1 - 2 * map.Entries.Count);
+                break;
+
+            case IndexExpression idx:
+                CompileBorrowed(idx.Target);
+                CompileExpression(idx.Index);
+                Emit(OpCode.Index, 0, 0, line, -1);
+                break;
+
+            case RangeExpression range:
+                CompileBorrowed(range.Target);
+                if (range.Start != null) CompileExpression(range.Start);
+                if (range.End != null) CompileExpression(range.End);
+                int operands = (range.Start != null ? 1 : 0) + (range.End != null ? 1 : 0);
+                Emit(OpCode.Range, range.Start != null ? 1 : 0, range.End != null ? 1 : 0, line, -operands);
+                break;
+
+            case FunctionCall call when call.Name == "sscanf" && !call.IsParentCall:
+                CompileSscanf(call);
+                break;
+
+            case FunctionCall call:
+                foreach (var arg in call.Arguments)
+                {
+                    CompileExpression(arg);
+                }
+                if (call.Name == "sprintf" && call.Arguments.Count > 0 && call.Arguments[0] is StringLiteral format)
+                {
+                    // Parse the format now, keyed on the constant the call will pass
+                    SprintfFormat.Precompile((string)_constants[_constantIndex[format.Value]]);
+                }
+                var callOp = call.IsParentCall ? OpCode.CallParent
+                    : call.Name == "call_other" ? OpCode.CallOther
+                    : EfunRegistry.SlotOf(call.Name) >= 0 ? OpCode.CallEfun
+                    : OpCode.Call;
+                Emit(callOp, Name(call.Name), call.Arguments.Count, line, 1 - call.Arguments.Count);
+                break;
+
+            case ArrowCall arrow:
+                CompileExpression(arrow.Target);
+                foreach (var arg in arrow.Arguments)
+                {
+                    CompileExpression(arg);
+                }
+                Emit(OpCode.CallArrow, Name(arrow.FunctionName), arrow.Arguments.Count, line, -arrow.Arguments.Count);
+                break;
+
+            case CatchExpression catchExpr:
+                // The body runs as a nested VM invocation that stops at CatchEnd;
+                // the Catch handler then pushes 0 or the error message.
+                int catchStart = Emit(OpCode.Catch, -1, 0, line, 0);
+                CompileExpression(catchExpr.Body);
+                int catchEnd = Emit(OpCode.CatchEnd, 0, 0, line, 0);
+                _code[catchStart] = _code[catchStart] with { A = catchEnd };
+                break;
+
+            default:
+                throw new UnsupportedConstructException($"expression {expr.GetType().Name}");
+        }
+    }
+
+    /// <summary>
+    /// Compile an expression whose value isn't used: a self-append to a local
+    /// becomes AppendLocal, anything else is evaluated and popped.
+    /// </summary>
+    private void CompileDiscarded(Expression expr, int line)
+    {
+        var append = expr switch
+        {
+            CompoundAssignment { Operator: BinaryOperator.Add } compound => (compound.Name, compound.Value, Compound: true),
+            Assignment { Value: BinaryOp { Operator: BinaryOperator.Add, Left: Identifier self } add } assign
+                when self.Name == assign.Name => (assign.Name, add.Right, Compound: false),
+            _ => default((string Name, Expression Value, bool Compound)?)
+        };
+
+        // Only locals: any code can read an object variable, so it is never unshared.
+        // Declared ints and strings gain nothing, and the right side must not assign the local.
+        if (append is { } target && _localSlots.TryGetValue(target.Name, out var slot) &&
+            _localTypes[target.Name] is not ("int" or "string") &&
+            !ExpressionTree.Any(target.Value, node => node is Assignment a && a.Name == target.Name ||
+                                                      node is CompoundAssignment c && c.Name == target.Name))
+        {
+            CompileExpression(target.Value);
+            Emit(OpCode.AppendLocal, slot, target.Compound ? 1 : 0, expr.Line, -1);
+            if (_appendSlots.Add(slot) && _releasingLoads.TryGetValue(slot, out var loads))
+            {
+                foreach (var pc in loads) _code[pc] = _code[pc] with { B = 1 };
+            }
+            return;
+        }
+
+        CompileExpression(expr);
+        Emit(OpCode.Pop, 0, 0, line, -1);
+    }
+
+    /// <summary>
+    /// Compile the target of an index or slice: a local there is only read,
+    /// so its load doesn't release an array the function is building.
+    /// </summary>
+    private void CompileBorrowed(Expression expr)
+    {
+        if (expr is Identifier id)
+        {
+            EmitLoad(id.Name, expr.Line, borrow: true);
+        }
+        else
+        {
+            CompileExpression(expr);
+        }
+    }
+
+    private void CompileBinary(BinaryOp bin)
+    {
+        int line = bin.Line;
+        if (bin.Operator == BinaryOperator.LogicalAnd || bin.Operator == BinaryOperator.LogicalOr)
+        {
+            bool isAnd = bin.Operator == BinaryOperator.LogicalAnd;
+            CompileExpression(bin.Left);
+            int shortCircuit = Emit(isAnd ? OpCode.JumpIfFalse : OpCode.JumpIfTrue, -1, 0, line, -1);
+            CompileExpression(bin.Right);
+            Emit(OpCode.ToBool, 0, 0, line, 0);
+            int end = Emit(OpCode.Jump, -1, 0, line, 0);
+            _depth--;
+            PatchToHere(shortCircuit);
+            EmitConst(isAnd ? 0L : 1L, line);
+            PatchToHere(end);
+            return;
+        }
+
+        bool intOperands = IsInt(bin.Left) && IsInt(bin.Right);
+        if (bin.Operator == BinaryOperator.Add && bin.Left is BinaryOp { Operator: BinaryOperator.Add } && !intOperands)
+        {
+            CompileAddChain(bin);
+            return;
+        }
+
+        CompileExpression(bin.Left);
+        CompileExpression(bin.Right);
+        if (intOperands && IntOpCode(bin.Operator) is { } intOp)
+        {
+            Emit(intOp, (int)bin.Operator, 0, line, -1);
+        }
+        else
+        {
+            Emit(OpCode.Binary, (int)bin.Operator, 0, line, -1);
+        }
+    }
+
+    /// <summary>
+    /// a + b + c + ... as one Concat, so building a message out of several
+    /// pieces makes one string rather than one per +.
+    /// </summary>
+    private void CompileAddChain(BinaryOp bin)
+    {
+        var operands = new List<Expression>();
+        Expression node = bin;
+        while (node is BinaryOp { Operator: BinaryOperator.Add } add)
+        {
+            operands.Add(add.Right);
+            node = add.Left;
+        }
+        operands.Add(node);
+        operands.Reverse();
+
+        foreach (var operand in operands)
+        {
+            CompileExpression(operand);
+        }
+        Emit(OpCode.Concat, operands.Count, 0, bin.Line, 1 - operands.Count);
+    }
+
+    private void CompileUnary(UnaryOp unary)
+    {
+        switch (unary.Operator)
+        {
+            case UnaryOperator.PreIncrement:
+            case UnaryOperator.PreDecrement:
+            case UnaryOperator.PostIncrement:
+            case UnaryOperator.PostDecrement:
+                if (unary.Operand is not Identifier id)
+                {
+                    throw new UnsupportedConstructException("increment/decrement of a non-variable");
+                }
+                if (_localSlots.TryGetValue(id.Name, out var slot))
+                {
+                    Emit(OpCode.IncDecLocal, slot, (int)unary.Operator, unary.Line, 1);
+                }
+                else
+                {
+                    Emit(OpCode.IncDecGlobal, Name(id.Name), (int)unary.Operator, unary.Line, 1);
+                }
+                break;
+
+            default:
+                CompileExpression(unary.Operand);
+                Emit(OpCode.Unary, (int)unary.Operator, 0, unary.Line, 0);
+                break;
+        }
+    }
+
+    private void CompileSscanf(FunctionCall call)
+    {
+        if (call.Arguments.Count < 2)
+        {
+            throw new UnsupportedConstructException("sscanf() with fewer than 2 arguments");
+        }
+
+        int line = call.Line;
+        CompileExpression(call.Arguments[0]);
+        CompileExpression(call.Arguments[1]);
+        if (call.Arguments[1] is StringLiteral format)
+        {
+            // Compile the matcher now, keyed on the constant the call will pass
+            SscanfFormat.Precompile((string)_constants[_constantIndex[format.Value]]);
+        }
+        int targets = call.Arguments.Count - 2;
+        Emit(OpCode.Sscanf, targets, 0, line, -1);
+
+        for (int i = 0; i < targets; i++)
+        {
+            switch (call.Arguments[i + 2])
+            {
+                case Identifier id:
+                    // Local, else object variable, else a new local (as AssignToVariable does)
+                    if (_localSlots.TryGetValue(id.Name, out var slot) ||
+                        (_objectVariables != null && !_objectVariables.Contains(id.Name)))
+                    {
+                        Emit(OpCode.SscanfStoreLocal, DeclareSlot(id.Name), i, line, 0);
+                    }
+                    else
+                    {
+                        Emit(OpCode.SscanfStoreGlobal, Name(id.Name), i, line, 0);
+                    }
+                    break;
+                case IndexExpression indexExpr:
+                    CompileExpression(indexExpr.Target);
+                    CompileExpression(indexExpr.Index);
+                    Emit(OpCode.SscanfStoreIndex, 0, i, line, -2);
+                    break;
+                default:
+                    throw new UnsupportedConstructException("sscanf() target that is not a variable or index");
+            }
+        }
+
+        Emit(OpCode.SscanfEnd, 0, 0, line, 0);
+    }
+
+    #endregion
+}
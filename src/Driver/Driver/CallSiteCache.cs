@@ -0,0 +1,75 @@
+namespace Driver;
+
+/// <summary>
+/// Inline cache for one call_other / arrow call site in compiled code.
+/// Remembers the function lookup for the last few target programs seen at the
+/// site, so repeated calls on objects of the same program (every player in a
+/// chat loop, say) skip LpcProgram.FindFunctionWithProgram's inheritance walk.
+///
+/// Entries are keyed by program identity. Hot reload compiles new programs, so
+/// stale entries can never match; UpdateObject also calls InvalidateAll() so
+/// caches drop references to the old programs.
+/// </summary>
+public sealed class CallSiteCache
+{
+    /// <summary>
+    /// Programs remembered per site. A site that sees more than this is
+    /// megamorphic and stops adding entries.
+    /// </summary>
+    public const int MaxEntries = 4;
+
+    /// <summary>
+    /// A resolved lookup. Function is null when the program has no such function.
+    /// </summary>
+    public sealed record Entry(LpcProgram Program, string Name, FunctionDefinition? Function, LpcProgram? OwningProgram);
+
+    private static int _generation;
+
+    private Entry[] _entries = Array.Empty<Entry>();
+    private int _entriesGeneration;
+
+    /// <summary>
+    /// Drop every site's entries (called when programs are hot-reloaded).
+    /// </summary>
+    public static void InvalidateAll()
+    {
+        Interlocked.Increment(ref _generation);
+    }
+
+    /// <summary>
+    /// Number of programs currently cached at this site.
+    /// </summary>
+    public int Count => Volatile.Read(ref _entriesGeneration) == Volatile.Read(ref _generation) ? _entries.Length : 0;
+
+    /// <summary>
+    /// Resolve name on program, from the cache when possible.
+    /// </summary>
+    public Entry Lookup(LpcProgram program, string name)
+    {
+        int generation = Volatile.Read(ref _generation);
+        var entries = _entriesGeneration == generation ? _entries : Array.Empty<Entry>();
+
+        foreach (var entry in entries)
+        {
+            if (ReferenceEquals(entry.Program, program) && entry.Name == name)
+            {
+                return entry;
+            }
+        }
+
+        var (function, owningProgram) = program.FindFunctionWithProgram(name);
+        var resolved = new Entry(program, name, function, owningProgram);
+
+        if (entries.Length < MaxEntries)
+        {
+            // Copy-on-write so a concurrent reader always sees a complete array
+            var updated = new Entry[entries.Length + 1];
+            entries.CopyTo(updated, 0);
+            updated[^1] = resolved;
+            _entries = updated;
+            _entriesGeneration = generation;
+        }
+
+        return resolved;
+    }
+}
@@ -0,0 +1,112 @@
+namespace Driver;
+
+/// <summary>
+/// Subscriber sets for chat channels, behind the channel_* efuns.
+///
+/// The chat daemon decides who may hear a channel and records it here when a
+/// player logs in or changes a subscription; sending a message is then one
+/// loop over the channel's listeners queuing output, with no LPC calls per
+/// recipient. Subscribers are kept in the order they joined, and an object
+/// leaves every channel when it is destructed.
+/// </summary>
+public sealed class ChannelRegistry
+{
+    private readonly Dictionary<string, List<MudObject>> _channels = new();
+    private readonly object _lock = new();
+
+    /// <summary>
+    /// Add obj to a channel. Returns false if it was already subscribed.
+    /// </summary>
+    public bool Subscribe(string channel, MudObject obj)
+    {
+        lock (_lock)
+        {
+            if (!_channels.TryGetValue(channel, out var subscribers))
+            {
+                _channels[channel] = subscribers = new List<MudObject>();
+            }
+            if (subscribers.Contains(obj)) return false;
+            subscribers.Add(obj);
+            return true;
+        }
+    }
+
+    /// <summary>
+    /// Remove obj from a channel. Returns false if it wasn't subscribed.
+    /// </summary>
+    public bool Unsubscribe(string channel, MudObject obj)
+    {
+        lock (_lock)
+        {
+            if (!_channels.TryGetValue(channel, out var subscribers) || !subscribers.Remove(obj))
+            {
+                return false;
+            }
+            if (subscribers.Count == 0)
+            {
+                _channels.Remove(channel);
+            }
+            return true;
+        }
+    }
+
+    /// <summary>
+    /// Remove obj from every channel (called when it is destructed).
+    /// </summary>
+    public void UnsubscribeAll(MudObject obj)
+    {
+        lock (_lock)
+        {
+            foreach (var channel in _channels.Keys.ToList())
+            {
+                Unsubscribe(channel, obj);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Drop a channel and all its subscribers.
+    /// </summary>
+    public void Remove(string channel)
+    {
+        lock (_lock)
+        {
+            _channels.Remove(channel);
+        }
+    }
+
+    /// <summary>
+    /// A channel's subscribers, in the order they joined.
+    /// </summary>
+    public List<MudObject> GetSubscribers(string channel)
+    {
+        lock (_lock)
+        {
+            return _channels.TryGetValue(channel, out var subscribers)
+                ? subscribers.Where(o => !o.IsDestructed).ToList()
+                : new List<MudObject>();
+        }
+    }
+
+    /// <summary>
+    /// Queue message for every connected subscriber of a channel through
+    /// send, which takes a connection id. Returns the number reached;
+    /// linkdead subscribers stay subscribed but are skipped.
+    /// </summary>
+    public int Publish(string channel, string message, Action<string, string> send)
+    {
+        lock (_lock)
+        {
+            if (!_channels.TryGetValue(channel, out var subscribers)) return 0;
+
+            int delivered = 0;
+            foreach (var obj in subscribers)
+            {
+                if (obj.IsDestructed || !obj.IsInteractive || string.IsNullOrEmpty(obj.ConnectionId)) continue;
+                send(obj.ConnectionId, message);
+                delivered++;
+            }
+            return delivered;
+        }
+    }
+}
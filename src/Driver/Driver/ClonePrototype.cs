@@ -0,0 +1,240 @@
+namespace Driver;
+
+/// <summary>
+/// The state create() leaves a new clone in, for programs whose create()
+/// only sets up the clone's own state.
+///
+/// Most items and monsters are a create() that calls setters on an inherited
+/// base with constant arguments, which every clone runs through the
+/// interpreter to reach the same result. When the compiler can show that
+/// create(), everything it calls and the variable initializers only touch
+/// the object's own variables (see IsDeclarative), the first clone's state
+/// after create() is captured here, and later clones copy it instead:
+/// variables by block copy (arrays and mappings copied deep), plus the
+/// driver-side state the allowed efuns set (declared ids, living, commands,
+/// heartbeat, skills, description version). reset() still runs for each clone.
+///
+/// What counts as declarative: assignments, arithmetic, control flow, calls
+/// to the object's own functions, and efuns in PureEfuns (their result
+/// depends only on their arguments) or StateEfuns (the state they set is
+/// copied). Anything else - call_other(), ->, this_object(), random(),
+/// time(), moving or cloning objects, callouts - runs create() every time.
+///
+/// Immutable once captured; shared by every clone of the program.
+/// </summary>
+internal sealed class ClonePrototype
+{
+    /// <summary>
+    /// Efuns whose result depends only on their arguments.
+    /// </summary>
+    private static readonly HashSet<string> PureEfuns = new(StringComparer.Ordinal)
+    {
+        "typeof", "strlen", "sizeof", "to_string", "to_int", "abs", "min", "max", "sum",
+        "member_array", "sprintf", "explode", "implode", "lower_case", "upper_case", "capitalize",
+        "regexp", "regmatch", "regexplode", "unique_array", "m_indices", "m_values", "m_delete",
+        "mkmapping", "keys", "values", "strsrch", "member", "intp", "stringp", "objectp",
+        "pointerp", "arrayp", "mappingp", "allocate", "copy", "replace_string", "trim", "sscanf",
+    };
+
+    /// <summary>
+    /// Efuns that set driver-side state of this_object() which Apply() copies.
+    /// </summary>
+    private static readonly HashSet<string> StateEfuns = new(StringComparer.Ordinal)
+    {
+        "set_ids", "set_living", "enable_commands", "disable_commands", "set_heart_beat",
+        "set_skill_level", "set_skill_allowed", "description_changed",
+    };
+
+    private readonly LpcValue[] _variables;
+    private readonly int[] _containerSlots;
+    private readonly (string[] Ids, string? Text, LpcProgram Program)? _ids;
+    private readonly bool _living;
+    private readonly bool _commands;
+    private readonly bool _heartbeat;
+    private readonly long _descriptionVersion;
+    private readonly SkillTable? _skills;
+
+    private ClonePrototype(MudObject clone)
+    {
+        _variables = clone.SnapshotVariables(Array.Empty<LpcValue>());
+        var containerSlots = new List<int>();
+        for (int i = 0; i < _variables.Length; i++)
+        {
+            if (_variables[i].Kind is LpcValueKind.Array or LpcValueKind.Mapping)
+            {
+                _variables[i] = CopyValue(_variables[i]);
+                containerSlots.Add(i);
+            }
+        }
+        _containerSlots = containerSlots.ToArray();
+        _ids = clone.DeclaredIdState;
+        _living = clone.IsLiving;
+        _commands = clone.CommandsEnabled;
+        _heartbeat = clone.HeartbeatEnabled;
+        _descriptionVersion = clone.DescriptionVersion;
+        _skills = clone.SkillsIfAny?.Copy();
+    }
+
+    /// <summary>
+    /// Capture clone's state right after its create(), or null if it holds
+    /// anything a copy couldn't reproduce (an object reference).
+    /// </summary>
+    public static ClonePrototype? Capture(MudObject clone)
+    {
+        var variables = clone.SnapshotVariables(Array.Empty<LpcValue>());
+        foreach (var value in variables)
+        {
+            if (HoldsObject(value.ToObject())) return null;
+        }
+        return new ClonePrototype(clone);
+    }
+
+    /// <summary>
+    /// Put a new clone in the captured state, in place of its initializers
+    /// and create().
+    /// </summary>
+    public void Apply(MudObject clone)
+    {
+        clone.RestoreVariables(_variables);
+        foreach (int slot in _containerSlots)
+        {
+            clone.SetVariableAt(slot, CopyValue(_variables[slot]));
+        }
+        if (_ids is { } ids)
+        {
+            clone.DeclareIds(ids.Ids, ids.Text, ids.Program);
+        }
+        clone.IsLiving = _living;
+        clone.CommandsEnabled = _commands;
+        clone.DescriptionVersion = _descriptionVersion;
+        if (_skills != null)
+        {
+            clone.Skills.CopyFrom(_skills);
+        }
+        if (_heartbeat)
+        {
+            clone.HeartbeatEnabled = true;
+            GameLoop.Instance?.RegisterHeartbeat(clone);
+        }
+    }
+
+    private static LpcValue CopyValue(LpcValue value)
+    {
+        return value.Kind is LpcValueKind.Array or LpcValueKind.Mapping
+            ? LpcValue.FromObject(EfunRegistry.DeepCopy(value.Ref!))
+            : value;
+    }
+
+    private static bool HoldsObject(object? value)
+    {
+        return value switch
+        {
+            MudObject => true,
+            List<object> list => list.Exists(HoldsObject),
+            Dictionary<object, object> map => map.Any(entry => HoldsObject(entry.Key) || HoldsObject(entry.Value)),
+            null or string or long or int => false,
+            _ => value is not double
+        };
+    }
+
+    #region Analysis
+
+    /// <summary>
+    /// Whether program's variable initializers and create() (with everything
+    /// they call) only set up the object's own state.
+    /// </summary>
+    public static bool IsDeclarative(LpcProgram program)
+    {
+        var analysis = new Analysis(program);
+        foreach (var initializer in program.DynamicInitializers)
+        {
+            if (initializer.Initializer != null && !analysis.Expression(initializer.Initializer, program)) return false;
+        }
+
+        var (create, owner) = program.FindFunctionWithProgram("create");
+        return create == null || analysis.Function(create, owner!);
+    }
+
+    private sealed class Analysis
+    {
+        private readonly LpcProgram _objectProgram;
+        private readonly HashSet<FunctionDefinition> _seen = new(ReferenceEqualityComparer.Instance);
+
+        public Analysis(LpcProgram objectProgram)
+        {
+            _objectProgram = objectProgram;
+        }
+
+        public bool Function(FunctionDefinition function, LpcProgram owner)
+        {
+            // Recursion is judged by the rest of the body
+            return !_seen.Add(function) || Statement(function.ReadBody(), owner);
+        }
+
+        private bool Statement(Statement? statement, LpcProgram owner)
+        {
+            return statement switch
+            {
+                null or BreakStatement or ContinueStatement => true,
+                BlockStatement block => block.Statements.TrueForAll(s => Statement(s, owner)),
+                ExpressionStatement e => Expression(e.Expression, owner),
+                IfStatement i => Expression(i.Condition, owner) && Statement(i.ThenBranch, owner) && Statement(i.ElseBranch, owner),
+                WhileStatement w => Expression(w.Condition, owner) && Statement(w.Body, owner),
+                ForStatement f => Expression(f.Init, owner) && Expression(f.Condition, owner) &&
+                                  Expression(f.Increment, owner) && Statement(f.Body, owner),
+                ForEachStatement f => Expression(f.Collection, owner) && Statement(f.Body, owner),
+                SwitchStatement s => Expression(s.Value, owner) &&
+                                     s.Cases.TrueForAll(c => Expression(c.Value, owner) && c.Statements.TrueForAll(b => Statement(b, owner))),
+                ReturnStatement r => Expression(r.Value, owner),
+                VariableDeclaration v => Expression(v.Initializer, owner),
+                _ => false
+            };
+        }
+
+        public bool Expression(Expression? expression, LpcProgram owner)
+        {
+            return expression switch
+            {
+                null or NumberLiteral or StringLiteral or Identifier => true,
+                BinaryOp b => Expression(b.Left, owner) && Expression(b.Right, owner),
+                UnaryOp u => Expression(u.Operand, owner),
+                GroupedExpression g => Expression(g.Inner, owner),
+                TernaryOp t => Expression(t.Condition, owner) && Expression(t.ThenBranch, owner) && Expression(t.ElseBranch, owner),
+                Assignment a => Expression(a.Value, owner),
+                CompoundAssignment c => Expression(c.Value, owner),
+                IndexAssignment i => Expression(i.Object, owner) && Expression(i.Index, owner) && Expression(i.Value, owner),
+                ArrayLiteral a => a.Elements.TrueForAll(e => Expression(e, owner)),
+                MappingLiteral m => m.Entries.TrueForAll(e => Expression(e.Key, owner) && Expression(e.Value, owner)),
+                IndexExpression i => Expression(i.Target, owner) && Expression(i.Index, owner),
+                RangeExpression r => Expression(r.Target, owner) && Expression(r.Start, owner) && Expression(r.End, owner),
+                CatchExpression c => Expression(c.Body, owner),
+                FunctionCall call => call.Arguments.TrueForAll(a => Expression(a, owner)) && Call(call, owner),
+                _ => false
+            };
+        }
+
+        private bool Call(FunctionCall call, LpcProgram owner)
+        {
+            if (call.IsParentCall)
+            {
+                var (parent, parentOwner) = owner.FindParentFunctionWithProgram(call.Name);
+                return parent != null && Function(parent, parentOwner!);
+            }
+
+            // The object's own functions first (private ones only from their own program), then efuns
+            var (function, functionOwner) = _objectProgram.FindFunctionWithProgram(call.Name);
+            if (function == null && owner.Functions.TryGetValue(call.Name, out var local))
+            {
+                (function, functionOwner) = (local, owner);
+            }
+            if (function != null)
+            {
+                return Function(function, functionOwner!);
+            }
+
+            return PureEfuns.Contains(call.Name) || StateEfuns.Contains(call.Name);
+        }
+    }
+
+    #endregion
+}
@@ -0,0 +1,506 @@
+using System.Collections.Concurrent;
+using System.Net.Sockets;
+using System.Text;
+using System.Text.Json;
+using System.Text.Json.Serialization;
+
+namespace Driver;
+
+/// <summary>
+/// One driver process in a cluster: its name, the port the router reaches
+/// it on, and the areas (path prefixes) whose objects it runs.
+/// </summary>
+public sealed class ClusterNodeInfo
+{
+    public string Name { get; set; } = string.Empty;
+    public string Host { get; set; } = "127.0.0.1";
+    public int Port { get; set; }
+    public List<string> Areas { get; set; } = new();
+}
+
+/// <summary>
+/// A cluster's layout, shared by the router and every node:
+///
+///   { "Secret": "...", "Port": 4000, "LinkPort": 4100,
+///     "Nodes": [ { "Name": "town", "Port": 4001, "Areas": [ "/world/rooms/town" ] },
+///                { "Name": "forest", "Port": 4002, "Areas": [ "/world/rooms/forest" ] } ] }
+///
+/// Port takes players at the router; LinkPort carries messages between the
+/// router and the nodes. A path belongs to the node with the longest area
+/// prefix matching it, and anything outside every area to the first node.
+/// Secret authenticates the router to the nodes and the nodes to the router.
+/// </summary>
+public sealed class ClusterConfig
+{
+    public string Secret { get; set; } = string.Empty;
+    public string RouterHost { get; set; } = "127.0.0.1";
+    public int Port { get; set; } = 4000;
+    public int LinkPort { get; set; } = 4100;
+    public List<ClusterNodeInfo> Nodes { get; set; } = new();
+
+    public static ClusterConfig Load(string path)
+    {
+        var config = JsonSerializer.Deserialize(File.ReadAllBytes(path), ClusterJsonContext.Default.ClusterConfig)
+            ?? throw new InvalidDataException($"Empty cluster config: {path}");
+        if (config.Nodes.Count == 0)
+        {
+            throw new InvalidDataException($"{path} lists no nodes");
+        }
+        if (config.Secret.Length == 0 || config.Secret.Any(char.IsWhiteSpace))
+        {
+            throw new InvalidDataException($"{path} needs a Secret without spaces");
+        }
+        return config;
+    }
+
+    public ClusterNodeInfo? Find(string name)
+    {
+        return Nodes.Find(node => node.Name == name);
+    }
+
+    /// <summary>
+    /// The node that runs objectName (a path, or a clone's name).
+    /// </summary>
+    public string OwnerOf(string objectName)
+    {
+        int hash = objectName.IndexOf('#');
+        var path = hash >= 0 ? objectName[..hash] : objectName;
+        if (!path.StartsWith('/')) path = "/" + path;
+
+        string owner = Nodes[0].Name;
+        int longest = -1;
+        foreach (var node in Nodes)
+        {
+            foreach (var area in node.Areas)
+            {
+                var prefix = area.TrimEnd('/');
+                bool inArea = path.Length == prefix.Length
+                    ? path == prefix
+                    : path.StartsWith(prefix, StringComparison.Ordinal) && path[prefix.Length] == '/';
+                if (inArea && prefix.Length > longest)
+                {
+                    owner = node.Name;
+                    longest = prefix.Length;
+                }
+            }
+        }
+        return owner;
+    }
+}
+
+/// <summary>
+/// A message between a node and the router, sent as one JSON line.
+///
+///   hello     node to router, first on a link (Value is the secret)
+///   users     node to router: the players logged in there (Names)
+///   directory router to nodes: every player in the cluster and their node (Users)
+///   call      node to node: call Function in Path with the arguments in Value; Id matches the reply
+///   reply     node to node: the result in Value, or Error
+///   handoff   node to router: move the player on Route to node To, into Room
+///
+/// Values are in save-file text form (SaveFormat), with objects as their names.
+/// </summary>
+public sealed class ClusterMessage
+{
+    public string Type { get; set; } = string.Empty;
+    public string? From { get; set; }
+    public string? To { get; set; }
+    public long Id { get; set; }
+    public string? Path { get; set; }
+    public string? Function { get; set; }
+    public string? Value { get; set; }
+    public string? Error { get; set; }
+    public string? Route { get; set; }
+    public string? User { get; set; }
+    public string? Room { get; set; }
+    public List<string>? Names { get; set; }
+    public Dictionary<string, string>? Users { get; set; }
+}
+
+/// <summary>
+/// A socket carrying ClusterMessages as JSON lines. Send() is safe from any
+/// thread; one thread reads.
+/// </summary>
+public sealed class ClusterLink : IDisposable
+{
+    private readonly Socket _socket;
+    private readonly NetworkStream _stream;
+    private readonly StreamReader _reader;
+    private readonly object _sendLock = new();
+
+    public ClusterLink(Socket socket)
+    {
+        _socket = socket;
+        _socket.NoDelay = true;
+        _stream = new NetworkStream(socket, ownsSocket: true);
+        _reader = new StreamReader(_stream, new UTF8Encoding(false));
+    }
+
+    /// <summary>
+    /// Send message. False if the link has closed.
+    /// </summary>
+    public bool Send(ClusterMessage message)
+    {
+        var line = JsonSerializer.SerializeToUtf8Bytes(message, ClusterJsonContext.Default.ClusterMessage);
+        lock (_sendLock)
+        {
+            try
+            {
+                _stream.Write(line);
+                _stream.WriteByte((byte)'\n');
+                return true;
+            }
+            catch (Exception ex) when (ex is IOException or ObjectDisposedException)
+            {
+                return false;
+            }
+        }
+    }
+
+    /// <summary>
+    /// The next message, or null once the link has closed.
+    /// </summary>
+    public async Task<ClusterMessage?> ReceiveAsync(CancellationToken cancellationToken)
+    {
+        while (true)
+        {
+            string? line;
+            try
+            {
+                line = await _reader.ReadLineAsync(cancellationToken);
+            }
+            catch (Exception ex) when (ex is IOException or ObjectDisposedException)
+            {
+                return null;
+            }
+            if (line == null) return null;
+            if (line.Length == 0) continue;
+
+            try
+            {
+                return JsonSerializer.Deserialize(line, ClusterJsonContext.Default.ClusterMessage);
+            }
+            catch (JsonException ex)
+            {
+                Logger.Warning($"Bad cluster message: {ex.Message}", LogCategory.Network);
+            }
+        }
+    }
+
+    public void Dispose()
+    {
+        _stream.Dispose();
+    }
+}
+
+/// <summary>
+/// This driver's place in a cluster (--cluster config --node name).
+///
+/// A world too busy for one process is split by area across several driver
+/// processes sharing one mudlib directory. Players connect to a ClusterRouter,
+/// which passes each connection through to a node and carries messages
+/// between nodes. Each node runs the objects in its areas:
+///
+/// - A player moved into a room another node owns is handed off: saved,
+///   taken out of the game here, and logged straight in on the other node
+///   in that room, on the same client connection.
+/// - call_other_async() on a path another node owns is sent there, and its
+///   callback gets the result when the reply comes back.
+/// - The router keeps a directory of every logged-in player and their node,
+///   for cluster_users() and who.
+///
+/// Objects can't be referenced across nodes. A node may still load another
+/// node's rooms (an exit loads its destination), but no player is ever in
+/// them there.
+///
+/// Messages arrive on a background thread and wait in an inbox for the game
+/// thread (GameLoop.RunCluster).
+/// </summary>
+public sealed class ClusterNode : IDisposable
+{
+    /// <summary>
+    /// How long a call_other_async() to another node waits for its reply.
+    /// </summary>
+    public static readonly TimeSpan CallTimeout = TimeSpan.FromSeconds(10);
+
+    private static readonly TimeSpan ReconnectDelay = TimeSpan.FromSeconds(2);
+
+    private readonly ConcurrentQueue<ClusterMessage> _inbox = new();
+    private readonly ConcurrentDictionary<string, string> _routes = new();
+    private readonly Dictionary<long, PendingCall> _calls = new();
+    private readonly CancellationTokenSource _stop = new();
+    private volatile ClusterLink? _link;
+    private volatile Dictionary<string, string> _directory = new();
+    private long _nextCallId;
+    private string _publishedUsers = string.Empty;
+
+    /// <summary>
+    /// A call_out waiting for a reply from another node (game thread only).
+    /// </summary>
+    private sealed record PendingCall(MudObject Caller, string? Callback, DateTime Deadline);
+
+    public ClusterConfig Config { get; }
+    public string Name { get; }
+
+    /// <summary>
+    /// Whether the link to the router is up.
+    /// </summary>
+    public bool Connected => _link != null;
+
+    public ClusterNode(ClusterConfig config, string name)
+    {
+        if (config.Find(name) == null)
+        {
+            throw new ArgumentException($"Node {name} is not in the cluster config");
+        }
+        Config = config;
+        Name = name;
+    }
+
+    /// <summary>
+    /// Keep a link to the router open from a background thread.
+    /// </summary>
+    public void Start()
+    {
+        _ = Task.Run(() => LinkLoopAsync(_stop.Token));
+    }
+
+    /// <summary>
+    /// Whether objectName runs on this node.
+    /// </summary>
+    public bool IsLocal(string objectName) => Config.OwnerOf(objectName) == Name;
+
+    /// <summary>
+    /// Players logged in on other nodes, by lower-case name, with their node.
+    /// </summary>
+    public IReadOnlyDictionary<string, string> RemoteUsers
+    {
+        get
+        {
+            var remote = new Dictionary<string, string>();
+            foreach (var (user, node) in _directory)
+            {
+                if (node != Name) remote[user] = node;
+            }
+            return remote;
+        }
+    }
+
+    public void Send(ClusterMessage message)
+    {
+        message.From ??= Name;
+        if (_link?.Send(message) != true)
+        {
+            Logger.Debug($"Cluster link down; dropped {message.Type} to {message.To}", LogCategory.Network);
+        }
+    }
+
+    public bool TryReceive(out ClusterMessage message) => _inbox.TryDequeue(out message!);
+
+    #region Routed connections
+
+    /// <summary>
+    /// A connection the router opened, from its first line:
+    /// "#route secret routeId address [user [room]]". User is set when the
+    /// router is handing a player over from another node.
+    /// </summary>
+    public sealed record RoutedConnection(string RouteId, string Address, string? User, string? Room);
+
+    /// <summary>
+    /// Parse a route line, or null if it isn't one or the secret is wrong.
+    /// </summary>
+    public RoutedConnection? ParseRoute(string line)
+    {
+        var parts = line.Trim().Split(' ', StringSplitOptions.RemoveEmptyEntries);
+        if (parts.Length < 4 || parts.Length > 6 || parts[0] != "#route" || parts[1] != Config.Secret)
+        {
+            return null;
+        }
+        return new RoutedConnection(parts[2], parts[3], parts.Length > 4 ? parts[4] : null, parts.Length > 5 ? parts[5] : null);
+    }
+
+    public void Routed(string connectionId, string routeId) => _routes[connectionId] = routeId;
+
+    public void Unrouted(string connectionId) => _routes.TryRemove(connectionId, out _);
+
+    public string? RouteOf(string connectionId) => _routes.GetValueOrDefault(connectionId);
+
+    #endregion
+
+    #region Calls
+
+    /// <summary>
+    /// Send a call of function in path to the node that owns it. The reply
+    /// becomes a call_out of callback(result) on caller (game thread).
+    /// </summary>
+    public void Call(string path, string function, List<object> args, MudObject caller, string? callback)
+    {
+        long id = ++_nextCallId;
+        _calls[id] = new PendingCall(caller, callback, DateTime.UtcNow + CallTimeout);
+        Send(new ClusterMessage
+        {
+            Type = "call",
+            To = Config.OwnerOf(path),
+            Id = id,
+            Path = path,
+            Function = function,
+            Value = Encode(args)
+        });
+    }
+
+    /// <summary>
+    /// The caller and callback waiting on reply id, removed (game thread).
+    /// </summary>
+    public (MudObject Caller, string? Callback)? EndCall(long id)
+    {
+        return _calls.Remove(id, out var call) ? (call.Caller, call.Callback) : null;
+    }
+
+    /// <summary>
+    /// Calls whose reply didn't come in time, removed (game thread).
+    /// </summary>
+    public List<(MudObject Caller, string? Callback)> ExpiredCalls(DateTime now)
+    {
+        var expired = new List<(MudObject, string?)>();
+        foreach (var (id, call) in _calls)
+        {
+            if (call.Deadline <= now)
+            {
+                expired.Add((call.Caller, call.Callback));
+                _calls.Remove(id);
+            }
+        }
+        return expired;
+    }
+
+    /// <summary>
+    /// value in save-file text form, with objects as their names.
+    /// </summary>
+    public static string Encode(object? value)
+    {
+        var sb = new StringBuilder();
+        SaveFormat.WriteValue(sb, Portable(value));
+        return sb.ToString();
+    }
+
+    public static object Decode(string? text)
+    {
+        return string.IsNullOrEmpty(text) ? 0L : SaveFormat.ParseValue(text);
+    }
+
+    private static object? Portable(object? value)
+    {
+        return value switch
+        {
+            MudObject obj => obj.ObjectName,
+            List<object> list => list.ConvertAll(item => Portable(item)!),
+            Dictionary<object, object> map => PortableMapping(map),
+            _ => value
+        };
+    }
+
+    /// <summary>
+    /// A mapping with object keys as their names. Where an object's name is
+    /// also a plain key of the same mapping, the plain key keeps its value
+    /// and the object's entry is dropped.
+    /// </summary>
+    private static Dictionary<object, object> PortableMapping(Dictionary<object, object> map)
+    {
+        var portable = new Dictionary<object, object>(map.Count);
+        foreach (var (key, value) in map)
+        {
+            if (key is not MudObject)
+            {
+                portable[key] = Portable(value)!;
+            }
+        }
+        foreach (var (key, value) in map)
+        {
+            if (key is MudObject obj)
+            {
+                portable.TryAdd(obj.ObjectName, Portable(value)!);
+            }
+        }
+        return portable;
+    }
+
+    #endregion
+
+    /// <summary>
+    /// Tell the router who is logged in here, if that changed (game thread).
+    /// </summary>
+    public void PublishUsers(List<string> users)
+    {
+        users.Sort(StringComparer.Ordinal);
+        var joined = string.Join(',', users);
+        if (joined == _publishedUsers || _link == null) return;
+
+        _publishedUsers = joined;
+        Send(new ClusterMessage { Type = "users", Names = users });
+    }
+
+    private async Task LinkLoopAsync(CancellationToken cancellationToken)
+    {
+        while (!cancellationToken.IsCancellationRequested)
+        {
+            try
+            {
+                var socket = new Socket(SocketType.Stream, ProtocolType.Tcp);
+                await socket.ConnectAsync(Config.RouterHost, Config.LinkPort, cancellationToken);
+                using var link = new ClusterLink(socket);
+                link.Send(new ClusterMessage { Type = "hello", From = Name, Value = Config.Secret });
+                _publishedUsers = string.Empty;
+                _link = link;
+                Logger.Info($"Cluster: node {Name} linked to the router at {Config.RouterHost}:{Config.LinkPort}", LogCategory.Network);
+
+                while (await link.ReceiveAsync(cancellationToken) is { } message)
+                {
+                    if (message.Type == "directory")
+                    {
+                        _directory = message.Users ?? new Dictionary<string, string>();
+                    }
+                    else
+                    {
+                        _inbox.Enqueue(message);
+                    }
+                }
+
+                _link = null;
+                _directory = new Dictionary<string, string>();
+                Logger.Warning($"Cluster: link to the router closed", LogCategory.Network);
+            }
+            catch (OperationCanceledException)
+            {
+                break;
+            }
+            catch (SocketException)
+            {
+                _link = null;
+            }
+
+            try
+            {
+                await Task.Delay(ReconnectDelay, cancellationToken);
+            }
+            catch (OperationCanceledException)
+            {
+                break;
+            }
+        }
+    }
+
+    public void Dispose()
+    {
+        _stop.Cancel();
+        _link?.Dispose();
+    }
+}
+
+/// <summary>
+/// Source-generated serializers for the cluster config and messages.
+/// </summary>
+[JsonSerializable(typeof(ClusterConfig))]
+[JsonSerializable(typeof(ClusterMessage))]
+internal partial class ClusterJsonContext : JsonSerializerContext
+{
+}
@@ -0,0 +1,448 @@
+using System.Net;
+using System.Net.Sockets;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// The front end of a cluster (driver --router config): takes player
+/// connections, passes each one through to a node, and carries messages
+/// between the nodes.
+///
+/// A new connection goes to the first node, which logs the player in. The
+/// router opens its own connection to the node and sends one line first,
+/// "#route secret routeId address", so the node knows where the player is
+/// from; after that the bytes go back and forth untouched. When a node
+/// hands a player off, the router opens a connection to the new node with
+/// the player's name and room on the route line, switches the client's input
+/// over to it, and shuts the old one down. Output from the old node is let
+/// through until that node closes, so nothing it sent is lost or reordered.
+///
+/// Nodes keep a link to LinkPort (see ClusterNode). The router forwards call
+/// and reply messages to the node named in To, and keeps the directory of
+/// which players are on which node, sending it to every node when it changes.
+///
+/// Telnet only: MCCP is left off on nodes, since a compressed stream can't
+/// be moved between them.
+/// </summary>
+public sealed class ClusterRouter : IDisposable
+{
+    private static readonly TimeSpan DrainTimeout = TimeSpan.FromSeconds(5);
+
+    private readonly ClusterConfig _config;
+    private readonly Socket _listener;
+    private readonly Socket _linkListener;
+    private readonly CancellationTokenSource _stop = new();
+    private readonly object _lock = new();
+    private readonly Dictionary<string, Route> _routes = new();
+    private readonly Dictionary<string, ClusterLink> _links = new();
+    private readonly Dictionary<string, List<string>> _users = new();
+    private long _nextRoute;
+
+    /// <summary>
+    /// A client connection and the node connection it is passed through to.
+    /// </summary>
+    private sealed class Route
+    {
+        public required string Id { get; init; }
+        public required Socket Client { get; init; }
+        public required string Address { get; init; }
+        public required Socket Upstream { get; set; }
+        public required string Node { get; set; }
+        public Task UpstreamPump { get; set; } = Task.CompletedTask;
+    }
+
+    public ClusterRouter(ClusterConfig config, int? port = null, int? linkPort = null)
+    {
+        _config = config;
+        _listener = new Socket(SocketType.Stream, ProtocolType.Tcp);
+        _listener.Bind(new IPEndPoint(IPAddress.Any, port ?? config.Port));
+        _listener.Listen();
+        _linkListener = new Socket(SocketType.Stream, ProtocolType.Tcp);
+        _linkListener.Bind(new IPEndPoint(IPAddress.Any, linkPort ?? config.LinkPort));
+        _linkListener.Listen();
+    }
+
+    public int LocalPort => ((IPEndPoint)_listener.LocalEndPoint!).Port;
+    public int LinkLocalPort => ((IPEndPoint)_linkListener.LocalEndPoint!).Port;
+
+    /// <summary>
+    /// Client connections open.
+    /// </summary>
+    public int RouteCount
+    {
+        get
+        {
+            lock (_lock)
+            {
+                return _routes.Count;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Nodes linked.
+    /// </summary>
+    public int NodeCount
+    {
+        get
+        {
+            lock (_lock)
+            {
+                return _links.Count;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Accept clients and node links until Dispose().
+    /// </summary>
+    public Task RunAsync()
+    {
+        Logger.Info($"Cluster router: players on port {LocalPort}, nodes on port {LinkLocalPort}", LogCategory.Network);
+        return Task.WhenAll(AcceptClientsAsync(_stop.Token), AcceptLinksAsync(_stop.Token));
+    }
+
+    #region Clients
+
+    private async Task AcceptClientsAsync(CancellationToken cancellationToken)
+    {
+        while (!cancellationToken.IsCancellationRequested)
+        {
+            Socket client;
+            try
+            {
+                client = await _listener.AcceptAsync(cancellationToken);
+            }
+            catch (Exception ex) when (ex is OperationCanceledException or ObjectDisposedException)
+            {
+                break;
+            }
+            catch (SocketException ex)
+            {
+                Logger.Error($"Router: error accepting connection: {ex.Message}", LogCategory.Network);
+                continue;
+            }
+
+            _ = OpenRouteAsync(client);
+        }
+    }
+
+    private async Task OpenRouteAsync(Socket client)
+    {
+        var id = "r" + Interlocked.Increment(ref _nextRoute);
+        var address = (client.RemoteEndPoint as IPEndPoint)?.Address.ToString() ?? "unknown";
+        var node = _config.Nodes[0];
+
+        Socket upstream;
+        try
+        {
+            upstream = await ConnectAsync(node, id, address, null, null);
+        }
+        catch (SocketException ex)
+        {
+            Logger.Warning($"Router: node {node.Name} unreachable: {ex.Message}", LogCategory.Network);
+            client.Send(Encoding.ASCII.GetBytes("The game is not available right now. Try again soon.\r\n"));
+            client.Dispose();
+            return;
+        }
+
+        var route = new Route { Id = id, Client = client, Address = address, Upstream = upstream, Node = node.Name };
+        lock (_lock)
+        {
+            _routes[id] = route;
+        }
+        Logger.Info($"Router: {id} from {address} to {node.Name}", LogCategory.Network);
+
+        route.UpstreamPump = PumpUpstreamAsync(route, upstream);
+        await PumpClientAsync(route);
+    }
+
+    /// <summary>
+    /// Connect to node and send the route line.
+    /// </summary>
+    private async Task<Socket> ConnectAsync(ClusterNodeInfo node, string routeId, string address, string? user, string? room)
+    {
+        var socket = new Socket(SocketType.Stream, ProtocolType.Tcp) { NoDelay = true };
+        try
+        {
+            await socket.ConnectAsync(node.Host, node.Port);
+            var line = $"#route {_config.Secret} {routeId} {address}" + (user != null ? $" {user}" : "") + (room != null ? $" {room}" : "");
+            await socket.SendAsync(Encoding.UTF8.GetBytes(line + "\r\n"));
+            return socket;
+        }
+        catch
+        {
+            socket.Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>
+    /// Client to node, whichever node the route points at now.
+    /// </summary>
+    private async Task PumpClientAsync(Route route)
+    {
+        var buffer = new byte[4096];
+        try
+        {
+            while (true)
+            {
+                int read = await route.Client.ReceiveAsync(buffer, SocketFlags.None);
+                if (read == 0) break;
+
+                try
+                {
+                    await route.Upstream.SendAsync(buffer.AsMemory(0, read), SocketFlags.None);
+                }
+                catch (Exception ex) when (ex is SocketException or ObjectDisposedException)
+                {
+                    // Mid-handoff the old node may already be gone; the input is lost like a dropped line
+                }
+            }
+        }
+        catch (Exception ex) when (ex is SocketException or ObjectDisposedException)
+        {
+        }
+
+        CloseRoute(route);
+    }
+
+    /// <summary>
+    /// One node connection to the client. When it ends, the client is closed
+    /// too unless the route has moved on to another node.
+    /// </summary>
+    private async Task PumpUpstreamAsync(Route route, Socket upstream)
+    {
+        var buffer = new byte[8192];
+        try
+        {
+            while (true)
+            {
+                int read = await upstream.ReceiveAsync(buffer, SocketFlags.None);
+                if (read == 0) break;
+                await route.Client.SendAsync(buffer.AsMemory(0, read), SocketFlags.None);
+            }
+        }
+        catch (Exception ex) when (ex is SocketException or ObjectDisposedException)
+        {
+        }
+
+        if (route.Upstream == upstream)
+        {
+            CloseRoute(route);
+        }
+    }
+
+    private void CloseRoute(Route route)
+    {
+        lock (_lock)
+        {
+            if (!_routes.Remove(route.Id)) return;
+        }
+        route.Client.Dispose();
+        route.Upstream.Dispose();
+        Logger.Debug($"Router: {route.Id} closed", LogCategory.Network);
+    }
+
+    /// <summary>
+    /// Move a route to another node: the player arrives there as user, in room.
+    /// If that node can't be reached the player goes back to the node they
+    /// came from, where they log in at their saved location.
+    /// </summary>
+    private async Task HandoffAsync(ClusterMessage message)
+    {
+        Route? route;
+        lock (_lock)
+        {
+            route = message.Route != null ? _routes.GetValueOrDefault(message.Route) : null;
+        }
+        var target = message.To != null ? _config.Find(message.To) : null;
+        var from = message.From != null ? _config.Find(message.From) : null;
+        if (route == null || target == null || from == null || message.User == null) return;
+
+        Socket upstream;
+        try
+        {
+            upstream = await ConnectAsync(target, route.Id, route.Address, message.User, message.Room);
+        }
+        catch (SocketException ex)
+        {
+            Logger.Warning($"Router: handoff of {message.User} to {target.Name} failed ({ex.Message}); back to {from.Name}", LogCategory.Network);
+            target = from;
+            try
+            {
+                upstream = await ConnectAsync(from, route.Id, route.Address, message.User, null);
+            }
+            catch (SocketException)
+            {
+                CloseRoute(route);
+                return;
+            }
+        }
+
+        // Input goes to the new node from here; the old one finishes its output first
+        var old = route.Upstream;
+        var oldPump = route.UpstreamPump;
+        route.Upstream = upstream;
+        route.Node = target.Name;
+        try
+        {
+            old.Shutdown(SocketShutdown.Send);
+        }
+        catch (Exception ex) when (ex is SocketException or ObjectDisposedException)
+        {
+        }
+
+        route.UpstreamPump = Task.Run(async () =>
+        {
+            await Task.WhenAny(oldPump, Task.Delay(DrainTimeout));
+            old.Dispose();
+            await PumpUpstreamAsync(route, upstream);
+        });
+        Logger.Info($"Router: {message.User} handed off from {message.From} to {target.Name}", LogCategory.Network);
+    }
+
+    #endregion
+
+    #region Node links
+
+    private async Task AcceptLinksAsync(CancellationToken cancellationToken)
+    {
+        while (!cancellationToken.IsCancellationRequested)
+        {
+            Socket socket;
+            try
+            {
+                socket = await _linkListener.AcceptAsync(cancellationToken);
+            }
+            catch (Exception ex) when (ex is OperationCanceledException or ObjectDisposedException)
+            {
+                break;
+            }
+            catch (SocketException)
+            {
+                continue;
+            }
+
+            _ = ServeLinkAsync(new ClusterLink(socket), cancellationToken);
+        }
+    }
+
+    private async Task ServeLinkAsync(ClusterLink link, CancellationToken cancellationToken)
+    {
+        var hello = await link.ReceiveAsync(cancellationToken);
+        if (hello?.Type != "hello" || hello.Value != _config.Secret || hello.From == null || _config.Find(hello.From) == null)
+        {
+            link.Dispose();
+            return;
+        }
+
+        var node = hello.From;
+        lock (_lock)
+        {
+            if (_links.Remove(node, out var stale)) stale.Dispose();
+            _links[node] = link;
+        }
+        Logger.Info($"Router: node {node} linked", LogCategory.Network);
+        SendDirectory();
+
+        while (await link.ReceiveAsync(cancellationToken) is { } message)
+        {
+            message.From = node;
+            switch (message.Type)
+            {
+                case "users":
+                    lock (_lock)
+                    {
+                        _users[node] = message.Names ?? new List<string>();
+                    }
+                    SendDirectory();
+                    break;
+                case "handoff":
+                    _ = HandoffAsync(message);
+                    break;
+                case "call":
+                case "reply":
+                    Forward(message);
+                    break;
+            }
+        }
+
+        lock (_lock)
+        {
+            if (_links.GetValueOrDefault(node) != link) return;
+            _links.Remove(node);
+            _users.Remove(node);
+        }
+        link.Dispose();
+        Logger.Warning($"Router: node {node} unlinked", LogCategory.Network);
+        SendDirectory();
+    }
+
+    /// <summary>
+    /// Pass a message on to the node in To. A call to a node that isn't
+    /// linked is answered with an error.
+    /// </summary>
+    private void Forward(ClusterMessage message)
+    {
+        ClusterLink? to, from;
+        lock (_lock)
+        {
+            to = message.To != null ? _links.GetValueOrDefault(message.To) : null;
+            from = _links.GetValueOrDefault(message.From!);
+        }
+
+        if (to?.Send(message) == true) return;
+        if (message.Type == "call")
+        {
+            from?.Send(new ClusterMessage { Type = "reply", From = message.To, To = message.From, Id = message.Id, Error = $"node {message.To} is down" });
+        }
+    }
+
+    private void SendDirectory()
+    {
+        List<ClusterLink> links;
+        var directory = new Dictionary<string, string>();
+        lock (_lock)
+        {
+            foreach (var (node, users) in _users)
+            {
+                foreach (var user in users)
+                {
+                    directory[user] = node;
+                }
+            }
+            links = _links.Values.ToList();
+        }
+
+        var message = new ClusterMessage { Type = "directory", Users = directory };
+        foreach (var link in links)
+        {
+            link.Send(message);
+        }
+    }
+
+    #endregion
+
+    public void Dispose()
+    {
+        _stop.Cancel();
+        _listener.Dispose();
+        _linkListener.Dispose();
+        lock (_lock)
+        {
+            foreach (var route in _routes.Values)
+            {
+                route.Client.Dispose();
+                route.Upstream.Dispose();
+            }
+            _routes.Clear();
+            foreach (var link in _links.Values)
+            {
+                link.Dispose();
+            }
+            _links.Clear();
+        }
+    }
+}
@@ -0,0 +1,201 @@
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// Pinkfish-style color markup in output: %^RED%^, %^B_BLUE%^, %^BOLD%^,
+/// %^RESET%^ and so on, plus %^F208%^ / %^B017%^ for xterm color numbers.
+/// The mudlib writes markup and never escape codes; what a client receives
+/// depends on its terminal's ColorSupport. Plain clients get the markup
+/// stripped, ANSI clients the 16 colors (xterm numbers mapped to the
+/// nearest), and xterm clients the full palette.
+///
+/// "%^" that doesn't start a known token is left as it is. A message that
+/// leaves a color on is reset at its end, so one message can't bleed into
+/// the next.
+/// </summary>
+public static class ColorMarkup
+{
+    public const string Delimiter = "%^";
+    private const string Reset = "\u001b[0m";
+
+    private static readonly Dictionary<string, string> Codes = new(StringComparer.Ordinal)
+    {
+        ["RESET"] = Reset,
+        ["BOLD"] = "\u001b[1m",
+        ["ULINE"] = "\u001b[4m",
+        ["FLASH"] = "\u001b[5m",
+        ["REVERSE"] = "\u001b[7m",
+        ["BLACK"] = "\u001b[30m",
+        ["RED"] = "\u001b[31m",
+        ["GREEN"] = "\u001b[32m",
+        ["ORANGE"] = "\u001b[33m",
+        ["YELLOW"] = "\u001b[1;33m",
+        ["BLUE"] = "\u001b[34m",
+        ["MAGENTA"] = "\u001b[35m",
+        ["CYAN"] = "\u001b[36m",
+        ["WHITE"] = "\u001b[37m",
+        ["B_BLACK"] = "\u001b[40m",
+        ["B_RED"] = "\u001b[41m",
+        ["B_GREEN"] = "\u001b[42m",
+        ["B_ORANGE"] = "\u001b[43m",
+        ["B_YELLOW"] = "\u001b[43m",
+        ["B_BLUE"] = "\u001b[44m",
+        ["B_MAGENTA"] = "\u001b[45m",
+        ["B_CYAN"] = "\u001b[46m",
+        ["B_WHITE"] = "\u001b[47m"
+    };
+
+    /// <summary>
+    /// Whether text has anything that might be markup; text without it
+    /// renders to itself for every class.
+    /// </summary>
+    public static bool HasMarkup(string text) => text.Contains(Delimiter, StringComparison.Ordinal);
+
+    /// <summary>
+    /// text with its markup turned into escape codes for support (or removed).
+    /// </summary>
+    public static string Render(string text, ColorSupport support)
+    {
+        int start = text.IndexOf(Delimiter, StringComparison.Ordinal);
+        if (start < 0) return text;
+
+        var sb = new StringBuilder(text.Length + 32);
+        sb.Append(text, 0, start);
+        bool colored = false;
+        while (start >= 0)
+        {
+            int end = text.IndexOf(Delimiter, start + 2, StringComparison.Ordinal);
+            var code = end < 0 ? null : Code(text.AsSpan(start + 2, end - start - 2), support);
+            int next;
+            if (code == null)
+            {
+                // Not a token: keep the first delimiter and look again after it
+                sb.Append(Delimiter);
+                next = start + 2;
+            }
+            else
+            {
+                sb.Append(code);
+                if (code.Length > 0) colored = code != Reset;
+                next = end + 2;
+            }
+
+            start = text.IndexOf(Delimiter, next, StringComparison.Ordinal);
+            sb.Append(text, next, (start < 0 ? text.Length : start) - next);
+        }
+
+        if (colored) sb.Append(Reset);
+        return sb.ToString();
+    }
+
+    /// <summary>
+    /// The escape code for a token, "" for a known token under
+    /// ColorSupport.None, or null if token isn't one.
+    /// </summary>
+    private static string? Code(ReadOnlySpan<char> token, ColorSupport support)
+    {
+        if (token.Length == 4 && (token[0] == 'F' || token[0] == 'B') &&
+            int.TryParse(token[1..], out var number) && number <= 255)
+        {
+            bool background = token[0] == 'B';
+            return support switch
+            {
+                ColorSupport.None => "",
+                ColorSupport.Ansi => AnsiColor(Nearest16(number), background),
+                _ => background ? $"\u001b[48;5;{number}m" : $"\u001b[38;5;{number}m"
+            };
+        }
+
+        if (token.Length > 9 || !Codes.TryGetValue(token.ToString(), out var code)) return null;
+        return support == ColorSupport.None ? "" : code;
+    }
+
+    private static string AnsiColor(int color, bool background)
+    {
+        int baseCode = background ? 40 : 30;
+        return color < 8
+            ? $"\u001b[{baseCode + color}m"
+            : background ? $"\u001b[{baseCode + color - 8}m" : $"\u001b[1;{baseCode + color - 8}m";
+    }
+
+    /// <summary>
+    /// The nearest of the 16 ANSI colors (0-7 normal, 8-15 bright) to an xterm color.
+    /// </summary>
+    public static int Nearest16(int xterm)
+    {
+        if (xterm < 16) return xterm;
+
+        int r, g, b;
+        if (xterm >= 232)
+        {
+            r = g = b = 8 + (xterm - 232) * 10;
+        }
+        else
+        {
+            int cube = xterm - 16;
+            r = CubeLevel(cube / 36);
+            g = CubeLevel(cube / 6 % 6);
+            b = CubeLevel(cube % 6);
+        }
+
+        int best = 0;
+        int bestDistance = int.MaxValue;
+        for (int i = 0; i < 16; i++)
+        {
+            var (pr, pg, pb) = Palette16[i];
+            int distance = (r - pr) * (r - pr) + (g - pg) * (g - pg) + (b - pb) * (b - pb);
+            if (distance < bestDistance)
+            {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+        return best;
+    }
+
+    private static int CubeLevel(int level) => level == 0 ? 0 : 55 + level * 40;
+
+    private static readonly (int R, int G, int B)[] Palette16 =
+    {
+        (0, 0, 0), (205, 0, 0), (0, 205, 0), (205, 205, 0), (0, 0, 238), (205, 0, 205), (0, 205, 205), (229, 229, 229),
+        (127, 127, 127), (255, 0, 0), (0, 255, 0), (255, 255, 0), (92, 92, 255), (255, 0, 255), (0, 255, 255), (255, 255, 255)
+    };
+}
+
+/// <summary>
+/// Renders a batch of output for many clients, each message once per color
+/// class. A broadcast (tell_room(), a channel) queues the same string for
+/// every listener, so the cache is keyed by the string instance: three
+/// hundred players in two classes cost two renders. Used by the server
+/// thread for one drain of the output queue, then cleared.
+/// </summary>
+public sealed class ColorRenderer
+{
+    private readonly Dictionary<string, string?[]> _rendered = new(ReferenceEqualityComparer.Instance);
+
+    /// <summary>
+    /// Renders done, as opposed to served from the cache.
+    /// </summary>
+    public long Renders { get; private set; }
+
+    public string Render(string text, ColorSupport support)
+    {
+        if (!ColorMarkup.HasMarkup(text)) return text;
+
+        if (!_rendered.TryGetValue(text, out var variants))
+        {
+            variants = new string?[3];
+            _rendered[text] = variants;
+        }
+        if (variants[(int)support] is { } rendered) return rendered;
+
+        Renders++;
+        return variants[(int)support] = ColorMarkup.Render(text, support);
+    }
+
+    /// <summary>
+    /// Forget this batch's messages.
+    /// </summary>
+    public void Clear() => _rendered.Clear();
+}
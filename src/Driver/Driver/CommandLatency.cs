@@ -0,0 +1,276 @@
+using System.Diagnostics;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// The stages a player command passes through, each ending when the next
+/// begins.
+/// </summary>
+public enum CommandStage
+{
+    /// <summary>From the socket read that completed the line to it being queued.</summary>
+    Read,
+    /// <summary>Waiting in the command scheduler for the connection's turn.</summary>
+    Queue,
+    /// <summary>Running on the game thread.</summary>
+    Run,
+    /// <summary>Output waiting in the game loop's output queue for the server thread.</summary>
+    Output,
+    /// <summary>From the server taking the output to the socket write finishing.</summary>
+    Send
+}
+
+/// <summary>
+/// The LPC calls one command made, in call order with their depth, for the
+/// slow command log. Only the first MaxCalls are kept; the rest are counted.
+/// Used by the thread running the command only.
+/// </summary>
+public sealed class CallTrace
+{
+    public const int MaxCalls = 64;
+
+    public readonly record struct Call(int Depth, string Name, long Microseconds);
+
+    private readonly List<(int Depth, string Name, long Start, long Elapsed)> _calls = new();
+
+    /// <summary>
+    /// Calls made past MaxCalls.
+    /// </summary>
+    public int Dropped { get; private set; }
+
+    /// <summary>
+    /// A function was entered at depth (1 for a top-level call). Returns the
+    /// handle to pass to Exit, or -1 if the call isn't kept.
+    /// </summary>
+    public int Enter(string program, string function, int depth)
+    {
+        if (_calls.Count >= MaxCalls)
+        {
+            Dropped++;
+            return -1;
+        }
+        _calls.Add((depth, $"{program}:{function}", Stopwatch.GetTimestamp(), 0));
+        return _calls.Count - 1;
+    }
+
+    /// <summary>
+    /// The call Enter() returned handle for returned or threw.
+    /// </summary>
+    public void Exit(int handle)
+    {
+        var call = _calls[handle];
+        _calls[handle] = call with { Elapsed = Stopwatch.GetTimestamp() - call.Start };
+    }
+
+    /// <summary>
+    /// The calls kept so far, with how long each took.
+    /// </summary>
+    public List<Call> Recorded() => _calls
+        .Select(call => new Call(call.Depth, call.Name, call.Elapsed * 1_000_000 / Stopwatch.Frequency))
+        .ToList();
+}
+
+/// <summary>
+/// One player command on its way through the driver, stamped with
+/// Stopwatch timestamps as it reaches each stage. The network thread, the
+/// game thread and the connection's send loop each stamp their own stage in
+/// turn, so no two write it at once; the last stamp hands it to its
+/// CommandLatency.
+/// </summary>
+public sealed class CommandTrace
+{
+    private static readonly int StageCount = Enum.GetValues<CommandStage>().Length;
+
+    // When each stage began; the last entry is when the Send stage ended
+    private readonly long[] _stamps = new long[StageCount + 1];
+    private readonly CommandLatency _owner;
+
+    public string ConnectionId { get; }
+    public string Input { get; }
+
+    /// <summary>
+    /// The LPC calls the command made, while it runs with a slow threshold set.
+    /// </summary>
+    public CallTrace? Calls { get; internal set; }
+
+    internal CommandTrace(CommandLatency owner, string connectionId, string input, long received)
+    {
+        _owner = owner;
+        ConnectionId = connectionId;
+        Input = input;
+        _stamps[(int)CommandStage.Read] = received;
+        _stamps[(int)CommandStage.Queue] = Stopwatch.GetTimestamp();
+    }
+
+    /// <summary>
+    /// The command reached stage.
+    /// </summary>
+    public void Reached(CommandStage stage)
+    {
+        _stamps[(int)stage] = Stopwatch.GetTimestamp();
+    }
+
+    /// <summary>
+    /// The command's output has been written to the socket.
+    /// </summary>
+    public void Sent()
+    {
+        _stamps[StageCount] = Stopwatch.GetTimestamp();
+        _owner.Record(this);
+    }
+
+    /// <summary>
+    /// Microseconds spent in stage.
+    /// </summary>
+    public long Microseconds(CommandStage stage) => ToMicroseconds(_stamps[(int)stage + 1] - _stamps[(int)stage]);
+
+    /// <summary>
+    /// Microseconds from the read to the send finishing.
+    /// </summary>
+    public long TotalMicroseconds => ToMicroseconds(_stamps[StageCount] - _stamps[0]);
+
+    private static long ToMicroseconds(long elapsedTimestamp) => elapsedTimestamp * 1_000_000 / Stopwatch.Frequency;
+}
+
+/// <summary>
+/// End-to-end player command latency, split by stage: read off the socket,
+/// queued for the game thread, run, waiting to be picked up for the network,
+/// and written to the socket (see CommandStage). TickProfiler times the run
+/// by verb; this says where the rest of a slow command's time went, so
+/// network, queueing and interpreter costs can be told apart.
+///
+/// Each stage, and the whole, has a log2 histogram like the tick profiler's.
+/// A command slower than SlowThresholdMs in all is logged with its stages and
+/// the LPC calls it made, and the last MaxSlowCommands are kept for
+/// tick_stats(). Commands are traced from when they are queued while
+/// playing; speedwalk steps and login input are not. Safe from any thread.
+/// </summary>
+public sealed class CommandLatency
+{
+    /// <summary>
+    /// Slow command reports kept (oldest dropped first).
+    /// </summary>
+    public const int MaxSlowCommands = 10;
+
+    private static readonly CommandStage[] Stages = Enum.GetValues<CommandStage>();
+
+    /// <summary>
+    /// A command that took longer than the slow threshold.
+    /// </summary>
+    public record SlowCommand(DateTime When, string ConnectionId, string Input, long Microseconds,
+        long[] StageMicroseconds, List<CallTrace.Call> Calls, int DroppedCalls);
+
+    private readonly object _lock = new();
+    private readonly TickProfiler.Histogram _total = new();
+    private readonly TickProfiler.Histogram[] _stages;
+    private readonly Queue<SlowCommand> _slowCommands = new();
+
+    public CommandLatency()
+    {
+        _stages = Stages.Select(_ => new TickProfiler.Histogram()).ToArray();
+    }
+
+    /// <summary>
+    /// Commands taking longer than this from read to send are logged with
+    /// their LPC calls; 0 logs none and doesn't trace calls.
+    /// </summary>
+    public int SlowThresholdMs { get; set; } = 1000;
+
+    /// <summary>
+    /// Start tracing a command read off the socket at the Stopwatch
+    /// timestamp received and being queued now.
+    /// </summary>
+    public CommandTrace Begin(string connectionId, string input, long received)
+    {
+        return new CommandTrace(this, connectionId, input, received);
+    }
+
+    /// <summary>
+    /// Record a command whose output has gone out (called by CommandTrace.Sent).
+    /// </summary>
+    internal void Record(CommandTrace trace)
+    {
+        long total = trace.TotalMicroseconds;
+        var stages = Stages.Select(trace.Microseconds).ToArray();
+        SlowCommand? slow = null;
+        if (SlowThresholdMs > 0 && total > SlowThresholdMs * 1000L)
+        {
+            slow = new SlowCommand(DateTime.UtcNow, trace.ConnectionId, trace.Input, total, stages,
+                trace.Calls?.Recorded() ?? new List<CallTrace.Call>(), trace.Calls?.Dropped ?? 0);
+        }
+
+        lock (_lock)
+        {
+            _total.Record(total);
+            for (int i = 0; i < stages.Length; i++)
+            {
+                _stages[i].Record(stages[i]);
+            }
+            if (slow != null)
+            {
+                _slowCommands.Enqueue(slow);
+                if (_slowCommands.Count > MaxSlowCommands)
+                {
+                    _slowCommands.Dequeue();
+                }
+            }
+        }
+
+        if (slow != null)
+        {
+            Logger.Warning(FormatSlow(slow), LogCategory.System);
+        }
+    }
+
+    /// <summary>
+    /// The slow command log entry: stages on the first line, then the calls
+    /// indented by depth.
+    /// </summary>
+    public static string FormatSlow(SlowCommand slow)
+    {
+        var sb = new StringBuilder();
+        sb.Append($"Slow command from {slow.ConnectionId}: \"{slow.Input}\" {slow.Microseconds / 1000.0:F1}ms (");
+        sb.AppendJoin(", ", Stages.Select(stage =>
+            $"{stage.ToString().ToLowerInvariant()} {slow.StageMicroseconds[(int)stage] / 1000.0:F1}ms"));
+        sb.Append(')');
+        foreach (var call in slow.Calls)
+        {
+            sb.Append('\n').Append(' ', call.Depth * 2).Append($"{call.Name} {call.Microseconds / 1000.0:F1}ms");
+        }
+        if (slow.DroppedCalls > 0)
+        {
+            sb.Append($"\n  ... {slow.DroppedCalls} more calls");
+        }
+        return sb.ToString();
+    }
+
+    /// <summary>
+    /// Read the stats under the lock: the whole, each stage (indexed by
+    /// CommandStage) and the slow commands. The histograms passed to the
+    /// callback must not be kept.
+    /// </summary>
+    public T Read<T>(Func<TickProfiler.Histogram, IReadOnlyList<TickProfiler.Histogram>, IReadOnlyCollection<SlowCommand>, T> reader)
+    {
+        lock (_lock)
+        {
+            return reader(_total, _stages, _slowCommands);
+        }
+    }
+
+    /// <summary>
+    /// Forget everything recorded so far.
+    /// </summary>
+    public void Clear()
+    {
+        lock (_lock)
+        {
+            _total.Clear();
+            foreach (var stage in _stages)
+            {
+                stage.Clear();
+            }
+            _slowCommands.Clear();
+        }
+    }
+}
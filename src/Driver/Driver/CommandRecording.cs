@@ -0,0 +1,296 @@
+using System.Diagnostics;
+using System.Text;
+using System.Text.Json;
+using System.Text.Json.Serialization;
+
+namespace Driver;
+
+public enum RecordedEventKind
+{
+    Login,
+    Command,
+    Disconnect
+}
+
+/// <summary>
+/// One line of a command recording: Ms after recording started, the
+/// connection, and the username (Login) or input line (Command).
+/// </summary>
+public record RecordedEvent(long Ms, RecordedEventKind Kind, string ConnectionId, string Text = "");
+
+/// <summary>
+/// Writes the command stream of a running server to a file, for --replay.
+///
+///     #recording 1 seed 123456789
+///     0	login	conn-1	bob
+///     1520	cmd	conn-1	look
+///     9410	close	conn-1
+///
+/// Fields are tab separated; tabs, newlines and backslashes in input are
+/// escaped. Input is recorded from players who are in the game and not
+/// answering a no-echo input_to(), so passwords never reach the file: a
+/// replay logs players straight in by name instead. random() is seeded with
+/// the header's seed for the whole run.
+/// </summary>
+public sealed class CommandRecorder : IDisposable
+{
+    private readonly object _lock = new();
+    private readonly StreamWriter _writer;
+    private readonly Stopwatch _clock = Stopwatch.StartNew();
+    private bool _dirty;
+
+    public string Path { get; }
+    public int Seed { get; }
+
+    /// <summary>
+    /// Events written so far.
+    /// </summary>
+    public long Events { get; private set; }
+
+    /// <summary>
+    /// Start a recording at path, replacing any file there, and seed random().
+    /// </summary>
+    public CommandRecorder(string path, int? seed = null)
+    {
+        Path = System.IO.Path.GetFullPath(path);
+        Seed = seed ?? System.Random.Shared.Next();
+        _writer = new StreamWriter(Path, append: false, new UTF8Encoding(false));
+        _writer.WriteLine($"{CommandRecording.Header} seed {Seed}");
+        EfunRegistry.SeedRandom(Seed);
+    }
+
+    public void Login(string connectionId, string username) => Write("login", connectionId, username);
+
+    public void Command(string connectionId, string input) => Write("cmd", connectionId, input);
+
+    public void Disconnect(string connectionId) => Write("close", connectionId, null);
+
+    /// <summary>
+    /// Push what has been written to the file. Called once a tick.
+    /// </summary>
+    public void Flush()
+    {
+        lock (_lock)
+        {
+            if (!_dirty) return;
+            _dirty = false;
+            _writer.Flush();
+        }
+    }
+
+    public void Dispose()
+    {
+        lock (_lock)
+        {
+            _writer.Dispose();
+        }
+    }
+
+    private void Write(string kind, string connectionId, string? text)
+    {
+        var line = new StringBuilder();
+        line.Append(_clock.ElapsedMilliseconds).Append('\t').Append(kind).Append('\t').Append(connectionId);
+        if (text != null)
+        {
+            line.Append('\t').Append(Escape(text));
+        }
+
+        lock (_lock)
+        {
+            _writer.WriteLine(line);
+            _dirty = true;
+            Events++;
+        }
+    }
+
+    private static string Escape(string text)
+    {
+        if (text.AsSpan().IndexOfAny("\\\t\r\n") < 0) return text;
+        return text.Replace("\\", "\\\\").Replace("\t", "\\t").Replace("\r", "\\r").Replace("\n", "\\n");
+    }
+}
+
+/// <summary>
+/// A command recording read back from its file.
+/// </summary>
+public sealed class CommandRecording
+{
+    public const string Header = "#recording 1";
+
+    public int Seed { get; }
+    public IReadOnlyList<RecordedEvent> Events { get; }
+
+    private CommandRecording(int seed, List<RecordedEvent> events)
+    {
+        Seed = seed;
+        Events = events;
+    }
+
+    /// <summary>
+    /// Read a recording. A torn last line, as a crash leaves it, is dropped.
+    /// </summary>
+    public static CommandRecording Load(string path)
+    {
+        using var reader = new StreamReader(path);
+        var header = reader.ReadLine() ?? "";
+        var headerParts = header.Split(' ');
+        if (!header.StartsWith(Header + " seed ", StringComparison.Ordinal) || !int.TryParse(headerParts[^1], out var seed))
+        {
+            throw new InvalidDataException($"{path} is not a command recording");
+        }
+
+        var events = new List<RecordedEvent>();
+        string? line;
+        while ((line = reader.ReadLine()) != null)
+        {
+            var fields = line.Split('\t');
+            if (fields.Length < 3 || !long.TryParse(fields[0], out var ms)) continue;
+
+            RecordedEvent? recorded = fields[1] switch
+            {
+                "login" when fields.Length == 4 => new RecordedEvent(ms, RecordedEventKind.Login, fields[2], fields[3]),
+                "cmd" when fields.Length == 4 => new RecordedEvent(ms, RecordedEventKind.Command, fields[2], Unescape(fields[3])),
+                "close" => new RecordedEvent(ms, RecordedEventKind.Disconnect, fields[2]),
+                _ => null
+            };
+            if (recorded != null)
+            {
+                events.Add(recorded);
+            }
+        }
+        return new CommandRecording(seed, events);
+    }
+
+    private static string Unescape(string text)
+    {
+        if (!text.Contains('\\')) return text;
+
+        var sb = new StringBuilder(text.Length);
+        for (int i = 0; i < text.Length; i++)
+        {
+            if (text[i] != '\\' || i + 1 == text.Length)
+            {
+                sb.Append(text[i]);
+                continue;
+            }
+            sb.Append(text[++i] switch { 't' => '\t', 'r' => '\r', 'n' => '\n', var c => c });
+        }
+        return sb.ToString();
+    }
+}
+
+/// <summary>
+/// Results of a replay. Command latencies are from being queued to having
+/// run, as the tick profiler measures them; percentiles are the upper bound
+/// of the profiler's power-of-two buckets, averages and maxima are exact.
+/// </summary>
+public sealed class ReplayReport
+{
+    public record Latency(string Command, long Count, double AverageMs, double P50Ms, double P95Ms, double P99Ms, double MaxMs);
+
+    public long Ticks { get; init; }
+    public double Seconds { get; init; }
+    public double TicksPerSecond => Seconds > 0 ? Ticks / Seconds : 0;
+    public double RecordedSeconds { get; init; }
+    public int Logins { get; init; }
+    public int MissingAccounts { get; init; }
+    public long Commands { get; init; }
+    public double CommandsPerSecond => Seconds > 0 ? Commands / Seconds : 0;
+    public List<Latency> Latencies { get; init; } = new();
+
+    public string ToJson() => JsonSerializer.Serialize(this, ReplayJsonContext.Default.ReplayReport);
+
+    public override string ToString()
+    {
+        var sb = new StringBuilder();
+        sb.AppendLine($"Replayed {RecordedSeconds:F1}s of recording in {Seconds:F2}s");
+        sb.AppendLine($"Ticks: {Ticks} ({TicksPerSecond:F0}/s)");
+        sb.AppendLine($"Logins: {Logins}, {MissingAccounts} without an account in this mudlib");
+        sb.AppendLine($"Commands: {Commands} ({CommandsPerSecond:F0}/s)");
+        sb.AppendLine($"  {"command",-12} {"count",8} {"avg ms",8} {"p50",8} {"p95",8} {"p99",8} {"max",8}");
+        foreach (var latency in Latencies)
+        {
+            sb.AppendLine($"  {latency.Command,-12} {latency.Count,8} {latency.AverageMs,8:F2} {latency.P50Ms,8:F2} {latency.P95Ms,8:F2} {latency.P99Ms,8:F2} {latency.MaxMs,8:F2}");
+        }
+        return sb.ToString();
+    }
+}
+
+/// <summary>
+/// Runs a command recording against a game loop that isn't started, as fast
+/// as it goes: each event is fed in before the tick it was recorded in, and
+/// ticks run back to back on the calling thread with the loop's clock
+/// stepping one tick at a time, so callouts, resets and heartbeats fall on
+/// the same ticks as in the recording. Output is thrown away.
+/// </summary>
+public static class CommandReplay
+{
+    public static ReplayReport Run(GameLoop gameLoop, CommandRecording recording)
+    {
+        EfunRegistry.SeedRandom(recording.Seed);
+        gameLoop.TickProfiler.Clear();
+
+        var events = recording.Events;
+        long lastTick = events.Count == 0 ? 0 : events[^1].Ms / GameLoop.TickIntervalMs + 1;
+        int next = 0, logins = 0, missing = 0;
+        long commands = 0;
+
+        var started = Stopwatch.StartNew();
+        for (long tick = 0; tick <= lastTick; tick++)
+        {
+            for (; next < events.Count && events[next].Ms / GameLoop.TickIntervalMs <= tick; next++)
+            {
+                var recorded = events[next];
+                switch (recorded.Kind)
+                {
+                    case RecordedEventKind.Login:
+                        logins++;
+                        if (!gameLoop.AccountManager.AccountExists(recorded.Text)) missing++;
+                        gameLoop.ResumePlayerSession(recorded.ConnectionId, "replay", recorded.Text);
+                        break;
+                    case RecordedEventKind.Command:
+                        commands++;
+                        gameLoop.QueueCommand(recorded.ConnectionId, recorded.Text);
+                        break;
+                    case RecordedEventKind.Disconnect:
+                        gameLoop.RemovePlayerSession(recorded.ConnectionId);
+                        break;
+                }
+            }
+
+            gameLoop.Step();
+            while (gameLoop.TryDequeueOutput(out _))
+            {
+            }
+        }
+        started.Stop();
+
+        var latencies = gameLoop.TickProfiler.ReadCommands(verbs => verbs
+            .OrderByDescending(verb => verb.Value.Count)
+            .Select(verb => new ReplayReport.Latency(verb.Key, verb.Value.Count,
+                verb.Value.AverageMicroseconds / 1000.0, verb.Value.Percentile(50) / 1000.0,
+                verb.Value.Percentile(95) / 1000.0, verb.Value.Percentile(99) / 1000.0,
+                verb.Value.MaxMicroseconds / 1000.0))
+            .ToList());
+
+        return new ReplayReport
+        {
+            Ticks = lastTick + 1,
+            Seconds = started.Elapsed.TotalSeconds,
+            RecordedSeconds = events.Count == 0 ? 0 : events[^1].Ms / 1000.0,
+            Logins = logins,
+            MissingAccounts = missing,
+            Commands = commands,
+            Latencies = latencies
+        };
+    }
+}
+
+/// <summary>
+/// Source-generated serializer for --replay --json.
+/// </summary>
+[JsonSourceGenerationOptions(WriteIndented = true)]
+[JsonSerializable(typeof(ReplayReport))]
+internal partial class ReplayJsonContext : JsonSerializerContext
+{
+}
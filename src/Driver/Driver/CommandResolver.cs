@@ -0,0 +1,144 @@
+using System.Collections.Concurrent;
+
+namespace Driver;
+
+/// <summary>
+/// Finds the /cmds/ files a verb can run for an access level.
+///
+/// Admins search /cmds/admin, /cmds/wizard and /cmds/std, wizards the last two
+/// and players only /cmds/std; the first file found wins. Results, including
+/// "no such command", are cached per (access level, verb) so typos and
+/// add_action-only verbs cost a dictionary lookup instead of a disk check per
+/// directory. A FileSystemWatcher on mudlib/cmds drops the cache whenever a
+/// command file appears, disappears or is renamed.
+///
+/// Caching only happens while watching, so nothing can go stale unnoticed.
+/// </summary>
+public sealed class CommandResolver : IDisposable
+{
+    /// <summary>
+    /// Cached verbs kept before the cache starts over, so a flood of junk
+    /// verbs can't grow it without bound.
+    /// </summary>
+    public const int MaxCachedVerbs = 4096;
+
+    private readonly string _mudlibPath;
+    private readonly ConcurrentDictionary<(AccessLevel, string), string[]> _cache = new();
+    private FileSystemWatcher? _watcher;
+    private long _generation;
+
+    public CommandResolver(string mudlibPath)
+    {
+        _mudlibPath = mudlibPath;
+    }
+
+    /// <summary>
+    /// Whether a watcher is running (and results are cached).
+    /// </summary>
+    public bool IsWatching => _watcher != null;
+
+    /// <summary>
+    /// Number of cached (access level, verb) entries.
+    /// </summary>
+    public int CachedCount => _cache.Count;
+
+    /// <summary>
+    /// Start watching mudlib/cmds and caching lookups. Does nothing if the
+    /// directory doesn't exist.
+    /// </summary>
+    public void StartWatching()
+    {
+        if (_watcher != null) return;
+
+        var cmdsPath = Path.Combine(_mudlibPath, "cmds");
+        if (!Directory.Exists(cmdsPath)) return;
+
+        var watcher = new FileSystemWatcher(cmdsPath)
+        {
+            IncludeSubdirectories = true,
+            NotifyFilter = NotifyFilters.FileName | NotifyFilters.DirectoryName
+        };
+        watcher.Created += (_, _) => Invalidate();
+        watcher.Deleted += (_, _) => Invalidate();
+        watcher.Renamed += (_, _) => Invalidate();
+        watcher.Error += (_, _) => Invalidate();
+        watcher.EnableRaisingEvents = true;
+
+        Invalidate();
+        _watcher = watcher;
+    }
+
+    /// <summary>
+    /// Forget every cached lookup.
+    /// </summary>
+    public void Invalidate()
+    {
+        Interlocked.Increment(ref _generation);
+        _cache.Clear();
+    }
+
+    /// <summary>
+    /// The existing command files for a verb, best match first, as object
+    /// paths ("/cmds/std/look"). Empty if there are none.
+    /// </summary>
+    public string[] Resolve(string verb, AccessLevel accessLevel)
+    {
+        // Verbs are file names; anything that could leave /cmds/ has no command
+        if (verb.Length == 0 || verb.Contains('/') || verb.Contains('\\') || verb.Contains(".."))
+        {
+            return Array.Empty<string>();
+        }
+
+        var key = (accessLevel, verb);
+        if (_cache.TryGetValue(key, out var cached))
+        {
+            return cached;
+        }
+
+        // A change seen while probing the disk means the result may be stale
+        long generation = Interlocked.Read(ref _generation);
+        var found = Probe(verb, accessLevel);
+
+        if (_watcher != null && Interlocked.Read(ref _generation) == generation)
+        {
+            if (_cache.Count >= MaxCachedVerbs)
+            {
+                _cache.Clear();
+            }
+            _cache[key] = found;
+        }
+        return found;
+    }
+
+    private string[] Probe(string verb, AccessLevel accessLevel)
+    {
+        List<string>? found = null;
+
+        void Check(string directory)
+        {
+            if (File.Exists(Path.Combine(_mudlibPath, "cmds", directory, verb + ".c")))
+            {
+                (found ??= new List<string>()).Add($"/cmds/{directory}/{verb}");
+            }
+        }
+
+        if (accessLevel >= AccessLevel.Admin)
+        {
+            Check("admin");
+        }
+        if (accessLevel >= AccessLevel.Wizard)
+        {
+            Check("wizard");
+        }
+        Check("std");
+
+        return found?.ToArray() ?? Array.Empty<string>();
+    }
+
+    public void Dispose()
+    {
+        _watcher?.Dispose();
+        _watcher = null;
+        _cache.Clear();
+    }
+}
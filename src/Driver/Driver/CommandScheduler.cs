@@ -0,0 +1,215 @@
+using System.Collections.Concurrent;
+
+namespace Driver;
+
+/// <summary>
+/// Player input waiting for the game thread, queued per connection and
+/// served round-robin.
+///
+/// With a single FIFO, one player pasting a 200-line script held everyone
+/// else's commands back by whole ticks. Here each connection with input
+/// waiting gets one turn at a time: run one command, go to the back of the
+/// line. A tick stops handing out turns when it has run MaxCommandsPerTick
+/// commands or its commands have run MaxInstructionsPerTick LPC
+/// instructions; whoever is left keeps their place for the next tick.
+///
+/// A speedwalk (".3n2e") becomes steps on its own connection's queue. They
+/// go SpeedwalkStepsPerTurn to a turn, ahead of that connection's other
+/// input, so a walk is quick without crowding anyone out.
+///
+/// Enqueue and Remove are safe from any thread; the rest is game thread only.
+/// </summary>
+public sealed class CommandScheduler
+{
+    /// <summary>
+    /// Most commands (speedwalk steps included) run in one tick.
+    /// </summary>
+    public int MaxCommandsPerTick { get; set; } = 100;
+
+    /// <summary>
+    /// LPC instructions the tick's commands may run before the rest wait for
+    /// the next tick. A command that is already running always finishes.
+    /// </summary>
+    public long MaxInstructionsPerTick { get; set; } = 5_000_000;
+
+    /// <summary>
+    /// Speedwalk steps one turn runs.
+    /// </summary>
+    public int SpeedwalkStepsPerTurn { get; set; } = 4;
+
+    /// <summary>
+    /// Longest speedwalk accepted.
+    /// </summary>
+    public const int MaxSpeedwalkSteps = 50;
+
+    private sealed class ConnectionQueue
+    {
+        public readonly ConcurrentQueue<PlayerCommand> Pending = new();
+        public readonly Queue<PlayerCommand> Steps = new();
+
+        // 1 while the queue is in _ready (or being served)
+        public int Scheduled;
+        public bool Removed;
+    }
+
+    private readonly ConcurrentDictionary<string, ConnectionQueue> _queues = new();
+    private readonly ConcurrentQueue<ConnectionQueue> _ready = new();
+    private int _depth;
+
+    /// <summary>
+    /// Commands waiting, not counting speedwalk steps.
+    /// </summary>
+    public int Depth => Volatile.Read(ref _depth);
+
+    /// <summary>
+    /// Queue a line of input from a connection.
+    /// </summary>
+    public void Enqueue(PlayerCommand command)
+    {
+        var queue = _queues.GetOrAdd(command.ConnectionId, _ => new ConnectionQueue());
+        queue.Pending.Enqueue(command);
+        Interlocked.Increment(ref _depth);
+        Schedule(queue);
+    }
+
+    /// <summary>
+    /// Drop a closed connection's queue. Input it still had is discarded.
+    /// </summary>
+    public void Remove(string connectionId)
+    {
+        if (_queues.TryRemove(connectionId, out var queue))
+        {
+            queue.Removed = true;
+            while (queue.Pending.TryDequeue(out _))
+            {
+                Interlocked.Decrement(ref _depth);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Run a speedwalk for a connection: steps go ahead of its other input,
+    /// starting on its next turn. Game thread only.
+    /// </summary>
+    public void StartSpeedwalk(PlayerCommand command, IReadOnlyList<string> steps)
+    {
+        if (!_queues.TryGetValue(command.ConnectionId, out var queue)) return;
+
+        foreach (var step in steps)
+        {
+            queue.Steps.Enqueue(command with { Input = step, SpeedwalkStep = true });
+        }
+        Schedule(queue);
+    }
+
+    /// <summary>
+    /// Drop the rest of a connection's speedwalk. Game thread only.
+    /// </summary>
+    public void CancelSpeedwalk(string connectionId)
+    {
+        if (_queues.TryGetValue(connectionId, out var queue))
+        {
+            queue.Steps.Clear();
+        }
+    }
+
+    /// <summary>
+    /// Give out turns for one tick. process runs a command; instructions
+    /// reads the game thread's running LPC instruction count. Returns the
+    /// number of commands run.
+    /// </summary>
+    public int RunTick(Action<PlayerCommand> process, Func<long> instructions)
+    {
+        int run = 0;
+        long startInstructions = instructions();
+
+        // Queues scheduled during this tick join at the back, so a connection
+        // refilling itself can't jump ahead of others
+        while (run < MaxCommandsPerTick &&
+               instructions() - startInstructions < MaxInstructionsPerTick &&
+               _ready.TryDequeue(out var queue))
+        {
+            if (queue.Removed)
+            {
+                continue;
+            }
+
+            if (queue.Steps.Count > 0)
+            {
+                for (int i = 0; i < SpeedwalkStepsPerTurn && queue.Steps.TryDequeue(out var step); i++)
+                {
+                    process(step);
+                    run++;
+                }
+            }
+            else if (queue.Pending.TryDequeue(out var command))
+            {
+                Interlocked.Decrement(ref _depth);
+                process(command);
+                run++;
+            }
+
+            if (queue.Steps.Count > 0 || !queue.Pending.IsEmpty)
+            {
+                _ready.Enqueue(queue);
+            }
+            else
+            {
+                // Unschedule, then look again: input may have arrived in between
+                Volatile.Write(ref queue.Scheduled, 0);
+                if (!queue.Pending.IsEmpty)
+                {
+                    Schedule(queue);
+                }
+            }
+        }
+        return run;
+    }
+
+    private void Schedule(ConnectionQueue queue)
+    {
+        if (Interlocked.CompareExchange(ref queue.Scheduled, 1, 0) == 0)
+        {
+            _ready.Enqueue(queue);
+        }
+    }
+
+    /// <summary>
+    /// Parse a speedwalk: a '.' followed by directions (n, s, e, w, u, d),
+    /// each optionally preceded by a repeat count, e.g. ".3n2e" for
+    /// n, n, n, e, e. Returns null if input isn't one, or is over
+    /// MaxSpeedwalkSteps.
+    /// </summary>
+    public static List<string>? ParseSpeedwalk(string input)
+    {
+        var text = input.AsSpan().Trim();
+        if (text.Length < 2 || text[0] != '.') return null;
+
+        var steps = new List<string>();
+        int count = 0;
+        foreach (var c in text[1..])
+        {
+            if (char.IsAsciiDigit(c))
+            {
+                count = count * 10 + (c - '0');
+                if (count > MaxSpeedwalkSteps) return null;
+                continue;
+            }
+
+            var direction = char.ToLowerInvariant(c) switch
+            {
+                'n' => "n", 's' => "s", 'e' => "e", 'w' => "w", 'u' => "u", 'd' => "d",
+                _ => null
+            };
+            if (direction == null) return null;
+
+            for (int i = 0; i < Math.Max(count, 1); i++)
+            {
+                steps.Add(direction);
+            }
+            if (steps.Count > MaxSpeedwalkSteps) return null;
+            count = 0;
+        }
+        return count == 0 ? steps : null;
+    }
+}
@@ -1,4 +1,9 @@
+using System.Buffers;
+using System.Diagnostics;
+using System.IO.Compression;
+using System.Net;
 using System.Net.Sockets;
+using System.Net.WebSockets;
 using System.Text;
 
 namespace Driver;
@@ -6,6 +11,12 @@ namespace Driver;
 /// <summary>
 /// Represents a single client connection.
 /// Commands are queued to the GameLoop for processing.
+///
+/// Telnet by default. A connection made through the WebSocket port carries
+/// a WebSocket instead: each flushed batch of output (one tick's worth) is
+/// one text message, compressed by permessage-deflate if the client agreed
+/// to it, and each line of an incoming message is a command. Telnet option
+/// negotiation doesn't apply there.
 /// </summary>
 public class Connection : IDisposable
 {
@@ -13,158 +24,769 @@ public class Connection : IDisposable
     private const byte IAC = 255;   // Interpret As Command
     private const byte WILL = 251;  // Will do option
     private const byte WONT = 252;  // Won't do option
+    private const byte DO = 253;    // Please do option
+    private const byte DONT = 254;  // Please don't do option
+    private const byte SB = 250;    // Subnegotiation begin
+    private const byte SE = 240;    // Subnegotiation end
     private const byte ECHO = 1;    // Echo option
+    private const byte COMPRESS2 = 86; // MCCP2
+    private const byte NAWS = 31;   // Negotiate About Window Size
 
     private readonly TcpClient _client;
     private readonly NetworkStream _stream;
-    private readonly StreamWriter _writer;
-    private readonly StringBuilder _inputBuffer = new();
+    private readonly TelnetParser _telnet;
+    private readonly WebSocket? _webSocket;
+
+    private const int ReceiveBufferSize = 4096;
+
+    /// <summary>
+    /// Output gathered since the last flush, in the order it was sent.
+    /// Only touched by the server thread.
+    /// </summary>
+    private readonly StringBuilder _pendingOutput = new();
+
+    /// <summary>
+    /// Encoded output waiting for the socket, oldest first. Buffers are pooled.
+    /// Writers (server thread output, game thread echo negotiation) append under
+    /// _sendLock; a single async send loop drains it, so nobody blocks on a
+    /// slow client.
+    /// </summary>
+    private readonly Queue<(byte[] Buffer, int Length, bool Droppable)> _sendQueue = new();
+    private readonly object _sendLock = new();
+    private Task _sendLoop = Task.CompletedTask;
+    private bool _sending;
+    private bool _overflowed;
+
+    /// <summary>
+    /// Traced commands whose output is in the send queue, with the chunk
+    /// count (of _chunksQueued) their output ends at; their Send stage is
+    /// over once _chunksDone reaches it. Chunks written or dropped both count
+    /// as done. Under _sendLock.
+    /// </summary>
+    private readonly Queue<(long Chunk, CommandTrace Trace)> _sendTraces = new();
+    private long _chunksQueued;
+    private long _chunksDone;
+
+    /// <summary>
+    /// Traced commands whose output is still in _pendingOutput. Server thread only.
+    /// </summary>
+    private readonly List<CommandTrace> _flushTraces = new();
+
+    private readonly OutputLimits _limits;
+    private readonly Action<Connection>? _onOverflow;
+
+    /// <summary>
+    /// MCCP2 state. _compressionLevel is null when compression isn't offered.
+    /// Once the client accepts, everything sent goes through _deflate, whose
+    /// output lands in _compressedSink. _compressLock keeps compression and
+    /// queueing in the same order when the server and game threads both write.
+    /// </summary>
+    private readonly CompressionLevel? _compressionLevel;
+    private readonly object _compressLock = new();
+    private readonly MemoryStream _compressedSink = new();
+    private ZLibStream? _deflate;
     private readonly GameLoop _gameLoop;
     private readonly string _id;
 
-    private bool _disposed;
+    private readonly CancellationTokenSource _receiveCancellation = new();
+
+    private volatile bool _disposed;
+
+    // When the read that lines are being taken from completed (receive loop only)
+    private long _receivedAt;
+    private volatile bool _receiveClosed;
 
     public string Id => _id;
-    public bool IsConnected => _client.Connected && !_disposed;
 
-    public Connection(TcpClient client, GameLoop gameLoop)
+    /// <summary>
+    /// The client's IP address, if known.
+    /// </summary>
+    public string? RemoteAddress { get; }
+
+    /// <summary>
+    /// The underlying socket (handed on by a copyover).
+    /// </summary>
+    public Socket Socket => _client.Client;
+
+    /// <summary>
+    /// Whether the client came in through the WebSocket port.
+    /// </summary>
+    public bool IsWebSocket => _webSocket != null;
+    public bool IsConnected => _client.Connected && !_disposed && !_receiveClosed;
+
+    /// <summary>
+    /// Bytes accepted for sending that haven't reached the socket yet.
+    /// </summary>
+    public int QueuedBytes { get; private set; }
+
+    /// <summary>
+    /// Bytes written to the socket.
+    /// </summary>
+    public long BytesSent => Interlocked.Read(ref _bytesSent);
+    private long _bytesSent;
+
+    /// <summary>
+    /// Bytes discarded because the client wasn't reading fast enough.
+    /// </summary>
+    public long BytesDropped { get; private set; }
+
+    /// <summary>
+    /// Set once the output limit was exceeded under the Linkdead or Disconnect
+    /// policy; the server closes the connection.
+    /// </summary>
+    public bool Overflowed => _overflowed;
+
+    /// <summary>
+    /// Whether the client accepted MCCP2 and output is being compressed.
+    /// </summary>
+    public bool IsCompressing => _deflate != null;
+
+    /// <summary>
+    /// Bytes fed to the compressor.
+    /// </summary>
+    public long UncompressedBytes { get; private set; }
+
+    /// <summary>
+    /// Bytes the compressor produced for them.
+    /// </summary>
+    public long CompressedBytes { get; private set; }
+
+    /// <summary>
+    /// Whether the client accepted GMCP.
+    /// </summary>
+    public bool IsGmcp { get; private set; }
+
+    /// <summary>
+    /// What the client said about its terminal through TTYPE; null until it has.
+    /// </summary>
+    public TerminalInfo? Terminal { get; private set; }
+
+    /// <summary>
+    /// The color class output is rendered for: the player's choice if they
+    /// made one (ForceColor), else what TTYPE reported, else none.
+    /// </summary>
+    public ColorSupport Color => _forcedColor ?? Terminal?.Color ?? ColorSupport.None;
+
+    private volatile TerminalTypeNegotiation? _terminalType;
+    private ColorSupport? _forcedColor;
+
+    /// <summary>
+    /// The client's window width from NAWS, which output is wrapped to; 0 until it reports one.
+    /// </summary>
+    public int WindowWidth { get; private set; }
+
+    /// <summary>
+    /// The client's window height from NAWS; 0 until it reports one.
+    /// </summary>
+    public int WindowHeight { get; private set; }
+
+    private readonly TelnetTextEncoder _encoder = new();
+
+    /// <summary>
+    /// Header of the snooped connection whose output this one was last
+    /// given, null after its own output. Server thread only.
+    /// </summary>
+    public string? ObservedSource { get; set; }
+
+    /// <summary>
+    /// Uncompressed / compressed; 1 until compression has done anything.
+    /// </summary>
+    public double CompressionRatio => CompressedBytes == 0 ? 1.0 : (double)UncompressedBytes / CompressedBytes;
+
+    /// <param name="limits">Output queue bound and overflow policy (defaults to OutputLimits.Default)</param>
+    /// <param name="onOverflow">Called once when the limit is hit under Linkdead or Disconnect</param>
+    /// <param name="compression">Offer MCCP2 at this level; null to not offer it</param>
+    /// <param name="webSocket">The client's WebSocket, after WebSocketHandshake; null for telnet</param>
+    public Connection(TcpClient client, GameLoop gameLoop, OutputLimits? limits = null,
+        Action<Connection>? onOverflow = null, CompressionLevel? compression = null, WebSocket? webSocket = null)
     {
         _client = client;
         _gameLoop = gameLoop;
+        _limits = limits ?? OutputLimits.Default;
+        _onOverflow = onOverflow;
+        _webSocket = webSocket;
+        _compressionLevel = webSocket == null ? compression : null;
         _stream = client.GetStream();
-        _writer = new StreamWriter(_stream, Encoding.ASCII) { AutoFlush = true };
+        _telnet = new TelnetParser(OnLine, OnNegotiation, OnSubnegotiation);
         _id = Guid.NewGuid().ToString()[..8];
+        RemoteAddress = (client.Client.RemoteEndPoint as IPEndPoint)?.Address.ToString();
+
+        // Offer compression before anything else goes out
+        if (_compressionLevel != null)
+        {
+            SendRaw(stackalloc byte[] { IAC, WILL, COMPRESS2 });
+        }
+        if (webSocket == null)
+        {
+            SendRaw(stackalloc byte[] { IAC, WILL, Gmcp.Option });
+            SendRaw(stackalloc byte[] { IAC, DO, TerminalTypeNegotiation.Option });
+            SendRaw(stackalloc byte[] { IAC, DO, NAWS });
+        }
+    }
+
+    /// <summary>
+    /// Render output for this color class whatever the terminal reported;
+    /// null goes back to the reported one.
+    /// </summary>
+    public void ForceColor(ColorSupport? color)
+    {
+        _forcedColor = color;
     }
 
     /// <summary>
-    /// Send a message to this connection.
+    /// Send a message to this connection immediately.
     /// Converts Unix newlines (\n) to telnet newlines (\r\n).
     /// </summary>
     public void Send(string message)
     {
-        if (!IsConnected) return;
+        QueueOutput(message);
+        FlushOutput();
+    }
 
-        try
+    /// <summary>
+    /// Add a message to the output buffer; it goes out on the next FlushOutput().
+    /// </summary>
+    public void QueueOutput(string message)
+    {
+        _pendingOutput.Append(message);
+    }
+
+    /// <summary>
+    /// Whether QueueOutput() has buffered anything since the last flush.
+    /// </summary>
+    public bool HasPendingOutput => _pendingOutput.Length > 0;
+
+    /// <summary>
+    /// Hand all buffered output to the socket as one write.
+    /// The whole batch is encoded once, straight into a pooled byte buffer:
+    /// newlines converted and, if the client reported its window size,
+    /// word wrapped (TelnetTextEncoder). Never blocks: the bytes join the
+    /// send queue and go out as the client reads.
+    /// </summary>
+    public void FlushOutput()
+    {
+        if (_pendingOutput.Length == 0)
         {
-            // Convert \n to \r\n for telnet, but don't double-convert \r\n
-            var telnetMessage = message.Replace("\r\n", "\n").Replace("\n", "\r\n");
-            _writer.Write(telnetMessage);
+            if (_flushTraces.Count > 0) TrackSends();
+            return;
         }
-        catch (IOException)
+
+        if (!IsConnected)
         {
-            // Connection closed
+            _pendingOutput.Clear();
+            _flushTraces.Clear();
+            return;
         }
+
+        var buffer = ArrayPool<byte>.Shared.Rent(TelnetTextEncoder.MaxEncodedLength(_pendingOutput.Length));
+        int length = _encoder.Encode(_pendingOutput, buffer);
+        _pendingOutput.Clear();
+
+        Transmit(buffer, length, droppable: true);
+        if (_flushTraces.Count > 0) TrackSends();
     }
 
     /// <summary>
-    /// Send a line to this connection (appends newline).
+    /// A traced command's output has all been queued on this connection:
+    /// finish its Send stage once the next flush has reached the socket.
     /// </summary>
-    public void SendLine(string message)
+    public void TraceSend(CommandTrace trace)
     {
-        Send(message + "\r\n");
+        _flushTraces.Add(trace);
     }
 
     /// <summary>
-    /// Control local echo on the client side.
-    /// When disabled, typed characters won't be echoed (for password input).
+    /// Move the traces of flushed output on to wait for the send loop, or
+    /// finish them if everything queued has already gone.
     /// </summary>
-    /// <param name="enabled">True to enable echo, false to suppress.</param>
-    public void SetEchoMode(bool enabled)
+    private void TrackSends()
+    {
+        List<CommandTrace>? sent = null;
+        lock (_sendLock)
+        {
+            foreach (var trace in _flushTraces)
+            {
+                if (_chunksDone < _chunksQueued)
+                {
+                    _sendTraces.Enqueue((_chunksQueued, trace));
+                }
+                else if (!_disposed)
+                {
+                    (sent ??= new List<CommandTrace>()).Add(trace);
+                }
+            }
+        }
+        _flushTraces.Clear();
+        sent?.ForEach(trace => trace.Sent());
+    }
+
+    /// <summary>
+    /// Take the traces whose output is all out (caller holds _sendLock).
+    /// </summary>
+    private List<CommandTrace>? TakeSentTraces()
     {
-        if (!IsConnected) return;
+        List<CommandTrace>? sent = null;
+        while (_sendTraces.Count > 0 && _sendTraces.Peek().Chunk <= _chunksDone)
+        {
+            (sent ??= new List<CommandTrace>()).Add(_sendTraces.Dequeue().Trace);
+        }
+        return sent;
+    }
 
-        try
+    /// <summary>
+    /// Send a GMCP message, after any text queued before it.
+    /// </summary>
+    public void QueueGmcp(string message)
+    {
+        if (!IsGmcp) return;
+
+        FlushOutput();
+        SendRaw(Gmcp.Frame(message));
+    }
+
+    /// <summary>
+    /// Queue raw bytes (telnet commands) behind any output already queued.
+    /// </summary>
+    private void SendRaw(ReadOnlySpan<byte> data)
+    {
+        var buffer = ArrayPool<byte>.Shared.Rent(data.Length);
+        data.CopyTo(buffer);
+        Transmit(buffer, data.Length, droppable: false);
+    }
+
+    /// <summary>
+    /// Queue a pooled buffer for sending, compressing it first when MCCP2 is on.
+    /// A compressed batch is one deflate sync flush, so the client can
+    /// decompress each tick's output as soon as it arrives.
+    /// </summary>
+    private void Transmit(byte[] buffer, int length, bool droppable)
+    {
+        lock (_compressLock)
         {
-            // IAC WILL ECHO = server will handle echo (client should not echo)
-            // IAC WONT ECHO = server won't handle echo (client should echo)
-            byte[] command = enabled
-                ? new byte[] { IAC, WONT, ECHO }
-                : new byte[] { IAC, WILL, ECHO };
+            if (_deflate == null)
+            {
+                EnqueueSend(buffer, length, droppable);
+                return;
+            }
+
+            // Dropping part of a zlib stream would corrupt everything after it,
+            // so DropOldest sheds new output before it's compressed instead
+            if (droppable && _limits.Policy == OutputOverflowPolicy.DropOldest &&
+                QueuedBytes + length > _limits.MaxQueuedBytes)
+            {
+                lock (_sendLock)
+                {
+                    BytesDropped += length;
+                }
+                ArrayPool<byte>.Shared.Return(buffer);
+                return;
+            }
 
-            _stream.Write(command, 0, command.Length);
-            _stream.Flush();
+            _deflate.Write(buffer, 0, length);
+            _deflate.Flush();
+            UncompressedBytes += length;
+            ArrayPool<byte>.Shared.Return(buffer);
+
+            EnqueueCompressed();
+        }
+    }
+
+    /// <summary>
+    /// Move what the compressor produced into the send queue (caller holds _compressLock).
+    /// </summary>
+    private void EnqueueCompressed()
+    {
+        var length = (int)_compressedSink.Length;
+        if (length == 0) return;
+
+        var compressed = ArrayPool<byte>.Shared.Rent(length);
+        _compressedSink.GetBuffer().AsSpan(0, length).CopyTo(compressed);
+        _compressedSink.SetLength(0);
+        CompressedBytes += length;
+
+        EnqueueSend(compressed, length, droppable: false);
+    }
+
+    /// <summary>
+    /// Handle the client's answer to our MCCP2 and GMCP offers and TTYPE request (receive thread).
+    /// NAWS needs no answer: a client that agrees sends its window size straight away.
+    /// </summary>
+    private void OnNegotiation(byte command, byte option)
+    {
+        if (option == TerminalTypeNegotiation.Option)
+        {
+            if (command == WILL && _terminalType == null)
+            {
+                _terminalType = new TerminalTypeNegotiation();
+                SendRaw(TerminalTypeNegotiation.SendRequest);
+            }
+            return;
         }
-        catch (IOException)
+        if (option == Gmcp.Option && (command == DO || command == DONT))
         {
-            // Connection closed
+            IsGmcp = command == DO;
+            _gameLoop.SetGmcp(_id, IsGmcp);
+            return;
+        }
+        if (option != COMPRESS2 || _compressionLevel == null) return;
+
+        lock (_compressLock)
+        {
+            if (command == DO && _deflate == null)
+            {
+                // IAC SB COMPRESS2 IAC SE goes out uncompressed; everything after it is zlib
+                var start = ArrayPool<byte>.Shared.Rent(5);
+                start[0] = IAC; start[1] = SB; start[2] = COMPRESS2; start[3] = IAC; start[4] = SE;
+                EnqueueSend(start, 5, droppable: false);
+
+                _deflate = new ZLibStream(_compressedSink, _compressionLevel.Value, leaveOpen: true);
+                Logger.Debug($"Connection {_id} negotiated MCCP2", LogCategory.Network);
+            }
+            else if (command == DONT)
+            {
+                EndCompression();
+            }
         }
     }
 
     /// <summary>
-    /// Process any available input from the connection.
-    /// Returns complete lines that have been received.
+    /// Take a TTYPE answer and ask for the next, until the client has said
+    /// all it will (receive thread).
     /// </summary>
-    public List<string> ReadAvailableLines()
+    private void OnSubnegotiation(byte option, ReadOnlySpan<byte> data)
     {
-        var lines = new List<string>();
+        if (option == NAWS)
+        {
+            OnWindowSize(data);
+            return;
+        }
+        if (option != TerminalTypeNegotiation.Option || _terminalType is not { } negotiation) return;
 
-        if (!IsConnected) return lines;
+        if (negotiation.Reply(data))
+        {
+            SendRaw(TerminalTypeNegotiation.SendRequest);
+        }
+        else if (negotiation.Result is { } terminal && Terminal == null)
+        {
+            Terminal = terminal;
+            _gameLoop.SetTerminal(_id, terminal);
+            Logger.Debug($"Connection {_id} terminal: {terminal.Client} / {terminal.Terminal}, MTTS {terminal.Mtts}: {terminal.Color}", LogCategory.Network);
+        }
+    }
 
-        try
+    /// <summary>
+    /// NAWS: the client's window is data[0..1] columns by data[2..3] rows,
+    /// sent when it agrees to NAWS and again whenever it is resized (receive thread).
+    /// </summary>
+    private void OnWindowSize(ReadOnlySpan<byte> data)
+    {
+        if (data.Length != 4) return;
+
+        WindowWidth = data[0] << 8 | data[1];
+        WindowHeight = data[2] << 8 | data[3];
+        _encoder.Width = WindowWidth;
+        _gameLoop.SetWindowSize(_id, WindowWidth, WindowHeight);
+    }
+
+    /// <summary>
+    /// Stop compressing, if MCCP2 is on. Ending the zlib stream returns the
+    /// client to plain telnet.
+    /// </summary>
+    public void EndCompression()
+    {
+        lock (_compressLock)
+        {
+            if (_deflate == null) return;
+
+            _deflate.Dispose();
+            _deflate = null;
+            EnqueueCompressed();
+        }
+    }
+
+    /// <summary>
+    /// Add a pooled buffer to the send queue, applying the output limit, and
+    /// start the send loop if it isn't running. Droppable chunks are plain
+    /// text that DropOldest may discard; telnet commands and compressed data
+    /// always go out.
+    /// </summary>
+    private void EnqueueSend(byte[] buffer, int length, bool droppable)
+    {
+        bool overflowed = false;
+
+        lock (_sendLock)
         {
-            // Read any available data
-            while (_stream.DataAvailable)
+            if (_overflowed || _disposed)
             {
-                var buffer = new byte[1024];
-                int bytesRead = _stream.Read(buffer, 0, buffer.Length);
+                ArrayPool<byte>.Shared.Return(buffer);
+                return;
+            }
 
-                if (bytesRead == 0)
+            if (QueuedBytes + length > _limits.MaxQueuedBytes)
+            {
+                if (_limits.Policy == OutputOverflowPolicy.DropOldest)
                 {
-                    // Connection closed
-                    break;
+                    // Make room by discarding what the client would have seen first
+                    while (_sendQueue.Count > 0 && _sendQueue.Peek().Droppable &&
+                           QueuedBytes + length > _limits.MaxQueuedBytes)
+                    {
+                        var (oldest, oldestLength, _) = _sendQueue.Dequeue();
+                        ArrayPool<byte>.Shared.Return(oldest);
+                        QueuedBytes -= oldestLength;
+                        BytesDropped += oldestLength;
+                        _chunksDone++;
+                    }
+                }
+                else
+                {
+                    _overflowed = true;
+                    overflowed = true;
+                    BytesDropped += length;
+                    ArrayPool<byte>.Shared.Return(buffer);
+                }
+            }
+
+            if (!overflowed)
+            {
+                _sendQueue.Enqueue((buffer, length, droppable));
+                QueuedBytes += length;
+                _chunksQueued++;
+
+                if (!_sending)
+                {
+                    _sending = true;
+                    _sendLoop = Task.Run(SendLoopAsync);
                 }
+            }
+        }
+
+        if (overflowed)
+        {
+            Logger.Warning($"Connection {_id} exceeded its output limit ({_limits.MaxQueuedBytes} bytes queued); policy {_limits.Policy}", LogCategory.Network);
+            _onOverflow?.Invoke(this);
+        }
+    }
 
-                // Add to input buffer, handling telnet basics
-                for (int i = 0; i < bytesRead; i++)
+    private async Task SendLoopAsync()
+    {
+        var socket = _client.Client;
+
+        while (true)
+        {
+            byte[] buffer;
+            int length;
+            lock (_sendLock)
+            {
+                if (_sendQueue.Count == 0 || _disposed)
                 {
-                    byte b = buffer[i];
+                    ReleaseSendQueue();
+                    _sending = false;
+                    return;
+                }
 
-                    // Skip telnet IAC sequences (255 = IAC)
-                    if (b == 255 && i + 2 < bytesRead)
-                    {
-                        i += 2; // Skip IAC + command + option
-                        continue;
-                    }
+                // Take the chunk off the queue while it's in flight, so DropOldest
+                // only ever discards output the socket hasn't started on
+                (buffer, length, _) = _sendQueue.Dequeue();
+            }
 
-                    // Handle backspace
-                    if (b == 8 || b == 127)
+            bool closed = false;
+            try
+            {
+                if (_webSocket != null)
+                {
+                    await _webSocket.SendAsync(buffer.AsMemory(0, length), WebSocketMessageType.Text, endOfMessage: true, CancellationToken.None);
+                }
+                else
+                {
+                    int sent = 0;
+                    while (sent < length)
                     {
-                        if (_inputBuffer.Length > 0)
-                        {
-                            _inputBuffer.Length--;
-                        }
-                        continue;
+                        sent += await socket.SendAsync(buffer.AsMemory(sent, length - sent), SocketFlags.None);
                     }
+                }
+                Interlocked.Add(ref _bytesSent, length);
+            }
+            catch (Exception ex) when (ex is SocketException or ObjectDisposedException or IOException or WebSocketException)
+            {
+                // Connection closed; the receive loop reports it
+                closed = true;
+            }
 
-                    // Handle newline - extract complete line
-                    if (b == '\n')
-                    {
-                        var line = _inputBuffer.ToString().TrimEnd('\r');
-                        _inputBuffer.Clear();
-                        lines.Add(line);
-                        continue;
-                    }
+            ArrayPool<byte>.Shared.Return(buffer);
 
-                    // Skip carriage return (we handle it with newline)
-                    if (b == '\r')
-                    {
-                        continue;
-                    }
+            List<CommandTrace>? traced;
+            lock (_sendLock)
+            {
+                QueuedBytes -= length;
+                if (closed)
+                {
+                    ReleaseSendQueue();
+                    _sending = false;
+                    return;
+                }
+                _chunksDone++;
+                traced = _sendTraces.Count > 0 ? TakeSentTraces() : null;
+            }
+            traced?.ForEach(trace => trace.Sent());
+        }
+    }
 
-                    // Regular character
-                    if (b >= 32 && b < 127)
-                    {
-                        _inputBuffer.Append((char)b);
-                    }
+    /// <summary>
+    /// Return every queued buffer to the pool (caller holds _sendLock).
+    /// </summary>
+    private void ReleaseSendQueue()
+    {
+        while (_sendQueue.Count > 0)
+        {
+            var (buffer, length, _) = _sendQueue.Dequeue();
+            ArrayPool<byte>.Shared.Return(buffer);
+            QueuedBytes -= length;
+        }
+        // Output that never went out isn't timed
+        _sendTraces.Clear();
+    }
+
+    /// <summary>
+    /// Wait (up to timeout) for queued output to reach the socket.
+    /// Used before closing so goodbye messages aren't lost.
+    /// </summary>
+    public void WaitForSends(TimeSpan timeout)
+    {
+        Task loop;
+        lock (_sendLock)
+        {
+            loop = _sendLoop;
+        }
+        loop.Wait(timeout);
+    }
+
+    /// <summary>
+    /// Send a line to this connection (appends newline).
+    /// </summary>
+    public void SendLine(string message)
+    {
+        Send(message + "\r\n");
+    }
+
+    /// <summary>
+    /// Control local echo on the client side.
+    /// When disabled, typed characters won't be echoed (for password input).
+    /// </summary>
+    /// <param name="enabled">True to enable echo, false to suppress.</param>
+    public void SetEchoMode(bool enabled)
+    {
+        if (!IsConnected || _webSocket != null) return;
+
+        // IAC WILL ECHO = server will handle echo (client should not echo)
+        // IAC WONT ECHO = server won't handle echo (client should echo)
+        ReadOnlySpan<byte> command = enabled
+            ? stackalloc byte[] { IAC, WONT, ECHO }
+            : stackalloc byte[] { IAC, WILL, ECHO };
+
+        SendRaw(command);
+    }
+
+    /// <summary>
+    /// Start the receive loop. Reads complete only when the socket has data, so
+    /// an idle connection costs nothing until its client types something; each
+    /// complete line goes straight to the game loop. onClosed runs once, when
+    /// the client disconnects or the connection is disposed.
+    /// </summary>
+    public Task StartReceiving(Action<Connection> onClosed)
+    {
+        return Task.Run(() => ReceiveLoopAsync(onClosed));
+    }
+
+    private async Task ReceiveLoopAsync(Action<Connection> onClosed)
+    {
+        var socket = _client.Client;
+        var buffer = ArrayPool<byte>.Shared.Rent(ReceiveBufferSize);
+
+        try
+        {
+            if (_webSocket != null)
+            {
+                await ReceiveWebSocketAsync(_webSocket, buffer);
+            }
+
+            while (!_disposed && _webSocket == null)
+            {
+                int bytesRead = await socket.ReceiveAsync(buffer, SocketFlags.None, _receiveCancellation.Token);
+                if (bytesRead == 0)
+                {
+                    // Connection closed by the client
+                    break;
                 }
+
+                _receivedAt = Stopwatch.GetTimestamp();
+                _telnet.Feed(buffer.AsSpan(0, bytesRead));
             }
         }
-        catch (IOException)
+        catch (Exception ex) when (ex is SocketException or ObjectDisposedException or OperationCanceledException or IOException or WebSocketException)
         {
             // Connection closed
         }
+        finally
+        {
+            // The receive loop is the parser's only user, so it releases the buffers
+            ArrayPool<byte>.Shared.Return(buffer);
+            _telnet.Dispose();
 
-        return lines;
+            _receiveClosed = true;
+            onClosed(this);
+        }
+    }
+
+    /// <summary>
+    /// Read messages until the client closes. Each line of a text message
+    /// is a command; like the telnet path, only printable ASCII is kept and
+    /// lines are cut at TelnetParser.MaxLineLength.
+    /// </summary>
+    private async Task ReceiveWebSocketAsync(WebSocket webSocket, byte[] buffer)
+    {
+        var line = new StringBuilder();
+        var decoder = Encoding.UTF8.GetDecoder();
+        var chars = new char[buffer.Length];
+
+        while (!_disposed)
+        {
+            var result = await webSocket.ReceiveAsync(buffer.AsMemory(), _receiveCancellation.Token);
+            if (result.MessageType == WebSocketMessageType.Close)
+            {
+                await webSocket.CloseOutputAsync(WebSocketCloseStatus.NormalClosure, null, CancellationToken.None);
+                break;
+            }
+            if (result.MessageType != WebSocketMessageType.Text) continue;
+            _receivedAt = Stopwatch.GetTimestamp();
+
+            int count = decoder.GetChars(buffer, 0, result.Count, chars, 0, flush: result.EndOfMessage);
+            for (int i = 0; i < count; i++)
+            {
+                char c = chars[i];
+                if (c == '\n')
+                {
+                    ProcessLine(line.ToString());
+                    line.Clear();
+                }
+                else if (c >= ' ' && c < 127 && line.Length < TelnetParser.MaxLineLength)
+                {
+                    line.Append(c);
+                }
+            }
+
+            // A message is a complete line even without a newline at the end
+            if (result.EndOfMessage && line.Length > 0)
+            {
+                ProcessLine(line.ToString());
+                line.Clear();
+            }
+        }
+    }
+
+    private void OnLine(ReadOnlySpan<byte> line)
+    {
+        // The parser only keeps printable ASCII
+        ProcessLine(Encoding.ASCII.GetString(line));
     }
 
     /// <summary>
@@ -173,7 +795,7 @@ public class Connection : IDisposable
     public void ProcessLine(string line)
     {
         // Queue the command to the game loop for processing
-        _gameLoop.QueueCommand(_id, line);
+        _gameLoop.QueueCommand(_id, line, _receivedAt);
     }
 
     public void SendWelcome()
@@ -186,13 +808,31 @@ public class Connection : IDisposable
     public void Dispose()
     {
         if (_disposed) return;
-        _disposed = true;
+
+        lock (_sendLock)
+        {
+            _disposed = true;
+
+            // A running send loop releases the queue itself when it next looks
+            if (!_sending)
+            {
+                ReleaseSendQueue();
+            }
+        }
+
+        lock (_compressLock)
+        {
+            _deflate?.Dispose();
+            _deflate = null;
+        }
 
         try
         {
-            _writer.Dispose();
+            _receiveCancellation.Cancel();
+            _webSocket?.Dispose();
             _stream.Dispose();
             _client.Dispose();
+            _receiveCancellation.Dispose();
         }
         catch
         {
@@ -0,0 +1,146 @@
+using System.Net.Sockets;
+using System.Runtime.InteropServices;
+using System.Text.Json;
+using System.Text.Json.Serialization;
+
+namespace Driver;
+
+/// <summary>
+/// A connection handed over in a copyover. Username is the player it was
+/// playing as, or null if it was still logging in.
+/// </summary>
+public sealed record CopyoverConnection(long Handle, string? RemoteAddress, string? Username);
+
+/// <summary>
+/// What the old driver process leaves for the new one: the listening socket
+/// and every client socket, as file descriptors the new process inherits.
+/// </summary>
+public sealed record CopyoverState(int Port, long ListenerHandle, List<CopyoverConnection> Connections);
+
+/// <summary>
+/// Copyover: restart the driver without dropping connections.
+///
+/// The old process saves every player, then exec()s itself with
+/// --copyover &lt;state file&gt;. The process image is replaced but open file
+/// descriptors survive exec unless they're close-on-exec, which .NET sets on
+/// every socket; so each socket is dup()ed first (dup() never copies that
+/// flag) and the state file lists the duplicates. The new process adopts
+/// them, logs each player straight back in from their save file and goes on.
+/// Players see a pause of a few seconds, not a disconnect.
+///
+/// MCCP2 is ended before the handover, since the zlib stream can't be carried
+/// over; the new process offers it again.
+///
+/// Unix only: Windows has neither exec() nor inheritable socket handles.
+/// </summary>
+public static class Copyover
+{
+    public static bool IsSupported => OperatingSystem.IsLinux() || OperatingSystem.IsMacOS() || OperatingSystem.IsFreeBSD();
+
+    /// <summary>
+    /// A descriptor for the socket that stays open across exec().
+    /// </summary>
+    public static long Inherit(Socket socket)
+    {
+        int fd = dup((int)socket.Handle);
+        if (fd < 0)
+        {
+            throw new IOException($"dup() failed: errno {Marshal.GetLastPInvokeError()}");
+        }
+        return fd;
+    }
+
+    /// <summary>
+    /// Close a descriptor from Inherit() after a copyover that didn't happen.
+    /// </summary>
+    public static void Release(long handle)
+    {
+        close((int)handle);
+    }
+
+    /// <summary>
+    /// Wrap an inherited descriptor. The socket owns it from here on.
+    /// </summary>
+    public static Socket Adopt(long handle)
+    {
+        return new Socket(new SafeSocketHandle((IntPtr)handle, ownsHandle: true));
+    }
+
+    public static void Save(CopyoverState state, string path)
+    {
+        File.WriteAllBytes(path, JsonSerializer.SerializeToUtf8Bytes(state, CopyoverJsonContext.Default.CopyoverState));
+    }
+
+    /// <summary>
+    /// Read and delete a state file.
+    /// </summary>
+    public static CopyoverState Load(string path)
+    {
+        var state = JsonSerializer.Deserialize(File.ReadAllBytes(path), CopyoverJsonContext.Default.CopyoverState)
+            ?? throw new InvalidDataException($"Empty copyover state: {path}");
+        File.Delete(path);
+        return state;
+    }
+
+    /// <summary>
+    /// The command line to start this driver again with: the same arguments,
+    /// plus --copyover statePath in place of any earlier one. argv[0] is the
+    /// executable; under the dotnet host the entry assembly follows it.
+    /// </summary>
+    public static string[] RestartArguments(string statePath)
+    {
+        var processPath = Environment.ProcessPath ?? throw new InvalidOperationException("Unknown process path");
+        var commandLine = Environment.GetCommandLineArgs();
+
+        var argv = new List<string> { processPath };
+        if (Path.GetFileNameWithoutExtension(processPath) == "dotnet")
+        {
+            argv.Add(commandLine[0]);
+        }
+        for (int i = 1; i < commandLine.Length; i++)
+        {
+            if (commandLine[i] == "--copyover")
+            {
+                i++;
+                continue;
+            }
+            argv.Add(commandLine[i]);
+        }
+        argv.Add("--copyover");
+        argv.Add(statePath);
+        return argv.ToArray();
+    }
+
+    /// <summary>
+    /// Replace this process with argv. Only returns by throwing.
+    /// </summary>
+    public static void Exec(string[] argv)
+    {
+        Logger.Info($"Copyover: exec {string.Join(' ', argv)}", LogCategory.System);
+        Logger.Flush();
+
+        var terminated = new string?[argv.Length + 1];
+        argv.CopyTo(terminated, 0);
+        execv(argv[0], terminated);
+
+        var errno = Marshal.GetLastPInvokeError();
+        throw new IOException($"execv({argv[0]}) failed: errno {errno}");
+    }
+
+    [DllImport("libc", SetLastError = true)]
+    private static extern int dup(int fd);
+
+    [DllImport("libc", SetLastError = true)]
+    private static extern int close(int fd);
+
+    [DllImport("libc", SetLastError = true)]
+    private static extern int execv(string path, string?[] argv);
+}
+
+/// <summary>
+/// Source-generated serializers for the copyover state file.
+/// </summary>
+[JsonSerializable(typeof(CopyoverState))]
+internal partial class CopyoverJsonContext : JsonSerializerContext
+{
+}
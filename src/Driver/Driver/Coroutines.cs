@@ -0,0 +1,227 @@
+namespace Driver;
+
+/// <summary>
+/// LPC coroutines, behind the start_coroutine(), yield(), sleep() and
+/// stop_coroutine() efuns. A coroutine is a function call that can suspend
+/// itself with its whole call stack and carry on in a later tick with a fresh
+/// instruction budget, so a batch job (a world-wide scan, a mass reset, a
+/// migration) is spread over many ticks instead of spiking one or hitting
+/// the instruction limit.
+///
+/// Calls nest as C# calls in both the VM and the tree walker, so a call stack
+/// can't be lifted off the thread running it. Instead each coroutine runs on
+/// its own thread, but only while the game thread waits for it: resuming one
+/// hands it the world and blocks until it yields or returns. Exactly one of
+/// them runs at a time, so LPC in a coroutine sees the world as it would on
+/// the game thread (OnGameThread is true for it while it runs). Slices run
+/// with the waiting resets, oldest first while the tick has room, with no
+/// this_player(), like call_outs.
+///
+/// A coroutine whose object is destructed, or that stop_coroutine() names,
+/// is unwound at its next resume: yield() throws an error catch() can't stop.
+/// Changed on the game thread (or a coroutine standing in for it) only.
+/// </summary>
+public sealed class Coroutines
+{
+    /// <summary>
+    /// Coroutines that may be alive at once; each holds a thread.
+    /// </summary>
+    public const int MaxCoroutines = 64;
+
+    private sealed class Coroutine
+    {
+        public required int Id { get; init; }
+        public required MudObject Owner { get; init; }
+        public required string Function { get; init; }
+        public required List<object> Args { get; init; }
+        public Thread Thread { get; set; } = null!;
+
+        // Handed back and forth: the game thread releases Resume and waits
+        // on Paused, the coroutine the other way around
+        public readonly SemaphoreSlim Resume = new(0);
+        public readonly SemaphoreSlim Paused = new(0);
+
+        public long WakeTick;
+        public int SleepTicks;
+        public bool Stopping;
+        public bool Finished;
+    }
+
+    [ThreadStatic]
+    private static Coroutine? _current;
+
+    private readonly Dictionary<int, Coroutine> _coroutines = new();
+    private volatile Thread? _running;
+    private int _nextId;
+
+    /// <summary>
+    /// Coroutines alive, running or suspended.
+    /// </summary>
+    public int Count => _coroutines.Count;
+
+    /// <summary>
+    /// The thread of the coroutine running now, standing in for the game
+    /// thread; null between slices.
+    /// </summary>
+    public Thread? RunningThread => _running;
+
+    /// <summary>
+    /// Start function(args) in owner as a coroutine whose first slice runs
+    /// at tick wakeTick. Returns its id, or 0 if MaxCoroutines are alive.
+    /// </summary>
+    public int Start(ObjectInterpreter interpreter, MudObject owner, string function, List<object> args, long wakeTick)
+    {
+        if (_coroutines.Count >= MaxCoroutines) return 0;
+
+        var coroutine = new Coroutine
+        {
+            Id = ++_nextId,
+            Owner = owner,
+            Function = function,
+            Args = args,
+            WakeTick = wakeTick
+        };
+        coroutine.Thread = new Thread(() => Run(interpreter, coroutine))
+        {
+            Name = $"Coroutine-{coroutine.Id}",
+            IsBackground = true
+        };
+        coroutine.Thread.Start();
+        _coroutines[coroutine.Id] = coroutine;
+        return coroutine.Id;
+    }
+
+    /// <summary>
+    /// Have owner's coroutine id unwind at its next resume, which is due at
+    /// once. Returns false if owner has no such coroutine.
+    /// </summary>
+    public bool Stop(MudObject owner, int id)
+    {
+        if (!_coroutines.TryGetValue(id, out var coroutine) || coroutine.Owner != owner) return false;
+
+        coroutine.Stopping = true;
+        coroutine.WakeTick = long.MinValue;
+        return true;
+    }
+
+    /// <summary>
+    /// Resume the coroutines due at nowTick, longest waiting first, while
+    /// mayRun(ticks overdue) says the tick has room. Ones being stopped are
+    /// always unwound. Game thread only.
+    /// </summary>
+    public void RunDue(long nowTick, Func<long, bool> mayRun)
+    {
+        if (_coroutines.Count == 0) return;
+
+        var due = _coroutines.Values
+            .Where(c => c.WakeTick <= nowTick)
+            .OrderBy(c => c.WakeTick)
+            .ThenBy(c => c.Id)
+            .ToList();
+        foreach (var coroutine in due)
+        {
+            if (coroutine.Owner.IsDestructed) coroutine.Stopping = true;
+            if (!coroutine.Stopping && !mayRun(nowTick - coroutine.WakeTick)) continue;
+            RunSlice(coroutine, nowTick);
+        }
+    }
+
+    /// <summary>
+    /// Unwind every coroutine (when the game loop stops).
+    /// </summary>
+    public void StopAll()
+    {
+        foreach (var coroutine in _coroutines.Values.ToList())
+        {
+            coroutine.Stopping = true;
+            RunSlice(coroutine, 0);
+        }
+    }
+
+    /// <summary>
+    /// Suspend the calling coroutine for ticks (at least 1) and return when
+    /// it is resumed. False, without waiting, if the caller isn't a
+    /// coroutine. Throws CoroutineStoppedException if it is being stopped.
+    /// </summary>
+    public static bool Suspend(int ticks)
+    {
+        var coroutine = _current;
+        if (coroutine == null) return false;
+
+        if (!coroutine.Stopping)
+        {
+            coroutine.SleepTicks = Math.Max(1, ticks);
+            coroutine.Paused.Release();
+            coroutine.Resume.Wait();
+        }
+        if (coroutine.Stopping)
+        {
+            throw new CoroutineStoppedException(coroutine.Id);
+        }
+        return true;
+    }
+
+    private void RunSlice(Coroutine coroutine, long nowTick)
+    {
+        _running = coroutine.Thread;
+        coroutine.Resume.Release();
+        coroutine.Paused.Wait();
+        _running = null;
+
+        if (coroutine.Finished)
+        {
+            _coroutines.Remove(coroutine.Id);
+            coroutine.Resume.Dispose();
+            coroutine.Paused.Dispose();
+        }
+        else
+        {
+            coroutine.WakeTick = coroutine.Stopping ? long.MinValue : nowTick + coroutine.SleepTicks;
+        }
+    }
+
+    private static void Run(ObjectInterpreter interpreter, Coroutine coroutine)
+    {
+        coroutine.Resume.Wait();
+        _current = coroutine;
+        var name = $"{coroutine.Owner.ObjectName}->{coroutine.Function}";
+        try
+        {
+            if (!coroutine.Stopping)
+            {
+                interpreter.ResetInstructionCount();
+                interpreter.CallFunctionOnObject(coroutine.Owner, coroutine.Function, coroutine.Args);
+            }
+        }
+        catch (Exception) when (coroutine.Stopping)
+        {
+            // Unwound by stop_coroutine() or a destruct
+        }
+        catch (ExecutionLimitException ex)
+        {
+            Logger.Warning($"Coroutine limit exceeded in {name}: {ex.Message}", LogCategory.LPC);
+        }
+        catch (Exception ex)
+        {
+            Logger.Error($"Coroutine error in {name}: {ex.Message}", LogCategory.LPC);
+        }
+        finally
+        {
+            interpreter.ReleaseThread();
+            _current = null;
+            coroutine.Finished = true;
+            coroutine.Paused.Release();
+        }
+    }
+}
+
+/// <summary>
+/// Thrown out of yield() or sleep() to unwind a coroutine being stopped.
+/// catch() doesn't stop it.
+/// </summary>
+public class CoroutineStoppedException : Exception
+{
+    public CoroutineStoppedException(int id) : base($"Coroutine {id} was stopped")
+    {
+    }
+}
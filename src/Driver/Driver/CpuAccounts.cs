@@ -0,0 +1,212 @@
+namespace Driver;
+
+/// <summary>
+/// LPC instructions and wall time used by each object, blueprint and domain,
+/// in total and over the last minute.
+///
+/// Every top-level call the game loop makes (a command, heart_beat(), a
+/// callout, reset() or clean_up()) is charged to the object it was made on,
+/// to that object's blueprint and to its domain: the wizard's directory for
+/// files under /wizards/name, else the directory the file is in, so each
+/// area under /world counts as one. What a call does in other objects is
+/// charged to the caller, which is the object responsible for it.
+///
+/// With a budget set, an object that used more than Budget instructions in
+/// the last minute has its heart_beat() slowed: it beats on one turn in
+/// (used / Budget) rounded up, up to MaxSlowdown, until the minute rolls
+/// past its busy stretch.
+///
+/// Used on the game thread only.
+/// </summary>
+public sealed class CpuAccounts
+{
+    /// <summary>
+    /// The recent window is this many slots of SlotSeconds each.
+    /// </summary>
+    public const int Slots = 6;
+    public const int SlotSeconds = 10;
+    public const int WindowSeconds = Slots * SlotSeconds;
+
+    /// <summary>
+    /// Most heartbeat turns an object over budget skips in a row.
+    /// </summary>
+    public const int MaxSlowdown = 8;
+
+    /// <summary>
+    /// Instructions, time and calls charged to one name.
+    /// </summary>
+    public sealed class Account
+    {
+        private readonly long[] _instructions = new long[Slots];
+        private readonly long[] _microseconds = new long[Slots];
+        private long _newest;
+
+        public Account(string name)
+        {
+            Name = name;
+        }
+
+        public string Name { get; }
+        public long Instructions { get; private set; }
+        public long Microseconds { get; private set; }
+        public long Calls { get; private set; }
+
+        internal void Add(long slot, long instructions, long microseconds)
+        {
+            Advance(slot);
+            int i = (int)(slot % Slots);
+            _instructions[i] += instructions;
+            _microseconds[i] += microseconds;
+            Instructions += instructions;
+            Microseconds += microseconds;
+            Calls++;
+        }
+
+        /// <summary>
+        /// Instructions and microseconds in the window ending at slot.
+        /// </summary>
+        public (long Instructions, long Microseconds) Recent(long slot)
+        {
+            long instructions = 0;
+            long microseconds = 0;
+            for (long s = Math.Max(0, Math.Max(slot, _newest) - Slots + 1); s <= Math.Min(slot, _newest); s++)
+            {
+                int i = (int)(s % Slots);
+                instructions += _instructions[i];
+                microseconds += _microseconds[i];
+            }
+            return (instructions, microseconds);
+        }
+
+        private void Advance(long slot)
+        {
+            if (slot <= _newest) return;
+
+            // Clear the slots that fell out of the window since the last charge
+            for (long s = Math.Max(_newest + 1, slot - Slots + 1); s <= slot; s++)
+            {
+                int i = (int)(s % Slots);
+                _instructions[i] = 0;
+                _microseconds[i] = 0;
+            }
+            _newest = slot;
+        }
+    }
+
+    /// <summary>
+    /// A live object's account, with its heartbeat turns for throttling.
+    /// </summary>
+    public sealed class ObjectAccount
+    {
+        public ObjectAccount(MudObject obj)
+        {
+            Object = obj;
+            Account = new Account(obj.ObjectName);
+        }
+
+        public MudObject Object { get; }
+        public Account Account { get; }
+        internal long HeartbeatTurns;
+
+        /// <summary>
+        /// Heartbeat turns skipped for being over budget.
+        /// </summary>
+        public long Throttled { get; internal set; }
+    }
+
+    private readonly Func<long> _clockSeconds;
+    private readonly Dictionary<MudObject, ObjectAccount> _objects = new();
+    private readonly Dictionary<string, Account> _blueprints = new();
+    private readonly Dictionary<string, Account> _domains = new();
+
+    /// <param name="clockSeconds">Seconds on a monotonic clock</param>
+    public CpuAccounts(Func<long> clockSeconds)
+    {
+        _clockSeconds = clockSeconds;
+    }
+
+    /// <summary>
+    /// Instructions an object may use per window before its heart_beat() is
+    /// slowed; 0 for no limit.
+    /// </summary>
+    public long Budget { get; set; }
+
+    private long CurrentSlot => _clockSeconds() / SlotSeconds;
+
+    public IReadOnlyCollection<ObjectAccount> Objects => _objects.Values;
+    public IReadOnlyCollection<Account> Blueprints => _blueprints.Values;
+    public IReadOnlyCollection<Account> Domains => _domains.Values;
+
+    /// <summary>
+    /// Charge a call made on obj.
+    /// </summary>
+    public void Charge(MudObject obj, long instructions, long microseconds)
+    {
+        long slot = CurrentSlot;
+        if (!_objects.TryGetValue(obj, out var account))
+        {
+            _objects[obj] = account = new ObjectAccount(obj);
+        }
+        account.Account.Add(slot, instructions, microseconds);
+
+        var file = obj.FilePath;
+        Named(_blueprints, file).Add(slot, instructions, microseconds);
+        Named(_domains, DomainOf(file)).Add(slot, instructions, microseconds);
+    }
+
+    /// <summary>
+    /// Instructions and microseconds an account used in the last window.
+    /// </summary>
+    public (long Instructions, long Microseconds) Recent(Account account) => account.Recent(CurrentSlot);
+
+    /// <summary>
+    /// Whether obj's heart_beat() sits out this turn for being over budget.
+    /// </summary>
+    public bool SkipHeartbeat(MudObject obj)
+    {
+        if (Budget <= 0 || !_objects.TryGetValue(obj, out var account)) return false;
+
+        long used = account.Account.Recent(CurrentSlot).Instructions;
+        if (used <= Budget) return false;
+
+        long slowdown = Math.Min(MaxSlowdown, (used + Budget - 1) / Budget);
+        if (account.HeartbeatTurns++ % slowdown == 0) return false;
+
+        account.Throttled++;
+        return true;
+    }
+
+    /// <summary>
+    /// Drop a destructed object's own account; its blueprint and domain keep
+    /// what it used.
+    /// </summary>
+    public void Forget(MudObject obj)
+    {
+        _objects.Remove(obj);
+    }
+
+    /// <summary>
+    /// The domain a file is charged to: "/wizards/name" for a wizard's
+    /// files, else the file's directory.
+    /// </summary>
+    public static string DomainOf(string file)
+    {
+        if (file.StartsWith("/wizards/", StringComparison.Ordinal))
+        {
+            int end = file.IndexOf('/', "/wizards/".Length);
+            if (end > 0) return file[..end];
+        }
+
+        int slash = file.LastIndexOf('/');
+        return slash > 0 ? file[..slash] : "/";
+    }
+
+    private static Account Named(Dictionary<string, Account> accounts, string name)
+    {
+        if (!accounts.TryGetValue(name, out var account))
+        {
+            accounts[name] = account = new Account(name);
+        }
+        return account;
+    }
+}
@@ -1,11 +1,29 @@
+using System.Runtime.InteropServices;
+
 namespace Driver;
 
+/// <summary>
+/// An efun that reads its arguments where they already are (the VM's operand
+/// stack) and returns an LpcValue, so a call allocates nothing.
+/// </summary>
+public delegate LpcValue SpanEfun(ReadOnlySpan<LpcValue> args);
+
 /// <summary>
 /// Registry for external functions (efuns) callable from LPC code.
+///
+/// Every efun name gets a slot number, the same in every registry, when it is
+/// first registered. The bytecode compiler binds calls to efun names to their
+/// slots, so the VM finds an efun by array index rather than by name. Hot
+/// efuns can also be registered in SpanEfun form, which the VM calls on its
+/// stack directly; their List form is derived from it.
 /// </summary>
 public class EfunRegistry
 {
+    private static readonly Dictionary<string, int> Slots = new();
+
     private readonly Dictionary<string, Func<List<object>, object>> _efuns = new();
+    private Func<List<object>, object>?[] _bySlot = Array.Empty<Func<List<object>, object>?>();
+    private SpanEfun?[] _spanBySlot = Array.Empty<SpanEfun?>();
     private readonly TextWriter _output;
 
     /// <summary>
@@ -19,6 +37,18 @@ public class EfunRegistry
     /// </summary>
     public static Action<string, string>? SendToConnection { get; set; }
 
+    private static System.Random? _seededRandom;
+
+    /// <summary>
+    /// Make random() repeat the sequence seed gives, for recording and
+    /// replaying a command stream; null goes back to unseeded. Seeded calls
+    /// share one generator under a lock.
+    /// </summary>
+    public static void SeedRandom(int? seed)
+    {
+        _seededRandom = seed is { } value ? new System.Random(value) : null;
+    }
+
     public EfunRegistry(TextWriter? output = null)
     {
         _output = output ?? Console.Out;
@@ -28,21 +58,29 @@ public class EfunRegistry
     private void RegisterBuiltins()
     {
         Register("write", Write);
-        Register("typeof", TypeOf);
-        Register("strlen", Strlen);
-        Register("sizeof", SizeOf);
+        RegisterSpan("typeof", TypeOf);
+        RegisterSpan("strlen", Strlen);
+        RegisterSpan("sizeof", SizeOf);
         Register("to_string", ToString);
         Register("to_int", ToInt);
         Register("this_player", ThisPlayer);
         Register("tell_object", TellObject);
+        Register("send_gmcp", SendGmcp);
+        Register("has_gmcp", HasGmcp);
+        Register("terminal_info", TerminalInfoEfun);
+        Register("set_color", SetColor);
+        Register("screen_width", ScreenWidth);
         Register("environment", Environment);
         Register("tell_room", TellRoom);
         Register("log_console", LogConsole);
         Register("all_inventory", AllInventory);
+        Register("all_livings", AllLivings);
+        Register("all_interactive", AllInteractive);
         Register("random", Random);
-        Register("abs", Abs);
+        RegisterSpan("abs", Abs);
         Register("min", Min);
         Register("max", Max);
+        Register("sum", Sum);
         Register("member_array", MemberArray);
         Register("sprintf", Sprintf);
         Register("explode", Explode);
@@ -80,12 +118,12 @@ public class EfunRegistry
         Register("next_inventory", NextInventory);
 
         // Type predicates
-        Register("intp", Intp);
-        Register("stringp", Stringp);
-        Register("objectp", Objectp);
-        Register("pointerp", Pointerp);
-        Register("arrayp", Pointerp);  // Alias
-        Register("mappingp", Mappingp);
+        RegisterSpan("intp", Intp);
+        RegisterSpan("stringp", Stringp);
+        RegisterSpan("objectp", Objectp);
+        RegisterSpan("pointerp", Pointerp);
+        RegisterSpan("arrayp", Pointerp);  // Alias
+        RegisterSpan("mappingp", Mappingp);
 
         // Array/mapping utilities
         Register("allocate", Allocate);
@@ -95,6 +133,9 @@ public class EfunRegistry
         Register("replace_string", ReplaceString);
         Register("trim", Trim);
 
+        // Testing
+        Register("assert", Assert);
+
         // Note: load_object, clone_object, move_object, etc. are registered by ObjectInterpreter
         // Note: filter_array, map_array are in ObjectInterpreter (need callback support)
         // Note: sscanf is in ObjectInterpreter (needs variable assignment)
@@ -104,6 +145,33 @@ public class EfunRegistry
     public void Register(string name, Func<List<object>, object> implementation)
     {
         _efuns[name] = implementation;
+
+        int slot = SlotOf(name, create: true);
+        if (slot >= _bySlot.Length)
+        {
+            Array.Resize(ref _bySlot, slot + 16);
+            Array.Resize(ref _spanBySlot, slot + 16);
+        }
+        _bySlot[slot] = implementation;
+        _spanBySlot[slot] = null;
+    }
+
+    /// <summary>
+    /// Register an efun in SpanEfun form. Callers holding a List get it
+    /// through a wrapper.
+    /// </summary>
+    public void RegisterSpan(string name, SpanEfun implementation)
+    {
+        Register(name, args =>
+        {
+            var values = new LpcValue[args.Count];
+            for (int i = 0; i < values.Length; i++)
+            {
+                values[i] = LpcValue.FromObject(args[i]);
+            }
+            return implementation(values).ToObject()!;
+        });
+        _spanBySlot[SlotOf(name)] = implementation;
     }
 
     public bool TryGet(string name, out Func<List<object>, object>? efun)
@@ -111,6 +179,41 @@ public class EfunRegistry
         return _efuns.TryGetValue(name, out efun);
     }
 
+    /// <summary>
+    /// The efun in slot, and its SpanEfun form if it has one. False if this
+    /// registry has nothing there.
+    /// </summary>
+    public bool TryGet(int slot, out Func<List<object>, object> efun, out SpanEfun? spanEfun)
+    {
+        if ((uint)slot < (uint)_bySlot.Length && _bySlot[slot] is { } found)
+        {
+            efun = found;
+            spanEfun = _spanBySlot[slot];
+            return true;
+        }
+        efun = null!;
+        spanEfun = null;
+        return false;
+    }
+
+    /// <summary>
+    /// The slot of an efun name, or -1 if no registry has registered it.
+    /// </summary>
+    public static int SlotOf(string name) => SlotOf(name, create: false);
+
+    private static int SlotOf(string name, bool create)
+    {
+        lock (Slots)
+        {
+            if (Slots.TryGetValue(name, out int slot)) return slot;
+            if (!create) return -1;
+
+            slot = Slots.Count;
+            Slots[name] = slot;
+            return slot;
+        }
+    }
+
     public bool Exists(string name) => _efuns.ContainsKey(name);
 
     #region Built-in Efuns
@@ -208,60 +311,172 @@ public class EfunRegistry
         return 1;
     }
 
+    /// <summary>
+    /// send_gmcp(player, package, data) - Send a GMCP message, with data (any
+    /// value) as its JSON body, or none if data is left out. Returns 1 if
+    /// sent, 0 if the player's client doesn't speak GMCP.
+    /// </summary>
+    private static object SendGmcp(List<object> args)
+    {
+        if (args.Count is < 2 or > 3)
+        {
+            throw new EfunException("send_gmcp() requires 2 or 3 arguments");
+        }
+
+        if (args[0] is not MudObject target)
+        {
+            throw new EfunException("First argument must be an object");
+        }
+
+        if (args[1] is not string package || !Gmcp.IsPackageName(package))
+        {
+            throw new EfunException("Second argument must be a GMCP package name, like \"Char.Vitals\"");
+        }
+
+        return GameLoop.Instance?.SendGmcp(target, package, args.Count == 3 ? args[2] : null) == true ? 1L : 0L;
+    }
+
+    /// <summary>
+    /// has_gmcp(player) - 1 if the player's client speaks GMCP.
+    /// </summary>
+    private static object HasGmcp(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not MudObject target)
+        {
+            throw new EfunException("has_gmcp() requires an object");
+        }
+
+        return GameLoop.Instance?.HasGmcp(target) == true ? 1L : 0L;
+    }
+
+    /// <summary>
+    /// terminal_info(player) - What the player's client reported through
+    /// TTYPE and NAWS and the color class their output gets:
+    /// ([ "client", "terminal", "mtts", "color", "width", "height" ]), color
+    /// being "none", "ansi" or "256" and the window 0 x 0 if unknown.
+    /// 0 if they aren't connected.
+    /// </summary>
+    private static object TerminalInfoEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not MudObject target)
+        {
+            throw new EfunException("terminal_info() requires an object");
+        }
+
+        if (GameLoop.Instance?.GetTerminal(target) is not var (terminal, color, width, height))
+        {
+            return 0L;
+        }
+        return new LpcMapping
+        {
+            ["client"] = terminal?.Client ?? "",
+            ["terminal"] = terminal?.Terminal ?? "",
+            ["mtts"] = (long)(terminal?.Mtts ?? 0),
+            ["color"] = ColorName(color),
+            ["width"] = (long)width,
+            ["height"] = (long)height
+        };
+    }
+
+    /// <summary>
+    /// screen_width(player) - Columns in the player's window, for laying out
+    /// tables: what their client reported through NAWS, or 80 if it didn't
+    /// (or they aren't connected). Output is wrapped to this width anyway.
+    /// </summary>
+    private static object ScreenWidth(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not MudObject target)
+        {
+            throw new EfunException("screen_width() requires an object");
+        }
+
+        var width = GameLoop.Instance?.GetTerminal(target)?.Width ?? 0;
+        return width >= TelnetTextEncoder.MinimumWidth ? (long)width : 80L;
+    }
+
+    /// <summary>
+    /// set_color(player, mode) - Render the player's output as mode: "none",
+    /// "ansi" or "256" whatever their terminal reported, or "auto" to go by
+    /// the report again. Returns 1 if the player has a session.
+    /// </summary>
+    private static object SetColor(List<object> args)
+    {
+        if (args.Count != 2 || args[0] is not MudObject target || args[1] is not string mode)
+        {
+            throw new EfunException("set_color() requires an object and a mode");
+        }
+
+        ColorSupport? color = mode switch
+        {
+            "auto" => null,
+            "none" => ColorSupport.None,
+            "ansi" => ColorSupport.Ansi,
+            "256" => ColorSupport.Xterm256,
+            _ => throw new EfunException("set_color() mode must be \"auto\", \"none\", \"ansi\" or \"256\"")
+        };
+        return GameLoop.Instance?.SetColor(target, color) == true ? 1L : 0L;
+    }
+
+    private static string ColorName(ColorSupport color) => color switch
+    {
+        ColorSupport.Ansi => "ansi",
+        ColorSupport.Xterm256 => "256",
+        _ => "none"
+    };
+
     /// <summary>
     /// typeof(value) - Returns the type name as a string.
     /// </summary>
-    private static object TypeOf(List<object> args)
+    private static LpcValue TypeOf(ReadOnlySpan<LpcValue> args)
     {
-        if (args.Count != 1)
+        if (args.Length != 1)
         {
             throw new EfunException("typeof() requires exactly 1 argument");
         }
 
-        return args[0] switch
+        return LpcValue.FromObject(args[0].Kind switch
         {
-            int => "int",
-            long => "int",  // LPC doesn't distinguish int/long - both are "int"
-            string => "string",
+            LpcValueKind.Int => "int",  // LPC doesn't distinguish int/long - both are "int"
+            LpcValueKind.String => "string",
             _ => "unknown"
-        };
+        });
     }
 
     /// <summary>
     /// strlen(string) - Returns the length of a string.
     /// </summary>
-    private static object Strlen(List<object> args)
+    private static LpcValue Strlen(ReadOnlySpan<LpcValue> args)
     {
-        if (args.Count != 1)
+        if (args.Length != 1)
         {
             throw new EfunException("strlen() requires exactly 1 argument");
         }
 
-        if (args[0] is not string s)
+        if (args[0].Ref is not string s)
         {
             throw new EfunException("strlen() requires a string argument");
         }
 
-        return (long)s.Length;
+        return LpcValue.FromInt(s.Length);
     }
 
     /// <summary>
     /// sizeof(array) - Returns the number of elements in an array.
     /// Also works on strings (returns length) and mappings (returns key count).
     /// </summary>
-    private static object SizeOf(List<object> args)
+    private static LpcValue SizeOf(ReadOnlySpan<LpcValue> args)
     {
-        if (args.Count != 1)
+        if (args.Length != 1)
         {
             throw new EfunException("sizeof() requires exactly 1 argument");
         }
 
-        return args[0] switch
+        return args[0].Ref switch
         {
-            List<object> list => (long)list.Count,
-            string s => (long)s.Length,
-            Dictionary<object, object> dict => (long)dict.Count,
-            _ => throw new EfunException($"sizeof() requires an array, string, or mapping, got {args[0]?.GetType().Name ?? "null"}")
+            List<object> list => LpcValue.FromInt(list.Count),
+            string s => LpcValue.FromInt(s.Length),
+            Dictionary<object, object> dict => LpcValue.FromInt(dict.Count),
+            _ => throw new EfunException($"sizeof() requires an array, string, or mapping, got {args[0].ToObject()?.GetType().Name ?? "null"}")
         };
     }
 
@@ -469,7 +684,55 @@ public class EfunRegistry
             return new List<object>();
         }
 
-        return target.Contents.Cast<object>().ToList();
+        var result = new List<object>(target.Contents.Count);
+        foreach (var obj in target.Contents)
+        {
+            result.Add(obj);
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// all_livings(obj) - Returns an array of the living objects in obj, in
+    /// inventory order. The driver keeps these on their own list as objects
+    /// move, so the rest of obj's contents aren't looked at.
+    /// </summary>
+    private static object AllLivings(List<object> args)
+    {
+        if (args.Count != 1)
+        {
+            throw new EfunException("all_livings() requires exactly 1 argument");
+        }
+
+        if (args[0] is not MudObject obj)
+        {
+            throw new EfunException("all_livings() argument must be an object");
+        }
+
+        var result = new List<object>(obj.LivingContents.Count);
+        foreach (var living in obj.LivingContents)
+        {
+            result.Add(living);
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// all_interactive(obj) - Returns an array of the connected players in obj.
+    /// </summary>
+    private static object AllInteractive(List<object> args)
+    {
+        if (args.Count != 1)
+        {
+            throw new EfunException("all_interactive() requires exactly 1 argument");
+        }
+
+        if (args[0] is not MudObject obj)
+        {
+            throw new EfunException("all_interactive() argument must be an object");
+        }
+
+        return obj.InteractiveContents.Cast<object>().ToList();
     }
 
     /// <summary>
@@ -502,33 +765,44 @@ public class EfunRegistry
             return 0L;
         }
 
+        if (_seededRandom is { } seeded)
+        {
+            lock (seeded)
+            {
+                return seeded.NextInt64(n);
+            }
+        }
         return (long)System.Random.Shared.NextInt64(n);
     }
 
     /// <summary>
     /// abs(n) - Returns the absolute value of n.
     /// </summary>
-    private static object Abs(List<object> args)
+    private static LpcValue Abs(ReadOnlySpan<LpcValue> args)
     {
-        if (args.Count != 1)
+        if (args.Length != 1)
         {
             throw new EfunException("abs() requires exactly 1 argument");
         }
 
-        return args[0] switch
+        if (!args[0].IsInt)
         {
-            long l => Math.Abs(l),
-            int i => (long)Math.Abs(i),
-            _ => throw new EfunException("abs() argument must be an integer")
-        };
+            throw new EfunException("abs() argument must be an integer");
+        }
+        return LpcValue.FromInt(Math.Abs(args[0].Int));
     }
 
     /// <summary>
-    /// min(a, b, ...) - Returns the minimum value among the arguments.
-    /// Accepts 2 or more arguments.
+    /// min(a, b, ...) or min(array) - Returns the minimum value among the
+    /// arguments, or among the elements of an array of ints.
     /// </summary>
     private static object Min(List<object> args)
     {
+        if (args.Count == 1 && args[0] is List<object> array)
+        {
+            return array.Count == 0 ? 0L : ExtremeInt(array, -1, "min");
+        }
+
         if (args.Count < 2)
         {
             throw new EfunException("min() requires at least 2 arguments");
@@ -556,11 +830,60 @@ public class EfunRegistry
     }
 
     /// <summary>
-    /// max(a, b, ...) - Returns the maximum value among the arguments.
-    /// Accepts 2 or more arguments.
+    /// sum(array) - The total of an array of ints; 0 for an empty array.
+    /// </summary>
+    private static object Sum(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not List<object> array)
+        {
+            throw new EfunException("sum() requires an array of ints");
+        }
+
+        long total = 0;
+        foreach (var item in CollectionsMarshal.AsSpan(array))
+        {
+            total += ToIntElement(item, "sum");
+        }
+        return total;
+    }
+
+    /// <summary>
+    /// The smallest (sign -1) or largest (sign 1) int in a non-empty array,
+    /// in one pass that unboxes each element once.
+    /// </summary>
+    private static long ExtremeInt(List<object> array, int sign, string efun)
+    {
+        var items = CollectionsMarshal.AsSpan(array);
+        long best = ToIntElement(items[0], efun);
+        for (int i = 1; i < items.Length; i++)
+        {
+            long value = ToIntElement(items[i], efun);
+            if (sign < 0 ? value < best : value > best) best = value;
+        }
+        return best;
+    }
+
+    private static long ToIntElement(object item, string efun)
+    {
+        return item switch
+        {
+            long l => l,
+            int n => n,
+            _ => throw new EfunException($"{efun}() arguments must be integers")
+        };
+    }
+
+    /// <summary>
+    /// max(a, b, ...) or max(array) - Returns the maximum value among the
+    /// arguments, or among the elements of an array of ints.
     /// </summary>
     private static object Max(List<object> args)
     {
+        if (args.Count == 1 && args[0] is List<object> array)
+        {
+            return array.Count == 0 ? 0L : ExtremeInt(array, 1, "max");
+        }
+
         if (args.Count < 2)
         {
             throw new EfunException("max() requires at least 2 arguments");
@@ -589,7 +912,7 @@ public class EfunRegistry
 
     /// <summary>
     /// member_array(item, array) - Returns the index of item in array, or -1 if not found.
-    /// Comparison is done using Equals().
+    /// Comparison is LPC equality (LpcValueComparer), as for mapping keys.
     /// </summary>
     private static object MemberArray(List<object> args)
     {
@@ -605,15 +928,47 @@ public class EfunRegistry
             throw new EfunException("member_array() second argument must be an array");
         }
 
-        for (int i = 0; i < array.Count; i++)
+        return (long)IndexOfValue(array, item);
+    }
+
+    /// <summary>
+    /// Where item first appears in array by LPC equality, or -1. The scan is
+    /// picked by the kind of item, so each element costs a type test and a
+    /// compare rather than a call through the comparer: ints compare
+    /// unboxed, strings by length before contents, and objects, arrays and
+    /// mappings by reference.
+    /// </summary>
+    internal static int IndexOfValue(List<object> array, object? item)
+    {
+        var items = CollectionsMarshal.AsSpan(array);
+        switch (item)
         {
-            if (Equals(item, array[i]))
-            {
-                return (long)i;
-            }
+            case long or int:
+                long number = item is long l ? l : (int)item;
+                for (int i = 0; i < items.Length; i++)
+                {
+                    if ((items[i] is long n && n == number) || (items[i] is int m && m == number)) return i;
+                }
+                return -1;
+            case string text:
+                for (int i = 0; i < items.Length; i++)
+                {
+                    if (items[i] is string s && s.Length == text.Length && (ReferenceEquals(s, text) || s == text)) return i;
+                }
+                return -1;
+            case null or MudObject or List<object> or Dictionary<object, object>:
+                for (int i = 0; i < items.Length; i++)
+                {
+                    if (ReferenceEquals(items[i], item)) return i;
+                }
+                return -1;
+            default:
+                for (int i = 0; i < items.Length; i++)
+                {
+                    if (LpcValueComparer.Instance.Equals(item, items[i])) return i;
+                }
+                return -1;
         }
-
-        return -1L;
     }
 
     /// <summary>
@@ -633,166 +988,8 @@ public class EfunRegistry
             throw new EfunException("sprintf() first argument must be a format string");
         }
 
-        var result = new System.Text.StringBuilder();
-        var argIndex = 1;
-        var i = 0;
-
-        while (i < format.Length)
-        {
-            if (format[i] != '%')
-            {
-                result.Append(format[i]);
-                i++;
-                continue;
-            }
-
-            i++; // Skip '%'
-            if (i >= format.Length)
-            {
-                break;
-            }
-
-            // Check for %%
-            if (format[i] == '%')
-            {
-                result.Append('%');
-                i++;
-                continue;
-            }
-
-            // Parse flags
-            bool leftAlign = false;
-            bool zeroPad = false;
-
-            if (format[i] == '-')
-            {
-                leftAlign = true;
-                i++;
-            }
-            else if (format[i] == '0')
-            {
-                zeroPad = true;
-                i++;
-            }
-
-            // Parse width
-            int width = 0;
-            while (i < format.Length && char.IsDigit(format[i]))
-            {
-                width = width * 10 + (format[i] - '0');
-                i++;
-            }
-
-            if (i >= format.Length)
-            {
-                break;
-            }
-
-            // Parse format specifier
-            var spec = format[i];
-            i++;
-
-            if (argIndex >= args.Count)
-            {
-                // Not enough arguments - LPC typically just outputs nothing
-                continue;
-            }
-
-            var arg = args[argIndex++];
-            string formatted;
-
-            switch (spec)
-            {
-                case 's':
-                    formatted = arg switch
-                    {
-                        string s => s,
-                        long n => n.ToString(),
-                        int n => n.ToString(),
-                        _ => arg?.ToString() ?? ""
-                    };
-                    break;
-                case 'd':
-                case 'i':
-                    formatted = arg switch
-                    {
-                        long n => n.ToString(),
-                        int n => n.ToString(),
-                        string s when long.TryParse(s, out var n) => n.ToString(),
-                        _ => "0"
-                    };
-                    break;
-                case 'o':
-                    formatted = arg switch
-                    {
-                        long n => Convert.ToString(n, 8),
-                        int n => Convert.ToString(n, 8),
-                        _ => "0"
-                    };
-                    break;
-                case 'x':
-                    formatted = arg switch
-                    {
-                        long n => Convert.ToString(n, 16),
-                        int n => Convert.ToString(n, 16),
-                        _ => "0"
-                    };
-                    break;
-                case 'X':
-                    formatted = arg switch
-                    {
-                        long n => Convert.ToString(n, 16).ToUpper(),
-                        int n => Convert.ToString(n, 16).ToUpper(),
-                        _ => "0"
-                    };
-                    break;
-                case 'O':
-                    // %O is LPC's "object" format - dump the value
-                    formatted = FormatValue(arg);
-                    break;
-                default:
-                    formatted = arg?.ToString() ?? "";
-                    break;
-            }
-
-            // Apply width
-            if (width > 0 && formatted.Length < width)
-            {
-                if (leftAlign)
-                {
-                    formatted = formatted.PadRight(width);
-                }
-                else if (zeroPad && (spec == 'd' || spec == 'i' || spec == 'o' || spec == 'x' || spec == 'X'))
-                {
-                    formatted = formatted.PadLeft(width, '0');
-                }
-                else
-                {
-                    formatted = formatted.PadLeft(width);
-                }
-            }
-
-            result.Append(formatted);
-        }
-
-        return result.ToString();
-    }
-
-    /// <summary>
-    /// Format a value for %O (object dump) output.
-    /// </summary>
-    private static string FormatValue(object value)
-    {
-        return value switch
-        {
-            null => "0",
-            int i => i.ToString(),
-            string s => $"\"{s}\"",
-            List<object> arr => "({ " + string.Join(", ", arr.Select(FormatValue)) + " })",
-            Dictionary<object, object> dict => "([ " + string.Join(", ", dict.Select(kv => $"{FormatValue(kv.Key)}: {FormatValue(kv.Value)}")) + " ])",
-            MudObject obj => obj.FilePath,
-            _ => value.ToString() ?? "0"
-        };
+        // Parsed once per format; literal formats are precompiled by the compiler
+        return SprintfFormat.Get(format).Format(args, 1);
     }
 
     /// <summary>
@@ -822,8 +1019,21 @@ public class EfunRegistry
             return str.Select(c => (object)c.ToString()).ToList();
         }
 
-        var parts = str.Split(delimiter);
-        return parts.Select(p => (object)p).ToList();
+        // Count the pieces first so the array is allocated once; both the
+        // count and the search are vectorized span scans
+        var text = str.AsSpan();
+        var separator = delimiter.AsSpan();
+        var parts = new List<object>(text.Count(separator) + 1);
+        int start = 0;
+        while (true)
+        {
+            int found = text[start..].IndexOf(separator);
+            if (found < 0) break;
+            parts.Add(str.Substring(start, found));
+            start += found + separator.Length;
+        }
+        parts.Add(str[start..]);
+        return parts;
     }
 
     /// <summary>
@@ -847,12 +1057,17 @@ public class EfunRegistry
             throw new EfunException("implode() second argument must be a string");
         }
 
-        var strings = arr.Select(item => item switch
+        // The pieces are gathered into one array so Join can size the result up front
+        var strings = new string[arr.Count];
+        for (int i = 0; i < strings.Length; i++)
         {
-            string s => s,
-            int i => i.ToString(),
-            _ => item?.ToString() ?? ""
-        });
+            strings[i] = arr[i] switch
+            {
+                string s => s,
+                int n => n.ToString(),
+                var item => item?.ToString() ?? ""
+            };
+        }
 
         return string.Join(delimiter, strings);
     }
@@ -1042,7 +1257,7 @@ public class EfunRegistry
 
         try
         {
-            var regex = new System.Text.RegularExpressions.Regex(pattern);
+            var regex = RegexCache.Get(pattern);
             var result = new List<object>();
 
             foreach (var item in arr)
@@ -1060,6 +1275,10 @@ public class EfunRegistry
         {
             throw new EfunException($"Invalid regular expression: {ex.Message}");
         }
+        catch (System.Text.RegularExpressions.RegexMatchTimeoutException)
+        {
+            throw new EfunException($"Regular expression timed out: {pattern}");
+        }
     }
 
     /// <summary>
@@ -1094,7 +1313,7 @@ public class EfunRegistry
 
         try
         {
-            var regex = new System.Text.RegularExpressions.Regex(pattern);
+            var regex = RegexCache.Get(pattern);
             var match = regex.Match(str, start);
 
             if (match.Success)
@@ -1108,6 +1327,10 @@ public class EfunRegistry
         {
             throw new EfunException($"Invalid regular expression: {ex.Message}");
         }
+        catch (System.Text.RegularExpressions.RegexMatchTimeoutException)
+        {
+            throw new EfunException($"Regular expression timed out: {pattern}");
+        }
     }
 
     /// <summary>
@@ -1134,7 +1357,7 @@ public class EfunRegistry
 
         try
         {
-            var regex = new System.Text.RegularExpressions.Regex(pattern);
+            var regex = RegexCache.Get(pattern);
             var result = new List<object>();
             var lastEnd = 0;
 
@@ -1162,6 +1385,10 @@ public class EfunRegistry
         {
             throw new EfunException($"Invalid regular expression: {ex.Message}");
         }
+        catch (System.Text.RegularExpressions.RegexMatchTimeoutException)
+        {
+            throw new EfunException($"Regular expression timed out: {pattern}");
+        }
     }
 
     #endregion
@@ -1172,8 +1399,9 @@ public class EfunRegistry
     /// sort_array(arr, direction) - Sort an array.
     /// direction: 1 for ascending, -1 for descending.
     /// Returns a new sorted array (does not modify original).
+    /// The object interpreter handles the callback form, sort_array(arr, func).
     /// </summary>
-    private static object SortArray(List<object> args)
+    public static object SortArray(List<object> args)
     {
         if (args.Count < 1 || args.Count > 2)
         {
@@ -1191,41 +1419,62 @@ public class EfunRegistry
             direction = Convert.ToInt32(args[1]);
         }
 
-        // Create a copy for sorting
-        var result = new List<object>(arr);
+        var result = SortHomogeneous(arr);
+        if (result == null)
+        {
+            // Create a copy for sorting
+            result = new List<object>(arr);
+            result.Sort(CompareMixed);
+        }
+        if (direction < 0)
+        {
+            result.Reverse();
+        }
+
+        return result;
+    }
 
-        result.Sort((a, b) =>
+    /// <summary>
+    /// Sort an array of all ints or all strings without boxing comparisons,
+    /// or null if it is mixed. Equal ints or strings are interchangeable, so
+    /// stability doesn't matter here.
+    /// </summary>
+    private static List<object>? SortHomogeneous(List<object> arr)
+    {
+        if (arr.TrueForAll(item => item is long))
         {
-            int cmp;
-            if (a is long al && b is long bl)
-            {
-                cmp = al.CompareTo(bl);
-            }
-            else if (a is int ai && b is int bi)
-            {
-                cmp = ai.CompareTo(bi);
-            }
-            else if ((a is int or long) && (b is int or long))
-            {
-                // Mixed int/long - convert both to long
-                long la = Convert.ToInt64(a);
-                long lb = Convert.ToInt64(b);
-                cmp = la.CompareTo(lb);
-            }
-            else if (a is string sa && b is string sb)
-            {
-                cmp = string.Compare(sa, sb, StringComparison.Ordinal);
-            }
-            else
-            {
-                // Mixed types: compare by string representation
-                cmp = string.Compare(a?.ToString() ?? "", b?.ToString() ?? "", StringComparison.Ordinal);
-            }
+            var keys = new long[arr.Count];
+            for (int i = 0; i < keys.Length; i++) keys[i] = (long)arr[i];
+            Array.Sort(keys);
+            var sorted = new List<object>(keys.Length);
+            foreach (var key in keys) sorted.Add(key);
+            return sorted;
+        }
 
-            return direction >= 0 ? cmp : -cmp;
-        });
+        if (arr.TrueForAll(item => item is string))
+        {
+            var keys = new string[arr.Count];
+            for (int i = 0; i < keys.Length; i++) keys[i] = (string)arr[i];
+            Array.Sort(keys, StringComparer.Ordinal);
+            return new List<object>(keys);
+        }
 
-        return result;
+        return null;
+    }
+
+    private static int CompareMixed(object a, object b)
+    {
+        if ((a is int or long) && (b is int or long))
+        {
+            return Convert.ToInt64(a).CompareTo(Convert.ToInt64(b));
+        }
+        if (a is string sa && b is string sb)
+        {
+            return string.Compare(sa, sb, StringComparison.Ordinal);
+        }
+
+        // Mixed types: compare by string representation
+        return string.Compare(a?.ToString() ?? "", b?.ToString() ?? "", StringComparison.Ordinal);
     }
 
     /// <summary>
@@ -1244,7 +1493,7 @@ public class EfunRegistry
             throw new EfunException("unique_array() argument must be an array");
         }
 
-        var seen = new HashSet<object>();
+        var seen = new HashSet<object>(LpcValueComparer.Instance);
         var result = new List<object>();
 
         foreach (var item in arr)
@@ -1277,7 +1526,7 @@ public class EfunRegistry
             throw new EfunException("m_indices() argument must be a mapping");
         }
 
-        return mapping.Keys.ToList();
+        return new List<object>(mapping.Keys);
     }
 
     /// <summary>
@@ -1295,7 +1544,7 @@ public class EfunRegistry
             throw new EfunException("m_values() argument must be a mapping");
         }
 
-        return mapping.Values.Cast<object>().ToList();
+        return new List<object>(mapping.Values);
     }
 
     /// <summary>
@@ -1344,7 +1593,7 @@ public class EfunRegistry
             throw new EfunException("mkmapping() requires arrays of equal length");
         }
 
-        var result = new Dictionary<object, object>();
+        var result = new LpcMapping();
         for (int i = 0; i < keys.Count; i++)
         {
             result[keys[i]] = values[i];
@@ -1437,14 +1686,7 @@ public class EfunRegistry
         // Array search (for element)
         if (collection is List<object> array)
         {
-            for (int i = 0; i < array.Count; i++)
-            {
-                if (Equals(element, array[i]))
-                {
-                    return (long)i;
-                }
-            }
-            return -1L;
+            return (long)IndexOfValue(array, element);
         }
 
         // Mapping key check
@@ -1476,12 +1718,7 @@ public class EfunRegistry
             throw new EfunException("first_inventory() argument must be an object");
         }
 
-        if (obj.Contents.Count > 0)
-        {
-            return obj.Contents[0];
-        }
-
-        return 0;
+        return (object?)obj.Contents.First ?? 0;
     }
 
     /// <summary>
@@ -1501,23 +1738,7 @@ public class EfunRegistry
             throw new EfunException("next_inventory() argument must be an object");
         }
 
-        var env = obj.Environment;
-        if (env == null)
-        {
-            return 0;
-        }
-
-        // Find this object in parent's contents and return the next one
-        var contents = env.Contents;
-        for (int i = 0; i < contents.Count - 1; i++)
-        {
-            if (contents[i] == obj)
-            {
-                return contents[i + 1];
-            }
-        }
-
-        return 0;
+        return (object?)obj.NextContent ?? 0;
     }
 
     #endregion
@@ -1527,62 +1748,62 @@ public class EfunRegistry
     /// <summary>
     /// intp(x) - Returns 1 if x is an integer (32-bit or 64-bit), 0 otherwise.
     /// </summary>
-    private static object Intp(List<object> args)
+    private static LpcValue Intp(ReadOnlySpan<LpcValue> args)
     {
-        if (args.Count != 1)
+        if (args.Length != 1)
         {
             throw new EfunException("intp() requires exactly 1 argument");
         }
-        return args[0] is int or long ? 1L : 0L;
+        return LpcValue.FromBool(args[0].IsInt);
     }
 
     /// <summary>
     /// stringp(x) - Returns 1 if x is a string, 0 otherwise.
     /// </summary>
-    private static object Stringp(List<object> args)
+    private static LpcValue Stringp(ReadOnlySpan<LpcValue> args)
     {
-        if (args.Count != 1)
+        if (args.Length != 1)
         {
             throw new EfunException("stringp() requires exactly 1 argument");
         }
-        return args[0] is string ? 1L : 0L;
+        return LpcValue.FromBool(args[0].Kind == LpcValueKind.String);
     }
 
     /// <summary>
     /// objectp(x) - Returns 1 if x is an object, 0 otherwise.
     /// </summary>
-    private static object Objectp(List<object> args)
+    private static LpcValue Objectp(ReadOnlySpan<LpcValue> args)
     {
-        if (args.Count != 1)
+        if (args.Length != 1)
         {
             throw new EfunException("objectp() requires exactly 1 argument");
         }
-        return args[0] is MudObject ? 1L : 0L;
+        return LpcValue.FromBool(args[0].Kind == LpcValueKind.Object);
     }
 
     /// <summary>
     /// pointerp(x) / arrayp(x) - Returns 1 if x is an array, 0 otherwise.
     /// "Pointer" is classic LPC terminology for arrays.
     /// </summary>
-    private static object Pointerp(List<object> args)
+    private static LpcValue Pointerp(ReadOnlySpan<LpcValue> args)
     {
-        if (args.Count != 1)
+        if (args.Length != 1)
         {
             throw new EfunException("pointerp() requires exactly 1 argument");
         }
-        return args[0] is List<object> ? 1L : 0L;
+        return LpcValue.FromBool(args[0].Kind == LpcValueKind.Array);
     }
 
     /// <summary>
     /// mappingp(x) - Returns 1 if x is a mapping, 0 otherwise.
     /// </summary>
-    private static object Mappingp(List<object> args)
+    private static LpcValue Mappingp(ReadOnlySpan<LpcValue> args)
     {
-        if (args.Count != 1)
+        if (args.Length != 1)
         {
             throw new EfunException("mappingp() requires exactly 1 argument");
         }
-        return args[0] is Dictionary<object, object> ? 1L : 0L;
+        return LpcValue.FromBool(args[0].Kind == LpcValueKind.Mapping);
     }
 
     #endregion
@@ -1640,20 +1861,46 @@ public class EfunRegistry
     }
 
     /// <summary>
-    /// Recursively deep copy a value.
+    /// Recursively deep copy a value. Arrays and mappings with nothing nested
+    /// in them are copied in one block, without walking their elements twice.
     /// </summary>
-    private static object DeepCopy(object value)
+    internal static object DeepCopy(object value)
     {
-        return value switch
+        switch (value)
         {
-            List<object> list => list.Select(DeepCopy).ToList(),
-            Dictionary<object, object> dict => dict.ToDictionary(
-                kv => DeepCopy(kv.Key),
-                kv => DeepCopy(kv.Value)
-            ),
-            // Primitives and objects are not deep-copied
-            _ => value
-        };
+            case List<object> list:
+            {
+                var copy = new List<object>(list);
+                for (int i = 0; i < copy.Count; i++)
+                {
+                    if (copy[i] is List<object> or Dictionary<object, object>)
+                    {
+                        copy[i] = DeepCopy(copy[i]);
+                    }
+                }
+                return copy;
+            }
+            case Dictionary<object, object> dict:
+            {
+                var copy = new LpcMapping(dict);
+                foreach (var (key, item) in dict)
+                {
+                    if (key is List<object> or Dictionary<object, object>)
+                    {
+                        copy.Remove(key);
+                        copy[DeepCopy(key)] = DeepCopy(item);
+                    }
+                    else if (item is List<object> or Dictionary<object, object>)
+                    {
+                        copy[key] = DeepCopy(item);
+                    }
+                }
+                return copy;
+            }
+            default:
+                // Primitives and objects are not deep-copied
+                return value;
+        }
     }
 
     #endregion
@@ -1714,6 +1961,33 @@ public class EfunRegistry
 
     #endregion
 
+    /// <summary>
+    /// assert(condition, [message]) - Throw "Assertion failed: message" unless
+    /// condition is true (non-zero, a non-empty string, or any other value).
+    /// The lpc-tests runner (driver --test) reports the first failure of a file.
+    /// </summary>
+    private static object Assert(List<object> args)
+    {
+        if (args.Count is < 1 or > 2)
+        {
+            throw new EfunException("assert() requires a condition and optionally a message");
+        }
+
+        bool holds = args[0] switch
+        {
+            long l => l != 0,
+            string s => s.Length > 0,
+            var value => value != null
+        };
+        if (!holds)
+        {
+            throw new EfunException(args.Count == 2 && args[1] is string message
+                ? $"Assertion failed: {message}"
+                : "Assertion failed");
+        }
+        return 1L;
+    }
+
     #endregion
 }
 
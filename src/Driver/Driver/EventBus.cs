@@ -0,0 +1,182 @@
+namespace Driver;
+
+/// <summary>
+/// Event subscriptions, behind the subscribe(), unsubscribe() and emit()
+/// efuns. An object asks to hear an event from one source object, or from
+/// any source, and names a function; emitting the event calls exactly the
+/// objects that asked. Code that reacts to rare things (someone entering a
+/// room, a death) waits for them here instead of checking from heart_beat.
+///
+/// Subscriber lists are copied on change, so a dispatch walks the list as it
+/// was when the event fired even if a handler subscribes or unsubscribes.
+/// An object's subscriptions, and those to it as a source, go when it is
+/// destructed. Changed on the game thread (or under the world write lock)
+/// only, like the rest of the object store.
+/// </summary>
+public sealed class EventBus
+{
+    /// <summary>
+    /// A subscriber and the function of it an event calls.
+    /// </summary>
+    public readonly record struct Subscription(MudObject Subscriber, string Function);
+
+    private static readonly Subscription[] None = Array.Empty<Subscription>();
+
+    // By (source, event); a null source is "any source"
+    private readonly Dictionary<(MudObject? Source, string Event), Subscription[]> _subscriptions = new();
+
+    // The keys each object is in, as a subscriber or as the source, for RemoveObject
+    private readonly Dictionary<MudObject, HashSet<(MudObject? Source, string Event)>> _keysByObject = new();
+
+    // Subscriptions per event name, so an event nobody listens for costs one lookup
+    private readonly Dictionary<string, int> _perEvent = new();
+
+    /// <summary>
+    /// Subscriptions in all.
+    /// </summary>
+    public int Count { get; private set; }
+
+    /// <summary>
+    /// Whether anything is subscribed to event, from any source.
+    /// </summary>
+    public bool HasSubscribers(string eventName) => _perEvent.ContainsKey(eventName);
+
+    /// <summary>
+    /// Have subscriber's function called when source (null for any source)
+    /// emits eventName. Returns false if it was already subscribed so.
+    /// </summary>
+    public bool Subscribe(MudObject? source, string eventName, MudObject subscriber, string function)
+    {
+        var key = (source, eventName);
+        var subscription = new Subscription(subscriber, function);
+        var current = _subscriptions.GetValueOrDefault(key, None);
+        if (Array.IndexOf(current, subscription) >= 0) return false;
+
+        _subscriptions[key] = current.Append(subscription).ToArray();
+        Track(subscriber, key);
+        if (source != null) Track(source, key);
+        _perEvent[eventName] = _perEvent.GetValueOrDefault(eventName) + 1;
+        Count++;
+        return true;
+    }
+
+    /// <summary>
+    /// Drop subscriber's subscriptions to eventName from source (null for
+    /// the any-source ones), only those calling function if it is given.
+    /// Returns how many went.
+    /// </summary>
+    public int Unsubscribe(MudObject? source, string eventName, MudObject subscriber, string? function)
+    {
+        var key = (source, eventName);
+        if (!_subscriptions.TryGetValue(key, out var current)) return 0;
+
+        var kept = current.Where(s => s.Subscriber != subscriber || (function != null && s.Function != function)).ToArray();
+        int removed = current.Length - kept.Length;
+        if (removed == 0) return 0;
+
+        Replace(key, kept, removed);
+        if (subscriber != source && !kept.Any(s => s.Subscriber == subscriber)) Forget(subscriber, key);
+        return removed;
+    }
+
+    /// <summary>
+    /// Drop everything obj subscribed to and every subscription to obj as a
+    /// source (called when it is destructed).
+    /// </summary>
+    public void RemoveObject(MudObject obj)
+    {
+        if (!_keysByObject.Remove(obj, out var keys)) return;
+
+        foreach (var key in keys)
+        {
+            if (!_subscriptions.TryGetValue(key, out var current)) continue;
+
+            var kept = None;
+            if (key.Source == obj)
+            {
+                foreach (var other in current) Forget(other.Subscriber, key);
+            }
+            else
+            {
+                kept = current.Where(s => s.Subscriber != obj).ToArray();
+            }
+            Replace(key, kept, current.Length - kept.Length);
+        }
+    }
+
+    /// <summary>
+    /// The subscriptions to eventName from exactly source (null for the
+    /// any-source ones), in the order they were made.
+    /// </summary>
+    public Subscription[] For(MudObject? source, string eventName)
+    {
+        return _subscriptions.GetValueOrDefault((source, eventName), None);
+    }
+
+    /// <summary>
+    /// Everything obj has subscribed to, as (source, event, function).
+    /// </summary>
+    public List<(MudObject? Source, string Event, string Function)> SubscriptionsOf(MudObject obj)
+    {
+        var result = new List<(MudObject? Source, string Event, string Function)>();
+        if (!_keysByObject.TryGetValue(obj, out var keys)) return result;
+
+        foreach (var key in keys)
+        {
+            foreach (var subscription in For(key.Source, key.Event))
+            {
+                if (subscription.Subscriber == obj) result.Add((key.Source, key.Event, subscription.Function));
+            }
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Every subscription, as (source, event, subscriber, function).
+    /// </summary>
+    public IEnumerable<(MudObject? Source, string Event, MudObject Subscriber, string Function)> All()
+    {
+        foreach (var ((source, eventName), subscriptions) in _subscriptions)
+        {
+            foreach (var (subscriber, function) in subscriptions)
+            {
+                yield return (source, eventName, subscriber, function);
+            }
+        }
+    }
+
+    private void Replace((MudObject? Source, string Event) key, Subscription[] kept, int removed)
+    {
+        if (kept.Length > 0)
+        {
+            _subscriptions[key] = kept;
+        }
+        else
+        {
+            _subscriptions.Remove(key);
+            if (key.Source != null) Forget(key.Source, key);
+        }
+
+        Count -= removed;
+        int left = _perEvent[key.Event] - removed;
+        if (left == 0) _perEvent.Remove(key.Event);
+        else _perEvent[key.Event] = left;
+    }
+
+    private void Track(MudObject obj, (MudObject? Source, string Event) key)
+    {
+        if (!_keysByObject.TryGetValue(obj, out var keys))
+        {
+            _keysByObject[obj] = keys = new HashSet<(MudObject? Source, string Event)>();
+        }
+        keys.Add(key);
+    }
+
+    private void Forget(MudObject obj, (MudObject? Source, string Event) key)
+    {
+        if (_keysByObject.TryGetValue(obj, out var keys) && keys.Remove(key) && keys.Count == 0)
+        {
+            _keysByObject.Remove(obj);
+        }
+    }
+}
@@ -21,6 +21,9 @@ public class ExecutionContext
     [ThreadStatic]
     private static ExecutionContext? _initContext;
 
+    [ThreadStatic]
+    private static ExecutionContext? _initContextCache;
+
     /// <summary>
     /// Gets or sets the current execution context for this thread.
     /// </summary>
@@ -36,7 +39,10 @@ public class ExecutionContext
     /// </summary>
     public static void SetCurrentForInit(MudObject playerObject)
     {
-        _initContext = new ExecutionContext { _playerObject = playerObject };
+        // One per thread, reused: nested moves see it as Current and don't come here
+        var context = _initContextCache ??= new ExecutionContext();
+        context._playerObject = playerObject;
+        _initContext = context;
     }
 
     /// <summary>
@@ -44,6 +50,13 @@ public class ExecutionContext
     /// </summary>
     public static void ClearCurrentForInit()
     {
+        if (_initContext != null)
+        {
+            _initContext._playerObject = null;
+            _initContext.CurrentVerb = null;
+            _initContext.CurrentArgs = null;
+            _initContext.NotifyFailMessage = null;
+        }
         _initContext = null;
     }
 
@@ -168,6 +181,16 @@ public record PlayerCommand
     /// When the command was submitted.
     /// </summary>
     public DateTime Timestamp { get; init; } = DateTime.UtcNow;
+
+    /// <summary>
+    /// One step of a speedwalk, already rate limited as part of the walk.
+    /// </summary>
+    public bool SpeedwalkStep { get; init; }
+
+    /// <summary>
+    /// Stage timestamps for GameLoop.Latency, for a player's command.
+    /// </summary>
+    public CommandTrace? Trace { get; init; }
 }
 
 /// <summary>
@@ -184,6 +207,25 @@ public record OutputMessage
     /// The content to send.
     /// </summary>
     public string Content { get; init; } = string.Empty;
+
+    /// <summary>
+    /// Content is a GMCP message rather than text.
+    /// </summary>
+    public bool Gmcp { get; init; }
+
+    /// <summary>
+    /// Not output: the connection's player is moving to another cluster node.
+    /// The server sends this to the router once everything before it has
+    /// gone out, and drops anything after it.
+    /// </summary>
+    public ClusterMessage? Handoff { get; init; }
+
+    /// <summary>
+    /// Not output: the traced command before it has finished, and everything
+    /// it wrote is ahead of this in the queue. The server marks the trace's
+    /// Output stage over, and its Send stage when that output is written.
+    /// </summary>
+    public CommandTrace? Trace { get; init; }
 }
 
 /// <summary>
@@ -197,6 +239,16 @@ public class PlayerSession
     /// </summary>
     public string ConnectionId { get; set; } = string.Empty;
 
+    /// <summary>
+    /// The client's IP address, when known.
+    /// </summary>
+    public string? RemoteAddress { get; set; }
+
+    /// <summary>
+    /// This connection's command rate limit bucket.
+    /// </summary>
+    public CommandRate CommandRate { get; } = new();
+
     /// <summary>
     /// The player object for this session.
     /// Null until authentication is complete.
@@ -268,6 +320,38 @@ public class PlayerSession
     /// Used to determine when to clean up expired linkdead sessions.
     /// </summary>
     public DateTime? LinkdeadSince { get; set; }
+
+    /// <summary>
+    /// What the client reported about its terminal through TTYPE; null if nothing.
+    /// </summary>
+    public TerminalInfo? Terminal { get; set; }
+
+    /// <summary>
+    /// The color class the player chose (set_color()); null to go by Terminal.
+    /// </summary>
+    public ColorSupport? ColorMode { get; set; }
+
+    /// <summary>
+    /// The client's window width from NAWS; 0 if it hasn't reported one.
+    /// </summary>
+    public int WindowWidth { get; set; }
+
+    /// <summary>
+    /// The client's window height from NAWS; 0 if it hasn't reported one.
+    /// </summary>
+    public int WindowHeight { get; set; }
+
+    /// <summary>
+    /// Room to put the player in at login, for a player handed over from
+    /// another cluster node; null to use their saved location.
+    /// </summary>
+    public string? ArrivalRoom { get; init; }
+
+    /// <summary>
+    /// The player is being handed off to another cluster node: they are
+    /// taken out of the game here when their connection closes, not left linkdead.
+    /// </summary>
+    public bool HandingOff { get; set; }
 }
 
 /// <summary>
@@ -0,0 +1,113 @@
+namespace Driver;
+
+/// <summary>
+/// A foreach loop's place in what it visits: array elements, mapping keys
+/// (and their values, for a two-variable loop) or string characters, all of
+/// them or a range.
+///
+/// Arrays and strings are walked by index, so a loop costs this one object
+/// rather than an enumerator plus, for strings, a LINQ iterator. Characters
+/// come back as one-character strings shared from a table for ASCII, so a
+/// loop over a string allocates nothing per character. A mapping's entries
+/// are walked directly, so foreach (k, v in m) looks nothing up. foreach
+/// over arr[a..b] or str[a..b] walks that part of the original, with no copy.
+///
+/// A range is taken when the loop starts; assigning to an element from the
+/// body is seen by later iterations, as with the whole array.
+/// </summary>
+internal sealed class ForeachCursor
+{
+    private static readonly string[] AsciiChars = Enumerable.Range(0, 128).Select(c => ((char)c).ToString()).ToArray();
+
+    private readonly List<object>? _list;
+    private readonly string? _text;
+    private Dictionary<object, object>.Enumerator _entries;
+    private readonly bool _isMapping;
+    private int _index;
+    private readonly int _end;
+
+    private ForeachCursor(List<object>? list, string? text, Dictionary<object, object>? mapping, int start, int end)
+    {
+        _list = list;
+        _text = text;
+        if (mapping != null)
+        {
+            _entries = mapping.GetEnumerator();
+            _isMapping = true;
+        }
+        _index = start;
+        _end = end;
+    }
+
+    /// <summary>
+    /// The value under the key MoveNext() last gave, for a cursor over a mapping.
+    /// </summary>
+    public object Value => _entries.Current.Value;
+
+    /// <summary>
+    /// A cursor over the whole of collection; with pairs, over a mapping's
+    /// keys and values, and anything else is an error.
+    /// </summary>
+    public static ForeachCursor Over(object? collection, bool pairs = false)
+    {
+        if (pairs && collection is not Dictionary<object, object>)
+        {
+            throw new ObjectInterpreterException(
+                $"foreach with two variables needs a mapping, not {collection?.GetType().Name ?? "null"}");
+        }
+
+        return collection switch
+        {
+            List<object> list => new ForeachCursor(list, null, null, 0, int.MaxValue),
+            Dictionary<object, object> mapping => new ForeachCursor(null, null, mapping, 0, 0),
+            string text => new ForeachCursor(null, text, null, 0, text.Length),
+            _ => throw new ObjectInterpreterException($"Cannot iterate over type: {collection?.GetType().Name ?? "null"}")
+        };
+    }
+
+    /// <summary>
+    /// A cursor over collection[start..end] by the range operator's rules (a
+    /// null bound is open, negative bounds count from the end).
+    /// </summary>
+    public static ForeachCursor OverRange(object? collection, object? start, object? end)
+    {
+        int length = collection switch
+        {
+            List<object> list => list.Count,
+            string text => text.Length,
+            _ => throw new ObjectInterpreterException($"Cannot apply range operator to {collection?.GetType().Name ?? "null"}")
+        };
+
+        ObjectInterpreter.RangeBounds(length, start, end, out int first, out int count);
+        return new ForeachCursor(collection as List<object>, collection as string, null, first, first + count);
+    }
+
+    public bool MoveNext(out object? item)
+    {
+        if (_isMapping)
+        {
+            bool more = _entries.MoveNext();
+            item = more ? _entries.Current.Key : null;
+            return more;
+        }
+
+        if (_list != null)
+        {
+            // Checked against the current length in case the body shrank the array
+            if (_index < _end && _index < _list.Count)
+            {
+                item = _list[_index++];
+                return true;
+            }
+        }
+        else if (_index < _end)
+        {
+            char c = _text![_index++];
+            item = c < AsciiChars.Length ? AsciiChars[c] : c.ToString();
+            return true;
+        }
+
+        item = null;
+        return false;
+    }
+}
@@ -0,0 +1,219 @@
+using System.Diagnostics;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// Per-function LPC profiler, driven by the interpreter's call path.
+///
+/// While enabled, every LPC function call is charged to its (program, function)
+/// pair: the number of calls, the instructions and wall time spent inside it
+/// including callees (inclusive) and excluding them (self). Calls are also
+/// kept as a call tree, so the self costs can be written out as folded stacks
+/// for flame graph tools.
+///
+/// While disabled the interpreter only tests Enabled once per call.
+/// Not thread-safe: like the interpreter, it is used from the game thread.
+/// </summary>
+public sealed class FunctionProfiler
+{
+    /// <summary>
+    /// Totals for one (program, function) pair.
+    /// </summary>
+    public sealed class FunctionStats
+    {
+        public string Program { get; }
+        public string Function { get; }
+        public long Calls { get; internal set; }
+        public long Instructions { get; internal set; }
+        public long SelfInstructions { get; internal set; }
+        public long Microseconds => ToMicroseconds(Elapsed);
+        public long SelfMicroseconds => ToMicroseconds(SelfElapsed);
+
+        internal long Elapsed;
+        internal long SelfElapsed;
+
+        // Frames of this function currently on the stack; recursive calls only
+        // add inclusive cost at the outermost one so it isn't counted twice
+        internal int Active;
+
+        internal FunctionStats(string program, string function)
+        {
+            Program = program;
+            Function = function;
+        }
+
+        /// <summary>
+        /// Frame name used in stack traces and folded output.
+        /// </summary>
+        public string Name => $"{Program}:{Function}";
+    }
+
+    private sealed class CallNode
+    {
+        public readonly FunctionStats? Function;
+        public readonly Dictionary<FunctionStats, CallNode> Children = new();
+        public long SelfInstructions;
+        public long SelfElapsed;
+
+        public CallNode(FunctionStats? function)
+        {
+            Function = function;
+        }
+    }
+
+    private struct Frame
+    {
+        public CallNode Node;
+        public long StartInstructions;
+        public long StartTimestamp;
+        public long ChildInstructions;
+        public long ChildElapsed;
+    }
+
+    private readonly Dictionary<(string, string), FunctionStats> _functions = new();
+    private readonly Stack<Frame> _frames = new();
+    private CallNode _root = new(null);
+
+    /// <summary>
+    /// Whether calls are being recorded.
+    /// </summary>
+    public bool Enabled { get; set; }
+
+    /// <summary>
+    /// Number of distinct functions recorded.
+    /// </summary>
+    public int FunctionCount => _functions.Count;
+
+    private static long ToMicroseconds(long elapsedTimestamp)
+    {
+        return elapsedTimestamp * 1_000_000 / Stopwatch.Frequency;
+    }
+
+    /// <summary>
+    /// A function was entered. instructions is the interpreter's running
+    /// instruction total.
+    /// </summary>
+    public void Enter(string program, string function, long instructions)
+    {
+        if (!_functions.TryGetValue((program, function), out var stats))
+        {
+            stats = new FunctionStats(program, function);
+            _functions[(program, function)] = stats;
+        }
+        stats.Calls++;
+        stats.Active++;
+
+        var parent = _frames.Count > 0 ? _frames.Peek().Node : _root;
+        if (!parent.Children.TryGetValue(stats, out var node))
+        {
+            node = new CallNode(stats);
+            parent.Children[stats] = node;
+        }
+
+        _frames.Push(new Frame
+        {
+            Node = node,
+            StartInstructions = instructions,
+            StartTimestamp = Stopwatch.GetTimestamp()
+        });
+    }
+
+    /// <summary>
+    /// The function from the matching Enter() returned or threw.
+    /// </summary>
+    public void Exit(long instructions)
+    {
+        if (_frames.Count == 0) return;
+
+        var frame = _frames.Pop();
+        long elapsed = Stopwatch.GetTimestamp() - frame.StartTimestamp;
+        long executed = instructions - frame.StartInstructions;
+        long selfInstructions = executed - frame.ChildInstructions;
+        long selfElapsed = elapsed - frame.ChildElapsed;
+
+        var stats = frame.Node.Function!;
+        stats.Active--;
+        stats.SelfInstructions += selfInstructions;
+        stats.SelfElapsed += selfElapsed;
+        if (stats.Active == 0)
+        {
+            stats.Instructions += executed;
+            stats.Elapsed += elapsed;
+        }
+        frame.Node.SelfInstructions += selfInstructions;
+        frame.Node.SelfElapsed += selfElapsed;
+
+        if (_frames.Count > 0)
+        {
+            var parent = _frames.Pop();
+            parent.ChildInstructions += executed;
+            parent.ChildElapsed += elapsed;
+            _frames.Push(parent);
+        }
+    }
+
+    /// <summary>
+    /// Recorded functions, costliest (by self instructions) first.
+    /// </summary>
+    public List<FunctionStats> GetTopFunctions(int limit = int.MaxValue, string? programPrefix = null)
+    {
+        return _functions.Values
+            .Where(stats => programPrefix == null || stats.Program.StartsWith(programPrefix, StringComparison.Ordinal))
+            .OrderByDescending(stats => stats.SelfInstructions)
+            .ThenByDescending(stats => stats.SelfElapsed)
+            .Take(limit)
+            .ToList();
+    }
+
+    /// <summary>
+    /// The call tree as folded stacks ("a;b;c weight" per line), the input
+    /// format of flamegraph.pl and speedscope. Weights are self instructions,
+    /// or self microseconds when byTime is set.
+    /// </summary>
+    public string ToFoldedStacks(bool byTime = false)
+    {
+        var lines = new List<string>();
+        var path = new List<string>();
+        foreach (var child in _root.Children.Values)
+        {
+            Fold(child, path, lines, byTime);
+        }
+        lines.Sort(StringComparer.Ordinal);
+
+        var sb = new StringBuilder();
+        foreach (var line in lines)
+        {
+            sb.Append(line).Append('\n');
+        }
+        return sb.ToString();
+    }
+
+    private static void Fold(CallNode node, List<string> path, List<string> lines, bool byTime)
+    {
+        path.Add(node.Function!.Name);
+
+        long weight = byTime ? ToMicroseconds(node.SelfElapsed) : node.SelfInstructions;
+        if (weight > 0)
+        {
+            lines.Add($"{string.Join(";", path)} {weight}");
+        }
+        foreach (var child in node.Children.Values)
+        {
+            Fold(child, path, lines, byTime);
+        }
+
+        path.RemoveAt(path.Count - 1);
+    }
+
+    /// <summary>
+    /// Forget everything recorded so far. Calls still on the stack when this
+    /// runs are not counted.
+    /// </summary>
+    public void Clear()
+    {
+        _functions.Clear();
+        _root = new CallNode(null);
+        _frames.Clear();
+    }
+}
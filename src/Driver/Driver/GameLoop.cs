@@ -1,4 +1,5 @@
 using System.Collections.Concurrent;
+using System.Diagnostics;
 
 namespace Driver;
 
@@ -6,14 +7,22 @@ namespace Driver;
 /// Central game loop that processes all player commands on a single thread.
 /// This ensures LPC code execution is single-threaded, avoiding all race conditions.
 /// Network I/O remains async on separate threads.
+/// With RegionThreads set, heartbeats in world areas run on region workers
+/// (see RegionWorkers) while the game thread waits for them.
+///
+/// The world (objects, heartbeats, timers) belongs to the game thread and is
+/// kept without locks. Other threads hand it work through Post(), or the
+/// queues for input and logins, and read what it publishes between ticks:
+/// the object store's Snapshot and the scheduler figures below.
 /// </summary>
 public class GameLoop
 {
     /// <summary>
-    /// Commands queued from player connections, waiting to be processed.
+    /// Commands queued from player connections, waiting to be processed, one
+    /// queue per connection served round-robin.
     /// Thread-safe for concurrent enqueuing from network threads.
     /// </summary>
-    private readonly ConcurrentQueue<PlayerCommand> _commandQueue = new();
+    public CommandScheduler Commands { get; } = new();
 
     /// <summary>
     /// Output messages to be sent to connections.
@@ -48,6 +57,11 @@ public class GameLoop
     /// </summary>
     private readonly ObjectManager _objectManager;
 
+    /// <summary>
+    /// Cached verb to /cmds/ file lookups, watched while the loop runs.
+    /// </summary>
+    public CommandResolver CommandResolver { get; }
+
     /// <summary>
     /// The account manager for authentication.
     /// Exposed for permission checks in efuns.
@@ -61,6 +75,16 @@ public class GameLoop
     public RateLimiter RateLimiter => _rateLimiter;
     private readonly RateLimiter _rateLimiter = new();
 
+    /// <summary>
+    /// The login prompts, run on their own thread until a session authenticates.
+    /// </summary>
+    public LoginWorker Logins { get; }
+
+    /// <summary>
+    /// Password hashing for logins and registrations, off the game thread.
+    /// </summary>
+    public LoginHasher LoginHasher => Logins.Hasher;
+
     /// <summary>
     /// The object interpreter for executing LPC code.
     /// </summary>
@@ -76,29 +100,144 @@ public class GameLoop
     /// </summary>
     private volatile bool _running;
 
+    /// <summary>
+    /// Work other threads handed to the game thread with Post(), run at the
+    /// start of the next tick.
+    /// </summary>
+    private readonly ConcurrentQueue<Action> _posted = new();
+
+    /// <summary>
+    /// Heartbeat bucket sizes and pending timers as of the end of the last
+    /// tick, for other threads.
+    /// </summary>
+    private volatile int[] _publishedBucketSizes = new int[HeartbeatIntervalTicks];
+    private volatile int _publishedTimerCount;
+
+    /// <summary>
+    /// The driver's state as of the end of the last tick, for the /status
+    /// API: replaced every tick, never changed, safe to read from any thread.
+    /// </summary>
+    public StatusSnapshot Status => _status;
+    private volatile StatusSnapshot _status = StatusSnapshot.Empty;
+
+    /// <summary>
+    /// How often the object store's Snapshot is republished. Counting clones
+    /// walks every object, and metrics don't need it fresher.
+    /// </summary>
+    private static readonly TimeSpan SnapshotPublishInterval = TimeSpan.FromSeconds(1);
+    private DateTime _lastSnapshotPublish;
+
     /// <summary>
     /// Tick interval in milliseconds (10 ticks/second).
     /// </summary>
-    private const int TickIntervalMs = 100;
+    public const int TickIntervalMs = 100;
 
-    #region Heartbeat System
+    /// <summary>
+    /// Per-phase tick timings, overrun counts and slow-tick reports.
+    /// </summary>
+    public TickProfiler TickProfiler { get; } = new(TickIntervalMs);
+
+    /// <summary>
+    /// Player command latency by stage, from the socket read to the reply's
+    /// send, and the slow command log.
+    /// </summary>
+    public CommandLatency Latency { get; } = new();
+
+    /// <summary>
+    /// The http_request() and tcp_request() efuns' requests in flight.
+    /// </summary>
+    public OutboundRequests Requests { get; } = new();
+
+    /// <summary>
+    /// LPC coroutines from start_coroutine(), resumed with the waiting resets.
+    /// </summary>
+    public Coroutines Coroutines { get; } = new();
+
+    /// <summary>
+    /// Instructions and time used per object, blueprint and domain; with a
+    /// budget, slows the heart_beat() of objects that use too much.
+    /// </summary>
+    public CpuAccounts Cpu { get; }
 
     /// <summary>
-    /// Objects that have heartbeats enabled.
-    /// heart_beat() is called on each object every HeartbeatIntervalTicks ticks.
+    /// Decides what deferrable work (heartbeats, resets, saves) fits in each
+    /// tick, and how far behind the world is running.
     /// </summary>
-    private readonly HashSet<MudObject> _heartbeatObjects = new();
-    private readonly object _heartbeatLock = new();
+    public TickBudget Budget { get; }
+
+    #region Heartbeat System
 
     /// <summary>
     /// Heartbeat interval in ticks (20 ticks = 2 seconds at 10 ticks/sec).
     /// </summary>
-    private const int HeartbeatIntervalTicks = 20;
+    internal const int HeartbeatIntervalTicks = 20;
+
+    /// <summary>
+    /// Objects that have heartbeats enabled, spread over one bucket per tick of
+    /// the heartbeat interval. Each tick runs one bucket, so every object still
+    /// beats every HeartbeatIntervalTicks ticks, but at its own phase instead
+    /// of all at once. New objects go in the emptiest bucket.
+    /// </summary>
+    private readonly List<MudObject>[] _heartbeatBuckets = CreateHeartbeatBuckets();
+
+    /// <summary>
+    /// The bucket the next tick runs.
+    /// </summary>
+    private int _heartbeatPhase;
+
+    /// <summary>
+    /// Copy of the bucket being run, reused every tick (game thread only).
+    /// </summary>
+    private readonly List<MudObject> _heartbeatBatch = new();
+
+    /// <summary>
+    /// Room-level dormancy: objects whose room has no interactive player get
+    /// no heart_beat() or reset() until a player arrives, and can catch up
+    /// with query_dormant_elapsed(). Objects without an environment (daemons,
+    /// rooms) are always awake.
+    /// </summary>
+    public bool HeartbeatDormancy { get; set; }
+
+    /// <summary>
+    /// Worker threads for running heartbeats region by region; 0 runs them
+    /// all on the game thread. Read by Start().
+    /// </summary>
+    public int RegionThreads { get; set; }
+
+    /// <summary>
+    /// The region workers while running with RegionThreads > 0.
+    /// </summary>
+    public RegionWorkers? RegionWorkers { get; private set; }
+
+    /// <summary>
+    /// Run heart_beat()s speculatively in parallel, each confined to its own
+    /// object (see HeartbeatSandbox). Ones that reach outside their object
+    /// run again on the game thread.
+    /// </summary>
+    public bool ParallelHeartbeats { get; set; }
+
+    /// <summary>
+    /// Ready heartbeats below which a tick doesn't bother going parallel.
+    /// </summary>
+    public const int MinParallelHeartbeats = 16;
+
+    /// <summary>
+    /// Heartbeats that completed in a sandbox, and those that had to be rerun
+    /// on the game thread.
+    /// </summary>
+    public long SandboxedHeartbeats { get; private set; }
+    public long SandboxAborts { get; private set; }
+
+    /// <summary>
+    /// One sandbox per ready heartbeat, reused across ticks (game thread only).
+    /// </summary>
+    private readonly List<HeartbeatSandbox> _sandboxes = new();
 
     /// <summary>
-    /// Current tick count for heartbeat timing.
+    /// Heartbeats to run this tick, after the dormancy and no-heart_beat
+    /// checks (game thread only).
     /// </summary>
-    private int _tickCount;
+    private readonly List<MudObject> _heartbeatReady = new();
 
     /// <summary>
     /// When the last periodic save occurred.
@@ -110,42 +249,154 @@ public class GameLoop
     /// </summary>
     private static readonly TimeSpan PeriodicSaveInterval = TimeSpan.FromMinutes(5);
 
-    #endregion
+    /// <summary>
+    /// Periodic world snapshot, or null for none. Also taken at shutdown and
+    /// before a copyover.
+    /// </summary>
+    public WorldSnapshot? Snapshot { get; set; }
+
+    /// <summary>
+    /// Where logins, in-game input and disconnects are recorded for --replay,
+    /// or null. Set before Start().
+    /// </summary>
+    public CommandRecorder? Recorder { get; set; }
+
+    /// <summary>
+    /// Runs garbage collections in the sleep between ticks, or null to leave
+    /// the GC alone. Set before Start().
+    /// </summary>
+    public IdleCollector? IdleCollector { get; set; }
+
+    /// <summary>
+    /// When the last world snapshot was taken.
+    /// </summary>
+    private DateTime _lastSnapshot = DateTime.UtcNow;
 
-    #region Reset System
+    /// <summary>
+    /// Seconds an object has to go without its code running before it is
+    /// offered clean_up(). 0 turns the clean_up() cycle off.
+    /// </summary>
+    public int CleanUpIdleSeconds { get; set; } = 3600;
 
     /// <summary>
-    /// Objects registered for periodic reset() calls.
-    /// Maps object to its next reset time.
+    /// How often the clean_up() cycle looks for idle objects.
     /// </summary>
-    private readonly Dictionary<MudObject, DateTime> _resetObjects = new();
-    private readonly object _resetLock = new();
+    private static readonly TimeSpan CleanUpCheckInterval = TimeSpan.FromMinutes(1);
 
     /// <summary>
-    /// Default reset interval in seconds.
+    /// When the clean_up() cycle last ran.
     /// </summary>
-    private const int DefaultResetIntervalSeconds = 60;
+    private DateTime _lastCleanUp = DateTime.UtcNow;
 
     #endregion
 
-    #region Callout System
+    #region Timer System
+
+    /// <summary>
+    /// Something scheduled on the timing wheel.
+    /// </summary>
+    private abstract record ScheduledEvent;
 
     /// <summary>
-    /// Entry in the callout queue.
+    /// A pending call_out.
     /// </summary>
-    private record CalloutEntry(
+    private sealed record CalloutEntry(
         MudObject Target,
         string Function,
         List<object> Args,
-        DateTime FireTime,
         int CalloutId
-    );
+    ) : ScheduledEvent;
+
+    /// <summary>
+    /// The next periodic reset() of an object registered with set_reset().
+    /// </summary>
+    private sealed record ResetEvent(MudObject Target) : ScheduledEvent;
+
+    /// <summary>
+    /// The end of a linkdead session's grace period.
+    /// </summary>
+    private sealed record LinkdeadExpiry(PlayerSession Session) : ScheduledEvent;
+
+    /// <summary>
+    /// A timed effect from add_effect(): Owner's TickFunction is called on
+    /// Target every IntervalTicks until ExpiresTick, then its ExpireFunction.
+    /// </summary>
+    private sealed record EffectEntry(
+        MudObject Target,
+        MudObject Owner,
+        string Id,
+        string? TickFunction,
+        string? ExpireFunction,
+        long IntervalTicks
+    ) : ScheduledEvent
+    {
+        public long ExpiresTick { get; set; }
+    }
+
+    /// <summary>
+    /// Callouts, resets, effects and linkdead expiry, keyed by game tick. Scheduling and
+    /// cancelling are O(1), and a tick with nothing due does no work, however
+    /// many timers are pending. Game thread only, like everything below.
+    /// </summary>
+    private readonly TimingWheel<ScheduledEvent> _timers = new();
+
+    /// <summary>
+    /// Pending callouts by ID and by object, so remove_call_out() and
+    /// find_call_out() only look at the calling object's own callouts.
+    /// </summary>
+    private readonly Dictionary<int, TimingWheel<ScheduledEvent>.Timer> _calloutsById = new();
+    private readonly Dictionary<MudObject, List<TimingWheel<ScheduledEvent>.Timer>> _calloutsByObject = new();
+
+    /// <summary>
+    /// Reset timer per registered object. The entry stays while reset() runs,
+    /// so the timer can be rescheduled afterwards.
+    /// </summary>
+    private readonly Dictionary<MudObject, TimingWheel<ScheduledEvent>.Timer> _resetTimers = new();
+
+    /// <summary>
+    /// Expiry timer per linkdead session.
+    /// </summary>
+    private readonly Dictionary<PlayerSession, TimingWheel<ScheduledEvent>.Timer> _linkdeadTimers = new();
+
+    /// <summary>
+    /// Timed effects by target and ID. An effect has one timer, due at its
+    /// next tick or its expiry, so between those it costs nothing.
+    /// </summary>
+    private readonly Dictionary<MudObject, Dictionary<string, TimingWheel<ScheduledEvent>.Timer>> _effects = new();
 
     /// <summary>
-    /// Priority queue of pending callouts, ordered by fire time.
+    /// Events fired this tick (game thread only).
     /// </summary>
-    private readonly PriorityQueue<CalloutEntry, DateTime> _callouts = new();
-    private readonly object _calloutLock = new();
+    private readonly List<ScheduledEvent> _dueEvents = new();
+
+    /// <summary>
+    /// Resets that came due, with the tick they did, waiting for room
+    /// (game thread only).
+    /// </summary>
+    private readonly Queue<(MudObject Target, long DueTick)> _resetsWaiting = new();
+
+    /// <summary>
+    /// Most monsters respawn() clones in one tick.
+    /// </summary>
+    public int SpawnsPerTick { get; set; } = 16;
+
+    /// <summary>
+    /// When RunSpawns() last ran or found nothing queued.
+    /// </summary>
+    private long _spawnsWaitingSince;
+
+    /// <summary>
+    /// Game time: ticks counted from a monotonic clock, so wall-clock changes
+    /// don't fire or stall timers.
+    /// </summary>
+    private readonly Stopwatch _clock = Stopwatch.StartNew();
+    private const int TicksPerSecond = 1000 / TickIntervalMs;
+    private long NowTick => _steppedTick >= 0 ? _steppedTick : _clock.ElapsedMilliseconds / TickIntervalMs;
+
+    /// <summary>
+    /// Game time while Step() drives the loop instead of its thread; -1 otherwise.
+    /// </summary>
+    private long _steppedTick = -1;
 
     /// <summary>
     /// Next callout ID to assign.
@@ -230,10 +481,26 @@ public class GameLoop
     /// </summary>
     public Action<string, bool>? OnSetEchoMode { get; set; }
 
+    /// <summary>
+    /// Callback invoked when a player picks a color class for their
+    /// connection (null: what the terminal reported). Set by TelnetServer.
+    /// </summary>
+    public Action<string, ColorSupport?>? OnSetColor { get; set; }
+
+    /// <summary>
+    /// Callback invoked at the end of a tick that left output in the queue.
+    /// Set by TelnetServer to wake its delivery thread.
+    /// </summary>
+    public Action? OnOutputReady { get; set; }
+
     public GameLoop(ObjectManager objectManager, AccountManager accountManager)
     {
         _objectManager = objectManager;
         _accountManager = accountManager;
+        Logins = new LoginWorker(this);
+        CommandResolver = new CommandResolver(objectManager.MudlibPath);
+        Cpu = new CpuAccounts(() => _clock.ElapsedMilliseconds / 1000);
+        Budget = new TickBudget(TickIntervalMs, HeartbeatIntervalTicks, () => _clock.Elapsed.TotalMilliseconds);
     }
 
     /// <summary>
@@ -241,6 +508,23 @@ public class GameLoop
     /// </summary>
     public string StartingRoomPath { get; set; } = "/world/rooms/town/square";
 
+    /// <summary>
+    /// Where /std/player keeps its save files, for the login queue to prefetch.
+    /// </summary>
+    public string PlayerSaveDirectory { get; set; } = "/secure/players/";
+
+    /// <summary>
+    /// Most logins that enter the game (clone, restore, first look) per tick.
+    /// The rest wait in line, so a reconnect storm can't stall the players
+    /// already in (driver --server --logins-per-tick).
+    /// </summary>
+    public int MaxLoginsPerTick { get; set; } = 4;
+
+    /// <summary>
+    /// Authenticated sessions waiting in the login queue.
+    /// </summary>
+    public int LoginQueueDepth => _admissions.Count;
+
     /// <summary>
     /// Static reference to the game loop for efun callbacks.
     /// Set during initialization.
@@ -262,14 +546,13 @@ public class GameLoop
 
     /// <summary>
     /// Find a session by its player object.
-    /// Used by tell_room() efun.
+    /// Used by tell_room() efun and the interpreter's permission checks.
     /// </summary>
-    private PlayerSession? FindSessionByPlayerObject(MudObject playerObject)
+    internal static PlayerSession? FindSessionByPlayerObject(MudObject playerObject)
     {
-        lock (_sessionLock)
-        {
-            return _sessions.Values.FirstOrDefault(s => s.PlayerObject == playerObject);
-        }
+        // A connected player object points at its session; no lookup or lock
+        var session = playerObject.Session;
+        return session != null && session.PlayerObject == playerObject ? session : null;
     }
 
     /// <summary>
@@ -294,165 +577,482 @@ public class GameLoop
     }
 
     /// <summary>
-    /// Start the game loop thread.
+    /// Connections whose client accepted GMCP. Set from the network thread.
     /// </summary>
-    public void Start()
+    private readonly ConcurrentDictionary<string, bool> _gmcpConnections = new();
+
+    /// <summary>
+    /// Record whether a connection's client speaks GMCP (it answered our offer).
+    /// </summary>
+    public void SetGmcp(string connectionId, bool enabled)
     {
-        if (_running)
+        if (enabled)
         {
-            return;
+            _gmcpConnections[connectionId] = true;
         }
-
-        _running = true;
-        _gameThread = new Thread(RunLoop)
+        else
         {
-            Name = "GameLoop",
-            IsBackground = true
-        };
-        _gameThread.Start();
-
-        Logger.Info("Game loop started", LogCategory.System);
+            _gmcpConnections.TryRemove(connectionId, out _);
+        }
     }
 
     /// <summary>
-    /// Stop the game loop thread.
+    /// Record what a connection's client reported through TTYPE (network thread).
     /// </summary>
-    public void Stop()
+    public void SetTerminal(string connectionId, TerminalInfo terminal)
     {
-        _running = false;
-        _gameThread?.Join(TimeSpan.FromSeconds(5));
-        Logger.Info("Game loop stopped", LogCategory.System);
+        var session = GetSession(connectionId);
+        if (session != null)
+        {
+            session.Terminal = terminal;
+        }
     }
 
     /// <summary>
-    /// Perform graceful shutdown: announce to players, save all data.
-    /// Call this before Stop() for a clean shutdown.
+    /// Record a connection's window size from NAWS (network thread).
     /// </summary>
-    public void GracefulShutdown()
+    public void SetWindowSize(string connectionId, int width, int height)
     {
-        Logger.Info("Initiating graceful shutdown...", LogCategory.System);
-
-        // Get all active sessions
-        List<PlayerSession> sessions;
-        lock (_sessionLock)
-        {
-            sessions = _sessions.Values
-                .Where(s => s.LoginState == LoginState.Playing)
-                .ToList();
-        }
-
-        // Announce shutdown to all players
-        foreach (var session in sessions)
+        var session = GetSession(connectionId);
+        if (session != null)
         {
-            if (!string.IsNullOrEmpty(session.ConnectionId))
-            {
-                SendToPlayer(session.ConnectionId, "\r\n*** Server shutting down. Saving your character... ***\r\n");
-            }
+            session.WindowWidth = width;
+            session.WindowHeight = height;
         }
+    }
 
-        // Save all players (includes linkdead)
-        SaveAllPlayers();
-
-        Logger.Info("Graceful shutdown complete", LogCategory.System);
+    /// <summary>
+    /// A player's terminal: what it reported (null fields if nothing), the
+    /// color class their output is rendered for and the window size (0 x 0
+    /// if unknown). Null if they aren't connected.
+    /// </summary>
+    public (TerminalInfo? Terminal, ColorSupport Color, int Width, int Height)? GetTerminal(MudObject playerObject)
+    {
+        var session = FindSessionByPlayerObject(playerObject);
+        if (session == null || session.IsLinkdead) return null;
+        return (session.Terminal, session.ColorMode ?? session.Terminal?.Color ?? ColorSupport.None,
+            session.WindowWidth, session.WindowHeight);
     }
 
     /// <summary>
-    /// Queue a command from a player connection.
-    /// Called from network thread.
+    /// Render a player's output for color, whatever their terminal reported;
+    /// null goes back to the reported class.
     /// </summary>
-    public void QueueCommand(string connectionId, string input)
+    public bool SetColor(MudObject playerObject, ColorSupport? color)
     {
-        _commandQueue.Enqueue(new PlayerCommand
+        var session = FindSessionByPlayerObject(playerObject);
+        if (session == null) return false;
+
+        session.ColorMode = color;
+        if (!session.IsLinkdead)
         {
-            ConnectionId = connectionId,
-            Input = input,
-            Timestamp = DateTime.UtcNow
-        });
+            OnSetColor?.Invoke(session.ConnectionId, color);
+        }
+        return true;
     }
 
     /// <summary>
-    /// Try to dequeue an output message.
-    /// Called from network thread.
+    /// Whether a player is connected through a client that speaks GMCP.
     /// </summary>
-    public bool TryDequeueOutput(out OutputMessage? output)
+    public bool HasGmcp(MudObject playerObject)
     {
-        return _outputQueue.TryDequeue(out output);
+        var session = FindSessionByPlayerObject(playerObject);
+        return session != null && !session.IsLinkdead && _gmcpConnections.ContainsKey(session.ConnectionId);
     }
 
     /// <summary>
-    /// Create a player session for a new connection.
-    /// Does NOT create a player object - that happens after authentication.
-    /// Called from network thread.
+    /// Send a GMCP message to a player, in order with their text output.
+    /// Returns false if their client doesn't speak GMCP.
     /// </summary>
-    public void CreatePlayerSession(string connectionId)
+    public bool SendGmcp(MudObject playerObject, string package, object? data)
     {
-        var session = new PlayerSession
-        {
-            ConnectionId = connectionId,
-            PlayerObject = null,  // No player until authenticated
-            CreatedAt = DateTime.UtcNow,
-            LastActivity = DateTime.UtcNow,
-            LoginState = LoginState.Welcome
-        };
-
-        lock (_sessionLock)
+        var session = FindSessionByPlayerObject(playerObject);
+        if (session == null || session.IsLinkdead || !_gmcpConnections.ContainsKey(session.ConnectionId))
         {
-            _sessions[connectionId] = session;
+            return false;
         }
 
-        Logger.Debug($"Created login session for {connectionId}", LogCategory.Network);
-
-        // Send welcome banner
-        SendWelcomeBanner(connectionId);
+        _outputQueue.Enqueue(new OutputMessage
+        {
+            ConnectionId = session.ConnectionId,
+            Content = Gmcp.Encode(package, data),
+            Gmcp = true
+        });
+        return true;
     }
 
     /// <summary>
-    /// Send the welcome banner and initial login prompt.
+    /// Connections watching other connections' output (snoop()). The server
+    /// thread copies each message to its target's observers as it delivers it.
     /// </summary>
-    private void SendWelcomeBanner(string connectionId)
-    {
-        SendToPlayer(connectionId, "\r\n");
-        SendToPlayer(connectionId, "========================================\r\n");
-        SendToPlayer(connectionId, "       Welcome to LPMud Revival!        \r\n");
-        SendToPlayer(connectionId, "========================================\r\n");
-        SendToPlayer(connectionId, "\r\n");
-        SendToPlayer(connectionId, "Enter your name, or type 'new' to create a character: ");
+    public OutputObservers Observers { get; } = new();
 
-        var session = GetSession(connectionId);
-        if (session != null)
+    /// <summary>
+    /// Start copying target's output to observer. False if either isn't
+    /// connected, they are the same player, or observer is already watching.
+    /// </summary>
+    public bool Snoop(MudObject observer, MudObject target)
+    {
+        var observerSession = FindSessionByPlayerObject(observer);
+        var targetSession = FindSessionByPlayerObject(target);
+        if (observerSession == null || observerSession.IsLinkdead ||
+            targetSession == null || targetSession.IsLinkdead)
         {
-            session.LoginState = LoginState.AwaitingName;
+            return false;
         }
+
+        var header = $"%^CYAN%^[{GetPlayerName(target, targetSession.AuthenticatedUsername)}]%^RESET%^\n";
+        return Observers.Add(targetSession.ConnectionId, observerSession.ConnectionId, header);
     }
 
     /// <summary>
-    /// Remove a player session when connection closes.
-    /// If the player was actively playing, they go linkdead instead of being destroyed.
-    /// Called from network thread.
+    /// Stop copying target's output to observer, or everyone's if target is
+    /// null. Returns how many players observer stopped watching.
     /// </summary>
-    public void RemovePlayerSession(string connectionId)
+    public int Unsnoop(MudObject observer, MudObject? target)
     {
-        PlayerSession? session = null;
+        var observerSession = FindSessionByPlayerObject(observer);
+        if (observerSession == null || observerSession.IsLinkdead) return 0;
+        if (target == null) return Observers.Remove(observerSession.ConnectionId);
 
-        lock (_sessionLock)
-        {
-            if (_sessions.TryGetValue(connectionId, out session))
-            {
-                _sessions.Remove(connectionId);
+        var targetSession = FindSessionByPlayerObject(target);
+        if (targetSession == null || targetSession.IsLinkdead) return 0;
+        return Observers.Remove(observerSession.ConnectionId, targetSession.ConnectionId);
+    }
 
-                // If player was actively playing, move to linkdead instead of destroying
-                if (session.LoginState == LoginState.Playing &&
-                    session.AuthenticatedUsername != null &&
+    /// <summary>
+    /// The players watching target's output.
+    /// </summary>
+    public List<MudObject> QuerySnoopers(MudObject target)
+    {
+        var session = FindSessionByPlayerObject(target);
+        return session == null || session.IsLinkdead ? new List<MudObject>() : Players(Observers.ObserversOf(session.ConnectionId));
+    }
+
+    /// <summary>
+    /// The players whose output observer is watching.
+    /// </summary>
+    public List<MudObject> QuerySnooping(MudObject observer)
+    {
+        var session = FindSessionByPlayerObject(observer);
+        return session == null || session.IsLinkdead ? new List<MudObject>() : Players(Observers.TargetsOf(session.ConnectionId));
+    }
+
+    private List<MudObject> Players(List<string> connectionIds)
+    {
+        var players = new List<MudObject>();
+        foreach (var connectionId in connectionIds)
+        {
+            if (GetSession(connectionId)?.PlayerObject is { IsDestructed: false } player)
+            {
+                players.Add(player);
+            }
+        }
+        return players;
+    }
+
+    /// <summary>
+    /// Start the game loop thread.
+    /// </summary>
+    public void Start()
+    {
+        if (_running)
+        {
+            return;
+        }
+
+        _running = true;
+        IdleCollector?.Enable();
+        CommandResolver.StartWatching();
+        StartRegionWorkers();
+        _gameThread = new Thread(RunLoop)
+        {
+            Name = "GameLoop",
+            IsBackground = true
+        };
+        _gameThread.Start();
+
+        Logger.Info("Game loop started", LogCategory.System);
+    }
+
+    /// <summary>
+    /// Whether the caller may use the world directly: it is the game thread
+    /// or a coroutine it is waiting on, or the loop isn't running (tests,
+    /// tools) or is paused.
+    /// </summary>
+    public bool OnGameThread => !_running || Thread.CurrentThread == _gameThread
+        || Thread.CurrentThread == Coroutines.RunningThread || _parked.IsSet;
+
+    /// <summary>
+    /// Run work on the game thread: at the start of the next tick, or right
+    /// away if the caller is OnGameThread. How other threads change the world.
+    /// </summary>
+    public void Post(Action work)
+    {
+        if (OnGameThread)
+        {
+            work();
+            return;
+        }
+        _posted.Enqueue(work);
+    }
+
+    private void RunPosted()
+    {
+        while (_posted.TryDequeue(out var work))
+        {
+            try
+            {
+                work();
+            }
+            catch (Exception ex)
+            {
+                Logger.Error($"Posted work failed: {ex.Message}", LogCategory.System);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Publish what other threads read between ticks.
+    /// </summary>
+    private void PublishState(DateTime now)
+    {
+        var published = _publishedBucketSizes;
+        for (int i = 0; i < _heartbeatBuckets.Length; i++)
+        {
+            if (published[i] != _heartbeatBuckets[i].Count)
+            {
+                _publishedBucketSizes = _heartbeatBuckets.Select(bucket => bucket.Count).ToArray();
+                break;
+            }
+        }
+        _publishedTimerCount = _timers.Count;
+
+        if (now - _lastSnapshotPublish >= SnapshotPublishInterval)
+        {
+            _lastSnapshotPublish = now;
+            _objectManager.PublishSnapshot();
+        }
+
+        _status = BuildStatus(now);
+    }
+
+    private StatusSnapshot BuildStatus(DateTime now)
+    {
+        var players = new List<StatusPlayer>();
+        lock (_sessionLock)
+        {
+            foreach (var session in _sessions.Values.Concat(_linkdeadSessions.Values))
+            {
+                if (session.LoginState != LoginState.Playing || session.AuthenticatedUsername == null) continue;
+                var player = session.PlayerObject;
+                players.Add(new StatusPlayer(
+                    session.AuthenticatedUsername,
+                    player is { IsDestructed: false } ? player.Environment?.ObjectName : null,
+                    session.AccessLevel,
+                    (long)(now - session.LastActivity).TotalSeconds,
+                    session.IsLinkdead));
+            }
+        }
+
+        var objects = _objectManager.Snapshot.Stats;
+        return new StatusSnapshot(
+            now,
+            _clock.Elapsed.TotalSeconds,
+            TickProfiler.Ticks,
+            Budget.LagMs,
+            objects.TotalObjectCount,
+            objects.BlueprintCount,
+            _publishedBucketSizes.Sum(),
+            _publishedTimerCount,
+            Coroutines.Count,
+            players);
+    }
+
+    /// <summary>
+    /// Stop the game loop thread.
+    /// </summary>
+    public void Stop()
+    {
+        _running = false;
+        Resume();
+        _gameThread?.Join(TimeSpan.FromSeconds(5));
+        RunPosted();
+        Coroutines.StopAll();
+        IdleCollector?.Disable();
+        CommandResolver.Dispose();
+        RegionWorkers?.Dispose();
+        RegionWorkers = null;
+        AsyncFileWriter.Shared.Flush();
+        Logger.Info("Game loop stopped", LogCategory.System);
+    }
+
+    /// <summary>
+    /// Perform graceful shutdown: announce to players, save all data.
+    /// Call this before Stop() for a clean shutdown.
+    /// </summary>
+    public void GracefulShutdown()
+    {
+        Logger.Info("Initiating graceful shutdown...", LogCategory.System);
+
+        // Saving reads the world, so hold the game thread between ticks meanwhile
+        bool pausing = !OnGameThread;
+        if (pausing)
+        {
+            Pause(TimeSpan.FromSeconds(5));
+        }
+
+        try
+        {
+            // Get all active sessions
+            List<PlayerSession> sessions;
+            lock (_sessionLock)
+            {
+                sessions = _sessions.Values
+                    .Where(s => s.LoginState == LoginState.Playing)
+                    .ToList();
+            }
+
+            // Announce shutdown to all players
+            foreach (var session in sessions)
+            {
+                if (!string.IsNullOrEmpty(session.ConnectionId))
+                {
+                    SendToPlayer(session.ConnectionId, "\r\n*** Server shutting down. Saving your character... ***\r\n");
+                }
+            }
+
+            // Save all players (includes linkdead)
+            SaveAllPlayers();
+            Snapshot?.Write(this);
+        }
+        finally
+        {
+            if (pausing)
+            {
+                Resume();
+            }
+        }
+
+        Logger.Info("Graceful shutdown complete", LogCategory.System);
+    }
+
+    /// <summary>
+    /// Queue a command from a player connection. received is the Stopwatch
+    /// timestamp of the socket read that completed the line, 0 for now; a
+    /// playing connection's commands are traced from there by Latency.
+    /// Called from network thread.
+    /// </summary>
+    public void QueueCommand(string connectionId, string input, long received = 0)
+    {
+        var session = GetSession(connectionId);
+        if (session != null && LoginWorker.Handles(session.LoginState))
+        {
+            // Names and passwords never take a turn on the game thread
+            Logins.Enqueue(session, input);
+            return;
+        }
+
+        bool playing = session is { LoginState: LoginState.Playing };
+        if (Recorder is { } recorder && playing && ((session!.PendingInputHandler?.Flags ?? 0) & 1) == 0)
+        {
+            recorder.Command(connectionId, input);
+        }
+
+        Commands.Enqueue(new PlayerCommand
+        {
+            ConnectionId = connectionId,
+            Input = input,
+            Timestamp = DateTime.UtcNow,
+            Trace = playing ? Latency.Begin(connectionId, input, received != 0 ? received : Stopwatch.GetTimestamp()) : null
+        });
+    }
+
+    /// <summary>
+    /// Try to dequeue an output message.
+    /// Called from network thread.
+    /// </summary>
+    public bool TryDequeueOutput(out OutputMessage? output)
+    {
+        return _outputQueue.TryDequeue(out output);
+    }
+
+    /// <summary>
+    /// Whether any output is waiting to be sent.
+    /// </summary>
+    public bool HasPendingOutput => !_outputQueue.IsEmpty;
+
+    /// <summary>
+    /// Create a player session for a new connection.
+    /// Does NOT create a player object - that happens after authentication.
+    /// Called from network thread.
+    /// </summary>
+    public void CreatePlayerSession(string connectionId, string? remoteAddress = null)
+    {
+        var session = new PlayerSession
+        {
+            ConnectionId = connectionId,
+            RemoteAddress = remoteAddress,
+            PlayerObject = null,  // No player until authenticated
+            CreatedAt = DateTime.UtcNow,
+            LastActivity = DateTime.UtcNow,
+            LoginState = LoginState.Welcome
+        };
+
+        lock (_sessionLock)
+        {
+            _sessions[connectionId] = session;
+        }
+
+        Logger.Debug($"Created login session for {connectionId}", LogCategory.Network);
+
+        // Send welcome banner
+        Logins.Greet(session);
+    }
+
+    /// <summary>
+    /// Remove a player session when connection closes.
+    /// If the player was actively playing, they go linkdead instead of being destroyed.
+    /// Called from network thread; the player is dealt with on the game thread.
+    /// </summary>
+    public void RemovePlayerSession(string connectionId)
+    {
+        Commands.Remove(connectionId);
+        _gmcpConnections.TryRemove(connectionId, out _);
+        Observers.RemoveConnection(connectionId);
+        Post(() => CloseSession(connectionId));
+    }
+
+    /// <summary>
+    /// The game thread's part of RemovePlayerSession().
+    /// </summary>
+    private void CloseSession(string connectionId)
+    {
+        PlayerSession? session = null;
+        lock (_sessionLock)
+        {
+            if (_sessions.TryGetValue(connectionId, out session))
+            {
+                _sessions.Remove(connectionId);
+                if (session.LoginState == LoginState.Playing)
+                {
+                    Recorder?.Disconnect(connectionId);
+                }
+
+                // If player was actively playing, move to linkdead instead of destroying
+                if (session.LoginState == LoginState.Playing && !session.HandingOff &&
+                    session.AuthenticatedUsername != null &&
                     session.PlayerObject != null &&
                     !session.PlayerObject.IsDestructed)
                 {
                     session.IsLinkdead = true;
                     session.LinkdeadSince = DateTime.UtcNow;
                     session.ConnectionId = string.Empty; // No longer connected
-                    session.PlayerObject.IsInteractive = false;
-                    session.PlayerObject.ConnectionId = null;
+                    _objectManager.SetInteractive(session.PlayerObject, false);
+                    session.PlayerObject.BindSession(null);
 
                     _linkdeadSessions[session.AuthenticatedUsername] = session;
+                    ScheduleLinkdeadExpiry(session);
 
                     Logger.Info($"Player {session.AuthenticatedUsername} went linkdead (15 min timeout)", LogCategory.Player);
 
@@ -466,8 +1066,8 @@ public class GameLoop
         // Non-playing session or no player object - just clean up
         if (session?.PlayerObject != null && !session.PlayerObject.IsDestructed)
         {
-            session.PlayerObject.IsInteractive = false;
-            session.PlayerObject.ConnectionId = null;
+            _objectManager.SetInteractive(session.PlayerObject, false);
+            session.PlayerObject.BindSession(null);
 
             try
             {
@@ -485,6 +1085,34 @@ public class GameLoop
         Logger.Debug($"Removed player session for {connectionId}", LogCategory.Network);
     }
 
+    /// <summary>
+    /// Log out the session on a connection the server is dropping (output
+    /// overflow under the Disconnect policy): the player is saved and removed
+    /// instead of going linkdead. Called from network thread; the work is
+    /// posted to the game thread.
+    /// </summary>
+    public void DisconnectSession(string connectionId)
+    {
+        Post(() => LogOutSession(connectionId));
+    }
+
+    private void LogOutSession(string connectionId)
+    {
+        var session = GetSession(connectionId);
+        if (session == null)
+        {
+            return;
+        }
+
+        if (session.LoginState == LoginState.Playing)
+        {
+            SavePlayerObject(session.PlayerObject);
+        }
+
+        ForceRemoveSession(session);
+        _rateLimiter.RemoveConnection(connectionId);
+    }
+
     /// <summary>
     /// Force-remove a session completely (for kicks and cleanup).
     /// Does not go linkdead - fully destroys the session.
@@ -509,12 +1137,13 @@ public class GameLoop
                 _linkdeadSessions.Remove(session.AuthenticatedUsername);
             }
         }
+        CancelLinkdeadExpiry(session);
 
         // Destruct the player object
         if (session.PlayerObject != null && !session.PlayerObject.IsDestructed)
         {
-            session.PlayerObject.IsInteractive = false;
-            session.PlayerObject.ConnectionId = null;
+            _objectManager.SetInteractive(session.PlayerObject, false);
+            session.PlayerObject.BindSession(null);
 
             try
             {
@@ -604,23 +1233,10 @@ public class GameLoop
             var result = _interpreter.CallFunctionOnObject(playerObject, "save_player", new List<object>());
 
             // save_player returns 1 on success
-            if (result is int i && i == 1)
-            {
-                return true;
-            }
-            if (result is long l && l == 1)
-            {
-                return true;
-            }
-        }
-        catch (ReturnException ex)
-        {
-            if (ex.Value is int i && i == 1)
-            {
-                return true;
-            }
-            if (ex.Value is long l && l == 1)
+            if ((result is int i && i == 1) || (result is long l && l == 1))
             {
+                // save_player() itself writes variables, so take the version afterwards
+                playerObject.SavedVersion = playerObject.StateVersion;
                 return true;
             }
         }
@@ -634,8 +1250,11 @@ public class GameLoop
 
     /// <summary>
     /// Save all active players. Used for periodic saves and shutdown.
+    /// With changedOnly, players whose state hasn't changed since their last
+    /// save are skipped. save_object() only serializes here; the file writer
+    /// does the disk I/O.
     /// </summary>
-    public void SaveAllPlayers()
+    public void SaveAllPlayers(bool changedOnly = false)
     {
         List<PlayerSession> sessions;
         lock (_sessionLock)
@@ -652,6 +1271,10 @@ public class GameLoop
         int saved = 0;
         foreach (var session in sessions)
         {
+            if (changedOnly && !session.PlayerObject!.IsDirty)
+            {
+                continue;
+            }
             if (SavePlayerObject(session.PlayerObject))
             {
                 saved++;
@@ -665,59 +1288,81 @@ public class GameLoop
     }
 
     /// <summary>
-    /// Clean up linkdead sessions that have exceeded the timeout.
-    /// Called periodically from the game loop.
+    /// Start a linkdead session's grace period.
     /// </summary>
-    private void CleanupExpiredLinkdeadSessions()
+    private void ScheduleLinkdeadExpiry(PlayerSession session)
     {
-        var now = DateTime.UtcNow;
-        List<PlayerSession> expiredSessions;
-
-        lock (_sessionLock)
+        var due = NowTick + (long)LinkdeadTimeout.TotalMilliseconds / TickIntervalMs;
+        if (_linkdeadTimers.TryGetValue(session, out var timer))
         {
-            expiredSessions = _linkdeadSessions.Values
-                .Where(s => s.LinkdeadSince.HasValue &&
-                           (now - s.LinkdeadSince.Value) > LinkdeadTimeout)
-                .ToList();
+            _timers.Reschedule(timer, due);
         }
-
-        foreach (var session in expiredSessions)
+        else
         {
-            Logger.Info($"Linkdead session for {session.AuthenticatedUsername} expired - cleaning up", LogCategory.Player);
-
-            // Save player data before cleanup
-            if (session.PlayerObject != null && !session.PlayerObject.IsDestructed)
-            {
-                if (SavePlayerObject(session.PlayerObject))
-                {
-                    Logger.Debug($"Saved player data for {session.AuthenticatedUsername}", LogCategory.Player);
-                }
-
-                // Announce to room before cleanup (use character name, not account name)
-                AnnounceToRoom(session.PlayerObject,
-                    $"{GetPlayerName(session.PlayerObject, session.AuthenticatedUsername)} has disconnected (linkdead timeout).\r\n");
-            }
-
-            // Force remove (destroys player object)
-            ForceRemoveSession(session);
+            _linkdeadTimers[session] = _timers.Schedule(new LinkdeadExpiry(session), due);
         }
     }
 
-    /// <summary>
-    /// Get a player session by connection ID.
-    /// </summary>
-    public PlayerSession? GetSession(string connectionId)
+    private void CancelLinkdeadExpiry(PlayerSession session)
     {
-        lock (_sessionLock)
+        if (_linkdeadTimers.Remove(session, out var timer))
         {
-            return _sessions.TryGetValue(connectionId, out var session) ? session : null;
+            _timers.Cancel(timer);
         }
     }
 
     /// <summary>
-    /// Get all active sessions (not including linkdead).
+    /// Clean up a linkdead session whose grace period ran out.
     /// </summary>
-    public List<PlayerSession> GetAllSessions()
+    private void ExpireLinkdeadSession(PlayerSession session)
+    {
+        _linkdeadTimers.Remove(session);
+
+        lock (_sessionLock)
+        {
+            // Reconnected (or kicked) since the timer was set
+            if (!session.IsLinkdead || session.AuthenticatedUsername == null ||
+                !_linkdeadSessions.TryGetValue(session.AuthenticatedUsername, out var current) ||
+                current != session)
+            {
+                return;
+            }
+        }
+
+        Logger.Info($"Linkdead session for {session.AuthenticatedUsername} expired - cleaning up", LogCategory.Player);
+
+        // Save player data before cleanup
+        if (session.PlayerObject != null && !session.PlayerObject.IsDestructed)
+        {
+            if (SavePlayerObject(session.PlayerObject))
+            {
+                Logger.Debug($"Saved player data for {session.AuthenticatedUsername}", LogCategory.Player);
+            }
+
+            // Announce to room before cleanup (use character name, not account name)
+            AnnounceToRoom(session.PlayerObject,
+                $"{GetPlayerName(session.PlayerObject, session.AuthenticatedUsername)} has disconnected (linkdead timeout).\r\n");
+        }
+
+        // Force remove (destroys player object)
+        ForceRemoveSession(session);
+    }
+
+    /// <summary>
+    /// Get a player session by connection ID.
+    /// </summary>
+    public PlayerSession? GetSession(string connectionId)
+    {
+        lock (_sessionLock)
+        {
+            return _sessions.TryGetValue(connectionId, out var session) ? session : null;
+        }
+    }
+
+    /// <summary>
+    /// Get all active sessions (not including linkdead).
+    /// </summary>
+    public List<PlayerSession> GetAllSessions()
     {
         lock (_sessionLock)
         {
@@ -839,7 +1484,7 @@ public class GameLoop
             }
 
             // Now complete the login
-            CompleteLogin(session);
+            AdmitLogin(session);
         }
         else if (input == "n" || input == "no")
         {
@@ -870,17 +1515,27 @@ public class GameLoop
             linkdeadSession.ConnectionId = newSession.ConnectionId;
             linkdeadSession.IsLinkdead = false;
             linkdeadSession.LinkdeadSince = null;
+            CancelLinkdeadExpiry(linkdeadSession);
             linkdeadSession.LastActivity = DateTime.UtcNow;
 
             // Restore interactive status on player object
             if (linkdeadSession.PlayerObject != null)
             {
-                linkdeadSession.PlayerObject.IsInteractive = true;
-                linkdeadSession.PlayerObject.ConnectionId = newSession.ConnectionId;
+                _objectManager.SetInteractive(linkdeadSession.PlayerObject, true);
+                linkdeadSession.PlayerObject.BindSession(linkdeadSession);
             }
 
             // Add to active sessions with new connection ID
             _sessions[newSession.ConnectionId] = linkdeadSession;
+
+            // The new connection's terminal and window, and the player's color choice carried over to it
+            linkdeadSession.Terminal = newSession.Terminal;
+            linkdeadSession.WindowWidth = newSession.WindowWidth;
+            linkdeadSession.WindowHeight = newSession.WindowHeight;
+        }
+        if (linkdeadSession.ColorMode != null)
+        {
+            OnSetColor?.Invoke(linkdeadSession.ConnectionId, linkdeadSession.ColorMode);
         }
 
         // Announce reconnection to the room (use character name, not account name)
@@ -894,6 +1549,7 @@ public class GameLoop
 
         // Show the room
         ExecuteLookForPlayer(linkdeadSession);
+        EmitLogin(linkdeadSession);
         SendPrompt(linkdeadSession.ConnectionId);
 
         Logger.Info($"Player {linkdeadSession.AuthenticatedUsername} reconnected from linkdead", LogCategory.Player);
@@ -918,54 +1574,124 @@ public class GameLoop
     {
         while (_running)
         {
-            try
+            var tickStart = DateTime.UtcNow;
+            RunTick();
+            IdleCollector?.AfterTick();
+            WaitWhilePaused();
+
+            // Sleep for remaining tick time, collecting garbage first if that's on
+            var elapsed = (DateTime.UtcNow - tickStart).TotalMilliseconds;
+            var sleepTime = Math.Max(0, TickIntervalMs - elapsed);
+            if (sleepTime > 0 && IdleCollector != null && IdleCollector.Idle(TimeSpan.FromMilliseconds(sleepTime)))
+            {
+                sleepTime = Math.Max(0, TickIntervalMs - (DateTime.UtcNow - tickStart).TotalMilliseconds);
+            }
+            if (sleepTime > 0)
             {
-                var tickStart = DateTime.UtcNow;
+                Thread.Sleep((int)sleepTime);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Run one tick on the calling thread, with game time one tick on from
+    /// the last Step(), for --replay. The loop must not be started.
+    /// </summary>
+    public void Step()
+    {
+        if (_running)
+        {
+            throw new InvalidOperationException("Step() can't run while the game loop thread is running");
+        }
+        _steppedTick++;
+        RunTick();
+    }
 
-                // Process all queued commands
-                ProcessCommands();
+    /// <summary>
+    /// One tick: commands, timers, heartbeats, then saves.
+    /// </summary>
+    private void RunTick()
+    {
+        try
+        {
+            var phaseStart = TickProfiler.BeginTick();
+            Budget.BeginTick();
 
-                // Process heartbeats every HeartbeatIntervalTicks ticks
-                _tickCount++;
-                if (_tickCount >= HeartbeatIntervalTicks)
-                {
-                    _tickCount = 0;
-                    ProcessHeartbeats();
+            // Swap in programs the source watcher recompiled since the last tick
+            _objectManager.ApplyStagedReloads();
+            phaseStart = TickProfiler.EndPhase(TickPhase.Reloads, phaseStart);
 
-                    // Clean up expired linkdead sessions (check during heartbeat cycle)
-                    CleanupExpiredLinkdeadSessions();
-                }
+            // Work other threads posted (closed connections, console commands), then queued commands
+            RunPosted();
+            ProcessCommands();
+            RunCluster();
+            phaseStart = TickProfiler.EndPhase(TickPhase.Commands, phaseStart);
 
-                // Periodic player saves
-                var now = DateTime.UtcNow;
-                if (now - _lastPeriodicSave >= PeriodicSaveInterval)
-                {
-                    _lastPeriodicSave = now;
-                    SaveAllPlayers();
+            // Fire callouts and linkdead expiry that are due; resets wait their turn below
+            ProcessTimers();
+            phaseStart = TickProfiler.EndPhase(TickPhase.Timers, phaseStart);
 
-                    // Clean up rate limiter data periodically (every 5 min with saves)
-                    _rateLimiter.Cleanup();
-                }
+            // One heartbeat bucket per tick, more when catching up, none when the tick is full
+            while (Budget.NextHeartbeatTurn())
+            {
+                ProcessHeartbeats();
+            }
+            phaseStart = TickProfiler.EndPhase(TickPhase.Heartbeats, phaseStart);
 
-                // Process pending callouts every tick
-                ProcessCallouts();
+            RunWaitingResets();
+            Coroutines.RunDue(NowTick, Budget.MayRun);
+            RunSpawns();
+            phaseStart = TickProfiler.EndPhase(TickPhase.Timers, phaseStart);
 
-                // Process object resets
-                ProcessResets();
+            // Periodic player saves
+            var now = DateTime.UtcNow;
+            if (now - _lastPeriodicSave >= PeriodicSaveInterval && Budget.MayRun(TicksOverdue(now, _lastPeriodicSave, PeriodicSaveInterval)))
+            {
+                _lastPeriodicSave = now;
+                SaveAllPlayers(changedOnly: true);
 
-                // Sleep for remaining tick time
-                var elapsed = (DateTime.UtcNow - tickStart).TotalMilliseconds;
-                var sleepTime = Math.Max(0, TickIntervalMs - elapsed);
-                if (sleepTime > 0)
-                {
-                    Thread.Sleep((int)sleepTime);
-                }
+                // Clean up rate limiter data periodically (every 5 min with saves)
+                _rateLimiter.Cleanup();
             }
-            catch (Exception ex)
+            if (Snapshot != null && now - _lastSnapshot >= Snapshot.Interval && Budget.MayRun(TicksOverdue(now, _lastSnapshot, Snapshot.Interval)))
+            {
+                _lastSnapshot = now;
+                Snapshot.Write(this);
+            }
+            if (CleanUpIdleSeconds > 0 && now - _lastCleanUp >= CleanUpCheckInterval && Budget.MayRun(TicksOverdue(now, _lastCleanUp, CleanUpCheckInterval)))
+            {
+                _lastCleanUp = now;
+                RunCleanUp(Environment.TickCount64);
+            }
+
+            // This tick's saves go to disk together
+            _objectManager.SaveStore?.Commit();
+            Recorder?.Flush();
+            TickProfiler.EndPhase(TickPhase.Saves, phaseStart);
+
+            // A running object census sizes its next slice of objects
+            _objectManager.Census.Step();
+
+            // Nothing is running in this tick's destructed objects any more
+            _objectManager.RecycleDestructed(ForgetObject);
+            PublishState(now);
+
+            if (!_outputQueue.IsEmpty)
+            {
+                OnOutputReady?.Invoke();
+            }
+
+            Budget.EndTick();
+            var slowTick = TickProfiler.EndTick();
+            if (slowTick != null)
             {
-                Logger.Error($"Game loop error: {ex.Message}", LogCategory.System);
+                LogSlowTick(slowTick);
             }
         }
+        catch (Exception ex)
+        {
+            Logger.Error($"Game loop error: {ex.Message}", LogCategory.System);
+        }
     }
 
     /// <summary>
@@ -973,17 +1699,98 @@ public class GameLoop
     /// </summary>
     private void ProcessCommands()
     {
-        // Process up to 100 commands per tick to avoid starvation
-        int processed = 0;
-        while (processed < 100 && _commandQueue.TryDequeue(out var cmd))
+        RunAuthenticated();
+        RunResumedSessions();
+        _admittedThisTick = 0;
+        RunAdmissions();
+
+        // Each connection gets a turn in rotation, within the tick's command budget
+        Commands.RunTick(cmd =>
         {
-            ProcessCommand(cmd);
-            processed++;
-        }
+            // Only in-game input is a command; during login it's names and passwords
+            bool playing = GetSession(cmd.ConnectionId)?.LoginState == LoginState.Playing;
+            long instructions = _interpreter?.ThreadInstructions ?? 0;
+            long allocated = GC.GetAllocatedBytesForCurrentThread();
+            var trace = cmd.Trace;
+            trace?.Reached(CommandStage.Run);
+            if (trace != null && Latency.SlowThresholdMs > 0 && _interpreter != null)
+            {
+                _interpreter.ThreadCallTrace = trace.Calls = new CallTrace();
+            }
+            var callStart = Stopwatch.GetTimestamp();
+            try
+            {
+                ProcessCommand(cmd);
+            }
+            finally
+            {
+                if (trace != null)
+                {
+                    if (_interpreter != null) _interpreter.ThreadCallTrace = null;
+                    trace.Reached(CommandStage.Output);
+                    _outputQueue.Enqueue(new OutputMessage { ConnectionId = cmd.ConnectionId, Trace = trace });
+                }
+            }
+            var player = GetSession(cmd.ConnectionId)?.PlayerObject;
+            if (player != null)
+            {
+                RecordCall(player, "command " + FirstWord(cmd.Input), callStart, Stopwatch.GetTimestamp(),
+                    _interpreter!.ThreadInstructions - instructions, GC.GetAllocatedBytesForCurrentThread() - allocated);
+            }
+            else
+            {
+                TickProfiler.RecordCall(cmd.ConnectionId, "command " + FirstWord(cmd.Input), callStart);
+            }
+            if (playing)
+            {
+                TickProfiler.RecordCommand(FirstWord(cmd.Input).ToLowerInvariant(), DateTime.UtcNow - cmd.Timestamp);
+            }
+        }, () => _interpreter?.ThreadInstructions ?? 0);
+
+        // Logins that finished during the phase, if the tick has room
+        RunAdmissions();
+        NotifyAdmissionQueue();
+    }
+
+    /// <summary>
+    /// Record a top-level call on obj with the tick profiler and charge it to
+    /// obj's CPU account.
+    /// </summary>
+    private void RecordCall(MudObject obj, string function, long callStart, long callEnd, long instructions, long bytes)
+    {
+        TickProfiler.RecordCall(obj.ObjectName, function, callStart, callEnd, bytes);
+        Cpu.Charge(obj, instructions, (callEnd - callStart) * 1_000_000 / Stopwatch.Frequency);
+    }
+
+    private static string FirstWord(string input)
+    {
+        var trimmed = input.AsSpan().Trim();
+        int space = trimmed.IndexOf(' ');
+        return (space < 0 ? trimmed : trimmed[..space]).ToString();
+    }
+
+    private static void LogSlowTick(TickProfiler.SlowTick slowTick)
+    {
+        var phases = string.Join(", ", Enum.GetValues<TickPhase>()
+            .Select(phase => $"{phase.ToString().ToLowerInvariant()} {slowTick.PhaseMicroseconds[(int)phase] / 1000.0:F1}ms/{slowTick.PhaseBytes[(int)phase] / 1024}KB"));
+        var top = string.Join(", ", slowTick.TopCalls
+            .Select(call => $"{call.Object}->{call.Function} {call.Microseconds / 1000.0:F1}ms {call.Bytes / 1024}KB x{call.Calls}"));
+        var gc = slowTick.Collections;
+        Logger.Warning($"Slow tick: {slowTick.Microseconds / 1000.0:F1}ms ({phases}); gc {gc[0]}/{gc[1]}/{gc[2]}; top: {top}", LogCategory.System);
     }
 
     #region Heartbeat Methods
 
+    private static List<MudObject>[] CreateHeartbeatBuckets()
+    {
+        var buckets = new List<MudObject>[HeartbeatIntervalTicks];
+        for (int i = 0; i < buckets.Length; i++)
+        {
+            buckets[i] = new List<MudObject>();
+        }
+        return buckets;
+    }
+
     /// <summary>
     /// Register an object for heartbeats.
     /// Called by set_heart_beat(1) efun.
@@ -991,11 +1798,21 @@ public class GameLoop
     public void RegisterHeartbeat(MudObject obj)
     {
         Logger.Debug($"RegisterHeartbeat: {obj.ObjectName}", LogCategory.LPC);
-        lock (_heartbeatLock)
+        if (obj.HeartbeatBucket >= 0) return;
+
+        int emptiest = 0;
+        for (int i = 1; i < _heartbeatBuckets.Length; i++)
         {
-            _heartbeatObjects.Add(obj);
-            Logger.Debug($"RegisterHeartbeat: now have {_heartbeatObjects.Count} objects", LogCategory.LPC);
+            if (_heartbeatBuckets[i].Count < _heartbeatBuckets[emptiest].Count)
+            {
+                emptiest = i;
+            }
         }
+
+        var bucket = _heartbeatBuckets[emptiest];
+        obj.HeartbeatBucket = emptiest;
+        obj.HeartbeatSlot = bucket.Count;
+        bucket.Add(obj);
     }
 
     /// <summary>
@@ -1004,10 +1821,16 @@ public class GameLoop
     /// </summary>
     public void UnregisterHeartbeat(MudObject obj)
     {
-        lock (_heartbeatLock)
-        {
-            _heartbeatObjects.Remove(obj);
-        }
+        if (obj.HeartbeatBucket < 0) return;
+
+        // Swap the last object into this one's slot
+        var bucket = _heartbeatBuckets[obj.HeartbeatBucket];
+        var last = bucket[^1];
+        bucket[obj.HeartbeatSlot] = last;
+        last.HeartbeatSlot = obj.HeartbeatSlot;
+        bucket.RemoveAt(bucket.Count - 1);
+
+        obj.HeartbeatBucket = -1;
     }
 
     /// <summary>
@@ -1015,234 +1838,809 @@ public class GameLoop
     /// </summary>
     public bool HasHeartbeat(MudObject obj)
     {
-        lock (_heartbeatLock)
-        {
-            return _heartbeatObjects.Contains(obj);
-        }
+        return obj.HeartbeatBucket >= 0;
     }
 
     /// <summary>
-    /// Process heartbeats for all registered objects.
-    /// Called every HeartbeatIntervalTicks ticks.
+    /// Player input waiting for the game thread.
     /// </summary>
-    private void ProcessHeartbeats()
+    public int CommandQueueDepth => Commands.Depth;
+
+    /// <summary>
+    /// Messages waiting to be handed to the network layer.
+    /// </summary>
+    public int OutputQueueDepth => _outputQueue.Count;
+
+    /// <summary>
+    /// Number of objects in each heartbeat bucket (from another thread, as
+    /// of the end of the last tick).
+    /// </summary>
+    public int[] GetHeartbeatBucketSizes()
     {
-        if (_interpreter == null) return;
+        return OnGameThread ? _heartbeatBuckets.Select(b => b.Count).ToArray() : _publishedBucketSizes.ToArray();
+    }
 
-        // Get a snapshot of objects to avoid lock during execution
-        List<MudObject> objects;
-        lock (_heartbeatLock)
-        {
-            objects = _heartbeatObjects.ToList();
-        }
+    /// <summary>
+    /// Run the next heartbeat bucket.
+    /// Called once per heartbeat turn the tick budget allows.
+    /// </summary>
+    internal void ProcessHeartbeats()
+    {
+        if (_interpreter == null) return;
 
-        if (objects.Count > 0)
-        {
-            Logger.Debug($"ProcessHeartbeats: processing {objects.Count} objects", LogCategory.LPC);
-        }
+        // Copy the bucket so heart_beat() can register and unregister freely
+        _heartbeatBatch.AddRange(_heartbeatBuckets[_heartbeatPhase]);
+        _heartbeatPhase = (_heartbeatPhase + 1) % HeartbeatIntervalTicks;
 
-        foreach (var obj in objects)
+        foreach (var obj in _heartbeatBatch)
         {
             // Skip destructed objects and remove from registry
             if (obj.IsDestructed)
             {
-                lock (_heartbeatLock)
-                {
-                    _heartbeatObjects.Remove(obj);
-                }
+                UnregisterHeartbeat(obj);
                 continue;
             }
 
-            // Skip objects without heartbeat function
-            if (obj.FindFunction("heart_beat") == null)
+            // Turned off by an earlier heart_beat() this tick
+            if (obj.HeartbeatBucket < 0)
             {
                 continue;
             }
 
-            try
+            // Skip objects without heartbeat function
+            if (obj.FindFunction("heart_beat") == null)
             {
-                // Reset instruction counter for fair execution
-                _interpreter.ResetInstructionCount();
-
-                // Call heart_beat() on the object
-                _interpreter.CallFunctionOnObject(obj, "heart_beat", new List<object>());
+                continue;
             }
-            catch (ExecutionLimitException ex)
+
+            if (HeartbeatDormancy && IsDormant(obj))
             {
-                Logger.Warning($"Heartbeat limit exceeded on {obj.ObjectName}: {ex.Message}", LogCategory.LPC);
-                // Disable heartbeat for misbehaving object
-                lock (_heartbeatLock)
+                if (obj.DormantSinceTick < 0)
                 {
-                    _heartbeatObjects.Remove(obj);
+                    obj.DormantSinceTick = NowTick;
                 }
-                obj.HeartbeatEnabled = false;
+                continue;
             }
-            catch (ReturnException)
+
+            // Waking up: tell heart_beat() how long it slept
+            if (obj.DormantSinceTick >= 0)
             {
-                // Normal return from heart_beat()
+                obj.DormantElapsedSeconds = (int)((NowTick - obj.DormantSinceTick) / TicksPerSecond);
+                obj.DormantSinceTick = -1;
             }
-            catch (Exception ex)
+            else
             {
-                Logger.Warning($"Heartbeat error on {obj.ObjectName}: {ex.Message}", LogCategory.LPC);
+                obj.DormantElapsedSeconds = 0;
             }
-        }
-    }
 
-    #endregion
+            // Over its CPU budget: beats on fewer turns until its usage drops
+            if (Cpu.SkipHeartbeat(obj))
+            {
+                continue;
+            }
 
-    #region Reset Methods
+            _heartbeatReady.Add(obj);
+        }
+        _heartbeatBatch.Clear();
 
-    /// <summary>
-    /// Register an object for periodic reset() calls.
-    /// The reset will fire after intervalSeconds, and repeat at that interval.
-    /// Called by set_reset(seconds) efun.
-    /// </summary>
-    public void RegisterReset(MudObject obj, int intervalSeconds)
-    {
-        if (intervalSeconds <= 0)
+        if (ParallelHeartbeats && !_interpreter.Profiler.Enabled && _heartbeatReady.Count >= MinParallelHeartbeats)
         {
-            UnregisterReset(obj);
-            return;
+            RunSandboxedHeartbeats(_interpreter);
         }
 
-        lock (_resetLock)
+        if (RegionWorkers != null)
         {
-            obj.ResetInterval = intervalSeconds;
-            _resetObjects[obj] = DateTime.UtcNow.AddSeconds(intervalSeconds);
+            RunRegionHeartbeats(RegionWorkers);
         }
-    }
 
-    /// <summary>
-    /// Unregister an object from periodic resets.
-    /// Called by set_reset(0) efun.
-    /// </summary>
-    public void UnregisterReset(MudObject obj)
-    {
-        lock (_resetLock)
+        // Everything outside a region (or every heartbeat, without workers)
+        foreach (var obj in _heartbeatReady)
         {
-            obj.ResetInterval = 0;
-            _resetObjects.Remove(obj);
+            // Turned off by an earlier heart_beat() this tick
+            if (obj.IsDestructed || obj.HeartbeatBucket < 0)
+            {
+                continue;
+            }
+
+            long instructions = _interpreter.ThreadInstructions;
+            long allocated = GC.GetAllocatedBytesForCurrentThread();
+            var callStart = Stopwatch.GetTimestamp();
+            if (!RunHeartbeat(_interpreter, obj))
+            {
+                DisableHeartbeat(obj);
+            }
+            RecordCall(obj, "heart_beat", callStart, Stopwatch.GetTimestamp(), _interpreter.ThreadInstructions - instructions,
+                GC.GetAllocatedBytesForCurrentThread() - allocated);
         }
+        _heartbeatReady.Clear();
     }
 
     /// <summary>
-    /// Get the reset interval for an object.
-    /// Returns 0 if not registered for reset.
+    /// Run every ready heartbeat in a sandbox, in parallel. The ones that stay
+    /// inside their object have their messages sent, in order, and are taken
+    /// out of _heartbeatReady; the rest are left there to run normally.
     /// </summary>
-    public int GetResetInterval(MudObject obj)
+    private void RunSandboxedHeartbeats(ObjectInterpreter interpreter)
     {
-        lock (_resetLock)
+        int count = _heartbeatReady.Count;
+        while (_sandboxes.Count < count)
+        {
+            _sandboxes.Add(new HeartbeatSandbox());
+        }
+
+        var timings = new (long Start, long End, long Instructions, long Bytes)[count];
+        var options = new ParallelOptions { MaxDegreeOfParallelism = Environment.ProcessorCount };
+        Parallel.ForEach(Partitioner.Create(0, count), options, range =>
+        {
+            for (int i = range.Item1; i < range.Item2; i++)
+            {
+                var obj = _heartbeatReady[i];
+                var sandbox = _sandboxes[i];
+                long instructions = interpreter.ThreadInstructions;
+                long allocated = GC.GetAllocatedBytesForCurrentThread();
+                long start = Stopwatch.GetTimestamp();
+                sandbox.Begin(obj);
+                interpreter.CallInSandbox(sandbox, obj, "heart_beat");
+                timings[i] = (start, Stopwatch.GetTimestamp(), interpreter.ThreadInstructions - instructions,
+                    GC.GetAllocatedBytesForCurrentThread() - allocated);
+            }
+        });
+
+        // Back on the game thread: keep what worked, in heartbeat order
+        int remaining = 0;
+        for (int i = 0; i < count; i++)
         {
-            return _resetObjects.ContainsKey(obj) ? obj.ResetInterval : 0;
+            var obj = _heartbeatReady[i];
+            var sandbox = _sandboxes[i];
+            if (sandbox.End())
+            {
+                sandbox.ApplyEffects(interpreter);
+                RecordCall(obj, "heart_beat", timings[i].Start, timings[i].End, timings[i].Instructions, timings[i].Bytes);
+                SandboxedHeartbeats++;
+            }
+            else
+            {
+                _heartbeatReady[remaining++] = obj;
+                SandboxAborts++;
+            }
         }
+        _heartbeatReady.RemoveRange(remaining, count - remaining);
     }
 
     /// <summary>
-    /// Call reset() immediately on an object.
-    /// Used after create() completes.
+    /// Run the heartbeats of objects in a region on the region workers and
+    /// take them out of _heartbeatReady, leaving the rest for the game thread.
     /// </summary>
-    public void CallReset(MudObject obj)
+    private void RunRegionHeartbeats(RegionWorkers workers)
     {
-        if (_interpreter == null) return;
+        var groups = new Dictionary<string, List<MudObject>>();
+        int remaining = 0;
+        for (int i = 0; i < _heartbeatReady.Count; i++)
+        {
+            var obj = _heartbeatReady[i];
+            var region = RegionGuard.RegionOf(obj);
+            if (region == null)
+            {
+                _heartbeatReady[remaining++] = obj;
+                continue;
+            }
 
-        // Skip if no reset function exists
-        if (obj.FindFunction("reset") == null)
+            if (!groups.TryGetValue(region, out var group))
+            {
+                groups[region] = group = new List<MudObject>();
+            }
+            group.Add(obj);
+        }
+        _heartbeatReady.RemoveRange(remaining, _heartbeatReady.Count - remaining);
+
+        if (groups.Count == 0) return;
+
+        // Timings and failures are collected per call and applied here, on the game thread
+        var calls = new ConcurrentQueue<(MudObject Obj, long Start, long End, long Instructions, long Bytes, bool Ok)>();
+        workers.Run(groups.Select(kv => (kv.Key, kv.Value)), (interpreter, obj) =>
         {
-            return;
+            if (obj.IsDestructed || obj.HeartbeatBucket < 0) return;
+
+            long instructions = interpreter.ThreadInstructions;
+            long allocated = GC.GetAllocatedBytesForCurrentThread();
+            var callStart = Stopwatch.GetTimestamp();
+            bool ok = RunHeartbeat(interpreter, obj);
+            calls.Enqueue((obj, callStart, Stopwatch.GetTimestamp(), interpreter.ThreadInstructions - instructions,
+                GC.GetAllocatedBytesForCurrentThread() - allocated, ok));
+        });
+
+        foreach (var (obj, start, end, instructions, bytes, ok) in calls)
+        {
+            if (!ok)
+            {
+                DisableHeartbeat(obj);
+            }
+            RecordCall(obj, "heart_beat", start, end, instructions, bytes);
         }
+    }
 
+    /// <summary>
+    /// Call heart_beat() on obj. Returns false if it ran out of execution
+    /// limits and should stop beating.
+    /// </summary>
+    private static bool RunHeartbeat(ObjectInterpreter interpreter, MudObject obj)
+    {
         try
         {
-            _interpreter.ResetInstructionCount();
-            _interpreter.CallFunctionOnObject(obj, "reset", new List<object>());
+            // Reset instruction counter for fair execution
+            interpreter.ResetInstructionCount();
+
+            // Call heart_beat() on the object
+            interpreter.CallFunctionOnObject(obj, "heart_beat", new List<object>());
+            return true;
         }
-        catch (ReturnException)
+        catch (ExecutionLimitException ex)
         {
-            // Normal return
+            Logger.Warning($"Heartbeat limit exceeded on {obj.ObjectName}: {ex.Message}", LogCategory.LPC);
+            return false;
         }
         catch (Exception ex)
         {
-            Logger.Warning($"Reset error on {obj.ObjectName}: {ex.Message}", LogCategory.LPC);
+            Logger.Warning($"Heartbeat error on {obj.ObjectName}: {ex.Message}", LogCategory.LPC);
+            return true;
         }
     }
 
     /// <summary>
-    /// Process periodic resets for all registered objects.
-    /// Called every tick, but only fires resets that are due.
+    /// Disable heartbeat for misbehaving object.
     /// </summary>
-    private void ProcessResets()
+    private void DisableHeartbeat(MudObject obj)
     {
-        if (_interpreter == null) return;
+        UnregisterHeartbeat(obj);
+        obj.HeartbeatEnabled = false;
+    }
 
-        var now = DateTime.UtcNow;
-        List<MudObject> dueForReset;
+    /// <summary>
+    /// Create the region workers, each with an interpreter configured like
+    /// the game thread's.
+    /// </summary>
+    private void StartRegionWorkers()
+    {
+        if (RegionThreads <= 0 || _interpreter == null || RegionWorkers != null) return;
 
-        // Get list of objects due for reset
-        lock (_resetLock)
+        var main = _interpreter;
+        RegionWorkers = new RegionWorkers(RegionThreads, () => new ObjectInterpreter(_objectManager)
         {
-            dueForReset = _resetObjects
-                .Where(kvp => kvp.Value <= now)
-                .Select(kvp => kvp.Key)
-                .ToList();
+            UseBytecode = main.UseBytecode,
+            UseJit = main.UseJit,
+            MemoizeQueries = main.MemoizeQueries,
+            JitThreshold = main.JitThreshold,
+            MaxInstructions = main.MaxInstructions,
+            MaxRecursionDepth = main.MaxRecursionDepth,
+            LimitsEnabled = main.LimitsEnabled
+        });
+        Logger.Info($"Running heartbeats on {RegionThreads} region threads", LogCategory.System);
+    }
+
+    /// <summary>
+    /// Whether obj is in a room with no interactive player (its outermost
+    /// environment, so items carried by a player count as occupied).
+    /// </summary>
+    public bool IsDormant(MudObject obj)
+    {
+        if (obj.Environment == null || obj.IsInteractive)
+        {
+            return false;
         }
 
-        foreach (var obj in dueForReset)
+        var room = obj.Environment;
+        while (room.Environment != null)
         {
-            // Skip destructed objects and remove from registry
-            if (obj.IsDestructed)
+            room = room.Environment;
+        }
+
+        return !room.IsInteractive && room.InteractiveCount == 0;
+    }
+
+    #endregion
+
+    #region Reset Methods
+
+    /// <summary>
+    /// Register an object for periodic reset() calls.
+    /// The reset will fire after intervalSeconds, and repeat at that interval.
+    /// Called by set_reset(seconds) efun.
+    /// </summary>
+    public void RegisterReset(MudObject obj, int intervalSeconds)
+    {
+        if (intervalSeconds <= 0)
+        {
+            UnregisterReset(obj);
+            return;
+        }
+
+        obj.ResetInterval = intervalSeconds;
+        var due = NowTick + (long)intervalSeconds * TicksPerSecond;
+        if (_resetTimers.TryGetValue(obj, out var timer))
+        {
+            _timers.Reschedule(timer, due);
+        }
+        else
+        {
+            _resetTimers[obj] = _timers.Schedule(new ResetEvent(obj), due);
+        }
+    }
+
+    /// <summary>
+    /// Unregister an object from periodic resets.
+    /// Called by set_reset(0) efun.
+    /// </summary>
+    public void UnregisterReset(MudObject obj)
+    {
+        obj.ResetInterval = 0;
+        if (_resetTimers.Remove(obj, out var timer))
+        {
+            _timers.Cancel(timer);
+        }
+    }
+
+    /// <summary>
+    /// Get the reset interval for an object.
+    /// Returns 0 if not registered for reset.
+    /// </summary>
+    public int GetResetInterval(MudObject obj)
+    {
+        return _resetTimers.ContainsKey(obj) ? obj.ResetInterval : 0;
+    }
+
+    /// <summary>
+    /// Call reset() immediately on an object.
+    /// Used after create() completes.
+    /// </summary>
+    public void CallReset(MudObject obj)
+    {
+        if (_interpreter == null) return;
+
+        // Skip if no reset function exists
+        if (obj.FindFunction("reset") == null)
+        {
+            return;
+        }
+
+        try
+        {
+            _interpreter.ResetInstructionCount();
+            _interpreter.CallFunctionOnObject(obj, "reset", new List<object>());
+        }
+        catch (Exception ex)
+        {
+            Logger.Warning($"Reset error on {obj.ObjectName}: {ex.Message}", LogCategory.LPC);
+        }
+    }
+
+    /// <summary>
+    /// Run a periodic reset that came due, then schedule the next one.
+    /// </summary>
+    private void RunReset(MudObject obj)
+    {
+        // Skip destructed objects and remove from registry
+        if (obj.IsDestructed)
+        {
+            UnregisterReset(obj);
+            return;
+        }
+
+        // Dormant objects skip resets; the timer keeps running for when a player arrives
+        if (obj.FindFunction("reset") != null && !(HeartbeatDormancy && IsDormant(obj)))
+        {
+            // A reset isn't a use: a room nobody visits still goes idle for clean_up()
+            var lastReferenced = obj.LastReferenced;
+            try
             {
-                lock (_resetLock)
-                {
-                    _resetObjects.Remove(obj);
-                }
-                continue;
+                _interpreter!.ResetInstructionCount();
+                long instructions = _interpreter.ThreadInstructions;
+                long allocated = GC.GetAllocatedBytesForCurrentThread();
+                var callStart = Stopwatch.GetTimestamp();
+                _interpreter.CallFunctionOnObject(obj, "reset", new List<object>());
+                RecordCall(obj, "reset", callStart, Stopwatch.GetTimestamp(), _interpreter.ThreadInstructions - instructions,
+                    GC.GetAllocatedBytesForCurrentThread() - allocated);
             }
+            catch (ExecutionLimitException ex)
+            {
+                Logger.Warning($"Reset limit exceeded on {obj.ObjectName}: {ex.Message}", LogCategory.LPC);
+                // Disable reset for misbehaving object
+                UnregisterReset(obj);
+                return;
+            }
+            catch (Exception ex)
+            {
+                Logger.Warning($"Reset error on {obj.ObjectName}: {ex.Message}", LogCategory.LPC);
+            }
+            obj.LastReferenced = lastReferenced;
+        }
+
+        // Schedule next reset, unless reset() called set_reset() itself
+        if (_resetTimers.TryGetValue(obj, out var timer) && !timer.IsScheduled && obj.ResetInterval > 0)
+        {
+            _timers.Reschedule(timer, NowTick + (long)obj.ResetInterval * TicksPerSecond);
+        }
+    }
+
+    #endregion
+
+    #region Clean Up
+
+    /// <summary>
+    /// The LPMud clean_up() cycle, so a long-running world doesn't keep every
+    /// room anyone ever walked through. Each object whose code hasn't run for
+    /// CleanUpIdleSeconds (as of now, in Environment.TickCount64 milliseconds)
+    /// gets clean_up(inherited), inherited being 1 for a blueprint other
+    /// programs inherit. It normally destructs itself, contents and all, when
+    /// nothing needs it; returning 0 means don't ask again.
+    ///
+    /// Objects inside something are left to their container, and ones with a
+    /// player or anything recently used inside are skipped. So are blueprints
+    /// with clones, since destructing one takes its clones with it. Returns
+    /// the number of objects offered clean_up() that destructed.
+    /// </summary>
+    public int RunCleanUp(long now)
+    {
+        if (_interpreter == null) return 0;
 
-            // Skip if no reset function
-            if (obj.FindFunction("reset") == null)
+        long idle = (long)CleanUpIdleSeconds * 1000;
+        int destructed = 0;
+        foreach (var obj in _objectManager.GetAllObjects())
+        {
+            if (obj.IsDestructed || obj.NoCleanUp || obj.Environment != null ||
+                now - obj.LastReferenced < idle || (obj.IsBlueprint && obj.Clones.Count > 0) ||
+                obj.FindFunction("clean_up") == null || InUse(obj, now - idle))
             {
                 continue;
             }
 
+            int inherited = obj.IsBlueprint && _objectManager.GetInheritanceChildren(obj.FilePath).Count > 0 ? 1 : 0;
             try
             {
                 _interpreter.ResetInstructionCount();
-                _interpreter.CallFunctionOnObject(obj, "reset", new List<object>());
+                long instructions = _interpreter.ThreadInstructions;
+                long allocated = GC.GetAllocatedBytesForCurrentThread();
+                var callStart = Stopwatch.GetTimestamp();
+                var result = _interpreter.CallFunctionOnObject(obj, "clean_up", new List<object> { inherited });
+                RecordCall(obj, "clean_up", callStart, Stopwatch.GetTimestamp(), _interpreter.ThreadInstructions - instructions,
+                    GC.GetAllocatedBytesForCurrentThread() - allocated);
+                obj.NoCleanUp = result is 0 or 0L;
+            }
+            catch (Exception ex)
+            {
+                Logger.Warning($"clean_up error on {obj.ObjectName}: {ex.Message}", LogCategory.LPC);
+                obj.NoCleanUp = true;
+            }
 
-                // Schedule next reset
-                lock (_resetLock)
-                {
-                    if (_resetObjects.ContainsKey(obj) && obj.ResetInterval > 0)
-                    {
-                        _resetObjects[obj] = DateTime.UtcNow.AddSeconds(obj.ResetInterval);
-                    }
-                }
+            if (obj.IsDestructed)
+            {
+                destructed++;
             }
-            catch (ExecutionLimitException ex)
+        }
+
+        if (destructed > 0)
+        {
+            Logger.Debug($"clean_up unloaded {destructed} idle object(s)", LogCategory.Object);
+        }
+        return destructed;
+    }
+
+    /// <summary>
+    /// Whether obj holds, anywhere inside it, an interactive player or an
+    /// object whose code ran after since.
+    /// </summary>
+    private static bool InUse(MudObject obj, long since)
+    {
+        if (obj.IsInteractive || obj.InteractiveCount > 0) return true;
+        foreach (var content in obj.Contents)
+        {
+            if (content.LastReferenced > since || InUse(content, since)) return true;
+        }
+        return false;
+    }
+
+    #endregion
+
+    #region Copyover
+
+    private volatile bool _pauseRequested;
+    private readonly ManualResetEventSlim _parked = new(false);
+    private readonly ManualResetEventSlim _unpaused = new(true);
+
+    /// <summary>
+    /// Players coming back from a copyover, for the game thread to log in.
+    /// </summary>
+    private readonly ConcurrentQueue<PlayerSession> _resumedSessions = new();
+
+    /// <summary>
+    /// Sessions the login worker has authenticated, for the game thread to take over.
+    /// </summary>
+    private readonly ConcurrentQueue<PlayerSession> _authenticated = new();
+
+    /// <summary>
+    /// Authenticated sessions waiting to enter the game (game thread only).
+    /// </summary>
+    private readonly Queue<PlayerSession> _admissions = new();
+    private int _admittedThisTick;
+    private long _admissionPasses;
+
+    /// <summary>
+    /// Ticks between reminders to sessions waiting in the login queue.
+    /// </summary>
+    private const int AdmissionNoticeTicks = 50;
+
+    /// <summary>
+    /// Callback invoked when an admin asks for a copyover.
+    /// Set by TelnetServer, which owns the sockets being handed over.
+    /// </summary>
+    public Action? OnCopyoverRequested { get; set; }
+
+    /// <summary>
+    /// Ask for a copyover. False if nothing is listening for the request.
+    /// </summary>
+    public bool RequestCopyover()
+    {
+        var handler = OnCopyoverRequested;
+        if (handler == null) return false;
+        handler();
+        return true;
+    }
+
+    /// <summary>
+    /// Hold the game thread between ticks until Resume(), so another thread
+    /// can work with the world while nothing runs. False if it didn't stop
+    /// within timeout.
+    /// </summary>
+    public bool Pause(TimeSpan timeout)
+    {
+        if (!_running) return true;
+
+        _unpaused.Reset();
+        _pauseRequested = true;
+        return _parked.Wait(timeout);
+    }
+
+    public void Resume()
+    {
+        _pauseRequested = false;
+        _unpaused.Set();
+    }
+
+    /// <summary>
+    /// Park the game thread here while Pause() holds it (game thread).
+    /// </summary>
+    private void WaitWhilePaused()
+    {
+        if (!_pauseRequested) return;
+
+        _parked.Set();
+        _unpaused.Wait();
+        _parked.Reset();
+    }
+
+    /// <summary>
+    /// Get ready to hand over to a new driver process (game thread paused):
+    /// tell players, save them all and wait for the files to be written.
+    /// Returns the username playing on each connection.
+    /// </summary>
+    public Dictionary<string, string> PrepareCopyover()
+    {
+        var players = new Dictionary<string, string>();
+        lock (_sessionLock)
+        {
+            foreach (var session in _sessions.Values)
             {
-                Logger.Warning($"Reset limit exceeded on {obj.ObjectName}: {ex.Message}", LogCategory.LPC);
-                // Disable reset for misbehaving object
-                lock (_resetLock)
+                if (session.LoginState == LoginState.Playing && session.AuthenticatedUsername != null)
                 {
-                    _resetObjects.Remove(obj);
+                    players[session.ConnectionId] = session.AuthenticatedUsername;
                 }
-                obj.ResetInterval = 0;
+                SendToPlayer(session.ConnectionId, "\r\n*** Copyover: the driver is restarting, hold on... ***\r\n");
             }
-            catch (ReturnException)
+        }
+
+        SaveAllPlayers();
+        Snapshot?.Write(this);
+        AsyncFileWriter.Shared.Flush();
+        _objectManager.SaveStore?.Flush();
+        return players;
+    }
+
+    /// <summary>
+    /// The handover didn't happen; the game carries on in this process.
+    /// </summary>
+    public void CopyoverFailed(string reason)
+    {
+        Logger.Error($"Copyover failed: {reason}", LogCategory.System);
+        foreach (var session in GetAllSessions())
+        {
+            SendToPlayer(session.ConnectionId, "*** Copyover failed; carry on. ***\r\n");
+        }
+    }
+
+    /// <summary>
+    /// Session for a connection inherited from the driver before a copyover.
+    /// A player who was in the game is logged straight back in as username
+    /// (no password: the old driver already authenticated them); anyone else
+    /// starts the login over. Called from network thread.
+    /// </summary>
+    public void ResumePlayerSession(string connectionId, string? remoteAddress, string? username, string? arrivalRoom = null)
+    {
+        if (username == null || !_accountManager.AccountExists(username))
+        {
+            CreatePlayerSession(connectionId, remoteAddress);
+            return;
+        }
+
+        var session = new PlayerSession
+        {
+            ConnectionId = connectionId,
+            RemoteAddress = remoteAddress,
+            CreatedAt = DateTime.UtcNow,
+            LastActivity = DateTime.UtcNow,
+            LoginState = LoginState.Authenticated,
+            AuthenticatedUsername = username,
+            ArrivalRoom = arrivalRoom
+        };
+
+        lock (_sessionLock)
+        {
+            _sessions[connectionId] = session;
+        }
+        _resumedSessions.Enqueue(session);
+    }
+
+    /// <summary>
+    /// Put players from a copyover back in the game (game thread).
+    /// </summary>
+    private void RunResumedSessions()
+    {
+        while (_resumedSessions.TryDequeue(out var session))
+        {
+            // The connection may have closed in the meantime
+            if (GetSession(session.ConnectionId) != session) continue;
+
+            if (session.ArrivalRoom == null)
             {
-                // Normal return - schedule next reset
-                lock (_resetLock)
-                {
-                    if (_resetObjects.ContainsKey(obj) && obj.ResetInterval > 0)
+                SendToPlayer(session.ConnectionId, "*** Copyover complete. ***\r\n");
+            }
+            AdmitLogin(session);
+        }
+    }
+
+    #endregion
+
+    #region Cluster
+
+    /// <summary>
+    /// This driver's node in a cluster, or null when it runs alone. Set before Start().
+    /// </summary>
+    public ClusterNode? Cluster { get; set; }
+
+    /// <summary>
+    /// Players handed off to another node this tick, to take out of the game here.
+    /// </summary>
+    private readonly ConcurrentQueue<PlayerSession> _handoffs = new();
+
+    private long _lastUserPublish;
+
+    /// <summary>
+    /// Hand player over to the node that owns room (game thread, from
+    /// move_object()). The player is saved now; once the output they were
+    /// sent so far has gone out, the router moves their connection and the
+    /// other node logs them in, in room. Output sent to them after this is
+    /// dropped. False if player isn't a connected player on a routed
+    /// connection, or is already leaving.
+    /// </summary>
+    public bool HandOff(MudObject player, string room)
+    {
+        var cluster = Cluster;
+        var session = FindSessionByPlayerObject(player);
+        if (cluster == null || session == null || session.HandingOff || session.AuthenticatedUsername == null)
+        {
+            return false;
+        }
+        var route = cluster.RouteOf(session.ConnectionId);
+        if (route == null)
+        {
+            return false;
+        }
+
+        session.HandingOff = true;
+        SavePlayerObject(player);
+        AsyncFileWriter.Shared.Flush();
+
+        _outputQueue.Enqueue(new OutputMessage
+        {
+            ConnectionId = session.ConnectionId,
+            Handoff = new ClusterMessage
+            {
+                Type = "handoff",
+                To = cluster.Config.OwnerOf(room),
+                Route = route,
+                User = session.AuthenticatedUsername,
+                Room = room
+            }
+        });
+        _handoffs.Enqueue(session);
+        Logger.Info($"Player {session.AuthenticatedUsername} handed off to {cluster.Config.OwnerOf(room)}", LogCategory.Player);
+        return true;
+    }
+
+    /// <summary>
+    /// Cluster work for the tick (game thread): calls from other nodes and
+    /// their replies, players handed off, and this node's player list for
+    /// the router's directory.
+    /// </summary>
+    private void RunCluster()
+    {
+        var cluster = Cluster;
+        if (cluster == null) return;
+
+        while (cluster.TryReceive(out var message))
+        {
+            switch (message.Type)
+            {
+                case "call":
+                    RunClusterCall(cluster, message);
+                    break;
+                case "reply":
+                    if (cluster.EndCall(message.Id) is { } call)
                     {
-                        _resetObjects[obj] = DateTime.UtcNow.AddSeconds(obj.ResetInterval);
+                        DeliverClusterReply(call.Caller, call.Callback, message.Error == null ? ClusterNode.Decode(message.Value) : 0L);
                     }
-                }
+                    break;
             }
-            catch (Exception ex)
+        }
+        foreach (var (caller, callback) in cluster.ExpiredCalls(DateTime.UtcNow))
+        {
+            DeliverClusterReply(caller, callback, 0L);
+        }
+
+        while (_handoffs.TryDequeue(out var session))
+        {
+            ForceRemoveSession(session);
+        }
+
+        long now = Environment.TickCount64;
+        if (now - _lastUserPublish >= 1000)
+        {
+            _lastUserPublish = now;
+            var users = new List<string>();
+            foreach (var session in GetAllSessions())
             {
-                Logger.Warning($"Reset error on {obj.ObjectName}: {ex.Message}", LogCategory.LPC);
+                if (session.LoginState == LoginState.Playing && !session.HandingOff && session.AuthenticatedUsername != null)
+                {
+                    users.Add(session.AuthenticatedUsername.ToLowerInvariant());
+                }
             }
+            cluster.PublishUsers(users);
+        }
+    }
+
+    /// <summary>
+    /// Run a call_other_async() from another node and send back the result.
+    /// </summary>
+    private void RunClusterCall(ClusterNode cluster, ClusterMessage message)
+    {
+        var reply = new ClusterMessage { Type = "reply", To = message.From, Id = message.Id };
+        try
+        {
+            var args = ClusterNode.Decode(message.Value) as List<object> ?? new List<object>();
+            _interpreter!.ResetInstructionCount();
+            reply.Value = ClusterNode.Encode(_interpreter.CallFromNode(message.Path ?? "", message.Function ?? "", args));
+        }
+        catch (Exception ex)
+        {
+            Logger.Warning($"Cluster call {message.Path}->{message.Function}() from {message.From} failed: {ex.Message}", LogCategory.Object);
+            reply.Error = ex.Message;
+        }
+        cluster.Send(reply);
+    }
+
+    private void DeliverClusterReply(MudObject caller, string? callback, object result)
+    {
+        if (callback != null && !caller.IsDestructed)
+        {
+            ScheduleCallout(caller, callback, new List<object> { result }, 0);
         }
     }
 
@@ -1251,180 +2649,463 @@ public class GameLoop
     #region Callout Methods
 
     /// <summary>
-    /// Schedule a callout to call a function on an object after a delay.
-    /// Returns the callout ID which can be used to cancel it.
+    /// Schedule a callout to call a function on an object after a delay.
+    /// Returns the callout ID which can be used to cancel it.
+    /// </summary>
+    public int ScheduleCallout(MudObject target, string function, List<object> args, int delaySeconds)
+    {
+        var id = _nextCalloutId++;
+        var entry = new CalloutEntry(target, function, args, id);
+        var timer = _timers.Schedule(entry, NowTick + (long)delaySeconds * TicksPerSecond);
+
+        _calloutsById[id] = timer;
+        if (!_calloutsByObject.TryGetValue(target, out var timers))
+        {
+            timers = new List<TimingWheel<ScheduledEvent>.Timer>();
+            _calloutsByObject[target] = timers;
+        }
+        timers.Add(timer);
+        return id;
+    }
+
+    /// <summary>
+    /// Start function(args) in target as a coroutine, first resumed next
+    /// tick. Returns its id, or 0 if too many coroutines are alive.
+    /// </summary>
+    public int StartCoroutine(MudObject target, string function, List<object> args)
+    {
+        return Coroutines.Start(_interpreter!, target, function, args, NowTick + 1);
+    }
+
+    /// <summary>
+    /// Remove a callout by function name for the given object.
+    /// Returns the time remaining until it would have fired, or -1 if not found.
+    /// </summary>
+    public int RemoveCalloutByFunction(MudObject target, string function)
+    {
+        var timer = FindCalloutTimer(target, function);
+        return timer == null ? -1 : CancelCallout(timer);
+    }
+
+    /// <summary>
+    /// Remove a callout by its ID.
+    /// Returns the time remaining until it would have fired, or -1 if not found.
+    /// </summary>
+    public int RemoveCalloutById(int calloutId)
+    {
+        return _calloutsById.TryGetValue(calloutId, out var timer) ? CancelCallout(timer) : -1;
+    }
+
+    /// <summary>
+    /// Find the time remaining until a callout fires for a given function.
+    /// Returns -1 if no matching callout is found.
+    /// </summary>
+    public int FindCallout(MudObject target, string function)
+    {
+        var timer = FindCalloutTimer(target, function);
+        return timer == null ? -1 : SecondsUntil(timer);
+    }
+
+    /// <summary>
+    /// Drop a destructed object's callouts, reset and heartbeat now rather
+    /// than when they come due, so the timers stop holding on to it.
+    /// </summary>
+    private void ForgetObject(MudObject obj)
+    {
+        if (_calloutsByObject.Remove(obj, out var timers))
+        {
+            foreach (var timer in timers)
+            {
+                _timers.Cancel(timer);
+                _calloutsById.Remove(((CalloutEntry)timer.Value).CalloutId);
+            }
+        }
+        RemoveEffects(obj);
+        UnregisterReset(obj);
+        UnregisterHeartbeat(obj);
+        Cpu.Forget(obj);
+        _objectManager.Spawns.Forget(obj);
+    }
+
+    /// <summary>
+    /// Number of pending callouts, resets, effects and linkdead expiries
+    /// (from another thread, as of the end of the last tick).
+    /// </summary>
+    public int PendingTimerCount => OnGameThread ? _timers.Count : _publishedTimerCount;
+
+    /// <summary>
+    /// The next callout of function on target to fire.
+    /// </summary>
+    private TimingWheel<ScheduledEvent>.Timer? FindCalloutTimer(MudObject target, string function)
+    {
+        if (!_calloutsByObject.TryGetValue(target, out var timers))
+        {
+            return null;
+        }
+
+        TimingWheel<ScheduledEvent>.Timer? next = null;
+        foreach (var timer in timers)
+        {
+            if (((CalloutEntry)timer.Value).Function == function &&
+                (next == null || timer.DueTick < next.DueTick))
+            {
+                next = timer;
+            }
+        }
+        return next;
+    }
+
+    /// <summary>
+    /// Unschedule a callout, returning its remaining seconds.
+    /// </summary>
+    private int CancelCallout(TimingWheel<ScheduledEvent>.Timer timer)
+    {
+        var remaining = SecondsUntil(timer);
+        _timers.Cancel(timer);
+        UnindexCallout(timer);
+        return remaining;
+    }
+
+    private void UnindexCallout(TimingWheel<ScheduledEvent>.Timer timer)
+    {
+        var entry = (CalloutEntry)timer.Value;
+        _calloutsById.Remove(entry.CalloutId);
+        if (_calloutsByObject.TryGetValue(entry.Target, out var timers))
+        {
+            timers.Remove(timer);
+            if (timers.Count == 0)
+            {
+                _calloutsByObject.Remove(entry.Target);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Every pending callout with its remaining seconds, for WorldSnapshot.
+    /// </summary>
+    internal List<(MudObject Target, string Function, List<object> Args, int Seconds)> PendingCallouts()
+    {
+        var callouts = new List<(MudObject, string, List<object>, int)>(_calloutsById.Count);
+        foreach (var timer in _calloutsById.Values)
+        {
+            var entry = (CalloutEntry)timer.Value;
+            callouts.Add((entry.Target, entry.Function, entry.Args, SecondsUntil(timer)));
+        }
+        return callouts;
+    }
+
+    private int SecondsUntil(TimingWheel<ScheduledEvent>.Timer timer)
+    {
+        return (int)Math.Max(0, (timer.DueTick - NowTick) / TicksPerSecond);
+    }
+
+    /// <summary>
+    /// Fire the callouts and linkdead expiries that are due, and queue due
+    /// resets for RunWaitingResets().
+    /// Called every tick.
+    /// </summary>
+    private void ProcessTimers()
+    {
+        if (_interpreter == null) return;
+
+        // Collect due events; fired callouts leave the indexes right away so
+        // find_call_out() from inside them doesn't see themselves
+        int first = _dueEvents.Count;
+        _timers.Advance(NowTick, _dueEvents);
+        for (int i = first; i < _dueEvents.Count; i++)
+        {
+            if (_dueEvents[i] is CalloutEntry callout && _calloutsById.TryGetValue(callout.CalloutId, out var timer))
+            {
+                UnindexCallout(timer);
+            }
+        }
+
+        // Execute outside the lock
+        foreach (var due in _dueEvents)
+        {
+            switch (due)
+            {
+                case CalloutEntry callout:
+                    RunCallout(callout);
+                    break;
+                case ResetEvent reset:
+                    _resetsWaiting.Enqueue((reset.Target, NowTick));
+                    break;
+                case LinkdeadExpiry expiry:
+                    ExpireLinkdeadSession(expiry.Session);
+                    break;
+                case EffectEntry effect:
+                    RunEffect(effect);
+                    break;
+            }
+        }
+        _dueEvents.Clear();
+    }
+
+    /// <summary>
+    /// Run the resets that came due, oldest first, while the tick has room
+    /// for them or they have waited too long.
+    /// </summary>
+    private void RunWaitingResets()
+    {
+        while (_resetsWaiting.TryPeek(out var waiting) && Budget.MayRun(NowTick - waiting.DueTick))
+        {
+            _resetsWaiting.Dequeue();
+            RunReset(waiting.Target);
+        }
+    }
+
+    /// <summary>
+    /// Clone a batch of the monsters rooms asked for with respawn(), while
+    /// the tick has room or the queue has waited too long.
+    /// </summary>
+    private void RunSpawns()
+    {
+        var spawns = _objectManager.Spawns;
+        if (spawns.PendingRooms == 0)
+        {
+            _spawnsWaitingSince = NowTick;
+            return;
+        }
+        if (!Budget.MayRun(NowTick - _spawnsWaitingSince)) return;
+
+        _spawnsWaitingSince = NowTick;
+        spawns.RunQueued(SpawnsPerTick, (path, room) =>
+        {
+            _interpreter!.ResetInstructionCount();
+            return _interpreter.SpawnInto(path, room);
+        });
+    }
+
+    /// <summary>
+    /// Resets that are due but waiting for room in a tick.
+    /// </summary>
+    public int WaitingResets => _resetsWaiting.Count;
+
+    private static long TicksOverdue(DateTime now, DateTime last, TimeSpan interval)
+    {
+        return (long)((now - last - interval).TotalMilliseconds / TickIntervalMs);
+    }
+
+    private void RunCallout(CalloutEntry entry)
+    {
+        // Skip destructed objects
+        if (entry.Target.IsDestructed)
+        {
+            return;
+        }
+
+        // Skip if function doesn't exist
+        if (entry.Target.FindFunction(entry.Function) == null)
+        {
+            Logger.Warning($"Callout warning: Function {entry.Function} not found on {entry.Target.ObjectName}", LogCategory.LPC);
+            return;
+        }
+
+        try
+        {
+            // Reset instruction counter
+            _interpreter!.ResetInstructionCount();
+
+            // Call the function
+            long instructions = _interpreter.ThreadInstructions;
+            long allocated = GC.GetAllocatedBytesForCurrentThread();
+            var callStart = Stopwatch.GetTimestamp();
+            _interpreter.CallFunctionOnObject(entry.Target, entry.Function, entry.Args);
+            RecordCall(entry.Target, entry.Function, callStart, Stopwatch.GetTimestamp(), _interpreter.ThreadInstructions - instructions,
+                GC.GetAllocatedBytesForCurrentThread() - allocated);
+        }
+        catch (ExecutionLimitException ex)
+        {
+            Logger.Warning($"Callout limit exceeded on {entry.Target.ObjectName}->{entry.Function}: {ex.Message}", LogCategory.LPC);
+        }
+        catch (Exception ex)
+        {
+            Logger.Error($"Callout error on {entry.Target.ObjectName}->{entry.Function}: {ex.Message}", LogCategory.LPC);
+        }
+    }
+
+    #endregion
+
+    #region Effect Methods
+
+    /// <summary>
+    /// Put effect id on target for durationSeconds, calling tickFunction on
+    /// owner every intervalSeconds and expireFunction when it runs out (either
+    /// may be null). Adding an id the target already has replaces it.
+    /// </summary>
+    public void AddEffect(MudObject target, MudObject owner, string id, int durationSeconds,
+        string? tickFunction, string? expireFunction, int intervalSeconds)
+    {
+        if (!_effects.TryGetValue(target, out var effects))
+        {
+            effects = new Dictionary<string, TimingWheel<ScheduledEvent>.Timer>();
+            _effects[target] = effects;
+        }
+        else if (effects.Remove(id, out var old))
+        {
+            _timers.Cancel(old);
+        }
+
+        long now = NowTick;
+        var entry = new EffectEntry(target, owner, id, tickFunction, expireFunction,
+            Math.Max(1, (long)intervalSeconds * TicksPerSecond))
+        {
+            ExpiresTick = now + (long)Math.Max(0, durationSeconds) * TicksPerSecond
+        };
+        effects[id] = _timers.Schedule(entry, NextEffectTick(entry, now));
+    }
+
+    /// <summary>
+    /// End effect id on target early, without calling its expire function.
+    /// Returns the seconds it had left, or -1 if target doesn't have it.
     /// </summary>
-    public int ScheduleCallout(MudObject target, string function, List<object> args, int delaySeconds)
+    public int RemoveEffect(MudObject target, string id)
     {
-        lock (_calloutLock)
+        if (!_effects.TryGetValue(target, out var effects) || !effects.Remove(id, out var timer))
         {
-            var id = _nextCalloutId++;
-            var entry = new CalloutEntry(
-                target,
-                function,
-                args,
-                DateTime.UtcNow.AddSeconds(delaySeconds),
-                id
-            );
-            _callouts.Enqueue(entry, entry.FireTime);
-            return id;
+            return -1;
         }
+        if (effects.Count == 0)
+        {
+            _effects.Remove(target);
+        }
+        _timers.Cancel(timer);
+        return EffectSecondsLeft((EffectEntry)timer.Value);
     }
 
     /// <summary>
-    /// Remove a callout by function name for the given object.
-    /// Returns the time remaining until it would have fired, or -1 if not found.
+    /// Seconds left on effect id on target, or -1 if it doesn't have it.
     /// </summary>
-    public int RemoveCalloutByFunction(MudObject target, string function)
+    public int QueryEffect(MudObject target, string id)
     {
-        lock (_calloutLock)
-        {
-            // We need to rebuild the queue without the matching callout
-            var remaining = new List<CalloutEntry>();
-            int foundTime = -1;
-
-            while (_callouts.TryDequeue(out var entry, out _))
-            {
-                if (entry.Target == target && entry.Function == function && foundTime == -1)
-                {
-                    // Found the first matching callout
-                    foundTime = Math.Max(0, (int)(entry.FireTime - DateTime.UtcNow).TotalSeconds);
-                }
-                else
-                {
-                    remaining.Add(entry);
-                }
-            }
+        return _effects.TryGetValue(target, out var effects) && effects.TryGetValue(id, out var timer)
+            ? EffectSecondsLeft((EffectEntry)timer.Value)
+            : -1;
+    }
 
-            // Re-add remaining callouts
-            foreach (var entry in remaining)
+    /// <summary>
+    /// Every effect on target with its seconds left.
+    /// </summary>
+    public Dictionary<string, int> QueryEffects(MudObject target)
+    {
+        var result = new Dictionary<string, int>();
+        if (_effects.TryGetValue(target, out var effects))
+        {
+            foreach (var (id, timer) in effects)
             {
-                _callouts.Enqueue(entry, entry.FireTime);
+                result[id] = EffectSecondsLeft((EffectEntry)timer.Value);
             }
-
-            return foundTime;
         }
+        return result;
     }
 
     /// <summary>
-    /// Remove a callout by its ID.
-    /// Returns the time remaining until it would have fired, or -1 if not found.
+    /// Objects with effects on them.
     /// </summary>
-    public int RemoveCalloutById(int calloutId)
+    public int EffectTargets
     {
-        lock (_calloutLock)
+        get
         {
-            var remaining = new List<CalloutEntry>();
-            int foundTime = -1;
-
-            while (_callouts.TryDequeue(out var entry, out _))
-            {
-                if (entry.CalloutId == calloutId && foundTime == -1)
-                {
-                    foundTime = Math.Max(0, (int)(entry.FireTime - DateTime.UtcNow).TotalSeconds);
-                }
-                else
-                {
-                    remaining.Add(entry);
-                }
-            }
-
-            foreach (var entry in remaining)
-            {
-                _callouts.Enqueue(entry, entry.FireTime);
-            }
-
-            return foundTime;
+            return _effects.Count;
         }
     }
 
     /// <summary>
-    /// Find the time remaining until a callout fires for a given function.
-    /// Returns -1 if no matching callout is found.
+    /// Every effect with its seconds left, for WorldSnapshot.
     /// </summary>
-    public int FindCallout(MudObject target, string function)
+    internal List<(MudObject Target, MudObject Owner, string Id, string? TickFunction, string? ExpireFunction,
+        int IntervalSeconds, int Seconds)> PendingEffects()
     {
-        lock (_calloutLock)
+        var result = new List<(MudObject, MudObject, string, string?, string?, int, int)>();
+        foreach (var effects in _effects.Values)
         {
-            // We need to peek through the queue without modifying it
-            var entries = new List<CalloutEntry>();
-
-            while (_callouts.TryDequeue(out var entry, out _))
+            foreach (var timer in effects.Values)
             {
-                entries.Add(entry);
+                var entry = (EffectEntry)timer.Value;
+                result.Add((entry.Target, entry.Owner, entry.Id, entry.TickFunction, entry.ExpireFunction,
+                    (int)(entry.IntervalTicks / TicksPerSecond), EffectSecondsLeft(entry)));
             }
+        }
+        return result;
+    }
 
-            int foundTime = -1;
-            foreach (var entry in entries)
+    private void RemoveEffects(MudObject target)
+    {
+        if (_effects.Remove(target, out var effects))
+        {
+            foreach (var timer in effects.Values)
             {
-                _callouts.Enqueue(entry, entry.FireTime);
-                if (entry.Target == target && entry.Function == function && foundTime == -1)
-                {
-                    foundTime = Math.Max(0, (int)(entry.FireTime - DateTime.UtcNow).TotalSeconds);
-                }
+                _timers.Cancel(timer);
             }
-
-            return foundTime;
         }
     }
 
-    /// <summary>
-    /// Process all callouts that are due to fire.
-    /// Called every tick.
-    /// </summary>
-    private void ProcessCallouts()
+    private static long NextEffectTick(EffectEntry entry, long now)
     {
-        if (_interpreter == null) return;
+        return entry.TickFunction == null ? entry.ExpiresTick : Math.Min(now + entry.IntervalTicks, entry.ExpiresTick);
+    }
 
-        var now = DateTime.UtcNow;
-        var toExecute = new List<CalloutEntry>();
+    private int EffectSecondsLeft(EffectEntry entry)
+    {
+        return (int)Math.Max(0, (entry.ExpiresTick - NowTick + TicksPerSecond - 1) / TicksPerSecond);
+    }
 
-        // Collect all due callouts
-        lock (_calloutLock)
+    /// <summary>
+    /// An effect's timer fired: expire it, or tick it and wait for the next
+    /// boundary. The timer is settled before calling into LPC, so the
+    /// functions may add or remove effects, this one included.
+    /// </summary>
+    private void RunEffect(EffectEntry entry)
+    {
+        string? function;
+        var args = new List<object> { entry.Target, entry.Id };
+        // Replaced or removed since it fired
+        if (!_effects.TryGetValue(entry.Target, out var effects) ||
+            !effects.TryGetValue(entry.Id, out var timer) || !ReferenceEquals(timer.Value, entry))
         {
-            while (_callouts.TryPeek(out var entry, out var fireTime) && fireTime <= now)
-            {
-                _callouts.Dequeue();
-                toExecute.Add(entry);
-            }
+            return;
         }
 
-        // Execute outside the lock
-        foreach (var entry in toExecute)
+        long now = NowTick;
+        if (entry.Owner.IsDestructed || now >= entry.ExpiresTick)
         {
-            // Skip destructed objects
-            if (entry.Target.IsDestructed)
-            {
-                continue;
-            }
-
-            // Skip if function doesn't exist
-            if (entry.Target.FindFunction(entry.Function) == null)
+            effects.Remove(entry.Id);
+            if (effects.Count == 0)
             {
-                Logger.Warning($"Callout warning: Function {entry.Function} not found on {entry.Target.ObjectName}", LogCategory.LPC);
-                continue;
+                _effects.Remove(entry.Target);
             }
+            function = entry.Owner.IsDestructed ? null : entry.ExpireFunction;
+        }
+        else
+        {
+            _timers.Reschedule(timer, NextEffectTick(entry, now));
+            function = entry.TickFunction;
+            args.Add(EffectSecondsLeft(entry));
+        }
 
-            try
-            {
-                // Reset instruction counter
-                _interpreter.ResetInstructionCount();
+        if (function == null || entry.Target.IsDestructed)
+        {
+            return;
+        }
 
-                // Call the function
-                _interpreter.CallFunctionOnObject(entry.Target, entry.Function, entry.Args);
-            }
-            catch (ExecutionLimitException ex)
-            {
-                Logger.Warning($"Callout limit exceeded on {entry.Target.ObjectName}->{entry.Function}: {ex.Message}", LogCategory.LPC);
-            }
-            catch (ReturnException)
-            {
-                // Normal return from callout function
-            }
-            catch (Exception ex)
-            {
-                Logger.Error($"Callout error on {entry.Target.ObjectName}->{entry.Function}: {ex.Message}", LogCategory.LPC);
-            }
+        try
+        {
+            _interpreter!.ResetInstructionCount();
+            long instructions = _interpreter.ThreadInstructions;
+            long allocated = GC.GetAllocatedBytesForCurrentThread();
+            var callStart = Stopwatch.GetTimestamp();
+            _interpreter.CallFunctionOnObject(entry.Owner, function, args);
+            RecordCall(entry.Owner, function, callStart, Stopwatch.GetTimestamp(), _interpreter.ThreadInstructions - instructions,
+                GC.GetAllocatedBytesForCurrentThread() - allocated);
+        }
+        catch (ExecutionLimitException ex)
+        {
+            Logger.Warning($"Effect limit exceeded on {entry.Owner.ObjectName}->{function}: {ex.Message}", LogCategory.LPC);
+        }
+        catch (Exception ex)
+        {
+            Logger.Error($"Effect error on {entry.Owner.ObjectName}->{function}: {ex.Message}", LogCategory.LPC);
         }
     }
 
@@ -1449,8 +3130,15 @@ public class GameLoop
             session.LastActivity = DateTime.UtcNow;
         }
 
-        // Check rate limiting
-        if (!_rateLimiter.AllowCommand(cmd.ConnectionId))
+        // A line typed at a login prompt that got here before the session went back to one
+        if (LoginWorker.Handles(session.LoginState))
+        {
+            Logins.Enqueue(session, cmd.Input);
+            return;
+        }
+
+        // Check rate limiting (a speedwalk was checked once, as a whole)
+        if (!cmd.SpeedwalkStep && !_rateLimiter.AllowCommand(session.CommandRate))
         {
             SendToPlayer(cmd.ConnectionId, "You are sending commands too quickly. Please slow down.\r\n");
             Logger.Warning($"Rate limited: {cmd.ConnectionId}", LogCategory.Network);
@@ -1466,6 +3154,12 @@ public class GameLoop
 
         // Check for pending input handler (set by input_to)
         var inputHandler = session.PendingInputHandler;
+        if (inputHandler != null && cmd.SpeedwalkStep)
+        {
+            // Something along the way asked a question; stop walking
+            Commands.CancelSpeedwalk(cmd.ConnectionId);
+            return;
+        }
         if (inputHandler != null)
         {
             // Clear the handler before calling it (so it doesn't persist)
@@ -1503,17 +3197,25 @@ public class GameLoop
             return;
         }
 
+        // A speedwalk (".3n2e") runs as steps over this player's next turns
+        var speedwalk = CommandScheduler.ParseSpeedwalk(input);
+        if (speedwalk != null)
+        {
+            Commands.StartSpeedwalk(cmd, speedwalk);
+            return;
+        }
+
         // Split into verb and args
         var spaceIndex = input.IndexOf(' ');
         string verb, args;
         if (spaceIndex >= 0)
         {
-            verb = input[..spaceIndex].ToLowerInvariant();
+            verb = StringPool.Intern(input[..spaceIndex].ToLowerInvariant());
             args = input[(spaceIndex + 1)..];
         }
         else
         {
-            verb = input.ToLowerInvariant();
+            verb = StringPool.Intern(input.ToLowerInvariant());
             args = "";
         }
 
@@ -1579,10 +3281,6 @@ public class GameLoop
         {
             Logger.Warning($"input_to limit exceeded on {handler.Target.ObjectName}->{handler.Function}: {ex.Message}", LogCategory.LPC);
         }
-        catch (ReturnException)
-        {
-            // Normal return from input handler
-        }
         catch (Exception ex)
         {
             Logger.Error($"input_to error on {handler.Target.ObjectName}->{handler.Function}: {ex.Message}", LogCategory.LPC);
@@ -1672,11 +3370,7 @@ public class GameLoop
         }
 
         // Get session for player (needed for alias resolution)
-        PlayerSession? session;
-        lock (_sessionLock)
-        {
-            session = _sessions.Values.FirstOrDefault(s => s.PlayerObject == context.PlayerObject);
-        }
+        var session = context.PlayerObject != null ? FindSessionByPlayerObject(context.PlayerObject) : null;
 
         if (session == null)
         {
@@ -1687,12 +3381,12 @@ public class GameLoop
         string verb, args;
         if (spaceIndex >= 0)
         {
-            verb = input[..spaceIndex].ToLowerInvariant();
+            verb = StringPool.Intern(input[..spaceIndex].ToLowerInvariant());
             args = input[(spaceIndex + 1)..];
         }
         else
         {
-            verb = input.ToLowerInvariant();
+            verb = StringPool.Intern(input.ToLowerInvariant());
             args = "";
         }
 
@@ -1770,22 +3464,9 @@ public class GameLoop
     /// </summary>
     private bool ExecuteCmdFile(PlayerSession session, string verb, string args)
     {
-        // Build list of directories to search based on access level
-        var searchPaths = new List<string>();
-
-        if (session.AccessLevel >= AccessLevel.Admin)
-        {
-            searchPaths.Add($"/cmds/admin/{verb}");
-        }
-        if (session.AccessLevel >= AccessLevel.Wizard)
-        {
-            searchPaths.Add($"/cmds/wizard/{verb}");
-        }
-        searchPaths.Add($"/cmds/std/{verb}");
-
-        // Try each path in order
+        // Try each existing file in tier order; one that fails to load falls through to the next
         MudObject? cmdObj = null;
-        foreach (var path in searchPaths)
+        foreach (var path in CommandResolver.Resolve(verb, session.AccessLevel))
         {
             try
             {
@@ -1815,22 +3496,30 @@ public class GameLoop
             _interpreter?.ResetInstructionCount();
             _interpreter?.CallFunctionOnObject(cmdObj, "main", new List<object> { args });
         }
-        catch (ReturnException)
-        {
-            // Normal return from command
-        }
         catch (ExecutionLimitException ex)
         {
             SendToPlayer(session.ConnectionId, $"EXECUTION ABORTED: {ex.Message}\r\n");
         }
         catch (Exception ex)
         {
-            SendToPlayer(session.ConnectionId, $"Error: {ex.Message}\r\n");
+            SendToPlayer(session.ConnectionId, $"Error: {ex.Message}\r\n{ErrorSourceLine(session, ex)}");
         }
 
         return true;
     }
 
+    /// <summary>
+    /// For wizards, the source line an LPC error points at, read from disk
+    /// (programs don't keep their source). Empty for everyone else.
+    /// </summary>
+    private string ErrorSourceLine(PlayerSession session, Exception ex)
+    {
+        if (session.AccessLevel < AccessLevel.Wizard || ex is not LpcRuntimeException lpc) return "";
+
+        var line = _objectManager.ReadSourceLine(lpc.File, lpc.Line);
+        return line == null ? "" : $"  {lpc.File}:{lpc.Line}: {line}\r\n";
+    }
+
     /// <summary>
     /// Find an action that can override core commands (has OverrideCore flag).
     /// </summary>
@@ -1845,9 +3534,11 @@ public class GameLoop
 
     /// <summary>
     /// Collect all action handlers for a verb from relevant objects.
-    /// Searches: player inventory, room, room contents.
+    /// Searches: player, player inventory, room, room contents. Each
+    /// container indexes its contents' actions by verb, so this costs the
+    /// same however crowded the room is.
     /// </summary>
-    private List<MudObject.ActionEntry> CollectActions(MudObject? player, string verb)
+    internal List<MudObject.ActionEntry> CollectActions(MudObject? player, string verb)
     {
         var actions = new List<MudObject.ActionEntry>();
         if (player == null) return actions;
@@ -1860,15 +3551,7 @@ public class GameLoop
         }
 
         // Check inventory
-        foreach (var item in player.Contents)
-        {
-            if (item.IsDestructed) continue;
-            var action = item.FindAction(verb);
-            if (action != null)
-            {
-                actions.Add(action);
-            }
-        }
+        player.CollectContentActions(verb, null, actions);
 
         // Check room
         var room = player.Environment;
@@ -1881,15 +3564,7 @@ public class GameLoop
             }
 
             // Check room contents (other objects in the room)
-            foreach (var obj in room.Contents)
-            {
-                if (obj == player || obj.IsDestructed) continue;
-                var action = obj.FindAction(verb);
-                if (action != null)
-                {
-                    actions.Add(action);
-                }
-            }
+            room.CollectContentActions(verb, player, actions);
         }
 
         return actions;
@@ -1932,22 +3607,6 @@ public class GameLoop
                 return true;
             }
         }
-        catch (ReturnException ex)
-        {
-            // Check the return value
-            if (ex.Value is int i && i != 0)
-            {
-                return true;
-            }
-            if (ex.Value is long l && l != 0)
-            {
-                return true;
-            }
-            if (ex.Value is bool b && b)
-            {
-                return true;
-            }
-        }
         catch (ExecutionLimitException ex)
         {
             SendToPlayer(session.ConnectionId, $"EXECUTION ABORTED: {ex.Message}\r\n");
@@ -1955,7 +3614,7 @@ public class GameLoop
         }
         catch (Exception ex)
         {
-            SendToPlayer(session.ConnectionId, $"Error in {action.Function}: {ex.Message}\r\n");
+            SendToPlayer(session.ConnectionId, $"Error in {action.Function}: {ex.Message}\r\n{ErrorSourceLine(session, ex)}");
             return true; // Prevent further handlers from running
         }
 
@@ -1973,220 +3632,145 @@ public class GameLoop
     #region Login State Machine
 
     /// <summary>
-    /// Process input during login/registration flow.
+    /// Process input from a session that has authenticated but isn't playing
+    /// yet. The prompts before that are LoginWorker's.
     /// </summary>
     private void ProcessLoginInput(PlayerSession session, string input)
     {
-        input = input.Trim();
-
         switch (session.LoginState)
         {
-            case LoginState.AwaitingName:
-                HandleAwaitingName(session, input);
-                break;
-
-            case LoginState.AwaitingPassword:
-                HandleAwaitingPassword(session, input);
-                break;
-
-            case LoginState.RegistrationName:
-                HandleRegistrationName(session, input);
-                break;
-
-            case LoginState.RegistrationEmail:
-                HandleRegistrationEmail(session, input);
-                break;
-
-            case LoginState.RegistrationPassword:
-                HandleRegistrationPassword(session, input);
-                break;
-
-            case LoginState.RegistrationConfirm:
-                HandleRegistrationConfirm(session, input);
+            case LoginState.ConfirmTakeover:
+                HandleConfirmTakeover(session, input.Trim());
                 break;
 
-            case LoginState.ConfirmTakeover:
-                HandleConfirmTakeover(session, input);
+            case LoginState.Authenticated:
+                // Not yet picked up by RunAuthenticated
+                SendToPlayer(session.ConnectionId, "One moment...\r\n");
                 break;
 
-            default:
-                // Shouldn't happen, but reset to awaiting name
-                session.LoginState = LoginState.AwaitingName;
-                SendToPlayer(session.ConnectionId, "Enter your name, or type 'new': ");
+            case LoginState.Admitting:
+                SendToPlayer(session.ConnectionId, $"You are number {AdmissionPosition(session)} in line to enter the game.\r\n");
                 break;
         }
     }
 
-    private void HandleAwaitingName(PlayerSession session, string input)
+    /// <summary>
+    /// Hand a session the login worker has just authenticated to the game
+    /// thread. Called from the login thread.
+    /// </summary>
+    internal void Authenticated(PlayerSession session)
     {
-        if (string.IsNullOrWhiteSpace(input))
-        {
-            SendToPlayer(session.ConnectionId, "Enter your name, or type 'new': ");
-            return;
-        }
-
-        if (input.Equals("new", StringComparison.OrdinalIgnoreCase))
-        {
-            session.LoginState = LoginState.RegistrationName;
-            SendToPlayer(session.ConnectionId, "\r\nChoose a username (letters only, 3-20 characters): ");
-            return;
-        }
-
-        // Check if account exists
-        if (!_accountManager.AccountExists(input))
-        {
-            SendToPlayer(session.ConnectionId, "Unknown user. Type 'new' to create a new character.\r\n");
-            SendToPlayer(session.ConnectionId, "Enter your name, or type 'new': ");
-            return;
-        }
-
-        session.PendingUsername = input.ToLowerInvariant();
-        session.LoginState = LoginState.AwaitingPassword;
-
-        // Suppress echo for password
-        OnSetEchoMode?.Invoke(session.ConnectionId, false);
-        SendToPlayer(session.ConnectionId, "Password: ");
+        _authenticated.Enqueue(session);
     }
 
-    private void HandleAwaitingPassword(PlayerSession session, string input)
+    /// <summary>
+    /// Take over sessions authenticated since the last tick: reconnect them to
+    /// a linkdead player, ask about taking over one still connected, or queue
+    /// them to enter the game. Game thread, at the start of the command phase.
+    /// </summary>
+    private void RunAuthenticated()
     {
-        // Restore echo
-        OnSetEchoMode?.Invoke(session.ConnectionId, true);
-        SendToPlayer(session.ConnectionId, "\r\n");
-
-        // Check for login lockout
-        if (_rateLimiter.IsLoginLockedOut(session.ConnectionId))
-        {
-            var remaining = _rateLimiter.GetLoginLockoutRemaining(session.ConnectionId);
-            SendToPlayer(session.ConnectionId, $"Too many failed login attempts. Please wait {remaining} seconds.\r\n\r\n");
-            session.PendingUsername = null;
-            session.LoginState = LoginState.AwaitingName;
-            SendToPlayer(session.ConnectionId, "Enter your name, or type 'new': ");
-            return;
-        }
-
-        if (_accountManager.ValidateCredentials(session.PendingUsername!, input))
+        while (_authenticated.TryDequeue(out var session))
         {
-            session.AuthenticatedUsername = session.PendingUsername;
-            _accountManager.UpdateLastLogin(session.AuthenticatedUsername!);
-
-            // Clear login attempts on success
-            _rateLimiter.ClearLoginAttempts(session.ConnectionId);
+            // The connection may have closed in the meantime
+            if (GetSession(session.ConnectionId) != session || session.LoginState != LoginState.Authenticated)
+            {
+                continue;
+            }
 
             // Check for existing session before completing login
             if (CheckAndPromptForExistingSession(session))
             {
                 // Duplicate exists, waiting for confirmation
-                return;
+                continue;
             }
 
-            CompleteLogin(session);
-        }
-        else
-        {
-            // Record failed attempt
-            _rateLimiter.RecordLoginAttempt(session.ConnectionId);
-
-            SendToPlayer(session.ConnectionId, "Invalid password.\r\n\r\n");
-            session.PendingUsername = null;
-            session.LoginState = LoginState.AwaitingName;
-            SendToPlayer(session.ConnectionId, "Enter your name, or type 'new': ");
+            AdmitLogin(session);
         }
     }
 
-    private void HandleRegistrationName(PlayerSession session, string input)
+    /// <summary>
+    /// Queue an authenticated session to enter the game. At most
+    /// MaxLoginsPerTick enter each tick, at the end of the command phase;
+    /// anyone further back is told their place in line, and their save file
+    /// is read and decoded on the pool while they wait.
+    /// </summary>
+    private void AdmitLogin(PlayerSession session)
     {
-        if (!IsValidUsername(input))
-        {
-            SendToPlayer(session.ConnectionId, "Invalid username. Use 3-20 letters only.\r\n");
-            SendToPlayer(session.ConnectionId, "Choose a username: ");
-            return;
-        }
-
-        // "new" is reserved for the registration command
-        if (input.Equals("new", StringComparison.OrdinalIgnoreCase))
-        {
-            SendToPlayer(session.ConnectionId, "That name is reserved.\r\n");
-            SendToPlayer(session.ConnectionId, "Choose a username: ");
-            return;
-        }
+        session.LoginState = LoginState.Admitting;
+        _admissions.Enqueue(session);
 
-        if (_accountManager.AccountExists(input))
+        int position = _admissions.Count;
+        if (position > MaxLoginsPerTick)
         {
-            SendToPlayer(session.ConnectionId, "That name is already taken.\r\n");
-            SendToPlayer(session.ConnectionId, "Choose a username: ");
-            return;
+            SendToPlayer(session.ConnectionId, $"The game is busy. You are number {position} in line to enter.\r\n");
+            if (SaveFilePath(session) is { } saveFile)
+            {
+                _objectManager.Restores.Prefetch(saveFile);
+            }
         }
-
-        session.PendingUsername = input.ToLowerInvariant();
-        session.LoginState = LoginState.RegistrationEmail;
-        SendToPlayer(session.ConnectionId, "Enter your email address: ");
     }
 
-    private void HandleRegistrationEmail(PlayerSession session, string input)
+    /// <summary>
+    /// Let queued sessions into the game until MaxLoginsPerTick have entered
+    /// this tick. Game thread, at the start and end of the command phase.
+    /// </summary>
+    private void RunAdmissions()
     {
-        // Basic email validation
-        if (string.IsNullOrWhiteSpace(input) || !input.Contains('@'))
+        while (_admittedThisTick < MaxLoginsPerTick && _admissions.TryDequeue(out var session))
         {
-            SendToPlayer(session.ConnectionId, "Please enter a valid email address: ");
-            return;
+            // The connection may have closed while it waited
+            if (GetSession(session.ConnectionId) != session || session.LoginState != LoginState.Admitting)
+            {
+                if (SaveFilePath(session) is { } saveFile)
+                {
+                    _objectManager.Restores.Invalidate(saveFile);
+                }
+                continue;
+            }
+            CompleteLogin(session);
+            _admittedThisTick++;
         }
-
-        session.PendingEmail = input;
-        session.LoginState = LoginState.RegistrationPassword;
-
-        OnSetEchoMode?.Invoke(session.ConnectionId, false);
-        SendToPlayer(session.ConnectionId, "Choose a password (8+ characters): ");
     }
 
-    private void HandleRegistrationPassword(PlayerSession session, string input)
+    /// <summary>
+    /// Now and then, tell sessions still in the login queue where they are in line.
+    /// </summary>
+    private void NotifyAdmissionQueue()
     {
-        if (input.Length < 8)
+        if (_admissions.Count > 0 && ++_admissionPasses % AdmissionNoticeTicks == 0)
         {
-            SendToPlayer(session.ConnectionId, "\r\nPassword must be at least 8 characters.\r\n");
-            SendToPlayer(session.ConnectionId, "Choose a password: ");
-            return;
+            int position = 0;
+            foreach (var waiting in _admissions)
+            {
+                position++;
+                if (waiting.LoginState == LoginState.Admitting)
+                {
+                    SendToPlayer(waiting.ConnectionId, $"You are number {position} in line to enter the game.\r\n");
+                }
+            }
         }
-
-        session.PendingPassword = input;
-        session.LoginState = LoginState.RegistrationConfirm;
-        SendToPlayer(session.ConnectionId, "\r\nConfirm password: ");
     }
 
-    private void HandleRegistrationConfirm(PlayerSession session, string input)
+    private int AdmissionPosition(PlayerSession session)
     {
-        OnSetEchoMode?.Invoke(session.ConnectionId, true);
-        SendToPlayer(session.ConnectionId, "\r\n");
-
-        if (input != session.PendingPassword)
-        {
-            SendToPlayer(session.ConnectionId, "Passwords do not match. Let's try again.\r\n\r\n");
-            session.PendingPassword = null;
-            session.LoginState = LoginState.RegistrationPassword;
-            OnSetEchoMode?.Invoke(session.ConnectionId, false);
-            SendToPlayer(session.ConnectionId, "Choose a password (8+ characters): ");
-            return;
-        }
-
-        // Create the account
-        if (_accountManager.CreateAccount(session.PendingUsername!, session.PendingEmail!, session.PendingPassword!))
-        {
-            // Clear sensitive data
-            session.PendingPassword = null;
-
-            SendToPlayer(session.ConnectionId, "\r\nAccount created successfully!\r\n\r\n");
-            session.AuthenticatedUsername = session.PendingUsername;
-            CompleteLogin(session);
-        }
-        else
+        int position = 0;
+        foreach (var waiting in _admissions)
         {
-            session.PendingPassword = null;
-            SendToPlayer(session.ConnectionId, "Failed to create account. Please try again.\r\n\r\n");
-            session.LoginState = LoginState.AwaitingName;
-            SendToPlayer(session.ConnectionId, "Enter your name, or type 'new': ");
+            position++;
+            if (waiting == session) return position;
         }
+        return position;
     }
 
+    /// <summary>
+    /// Full path of the save file /std/player restores for this session's user.
+    /// </summary>
+    private string? SaveFilePath(PlayerSession session) =>
+        session.AuthenticatedUsername is { } username
+            ? _objectManager.Files.Resolve(PlayerSaveDirectory + username.ToLowerInvariant() + ".o")
+            : null;
+
     /// <summary>
     /// Complete the login process and enter the game.
     /// Duplicate session handling should be done BEFORE calling this method.
@@ -2205,8 +3789,13 @@ public class GameLoop
 
             // Clone a player object (outside lock - object creation doesn't need login serialization)
             var playerObject = _objectManager.CloneObject("/std/player");
-            playerObject.IsInteractive = true;
-            playerObject.ConnectionId = session.ConnectionId;
+            _objectManager.SetInteractive(playerObject, true);
+            // Named for find_player() and the name index, unless create() chose a name
+            if (playerObject.LivingName == null)
+            {
+                _objectManager.SetLivingName(playerObject, session.AuthenticatedUsername!.ToLowerInvariant());
+            }
+            playerObject.BindSession(session);
 
             // Critical section: atomically check for duplicate and mark as Playing
             // This lock is MINIMAL - only covers the state transition
@@ -2218,7 +3807,7 @@ public class GameLoop
                 {
                     // Rare race condition: another session completed login while we were setting up
                     // Clean up our player object and abort
-                    playerObject.IsInteractive = false;
+                    _objectManager.SetInteractive(playerObject, false);
                     _objectManager.DestructObject(playerObject);
                     SendToPlayer(session.ConnectionId, "Another session has connected. Please try again.\r\n");
                     OnPlayerDisconnect?.Invoke(session.ConnectionId);
@@ -2229,6 +3818,7 @@ public class GameLoop
                 session.PlayerObject = playerObject;
                 session.LoginState = LoginState.Playing;
             }
+            Recorder?.Login(session.ConnectionId, session.AuthenticatedUsername!);
             // Lock released - all remaining operations are safe without synchronization
 
             // Set player name
@@ -2246,10 +3836,6 @@ public class GameLoop
                     _interpreter.ResetInstructionCount();
                     _interpreter.CallFunctionOnObject(playerObject, "restore_player", new List<object>());
                 }
-                catch (ReturnException)
-                {
-                    // Normal return
-                }
                 catch (Exception ex)
                 {
                     Logger.Warning($"Could not restore player data: {ex.Message}", LogCategory.Player);
@@ -2275,6 +3861,12 @@ public class GameLoop
                 }
             }
 
+            // A player handed over from another cluster node arrives in the room they walked into
+            if (session.ArrivalRoom != null)
+            {
+                savedLocation = session.ArrivalRoom;
+            }
+
             // Try to load saved location first
             if (!string.IsNullOrEmpty(savedLocation))
             {
@@ -2314,10 +3906,18 @@ public class GameLoop
                 AccessLevel.Wizard => " [Wizard]",
                 _ => ""
             };
-            SendToPlayer(session.ConnectionId, $"Welcome, {Capitalize(session.AuthenticatedUsername!)}{accessMsg}!\r\n\r\n");
+            if (session.ArrivalRoom != null)
+            {
+                AnnounceToRoom(playerObject, $"{GetPlayerName(playerObject, session.AuthenticatedUsername)} arrives.\r\n");
+            }
+            else
+            {
+                SendToPlayer(session.ConnectionId, $"Welcome, {Capitalize(session.AuthenticatedUsername!)}{accessMsg}!\r\n\r\n");
+            }
 
             // Execute look command to show the room
             ExecuteLookForPlayer(session);
+            EmitLogin(session);
 
             SendPrompt(session.ConnectionId);
 
@@ -2331,6 +3931,18 @@ public class GameLoop
         }
     }
 
+    /// <summary>
+    /// Emit the "login" event from a player now in the world (logout is
+    /// emitted by ObjectManager.SetInteractive).
+    /// </summary>
+    private void EmitLogin(PlayerSession session)
+    {
+        if (_interpreter == null || session.PlayerObject == null) return;
+
+        _interpreter.ResetInstructionCount();
+        _interpreter.EmitEvent(session.PlayerObject, "login");
+    }
+
     /// <summary>
     /// Execute the look command for a player who just logged in.
     /// </summary>
@@ -2353,13 +3965,6 @@ public class GameLoop
         });
     }
 
-    private static bool IsValidUsername(string name)
-    {
-        if (string.IsNullOrWhiteSpace(name)) return false;
-        if (name.Length < 3 || name.Length > 20) return false;
-        return name.All(char.IsLetter);
-    }
-
     private static string Capitalize(string s)
     {
         if (string.IsNullOrEmpty(s)) return s;
@@ -0,0 +1,120 @@
+using System.Buffers;
+using System.Text;
+using System.Text.Json;
+
+namespace Driver;
+
+/// <summary>
+/// GMCP (Generic Mud Communication Protocol, telnet option 201): structured
+/// data sent alongside the text stream, so a client can drive its HP bars
+/// and maps from messages instead of scraping command output.
+///
+/// A message is a package name, a space and a JSON value, carried in
+/// IAC SB GMCP ... IAC SE. The server offers GMCP on connect; once the
+/// client answers DO, send_gmcp() reaches it. Messages from the client
+/// (Core.Hello, Core.Supports.Set) are accepted and ignored.
+/// </summary>
+public static class Gmcp
+{
+    public const byte Option = 201;
+
+    /// <summary>
+    /// Longest package name accepted.
+    /// </summary>
+    public const int MaxPackageLength = 64;
+
+    /// <summary>
+    /// Whether package is a dotted name like "Char.Vitals".
+    /// </summary>
+    public static bool IsPackageName(string package)
+    {
+        if (package.Length == 0 || package.Length > MaxPackageLength) return false;
+        foreach (var c in package)
+        {
+            if (!char.IsAsciiLetterOrDigit(c) && c != '.' && c != '_' && c != '-') return false;
+        }
+        return package[0] != '.' && package[^1] != '.';
+    }
+
+    /// <summary>
+    /// The message text for package with data as its JSON body, or just the
+    /// package name when data is null.
+    /// </summary>
+    public static string Encode(string package, object? data)
+    {
+        if (data == null) return package;
+
+        var buffer = new ArrayBufferWriter<byte>();
+        using (var writer = new Utf8JsonWriter(buffer))
+        {
+            WriteJson(writer, data);
+        }
+        return package + " " + Encoding.UTF8.GetString(buffer.WrittenSpan);
+    }
+
+    /// <summary>
+    /// An LPC value as JSON: mappings become objects (keys as strings),
+    /// arrays arrays, objects their names.
+    /// </summary>
+    private static void WriteJson(Utf8JsonWriter writer, object? value)
+    {
+        switch (value)
+        {
+            case null:
+                writer.WriteNullValue();
+                break;
+            case long l:
+                writer.WriteNumberValue(l);
+                break;
+            case int i:
+                writer.WriteNumberValue(i);
+                break;
+            case string s:
+                writer.WriteStringValue(s);
+                break;
+            case List<object> array:
+                writer.WriteStartArray();
+                foreach (var item in array)
+                {
+                    WriteJson(writer, item);
+                }
+                writer.WriteEndArray();
+                break;
+            case Dictionary<object, object> map:
+                writer.WriteStartObject();
+                foreach (var (key, item) in map)
+                {
+                    writer.WritePropertyName(key is MudObject keyObject ? keyObject.ObjectName : key.ToString() ?? "");
+                    WriteJson(writer, item);
+                }
+                writer.WriteEndObject();
+                break;
+            case MudObject obj:
+                writer.WriteStringValue(obj.ObjectName);
+                break;
+            default:
+                writer.WriteStringValue(value.ToString());
+                break;
+        }
+    }
+
+    /// <summary>
+    /// The subnegotiation carrying message: IAC SB GMCP, the UTF-8 text with
+    /// any 255 byte doubled, IAC SE.
+    /// </summary>
+    public static byte[] Frame(string message)
+    {
+        const byte IAC = 255, SB = 250, SE = 240;
+
+        var text = Encoding.UTF8.GetBytes(message);
+        var frame = new List<byte>(text.Length + 5) { IAC, SB, Option };
+        foreach (var b in text)
+        {
+            frame.Add(b);
+            if (b == IAC) frame.Add(IAC);
+        }
+        frame.Add(IAC);
+        frame.Add(SE);
+        return frame.ToArray();
+    }
+}
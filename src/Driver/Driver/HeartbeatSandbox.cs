@@ -0,0 +1,168 @@
+namespace Driver;
+
+/// <summary>
+/// Runs one heart_beat() speculatively off the game thread, confined to its
+/// own object.
+///
+/// Inside the sandbox a heart_beat may read and write its object's variables,
+/// call its own functions and use efuns that only compute. Messages it sends
+/// (tell_object, tell_room, write, say, send_gmcp, logging) are recorded instead of
+/// sent, and the game thread replays them afterwards in heartbeat order.
+///
+/// Anything that touches the rest of the world aborts the speculation: a call
+/// into another object, a move, a clone, an in-place array or mapping change,
+/// or any efun not listed here, as does a runtime error. The object's
+/// variables are put back as they were, its recorded messages are dropped, and
+/// the heartbeat is run again on the game thread the normal way.
+/// </summary>
+public sealed class HeartbeatSandbox
+{
+    /// <summary>
+    /// Efuns a sandboxed heart_beat() may run directly. The inventory and
+    /// environment readers are safe because nothing moves while the
+    /// sandboxes run.
+    /// </summary>
+    private static readonly HashSet<string> AllowedEfuns = new()
+    {
+        "typeof", "strlen", "sizeof", "to_string", "to_int", "this_player", "random", "abs", "min", "max", "sum",
+        "member_array", "sprintf", "explode", "implode", "lower_case", "upper_case", "capitalize", "time",
+        "ctime", "localtime", "regexp", "regmatch", "regexplode", "sort_array", "unique_array", "m_indices",
+        "m_values", "mkmapping", "keys", "values", "strsrch", "member", "intp", "stringp", "objectp",
+        "pointerp", "arrayp", "mappingp", "allocate", "copy", "replace_string", "trim", "this_object",
+        "call_other", "call_other_many", "map_call", "filter_array", "map_array", "throw", "previous_object", "query_dormant_elapsed",
+        "environment", "all_inventory", "all_livings", "all_interactive", "first_inventory", "next_inventory",
+        "present", "object_name", "file_name", "living", "interactive", "has_gmcp", "clonep", "query_heart_beat", "inherits",
+        "query_attacking", "query_attackers", "hostile_in_room", "find_path", "rooms_within",
+        "description_changed"
+    };
+
+    /// <summary>
+    /// Efuns whose only effect is output; recorded and replayed later.
+    /// </summary>
+    private static readonly HashSet<string> DeferredEfuns = new()
+    {
+        "tell_object", "tell_room", "tell_room_tmpl", "write", "say", "log_console", "syslog", "send_gmcp"
+    };
+
+    private readonly List<(Func<List<object>, object> Efun, List<object> Args)> _effects = new();
+    private LpcValue[] _snapshot = Array.Empty<LpcValue>();
+
+    /// <summary>
+    /// The object whose heart_beat() is running.
+    /// </summary>
+    public MudObject Owner { get; private set; } = null!;
+
+    /// <summary>
+    /// Why the speculation was abandoned, or null while it still holds.
+    /// </summary>
+    public string? AbortReason { get; private set; }
+
+    /// <summary>
+    /// Number of recorded effects waiting to be replayed.
+    /// </summary>
+    public int EffectCount => _effects.Count;
+
+    /// <summary>
+    /// Start speculating on owner: remember its variables.
+    /// </summary>
+    public void Begin(MudObject owner)
+    {
+        Owner = owner;
+        AbortReason = null;
+        _effects.Clear();
+        _snapshot = owner.SnapshotVariables(_snapshot);
+    }
+
+    /// <summary>
+    /// Give up (the first reason sticks, in case LPC catches the unwinding).
+    /// Returns the exception that unwinds the heart_beat().
+    /// </summary>
+    internal SandboxAbortException Abort(string reason)
+    {
+        AbortReason ??= reason;
+        return new SandboxAbortException(AbortReason);
+    }
+
+    /// <summary>
+    /// Finish the speculation. If it was abandoned, put the owner's variables
+    /// back, forget its effects and return false.
+    /// </summary>
+    public bool End()
+    {
+        if (AbortReason == null) return true;
+
+        Owner.RestoreVariables(_snapshot);
+        _effects.Clear();
+        return false;
+    }
+
+    /// <summary>
+    /// Let an efun call through (true), or record it for later (false, with
+    /// its arguments copied). Throws for anything else.
+    /// </summary>
+    internal bool AllowEfun(string name, Func<List<object>, object> efun, List<object> args)
+    {
+        if (AbortReason != null) throw Abort(AbortReason);
+        if (AllowedEfuns.Contains(name)) return true;
+
+        if (DeferredEfuns.Contains(name))
+        {
+            _effects.Add((efun, new List<object>(args)));
+            return false;
+        }
+        throw Abort($"{name}()");
+    }
+
+    /// <summary>
+    /// Check a call into target, which must be the owner.
+    /// </summary>
+    internal void CheckCall(MudObject target)
+    {
+        if (AbortReason != null) throw Abort(AbortReason);
+        if (target != Owner) throw Abort($"call into {target.ObjectName}");
+    }
+
+    /// <summary>
+    /// Arrays and mappings may be shared with other objects, so changing one
+    /// in place ends the speculation. Returns the exception to throw.
+    /// </summary>
+    internal SandboxAbortException AbortMutation()
+    {
+        return Abort("array or mapping assignment");
+    }
+
+    /// <summary>
+    /// Replay the recorded effects, in the order they were made, each as
+    /// called by the owner (syslog() names it, for one). Game thread only.
+    /// Returns how many of them failed.
+    /// </summary>
+    public int ApplyEffects(ObjectInterpreter interpreter)
+    {
+        int failed = 0;
+        foreach (var (efun, args) in _effects)
+        {
+            try
+            {
+                interpreter.CallEfunAs(Owner, efun, args);
+            }
+            catch (Exception ex)
+            {
+                Logger.Warning($"Heartbeat effect failed on {Owner.ObjectName}: {ex.Message}", LogCategory.LPC);
+                failed++;
+            }
+        }
+        _effects.Clear();
+        return failed;
+    }
+}
+
+/// <summary>
+/// Unwinds a sandboxed heart_beat() that reached outside its object. catch()
+/// doesn't stop it.
+/// </summary>
+public class SandboxAbortException : Exception
+{
+    public SandboxAbortException(string reason) : base($"Heartbeat left its sandbox: {reason}")
+    {
+    }
+}
@@ -0,0 +1,216 @@
+namespace Driver;
+
+/// <summary>
+/// The mudlib's help files, held in memory.
+///
+/// help used to list /help/topics and /help/commands with get_dir() and then
+/// try up to three read_file()s per lookup, each a path resolution, access
+/// check and disk read. The index reads /help/commands, /help/topics and the
+/// files directly in /help once, and answers lookups, listings and searches
+/// from memory.
+///
+/// A FileSystemWatcher on /help marks the index stale; once the directory
+/// has been quiet for QuietPeriod the whole index is read again on a timer
+/// thread and swapped in. Readers always see one complete index, never a
+/// half-built one, and take no locks.
+///
+/// Search finds topics whose name starts with a word, then topics whose text
+/// contains it as a word, through a word-to-topics table built with the
+/// index.
+/// </summary>
+public sealed class HelpIndex : IDisposable
+{
+    /// <summary>
+    /// Sections in lookup order. "" is /help itself.
+    /// </summary>
+    public static readonly string[] Sections = { "commands", "topics", "" };
+
+    /// <summary>
+    /// Shortest word the keyword table keeps.
+    /// </summary>
+    private const int MinKeywordLength = 3;
+
+    private sealed class Index
+    {
+        public readonly Dictionary<string, Dictionary<string, string>> Sections = new();
+        public readonly Dictionary<string, SortedSet<string>> Keywords = new();
+        public readonly SortedSet<string> Names = new(StringComparer.Ordinal);
+    }
+
+    private readonly string _helpPath;
+    private volatile Index _index;
+    private readonly FileSystemWatcher? _watcher;
+    private readonly Timer? _timer;
+    private long _changedAt;
+
+    /// <summary>
+    /// How long /help must go without changes before it is read again.
+    /// </summary>
+    public TimeSpan QuietPeriod { get; }
+
+    /// <param name="watch">Rebuild when files under /help change</param>
+    public HelpIndex(string mudlibPath, bool watch = true, TimeSpan? quietPeriod = null)
+    {
+        _helpPath = Path.Combine(mudlibPath, "help");
+        QuietPeriod = quietPeriod ?? TimeSpan.FromMilliseconds(250);
+        _index = Build();
+
+        if (watch && Directory.Exists(_helpPath))
+        {
+            _watcher = new FileSystemWatcher(_helpPath)
+            {
+                IncludeSubdirectories = true,
+                NotifyFilter = NotifyFilters.LastWrite | NotifyFilters.FileName | NotifyFilters.DirectoryName | NotifyFilters.Size
+            };
+            _watcher.Changed += (_, _) => Touch();
+            _watcher.Created += (_, _) => Touch();
+            _watcher.Deleted += (_, _) => Touch();
+            _watcher.Renamed += (_, _) => Touch();
+
+            var interval = QuietPeriod / 2;
+            _timer = new Timer(_ => RebuildIfQuiet(), null, interval, interval);
+            _watcher.EnableRaisingEvents = true;
+        }
+    }
+
+    /// <summary>
+    /// The text of a topic, looked for in commands, then topics, then /help
+    /// itself; null if there is none.
+    /// </summary>
+    public string? Lookup(string topic)
+    {
+        var index = _index;
+        topic = topic.ToLowerInvariant();
+        foreach (var section in Sections)
+        {
+            if (index.Sections.TryGetValue(section, out var files) && files.TryGetValue(topic, out var text))
+            {
+                return text;
+            }
+        }
+        return null;
+    }
+
+    /// <summary>
+    /// The topics in a section, sorted; empty for an unknown section.
+    /// </summary>
+    public List<string> List(string section)
+    {
+        return _index.Sections.TryGetValue(section, out var files)
+            ? files.Keys.Order(StringComparer.Ordinal).ToList()
+            : new List<string>();
+    }
+
+    /// <summary>
+    /// Topics whose name starts with word, then those whose text contains
+    /// it, each group sorted and no topic twice.
+    /// </summary>
+    public List<string> Search(string word)
+    {
+        var index = _index;
+        word = word.Trim().ToLowerInvariant();
+        var results = new List<string>();
+        if (word.Length == 0) return results;
+
+        foreach (var name in index.Names.GetViewBetween(word, word + char.MaxValue))
+        {
+            results.Add(name);
+        }
+        if (index.Keywords.TryGetValue(word, out var topics))
+        {
+            foreach (var name in topics)
+            {
+                if (!name.StartsWith(word, StringComparison.Ordinal)) results.Add(name);
+            }
+        }
+        return results;
+    }
+
+    /// <summary>
+    /// Read /help again now.
+    /// </summary>
+    public void Rebuild()
+    {
+        _index = Build();
+    }
+
+    private void Touch()
+    {
+        Interlocked.Exchange(ref _changedAt, Environment.TickCount64);
+    }
+
+    private void RebuildIfQuiet()
+    {
+        long changedAt = Interlocked.Read(ref _changedAt);
+        if (changedAt == 0 || Environment.TickCount64 - changedAt < QuietPeriod.TotalMilliseconds) return;
+
+        // A change arriving during the rebuild leaves _changedAt set for the next pass
+        if (Interlocked.CompareExchange(ref _changedAt, 0, changedAt) != changedAt) return;
+        try
+        {
+            Rebuild();
+        }
+        catch (IOException ex)
+        {
+            Logger.Warning($"Help index rebuild failed: {ex.Message}", LogCategory.System);
+            Touch();
+        }
+    }
+
+    private Index Build()
+    {
+        var index = new Index();
+        foreach (var section in Sections)
+        {
+            var directory = section.Length == 0 ? _helpPath : Path.Combine(_helpPath, section);
+            var files = new Dictionary<string, string>();
+            index.Sections[section] = files;
+            if (!Directory.Exists(directory)) continue;
+
+            foreach (var path in Directory.EnumerateFiles(directory))
+            {
+                var name = Path.GetFileName(path).ToLowerInvariant();
+                if (name.StartsWith('.')) continue;
+
+                var text = File.ReadAllText(path);
+                files[name] = text;
+                index.Names.Add(name);
+                AddKeywords(index, name, text);
+            }
+        }
+        return index;
+    }
+
+    private static void AddKeywords(Index index, string name, string text)
+    {
+        int start = -1;
+        for (int i = 0; i <= text.Length; i++)
+        {
+            bool letter = i < text.Length && char.IsAsciiLetter(text[i]);
+            if (letter && start < 0)
+            {
+                start = i;
+            }
+            else if (!letter && start >= 0)
+            {
+                if (i - start >= MinKeywordLength)
+                {
+                    var word = text[start..i].ToLowerInvariant();
+                    if (!index.Keywords.TryGetValue(word, out var topics))
+                    {
+                        topics = new SortedSet<string>(StringComparer.Ordinal);
+                        index.Keywords[word] = topics;
+                    }
+                    topics.Add(name);
+                }
+                start = -1;
+            }
+        }
+    }
+
+    public void Dispose()
+    {
+        _watcher?.Dispose();
+        _timer?.Dispose();
+    }
+}
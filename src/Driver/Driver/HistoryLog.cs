@@ -0,0 +1,154 @@
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// A bounded, named history (a chat channel's last hundred lines, say),
+/// behind the history_* efuns.
+///
+/// Entries live in a ring buffer, so adding one is O(1) however full it is:
+/// the oldest entry is overwritten in place. With a file attached, each entry
+/// is also appended to it as one line of save-file text. The file grows until
+/// it holds twice the capacity, then a snapshot of the ring is queued to
+/// replace it; both go through the shared AsyncFileWriter, so the game thread
+/// never waits on the disk and the compaction lands in order with the appends
+/// around it.
+/// </summary>
+public sealed class HistoryLog
+{
+    private readonly object _lock = new();
+    private object[] _items;
+    private int _start;
+    private int _count;
+    private string? _fullPath;
+    private int _fileLines;
+
+    public HistoryLog(int capacity)
+    {
+        _items = new object[Math.Max(1, capacity)];
+    }
+
+    public int Capacity => _items.Length;
+
+    public int Count
+    {
+        get { lock (_lock) return _count; }
+    }
+
+    /// <summary>
+    /// The file this history is kept in, if any.
+    /// </summary>
+    public string? FullPath
+    {
+        get { lock (_lock) return _fullPath; }
+    }
+
+    /// <summary>
+    /// Change how many entries are kept, dropping the oldest if it shrinks.
+    /// </summary>
+    public void Resize(int capacity)
+    {
+        lock (_lock)
+        {
+            capacity = Math.Max(1, capacity);
+            if (capacity == _items.Length) return;
+
+            var kept = Snapshot(Math.Min(_count, capacity));
+            _items = new object[capacity];
+            kept.CopyTo(_items, 0);
+            _start = 0;
+            _count = kept.Count;
+        }
+    }
+
+    /// <summary>
+    /// Keep this history in fullPath, loading the entries already there (the
+    /// newest Capacity of them). Lines that aren't save-file values are read
+    /// as plain strings.
+    /// </summary>
+    public void Attach(string fullPath)
+    {
+        AsyncFileWriter.Shared.Settle(fullPath);
+        var lines = File.Exists(fullPath) ? File.ReadAllLines(fullPath) : Array.Empty<string>();
+
+        lock (_lock)
+        {
+            _fullPath = fullPath;
+            _start = 0;
+            _count = 0;
+            Array.Clear(_items);
+            foreach (var line in lines.Where(l => l.Length > 0).TakeLast(_items.Length))
+            {
+                Push(line[0] is '"' or '(' || long.TryParse(line, out _) ? SaveFormat.ParseValue(line) : line);
+            }
+            _fileLines = lines.Length;
+        }
+    }
+
+    /// <summary>
+    /// Add an entry, evicting the oldest if full, and log it.
+    /// </summary>
+    public void Add(object value)
+    {
+        lock (_lock)
+        {
+            Push(value);
+            if (_fullPath == null) return;
+
+            var sb = new StringBuilder();
+            if (++_fileLines > 2 * _items.Length)
+            {
+                // Compact: rewrite the file as just what the ring holds
+                foreach (var item in Snapshot(_count))
+                {
+                    SaveFormat.WriteValue(sb, item);
+                    sb.Append('\n');
+                }
+                AsyncFileWriter.Shared.Write(_fullPath, sb.ToString(), append: false);
+                _fileLines = _count;
+            }
+            else
+            {
+                SaveFormat.WriteValue(sb, value);
+                sb.Append('\n');
+                AsyncFileWriter.Shared.Write(_fullPath, sb.ToString(), append: true);
+            }
+        }
+    }
+
+    /// <summary>
+    /// The newest count entries (all of them if count is 0 or more than
+    /// there are), oldest first.
+    /// </summary>
+    public List<object> GetLast(int count)
+    {
+        lock (_lock)
+        {
+            return Snapshot(count <= 0 ? _count : Math.Min(count, _count));
+        }
+    }
+
+    private void Push(object value)
+    {
+        if (_count < _items.Length)
+        {
+            _items[(_start + _count) % _items.Length] = value;
+            _count++;
+        }
+        else
+        {
+            _items[_start] = value;
+            _start = (_start + 1) % _items.Length;
+        }
+    }
+
+    private List<object> Snapshot(int count)
+    {
+        var result = new List<object>(count);
+        for (int i = _count - count; i < _count; i++)
+        {
+            result.Add(_items[(_start + i) % _items.Length]);
+        }
+        return result;
+    }
+}
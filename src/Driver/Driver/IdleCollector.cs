@@ -0,0 +1,131 @@
+using System.Runtime;
+
+namespace Driver;
+
+/// <summary>
+/// GC-aware tick scheduling (--gc-idle): keep collections out of the tick
+/// body and run them in the sleep between ticks.
+///
+/// While the game loop runs, the GC is in SustainedLowLatency mode, so gen2
+/// is collected in the background instead of in a blocking pause unless
+/// memory is short. After each tick the collector learns how much the
+/// process allocates per tick and between gen0 collections. When the next
+/// tick would probably run past the gen0 budget, gen0 and gen1 are collected
+/// now, in the idle time, and the tick starts with an empty nursery. When the
+/// heap has grown by half since the last full collection, a background gen2
+/// is started in idle time too, before the GC would start one mid-tick.
+///
+/// No-GC regions aren't used: entering one collects the whole heap, blocking,
+/// every time, which costs more than the pauses it would save.
+/// </summary>
+public sealed class IdleCollector
+{
+    /// <summary>
+    /// Idle time under which nothing is collected.
+    /// </summary>
+    public TimeSpan MinIdle { get; set; } = TimeSpan.FromMilliseconds(10);
+
+    /// <summary>
+    /// Heap growth since the last full collection that starts a background gen2.
+    /// </summary>
+    public double Gen2Growth { get; set; } = 1.5;
+
+    /// <summary>
+    /// Collections run in idle time: gen0/gen1, and background gen2s started.
+    /// </summary>
+    public long EphemeralCollections { get; private set; }
+    public long Gen2Collections { get; private set; }
+
+    /// <summary>
+    /// Bytes allocated per tick and between gen0 collections, smoothed; 0 until seen.
+    /// </summary>
+    public double BytesPerTick { get; private set; }
+    public double Gen0Budget { get; private set; }
+
+    private GCLatencyMode _previousMode;
+    private long _lastAllocated = -1;
+    private long _allocatedAtGc;
+    private int _gen0Count;
+    private DateTime _lastGen2 = DateTime.MinValue;
+
+    /// <summary>
+    /// Switch the GC to SustainedLowLatency. Called when the game loop starts.
+    /// </summary>
+    public void Enable()
+    {
+        _previousMode = GCSettings.LatencyMode;
+        GCSettings.LatencyMode = GCLatencyMode.SustainedLowLatency;
+        _gen0Count = GC.CollectionCount(0);
+        _allocatedAtGc = GC.GetTotalAllocatedBytes();
+    }
+
+    /// <summary>
+    /// Put the GC back as it was. Called when the game loop stops.
+    /// </summary>
+    public void Disable()
+    {
+        GCSettings.LatencyMode = _previousMode;
+    }
+
+    /// <summary>
+    /// Learn from the tick that just ended. Allocation is process-wide, as the
+    /// GC's budget is.
+    /// </summary>
+    public void AfterTick()
+    {
+        long allocated = GC.GetTotalAllocatedBytes();
+        if (_lastAllocated >= 0)
+        {
+            BytesPerTick = Smooth(BytesPerTick, allocated - _lastAllocated);
+        }
+        _lastAllocated = allocated;
+        ObserveGen0(allocated);
+    }
+
+    /// <summary>
+    /// Spend up to idle collecting what the next tick would otherwise collect.
+    /// Returns whether anything was collected.
+    /// </summary>
+    public bool Idle(TimeSpan idle)
+    {
+        if (idle < MinIdle) return false;
+
+        long allocated = GC.GetTotalAllocatedBytes();
+        if (Gen0Budget > 0 && allocated - _allocatedAtGc + 2 * BytesPerTick >= Gen0Budget)
+        {
+            GC.Collect(1, GCCollectionMode.Forced, blocking: true, compacting: false);
+            EphemeralCollections++;
+
+            // An early collection says nothing about the budget
+            _gen0Count = GC.CollectionCount(0);
+            _allocatedAtGc = GC.GetTotalAllocatedBytes();
+            return true;
+        }
+
+        var background = GC.GetGCMemoryInfo(GCKind.Background);
+        var blocking = GC.GetGCMemoryInfo(GCKind.FullBlocking);
+        long afterGen2 = (background.Index > blocking.Index ? background : blocking).HeapSizeBytes;
+        if (afterGen2 > 0 && DateTime.UtcNow - _lastGen2 >= TimeSpan.FromMinutes(1) &&
+            GC.GetGCMemoryInfo(GCKind.Any).HeapSizeBytes > afterGen2 * Gen2Growth)
+        {
+            _lastGen2 = DateTime.UtcNow;
+            GC.Collect(2, GCCollectionMode.Forced, blocking: false);
+            Gen2Collections++;
+            return true;
+        }
+        return false;
+    }
+
+    private void ObserveGen0(long allocated)
+    {
+        int count = GC.CollectionCount(0);
+        if (count == _gen0Count) return;
+
+        // One or more gen0s since the last look: the bytes between them are the budget
+        Gen0Budget = Smooth(Gen0Budget, (double)(allocated - _allocatedAtGc) / (count - _gen0Count));
+        _gen0Count = count;
+        _allocatedAtGc = allocated;
+    }
+
+    private static double Smooth(double average, double sample) => average == 0 ? sample : average + (sample - average) * 0.2;
+}
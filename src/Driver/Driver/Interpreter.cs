@@ -2,7 +2,9 @@ namespace Driver;
 
 /// <summary>
 /// Tree-walking interpreter for LPC expressions and statements.
-/// Evaluates AST nodes and returns results.
+/// Evaluates AST nodes and returns results. This is a standalone evaluator
+/// with no objects behind it; --eval and --repl run on ObjectInterpreter
+/// instead (see ScratchEvaluator), as the server does.
 /// </summary>
 public class Interpreter
 {
@@ -33,14 +35,26 @@ public class Interpreter
     #region Statement Execution
 
     /// <summary>
-    /// Execute a statement. Returns the last expression value if any.
+    /// Execute a statement. Returns the last expression value if any,
+    /// or the value of a top-level return.
     /// </summary>
     public object? Execute(Statement stmt)
+    {
+        var completion = ExecuteStatement(stmt);
+        return completion.Kind switch
+        {
+            CompletionKind.Break => throw new InterpreterException("break outside of loop", stmt),
+            CompletionKind.Continue => throw new InterpreterException("continue outside of loop", stmt),
+            _ => completion.Value
+        };
+    }
+
+    private Completion ExecuteStatement(Statement stmt)
     {
         return stmt switch
         {
             BlockStatement block => ExecuteBlock(block),
-            ExpressionStatement exprStmt => Evaluate(exprStmt.Expression),
+            ExpressionStatement exprStmt => Completion.Normal(Evaluate(exprStmt.Expression)),
             IfStatement ifStmt => ExecuteIf(ifStmt),
             WhileStatement whileStmt => ExecuteWhile(whileStmt),
             ForStatement forStmt => ExecuteFor(forStmt),
@@ -48,69 +62,63 @@ public class Interpreter
             SwitchStatement switchStmt => ExecuteSwitch(switchStmt),
             ReturnStatement ret => ExecuteReturn(ret),
             FunctionDefinition funcDef => ExecuteFunctionDefinition(funcDef),
-            BreakStatement => throw new BreakException(),
-            ContinueStatement => throw new ContinueException(),
+            BreakStatement => Completion.Break,
+            ContinueStatement => Completion.Continue,
             _ => throw new InterpreterException($"Unknown statement type: {stmt.GetType().Name}", stmt)
         };
     }
 
-    private object? ExecuteFunctionDefinition(FunctionDefinition funcDef)
+    private Completion ExecuteFunctionDefinition(FunctionDefinition funcDef)
     {
         // Register the function for later calling
         _functions[funcDef.Name] = funcDef;
-        return null; // Function definitions don't return a value
+        return Completion.Normal(null); // Function definitions don't return a value
     }
 
-    private object? ExecuteBlock(BlockStatement block)
+    private Completion ExecuteBlock(BlockStatement block)
     {
         object? lastValue = null;
         foreach (var stmt in block.Statements)
         {
-            lastValue = Execute(stmt);
+            var completion = ExecuteStatement(stmt);
+            if (completion.IsAbrupt) return completion;
+            lastValue = completion.Value;
         }
-        return lastValue;
+        return Completion.Normal(lastValue);
     }
 
-    private object? ExecuteIf(IfStatement stmt)
+    private Completion ExecuteIf(IfStatement stmt)
     {
         var condition = Evaluate(stmt.Condition);
 
         if (IsTrue(condition))
         {
-            return Execute(stmt.ThenBranch);
+            return ExecuteStatement(stmt.ThenBranch);
         }
         else if (stmt.ElseBranch != null)
         {
-            return Execute(stmt.ElseBranch);
+            return ExecuteStatement(stmt.ElseBranch);
         }
 
-        return null;
+        return Completion.Normal(null);
     }
 
-    private object? ExecuteWhile(WhileStatement stmt)
+    private Completion ExecuteWhile(WhileStatement stmt)
     {
         object? lastValue = null;
 
         while (IsTrue(Evaluate(stmt.Condition)))
         {
-            try
-            {
-                lastValue = Execute(stmt.Body);
-            }
-            catch (BreakException)
-            {
-                break;
-            }
-            catch (ContinueException)
-            {
-                continue;
-            }
+            var completion = ExecuteStatement(stmt.Body);
+            if (completion.Kind == CompletionKind.Break) break;
+            if (completion.Kind == CompletionKind.Return) return completion;
+            lastValue = completion.Value;
         }
 
-        return lastValue;
+        return Completion.Normal(lastValue);
     }
 
-    private object? ExecuteFor(ForStatement stmt)
+    private Completion ExecuteFor(ForStatement stmt)
     {
         object? lastValue = null;
 
@@ -123,18 +131,11 @@ public class Interpreter
         // Loop
         while (stmt.Condition == null || IsTrue(Evaluate(stmt.Condition)))
         {
-            try
-            {
-                lastValue = Execute(stmt.Body);
-            }
-            catch (BreakException)
-            {
-                break;
-            }
-            catch (ContinueException)
-            {
-                // Fall through to increment
-            }
+            // Continue falls through to the increment
+            var completion = ExecuteStatement(stmt.Body);
+            if (completion.Kind == CompletionKind.Break) break;
+            if (completion.Kind == CompletionKind.Return) return completion;
+            lastValue = completion.Value;
 
             // Increment
             if (stmt.Increment != null)
@@ -143,17 +144,16 @@ public class Interpreter
             }
         }
 
-        return lastValue;
+        return Completion.Normal(lastValue);
     }
 
-    private object? ExecuteSwitch(SwitchStatement stmt)
+    private Completion ExecuteSwitch(SwitchStatement stmt)
     {
         var switchValue = Evaluate(stmt.Value);
-        object? lastValue = null;
-        bool matched = false;
+        int start = -1;
         int defaultIndex = -1;
 
-        // First, find if there's a matching case or a default
+        // Find the first matching case, remembering where default is
         for (int i = 0; i < stmt.Cases.Count; i++)
         {
             var switchCase = stmt.Cases[i];
@@ -163,69 +163,66 @@ public class Interpreter
                 // This is the default case
                 defaultIndex = i;
             }
-            else if (!matched)
-            {
-                var caseValue = Evaluate(switchCase.Value);
-                if (ValuesEqual(switchValue, caseValue))
-                {
-                    matched = true;
-                }
-            }
-
-            // If we've matched, execute this case's statements (fall-through)
-            if (matched)
+            else if (ValuesEqual(switchValue, Evaluate(switchCase.Value)))
             {
-                try
-                {
-                    foreach (var statement in switchCase.Statements)
-                    {
-                        lastValue = Execute(statement);
-                    }
-                }
-                catch (BreakException)
-                {
-                    return lastValue;
-                }
+                start = i;
+                break;
             }
         }
 
         // If no case matched but there's a default, execute from default onwards
-        if (!matched && defaultIndex >= 0)
+        if (start < 0)
+        {
+            start = defaultIndex;
+        }
+
+        object? lastValue = null;
+        if (start < 0)
         {
-            for (int i = defaultIndex; i < stmt.Cases.Count; i++)
+            return Completion.Normal(lastValue);
+        }
+
+        // Execute from the matched case to the end (fall-through)
+        for (int i = start; i < stmt.Cases.Count; i++)
+        {
+            foreach (var statement in stmt.Cases[i].Statements)
             {
-                var switchCase = stmt.Cases[i];
-                try
-                {
-                    foreach (var statement in switchCase.Statements)
-                    {
-                        lastValue = Execute(statement);
-                    }
-                }
-                catch (BreakException)
-                {
-                    return lastValue;
-                }
+                var completion = ExecuteStatement(statement);
+                if (completion.Kind == CompletionKind.Break) return Completion.Normal(lastValue);
+                if (completion.IsAbrupt) return completion;
+                lastValue = completion.Value;
             }
         }
 
-        return lastValue;
+        return Completion.Normal(lastValue);
     }
 
-    private static bool ValuesEqual(object? a, object? b)
-    {
-        if (a == null && b == null) return true;
-        if (a == null || b == null) return false;
-        if (IsInteger(a) && IsInteger(b)) return ToLong(a) == ToLong(b);
-        if (a is string sa && b is string sb) return sa == sb;
-        return a.Equals(b);
-    }
+    private static bool ValuesEqual(object? a, object? b) => LpcValueComparer.Instance.Equals(a, b);
 
-    private object? ExecuteForeach(ForEachStatement stmt)
+    private Completion ExecuteForeach(ForEachStatement stmt)
     {
         var collection = Evaluate(stmt.Collection);
         object? lastValue = null;
 
+        if (stmt.ValueVariable != null)
+        {
+            if (collection is not Dictionary<object, object> entries)
+            {
+                throw new InterpreterException($"foreach with two variables needs a mapping, not {collection?.GetType().Name ?? "null"}", stmt);
+            }
+            foreach (var (key, value) in entries)
+            {
+                _variables[stmt.Variable] = key;
+                _variables[stmt.ValueVariable] = value ?? 0;
+
+                var completion = ExecuteStatement(stmt.Body);
+                if (completion.Kind == CompletionKind.Break) break;
+                if (completion.Kind == CompletionKind.Return) return completion;
+                lastValue = completion.Value;
+            }
+            return Completion.Normal(lastValue);
+        }
+
         // Get items to iterate over
         IEnumerable<object?> items;
         if (collection is List<object> list)
@@ -252,31 +249,23 @@ public class Interpreter
             // Set the loop variable (null becomes 0 in LPC)
             _variables[stmt.Variable] = item ?? 0;
 
-            try
-            {
-                lastValue = Execute(stmt.Body);
-            }
-            catch (BreakException)
-            {
-                break;
-            }
-            catch (ContinueException)
-            {
-                continue;
-            }
+            var completion = ExecuteStatement(stmt.Body);
+            if (completion.Kind == CompletionKind.Break) break;
+            if (completion.Kind == CompletionKind.Return) return completion;
+            lastValue = completion.Value;
         }
 
-        return lastValue;
+        return Completion.Normal(lastValue);
     }
 
-    private object? ExecuteReturn(ReturnStatement stmt)
+    private Completion ExecuteReturn(ReturnStatement stmt)
     {
         object? value = null;
         if (stmt.Value != null)
         {
             value = Evaluate(stmt.Value);
         }
-        throw new ReturnException(value);
+        return Completion.Return(value);
     }
 
     #endregion
@@ -322,7 +311,7 @@ public class Interpreter
 
     private object EvaluateMappingLiteral(MappingLiteral expr)
     {
-        var dict = new Dictionary<object, object>();
+        var dict = new LpcMapping();
         foreach (var (keyExpr, valueExpr) in expr.Entries)
         {
             var key = Evaluate(keyExpr);
@@ -574,12 +563,14 @@ public class Interpreter
         try
         {
             // Execute function body
-            Execute(funcDef.Body);
-            return 0L; // Functions that don't return explicitly return 0
-        }
-        catch (ReturnException ret)
-        {
-            return ret.Value ?? 0L; // Return the value, or 0 if no value
+            var completion = ExecuteStatement(funcDef.Body);
+            return completion.Kind switch
+            {
+                CompletionKind.Return => completion.Value ?? 0L, // Return the value, or 0 if no value
+                CompletionKind.Break => throw new InterpreterException("break outside of loop", funcDef),
+                CompletionKind.Continue => throw new InterpreterException("continue outside of loop", funcDef),
+                _ => 0L // Functions that don't return explicitly return 0
+            };
         }
         finally
         {
@@ -717,7 +708,7 @@ public class Interpreter
         // Mapping concatenation (merge mappings, right overwrites left)
         if (expr.Operator == BinaryOperator.Add && leftVal is Dictionary<object, object> leftMap && rightVal is Dictionary<object, object> rightMap)
         {
-            var result = new Dictionary<object, object>();
+            var result = new LpcMapping();
             foreach (var kvp in leftMap)
             {
                 result[kvp.Key] = kvp.Value;
@@ -874,24 +865,32 @@ public class InterpreterException : Exception
 }
 
 /// <summary>
-/// Thrown when a break statement is executed.
+/// How control leaves a statement.
 /// </summary>
-public class BreakException : Exception { }
-
-/// <summary>
-/// Thrown when a continue statement is executed.
-/// </summary>
-public class ContinueException : Exception { }
+public enum CompletionKind
+{
+    Normal,
+    Return,
+    Break,
+    Continue
+}
 
 /// <summary>
-/// Thrown when a return statement is executed.
+/// Result of executing a statement. Loops and function calls check Kind
+/// instead of catching exceptions, so return/break/continue cost no more
+/// than a normal statement.
+/// Value is the returned value for Return, or the last expression value for Normal.
 /// </summary>
-public class ReturnException : Exception
+public readonly record struct Completion(CompletionKind Kind, object? Value)
 {
-    public object? Value { get; }
+    public static readonly Completion Break = new(CompletionKind.Break, null);
+    public static readonly Completion Continue = new(CompletionKind.Continue, null);
 
-    public ReturnException(object? value)
-    {
-        Value = value;
-    }
+    public static Completion Normal(object? value) => new(CompletionKind.Normal, value);
+    public static Completion Return(object? value) => new(CompletionKind.Return, value);
+
+    /// <summary>
+    /// True for return/break/continue: enclosing statements stop and pass it up.
+    /// </summary>
+    public bool IsAbrupt => Kind != CompletionKind.Normal;
 }
@@ -1,11 +1,25 @@
 namespace Driver;
 
+/// <summary>
+/// Turns source text into tokens, on demand (NextToken, which is how the
+/// Parser reads them) or all at once (Tokenize). Text is read as spans:
+/// identifiers, keywords and numbers go through a per-lexer name table so
+/// each distinct name is allocated once, and strings without escapes are
+/// cut straight from the source.
+/// </summary>
 public class Lexer
 {
     private readonly string _source;
     private int _position;
     private int _line = 1;
     private int _column = 1;
+    private int _tokenStart;
+    private readonly NameTable _names = NameTable.WithKeywords();
+
+    /// <summary>
+    /// Decimal text of each char literal value below 256.
+    /// </summary>
+    private static readonly string[] CharCodes = Enumerable.Range(0, 256).Select(i => i.ToString()).ToArray();
 
     private static readonly Dictionary<string, TokenType> Keywords = new()
     {
@@ -44,23 +58,44 @@ public class Lexer
         _source = source;
     }
 
+    /// <summary>
+    /// Lex source from position, which is at line and column: to re-read
+    /// part of a file, as a deferred function body is.
+    /// </summary>
+    public Lexer(string source, int position, int line, int column)
+    {
+        _source = source;
+        _position = position;
+        _line = line;
+        _column = column;
+    }
+
+    /// <summary>
+    /// The text being lexed.
+    /// </summary>
+    public string Source => _source;
+
     public List<Token> Tokenize()
     {
-        var tokens = new List<Token>();
+        var tokens = new List<Token>(_source.Length / 4 + 1);
 
         while (!IsAtEnd())
         {
-            var token = NextToken();
-            if (token != null)
+            if (NextToken() is { } token)
             {
                 tokens.Add(token);
             }
         }
 
-        tokens.Add(new Token(TokenType.Eof, "", _line, _column));
+        tokens.Add(EndToken());
         return tokens;
     }
 
+    /// <summary>
+    /// The Eof token for the current position.
+    /// </summary>
+    public Token EndToken() => new(TokenType.Eof, "", _line, _column) { Offset = _position };
+
     public Token? NextToken()
     {
         SkipWhitespaceAndComments();
@@ -68,6 +103,7 @@ public class Lexer
         if (IsAtEnd())
             return null;
 
+        _tokenStart = _position;
         int startColumn = _column;
         char c = Advance();
 
@@ -76,92 +112,92 @@ public class Lexer
         {
             case '(':
                 // Check for LPC array/mapping literals: ({ and ([
-                if (Match('{')) return new Token(TokenType.ArrayStart, "({", _line, startColumn);
-                if (Match('[')) return new Token(TokenType.MappingStart, "([", _line, startColumn);
-                return new Token(TokenType.LeftParen, "(", _line, startColumn);
-            case ')': return new Token(TokenType.RightParen, ")", _line, startColumn);
-            case '{': return new Token(TokenType.LeftBrace, "{", _line, startColumn);
-            case '}': return new Token(TokenType.RightBrace, "}", _line, startColumn);
-            case '[': return new Token(TokenType.LeftBracket, "[", _line, startColumn);
-            case ']': return new Token(TokenType.RightBracket, "]", _line, startColumn);
-            case ';': return new Token(TokenType.Semicolon, ";", _line, startColumn);
-            case ',': return new Token(TokenType.Comma, ",", _line, startColumn);
-            case '~': return new Token(TokenType.Tilde, "~", _line, startColumn);
-            case '?': return new Token(TokenType.Question, "?", _line, startColumn);
+                if (Match('{')) return Make(TokenType.ArrayStart, "({", _line, startColumn);
+                if (Match('[')) return Make(TokenType.MappingStart, "([", _line, startColumn);
+                return Make(TokenType.LeftParen, "(", _line, startColumn);
+            case ')': return Make(TokenType.RightParen, ")", _line, startColumn);
+            case '{': return Make(TokenType.LeftBrace, "{", _line, startColumn);
+            case '}': return Make(TokenType.RightBrace, "}", _line, startColumn);
+            case '[': return Make(TokenType.LeftBracket, "[", _line, startColumn);
+            case ']': return Make(TokenType.RightBracket, "]", _line, startColumn);
+            case ';': return Make(TokenType.Semicolon, ";", _line, startColumn);
+            case ',': return Make(TokenType.Comma, ",", _line, startColumn);
+            case '~': return Make(TokenType.Tilde, "~", _line, startColumn);
+            case '?': return Make(TokenType.Question, "?", _line, startColumn);
         }
 
         // Multi-character operators
         switch (c)
         {
             case '+':
-                if (Match('+')) return new Token(TokenType.PlusPlus, "++", _line, startColumn);
-                if (Match('=')) return new Token(TokenType.PlusEqual, "+=", _line, startColumn);
-                return new Token(TokenType.Plus, "+", _line, startColumn);
+                if (Match('+')) return Make(TokenType.PlusPlus, "++", _line, startColumn);
+                if (Match('=')) return Make(TokenType.PlusEqual, "+=", _line, startColumn);
+                return Make(TokenType.Plus, "+", _line, startColumn);
 
             case '-':
-                if (Match('-')) return new Token(TokenType.MinusMinus, "--", _line, startColumn);
-                if (Match('=')) return new Token(TokenType.MinusEqual, "-=", _line, startColumn);
-                if (Match('>')) return new Token(TokenType.Arrow, "->", _line, startColumn);
-                return new Token(TokenType.Minus, "-", _line, startColumn);
+                if (Match('-')) return Make(TokenType.MinusMinus, "--", _line, startColumn);
+                if (Match('=')) return Make(TokenType.MinusEqual, "-=", _line, startColumn);
+                if (Match('>')) return Make(TokenType.Arrow, "->", _line, startColumn);
+                return Make(TokenType.Minus, "-", _line, startColumn);
 
             case '*':
-                if (Match('=')) return new Token(TokenType.StarEqual, "*=", _line, startColumn);
-                return new Token(TokenType.Star, "*", _line, startColumn);
+                if (Match('=')) return Make(TokenType.StarEqual, "*=", _line, startColumn);
+                return Make(TokenType.Star, "*", _line, startColumn);
 
             case '/':
-                if (Match('=')) return new Token(TokenType.SlashEqual, "/=", _line, startColumn);
-                return new Token(TokenType.Slash, "/", _line, startColumn);
+                if (Match('=')) return Make(TokenType.SlashEqual, "/=", _line, startColumn);
+                return Make(TokenType.Slash, "/", _line, startColumn);
 
             case '%':
-                if (Match('=')) return new Token(TokenType.PercentEqual, "%=", _line, startColumn);
-                return new Token(TokenType.Percent, "%", _line, startColumn);
+                if (Match('=')) return Make(TokenType.PercentEqual, "%=", _line, startColumn);
+                return Make(TokenType.Percent, "%", _line, startColumn);
 
             case '=':
-                if (Match('=')) return new Token(TokenType.EqualEqual, "==", _line, startColumn);
-                return new Token(TokenType.Equal, "=", _line, startColumn);
+                if (Match('=')) return Make(TokenType.EqualEqual, "==", _line, startColumn);
+                return Make(TokenType.Equal, "=", _line, startColumn);
 
             case '!':
-                if (Match('=')) return new Token(TokenType.BangEqual, "!=", _line, startColumn);
-                return new Token(TokenType.Bang, "!", _line, startColumn);
+                if (Match('=')) return Make(TokenType.BangEqual, "!=", _line, startColumn);
+                return Make(TokenType.Bang, "!", _line, startColumn);
 
             case '<':
                 if (Match('<'))
                 {
-                    if (Match('=')) return new Token(TokenType.LessLessEqual, "<<=", _line, startColumn);
-                    return new Token(TokenType.LessLess, "<<", _line, startColumn);
+                    if (Match('=')) return Make(TokenType.LessLessEqual, "<<=", _line, startColumn);
+                    return Make(TokenType.LessLess, "<<", _line, startColumn);
                 }
-                if (Match('=')) return new Token(TokenType.LessEqual, "<=", _line, startColumn);
-                return new Token(TokenType.Less, "<", _line, startColumn);
+                if (Match('=')) return Make(TokenType.LessEqual, "<=", _line, startColumn);
+                return Make(TokenType.Less, "<", _line, startColumn);
 
             case '>':
                 if (Match('>'))
                 {
-                    if (Match('=')) return new Token(TokenType.GreaterGreaterEqual, ">>=", _line, startColumn);
-                    return new Token(TokenType.GreaterGreater, ">>", _line, startColumn);
+                    if (Match('=')) return Make(TokenType.GreaterGreaterEqual, ">>=", _line, startColumn);
+                    return Make(TokenType.GreaterGreater, ">>", _line, startColumn);
                 }
-                if (Match('=')) return new Token(TokenType.GreaterEqual, ">=", _line, startColumn);
-                return new Token(TokenType.Greater, ">", _line, startColumn);
+                if (Match('=')) return Make(TokenType.GreaterEqual, ">=", _line, startColumn);
+                return Make(TokenType.Greater, ">", _line, startColumn);
 
             case '&':
-                if (Match('&')) return new Token(TokenType.AmpAmp, "&&", _line, startColumn);
-                if (Match('=')) return new Token(TokenType.AmpEqual, "&=", _line, startColumn);
-                return new Token(TokenType.Amp, "&", _line, startColumn);
+                if (Match('&')) return Make(TokenType.AmpAmp, "&&", _line, startColumn);
+                if (Match('=')) return Make(TokenType.AmpEqual, "&=", _line, startColumn);
+                return Make(TokenType.Amp, "&", _line, startColumn);
 
             case '|':
-                if (Match('|')) return new Token(TokenType.PipePipe, "||", _line, startColumn);
-                if (Match('=')) return new Token(TokenType.PipeEqual, "|=", _line, startColumn);
-                return new Token(TokenType.Pipe, "|", _line, startColumn);
+                if (Match('|')) return Make(TokenType.PipePipe, "||", _line, startColumn);
+                if (Match('=')) return Make(TokenType.PipeEqual, "|=", _line, startColumn);
+                return Make(TokenType.Pipe, "|", _line, startColumn);
 
             case '^':
-                if (Match('=')) return new Token(TokenType.CaretEqual, "^=", _line, startColumn);
-                return new Token(TokenType.Caret, "^", _line, startColumn);
+                if (Match('=')) return Make(TokenType.CaretEqual, "^=", _line, startColumn);
+                return Make(TokenType.Caret, "^", _line, startColumn);
 
             case ':':
-                if (Match(':')) return new Token(TokenType.ColonColon, "::", _line, startColumn);
-                return new Token(TokenType.Colon, ":", _line, startColumn);
+                if (Match(':')) return Make(TokenType.ColonColon, "::", _line, startColumn);
+                return Make(TokenType.Colon, ":", _line, startColumn);
 
             case '.':
-                if (Match('.')) return new Token(TokenType.DotDot, "..", _line, startColumn);
+                if (Match('.')) return Make(TokenType.DotDot, "..", _line, startColumn);
                 throw new LexerException("Unexpected character '.'", _line, startColumn);
         }
 
@@ -192,6 +228,11 @@ public class Lexer
         throw new LexerException($"Unexpected character '{c}'", _line, startColumn);
     }
 
+    private Token Make(TokenType type, string lexeme, int line, int column)
+    {
+        return new Token(type, lexeme, line, column) { Offset = _tokenStart };
+    }
+
     private Token ReadNumber(int startColumn)
     {
         int start = _position - 1;
@@ -201,13 +242,25 @@ public class Lexer
             Advance();
         }
 
-        string lexeme = _source[start.._position];
-        return new Token(TokenType.Number, lexeme, _line, startColumn);
+        var (lexeme, _) = _names.GetOrAdd(_source.AsSpan(start, _position - start), TokenType.Number);
+        return Make(TokenType.Number, lexeme, _line, startColumn);
     }
 
     private Token ReadString(int startColumn)
     {
         int startLine = _line;
+
+        // Common case: no escapes, so the value is a slice of the source
+        var rest = _source.AsSpan(_position);
+        int end = rest.IndexOfAny('"', '\\', '\n');
+        if (end >= 0 && rest[end] == '"')
+        {
+            var text = _source.Substring(_position, end);
+            _position += end + 1;
+            _column += end + 1;
+            return Make(TokenType.String, text, startLine, startColumn);
+        }
+
         var sb = new System.Text.StringBuilder();
 
         while (!IsAtEnd() && Peek() != '"')
@@ -248,7 +301,7 @@ public class Lexer
         }
 
         Advance(); // consume closing quote
-        return new Token(TokenType.String, sb.ToString(), startLine, startColumn);
+        return Make(TokenType.String, sb.ToString(), startLine, startColumn);
     }
 
     private Token ReadCharLiteral(int startColumn)
@@ -294,7 +347,8 @@ public class Lexer
         Advance(); // consume closing quote
 
         // Return as a number token with the ASCII value
-        return new Token(TokenType.Number, ((int)charValue).ToString(), _line, startColumn);
+        var code = charValue < CharCodes.Length ? CharCodes[charValue] : ((int)charValue).ToString();
+        return Make(TokenType.Number, code, _line, startColumn);
     }
 
     private Token ReadIdentifier(int startColumn)
@@ -306,14 +360,8 @@ public class Lexer
             Advance();
         }
 
-        string lexeme = _source[start.._position];
-
-        if (Keywords.TryGetValue(lexeme, out var keywordType))
-        {
-            return new Token(keywordType, lexeme, _line, startColumn);
-        }
-
-        return new Token(TokenType.Identifier, lexeme, _line, startColumn);
+        var (lexeme, type) = _names.GetOrAdd(_source.AsSpan(start, _position - start), TokenType.Identifier);
+        return Make(type, lexeme, _line, startColumn);
     }
 
     private void SkipWhitespaceAndComments()
@@ -428,6 +476,90 @@ public class Lexer
     {
         return char.IsLetterOrDigit(c) || c == '_';
     }
+
+    /// <summary>
+    /// Open-addressed table of the names a lexer has seen, looked up by span
+    /// so a name already seen costs no allocation. Starts with the keywords.
+    /// </summary>
+    private sealed class NameTable
+    {
+        private static readonly NameTable KeywordTable = CreateKeywordTable();
+
+        private string?[] _texts;
+        private TokenType[] _types;
+        private int _count;
+
+        private NameTable(int capacity)
+        {
+            _texts = new string?[capacity];
+            _types = new TokenType[capacity];
+        }
+
+        private static NameTable CreateKeywordTable()
+        {
+            var table = new NameTable(64);
+            foreach (var (text, type) in Keywords)
+            {
+                table.Insert(text, type);
+            }
+            return table;
+        }
+
+        public static NameTable WithKeywords()
+        {
+            var table = new NameTable(256);
+            for (int i = 0; i < KeywordTable._texts.Length; i++)
+            {
+                if (KeywordTable._texts[i] is { } text)
+                {
+                    table.Insert(text, KeywordTable._types[i]);
+                }
+            }
+            return table;
+        }
+
+        /// <summary>
+        /// The saved text equal to span and its token type, adding it with
+        /// type if it is new.
+        /// </summary>
+        public (string Text, TokenType Type) GetOrAdd(ReadOnlySpan<char> span, TokenType type)
+        {
+            int mask = _texts.Length - 1;
+            for (int i = string.GetHashCode(span) & mask; ; i = (i + 1) & mask)
+            {
+                var text = _texts[i];
+                if (text == null) break;
+                if (span.SequenceEqual(text)) return (text, _types[i]);
+            }
+
+            var added = span.ToString();
+            Insert(added, type);
+            return (added, type);
+        }
+
+        private void Insert(string text, TokenType type)
+        {
+            if ((_count + 1) * 2 > _texts.Length)
+            {
+                var oldTexts = _texts;
+                var oldTypes = _types;
+                _texts = new string?[oldTexts.Length * 2];
+                _types = new TokenType[oldTexts.Length * 2];
+                _count = 0;
+                for (int j = 0; j < oldTexts.Length; j++)
+                {
+                    if (oldTexts[j] is { } old) Insert(old, oldTypes[j]);
+                }
+            }
+
+            int mask = _texts.Length - 1;
+            int i = string.GetHashCode(text.AsSpan()) & mask;
+            while (_texts[i] != null) i = (i + 1) & mask;
+            _texts[i] = text;
+            _types[i] = type;
+            _count++;
+        }
+    }
 }
 
 public class LexerException : Exception
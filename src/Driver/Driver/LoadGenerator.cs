@@ -0,0 +1,634 @@
+using System.Diagnostics;
+using System.Net.Sockets;
+using System.Text;
+using System.Text.Json;
+using System.Text.Json.Serialization;
+using System.Text.RegularExpressions;
+
+namespace Driver;
+
+public enum LoadStepKind
+{
+    Login,
+    Command,
+    Wait
+}
+
+/// <summary>
+/// One line of a load script. Waits pause for a random time in [MinMs, MaxMs].
+/// </summary>
+public record LoadStep(LoadStepKind Kind, string Text = "", int MinMs = 0, int MaxMs = 0);
+
+/// <summary>
+/// What each bot does, read from a command file:
+///
+///     # comment
+///     login               log in, registering the account on first use
+///     wait 500            pause 500 ms; "wait 500-2000" picks a random pause
+///     loop                the steps after this repeat until the run ends
+///     say I am {name}     anything else is a command; {name} is the bot's name
+///
+/// Without a loop line each bot runs the script once and quits.
+/// </summary>
+public sealed class LoadScript
+{
+    public List<LoadStep> Steps { get; } = new();
+
+    /// <summary>
+    /// Index of the first repeated step, or -1.
+    /// </summary>
+    public int LoopStart { get; private set; } = -1;
+
+    public static LoadScript Parse(string source)
+    {
+        var script = new LoadScript();
+        var lines = source.Split('\n');
+
+        for (int i = 0; i < lines.Length; i++)
+        {
+            var line = lines[i].Trim();
+            if (line.Length == 0 || line.StartsWith('#')) continue;
+
+            var parts = line.Split(' ', 2, StringSplitOptions.RemoveEmptyEntries);
+            switch (parts[0].ToLowerInvariant())
+            {
+                case "login":
+                    script.Steps.Add(new LoadStep(LoadStepKind.Login));
+                    break;
+
+                case "loop":
+                    if (script.LoopStart >= 0)
+                    {
+                        throw new FormatException($"Line {i + 1}: only one loop is allowed");
+                    }
+                    script.LoopStart = script.Steps.Count;
+                    break;
+
+                case "wait":
+                    script.Steps.Add(ParseWait(parts.Length > 1 ? parts[1] : "", i + 1));
+                    break;
+
+                default:
+                    script.Steps.Add(new LoadStep(LoadStepKind.Command, line));
+                    break;
+            }
+        }
+
+        if (script.LoopStart == script.Steps.Count)
+        {
+            throw new FormatException("Nothing to repeat after loop");
+        }
+        if (!script.Steps.Any(step => step.Kind == LoadStepKind.Login))
+        {
+            throw new FormatException("Script never logs in");
+        }
+        return script;
+    }
+
+    private static LoadStep ParseWait(string range, int lineNumber)
+    {
+        var bounds = range.Split('-', 2);
+        if (!int.TryParse(bounds[0], out var min) || min < 0)
+        {
+            throw new FormatException($"Line {lineNumber}: wait needs a time in ms");
+        }
+        int max = min;
+        if (bounds.Length > 1 && (!int.TryParse(bounds[1], out max) || max < min))
+        {
+            throw new FormatException($"Line {lineNumber}: bad wait range '{range}'");
+        }
+        return new LoadStep(LoadStepKind.Wait, MinMs: min, MaxMs: max);
+    }
+}
+
+/// <summary>
+/// Settings for a load run.
+/// </summary>
+public sealed record LoadOptions
+{
+    public string Host { get; init; } = "127.0.0.1";
+    public int Port { get; init; } = 4000;
+    public int Bots { get; init; } = 100;
+
+    /// <summary>
+    /// Bots connect evenly spread over this time, so logins don't all land in one tick.
+    /// </summary>
+    public TimeSpan Ramp { get; init; } = TimeSpan.FromSeconds(10);
+
+    /// <summary>
+    /// Length of the whole run, ramp included.
+    /// </summary>
+    public TimeSpan Duration { get; init; } = TimeSpan.FromSeconds(60);
+
+    /// <summary>
+    /// Bot accounts are this prefix plus letters. It must contain "test".
+    /// </summary>
+    public string NamePrefix { get; init; } = "testbot";
+    public string Password { get; init; } = "loadtest123";
+
+    /// <summary>
+    /// How long to wait for the prompt after a command before counting a timeout.
+    /// </summary>
+    public TimeSpan CommandTimeout { get; init; } = TimeSpan.FromSeconds(10);
+
+    /// <summary>
+    /// An admin account used to read the tick profiler before and after the run.
+    /// </summary>
+    public string? AdminName { get; init; }
+    public string? AdminPassword { get; init; }
+}
+
+/// <summary>
+/// Results of a load run. Latencies are from sending a line to receiving
+/// the prompt that follows its output.
+/// </summary>
+public sealed class LoadReport
+{
+    public record Latency(string Command, int Count, double P50Ms, double P95Ms, double P99Ms, double MaxMs);
+
+    public int Bots { get; init; }
+    public int LoggedIn { get; init; }
+    public double Seconds { get; init; }
+    public long Commands { get; init; }
+    public double CommandsPerSecond => Seconds > 0 ? Commands / Seconds : 0;
+    public long Timeouts { get; init; }
+    public long Throttled { get; init; }
+    public long Errors { get; init; }
+    public List<string> SampleErrors { get; init; } = new();
+    public List<Latency> Latencies { get; init; } = new();
+
+    /// <summary>
+    /// Ticks run and tick overruns during the run, when an admin account was given.
+    /// </summary>
+    public long? Ticks { get; init; }
+    public long? TickOverruns { get; init; }
+
+    public string ToJson() => JsonSerializer.Serialize(this, LoadJsonContext.Default.LoadReport);
+
+    public override string ToString()
+    {
+        var sb = new StringBuilder();
+        sb.AppendLine($"Bots: {LoggedIn}/{Bots} logged in, {Seconds:F1}s");
+        sb.AppendLine($"Commands: {Commands} ({CommandsPerSecond:F1}/s), {Timeouts} timed out, {Throttled} throttled, {Errors} bot errors");
+        if (Ticks != null)
+        {
+            sb.AppendLine($"Server ticks: {Ticks}, overruns: {TickOverruns}");
+        }
+        sb.AppendLine($"  {"command",-12} {"count",8} {"p50 ms",8} {"p95",8} {"p99",8} {"max",8}");
+        foreach (var latency in Latencies)
+        {
+            sb.AppendLine($"  {latency.Command,-12} {latency.Count,8} {latency.P50Ms,8:F1} {latency.P95Ms,8:F1} {latency.P99Ms,8:F1} {latency.MaxMs,8:F1}");
+        }
+        foreach (var error in SampleErrors)
+        {
+            sb.AppendLine($"  error: {error}");
+        }
+        return sb.ToString();
+    }
+}
+
+/// <summary>
+/// Synthetic load: many scripted telnet bots against a running server.
+///
+/// Each bot is one connection running the script through the real login
+/// flow and command loop. Bots are async, so thousands share a few threads.
+/// The server's tick overruns come from the admin "ticks" command, read
+/// before and after the run when an admin account is given.
+/// </summary>
+public sealed class LoadGenerator
+{
+    private const int MaxSampleErrors = 5;
+
+    private readonly LoadScript _script;
+    private readonly LoadOptions _options;
+
+    private readonly Dictionary<string, List<double>> _latencies = new();
+    private readonly List<string> _sampleErrors = new();
+    private long _commands;
+    private long _timeouts;
+    private long _throttled;
+    private long _errors;
+    private int _loggedIn;
+
+    public LoadGenerator(LoadScript script, LoadOptions options)
+    {
+        if (!options.NamePrefix.Contains("test") || !options.NamePrefix.All(char.IsAsciiLetterLower))
+        {
+            throw new ArgumentException("Bot name prefix must be lowercase letters containing 'test'");
+        }
+        _script = script;
+        _options = options;
+    }
+
+    /// <summary>
+    /// Account name of bot n: the prefix plus four letters.
+    /// </summary>
+    public string BotName(int n)
+    {
+        var suffix = new char[4];
+        for (int i = suffix.Length - 1; i >= 0; i--)
+        {
+            suffix[i] = (char)('a' + n % 26);
+            n /= 26;
+        }
+        return _options.NamePrefix + new string(suffix);
+    }
+
+    public async Task<LoadReport> RunAsync(CancellationToken cancellationToken = default)
+    {
+        var before = await ReadTickStatsAsync(cancellationToken);
+
+        var stopwatch = Stopwatch.StartNew();
+        var deadline = DateTime.UtcNow + _options.Duration;
+        var bots = new Task[_options.Bots];
+        for (int i = 0; i < bots.Length; i++)
+        {
+            var delay = _options.Ramp * i / Math.Max(1, bots.Length);
+            bots[i] = RunBotAsync(i, delay, deadline, cancellationToken);
+        }
+        await Task.WhenAll(bots);
+        stopwatch.Stop();
+
+        var after = await ReadTickStatsAsync(cancellationToken);
+
+        lock (_latencies)
+        {
+            return new LoadReport
+            {
+                Bots = _options.Bots,
+                LoggedIn = _loggedIn,
+                Seconds = stopwatch.Elapsed.TotalSeconds,
+                Commands = _commands,
+                Timeouts = _timeouts,
+                Throttled = _throttled,
+                Errors = _errors,
+                SampleErrors = _sampleErrors.ToList(),
+                Latencies = _latencies
+                    .OrderBy(pair => pair.Key == "login" ? 0 : 1).ThenByDescending(pair => pair.Value.Count)
+                    .Select(pair => Summarize(pair.Key, pair.Value))
+                    .ToList(),
+                Ticks = after?.Ticks - before?.Ticks,
+                TickOverruns = after?.Overruns - before?.Overruns
+            };
+        }
+    }
+
+    private async Task RunBotAsync(int index, TimeSpan delay, DateTime deadline, CancellationToken cancellationToken)
+    {
+        var name = BotName(index);
+        try
+        {
+            await Task.Delay(delay, cancellationToken);
+            using var bot = await BotConnection.ConnectAsync(_options.Host, _options.Port, cancellationToken);
+
+            int step = 0;
+            while (step < _script.Steps.Count && DateTime.UtcNow < deadline)
+            {
+                await RunStepAsync(bot, _script.Steps[step], name, cancellationToken);
+                step++;
+                if (step == _script.Steps.Count && _script.LoopStart >= 0)
+                {
+                    step = _script.LoopStart;
+                }
+            }
+
+            // Quit rather than hang up, so the world isn't left full of linkdead bots
+            await bot.SendAsync("quit", cancellationToken);
+        }
+        catch (OperationCanceledException) when (cancellationToken.IsCancellationRequested)
+        {
+        }
+        catch (Exception ex)
+        {
+            RecordError($"{name}: {ex.Message}");
+        }
+    }
+
+    private async Task RunStepAsync(BotConnection bot, LoadStep step, string name, CancellationToken cancellationToken)
+    {
+        switch (step.Kind)
+        {
+            case LoadStepKind.Wait:
+                await Task.Delay(Random.Shared.Next(step.MinMs, step.MaxMs + 1), cancellationToken);
+                break;
+
+            case LoadStepKind.Login:
+            {
+                var started = Stopwatch.GetTimestamp();
+                await LoginAsync(bot, name, _options.Password, register: true, cancellationToken);
+                RecordLatency("login", Stopwatch.GetElapsedTime(started));
+                Interlocked.Increment(ref _loggedIn);
+                break;
+            }
+
+            case LoadStepKind.Command:
+            {
+                var command = step.Text.Replace("{name}", name);
+                var started = Stopwatch.GetTimestamp();
+                bot.Clear();
+                await bot.SendAsync(command, cancellationToken);
+                var outcome = await bot.WaitForPromptAsync(_options.CommandTimeout, cancellationToken);
+                Interlocked.Increment(ref _commands);
+                if (outcome == PromptOutcome.Prompt)
+                {
+                    RecordLatency(command.Split(' ', 2)[0].ToLowerInvariant(), Stopwatch.GetElapsedTime(started));
+                }
+                else if (outcome == PromptOutcome.Throttled)
+                {
+                    Interlocked.Increment(ref _throttled);
+                }
+                else
+                {
+                    Interlocked.Increment(ref _timeouts);
+                }
+                break;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Walk the login prompts, registering the account first if it doesn't exist.
+    /// The server caps password hashes in flight per address, and every bot
+    /// shares one, so a login turned away for that is retried after a pause.
+    /// </summary>
+    private async Task LoginAsync(BotConnection bot, string name, string password, bool register, CancellationToken cancellationToken)
+    {
+        await bot.ExpectAsync(_options.CommandTimeout, cancellationToken, "type 'new'");
+        for (int attempt = 1; !await TryLoginAsync(bot, name, password, register, cancellationToken); attempt++)
+        {
+            if (attempt == MaxLoginAttempts)
+            {
+                throw new InvalidOperationException($"Server too busy to log in {name}");
+            }
+            await Task.Delay(Random.Shared.Next(50, 250), cancellationToken);
+        }
+    }
+
+    private const int MaxLoginAttempts = 20;
+
+    /// <summary>
+    /// One pass through the prompts from the name prompt. False if the server
+    /// was too busy and is back at the name prompt.
+    /// </summary>
+    private async Task<bool> TryLoginAsync(BotConnection bot, string name, string password, bool register, CancellationToken cancellationToken)
+    {
+        var timeout = _options.CommandTimeout;
+        await bot.SendAsync(name, cancellationToken);
+
+        if (await bot.ExpectAsync(timeout, cancellationToken, "Password: ", "Unknown user") == 1)
+        {
+            if (!register)
+            {
+                throw new InvalidOperationException($"No account named {name}");
+            }
+            await bot.SendAsync("new", cancellationToken);
+            await bot.ExpectAsync(timeout, cancellationToken, "Choose a username");
+            await bot.SendAsync(name, cancellationToken);
+            await bot.ExpectAsync(timeout, cancellationToken, "email address: ");
+            await bot.SendAsync($"{name}@example.com", cancellationToken);
+            await bot.ExpectAsync(timeout, cancellationToken, "Choose a password");
+            await bot.SendAsync(password, cancellationToken);
+            await bot.ExpectAsync(timeout, cancellationToken, "Confirm password: ");
+        }
+        await bot.SendAsync(password, cancellationToken);
+
+        switch (await bot.ExpectAsync(timeout, cancellationToken, "> ", "(y/n): ", "Invalid password", "Too many failed", "Too many logins"))
+        {
+            case 1:
+                // A previous run's session is still in the game
+                await bot.SendAsync("y", cancellationToken);
+                await bot.ExpectAsync(timeout, cancellationToken, "> ");
+                break;
+            case 2:
+            case 3:
+                throw new InvalidOperationException($"Login refused for {name}");
+            case 4:
+                return false;
+        }
+        return true;
+    }
+
+    private async Task<(long Ticks, long Overruns)?> ReadTickStatsAsync(CancellationToken cancellationToken)
+    {
+        if (_options.AdminName == null) return null;
+
+        using var admin = await BotConnection.ConnectAsync(_options.Host, _options.Port, cancellationToken);
+        await LoginAsync(admin, _options.AdminName, _options.AdminPassword ?? "", register: false, cancellationToken);
+        admin.Clear();
+        await admin.SendAsync("ticks", cancellationToken);
+        var output = admin.Text;
+        if (await admin.WaitForPromptAsync(_options.CommandTimeout, cancellationToken) == PromptOutcome.Prompt)
+        {
+            output = admin.Text;
+        }
+        await admin.SendAsync("quit", cancellationToken);
+
+        var match = Regex.Match(output, @"Ticks: (\d+), overruns: (\d+)");
+        if (!match.Success)
+        {
+            throw new InvalidOperationException($"{_options.AdminName} couldn't read tick stats: {output.Trim()}");
+        }
+        return (long.Parse(match.Groups[1].Value), long.Parse(match.Groups[2].Value));
+    }
+
+    private void RecordLatency(string command, TimeSpan elapsed)
+    {
+        lock (_latencies)
+        {
+            if (!_latencies.TryGetValue(command, out var samples))
+            {
+                _latencies[command] = samples = new List<double>();
+            }
+            samples.Add(elapsed.TotalMilliseconds);
+        }
+    }
+
+    private void RecordError(string message)
+    {
+        Interlocked.Increment(ref _errors);
+        lock (_sampleErrors)
+        {
+            if (_sampleErrors.Count < MaxSampleErrors) _sampleErrors.Add(message);
+        }
+    }
+
+    private static LoadReport.Latency Summarize(string command, List<double> samples)
+    {
+        samples.Sort();
+        double At(double percentile) => samples[Math.Min(samples.Count - 1, (int)(percentile / 100 * samples.Count))];
+        return new LoadReport.Latency(command, samples.Count, At(50), At(95), At(99), samples[^1]);
+    }
+
+    private enum PromptOutcome
+    {
+        Prompt,
+        Throttled,
+        Timeout
+    }
+
+    /// <summary>
+    /// A bot's socket. Telnet negotiation is read past and never answered, so
+    /// the server keeps its defaults (no echo changes, no compression).
+    /// </summary>
+    private sealed class BotConnection : IDisposable
+    {
+        private readonly TcpClient _client;
+        private readonly NetworkStream _stream;
+        private readonly byte[] _buffer = new byte[8192];
+        private readonly StringBuilder _text = new();
+        private int _telnetState;
+
+        private BotConnection(TcpClient client)
+        {
+            _client = client;
+            _stream = client.GetStream();
+        }
+
+        public static async Task<BotConnection> ConnectAsync(string host, int port, CancellationToken cancellationToken)
+        {
+            var client = new TcpClient { NoDelay = true };
+            try
+            {
+                await client.ConnectAsync(host, port, cancellationToken);
+                return new BotConnection(client);
+            }
+            catch
+            {
+                client.Dispose();
+                throw;
+            }
+        }
+
+        /// <summary>
+        /// Text received since the last Clear(), without CRs or telnet commands.
+        /// </summary>
+        public string Text => _text.ToString();
+
+        public void Clear() => _text.Clear();
+
+        public async Task SendAsync(string line, CancellationToken cancellationToken)
+        {
+            await _stream.WriteAsync(Encoding.UTF8.GetBytes(line + "\r\n"), cancellationToken);
+        }
+
+        /// <summary>
+        /// Read until one of the markers arrives; returns its index and clears
+        /// the text. Throws TimeoutException if none arrives in time.
+        /// </summary>
+        public async Task<int> ExpectAsync(TimeSpan timeout, CancellationToken cancellationToken, params string[] markers)
+        {
+            using var timer = CancellationTokenSource.CreateLinkedTokenSource(cancellationToken);
+            timer.CancelAfter(timeout);
+            while (true)
+            {
+                var text = Text;
+                for (int i = 0; i < markers.Length; i++)
+                {
+                    if (text.Contains(markers[i]))
+                    {
+                        Clear();
+                        return i;
+                    }
+                }
+                if (!await ReadAsync(timer.Token, cancellationToken))
+                {
+                    var lastLine = text.TrimEnd().Split('\n')[^1];
+                    throw new TimeoutException($"No '{markers[0].Trim()}' after {timeout.TotalSeconds:F0}s, last line '{lastLine}'");
+                }
+            }
+        }
+
+        /// <summary>
+        /// Read until the command prompt, or the rate limiter's refusal (which has no prompt).
+        /// Other players' messages can arrive in the same read, before or after the
+        /// prompt, so it's looked for anywhere in the text rather than at the end.
+        /// </summary>
+        public async Task<PromptOutcome> WaitForPromptAsync(TimeSpan timeout, CancellationToken cancellationToken)
+        {
+            using var timer = CancellationTokenSource.CreateLinkedTokenSource(cancellationToken);
+            timer.CancelAfter(timeout);
+            while (true)
+            {
+                var text = Text;
+                if (text.Contains("> ")) return PromptOutcome.Prompt;
+                if (text.Contains("sending commands too quickly")) return PromptOutcome.Throttled;
+                if (!await ReadAsync(timer.Token, cancellationToken)) return PromptOutcome.Timeout;
+            }
+        }
+
+        /// <summary>
+        /// Receive one chunk. False when the timer ran out first.
+        /// </summary>
+        private async Task<bool> ReadAsync(CancellationToken timer, CancellationToken cancellationToken)
+        {
+            int count;
+            try
+            {
+                count = await _stream.ReadAsync(_buffer, timer);
+            }
+            catch (OperationCanceledException) when (!cancellationToken.IsCancellationRequested)
+            {
+                return false;
+            }
+            if (count == 0)
+            {
+                throw new IOException("Server closed the connection");
+            }
+            Append(_buffer.AsSpan(0, count));
+            return true;
+        }
+
+        private void Append(ReadOnlySpan<byte> data)
+        {
+            foreach (var b in data)
+            {
+                switch (_telnetState)
+                {
+                    case 0:
+                        if (b == TelnetParser.IAC) _telnetState = 1;
+                        else if (b != '\r') _text.Append((char)b);
+                        break;
+                    case 1:
+                        _telnetState = b switch
+                        {
+                            TelnetParser.WILL or TelnetParser.WONT or TelnetParser.DO or TelnetParser.DONT => 2,
+                            TelnetParser.SB => 3,
+                            TelnetParser.IAC => AppendByte(b),
+                            _ => 0
+                        };
+                        break;
+                    case 2:
+                        _telnetState = 0;
+                        break;
+                    case 3:
+                        if (b == TelnetParser.IAC) _telnetState = 4;
+                        break;
+                    case 4:
+                        _telnetState = b == TelnetParser.SE ? 0 : 3;
+                        break;
+                }
+            }
+        }
+
+        private int AppendByte(byte b)
+        {
+            _text.Append((char)b);
+            return 0;
+        }
+
+        public void Dispose()
+        {
+            _stream.Dispose();
+            _client.Dispose();
+        }
+    }
+}
+
+/// <summary>
+/// Source-generated serializer for --load --json.
+/// </summary>
+[JsonSourceGenerationOptions(WriteIndented = true)]
+[JsonSerializable(typeof(LoadReport))]
+internal partial class LoadJsonContext : JsonSerializerContext
+{
+}
@@ -1,3 +1,7 @@
+using System.Collections.Concurrent;
+using System.Runtime.CompilerServices;
+using System.Text;
+
 namespace Driver;
 
 /// <summary>
@@ -29,9 +33,21 @@ public enum LogCategory
 /// <summary>
 /// Central logging system for the driver.
 /// Supports log levels, categories, timestamps, and multiple outputs.
+///
+/// Logging never writes on the caller's thread. A call checks the level,
+/// stamps the entry and puts it on a lock-free queue; a background thread
+/// drains the queue, formats each batch, writes it to the console and the log
+/// file, and flushes the file once per batch. Debug and Info take interpolated
+/// strings through handlers that skip formatting entirely when the level is
+/// off, so a debug line in a hot path costs one comparison.
+///
+/// The queue is drained at process exit; call Flush() where output has to be
+/// on disk at a particular point.
 /// </summary>
 public static class Logger
 {
+    private readonly record struct LogEntry(DateTime Time, LogLevel Level, LogCategory Category, string Message);
+
     private static LogLevel _minLevel = LogLevel.Info;
     private static readonly object _lock = new();
     private static StreamWriter? _fileWriter;
@@ -40,6 +56,20 @@ public static class Logger
     private static bool _showTimestamp = true;
     private static bool _showCategory = true;
 
+    private static readonly ConcurrentQueue<LogEntry> _queue = new();
+    private static readonly ManualResetEventSlim _wake = new(false);
+    private static readonly object _flushLock = new();
+    private static int _idle;
+    private static long _enqueued;
+    private static long _written;
+
+    static Logger()
+    {
+        new Thread(WriterLoop) { Name = "Logger", IsBackground = true }.Start();
+        AppDomain.CurrentDomain.ProcessExit += (_, _) => Close();
+        AppDomain.CurrentDomain.UnhandledException += (_, _) => Flush();
+    }
+
     /// <summary>
     /// Minimum log level. Messages below this level are ignored.
     /// </summary>
@@ -49,6 +79,11 @@ public static class Logger
         set => _minLevel = value;
     }
 
+    /// <summary>
+    /// Whether a message at this level would be logged.
+    /// </summary>
+    public static bool IsEnabled(LogLevel level) => level >= _minLevel;
+
     /// <summary>
     /// Whether to use ANSI colors in console output.
     /// </summary>
@@ -76,11 +111,18 @@ public static class Logger
         set => _showCategory = value;
     }
 
+    /// <summary>
+    /// Write the log file as JSON lines (one object per entry, with time,
+    /// level, category and message) instead of text. The console stays text.
+    /// </summary>
+    public static bool JsonLines { get; set; }
+
     /// <summary>
     /// Set up file logging. Pass null to disable.
     /// </summary>
     public static void SetLogFile(string? path)
     {
+        Flush();
         lock (_lock)
         {
             _fileWriter?.Dispose();
@@ -98,7 +140,8 @@ public static class Logger
                         Directory.CreateDirectory(dir);
                     }
 
-                    _fileWriter = new StreamWriter(path, append: true) { AutoFlush = true };
+                    // Flushed by the writer after each batch
+                    _fileWriter = new StreamWriter(path, append: true);
                 }
                 catch (Exception ex)
                 {
@@ -109,10 +152,11 @@ public static class Logger
     }
 
     /// <summary>
-    /// Close the log file (if any).
+    /// Write out everything logged so far, then close the log file (if any).
     /// </summary>
     public static void Close()
     {
+        Flush();
         lock (_lock)
         {
             _fileWriter?.Dispose();
@@ -120,18 +164,52 @@ public static class Logger
         }
     }
 
+    /// <summary>
+    /// Block until everything logged before the call has been written.
+    /// </summary>
+    public static void Flush()
+    {
+        long target = Interlocked.Read(ref _enqueued);
+        _wake.Set();
+        lock (_flushLock)
+        {
+            while (Interlocked.Read(ref _written) < target)
+            {
+                Monitor.Wait(_flushLock, 100);
+            }
+        }
+    }
+
     /// <summary>
     /// Log a debug message.
     /// </summary>
     public static void Debug(string message, LogCategory category = LogCategory.General)
         => Log(LogLevel.Debug, category, message);
 
+    /// <summary>
+    /// Log a debug message, formatting it only if debug logging is on.
+    /// </summary>
+    public static void Debug([InterpolatedStringHandlerArgument] ref DebugMessageHandler message, LogCategory category = LogCategory.General)
+    {
+        if (LogLevel.Debug >= _minLevel)
+            Enqueue(LogLevel.Debug, category, message.ToStringAndClear());
+    }
+
     /// <summary>
     /// Log an info message.
     /// </summary>
     public static void Info(string message, LogCategory category = LogCategory.General)
         => Log(LogLevel.Info, category, message);
 
+    /// <summary>
+    /// Log an info message, formatting it only if info logging is on.
+    /// </summary>
+    public static void Info([InterpolatedStringHandlerArgument] ref InfoMessageHandler message, LogCategory category = LogCategory.General)
+    {
+        if (LogLevel.Info >= _minLevel)
+            Enqueue(LogLevel.Info, category, message.ToStringAndClear());
+    }
+
     /// <summary>
     /// Log a warning message.
     /// </summary>
@@ -152,54 +230,145 @@ public static class Logger
         if (level < _minLevel)
             return;
 
-        var timestamp = DateTime.Now.ToString("yyyy-MM-dd HH:mm:ss");
-        var levelStr = level.ToString().ToUpper().PadRight(7);
-        var categoryStr = category.ToString().PadRight(8);
-
-        // Build message parts
-        var parts = new List<string>();
-        if (_showTimestamp)
-            parts.Add($"[{timestamp}]");
-        parts.Add($"[{levelStr}]");
-        if (_showCategory)
-            parts.Add($"[{categoryStr}]");
-        parts.Add(message);
+        Enqueue(level, category, message);
+    }
 
-        var fullMessage = string.Join(" ", parts);
+    private static void Enqueue(LogLevel level, LogCategory category, string message)
+    {
+        _queue.Enqueue(new LogEntry(DateTime.UtcNow, level, category, message));
+        Interlocked.Increment(ref _enqueued);
 
-        lock (_lock)
+        // Only signal the writer when it's asleep
+        if (Volatile.Read(ref _idle) == 1)
         {
-            // Write to console with colors
-            WriteToConsole(level, fullMessage);
-
-            // Write to file without colors
-            _fileWriter?.WriteLine(fullMessage);
+            _wake.Set();
         }
     }
 
-    private static void WriteToConsole(LogLevel level, string message)
+    private static void WriterLoop()
     {
-        if (_useColors)
+        var text = new StringBuilder();
+        var json = new StringBuilder();
+
+        while (true)
         {
-            var originalColor = Console.ForegroundColor;
-            Console.ForegroundColor = level switch
+            long batch = 0;
+            lock (_lock)
+            {
+                LogLevel? color = null;
+                while (_queue.TryDequeue(out var entry))
+                {
+                    batch++;
+                    text.Clear();
+                    FormatText(text, entry);
+                    var line = text.ToString();
+
+                    // Console writes are grouped by color
+                    if (_useColors && color != entry.Level)
+                    {
+                        Console.ForegroundColor = ConsoleColorFor(entry.Level);
+                        color = entry.Level;
+                    }
+                    Console.Out.WriteLine(line);
+
+                    if (_fileWriter != null)
+                    {
+                        if (JsonLines)
+                        {
+                            json.Clear();
+                            FormatJson(json, entry);
+                            _fileWriter.WriteLine(json);
+                        }
+                        else
+                        {
+                            _fileWriter.WriteLine(line);
+                        }
+                    }
+                }
+
+                if (batch > 0)
+                {
+                    if (color != null) Console.ResetColor();
+                    try
+                    {
+                        _fileWriter?.Flush();
+                    }
+                    catch (IOException ex)
+                    {
+                        Console.Error.WriteLine($"Failed to write log file {_logFilePath}: {ex.Message}");
+                    }
+                }
+            }
+
+            if (batch > 0)
+            {
+                Interlocked.Add(ref _written, batch);
+                lock (_flushLock)
+                {
+                    Monitor.PulseAll(_flushLock);
+                }
+                continue;
+            }
+
+            // Nothing queued: sleep until a logger or Flush() wakes us
+            Interlocked.Exchange(ref _idle, 1);
+            _wake.Reset();
+            if (_queue.IsEmpty)
             {
-                LogLevel.Debug => ConsoleColor.Gray,
-                LogLevel.Info => ConsoleColor.White,
-                LogLevel.Warning => ConsoleColor.Yellow,
-                LogLevel.Error => ConsoleColor.Red,
-                _ => ConsoleColor.White
-            };
-
-            Console.WriteLine(message);
-            Console.ForegroundColor = originalColor;
+                _wake.Wait();
+            }
+            Interlocked.Exchange(ref _idle, 0);
         }
-        else
+    }
+
+    private static void FormatText(StringBuilder sb, LogEntry entry)
+    {
+        if (_showTimestamp)
+            sb.Append('[').Append(entry.Time.ToLocalTime().ToString("yyyy-MM-dd HH:mm:ss")).Append("] ");
+        sb.Append('[').Append(entry.Level <= LogLevel.Error ? LevelNames[(int)entry.Level] : entry.Level.ToString().ToUpper().PadRight(7)).Append("] ");
+        if (_showCategory)
+            sb.Append('[').Append(entry.Category.ToString().PadRight(8)).Append("] ");
+        sb.Append(entry.Message);
+    }
+
+    private static void FormatJson(StringBuilder sb, LogEntry entry)
+    {
+        sb.Append("{\"time\":\"").Append(entry.Time.ToString("o"))
+          .Append("\",\"level\":\"").Append(entry.Level.ToString().ToLowerInvariant())
+          .Append("\",\"category\":\"").Append(entry.Category.ToString().ToLowerInvariant())
+          .Append("\",\"message\":\"");
+        foreach (var c in entry.Message)
         {
-            Console.WriteLine(message);
+            switch (c)
+            {
+                case '"': sb.Append("\\\""); break;
+                case '\\': sb.Append("\\\\"); break;
+                case '\n': sb.Append("\\n"); break;
+                case '\r': sb.Append("\\r"); break;
+                case '\t': sb.Append("\\t"); break;
+                default:
+                    if (c < ' ')
+                        sb.Append("\\u").Append(((int)c).ToString("x4"));
+                    else
+                        sb.Append(c);
+                    break;
+            }
         }
+        sb.Append("\"}");
     }
 
+    // Padded level names, indexed by LogLevel
+    private static readonly string[] LevelNames = { "DEBUG  ", "INFO   ", "WARNING", "ERROR  " };
+
+    private static ConsoleColor ConsoleColorFor(LogLevel level) => level switch
+    {
+        LogLevel.Debug => ConsoleColor.Gray,
+        LogLevel.Info => ConsoleColor.White,
+        LogLevel.Warning => ConsoleColor.Yellow,
+        LogLevel.Error => ConsoleColor.Red,
+        _ => ConsoleColor.White
+    };
+
     /// <summary>
     /// Parse a log level from string (for command-line args).
     /// </summary>
@@ -212,3 +381,53 @@ public static class Logger
         return Enum.TryParse(value, ignoreCase: true, out level);
     }
 }
+
+/// <summary>
+/// Builds a Logger.Debug message only when debug logging is on.
+/// </summary>
+[InterpolatedStringHandler]
+public ref struct DebugMessageHandler
+{
+    private DefaultInterpolatedStringHandler _builder;
+
+    public DebugMessageHandler(int literalLength, int formattedCount, out bool isEnabled)
+    {
+        isEnabled = Logger.IsEnabled(LogLevel.Debug);
+        _builder = isEnabled ? new DefaultInterpolatedStringHandler(literalLength, formattedCount) : default;
+    }
+
+    public void AppendLiteral(string value) => _builder.AppendLiteral(value);
+    public void AppendFormatted<T>(T value) => _builder.AppendFormatted(value);
+    public void AppendFormatted<T>(T value, string? format) => _builder.AppendFormatted(value, format);
+    public void AppendFormatted<T>(T value, int alignment) => _builder.AppendFormatted(value, alignment);
+    public void AppendFormatted<T>(T value, int alignment, string? format) => _builder.AppendFormatted(value, alignment, format);
+    public void AppendFormatted(ReadOnlySpan<char> value) => _builder.AppendFormatted(value);
+    public void AppendFormatted(string? value) => _builder.AppendFormatted(value);
+
+    internal string ToStringAndClear() => _builder.ToStringAndClear();
+}
+
+/// <summary>
+/// Builds a Logger.Info message only when info logging is on.
+/// </summary>
+[InterpolatedStringHandler]
+public ref struct InfoMessageHandler
+{
+    private DefaultInterpolatedStringHandler _builder;
+
+    public InfoMessageHandler(int literalLength, int formattedCount, out bool isEnabled)
+    {
+        isEnabled = Logger.IsEnabled(LogLevel.Info);
+        _builder = isEnabled ? new DefaultInterpolatedStringHandler(literalLength, formattedCount) : default;
+    }
+
+    public void AppendLiteral(string value) => _builder.AppendLiteral(value);
+    public void AppendFormatted<T>(T value) => _builder.AppendFormatted(value);
+    public void AppendFormatted<T>(T value, string? format) => _builder.AppendFormatted(value, format);
+    public void AppendFormatted<T>(T value, int alignment) => _builder.AppendFormatted(value, alignment);
+    public void AppendFormatted<T>(T value, int alignment, string? format) => _builder.AppendFormatted(value, alignment, format);
+    public void AppendFormatted(ReadOnlySpan<char> value) => _builder.AppendFormatted(value);
+    public void AppendFormatted(string? value) => _builder.AppendFormatted(value);
+
+    internal string ToStringAndClear() => _builder.ToStringAndClear();
+}
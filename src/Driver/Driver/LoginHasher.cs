@@ -0,0 +1,107 @@
+using System.Collections.Concurrent;
+
+namespace Driver;
+
+/// <summary>
+/// Runs password hashing for logins and registrations on the thread pool.
+///
+/// A PBKDF2 hash takes tens of milliseconds by design. Done on the game
+/// thread, every login stalls the world for that long, and a client guessing
+/// passwords can stall it at will. Even on the login thread (LoginWorker) it
+/// would hold up everyone else at the prompts. Here the hash runs on a pool
+/// thread and its result comes back as a continuation, which the login thread
+/// runs when Completed wakes it. The continuation picks up that session's
+/// login state machine where it left off.
+///
+/// Hashes in flight are capped per remote address, so one host can't tie up
+/// the pool.
+/// </summary>
+public sealed class LoginHasher
+{
+    /// <summary>
+    /// Hashes one address may have running at once.
+    /// </summary>
+    public int MaxPerAddress { get; set; } = 2;
+
+    private readonly Dictionary<string, int> _inFlight = new();
+    private readonly ConcurrentQueue<Action> _completions = new();
+
+    /// <summary>
+    /// Called on the pool thread each time a continuation is queued, so
+    /// whoever runs them knows to call RunCompletions().
+    /// </summary>
+    public Action? Completed { get; init; }
+
+    /// <summary>
+    /// Hashes running now, across all addresses.
+    /// </summary>
+    public int InFlight
+    {
+        get
+        {
+            lock (_inFlight)
+            {
+                return _inFlight.Values.Sum();
+            }
+        }
+    }
+
+    /// <summary>
+    /// Run work on the pool and queue onComplete with its result. If work
+    /// throws, the error is logged and onComplete gets default(T). Returns
+    /// false, running nothing, if the address is already at its cap. A null
+    /// address (no socket behind the session) is not capped.
+    /// </summary>
+    public bool TryStart<T>(string? address, Func<T> work, Action<T> onComplete)
+    {
+        var key = address ?? "";
+        lock (_inFlight)
+        {
+            int running = _inFlight.GetValueOrDefault(key);
+            if (address != null && running >= MaxPerAddress)
+            {
+                return false;
+            }
+            _inFlight[key] = running + 1;
+        }
+
+        Task.Run(() =>
+        {
+            T result = default!;
+            try
+            {
+                result = work();
+            }
+            catch (Exception ex)
+            {
+                Logger.Error($"Password hashing failed: {ex.Message}", LogCategory.Player);
+            }
+            _completions.Enqueue(() => onComplete(result));
+            lock (_inFlight)
+            {
+                if (--_inFlight[key] == 0) _inFlight.Remove(key);
+            }
+            Completed?.Invoke();
+        });
+        return true;
+    }
+
+    /// <summary>
+    /// Run the continuations of finished hashes. Only ever from one thread at a
+    /// time: the login thread.
+    /// </summary>
+    public void RunCompletions()
+    {
+        while (_completions.TryDequeue(out var completion))
+        {
+            try
+            {
+                completion();
+            }
+            catch (Exception ex)
+            {
+                Logger.Error($"Login continuation failed: {ex.Message}", LogCategory.Player);
+            }
+        }
+    }
+}
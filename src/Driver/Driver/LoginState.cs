@@ -40,11 +40,26 @@ public enum LoginState
     /// </summary>
     RegistrationConfirm,
 
+    /// <summary>
+    /// Password being checked off the game thread.
+    /// </summary>
+    VerifyingPassword,
+
+    /// <summary>
+    /// Registration: password being hashed off the game thread.
+    /// </summary>
+    CreatingAccount,
+
     /// <summary>
     /// Successfully authenticated, transitioning to game.
     /// </summary>
     Authenticated,
 
+    /// <summary>
+    /// Authenticated, waiting in the login queue for a turn to enter the game.
+    /// </summary>
+    Admitting,
+
     /// <summary>
     /// Waiting for confirmation to take over existing active session.
     /// </summary>
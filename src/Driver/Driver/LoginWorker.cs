@@ -0,0 +1,451 @@
+namespace Driver;
+
+/// <summary>
+/// Runs the login state machine for connections that haven't authenticated
+/// yet: the banner, the name and password prompts, and registration.
+///
+/// Lines typed at those prompts never reach the game thread. GameLoop.QueueCommand
+/// hands them here instead of to the command scheduler, so a port scanner or
+/// a bot hammering the login prompt takes no turns, queue slots or tick time
+/// from players in the game. A dedicated thread works through them in
+/// arrival order; it only reads and creates accounts (AccountManager is
+/// thread safe), checks the rate limiter and writes to the output queue.
+/// Password hashes still run on the pool (LoginHasher), and their
+/// continuations come back to this thread.
+///
+/// Once a session authenticates it goes to the game loop (GameLoop.Authenticated),
+/// which checks for a session already playing as that user and queues it for
+/// admission. From then on its input goes to the game thread as before. A
+/// line that raced the state change is passed on to whichever side now owns
+/// the session.
+///
+/// The thread starts with the first line and exits after a while with
+/// nothing to do.
+/// </summary>
+public sealed class LoginWorker
+{
+    /// <summary>
+    /// How long the thread waits for work before exiting.
+    /// </summary>
+    private const int IdleExitMs = 30_000;
+
+    private const string NamePrompt = "Enter your name, or type 'new': ";
+
+    private readonly GameLoop _gameLoop;
+    private readonly object _lock = new();
+    private readonly Queue<(PlayerSession Session, string Input)> _lines = new();
+    private bool _hashDone;
+    private Thread? _thread;
+
+    public LoginWorker(GameLoop gameLoop)
+    {
+        _gameLoop = gameLoop;
+        Hasher = new LoginHasher { Completed = HashCompleted };
+    }
+
+    /// <summary>
+    /// Password hashing for logins and registrations, off this thread too.
+    /// </summary>
+    public LoginHasher Hasher { get; }
+
+    /// <summary>
+    /// Lines waiting to be handled.
+    /// </summary>
+    public int Pending
+    {
+        get
+        {
+            lock (_lock)
+            {
+                return _lines.Count;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Whether input in state is handled here rather than on the game thread.
+    /// </summary>
+    public static bool Handles(LoginState state) => state switch
+    {
+        LoginState.Welcome or LoginState.AwaitingName or LoginState.AwaitingPassword or
+        LoginState.RegistrationName or LoginState.RegistrationEmail or LoginState.RegistrationPassword or
+        LoginState.RegistrationConfirm or LoginState.VerifyingPassword or LoginState.CreatingAccount => true,
+        _ => false
+    };
+
+    /// <summary>
+    /// Send the welcome banner and first prompt to a new session. Called on
+    /// the network thread that made it.
+    /// </summary>
+    public void Greet(PlayerSession session)
+    {
+        Send(session, "\r\n");
+        Send(session, "========================================\r\n");
+        Send(session, "       Welcome to LPMud Revival!        \r\n");
+        Send(session, "========================================\r\n");
+        Send(session, "\r\n");
+        Send(session, "Enter your name, or type 'new' to create a character: ");
+        session.LoginState = LoginState.AwaitingName;
+    }
+
+    /// <summary>
+    /// Queue a line typed by session at a login prompt. Any thread.
+    /// </summary>
+    public void Enqueue(PlayerSession session, string input)
+    {
+        lock (_lock)
+        {
+            _lines.Enqueue((session, input));
+            Wake();
+        }
+    }
+
+    private void HashCompleted()
+    {
+        lock (_lock)
+        {
+            _hashDone = true;
+            Wake();
+        }
+    }
+
+    // Under _lock
+    private void Wake()
+    {
+        if (_thread == null)
+        {
+            _thread = new Thread(WorkerLoop) { Name = "Login", IsBackground = true };
+            _thread.Start();
+        }
+        Monitor.Pulse(_lock);
+    }
+
+    private void WorkerLoop()
+    {
+        while (true)
+        {
+            (PlayerSession Session, string Input)? line = null;
+            lock (_lock)
+            {
+                while (_lines.Count == 0 && !_hashDone)
+                {
+                    if (!Monitor.Wait(_lock, IdleExitMs) && _lines.Count == 0 && !_hashDone)
+                    {
+                        _thread = null;
+                        return;
+                    }
+                }
+                _hashDone = false;
+                if (_lines.Count > 0)
+                {
+                    line = _lines.Dequeue();
+                }
+            }
+
+            // Logins and registrations whose password hash finished
+            Hasher.RunCompletions();
+            if (line is var (session, input))
+            {
+                try
+                {
+                    Process(session, input);
+                }
+                catch (Exception ex)
+                {
+                    Logger.Error($"Login input failed: {ex.Message}", LogCategory.Player);
+                }
+            }
+            _gameLoop.OnOutputReady?.Invoke();
+        }
+    }
+
+    private void Process(PlayerSession session, string input)
+    {
+        // The connection may have closed while the line waited
+        if (!IsOpen(session))
+        {
+            return;
+        }
+
+        // Authenticated since it was queued: the game thread has it now
+        if (!Handles(session.LoginState))
+        {
+            _gameLoop.QueueCommand(session.ConnectionId, input);
+            return;
+        }
+
+        session.LastActivity = DateTime.UtcNow;
+        if (!_gameLoop.RateLimiter.AllowCommand(session.CommandRate))
+        {
+            Send(session, "You are sending commands too quickly. Please slow down.\r\n");
+            Logger.Warning($"Rate limited: {session.ConnectionId}", LogCategory.Network);
+            return;
+        }
+
+        input = input.Trim();
+        switch (session.LoginState)
+        {
+            case LoginState.AwaitingName:
+                HandleAwaitingName(session, input);
+                break;
+
+            case LoginState.AwaitingPassword:
+                HandleAwaitingPassword(session, input);
+                break;
+
+            case LoginState.RegistrationName:
+                HandleRegistrationName(session, input);
+                break;
+
+            case LoginState.RegistrationEmail:
+                HandleRegistrationEmail(session, input);
+                break;
+
+            case LoginState.RegistrationPassword:
+                HandleRegistrationPassword(session, input);
+                break;
+
+            case LoginState.RegistrationConfirm:
+                HandleRegistrationConfirm(session, input);
+                break;
+
+            case LoginState.VerifyingPassword:
+            case LoginState.CreatingAccount:
+                // The password hash is still running
+                Send(session, "One moment...\r\n");
+                break;
+
+            default:
+                // Shouldn't happen, but reset to awaiting name
+                session.LoginState = LoginState.AwaitingName;
+                Send(session, NamePrompt);
+                break;
+        }
+    }
+
+    private bool IsOpen(PlayerSession session) => _gameLoop.GetSession(session.ConnectionId) == session;
+
+    private void Send(PlayerSession session, string message) => _gameLoop.SendToPlayer(session.ConnectionId, message);
+
+    private void SetEcho(PlayerSession session, bool enabled) => _gameLoop.OnSetEchoMode?.Invoke(session.ConnectionId, enabled);
+
+    private void BackToName(PlayerSession session)
+    {
+        session.PendingUsername = null;
+        session.LoginState = LoginState.AwaitingName;
+        Send(session, NamePrompt);
+    }
+
+    private void HandleAwaitingName(PlayerSession session, string input)
+    {
+        if (string.IsNullOrWhiteSpace(input))
+        {
+            Send(session, NamePrompt);
+            return;
+        }
+
+        if (input.Equals("new", StringComparison.OrdinalIgnoreCase))
+        {
+            session.LoginState = LoginState.RegistrationName;
+            Send(session, "\r\nChoose a username (letters only, 3-20 characters): ");
+            return;
+        }
+
+        // Check if account exists
+        if (!_gameLoop.AccountManager.AccountExists(input))
+        {
+            Send(session, "Unknown user. Type 'new' to create a new character.\r\n");
+            Send(session, NamePrompt);
+            return;
+        }
+
+        session.PendingUsername = input.ToLowerInvariant();
+        session.LoginState = LoginState.AwaitingPassword;
+
+        // Suppress echo for password
+        SetEcho(session, false);
+        Send(session, "Password: ");
+    }
+
+    private void HandleAwaitingPassword(PlayerSession session, string input)
+    {
+        // Restore echo
+        SetEcho(session, true);
+        Send(session, "\r\n");
+
+        // Check for login lockout
+        var rateLimiter = _gameLoop.RateLimiter;
+        if (rateLimiter.IsLoginLockedOut(session.ConnectionId))
+        {
+            var remaining = rateLimiter.GetLoginLockoutRemaining(session.ConnectionId);
+            Send(session, $"Too many failed login attempts. Please wait {remaining} seconds.\r\n\r\n");
+            BackToName(session);
+            return;
+        }
+
+        var passwordHash = _gameLoop.AccountManager.GetPasswordHash(session.PendingUsername!);
+        var connectionId = session.ConnectionId;
+        session.LoginState = LoginState.VerifyingPassword;
+        if (!Hasher.TryStart(session.RemoteAddress,
+                () => passwordHash != null && AccountManager.VerifyPassword(passwordHash, input),
+                valid => FinishPasswordCheck(session, connectionId, valid)))
+        {
+            Send(session, "Too many logins in progress from your address. Please try again.\r\n\r\n");
+            BackToName(session);
+        }
+    }
+
+    /// <summary>
+    /// Continue a login once its password has been checked.
+    /// </summary>
+    private void FinishPasswordCheck(PlayerSession session, string connectionId, bool valid)
+    {
+        // The connection may have closed while the hash ran
+        if (!IsOpen(session) || session.LoginState != LoginState.VerifyingPassword)
+        {
+            return;
+        }
+
+        if (valid)
+        {
+            session.AuthenticatedUsername = session.PendingUsername;
+            _gameLoop.AccountManager.UpdateLastLogin(session.AuthenticatedUsername!);
+
+            // Clear login attempts on success
+            _gameLoop.RateLimiter.ClearLoginAttempts(connectionId);
+
+            session.LoginState = LoginState.Authenticated;
+            _gameLoop.Authenticated(session);
+        }
+        else
+        {
+            // Record failed attempt
+            _gameLoop.RateLimiter.RecordLoginAttempt(connectionId);
+
+            Send(session, "Invalid password.\r\n\r\n");
+            BackToName(session);
+        }
+    }
+
+    private void HandleRegistrationName(PlayerSession session, string input)
+    {
+        if (!IsValidUsername(input))
+        {
+            Send(session, "Invalid username. Use 3-20 letters only.\r\n");
+            Send(session, "Choose a username: ");
+            return;
+        }
+
+        // "new" is reserved for the registration command
+        if (input.Equals("new", StringComparison.OrdinalIgnoreCase))
+        {
+            Send(session, "That name is reserved.\r\n");
+            Send(session, "Choose a username: ");
+            return;
+        }
+
+        if (_gameLoop.AccountManager.AccountExists(input))
+        {
+            Send(session, "That name is already taken.\r\n");
+            Send(session, "Choose a username: ");
+            return;
+        }
+
+        session.PendingUsername = input.ToLowerInvariant();
+        session.LoginState = LoginState.RegistrationEmail;
+        Send(session, "Enter your email address: ");
+    }
+
+    private void HandleRegistrationEmail(PlayerSession session, string input)
+    {
+        // Basic email validation
+        if (string.IsNullOrWhiteSpace(input) || !input.Contains('@'))
+        {
+            Send(session, "Please enter a valid email address: ");
+            return;
+        }
+
+        session.PendingEmail = input;
+        session.LoginState = LoginState.RegistrationPassword;
+
+        SetEcho(session, false);
+        Send(session, "Choose a password (8+ characters): ");
+    }
+
+    private void HandleRegistrationPassword(PlayerSession session, string input)
+    {
+        if (input.Length < 8)
+        {
+            Send(session, "\r\nPassword must be at least 8 characters.\r\n");
+            Send(session, "Choose a password: ");
+            return;
+        }
+
+        session.PendingPassword = input;
+        session.LoginState = LoginState.RegistrationConfirm;
+        Send(session, "\r\nConfirm password: ");
+    }
+
+    private void HandleRegistrationConfirm(PlayerSession session, string input)
+    {
+        SetEcho(session, true);
+        Send(session, "\r\n");
+
+        if (input != session.PendingPassword)
+        {
+            Send(session, "Passwords do not match. Let's try again.\r\n\r\n");
+            session.PendingPassword = null;
+            session.LoginState = LoginState.RegistrationPassword;
+            SetEcho(session, false);
+            Send(session, "Choose a password (8+ characters): ");
+            return;
+        }
+
+        // Hash the password on the pool, then create the account
+        var password = session.PendingPassword!;
+        session.PendingPassword = null;
+        session.LoginState = LoginState.CreatingAccount;
+        if (!Hasher.TryStart(session.RemoteAddress,
+                () => AccountManager.HashNewPassword(password),
+                passwordHash => FinishRegistration(session, passwordHash)))
+        {
+            Send(session, "Too many logins in progress from your address. Please try again.\r\n\r\n");
+            session.LoginState = LoginState.AwaitingName;
+            Send(session, NamePrompt);
+        }
+    }
+
+    /// <summary>
+    /// Create the account once its password has been hashed.
+    /// </summary>
+    private void FinishRegistration(PlayerSession session, string? passwordHash)
+    {
+        // The connection may have closed while the hash ran
+        if (!IsOpen(session) || session.LoginState != LoginState.CreatingAccount)
+        {
+            return;
+        }
+
+        if (passwordHash != null &&
+            _gameLoop.AccountManager.CreateAccountWithHash(session.PendingUsername!, session.PendingEmail!, passwordHash))
+        {
+            Send(session, "\r\nAccount created successfully!\r\n\r\n");
+            session.AuthenticatedUsername = session.PendingUsername;
+            session.LoginState = LoginState.Authenticated;
+            _gameLoop.Authenticated(session);
+        }
+        else
+        {
+            Send(session, "Failed to create account. Please try again.\r\n\r\n");
+            session.LoginState = LoginState.AwaitingName;
+            Send(session, NamePrompt);
+        }
+    }
+
+    private static bool IsValidUsername(string name)
+    {
+        if (string.IsNullOrWhiteSpace(name)) return false;
+        if (name.Length < 3 || name.Length > 20) return false;
+        return name.All(char.IsLetter);
+    }
+}
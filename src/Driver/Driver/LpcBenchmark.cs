@@ -0,0 +1,102 @@
+using System.Diagnostics;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// Results of timing one LPC function with --bench.
+/// </summary>
+public sealed class BenchResult
+{
+    public required string Object { get; init; }
+    public required string Function { get; init; }
+    public long Iterations { get; init; }
+    public double Seconds { get; init; }
+    public double NanosecondsPerCall => Iterations > 0 ? Seconds * 1e9 / Iterations : 0;
+    public double BytesPerCall { get; init; }
+    public double InstructionsPerCall { get; init; }
+    public int Gen0Collections { get; init; }
+    public object? Result { get; init; }
+
+    public override string ToString()
+    {
+        var sb = new StringBuilder();
+        sb.AppendLine($"{Object}->{Function}(): {Iterations} calls in {Seconds * 1000:F1} ms");
+        sb.AppendLine($"  {NanosecondsPerCall,12:F1} ns/call");
+        sb.AppendLine($"  {BytesPerCall,12:F1} bytes allocated/call ({Gen0Collections} gen0 GCs)");
+        sb.AppendLine($"  {InstructionsPerCall,12:F1} LPC instructions/call");
+        sb.AppendLine($"  returned {SprintfFormat.FormatValue(Result ?? 0L)}");
+        return sb.ToString();
+    }
+}
+
+/// <summary>
+/// Times an LPC function, for --bench, the bench() efun and the bench_*
+/// functions of lpc-tests: call it enough times to get it through the JIT
+/// threshold, then time iterations calls on this thread. Allocations are the thread's, so the
+/// game loop and other threads don't count; instructions are the VM's own
+/// count, as the tick profiler and CPU accounts see them.
+/// </summary>
+public static class LpcBenchmark
+{
+    /// <summary>
+    /// Calls made before timing starts.
+    /// </summary>
+    public const int WarmupCalls = 1000;
+
+    public static BenchResult Run(ObjectManager objectManager, string path, string function, long iterations)
+    {
+        var target = objectManager.FindObject(path) ?? objectManager.LoadObject(path);
+        if (target.FindFunction(function) == null)
+        {
+            throw new ObjectInterpreterException($"Function '{function}' not found in object {target.ObjectName}");
+        }
+
+        return Measure(objectManager.Interpreter!, target, function, new List<object>(), iterations, WarmupCalls);
+    }
+
+    /// <summary>
+    /// Call target's function warmup times, then time iterations calls. With
+    /// a limit, both stop once that much time has gone by, and Iterations is
+    /// the number of timed calls actually made. Each call starts with a fresh
+    /// instruction count, so only a single call can hit the instruction limit.
+    /// </summary>
+    public static BenchResult Measure(ObjectInterpreter interpreter, MudObject target, string function,
+        List<object> args, long iterations, long warmup, TimeSpan? limit = null)
+    {
+        var started = Stopwatch.StartNew();
+        bool OverTime(long i) => limit != null && (i & 63) == 63 && started.Elapsed > limit;
+
+        object? result = null;
+        for (long i = 0; i < warmup && !OverTime(i); i++)
+        {
+            interpreter.ResetInstructionCount();
+            result = interpreter.CallFunctionOnObject(target, function, args);
+        }
+
+        int gen0 = GC.CollectionCount(0);
+        long bytes = GC.GetAllocatedBytesForCurrentThread();
+        long instructions = interpreter.ThreadInstructions;
+        long calls = 0;
+        var clock = Stopwatch.StartNew();
+        while (calls < iterations)
+        {
+            interpreter.ResetInstructionCount();
+            result = interpreter.CallFunctionOnObject(target, function, args);
+            if (OverTime(calls++)) break;
+        }
+        clock.Stop();
+
+        return new BenchResult
+        {
+            Object = target.ObjectName,
+            Function = function,
+            Iterations = calls,
+            Seconds = clock.Elapsed.TotalSeconds,
+            BytesPerCall = calls > 0 ? (double)(GC.GetAllocatedBytesForCurrentThread() - bytes) / calls : 0,
+            InstructionsPerCall = calls > 0 ? (double)(interpreter.ThreadInstructions - instructions) / calls : 0,
+            Gen0Collections = GC.CollectionCount(0) - gen0,
+            Result = result
+        };
+    }
+}
@@ -0,0 +1,83 @@
+using System.Runtime.CompilerServices;
+
+namespace Driver;
+
+/// <summary>
+/// LPC's equality on values, for mapping keys, switch cases and
+/// member_array().
+///
+/// Integers are equal by value whatever their width: efuns hand back both
+/// int and long, and a boxed int never Equals() a boxed long, so m[1] could
+/// miss a key stored by another path. Strings compare ordinally. Objects,
+/// arrays and mappings are equal only to themselves. Anything else (floats)
+/// falls back to Equals().
+///
+/// The common keys are tested by type before any virtual call, so hashing a
+/// string or integer key doesn't go through object.Equals()/GetHashCode().
+/// </summary>
+public sealed class LpcValueComparer : IEqualityComparer<object>
+{
+    public static readonly LpcValueComparer Instance = new();
+
+    private LpcValueComparer()
+    {
+    }
+
+    public new bool Equals(object? a, object? b)
+    {
+        if (ReferenceEquals(a, b)) return true;
+        if (a == null || b == null) return false;
+
+        switch (a)
+        {
+            case string sa:
+                return b is string sb && string.Equals(sa, sb);
+            case long la:
+                return b is long lb ? la == lb : b is int ib && la == ib;
+            case int ia:
+                return b is long lb2 ? ia == lb2 : b is int ib2 && ia == ib2;
+            case MudObject or List<object> or Dictionary<object, object>:
+                return false;
+            default:
+                return a.Equals(b);
+        }
+    }
+
+    public int GetHashCode(object value)
+    {
+        return value switch
+        {
+            string s => s.GetHashCode(),
+            long l => l.GetHashCode(),
+            int i => ((long)i).GetHashCode(),
+            MudObject or List<object> or Dictionary<object, object> => RuntimeHelpers.GetHashCode(value),
+            _ => value.GetHashCode()
+        };
+    }
+}
+
+/// <summary>
+/// An LPC mapping: a Dictionary keyed with LPC's equality (LpcValueComparer).
+/// Every mapping the driver makes is one of these; code that only reads a
+/// mapping can keep treating it as a Dictionary&lt;object, object&gt;.
+/// </summary>
+public sealed class LpcMapping : Dictionary<object, object>
+{
+    public LpcMapping()
+        : base(LpcValueComparer.Instance)
+    {
+    }
+
+    public LpcMapping(int capacity)
+        : base(capacity, LpcValueComparer.Instance)
+    {
+    }
+
+    /// <summary>
+    /// A shallow copy of source.
+    /// </summary>
+    public LpcMapping(IDictionary<object, object> source)
+        : base(source, LpcValueComparer.Instance)
+    {
+    }
+}
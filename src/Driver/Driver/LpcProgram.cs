@@ -1,3 +1,5 @@
+using System.Collections.Concurrent;
+
 namespace Driver;
 
 /// <summary>
@@ -24,6 +26,20 @@ public class LpcProgram
     /// </summary>
     public Dictionary<string, FunctionDefinition> Functions { get; } = new();
 
+    /// <summary>
+    /// Bytecode for functions defined in this program, keyed by function name.
+    /// Functions the compiler can't lower are absent and run on the tree walker.
+    /// </summary>
+    public Dictionary<string, CompiledFunction> CompiledFunctions { get; } = new();
+
+    /// <summary>
+    /// Bytecode for functions whose bodies were left for lazy parsing,
+    /// lowered by LowerDeferred() on their first call. Kept apart from
+    /// CompiledFunctions, which is only written while the program is built,
+    /// because region workers may call one for the first time at once.
+    /// </summary>
+    private readonly ConcurrentDictionary<string, CompiledFunction> _lowered = new();
+
     /// <summary>
     /// Variable declarations in this program (not including inherited variables).
     /// This defines what variables should be created when an object is instantiated.
@@ -31,15 +47,42 @@ public class LpcProgram
     public List<string> VariableNames { get; } = new();
 
     /// <summary>
-    /// The parsed AST of the program (for potential future use).
-    /// Currently null as we'll build this up incrementally.
+    /// Declared type of each of this program's variables ("int", "string *", ...).
+    /// </summary>
+    public Dictionary<string, string> VariableTypes { get; } = new();
+
+    /// <summary>
+    /// This program's own top-level variable declarations that have an
+    /// initializer, in source order. They are all the top-level statements a
+    /// compiled program needs beyond its functions (see BuildInitialState).
+    /// </summary>
+    public List<VariableDeclaration> VariableInitializers { get; } = new();
+
+    /// <summary>
+    /// Where each line of the preprocessed source came from, for errors and
+    /// stack traces. The source text itself isn't kept (bar bodies left for
+    /// lazy parsing); it is read from disk when someone needs to see it.
     /// </summary>
-    public Statement? Ast { get; set; }
+    public SourceMap? LineMap { get; set; }
 
     /// <summary>
-    /// Source code text (for debugging/hot-reload).
+    /// A hash of each function's source text and position. A hot reload
+    /// keeps the definition (and bytecode) of every function whose hash
+    /// didn't change.
     /// </summary>
-    public string? SourceCode { get; set; }
+    public Dictionary<string, long> FunctionFingerprints { get; } = new();
+
+    /// <summary>
+    /// Full paths of the files #included into this program's source. Hot
+    /// reload uses it to find the programs a changed header affects.
+    /// </summary>
+    public IReadOnlyList<string> IncludedFiles { get; set; } = Array.Empty<string>();
+
+    /// <summary>
+    /// Costly patterns PerfLint found in this program's own source, for
+    /// perf_warnings() and the update command.
+    /// </summary>
+    public IReadOnlyList<PerfWarning> PerfWarnings { get; set; } = Array.Empty<PerfWarning>();
 
     /// <summary>
     /// Time this program was compiled (for hot-reload tracking).
@@ -53,60 +96,80 @@ public class LpcProgram
     }
 
     /// <summary>
-    /// Finds a function in this program or its inheritance chain.
-    /// Searches depth-first through inherited programs.
-    /// Private functions are not inherited (but static functions ARE inherited).
+    /// Every function callable on this program: its own functions (including
+    /// private ones) plus inherited non-private ones, resolved depth-first in
+    /// inheritance order. Built once per program; hot reload builds a new
+    /// program (and rebuilds its descendants onto it), each with a fresh table.
     /// </summary>
-    /// <param name="name">Function name to find</param>
-    /// <returns>Function definition or null if not found</returns>
-    public FunctionDefinition? FindFunction(string name)
+    private Dictionary<string, FunctionEntry>? _functionTable;
+
+    /// <summary>
+    /// What inheriting programs see: like _functionTable but without private
+    /// functions at any level (private = not inherited).
+    /// </summary>
+    private Dictionary<string, FunctionEntry>? _inheritableTable;
+
+    /// <summary>
+    /// Build the flattened lookup tables. Called by the compiler once Functions
+    /// and InheritedPrograms are complete; lookups build them lazily otherwise.
+    /// </summary>
+    public void BuildFunctionTables()
     {
-        // Check this program first
-        if (Functions.TryGetValue(name, out var func))
+        var table = new Dictionary<string, FunctionEntry>();
+        var inheritable = new Dictionary<string, FunctionEntry>();
+
+        foreach (var (name, func) in Functions)
         {
-            return func;
+            var entry = new FunctionEntry(func, this);
+            table[name] = entry;
+            if ((func.Visibility & FunctionVisibility.Private) == 0)
+            {
+                inheritable[name] = entry;
+            }
         }
 
-        // Check inherited programs in order (private functions are NOT inherited)
+        // Earlier parents win, and a parent's own functions beat its ancestors'
+        // (the parent table is already ordered that way)
         foreach (var inherited in InheritedPrograms)
         {
-            var result = inherited.FindFunctionExcludingPrivate(name);
-            if (result != null)
+            foreach (var (name, entry) in inherited.InheritableTable)
             {
-                return result;
+                table.TryAdd(name, entry);
+                inheritable.TryAdd(name, entry);
             }
         }
 
-        return null;
+        _inheritableTable = inheritable;
+        _functionTable = table;
     }
 
-    /// <summary>
-    /// Finds a function excluding private functions (for inheritance lookup).
-    /// In LPC: private = not inherited, static = inherited but not call_other callable.
-    /// </summary>
-    private FunctionDefinition? FindFunctionExcludingPrivate(string name)
+    private Dictionary<string, FunctionEntry> FunctionTable
     {
-        // Check this program first, but skip private functions
-        if (Functions.TryGetValue(name, out var func))
+        get
         {
-            if ((func.Visibility & FunctionVisibility.Private) == 0)
-            {
-                return func;
-            }
-            // Private function found but not returned - keep searching parents
+            if (_functionTable == null) BuildFunctionTables();
+            return _functionTable!;
         }
+    }
 
-        // Check inherited programs in order
-        foreach (var inherited in InheritedPrograms)
+    private Dictionary<string, FunctionEntry> InheritableTable
+    {
+        get
         {
-            var result = inherited.FindFunctionExcludingPrivate(name);
-            if (result != null)
-            {
-                return result;
-            }
+            if (_inheritableTable == null) BuildFunctionTables();
+            return _inheritableTable!;
         }
+    }
 
-        return null;
+    /// <summary>
+    /// Finds a function in this program or its inheritance chain.
+    /// Private functions are not inherited (but static functions ARE inherited).
+    /// </summary>
+    /// <param name="name">Function name to find</param>
+    /// <returns>Function definition or null if not found</returns>
+    public FunctionDefinition? FindFunction(string name)
+    {
+        return FunctionTable.TryGetValue(name, out var entry) ? entry.Function : null;
     }
 
     /// <summary>
@@ -119,16 +182,35 @@ public class LpcProgram
     /// <returns>Tuple of (function, owning program) or (null, null) if not found</returns>
     public (FunctionDefinition? Function, LpcProgram? OwningProgram) FindFunctionWithProgram(string name)
     {
-        // Check this program first
-        if (Functions.TryGetValue(name, out var func))
-        {
-            return (func, this);
-        }
+        return FunctionTable.TryGetValue(name, out var entry)
+            ? (entry.Function, entry.OwningProgram)
+            : (null, null);
+    }
+
+    /// <summary>
+    /// All functions callable on this program, keyed by name.
+    /// </summary>
+    public IReadOnlyDictionary<string, FunctionEntry> AllFunctions => FunctionTable;
+
+    /// <summary>
+    /// Finds a function in parent programs only (for :: operator).
+    /// </summary>
+    /// <param name="name">Function name to find</param>
+    /// <returns>Function definition or null if not found</returns>
+    public FunctionDefinition? FindParentFunction(string name)
+    {
+        return FindParentFunctionWithProgram(name).Function;
+    }
 
-        // Check inherited programs in order (private functions are NOT inherited)
+    /// <summary>
+    /// Finds a function in parent programs only, with the program that defines it.
+    /// </summary>
+    public (FunctionDefinition? Function, LpcProgram? OwningProgram) FindParentFunctionWithProgram(string name)
+    {
+        // Only search inherited programs, not this one
         foreach (var inherited in InheritedPrograms)
         {
-            var result = inherited.FindFunctionWithProgramExcludingPrivate(name);
+            var result = inherited.FindFunctionWithProgram(name);
             if (result.Function != null)
             {
                 return result;
@@ -139,72 +221,291 @@ public class LpcProgram
     }
 
     /// <summary>
-    /// Finds a function excluding private functions (for inheritance lookup with program).
+    /// Gets all variable names including inherited ones.
+    /// Used when initializing a new object instance.
     /// </summary>
-    private (FunctionDefinition? Function, LpcProgram? OwningProgram) FindFunctionWithProgramExcludingPrivate(string name)
+    /// <returns>List of all variable names in inheritance order</returns>
+    public List<string> GetAllVariableNames()
     {
-        // Check this program first, but skip private functions
-        if (Functions.TryGetValue(name, out var func))
+        var allVars = new List<string>();
+
+        // Add inherited variables first (parents before children)
+        foreach (var inherited in InheritedPrograms)
         {
-            if ((func.Visibility & FunctionVisibility.Private) == 0)
-            {
-                return (func, this);
-            }
+            allVars.AddRange(inherited.GetAllVariableNames());
         }
 
-        // Check inherited programs in order
+        // Add this program's variables
+        allVars.AddRange(VariableNames);
+
+        return allVars;
+    }
+
+    /// <summary>
+    /// Declared types of all variables including inherited ones; a variable
+    /// declared again further down the chain has the later declaration's type.
+    /// </summary>
+    public Dictionary<string, string> GetAllVariableTypes()
+    {
+        var allTypes = new Dictionary<string, string>();
         foreach (var inherited in InheritedPrograms)
         {
-            var result = inherited.FindFunctionWithProgramExcludingPrivate(name);
-            if (result.Function != null)
+            foreach (var (name, type) in inherited.GetAllVariableTypes())
             {
-                return result;
+                allTypes[name] = type;
             }
         }
+        foreach (var (name, type) in VariableTypes)
+        {
+            allTypes[name] = type;
+        }
+        return allTypes;
+    }
 
-        return (null, null);
+    /// <summary>
+    /// Bytecode for function, a deferred function of this program: parsed
+    /// and lowered on the first call, then reused, with its tree dropped
+    /// again. Null if the VM can't run it, in which case the parsed tree is
+    /// kept for the tree walker. A syntax error in the body is thrown from here.
+    /// </summary>
+    public CompiledFunction? LowerDeferred(FunctionDefinition function)
+    {
+        if (_lowered.TryGetValue(function.Name, out var compiled) && ReferenceEquals(compiled.Definition, function))
+        {
+            return compiled;
+        }
+
+        compiled = BytecodeCompiler.Compile(function, GetAllVariableNames().ToHashSet(), GetAllVariableTypes());
+        if (compiled == null)
+        {
+            _ = function.Body;
+            return null;
+        }
+        _lowered[function.Name] = compiled;
+        return compiled;
     }
 
     /// <summary>
-    /// Finds a function in parent programs only (for :: operator).
+    /// Slot layout for object variables, computed on first use.
+    /// Programs are immutable once compiled, so the layout never changes;
+    /// hot reload produces a new program with a new layout.
     /// </summary>
-    /// <param name="name">Function name to find</param>
-    /// <returns>Function definition or null if not found</returns>
-    public FunctionDefinition? FindParentFunction(string name)
+    public VariableLayout VariableLayout => _variableLayout ??= new VariableLayout(GetAllVariableNames());
+
+    private VariableLayout? _variableLayout;
+
+    /// <summary>
+    /// Take over a previous program's layout if it has the same variables in
+    /// the same order, so a hot reload that only touched code leaves every
+    /// object's slots (and the bytecode slot caches keyed on the layout) alone.
+    /// </summary>
+    public bool AdoptVariableLayout(VariableLayout previous)
     {
-        // Only search inherited programs, not this one
-        foreach (var inherited in InheritedPrograms)
+        if (_variableLayout != null && !ReferenceEquals(_variableLayout, previous)) return false;
+        if (!GetAllVariableNames().Distinct().SequenceEqual(previous.Names)) return false;
+        _variableLayout = previous;
+        return true;
+    }
+
+    /// <summary>
+    /// Whether this program's init() does anything. An init() that is empty,
+    /// or only calls ::init() on a parent whose init() does nothing (the
+    /// placeholder /std/object has), counts as none, and move_object() skips it.
+    /// </summary>
+    public bool HasInit => _hasInit ??= InitDoesSomething(FindFunctionWithProgram("init"));
+
+    private bool? _hasInit;
+
+    /// <summary>
+    /// Whether the variable initializers and create() only set up the object's
+    /// own state, so clones can start from a ClonePrototype instead of running them.
+    /// </summary>
+    internal bool HasDeclarativeCreate => _hasDeclarativeCreate ??= ClonePrototype.IsDeclarative(this);
+
+    private bool? _hasDeclarativeCreate;
+
+    /// <summary>
+    /// The state captured from this program's first clone after create(), when
+    /// HasDeclarativeCreate. Null until then, or if the capture was refused.
+    /// </summary>
+    internal ClonePrototype? Prototype { get; set; }
+
+    /// <summary>
+    /// Set once a clone's state couldn't be captured, so later clones don't retry.
+    /// </summary>
+    internal bool PrototypeRefused { get; set; }
+
+    private static bool InitDoesSomething((FunctionDefinition? Function, LpcProgram? OwningProgram) init)
+    {
+        if (init.Function == null || init.OwningProgram == null) return false;
+        if (init.Function.ReadBody() is not BlockStatement body) return true;
+
+        foreach (var stmt in body.Statements)
         {
-            var result = inherited.FindFunction(name);
-            if (result != null)
+            if (stmt is ExpressionStatement { Expression: FunctionCall { IsParentCall: true, Name: "init", Arguments.Count: 0 } })
             {
-                return result;
+                if (InitDoesSomething(init.OwningProgram.FindParentFunctionWithProgram("init"))) return true;
+                continue;
             }
+            return true;
         }
+        return false;
+    }
 
-        return null;
+    /// <summary>
+    /// What a new object's variable slots hold before its initializers run,
+    /// one entry per VariableLayout slot. Objects start as a block copy of it.
+    /// Constant initializers (numbers and strings) are already applied.
+    /// </summary>
+    internal LpcValue[] InitialVariables
+    {
+        get
+        {
+            if (_initialVariables == null) BuildInitialState();
+            return _initialVariables!;
+        }
     }
 
     /// <summary>
-    /// Gets all variable names including inherited ones.
-    /// Used when initializing a new object instance.
+    /// Slots initialized to an empty array ({}) or mapping ([]). Those can't be
+    /// shared through the image, so each object gets its own.
     /// </summary>
-    /// <returns>List of all variable names in inheritance order</returns>
-    public List<string> GetAllVariableNames()
+    internal (int Slot, bool IsMapping)[] EmptyContainerSlots
     {
-        var allVars = new List<string>();
+        get
+        {
+            if (_initialVariables == null) BuildInitialState();
+            return _emptyContainerSlots!;
+        }
+    }
 
-        // Add inherited variables first (parents before children)
-        foreach (var inherited in InheritedPrograms)
+    /// <summary>
+    /// Initializers the image can't hold, in declaration order. Only these
+    /// still run through the interpreter for each new object.
+    /// </summary>
+    internal VariableDeclaration[] DynamicInitializers
+    {
+        get
         {
-            allVars.AddRange(inherited.GetAllVariableNames());
+            if (_initialVariables == null) BuildInitialState();
+            return _dynamicInitializers!;
         }
+    }
 
-        // Add this program's variables
-        allVars.AddRange(VariableNames);
+    private LpcValue[]? _initialVariables;
+    private (int Slot, bool IsMapping)[]? _emptyContainerSlots;
+    private VariableDeclaration[]? _dynamicInitializers;
 
-        return allVars;
+    private void BuildInitialState()
+    {
+        var image = new LpcValue[VariableLayout.Count];
+        Array.Fill(image, LpcValue.FromObject(0));
+        var containers = new Dictionary<int, bool>();
+        var dynamic = new List<VariableDeclaration>();
+        var dynamicNames = new HashSet<string>();
+
+        foreach (var varDecl in VariableInitializers)
+        {
+            var initializer = varDecl.Initializer!;
+            int slot = VariableLayout.IndexOf(varDecl.Name);
+
+            // Once a variable has a dynamic initializer, later ones for it
+            // have to run after it
+            if (slot < 0 || dynamicNames.Contains(varDecl.Name))
+            {
+                dynamic.Add(varDecl);
+                continue;
+            }
+
+            switch (initializer)
+            {
+                case NumberLiteral number:
+                    image[slot] = LpcValue.FromObject(number.Value);
+                    containers.Remove(slot);
+                    break;
+                case StringLiteral str:
+                    image[slot] = LpcValue.FromObject(str.Value);
+                    containers.Remove(slot);
+                    break;
+                case ArrayLiteral { Elements.Count: 0 }:
+                    containers[slot] = false;
+                    break;
+                case MappingLiteral { Entries.Count: 0 }:
+                    containers[slot] = true;
+                    break;
+                default:
+                    dynamic.Add(varDecl);
+                    dynamicNames.Add(varDecl.Name);
+                    break;
+            }
+        }
+
+        _emptyContainerSlots = containers.Select(pair => (pair.Key, pair.Value)).ToArray();
+        _dynamicInitializers = dynamic.ToArray();
+        Volatile.Write(ref _initialVariables, image);
     }
 
     public override string ToString() => $"LpcProgram({FilePath})";
 }
+
+/// <summary>
+/// A resolved entry in a program's flattened function table.
+/// </summary>
+public readonly record struct FunctionEntry(FunctionDefinition Function, LpcProgram OwningProgram)
+{
+    public FunctionVisibility Visibility => Function.Visibility;
+}
+
+/// <summary>
+/// Maps object variable names to slots in a clone's flat variable array.
+/// Inherited variables come first, in inheritance order. A name that appears
+/// more than once in the chain (diamond inheritance) gets a single slot.
+/// </summary>
+public sealed class VariableLayout
+{
+    private readonly Dictionary<string, int> _slots;
+
+    /// <summary>
+    /// A layout with no variables.
+    /// </summary>
+    public static readonly VariableLayout Empty = new(Array.Empty<string>());
+
+    /// <summary>
+    /// Variable names in slot order.
+    /// </summary>
+    public string[] Names { get; }
+
+    public int Count => Names.Length;
+
+    public VariableLayout(IEnumerable<string> names)
+    {
+        _slots = new Dictionary<string, int>();
+        var ordered = new List<string>();
+        foreach (var name in names)
+        {
+            if (_slots.TryAdd(name, ordered.Count))
+            {
+                ordered.Add(name);
+            }
+        }
+        Names = ordered.ToArray();
+    }
+
+    /// <summary>
+    /// Slot index for a variable, or -1 if this layout has no such variable.
+    /// </summary>
+    public int IndexOf(string name)
+    {
+        return _slots.TryGetValue(name, out var slot) ? slot : -1;
+    }
+
+    /// <summary>
+    /// For each of this layout's slots, the slot holding the same variable in
+    /// previous (-1 for variables previous doesn't have). Computed once per
+    /// reload and applied to every object on the old layout.
+    /// </summary>
+    public int[] MapFrom(VariableLayout previous)
+    {
+        return Array.ConvertAll(Names, previous.IndexOf);
+    }
+}
@@ -0,0 +1,119 @@
+using System.Diagnostics;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// One line of a --test run: a file's run_tests(), one of its bench_*
+/// functions, or the file itself if it didn't compile.
+/// </summary>
+public sealed record LpcTestResult(string File, string Function, double Milliseconds, string? Error, BenchResult? Bench)
+{
+    public bool Passed => Error == null;
+}
+
+/// <summary>
+/// The results of a --test run, printed as a table.
+/// </summary>
+public sealed class LpcTestReport
+{
+    public List<LpcTestResult> Results { get; } = new();
+
+    public int Failed => Results.Count(result => !result.Passed);
+
+    public override string ToString()
+    {
+        var sb = new StringBuilder();
+        foreach (var result in Results)
+        {
+            var label = $"{result.File} {result.Function}";
+            if (!result.Passed)
+            {
+                sb.AppendLine($"  FAIL  {label,-48} {result.Error}");
+            }
+            else if (result.Bench is { } bench)
+            {
+                sb.AppendLine($"  BENCH {label,-48} {bench.Iterations,9} calls {bench.NanosecondsPerCall,12:F1} ns " +
+                              $"{bench.BytesPerCall,10:F1} B {bench.InstructionsPerCall,10:F1} instr /call");
+            }
+            else
+            {
+                sb.AppendLine($"  PASS  {label,-48} {result.Milliseconds,9:F1} ms");
+            }
+        }
+
+        int passed = Results.Count(result => result.Passed && result.Bench == null);
+        int benches = Results.Count(result => result.Bench != null);
+        sb.AppendLine($"{passed} passed, {Failed} failed, {benches} benchmarks");
+        return sb.ToString();
+    }
+}
+
+/// <summary>
+/// Runs the LPC test files of a directory (lpc-tests/) against a mudlib, for
+/// driver --test. Each file is compiled as /lpc-tests/&lt;name&gt; without
+/// being copied into the mudlib. Its run_tests() passes if it returns
+/// without an error (assert() throws one), and each of its bench_*
+/// functions is timed as --bench would, so a slowdown in mudlib code shows
+/// up next to the tests that cover it.
+/// </summary>
+public static class LpcTestRunner
+{
+    public const string TestRoot = "/lpc-tests";
+    public const string BenchPrefix = "bench_";
+
+    public static LpcTestReport Run(ObjectManager objectManager, string directory, long iterations)
+    {
+        var interpreter = objectManager.Interpreter!;
+        var report = new LpcTestReport();
+
+        foreach (var file in Directory.GetFiles(directory, "*.c").Order(StringComparer.Ordinal))
+        {
+            var name = Path.GetFileName(file);
+            MudObject test;
+            try
+            {
+                test = objectManager.LoadSource($"{TestRoot}/{Path.GetFileNameWithoutExtension(file)}", File.ReadAllText(file));
+            }
+            catch (Exception ex) when (ex is not OutOfMemoryException)
+            {
+                report.Results.Add(new LpcTestResult(name, "(compile)", 0, ex.Message, null));
+                continue;
+            }
+
+            if (test.FindFunction("run_tests") != null)
+            {
+                var clock = Stopwatch.StartNew();
+                string? error = null;
+                try
+                {
+                    interpreter.ResetInstructionCount();
+                    interpreter.CallFunctionOnObject(test, "run_tests", new List<object>());
+                }
+                catch (Exception ex) when (ex is not OutOfMemoryException)
+                {
+                    error = ex.Message;
+                }
+                report.Results.Add(new LpcTestResult(name, "run_tests()", clock.Elapsed.TotalMilliseconds, error, null));
+            }
+
+            foreach (var function in test.Program.Functions.Keys
+                         .Where(function => function.StartsWith(BenchPrefix, StringComparison.Ordinal))
+                         .Order(StringComparer.Ordinal))
+            {
+                try
+                {
+                    var bench = LpcBenchmark.Measure(interpreter, test, function, new List<object>(), iterations,
+                        LpcBenchmark.WarmupCalls);
+                    report.Results.Add(new LpcTestResult(name, function + "()", bench.Seconds * 1000, null, bench));
+                }
+                catch (Exception ex) when (ex is not OutOfMemoryException)
+                {
+                    report.Results.Add(new LpcTestResult(name, function + "()", 0, ex.Message, null));
+                }
+            }
+        }
+
+        return report;
+    }
+}
@@ -0,0 +1,142 @@
+using System.Runtime.CompilerServices;
+
+namespace Driver;
+
+/// <summary>
+/// Type tag for <see cref="LpcValue"/>.
+/// Int is zero so default(LpcValue) is the LPC default value 0.
+/// </summary>
+public enum LpcValueKind : byte
+{
+    Int,
+    Null,
+    String,
+    Object,
+    Array,
+    Mapping,
+    Other       // Driver-internal values (iterators, sscanf results, etc.)
+}
+
+/// <summary>
+/// An LPC value without boxing for integers.
+/// The VM's frames and object variable storage hold these, so integer-heavy
+/// code (combat math, counters, loops) runs without allocating.
+///
+/// Everything outside the VM - efuns, the tree walker, arrays and mappings -
+/// still uses plain object values; ToObject() and FromObject() convert at
+/// that boundary. An integer that arrived boxed keeps its box, so round trips
+/// return the same object (including int-typed results from sscanf).
+/// </summary>
+public readonly struct LpcValue
+{
+    /// <summary>
+    /// Reference payload: the string/object/array/mapping, or the original box of an Int.
+    /// </summary>
+    private readonly object? _ref;
+    private readonly long _int;
+
+    public LpcValueKind Kind { get; }
+
+    public static readonly LpcValue Zero = default;
+    public static readonly LpcValue Null = new(LpcValueKind.Null, 0, null);
+
+    private LpcValue(LpcValueKind kind, long i, object? r)
+    {
+        Kind = kind;
+        _int = i;
+        _ref = r;
+    }
+
+    public bool IsInt => Kind == LpcValueKind.Int;
+    public bool IsNull => Kind == LpcValueKind.Null;
+
+    /// <summary>
+    /// The integer value. Only meaningful when IsInt.
+    /// </summary>
+    public long Int => _int;
+
+    /// <summary>
+    /// The reference payload (string, MudObject, array, mapping or internal value).
+    /// </summary>
+    public object? Ref => _ref;
+
+    [MethodImpl(MethodImplOptions.AggressiveInlining)]
+    public static LpcValue FromInt(long value) => new(LpcValueKind.Int, value, null);
+
+    /// <summary>
+    /// An array or mapping marked as held by nothing but the frame slot it is
+    /// stored in, which AppendLocal may grow in place. Only that slot carries
+    /// the mark: loading the value hands on an unmarked copy.
+    /// </summary>
+    internal static LpcValue Owned(List<object> array) => new(LpcValueKind.Array, 1, array);
+
+    internal static LpcValue Owned(Dictionary<object, object> mapping) => new(LpcValueKind.Mapping, 1, mapping);
+
+    internal bool IsOwned => Kind is LpcValueKind.Array or LpcValueKind.Mapping && _int != 0;
+
+    public static LpcValue FromBool(bool value) => new(LpcValueKind.Int, value ? 1 : 0, null);
+
+    public static LpcValue FromObject(object? value) => value switch
+    {
+        long l => new LpcValue(LpcValueKind.Int, l, value),
+        int i => new LpcValue(LpcValueKind.Int, i, value),
+        string => new LpcValue(LpcValueKind.String, 0, value),
+        MudObject => new LpcValue(LpcValueKind.Object, 0, value),
+        List<object> => new LpcValue(LpcValueKind.Array, 0, value),
+        Dictionary<object, object> => new LpcValue(LpcValueKind.Mapping, 0, value),
+        null => Null,
+        _ => new LpcValue(LpcValueKind.Other, 0, value)
+    };
+
+    /// <summary>
+    /// Box for the rest of the driver. Ints reuse their original box or a cached
+    /// small-integer box where possible.
+    /// </summary>
+    public object? ToObject()
+    {
+        if (Kind == LpcValueKind.Int)
+        {
+            return _ref ?? Box(_int);
+        }
+        return _ref;
+    }
+
+    /// <summary>
+    /// LPC truthiness: non-zero ints, non-empty strings and any other non-null value.
+    /// </summary>
+    public bool IsTrue => Kind switch
+    {
+        LpcValueKind.Int => _int != 0,
+        LpcValueKind.Null => false,
+        LpcValueKind.String => ((string)_ref!).Length != 0,
+        _ => true
+    };
+
+    private const int SmallIntMin = -128;
+    private const int SmallIntMax = 1023;
+    private static readonly object[] SmallInts = CreateSmallInts();
+
+    private static object[] CreateSmallInts()
+    {
+        var boxes = new object[SmallIntMax - SmallIntMin + 1];
+        for (int i = 0; i < boxes.Length; i++)
+        {
+            boxes[i] = (long)(i + SmallIntMin);
+        }
+        return boxes;
+    }
+
+    /// <summary>
+    /// Box a long, sharing boxes for common small values.
+    /// </summary>
+    public static object Box(long value)
+    {
+        if (value >= SmallIntMin && value <= SmallIntMax)
+        {
+            return SmallInts[value - SmallIntMin];
+        }
+        return value;
+    }
+
+    public override string ToString() => ToObject()?.ToString() ?? "null";
+}
@@ -0,0 +1,85 @@
+namespace Driver;
+
+/// <summary>
+/// A bounded map that drops its least recently used entry when full.
+/// Thread-safe; used for the driver's parsed-pattern caches.
+/// </summary>
+public sealed class LruCache<TKey, TValue> where TKey : notnull
+{
+    private readonly object _lock = new();
+    private readonly Dictionary<TKey, LinkedListNode<(TKey Key, TValue Value)>> _entries = new();
+    private readonly LinkedList<(TKey Key, TValue Value)> _recent = new();
+
+    public LruCache(int capacity)
+    {
+        Capacity = capacity;
+    }
+
+    public int Capacity { get; }
+
+    public int Count
+    {
+        get { lock (_lock) return _entries.Count; }
+    }
+
+    /// <summary>
+    /// Look key up, marking it most recently used.
+    /// </summary>
+    public bool TryGet(TKey key, out TValue value)
+    {
+        lock (_lock)
+        {
+            if (_entries.TryGetValue(key, out var node))
+            {
+                _recent.Remove(node);
+                _recent.AddFirst(node);
+                value = node.Value.Value;
+                return true;
+            }
+        }
+        value = default!;
+        return false;
+    }
+
+    /// <summary>
+    /// Add or replace key's value, evicting the least recently used entry
+    /// if that makes too many.
+    /// </summary>
+    public void Set(TKey key, TValue value)
+    {
+        lock (_lock)
+        {
+            if (_entries.TryGetValue(key, out var node))
+            {
+                _recent.Remove(node);
+            }
+            _entries[key] = _recent.AddFirst((key, value));
+            if (_entries.Count > Capacity)
+            {
+                _entries.Remove(_recent.Last!.Value.Key);
+                _recent.RemoveLast();
+            }
+        }
+    }
+
+    /// <summary>
+    /// The value for key, created by create if it isn't cached. create runs
+    /// outside the lock, so two threads missing at once may both run it.
+    /// </summary>
+    public TValue GetOrAdd(TKey key, Func<TKey, TValue> create)
+    {
+        if (TryGet(key, out var value)) return value;
+        value = create(key);
+        Set(key, value);
+        return value;
+    }
+
+    public void Clear()
+    {
+        lock (_lock)
+        {
+            _entries.Clear();
+            _recent.Clear();
+        }
+    }
+}
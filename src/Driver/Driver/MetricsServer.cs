@@ -0,0 +1,261 @@
+using System.Globalization;
+using System.Net;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// Live driver metrics in the Prometheus text format, served over HTTP at
+/// /metrics for dashboards and alerting.
+///
+/// Everything is read when scraped: the tick profiler's histograms, queue
+/// depths, object and clone counts, connection and output counters, GC
+/// statistics and the LPC instruction counter. Counters only go up, so
+/// rates (instructions/sec, ticks/sec) come from rate() on the scraper.
+/// Nothing here runs on the game thread.
+///
+/// /status is a read-only JSON view of the game for admin tools and status
+/// pages: uptime, lag, object counts and who is online where, straight from
+/// the StatusSnapshot the game thread published at the end of the last tick.
+/// Polling it takes no game-thread locks and runs no LPC.
+/// </summary>
+public sealed class MetricsServer : IDisposable
+{
+    private readonly GameLoop _gameLoop;
+    private readonly ObjectManager _objectManager;
+    private readonly TelnetServer? _telnetServer;
+    private readonly HttpListener _listener = new();
+    private Thread? _thread;
+
+    /// <summary>
+    /// Serve /metrics and /status on the given port (all interfaces) once started.
+    /// </summary>
+    public MetricsServer(int port, GameLoop gameLoop, ObjectManager objectManager, TelnetServer? telnetServer)
+    {
+        _gameLoop = gameLoop;
+        _objectManager = objectManager;
+        _telnetServer = telnetServer;
+        _listener.Prefixes.Add($"http://+:{port}/");
+    }
+
+    public void Start()
+    {
+        _listener.Start();
+        _thread = new Thread(Serve) { IsBackground = true, Name = "Metrics" };
+        _thread.Start();
+    }
+
+    private void Serve()
+    {
+        while (_listener.IsListening)
+        {
+            HttpListenerContext context;
+            try
+            {
+                context = _listener.GetContext();
+            }
+            catch (Exception) when (!_listener.IsListening)
+            {
+                return;
+            }
+            catch (HttpListenerException ex)
+            {
+                Logger.Warning($"Metrics listener error: {ex.Message}", LogCategory.Network);
+                continue;
+            }
+
+            try
+            {
+                var response = context.Response;
+                byte[] body;
+                switch (context.Request.Url?.AbsolutePath)
+                {
+                    case "/metrics":
+                        body = Encoding.UTF8.GetBytes(Render());
+                        response.ContentType = "text/plain; version=0.0.4; charset=utf-8";
+                        break;
+                    case "/status":
+                        body = _gameLoop.Status.ToJson();
+                        response.ContentType = "application/json";
+                        break;
+                    default:
+                        response.StatusCode = 404;
+                        response.Close();
+                        continue;
+                }
+
+                response.ContentLength64 = body.Length;
+                response.OutputStream.Write(body);
+                response.Close();
+            }
+            catch (Exception ex)
+            {
+                Logger.Warning($"Metrics request failed: {ex.Message}", LogCategory.Network);
+            }
+        }
+    }
+
+    /// <summary>
+    /// The current metrics in Prometheus text exposition format.
+    /// </summary>
+    public string Render()
+    {
+        var sb = new StringBuilder();
+        var profiler = _gameLoop.TickProfiler;
+
+        profiler.Read((tick, phases, _) =>
+        {
+            Histogram(sb, "lpmud_tick_duration_seconds", "Game loop tick duration.", null, tick);
+            Header(sb, "lpmud_tick_phase_duration_seconds", "Time spent in each phase of a tick.", "histogram");
+            foreach (var phase in Enum.GetValues<TickPhase>())
+            {
+                HistogramSeries(sb, "lpmud_tick_phase_duration_seconds", $"phase=\"{phase.ToString().ToLowerInvariant()}\"", phases[(int)phase]);
+            }
+            return 0;
+        });
+        Counter(sb, "lpmud_ticks_total", "Game loop ticks run.", profiler.Ticks);
+        Counter(sb, "lpmud_tick_overruns_total", "Ticks that ran past their budget.", profiler.Overruns);
+
+        var phaseBytes = profiler.PhaseBytes;
+        Header(sb, "lpmud_tick_phase_allocated_bytes_total", "Bytes the game thread allocated in each phase of a tick.", "counter");
+        foreach (var phase in Enum.GetValues<TickPhase>())
+        {
+            Sample(sb, "lpmud_tick_phase_allocated_bytes_total", $"phase=\"{phase.ToString().ToLowerInvariant()}\"", phaseBytes[(int)phase]);
+        }
+        var collections = profiler.Collections;
+        Header(sb, "lpmud_tick_gc_collections_total", "Garbage collections during ticks, by generation.", "counter");
+        Sample(sb, "lpmud_tick_gc_collections_total", "generation=\"0\"", collections.Gen0);
+        Sample(sb, "lpmud_tick_gc_collections_total", "generation=\"1\"", collections.Gen1);
+        Sample(sb, "lpmud_tick_gc_collections_total", "generation=\"2\"", collections.Gen2);
+        Counter(sb, "lpmud_ticks_with_gen2_total", "Ticks during which a gen2 collection ran.", collections.Gen2Ticks);
+
+        profiler.ReadCommands(commands =>
+        {
+            Header(sb, "lpmud_command_latency_seconds", "Player command latency, from being queued to having run.", "histogram");
+            foreach (var (verb, histogram) in commands.OrderBy(pair => pair.Key, StringComparer.Ordinal))
+            {
+                HistogramSeries(sb, "lpmud_command_latency_seconds", $"verb=\"{Escape(verb)}\"", histogram);
+            }
+            return 0;
+        });
+
+        _gameLoop.Latency.Read((total, stages, _) =>
+        {
+            Histogram(sb, "lpmud_command_round_trip_seconds", "Player command time from the socket read to the reply being sent.", null, total);
+            Header(sb, "lpmud_command_stage_seconds", "Player command time in each stage from read to send.", "histogram");
+            foreach (var stage in Enum.GetValues<CommandStage>())
+            {
+                HistogramSeries(sb, "lpmud_command_stage_seconds", $"stage=\"{stage.ToString().ToLowerInvariant()}\"", stages[(int)stage]);
+            }
+            return 0;
+        });
+
+        Gauge(sb, "lpmud_command_queue_depth", "Player input waiting for the game thread.", _gameLoop.CommandQueueDepth);
+        Gauge(sb, "lpmud_login_queue_depth", "Logged-in players waiting for their turn to enter the game.", _gameLoop.LoginQueueDepth);
+        Gauge(sb, "lpmud_output_queue_depth", "Messages waiting for the network thread.", _gameLoop.OutputQueueDepth);
+        Gauge(sb, "lpmud_heartbeat_objects", "Objects with a heartbeat.", _gameLoop.GetHeartbeatBucketSizes().Sum());
+        Gauge(sb, "lpmud_callouts_pending", "Pending call_out()s.", _gameLoop.PendingTimerCount);
+
+        // The object store is the game thread's; anyone else reads its published copy
+        var objects = _gameLoop.OnGameThread ? _objectManager.PublishSnapshot() : _objectManager.Snapshot;
+        Gauge(sb, "lpmud_objects", "Loaded objects, blueprints and clones.", objects.Stats.TotalObjectCount);
+        Gauge(sb, "lpmud_blueprints", "Loaded blueprints.", objects.Stats.BlueprintCount);
+        Header(sb, "lpmud_clones", "Live clones per blueprint.", "gauge");
+        foreach (var (blueprint, count) in objects.CloneCounts.OrderBy(pair => pair.Key, StringComparer.Ordinal))
+        {
+            Sample(sb, "lpmud_clones", $"blueprint=\"{Escape(blueprint)}\"", count);
+        }
+
+        Counter(sb, "lpmud_lpc_instructions_total", "LPC instructions executed.", VmThread.TotalInstructions);
+
+        if (_telnetServer != null)
+        {
+            var output = _telnetServer.GetOutputStats();
+            Gauge(sb, "lpmud_connections", "Open telnet connections.", output.Connections);
+            Gauge(sb, "lpmud_output_queued_bytes", "Output buffered for slow clients.", output.QueuedBytes);
+            Counter(sb, "lpmud_output_sent_bytes_total", "Output bytes sent.", output.BytesSent);
+            Counter(sb, "lpmud_output_dropped_bytes_total", "Output bytes dropped for slow clients.", output.BytesDropped);
+            Counter(sb, "lpmud_output_overflows_total", "Connections that went over their output limit.", output.Overflows);
+        }
+
+        Header(sb, "lpmud_gc_collections_total", "Garbage collections by generation.", "counter");
+        for (int generation = 0; generation <= GC.MaxGeneration; generation++)
+        {
+            Sample(sb, "lpmud_gc_collections_total", $"generation=\"{generation}\"", GC.CollectionCount(generation));
+        }
+        Counter(sb, "lpmud_gc_pause_seconds_total", "Time the runtime was paused for garbage collection.", GC.GetTotalPauseDuration().TotalSeconds);
+        Gauge(sb, "lpmud_gc_heap_bytes", "Managed heap size after the last collection.", GC.GetGCMemoryInfo().HeapSizeBytes);
+        Counter(sb, "lpmud_allocated_bytes_total", "Bytes allocated since startup.", GC.GetTotalAllocatedBytes());
+
+        return sb.ToString();
+    }
+
+    private static void Header(StringBuilder sb, string name, string help, string type)
+    {
+        sb.Append("# HELP ").Append(name).Append(' ').Append(help).Append('\n');
+        sb.Append("# TYPE ").Append(name).Append(' ').Append(type).Append('\n');
+    }
+
+    private static void Sample(StringBuilder sb, string name, string? labels, double value)
+    {
+        sb.Append(name);
+        if (labels != null) sb.Append('{').Append(labels).Append('}');
+        sb.Append(' ').Append(value.ToString(CultureInfo.InvariantCulture)).Append('\n');
+    }
+
+    private static void Counter(StringBuilder sb, string name, string help, double value)
+    {
+        Header(sb, name, help, "counter");
+        Sample(sb, name, null, value);
+    }
+
+    private static void Gauge(StringBuilder sb, string name, string help, double value)
+    {
+        Header(sb, name, help, "gauge");
+        Sample(sb, name, null, value);
+    }
+
+    private static void Histogram(StringBuilder sb, string name, string help, string? labels, TickProfiler.Histogram histogram)
+    {
+        Header(sb, name, help, "histogram");
+        HistogramSeries(sb, name, labels, histogram);
+    }
+
+    /// <summary>
+    /// A TickProfiler histogram as cumulative buckets. Its bucket i holds
+    /// samples under 2^i microseconds; the last one is open-ended, so it only
+    /// shows up in +Inf.
+    /// </summary>
+    private static void HistogramSeries(StringBuilder sb, string name, string? labels, TickProfiler.Histogram histogram)
+    {
+        var prefix = labels == null ? "" : labels + ",";
+        long cumulative = 0;
+        for (int i = 0; i < TickProfiler.HistogramBuckets - 1; i++)
+        {
+            cumulative += histogram.BucketCount(i);
+            var le = ((1L << i) / 1_000_000.0).ToString(CultureInfo.InvariantCulture);
+            Sample(sb, name + "_bucket", $"{prefix}le=\"{le}\"", cumulative);
+        }
+        Sample(sb, name + "_bucket", $"{prefix}le=\"+Inf\"", histogram.Count);
+        Sample(sb, name + "_sum", labels, histogram.TotalMicroseconds / 1_000_000.0);
+        Sample(sb, name + "_count", labels, histogram.Count);
+    }
+
+    /// <summary>
+    /// Escape a label value (verbs come straight from player input).
+    /// </summary>
+    private static string Escape(string value)
+    {
+        return value.Replace("\\", "\\\\").Replace("\"", "\\\"").Replace("\n", "\\n");
+    }
+
+    public void Dispose()
+    {
+        if (_listener.IsListening)
+        {
+            _listener.Stop();
+        }
+        _listener.Close();
+        _thread?.Join(TimeSpan.FromSeconds(2));
+    }
+}
@@ -10,8 +10,11 @@ public class MudObject
     /// <summary>
     /// The full object name including clone suffix if applicable.
     /// Examples: "/std/weapon", "/obj/weapons/sword#5"
+    /// A clone's is formatted the first time it is asked for.
     /// </summary>
-    public string ObjectName { get; }
+    public string ObjectName => _objectName ??= $"{FilePath}#{CloneNumber}";
+
+    private string? _objectName;
 
     /// <summary>
     /// The file path this object was loaded from (without .c extension).
@@ -20,6 +23,27 @@ public class MudObject
     /// </summary>
     public string FilePath { get; }
 
+    /// <summary>
+    /// The world area this object's file is in ("town" for
+    /// /world/rooms/town/square), or null outside /world/rooms/.
+    /// Used to split the world into regions for parallel heartbeats.
+    /// </summary>
+    public string? Area
+    {
+        get
+        {
+            if (!_areaKnown)
+            {
+                _area = RegionGuard.AreaOf(FilePath);
+                _areaKnown = true;
+            }
+            return _area;
+        }
+    }
+
+    private string? _area;
+    private bool _areaKnown;
+
     /// <summary>
     /// Whether this is a blueprint (master object) or a clone (instance).
     /// </summary>
@@ -56,11 +80,38 @@ public class MudObject
     }
 
     /// <summary>
-    /// Instance variables for this object.
+    /// Instance variable values, one slot per entry in VariableLayout.
     /// Each clone has its own independent variable storage.
     /// Blueprints can also have variables (shared state - rarely used).
     /// </summary>
-    public Dictionary<string, object?> Variables { get; } = new();
+    private LpcValue[] _variables = Array.Empty<LpcValue>();
+
+    /// <summary>
+    /// Value of a variable that has not been assigned (the int 0, as LPC expects).
+    /// </summary>
+    private static readonly LpcValue UninitializedValue = LpcValue.FromObject(0);
+
+    /// <summary>
+    /// Layout the variable slots follow. Normally Program.VariableLayout; after a
+    /// hot reload it stays on the old layout until MigrateVariables() is called.
+    /// </summary>
+    public VariableLayout VariableLayout { get; private set; } = null!;
+
+    /// <summary>
+    /// Name/value view of the instance variables, in slot order.
+    /// Used by save_object and debugging tools; the interpreter uses slots.
+    /// </summary>
+    public IEnumerable<KeyValuePair<string, object?>> Variables
+    {
+        get
+        {
+            var names = VariableLayout.Names;
+            for (int i = 0; i < names.Length; i++)
+            {
+                yield return new KeyValuePair<string, object?>(names[i], _variables[i].ToObject());
+            }
+        }
+    }
 
     /// <summary>
     /// For clones: reference to their blueprint.
@@ -69,11 +120,80 @@ public class MudObject
     public MudObject? Blueprint { get; }
 
     /// <summary>
-    /// For blueprints: list of active clones (for tracking/cleanup).
-    /// For clones: empty list.
+    /// For blueprints: list of active clones (for tracking/cleanup), in no
+    /// particular order. For clones: empty list.
     /// Note: This is a weak reference in real LPMud, but we'll track explicitly for now.
     /// </summary>
-    public List<MudObject> Clones { get; } = new();
+    public IReadOnlyList<MudObject> Clones => (IReadOnlyList<MudObject>?)_blueprintState?.Clones ?? Array.Empty<MudObject>();
+
+    /// <summary>
+    /// What only a blueprint keeps: its clones, their numbering and the
+    /// pool of variable arrays for new ones. Null on clones, which are what
+    /// a world has most of.
+    /// </summary>
+    private sealed class BlueprintState
+    {
+        /// <summary>
+        /// A removal moves the last clone into the gap, so
+        /// each clone records where it is (_cloneIndex) and leaves in O(1).
+        /// </summary>
+        public readonly List<MudObject> Clones = new();
+
+        /// <summary>
+        /// Highest clone number handed out for this blueprint.
+        /// </summary>
+        public int CloneCounter;
+
+        /// <summary>
+        /// Variable arrays of destructed clones, kept for the next clones.
+        /// Only arrays on PooledLayout are kept; a reload empties it. Locked
+        /// while in use.
+        /// </summary>
+        public readonly Stack<LpcValue[]> VariablePool = new();
+        public VariableLayout? PooledLayout;
+    }
+
+    private readonly BlueprintState? _blueprintState;
+    private int _cloneIndex = -1;
+
+    public int LastCloneNumber => _blueprintState?.CloneCounter ?? 0;
+
+    /// <summary>
+    /// Number for a new clone of this blueprint (game thread, as with all cloning).
+    /// </summary>
+    internal int NextCloneNumber() => ++_blueprintState!.CloneCounter;
+
+    /// <summary>
+    /// Continue numbering after a destructed blueprint's last clone, so a
+    /// reloaded blueprint never reuses a name.
+    /// </summary>
+    internal void ContinueCloneNumbers(int last)
+    {
+        _blueprintState!.CloneCounter = last;
+    }
+
+    private void AddClone(MudObject clone)
+    {
+        var clones = _blueprintState!.Clones;
+        clone._cloneIndex = clones.Count;
+        clones.Add(clone);
+    }
+
+    /// <summary>
+    /// Stop tracking a clone (destructed). O(1).
+    /// </summary>
+    internal void RemoveClone(MudObject clone)
+    {
+        var clones = _blueprintState?.Clones;
+        int index = clone._cloneIndex;
+        if (clones == null || index < 0 || index >= clones.Count || clones[index] != clone) return;
+
+        var last = clones[^1];
+        clones[index] = last;
+        last._cloneIndex = index;
+        clones.RemoveAt(clones.Count - 1);
+        clone._cloneIndex = -1;
+    }
 
     /// <summary>
     /// Whether this object has been destructed.
@@ -85,31 +205,331 @@ public class MudObject
     /// </summary>
     public DateTime CreatedAt { get; }
 
+    #region Ids
+
+    private string[]? _declaredIds;
+    private string? _declaredIdText;
+    private LpcProgram? _idsProgram;
+
+    /// <summary>
+    /// Record what this object's id() matches, as declared by set_ids(): any
+    /// of ids exactly, or any part of text. declaringProgram is the program
+    /// that made the declaration; it holds only while that program's id() is
+    /// the one the object uses.
+    /// </summary>
+    public void DeclareIds(IEnumerable<string> ids, string? text, LpcProgram declaringProgram)
+    {
+        _declaredIds = ids.Select(id => id.ToLowerInvariant()).Distinct().ToArray();
+        _declaredIdText = string.IsNullOrEmpty(text) ? null : text.ToLowerInvariant();
+        _idsProgram = declaringProgram;
+    }
+
+    /// <summary>
+    /// Whether name (lowercase) matches the declared ids, or null when they
+    /// don't apply and id() has to be called: nothing was declared, a
+    /// subclass or shadow overrides the declaring program's id(), or the
+    /// object has been recompiled since.
+    /// </summary>
+    public bool? MatchDeclaredId(string name)
+    {
+        if (_idsProgram == null) return null;
+        if (ShadowedBy?.Program.FindFunction("id") != null) return null;
+        if (Program.FindFunctionWithProgram("id").OwningProgram != _idsProgram) return null;
+
+        if (name.Length == 0) return false;
+        return Array.IndexOf(_declaredIds!, name) >= 0 ||
+               (_declaredIdText != null && _declaredIdText.Contains(name, StringComparison.Ordinal));
+    }
+
+    /// <summary>
+    /// The declared ids and text while they still apply (see MatchDeclaredId),
+    /// otherwise null. For WorldSnapshot.
+    /// </summary>
+    internal (string[] Ids, string? Text, LpcProgram Program)? DeclaredIdState =>
+        _idsProgram != null ? (_declaredIds!, _declaredIdText, _idsProgram) : null;
+
+    internal (string[] Ids, string? Text)? DeclaredIds =>
+        _idsProgram != null && Program.FindFunctionWithProgram("id").OwningProgram == _idsProgram
+            ? (_declaredIds!, _declaredIdText)
+            : null;
+
+    #endregion
+
+    #region Skills
+
+    /// <summary>
+    /// Results of this object's pure query functions, made on first use.
+    /// </summary>
+    internal QueryMemo Memo => _memo ??= new QueryMemo();
+    private QueryMemo? _memo;
+
+    /// <summary>
+    /// This object's skills (see SkillTable), or null if it has never had any.
+    /// </summary>
+    public SkillTable? SkillsIfAny => _cold?.Skills;
+
+    /// <summary>
+    /// This object's skills, made on first use. Changes to it should be
+    /// followed by MarkDirty(), as they are part of what a save records.
+    /// </summary>
+    public SkillTable Skills => Cold.Skills ??= new SkillTable();
+
+    /// <summary>
+    /// What save_object() and world snapshots record: the variables, then
+    /// the skill table's entries.
+    /// </summary>
+    public IEnumerable<KeyValuePair<string, object?>> SaveEntries()
+    {
+        var skills = SkillsIfAny;
+        return skills == null ? Variables : Variables.Concat(skills.SaveEntries());
+    }
+
+    /// <summary>
+    /// Restore one entry written by SaveEntries(). Returns false if this
+    /// object has no such variable.
+    /// </summary>
+    public bool RestoreEntry(string name, object? value)
+    {
+        if (name.StartsWith('#'))
+        {
+            if (!Skills.Restore(name, value)) return false;
+            MarkDirty();
+            return true;
+        }
+        if (!HasVariable(name)) return false;
+        SetVariable(name, value);
+        return true;
+    }
+
+    #endregion
+
+    #region Cold State
+
+    /// <summary>
+    /// State most objects never have: shadows, living names, skills, exits,
+    /// a connection, fights, and the lists a container keeps of interactive and
+    /// init() contents. It lives in a side object made the first time any of
+    /// it is set, so the swords and coins that make up most of a world carry
+    /// one null reference for it instead of a dozen fields.
+    /// </summary>
+    private sealed class ColdState
+    {
+        public MudObject? ShadowedBy;
+        public ShadowDispatch? ShadowDispatch;
+        public MudObject? Shadowing;
+        public string? LivingName;
+        public SkillTable? Skills;
+        public RoomExits? Exits;
+        public string? ConnectionId;
+        public PlayerSession? Session;
+        public List<MudObject>? InteractiveContents;
+        public List<MudObject>? InitContents;
+        public MudObject? CombatTarget;
+        public List<MudObject>? Attackers;
+    }
+
+    private ColdState? _cold;
+
+    private ColdState Cold => _cold ??= new ColdState();
+
+    #endregion
+
     #region Living/Interactive Properties
 
     /// <summary>
     /// Whether this object is "living" (can have HP, receive heartbeats, etc).
     /// Set via set_living() efun. Typically true for players and NPCs.
     /// </summary>
-    public bool IsLiving { get; set; }
+    public bool IsLiving
+    {
+        get => _isLiving;
+        set
+        {
+            if (_isLiving == value) return;
+            if (Environment != null && _isLiving) Environment.UnlinkLiving(this);
+            _isLiving = value;
+            if (Environment != null && _isLiving) Environment.LinkLiving(this);
+        }
+    }
+    private bool _isLiving;
 
     /// <summary>
     /// The "living name" for this object (used by find_living()).
     /// Set via set_living_name() efun. Examples: "orc", "troll", "player_bob"
     /// </summary>
-    public string? LivingName { get; set; }
+    public string? LivingName
+    {
+        get => _cold?.LivingName;
+        set
+        {
+            if (value != null || _cold != null) Cold.LivingName = value;
+        }
+    }
+
+    /// <summary>
+    /// This room's exits, set with set_exit(). Null until it has any.
+    /// </summary>
+    public RoomExits? Exits
+    {
+        get => _cold?.Exits;
+        set
+        {
+            if (value != null || _cold != null) Cold.Exits = value;
+        }
+    }
+
+    /// <summary>
+    /// Bumped by description_changed() when this object would now describe
+    /// itself differently, so cached renderings of it are redone.
+    /// </summary>
+    public long DescriptionVersion { get; internal set; }
+
+    public void DescriptionChanged() => DescriptionVersion++;
+
+    /// <summary>
+    /// What tell_room_tmpl() last resolved this object's name to, and the
+    /// DescriptionVersion it was resolved at.
+    /// </summary>
+    internal MessageName? CachedMessageName { get; set; }
+
+    internal sealed record MessageName(string Name, long Version);
 
     /// <summary>
     /// Whether this object is an interactive player (connected via telnet).
     /// Set by GameLoop when player connects/disconnects.
     /// </summary>
-    public bool IsInteractive { get; set; }
+    public bool IsInteractive
+    {
+        get => _isInteractive;
+        set
+        {
+            if (_isInteractive == value) return;
+            _isInteractive = value;
+            if (Environment != null)
+            {
+                if (value) Environment.AddInteractive(this);
+                else Environment.RemoveInteractive(this);
+            }
+        }
+    }
+    private bool _isInteractive;
+
+    /// <summary>
+    /// Interactive players directly inside this object, kept up to date as
+    /// they move and connect, so the game loop can tell which rooms are
+    /// occupied without scanning contents.
+    /// </summary>
+    public int InteractiveCount => _cold?.InteractiveContents?.Count ?? 0;
+
+    /// <summary>
+    /// The interactive players directly inside this object, in arrival order.
+    /// A room rarely holds more than a handful, so this is a plain list.
+    /// </summary>
+    public IReadOnlyList<MudObject> InteractiveContents =>
+        (IReadOnlyList<MudObject>?)_cold?.InteractiveContents ?? Array.Empty<MudObject>();
+
+    /// <summary>
+    /// The objects directly inside this one whose init() does something
+    /// (LpcProgram.HasInit), in arrival order. move_object() calls init() on
+    /// these rather than on everything in the room.
+    /// </summary>
+    public IReadOnlyList<MudObject> InitContents =>
+        (IReadOnlyList<MudObject>?)_cold?.InitContents ?? Array.Empty<MudObject>();
+
+    // Whether this object is on its environment's InitContents
+    private bool _initListed;
+
+    /// <summary>
+    /// Get on or off the environment's InitContents after a hot reload
+    /// changed whether the program has an init().
+    /// </summary>
+    internal void RefreshInitListing()
+    {
+        if (Environment == null || _initListed == Program.HasInit) return;
+
+        if (_initListed) Environment._cold?.InitContents?.Remove(this);
+        else (Environment.Cold.InitContents ??= new List<MudObject>()).Add(this);
+        _initListed = !_initListed;
+    }
 
     /// <summary>
     /// The connection ID for interactive players.
     /// Used to route output to the correct telnet session.
     /// </summary>
-    public string? ConnectionId { get; set; }
+    public string? ConnectionId
+    {
+        get => _cold?.ConnectionId;
+        set
+        {
+            if (value != null || _cold != null) Cold.ConnectionId = value;
+        }
+    }
+
+    /// <summary>
+    /// The session this player object is connected through, or null if it
+    /// has none (not a player, linkdead, or gone). tell_object()/tell_room()
+    /// deliver through it without looking the session up.
+    /// </summary>
+    public PlayerSession? Session => _cold?.Session;
+
+    /// <summary>
+    /// Connect this object to a session (null to disconnect it), keeping
+    /// ConnectionId in step.
+    /// </summary>
+    public void BindSession(PlayerSession? session)
+    {
+        if (session == null && _cold == null) return;
+        Cold.Session = session;
+        Cold.ConnectionId = session?.ConnectionId;
+    }
+
+    #endregion
+
+    #region Combat
+
+    /// <summary>
+    /// What this object is fighting, set with the set_attacking() efun.
+    /// </summary>
+    public MudObject? CombatTarget => _cold?.CombatTarget;
+
+    /// <summary>
+    /// Objects fighting this one, wherever they are, in the order they started.
+    /// </summary>
+    public IReadOnlyList<MudObject> Attackers =>
+        (IReadOnlyList<MudObject>?)_cold?.Attackers ?? Array.Empty<MudObject>();
+
+    /// <summary>
+    /// Start fighting target, or stop fighting with null. Keeps the target's
+    /// list of attackers in step, so "who is attacking me" is a lookup rather
+    /// than a scan of the room.
+    /// </summary>
+    public void SetCombatTarget(MudObject? target)
+    {
+        var current = CombatTarget;
+        if (current == target) return;
+        current?._cold?.Attackers?.Remove(this);
+        if (target == null)
+        {
+            _cold!.CombatTarget = null;
+            return;
+        }
+        Cold.CombatTarget = target;
+        (target.Cold.Attackers ??= new List<MudObject>()).Add(this);
+    }
+
+    /// <summary>
+    /// Drop every fight this object is in, either side (on destruct).
+    /// </summary>
+    public void ClearCombat()
+    {
+        SetCombatTarget(null);
+        var attackers = _cold?.Attackers;
+        if (attackers == null) return;
+        foreach (var attacker in attackers.ToList())
+        {
+            attacker.SetCombatTarget(null);
+        }
+    }
 
     #endregion
 
@@ -127,6 +547,25 @@ public class MudObject
     /// </summary>
     public DateTime LastHeartbeat { get; set; } = DateTime.UtcNow;
 
+    /// <summary>
+    /// Heartbeat bucket and position the game loop filed this object under,
+    /// so unregistering is O(1). -1 when not registered.
+    /// </summary>
+    internal int HeartbeatBucket { get; set; } = -1;
+    internal int HeartbeatSlot { get; set; }
+
+    /// <summary>
+    /// Game tick this object's heartbeats were first skipped for dormancy,
+    /// or -1 while it is awake.
+    /// </summary>
+    internal long DormantSinceTick { get; set; } = -1;
+
+    /// <summary>
+    /// Seconds the object slept before its current heartbeat; 0 if it
+    /// wasn't dormant. Returned by query_dormant_elapsed().
+    /// </summary>
+    public int DormantElapsedSeconds { get; set; }
+
     /// <summary>
     /// Reset interval in seconds for this object.
     /// When > 0, reset() is called periodically at this interval.
@@ -134,6 +573,18 @@ public class MudObject
     /// </summary>
     public int ResetInterval { get; set; }
 
+    /// <summary>
+    /// When LPC code last ran in this object (Environment.TickCount64
+    /// milliseconds). The clean_up() cycle only offers clean_up() to objects
+    /// idle for long enough.
+    /// </summary>
+    public long LastReferenced { get; set; } = System.Environment.TickCount64;
+
+    /// <summary>
+    /// Set when clean_up() returned 0 (or failed): the driver won't call it again.
+    /// </summary>
+    public bool NoCleanUp { get; set; }
+
     #endregion
 
     #region Shadow System
@@ -142,13 +593,91 @@ public class MudObject
     /// The object that is shadowing this one (outermost shadow in chain).
     /// When a function is called on this object, the shadow gets first chance to intercept.
     /// </summary>
-    public MudObject? ShadowedBy { get; set; }
+    public MudObject? ShadowedBy
+    {
+        get => _cold?.ShadowedBy;
+        set
+        {
+            if (value == null && _cold == null) return;
+            Cold.ShadowedBy = value;
+            Cold.ShadowDispatch = null;
+        }
+    }
+
+    /// <summary>
+    /// A shadowed object's function table with the shadow's functions laid
+    /// over its own, built for the programs it was built from.
+    /// </summary>
+    private sealed class ShadowDispatch(LpcProgram own, LpcProgram shadow,
+        Dictionary<string, (MudObject Target, FunctionEntry Entry)> table)
+    {
+        public readonly LpcProgram Own = own;
+        public readonly LpcProgram Shadow = shadow;
+        public readonly Dictionary<string, (MudObject Target, FunctionEntry Entry)> Table = table;
+    }
+
+    /// <summary>
+    /// Find the function a call into this object runs, and the object it
+    /// runs in: the shadow's if it defines one, otherwise this object's.
+    /// Unshadowed, this is one lookup in the program's table. Shadowed, it
+    /// is one lookup in a merged table, rebuilt when the shadow changes or
+    /// either program is recompiled.
+    /// </summary>
+    public bool TryResolveCall(string name, out MudObject target, out FunctionEntry entry)
+    {
+        var cold = _cold;
+        var shadow = cold?.ShadowedBy;
+        if (shadow == null)
+        {
+            target = this;
+            return Program.AllFunctions.TryGetValue(name, out entry);
+        }
+
+        var dispatch = cold!.ShadowDispatch;
+        if (dispatch == null || dispatch.Own != Program || dispatch.Shadow != shadow.Program)
+        {
+            dispatch = BuildShadowDispatch(shadow);
+            cold.ShadowDispatch = dispatch;
+        }
+
+        if (dispatch.Table.TryGetValue(name, out var resolved))
+        {
+            (target, entry) = resolved;
+            return true;
+        }
+        target = this;
+        entry = default;
+        return false;
+    }
+
+    private ShadowDispatch BuildShadowDispatch(MudObject shadow)
+    {
+        var own = Program;
+        var shadowProgram = shadow.Program;
+        var table = new Dictionary<string, (MudObject, FunctionEntry)>(own.AllFunctions.Count);
+        foreach (var (name, entry) in shadowProgram.AllFunctions)
+        {
+            table[name] = (shadow, entry);
+        }
+        foreach (var (name, entry) in own.AllFunctions)
+        {
+            table.TryAdd(name, (this, entry));
+        }
+        return new ShadowDispatch(own, shadowProgram, table);
+    }
 
     /// <summary>
     /// The object this is shadowing.
     /// If set, this object intercepts function calls to the shadowed object.
     /// </summary>
-    public MudObject? Shadowing { get; set; }
+    public MudObject? Shadowing
+    {
+        get => _cold?.Shadowing;
+        set
+        {
+            if (value != null || _cold != null) Cold.Shadowing = value;
+        }
+    }
 
     #endregion
 
@@ -178,15 +707,45 @@ public class MudObject
     );
 
     /// <summary>
-    /// Actions registered by this object via add_action().
-    /// These are actions this object provides to command givers (players).
+    /// Actions registered by this object via add_action(), in registration
+    /// order, with the exact-match ones also by verb. These are actions this
+    /// object provides to command givers (players). Made by the first
+    /// add_action() and dropped by ClearActions().
     /// </summary>
-    private readonly List<ActionEntry> _actions = new();
+    private sealed class ActionTable
+    {
+        public readonly List<ActionEntry> List = new();
+        public readonly Dictionary<string, ActionEntry> ByVerb = new();
+    }
+
+    private ActionTable? _ownActions;
+
+    /// <summary>
+    /// Actions offered by this object's contents. Kept up to date as contents
+    /// add and remove actions and move in and out, so command lookup doesn't
+    /// scan every object in a room. Made when the first one arrives.
+    /// </summary>
+    private sealed class ContentActionIndex
+    {
+        /// <summary>
+        /// Exact-match actions, by verb.
+        /// </summary>
+        public readonly Dictionary<string, List<ActionEntry>> Exact = new();
+
+        /// <summary>
+        /// Prefix-match actions. These can't be keyed by the typed verb, but
+        /// they are rare.
+        /// </summary>
+        public readonly List<ActionEntry> Prefix = new();
+    }
+
+    private ContentActionIndex? _contentActions;
 
     /// <summary>
     /// Read-only access to registered actions.
     /// </summary>
-    public IReadOnlyList<ActionEntry> Actions => _actions.AsReadOnly();
+    public IReadOnlyList<ActionEntry> Actions =>
+        (IReadOnlyList<ActionEntry>?)_ownActions?.List.AsReadOnly() ?? Array.Empty<ActionEntry>();
 
     /// <summary>
     /// Whether this object can receive and process commands.
@@ -201,8 +760,16 @@ public class MudObject
     public void AddAction(string function, string verb, ActionFlags flags = ActionFlags.None)
     {
         // Remove any existing action for this verb from this object
-        _actions.RemoveAll(a => a.Verb == verb);
-        _actions.Add(new ActionEntry(verb, function, flags, this));
+        RemoveAction(verb);
+
+        var action = new ActionEntry(verb, function, flags, this);
+        var table = _ownActions ??= new ActionTable();
+        table.List.Add(action);
+        if ((flags & ActionFlags.MatchPrefix) == 0)
+        {
+            table.ByVerb[verb] = action;
+        }
+        Environment?.IndexContentAction(action);
     }
 
     /// <summary>
@@ -210,7 +777,16 @@ public class MudObject
     /// </summary>
     public bool RemoveAction(string verb)
     {
-        return _actions.RemoveAll(a => a.Verb == verb) > 0;
+        var table = _ownActions;
+        if (table == null) return false;
+        int index = table.List.FindIndex(a => a.Verb == verb);
+        if (index < 0) return false;
+
+        var action = table.List[index];
+        table.List.RemoveAt(index);
+        table.ByVerb.Remove(verb);
+        Environment?.UnindexContentAction(action);
+        return true;
     }
 
     /// <summary>
@@ -219,21 +795,39 @@ public class MudObject
     /// </summary>
     public void ClearActions()
     {
-        _actions.Clear();
+        if (_ownActions == null) return;
+        if (Environment != null)
+        {
+            foreach (var action in _ownActions.List)
+            {
+                Environment.UnindexContentAction(action);
+            }
+        }
+        _ownActions = null;
     }
 
     /// <summary>
-    /// Find an action that matches the given verb.
+    /// Find an action that matches the given verb. An exact match wins over
+    /// prefix matches; among prefix matches the first registered wins.
     /// </summary>
     public ActionEntry? FindAction(string verb)
     {
-        foreach (var action in _actions)
+        var table = _ownActions;
+        if (table == null)
+        {
+            return null;
+        }
+        if (table.ByVerb.TryGetValue(verb, out var exact))
+        {
+            return exact;
+        }
+        if (table.ByVerb.Count == table.List.Count)
+        {
+            return null;
+        }
+
+        foreach (var action in table.List)
         {
-            if (action.Verb == verb)
-            {
-                return action;
-            }
-            // Check prefix match
             if ((action.Flags & ActionFlags.MatchPrefix) != 0 && verb.StartsWith(action.Verb))
             {
                 return action;
@@ -242,6 +836,77 @@ public class MudObject
         return null;
     }
 
+    /// <summary>
+    /// Append the action each of this object's contents answers verb with
+    /// (as FindAction would pick it), skipping exclude and destructed objects.
+    /// Exact matches come first, each group in the order the actions were
+    /// added or their owners arrived.
+    /// </summary>
+    public void CollectContentActions(string verb, MudObject? exclude, List<ActionEntry> into)
+    {
+        var index = _contentActions;
+        if (index == null)
+        {
+            return;
+        }
+        if (index.Exact.TryGetValue(verb, out var exact))
+        {
+            foreach (var action in exact)
+            {
+                if (action.Owner != exclude && !action.Owner.IsDestructed)
+                {
+                    into.Add(action);
+                }
+            }
+        }
+
+        foreach (var action in index.Prefix)
+        {
+            if (action.Owner != exclude && !action.Owner.IsDestructed &&
+                verb.StartsWith(action.Verb) && ReferenceEquals(action.Owner.FindAction(verb), action))
+            {
+                into.Add(action);
+            }
+        }
+    }
+
+    private void IndexContentAction(ActionEntry action)
+    {
+        var index = _contentActions ??= new ContentActionIndex();
+        if ((action.Flags & ActionFlags.MatchPrefix) != 0)
+        {
+            index.Prefix.Add(action);
+            return;
+        }
+
+        if (!index.Exact.TryGetValue(action.Verb, out var list))
+        {
+            list = new List<ActionEntry>(1);
+            index.Exact[action.Verb] = list;
+        }
+        list.Add(action);
+    }
+
+    private void UnindexContentAction(ActionEntry action)
+    {
+        var index = _contentActions;
+        if (index == null) return;
+        if ((action.Flags & ActionFlags.MatchPrefix) != 0)
+        {
+            index.Prefix.Remove(action);
+            return;
+        }
+
+        if (index.Exact.TryGetValue(action.Verb, out var list))
+        {
+            list.Remove(action);
+            if (list.Count == 0)
+            {
+                index.Exact.Remove(action.Verb);
+            }
+        }
+    }
+
     #endregion
 
     /// <summary>
@@ -253,16 +918,104 @@ public class MudObject
     public MudObject? Environment { get; private set; }
 
     /// <summary>
-    /// Objects contained within this object.
+    /// Objects contained within this object, in the order they arrived.
     /// For rooms: players, NPCs, items on the floor.
     /// For players: inventory items.
+    ///
+    /// Kept as a doubly linked list threaded through the objects themselves,
+    /// so moving an object in or out is O(1) whatever the room holds. The
+    /// livings among them are threaded on a second list the same way.
+    /// </summary>
+    public ObjectContents Contents => new(this, living: false);
+
+    /// <summary>
+    /// The living objects in Contents, in the same order.
     /// </summary>
-    private readonly List<MudObject> _contents = new();
+    public ObjectContents LivingContents => new(this, living: true);
+
+    // Head, tail and size of this object's contents and living lists
+    internal MudObject? FirstContent;
+    private MudObject? _lastContent;
+    internal int ContentCount;
+    internal MudObject? FirstLiving;
+    private MudObject? _lastLiving;
+    internal int LivingCount;
+
+    // Bumped on every change to the contents, so enumerators can spot one
+    internal int ContentsVersion;
+
+    // This object's neighbours in its environment's lists
+    internal MudObject? NextContent;
+    private MudObject? _prevContent;
+    internal MudObject? NextLiving;
+    private MudObject? _prevLiving;
 
     /// <summary>
-    /// Read-only access to contents.
+    /// Deepest nesting of environments MoveTo will build, and how far up
+    /// Contains looks.
     /// </summary>
-    public IReadOnlyList<MudObject> Contents => _contents.AsReadOnly();
+    public const int MaxEnvironmentDepth = 64;
+
+    private void LinkContent(MudObject obj)
+    {
+        obj._prevContent = _lastContent;
+        obj.NextContent = null;
+        if (_lastContent != null) _lastContent.NextContent = obj;
+        else FirstContent = obj;
+        _lastContent = obj;
+        ContentCount++;
+        ContentsVersion++;
+    }
+
+    private void UnlinkContent(MudObject obj)
+    {
+        if (obj._prevContent != null) obj._prevContent.NextContent = obj.NextContent;
+        else FirstContent = obj.NextContent;
+        if (obj.NextContent != null) obj.NextContent._prevContent = obj._prevContent;
+        else _lastContent = obj._prevContent;
+        obj._prevContent = obj.NextContent = null;
+        ContentCount--;
+        ContentsVersion++;
+    }
+
+    private void LinkLiving(MudObject obj)
+    {
+        // Keep content order: insert after the nearest living before obj.
+        // A newly arrived object is last, so that's the last living.
+        var before = obj.NextContent == null ? _lastLiving : obj._prevContent;
+        while (before != null && (!before._isLiving || before == obj)) before = before._prevContent;
+
+        var after = before != null ? before.NextLiving : FirstLiving;
+        obj._prevLiving = before;
+        obj.NextLiving = after;
+        if (before != null) before.NextLiving = obj;
+        else FirstLiving = obj;
+        if (after != null) after._prevLiving = obj;
+        else _lastLiving = obj;
+        LivingCount++;
+        ContentsVersion++;
+    }
+
+    private void UnlinkLiving(MudObject obj)
+    {
+        if (obj._prevLiving != null) obj._prevLiving.NextLiving = obj.NextLiving;
+        else FirstLiving = obj.NextLiving;
+        if (obj.NextLiving != null) obj.NextLiving._prevLiving = obj._prevLiving;
+        else _lastLiving = obj._prevLiving;
+        obj._prevLiving = obj.NextLiving = null;
+        LivingCount--;
+        ContentsVersion++;
+    }
+
+    private void AddInteractive(MudObject obj)
+    {
+        (Cold.InteractiveContents ??= new List<MudObject>()).Add(obj);
+    }
+
+    private void RemoveInteractive(MudObject obj)
+    {
+        _cold?.InteractiveContents?.Remove(obj);
+    }
 
     /// <summary>
     /// Create a blueprint object.
@@ -270,12 +1023,13 @@ public class MudObject
     public MudObject(LpcProgram program)
     {
         FilePath = program.FilePath;
-        ObjectName = program.FilePath;
+        _objectName = program.FilePath;
         IsBlueprint = true;
         CloneNumber = null;
         _program = program;
         Blueprint = null;
         CreatedAt = DateTime.UtcNow;
+        _blueprintState = new BlueprintState();
 
         // Initialize variables for blueprint
         InitializeVariables();
@@ -292,7 +1046,6 @@ public class MudObject
         }
 
         FilePath = blueprint.FilePath;
-        ObjectName = $"{blueprint.FilePath}#{cloneNumber}";
         IsBlueprint = false;
         CloneNumber = cloneNumber;
         _program = null;  // Clones dynamically get Program from Blueprint
@@ -303,32 +1056,175 @@ public class MudObject
         InitializeVariables();
 
         // Register this clone with the blueprint
-        blueprint.Clones.Add(this);
+        blueprint.AddClone(this);
     }
 
     /// <summary>
-    /// Initialize variables from the program's variable declarations.
-    /// Creates entries for all variables (including inherited ones).
+    /// Initialize variables from the program's variable layout.
+    /// Creates slots for all variables (including inherited ones).
     /// </summary>
     private void InitializeVariables()
     {
-        var allVars = Program.GetAllVariableNames();
-        foreach (var varName in allVars)
+        var program = Program;
+        VariableLayout = program.VariableLayout;
+        _variables = Blueprint?.RentVariables(VariableLayout) ?? new LpcValue[VariableLayout.Count];
+
+        // Start from the program's initial image: 0, or the constant initializer
+        Array.Copy(program.InitialVariables, _variables, _variables.Length);
+        foreach (var (slot, isMapping) in program.EmptyContainerSlots)
         {
-            // Initialize to 0 (LPC default for uninitialized variables)
-            // Future: Could use type information for proper defaults
-            Variables[varName] = 0;
+            _variables[slot] = isMapping
+                ? LpcValue.FromObject(new LpcMapping())
+                : LpcValue.FromObject(new List<object>());
         }
     }
 
+    /// <summary>
+    /// Most variable arrays a blueprint keeps for reuse.
+    /// </summary>
+    internal const int MaxPooledVariableArrays = 64;
+
+    /// <summary>
+    /// Arrays waiting in this blueprint's pool.
+    /// </summary>
+    internal int PooledVariableArrays
+    {
+        get
+        {
+            var pool = _blueprintState?.VariablePool;
+            if (pool == null) return 0;
+            lock (pool)
+            {
+                return pool.Count;
+            }
+        }
+    }
+
+    private LpcValue[]? RentVariables(VariableLayout layout)
+    {
+        var state = _blueprintState;
+        if (state == null) return null;
+        lock (state.VariablePool)
+        {
+            if (state.VariablePool.Count == 0) return null;
+            if (!ReferenceEquals(state.PooledLayout, layout))
+            {
+                state.VariablePool.Clear();
+                return null;
+            }
+            return state.VariablePool.Pop();
+        }
+    }
+
+    /// <summary>
+    /// Drop what a destructed object still holds, so a reference LPC code
+    /// leaked to it (in a mapping, a callout argument, another object's
+    /// variable) keeps only this shell alive, not the graph behind it. A
+    /// clone's variable array goes back to its blueprint. Only safe once
+    /// nothing can still be running the object's code, so the object manager
+    /// does it between ticks, not in destruct().
+    /// </summary>
+    internal void ReleaseState()
+    {
+        var blueprint = Blueprint;
+        var variables = _variables;
+        var layout = VariableLayout;
+        _variables = Array.Empty<LpcValue>();
+        VariableLayout = VariableLayout.Empty;
+
+        _ownActions = null;
+        _contentActions = null;
+        if (Shadowing?.ShadowedBy == this)
+        {
+            // A destructed shadow stops intercepting
+            Shadowing.ShadowedBy = null;
+        }
+        if (_cold != null)
+        {
+            _cold.InteractiveContents = null;
+            _cold.InitContents = null;
+            _cold.Attackers = null;
+            _cold.ShadowedBy = null;
+            _cold.ShadowDispatch = null;
+            _cold.Shadowing = null;
+        }
+        _declaredIds = null;
+        _idsProgram = null;
+
+        var state = blueprint?._blueprintState;
+        if (state == null || blueprint!.IsDestructed || variables.Length == 0) return;
+
+        // Drop references so pooled arrays don't keep old values alive
+        Array.Clear(variables);
+        var pool = state.VariablePool;
+        lock (pool)
+        {
+            if (!ReferenceEquals(state.PooledLayout, layout))
+            {
+                pool.Clear();
+                state.PooledLayout = layout;
+            }
+            if (pool.Count < MaxPooledVariableArrays)
+            {
+                pool.Push(variables);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Move variable values onto the current program's layout after a hot reload.
+    /// Values are carried over by name; new variables start at 0 and variables
+    /// the new program no longer declares are dropped.
+    /// </summary>
+    public void MigrateVariables()
+    {
+        var newLayout = Program.VariableLayout;
+        if (ReferenceEquals(newLayout, VariableLayout)) return;
+
+        MigrateVariables(VariableLayout, newLayout, newLayout.MapFrom(VariableLayout));
+    }
+
+    /// <summary>
+    /// MigrateVariables() with the slot map worked out by the caller (see
+    /// VariableLayout.MapFrom), so a blueprint's clones share one. Objects not
+    /// on layout from work out their own.
+    /// </summary>
+    public void MigrateVariables(VariableLayout from, VariableLayout to, int[] slotMap)
+    {
+        if (ReferenceEquals(VariableLayout, to)) return;
+        if (!ReferenceEquals(VariableLayout, from))
+        {
+            slotMap = to.MapFrom(VariableLayout);
+        }
+
+        var newValues = new LpcValue[to.Count];
+        for (int i = 0; i < newValues.Length; i++)
+        {
+            int oldSlot = slotMap[i];
+            newValues[i] = oldSlot >= 0 ? _variables[oldSlot] : UninitializedValue;
+        }
+
+        VariableLayout = to;
+        _variables = newValues;
+    }
+
+    /// <summary>
+    /// Check whether this object has a variable with the given name.
+    /// </summary>
+    public bool HasVariable(string name)
+    {
+        return VariableLayout.IndexOf(name) >= 0;
+    }
+
     /// <summary>
     /// Get a variable value.
     /// </summary>
     public object? GetVariable(string name)
     {
-        if (Variables.TryGetValue(name, out var value))
+        int slot = VariableLayout.IndexOf(name);
+        if (slot >= 0)
         {
-            return value;
+            return _variables[slot].ToObject();
         }
         throw new InvalidOperationException($"Variable '{name}' not found in object {ObjectName}");
     }
@@ -338,9 +1234,11 @@ public class MudObject
     /// </summary>
     public void SetVariable(string name, object? value)
     {
-        if (Variables.ContainsKey(name))
+        int slot = VariableLayout.IndexOf(name);
+        if (slot >= 0)
         {
-            Variables[name] = value;
+            _variables[slot] = LpcValue.FromObject(value);
+            StateVersion++;
         }
         else
         {
@@ -348,6 +1246,66 @@ public class MudObject
         }
     }
 
+    /// <summary>
+    /// Get a variable by slot in VariableLayout (no name lookup, no boxing).
+    /// </summary>
+    public LpcValue GetVariableAt(int slot) => _variables[slot];
+
+    /// <summary>
+    /// Set a variable by slot in VariableLayout (no name lookup, no boxing).
+    /// </summary>
+    public void SetVariableAt(int slot, LpcValue value)
+    {
+        _variables[slot] = value;
+        StateVersion++;
+    }
+
+    /// <summary>
+    /// Bumped on every change to what a save of this object would record: a
+    /// variable write, an array or mapping store made by its own code, or a
+    /// move. Periodic player saves skip players it hasn't moved for.
+    /// </summary>
+    public long StateVersion { get; private set; }
+
+    /// <summary>
+    /// StateVersion when the object was last saved, or -1 if never.
+    /// </summary>
+    public long SavedVersion { get; set; } = -1;
+
+    /// <summary>
+    /// Whether anything changed since the last save.
+    /// </summary>
+    public bool IsDirty => StateVersion != SavedVersion;
+
+    /// <summary>
+    /// Note a change the object's variables don't show, such as an in-place
+    /// array store.
+    /// </summary>
+    public void MarkDirty() => StateVersion++;
+
+    /// <summary>
+    /// Copy the variable slots into buffer (reallocated if too small) and
+    /// return it. Arrays and mappings are shared, not copied.
+    /// </summary>
+    internal LpcValue[] SnapshotVariables(LpcValue[] buffer)
+    {
+        if (buffer.Length < _variables.Length)
+        {
+            buffer = new LpcValue[_variables.Length];
+        }
+        Array.Copy(_variables, buffer, _variables.Length);
+        return buffer;
+    }
+
+    /// <summary>
+    /// Put back the slots saved by SnapshotVariables().
+    /// </summary>
+    internal void RestoreVariables(LpcValue[] snapshot)
+    {
+        Array.Copy(snapshot, _variables, _variables.Length);
+        StateVersion++;
+    }
+
     /// <summary>
     /// Find a function in this object's program (including inherited).
     /// </summary>
@@ -384,16 +1342,66 @@ public class MudObject
             return false;
         }
 
+        // Can't move into something inside this object, or nest too deep
+        if (destination != null && (Contains(destination) || destination.EnvironmentDepth() >= MaxEnvironmentDepth))
+        {
+            return false;
+        }
+
         // Remove from old environment
-        Environment?._contents.Remove(this);
+        if (Environment != null)
+        {
+            if (_isLiving)
+            {
+                Environment.UnlinkLiving(this);
+            }
+            Environment.UnlinkContent(this);
+            if (_isInteractive)
+            {
+                Environment.RemoveInteractive(this);
+            }
+            if (_initListed)
+            {
+                Environment._cold?.InitContents?.Remove(this);
+                _initListed = false;
+            }
+            if (_ownActions != null)
+            {
+                foreach (var action in _ownActions.List)
+                {
+                    Environment.UnindexContentAction(action);
+                }
+            }
+        }
         var oldEnvironment = Environment;
         Environment = null;
+        StateVersion++;
 
         // Add to new environment
         if (destination != null)
         {
-            destination._contents.Add(this);
+            destination.LinkContent(this);
             Environment = destination;
+            if (_isLiving)
+            {
+                destination.LinkLiving(this);
+            }
+            if (_isInteractive)
+            {
+                destination.AddInteractive(this);
+            }
+            if (Program.HasInit)
+            {
+                (destination.Cold.InitContents ??= new List<MudObject>()).Add(this);
+                _initListed = true;
+            }
+            if (_ownActions != null)
+            {
+                foreach (var action in _ownActions.List)
+                {
+                    destination.IndexContentAction(action);
+                }
+            }
         }
 
         return true;
@@ -401,26 +1409,38 @@ public class MudObject
 
     /// <summary>
     /// Check if this object contains another object (directly or indirectly).
-    /// Used to prevent circular containment.
+    /// Used to prevent circular containment. Walks up from obj rather than
+    /// down through everything this holds, and answers yes past
+    /// MaxEnvironmentDepth.
     /// </summary>
     public bool Contains(MudObject obj)
     {
-        if (_contents.Contains(obj))
-        {
-            return true;
-        }
-
-        foreach (var content in _contents)
+        var env = obj.Environment;
+        for (int depth = 0; env != null; depth++)
         {
-            if (content.Contains(obj))
+            if (env == this || depth >= MaxEnvironmentDepth)
             {
                 return true;
             }
+            env = env.Environment;
         }
 
         return false;
     }
 
+    /// <summary>
+    /// How many environments this object is nested in, up to MaxEnvironmentDepth.
+    /// </summary>
+    private int EnvironmentDepth()
+    {
+        int depth = 0;
+        for (var env = Environment; env != null && depth < MaxEnvironmentDepth; env = env.Environment)
+        {
+            depth++;
+        }
+        return depth;
+    }
+
     /// <summary>
     /// Get a display name for debugging.
     /// </summary>
@@ -0,0 +1,345 @@
+using System.IO.MemoryMappedFiles;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// What a path is on disk, from one stat.
+/// </summary>
+public enum FileKind { Missing, File, Directory }
+
+public readonly record struct FileStat(FileKind Kind, long Length, DateTime LastWriteUtc);
+
+/// <summary>
+/// Read-through cache behind the file efuns.
+///
+/// Wizard tools and daemons read the same handful of files and directories
+/// over and over, and each read_file() used to read and split the whole file
+/// while each get_dir() listed the directory afresh. Here file text and
+/// directory listings are kept along with the modification time and length
+/// they were read at. Every use costs one stat to check them; a file or
+/// directory that has changed since (an edit from outside the driver
+/// included) is read again.
+///
+/// File text is kept as read_file() returns it, line endings made "\n" and
+/// no final newline, with the offset of each line worked out on the first
+/// ranged read, so read_file(path, start, lines) is a substring. The cache
+/// holds at most MaxBytes of text and drops the least recently used files
+/// past that. Files over LargeFileThreshold aren't kept: a ranged read of one
+/// maps the file and scans only as far as the last line it wants.
+///
+/// Resolved paths are cached too, since a mudlib path always resolves to the
+/// same file system path. Thread-safe; the efuns' writes call Invalidate()
+/// rather than wait for the modification time to move.
+/// </summary>
+public sealed class MudlibFileCache
+{
+    private sealed class FileEntry
+    {
+        public required DateTime LastWriteUtc;
+        public required long Length;
+        public required string Text;
+        public int[]? LineStarts;
+        public required LinkedListNode<string> Node;
+    }
+
+    private readonly record struct DirectoryEntry(DateTime LastWriteUtc, string[] Names);
+
+    private readonly string _mudlibPath;
+    private readonly object _lock = new();
+    private readonly Dictionary<string, string> _resolved = new();
+    private readonly Dictionary<string, FileEntry> _files = new();
+    private readonly LinkedList<string> _recent = new();
+    private readonly Dictionary<string, DirectoryEntry> _directories = new();
+    private long _cachedBytes;
+
+    public MudlibFileCache(string mudlibPath)
+    {
+        _mudlibPath = Path.GetFullPath(mudlibPath);
+    }
+
+    /// <summary>
+    /// Most file text kept, in bytes (two per character).
+    /// </summary>
+    public long MaxBytes { get; init; } = 16 * 1024 * 1024;
+
+    /// <summary>
+    /// Files larger than this on disk are read without being kept.
+    /// </summary>
+    public long LargeFileThreshold { get; init; } = 1024 * 1024;
+
+    /// <summary>
+    /// Most resolved paths and directory listings kept.
+    /// </summary>
+    public int MaxEntries { get; init; } = 4096;
+
+    /// <summary>
+    /// Reads answered from the cache and reads that went to disk.
+    /// </summary>
+    public long Hits { get; private set; }
+    public long Misses { get; private set; }
+
+    public long CachedBytes
+    {
+        get { lock (_lock) return _cachedBytes; }
+    }
+
+    /// <summary>
+    /// The file system path of a mudlib path, or null if it would lead out
+    /// of the mudlib.
+    /// </summary>
+    public string? Resolve(string path)
+    {
+        lock (_lock)
+        {
+            if (_resolved.TryGetValue(path, out var cached)) return cached;
+        }
+
+        var fullPath = Path.GetFullPath(Path.Combine(_mudlibPath, path.TrimStart('/')));
+        if (!fullPath.StartsWith(_mudlibPath, StringComparison.Ordinal)) return null;
+
+        lock (_lock)
+        {
+            if (_resolved.Count >= MaxEntries) _resolved.Clear();
+            _resolved[path] = fullPath;
+        }
+        return fullPath;
+    }
+
+    public static FileStat Stat(string fullPath)
+    {
+        var info = new FileInfo(fullPath);
+        var attributes = info.Attributes;
+        if ((int)attributes == -1) return new FileStat(FileKind.Missing, 0, default);
+        if (attributes.HasFlag(FileAttributes.Directory)) return new FileStat(FileKind.Directory, 0, info.LastWriteTimeUtc);
+        return new FileStat(FileKind.File, info.Length, info.LastWriteTimeUtc);
+    }
+
+    /// <summary>
+    /// Lines [startLine, startLine + lineCount) of a file (1-based; all of
+    /// the rest when lineCount is null), joined with "\n". Null if there is
+    /// no such file.
+    /// </summary>
+    public string? ReadLines(string fullPath, int startLine = 1, int? lineCount = null)
+    {
+        var stat = Stat(fullPath);
+        if (stat.Kind != FileKind.File) return null;
+
+        bool whole = startLine <= 1 && lineCount == null;
+        if (stat.Length > LargeFileThreshold)
+        {
+            lock (_lock) Misses++;
+            return whole ? Normalize(File.ReadAllText(fullPath)) : ReadMappedLines(fullPath, startLine, lineCount);
+        }
+
+        FileEntry? entry;
+        lock (_lock)
+        {
+            if (_files.TryGetValue(fullPath, out entry) &&
+                entry.LastWriteUtc == stat.LastWriteUtc && entry.Length == stat.Length)
+            {
+                Hits++;
+                _recent.Remove(entry.Node);
+                _recent.AddFirst(entry.Node);
+            }
+            else
+            {
+                entry = null;
+            }
+        }
+
+        if (entry == null)
+        {
+            var text = Normalize(File.ReadAllText(fullPath));
+            lock (_lock)
+            {
+                Misses++;
+                Remove(fullPath);
+                entry = new FileEntry
+                {
+                    LastWriteUtc = stat.LastWriteUtc,
+                    Length = stat.Length,
+                    Text = text,
+                    Node = _recent.AddFirst(fullPath)
+                };
+                _files[fullPath] = entry;
+                _cachedBytes += text.Length * 2L;
+                while (_cachedBytes > MaxBytes && _recent.Last != null && _recent.Last != entry.Node)
+                {
+                    Remove(_recent.Last.Value);
+                }
+            }
+        }
+
+        if (whole) return entry.Text;
+
+        var starts = entry.LineStarts ??= LineStarts(entry.Text);
+        return Slice(entry.Text, starts, startLine, lineCount);
+    }
+
+    /// <summary>
+    /// Names in a directory, sorted, subdirectories with a trailing "/".
+    /// Null if it isn't a directory. The array is shared; copy before
+    /// handing it to LPC.
+    /// </summary>
+    public string[]? ListDirectory(string fullPath)
+    {
+        var stat = Stat(fullPath);
+        if (stat.Kind != FileKind.Directory) return null;
+
+        lock (_lock)
+        {
+            if (_directories.TryGetValue(fullPath, out var cached) && cached.LastWriteUtc == stat.LastWriteUtc)
+            {
+                Hits++;
+                return cached.Names;
+            }
+        }
+
+        var names = new List<string>();
+        foreach (var dir in Directory.EnumerateDirectories(fullPath))
+        {
+            names.Add(Path.GetFileName(dir) + "/");
+        }
+        foreach (var file in Directory.EnumerateFiles(fullPath))
+        {
+            names.Add(Path.GetFileName(file));
+        }
+        names.Sort();
+        var listing = names.ToArray();
+
+        lock (_lock)
+        {
+            Misses++;
+            if (_directories.Count >= MaxEntries) _directories.Clear();
+            _directories[fullPath] = new DirectoryEntry(stat.LastWriteUtc, listing);
+        }
+        return listing;
+    }
+
+    /// <summary>
+    /// Forget a path, anything under it and its directory's listing, after
+    /// the driver has written, removed or renamed it.
+    /// </summary>
+    public void Invalidate(string fullPath)
+    {
+        var parent = Path.GetDirectoryName(fullPath);
+        var prefix = fullPath + Path.DirectorySeparatorChar;
+        lock (_lock)
+        {
+            Remove(fullPath);
+            _directories.Remove(fullPath);
+            if (parent != null) _directories.Remove(parent);
+
+            foreach (var path in _files.Keys.Where(p => p.StartsWith(prefix, StringComparison.Ordinal)).ToList())
+            {
+                Remove(path);
+            }
+            foreach (var path in _directories.Keys.Where(p => p.StartsWith(prefix, StringComparison.Ordinal)).ToList())
+            {
+                _directories.Remove(path);
+            }
+        }
+    }
+
+    private void Remove(string fullPath)
+    {
+        if (_files.Remove(fullPath, out var entry))
+        {
+            _recent.Remove(entry.Node);
+            _cachedBytes -= entry.Text.Length * 2L;
+        }
+    }
+
+    /// <summary>
+    /// What joining File.ReadAllLines() with "\n" gives: "\r\n" and "\r" as
+    /// "\n", and no final newline.
+    /// </summary>
+    private static string Normalize(string text)
+    {
+        if (text.Contains('\r'))
+        {
+            text = text.Replace("\r\n", "\n").Replace('\r', '\n');
+        }
+        return text.EndsWith('\n') ? text[..^1] : text;
+    }
+
+    private static int[] LineStarts(string text)
+    {
+        var starts = new List<int> { 0 };
+        int i = -1;
+        while ((i = text.IndexOf('\n', i + 1)) >= 0)
+        {
+            starts.Add(i + 1);
+        }
+        return starts.ToArray();
+    }
+
+    private static string Slice(string text, int[] starts, int startLine, int? lineCount)
+    {
+        int first = Math.Max(startLine, 1) - 1;
+        if (first >= starts.Length || lineCount == 0) return "";
+
+        int end = lineCount == null || first + lineCount.Value >= starts.Length
+            ? text.Length
+            : starts[first + lineCount.Value] - 1;
+        return text[starts[first]..end];
+    }
+
+    /// <summary>
+    /// A line range of a large file: map it, skip to the first line wanted
+    /// and decode only the lines returned.
+    /// </summary>
+    private static string ReadMappedLines(string fullPath, int startLine, int? lineCount)
+    {
+        if (lineCount == 0) return "";
+
+        using var file = MemoryMappedFile.CreateFromFile(fullPath, FileMode.Open, null, 0, MemoryMappedFileAccess.Read);
+        using var stream = file.CreateViewStream(0, 0, MemoryMappedFileAccess.Read);
+        long length = new FileInfo(fullPath).Length;
+
+        // The view may run past the end of the file to a page boundary.
+        // A UTF-8 byte order mark isn't part of the first line.
+        long position = 0;
+        if (length >= 3 && stream.ReadByte() == 0xEF && stream.ReadByte() == 0xBB && stream.ReadByte() == 0xBF)
+        {
+            position = 3;
+        }
+        stream.Position = position;
+
+        var output = new MemoryStream();
+        int line = 1;
+        int taken = 0;
+        bool afterCr = false;
+        bool atLineStart = false;
+        int b;
+        while (position < length && (b = stream.ReadByte()) >= 0)
+        {
+            position++;
+            if (afterCr && b == '\n')
+            {
+                afterCr = false;
+                continue;
+            }
+            afterCr = b == '\r';
+
+            if (b == '\n' || b == '\r')
+            {
+                if (line >= startLine)
+                {
+                    if (++taken == lineCount) return Encoding.UTF8.GetString(output.GetBuffer(), 0, (int)output.Length);
+                    output.WriteByte((byte)'\n');
+                }
+                line++;
+                atLineStart = true;
+                continue;
+            }
+            atLineStart = false;
+            if (line >= startLine) output.WriteByte((byte)b);
+        }
+
+        // A final newline ends the last line rather than starting another
+        if (atLineStart && output.Length > 0) output.SetLength(output.Length - 1);
+        return Encoding.UTF8.GetString(output.GetBuffer(), 0, (int)output.Length);
+    }
+}
@@ -0,0 +1,144 @@
+namespace Driver;
+
+/// <summary>
+/// Living names in a trie keyed by lowercased character, for find_living(),
+/// find_player() and name completion. Finding a name, or the node where the
+/// names beginning with a prefix start, takes one step per character however
+/// many livings there are; listing those names then visits only that subtree,
+/// in alphabetical order ("bob" before "bobby").
+///
+/// Several objects may share a name (a player and a monster both "bob").
+/// A node keeps them in the order they took it, and exact lookups prefer the
+/// latest. Game thread only, like the rest of the object store.
+/// </summary>
+public sealed class NameIndex
+{
+    private sealed class Node
+    {
+        public char[] Keys = Array.Empty<char>(); // sorted, parallel to Children
+        public Node[] Children = Array.Empty<Node>();
+        public MudObject[] Objects = Array.Empty<MudObject>();
+        public int Count; // objects here and below
+    }
+
+    private readonly Node _root = new();
+
+    /// <summary>
+    /// Objects indexed.
+    /// </summary>
+    public int Count => _root.Count;
+
+    public void Add(string name, MudObject obj)
+    {
+        var node = _root;
+        node.Count++;
+        foreach (var c in name)
+        {
+            var key = char.ToLowerInvariant(c);
+            int i = Array.BinarySearch(node.Keys, key);
+            if (i < 0)
+            {
+                i = ~i;
+                node.Keys = Insert(node.Keys, i, key);
+                node.Children = Insert(node.Children, i, new Node());
+            }
+            node = node.Children[i];
+            node.Count++;
+        }
+        node.Objects = node.Objects.Append(obj).ToArray();
+    }
+
+    /// <summary>
+    /// Take obj out from under name. False if it wasn't there.
+    /// </summary>
+    public bool Remove(string name, MudObject obj)
+    {
+        var node = FindNode(name);
+        if (node == null || Array.IndexOf(node.Objects, obj) < 0) return false;
+        node.Objects = node.Objects.Where(other => other != obj).ToArray();
+
+        // Count down along the path, dropping branches left empty
+        node = _root;
+        node.Count--;
+        foreach (var c in name)
+        {
+            int i = Array.BinarySearch(node.Keys, char.ToLowerInvariant(c));
+            var child = node.Children[i];
+            if (--child.Count == 0)
+            {
+                node.Keys = RemoveAt(node.Keys, i);
+                node.Children = RemoveAt(node.Children, i);
+                break;
+            }
+            node = child;
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// The objects named exactly name, oldest first.
+    /// </summary>
+    public ReadOnlySpan<MudObject> Find(string name)
+    {
+        return FindNode(name) is { } node ? node.Objects : ReadOnlySpan<MudObject>.Empty;
+    }
+
+    /// <summary>
+    /// Objects whose names begin with prefix that match, in name order, at
+    /// most limit of them. Where a name is shared, the latest comes first.
+    /// </summary>
+    public List<MudObject> WithPrefix(string prefix, Func<MudObject, bool> match, int limit = int.MaxValue)
+    {
+        var result = new List<MudObject>();
+        var node = FindNode(prefix);
+        if (node != null && limit > 0)
+        {
+            Collect(node, match, limit, result);
+        }
+        return result;
+    }
+
+    private static bool Collect(Node node, Func<MudObject, bool> match, int limit, List<MudObject> result)
+    {
+        for (int i = node.Objects.Length - 1; i >= 0; i--)
+        {
+            if (!match(node.Objects[i])) continue;
+            result.Add(node.Objects[i]);
+            if (result.Count == limit) return false;
+        }
+        foreach (var child in node.Children)
+        {
+            if (!Collect(child, match, limit, result)) return false;
+        }
+        return true;
+    }
+
+    private Node? FindNode(string name)
+    {
+        var node = _root;
+        foreach (var c in name)
+        {
+            int i = Array.BinarySearch(node.Keys, char.ToLowerInvariant(c));
+            if (i < 0) return null;
+            node = node.Children[i];
+        }
+        return node;
+    }
+
+    private static T[] Insert<T>(T[] array, int index, T value)
+    {
+        var result = new T[array.Length + 1];
+        Array.Copy(array, result, index);
+        result[index] = value;
+        Array.Copy(array, index, result, index + 1, array.Length - index);
+        return result;
+    }
+
+    private static T[] RemoveAt<T>(T[] array, int index)
+    {
+        var result = new T[array.Length - 1];
+        Array.Copy(array, result, index);
+        Array.Copy(array, index + 1, result, index, array.Length - index - 1);
+        return result;
+    }
+}
@@ -0,0 +1,208 @@
+using System.Diagnostics;
+
+namespace Driver;
+
+/// <summary>
+/// A count of the loaded objects: how many clones each blueprint has, about
+/// how much memory each object's variables hold, the largest objects, and
+/// how all of it moved since the census before.
+///
+/// Sizing every object at once would stall a tick on a large world, so a
+/// census is started with Start() and carried forward by Step() between
+/// ticks, a time budget at a time, over the objects that were loaded when it
+/// started. Objects destructed before their turn are left out. When the
+/// last object is done the report replaces Latest and the old one becomes
+/// what the next census compares against.
+///
+/// Sizes are estimates of what the object's variables reach: strings,
+/// arrays and mappings counted with rough .NET overheads, each once per
+/// object however often it is referenced, and not through other objects.
+/// An array shared between two objects counts toward both.
+/// </summary>
+public sealed class ObjectCensus
+{
+    /// <summary>
+    /// Largest objects named in a report.
+    /// </summary>
+    public const int TopObjects = 10;
+
+    // Rough managed sizes on 64-bit .NET
+    private const long ObjectOverhead = 256;
+    private const long SlotSize = 16;
+    private const long StringOverhead = 22;
+    private const long ArrayOverhead = 56;
+    private const long MappingOverhead = 80;
+    private const long MappingEntrySize = 28;
+    private const long BoxSize = 24;
+
+    public sealed record BlueprintCount(string Name, int Clones, long Bytes, int CloneDelta, long ByteDelta);
+
+    public sealed record ObjectSize(string Name, long Bytes);
+
+    /// <param name="Took">From Start() to the end, across however many ticks</param>
+    /// <param name="Busy">Time actually spent sizing objects</param>
+    public sealed record Report(DateTime Finished, TimeSpan Took, TimeSpan Busy, int Objects, long Bytes,
+        IReadOnlyList<BlueprintCount> Blueprints, IReadOnlyList<ObjectSize> Largest);
+
+    private MudObject[]? _pending;
+    private int _next;
+    private int _counted;
+    private Dictionary<string, (int Clones, long Bytes)> _counts = new();
+    private PriorityQueue<ObjectSize, long> _largest = new();
+    private long _started;
+    private long _busyTicks;
+
+    /// <summary>
+    /// Time Step() may take per call.
+    /// </summary>
+    public TimeSpan StepBudget { get; init; } = TimeSpan.FromMilliseconds(1);
+
+    /// <summary>
+    /// The last finished census, or null if none has finished.
+    /// </summary>
+    public Report? Latest { get; private set; }
+
+    public bool Running => _pending != null;
+
+    /// <summary>
+    /// Objects sized so far in the running census, and how many it covers.
+    /// </summary>
+    public (int Done, int Total) Progress => (_next, _pending?.Length ?? 0);
+
+    /// <summary>
+    /// Begin a census of objects. False if one is already running.
+    /// </summary>
+    public bool Start(IEnumerable<MudObject> objects)
+    {
+        if (_pending != null) return false;
+
+        _pending = objects.ToArray();
+        _next = 0;
+        _counted = 0;
+        _counts = new Dictionary<string, (int, long)>();
+        _largest = new PriorityQueue<ObjectSize, long>();
+        _started = Stopwatch.GetTimestamp();
+        _busyTicks = 0;
+        return true;
+    }
+
+    /// <summary>
+    /// Size objects until the budget runs out or the census is done. True
+    /// when this call finished it.
+    /// </summary>
+    public bool Step()
+    {
+        if (_pending == null) return false;
+
+        long start = Stopwatch.GetTimestamp();
+        long deadline = start + (long)(StepBudget.TotalSeconds * Stopwatch.Frequency);
+        while (_next < _pending.Length)
+        {
+            var obj = _pending[_next];
+            _pending[_next++] = null!;
+            if (!obj.IsDestructed) Count(obj);
+
+            // Checking the clock every object would cost more than sizing most of them
+            if ((_next & 31) == 0 && Stopwatch.GetTimestamp() > deadline) break;
+        }
+        _busyTicks += Stopwatch.GetTimestamp() - start;
+
+        if (_next < _pending.Length) return false;
+        Finish();
+        return true;
+    }
+
+    /// <summary>
+    /// Run a whole census now, for tests and the REPL.
+    /// </summary>
+    public Report Run(IEnumerable<MudObject> objects)
+    {
+        Start(objects);
+        while (!Step())
+        {
+        }
+        return Latest!;
+    }
+
+    /// <summary>
+    /// Estimated bytes held by an object and what its variables reach.
+    /// </summary>
+    public static long EstimateSize(MudObject obj)
+    {
+        long bytes = ObjectOverhead + obj.VariableLayout.Count * SlotSize;
+        var seen = new HashSet<object>(ReferenceEqualityComparer.Instance);
+        for (int slot = 0; slot < obj.VariableLayout.Count; slot++)
+        {
+            var value = obj.GetVariableAt(slot);
+            if (!value.IsInt) bytes += SizeOf(value.Ref, seen);
+        }
+        return bytes;
+    }
+
+    private static long SizeOf(object? value, HashSet<object> seen)
+    {
+        // Other objects are counted as themselves, not as part of this one
+        if (value is null or MudObject || !seen.Add(value)) return 0;
+
+        switch (value)
+        {
+            case string s:
+                return StringOverhead + 2L * s.Length;
+            case List<object> list:
+            {
+                long bytes = ArrayOverhead + 8L * list.Capacity;
+                foreach (var item in list) bytes += SizeOf(item, seen);
+                return bytes;
+            }
+            case Dictionary<object, object> map:
+            {
+                long bytes = MappingOverhead + MappingEntrySize * map.Count;
+                foreach (var (key, item) in map) bytes += SizeOf(key, seen) + SizeOf(item, seen);
+                return bytes;
+            }
+            default:
+                return value.GetType().IsValueType ? BoxSize : 0;
+        }
+    }
+
+    private void Count(MudObject obj)
+    {
+        long bytes = EstimateSize(obj);
+        _counted++;
+        var name = obj.Blueprint?.ObjectName ?? obj.ObjectName;
+        var (clones, total) = _counts.GetValueOrDefault(name);
+        _counts[name] = (clones + (obj.IsBlueprint ? 0 : 1), total + bytes);
+
+        _largest.Enqueue(new ObjectSize(obj.ObjectName, bytes), bytes);
+        if (_largest.Count > TopObjects) _largest.Dequeue();
+    }
+
+    private void Finish()
+    {
+        var previous = Latest?.Blueprints.ToDictionary(b => b.Name) ?? new Dictionary<string, BlueprintCount>();
+        var blueprints = _counts
+            .Select(entry =>
+            {
+                previous.TryGetValue(entry.Key, out var before);
+                return new BlueprintCount(entry.Key, entry.Value.Clones, entry.Value.Bytes,
+                    entry.Value.Clones - (before?.Clones ?? 0), entry.Value.Bytes - (before?.Bytes ?? 0));
+            })
+            .OrderByDescending(b => b.Bytes)
+            .ThenBy(b => b.Name, StringComparer.Ordinal)
+            .ToList();
+
+        var largest = new List<ObjectSize>(_largest.Count);
+        while (_largest.TryDequeue(out var size, out _)) largest.Add(size);
+        largest.Reverse();
+
+        Latest = new Report(
+            DateTime.UtcNow,
+            Stopwatch.GetElapsedTime(_started),
+            TimeSpan.FromSeconds((double)_busyTicks / Stopwatch.Frequency),
+            _counted,
+            blueprints.Sum(b => b.Bytes),
+            blueprints,
+            largest);
+        _pending = null;
+    }
+}
@@ -0,0 +1,96 @@
+using System.Collections;
+
+namespace Driver;
+
+/// <summary>
+/// A live view of an object's contents (or just the livings among them),
+/// walking the lists MudObject threads through its contents. Count, First
+/// and Contains are O(1); the indexer walks from the front.
+///
+/// Like List, enumerating throws if the contents change underneath; copy
+/// with ToList() first to move things around while iterating.
+/// </summary>
+public readonly struct ObjectContents : IReadOnlyList<MudObject>
+{
+    private readonly MudObject _owner;
+    private readonly bool _living;
+
+    internal ObjectContents(MudObject owner, bool living)
+    {
+        _owner = owner;
+        _living = living;
+    }
+
+    public int Count => _living ? _owner.LivingCount : _owner.ContentCount;
+
+    /// <summary>
+    /// The first object, or null if there are none.
+    /// </summary>
+    public MudObject? First => _living ? _owner.FirstLiving : _owner.FirstContent;
+
+    public MudObject this[int index]
+    {
+        get
+        {
+            if ((uint)index >= (uint)Count) throw new ArgumentOutOfRangeException(nameof(index));
+            var obj = First!;
+            for (int i = 0; i < index; i++) obj = Next(obj)!;
+            return obj;
+        }
+    }
+
+    /// <summary>
+    /// Whether obj is directly inside the owner (and living, for a living view).
+    /// </summary>
+    public bool Contains(MudObject obj) => obj.Environment == _owner && (!_living || obj.IsLiving);
+
+    /// <summary>
+    /// The object after obj in this view, or null at the end.
+    /// </summary>
+    public MudObject? Next(MudObject obj) => _living ? obj.NextLiving : obj.NextContent;
+
+    public Enumerator GetEnumerator() => new(this);
+    IEnumerator<MudObject> IEnumerable<MudObject>.GetEnumerator() => GetEnumerator();
+    IEnumerator IEnumerable.GetEnumerator() => GetEnumerator();
+
+    public struct Enumerator : IEnumerator<MudObject>
+    {
+        private readonly ObjectContents _contents;
+        private readonly int _version;
+        private MudObject? _next;
+        private MudObject? _current;
+
+        internal Enumerator(ObjectContents contents)
+        {
+            _contents = contents;
+            _version = contents._owner.ContentsVersion;
+            _next = contents.First;
+            _current = null;
+        }
+
+        public MudObject Current => _current!;
+        object IEnumerator.Current => Current;
+
+        public bool MoveNext()
+        {
+            if (_version != _contents._owner.ContentsVersion)
+            {
+                throw new InvalidOperationException("Contents changed during enumeration.");
+            }
+            _current = _next;
+            if (_current == null) return false;
+            _next = _contents.Next(_current);
+            return true;
+        }
+
+        public void Reset()
+        {
+            _next = _contents.First;
+            _current = null;
+        }
+
+        public void Dispose()
+        {
+        }
+    }
+}
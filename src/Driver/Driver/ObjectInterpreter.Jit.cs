@@ -0,0 +1,723 @@
+using System.Diagnostics.CodeAnalysis;
+using System.Reflection;
+using System.Reflection.Emit;
+using System.Runtime.CompilerServices;
+
+namespace Driver;
+
+/// <summary>
+/// Second tier for compiled functions: once a function has been called
+/// JitThreshold times its bytecode is translated to IL in a DynamicMethod,
+/// which the .NET JIT turns into native code.
+///
+/// The translation is call-threaded: every instruction becomes a direct call
+/// to the same operation the VM performs (trivial ones are emitted inline),
+/// and jumps become IL branches, so there is no dispatch loop and no decoding.
+/// The operand stack depth before each instruction is fixed at compile time,
+/// so the stack pointer is a constant in the emitted code. Values stay in the
+/// frame array as LpcValue; the int fast paths are the VM's.
+///
+/// Instructions are charged exactly as the VM charges them (a block at a time
+/// on taken jumps and returns), so limits and profiles don't change when a
+/// function tiers up. Functions containing catch() or sscanf() stay on the VM.
+///
+/// Jitted code hangs off its <see cref="CompiledFunction"/>, so a hot reload
+/// that recompiles a function discards it along with the old bytecode; the new
+/// bytecode counts calls from zero.
+/// </summary>
+public partial class ObjectInterpreter
+{
+    /// <summary>
+    /// Run hot compiled functions as IL. When false every compiled function
+    /// stays on the VM, which lets a wizard compare the two (jit_enable(),
+    /// driver --server --no-jit).
+    /// </summary>
+    public bool UseJit { get; set; } = true;
+
+    /// <summary>
+    /// Calls a compiled function gets on the VM before it is jitted.
+    /// </summary>
+    public int JitThreshold { get; set; } = 500;
+
+    /// <summary>
+    /// Count a call to fn and jit it when it reaches the threshold.
+    /// Returns the jitted code, or null to run this call on the VM.
+    /// </summary>
+    private JitCode? TierUp(CompiledFunction fn)
+    {
+        if (!fn.CountCall(JitThreshold)) return null;
+
+        var code = CompileJit(fn);
+        fn.Jitted = code;
+        return code;
+    }
+
+    /// <summary>
+    /// Translate fn's bytecode to a DynamicMethod. Returns null when the
+    /// function uses an instruction the JIT doesn't handle, or the runtime
+    /// can't compile dynamic code (Native AOT).
+    /// </summary>
+    [UnconditionalSuppressMessage("AOT", "IL3050", Justification = "DynamicMethod is only created when RuntimeFeature.IsDynamicCodeSupported")]
+    internal static JitCode? CompileJit(CompiledFunction fn)
+    {
+        if (!RuntimeFeature.IsDynamicCodeSupported || !RuntimeFeature.IsDynamicCodeCompiled) return null;
+
+        var depths = StackDepths(fn);
+        if (depths == null) return null;
+
+        var method = new DynamicMethod($"lpc_{fn.Definition.Name}", typeof(LpcValue),
+            new[] { typeof(ObjectInterpreter), typeof(CompiledFunction), typeof(LpcValue[]) },
+            typeof(ObjectInterpreter), skipVisibility: true);
+        new JitEmitter(fn, depths, method.GetILGenerator()).Emit();
+        return (JitCode)method.CreateDelegate(typeof(JitCode));
+    }
+
+    /// <summary>
+    /// Operand stack depth (as a frame index) before each instruction, -1 for
+    /// unreachable ones. Null if some instruction isn't supported or the
+    /// depths don't agree where control flow meets.
+    /// </summary>
+    private static int[]? StackDepths(CompiledFunction fn)
+    {
+        var code = fn.Code;
+        var depths = new int[code.Length];
+        Array.Fill(depths, -1);
+
+        var pending = new Stack<int>();
+        depths[0] = fn.LocalNames.Length;
+        pending.Push(0);
+
+        while (pending.Count > 0)
+        {
+            int pc = pending.Pop();
+            var ins = code[pc];
+            if (StackEffect(ins) is not { } effect) return null;
+
+            int after = depths[pc] + effect;
+            if (after < fn.LocalNames.Length) return null;
+
+            foreach (int next in Successors(fn, pc))
+            {
+                if (next < 0 || next >= code.Length) return null;
+                if (depths[next] == -1)
+                {
+                    depths[next] = after;
+                    pending.Push(next);
+                }
+                else if (depths[next] != after)
+                {
+                    return null;
+                }
+            }
+        }
+        return depths;
+    }
+
+    private static int? StackEffect(Instruction ins) => ins.Op switch
+    {
+        OpCode.PushConst or OpCode.Dup or OpCode.LoadLocal or OpCode.IncDecLocal
+            or OpCode.LoadGlobal or OpCode.IncDecGlobal => 1,
+        OpCode.Pop or OpCode.DeclareLocal or OpCode.Binary or OpCode.Compound or OpCode.AppendLocal
+            or OpCode.JumpIfFalse or OpCode.JumpIfTrue or OpCode.Index or OpCode.SwitchEq
+            or (>= OpCode.AddInt and <= OpCode.NotEqualInt) => -1,
+        OpCode.StoreLocal or OpCode.StoreGlobal or OpCode.Unary or OpCode.ToBool or OpCode.Jump
+            or OpCode.IterInit or OpCode.IterNext or OpCode.IterValue or OpCode.Switch or OpCode.Return or OpCode.Throw => 0,
+        OpCode.Concat or OpCode.MakeArray => 1 - ins.A,
+        OpCode.MakeMapping => 1 - 2 * ins.A,
+        OpCode.Range or OpCode.IterInitRange => -(ins.A + ins.B),
+        OpCode.StoreIndex => -2,
+        OpCode.Call or OpCode.CallEfun or OpCode.CallParent or OpCode.CallOther => 1 - ins.B,
+        OpCode.CallArrow => -ins.B,
+        _ => null // Catch and sscanf() keep the VM
+    };
+
+    private static IEnumerable<int> Successors(CompiledFunction fn, int pc)
+    {
+        var ins = fn.Code[pc];
+        return ins.Op switch
+        {
+            OpCode.Jump => new[] { ins.A },
+            OpCode.JumpIfFalse or OpCode.JumpIfTrue => new[] { pc + 1, ins.A },
+            OpCode.IterNext => new[] { pc + 1, ins.B },
+            OpCode.Switch => fn.Switches[ins.A].Targets,
+            OpCode.Return or OpCode.Throw => Array.Empty<int>(),
+            _ => new[] { pc + 1 }
+        };
+    }
+
+    /// <summary>
+    /// Writes the IL for one function. Arguments are (interpreter, function,
+    /// frame); locals hold the thread, the constants and the variable slots
+    /// the VM would keep in its own locals.
+    /// </summary>
+    private sealed class JitEmitter
+    {
+        private const BindingFlags Helpers = BindingFlags.NonPublic | BindingFlags.Static | BindingFlags.Instance;
+
+        private readonly CompiledFunction _fn;
+        private readonly int[] _depths;
+        private readonly ILGenerator _il;
+        private readonly Label[] _labels;
+
+        private LocalBuilder _vm = null!;
+        private LocalBuilder _constants = null!;
+        private LocalBuilder _layout = null!;
+        private LocalBuilder _slots = null!;
+        private LocalBuilder _blockStart = null!;
+
+        public JitEmitter(CompiledFunction fn, int[] depths, ILGenerator il)
+        {
+            _fn = fn;
+            _depths = depths;
+            _il = il;
+            _labels = new Label[fn.Code.Length];
+            for (int i = 0; i < _labels.Length; i++)
+            {
+                _labels[i] = il.DefineLabel();
+            }
+        }
+
+        public void Emit()
+        {
+            _vm = _il.DeclareLocal(typeof(VmThread));
+            _constants = _il.DeclareLocal(typeof(LpcValue[]));
+            _layout = _il.DeclareLocal(typeof(VariableLayout));
+            _slots = _il.DeclareLocal(typeof(int[]));
+            _blockStart = _il.DeclareLocal(typeof(int));
+
+            _il.Emit(OpCodes.Ldarg_0);
+            Call(nameof(JitThread));
+            _il.Emit(OpCodes.Stloc, _vm);
+            _il.Emit(OpCodes.Ldarg_1);
+            _il.Emit(OpCodes.Callvirt, typeof(CompiledFunction).GetProperty(nameof(CompiledFunction.ConstantValues))!.GetMethod!);
+            _il.Emit(OpCodes.Stloc, _constants);
+            _il.Emit(OpCodes.Ldloc, _vm);
+            _il.Emit(OpCodes.Ldarg_1);
+            _il.Emit(OpCodes.Ldloca, _slots);
+            Call(nameof(JitLayout));
+            _il.Emit(OpCodes.Stloc, _layout);
+
+            for (int pc = 0; pc < _fn.Code.Length; pc++)
+            {
+                _il.MarkLabel(_labels[pc]);
+                if (_depths[pc] >= 0)
+                {
+                    EmitInstruction(pc, _fn.Code[pc], _depths[pc]);
+                }
+            }
+
+            // Bytecode always ends in a return; this keeps the IL verifiable
+            _il.Emit(OpCodes.Ldstr, $"Fell off the end of {_fn.Definition.Name}");
+            _il.Emit(OpCodes.Newobj, typeof(InvalidOperationException).GetConstructor(new[] { typeof(string) })!);
+            _il.Emit(OpCodes.Throw);
+        }
+
+        private void EmitInstruction(int pc, Instruction ins, int sp)
+        {
+            switch (ins.Op)
+            {
+                case OpCode.PushConst:
+                    // frame[sp] = constants[A]
+                    _il.Emit(OpCodes.Ldarg_2);
+                    Int(sp);
+                    _il.Emit(OpCodes.Ldloc, _constants);
+                    Int(ins.A);
+                    _il.Emit(OpCodes.Ldelem, typeof(LpcValue));
+                    _il.Emit(OpCodes.Stelem, typeof(LpcValue));
+                    break;
+
+                case OpCode.Pop:
+                    _il.Emit(OpCodes.Ldarg_2);
+                    Int(sp - 1);
+                    _il.Emit(OpCodes.Ldelema, typeof(LpcValue));
+                    _il.Emit(OpCodes.Initobj, typeof(LpcValue));
+                    break;
+
+                case OpCode.Dup:
+                    _il.Emit(OpCodes.Ldarg_2);
+                    Int(sp);
+                    _il.Emit(OpCodes.Ldarg_2);
+                    Int(sp - 1);
+                    _il.Emit(OpCodes.Ldelem, typeof(LpcValue));
+                    _il.Emit(OpCodes.Stelem, typeof(LpcValue));
+                    break;
+
+                case OpCode.LoadLocal:
+                    Frame(sp, ins.A);
+                    Call(ins.B != 0 ? nameof(JitLoadLocalReleased) : nameof(JitLoadLocal));
+                    break;
+
+                case OpCode.StoreLocal:
+                    Frame(sp, ins.A);
+                    Call(nameof(JitStoreLocal));
+                    break;
+
+                case OpCode.DeclareLocal:
+                    Frame(sp, ins.A);
+                    Call(nameof(JitDeclareLocal));
+                    break;
+
+                case OpCode.IncDecLocal:
+                    Frame(sp, ins.A, ins.B);
+                    Call(nameof(JitIncDecLocal));
+                    break;
+
+                case OpCode.LoadGlobal:
+                case OpCode.StoreGlobal:
+                case OpCode.IncDecGlobal:
+                    _il.Emit(OpCodes.Ldloc, _vm);
+                    _il.Emit(OpCodes.Ldarg_1);
+                    if (ins.Op == OpCode.IncDecGlobal) Frame(sp, ins.A, ins.B);
+                    else Frame(sp, ins.A);
+                    _il.Emit(OpCodes.Ldloca, _layout);
+                    _il.Emit(OpCodes.Ldloca, _slots);
+                    Call(ins.Op switch
+                    {
+                        OpCode.LoadGlobal => nameof(JitLoadGlobal),
+                        OpCode.StoreGlobal => nameof(JitStoreGlobal),
+                        _ => nameof(JitIncDecGlobal)
+                    });
+                    break;
+
+                case OpCode.Binary:
+                    This();
+                    Frame(sp, ins.A);
+                    Call(nameof(JitBinary));
+                    break;
+
+                case OpCode.Compound:
+                    This();
+                    Frame(sp, ins.A);
+                    Call(nameof(JitCompound));
+                    break;
+
+                case OpCode.AppendLocal:
+                    This();
+                    Frame(sp, ins.A, ins.B);
+                    Call(nameof(JitAppendLocal));
+                    break;
+
+                case >= OpCode.AddInt and <= OpCode.NotEqualInt:
+                    EmitIntOp(ins, sp);
+                    break;
+
+                case OpCode.Concat:
+                    This();
+                    _il.Emit(OpCodes.Ldloc, _vm);
+                    Frame(sp, ins.A);
+                    Call(nameof(OpConcat));
+                    break;
+
+                case OpCode.Unary:
+                    This();
+                    Frame(sp, ins.A);
+                    Call(nameof(JitUnary));
+                    break;
+
+                case OpCode.ToBool:
+                    Frame(sp);
+                    Call(nameof(JitToBool));
+                    break;
+
+                case OpCode.Jump:
+                    Charge(pc, ins.Line);
+                    Branch(ins.A);
+                    break;
+
+                case OpCode.JumpIfFalse:
+                case OpCode.JumpIfTrue:
+                    Frame(sp);
+                    Call(nameof(JitPopTruth));
+                    _il.Emit(ins.Op == OpCode.JumpIfFalse ? OpCodes.Brtrue : OpCodes.Brfalse, _labels[pc + 1]);
+                    Charge(pc, ins.Line);
+                    Branch(ins.A);
+                    break;
+
+                case OpCode.Return:
+                    Charge(pc, ins.Line);
+                    Frame(sp);
+                    Call(nameof(JitReturn));
+                    _il.Emit(OpCodes.Ret);
+                    break;
+
+                case OpCode.MakeArray:
+                    Frame(sp, ins.A);
+                    Call(nameof(OpMakeArray));
+                    break;
+
+                case OpCode.MakeMapping:
+                    Frame(sp, ins.A);
+                    Call(nameof(OpMakeMapping));
+                    break;
+
+                case OpCode.Index:
+                    Frame(sp);
+                    Call(nameof(OpIndex));
+                    break;
+
+                case OpCode.Range:
+                    Frame(sp, ins.A, ins.B);
+                    Call(nameof(OpRange));
+                    break;
+
+                case OpCode.StoreIndex:
+                    This();
+                    Frame(sp);
+                    Call(nameof(OpStoreIndex));
+                    break;
+
+                case OpCode.Call:
+                case OpCode.CallParent:
+                    This();
+                    _il.Emit(OpCodes.Ldarg_1);
+                    Frame(sp, ins.A, ins.B);
+                    Int(ins.Op == OpCode.CallParent ? 1 : 0);
+                    Int(ins.Line);
+                    Call(nameof(OpCall));
+                    break;
+
+                case OpCode.CallEfun:
+                    This();
+                    _il.Emit(OpCodes.Ldloc, _vm);
+                    _il.Emit(OpCodes.Ldarg_1);
+                    Frame(sp, ins.A, ins.B);
+                    Int(pc);
+                    Int(ins.Line);
+                    Call(nameof(OpCallEfun));
+                    break;
+
+                case OpCode.CallArrow:
+                    This();
+                    _il.Emit(OpCodes.Ldarg_1);
+                    Frame(sp, ins.A, ins.B);
+                    Int(pc);
+                    Call(nameof(OpCallArrow));
+                    break;
+
+                case OpCode.CallOther:
+                    This();
+                    _il.Emit(OpCodes.Ldloc, _vm);
+                    _il.Emit(OpCodes.Ldarg_1);
+                    Frame(sp, ins.A, ins.B);
+                    Int(pc);
+                    Int(ins.Line);
+                    Call(nameof(OpCallOther));
+                    break;
+
+                case OpCode.IterInit:
+                    Frame(sp, ins.A);
+                    Call(nameof(OpIterInit));
+                    break;
+
+                case OpCode.IterInitRange:
+                    Frame(sp, ins.A, ins.B);
+                    Call(nameof(OpIterInitRange));
+                    break;
+
+                case OpCode.IterNext:
+                    Frame(sp, ins.A);
+                    Call(nameof(OpIterNext));
+                    _il.Emit(OpCodes.Brtrue, _labels[pc + 1]);
+                    Charge(pc, ins.Line);
+                    Branch(ins.B);
+                    break;
+
+                case OpCode.IterValue:
+                    Frame(sp, ins.A);
+                    Call(nameof(OpIterValue));
+                    break;
+
+                case OpCode.SwitchEq:
+                    Frame(sp);
+                    Call(nameof(OpSwitchEq));
+                    break;
+
+                case OpCode.Switch:
+                {
+                    // The helper gives the position in Targets; each position
+                    // gets a stub that starts the new block at its target
+                    var targets = _fn.Switches[ins.A].Targets;
+                    var caseIndex = _il.DeclareLocal(typeof(int));
+                    _il.Emit(OpCodes.Ldarg_1);
+                    Frame(sp, ins.A);
+                    Call(nameof(OpSwitch));
+                    _il.Emit(OpCodes.Stloc, caseIndex);
+                    Charge(pc, ins.Line);
+
+                    var stubs = new Label[targets.Length];
+                    for (int i = 0; i < stubs.Length; i++)
+                    {
+                        stubs[i] = _il.DefineLabel();
+                    }
+                    _il.Emit(OpCodes.Ldloc, caseIndex);
+                    _il.Emit(OpCodes.Switch, stubs);
+                    _il.Emit(OpCodes.Br, stubs[^1]);
+                    for (int i = 0; i < stubs.Length; i++)
+                    {
+                        _il.MarkLabel(stubs[i]);
+                        Branch(targets[i]);
+                    }
+                    break;
+                }
+
+                case OpCode.Throw:
+                    This();
+                    Int(ins.A);
+                    Int(ins.Line);
+                    Call(nameof(JitThrow));
+                    _il.Emit(OpCodes.Throw);
+                    break;
+
+                default:
+                    throw new InvalidOperationException($"JIT has no translation for {ins.Op}");
+            }
+        }
+
+        /// <summary>
+        /// An int-specialized operator as typed IL: if both operands are ints,
+        /// a plain add or compare on the longs; otherwise the generic helper.
+        /// </summary>
+        private void EmitIntOp(Instruction ins, int sp)
+        {
+            var generic = _il.DefineLabel();
+            var done = _il.DefineLabel();
+            var isInt = typeof(LpcValue).GetProperty(nameof(LpcValue.IsInt))!.GetMethod!;
+            var intValue = typeof(LpcValue).GetProperty(nameof(LpcValue.Int))!.GetMethod!;
+
+            Element(sp - 2);
+            _il.Emit(OpCodes.Call, isInt);
+            _il.Emit(OpCodes.Brfalse, generic);
+            Element(sp - 1);
+            _il.Emit(OpCodes.Call, isInt);
+            _il.Emit(OpCodes.Brfalse, generic);
+
+            _il.Emit(OpCodes.Ldarg_2);
+            Int(sp - 2);
+            Element(sp - 2);
+            _il.Emit(OpCodes.Call, intValue);
+            Element(sp - 1);
+            _il.Emit(OpCodes.Call, intValue);
+            switch (ins.Op)
+            {
+                case OpCode.AddInt: _il.Emit(OpCodes.Add); break;
+                case OpCode.SubtractInt: _il.Emit(OpCodes.Sub); break;
+                case OpCode.LessInt: _il.Emit(OpCodes.Clt); break;
+                case OpCode.GreaterInt: _il.Emit(OpCodes.Cgt); break;
+                case OpCode.EqualInt: _il.Emit(OpCodes.Ceq); break;
+                case OpCode.LessEqualInt: _il.Emit(OpCodes.Cgt); Not(); break;
+                case OpCode.GreaterEqualInt: _il.Emit(OpCodes.Clt); Not(); break;
+                case OpCode.NotEqualInt: _il.Emit(OpCodes.Ceq); Not(); break;
+            }
+            bool arithmetic = ins.Op is OpCode.AddInt or OpCode.SubtractInt;
+            _il.Emit(OpCodes.Call, typeof(LpcValue).GetMethod(arithmetic ? nameof(LpcValue.FromInt) : nameof(LpcValue.FromBool))!);
+            _il.Emit(OpCodes.Stelem, typeof(LpcValue));
+            Element(sp - 1);
+            _il.Emit(OpCodes.Initobj, typeof(LpcValue));
+            _il.Emit(OpCodes.Br, done);
+
+            _il.MarkLabel(generic);
+            This();
+            Frame(sp, ins.A, ins.B);
+            Call(nameof(JitIntFallback));
+            _il.MarkLabel(done);
+        }
+
+        private void Element(int index)
+        {
+            _il.Emit(OpCodes.Ldarg_2);
+            Int(index);
+            _il.Emit(OpCodes.Ldelema, typeof(LpcValue));
+        }
+
+        private void Not()
+        {
+            _il.Emit(OpCodes.Ldc_I4_0);
+            _il.Emit(OpCodes.Ceq);
+        }
+
+        private void This() => _il.Emit(OpCodes.Ldarg_0);
+
+        private void Int(int value) => _il.Emit(OpCodes.Ldc_I4, value);
+
+        /// <summary>
+        /// Push the frame, the stack depth and any operands.
+        /// </summary>
+        private void Frame(int sp, params int[] operands)
+        {
+            _il.Emit(OpCodes.Ldarg_2);
+            Int(sp);
+            foreach (var operand in operands)
+            {
+                Int(operand);
+            }
+        }
+
+        /// <summary>
+        /// ChargeInstructions(vm, pc + 1 - blockStart, line), as the VM charges
+        /// when control leaves the block at pc.
+        /// </summary>
+        private void Charge(int pc, int line)
+        {
+            This();
+            _il.Emit(OpCodes.Ldloc, _vm);
+            Int(pc + 1);
+            _il.Emit(OpCodes.Ldloc, _blockStart);
+            _il.Emit(OpCodes.Sub);
+            Int(line);
+            Call(nameof(ChargeInstructions));
+        }
+
+        private void Branch(int target)
+        {
+            Int(target);
+            _il.Emit(OpCodes.Stloc, _blockStart);
+            _il.Emit(OpCodes.Br, _labels[target]);
+        }
+
+        private void Call(string helper)
+        {
+            var method = typeof(ObjectInterpreter).GetMethod(helper, Helpers)
+                ?? throw new InvalidOperationException($"Missing JIT helper {helper}");
+            _il.Emit(OpCodes.Call, method);
+        }
+    }
+
+    // Helpers called from jitted code. sp is the stack depth before the
+    // instruction, as in the VM; each one has the instruction's stack effect.
+
+    private static VmThread JitThread(ObjectInterpreter interpreter) => interpreter.Vm;
+
+    private static VariableLayout JitLayout(VmThread vm, CompiledFunction fn, out int[] slots)
+    {
+        var layout = vm.CurrentObject.VariableLayout;
+        slots = fn.GetVariableSlots(layout);
+        return layout;
+    }
+
+    private static void JitLoadLocal(LpcValue[] stack, int sp, int slot)
+    {
+        var value = stack[slot];
+        stack[sp] = value.IsNull ? VmZero : value;
+    }
+
+    private static void JitLoadLocalReleased(LpcValue[] stack, int sp, int slot)
+    {
+        Release(stack, slot);
+        JitLoadLocal(stack, sp, slot);
+    }
+
+    private static void JitStoreLocal(LpcValue[] stack, int sp, int slot)
+    {
+        stack[slot] = stack[sp - 1];
+    }
+
+    private static void JitDeclareLocal(LpcValue[] stack, int sp, int slot)
+    {
+        stack[slot] = stack[sp - 1];
+        stack[sp - 1] = default;
+    }
+
+    private static void JitIncDecLocal(LpcValue[] stack, int sp, int slot, int op)
+    {
+        var oldValue = ToInt(stack[slot]);
+        var newValue = IsIncrement((UnaryOperator)op) ? oldValue + 1 : oldValue - 1;
+        stack[slot] = LpcValue.FromInt(newValue);
+        stack[sp] = LpcValue.FromInt(IsPrefix((UnaryOperator)op) ? newValue : oldValue);
+    }
+
+    private static void JitLoadGlobal(VmThread vm, CompiledFunction fn, LpcValue[] stack, int sp, int name,
+        ref VariableLayout layout, ref int[] slots)
+    {
+        int slot = GlobalSlot(vm, fn, name, ref layout, ref slots);
+        var value = vm.CurrentObject.GetVariableAt(slot);
+        stack[sp] = value.IsNull ? VmZero : value;
+    }
+
+    private static void JitStoreGlobal(VmThread vm, CompiledFunction fn, LpcValue[] stack, int sp, int name,
+        ref VariableLayout layout, ref int[] slots)
+    {
+        int slot = GlobalSlot(vm, fn, name, ref layout, ref slots);
+        vm.CurrentObject.SetVariableAt(slot, stack[sp - 1]);
+    }
+
+    private static void JitIncDecGlobal(VmThread vm, CompiledFunction fn, LpcValue[] stack, int sp, int name, int op,
+        ref VariableLayout layout, ref int[] slots)
+    {
+        int slot = GlobalSlot(vm, fn, name, ref layout, ref slots);
+        var oldValue = ToInt(vm.CurrentObject.GetVariableAt(slot));
+        var newValue = IsIncrement((UnaryOperator)op) ? oldValue + 1 : oldValue - 1;
+        vm.CurrentObject.SetVariableAt(slot, LpcValue.FromInt(newValue));
+        stack[sp] = LpcValue.FromInt(IsPrefix((UnaryOperator)op) ? newValue : oldValue);
+    }
+
+    private void JitBinary(LpcValue[] stack, int sp, int op)
+    {
+        var right = stack[sp - 1];
+        stack[sp - 1] = default;
+        var left = stack[sp - 2];
+        stack[sp - 2] = left.IsInt && right.IsInt && TryIntBinary((BinaryOperator)op, left.Int, right.Int, out var result)
+            ? result
+            : LpcValue.FromObject(BinaryOpValues((BinaryOperator)op, left.ToObject(), right.ToObject()));
+    }
+
+    private void JitCompound(LpcValue[] stack, int sp, int op)
+    {
+        var right = stack[sp - 1];
+        stack[sp - 1] = default;
+        var left = stack[sp - 2];
+        stack[sp - 2] = left.IsInt && right.IsInt && TryIntBinary((BinaryOperator)op, left.Int, right.Int, out var result)
+            ? result
+            : LpcValue.FromObject(CompoundValue((BinaryOperator)op, left.ToObject(), right.ToObject()));
+    }
+
+    private void JitAppendLocal(LpcValue[] stack, int sp, int slot, int compound)
+    {
+        var value = stack[sp - 1];
+        stack[sp - 1] = default;
+        AppendLocal(stack, slot, compound != 0, value);
+    }
+
+    private void JitIntFallback(LpcValue[] stack, int sp, int op, int compound)
+    {
+        stack[sp - 2] = IntOpFallback(op, compound, stack[sp - 2], stack[sp - 1]);
+        stack[sp - 1] = default;
+    }
+
+    private void JitUnary(LpcValue[] stack, int sp, int op)
+    {
+        var operand = stack[sp - 1];
+        stack[sp - 1] = (UnaryOperator)op switch
+        {
+            UnaryOperator.LogicalNot => LpcValue.FromBool(!operand.IsTrue),
+            UnaryOperator.Negate when operand.IsInt => LpcValue.FromInt(-operand.Int),
+            UnaryOperator.BitwiseNot when operand.IsInt => LpcValue.FromInt(~operand.Int),
+            _ => LpcValue.FromObject(UnaryValue((UnaryOperator)op, operand.ToObject()))
+        };
+    }
+
+    private static void JitToBool(LpcValue[] stack, int sp)
+    {
+        stack[sp - 1] = LpcValue.FromBool(stack[sp - 1].IsTrue);
+    }
+
+    /// <summary>
+    /// Pop the condition of a conditional jump.
+    /// </summary>
+    private static bool JitPopTruth(LpcValue[] stack, int sp)
+    {
+        bool truth = stack[sp - 1].IsTrue;
+        stack[sp - 1] = default;
+        return truth;
+    }
+
+    private static LpcValue JitReturn(LpcValue[] stack, int sp)
+    {
+        var value = stack[sp - 1];
+        return value.IsNull ? LpcValue.Zero : value;
+    }
+
+    private Exception JitThrow(int kind, int line)
+    {
+        return StrayLoopControl(kind == 0 ? CompletionKind.Break : CompletionKind.Continue, line);
+    }
+}
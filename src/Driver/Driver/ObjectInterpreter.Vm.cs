@@ -0,0 +1,874 @@
+using System.Buffers;
+
+namespace Driver;
+
+/// <summary>
+/// Stack VM that executes bytecode produced by <see cref="BytecodeCompiler"/>.
+/// Shares runtime state (current object, call/trace stacks, limits) with the
+/// tree-walking interpreter, so compiled and uncompiled functions can call each
+/// other freely.
+///
+/// Each call gets one pooled frame array: parameter and local slots first, the
+/// operand stack after them. Compiled functions never touch LocalScopes.
+/// Frames hold LpcValue, so integer locals and arithmetic don't box; values
+/// are converted to object only when they leave the VM (calls, efuns, arrays).
+/// </summary>
+public partial class ObjectInterpreter
+{
+    /// <summary>
+    /// Run compiled functions on the VM. When false every function is tree-walked,
+    /// which is useful for debugging the compiler (driver --server --no-bytecode).
+    /// </summary>
+    public bool UseBytecode { get; set; } = true;
+
+    /// <summary>
+    /// Answer repeated calls of pure query functions from the object's
+    /// QueryMemo while its variables are unchanged (driver --server
+    /// --no-memoize turns it off).
+    /// </summary>
+    public bool MemoizeQueries { get; set; } = true;
+
+    /// <summary>
+    /// What a missing argument or a null read as: the boxed int 0, as in the tree walker.
+    /// </summary>
+    private static readonly LpcValue VmZero = LpcValue.FromObject(0);
+
+    /// <summary>
+    /// Results of a sscanf() parse while its targets are being assigned.
+    /// </summary>
+    private sealed class SscanfResults
+    {
+        public required object?[] Values { get; init; }
+        public int Count { get; init; }
+        public int Assigned { get; set; }
+    }
+
+    /// <summary>
+    /// Execute a compiled function body, as IL once it is hot (see UseJit). The
+    /// caller (CallUserFunctionWithProgram) has already checked the argument
+    /// count and pushed the call's frame.
+    /// </summary>
+    private object RunBytecode(CompiledFunction fn, List<object> args)
+    {
+        var frame = ArrayPool<LpcValue>.Shared.Rent(fn.FrameSize);
+        try
+        {
+            int paramCount = fn.Definition.Parameters.Count;
+            for (int i = 0; i < paramCount; i++)
+            {
+                // Use provided argument, or 0 for missing varargs parameters
+                frame[i] = i < args.Count ? LpcValue.FromObject(args[i]) : VmZero;
+            }
+            var jitted = UseJit ? fn.Jitted ?? TierUp(fn) : null;
+            var result = jitted != null
+                ? jitted(this, fn, frame)
+                : RunBytecode(fn, frame, fn.LocalNames.Length, 0);
+            return result.ToObject() ?? 0L;
+        }
+        finally
+        {
+            ArrayPool<LpcValue>.Shared.Return(frame, clearArray: true);
+        }
+    }
+
+    /// <summary>
+    /// AppendLocal: frame[slot] += value (op= rules) or frame[slot] + value.
+    /// An array or mapping the slot owns (LpcValue.Owned) grows in place.
+    /// Otherwise two arrays or two mappings are combined into a new one the
+    /// slot owns, and anything else is left to CompoundValue/BinaryOpValues.
+    /// </summary>
+    private void AppendLocal(LpcValue[] frame, int slot, bool compound, LpcValue value)
+    {
+        var current = frame[slot];
+        var right = value.ToObject();
+
+        if (current.Ref is List<object> array && right is List<object> items)
+        {
+            if (!current.IsOwned)
+            {
+                var copy = new List<object>(Math.Max(4, (array.Count + items.Count) * 2));
+                copy.AddRange(array);
+                frame[slot] = LpcValue.Owned(array = copy);
+            }
+            array.AddRange(items);
+            return;
+        }
+
+        if (current.Ref is Dictionary<object, object> mapping && right is Dictionary<object, object> entries)
+        {
+            if (!current.IsOwned)
+            {
+                mapping = new LpcMapping(mapping);
+                frame[slot] = LpcValue.Owned(mapping);
+            }
+            foreach (var (key, entry) in entries)
+            {
+                mapping[key] = entry;
+            }
+            return;
+        }
+
+        var left = current.IsNull ? null : current.ToObject();
+        frame[slot] = LpcValue.FromObject(compound
+            ? CompoundValue(BinaryOperator.Add, left, right)
+            : BinaryOpValues(BinaryOperator.Add, left, right));
+    }
+
+    /// <summary>
+    /// A LoadLocal of a local AppendLocal builds into: the value is about to be
+    /// handed on, so the slot stops owning it.
+    /// </summary>
+    private static void Release(LpcValue[] frame, int slot)
+    {
+        if (frame[slot].IsOwned) frame[slot] = LpcValue.FromObject(frame[slot].Ref);
+    }
+
+    /// <summary>
+    /// The dispatch loop. Runs from pc until Return (function exit) or
+    /// CatchEnd (end of a nested catch() body) and returns that value.
+    /// stack is the call's whole frame: local slots are addressed directly by
+    /// index and the operand stack grows upward from sp.
+    /// </summary>
+    private LpcValue RunBytecode(CompiledFunction fn, LpcValue[] stack, int sp, int pc)
+    {
+        var vm = Vm;
+        var code = fn.Code;
+        var constants = fn.ConstantValues;
+        var layout = vm.CurrentObject.VariableLayout;
+        var slots = fn.GetVariableSlots(layout);
+
+        // Instructions are charged to the limit a block at a time: when control
+        // leaves straight-line code (a taken jump or a return), everything
+        // since blockStart is counted, and the limit error names that line.
+        int blockStart = pc;
+
+        while (true)
+        {
+            var ins = code[pc++];
+
+            switch (ins.Op)
+            {
+                case OpCode.PushConst:
+                    stack[sp++] = constants[ins.A];
+                    break;
+
+                case OpCode.Pop:
+                    stack[--sp] = default;
+                    break;
+
+                case OpCode.Dup:
+                    stack[sp] = stack[sp - 1];
+                    sp++;
+                    break;
+
+                case OpCode.LoadLocal:
+                {
+                    if (ins.B != 0) Release(stack, ins.A);
+                    var value = stack[ins.A];
+                    stack[sp++] = value.IsNull ? VmZero : value;
+                    break;
+                }
+
+                case OpCode.StoreLocal:
+                    stack[ins.A] = stack[sp - 1];
+                    break;
+
+                case OpCode.DeclareLocal:
+                    stack[ins.A] = stack[--sp];
+                    stack[sp] = default;
+                    break;
+
+                case OpCode.IncDecLocal:
+                {
+                    var oldValue = ToInt(stack[ins.A]);
+                    var op = (UnaryOperator)ins.B;
+                    var newValue = IsIncrement(op) ? oldValue + 1 : oldValue - 1;
+                    stack[ins.A] = LpcValue.FromInt(newValue);
+                    stack[sp++] = LpcValue.FromInt(IsPrefix(op) ? newValue : oldValue);
+                    break;
+                }
+
+                case OpCode.LoadGlobal:
+                {
+                    int slot = GlobalSlot(vm, fn, ins.A, ref layout, ref slots);
+                    var value = vm.CurrentObject.GetVariableAt(slot);
+                    stack[sp++] = value.IsNull ? VmZero : value;
+                    break;
+                }
+
+                case OpCode.StoreGlobal:
+                {
+                    int slot = GlobalSlot(vm, fn, ins.A, ref layout, ref slots);
+                    vm.CurrentObject.SetVariableAt(slot, stack[sp - 1]);
+                    break;
+                }
+
+                case OpCode.IncDecGlobal:
+                {
+                    int slot = GlobalSlot(vm, fn, ins.A, ref layout, ref slots);
+                    var oldValue = ToInt(vm.CurrentObject.GetVariableAt(slot));
+                    var op = (UnaryOperator)ins.B;
+                    var newValue = IsIncrement(op) ? oldValue + 1 : oldValue - 1;
+                    vm.CurrentObject.SetVariableAt(slot, LpcValue.FromInt(newValue));
+                    stack[sp++] = LpcValue.FromInt(IsPrefix(op) ? newValue : oldValue);
+                    break;
+                }
+
+                case OpCode.Binary:
+                {
+                    var right = stack[--sp];
+                    stack[sp] = default;
+                    var left = stack[sp - 1];
+                    var op = (BinaryOperator)ins.A;
+                    stack[sp - 1] = left.IsInt && right.IsInt && TryIntBinary(op, left.Int, right.Int, out var result)
+                        ? result
+                        : LpcValue.FromObject(BinaryOpValues(op, left.ToObject(), right.ToObject()));
+                    break;
+                }
+
+                case OpCode.Compound:
+                {
+                    var right = stack[--sp];
+                    stack[sp] = default;
+                    var left = stack[sp - 1];
+                    var op = (BinaryOperator)ins.A;
+                    stack[sp - 1] = left.IsInt && right.IsInt && TryIntBinary(op, left.Int, right.Int, out var result)
+                        ? result
+                        : LpcValue.FromObject(CompoundValue(op, left.ToObject(), right.ToObject()));
+                    break;
+                }
+
+                case OpCode.AppendLocal:
+                    AppendLocal(stack, ins.A, ins.B != 0, stack[--sp]);
+                    stack[sp] = default;
+                    break;
+
+                case OpCode.AddInt:
+                {
+                    var right = stack[--sp];
+                    stack[sp] = default;
+                    var left = stack[sp - 1];
+                    stack[sp - 1] = left.IsInt && right.IsInt ? LpcValue.FromInt(left.Int + right.Int) : IntOpFallback(ins.A, ins.B, left, right);
+                    break;
+                }
+
+                case OpCode.SubtractInt:
+                {
+                    var right = stack[--sp];
+                    stack[sp] = default;
+                    var left = stack[sp - 1];
+                    stack[sp - 1] = left.IsInt && right.IsInt ? LpcValue.FromInt(left.Int - right.Int) : IntOpFallback(ins.A, ins.B, left, right);
+                    break;
+                }
+
+                case OpCode.LessInt:
+                {
+                    var right = stack[--sp];
+                    stack[sp] = default;
+                    var left = stack[sp - 1];
+                    stack[sp - 1] = left.IsInt && right.IsInt ? LpcValue.FromBool(left.Int < right.Int) : IntOpFallback(ins.A, ins.B, left, right);
+                    break;
+                }
+
+                case OpCode.LessEqualInt:
+                {
+                    var right = stack[--sp];
+                    stack[sp] = default;
+                    var left = stack[sp - 1];
+                    stack[sp - 1] = left.IsInt && right.IsInt ? LpcValue.FromBool(left.Int <= right.Int) : IntOpFallback(ins.A, ins.B, left, right);
+                    break;
+                }
+
+                case OpCode.GreaterInt:
+                {
+                    var right = stack[--sp];
+                    stack[sp] = default;
+                    var left = stack[sp - 1];
+                    stack[sp - 1] = left.IsInt && right.IsInt ? LpcValue.FromBool(left.Int > right.Int) : IntOpFallback(ins.A, ins.B, left, right);
+                    break;
+                }
+
+                case OpCode.GreaterEqualInt:
+                {
+                    var right = stack[--sp];
+                    stack[sp] = default;
+                    var left = stack[sp - 1];
+                    stack[sp - 1] = left.IsInt && right.IsInt ? LpcValue.FromBool(left.Int >= right.Int) : IntOpFallback(ins.A, ins.B, left, right);
+                    break;
+                }
+
+                case OpCode.EqualInt:
+                {
+                    var right = stack[--sp];
+                    stack[sp] = default;
+                    var left = stack[sp - 1];
+                    stack[sp - 1] = left.IsInt && right.IsInt ? LpcValue.FromBool(left.Int == right.Int) : IntOpFallback(ins.A, ins.B, left, right);
+                    break;
+                }
+
+                case OpCode.NotEqualInt:
+                {
+                    var right = stack[--sp];
+                    stack[sp] = default;
+                    var left = stack[sp - 1];
+                    stack[sp - 1] = left.IsInt && right.IsInt ? LpcValue.FromBool(left.Int != right.Int) : IntOpFallback(ins.A, ins.B, left, right);
+                    break;
+                }
+
+                case OpCode.Concat:
+                    OpConcat(vm, stack, sp, ins.A);
+                    sp += 1 - ins.A;
+                    break;
+
+                case OpCode.Unary:
+                {
+                    var operand = stack[sp - 1];
+                    var op = (UnaryOperator)ins.A;
+                    stack[sp - 1] = op switch
+                    {
+                        UnaryOperator.LogicalNot => LpcValue.FromBool(!operand.IsTrue),
+                        UnaryOperator.Negate when operand.IsInt => LpcValue.FromInt(-operand.Int),
+                        UnaryOperator.BitwiseNot when operand.IsInt => LpcValue.FromInt(~operand.Int),
+                        _ => LpcValue.FromObject(UnaryValue(op, operand.ToObject()))
+                    };
+                    break;
+                }
+
+                case OpCode.ToBool:
+                    stack[sp - 1] = LpcValue.FromBool(stack[sp - 1].IsTrue);
+                    break;
+
+                case OpCode.Jump:
+                    ChargeInstructions(vm, pc - blockStart, ins.Line);
+                    pc = blockStart = ins.A;
+                    break;
+
+                case OpCode.JumpIfFalse:
+                    if (!stack[--sp].IsTrue)
+                    {
+                        ChargeInstructions(vm, pc - blockStart, ins.Line);
+                        pc = blockStart = ins.A;
+                    }
+                    stack[sp] = default;
+                    break;
+
+                case OpCode.JumpIfTrue:
+                    if (stack[--sp].IsTrue)
+                    {
+                        ChargeInstructions(vm, pc - blockStart, ins.Line);
+                        pc = blockStart = ins.A;
+                    }
+                    stack[sp] = default;
+                    break;
+
+                case OpCode.Return:
+                case OpCode.CatchEnd:
+                {
+                    ChargeInstructions(vm, pc - blockStart, ins.Line);
+                    var value = stack[--sp];
+                    return value.IsNull ? LpcValue.Zero : value;
+                }
+
+                case OpCode.MakeArray:
+                    OpMakeArray(stack, sp, ins.A);
+                    sp += 1 - ins.A;
+                    break;
+
+                case OpCode.MakeMapping:
+                    OpMakeMapping(stack, sp, ins.A);
+                    sp += 1 - 2 * ins.A;
+                    break;
+
+                case OpCode.Index:
+                    OpIndex(stack, sp);
+                    sp--;
+                    break;
+
+                case OpCode.Range:
+                    OpRange(stack, sp, ins.A, ins.B);
+                    sp -= ins.A + ins.B;
+                    break;
+
+                case OpCode.StoreIndex:
+                    OpStoreIndex(stack, sp);
+                    sp -= 2;
+                    break;
+
+                case OpCode.Call:
+                case OpCode.CallParent:
+                    OpCall(fn, stack, sp, ins.A, ins.B, ins.Op == OpCode.CallParent, ins.Line);
+                    sp += 1 - ins.B;
+                    break;
+
+                case OpCode.CallEfun:
+                    OpCallEfun(vm, fn, stack, sp, ins.A, ins.B, pc - 1, ins.Line);
+                    sp += 1 - ins.B;
+                    break;
+
+                case OpCode.CallArrow:
+                    OpCallArrow(fn, stack, sp, ins.A, ins.B, pc - 1);
+                    sp -= ins.B;
+                    break;
+
+                case OpCode.CallOther:
+                    OpCallOther(vm, fn, stack, sp, ins.A, ins.B, pc - 1, ins.Line);
+                    sp += 1 - ins.B;
+                    break;
+
+                case OpCode.IterInit:
+                    OpIterInit(stack, sp, ins.A);
+                    break;
+
+                case OpCode.IterInitRange:
+                    OpIterInitRange(stack, sp, ins.A, ins.B);
+                    sp -= ins.A + ins.B;
+                    break;
+
+                case OpCode.IterNext:
+                    if (!OpIterNext(stack, sp, ins.A))
+                    {
+                        ChargeInstructions(vm, pc - blockStart, ins.Line);
+                        pc = blockStart = ins.B;
+                    }
+                    break;
+
+                case OpCode.IterValue:
+                    OpIterValue(stack, sp, ins.A);
+                    break;
+
+                case OpCode.SwitchEq:
+                    OpSwitchEq(stack, sp);
+                    sp--;
+                    break;
+
+                case OpCode.Switch:
+                {
+                    int target = OpSwitch(fn, stack, sp, ins.A);
+                    ChargeInstructions(vm, pc - blockStart, ins.Line);
+                    pc = blockStart = fn.Switches[ins.A].Targets[target];
+                    break;
+                }
+
+                case OpCode.Catch:
+                {
+                    // The body charges its own blocks, up to its CatchEnd
+                    ChargeInstructions(vm, pc - blockStart, ins.Line);
+                    LpcValue result;
+                    try
+                    {
+                        RunBytecode(fn, stack, sp, pc);
+                        result = LpcValue.Zero; // Success
+                    }
+                    catch (Exception ex) when (IsCatchable(ex))
+                    {
+                        result = LpcValue.FromObject(CatchResult(ex));
+                    }
+                    Array.Clear(stack, sp, stack.Length - sp);
+                    stack[sp++] = result;
+                    pc = blockStart = ins.A + 1;
+                    break;
+                }
+
+                case OpCode.Sscanf:
+                {
+                    var format = stack[--sp].Ref as string
+                        ?? throw new ObjectInterpreterException("sscanf() second argument must be a format string");
+                    var input = stack[sp - 1].Ref as string
+                        ?? throw new ObjectInterpreterException("sscanf() first argument must be a string");
+                    stack[sp] = default;
+                    var plan = SscanfFormat.Get(format);
+                    var values = new object?[plan.Captures];
+                    int count = plan.Match(input, values);
+                    stack[sp - 1] = LpcValue.FromObject(new SscanfResults { Values = values, Count = count });
+                    break;
+                }
+
+                case OpCode.SscanfStoreLocal:
+                {
+                    var results = (SscanfResults)stack[sp - 1].Ref!;
+                    if (ins.B < results.Count)
+                    {
+                        stack[ins.A] = LpcValue.FromObject(results.Values[ins.B]);
+                        results.Assigned++;
+                    }
+                    break;
+                }
+
+                case OpCode.SscanfStoreGlobal:
+                {
+                    var results = (SscanfResults)stack[sp - 1].Ref!;
+                    if (ins.B < results.Count)
+                    {
+                        int slot = GlobalSlot(vm, fn, ins.A, ref layout, ref slots);
+                        vm.CurrentObject.SetVariableAt(slot, LpcValue.FromObject(results.Values[ins.B]));
+                        results.Assigned++;
+                    }
+                    break;
+                }
+
+                case OpCode.SscanfStoreIndex:
+                {
+                    var index = stack[--sp].ToObject()!;
+                    var target = stack[--sp].ToObject()!;
+                    stack[sp] = stack[sp + 1] = default;
+                    var results = (SscanfResults)stack[sp - 1].Ref!;
+                    if (ins.B < results.Count)
+                    {
+                        SetIndexValue(target, index, results.Values[ins.B]!);
+                        results.Assigned++;
+                    }
+                    break;
+                }
+
+                case OpCode.SscanfEnd:
+                    stack[sp - 1] = LpcValue.FromObject(((SscanfResults)stack[sp - 1].Ref!).Assigned);
+                    break;
+
+                case OpCode.Throw:
+                    throw StrayLoopControl(ins.A == 0 ? CompletionKind.Break : CompletionKind.Continue, ins.Line);
+
+                default:
+                    throw RuntimeError($"Unknown opcode: {ins.Op}", ins.Line);
+            }
+        }
+    }
+
+    // Operations shared by the VM and jitted code. Each works on the top of
+    // the operand stack given the depth sp before the instruction; the caller
+    // moves its own stack pointer by the instruction's effect.
+
+    private void OpConcat(VmThread vm, LpcValue[] stack, int sp, int count)
+    {
+        int first = sp - count;
+        var result = ConcatValues(vm, stack, first, sp);
+        Array.Clear(stack, first, count);
+        stack[first] = result;
+    }
+
+    private static void OpMakeArray(LpcValue[] stack, int sp, int count)
+    {
+        var elements = new List<object>(count);
+        int first = sp - count;
+        for (int i = first; i < sp; i++)
+        {
+            elements.Add(stack[i].ToObject()!);
+            stack[i] = default;
+        }
+        stack[first] = LpcValue.FromObject(elements);
+    }
+
+    private static void OpMakeMapping(LpcValue[] stack, int sp, int pairs)
+    {
+        var dict = new LpcMapping();
+        int first = sp - 2 * pairs;
+        for (int i = first; i < sp; i += 2)
+        {
+            dict[stack[i].ToObject()!] = stack[i + 1].ToObject()!;
+            stack[i] = stack[i + 1] = default;
+        }
+        stack[first] = LpcValue.FromObject(dict);
+    }
+
+    private static void OpIndex(LpcValue[] stack, int sp)
+    {
+        var index = stack[sp - 1];
+        stack[sp - 1] = default;
+        stack[sp - 2] = LpcValue.FromObject(IndexValue(stack[sp - 2].ToObject()!, index.ToObject()!));
+    }
+
+    private static void OpRange(LpcValue[] stack, int sp, int hasStart, int hasEnd)
+    {
+        object? end = null;
+        object? start = null;
+        if (hasEnd != 0)
+        {
+            end = stack[--sp].ToObject();
+            stack[sp] = default;
+        }
+        if (hasStart != 0)
+        {
+            start = stack[--sp].ToObject();
+            stack[sp] = default;
+        }
+        stack[sp - 1] = LpcValue.FromObject(RangeValue(stack[sp - 1].ToObject()!, start, end));
+    }
+
+    private void OpStoreIndex(LpcValue[] stack, int sp)
+    {
+        var value = stack[sp - 1];
+        var index = stack[sp - 2].ToObject()!;
+        stack[sp - 1] = stack[sp - 2] = default;
+        SetIndexValue(stack[sp - 3].ToObject()!, index, value.ToObject()!);
+        stack[sp - 3] = value;
+    }
+
+    private void OpCall(CompiledFunction fn, LpcValue[] stack, int sp, int name, int argCount, bool isParent, int line)
+    {
+        var args = PopArguments(stack, ref sp, argCount);
+        var result = CallNamedFunction(fn.Names[name], args, isParent, line);
+        stack[sp] = LpcValue.FromObject(result);
+    }
+
+    /// <summary>
+    /// A call the compiler bound to an efun. An object whose program defines
+    /// the name still gets its own function, found through the site's cache;
+    /// otherwise the efun comes from its slot, and a SpanEfun reads its
+    /// arguments off the stack.
+    /// </summary>
+    private void OpCallEfun(VmThread vm, CompiledFunction fn, LpcValue[] stack, int sp, int name, int argCount, int pc, int line)
+    {
+        if (fn.GetCallSite(pc).Lookup(vm.CurrentObject.Program, fn.Names[name]).Function != null ||
+            !_efuns.TryGet(fn.EfunSlots[name], out var efun, out var spanEfun))
+        {
+            OpCall(fn, stack, sp, name, argCount, false, line);
+            return;
+        }
+
+        int first = sp - argCount;
+        LpcValue result;
+        if (spanEfun != null && vm.Sandbox == null && RegionGuard == null)
+        {
+            try
+            {
+                result = spanEfun(new ReadOnlySpan<LpcValue>(stack, first, argCount));
+            }
+            catch (EfunException ex)
+            {
+                throw RuntimeError(ex.Message, line);
+            }
+            Array.Clear(stack, first, argCount);
+        }
+        else
+        {
+            var args = PopArguments(stack, ref sp, argCount);
+            result = LpcValue.FromObject(CallEfun(fn.Names[name], efun, args, line));
+        }
+        stack[first] = result;
+    }
+
+    private void OpCallArrow(CompiledFunction fn, LpcValue[] stack, int sp, int name, int argCount, int pc)
+    {
+        var args = PopArguments(stack, ref sp, argCount);
+        var result = CallArrow(stack[sp - 1].ToObject()!, fn.Names[name], args, fn.GetCallSite(pc));
+        stack[sp - 1] = LpcValue.FromObject(result);
+    }
+
+    private void OpCallOther(VmThread vm, CompiledFunction fn, LpcValue[] stack, int sp, int name, int argCount, int pc, int line)
+    {
+        var args = PopArguments(stack, ref sp, argCount);
+        // An object may define its own call_other(); only the efun is cached
+        object result = vm.CurrentObject.Program.FindFunction(fn.Names[name]) != null
+            ? CallNamedFunction(fn.Names[name], args, false, line)
+            : CallOtherCached(args, fn.GetCallSite(pc), line);
+        stack[sp] = LpcValue.FromObject(result);
+    }
+
+    private static void OpIterInit(LpcValue[] stack, int sp, int pairs)
+    {
+        stack[sp - 1] = LpcValue.FromObject(ForeachCursor.Over(stack[sp - 1].ToObject(), pairs != 0));
+    }
+
+    private static void OpIterInitRange(LpcValue[] stack, int sp, int hasStart, int hasEnd)
+    {
+        object? end = null;
+        object? start = null;
+        if (hasEnd != 0)
+        {
+            end = stack[--sp].ToObject();
+            stack[sp] = default;
+        }
+        if (hasStart != 0)
+        {
+            start = stack[--sp].ToObject();
+            stack[sp] = default;
+        }
+        stack[sp - 1] = LpcValue.FromObject(ForeachCursor.OverRange(stack[sp - 1].ToObject(), start, end));
+    }
+
+    /// <summary>
+    /// Advance the foreach iterator into its slot; false when it's exhausted.
+    /// </summary>
+    private static bool OpIterNext(LpcValue[] stack, int sp, int slot)
+    {
+        var cursor = (ForeachCursor)stack[sp - 1].Ref!;
+        if (!cursor.MoveNext(out var item)) return false;
+
+        stack[slot] = LpcValue.FromObject(item);
+        return true;
+    }
+
+    /// <summary>
+    /// Put the value under the key the foreach iterator is on into its slot.
+    /// </summary>
+    private static void OpIterValue(LpcValue[] stack, int sp, int slot)
+    {
+        stack[slot] = LpcValue.FromObject(((ForeachCursor)stack[sp - 1].Ref!).Value);
+    }
+
+    private static void OpSwitchEq(LpcValue[] stack, int sp)
+    {
+        var caseValue = stack[sp - 1];
+        stack[sp - 1] = default;
+        var value = stack[sp - 2];
+        stack[sp - 2] = LpcValue.FromBool(value.IsInt && caseValue.IsInt
+            ? value.Int == caseValue.Int
+            : ValuesEqual(value.ToObject(), caseValue.ToObject()));
+    }
+
+    /// <summary>
+    /// Position in the switch's Targets to jump to (the last one when nothing matches).
+    /// </summary>
+    private static int OpSwitch(CompiledFunction fn, LpcValue[] stack, int sp, int index)
+    {
+        var (table, targets) = fn.Switches[index];
+        int caseIndex = table.Lookup(stack[sp - 1]);
+        return caseIndex >= 0 ? caseIndex : targets.Length - 1;
+    }
+
+    /// <summary>
+    /// Resolve an object variable name operand to a slot in the current object.
+    /// The slots are re-fetched if the object's layout changed under us (hot
+    /// reload of the running object). Unknown names raise the usual error.
+    /// </summary>
+    private static int GlobalSlot(VmThread vm, CompiledFunction fn, int nameIndex, ref VariableLayout layout, ref int[] slots)
+    {
+        if (!ReferenceEquals(vm.CurrentObject.VariableLayout, layout))
+        {
+            layout = vm.CurrentObject.VariableLayout;
+            slots = fn.GetVariableSlots(layout);
+        }
+
+        int slot = slots[nameIndex];
+        if (slot < 0)
+        {
+            throw new InvalidOperationException($"Variable '{fn.Names[nameIndex]}' not found in object {vm.CurrentObject.ObjectName}");
+        }
+        return slot;
+    }
+
+    /// <summary>
+    /// The call_other efun through an inline cache, with the efun error handling
+    /// CallNamedFunction would apply.
+    /// </summary>
+    private object CallOtherCached(List<object> args, CallSiteCache site, int line)
+    {
+        try
+        {
+            return CallOther(args, site);
+        }
+        catch (EfunException ex)
+        {
+            throw RuntimeError(ex.Message, line);
+        }
+    }
+
+    /// <summary>
+    /// Pop the top count stack values into an argument list (first argument deepest).
+    /// </summary>
+    private static List<object> PopArguments(LpcValue[] stack, ref int sp, int count)
+    {
+        var args = new List<object>(count);
+        int first = sp - count;
+        for (int i = first; i < sp; i++)
+        {
+            args.Add(stack[i].ToObject()!);
+            stack[i] = default;
+        }
+        sp = first;
+        return args;
+    }
+
+    /// <summary>
+    /// Fold stack[first..end) with + from the left, as nested Binary adds
+    /// would. Once the running value is a string every later + is an append,
+    /// so the rest go into the thread's builder and one string comes out.
+    /// </summary>
+    private LpcValue ConcatValues(VmThread vm, LpcValue[] stack, int first, int end)
+    {
+        var acc = stack[first];
+        int i = first + 1;
+        for (; i < end && acc.Kind != LpcValueKind.String; i++)
+        {
+            var right = stack[i];
+            acc = acc.IsInt && right.IsInt && TryIntBinary(BinaryOperator.Add, acc.Int, right.Int, out var sum)
+                ? sum
+                : LpcValue.FromObject(BinaryOpValues(BinaryOperator.Add, acc.ToObject(), right.ToObject()));
+        }
+        if (i == end) return acc;
+
+        var sb = vm.Builder.Clear();
+        sb.Append((string)acc.Ref!);
+        for (; i < end; i++)
+        {
+            var part = stack[i];
+            if (part.IsInt) sb.Append(part.Int);
+            else sb.Append(ToStr(part.ToObject()));
+        }
+        var text = sb.ToString();
+        vm.TrimBuilder();
+        return LpcValue.FromObject(text);
+    }
+
+    /// <summary>
+    /// Integer fast path for Binary and Compound: the same results as
+    /// BinaryOpValues/CompoundValue give for two ints, without boxing.
+    /// Returns false for division by zero so the shared path raises the error.
+    /// </summary>
+    private static bool TryIntBinary(BinaryOperator op, long l, long r, out LpcValue result)
+    {
+        switch (op)
+        {
+            case BinaryOperator.Add: result = LpcValue.FromInt(l + r); return true;
+            case BinaryOperator.Subtract: result = LpcValue.FromInt(l - r); return true;
+            case BinaryOperator.Multiply: result = LpcValue.FromInt(l * r); return true;
+            case BinaryOperator.Divide when r != 0: result = LpcValue.FromInt(l / r); return true;
+            case BinaryOperator.Modulo when r != 0: result = LpcValue.FromInt(l % r); return true;
+            case BinaryOperator.Less: result = LpcValue.FromBool(l < r); return true;
+            case BinaryOperator.LessEqual: result = LpcValue.FromBool(l <= r); return true;
+            case BinaryOperator.Greater: result = LpcValue.FromBool(l > r); return true;
+            case BinaryOperator.GreaterEqual: result = LpcValue.FromBool(l >= r); return true;
+            case BinaryOperator.Equal: result = LpcValue.FromBool(l == r); return true;
+            case BinaryOperator.NotEqual: result = LpcValue.FromBool(l != r); return true;
+            case BinaryOperator.BitwiseAnd: result = LpcValue.FromInt(l & r); return true;
+            case BinaryOperator.BitwiseOr: result = LpcValue.FromInt(l | r); return true;
+            case BinaryOperator.BitwiseXor: result = LpcValue.FromInt(l ^ r); return true;
+            case BinaryOperator.LeftShift: result = LpcValue.FromInt(l << (int)r); return true;
+            case BinaryOperator.RightShift: result = LpcValue.FromInt(l >> (int)r); return true;
+            default: result = default; return false;
+        }
+    }
+
+    /// <summary>
+    /// An int-specialized operator whose operands weren't both ints after all:
+    /// the generic operator, or the op= rules for a compound assignment.
+    /// </summary>
+    private LpcValue IntOpFallback(int op, int compound, LpcValue left, LpcValue right)
+    {
+        return LpcValue.FromObject(compound != 0
+            ? CompoundValue((BinaryOperator)op, left.ToObject(), right.ToObject())
+            : BinaryOpValues((BinaryOperator)op, left.ToObject(), right.ToObject()));
+    }
+
+    /// <summary>
+    /// ToInt for a VM value: ints directly, numeric strings parsed, anything else 0.
+    /// </summary>
+    private static long ToInt(LpcValue value)
+    {
+        return value.Kind switch
+        {
+            LpcValueKind.Int => value.Int,
+            LpcValueKind.String => long.TryParse((string)value.Ref!, out var result) ? result : 0,
+            _ => 0
+        };
+    }
+
+    private static bool IsIncrement(UnaryOperator op)
+    {
+        return op is UnaryOperator.PreIncrement or UnaryOperator.PostIncrement;
+    }
+
+    private static bool IsPrefix(UnaryOperator op)
+    {
+        return op is UnaryOperator.PreIncrement or UnaryOperator.PreDecrement;
+    }
+}
@@ -7,94 +7,63 @@ namespace Driver;
 /// This is the authentic LPMud execution model where all code runs within an object.
 /// Variables and functions are accessed from the object's state and program.
 /// </summary>
-public class ObjectInterpreter
+public partial class ObjectInterpreter
 {
     private readonly EfunRegistry _efuns;
     private readonly ObjectManager _objectManager;
 
     /// <summary>
-    /// The current object whose code is being executed.
-    /// This is the "this_object()" context.
+    /// Per-thread execution state (see VmThread). Each thread that runs LPC
+    /// on this interpreter gets its own, so calls on different threads can be
+    /// in flight at once.
     /// </summary>
-    private MudObject _currentObject;
+    private readonly ThreadLocal<VmThread?> _vmThreads = new();
 
     /// <summary>
-    /// Call stack for tracking function calls across objects.
-    /// Top of stack is the most recent caller.
-    /// Used for previous_object() efun.
+    /// The calling thread's execution state, rented from the pool on first use.
     /// </summary>
-    private readonly Stack<MudObject> _callStack = new();
+    private VmThread Vm => _vmThreads.Value ??= VmThread.Rent();
 
     /// <summary>
-    /// Local variable scopes for function parameters and local variables.
-    /// Stack of dictionaries - one per function call depth.
-    /// Top of stack is the current function's local scope.
+    /// Give the calling thread's execution state back to the pool. For
+    /// threads that are done running LPC on this interpreter; the next call
+    /// on the thread rents a fresh one.
     /// </summary>
-    private readonly Stack<Dictionary<string, object?>> _localScopes = new();
+    public void ReleaseThread()
+    {
+        var vm = _vmThreads.Value;
+        if (vm == null) return;
 
-    /// <summary>
-    /// Stack tracking which program each executing function belongs to.
-    /// Used for correct :: (parent call) behavior in inheritance chains.
-    /// When function A from program X calls ::foo(), we need to search
-    /// from X's inheritance chain, not from _currentObject's program.
-    /// </summary>
-    private readonly Stack<LpcProgram> _executingPrograms = new();
+        _vmThreads.Value = null;
+        VmThread.Return(vm);
+    }
 
     #region Error Tracking
 
-    /// <summary>
-    /// Current file being executed (for error messages).
-    /// </summary>
-    private string _currentFile = "";
-
-    /// <summary>
-    /// Current line being executed (for error messages).
-    /// </summary>
-    private int _currentLine;
-
-    /// <summary>
-    /// Stack of (file, function) for building stack traces.
-    /// </summary>
-    private readonly Stack<(string File, string Function, int Line)> _traceStack = new();
-
-    /// <summary>
-    /// Create an error with file/line context.
-    /// </summary>
-    private LpcRuntimeException RuntimeError(string message)
-    {
-        return new LpcRuntimeException(message, _currentFile, _currentLine, BuildStackTrace());
-    }
-
     /// <summary>
     /// Create an error with file/line context from an expression.
     /// </summary>
     private LpcRuntimeException RuntimeError(string message, Expression expr)
     {
-        return new LpcRuntimeException(message, _currentFile, expr.Line, BuildStackTrace());
+        return RuntimeError(message, expr.Line);
     }
 
     /// <summary>
-    /// Create an error with file/line context from a statement.
+    /// Create an error with file/line context from an explicit line (used by the VM).
     /// </summary>
-    private LpcRuntimeException RuntimeError(string message, Statement stmt)
+    private LpcRuntimeException RuntimeError(string message, int line)
     {
-        return new LpcRuntimeException(message, _currentFile, stmt.Line, BuildStackTrace());
+        var (file, sourceLine) = Vm.Locate(line);
+        var frames = Vm.Frames;
+        return new LpcRuntimeException(message, file, sourceLine, frames.Count == 0 ? null : frames.ToArray());
     }
 
     /// <summary>
-    /// Build a stack trace string from the trace stack.
+    /// Create an error with file/line context from a statement.
     /// </summary>
-    private string BuildStackTrace()
+    private LpcRuntimeException RuntimeError(string message, Statement stmt)
     {
-        if (_traceStack.Count == 0) return "";
-
-        var sb = new StringBuilder();
-        sb.AppendLine("Stack trace:");
-        foreach (var (file, func, line) in _traceStack.Reverse())
-        {
-            sb.AppendLine($"  {file}:{line} in {func}()");
-        }
-        return sb.ToString();
+        return RuntimeError(message, stmt.Line);
     }
 
     #endregion
@@ -102,10 +71,15 @@ public class ObjectInterpreter
     #region Execution Limits
 
     /// <summary>
-    /// Current instruction count for this execution context.
-    /// Reset at the start of each top-level command execution.
+    /// Per-function call profiler (off until enabled).
     /// </summary>
-    private int _instructionCount;
+    public FunctionProfiler Profiler { get; } = new();
+
+    /// <summary>
+    /// Set on region worker interpreters: keeps their calls inside their
+    /// region and serializes the ones that leave it (see RegionWorkers).
+    /// </summary>
+    internal RegionGuard? RegionGuard { get; set; }
 
     /// <summary>
     /// Maximum instructions allowed per execution context.
@@ -127,40 +101,63 @@ public class ObjectInterpreter
     /// </summary>
     public bool LimitsEnabled { get; set; } = true;
 
+    /// <summary>
+    /// LPC instructions the calling thread has executed, ever. The game loop
+    /// reads it before and after work it wants to measure.
+    /// </summary>
+    public long ThreadInstructions => Vm.InstructionsExecuted;
+
+    /// <summary>
+    /// Where the calling thread notes the LPC calls it makes, while the game
+    /// loop traces a command; null for none.
+    /// </summary>
+    public CallTrace? ThreadCallTrace
+    {
+        get => Vm.CallTrace;
+        set => Vm.CallTrace = value;
+    }
+
     /// <summary>
     /// Reset the instruction counter. Called at the start of each command execution.
     /// </summary>
     public void ResetInstructionCount()
     {
-        _instructionCount = 0;
+        var vm = Vm;
+        vm.PublishInstructions();
+        vm.InstructionCount = 0;
     }
 
     /// <summary>
-    /// Increment the instruction counter and check limits.
-    /// Called for each statement and expression evaluation.
+    /// Add count instructions to the counter and check the limit; line is
+    /// reported if it's exceeded. Nothing is counted per expression or
+    /// statement: the VM charges each straight-line block when control leaves
+    /// it, the tree walker charges one per call and per loop iteration.
     /// </summary>
-    private void CountInstruction()
+    private void ChargeInstructions(VmThread vm, int count, int line)
     {
+        vm.InstructionsExecuted += count;
         if (!LimitsEnabled) return;
 
-        _instructionCount++;
-        if (_instructionCount > MaxInstructions)
+        vm.InstructionCount += count;
+        if (vm.InstructionCount > MaxInstructions)
         {
+            var (file, sourceLine) = vm.Locate(line);
             throw new ExecutionLimitException(
                 $"Execution limit exceeded: {MaxInstructions} instructions. " +
                 "This usually indicates an infinite loop.",
-                _currentFile, _currentLine);
+                file, sourceLine);
         }
     }
 
     /// <summary>
     /// Check recursion depth limit.
     /// </summary>
-    private void CheckRecursionDepth()
+    private void CheckRecursionDepth(VmThread vm)
     {
         if (!LimitsEnabled) return;
 
-        if (_localScopes.Count > MaxRecursionDepth)
+        // One frame is pushed per function call, compiled or not
+        if (vm.Frames.Count > MaxRecursionDepth)
         {
             throw new ExecutionLimitException(
                 $"Recursion limit exceeded: {MaxRecursionDepth} levels. " +
@@ -202,8 +199,7 @@ public class ObjectInterpreter
             return AccessLevel.Admin;
         }
 
-        var session = gameLoop.GetAllSessions()
-            .FirstOrDefault(s => s.PlayerObject == context.PlayerObject);
+        var session = GameLoop.FindSessionByPlayerObject(context.PlayerObject);
 
         return session?.AccessLevel ?? AccessLevel.Guest;
     }
@@ -226,8 +222,7 @@ public class ObjectInterpreter
             return null;
         }
 
-        var session = gameLoop.GetAllSessions()
-            .FirstOrDefault(s => s.PlayerObject == context.PlayerObject);
+        var session = GameLoop.FindSessionByPlayerObject(context.PlayerObject);
 
         return session?.AuthenticatedUsername;
     }
@@ -281,6 +276,9 @@ public class ObjectInterpreter
     /// <returns>True if access is allowed</returns>
     private bool CanAccessPath(string mudlibPath, bool isWrite)
     {
+        // Normalized once here; the checks below then find nothing to change
+        mudlibPath = mudlibPath.TrimStart('/').ToLowerInvariant();
+
         var accessLevel = GetCurrentAccessLevel();
         var username = GetCurrentUsername();
 
@@ -354,7 +352,6 @@ public class ObjectInterpreter
     {
         _objectManager = objectManager;
         _efuns = new EfunRegistry(output);
-        _currentObject = null!; // Will be set before execution
 
         // Register object-specific efuns
         RegisterObjectEfuns();
@@ -371,8 +368,25 @@ public class ObjectInterpreter
         _efuns.Register("find_object", FindObjectEfun);
         _efuns.Register("destruct", DestructEfun);
         _efuns.Register("call_other", CallOtherEfun);
+        _efuns.Register("call_other_many", CallOtherManyEfun);
+        _efuns.Register("call_other_async", CallOtherAsyncEfun);
+        _efuns.Register("map_call", MapCallEfun);
         _efuns.Register("move_object", MoveObjectEfun);
         _efuns.Register("present", PresentEfun);
+        _efuns.Register("set_ids", SetIdsEfun);
+
+        // Room exit efuns
+        _efuns.Register("set_exit", SetExitEfun);
+        _efuns.Register("exit_path", ExitPathEfun);
+        _efuns.Register("exit_destination", ExitDestinationEfun);
+        _efuns.Register("exit_is_hidden", ExitIsHiddenEfun);
+        _efuns.Register("exit_dirs", ExitDirsEfun);
+        _efuns.Register("find_path", FindPathEfun);
+        _efuns.Register("rooms_within", RoomsWithinEfun);
+        _efuns.Register("room_render", RoomRenderEfun);
+        _efuns.Register("set_room_render", SetRoomRenderEfun);
+        _efuns.Register("description_changed", DescriptionChangedEfun);
+        _efuns.Register("tell_room_tmpl", TellRoomTmplEfun);
 
         // Object metadata efuns
         _efuns.Register("object_name", ObjectNameEfun);
@@ -392,30 +406,81 @@ public class ObjectInterpreter
         _efuns.Register("interactive", InteractiveEfun);
         _efuns.Register("find_living", FindLivingEfun);
         _efuns.Register("find_player", FindPlayerEfun);
+        _efuns.Register("match_living", MatchLivingEfun);
+        _efuns.Register("resolve_living", ResolveLivingEfun);
         _efuns.Register("users", UsersEfun);
+        _efuns.Register("cluster_users", ClusterUsersEfun);
+
+        // Combat relationships
+        _efuns.Register("set_attacking", SetAttackingEfun);
+        _efuns.Register("query_attacking", QueryAttackingEfun);
+        _efuns.Register("query_attackers", QueryAttackersEfun);
+        _efuns.Register("hostile_in_room", HostileInRoomEfun);
         _efuns.Register("linkdead_users", LinkdeadUsersEfun);
+        _efuns.Register("query_lag", QueryLagEfun);
+        _efuns.Register("channel_subscribe", ChannelSubscribeEfun);
+        _efuns.Register("channel_unsubscribe", ChannelUnsubscribeEfun);
+        _efuns.Register("channel_subscribers", ChannelSubscribersEfun);
+        _efuns.Register("channel_publish", ChannelPublishEfun);
+        _efuns.Register("channel_remove", ChannelRemoveEfun);
+        _efuns.Register("history_open", HistoryOpenEfun);
+        _efuns.Register("history_add", HistoryAddEfun);
+        _efuns.Register("history_get", HistoryGetEfun);
         _efuns.Register("query_linkdead", QueryLinkdeadEfun);
 
         // Heartbeat efuns
         _efuns.Register("set_heart_beat", SetHeartBeatEfun);
         _efuns.Register("query_heart_beat", QueryHeartBeatEfun);
+        _efuns.Register("query_dormant_elapsed", QueryDormantElapsedEfun);
 
         // Reset efuns
         _efuns.Register("set_reset", SetResetEfun);
         _efuns.Register("query_reset", QueryResetEfun);
+        _efuns.Register("set_spawn", SetSpawnEfun);
+        _efuns.Register("respawn", RespawnEfun);
+        _efuns.Register("query_spawned", QuerySpawnedEfun);
 
         // Callout efuns
         _efuns.Register("call_out", CallOutEfun);
         _efuns.Register("remove_call_out", RemoveCallOutEfun);
         _efuns.Register("find_call_out", FindCallOutEfun);
 
+        // Coroutine efuns
+        _efuns.Register("start_coroutine", StartCoroutineEfun);
+        _efuns.Register("stop_coroutine", StopCoroutineEfun);
+        _efuns.Register("yield", YieldEfun);
+        _efuns.Register("sleep", SleepEfun);
+
+        // Event efuns
+        _efuns.Register("subscribe", SubscribeEfun);
+        _efuns.Register("unsubscribe", UnsubscribeEfun);
+        _efuns.Register("emit", EmitEfun);
+        _efuns.Register("query_subscriptions", QuerySubscriptionsEfun);
+
+        // Effect efuns
+        _efuns.Register("add_effect", AddEffectEfun);
+        _efuns.Register("remove_effect", RemoveEffectEfun);
+        _efuns.Register("query_effect", QueryEffectEfun);
+        _efuns.Register("query_effects", QueryEffectsEfun);
+
+        // Skill efuns
+        _efuns.Register("query_skill_level", QuerySkillLevelEfun);
+        _efuns.Register("set_skill_level", SetSkillLevelEfun);
+        _efuns.Register("query_skill_allowed", QuerySkillAllowedEfun);
+        _efuns.Register("set_skill_allowed", SetSkillAllowedEfun);
+        _efuns.Register("query_skill_levels", QuerySkillLevelsEfun);
+        _efuns.Register("query_skills_allowed", QuerySkillsAllowedEfun);
+
         // Array callback efuns (need interpreter access)
         _efuns.Register("filter_array", FilterArrayEfun);
         _efuns.Register("map_array", MapArrayEfun);
+        _efuns.Register("sort_array", SortArrayEfun);
 
         // File I/O efuns
         _efuns.Register("read_file", ReadFileEfun);
         _efuns.Register("write_file", WriteFileEfun);
+        _efuns.Register("write_file_async", WriteFileAsyncEfun);
+        _efuns.Register("read_file_async", ReadFileAsyncEfun);
         _efuns.Register("file_size", FileSizeEfun);
         _efuns.Register("file_time", FileTimeEfun);
         _efuns.Register("rm", RmEfun);
@@ -424,6 +489,15 @@ public class ObjectInterpreter
         _efuns.Register("rename", RenameEfun);
         _efuns.Register("get_dir", GetDirEfun);
 
+        // Network efuns
+        _efuns.Register("http_request", HttpRequestEfun);
+        _efuns.Register("tcp_request", TcpRequestEfun);
+
+        // Help index efuns
+        _efuns.Register("help_lookup", HelpLookupEfun);
+        _efuns.Register("help_topics", HelpTopicsEfun);
+        _efuns.Register("help_search", HelpSearchEfun);
+
         // Object persistence efuns
         _efuns.Register("save_object", SaveObjectEfun);
         _efuns.Register("restore_object", RestoreObjectEfun);
@@ -431,6 +505,7 @@ public class ObjectInterpreter
         // Hot-reload efuns
         _efuns.Register("update", UpdateEfun);
         _efuns.Register("inherits", InheritsEfun);
+        _efuns.Register("perf_warnings", PerfWarningsEfun);
         _efuns.Register("reload_changed", ReloadChangedEfun);
 
         // Input handling efuns
@@ -455,6 +530,20 @@ public class ObjectInterpreter
 
         // Server control efuns (Admin only)
         _efuns.Register("shutdown", ShutdownEfun);
+        _efuns.Register("copyover", CopyoverEfun);
+        _efuns.Register("tick_stats", TickStatsEfun);
+        _efuns.Register("object_census", ObjectCensusEfun);
+        _efuns.Register("cpu_stats", CpuStatsEfun);
+        _efuns.Register("profile_enable", ProfileEnableEfun);
+        _efuns.Register("profile_clear", ProfileClearEfun);
+        _efuns.Register("profile_stats", ProfileStatsEfun);
+        _efuns.Register("profile_folded", ProfileFoldedEfun);
+        _efuns.Register("jit_enable", JitEnableEfun);
+        _efuns.Register("bench", BenchEfun);
+        _efuns.Register("snoop", SnoopEfun);
+        _efuns.Register("unsnoop", UnsnoopEfun);
+        _efuns.Register("query_snoop", QuerySnoopEfun);
+        _efuns.Register("query_snooping", QuerySnoopingEfun);
 
         // Error handling efuns
         _efuns.Register("throw", ThrowEfun);
@@ -491,16 +580,21 @@ public class ObjectInterpreter
     /// </summary>
     public object? ExecuteInObject(MudObject obj, Statement stmt)
     {
-        var previousObject = _currentObject;
-        _currentObject = obj;
+        var previousObject = Vm.CurrentObject;
+        Vm.CurrentObject = obj;
 
         try
         {
-            return Execute(stmt);
+            var completion = Execute(stmt);
+            if (completion.Kind is CompletionKind.Break or CompletionKind.Continue)
+            {
+                throw StrayLoopControl(completion.Kind, stmt.Line);
+            }
+            return completion.Value;
         }
         finally
         {
-            _currentObject = previousObject;
+            Vm.CurrentObject = previousObject;
         }
     }
 
@@ -509,8 +603,8 @@ public class ObjectInterpreter
     /// </summary>
     public object EvaluateInObject(MudObject obj, Expression expr)
     {
-        var previousObject = _currentObject;
-        _currentObject = obj;
+        var previousObject = Vm.CurrentObject;
+        Vm.CurrentObject = obj;
 
         try
         {
@@ -518,7 +612,7 @@ public class ObjectInterpreter
         }
         finally
         {
-            _currentObject = previousObject;
+            Vm.CurrentObject = previousObject;
         }
     }
 
@@ -529,38 +623,42 @@ public class ObjectInterpreter
     /// </summary>
     public object? CallFunctionOnObject(MudObject target, string functionName, List<object> args)
     {
-        return CallFunctionOnObjectInternal(target, functionName, args, checkShadow: true);
+        // The shadow, if any, gets first chance
+        if (!target.TryResolveCall(functionName, out target, out var entry))
+        {
+            throw new ObjectInterpreterException($"Function '{functionName}' not found in object {target.ObjectName}");
+        }
+
+        return InvokeOnObject(target, entry.Function, entry.OwningProgram, args);
     }
 
     /// <summary>
-    /// Call a function on an object, optionally bypassing shadow check.
-    /// Used internally to prevent infinite recursion when shadows call through to original.
+    /// Run an already-resolved function with target as this_object().
     /// </summary>
-    private object? CallFunctionOnObjectInternal(MudObject target, string functionName, List<object> args, bool checkShadow)
+    private object? InvokeOnObject(MudObject target, FunctionDefinition func, LpcProgram? owningProgram, List<object> args)
     {
-        // Check for shadow first (unless bypassed)
-        if (checkShadow && target.ShadowedBy != null)
+        var vm = Vm;
+        vm.Sandbox?.CheckCall(target);
+
+        var guard = RegionGuard;
+        if (guard != null && !guard.IsExclusive && !guard.IsLocal(target))
         {
-            var shadow = target.ShadowedBy;
-            var shadowFunc = shadow.Program.FindFunction(functionName);
-            if (shadowFunc != null)
+            // Cross-region call: run alone, and share no arrays or mappings
+            var copied = args.Select(EfunRegistry.DeepCopy).ToList();
+            return guard.RunExclusive(() =>
             {
-                // Shadow has this function - call it instead
-                return CallFunctionOnObjectInternal(shadow, functionName, args, checkShadow: false);
-            }
+                var result = InvokeOnObject(target, func, owningProgram, copied);
+                return result == null ? null : EfunRegistry.DeepCopy(result);
+            }, CallStackIsLocal);
         }
 
-        var (func, owningProgram) = target.Program.FindFunctionWithProgram(functionName);
-        if (func == null)
-        {
-            throw new ObjectInterpreterException($"Function '{functionName}' not found in object {target.ObjectName}");
-        }
+        target.LastReferenced = Environment.TickCount64;
 
         // Push caller onto stack
-        _callStack.Push(_currentObject);
+        vm.CallStack.Push(vm.CurrentObject);
 
-        var previousObject = _currentObject;
-        _currentObject = target;
+        var previousObject = vm.CurrentObject;
+        vm.CurrentObject = target;
 
         try
         {
@@ -568,9 +666,66 @@ public class ObjectInterpreter
         }
         finally
         {
-            _currentObject = previousObject;
-            _callStack.Pop();
+            vm.CurrentObject = previousObject;
+            vm.CallStack.Pop();
+        }
+    }
+
+    /// <summary>
+    /// Call a function on target in a heart_beat sandbox on the calling
+    /// thread. Any error abandons the speculation (see HeartbeatSandbox.End).
+    /// </summary>
+    public void CallInSandbox(HeartbeatSandbox sandbox, MudObject target, string functionName)
+    {
+        var vm = Vm;
+        vm.PublishInstructions();
+        vm.InstructionCount = 0;
+        vm.Sandbox = sandbox;
+        try
+        {
+            CallFunctionOnObject(target, functionName, new List<object>());
+        }
+        catch (Exception ex)
+        {
+            sandbox.Abort(ex.Message);
+        }
+        finally
+        {
+            vm.Sandbox = null;
+        }
+    }
+
+    /// <summary>
+    /// Run efun with obj as the current object, as if obj's code had called
+    /// it. For effects a sandboxed heartbeat recorded.
+    /// </summary>
+    internal object CallEfunAs(MudObject obj, Func<List<object>, object> efun, List<object> args)
+    {
+        var vm = Vm;
+        var previousObject = vm.CurrentObject;
+        vm.CurrentObject = obj;
+        try
+        {
+            return efun(args);
+        }
+        finally
+        {
+            vm.CurrentObject = previousObject;
+        }
+    }
+
+    /// <summary>
+    /// Whether every object on the call stack is in this worker's region.
+    /// </summary>
+    private bool CallStackIsLocal()
+    {
+        var guard = RegionGuard!;
+        if (Vm.CurrentObject != null && !guard.IsLocal(Vm.CurrentObject)) return false;
+        foreach (var obj in Vm.CallStack)
+        {
+            if (obj != null && !guard.IsLocal(obj)) return false;
         }
+        return true;
     }
 
     /// <summary>
@@ -585,8 +740,8 @@ public class ObjectInterpreter
             return null; // Function doesn't exist, which is okay
         }
 
-        var previousObject = _currentObject;
-        _currentObject = target;
+        var previousObject = Vm.CurrentObject;
+        Vm.CurrentObject = target;
 
         try
         {
@@ -594,38 +749,37 @@ public class ObjectInterpreter
         }
         finally
         {
-            _currentObject = previousObject;
+            Vm.CurrentObject = previousObject;
         }
     }
 
     #region Statement Execution
 
-    private object? Execute(Statement stmt)
+    /// <summary>
+    /// Execute a statement. Return, break and continue come back as the
+    /// completion kind rather than exceptions; compound statements stop and
+    /// pass an abrupt completion up until a loop or the function call handles it.
+    /// </summary>
+    private Completion Execute(Statement stmt)
     {
-        // Track current line for error messages
-        _currentLine = stmt.Line;
-
-        // Count each statement execution for limit checking
-        CountInstruction();
-
         return stmt switch
         {
             BlockStatement block => ExecuteBlock(block),
-            ExpressionStatement exprStmt => Evaluate(exprStmt.Expression),
+            ExpressionStatement exprStmt => Completion.Normal(Evaluate(exprStmt.Expression)),
             IfStatement ifStmt => ExecuteIf(ifStmt),
             WhileStatement whileStmt => ExecuteWhile(whileStmt),
             ForStatement forStmt => ExecuteFor(forStmt),
             ForEachStatement foreachStmt => ExecuteForeach(foreachStmt),
             SwitchStatement switchStmt => ExecuteSwitch(switchStmt),
             ReturnStatement ret => ExecuteReturn(ret),
-            BreakStatement => throw new BreakException(),
-            ContinueStatement => throw new ContinueException(),
+            BreakStatement => Completion.Break,
+            ContinueStatement => Completion.Continue,
             VariableDeclaration varDecl => ExecuteVariableDeclaration(varDecl),
             _ => throw RuntimeError($"Unknown statement type: {stmt.GetType().Name}", stmt)
         };
     }
 
-    private object? ExecuteVariableDeclaration(VariableDeclaration varDecl)
+    private Completion ExecuteVariableDeclaration(VariableDeclaration varDecl)
     {
         // Determine initial value
         object? initialValue = varDecl.Initializer != null
@@ -633,17 +787,17 @@ public class ObjectInterpreter
             : GetDefaultValue(varDecl.Type);
 
         // If we're inside a function (local scope exists), add to local scope
-        if (_localScopes.Count > 0)
+        if (Vm.LocalScopes.Count > 0)
         {
-            _localScopes.Peek()[varDecl.Name] = initialValue;
+            Vm.LocalScopes.Peek()[varDecl.Name] = initialValue;
         }
         else
         {
             // Top-level: set on object (existing behavior for object variables)
-            _currentObject.SetVariable(varDecl.Name, initialValue);
+            Vm.CurrentObject.SetVariable(varDecl.Name, initialValue);
         }
 
-        return null;
+        return Completion.Normal(null);
     }
 
     /// <summary>
@@ -659,17 +813,19 @@ public class ObjectInterpreter
         };
     }
 
-    private object? ExecuteBlock(BlockStatement block)
+    private Completion ExecuteBlock(BlockStatement block)
     {
         object? lastValue = null;
         foreach (var stmt in block.Statements)
         {
-            lastValue = Execute(stmt);
+            var completion = Execute(stmt);
+            if (completion.IsAbrupt) return completion;
+            lastValue = completion.Value;
         }
-        return lastValue;
+        return Completion.Normal(lastValue);
     }
 
-    private object? ExecuteIf(IfStatement stmt)
+    private Completion ExecuteIf(IfStatement stmt)
     {
         var condition = Evaluate(stmt.Condition);
 
@@ -682,33 +838,27 @@ public class ObjectInterpreter
             return Execute(stmt.ElseBranch);
         }
 
-        return null;
+        return Completion.Normal(null);
     }
 
-    private object? ExecuteWhile(WhileStatement stmt)
+    private Completion ExecuteWhile(WhileStatement stmt)
     {
         object? lastValue = null;
+        var vm = Vm;
 
         while (IsTrue(Evaluate(stmt.Condition)))
         {
-            try
-            {
-                lastValue = Execute(stmt.Body);
-            }
-            catch (BreakException)
-            {
-                break;
-            }
-            catch (ContinueException)
-            {
-                continue;
-            }
+            ChargeInstructions(vm, 1, stmt.Line);
+            var completion = Execute(stmt.Body);
+            if (completion.Kind == CompletionKind.Break) break;
+            if (completion.Kind == CompletionKind.Return) return completion;
+            lastValue = completion.Value;
         }
 
-        return lastValue;
+        return Completion.Normal(lastValue);
     }
 
-    private object? ExecuteFor(ForStatement stmt)
+    private Completion ExecuteFor(ForStatement stmt)
     {
         object? lastValue = null;
 
@@ -719,20 +869,16 @@ public class ObjectInterpreter
         }
 
         // Loop
+        var vm = Vm;
         while (stmt.Condition == null || IsTrue(Evaluate(stmt.Condition)))
         {
-            try
-            {
-                lastValue = Execute(stmt.Body);
-            }
-            catch (BreakException)
-            {
-                break;
-            }
-            catch (ContinueException)
-            {
-                // Fall through to increment
-            }
+            ChargeInstructions(vm, 1, stmt.Line);
+
+            // Continue falls through to the increment
+            var completion = Execute(stmt.Body);
+            if (completion.Kind == CompletionKind.Break) break;
+            if (completion.Kind == CompletionKind.Return) return completion;
+            lastValue = completion.Value;
 
             // Increment
             if (stmt.Increment != null)
@@ -741,17 +887,43 @@ public class ObjectInterpreter
             }
         }
 
-        return lastValue;
+        return Completion.Normal(lastValue);
     }
 
-    private object? ExecuteSwitch(SwitchStatement stmt)
+    private Completion ExecuteSwitch(SwitchStatement stmt)
     {
         var switchValue = Evaluate(stmt.Value);
+        int start = stmt.GetTable()?.Lookup(switchValue) ?? MatchCase(stmt, switchValue);
+
         object? lastValue = null;
-        bool matched = false;
-        int defaultIndex = -1;
+        if (start < 0)
+        {
+            return Completion.Normal(lastValue);
+        }
+
+        // Execute from the matched case to the end (fall-through behavior)
+        for (int i = start; i < stmt.Cases.Count; i++)
+        {
+            foreach (var statement in stmt.Cases[i].Statements)
+            {
+                var completion = Execute(statement);
+                // Break exits the switch; continue and return belong to an outer construct
+                if (completion.Kind == CompletionKind.Break) return Completion.Normal(lastValue);
+                if (completion.IsAbrupt) return completion;
+                lastValue = completion.Value;
+            }
+        }
+
+        return Completion.Normal(lastValue);
+    }
 
-        // First, find if there's a matching case or a default
+    /// <summary>
+    /// Find the case to start at by evaluating labels in order (for switches
+    /// whose labels aren't all literals): the first match, else default, else -1.
+    /// </summary>
+    private int MatchCase(SwitchStatement stmt, object? switchValue)
+    {
+        int defaultIndex = -1;
         for (int i = 0; i < stmt.Cases.Count; i++)
         {
             var switchCase = stmt.Cases[i];
@@ -761,148 +933,117 @@ public class ObjectInterpreter
                 // This is the default case, remember its position
                 defaultIndex = i;
             }
-            else if (!matched)
-            {
-                var caseValue = Evaluate(switchCase.Value);
-                if (ValuesEqual(switchValue, caseValue))
-                {
-                    matched = true;
-                }
-            }
-
-            // If we've matched, execute this case's statements (fall-through behavior)
-            if (matched)
-            {
-                try
-                {
-                    foreach (var statement in switchCase.Statements)
-                    {
-                        lastValue = Execute(statement);
-                    }
-                }
-                catch (BreakException)
-                {
-                    // Break exits the switch
-                    return lastValue;
-                }
-            }
-        }
-
-        // If no case matched but there's a default, execute from default onwards
-        if (!matched && defaultIndex >= 0)
-        {
-            for (int i = defaultIndex; i < stmt.Cases.Count; i++)
+            else if (ValuesEqual(switchValue, Evaluate(switchCase.Value)))
             {
-                var switchCase = stmt.Cases[i];
-                try
-                {
-                    foreach (var statement in switchCase.Statements)
-                    {
-                        lastValue = Execute(statement);
-                    }
-                }
-                catch (BreakException)
-                {
-                    return lastValue;
-                }
+                return i;
             }
         }
-
-        return lastValue;
+        return defaultIndex;
     }
 
     /// <summary>
     /// Compare two values for equality (used in switch).
     /// </summary>
-    private static bool ValuesEqual(object? a, object? b)
-    {
-        if (a == null && b == null) return true;
-        if (a == null || b == null) return false;
-        // Handle int/long comparison
-        if ((a is int or long) && (b is int or long))
-        {
-            return Convert.ToInt64(a) == Convert.ToInt64(b);
-        }
-        if (a is string sa && b is string sb) return sa == sb;
-        return a.Equals(b);
-    }
+    private static bool ValuesEqual(object? a, object? b) => LpcValueComparer.Instance.Equals(a, b);
 
-    private object? ExecuteForeach(ForEachStatement stmt)
+    private Completion ExecuteForeach(ForEachStatement stmt)
     {
-        var collection = Evaluate(stmt.Collection);
         object? lastValue = null;
-
-        // Get items to iterate over
-        IEnumerable<object?> items;
-        if (collection is List<object> list)
-        {
-            items = list;
-        }
-        else if (collection is Dictionary<object, object> mapping)
-        {
-            // Iterate over keys for mappings
-            items = mapping.Keys;
-        }
-        else if (collection is string str)
-        {
-            // Iterate over characters for strings
-            items = str.Select(c => (object?)c.ToString());
-        }
-        else
-        {
-            throw new ObjectInterpreterException($"Cannot iterate over type: {collection?.GetType().Name ?? "null"}");
-        }
+        var cursor = stmt.ValueVariable != null
+            ? ForeachCursor.Over(Evaluate(stmt.Collection), pairs: true)
+            : ForeachCursorFor(stmt.Collection);
 
         // Create a local scope for the loop variable if needed
         bool createdScope = false;
-        if (_localScopes.Count == 0)
+        if (Vm.LocalScopes.Count == 0)
         {
-            _localScopes.Push(new Dictionary<string, object?>());
+            Vm.LocalScopes.Push(new Dictionary<string, object?>());
             createdScope = true;
         }
 
         try
         {
-            var currentScope = _localScopes.Peek();
-            foreach (var item in items)
+            var vm = Vm;
+            var currentScope = vm.LocalScopes.Peek();
+            while (cursor.MoveNext(out var item))
             {
-                // Set the loop variable
+                ChargeInstructions(vm, 1, stmt.Line);
+
+                // Set the loop variables
                 currentScope[stmt.Variable] = item;
+                if (stmt.ValueVariable != null) currentScope[stmt.ValueVariable] = cursor.Value;
 
-                try
-                {
-                    lastValue = Execute(stmt.Body);
-                }
-                catch (BreakException)
-                {
-                    break;
-                }
-                catch (ContinueException)
-                {
-                    continue;
-                }
+                var completion = Execute(stmt.Body);
+                if (completion.Kind == CompletionKind.Break) break;
+                if (completion.Kind == CompletionKind.Return) return completion;
+                lastValue = completion.Value;
             }
         }
         finally
         {
             if (createdScope)
             {
-                _localScopes.Pop();
+                Vm.LocalScopes.Pop();
             }
         }
 
-        return lastValue;
+        return Completion.Normal(lastValue);
+    }
+
+    /// <summary>
+    /// Where foreach starts in its collection. A range is walked in place
+    /// rather than copied out first.
+    /// </summary>
+    private ForeachCursor ForeachCursorFor(Expression collection)
+    {
+        if (collection is RangeExpression range)
+        {
+            var target = Evaluate(range.Target);
+            var start = range.Start != null ? Evaluate(range.Start) : null;
+            var end = range.End != null ? Evaluate(range.End) : null;
+            return ForeachCursor.OverRange(target, start, end);
+        }
+        return ForeachCursor.Over(Evaluate(collection));
     }
 
-    private object? ExecuteReturn(ReturnStatement stmt)
+    private Completion ExecuteReturn(ReturnStatement stmt)
     {
         if (stmt.Value != null)
         {
-            var value = Evaluate(stmt.Value);
-            throw new ReturnException(value);
+            return Completion.Return(Evaluate(stmt.Value));
         }
 
-        throw new ReturnException(0); // LPC returns 0 for void functions
+        return Completion.Return(0); // LPC returns 0 for void functions
+    }
+
+    /// <summary>
+    /// Error for a break or continue that reached a function body without
+    /// meeting a loop (or, for break, a switch).
+    /// </summary>
+    private LpcRuntimeException StrayLoopControl(CompletionKind kind, int line)
+    {
+        var keyword = kind == CompletionKind.Break ? "break" : "continue";
+        return RuntimeError($"'{keyword}' outside of a loop", line);
+    }
+
+    /// <summary>
+    /// Line of the first break or continue in a function body that no loop
+    /// (or, for break, switch) encloses. The tree walker doesn't track lines
+    /// as it runs, so the error's line is looked up here when it happens.
+    /// </summary>
+    private static int? StrayLoopControlLine(Statement stmt, bool inSwitch = false)
+    {
+        return stmt switch
+        {
+            BreakStatement when !inSwitch => stmt.Line,
+            ContinueStatement => stmt.Line,
+            BlockStatement block => block.Statements.Select(s => StrayLoopControlLine(s, inSwitch)).FirstOrDefault(l => l != null),
+            IfStatement ifStmt => StrayLoopControlLine(ifStmt.ThenBranch, inSwitch) ??
+                                  (ifStmt.ElseBranch != null ? StrayLoopControlLine(ifStmt.ElseBranch, inSwitch) : null),
+            SwitchStatement switchStmt => switchStmt.Cases.SelectMany(c => c.Statements)
+                .Select(s => StrayLoopControlLine(s, inSwitch: true)).FirstOrDefault(l => l != null),
+            _ => null
+        };
     }
 
     #endregion
@@ -911,12 +1052,6 @@ public class ObjectInterpreter
 
     private object Evaluate(Expression expr)
     {
-        // Track current line for error messages
-        _currentLine = expr.Line;
-
-        // Count each expression evaluation for limit checking
-        CountInstruction();
-
         return expr switch
         {
             NumberLiteral num => num.Value,
@@ -933,6 +1068,7 @@ public class ObjectInterpreter
             FunctionCall call => EvaluateFunctionCall(call),
             ArrowCall arrow => EvaluateArrowCall(arrow),
             IndexExpression idx => EvaluateIndexExpression(idx),
+            IndexAssignment indexAssign => EvaluateIndexAssignment(indexAssign),
             RangeExpression range => EvaluateRangeExpression(range),
             CatchExpression catchExpr => EvaluateCatch(catchExpr),
             _ => throw RuntimeError($"Unknown expression type: {expr.GetType().Name}", expr)
@@ -941,6 +1077,8 @@ public class ObjectInterpreter
 
     /// <summary>
     /// Evaluate catch(expr) - returns 0 on success, error string on exception.
+    /// .NET try regions cost nothing until something throws, so the success
+    /// path here (and the VM's Catch) is just the body.
     /// </summary>
     private object EvaluateCatch(CatchExpression expr)
     {
@@ -949,51 +1087,37 @@ public class ObjectInterpreter
             Evaluate(expr.Body);
             return 0L; // Success
         }
-        catch (LpcThrowException ex)
-        {
-            // Explicit throw() - return the thrown value as error
-            return ex.ThrownValue is string s ? s : ex.Message;
-        }
-        catch (LpcRuntimeException ex)
-        {
-            // Runtime error - return error message
-            return ex.Message;
-        }
-        catch (EfunException ex)
-        {
-            // Efun error - return error message
-            return ex.Message;
-        }
-        catch (ObjectInterpreterException ex)
-        {
-            // Interpreter error - return error message
-            return ex.Message;
-        }
-        catch (ReturnException)
-        {
-            // return inside catch is allowed
-            throw;
-        }
-        catch (BreakException)
+        catch (Exception ex) when (IsCatchable(ex))
         {
-            // break inside catch is allowed
-            throw;
+            return CatchResult(ex);
         }
-        catch (ContinueException)
-        {
-            // continue inside catch is allowed
-            throw;
-        }
-        catch (ExecutionLimitException)
-        {
-            // Don't catch execution limits - they need to propagate
-            throw;
-        }
-        catch (Exception ex)
+    }
+
+    /// <summary>
+    /// Whether catch() swallows this exception.
+    /// Execution limits must propagate so a catch() can't swallow a runaway loop.
+    /// </summary>
+    private static bool IsCatchable(Exception ex)
+    {
+        return ex is not (ExecutionLimitException or SandboxAbortException or CoroutineStoppedException);
+    }
+
+    /// <summary>
+    /// The value catch() returns for a caught exception.
+    /// </summary>
+    private static object CatchResult(Exception ex)
+    {
+        return ex switch
         {
+            // Explicit throw() - return the thrown value as error
+            LpcThrowException thrown => thrown.ThrownValue is string s ? s : thrown.Message,
+            // Runtime errors - "file:line: message", leaving the stack trace unformatted
+            LpcRuntimeException runtime => runtime.ErrorLine,
+            // Efun and interpreter errors - return error message
+            EfunException or ObjectInterpreterException => ex.Message,
             // Catch-all for unexpected errors
-            return $"*Unexpected error: {ex.Message}*";
-        }
+            _ => $"*Unexpected error: {ex.Message}*"
+        };
     }
 
     private object EvaluateArrayLiteral(ArrayLiteral arr)
@@ -1008,7 +1132,7 @@ public class ObjectInterpreter
 
     private object EvaluateMappingLiteral(MappingLiteral map)
     {
-        var dict = new Dictionary<object, object>();
+        var dict = new LpcMapping();
         foreach (var (keyExpr, valueExpr) in map.Entries)
         {
             var key = Evaluate(keyExpr);
@@ -1022,7 +1146,14 @@ public class ObjectInterpreter
     {
         var target = Evaluate(expr.Target);
         var index = Evaluate(expr.Index);
+        return IndexValue(target, index);
+    }
 
+    /// <summary>
+    /// Evaluate target[index] for strings, arrays and mappings.
+    /// </summary>
+    private static object IndexValue(object target, object index)
+    {
         if (target is string str)
         {
             int i;
@@ -1072,103 +1203,72 @@ public class ObjectInterpreter
     private object EvaluateRangeExpression(RangeExpression expr)
     {
         var target = Evaluate(expr.Target);
+        var startObj = expr.Start != null ? Evaluate(expr.Start) : null;
+        var endObj = expr.End != null ? Evaluate(expr.End) : null;
+        return RangeValue(target, startObj, endObj);
+    }
 
-        // Evaluate start (null means from beginning)
-        int start = 0;
-        if (expr.Start != null)
-        {
-            var startObj = Evaluate(expr.Start);
-            if (startObj is long startLong)
-                start = (int)startLong;
-            else if (startObj is int startInt)
-                start = startInt;
-            else
-                throw new ObjectInterpreterException("Range start must be an integer");
-        }
-
+    /// <summary>
+    /// Evaluate target[start..end]. A null start or end means the range is open on that side.
+    /// A range covering a whole string is the string itself; array ranges are always copies.
+    /// </summary>
+    private static object RangeValue(object target, object? startObj, object? endObj)
+    {
         if (target is string str)
         {
-            // Evaluate end (null means to end of string)
-            int end = str.Length - 1;
-            if (expr.End != null)
-            {
-                var endObj = Evaluate(expr.End);
-                if (endObj is long endLong)
-                    end = (int)endLong;
-                else if (endObj is int endInt)
-                    end = endInt;
-                else
-                    throw new ObjectInterpreterException("Range end must be an integer");
-            }
-
-            // Handle negative indices (count from end)
-            if (start < 0) start = str.Length + start;
-            if (end < 0) end = str.Length + end;
-
-            // Clamp to valid range
-            if (start < 0) start = 0;
-            if (end >= str.Length) end = str.Length - 1;
-
-            if (start > end || start >= str.Length)
-            {
-                return ""; // Empty result for invalid range
-            }
-
-            // LPC range is inclusive on both ends
-            return str.Substring(start, end - start + 1);
+            RangeBounds(str.Length, startObj, endObj, out int start, out int count);
+            return count == str.Length ? str : str.Substring(start, count);
         }
 
         if (target is List<object> list)
         {
-            // Evaluate end (null means to end of list)
-            int end = list.Count - 1;
-            if (expr.End != null)
-            {
-                var endObj = Evaluate(expr.End);
-                if (endObj is long endLong)
-                    end = (int)endLong;
-                else if (endObj is int endInt)
-                    end = endInt;
-                else
-                    throw new ObjectInterpreterException("Range end must be an integer");
-            }
-
-            // Handle negative indices
-            if (start < 0) start = list.Count + start;
-            if (end < 0) end = list.Count + end;
-
-            // Clamp to valid range
-            if (start < 0) start = 0;
-            if (end >= list.Count) end = list.Count - 1;
-
-            if (start > end || start >= list.Count)
-            {
-                return new List<object>(); // Empty array for invalid range
-            }
-
-            // LPC range is inclusive on both ends
-            return list.GetRange(start, end - start + 1);
+            RangeBounds(list.Count, startObj, endObj, out int start, out int count);
+            return list.GetRange(start, count);
         }
 
         throw new ObjectInterpreterException($"Cannot apply range operator to {target?.GetType().Name ?? "null"}");
     }
 
     /// <summary>
-    /// Evaluate arrow call: obj->func(args)
-    /// This is syntactic sugar for call_other(obj, "func", args...)
+    /// The elements [start..end] picks from something of the given length:
+    /// both ends inclusive, negative ends counting from the back, clamped to
+    /// what exists. An empty or backwards range is count 0.
     /// </summary>
-    private object EvaluateArrowCall(ArrowCall arrow)
+    internal static void RangeBounds(int length, object? startObj, object? endObj, out int start, out int count)
+    {
+        start = startObj == null ? 0 : RangeEnd(startObj, "start");
+        int end = endObj == null ? length - 1 : RangeEnd(endObj, "end");
+
+        if (start < 0) start = length + start;
+        if (end < 0) end = length + end;
+        if (start < 0) start = 0;
+        if (end >= length) end = length - 1;
+
+        count = start > end || start >= length ? 0 : end - start + 1;
+        if (count == 0) start = 0;
+    }
+
+    private static int RangeEnd(object value, string which)
+    {
+        return value switch
+        {
+            long l => (int)l,
+            int i => i,
+            _ => throw new ObjectInterpreterException($"Range {which} must be an integer")
+        };
+    }
+
+    /// <summary>
+    /// Evaluate arrow call: obj->func(args)
+    /// This is syntactic sugar for call_other(obj, "func", args...)
+    /// </summary>
+    private object EvaluateArrowCall(ArrowCall arrow)
     {
         var target = Evaluate(arrow.Target);
 
-        if (target is not MudObject targetObj)
+        if (target is not MudObject && IsZero(target))
         {
-            // Check for 0 (null object) - could be int or long
-            if ((target is int i && i == 0) || (target is long l && l == 0))
-            {
-                return 0L; // Calling on 0 returns 0 (LPC convention)
-            }
-            throw new ObjectInterpreterException($"Arrow call target must be an object, got {target?.GetType().Name ?? "null"}");
+            return 0L; // Calling on 0 returns 0 (LPC convention)
         }
 
         // Evaluate arguments
@@ -1178,40 +1278,95 @@ public class ObjectInterpreter
             args.Add(Evaluate(arg));
         }
 
+        return CallArrow(target, arrow.FunctionName, args);
+    }
+
+    private static bool IsZero(object? value)
+    {
+        return (value is int i && i == 0) || (value is long l && l == 0);
+    }
+
+    /// <summary>
+    /// Perform target->function(args) once the target and arguments are evaluated.
+    /// Compiled call sites pass their inline cache for the function lookup.
+    /// </summary>
+    private object CallArrow(object target, string functionName, List<object> args, CallSiteCache? site = null)
+    {
+        if (target is not MudObject targetObj)
+        {
+            // Check for 0 (null object) - could be int or long
+            if (IsZero(target))
+            {
+                return 0L; // Calling on 0 returns 0 (LPC convention)
+            }
+            throw new ObjectInterpreterException($"Arrow call target must be an object, got {target?.GetType().Name ?? "null"}");
+        }
+
         // Find the function and check visibility (arrow is just syntactic sugar for call_other)
-        var func = targetObj.FindFunction(arrow.FunctionName);
+        var (func, owningProgram) = LookupFunction(targetObj, functionName, site);
         if (func == null)
         {
             return 0L; // Function not found
         }
 
         // Security check: private, protected, and static functions cannot be called via arrow/call_other
-        if ((func.Visibility & (FunctionVisibility.Private | FunctionVisibility.Protected | FunctionVisibility.Static)) != 0)
+        if (!IsExternallyCallable(func))
         {
             return 0L; // Act as if function doesn't exist
         }
 
         // Call the function on the target object
-        try
+        return CallResolved(targetObj, functionName, func, owningProgram, args) ?? 0L;
+    }
+
+    /// <summary>
+    /// Find a function on an object's program, through a call site's inline cache when there is one.
+    /// </summary>
+    private static (FunctionDefinition? Function, LpcProgram? OwningProgram) LookupFunction(
+        MudObject target, string functionName, CallSiteCache? site)
+    {
+        if (site == null)
         {
-            return CallFunctionOnObject(targetObj, arrow.FunctionName, args) ?? 0L;
+            return target.Program.FindFunctionWithProgram(functionName);
         }
-        catch (ReturnException ret)
+
+        var entry = site.Lookup(target.Program, functionName);
+        return (entry.Function, entry.OwningProgram);
+    }
+
+    /// <summary>
+    /// Private, protected and static functions can't be reached by call_other or ->.
+    /// </summary>
+    private static bool IsExternallyCallable(FunctionDefinition func)
+    {
+        return (func.Visibility & (FunctionVisibility.Private | FunctionVisibility.Protected | FunctionVisibility.Static)) == 0;
+    }
+
+    /// <summary>
+    /// Call a function already looked up on target. A shadowed target
+    /// resolves again through its merged table so the shadow still gets
+    /// first chance.
+    /// </summary>
+    private object? CallResolved(MudObject target, string functionName, FunctionDefinition func,
+        LpcProgram? owningProgram, List<object> args)
+    {
+        if (target.ShadowedBy != null && target.TryResolveCall(functionName, out target, out var entry))
         {
-            return ret.Value ?? 0L;
+            (func, owningProgram) = (entry.Function, entry.OwningProgram);
         }
+        return InvokeOnObject(target, func, owningProgram, args);
     }
 
     private object EvaluateIdentifier(Identifier id)
     {
         // Check local scope first (function parameters/locals)
-        if (_localScopes.Count > 0 && _localScopes.Peek().TryGetValue(id.Name, out var localValue))
+        if (Vm.LocalScopes.Count > 0 && Vm.LocalScopes.Peek().TryGetValue(id.Name, out var localValue))
         {
             return localValue ?? 0;
         }
 
         // Then check object variables
-        var value = _currentObject.GetVariable(id.Name);
+        var value = Vm.CurrentObject.GetVariable(id.Name);
         return value ?? 0; // Default to 0 if null
     }
 
@@ -1220,14 +1375,14 @@ public class ObjectInterpreter
         var value = Evaluate(expr.Value);
 
         // Check if it's a local variable
-        if (_localScopes.Count > 0 && _localScopes.Peek().ContainsKey(expr.Name))
+        if (Vm.LocalScopes.Count > 0 && Vm.LocalScopes.Peek().ContainsKey(expr.Name))
         {
-            _localScopes.Peek()[expr.Name] = value;
+            Vm.LocalScopes.Peek()[expr.Name] = value;
         }
         else
         {
             // It's an object variable
-            _currentObject.SetVariable(expr.Name, value);
+            Vm.CurrentObject.SetVariable(expr.Name, value);
         }
 
         return value;
@@ -1239,38 +1394,52 @@ public class ObjectInterpreter
         object? currentValue;
         bool isLocal = false;
 
-        if (_localScopes.Count > 0 && _localScopes.Peek().TryGetValue(expr.Name, out var localVal))
+        if (Vm.LocalScopes.Count > 0 && Vm.LocalScopes.Peek().TryGetValue(expr.Name, out var localVal))
         {
             currentValue = localVal;
             isLocal = true;
         }
         else
         {
-            currentValue = _currentObject.GetVariable(expr.Name);
+            currentValue = Vm.CurrentObject.GetVariable(expr.Name);
         }
 
         var rightValue = Evaluate(expr.Value);
+        var newValue = CompoundValue(expr.Operator, currentValue, rightValue);
+
+        if (isLocal)
+        {
+            Vm.LocalScopes.Peek()[expr.Name] = newValue;
+        }
+        else
+        {
+            Vm.CurrentObject.SetVariable(expr.Name, newValue);
+        }
+        return newValue;
+    }
 
+    /// <summary>
+    /// Compute the new value for "current op= right".
+    /// </summary>
+    private object CompoundValue(BinaryOperator op, object? currentValue, object? rightValue)
+    {
         // Handle string concatenation for +=
-        if (expr.Operator == BinaryOperator.Add && currentValue is string leftStr)
+        if (op == BinaryOperator.Add && currentValue is string leftStr)
         {
-            var result = leftStr + ToStr(rightValue);
-            if (isLocal)
-            {
-                _localScopes.Peek()[expr.Name] = result;
-            }
-            else
-            {
-                _currentObject.SetVariable(expr.Name, result);
-            }
-            return result;
+            return leftStr + ToStr(rightValue);
+        }
+
+        // Arrays and mappings: += and -= combine into a new one, as + and - do
+        if (currentValue is List<object> or Dictionary<object, object>)
+        {
+            return BinaryOpValues(op, currentValue, rightValue);
         }
 
         // Integer operations
         var left_i = ToInt(currentValue);
         var right_i = ToInt(rightValue);
 
-        var newValue = expr.Operator switch
+        return op switch
         {
             BinaryOperator.Add => left_i + right_i,
             BinaryOperator.Subtract => left_i - right_i,
@@ -1284,18 +1453,20 @@ public class ObjectInterpreter
             BinaryOperator.BitwiseXor => left_i ^ right_i,
             BinaryOperator.LeftShift => left_i << (int)right_i,
             BinaryOperator.RightShift => left_i >> (int)right_i,
-            _ => throw new ObjectInterpreterException($"Unsupported compound assignment operator: {expr.Operator}")
+            _ => throw new ObjectInterpreterException($"Unsupported compound assignment operator: {op}")
         };
+    }
 
-        if (isLocal)
-        {
-            _localScopes.Peek()[expr.Name] = newValue;
-        }
-        else
-        {
-            _currentObject.SetVariable(expr.Name, newValue);
-        }
-        return newValue;
+    /// <summary>
+    /// Evaluate target[index] = value.
+    /// </summary>
+    private object EvaluateIndexAssignment(IndexAssignment expr)
+    {
+        var target = Evaluate(expr.Object);
+        var index = Evaluate(expr.Index);
+        var value = Evaluate(expr.Value);
+        SetIndexValue(target, index, value);
+        return value;
     }
 
     private object EvaluateFunctionCall(FunctionCall expr)
@@ -1307,62 +1478,82 @@ public class ObjectInterpreter
         }
 
         // Evaluate all arguments first
-        var args = expr.Arguments.Select(arg => Evaluate(arg)).ToList();
+        var args = new List<object>(expr.Arguments.Count);
+        foreach (var arg in expr.Arguments)
+        {
+            args.Add(Evaluate(arg));
+        }
 
+        return CallNamedFunction(expr.Name, args, expr.IsParentCall, expr.Line);
+    }
+
+    /// <summary>
+    /// Call name(args) from the current object: a ::parent call, a function in the
+    /// object's program (including inherited ones), or an efun, in that order.
+    /// </summary>
+    private object CallNamedFunction(string name, List<object> args, bool isParentCall, int line)
+    {
         // Handle parent function call (::function())
-        if (expr.IsParentCall)
+        if (isParentCall)
         {
             // For parent calls, we need to find the parent relative to the program
-            // where the calling function is defined, not relative to _currentObject.
+            // where the calling function is defined, not relative to Vm.CurrentObject.
             // This is critical for correct behavior with multi-level inheritance.
-            LpcProgram searchFrom;
-            if (_executingPrograms.Count > 0)
-            {
-                // Use the program of the currently executing function
-                searchFrom = _executingPrograms.Peek();
-            }
-            else
-            {
-                // No function context - use object's program (shouldn't happen normally)
-                searchFrom = _currentObject.Program;
-            }
+            // Use the program of the currently executing function; with no
+            // function context use the object's program (shouldn't happen normally)
+            LpcProgram searchFrom = Vm.ExecutingProgram ?? Vm.CurrentObject.Program;
 
-            var parentFunc = searchFrom.FindParentFunction(expr.Name);
+            // The owning program is needed for correct nested parent calls
+            var (parentFunc, owningProgram) = searchFrom.FindParentFunctionWithProgram(name);
             if (parentFunc == null)
             {
                 throw RuntimeError(
-                    $"Parent function '{expr.Name}' not found in inheritance chain", expr);
+                    $"Parent function '{name}' not found in inheritance chain", line);
             }
 
-            // Find which program owns this parent function for correct nested parent calls
-            var (_, owningProgram) = searchFrom.InheritedPrograms
-                .Select(p => p.FindFunctionWithProgram(expr.Name))
-                .FirstOrDefault(r => r.Function != null);
-
             return CallUserFunctionWithProgram(parentFunc, args, owningProgram) ?? 0;
         }
 
         // Check in current object's program (including inherited functions)
-        var (objectFunc, funcProgram) = _currentObject.Program.FindFunctionWithProgram(expr.Name);
+        var (objectFunc, funcProgram) = Vm.CurrentObject.Program.FindFunctionWithProgram(name);
         if (objectFunc != null)
         {
             return CallUserFunctionWithProgram(objectFunc, args, funcProgram) ?? 0;
         }
 
         // Check for efun
-        if (_efuns.TryGet(expr.Name, out var efun) && efun != null)
+        if (_efuns.TryGet(name, out var efun) && efun != null)
         {
-            try
+            return CallEfun(name, efun, args, line);
+        }
+
+        throw RuntimeError($"Unknown function '{name}' in {Vm.CurrentObject.ObjectName}", line);
+    }
+
+    /// <summary>
+    /// Run an efun under the heartbeat sandbox and region guard, if any.
+    /// </summary>
+    private object CallEfun(string name, Func<List<object>, object> efun, List<object> args, int line)
+    {
+        try
+        {
+            var sandbox = Vm.Sandbox;
+            if (sandbox != null && !sandbox.AllowEfun(name, efun, args))
             {
-                return efun(args);
+                return 0L; // Recorded, sent after the heartbeat phase
             }
-            catch (EfunException ex)
+
+            var guard = RegionGuard;
+            if (guard != null && !guard.IsExclusive && !(guard.AllowsEfun(name, args) && guard.IsLocal(Vm.CurrentObject)))
             {
-                throw RuntimeError(ex.Message, expr);
+                return guard.RunExclusive(() => EfunRegistry.DeepCopy(efun(args)), CallStackIsLocal);
             }
+            return efun(args);
+        }
+        catch (EfunException ex)
+        {
+            throw RuntimeError(ex.Message, line);
         }
-
-        throw RuntimeError($"Unknown function '{expr.Name}' in {_currentObject.ObjectName}", expr);
     }
 
     /// <summary>
@@ -1384,23 +1575,16 @@ public class ObjectInterpreter
         var formatStr = Evaluate(expr.Arguments[1]) as string
             ?? throw new ObjectInterpreterException("sscanf() second argument must be a format string");
 
-        // Collect the variable identifiers (not evaluated)
-        var varArgs = new List<Expression>();
-        for (int i = 2; i < expr.Arguments.Count; i++)
-        {
-            varArgs.Add(expr.Arguments[i]);
-        }
-
-        // Parse the format string and extract values
-        var values = ParseSscanfFormat(inputStr, formatStr);
+        // A literal format's plan is kept on the literal
+        var plan = expr.Arguments[1] is StringLiteral ? SscanfFormat.Precompile(formatStr) : SscanfFormat.Get(formatStr);
+        var values = new object?[plan.Captures];
+        int count = plan.Match(inputStr, values);
         int assigned = 0;
 
-        // Assign values to variables
-        for (int i = 0; i < values.Count && i < varArgs.Count; i++)
+        // Assign values to the variable arguments (not evaluated)
+        for (int i = 0; i < count && i + 2 < expr.Arguments.Count; i++)
         {
-            if (values[i] == null) continue; // Skip if this was a %* format
-
-            var varExpr = varArgs[i];
+            var varExpr = expr.Arguments[i + 2];
             if (varExpr is Identifier id)
             {
                 // Simple variable assignment
@@ -1422,182 +1606,13 @@ public class ObjectInterpreter
         return assigned;
     }
 
-    /// <summary>
-    /// Parse a string using sscanf format specifiers.
-    /// Returns a list of parsed values (null for skipped %* patterns).
-    /// </summary>
-    private List<object?> ParseSscanfFormat(string input, string format)
-    {
-        var results = new List<object?>();
-        int inputPos = 0;
-        int formatPos = 0;
-
-        while (formatPos < format.Length && inputPos <= input.Length)
-        {
-            if (format[formatPos] == '%' && formatPos + 1 < format.Length)
-            {
-                formatPos++;
-                bool skip = false;
-
-                // Check for * (skip)
-                if (format[formatPos] == '*')
-                {
-                    skip = true;
-                    formatPos++;
-                }
-
-                if (formatPos >= format.Length) break;
-
-                char specifier = format[formatPos];
-                formatPos++;
-
-                // Look ahead in format to find the delimiter (next literal or end)
-                string? delimiter = null;
-                int nextLiteral = formatPos;
-                while (nextLiteral < format.Length)
-                {
-                    if (format[nextLiteral] == '%')
-                    {
-                        break;
-                    }
-                    delimiter = (delimiter ?? "") + format[nextLiteral];
-                    nextLiteral++;
-                }
-
-                switch (specifier)
-                {
-                    case 's':
-                        // Match string up to delimiter or end
-                        int endPos;
-                        if (!string.IsNullOrEmpty(delimiter))
-                        {
-                            endPos = input.IndexOf(delimiter, inputPos, StringComparison.Ordinal);
-                            if (endPos == -1) endPos = input.Length;
-                        }
-                        else
-                        {
-                            // No delimiter text between this specifier and the next
-                            // Check if there's another format specifier coming
-                            if (nextLiteral < format.Length && format[nextLiteral] == '%')
-                            {
-                                // Another specifier follows (e.g., %s%d)
-                                // For %s followed by %d, stop at first digit
-                                // For %s followed by %s, stop at whitespace
-                                char? nextSpec = (nextLiteral + 1 < format.Length) ? format[nextLiteral + 1] : null;
-                                if (nextSpec == 'd')
-                                {
-                                    // Stop before first digit
-                                    endPos = inputPos;
-                                    while (endPos < input.Length && !char.IsDigit(input[endPos]))
-                                    {
-                                        endPos++;
-                                    }
-                                }
-                                else
-                                {
-                                    // Stop at whitespace for %s%s
-                                    endPos = inputPos;
-                                    while (endPos < input.Length && !char.IsWhiteSpace(input[endPos]))
-                                    {
-                                        endPos++;
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                // This is the last specifier - capture rest of string
-                                endPos = input.Length;
-                            }
-                        }
-
-                        var strValue = input[inputPos..endPos];
-                        if (!skip)
-                        {
-                            results.Add(strValue);
-                        }
-                        inputPos = endPos;
-
-                        // Skip the delimiter if present
-                        if (!string.IsNullOrEmpty(delimiter) && input[inputPos..].StartsWith(delimiter))
-                        {
-                            inputPos += delimiter.Length;
-                            formatPos = nextLiteral;
-                        }
-                        break;
-
-                    case 'd':
-                        // Skip leading whitespace for %d
-                        while (inputPos < input.Length && char.IsWhiteSpace(input[inputPos]))
-                        {
-                            inputPos++;
-                        }
-
-                        // Match integer
-                        int intStart = inputPos;
-                        if (inputPos < input.Length && (input[inputPos] == '-' || input[inputPos] == '+'))
-                        {
-                            inputPos++;
-                        }
-                        while (inputPos < input.Length && char.IsDigit(input[inputPos]))
-                        {
-                            inputPos++;
-                        }
-
-                        if (intStart == inputPos)
-                        {
-                            // No digits found
-                            return results;
-                        }
-
-                        var intStr = input[intStart..inputPos];
-                        if (int.TryParse(intStr, out int intValue))
-                        {
-                            if (!skip)
-                            {
-                                results.Add(intValue);
-                            }
-                        }
-                        else
-                        {
-                            return results;
-                        }
-
-                        // Skip delimiter if present
-                        if (!string.IsNullOrEmpty(delimiter) && inputPos < input.Length &&
-                            input[inputPos..].StartsWith(delimiter))
-                        {
-                            inputPos += delimiter.Length;
-                            formatPos = nextLiteral;
-                        }
-                        break;
-
-                    default:
-                        throw new ObjectInterpreterException($"sscanf() unknown format specifier '%{specifier}'");
-                }
-            }
-            else
-            {
-                // Literal character - must match
-                if (inputPos >= input.Length || input[inputPos] != format[formatPos])
-                {
-                    // Mismatch - stop parsing
-                    break;
-                }
-                inputPos++;
-                formatPos++;
-            }
-        }
-
-        return results;
-    }
-
     /// <summary>
     /// Assign a value to a variable by name (handles locals and object variables).
     /// </summary>
     private void AssignToVariable(string name, object value)
     {
         // Try local scopes first
-        foreach (var scope in _localScopes)
+        foreach (var scope in Vm.LocalScopes)
         {
             if (scope.ContainsKey(name))
             {
@@ -1607,16 +1622,16 @@ public class ObjectInterpreter
         }
 
         // Try object variables
-        if (_currentObject.Variables.ContainsKey(name))
+        if (Vm.CurrentObject.HasVariable(name))
         {
-            _currentObject.Variables[name] = value;
+            Vm.CurrentObject.SetVariable(name, value);
             return;
         }
 
         // Variable doesn't exist - create in local scope if we have one
-        if (_localScopes.Count > 0)
+        if (Vm.LocalScopes.Count > 0)
         {
-            _localScopes.Peek()[name] = value;
+            Vm.LocalScopes.Peek()[name] = value;
         }
         else
         {
@@ -1632,6 +1647,18 @@ public class ObjectInterpreter
     {
         var target = Evaluate(indexExpr.Target);
         var index = Evaluate(indexExpr.Index);
+        SetIndexValue(target, index, value);
+    }
+
+    private void SetIndexValue(object target, object index, object value)
+    {
+        if (Vm.Sandbox is { } sandbox)
+        {
+            throw sandbox.AbortMutation();
+        }
+
+        // The container is usually one of this object's own variables
+        Vm.CurrentObject?.MarkDirty();
 
         if (target is List<object> list)
         {
@@ -1659,7 +1686,7 @@ public class ObjectInterpreter
     {
         // Use the current object's program as the owning program
         // This is the legacy behavior, but CallUserFunctionWithProgram should be preferred
-        return CallUserFunctionWithProgram(funcDef, args, _currentObject.Program);
+        return CallUserFunctionWithProgram(funcDef, args, Vm.CurrentObject.Program);
     }
 
     private object? CallUserFunctionWithProgram(FunctionDefinition funcDef, List<object> args, LpcProgram? owningProgram)
@@ -1684,59 +1711,106 @@ public class ObjectInterpreter
             }
         }
 
-        // Create local scope for function parameters
-        var localScope = new Dictionary<string, object?>();
-        for (int i = 0; i < funcDef.Parameters.Count; i++)
+        var vm = Vm;
+
+        // Compiled functions keep parameters and locals in slots on their VM frame;
+        // only tree-walked functions need a name-keyed scope.
+        CompiledFunction? compiled = null;
+        if (UseBytecode && owningProgram != null &&
+            owningProgram.CompiledFunctions.TryGetValue(funcDef.Name, out var candidate) &&
+            ReferenceEquals(candidate.Definition, funcDef))
+        {
+            compiled = candidate;
+        }
+        else if (UseBytecode && owningProgram != null && funcDef.IsDeferred)
         {
-            // Use provided argument, or 0 for missing varargs parameters
-            localScope[funcDef.Parameters[i]] = i < args.Count ? args[i] : 0;
+            compiled = owningProgram.LowerDeferred(funcDef);
         }
 
-        // Push local scope onto stack
-        _localScopes.Push(localScope);
+        // A pure query whose object hasn't changed since it last ran
+        long memoVersion = -1;
+        if (compiled is { Memo: not QueryMemoKind.None } && MemoizeQueries && !Profiler.Enabled && vm.CallTrace == null)
+        {
+            memoVersion = vm.CurrentObject.StateVersion;
+            if (vm.CurrentObject.Memo.TryGet(compiled, memoVersion, out var memoized))
+            {
+                return memoized;
+            }
+        }
 
-        // Push the owning program onto the executing programs stack
-        // This is used for correct :: (parent call) resolution
-        if (owningProgram != null)
+        if (compiled == null)
         {
-            _executingPrograms.Push(owningProgram);
+            // Create local scope for function parameters
+            var localScope = vm.RentScope();
+            for (int i = 0; i < funcDef.Parameters.Count; i++)
+            {
+                // Use provided argument, or 0 for missing varargs parameters
+                localScope[funcDef.Parameters[i]] = i < args.Count ? args[i] : 0;
+            }
+
+            // Push local scope onto stack
+            vm.LocalScopes.Push(localScope);
         }
 
-        // Track file/function for error messages and stack traces
-        var previousFile = _currentFile;
-        var previousLine = _currentLine;
-        var filePath = owningProgram?.FilePath ?? _currentObject.ObjectName;
-        _currentFile = filePath;
-        _currentLine = funcDef.Body.Line;
-        _traceStack.Push((filePath, funcDef.Name, funcDef.Body.Line));
+        // One frame per call: :: resolution, error files and stack traces
+        // are all worked out from the frame stack when they're needed
+        var frame = new CallFrame(funcDef, owningProgram, vm.CurrentObject);
+        vm.Frames.Push(frame);
 
-        // Check recursion depth limit
-        CheckRecursionDepth();
+        bool profiled = Profiler.Enabled;
+        if (profiled)
+        {
+            Profiler.Enter(frame.File, funcDef.Name, vm.InstructionsExecuted);
+        }
+        var callTrace = vm.CallTrace;
+        int traced = callTrace?.Enter(frame.File, funcDef.Name, vm.Frames.Count) ?? -1;
 
         try
         {
+            // Limits are checked once on entry; loops are charged as they run
+            CheckRecursionDepth(vm);
+            ChargeInstructions(vm, 1, funcDef.BodyLine);
+
+            if (compiled != null)
+            {
+                var result = RunBytecode(compiled, args);
+                if (memoVersion >= 0 && vm.CurrentObject.StateVersion == memoVersion)
+                {
+                    vm.CurrentObject.Memo.Store(compiled, memoVersion, result);
+                }
+                return result;
+            }
+
             // Execute function body
-            Execute(funcDef.Body);
-            return 0L; // Default return value
-        }
-        catch (ReturnException ret)
-        {
-            return ret.Value ?? 0L; // Return 0 if null
+            var completion = Execute(funcDef.Body);
+            switch (completion.Kind)
+            {
+                case CompletionKind.Return:
+                    return completion.Value ?? 0L; // Return 0 if null
+                case CompletionKind.Break:
+                case CompletionKind.Continue:
+                    throw StrayLoopControl(completion.Kind, StrayLoopControlLine(funcDef.Body) ?? funcDef.Body.Line);
+                default:
+                    return 0L; // Default return value
+            }
         }
         finally
         {
-            // Pop trace stack
-            _traceStack.Pop();
-            _currentFile = previousFile;
-            _currentLine = previousLine;
+            if (profiled)
+            {
+                Profiler.Exit(vm.InstructionsExecuted);
+            }
+            if (traced >= 0)
+            {
+                callTrace!.Exit(traced);
+            }
 
-            // Pop local scope
-            _localScopes.Pop();
+            vm.Frames.Pop();
 
-            // Pop executing program
-            if (owningProgram != null)
+            // Pop local scope
+            if (compiled == null)
             {
-                _executingPrograms.Pop();
+                vm.ReturnScope(vm.LocalScopes.Pop());
             }
         }
     }
@@ -1763,24 +1837,32 @@ public class ObjectInterpreter
         // Evaluate both operands
         var leftValue = Evaluate(expr.Left);
         var rightValue = Evaluate(expr.Right);
+        return BinaryOpValues(expr.Operator, leftValue, rightValue);
+    }
 
+    /// <summary>
+    /// Apply a (non short-circuit) binary operator to evaluated operands.
+    /// </summary>
+    private object BinaryOpValues(BinaryOperator op, object? leftValue, object? rightValue)
+    {
         // String concatenation for +
-        if (expr.Operator == BinaryOperator.Add && leftValue is string leftStr)
+        if (op == BinaryOperator.Add && leftValue is string leftStr)
         {
             return leftStr + ToStr(rightValue);
         }
 
         // Array concatenation for +
-        if (expr.Operator == BinaryOperator.Add && leftValue is List<object> leftArr && rightValue is List<object> rightArr)
+        if (op == BinaryOperator.Add && leftValue is List<object> leftArr && rightValue is List<object> rightArr)
         {
-            var result = new List<object>(leftArr);
+            var result = new List<object>(leftArr.Count + rightArr.Count);
+            result.AddRange(leftArr);
             result.AddRange(rightArr);
             return result;
         }
 
         // Array subtraction for -
         // Removes all occurrences of elements in rightArr from leftArr
-        if (expr.Operator == BinaryOperator.Subtract && leftValue is List<object> leftArrSub && rightValue is List<object> rightArrSub)
+        if (op == BinaryOperator.Subtract && leftValue is List<object> leftArrSub && rightValue is List<object> rightArrSub)
         {
             var result = new List<object>();
             foreach (var item in leftArrSub)
@@ -1804,9 +1886,9 @@ public class ObjectInterpreter
         }
 
         // Mapping concatenation for + (merge mappings, right overwrites left)
-        if (expr.Operator == BinaryOperator.Add && leftValue is Dictionary<object, object> leftMap && rightValue is Dictionary<object, object> rightMap)
+        if (op == BinaryOperator.Add && leftValue is Dictionary<object, object> leftMap && rightValue is Dictionary<object, object> rightMap)
         {
-            var result = new Dictionary<object, object>();
+            var result = new LpcMapping();
             foreach (var kvp in leftMap)
             {
                 result[kvp.Key] = kvp.Value;
@@ -1821,35 +1903,35 @@ public class ObjectInterpreter
         // String comparison
         if (leftValue is string ls && rightValue is string rs)
         {
-            return expr.Operator switch
+            return op switch
             {
                 BinaryOperator.Equal => string.Equals(ls, rs) ? 1L : 0L,
                 BinaryOperator.NotEqual => !string.Equals(ls, rs) ? 1L : 0L,
-                _ => throw new ObjectInterpreterException($"Cannot apply operator {expr.Operator} to strings")
+                _ => throw new ObjectInterpreterException($"Cannot apply operator {op} to strings")
             };
         }
 
         // Object comparison (reference equality)
         if (leftValue is MudObject leftObj && rightValue is MudObject rightObj)
         {
-            return expr.Operator switch
+            return op switch
             {
                 BinaryOperator.Equal => ReferenceEquals(leftObj, rightObj) ? 1L : 0L,
                 BinaryOperator.NotEqual => !ReferenceEquals(leftObj, rightObj) ? 1L : 0L,
-                _ => throw new ObjectInterpreterException($"Cannot apply operator {expr.Operator} to objects")
+                _ => throw new ObjectInterpreterException($"Cannot apply operator {op} to objects")
             };
         }
 
         // Mixed type equality comparisons (string vs int, etc.) return false
         // This matches authentic LPC behavior
-        if (expr.Operator == BinaryOperator.Equal || expr.Operator == BinaryOperator.NotEqual)
+        if (op == BinaryOperator.Equal || op == BinaryOperator.NotEqual)
         {
             bool sameType = (IsInteger(leftValue) && IsInteger(rightValue)) ||
                            (leftValue is string && rightValue is string) ||
                            (leftValue is MudObject && rightValue is MudObject);
             if (!sameType)
             {
-                return expr.Operator == BinaryOperator.Equal ? 0L : 1L;
+                return op == BinaryOperator.Equal ? 0L : 1L;
             }
         }
 
@@ -1857,7 +1939,7 @@ public class ObjectInterpreter
         var left_i = ToInt(leftValue);
         var right_i = ToInt(rightValue);
 
-        return expr.Operator switch
+        return op switch
         {
             BinaryOperator.Add => left_i + right_i,
             BinaryOperator.Subtract => left_i - right_i,
@@ -1877,7 +1959,7 @@ public class ObjectInterpreter
             BinaryOperator.BitwiseXor => left_i ^ right_i,
             BinaryOperator.LeftShift => left_i << (int)right_i,
             BinaryOperator.RightShift => left_i >> (int)right_i,
-            _ => throw new ObjectInterpreterException($"Unknown binary operator: {expr.Operator}")
+            _ => throw new ObjectInterpreterException($"Unknown binary operator: {op}")
         };
     }
 
@@ -1885,83 +1967,58 @@ public class ObjectInterpreter
     {
         return expr.Operator switch
         {
-            UnaryOperator.Negate => -ToInt(Evaluate(expr.Operand)),
-            UnaryOperator.LogicalNot => IsTrue(Evaluate(expr.Operand)) ? 0 : 1,
-            UnaryOperator.BitwiseNot => ~ToInt(Evaluate(expr.Operand)),
-            UnaryOperator.PreIncrement => EvaluatePreIncrement((Identifier)expr.Operand),
-            UnaryOperator.PreDecrement => EvaluatePreDecrement((Identifier)expr.Operand),
-            UnaryOperator.PostIncrement => EvaluatePostIncrement((Identifier)expr.Operand),
-            UnaryOperator.PostDecrement => EvaluatePostDecrement((Identifier)expr.Operand),
-            _ => throw new ObjectInterpreterException($"Unknown unary operator: {expr.Operator}")
+            UnaryOperator.PreIncrement or UnaryOperator.PreDecrement or
+            UnaryOperator.PostIncrement or UnaryOperator.PostDecrement =>
+                IncDecVariable(((Identifier)expr.Operand).Name, expr.Operator),
+            _ => UnaryValue(expr.Operator, Evaluate(expr.Operand))
         };
     }
 
-    private object EvaluatePreIncrement(Identifier id)
+    /// <summary>
+    /// Apply -, ! or ~ to an evaluated operand.
+    /// </summary>
+    private object UnaryValue(UnaryOperator op, object? operand)
     {
-        // Check local scope first
-        if (_localScopes.Count > 0 && _localScopes.Peek().TryGetValue(id.Name, out var localVal))
+        return op switch
         {
-            var value = ToInt(localVal ?? 0);
-            var newValue = value + 1;
-            _localScopes.Peek()[id.Name] = newValue;
-            return newValue;
-        }
-
-        var current = _currentObject.GetVariable(id.Name);
-        var val = ToInt(current ?? 0);
-        var newVal = val + 1;
-        _currentObject.SetVariable(id.Name, newVal);
-        return newVal;
+            UnaryOperator.Negate => -ToInt(operand),
+            UnaryOperator.LogicalNot => IsTrue(operand) ? 0L : 1L,
+            UnaryOperator.BitwiseNot => ~ToInt(operand),
+            _ => throw new ObjectInterpreterException($"Unknown unary operator: {op}")
+        };
     }
 
-    private object EvaluatePreDecrement(Identifier id)
+    /// <summary>
+    /// ++x, --x, x++ and x-- on a local or object variable.
+    /// Prefix forms return the new value, postfix forms the old one.
+    /// </summary>
+    private object IncDecVariable(string name, UnaryOperator op)
     {
         // Check local scope first
-        if (_localScopes.Count > 0 && _localScopes.Peek().TryGetValue(id.Name, out var localVal))
+        object? current = null;
+        bool isLocal = Vm.LocalScopes.Count > 0 && Vm.LocalScopes.Peek().TryGetValue(name, out current);
+        if (!isLocal)
         {
-            var value = ToInt(localVal ?? 0);
-            var newValue = value - 1;
-            _localScopes.Peek()[id.Name] = newValue;
-            return newValue;
+            current = Vm.CurrentObject.GetVariable(name);
         }
 
-        var current = _currentObject.GetVariable(id.Name);
-        var val = ToInt(current ?? 0);
-        var newVal = val - 1;
-        _currentObject.SetVariable(id.Name, newVal);
-        return newVal;
-    }
+        var oldValue = ToInt(current ?? 0);
+        var newValue = op is UnaryOperator.PreIncrement or UnaryOperator.PostIncrement
+            ? oldValue + 1
+            : oldValue - 1;
 
-    private object EvaluatePostIncrement(Identifier id)
-    {
-        // Check local scope first
-        if (_localScopes.Count > 0 && _localScopes.Peek().TryGetValue(id.Name, out var localVal))
+        if (isLocal)
         {
-            var val = ToInt(localVal ?? 0);
-            _localScopes.Peek()[id.Name] = val + 1;
-            return val; // Return old value
+            Vm.LocalScopes.Peek()[name] = newValue;
         }
-
-        var current = _currentObject.GetVariable(id.Name);
-        var value = ToInt(current ?? 0);
-        _currentObject.SetVariable(id.Name, value + 1);
-        return value; // Return old value
-    }
-
-    private object EvaluatePostDecrement(Identifier id)
-    {
-        // Check local scope first
-        if (_localScopes.Count > 0 && _localScopes.Peek().TryGetValue(id.Name, out var localVal))
+        else
         {
-            var val = ToInt(localVal ?? 0);
-            _localScopes.Peek()[id.Name] = val - 1;
-            return val; // Return old value
+            Vm.CurrentObject.SetVariable(name, newValue);
         }
 
-        var current = _currentObject.GetVariable(id.Name);
-        var value = ToInt(current ?? 0);
-        _currentObject.SetVariable(id.Name, value - 1);
-        return value; // Return old value
+        return op is UnaryOperator.PreIncrement or UnaryOperator.PreDecrement
+            ? newValue
+            : oldValue; // Postfix returns old value
     }
 
     private object EvaluateTernaryOp(TernaryOp expr)
@@ -2021,7 +2078,7 @@ public class ObjectInterpreter
     /// </summary>
     public MudObject GetCurrentObject()
     {
-        return _currentObject;
+        return Vm.CurrentObject;
     }
 
     /// <summary>
@@ -2029,7 +2086,7 @@ public class ObjectInterpreter
     /// </summary>
     public MudObject? GetPreviousObject()
     {
-        return _callStack.Count > 0 ? _callStack.Peek() : null;
+        return Vm.CallStack.Count > 0 ? Vm.CallStack.Peek() : null;
     }
 
     #endregion
@@ -2086,7 +2143,7 @@ public class ObjectInterpreter
             throw new EfunException("this_object() takes no arguments");
         }
 
-        return _currentObject;
+        return Vm.CurrentObject;
     }
 
     /// <summary>
@@ -2107,18 +2164,7 @@ public class ObjectInterpreter
         }
 
         // Permission check: allow loading public game content, require Wizard+ for others
-        // Public paths that players can load for normal gameplay
-        bool isPublicPath = path.StartsWith("/world/") ||
-                           path.StartsWith("/std/") ||
-                           path.StartsWith("/cmds/") ||
-                           path.StartsWith("/help/") ||
-                           path.StartsWith("/examples/");
-
-        if (!isPublicPath)
-        {
-            RequireAccessLevel(AccessLevel.Wizard, "load_object");
-            RequirePathAccess(path, "load_object", isWrite: false);
-        }
+        RequireLoadAccess(path, "load_object");
 
         try
         {
@@ -2175,8 +2221,8 @@ public class ObjectInterpreter
         // 3. Objects can destruct their contents (corpse burying items)
         var context = ExecutionContext.Current;
         bool isPlayerSelfDestruct = context?.PlayerObject != null && context.PlayerObject == obj;
-        bool isObjectSelfDestruct = _currentObject == obj;
-        bool isDestructingOwnContent = obj.Environment == _currentObject;
+        bool isObjectSelfDestruct = Vm.CurrentObject == obj;
+        bool isDestructingOwnContent = obj.Environment == Vm.CurrentObject;
 
         if (!isPlayerSelfDestruct && !isObjectSelfDestruct && !isDestructingOwnContent)
         {
@@ -2207,6 +2253,14 @@ public class ObjectInterpreter
     /// Returns the function's return value, or 0 if function not found.
     /// </summary>
     private object CallOtherEfun(List<object> args)
+    {
+        return CallOther(args, null);
+    }
+
+    /// <summary>
+    /// call_other with an optional inline cache from a compiled call site.
+    /// </summary>
+    private object CallOther(List<object> args, CallSiteCache? site)
     {
         if (args.Count < 2)
         {
@@ -2236,7 +2290,7 @@ public class ObjectInterpreter
         }
 
         // Find the function
-        var func = target.FindFunction(functionName);
+        var (func, owningProgram) = LookupFunction(target, functionName, site);
         if (func == null)
         {
             // LPC convention: return 0 if function not found
@@ -2244,7 +2298,7 @@ public class ObjectInterpreter
         }
 
         // Security check: private, protected, and static functions cannot be called via call_other
-        if ((func.Visibility & (FunctionVisibility.Private | FunctionVisibility.Protected | FunctionVisibility.Static)) != 0)
+        if (!IsExternallyCallable(func))
         {
             // LPC convention: return 0 as if function doesn't exist (don't reveal existence)
             return 0;
@@ -2253,13 +2307,9 @@ public class ObjectInterpreter
         try
         {
             // Call the function on the target object
-            var result = CallFunctionOnObject(target, functionName, funcArgs);
+            var result = CallResolved(target, functionName, func, owningProgram, funcArgs);
             return result ?? 0;
         }
-        catch (ReturnException ret)
-        {
-            return ret.Value ?? 0;
-        }
         catch (Exception ex)
         {
             throw new EfunException($"call_other() failed: {ex.Message}");
@@ -2267,30 +2317,181 @@ public class ObjectInterpreter
     }
 
     /// <summary>
-    /// move_object(destination) or move_object(what, destination)
-    /// Moves an object to a new environment and calls init() hooks.
-    /// Single arg: moves this_object() (or this_player()) to destination
-    /// Two args: moves first arg to second arg
-    /// Returns 1 on success, 0 on failure.
-    ///
-    /// After a successful move, init() is called on:
-    /// 1. The destination (with this_player() = moving object)
-    /// 2. All other objects already in the destination (with this_player() = moving object)
+    /// call_other_async(ob, function, args, [callback]) - call_other() that
+    /// may cross cluster nodes. ob is an object or a path; a path another
+    /// node owns is called there. callback(result) is called on this_object()
+    /// as a call_out once the result is back; 0 if the call failed or timed
+    /// out. Objects in the result come back as their names. Returns 1.
     /// </summary>
-    private object MoveObjectEfun(List<object> args)
+    private object CallOtherAsyncEfun(List<object> args)
     {
-        MudObject? what;
-        MudObject? destination;
-
-        if (args.Count == 1)
+        if (args.Count < 3 || args.Count > 4)
         {
-            // Single arg: move this_player() or this_object() to destination
-            var context = ExecutionContext.Current;
-            what = context?.PlayerObject ?? _currentObject;
-
-            // Check for 0 (null destination) - could be int or long
-            if ((args[0] is int i && i == 0) || (args[0] is long l && l == 0))
-            {
+            throw new EfunException("call_other_async() requires 3 or 4 arguments");
+        }
+        if (args[0] is not (MudObject or string))
+        {
+            throw new EfunException("call_other_async() first argument must be an object or a path");
+        }
+        if (args[1] is not string function)
+        {
+            throw new EfunException("call_other_async() second argument must be a function name");
+        }
+        if (args[2] is not List<object> callArgs)
+        {
+            throw new EfunException("call_other_async() third argument must be an array of arguments");
+        }
+
+        string? callback = null;
+        if (args.Count == 4)
+        {
+            callback = args[3] as string ?? throw new EfunException("call_other_async() callback must be a function name string");
+        }
+
+        var gameLoop = GameLoop.Instance ?? throw new EfunException("call_other_async() requires an active game loop");
+        var caller = Vm.CurrentObject;
+        if (args[0] is string path && gameLoop.Cluster is { } cluster && !cluster.IsLocal(path))
+        {
+            cluster.Call(path, function, callArgs, caller, callback);
+            return 1L;
+        }
+
+        var target = args[0] as MudObject ?? _objectManager.FindObject((string)args[0]) ?? _objectManager.LoadObject((string)args[0]);
+        var callOtherArgs = new List<object>(callArgs.Count + 2) { target, function };
+        callOtherArgs.AddRange(callArgs);
+        var result = CallOther(callOtherArgs, null);
+        if (callback != null)
+        {
+            gameLoop.ScheduleCallout(caller, callback, new List<object> { result }, 0);
+        }
+        return 1L;
+    }
+
+    /// <summary>
+    /// Run a call_other_async() sent from another cluster node: function in
+    /// the object at path, loaded if need be. Functions call_other() can't
+    /// reach give 0.
+    /// </summary>
+    public object? CallFromNode(string path, string function, List<object> args)
+    {
+        var target = _objectManager.FindObject(path) ?? _objectManager.LoadObject(path);
+        var (func, _) = LookupFunction(target, function, null);
+        if (func == null || !IsExternallyCallable(func))
+        {
+            return 0L;
+        }
+        return CallFunctionOnObject(target, function, args);
+    }
+
+    /// <summary>
+    /// call_other_many(obj, functions, args...) - Call each named function on
+    /// obj with the same arguments, returning their results in order. A
+    /// function obj lacks or can't be called from outside gives 0, as with
+    /// call_other(); so does every function when obj is 0.
+    /// </summary>
+    private object CallOtherManyEfun(List<object> args)
+    {
+        if (args.Count < 2 || args[1] is not List<object> functions)
+        {
+            throw new EfunException("call_other_many() requires an object and an array of function names");
+        }
+
+        var results = new List<object>(functions.Count);
+        if (args[0] is not MudObject target)
+        {
+            if (!IsZero(args[0]))
+            {
+                throw new EfunException("call_other_many() first argument must be an object");
+            }
+            for (int i = 0; i < functions.Count; i++) results.Add(0L);
+            return results;
+        }
+
+        // Parameters are copied into the callee's frame, so one list serves every call
+        var funcArgs = args.Count > 2 ? args.GetRange(2, args.Count - 2) : new List<object>();
+        foreach (var function in functions)
+        {
+            if (function is not string functionName)
+            {
+                throw new EfunException("call_other_many() function names must be strings");
+            }
+            results.Add(CallBatched(target, functionName, funcArgs, null, "call_other_many"));
+        }
+        return results;
+    }
+
+    /// <summary>
+    /// map_call(objects, function, args...) - Call function on each object
+    /// with the same arguments, returning the results in order: the array
+    /// form of call_other(). Entries that aren't live objects give 0.
+    /// </summary>
+    private object MapCallEfun(List<object> args)
+    {
+        if (args.Count < 2 || args[0] is not List<object> targets || args[1] is not string functionName)
+        {
+            throw new EfunException("map_call() requires an array of objects and a function name");
+        }
+
+        var funcArgs = args.Count > 2 ? args.GetRange(2, args.Count - 2) : new List<object>();
+
+        // Objects in one array are mostly of a few programs; one inline cache covers the loop
+        var site = new CallSiteCache();
+        var results = new List<object>(targets.Count);
+        foreach (var item in targets)
+        {
+            results.Add(item is MudObject { IsDestructed: false } target
+                ? CallBatched(target, functionName, funcArgs, site, "map_call")
+                : 0L);
+        }
+        return results;
+    }
+
+    /// <summary>
+    /// One call of a batch, with call_other()'s lookup and visibility rules.
+    /// </summary>
+    private object CallBatched(MudObject target, string functionName, List<object> funcArgs, CallSiteCache? site, string efun)
+    {
+        var (func, owningProgram) = LookupFunction(target, functionName, site);
+        if (func == null || !IsExternallyCallable(func))
+        {
+            return 0L;
+        }
+
+        try
+        {
+            return CallResolved(target, functionName, func, owningProgram, funcArgs) ?? 0L;
+        }
+        catch (Exception ex)
+        {
+            throw new EfunException($"{efun}() failed: {ex.Message}");
+        }
+    }
+
+    /// <summary>
+    /// move_object(destination) or move_object(what, destination)
+    /// Moves an object to a new environment and calls init() hooks.
+    /// Single arg: moves this_object() (or this_player()) to destination
+    /// Two args: moves first arg to second arg
+    /// Returns 1 on success, 0 on failure.
+    ///
+    /// After a successful move, init() is called on:
+    /// 1. The destination (with this_player() = moving object)
+    /// 2. All other objects already in the destination (with this_player() = moving object)
+    /// </summary>
+    private object MoveObjectEfun(List<object> args)
+    {
+        MudObject? what;
+        MudObject? destination;
+
+        if (args.Count == 1)
+        {
+            // Single arg: move this_player() or this_object() to destination
+            var context = ExecutionContext.Current;
+            what = context?.PlayerObject ?? Vm.CurrentObject;
+
+            // Check for 0 (null destination) - could be int or long
+            if ((args[0] is int i && i == 0) || (args[0] is long l && l == 0))
+            {
                 destination = null; // Moving to null (remove from environment)
             }
             else if (args[0] is not MudObject dest)
@@ -2335,7 +2536,15 @@ public class ObjectInterpreter
             return 0L;
         }
 
+        // A player walking into another cluster node's area is handed over to it
+        if (destination != null && what.IsInteractive && GameLoop.Instance is { Cluster: { } cluster } gameLoop &&
+            !cluster.IsLocal(destination.ObjectName) && gameLoop.HandOff(what, destination.ObjectName))
+        {
+            return 1L;
+        }
+
         // Perform the move
+        var from = what.Environment;
         var success = what.MoveTo(destination);
         if (!success)
         {
@@ -2347,16 +2556,29 @@ public class ObjectInterpreter
         {
             CallInitHooks(what, destination);
         }
+        EmitMoveEvents(what, from, destination);
 
         return 1L;
     }
 
     /// <summary>
-    /// Call init() on destination and all other objects in the destination.
+    /// Call init() on the moved object, the destination and all other objects
+    /// in the destination. Only objects whose init() does something are
+    /// called: the moved object and destination by LpcProgram.HasInit, the
+    /// rest from the destination's InitContents, so the objects without one
+    /// aren't even looked at.
     /// this_player() is set to the object that moved during these calls.
     /// </summary>
     private void CallInitHooks(MudObject movedObject, MudObject destination)
     {
+        bool initSelf = movedObject.Program.HasInit;
+        bool initDestination = destination.Program.HasInit;
+        var others = destination.InitContents;
+        if (!initSelf && !initDestination && (others.Count == 0 || (others.Count == 1 && others[0] == movedObject)))
+        {
+            return;
+        }
+
         // Set up execution context with movedObject as this_player()
         var context = ExecutionContext.Current;
         var previousPlayer = context?.PlayerObject;
@@ -2377,21 +2599,27 @@ public class ObjectInterpreter
         try
         {
             // Call init() on the moved object itself (so it can register actions)
-            Logger.Debug($"CallInitHooks: calling init on moved object {movedObject.ObjectName}", LogCategory.LPC);
-            CallInitIfExists(movedObject);
+            if (initSelf)
+            {
+                CallInit(movedObject);
+            }
 
             // Call init() on the destination (e.g., room)
-            Logger.Debug($"CallInitHooks: calling init on destination {destination.ObjectName}", LogCategory.LPC);
-            CallInitIfExists(destination);
+            if (initDestination)
+            {
+                CallInit(destination);
+            }
 
-            // Call init() on all OTHER objects in the destination
-            Logger.Debug($"CallInitHooks: checking {destination.Contents.Count} objects in {destination.ObjectName}", LogCategory.LPC);
-            foreach (var other in destination.Contents)
+            // Call init() on all OTHER objects in the destination. Copied
+            // first: an init() may move things in or out.
+            if (others.Count > 0)
             {
-                if (other != movedObject && !other.IsDestructed)
+                foreach (var other in others.ToArray())
                 {
-                    Logger.Debug($"CallInitHooks: calling init on {other.ObjectName}", LogCategory.LPC);
-                    CallInitIfExists(other);
+                    if (other != movedObject && !other.IsDestructed && other.Environment == destination)
+                    {
+                        CallInit(other);
+                    }
                 }
             }
         }
@@ -2410,25 +2638,14 @@ public class ObjectInterpreter
     }
 
     /// <summary>
-    /// Call init() on an object if it has that function defined.
-    /// Silently does nothing if the function doesn't exist.
+    /// Call init() on an object whose program has one.
     /// </summary>
-    private void CallInitIfExists(MudObject obj)
+    private void CallInit(MudObject obj)
     {
-        var initFunc = obj.FindFunction("init");
-        if (initFunc == null)
-        {
-            return; // No init() function, nothing to do
-        }
-
         try
         {
             CallFunctionOnObject(obj, "init", new List<object>());
         }
-        catch (ReturnException)
-        {
-            // Normal return from init() - ignore
-        }
         catch (Exception ex)
         {
             // Log but don't fail the move
@@ -2555,6 +2772,13 @@ public class ObjectInterpreter
     /// </summary>
     private bool ObjectMatchesName(MudObject obj, string name)
     {
+        // Ids declared with set_ids() answer without running any LPC
+        var declared = obj.MatchDeclaredId(name);
+        if (declared.HasValue)
+        {
+            return declared.Value;
+        }
+
         var idFunc = obj.FindFunction("id");
         if (idFunc == null)
         {
@@ -2567,17 +2791,36 @@ public class ObjectInterpreter
             // Check for non-zero result (could be int or long)
             return (result is int i && i != 0) || (result is long l && l != 0);
         }
-        catch (ReturnException ret)
-        {
-            // Check for non-zero result (could be int or long)
-            return (ret.Value is int i && i != 0) || (ret.Value is long l && l != 0);
-        }
         catch
         {
             return false;
         }
     }
 
+    /// <summary>
+    /// set_ids(ids, [text]) - Declare what this_object()'s id() matches: any
+    /// string in ids exactly (case-insensitively), or any part of text.
+    /// present() then matches the object without calling id(). The
+    /// declaration is ignored, and id() called, for objects that override
+    /// the id() of the program calling set_ids().
+    /// </summary>
+    private object SetIdsEfun(List<object> args)
+    {
+        if (args.Count < 1 || args.Count > 2 || args[0] is not List<object> ids)
+        {
+            throw new EfunException("set_ids() requires an array of ids and an optional match text");
+        }
+        if (ids.Any(id => id is not string))
+        {
+            throw new EfunException("set_ids() ids must be strings");
+        }
+        var text = args.Count == 2 ? args[1] as string : null;
+
+        var declaringProgram = Vm.ExecutingProgram ?? Vm.CurrentObject.Program;
+        Vm.CurrentObject.DeclareIds(ids.Cast<string>(), text, declaringProgram);
+        return 1L;
+    }
+
     /// <summary>
     /// object_name(obj) - Returns the full object name including clone number.
     /// If no argument, returns name of this_object().
@@ -2589,7 +2832,7 @@ public class ObjectInterpreter
 
         if (args.Count == 0)
         {
-            target = _currentObject;
+            target = Vm.CurrentObject;
         }
         else if (args.Count == 1)
         {
@@ -2625,7 +2868,7 @@ public class ObjectInterpreter
 
         if (args.Count == 0)
         {
-            target = _currentObject;
+            target = Vm.CurrentObject;
         }
         else if (args.Count == 1)
         {
@@ -2683,160 +2926,521 @@ public class ObjectInterpreter
             return 0;
         }
 
-        // _callStack has the callers, with the most recent at the top
+        // Vm.CallStack has the callers, with the most recent at the top
         // Skip n entries to get the nth previous object
-        if (n >= _callStack.Count)
+        if (n >= Vm.CallStack.Count)
         {
             return 0;
         }
 
         // Convert stack to array to access by index
-        var callers = _callStack.ToArray();
+        var callers = Vm.CallStack.ToArray();
         return callers[n];
     }
 
-    #region Shadow Efuns
-
     /// <summary>
-    /// shadow(ob) - Make this_object() shadow `ob`.
-    /// Function calls to `ob` will be intercepted by this_object() first.
-    /// Returns 1 on success, 0 on failure.
-    /// Cannot shadow objects that already have shadows, or create circular shadows.
+    /// Players may load public game content (world, std, cmds, help,
+    /// examples); anything else needs Wizard+ and path access.
     /// </summary>
-    private object ShadowEfun(List<object> args)
+    private void RequireLoadAccess(string path, string operation)
     {
-        if (args.Count != 1)
-        {
-            throw new EfunException("shadow() requires exactly 1 argument");
-        }
+        bool isPublicPath = path.StartsWith("/world/") ||
+                           path.StartsWith("/std/") ||
+                           path.StartsWith("/cmds/") ||
+                           path.StartsWith("/help/") ||
+                           path.StartsWith("/examples/");
 
-        if (args[0] is not MudObject target)
+        if (!isPublicPath)
         {
-            if ((args[0] is long l && l == 0) || (args[0] is int i && i == 0))
-            {
-                return 0L; // shadow(0) just returns 0
-            }
-            throw new EfunException("shadow() argument must be an object");
+            RequireAccessLevel(AccessLevel.Wizard, operation);
+            RequirePathAccess(path, operation, isWrite: false);
         }
+    }
 
-        // Cannot shadow self
-        if (target == _currentObject)
-        {
-            return 0L;
-        }
+    #region Room Exit Efuns
 
-        // Cannot shadow if target already has a shadow
-        if (target.ShadowedBy != null)
+    /// <summary>
+    /// set_exit(direction, path, [hidden]) - Set an exit of this_object(),
+    /// replacing any in that direction. A path of 0 or "" removes the exit.
+    /// Short directions ("n", "sw", "u") are stored as their long names.
+    /// </summary>
+    private object SetExitEfun(List<object> args)
+    {
+        if (args.Count < 2 || args.Count > 3 || args[0] is not string direction || direction.Length == 0)
         {
-            return 0L;
+            throw new EfunException("set_exit() requires a direction, a path and an optional hidden flag");
         }
 
-        // Cannot shadow if this object is already shadowing something
-        if (_currentObject.Shadowing != null)
+        var room = Vm.CurrentObject;
+        if (args[1] is not string path || path.Length == 0)
         {
-            return 0L;
+            if (room.Exits?.Remove(direction) != true) return 0L;
+            _objectManager.WorldGraph.Update(room);
+            room.DescriptionChanged();
+            return 1L;
         }
 
-        // Cannot shadow if this object is being shadowed
-        if (_currentObject.ShadowedBy != null)
+        bool hidden = args.Count == 3 && args[2] is long flag && flag != 0;
+        (room.Exits ??= new RoomExits()).Set(direction, path, hidden);
+        _objectManager.WorldGraph.Update(room);
+        room.DescriptionChanged();
+        return 1L;
+    }
+
+    private RoomExits.Exit? FindExit(List<object> args, string efun)
+    {
+        if (args.Count != 2 || args[1] is not string direction)
         {
-            return 0L;
+            throw new EfunException($"{efun}() requires a room and a direction");
         }
+        return (args[0] as MudObject)?.Exits?.Find(direction);
+    }
 
-        // Check for query_prevent_shadow function on target
-        var preventFunc = target.FindFunction("query_prevent_shadow");
-        if (preventFunc != null)
+    /// <summary>
+    /// exit_path(room, direction) - Where an exit leads, as a path, or 0 if
+    /// the room has no exit that way.
+    /// </summary>
+    private object ExitPathEfun(List<object> args)
+    {
+        return (object?)FindExit(args, "exit_path")?.Path ?? 0L;
+    }
+
+    /// <summary>
+    /// exit_destination(room, direction) - The room an exit leads to, loading
+    /// it if need be, or 0 if there is no exit that way. Loading has the same
+    /// access rules as load_object().
+    /// </summary>
+    private object ExitDestinationEfun(List<object> args)
+    {
+        var exit = FindExit(args, "exit_destination");
+        if (exit == null) return 0L;
+
+        if (exit.Destination == null || exit.Destination.IsDestructed)
         {
-            var prevent = CallFunctionOnObject(target, "query_prevent_shadow", new List<object>());
-            if (prevent is int pi && pi != 0)
+            RequireLoadAccess(exit.Path, "exit_destination");
+            try
             {
-                return 0L; // Target prevents shadowing
+                return ((MudObject)args[0]).Exits!.Destination(exit.Direction, _objectManager)!;
             }
-            if (prevent is long pl && pl != 0)
+            catch (Exception ex) when (ex is not EfunException)
             {
-                return 0L;
+                throw new EfunException($"exit_destination(): loading \"{exit.Path}\" failed: {ex.Message}");
             }
         }
+        return exit.Destination;
+    }
 
-        // Set up shadow relationship
-        target.ShadowedBy = _currentObject;
-        _currentObject.Shadowing = target;
-
-        Logger.Debug($"{_currentObject.ObjectName} is now shadowing {target.ObjectName}", LogCategory.Object);
-        return 1L;
+    /// <summary>
+    /// exit_is_hidden(room, direction) - 1 if the room's exit that way is hidden.
+    /// </summary>
+    private object ExitIsHiddenEfun(List<object> args)
+    {
+        return FindExit(args, "exit_is_hidden")?.Hidden == true ? 1L : 0L;
     }
 
     /// <summary>
-    /// query_shadowing(ob) - Returns the object that is shadowing `ob`.
-    /// Returns 0 if not shadowed.
+    /// exit_dirs(room, [all]) - The directions of a room's exits, compass
+    /// directions first. Hidden exits are left out unless all is nonzero.
     /// </summary>
-    private object QueryShadowingEfun(List<object> args)
+    private object ExitDirsEfun(List<object> args)
     {
-        if (args.Count != 1)
+        if (args.Count < 1 || args.Count > 2)
         {
-            throw new EfunException("query_shadowing() requires exactly 1 argument");
+            throw new EfunException("exit_dirs() requires a room and an optional flag");
         }
 
-        if (args[0] is not MudObject target)
+        bool all = args.Count == 2 && args[1] is long flag && flag != 0;
+        var dirs = new List<object>();
+        if (args[0] is MudObject { Exits: { } exits })
         {
-            if ((args[0] is long l && l == 0) || (args[0] is int i && i == 0))
+            foreach (var exit in exits.All)
             {
-                return 0;
+                if (all || !exit.Hidden) dirs.Add(exit.Direction);
             }
-            throw new EfunException("query_shadowing() argument must be an object");
         }
-
-        return target.ShadowedBy ?? (object)0;
+        return dirs;
     }
 
     /// <summary>
-    /// unshadow(ob) - Remove shadow from `ob`.
-    /// Can only be called from the shadowing object itself.
-    /// Returns 1 on success, 0 on failure.
+    /// A room given as an object or a path.
     /// </summary>
-    private object UnshadowEfun(List<object> args)
+    private static string RoomName(object value, string efun)
     {
-        // If no argument, unshadow whatever this_object() is shadowing
-        if (args.Count == 0)
+        return value switch
         {
-            if (_currentObject.Shadowing == null)
-            {
-                return 0L;
-            }
-
-            var target = _currentObject.Shadowing;
-            target.ShadowedBy = null;
-            _currentObject.Shadowing = null;
-
-            Logger.Debug($"{_currentObject.ObjectName} stopped shadowing {target.ObjectName}", LogCategory.Object);
-            return 1L;
-        }
+            MudObject room => room.ObjectName,
+            string path => path,
+            _ => throw new EfunException($"{efun}() requires rooms as objects or paths")
+        };
+    }
 
-        if (args.Count != 1)
+    /// <summary>
+    /// find_path(from, to, [maxdepth]) - The directions of the shortest route
+    /// between two rooms through visible exits, from the world graph; ({ })
+    /// if they are the same room, 0 if there is no route within maxdepth
+    /// steps (default 32).
+    /// </summary>
+    private object FindPathEfun(List<object> args)
+    {
+        if (args.Count < 2 || args.Count > 3)
         {
-            throw new EfunException("unshadow() takes 0 or 1 argument");
+            throw new EfunException("find_path() requires two rooms and an optional depth");
         }
 
-        if (args[0] is not MudObject target2)
-        {
-            if ((args[0] is long l && l == 0) || (args[0] is int i && i == 0))
-            {
-                return 0L;
-            }
-            throw new EfunException("unshadow() argument must be an object");
-        }
+        int maxDepth = args.Count == 3 ? Convert.ToInt32(args[2]) : 32;
+        var path = _objectManager.WorldGraph.FindPath(RoomName(args[0], "find_path"), RoomName(args[1], "find_path"), maxDepth);
+        return path == null ? 0L : path.Cast<object>().ToList();
+    }
 
-        // Only the shadow can unshadow
-        if (_currentObject.Shadowing != target2)
+    /// <summary>
+    /// rooms_within(room, steps) - Paths of the rooms at most steps away
+    /// through visible exits, nearest first, not including room.
+    /// </summary>
+    private object RoomsWithinEfun(List<object> args)
+    {
+        if (args.Count != 2)
         {
-            return 0L;
+            throw new EfunException("rooms_within() requires a room and a number of steps");
         }
 
-        target2.ShadowedBy = null;
-        _currentObject.Shadowing = null;
-
-        Logger.Debug($"{_currentObject.ObjectName} stopped shadowing {target2.ObjectName}", LogCategory.Object);
-        return 1L;
+        return _objectManager.WorldGraph.Within(RoomName(args[0], "rooms_within"), Convert.ToInt32(args[1]))
+            .Cast<object>().ToList();
+    }
+
+    #endregion
+
+    #region Room Render Efuns
+
+    /// <summary>
+    /// room_render(room, viewer) - What look last stored for room, without
+    /// viewer's own line, or 0 if nothing is stored or the room, its contents
+    /// or any of their descriptions have changed since.
+    /// </summary>
+    private object RoomRenderEfun(List<object> args)
+    {
+        if (args.Count != 2 || args[0] is not MudObject room)
+        {
+            throw new EfunException("room_render() requires a room and a viewer");
+        }
+
+        return (object?)_objectManager.RenderCache.Render(room, args[1] as MudObject) ?? 0L;
+    }
+
+    /// <summary>
+    /// set_room_render(room, heading, objects, lines) - Store what look
+    /// rendered for room: its heading, and lines[i] for objects[i]. Lines go
+    /// in the order they are shown.
+    /// </summary>
+    private object SetRoomRenderEfun(List<object> args)
+    {
+        if (args.Count != 4 || args[0] is not MudObject room || args[1] is not string heading ||
+            args[2] is not List<object> objects || args[3] is not List<object> lines || objects.Count != lines.Count)
+        {
+            throw new EfunException("set_room_render() requires a room, a heading and matching arrays of objects and lines");
+        }
+
+        var listed = new List<MudObject>(objects.Count);
+        var text = new List<string>(lines.Count);
+        for (int i = 0; i < objects.Count; i++)
+        {
+            if (objects[i] is not MudObject obj || lines[i] is not string line)
+            {
+                throw new EfunException("set_room_render() requires objects and string lines");
+            }
+            listed.Add(obj);
+            text.Add(line);
+        }
+
+        _objectManager.RenderCache.Store(room, heading, listed, text);
+        return 1L;
+    }
+
+    /// <summary>
+    /// description_changed([ob]) - Note that ob (default this_object()) now
+    /// describes itself differently, so look renders rooms showing it again.
+    /// </summary>
+    private object DescriptionChangedEfun(List<object> args)
+    {
+        var target = args.Count == 0 ? Vm.CurrentObject : args[0] as MudObject;
+        if (args.Count > 1 || target == null)
+        {
+            throw new EfunException("description_changed() takes an optional object");
+        }
+
+        target.DescriptionChanged();
+        return 0L;
+    }
+
+    #endregion
+
+    #region Room Message Efuns
+
+    /// <summary>
+    /// tell_room_tmpl(room, template, [actor], [target], [exclude]) - Tell
+    /// every player in room the template, with $N/$n replaced by actor's name
+    /// (capitalized or lowercase), $P/$p by its possessive, and $T/$t by
+    /// target's name. The actor sees "You"/"you"/"Your"/"your" for its own
+    /// placeholders and the target "You"/"you" for $T/$t. actor and target are
+    /// objects or names; exclude is an object or an array of them. Returns
+    /// the number of players told.
+    /// </summary>
+    private object TellRoomTmplEfun(List<object> args)
+    {
+        if (args.Count is < 2 or > 5 || args[0] is not MudObject room || args[1] is not string template)
+        {
+            throw new EfunException("tell_room_tmpl() requires a room, a template and optional actor, target and exclude");
+        }
+
+        var actor = args.Count > 2 ? args[2] : 0L;
+        var target = args.Count > 3 ? args[3] : 0L;
+        var exclude = args.Count > 4 ? args[4] : 0L;
+
+        var viewers = room.InteractiveContents;
+        if (viewers.Count == 0) return 0L;
+
+        // One rendering for onlookers, and one each for the actor and target when they are watching
+        string? actorName = null, targetName = null, others = null;
+        int told = 0;
+        foreach (var viewer in viewers.ToArray())
+        {
+            if (ReferenceEquals(viewer, exclude) || (exclude is List<object> excluded && excluded.Contains(viewer))) continue;
+
+            string text;
+            if (ReferenceEquals(viewer, actor))
+            {
+                text = FillTemplate(template, null, targetName ??= MessageName(target));
+            }
+            else if (ReferenceEquals(viewer, target))
+            {
+                text = FillTemplate(template, actorName ??= MessageName(actor), null);
+            }
+            else
+            {
+                text = others ??= FillTemplate(template, actorName ??= MessageName(actor), targetName ??= MessageName(target));
+            }
+
+            var context = ExecutionContext.Current;
+            if (context != null && viewer == context.PlayerObject)
+            {
+                context.SendOutput(text);
+            }
+            else
+            {
+                GameLoop.Instance?.SendToPlayer(viewer, text);
+            }
+            told++;
+        }
+        return (long)told;
+    }
+
+    /// <summary>
+    /// What messages call who: a name as given, or an object's query_name()
+    /// (its query_short() if that is empty, else "someone"). An object's name
+    /// is kept until its description changes.
+    /// </summary>
+    private string MessageName(object who)
+    {
+        if (who is string name) return name;
+        if (who is not MudObject obj) return "someone";
+
+        if (obj.CachedMessageName is { } cached && cached.Version == obj.DescriptionVersion) return cached.Name;
+
+        long version = obj.DescriptionVersion;
+        name = CallForName(obj, "query_name") ?? CallForName(obj, "query_short") ?? "someone";
+        obj.CachedMessageName = new MudObject.MessageName(name, version);
+        return name;
+    }
+
+    private string? CallForName(MudObject obj, string function)
+    {
+        if (obj.IsDestructed || obj.FindFunction(function) == null) return null;
+        return CallFunctionOnObject(obj, function, new List<object>()) is string { Length: > 0 } name ? name : null;
+    }
+
+    /// <summary>
+    /// template with its placeholders filled in. A null name is the viewer's
+    /// own, shown as "you".
+    /// </summary>
+    private static string FillTemplate(string template, string? actor, string? target)
+    {
+        int next = template.IndexOf('$');
+        if (next < 0) return template;
+
+        var text = new StringBuilder(template.Length + 32);
+        int start = 0;
+        for (; next >= 0 && next + 1 < template.Length; next = template.IndexOf('$', start))
+        {
+            string? fill = template[next + 1] switch
+            {
+                'N' => actor != null ? Capitalize(actor) : "You",
+                'n' => actor != null ? actor.ToLowerInvariant() : "you",
+                'P' => actor != null ? Capitalize(actor) + "'s" : "Your",
+                'p' => actor != null ? actor.ToLowerInvariant() + "'s" : "your",
+                'T' => target != null ? Capitalize(target) : "You",
+                't' => target != null ? target.ToLowerInvariant() : "you",
+                _ => null
+            };
+            if (fill == null)
+            {
+                text.Append(template, start, next + 1 - start);
+                start = next + 1;
+                continue;
+            }
+            text.Append(template, start, next - start).Append(fill);
+            start = next + 2;
+        }
+        return text.Append(template, start, template.Length - start).ToString();
+    }
+
+    private static string Capitalize(string name)
+    {
+        return name.Length == 0 || char.IsUpper(name[0]) ? name : char.ToUpperInvariant(name[0]) + name[1..];
+    }
+
+    #endregion
+
+    #region Shadow Efuns
+
+    /// <summary>
+    /// shadow(ob) - Make this_object() shadow `ob`.
+    /// Function calls to `ob` will be intercepted by this_object() first.
+    /// Returns 1 on success, 0 on failure.
+    /// Cannot shadow objects that already have shadows, or create circular shadows.
+    /// </summary>
+    private object ShadowEfun(List<object> args)
+    {
+        if (args.Count != 1)
+        {
+            throw new EfunException("shadow() requires exactly 1 argument");
+        }
+
+        if (args[0] is not MudObject target)
+        {
+            if ((args[0] is long l && l == 0) || (args[0] is int i && i == 0))
+            {
+                return 0L; // shadow(0) just returns 0
+            }
+            throw new EfunException("shadow() argument must be an object");
+        }
+
+        // Cannot shadow self
+        if (target == Vm.CurrentObject)
+        {
+            return 0L;
+        }
+
+        // Cannot shadow if target already has a shadow
+        if (target.ShadowedBy != null)
+        {
+            return 0L;
+        }
+
+        // Cannot shadow if this object is already shadowing something
+        if (Vm.CurrentObject.Shadowing != null)
+        {
+            return 0L;
+        }
+
+        // Cannot shadow if this object is being shadowed
+        if (Vm.CurrentObject.ShadowedBy != null)
+        {
+            return 0L;
+        }
+
+        // Check for query_prevent_shadow function on target
+        var preventFunc = target.FindFunction("query_prevent_shadow");
+        if (preventFunc != null)
+        {
+            var prevent = CallFunctionOnObject(target, "query_prevent_shadow", new List<object>());
+            if (prevent is int pi && pi != 0)
+            {
+                return 0L; // Target prevents shadowing
+            }
+            if (prevent is long pl && pl != 0)
+            {
+                return 0L;
+            }
+        }
+
+        // Set up shadow relationship
+        target.ShadowedBy = Vm.CurrentObject;
+        Vm.CurrentObject.Shadowing = target;
+
+        Logger.Debug($"{Vm.CurrentObject.ObjectName} is now shadowing {target.ObjectName}", LogCategory.Object);
+        return 1L;
+    }
+
+    /// <summary>
+    /// query_shadowing(ob) - Returns the object that is shadowing `ob`.
+    /// Returns 0 if not shadowed.
+    /// </summary>
+    private object QueryShadowingEfun(List<object> args)
+    {
+        if (args.Count != 1)
+        {
+            throw new EfunException("query_shadowing() requires exactly 1 argument");
+        }
+
+        if (args[0] is not MudObject target)
+        {
+            if ((args[0] is long l && l == 0) || (args[0] is int i && i == 0))
+            {
+                return 0;
+            }
+            throw new EfunException("query_shadowing() argument must be an object");
+        }
+
+        return target.ShadowedBy ?? (object)0;
+    }
+
+    /// <summary>
+    /// unshadow(ob) - Remove shadow from `ob`.
+    /// Can only be called from the shadowing object itself.
+    /// Returns 1 on success, 0 on failure.
+    /// </summary>
+    private object UnshadowEfun(List<object> args)
+    {
+        // If no argument, unshadow whatever this_object() is shadowing
+        if (args.Count == 0)
+        {
+            if (Vm.CurrentObject.Shadowing == null)
+            {
+                return 0L;
+            }
+
+            var target = Vm.CurrentObject.Shadowing;
+            target.ShadowedBy = null;
+            Vm.CurrentObject.Shadowing = null;
+
+            Logger.Debug($"{Vm.CurrentObject.ObjectName} stopped shadowing {target.ObjectName}", LogCategory.Object);
+            return 1L;
+        }
+
+        if (args.Count != 1)
+        {
+            throw new EfunException("unshadow() takes 0 or 1 argument");
+        }
+
+        if (args[0] is not MudObject target2)
+        {
+            if ((args[0] is long l && l == 0) || (args[0] is int i && i == 0))
+            {
+                return 0L;
+            }
+            throw new EfunException("unshadow() argument must be an object");
+        }
+
+        // Only the shadow can unshadow
+        if (Vm.CurrentObject.Shadowing != target2)
+        {
+            return 0L;
+        }
+
+        target2.ShadowedBy = null;
+        Vm.CurrentObject.Shadowing = null;
+
+        Logger.Debug($"{Vm.CurrentObject.ObjectName} stopped shadowing {target2.ObjectName}", LogCategory.Object);
+        return 1L;
     }
 
     #endregion
@@ -2859,7 +3463,7 @@ public class ObjectInterpreter
             flag = l != 0;
         else if (args[0] is int i)
             flag = i != 0;
-        _currentObject.IsLiving = flag;
+        Vm.CurrentObject.IsLiving = flag;
         return flag ? 1L : 0L;
     }
 
@@ -2903,7 +3507,7 @@ public class ObjectInterpreter
             throw new EfunException("set_living_name() argument must be a string");
         }
 
-        _objectManager.SetLivingName(_currentObject, name);
+        _objectManager.SetLivingName(Vm.CurrentObject, name);
         return 1;
     }
 
@@ -2917,7 +3521,7 @@ public class ObjectInterpreter
 
         if (args.Count == 0)
         {
-            target = _currentObject;
+            target = Vm.CurrentObject;
         }
         else if (args.Count == 1)
         {
@@ -2952,7 +3556,7 @@ public class ObjectInterpreter
 
         if (args.Count == 0)
         {
-            target = _currentObject;
+            target = Vm.CurrentObject;
         }
         else if (args.Count == 1)
         {
@@ -3015,6 +3619,47 @@ public class ObjectInterpreter
         return _objectManager.FindPlayer(name) ?? (object)0;
     }
 
+    /// <summary>
+    /// match_living(prefix, players_only?) - Livings whose names begin with
+    /// prefix (case-insensitive), sorted by name; only interactive players if
+    /// players_only is non-zero. match_living("") lists every living.
+    /// </summary>
+    private object MatchLivingEfun(List<object> args)
+    {
+        var (prefix, playersOnly) = LivingNameArgs("match_living", args);
+        return _objectManager.MatchLivings(prefix, playersOnly).Cast<object>().ToList();
+    }
+
+    /// <summary>
+    /// resolve_living(abbrev, players_only?) - The living an abbreviated name
+    /// means: the one of exactly that name, else the only one whose name
+    /// begins with it. 0 if none does; an array of the candidates if several do.
+    /// </summary>
+    private object ResolveLivingEfun(List<object> args)
+    {
+        var (abbreviation, playersOnly) = LivingNameArgs("resolve_living", args);
+        if (abbreviation.Length == 0) return 0L;
+
+        var (match, candidates) = _objectManager.ResolveLiving(abbreviation, playersOnly);
+        if (match != null) return match;
+        return candidates.Count == 0 ? 0L : candidates.Cast<object>().ToList();
+    }
+
+    private (string Name, bool PlayersOnly) LivingNameArgs(string efun, List<object> args)
+    {
+        if (args.Count is < 1 or > 2)
+        {
+            throw new EfunException($"{efun}() requires 1 or 2 arguments");
+        }
+
+        if (args[0] is not string name)
+        {
+            throw new EfunException($"{efun}() first argument must be a string");
+        }
+
+        return (name, args.Count == 2 && IsTrue(args[1]));
+    }
+
     /// <summary>
     /// users() - Get an array of all connected players.
     /// Returns an array of player objects.
@@ -3030,28 +3675,175 @@ public class ObjectInterpreter
     }
 
     /// <summary>
-    /// linkdead_users() - Return an array of all linkdead player objects.
-    /// These are players whose connection was lost but are still in the game.
+    /// cluster_users() - Players logged in on other cluster nodes: a mapping
+    /// of lower-case name to node name. Empty when the driver runs alone.
     /// </summary>
-    private object LinkdeadUsersEfun(List<object> args)
+    private object ClusterUsersEfun(List<object> args)
     {
         if (args.Count != 0)
         {
-            throw new EfunException("linkdead_users() takes no arguments");
+            throw new EfunException("cluster_users() takes no arguments");
         }
 
-        var gameLoop = GameLoop.Instance;
-        if (gameLoop == null)
+        var users = new LpcMapping();
+        if (GameLoop.Instance?.Cluster is { } cluster)
         {
-            return new List<object>();
+            foreach (var (name, node) in cluster.RemoteUsers)
+            {
+                users[name] = node;
+            }
         }
+        return users;
+    }
 
-        return gameLoop.GetLinkdeadSessions()
-            .Where(s => s.PlayerObject != null && !s.PlayerObject.IsDestructed)
+    /// <summary>
+    /// linkdead_users() - Return an array of all linkdead player objects.
+    /// These are players whose connection was lost but are still in the game.
+    /// </summary>
+    private object LinkdeadUsersEfun(List<object> args)
+    {
+        if (args.Count != 0)
+        {
+            throw new EfunException("linkdead_users() takes no arguments");
+        }
+
+        var gameLoop = GameLoop.Instance;
+        if (gameLoop == null)
+        {
+            return new List<object>();
+        }
+
+        return gameLoop.GetLinkdeadSessions()
+            .Where(s => s.PlayerObject != null && !s.PlayerObject.IsDestructed)
             .Select(s => (object)s.PlayerObject!)
             .ToList();
     }
 
+    /// <summary>
+    /// query_lag() - How far behind the game loop is running.
+    /// Returns a mapping:
+    ///   "lag_ms": smoothed tick lateness plus heartbeat time owed
+    ///   "heartbeats_behind": heartbeat turns (ticks) owed from earlier ticks
+    ///   "resets_waiting": resets due but put off for busier work
+    ///   "deferrals": deferrable jobs put off since boot
+    /// Returns 0 when not running under the game loop.
+    /// </summary>
+    private object QueryLagEfun(List<object> args)
+    {
+        if (args.Count != 0)
+        {
+            throw new EfunException("query_lag() takes no arguments");
+        }
+
+        var gameLoop = GameLoop.Instance;
+        if (gameLoop == null)
+        {
+            return 0L;
+        }
+
+        return new LpcMapping
+        {
+            ["lag_ms"] = gameLoop.Budget.LagMs,
+            ["heartbeats_behind"] = (long)gameLoop.Budget.HeartbeatsBehind,
+            ["resets_waiting"] = (long)gameLoop.WaitingResets,
+            ["deferrals"] = gameLoop.Budget.Deferrals
+        };
+    }
+
+    /// <summary>
+    /// set_attacking(target) - Record that this_object() is fighting target,
+    /// or nothing with 0. Returns 1 if target is now the opponent.
+    /// </summary>
+    private object SetAttackingEfun(List<object> args)
+    {
+        if (args.Count != 1)
+        {
+            throw new EfunException("set_attacking() requires exactly 1 argument");
+        }
+
+        var self = Vm.CurrentObject;
+        if (args[0] is MudObject target)
+        {
+            if (target == self || target.IsDestructed)
+            {
+                return 0L;
+            }
+            self.SetCombatTarget(target);
+            return 1L;
+        }
+
+        if (args[0] is long l && l == 0)
+        {
+            self.SetCombatTarget(null);
+            return 0L;
+        }
+
+        throw new EfunException("set_attacking() argument must be an object or 0");
+    }
+
+    /// <summary>
+    /// query_attacking(ob) - What ob (default this_object()) is fighting, or 0.
+    /// </summary>
+    private object QueryAttackingEfun(List<object> args)
+    {
+        if (args.Count > 1)
+        {
+            throw new EfunException("query_attacking() takes 0 or 1 argument");
+        }
+
+        var obj = args.Count == 0 ? Vm.CurrentObject : args[0] as MudObject;
+        if (obj == null)
+        {
+            throw new EfunException("query_attacking() argument must be an object");
+        }
+
+        return (object?)obj.CombatTarget ?? 0L;
+    }
+
+    /// <summary>
+    /// query_attackers(ob) - Array of objects in ob's room that are fighting
+    /// ob, in the order they started.
+    /// </summary>
+    private object QueryAttackersEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not MudObject obj)
+        {
+            throw new EfunException("query_attackers() requires an object argument");
+        }
+
+        var result = new List<object>();
+        foreach (var attacker in obj.Attackers)
+        {
+            if (attacker.Environment == obj.Environment && obj.Environment != null && !attacker.IsDestructed)
+            {
+                result.Add(attacker);
+            }
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// hostile_in_room(room) - Array of livings in room fighting something
+    /// that's also in room, in inventory order.
+    /// </summary>
+    private object HostileInRoomEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not MudObject room)
+        {
+            throw new EfunException("hostile_in_room() requires an object argument");
+        }
+
+        var result = new List<object>();
+        foreach (var living in room.LivingContents)
+        {
+            if (living.CombatTarget?.Environment == room)
+            {
+                result.Add(living);
+            }
+        }
+        return result;
+    }
+
     /// <summary>
     /// query_linkdead(object) - Check if an object is a linkdead player.
     /// Returns 1 if linkdead, 0 otherwise.
@@ -3079,6 +3871,185 @@ public class ObjectInterpreter
             .Any(s => s.PlayerObject == obj) ? 1L : 0L;
     }
 
+    /// <summary>
+    /// The channel_* and history_* efuns belong to daemons: only objects
+    /// under /secure (or admin code) may change who hears a channel, publish
+    /// to it, or write a history.
+    /// </summary>
+    private void RequireSecureCaller(string operation)
+    {
+        var caller = Vm.CurrentObject;
+        if (caller != null && IsSecurePath(caller.FilePath)) return;
+        RequireAccessLevel(AccessLevel.Admin, operation);
+    }
+
+    private static string ChannelName(List<object> args, int count, string operation)
+    {
+        if (args.Count != count)
+        {
+            throw new EfunException($"{operation}() requires {count} argument{(count == 1 ? "" : "s")}");
+        }
+        if (args[0] is not string channel || channel == "")
+        {
+            throw new EfunException($"{operation}() first argument must be a channel name");
+        }
+        return channel;
+    }
+
+    /// <summary>
+    /// channel_subscribe(channel, object) - Add an object to a channel's
+    /// subscribers. Returns 1 if added, 0 if it was already subscribed.
+    /// </summary>
+    private object ChannelSubscribeEfun(List<object> args)
+    {
+        var channel = ChannelName(args, 2, "channel_subscribe");
+        if (args[1] is not MudObject obj)
+        {
+            throw new EfunException("channel_subscribe() second argument must be an object");
+        }
+        RequireSecureCaller("channel_subscribe");
+
+        return _objectManager.Channels.Subscribe(channel, obj) ? 1L : 0L;
+    }
+
+    /// <summary>
+    /// channel_unsubscribe(channel, object) - Remove an object from a channel.
+    /// Returns 1 if removed, 0 if it wasn't subscribed.
+    /// </summary>
+    private object ChannelUnsubscribeEfun(List<object> args)
+    {
+        var channel = ChannelName(args, 2, "channel_unsubscribe");
+        if (args[1] is not MudObject obj)
+        {
+            throw new EfunException("channel_unsubscribe() second argument must be an object");
+        }
+        RequireSecureCaller("channel_unsubscribe");
+
+        return _objectManager.Channels.Unsubscribe(channel, obj) ? 1L : 0L;
+    }
+
+    /// <summary>
+    /// channel_subscribers(channel) - Array of a channel's subscribers, in the
+    /// order they subscribed.
+    /// </summary>
+    private object ChannelSubscribersEfun(List<object> args)
+    {
+        var channel = ChannelName(args, 1, "channel_subscribers");
+
+        return _objectManager.Channels.GetSubscribers(channel).Cast<object>().ToList();
+    }
+
+    /// <summary>
+    /// channel_publish(channel, message) - Send message to every connected
+    /// subscriber of a channel. Returns the number of players reached.
+    /// </summary>
+    private object ChannelPublishEfun(List<object> args)
+    {
+        var channel = ChannelName(args, 2, "channel_publish");
+        if (args[1] is not string message)
+        {
+            throw new EfunException("channel_publish() second argument must be a string");
+        }
+        RequireSecureCaller("channel_publish");
+
+        var gameLoop = GameLoop.Instance;
+        if (gameLoop == null)
+        {
+            return 0L;
+        }
+        return (long)_objectManager.Channels.Publish(channel, message, gameLoop.SendToPlayer);
+    }
+
+    /// <summary>
+    /// channel_remove(channel) - Drop a channel and all its subscribers.
+    /// </summary>
+    private object ChannelRemoveEfun(List<object> args)
+    {
+        var channel = ChannelName(args, 1, "channel_remove");
+        RequireSecureCaller("channel_remove");
+
+        _objectManager.Channels.Remove(channel);
+        return 1L;
+    }
+
+    /// <summary>
+    /// history_open(name, path, capacity) - Create or resize the history
+    /// called name, keeping its newest capacity entries. With a path (0 for
+    /// none) it is logged there, and entries already in the file are loaded
+    /// the first time. Returns the number of entries held.
+    /// </summary>
+    private object HistoryOpenEfun(List<object> args)
+    {
+        if (args.Count != 3)
+        {
+            throw new EfunException("history_open() requires 3 arguments (name, path, capacity)");
+        }
+        if (args[0] is not string name || name == "")
+        {
+            throw new EfunException("history_open() first argument must be a name");
+        }
+        var path = args[1] as string;
+        if (path == null && !(args[1] is long or int && Convert.ToInt64(args[1]) == 0))
+        {
+            throw new EfunException("history_open() second argument must be a path or 0");
+        }
+        int capacity = Convert.ToInt32(args[2]);
+        if (capacity <= 0)
+        {
+            throw new EfunException("history_open() capacity must be positive");
+        }
+        RequireSecureCaller("history_open");
+
+        var log = _objectManager.Histories.GetOrAdd(name, _ => new HistoryLog(capacity));
+        log.Resize(capacity);
+        if (!string.IsNullOrEmpty(path))
+        {
+            var fullPath = ResolveMudlibPath(path);
+            if (log.FullPath != fullPath)
+            {
+                log.Attach(fullPath);
+            }
+        }
+        return (long)log.Count;
+    }
+
+    /// <summary>
+    /// history_add(name, value) - Add an entry to an open history, dropping
+    /// the oldest if it is full. Returns the number of entries held.
+    /// </summary>
+    private object HistoryAddEfun(List<object> args)
+    {
+        if (args.Count != 2 || args[0] is not string name)
+        {
+            throw new EfunException("history_add() requires 2 arguments (name, value)");
+        }
+        RequireSecureCaller("history_add");
+
+        if (!_objectManager.Histories.TryGetValue(name, out var log))
+        {
+            throw new EfunException($"history_add(): no history '{name}' (call history_open first)");
+        }
+        log.Add(args[1]);
+        return (long)log.Count;
+    }
+
+    /// <summary>
+    /// history_get(name, count) - The newest count entries of a history
+    /// (all if count is 0), oldest first. Unknown names give an empty array.
+    /// </summary>
+    private object HistoryGetEfun(List<object> args)
+    {
+        if (args.Count < 1 || args.Count > 2 || args[0] is not string name)
+        {
+            throw new EfunException("history_get() requires a name and an optional count");
+        }
+        int count = args.Count == 2 ? Convert.ToInt32(args[1]) : 0;
+
+        return _objectManager.Histories.TryGetValue(name, out var log)
+            ? log.GetLast(count)
+            : new List<object>();
+    }
+
     #endregion
 
     #region Heartbeat Efuns
@@ -3096,7 +4067,7 @@ public class ObjectInterpreter
         }
 
         var flag = Convert.ToInt32(args[0]);
-        var obj = _currentObject;
+        var obj = Vm.CurrentObject;
         var wasEnabled = obj.HeartbeatEnabled;
 
         if (flag != 0)
@@ -3126,7 +4097,7 @@ public class ObjectInterpreter
 
         if (args.Count == 0)
         {
-            obj = _currentObject;
+            obj = Vm.CurrentObject;
         }
         else if (args.Count == 1)
         {
@@ -3144,6 +4115,21 @@ public class ObjectInterpreter
         return obj.HeartbeatEnabled ? 1L : 0L;
     }
 
+    /// <summary>
+    /// query_dormant_elapsed() - Seconds this_object() slept in an empty room
+    /// before the current heartbeat, or 0 if it was awake. Lets heart_beat()
+    /// apply regeneration and other per-beat effects for the time it missed.
+    /// </summary>
+    private object QueryDormantElapsedEfun(List<object> args)
+    {
+        if (args.Count != 0)
+        {
+            throw new EfunException("query_dormant_elapsed() takes no arguments");
+        }
+
+        return (long)Vm.CurrentObject.DormantElapsedSeconds;
+    }
+
     #endregion
 
     #region Reset Efuns
@@ -3162,7 +4148,7 @@ public class ObjectInterpreter
         }
 
         var seconds = Convert.ToInt32(args[0]);
-        var obj = _currentObject;
+        var obj = Vm.CurrentObject;
         var wasEnabled = obj.ResetInterval;
 
         var gameLoop = GameLoop.Instance;
@@ -3192,7 +4178,7 @@ public class ObjectInterpreter
 
         if (args.Count == 0)
         {
-            obj = _currentObject;
+            obj = Vm.CurrentObject;
         }
         else if (args.Count == 1)
         {
@@ -3211,6 +4197,84 @@ public class ObjectInterpreter
         return (long)(gameLoop?.GetResetInterval(obj) ?? 0);
     }
 
+    /// <summary>
+    /// set_spawn(path, count) - Keep count clones of path spawned from
+    /// this_object(); 0 stops spawning it. respawn() clones what is missing.
+    /// Clones count while they live, wherever they wander.
+    /// </summary>
+    private object SetSpawnEfun(List<object> args)
+    {
+        if (args.Count != 2 || args[0] is not string path || args[1] is not (long or int))
+        {
+            throw new EfunException("set_spawn() requires a string path and an int count");
+        }
+
+        // The same paths clone_object() lets anyone clone
+        if (!path.StartsWith("/world/") && !path.StartsWith("/std/"))
+        {
+            RequireAccessLevel(AccessLevel.Wizard, "set_spawn");
+            RequirePathAccess(path, "set_spawn", isWrite: false);
+        }
+
+        _objectManager.Spawns.Set(Vm.CurrentObject, path, (int)Math.Clamp(Convert.ToInt64(args[1]), 0, 1000));
+        return 0L;
+    }
+
+    /// <summary>
+    /// respawn() - Queue this_object() to have its missing spawns cloned and
+    /// moved into it, a batch per tick. respawn(1) clones them now, as for a
+    /// room being loaded. Returns how many clones were missing.
+    /// </summary>
+    private object RespawnEfun(List<object> args)
+    {
+        if (args.Count > 1 || (args.Count == 1 && args[0] is not (long or int)))
+        {
+            throw new EfunException("respawn() takes an optional int argument");
+        }
+
+        var room = Vm.CurrentObject;
+        var spawns = _objectManager.Spawns;
+        bool now = args.Count == 1 && Convert.ToInt64(args[0]) != 0;
+
+        // Without a game loop nothing would ever run the queue
+        if (now || GameLoop.Instance == null)
+        {
+            return (long)spawns.Refill(room, int.MaxValue, SpawnInto);
+        }
+        return (long)spawns.Request(room);
+    }
+
+    /// <summary>
+    /// query_spawned() or query_spawned(path) - The live clones this_object()
+    /// spawned, of every spawn or of path.
+    /// </summary>
+    private object QuerySpawnedEfun(List<object> args)
+    {
+        if (args.Count > 1 || (args.Count == 1 && args[0] is not string))
+        {
+            throw new EfunException("query_spawned() takes an optional string path");
+        }
+
+        return _objectManager.Spawns.Live(Vm.CurrentObject, args.Count == 1 ? (string)args[0] : null)
+            .Cast<object>()
+            .ToList();
+    }
+
+    /// <summary>
+    /// Clone path and move the clone into room, calling init() and emitting
+    /// "enter" as move_object() does. Used for spawns.
+    /// </summary>
+    public MudObject SpawnInto(string path, MudObject room)
+    {
+        var clone = _objectManager.CloneObject(path);
+        if (clone.MoveTo(room))
+        {
+            CallInitHooks(clone, room);
+            EmitMoveEvents(clone, null, room);
+        }
+        return clone;
+    }
+
     #endregion
 
     #region Callout Efuns
@@ -3250,7 +4314,7 @@ public class ObjectInterpreter
             throw new EfunException("call_out() requires an active game loop");
         }
 
-        return gameLoop.ScheduleCallout(_currentObject, function, callArgs, delay);
+        return gameLoop.ScheduleCallout(Vm.CurrentObject, function, callArgs, delay);
     }
 
     /// <summary>
@@ -3274,7 +4338,7 @@ public class ObjectInterpreter
 
         if (args[0] is string function)
         {
-            return gameLoop.RemoveCalloutByFunction(_currentObject, function);
+            return gameLoop.RemoveCalloutByFunction(Vm.CurrentObject, function);
         }
         else if (args[0] is long calloutIdLong)
         {
@@ -3312,187 +4376,664 @@ public class ObjectInterpreter
             return -1;
         }
 
-        return gameLoop.FindCallout(_currentObject, function);
+        return gameLoop.FindCallout(Vm.CurrentObject, function);
     }
 
     #endregion
 
-    #region Array Callback Efuns
+    #region Coroutine Efuns
 
     /// <summary>
-    /// filter_array(arr, func) - Filter an array using a callback function.
-    /// Returns a new array containing only elements where func(element) returns non-zero.
-    /// func can be a string (function name in this_object) or an object#function pair.
+    /// start_coroutine(function, args...) - Call function(args) in
+    /// this_object() as a coroutine from the next tick. It may yield() or
+    /// sleep() to carry on in a later tick with a fresh instruction budget.
+    /// Returns its id, or 0 if too many coroutines are running.
     /// </summary>
-    private object FilterArrayEfun(List<object> args)
+    private object StartCoroutineEfun(List<object> args)
     {
-        if (args.Count < 2)
+        if (args.Count < 1 || args[0] is not string function)
         {
-            throw new EfunException("filter_array() requires at least 2 arguments");
+            throw new EfunException("start_coroutine() first argument must be a function name string");
         }
 
-        if (args[0] is not List<object> arr)
+        var gameLoop = GameLoop.Instance ?? throw new EfunException("start_coroutine() requires an active game loop");
+        if (Vm.CurrentObject.FindFunction(function) == null)
         {
-            throw new EfunException("filter_array() first argument must be an array");
+            throw new EfunException($"start_coroutine() function {function} not found in {Vm.CurrentObject.ObjectName}");
         }
+        return (long)gameLoop.StartCoroutine(Vm.CurrentObject, function, args.Skip(1).ToList());
+    }
 
-        var result = new List<object>();
-        string funcName;
-        MudObject? targetObj = null;
-
-        // Parse the callback specification
-        if (args[1] is string fn)
+    /// <summary>
+    /// stop_coroutine(id) - Unwind a coroutine this_object() started, at its
+    /// next resume. Returns 1, or 0 if there is no such coroutine.
+    /// </summary>
+    private object StopCoroutineEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not long id)
         {
-            funcName = fn;
-            targetObj = _currentObject;
+            throw new EfunException("stop_coroutine() requires a coroutine id");
         }
-        else
+
+        var gameLoop = GameLoop.Instance;
+        return gameLoop != null && gameLoop.Coroutines.Stop(Vm.CurrentObject, (int)id) ? 1L : 0L;
+    }
+
+    /// <summary>
+    /// yield() - Suspend the running coroutine until the next tick.
+    /// </summary>
+    private object YieldEfun(List<object> args)
+    {
+        if (args.Count != 0)
         {
-            throw new EfunException("filter_array() callback must be a function name string");
+            throw new EfunException("yield() takes no arguments");
         }
+        Suspend(1, "yield");
+        return 0L;
+    }
 
-        // Collect any extra arguments to pass to callback
-        var extraArgs = new List<object>();
-        for (int i = 2; i < args.Count; i++)
+    /// <summary>
+    /// sleep(ticks) - Suspend the running coroutine for ticks game ticks
+    /// (at least 1).
+    /// </summary>
+    private object SleepEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not long ticks || ticks < 1)
         {
-            extraArgs.Add(args[i]);
+            throw new EfunException("sleep() requires a number of ticks of at least 1");
         }
+        Suspend((int)Math.Min(ticks, int.MaxValue), "sleep");
+        return 0L;
+    }
 
-        // Filter each element
-        foreach (var item in arr)
+    private void Suspend(int ticks, string efun)
+    {
+        if (!Coroutines.Suspend(ticks))
         {
-            var callArgs = new List<object> { item };
-            callArgs.AddRange(extraArgs);
+            throw new EfunException($"{efun}() can only be called in a coroutine");
+        }
+        ResetInstructionCount();
+    }
 
-            try
-            {
-                var callResult = CallFunctionOnObject(targetObj, funcName, callArgs);
+    #endregion
 
-                // Non-zero result means keep the element
-                bool keep = false;
-                if (callResult is int i)
-                {
-                    keep = i != 0;
-                }
-                else if (callResult != null)
-                {
-                    keep = true;
-                }
+    #region Event Efuns
 
-                if (keep)
-                {
-                    result.Add(item);
-                }
+    /// <summary>
+    /// Events the driver emits itself: move (from whatever moved), enter and
+    /// leave (from a container, as things move in and out of it) and login
+    /// and logout (from a player). emit() can't fake them.
+    /// </summary>
+    private static readonly HashSet<string> DriverEvents = new() { "move", "enter", "leave", "login", "logout" };
+
+    /// <summary>
+    /// Call the subscribers to eventName from source, then those listening
+    /// to every source, each as fn(source, args...). A subscriber's error is
+    /// logged and the rest are still called. Returns the number called.
+    /// </summary>
+    internal int EmitEvent(MudObject source, string eventName, params object[] args)
+    {
+        var events = _objectManager.Events;
+        if (!events.HasSubscribers(eventName)) return 0;
+
+        return Dispatch(events.For(source, eventName), source, eventName, args) +
+               Dispatch(events.For(null, eventName), source, eventName, args);
+    }
+
+    private int Dispatch(EventBus.Subscription[] subscriptions, MudObject source, string eventName, object[] args)
+    {
+        int called = 0;
+        foreach (var (subscriber, function) in subscriptions)
+        {
+            if (subscriber.IsDestructed) continue;
+
+            var callArgs = new List<object>(args.Length + 1) { source };
+            callArgs.AddRange(args);
+            try
+            {
+                CallFunctionOnObject(subscriber, function, callArgs);
+                called++;
             }
-            catch (ReturnException ex)
+            catch (Exception ex)
             {
-                // Handle return value
-                bool keep = false;
-                if (ex.Value is int i)
-                {
-                    keep = i != 0;
-                }
-                else if (ex.Value != null)
-                {
-                    keep = true;
-                }
+                Logger.Warning($"{eventName} handler {subscriber.ObjectName}->{function}() threw: {ex.Message}", LogCategory.Object);
+            }
+        }
+        return called;
+    }
 
-                if (keep)
-                {
-                    result.Add(item);
-                }
+    /// <summary>
+    /// The events of a move from one environment to another: move from what
+    /// moved (first, so an object following its own moves is settled before
+    /// the rooms hear), then leave and enter.
+    /// </summary>
+    private void EmitMoveEvents(MudObject what, MudObject? from, MudObject? to)
+    {
+        EmitEvent(what, "move", (object?)from ?? 0L, (object?)to ?? 0L);
+        if (from != null && from != to)
+        {
+            EmitEvent(from, "leave", what, (object?)to ?? 0L);
+        }
+        if (to != null && from != to)
+        {
+            EmitEvent(to, "enter", what, (object?)from ?? 0L);
+        }
+    }
+
+    /// <summary>
+    /// The source argument of subscribe() and unsubscribe(): an object, or 0
+    /// for every source.
+    /// </summary>
+    private static MudObject? EventSource(object arg, string operation)
+    {
+        return arg switch
+        {
+            MudObject obj => obj,
+            long or int when Convert.ToInt64(arg) == 0 => null,
+            _ => throw new EfunException($"{operation}() first argument must be an object or 0")
+        };
+    }
+
+    private static string EventName(object arg, string operation)
+    {
+        if (arg is not string name || name == "")
+        {
+            throw new EfunException($"{operation}() second argument must be an event name");
+        }
+        return name;
+    }
+
+    /// <summary>
+    /// subscribe(source, event, fn) - Have this_object()->fn(source, args...)
+    /// called whenever source emits event; a source of 0 means any object.
+    /// Returns 1 if subscribed, 0 if it already was.
+    /// </summary>
+    private object SubscribeEfun(List<object> args)
+    {
+        if (args.Count != 3)
+        {
+            throw new EfunException("subscribe() requires 3 arguments: source, event and function");
+        }
+        var source = EventSource(args[0], "subscribe");
+        var eventName = EventName(args[1], "subscribe");
+        if (args[2] is not string function)
+        {
+            throw new EfunException("subscribe() third argument must be a function name");
+        }
+
+        var subscriber = Vm.CurrentObject ?? throw new EfunException("subscribe() needs a current object");
+        if (subscriber.FindFunction(function) == null)
+        {
+            throw new EfunException($"subscribe(): no function {function}() in {subscriber.ObjectName}");
+        }
+        return _objectManager.Events.Subscribe(source, eventName, subscriber, function) ? 1L : 0L;
+    }
+
+    /// <summary>
+    /// unsubscribe(source, event) or unsubscribe(source, event, fn) - Drop
+    /// this_object()'s subscriptions to event from source (0 for the ones to
+    /// any source), or only the one calling fn. Returns how many went.
+    /// </summary>
+    private object UnsubscribeEfun(List<object> args)
+    {
+        if (args.Count is < 2 or > 3)
+        {
+            throw new EfunException("unsubscribe() requires 2 or 3 arguments: source, event and optional function");
+        }
+        var source = EventSource(args[0], "unsubscribe");
+        var eventName = EventName(args[1], "unsubscribe");
+        string? function = null;
+        if (args.Count == 3)
+        {
+            function = args[2] as string ?? throw new EfunException("unsubscribe() third argument must be a function name");
+        }
+
+        var subscriber = Vm.CurrentObject;
+        if (subscriber == null) return 0L;
+        return (long)_objectManager.Events.Unsubscribe(source, eventName, subscriber, function);
+    }
+
+    /// <summary>
+    /// emit(event, args...) - Call every subscriber to event from
+    /// this_object(), and every one listening to any source, as
+    /// fn(this_object(), args...). Returns the number called.
+    /// </summary>
+    private object EmitEfun(List<object> args)
+    {
+        if (args.Count < 1 || args[0] is not string eventName || eventName == "")
+        {
+            throw new EfunException("emit() first argument must be an event name");
+        }
+        if (DriverEvents.Contains(eventName))
+        {
+            throw new EfunException($"emit(): \"{eventName}\" is emitted by the driver");
+        }
+
+        var source = Vm.CurrentObject;
+        if (source == null) return 0L;
+        return (long)EmitEvent(source, eventName, args.Skip(1).ToArray());
+    }
+
+    /// <summary>
+    /// query_subscriptions() or query_subscriptions(ob) - What an object
+    /// (this_object() by default) has subscribed to, as
+    /// ({ ({ source or 0, event, function }), ... }).
+    /// </summary>
+    private object QuerySubscriptionsEfun(List<object> args)
+    {
+        if (args.Count > 1 || (args.Count == 1 && args[0] is not MudObject))
+        {
+            throw new EfunException("query_subscriptions() takes an optional object");
+        }
+
+        var obj = args.Count == 1 ? (MudObject)args[0] : Vm.CurrentObject;
+        if (obj == null) return new List<object>();
+        return _objectManager.Events.SubscriptionsOf(obj)
+            .Select(s => (object)new List<object> { (object?)s.Source ?? 0L, s.Event, s.Function })
+            .ToList();
+    }
+
+    #endregion
+
+    #region Effect Efuns
+
+    /// <summary>
+    /// Default seconds between an effect's tick calls.
+    /// </summary>
+    private const int DefaultEffectInterval = 2;
+
+    /// <summary>
+    /// add_effect(ob, id, duration, tick_fn, expire_fn, [interval]) - Put a
+    /// timed effect on ob. tick_fn(ob, id, seconds_left) is called in
+    /// this_object() every interval seconds (default 2) and expire_fn(ob, id)
+    /// when the duration runs out; pass 0 for either to skip it. Nothing runs
+    /// in between. Adding an id ob already has replaces it.
+    /// </summary>
+    private object AddEffectEfun(List<object> args)
+    {
+        if (args.Count is < 5 or > 6)
+        {
+            throw new EfunException("add_effect() requires 5 or 6 arguments: object, id, duration, tick_fn, expire_fn, [interval]");
+        }
+
+        var (target, id) = EffectTarget(args, "add_effect");
+        if (args[2] is not (long or int))
+        {
+            throw new EfunException("add_effect() duration must be an integer");
+        }
+        var tickFunction = EffectFunction(args[3], "tick_fn");
+        var expireFunction = EffectFunction(args[4], "expire_fn");
+
+        int interval = DefaultEffectInterval;
+        if (args.Count == 6)
+        {
+            if (args[5] is not (long or int) || Convert.ToInt64(args[5]) < 1)
+            {
+                throw new EfunException("add_effect() interval must be a positive integer");
             }
+            interval = (int)Math.Min(Convert.ToInt64(args[5]), int.MaxValue);
+        }
+
+        var gameLoop = GameLoop.Instance ?? throw new EfunException("add_effect() requires an active game loop");
+        int duration = (int)Math.Clamp(Convert.ToInt64(args[2]), 0, int.MaxValue);
+        gameLoop.AddEffect(target, Vm.CurrentObject, id, duration, tickFunction, expireFunction, interval);
+        return 1L;
+    }
+
+    /// <summary>
+    /// remove_effect(ob, id) - End an effect early without calling its
+    /// expire_fn. Returns the seconds it had left, or -1 if ob doesn't have it.
+    /// </summary>
+    private object RemoveEffectEfun(List<object> args)
+    {
+        if (args.Count != 2)
+        {
+            throw new EfunException("remove_effect() requires exactly 2 arguments: object, id");
+        }
+
+        var (target, id) = EffectTarget(args, "remove_effect");
+        return (long)(GameLoop.Instance?.RemoveEffect(target, id) ?? -1);
+    }
+
+    /// <summary>
+    /// query_effect(ob, id) - Seconds left on an effect, or -1 if ob doesn't
+    /// have it.
+    /// </summary>
+    private object QueryEffectEfun(List<object> args)
+    {
+        if (args.Count != 2)
+        {
+            throw new EfunException("query_effect() requires exactly 2 arguments: object, id");
+        }
+
+        var (target, id) = EffectTarget(args, "query_effect");
+        return (long)(GameLoop.Instance?.QueryEffect(target, id) ?? -1);
+    }
+
+    /// <summary>
+    /// query_effects(ob) - Mapping of ob's effects to their seconds left.
+    /// </summary>
+    private object QueryEffectsEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not MudObject target)
+        {
+            throw new EfunException("query_effects() requires an object");
         }
 
+        var result = new LpcMapping();
+        if (GameLoop.Instance is { } gameLoop)
+        {
+            foreach (var (id, seconds) in gameLoop.QueryEffects(target))
+            {
+                result[id] = (long)seconds;
+            }
+        }
         return result;
     }
 
+    private static (MudObject Target, string Id) EffectTarget(List<object> args, string efun)
+    {
+        if (args[0] is not MudObject target)
+        {
+            throw new EfunException($"{efun}() first argument must be an object");
+        }
+        if (args[1] is not string id)
+        {
+            throw new EfunException($"{efun}() id must be a string");
+        }
+        return (target, id);
+    }
+
+    private static string? EffectFunction(object arg, string name)
+    {
+        return arg switch
+        {
+            string function => function,
+            long or int when Convert.ToInt64(arg) == 0 => null,
+            _ => throw new EfunException($"add_effect() {name} must be a function name or 0")
+        };
+    }
+
+    #endregion
+
+    #region Skill Efuns
+
     /// <summary>
-    /// map_array(arr, func) - Transform an array using a callback function.
-    /// Returns a new array where each element is the result of func(original_element).
-    /// func can be a string (function name in this_object).
+    /// query_skill_level(ob, skill) - ob's level in skill, 0 if it hasn't
+    /// learned it. Reads ob's skill table without calling into ob.
     /// </summary>
-    private object MapArrayEfun(List<object> args)
+    private object QuerySkillLevelEfun(List<object> args)
+    {
+        var (target, skill) = SkillArgs(args, "query_skill_level");
+        return (long)(target.SkillsIfAny?.Get(skill) ?? 0);
+    }
+
+    /// <summary>
+    /// set_skill_level(skill, level) - Set this_object()'s level in skill;
+    /// 0 forgets it.
+    /// </summary>
+    private object SetSkillLevelEfun(List<object> args)
+    {
+        if (args.Count != 2 || args[0] is not string skill || args[1] is not (long or int))
+        {
+            throw new EfunException("set_skill_level() requires a skill name and a level");
+        }
+        if (skill.Length == 0) return 0L;
+
+        var obj = Vm.CurrentObject;
+        obj.Skills.Set(skill, (int)Math.Clamp(Convert.ToInt64(args[1]), 0, int.MaxValue));
+        obj.MarkDirty();
+        return 1L;
+    }
+
+    /// <summary>
+    /// query_skill_allowed(ob, skill) - Whether ob may advance skill.
+    /// </summary>
+    private object QuerySkillAllowedEfun(List<object> args)
+    {
+        var (target, skill) = SkillArgs(args, "query_skill_allowed");
+        return target.SkillsIfAny?.IsAllowed(skill) == true ? 1L : 0L;
+    }
+
+    /// <summary>
+    /// set_skill_allowed(skill, flag) - Let this_object() advance skill, or
+    /// stop it with flag 0. set_skill_allowed(0, 0) stops every skill.
+    /// </summary>
+    private object SetSkillAllowedEfun(List<object> args)
+    {
+        if (args.Count != 2 || args[1] is not (long or int))
+        {
+            throw new EfunException("set_skill_allowed() requires a skill name and a flag");
+        }
+
+        var obj = Vm.CurrentObject;
+        bool allowed = Convert.ToInt64(args[1]) != 0;
+        if (args[0] is string skill)
+        {
+            if (skill.Length == 0) return 0L;
+            obj.Skills.SetAllowed(skill, allowed);
+        }
+        else if (args[0] is (long or int) && Convert.ToInt64(args[0]) == 0 && !allowed)
+        {
+            obj.SkillsIfAny?.ClearAllowed();
+        }
+        else
+        {
+            throw new EfunException("set_skill_allowed() requires a skill name, or 0 with flag 0");
+        }
+        obj.MarkDirty();
+        return 1L;
+    }
+
+    /// <summary>
+    /// query_skill_levels(ob) - Mapping of the skills ob has learned to
+    /// their levels.
+    /// </summary>
+    private object QuerySkillLevelsEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not MudObject target)
+        {
+            throw new EfunException("query_skill_levels() requires an object");
+        }
+        return target.SkillsIfAny?.Levels() ?? new LpcMapping();
+    }
+
+    /// <summary>
+    /// query_skills_allowed(ob) - The skills ob may advance.
+    /// </summary>
+    private object QuerySkillsAllowedEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not MudObject target)
+        {
+            throw new EfunException("query_skills_allowed() requires an object");
+        }
+        return target.SkillsIfAny?.Allowed() ?? new List<object>();
+    }
+
+    private static (MudObject Target, string Skill) SkillArgs(List<object> args, string efun)
+    {
+        if (args.Count != 2 || args[0] is not MudObject target || args[1] is not string skill)
+        {
+            throw new EfunException($"{efun}() requires an object and a skill name");
+        }
+        return (target, skill);
+    }
+
+    #endregion
+
+    #region Array Callback Efuns
+
+    /// <summary>
+    /// A function-name callback, looked up once per efun call rather than
+    /// once per element.
+    /// </summary>
+    private readonly record struct Callback(MudObject Target, FunctionDefinition Function, LpcProgram? Program);
+
+    /// <summary>
+    /// Resolve a callback naming a function in this_object() (or its shadow).
+    /// </summary>
+    private Callback ResolveCallback(object spec, string efun)
+    {
+        if (spec is not string name)
+        {
+            throw new EfunException($"{efun}() callback must be a function name string");
+        }
+
+        var target = Vm.CurrentObject ?? throw new EfunException($"{efun}() needs an object to call '{name}' in");
+        if (!target.TryResolveCall(name, out target, out var entry))
+        {
+            throw new ObjectInterpreterException($"Function '{name}' not found in object {target.ObjectName}");
+        }
+        return new Callback(target, entry.Function, entry.OwningProgram);
+    }
+
+    /// <summary>
+    /// An argument list for calling a callback once per element: slots for
+    /// the element(s) first, then the efun's extra arguments from args[from..].
+    /// The same list is refilled for every call.
+    /// </summary>
+    private static List<object> CallbackArgs(List<object> args, int from, int slots)
+    {
+        var buffer = new List<object>(slots + Math.Max(0, args.Count - from));
+        for (int i = 0; i < slots; i++) buffer.Add(0L);
+        for (int i = from; i < args.Count; i++) buffer.Add(args[i]);
+        return buffer;
+    }
+
+    private object? Invoke(Callback callback, List<object> args)
+    {
+        return InvokeOnObject(callback.Target, callback.Function, callback.Program, args);
+    }
+
+    /// <summary>
+    /// filter_array(arr, func, extra...) - Filter an array using a callback function.
+    /// Returns a new array containing only elements where func(element, extra...) returns non-zero.
+    /// func is the name of a function in this_object().
+    /// </summary>
+    private object FilterArrayEfun(List<object> args)
     {
         if (args.Count < 2)
         {
-            throw new EfunException("map_array() requires at least 2 arguments");
+            throw new EfunException("filter_array() requires at least 2 arguments");
         }
 
         if (args[0] is not List<object> arr)
         {
-            throw new EfunException("map_array() first argument must be an array");
+            throw new EfunException("filter_array() first argument must be an array");
         }
 
         var result = new List<object>();
-        string funcName;
-        MudObject? targetObj = null;
+        if (arr.Count == 0) return result;
 
-        // Parse the callback specification
-        if (args[1] is string fn)
+        var callback = ResolveCallback(args[1], "filter_array");
+        var callArgs = CallbackArgs(args, 2, 1);
+        foreach (var item in arr)
         {
-            funcName = fn;
-            targetObj = _currentObject;
+            callArgs[0] = item;
+            if (IsTrue(Invoke(callback, callArgs)))
+            {
+                result.Add(item);
+            }
         }
-        else
+
+        return result;
+    }
+
+    /// <summary>
+    /// map_array(arr, func, extra...) - Transform an array using a callback function.
+    /// Returns a new array where each element is the result of func(original_element, extra...).
+    /// func is the name of a function in this_object().
+    /// </summary>
+    private object MapArrayEfun(List<object> args)
+    {
+        if (args.Count < 2)
         {
-            throw new EfunException("map_array() callback must be a function name string");
+            throw new EfunException("map_array() requires at least 2 arguments");
         }
 
-        // Collect any extra arguments to pass to callback
-        var extraArgs = new List<object>();
-        for (int i = 2; i < args.Count; i++)
+        if (args[0] is not List<object> arr)
         {
-            extraArgs.Add(args[i]);
+            throw new EfunException("map_array() first argument must be an array");
         }
 
-        // Map each element
+        var result = new List<object>(arr.Count);
+        if (arr.Count == 0) return result;
+
+        var callback = ResolveCallback(args[1], "map_array");
+        var callArgs = CallbackArgs(args, 2, 1);
         foreach (var item in arr)
         {
-            var callArgs = new List<object> { item };
-            callArgs.AddRange(extraArgs);
+            callArgs[0] = item;
+            result.Add(Invoke(callback, callArgs) ?? 0);
+        }
 
-            try
+        return result;
+    }
+
+    /// <summary>
+    /// sort_array(arr, direction) - Sort ints or strings, ascending for 1,
+    /// descending for -1.
+    /// sort_array(arr, func, extra...) - Sort with func(a, b, extra...), which
+    /// returns a positive number when a belongs after b. The sort is stable.
+    /// Returns a new array either way.
+    /// </summary>
+    private object SortArrayEfun(List<object> args)
+    {
+        if (args.Count >= 2 && args[1] is string)
+        {
+            if (args[0] is not List<object> arr)
             {
-                var callResult = CallFunctionOnObject(targetObj, funcName, callArgs);
-                result.Add(callResult ?? 0);
+                throw new EfunException("sort_array() first argument must be an array");
             }
-            catch (ReturnException ex)
+            if (arr.Count < 2) return new List<object>(arr);
+
+            var callback = ResolveCallback(args[1], "sort_array");
+            var callArgs = CallbackArgs(args, 2, 2);
+            var comparer = Comparer<object>.Create((a, b) =>
             {
-                result.Add(ex.Value ?? 0);
-            }
+                callArgs[0] = a;
+                callArgs[1] = b;
+                return Math.Sign(ToInt(Invoke(callback, callArgs)));
+            });
+            return arr.OrderBy(item => item, comparer).ToList();
         }
 
-        return result;
+        return EfunRegistry.SortArray(args);
     }
 
     #endregion
 
     #region File I/O Efuns
 
+    /// <summary>
+    /// Wait for queued async writes to a file (or, with directory, anything
+    /// under it) so a synchronous file efun sees them.
+    /// </summary>
+    private static void SettleWrites(string fullPath, bool directory = false)
+    {
+        AsyncFileWriter.Shared.Settle(fullPath, directory);
+    }
+
     /// <summary>
     /// Resolve a mudlib path to a full file system path.
     /// Ensures the path stays within the mudlib directory for security.
     /// </summary>
     private string ResolveMudlibPath(string path)
     {
-        // Normalize: remove leading / and .c extension if present
-        path = path.TrimStart('/');
-        if (!path.EndsWith(".c") && !Path.HasExtension(path))
-        {
-            // Don't add extension for file operations
-        }
-
-        // Get full path
-        var fullPath = Path.GetFullPath(Path.Combine(_objectManager.MudlibPath, path));
-
-        // Security check: ensure path is within mudlib directory
-        if (!fullPath.StartsWith(_objectManager.MudlibPath))
-        {
-            throw new EfunException("Security violation: path traversal attempt detected");
-        }
+        return _objectManager.Files.Resolve(path)
+            ?? throw new EfunException("Security violation: path traversal attempt detected");
+    }
 
-        return fullPath;
+    /// <summary>
+    /// Game content anyone may read_file(): world, std, cmds, help and examples.
+    /// </summary>
+    private static bool IsPublicReadPath(string path)
+    {
+        return path.StartsWith("/world/") ||
+               path.StartsWith("/std/") ||
+               path.StartsWith("/cmds/") ||
+               path.StartsWith("/help") ||
+               path.StartsWith("/examples/");
     }
 
     /// <summary>
@@ -3515,14 +5056,7 @@ public class ObjectInterpreter
         }
 
         // Permission check: allow reading public game content, require Wizard+ for others
-        bool isPublicPath = path.StartsWith("/world/") ||
-                           path.StartsWith("/std/") ||
-                           path.StartsWith("/cmds/") ||
-                           path.StartsWith("/help/") ||
-                           path.StartsWith("/help") ||
-                           path.StartsWith("/examples/");
-
-        if (!isPublicPath)
+        if (!IsPublicReadPath(path))
         {
             RequireAccessLevel(AccessLevel.Wizard, "read_file");
             RequirePathAccess(path, "read_file", isWrite: false);
@@ -3546,24 +5080,9 @@ public class ObjectInterpreter
         try
         {
             var fullPath = ResolveMudlibPath(path);
+            SettleWrites(fullPath);
 
-            if (!File.Exists(fullPath))
-            {
-                return 0;
-            }
-
-            var lines = File.ReadAllLines(fullPath);
-
-            // Apply line range
-            int skipLines = startLine - 1;
-            IEnumerable<string> selectedLines = lines.Skip(skipLines);
-
-            if (numLines.HasValue)
-            {
-                selectedLines = selectedLines.Take(numLines.Value);
-            }
-
-            return string.Join("\n", selectedLines);
+            return (object?)_objectManager.Files.ReadLines(fullPath, startLine, numLines) ?? 0;
         }
         catch (IOException)
         {
@@ -3607,6 +5126,7 @@ public class ObjectInterpreter
         try
         {
             var fullPath = ResolveMudlibPath(path);
+            SettleWrites(fullPath);
 
             // Ensure directory exists
             var dir = Path.GetDirectoryName(fullPath);
@@ -3625,6 +5145,7 @@ public class ObjectInterpreter
                 // Overwrite
                 File.WriteAllText(fullPath, text);
             }
+            _objectManager.Files.Invalidate(fullPath);
 
             return 1;
         }
@@ -3634,6 +5155,141 @@ public class ObjectInterpreter
         }
     }
 
+    /// <summary>
+    /// write_file_async(path, text, [flag], [callback]) - write_file() on the
+    /// background file writer. Same permissions and flag as write_file().
+    /// When the write is done, callback(path, success) is called on
+    /// this_object() as a call_out. Returns 1 once queued.
+    /// </summary>
+    private object WriteFileAsyncEfun(List<object> args)
+    {
+        if (args.Count < 2 || args.Count > 4)
+        {
+            throw new EfunException("write_file_async() requires 2 to 4 arguments");
+        }
+
+        if (args[0] is not string path)
+        {
+            throw new EfunException("write_file_async() first argument must be a path string");
+        }
+
+        if (args[1] is not string text)
+        {
+            throw new EfunException("write_file_async() second argument must be a string");
+        }
+
+        string? callback = null;
+        if (args.Count >= 4)
+        {
+            callback = args[3] as string ?? throw new EfunException("write_file_async() callback must be a function name string");
+        }
+
+        RequireAccessLevel(AccessLevel.Wizard, "write_file_async");
+        RequirePathAccess(path, "write_file_async", isWrite: true);
+
+        int flag = args.Count >= 3 ? Convert.ToInt32(args[2]) : 0;
+        var fullPath = ResolveMudlibPath(path);
+        var done = FileCallback(callback, path);
+
+        AsyncFileWriter.Shared.Write(fullPath, text, append: flag == 1,
+            done == null ? null : ok => done(ok ? 1L : 0L));
+        return 1;
+    }
+
+    /// <summary>
+    /// read_file_async(path, callback) - Read a whole file on the background
+    /// file writer, after any queued writes to it. Same permissions as
+    /// read_file(). callback(path, contents) is called on this_object() as a
+    /// call_out, with contents 0 if the file doesn't exist. Returns 1 once queued.
+    /// </summary>
+    private object ReadFileAsyncEfun(List<object> args)
+    {
+        if (args.Count != 2)
+        {
+            throw new EfunException("read_file_async() requires exactly 2 arguments");
+        }
+
+        if (args[0] is not string path)
+        {
+            throw new EfunException("read_file_async() first argument must be a path string");
+        }
+
+        if (args[1] is not string callback)
+        {
+            throw new EfunException("read_file_async() callback must be a function name string");
+        }
+
+        if (!IsPublicReadPath(path))
+        {
+            RequireAccessLevel(AccessLevel.Wizard, "read_file_async");
+            RequirePathAccess(path, "read_file_async", isWrite: false);
+        }
+
+        var fullPath = ResolveMudlibPath(path);
+        var done = FileCallback(callback, path)!;
+        AsyncFileWriter.Shared.Read(fullPath, text => done(text ?? (object)0L));
+        return 1;
+    }
+
+    /// <summary>
+    /// The completion of an async file efun: a zero-delay call_out of
+    /// callback(path, result) on this_object(), or null without a callback.
+    /// Runs on the file writer thread.
+    /// </summary>
+    private Action<object>? FileCallback(string? callback, string path)
+    {
+        if (callback == null) return null;
+
+        var target = Vm.CurrentObject;
+        var gameLoop = GameLoop.Instance ?? throw new EfunException("Async file callbacks require an active game loop");
+        return result =>
+        {
+            if (!target.IsDestructed)
+            {
+                gameLoop.ScheduleCallout(target, callback, new List<object> { path, result }, 0);
+            }
+        };
+    }
+
+    /// <summary>
+    /// help_lookup(string topic) - The help text for topic from the help
+    /// index (commands, then topics, then /help), or 0 if there is none.
+    /// </summary>
+    private object HelpLookupEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not string topic)
+        {
+            throw new EfunException("help_lookup() requires a topic string");
+        }
+        return (object?)_objectManager.Help.Lookup(topic) ?? 0;
+    }
+
+    /// <summary>
+    /// help_topics(string section) - Sorted topic names in a help section
+    /// ("commands", "topics", or "" for /help itself).
+    /// </summary>
+    private object HelpTopicsEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not string section)
+        {
+            throw new EfunException("help_topics() requires a section string");
+        }
+        return _objectManager.Help.List(section).Cast<object>().ToList();
+    }
+
+    /// <summary>
+    /// help_search(string word) - Topics whose name starts with word, then
+    /// topics whose text mentions it.
+    /// </summary>
+    private object HelpSearchEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not string word)
+        {
+            throw new EfunException("help_search() requires a word string");
+        }
+        return _objectManager.Help.Search(word).Cast<object>().ToList();
+    }
+
     /// <summary>
     /// file_size(path) - Get the size of a file in bytes.
     /// Requires Wizard+ access level and read path access.
@@ -3659,19 +5315,15 @@ public class ObjectInterpreter
         try
         {
             var fullPath = ResolveMudlibPath(path);
+            SettleWrites(fullPath);
 
-            if (Directory.Exists(fullPath))
+            var stat = MudlibFileCache.Stat(fullPath);
+            return stat.Kind switch
             {
-                return -2; // Is a directory
-            }
-
-            if (!File.Exists(fullPath))
-            {
-                return -1; // Doesn't exist
-            }
-
-            var info = new FileInfo(fullPath);
-            return (int)info.Length;
+                FileKind.Directory => -2,
+                FileKind.Missing => -1,
+                _ => (int)stat.Length
+            };
         }
         catch (IOException)
         {
@@ -3703,14 +5355,15 @@ public class ObjectInterpreter
         try
         {
             var fullPath = ResolveMudlibPath(path);
+            SettleWrites(fullPath);
 
-            if (!File.Exists(fullPath))
+            var stat = MudlibFileCache.Stat(fullPath);
+            if (stat.Kind != FileKind.File)
             {
                 return -1; // Doesn't exist
             }
 
-            var info = new FileInfo(fullPath);
-            var unixTime = ((DateTimeOffset)info.LastWriteTimeUtc).ToUnixTimeSeconds();
+            var unixTime = ((DateTimeOffset)stat.LastWriteUtc).ToUnixTimeSeconds();
             return (int)unixTime;
         }
         catch (IOException)
@@ -3743,6 +5396,7 @@ public class ObjectInterpreter
         try
         {
             var fullPath = ResolveMudlibPath(path);
+            SettleWrites(fullPath);
 
             if (!File.Exists(fullPath))
             {
@@ -3750,6 +5404,7 @@ public class ObjectInterpreter
             }
 
             File.Delete(fullPath);
+            _objectManager.Files.Invalidate(fullPath);
             return 1;
         }
         catch (IOException)
@@ -3789,6 +5444,7 @@ public class ObjectInterpreter
             }
 
             Directory.CreateDirectory(fullPath);
+            _objectManager.Files.Invalidate(fullPath);
             return 1;
         }
         catch (IOException)
@@ -3822,6 +5478,7 @@ public class ObjectInterpreter
         try
         {
             var fullPath = ResolveMudlibPath(path);
+            SettleWrites(fullPath, directory: true);
 
             if (!Directory.Exists(fullPath))
             {
@@ -3835,6 +5492,7 @@ public class ObjectInterpreter
             }
 
             Directory.Delete(fullPath);
+            _objectManager.Files.Invalidate(fullPath);
             return 1;
         }
         catch (IOException)
@@ -3874,19 +5532,26 @@ public class ObjectInterpreter
         {
             var fullFromPath = ResolveMudlibPath(fromPath);
             var fullToPath = ResolveMudlibPath(toPath);
+            SettleWrites(fullFromPath, directory: true);
+            SettleWrites(fullToPath, directory: true);
 
-            if (File.Exists(fullFromPath))
+            var kind = MudlibFileCache.Stat(fullFromPath).Kind;
+            if (kind == FileKind.File)
             {
                 File.Move(fullFromPath, fullToPath);
-                return 1;
             }
-            else if (Directory.Exists(fullFromPath))
+            else if (kind == FileKind.Directory)
             {
                 Directory.Move(fullFromPath, fullToPath);
-                return 1;
+            }
+            else
+            {
+                return 0; // Source doesn't exist
             }
 
-            return 0; // Source doesn't exist
+            _objectManager.Files.Invalidate(fullFromPath);
+            _objectManager.Files.Invalidate(fullToPath);
+            return 1;
         }
         catch (IOException)
         {
@@ -3929,39 +5594,147 @@ public class ObjectInterpreter
         try
         {
             var fullPath = ResolveMudlibPath(path);
+            SettleWrites(fullPath, directory: true);
 
-            if (File.Exists(fullPath))
+            // Directories are listed with a trailing /
+            var listing = _objectManager.Files.ListDirectory(fullPath);
+            if (listing != null)
             {
-                // Return just the filename
-                return new List<object> { Path.GetFileName(fullPath) };
+                return new List<object>(listing);
             }
 
-            if (!Directory.Exists(fullPath))
+            if (MudlibFileCache.Stat(fullPath).Kind == FileKind.File)
             {
-                return new List<object>();
+                // Return just the filename
+                return new List<object> { Path.GetFileName(fullPath) };
             }
 
-            var entries = new List<object>();
+            return new List<object>();
+        }
+        catch (IOException)
+        {
+            return new List<object>();
+        }
+    }
+
+    #endregion
 
-            // Add directories (with trailing /)
-            foreach (var dir in Directory.GetDirectories(fullPath))
+    #region Network Efuns
+
+    /// <summary>
+    /// http_request(url, callback, [options]) - Send an HTTP request without
+    /// waiting for it. options may set "method" (default "GET"), "headers"
+    /// (a mapping), "body" (a string) and "timeout" (seconds, default 10, at
+    /// most 60). callback(id, result) is called on this_object() as a
+    /// call_out with ([ "status", "body", "headers" ]) or ([ "error" ]).
+    /// Returns the request id, or 0 if this_object() already has the most
+    /// requests in flight it may.
+    /// </summary>
+    private object HttpRequestEfun(List<object> args)
+    {
+        if (args.Count < 2 || args.Count > 3)
+        {
+            throw new EfunException("http_request() requires 2 or 3 arguments");
+        }
+        if (args[0] is not string url || !Uri.TryCreate(url, UriKind.Absolute, out var uri)
+            || (uri.Scheme != Uri.UriSchemeHttp && uri.Scheme != Uri.UriSchemeHttps))
+        {
+            throw new EfunException("http_request() first argument must be an http or https URL");
+        }
+        if (args[1] is not string callback)
+        {
+            throw new EfunException("http_request() callback must be a function name string");
+        }
+        var options = args.Count == 3 ? args[2] as LpcMapping ?? throw new EfunException("http_request() options must be a mapping") : new LpcMapping();
+
+        RequireAccessLevel(AccessLevel.Wizard, "http_request");
+
+        var request = new HttpRequestMessage(new HttpMethod(options.GetValueOrDefault("method") as string ?? "GET"), uri);
+        if (options.GetValueOrDefault("body") is string body)
+        {
+            request.Content = new StringContent(body);
+        }
+        if (options.GetValueOrDefault("headers") is LpcMapping headers)
+        {
+            foreach (var (name, value) in headers)
             {
-                entries.Add(Path.GetFileName(dir) + "/");
+                if (name is not string header) continue;
+                if (!request.Headers.TryAddWithoutValidation(header, value.ToString()))
+                {
+                    request.Content?.Headers.Remove(header);
+                    request.Content?.Headers.TryAddWithoutValidation(header, value.ToString());
+                }
             }
+        }
+
+        var timeout = RequestTimeout(options.GetValueOrDefault("timeout"), "http_request");
+        var (gameLoop, done) = RequestCallback(callback, "http_request");
+        return (long)gameLoop.Requests.Http(Vm.CurrentObject, request, timeout, done);
+    }
 
-            // Add files
-            foreach (var file in Directory.GetFiles(fullPath))
+    /// <summary>
+    /// tcp_request(host, port, data, callback, [timeout]) - Connect to
+    /// host:port, send data and read the reply until the other end closes,
+    /// without waiting for it. timeout is in seconds (default 10, at most
+    /// 60). callback(id, result) is called on this_object() as a call_out
+    /// with ([ "data" ]) or ([ "error" ]). Returns the request id, or 0 if
+    /// this_object() already has the most requests in flight it may.
+    /// </summary>
+    private object TcpRequestEfun(List<object> args)
+    {
+        if (args.Count < 4 || args.Count > 5)
+        {
+            throw new EfunException("tcp_request() requires 4 or 5 arguments");
+        }
+        if (args[0] is not string host || host.Length == 0)
+        {
+            throw new EfunException("tcp_request() first argument must be a host name");
+        }
+        if (args[1] is not long port || port < 1 || port > 65535)
+        {
+            throw new EfunException("tcp_request() second argument must be a port number");
+        }
+        if (args[2] is not string data)
+        {
+            throw new EfunException("tcp_request() third argument must be a string");
+        }
+        if (args[3] is not string callback)
+        {
+            throw new EfunException("tcp_request() callback must be a function name string");
+        }
+
+        RequireAccessLevel(AccessLevel.Wizard, "tcp_request");
+
+        var timeout = RequestTimeout(args.Count == 5 ? args[4] : null, "tcp_request");
+        var (gameLoop, done) = RequestCallback(callback, "tcp_request");
+        return (long)gameLoop.Requests.Tcp(Vm.CurrentObject, host, (int)port, data, timeout, done);
+    }
+
+    private static TimeSpan RequestTimeout(object? seconds, string efun)
+    {
+        if (seconds == null) return OutboundRequests.DefaultTimeout;
+        if (seconds is not long n || n <= 0)
+        {
+            throw new EfunException($"{efun}() timeout must be a positive number of seconds");
+        }
+        return TimeSpan.FromSeconds(Math.Min(n, (long)OutboundRequests.MaxTimeout.TotalSeconds));
+    }
+
+    /// <summary>
+    /// The completion of a network efun: a zero-delay call_out of
+    /// callback(id, result) on this_object(), posted to the game thread.
+    /// </summary>
+    private (GameLoop, Action<int, LpcMapping>) RequestCallback(string callback, string efun)
+    {
+        var target = Vm.CurrentObject;
+        var gameLoop = GameLoop.Instance ?? throw new EfunException($"{efun}() requires an active game loop");
+        return (gameLoop, (id, result) => gameLoop.Post(() =>
+        {
+            if (!target.IsDestructed)
             {
-                entries.Add(Path.GetFileName(file));
+                gameLoop.ScheduleCallout(target, callback, new List<object> { (long)id, result }, 0);
             }
-
-            entries.Sort();
-            return entries;
-        }
-        catch (IOException)
-        {
-            return new List<object>();
-        }
+        }));
     }
 
     #endregion
@@ -4115,54 +5888,609 @@ public class ObjectInterpreter
         var level = gameLoop.AccountManager.GetAccessLevel(targetUsername);
         if (level < AccessLevel.Wizard)
         {
-            return 0; // Not a wizard, no home directory
+            return 0; // Not a wizard, no home directory
+        }
+
+        return $"/wizards/{targetUsername.ToLowerInvariant()}";
+    }
+
+    /// <summary>
+    /// shutdown() - Initiate graceful server shutdown.
+    /// Requires Admin access level.
+    /// Announces to all players, saves all data, then shuts down.
+    /// </summary>
+    private object ShutdownEfun(List<object> args)
+    {
+        if (args.Count != 0)
+        {
+            throw new EfunException("shutdown() takes no arguments");
+        }
+
+        // Require Admin access
+        RequireAccessLevel(AccessLevel.Admin, "shutdown");
+
+        var gameLoop = GameLoop.Instance;
+        if (gameLoop == null)
+        {
+            throw new EfunException("shutdown() failed - no game loop");
+        }
+
+        // Log who initiated shutdown
+        var context = ExecutionContext.Current;
+        var initiator = context?.PlayerObject != null
+            ? GetPlayerName(context.PlayerObject)
+            : "unknown";
+        Logger.Info($"Shutdown initiated by {initiator}", LogCategory.System);
+
+        // Schedule shutdown on a separate thread to allow this command to complete
+        Task.Run(() =>
+        {
+            // Small delay to let the command response be sent
+            Thread.Sleep(500);
+
+            // Trigger graceful shutdown (this will save all players and announce)
+            gameLoop.GracefulShutdown();
+
+            // Signal the main loop to stop
+            Environment.Exit(0);
+        });
+
+        return 1;
+    }
+
+    /// <summary>
+    /// copyover() - Restart the driver without dropping connections.
+    /// Requires Admin access level.
+    /// Players are saved and logged back in by the new driver process.
+    /// </summary>
+    private object CopyoverEfun(List<object> args)
+    {
+        if (args.Count != 0)
+        {
+            throw new EfunException("copyover() takes no arguments");
+        }
+
+        RequireAccessLevel(AccessLevel.Admin, "copyover");
+
+        var context = ExecutionContext.Current;
+        var initiator = context?.PlayerObject != null
+            ? GetPlayerName(context.PlayerObject)
+            : "unknown";
+
+        // Carried out by the server between ticks, after this command has finished
+        if (GameLoop.Instance?.RequestCopyover() != true)
+        {
+            throw new EfunException("copyover() failed - no server to hand over");
+        }
+        Logger.Info($"Copyover initiated by {initiator}", LogCategory.System);
+
+        return 1;
+    }
+
+    /// <summary>
+    /// tick_stats() - Game loop timings from the tick profiler.
+    /// tick_stats(1) clears the profiler after reading.
+    /// Requires Admin access level.
+    /// Returns a mapping:
+    ///   "ticks", "overruns", "budget_us"
+    ///   "tick" and one entry per phase ("commands", "heartbeats", "timers",
+    ///     "saves"): ([ "count", "avg_us", "p50_us", "p95_us", "p99_us", "max_us",
+    ///     "bytes" ]), bytes being what the game thread allocated
+    ///   "gc": collections during ticks, ([ "gen0", "gen1", "gen2", "gen2_ticks" ])
+    ///   "allocators": the programs' functions that allocated most, over all
+    ///     their clones, ({ ([ "program", "function", "calls", "bytes" ]) })
+    ///   "slow_ticks": oldest first, ({ ([ "when", "us", "bytes", "gc", "phases", "top" ]) })
+    ///     where gc is ({ gen0, gen1, gen2 }) collections, phases maps phase
+    ///     name to microseconds and top is
+    ///     ({ ([ "object", "function", "calls", "us", "bytes" ]) }), costliest first
+    ///   "latency": player commands end to end, "total" and one entry per
+    ///     stage ("read", "queue", "run", "output", "send"), as for "tick"
+    ///     but without "bytes"
+    ///   "slow_commands": oldest first, ({ ([ "when", "connection", "input",
+    ///     "us", "stages", "calls" ]) }) where stages maps stage name to
+    ///     microseconds and calls is ({ ([ "depth", "function", "us" ]) }) in
+    ///     call order
+    /// </summary>
+    private object TickStatsEfun(List<object> args)
+    {
+        if (args.Count > 1)
+        {
+            throw new EfunException("tick_stats() takes at most 1 argument");
+        }
+
+        RequireAccessLevel(AccessLevel.Admin, "tick_stats");
+
+        var profiler = GameLoop.Instance?.TickProfiler;
+        if (profiler == null)
+        {
+            throw new EfunException("tick_stats() failed - no game loop");
+        }
+
+        var phaseNames = Enum.GetValues<TickPhase>().Select(phase => phase.ToString().ToLowerInvariant()).ToArray();
+
+        static Dictionary<object, object> HistogramToMapping(TickProfiler.Histogram histogram) => new LpcMapping
+        {
+            ["count"] = histogram.Count,
+            ["avg_us"] = histogram.AverageMicroseconds,
+            ["p50_us"] = histogram.Percentile(50),
+            ["p95_us"] = histogram.Percentile(95),
+            ["p99_us"] = histogram.Percentile(99),
+            ["max_us"] = histogram.MaxMicroseconds
+        };
+
+        var result = profiler.Read((tick, phases, slowTicks) =>
+        {
+            var stats = new LpcMapping
+            {
+                ["ticks"] = profiler.Ticks,
+                ["overruns"] = profiler.Overruns,
+                ["budget_us"] = profiler.BudgetMicroseconds,
+                ["tick"] = HistogramToMapping(tick)
+            };
+            var phaseBytes = profiler.PhaseBytes;
+            for (int i = 0; i < phases.Count; i++)
+            {
+                var phase = HistogramToMapping(phases[i]);
+                phase["bytes"] = phaseBytes[i];
+                stats[phaseNames[i]] = phase;
+            }
+            ((Dictionary<object, object>)stats["tick"])["bytes"] = phaseBytes.Sum();
+
+            var gc = profiler.Collections;
+            stats["gc"] = new LpcMapping
+            {
+                ["gen0"] = gc.Gen0,
+                ["gen1"] = gc.Gen1,
+                ["gen2"] = gc.Gen2,
+                ["gen2_ticks"] = gc.Gen2Ticks
+            };
+            stats["allocators"] = profiler.TopAllocators(10).Select(allocator => (object)new LpcMapping
+            {
+                ["program"] = allocator.Program,
+                ["function"] = allocator.Function,
+                ["calls"] = allocator.Calls,
+                ["bytes"] = allocator.Bytes
+            }).ToList();
+
+            var slowList = new List<object>();
+            foreach (var slow in slowTicks)
+            {
+                var slowPhases = new LpcMapping();
+                for (int i = 0; i < slow.PhaseMicroseconds.Length; i++)
+                {
+                    slowPhases[phaseNames[i]] = slow.PhaseMicroseconds[i];
+                }
+
+                slowList.Add(new LpcMapping
+                {
+                    ["when"] = new DateTimeOffset(slow.When).ToUnixTimeSeconds(),
+                    ["us"] = slow.Microseconds,
+                    ["bytes"] = slow.PhaseBytes.Sum(),
+                    ["gc"] = slow.Collections.Select(count => (object)(long)count).ToList(),
+                    ["phases"] = slowPhases,
+                    ["top"] = slow.TopCalls.Select(call => (object)new LpcMapping
+                    {
+                        ["object"] = call.Object,
+                        ["function"] = call.Function,
+                        ["calls"] = (long)call.Calls,
+                        ["us"] = call.Microseconds,
+                        ["bytes"] = call.Bytes
+                    }).ToList()
+                });
+            }
+            stats["slow_ticks"] = slowList;
+            return stats;
+        });
+
+        var latency = GameLoop.Instance!.Latency;
+        latency.Read((total, stages, slowCommands) =>
+        {
+            var stageNames = Enum.GetValues<CommandStage>().Select(stage => stage.ToString().ToLowerInvariant()).ToArray();
+            var latencyStats = new LpcMapping { ["total"] = HistogramToMapping(total) };
+            for (int i = 0; i < stages.Count; i++)
+            {
+                latencyStats[stageNames[i]] = HistogramToMapping(stages[i]);
+            }
+            result["latency"] = latencyStats;
+
+            result["slow_commands"] = slowCommands.Select(slow =>
+            {
+                var slowStages = new LpcMapping();
+                for (int i = 0; i < slow.StageMicroseconds.Length; i++)
+                {
+                    slowStages[stageNames[i]] = slow.StageMicroseconds[i];
+                }
+                return (object)new LpcMapping
+                {
+                    ["when"] = new DateTimeOffset(slow.When).ToUnixTimeSeconds(),
+                    ["connection"] = slow.ConnectionId,
+                    ["input"] = slow.Input,
+                    ["us"] = slow.Microseconds,
+                    ["stages"] = slowStages,
+                    ["calls"] = slow.Calls.Select(call => (object)new LpcMapping
+                    {
+                        ["depth"] = (long)call.Depth,
+                        ["function"] = call.Name,
+                        ["us"] = call.Microseconds
+                    }).ToList()
+                };
+            }).ToList();
+            return 0;
+        });
+
+        if (args.Count == 1 && args[0] is long clear && clear != 0)
+        {
+            profiler.Clear();
+            latency.Clear();
+        }
+
+        return result;
+    }
+
+    /// <summary>
+    /// object_census() - The last object census, or 0 if none has finished.
+    /// object_census(1) starts a census of every loaded object, carried out a
+    /// slice per tick; returns 1, or 0 if one is already running.
+    /// Requires Admin access level.
+    /// Returns a mapping:
+    ///   "finished" (unix time), "took_ms", "busy_ms", "objects", "bytes"
+    ///   "running": 1 if a newer census is under way, with "done" and "total"
+    ///   "blueprints": largest first,
+    ///     ({ ([ "name", "clones", "bytes", "clone_delta", "byte_delta" ]) })
+    ///     where the deltas are against the census before
+    ///   "largest": ({ ([ "object", "bytes" ]) }), largest first
+    /// Bytes are estimates of what each object's variables hold.
+    /// </summary>
+    private object ObjectCensusEfun(List<object> args)
+    {
+        if (args.Count > 1)
+        {
+            throw new EfunException("object_census() takes at most 1 argument");
+        }
+
+        RequireAccessLevel(AccessLevel.Admin, "object_census");
+
+        var census = _objectManager.Census;
+        if (args.Count == 1 && args[0] is long start && start != 0)
+        {
+            return census.Start(_objectManager.GetAllObjects()) ? 1L : 0L;
+        }
+
+        var report = census.Latest;
+        if (report == null)
+        {
+            return 0L;
+        }
+
+        var (done, total) = census.Progress;
+        return new LpcMapping
+        {
+            ["finished"] = new DateTimeOffset(report.Finished).ToUnixTimeSeconds(),
+            ["took_ms"] = (long)report.Took.TotalMilliseconds,
+            ["busy_ms"] = (long)report.Busy.TotalMilliseconds,
+            ["objects"] = (long)report.Objects,
+            ["bytes"] = report.Bytes,
+            ["running"] = census.Running ? 1L : 0L,
+            ["done"] = (long)done,
+            ["total"] = (long)total,
+            ["blueprints"] = report.Blueprints.Select(blueprint => (object)new LpcMapping
+            {
+                ["name"] = blueprint.Name,
+                ["clones"] = (long)blueprint.Clones,
+                ["bytes"] = blueprint.Bytes,
+                ["clone_delta"] = (long)blueprint.CloneDelta,
+                ["byte_delta"] = blueprint.ByteDelta
+            }).ToList(),
+            ["largest"] = report.Largest.Select(size => (object)new LpcMapping
+            {
+                ["object"] = size.Name,
+                ["bytes"] = size.Bytes
+            }).ToList()
+        };
+    }
+
+    /// <summary>
+    /// cpu_stats() or cpu_stats(n) - Where LPC time goes: the n (default 10)
+    /// objects, blueprints and domains that used the most instructions in the
+    /// last minute.
+    /// Requires Admin access level.
+    /// Returns a mapping:
+    ///   "budget": instructions an object may use a minute before its
+    ///     heart_beat() slows (0 = no limit), "window": seconds in "recent"
+    ///   "objects", "blueprints", "domains": busiest first,
+    ///     ({ ([ "name", "instructions", "us", "calls", "recent_instructions",
+    ///           "recent_us" ]) }), objects also with "throttled" (heartbeat
+    ///     turns skipped for going over budget)
+    /// Returns 0 when not running under the game loop.
+    /// </summary>
+    private object CpuStatsEfun(List<object> args)
+    {
+        if (args.Count > 1 || (args.Count == 1 && args[0] is not (long or int)))
+        {
+            throw new EfunException("cpu_stats() takes an optional int argument");
+        }
+
+        RequireAccessLevel(AccessLevel.Admin, "cpu_stats");
+
+        var cpu = GameLoop.Instance?.Cpu;
+        if (cpu == null)
+        {
+            return 0L;
+        }
+
+        int count = args.Count == 1 ? (int)Math.Clamp(Convert.ToInt64(args[0]), 1, 1000) : 10;
+        LpcMapping Describe(CpuAccounts.Account account)
+        {
+            var (recentInstructions, recentMicroseconds) = cpu.Recent(account);
+            return new LpcMapping
+            {
+                ["name"] = account.Name,
+                ["instructions"] = account.Instructions,
+                ["us"] = account.Microseconds,
+                ["calls"] = account.Calls,
+                ["recent_instructions"] = recentInstructions,
+                ["recent_us"] = recentMicroseconds
+            };
+        }
+        List<object> Busiest(IEnumerable<LpcMapping> entries) => entries
+            .OrderByDescending(entry => (long)entry["recent_instructions"])
+            .ThenByDescending(entry => (long)entry["instructions"])
+            .Take(count)
+            .Cast<object>()
+            .ToList();
+
+        var objects = cpu.Objects
+            .Where(account => !account.Object.IsDestructed)
+            .Select(account =>
+            {
+                var entry = Describe(account.Account);
+                entry["throttled"] = account.Throttled;
+                return entry;
+            });
+
+        return new LpcMapping
+        {
+            ["budget"] = cpu.Budget,
+            ["window"] = (long)CpuAccounts.WindowSeconds,
+            ["objects"] = Busiest(objects),
+            ["blueprints"] = Busiest(cpu.Blueprints.Select(Describe)),
+            ["domains"] = Busiest(cpu.Domains.Select(Describe))
+        };
+    }
+
+    /// <summary>
+    /// profile_enable(on) - Turn the LPC function profiler on (1) or off (0).
+    /// Requires Admin access level.
+    /// Returns the previous state. Recorded data is kept until profile_clear().
+    /// </summary>
+    private object ProfileEnableEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not long on)
+        {
+            throw new EfunException("profile_enable() requires an int argument");
+        }
+
+        RequireAccessLevel(AccessLevel.Admin, "profile_enable");
+
+        var previous = Profiler.Enabled;
+        Profiler.Enabled = on != 0;
+        return previous ? 1L : 0L;
+    }
+
+    /// <summary>
+    /// profile_clear() - Discard everything the function profiler recorded.
+    /// Requires Admin access level.
+    /// </summary>
+    private object ProfileClearEfun(List<object> args)
+    {
+        if (args.Count != 0)
+        {
+            throw new EfunException("profile_clear() takes no arguments");
+        }
+
+        RequireAccessLevel(AccessLevel.Admin, "profile_clear");
+
+        Profiler.Clear();
+        return 1L;
+    }
+
+    /// <summary>
+    /// profile_stats([limit, [prefix]]) - Functions recorded by the profiler,
+    /// costliest (by self instructions) first.
+    /// Requires Admin access level.
+    /// limit caps the number returned (0 for all); prefix keeps only programs
+    /// whose path starts with it, e.g. "/std/" or "/daemons/".
+    /// Returns: ({ ([ "program", "function", "calls", "instructions",
+    ///   "self_instructions", "us", "self_us" ]) })
+    /// </summary>
+    private object ProfileStatsEfun(List<object> args)
+    {
+        if (args.Count > 2)
+        {
+            throw new EfunException("profile_stats() takes at most 2 arguments");
+        }
+
+        RequireAccessLevel(AccessLevel.Admin, "profile_stats");
+
+        int limit = args.Count > 0 && args[0] is long n && n > 0 ? (int)Math.Min(n, int.MaxValue) : int.MaxValue;
+        string? prefix = args.Count > 1 && args[1] is string p && p.Length > 0 ? p : null;
+
+        return Profiler.GetTopFunctions(limit, prefix)
+            .Select(stats => (object)new LpcMapping
+            {
+                ["program"] = stats.Program,
+                ["function"] = stats.Function,
+                ["calls"] = stats.Calls,
+                ["instructions"] = stats.Instructions,
+                ["self_instructions"] = stats.SelfInstructions,
+                ["us"] = stats.Microseconds,
+                ["self_us"] = stats.SelfMicroseconds
+            })
+            .ToList();
+    }
+
+    /// <summary>
+    /// profile_folded([by_time]) - The profiler's call tree as folded stacks,
+    /// one "prog:func;prog:func weight" line per call path, for flamegraph.pl
+    /// or speedscope. Weights are self instructions, or self microseconds
+    /// when by_time is nonzero.
+    /// Requires Admin access level.
+    /// </summary>
+    private object ProfileFoldedEfun(List<object> args)
+    {
+        if (args.Count > 1)
+        {
+            throw new EfunException("profile_folded() takes at most 1 argument");
+        }
+
+        RequireAccessLevel(AccessLevel.Admin, "profile_folded");
+
+        bool byTime = args.Count == 1 && args[0] is long t && t != 0;
+        return Profiler.ToFoldedStacks(byTime);
+    }
+
+    /// <summary>
+    /// jit_enable(on) - Let hot functions run as IL (1) or keep them all on the
+    /// bytecode VM (0), for comparing the two. Requires Admin access level.
+    /// Returns the previous state. Jitted code is kept while it is off.
+    /// </summary>
+    private object JitEnableEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not long on)
+        {
+            throw new EfunException("jit_enable() requires an int argument");
+        }
+
+        RequireAccessLevel(AccessLevel.Admin, "jit_enable");
+
+        var previous = UseJit;
+        UseJit = on != 0;
+        return previous ? 1L : 0L;
+    }
+
+    /// <summary>
+    /// bench() stops after this many calls, or this long, so it can't hold up a tick for long.
+    /// </summary>
+    private const long MaxBenchIterations = 1_000_000;
+    private static readonly TimeSpan BenchTimeLimit = TimeSpan.FromSeconds(1);
+
+    /// <summary>
+    /// bench(function, iterations, args...) - Time iterations calls of
+    /// this_object()'s function with args, after up to 1000 untimed calls to
+    /// get it through the JIT. Requires Wizard access level. Stops at
+    /// 1,000,000 calls or after a second; "iterations" in the result is the
+    /// number timed. Returns ([ "iterations", "total_us", "ns", "instructions",
+    /// "bytes", "gc", "result" ]), with ns, instructions and bytes (allocated)
+    /// per call, gc the gen0 collections and result the last call's value.
+    /// </summary>
+    private object BenchEfun(List<object> args)
+    {
+        if (args.Count < 2 || args[0] is not string function || args[1] is not long iterations || iterations < 1)
+        {
+            throw new EfunException("bench() requires a function name and a positive iteration count");
+        }
+
+        RequireAccessLevel(AccessLevel.Wizard, "bench");
+
+        var vm = Vm;
+        var target = vm.CurrentObject ?? throw new EfunException("bench() requires a current object");
+        if (target.FindFunction(function) == null)
+        {
+            throw new EfunException($"bench(): no function '{function}' in {target.ObjectName}");
+        }
+
+        iterations = Math.Min(iterations, MaxBenchIterations);
+        var callArgs = args.Skip(2).ToList();
+        var saved = vm.InstructionCount;
+        BenchResult bench;
+        try
+        {
+            bench = LpcBenchmark.Measure(this, target, function, callArgs, iterations,
+                Math.Min(iterations, LpcBenchmark.WarmupCalls), BenchTimeLimit);
+        }
+        finally
+        {
+            vm.InstructionCount = saved;
+        }
+
+        return new LpcMapping
+        {
+            ["iterations"] = bench.Iterations,
+            ["total_us"] = (long)(bench.Seconds * 1_000_000),
+            ["ns"] = (long)Math.Round(bench.NanosecondsPerCall),
+            ["instructions"] = (long)Math.Round(bench.InstructionsPerCall),
+            ["bytes"] = (long)Math.Round(bench.BytesPerCall),
+            ["gc"] = (long)bench.Gen0Collections,
+            ["result"] = bench.Result ?? 0L
+        };
+    }
+
+    /// <summary>
+    /// snoop(observer, target) - Copy everything target is sent to observer
+    /// as well, under a header line with target's name. Requires Admin
+    /// access level. Returns 1 if started, 0 if either isn't connected or
+    /// observer is already watching. Ends when either disconnects.
+    /// </summary>
+    private object SnoopEfun(List<object> args)
+    {
+        if (args.Count != 2 || args[0] is not MudObject observer || args[1] is not MudObject target)
+        {
+            throw new EfunException("snoop() requires an observer and a target object");
         }
 
-        return $"/wizards/{targetUsername.ToLowerInvariant()}";
+        RequireAccessLevel(AccessLevel.Admin, "snoop");
+
+        return GameLoop.Instance?.Snoop(observer, target) == true ? 1L : 0L;
     }
 
     /// <summary>
-    /// shutdown() - Initiate graceful server shutdown.
-    /// Requires Admin access level.
-    /// Announces to all players, saves all data, then shuts down.
+    /// unsnoop(observer, [target]) - Stop copying target's output to
+    /// observer, or everyone's without a target. Requires Admin access
+    /// level. Returns the number of players observer stopped watching.
     /// </summary>
-    private object ShutdownEfun(List<object> args)
+    private object UnsnoopEfun(List<object> args)
     {
-        if (args.Count != 0)
+        if (args.Count is < 1 or > 2 || args[0] is not MudObject observer ||
+            (args.Count == 2 && args[1] is not MudObject))
         {
-            throw new EfunException("shutdown() takes no arguments");
+            throw new EfunException("unsnoop() requires an observer and optionally a target object");
         }
 
-        // Require Admin access
-        RequireAccessLevel(AccessLevel.Admin, "shutdown");
+        RequireAccessLevel(AccessLevel.Admin, "unsnoop");
 
-        var gameLoop = GameLoop.Instance;
-        if (gameLoop == null)
+        return (long)(GameLoop.Instance?.Unsnoop(observer, args.Count == 2 ? (MudObject)args[1] : null) ?? 0);
+    }
+
+    /// <summary>
+    /// query_snoop(target) - Array of the players watching target.
+    /// Requires Admin access level.
+    /// </summary>
+    private object QuerySnoopEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not MudObject target)
         {
-            throw new EfunException("shutdown() failed - no game loop");
+            throw new EfunException("query_snoop() requires an object");
         }
 
-        // Log who initiated shutdown
-        var context = ExecutionContext.Current;
-        var initiator = context?.PlayerObject != null
-            ? GetPlayerName(context.PlayerObject)
-            : "unknown";
-        Logger.Info($"Shutdown initiated by {initiator}", LogCategory.System);
+        RequireAccessLevel(AccessLevel.Admin, "query_snoop");
 
-        // Schedule shutdown on a separate thread to allow this command to complete
-        Task.Run(() =>
-        {
-            // Small delay to let the command response be sent
-            Thread.Sleep(500);
+        return GameLoop.Instance?.QuerySnoopers(target).Cast<object>().ToList() ?? new List<object>();
+    }
 
-            // Trigger graceful shutdown (this will save all players and announce)
-            gameLoop.GracefulShutdown();
+    /// <summary>
+    /// query_snooping(observer) - Array of the players observer is watching.
+    /// Requires Admin access level.
+    /// </summary>
+    private object QuerySnoopingEfun(List<object> args)
+    {
+        if (args.Count != 1 || args[0] is not MudObject observer)
+        {
+            throw new EfunException("query_snooping() requires an object");
+        }
 
-            // Signal the main loop to stop
-            Environment.Exit(0);
-        });
+        RequireAccessLevel(AccessLevel.Admin, "query_snooping");
 
-        return 1;
+        return GameLoop.Instance?.QuerySnooping(observer).Cast<object>().ToList() ?? new List<object>();
     }
 
     /// <summary>
@@ -4218,7 +6546,7 @@ public class ObjectInterpreter
         }
 
         // Include the calling object in the log message
-        var prefix = $"[{_currentObject.ObjectName}]";
+        var prefix = $"[{Vm.CurrentObject.ObjectName}]";
         Logger.Log(level, LogCategory.LPC, $"{prefix} {message}");
 
         return 1L;
@@ -4262,8 +6590,7 @@ public class ObjectInterpreter
         var gameLoop = GameLoop.Instance;
         if (gameLoop == null) return null;
 
-        return gameLoop.GetAllSessions()
-            .FirstOrDefault(s => s.PlayerObject == context.PlayerObject);
+        return GameLoop.FindSessionByPlayerObject(context.PlayerObject);
     }
 
     /// <summary>
@@ -4280,11 +6607,11 @@ public class ObjectInterpreter
         var session = GetCurrentSession();
         if (session == null)
         {
-            return new Dictionary<object, object>();
+            return new LpcMapping();
         }
 
         // Convert to LPC mapping format
-        var result = new Dictionary<object, object>();
+        var result = new LpcMapping();
         foreach (var kvp in session.Aliases)
         {
             result[kvp.Key] = kvp.Value;
@@ -4441,7 +6768,8 @@ public class ObjectInterpreter
 
     /// <summary>
     /// save_object(path) - Save this_object()'s variables to a file.
-    /// Returns 1 on success, 0 on failure.
+    /// The variables are serialized now and written by the background file
+    /// writer. Returns 1 once queued, 0 on failure.
     /// </summary>
     private object SaveObjectEfun(List<object> args)
     {
@@ -4464,29 +6792,24 @@ public class ObjectInterpreter
             }
 
             var fullPath = ResolveMudlibPath(path);
+            _objectManager.Restores.Invalidate(fullPath);
 
-            // Ensure directory exists
-            var dir = Path.GetDirectoryName(fullPath);
-            if (!string.IsNullOrEmpty(dir) && !Directory.Exists(dir))
-            {
-                Directory.CreateDirectory(dir);
-            }
-
-            var sb = new StringBuilder();
+            // Skip null/default values
+            var variables = Vm.CurrentObject.SaveEntries()
+                .Where(v => v.Value != null && v.Value is not (0L or 0));
+            var data = SaveFormat.Encode(variables, SaveFormat.Binary);
 
-            // Write each variable
-            foreach (var (name, value) in _currentObject.Variables)
+            var store = _objectManager.SaveStore;
+            if (store != null)
             {
-                // Skip null/default values
-                if (value == null) continue;
-                if ((value is long l && l == 0) || (value is int i && i == 0)) continue;
-
-                sb.Append(name);
-                sb.Append(' ');
-                sb.AppendLine(SerializeLpcValue(value));
+                // Goes out with the rest of this tick's saves
+                store.Put(SaveStore.KeyFor(_objectManager.MudlibPath, fullPath), data);
+                return 1;
             }
 
-            File.WriteAllText(fullPath, sb.ToString());
+            // Write-behind: the file writer merges repeated saves of the same file,
+            // and restore_object() waits for the queued one
+            AsyncFileWriter.Shared.Write(fullPath, data);
             return 1;
         }
         catch (Exception)
@@ -4521,327 +6844,34 @@ public class ObjectInterpreter
 
             var fullPath = ResolveMudlibPath(path);
 
-            if (!File.Exists(fullPath))
-            {
-                return 0;
-            }
-
-            var lines = File.ReadAllLines(fullPath);
-
-            foreach (var line in lines)
-            {
-                if (string.IsNullOrWhiteSpace(line)) continue;
-
-                // Find the first space to separate name from value
-                var spaceIndex = line.IndexOf(' ');
-                if (spaceIndex <= 0) continue;
-
-                var name = line[..spaceIndex];
-                var valueStr = line[(spaceIndex + 1)..];
-
-                // Only restore if the variable exists in the object
-                if (_currentObject.Variables.ContainsKey(name))
-                {
-                    var value = DeserializeLpcValue(valueStr);
-                    _currentObject.Variables[name] = value;
-                }
-            }
-
-            return 1;
-        }
-        catch (Exception)
-        {
-            return 0;
-        }
-    }
-
-    /// <summary>
-    /// Serialize an LPC value to string format.
-    /// </summary>
-    private string SerializeLpcValue(object? value)
-    {
-        if (value == null)
-        {
-            return "0";
-        }
-
-        return value switch
-        {
-            int i => i.ToString(),
-            string s => "\"" + EscapeString(s) + "\"",
-            List<object> arr => SerializeArray(arr),
-            Dictionary<object, object> map => SerializeMapping(map),
-            MudObject obj => obj.ObjectName, // Store object reference as path
-            _ => value.ToString() ?? "0"
-        };
-    }
-
-    private string EscapeString(string s)
-    {
-        return s.Replace("\\", "\\\\")
-                .Replace("\"", "\\\"")
-                .Replace("\n", "\\n")
-                .Replace("\r", "\\r")
-                .Replace("\t", "\\t");
-    }
-
-    private string SerializeArray(List<object> arr)
-    {
-        var sb = new StringBuilder();
-        sb.Append("({");
-        for (int i = 0; i < arr.Count; i++)
-        {
-            if (i > 0) sb.Append(',');
-            sb.Append(SerializeLpcValue(arr[i]));
-        }
-        sb.Append("})");
-        return sb.ToString();
-    }
-
-    private string SerializeMapping(Dictionary<object, object> map)
-    {
-        var sb = new StringBuilder();
-        sb.Append("([");
-        bool first = true;
-        foreach (var (key, value) in map)
-        {
-            if (!first) sb.Append(',');
-            first = false;
-            sb.Append(SerializeLpcValue(key));
-            sb.Append(':');
-            sb.Append(SerializeLpcValue(value));
-        }
-        sb.Append("])");
-        return sb.ToString();
-    }
-
-    /// <summary>
-    /// Deserialize an LPC value from string format.
-    /// </summary>
-    private object? DeserializeLpcValue(string str)
-    {
-        str = str.Trim();
-
-        if (string.IsNullOrEmpty(str))
-        {
-            return 0;
-        }
-
-        // Integer
-        if (int.TryParse(str, out int intVal))
-        {
-            return intVal;
-        }
-
-        // String
-        if (str.StartsWith('"') && str.EndsWith('"'))
-        {
-            return UnescapeString(str[1..^1]);
-        }
-
-        // Array
-        if (str.StartsWith("({") && str.EndsWith("})"))
-        {
-            return DeserializeArray(str[2..^2]);
-        }
-
-        // Mapping
-        if (str.StartsWith("([") && str.EndsWith("])"))
-        {
-            return DeserializeMapping(str[2..^2]);
-        }
-
-        // Default: try to find as object, otherwise return as string
-        return str;
-    }
-
-    private string UnescapeString(string s)
-    {
-        var result = new StringBuilder();
-        bool escape = false;
-
-        foreach (char c in s)
-        {
-            if (escape)
-            {
-                result.Append(c switch
-                {
-                    'n' => '\n',
-                    'r' => '\r',
-                    't' => '\t',
-                    '\\' => '\\',
-                    '"' => '"',
-                    _ => c
-                });
-                escape = false;
-            }
-            else if (c == '\\')
-            {
-                escape = true;
-            }
-            else
-            {
-                result.Append(c);
-            }
-        }
-
-        return result.ToString();
-    }
-
-    private List<object> DeserializeArray(string content)
-    {
-        var result = new List<object>();
-        if (string.IsNullOrWhiteSpace(content))
-        {
-            return result;
-        }
-
-        // Simple parsing - split by commas at depth 0
-        var items = SplitAtDepthZero(content, ',');
-        foreach (var item in items)
-        {
-            var value = DeserializeLpcValue(item.Trim());
-            if (value != null)
-            {
-                result.Add(value);
-            }
-        }
-
-        return result;
-    }
-
-    private Dictionary<object, object> DeserializeMapping(string content)
-    {
-        var result = new Dictionary<object, object>();
-        if (string.IsNullOrWhiteSpace(content))
-        {
-            return result;
-        }
-
-        // Split by commas at depth 0
-        var pairs = SplitAtDepthZero(content, ',');
-        foreach (var pair in pairs)
-        {
-            // Split key:value
-            var colonIndex = FindAtDepthZero(pair, ':');
-            if (colonIndex > 0)
+            // Decoded already if the login queue prefetched it
+            var entries = _objectManager.Restores.Take(fullPath);
+            if (entries == null)
             {
-                var keyStr = pair[..colonIndex].Trim();
-                var valueStr = pair[(colonIndex + 1)..].Trim();
-
-                var key = DeserializeLpcValue(keyStr);
-                var value = DeserializeLpcValue(valueStr);
-
-                if (key != null)
+                var data = _objectManager.ReadSaveFile(fullPath);
+                if (data == null)
                 {
-                    result[key] = value ?? 0;
+                    return 0;
                 }
-            }
-        }
-
-        return result;
-    }
-
-    private List<string> SplitAtDepthZero(string content, char delimiter)
-    {
-        var result = new List<string>();
-        int depth = 0;
-        bool inString = false;
-        bool escape = false;
-        int start = 0;
-
-        for (int i = 0; i < content.Length; i++)
-        {
-            char c = content[i];
 
-            if (escape)
-            {
-                escape = false;
-                continue;
-            }
-
-            if (c == '\\')
-            {
-                escape = true;
-                continue;
-            }
-
-            if (c == '"')
-            {
-                inString = !inString;
-                continue;
+                // Text or binary, whichever the file is
+                entries = SaveFormat.Read(data);
             }
 
-            if (inString) continue;
-
-            if (c == '(' || c == '[' || c == '{')
-            {
-                depth++;
-            }
-            else if (c == ')' || c == ']' || c == '}')
-            {
-                depth--;
-            }
-            else if (c == delimiter && depth == 0)
+            foreach (var (name, value) in entries)
             {
-                result.Add(content[start..i]);
-                start = i + 1;
+                // Only restores variables that exist in the object
+                Vm.CurrentObject.RestoreEntry(name, value);
             }
-        }
 
-        if (start < content.Length)
-        {
-            result.Add(content[start..]);
+            // Its name may have changed with them
+            Vm.CurrentObject.DescriptionChanged();
+            return 1;
         }
-
-        return result;
-    }
-
-    private int FindAtDepthZero(string content, char target)
-    {
-        int depth = 0;
-        bool inString = false;
-        bool escape = false;
-
-        for (int i = 0; i < content.Length; i++)
+        catch (Exception)
         {
-            char c = content[i];
-
-            if (escape)
-            {
-                escape = false;
-                continue;
-            }
-
-            if (c == '\\')
-            {
-                escape = true;
-                continue;
-            }
-
-            if (c == '"')
-            {
-                inString = !inString;
-                continue;
-            }
-
-            if (inString) continue;
-
-            if (c == '(' || c == '[' || c == '{')
-            {
-                depth++;
-            }
-            else if (c == ')' || c == ']' || c == '}')
-            {
-                depth--;
-            }
-            else if (c == target && depth == 0)
-            {
-                return i;
-            }
+            return 0;
         }
-
-        return -1;
     }
 
     #endregion
@@ -4900,6 +6930,30 @@ public class ObjectInterpreter
         return _objectManager.GetInheritanceParents(path).Cast<object>().ToList();
     }
 
+    /// <summary>
+    /// perf_warnings(path|object) - The costly patterns the compiler found in
+    /// a loaded program, as "file:line: message (in function())" strings.
+    /// Requires Wizard access level. 0 if the path isn't loaded.
+    /// </summary>
+    private object PerfWarningsEfun(List<object> args)
+    {
+        if (args.Count != 1)
+        {
+            throw new EfunException("perf_warnings() requires exactly 1 argument");
+        }
+
+        RequireAccessLevel(AccessLevel.Wizard, "perf_warnings");
+        var target = args[0] switch
+        {
+            string path => _objectManager.FindObject(path),
+            MudObject obj => obj,
+            _ => throw new EfunException("perf_warnings() argument must be a path string or object")
+        };
+        if (target == null) return 0L;
+
+        return target.Program.PerfWarnings.Select(warning => (object)warning.ToString()).ToList();
+    }
+
     /// <summary>
     /// reload_changed() - Reload all blueprints whose source files have changed.
     /// Requires Admin access level.
@@ -4922,13 +6976,15 @@ public class ObjectInterpreter
             try
             {
                 var sourcePath = ResolveMudlibPath(blueprint.FilePath + ".c");
+                SettleWrites(sourcePath);
                 if (!File.Exists(sourcePath))
                 {
                     continue;
                 }
 
+                // Compare with the program, not the object: a reload keeps the blueprint
                 var fileInfo = new FileInfo(sourcePath);
-                if (fileInfo.LastWriteTimeUtc > blueprint.CreatedAt)
+                if (fileInfo.LastWriteTimeUtc > blueprint.Program.CompiledAt)
                 {
                     // File is newer than the loaded blueprint - reload it
                     _objectManager.UpdateObject(blueprint.FilePath);
@@ -5000,7 +7056,7 @@ public class ObjectInterpreter
         // Set up the input handler
         session.PendingInputHandler = new InputHandler
         {
-            Target = _currentObject,
+            Target = Vm.CurrentObject,
             Function = function,
             Flags = flags
         };
@@ -5050,7 +7106,7 @@ public class ObjectInterpreter
             }
         }
 
-        _currentObject.AddAction(function, verb, flags);
+        Vm.CurrentObject.AddAction(function, verb, flags);
         return 1;
     }
 
@@ -5110,7 +7166,7 @@ public class ObjectInterpreter
             throw new EfunException("enable_commands() takes no arguments");
         }
 
-        _currentObject.CommandsEnabled = true;
+        Vm.CurrentObject.CommandsEnabled = true;
         return 1;
     }
 
@@ -5125,7 +7181,7 @@ public class ObjectInterpreter
             throw new EfunException("disable_commands() takes no arguments");
         }
 
-        _currentObject.CommandsEnabled = false;
+        Vm.CurrentObject.CommandsEnabled = false;
         return 1;
     }
 
@@ -5216,8 +7272,8 @@ public class ObjectInterpreter
             return 0; // Player not in a room
         }
 
-        // Send to all objects in room except player
-        foreach (var obj in room.Contents)
+        // Send to every player in the room but the speaker
+        foreach (var obj in room.InteractiveContents)
         {
             if (obj == player || obj.IsDestructed)
             {
@@ -5242,10 +7298,6 @@ public class ObjectInterpreter
                 {
                     CallFunctionOnObject(obj, "catch_tell", new List<object> { message });
                 }
-                catch (ReturnException)
-                {
-                    // Normal return
-                }
                 catch
                 {
                     // Ignore errors in catch_tell
@@ -5272,29 +7324,65 @@ public class ObjectInterpreterException : Exception
 
 /// <summary>
 /// LPC runtime error with file, line, and stack trace information.
+///
+/// Errors raised under catch() are usually thrown away, so the text is built
+/// only when read: the error keeps the call frames and formats the trace,
+/// and the message that includes it, on first use.
 /// </summary>
 public class LpcRuntimeException : Exception
 {
+    private readonly CallFrame[]? _frames;
+    private string? _lpcStackTrace;
+    private string? _errorLine;
+    private string? _message;
+
     public string File { get; }
     public int Line { get; }
-    public string LpcStackTrace { get; }
 
     public LpcRuntimeException(string message, string file, int line, string lpcStackTrace = "")
-        : base(FormatMessage(message, file, line, lpcStackTrace))
+        : base(message)
+    {
+        File = file;
+        Line = line;
+        _lpcStackTrace = lpcStackTrace;
+    }
+
+    /// <param name="frames">The calls in flight, innermost first (as Stack.ToArray() gives them)</param>
+    public LpcRuntimeException(string message, string file, int line, CallFrame[]? frames)
+        : base(message)
     {
         File = file;
         Line = line;
-        LpcStackTrace = lpcStackTrace;
+        _frames = frames;
     }
 
-    private static string FormatMessage(string message, string file, int line, string lpcStackTrace)
+    /// <summary>
+    /// "Stack trace:" and one line per call, outermost first; empty with no calls.
+    /// </summary>
+    public string LpcStackTrace => _lpcStackTrace ??= FormatStackTrace(_frames);
+
+    /// <summary>
+    /// "file:line: error", what catch() returns.
+    /// </summary>
+    public string ErrorLine => _errorLine ??= $"{File}:{Line}: {base.Message}";
+
+    public override string Message => _message ??= string.IsNullOrEmpty(LpcStackTrace)
+        ? ErrorLine
+        : ErrorLine + "\n" + LpcStackTrace;
+
+    private static string FormatStackTrace(CallFrame[]? frames)
     {
-        var result = $"{file}:{line}: {message}";
-        if (!string.IsNullOrEmpty(lpcStackTrace))
+        if (frames == null || frames.Length == 0) return "";
+
+        var sb = new StringBuilder();
+        sb.AppendLine("Stack trace:");
+        for (int i = frames.Length - 1; i >= 0; i--)
         {
-            result += "\n" + lpcStackTrace;
+            var frame = frames[i];
+            var (file, line) = frame.Locate(frame.Function.BodyLine);
+            sb.AppendLine($"  {file}:{line} in {frame.Function.Name}()");
         }
-        return result;
+        return sb.ToString();
     }
 }
 
@@ -1,4 +1,6 @@
 using System.Collections.Concurrent;
+using System.Collections.Immutable;
+using System.Globalization;
 
 namespace Driver;
 
@@ -6,32 +8,74 @@ namespace Driver;
 /// Central manager for all MUD objects (blueprints and clones).
 /// Handles loading, compilation, cloning, and lifecycle management.
 /// Singleton pattern - one instance per driver.
+///
+/// The store has one writer at a time: the game thread, or whoever it has
+/// handed the world to while it waits (a region worker holding the world
+/// lock exclusively, the thread that paused the loop). So its maps and
+/// registries are plain collections, with no locks on load, clone, destruct
+/// or find_living(). Other threads (the source watcher, metrics, the
+/// console) never read them: they read PublishedBlueprints, replaced
+/// whenever a blueprint comes or goes, and Snapshot, republished between
+/// ticks.
 /// </summary>
 public class ObjectManager
 {
     /// <summary>
     /// Blueprints cached by file path (without .c extension).
-    /// Thread-safe for concurrent loading from multiple connections.
     /// Key: "/std/weapon", "/obj/weapons/sword"
     /// Value: blueprint MudObject
     /// </summary>
-    private readonly ConcurrentDictionary<string, MudObject> _blueprints = new();
+    private readonly Dictionary<string, MudObject> _blueprints = new();
 
     /// <summary>
-    /// All objects (blueprints + clones) indexed by full name.
-    /// Thread-safe for concurrent lookups.
-    /// Key: "/std/weapon", "/obj/weapons/sword#5"
+    /// All objects (blueprints + clones) by file path and clone number, 0 for
+    /// a blueprint, so a clone's name is only formatted if someone asks for it.
+    /// Key: ("/std/weapon", 0), ("/obj/weapons/sword", 5)
     /// Value: MudObject
     /// </summary>
-    private readonly ConcurrentDictionary<string, MudObject> _allObjects = new();
+    private readonly Dictionary<(string Path, int Clone), MudObject> _allObjects = new();
 
     /// <summary>
-    /// Clone counter per blueprint path.
-    /// Used to generate unique clone numbers.
-    /// Locked during increment to ensure uniqueness.
+    /// Every path spelling load_object(), clone_object() and find_object()
+    /// have been given, normalized once, with the blueprint loaded from it.
     /// </summary>
-    private readonly Dictionary<string, int> _cloneCounters = new();
-    private readonly object _cloneCounterLock = new();
+    private readonly ObjectPathTable _paths = new();
+
+    /// <summary>
+    /// The blueprints as other threads see them: an immutable copy, replaced
+    /// (sharing all but a path's worth of nodes) on every add and remove.
+    /// </summary>
+    private volatile ImmutableDictionary<string, MudObject> _publishedBlueprints =
+        ImmutableDictionary<string, MudObject>.Empty;
+
+    /// <summary>
+    /// Bumped on every change to _allObjects, so PublishSnapshot() can tell
+    /// whether there is anything new to publish.
+    /// </summary>
+    private long _version;
+
+    private volatile ObjectStoreSnapshot _snapshot =
+        new(-1, new ObjectManagerStats(), new Dictionary<string, int>());
+
+    /// <summary>
+    /// Last clone number of blueprints that were destructed, so the next
+    /// blueprint loaded from the same path carries on from there. Live
+    /// blueprints keep their own counter.
+    /// </summary>
+    private readonly Dictionary<string, int> _retiredCloneCounters = new();
+
+    /// <summary>
+    /// Objects destructed since the last RecycleDestructed(), whose state is
+    /// released (and clones' variable arrays returned to their blueprints)
+    /// once no code can be running in them.
+    /// </summary>
+    private readonly Queue<MudObject> _destructed = new();
+
+    /// <summary>
+    /// Most destructed objects held for recycling. Past this (nothing calling
+    /// RecycleDestructed, as with no game loop) they are simply dropped.
+    /// </summary>
+    private const int MaxDestructed = 4096;
 
     /// <summary>
     /// Root directory for mudlib files.
@@ -42,18 +86,43 @@ public class ObjectManager
     /// <summary>
     /// Dependency tracking: which objects inherit from which.
     /// Key: parent path, Value: list of child paths
-    /// Used for future hot-reload implementation.
+    /// Used by hot reload to find what needs rebuilding.
     /// </summary>
     private readonly Dictionary<string, HashSet<string>> _inheritanceChildren = new();
-    private readonly object _inheritanceLock = new();
 
     /// <summary>
-    /// Living name registry: maps living names to objects.
-    /// Key: living name (lowercase), Value: object with that living name
-    /// Used by find_living() efun.
+    /// The same relationship the other way round (child path -> parent paths),
+    /// so a reload can untrack one program without scanning every parent.
+    /// </summary>
+    private readonly Dictionary<string, HashSet<string>> _inheritanceParents = new();
+
+    /// <summary>
+    /// Living name registry, a trie so find_living() and the prefix searches
+    /// of match_living() and resolve_living() cost O(name length).
     /// </summary>
-    private readonly Dictionary<string, MudObject> _livingNames = new();
-    private readonly object _livingNamesLock = new();
+    private readonly NameIndex _livingNames = new();
+
+    /// <summary>
+    /// Interactive (connected) objects in the order they connected, kept by
+    /// SetInteractive so users() and find_player() cost O(players), not a scan
+    /// of every object.
+    /// </summary>
+    private readonly List<MudObject> _users = new();
+
+    /// <summary>
+    /// Chat channel subscribers, for the channel_* efuns.
+    /// </summary>
+    public ChannelRegistry Channels { get; } = new();
+
+    /// <summary>
+    /// Event subscriptions, for subscribe(), unsubscribe() and emit().
+    /// </summary>
+    public EventBus Events { get; } = new();
+
+    /// <summary>
+    /// Named bounded histories, for the history_* efuns.
+    /// </summary>
+    public ConcurrentDictionary<string, HistoryLog> Histories { get; } = new();
 
     /// <summary>
     /// Object interpreter for executing LPC code within object contexts.
@@ -70,10 +139,96 @@ public class ObjectManager
     /// </summary>
     private readonly Preprocessor _preprocessor;
 
+    /// <summary>
+    /// Optional on-disk cache of parsed programs. When set, compiles reuse a
+    /// cached parse whose source and includes are unchanged.
+    /// </summary>
+    public ProgramCache? ProgramCache { get; set; }
+
+    /// <summary>
+    /// Lazy parsing: compiles read each function's signature and skip its
+    /// body, which is parsed and lowered to bytecode on its first call (or
+    /// when something else asks for it). Functions that never run cost no
+    /// tree or bytecode, but a syntax error in a body only shows when it is
+    /// called, and PerfLint doesn't see deferred bodies. The program cache
+    /// isn't used while this is on. Off by default.
+    /// </summary>
+    public bool LazyParse { get; set; }
+
+    /// <summary>
+    /// Whether clones of programs with a declarative create() start from the
+    /// state captured from the first one (see ClonePrototype). On by default.
+    /// </summary>
+    public bool ClonePrototypes { get; set; } = true;
+
+    /// <summary>
+    /// Optional store that save_object() writes to and restore_object() reads
+    /// from first, in place of .o files. Null keeps saves in files.
+    /// </summary>
+    public SaveStore? SaveStore { get; set; }
+
+    /// <summary>
+    /// Save files decoded ahead of restore_object().
+    /// </summary>
+    public RestorePrefetcher Restores { get; }
+
+    /// <summary>
+    /// File text, directory listings and resolved paths for the file efuns.
+    /// </summary>
+    public MudlibFileCache Files { get; }
+
+    /// <summary>
+    /// Rooms and the exits between them, for route finding.
+    /// </summary>
+    public WorldGraph WorldGraph { get; } = new();
+
+    /// <summary>
+    /// What look last rendered in each room.
+    /// </summary>
+    public RoomRenderCache RenderCache { get; } = new();
+
+    /// <summary>
+    /// Clones and estimated memory per blueprint, taken a slice per tick.
+    /// </summary>
+    public ObjectCensus Census { get; } = new();
+
+    /// <summary>
+    /// What each room spawns and the spawned clones still alive.
+    /// </summary>
+    public SpawnRegistry Spawns { get; } = new();
+
+    private HelpIndex? _help;
+
+    /// <summary>
+    /// The mudlib's help files. Built on first use without watching unless
+    /// the server sets one up at boot.
+    /// </summary>
+    public HelpIndex Help
+    {
+        get => _help ??= new HelpIndex(MudlibPath, watch: false);
+        set => _help = value;
+    }
+
     public ObjectManager(string mudlibPath)
     {
         MudlibPath = Path.GetFullPath(mudlibPath);
         _preprocessor = new Preprocessor(MudlibPath);
+        Files = new MudlibFileCache(MudlibPath);
+        Restores = new RestorePrefetcher(ReadSaveFile);
+    }
+
+    /// <summary>
+    /// The bytes of a save file by full path, or null if there is none: from
+    /// the save store first (a save made before it was in use is still in its
+    /// file), else from disk once queued writes to it have landed. Any thread.
+    /// </summary>
+    public byte[]? ReadSaveFile(string fullPath)
+    {
+        var data = SaveStore?.Get(SaveStore.KeyFor(MudlibPath, fullPath));
+        if (data != null) return data;
+
+        AsyncFileWriter.Shared.Settle(fullPath);
+        return File.Exists(fullPath) ? File.ReadAllBytes(fullPath) : null;
     }
 
     /// <summary>
@@ -93,18 +248,15 @@ public class ObjectManager
     /// <returns>Blueprint object</returns>
     public MudObject LoadObject(string path)
     {
-        // Normalize path (remove .c if present, ensure leading /)
-        path = NormalizePath(path);
-
-        // Check cache first (fast path)
-        if (_blueprints.TryGetValue(path, out var cached))
+        // Interned path (remove .c if present, ensure leading /), and its blueprint if loaded
+        var objectPath = _paths.Get(path);
+        if (objectPath.Blueprint is { } cached)
         {
             return cached;
         }
 
         // Not in cache - need to compile
-        // Use GetOrAdd for thread-safe lazy loading
-        return _blueprints.GetOrAdd(path, p => CompileAndLoad(p));
+        return AddBlueprint(objectPath.Name, CompileAndLoad(objectPath.Name));
     }
 
     /// <summary>
@@ -115,32 +267,22 @@ public class ObjectManager
     /// <returns>New clone object</returns>
     public MudObject CloneObject(string path)
     {
-        path = NormalizePath(path);
-
         // Load blueprint (will use cache if available)
         var blueprint = LoadObject(path);
 
-        // Get next clone number (thread-safe)
-        int cloneNumber;
-        lock (_cloneCounterLock)
-        {
-            if (!_cloneCounters.ContainsKey(path))
-            {
-                _cloneCounters[path] = 0;
-            }
-            cloneNumber = ++_cloneCounters[path];
-        }
+        // Get next clone number
+        int cloneNumber = blueprint.NextCloneNumber();
 
         // Create clone
         var clone = new MudObject(blueprint, cloneNumber);
 
         // Register in all objects
-        _allObjects[clone.ObjectName] = clone;
+        AddObject(clone);
 
-        // Call create() on the clone
+        // Call create() on the clone, or copy in the state it leaves
         if (_interpreter != null)
         {
-            CallCreate(clone);
+            CallCreate(clone, ClonePrototypes);
         }
 
         return clone;
@@ -154,8 +296,22 @@ public class ObjectManager
     /// <returns>Object or null if not found</returns>
     public MudObject? FindObject(string name)
     {
-        name = NormalizePath(name);
-        _allObjects.TryGetValue(name, out var obj);
+        int hash = name.IndexOf('#');
+        MudObject? obj;
+        if (hash < 0)
+        {
+            // Not the blueprint cache: a blueprint is findable while its create() runs
+            _allObjects.TryGetValue((_paths.Get(name).Name, 0), out obj);
+            return obj;
+        }
+
+        // Clone names are unbounded, so they aren't interned
+        if (!int.TryParse(name.AsSpan(hash + 1), NumberStyles.None, CultureInfo.InvariantCulture, out var number) ||
+            number == 0)
+        {
+            return null;
+        }
+        _allObjects.TryGetValue((NormalizePath(name[..hash]), number), out obj);
         return obj;
     }
 
@@ -174,6 +330,9 @@ public class ObjectManager
         // Call dest() lifecycle hook (Milestone 9+)
         // CallDest(obj);
 
+        // A player's logout handlers still see where it was
+        SetInteractive(obj, false);
+
         // Mark as destructed
         obj.IsDestructed = true;
 
@@ -189,14 +348,21 @@ public class ObjectManager
 
         // Remove living name registration
         RemoveLivingName(obj);
+        obj.ClearCombat();
+        Channels.UnsubscribeAll(obj);
+        Events.RemoveObject(obj);
 
         // Remove from all objects
-        _allObjects.TryRemove(obj.ObjectName, out _);
+        if (_allObjects.Remove(Key(obj))) _version++;
 
         // If it's a clone, remove from blueprint's clone list
         if (!obj.IsBlueprint && obj.Blueprint != null)
         {
-            obj.Blueprint.Clones.Remove(obj);
+            obj.Blueprint.RemoveClone(obj);
+        }
+        if (_destructed.Count < MaxDestructed)
+        {
+            _destructed.Enqueue(obj);
         }
 
         // If it's a blueprint, destruct all clones first
@@ -210,14 +376,98 @@ public class ObjectManager
             }
 
             // Remove from blueprint cache
-            _blueprints.TryRemove(obj.FilePath, out _);
+            if (_blueprints.Remove(obj.FilePath))
+            {
+                _paths.Get(obj.FilePath).Blueprint = null;
+                _publishedBlueprints = _publishedBlueprints.Remove(obj.FilePath);
+            }
+            _retiredCloneCounters[obj.FilePath] = obj.LastCloneNumber;
         }
     }
 
+    /// <summary>
+    /// Release the state of objects destructed since the last call (see
+    /// MudObject.ReleaseState). Clones' variable arrays go to their
+    /// blueprints' pools, so the next clone_object() of a corpse or a spell
+    /// effect reuses one instead of allocating. Code may still be running in
+    /// an object that destructed itself, so this waits for the game loop's end
+    /// of tick; forget lets the game loop drop its own references first.
+    ///
+    /// The destructed objects themselves are never reused: LPC values may
+    /// still point at them and must keep seeing them destructed. Because an
+    /// object's identity is never recycled, IsDestructed on the reference is
+    /// all a validity check needs.
+    /// </summary>
+    public void RecycleDestructed(Action<MudObject>? forget = null)
+    {
+        while (_destructed.TryDequeue(out var obj))
+        {
+            forget?.Invoke(obj);
+            obj.ReleaseState();
+        }
+    }
+
+    /// <summary>
+    /// One line of a mudlib source file, read from disk, for showing next to
+    /// an error. Compiled programs keep no source; file is a mudlib path as
+    /// errors report it ("/std/room" or "/include/foo.h"). Null if the file
+    /// or line isn't there.
+    /// </summary>
+    public string? ReadSourceLine(string file, int line)
+    {
+        if (line < 1 || string.IsNullOrEmpty(file)) return null;
+
+        var fullPath = Path.GetFullPath(Path.Combine(MudlibPath, file.TrimStart('/')));
+        if (!fullPath.StartsWith(MudlibPath, StringComparison.Ordinal)) return null;
+        if (!File.Exists(fullPath)) fullPath += ".c";
+        if (!File.Exists(fullPath)) return null;
+
+        try
+        {
+            return File.ReadLines(fullPath).Skip(line - 1).FirstOrDefault()?.Trim();
+        }
+        catch (IOException)
+        {
+            return null;
+        }
+    }
+
+    /// <summary>
+    /// Load a blueprint for WorldSnapshot to fill in: variable initializers
+    /// run, create() and reset() don't. An already loaded blueprint is
+    /// returned as it is.
+    /// </summary>
+    internal MudObject LoadForRestore(string path)
+    {
+        var objectPath = _paths.Get(path);
+        return objectPath.Blueprint ?? AddBlueprint(objectPath.Name, CompileAndLoad(objectPath.Name, create: false));
+    }
+
+    /// <summary>
+    /// Recreate a clone under the number it had when WorldSnapshot captured
+    /// it, without calling create(). New clones are numbered after it.
+    /// </summary>
+    internal MudObject RestoreClone(MudObject blueprint, int cloneNumber)
+    {
+        if (_allObjects.ContainsKey((blueprint.FilePath, cloneNumber)))
+        {
+            throw new ObjectManagerException($"{blueprint.FilePath}#{cloneNumber} already exists");
+        }
+
+        var clone = new MudObject(blueprint, cloneNumber);
+        if (blueprint.LastCloneNumber < cloneNumber)
+        {
+            blueprint.ContinueCloneNumbers(cloneNumber);
+        }
+        AddObject(clone);
+        ExecuteVariableInitializers(clone);
+        return clone;
+    }
+
     /// <summary>
     /// Compile and load a blueprint from a .c file.
     /// </summary>
-    private MudObject CompileAndLoad(string path)
+    private MudObject CompileAndLoad(string path, bool create = true)
     {
         // Construct full file path
         var fileName = path.TrimStart('/');
@@ -231,19 +481,30 @@ public class ObjectManager
         // Read source code
         var sourceCode = File.ReadAllText(fullPath);
 
-        // Compile to program
-        var program = CompileProgram(path, sourceCode);
+        // Compile to program, unless a boot-time precompile already did
+        var program = TakePrecompiled(path, sourceCode) ?? CompileProgram(path, sourceCode);
 
         // Create blueprint object
         var blueprint = new MudObject(program);
+        if (_retiredCloneCounters.Remove(path, out var lastCloneNumber))
+        {
+            blueprint.ContinueCloneNumbers(lastCloneNumber);
+        }
 
         // Register in all objects
-        _allObjects[blueprint.ObjectName] = blueprint;
+        AddObject(blueprint);
 
         // Execute variable initializers and call create()
         if (_interpreter != null)
         {
-            CallCreate(blueprint);
+            if (create)
+            {
+                CallCreate(blueprint);
+            }
+            else
+            {
+                ExecuteVariableInitializers(blueprint);
+            }
         }
 
         return blueprint;
@@ -253,52 +514,69 @@ public class ObjectManager
     /// Compile source code into an LpcProgram.
     /// Handles preprocessing, lexing, parsing, and inheritance resolution.
     /// </summary>
-    private LpcProgram CompileProgram(string path, string sourceCode)
+    private LpcProgram CompileProgram(string path, string sourceCode, LpcProgram? previous = null)
     {
-        // Preprocess the source code (handles #include, #define, etc.)
-        string preprocessedSource;
-        try
+        var (preprocessedSource, lineMap, statements, includedFiles) = ParseCached(path, sourceCode, _preprocessor);
+
+        var program = BuildProgram(path, preprocessedSource, lineMap, statements, parentPath =>
         {
-            preprocessedSource = _preprocessor.Process(sourceCode, path);
-        }
-        catch (PreprocessorException ex)
+            // Load the inherited program first (recursive)
+            var inheritedBlueprint = LoadObject(parentPath);
+
+            // Track inheritance for hot-reload
+            TrackInheritance(path, parentPath);
+            return inheritedBlueprint.Program;
+        }, previous);
+        program.IncludedFiles = includedFiles;
+        return program;
+    }
+
+    /// <summary>
+    /// Parse a source file, reusing the program cache's copy when it is current.
+    /// Also returns the files it #included, for the program's dependency record.
+    /// </summary>
+    private (string PreprocessedSource, SourceMap LineMap, List<Statement> Statements, List<string> IncludedFiles) ParseCached(
+        string path, string sourceCode, Preprocessor preprocessor)
+    {
+        // Deferred bodies are source, not trees, so there is nothing to cache
+        var cache = LazyParse ? null : ProgramCache;
+        var predefines = cache != null ? preprocessor.PredefinesFingerprint() : "";
+        var cached = cache?.TryLoad(path, sourceCode, predefines);
+        if (cached != null)
         {
-            throw new ObjectManagerException($"Preprocessor error in {path}: {ex.Message}", ex);
+            return (cached.PreprocessedSource, cached.LineMap, cached.Statements, cached.IncludedFiles);
         }
 
+        var (preprocessedSource, statements) = ParseSource(path, sourceCode, preprocessor, LazyParse);
+        var includedFiles = preprocessor.IncludedFiles.ToList();
+        var lineMap = preprocessor.LineMap;
+        cache?.Store(path, sourceCode, predefines, includedFiles,
+            preprocessedSource, lineMap, statements);
+        return (preprocessedSource, lineMap, statements, includedFiles);
+    }
+
+    /// <summary>
+    /// Build a program from parsed statements: resolve inherits through
+    /// resolveParent, then collect functions and variables and lower bytecode.
+    /// When previous (the program being replaced) is given, functions whose
+    /// source is unchanged keep their old definition and bytecode. The
+    /// preprocessed source is only read here, to fingerprint the functions;
+    /// the program keeps its line map instead.
+    /// </summary>
+    private static LpcProgram BuildProgram(string path, string preprocessedSource, SourceMap lineMap,
+        List<Statement> statements, Func<string, LpcProgram> resolveParent, LpcProgram? previous = null)
+    {
         var program = new LpcProgram(path)
         {
-            SourceCode = preprocessedSource
+            LineMap = lineMap
         };
 
-        // Lex
-        var lexer = new Lexer(preprocessedSource);
-        var tokens = new List<Token>();
-        while (true)
-        {
-            var token = lexer.NextToken();
-            if (token == null)
-                break;
-            tokens.Add(token);
-            if (token.Type == TokenType.Eof)
-                break;
-        }
-
-        // Parse
-        var parser = new Parser(tokens);
-        var statements = parser.ParseProgram();
-
         // Process statements to extract inherits, functions, and variables
         foreach (var stmt in statements)
         {
             if (stmt is InheritStatement inheritStmt)
             {
-                // Load the inherited program first (recursive)
-                var inheritedBlueprint = LoadObject(inheritStmt.Path);
-                program.InheritedPrograms.Add(inheritedBlueprint.Program);
-
-                // Track inheritance for future hot-reload
-                TrackInheritance(path, inheritStmt.Path);
+                program.InheritedPrograms.Add(resolveParent(inheritStmt.Path));
             }
             else if (stmt is FunctionDefinition funcDef)
             {
@@ -307,75 +585,401 @@ public class ObjectManager
             else if (stmt is VariableDeclaration varDecl)
             {
                 program.VariableNames.Add(varDecl.Name);
+                program.VariableTypes[varDecl.Name] = varDecl.Type;
+                if (varDecl.Initializer != null)
+                {
+                    program.VariableInitializers.Add(varDecl);
+                }
             }
         }
 
-        program.Ast = new BlockStatement(statements);
+        FingerprintFunctions(preprocessedSource, statements, program.FunctionFingerprints);
+        program.PerfWarnings = PerfLint.Check(path, statements, lineMap);
 
+        if (previous != null)
+        {
+            foreach (var (name, fingerprint) in program.FunctionFingerprints)
+            {
+                if (previous.FunctionFingerprints.TryGetValue(name, out var oldFingerprint) &&
+                    oldFingerprint == fingerprint &&
+                    previous.Functions.TryGetValue(name, out var oldDef))
+                {
+                    program.Functions[name] = oldDef;
+                }
+            }
+        }
+
+        program.BuildFunctionTables();
+        LowerFunctions(program, previous);
         return program;
     }
 
     /// <summary>
-    /// Normalize an object path:
-    /// - Remove .c extension if present
-    /// - Ensure leading /
-    /// - Handle clone suffix (#123)
+    /// Rebuild a program whose own source hasn't changed onto the current
+    /// programs of its parents: no reading or parsing, just a fresh dispatch
+    /// table, and bytecode reused unless the inherited variables changed.
     /// </summary>
-    private string NormalizePath(string path)
+    private LpcProgram RebuildProgram(LpcProgram previous)
     {
-        // Remove .c extension
-        if (path.EndsWith(".c"))
+        var program = new LpcProgram(previous.FilePath)
+        {
+            LineMap = previous.LineMap,
+            CompiledAt = previous.CompiledAt,
+            IncludedFiles = previous.IncludedFiles,
+            PerfWarnings = previous.PerfWarnings
+        };
+
+        foreach (var parent in previous.InheritedPrograms)
+        {
+            program.InheritedPrograms.Add(LoadObject(parent.FilePath).Program);
+        }
+        foreach (var (name, funcDef) in previous.Functions)
+        {
+            program.Functions[name] = funcDef;
+        }
+        program.VariableNames.AddRange(previous.VariableNames);
+        foreach (var (name, type) in previous.VariableTypes)
+        {
+            program.VariableTypes[name] = type;
+        }
+        program.VariableInitializers.AddRange(previous.VariableInitializers);
+        foreach (var (name, fingerprint) in previous.FunctionFingerprints)
         {
-            path = path[..^2];
+            program.FunctionFingerprints[name] = fingerprint;
         }
 
-        // Ensure leading /
-        if (!path.StartsWith('/'))
+        program.BuildFunctionTables();
+        LowerFunctions(program, previous);
+        return program;
+    }
+
+    /// <summary>
+    /// Lower function bodies to bytecode for the VM. A function carried over
+    /// from previous keeps its bytecode when the object variables it was
+    /// compiled against are the same (bytecode only depends on which names are
+    /// object variables; slots are resolved per layout at run time). Declared
+    /// types only pick int-specialized operators, which check their operands,
+    /// so a kept function stays correct if a variable's type was edited.
+    /// Bodies that have bytecode are then packed into an AstArena.
+    /// </summary>
+    private static void LowerFunctions(LpcProgram program, LpcProgram? previous)
+    {
+        var objectVariables = program.GetAllVariableNames().ToHashSet();
+        var variableTypes = program.GetAllVariableTypes();
+        bool sameVariables = previous != null && objectVariables.SetEquals(previous.GetAllVariableNames());
+        if (previous != null)
         {
-            path = "/" + path;
+            program.AdoptVariableLayout(previous.VariableLayout);
         }
 
-        return path;
+        foreach (var funcDef in program.Functions.Values)
+        {
+            // Lowered on first call instead (LpcProgram.LowerDeferred)
+            if (funcDef.IsDeferred) continue;
+
+            if (sameVariables && previous!.CompiledFunctions.TryGetValue(funcDef.Name, out var kept) &&
+                ReferenceEquals(kept.Definition, funcDef))
+            {
+                program.CompiledFunctions[funcDef.Name] = kept;
+                continue;
+            }
+
+            var compiled = BytecodeCompiler.Compile(funcDef, objectVariables, variableTypes);
+            if (compiled != null)
+            {
+                program.CompiledFunctions[funcDef.Name] = compiled;
+            }
+        }
+
+        // The VM runs the bytecode; the trees can go to the arena until something asks
+        AstArena.Pack(program.Functions.Values
+            .Where(funcDef => !funcDef.IsPacked && program.CompiledFunctions.ContainsKey(funcDef.Name))
+            .ToList());
+    }
+
+    /// <summary>
+    /// Fingerprint each top-level function: a 64-bit hash of the preprocessed
+    /// lines from its first line through the first line of the next
+    /// statement, and of where it starts (line numbers are baked into
+    /// bytecode and error messages, so a function that moved counts as
+    /// changed).
+    /// </summary>
+    private static void FingerprintFunctions(string source, List<Statement> statements, Dictionary<string, long> result)
+    {
+        var lines = source.Split('\n');
+        for (int i = 0; i < statements.Count; i++)
+        {
+            if (statements[i] is not FunctionDefinition funcDef || funcDef.Line < 1) continue;
+
+            int first = funcDef.Line - 1;
+            int last = i + 1 < statements.Count ? statements[i + 1].Line - 1 : lines.Length - 1;
+            last = Math.Clamp(last, first, lines.Length - 1);
+            if (first >= lines.Length) continue;
+
+            var text = funcDef.Line + ":" + string.Join('\n', lines, first, last - first + 1);
+            var hash = System.Security.Cryptography.SHA256.HashData(System.Text.Encoding.UTF8.GetBytes(text));
+            result[funcDef.Name] = BitConverter.ToInt64(hash);
+        }
     }
 
+    /// <summary>
+    /// Preprocess, lex and parse a source file into top-level statements,
+    /// then fold constants and drop dead branches (AstOptimizer). With lazy,
+    /// function bodies are only skipped over, to be parsed when first needed.
+    /// </summary>
+    private static (string PreprocessedSource, List<Statement> Statements) ParseSource(
+        string path, string sourceCode, Preprocessor preprocessor, bool lazy)
+    {
+        // Preprocess the source code (handles #include, #define, etc.)
+        string preprocessedSource;
+        try
+        {
+            preprocessedSource = preprocessor.Process(sourceCode, path);
+        }
+        catch (PreprocessorException ex)
+        {
+            throw new ObjectManagerException($"Preprocessor error in {path}: {ex.Message}", ex);
+        }
+
+        // Lex and parse together: the parser pulls tokens as it needs them
+        var parser = new Parser(new Lexer(preprocessedSource)) { DeferBodies = lazy, FilePath = path };
+        return (preprocessedSource, AstOptimizer.Optimize(parser.ParseProgram()));
+    }
+
+    /// <summary>
+    /// Normalize an object path without interning it, for callers off the
+    /// game thread (precompile workers) and paths seen once.
+    /// </summary>
+    private static string NormalizePath(string path) => ObjectPathTable.Normalize(path);
+
     /// <summary>
     /// Track inheritance relationship for future hot-reload support.
     /// </summary>
     private void TrackInheritance(string childPath, string parentPath)
     {
-        lock (_inheritanceLock)
+        if (!_inheritanceChildren.ContainsKey(parentPath))
         {
-            if (!_inheritanceChildren.ContainsKey(parentPath))
+            _inheritanceChildren[parentPath] = new HashSet<string>();
+        }
+        _inheritanceChildren[parentPath].Add(childPath);
+
+        if (!_inheritanceParents.ContainsKey(childPath))
+        {
+            _inheritanceParents[childPath] = new HashSet<string>();
+        }
+        _inheritanceParents[childPath].Add(parentPath);
+    }
+
+    /// <summary>
+    /// Forget what childPath inherits (before it is recompiled, which tracks
+    /// its inherits again).
+    /// </summary>
+    private void UntrackInheritance(string childPath)
+    {
+        if (!_inheritanceParents.Remove(childPath, out var parents)) return;
+        foreach (var parent in parents)
+        {
+            if (_inheritanceChildren.TryGetValue(parent, out var children))
+            {
+                children.Remove(childPath);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Get all objects that inherit from a given path.
+    /// Used by hot reload to find what needs rebuilding.
+    /// </summary>
+    public HashSet<string> GetInheritanceChildren(string path)
+    {
+        if (_inheritanceChildren.TryGetValue(path, out var children))
+        {
+            return new HashSet<string>(children);
+        }
+        return new HashSet<string>();
+    }
+
+    /// <summary>
+    /// Parse a file without building or loading it, for tools that inspect
+    /// source (the world graph reads room exits this way).
+    /// </summary>
+    public List<Statement> ParseFile(string path)
+    {
+        path = NormalizePath(path);
+        var source = File.ReadAllText(Path.Combine(MudlibPath, path.TrimStart('/') + ".c"));
+        return ParseCached(path, source, _preprocessor.Fork()).Statements;
+    }
+
+    #region Boot Precompilation
+
+    /// <summary>
+    /// Programs compiled ahead of time by Precompile(), waiting for their first
+    /// LoadObject. Each remembers the source it was built from, a hash of every
+    /// file it #included and the parent paths it inherits, so a stale entry is
+    /// detected and compiled normally.
+    /// </summary>
+    private readonly ConcurrentDictionary<string, PrecompiledProgram> _precompiled = new();
+
+    private sealed record PrecompiledProgram(LpcProgram Program, string SourceCode, List<string> ParentPaths,
+        List<(string Path, string Hash)> Includes)
+    {
+        /// <summary>
+        /// Whether every #included file is still what the program was built from.
+        /// </summary>
+        public bool IncludesUnchanged => Includes.All(include =>
+            File.Exists(include.Path) && ProgramCache.HashFile(include.Path) == include.Hash);
+    }
+
+    private static List<(string Path, string Hash)> HashIncludes(List<string> includes, ConcurrentDictionary<string, string>? hashes = null)
+    {
+        return includes
+            .Select(include => (include, hashes != null ? hashes.GetOrAdd(include, ProgramCache.HashFile) : ProgramCache.HashFile(include)))
+            .ToList();
+    }
+
+    /// <summary>
+    /// Number of precompiled programs not yet loaded.
+    /// </summary>
+    public int PrecompiledCount => _precompiled.Count;
+
+    /// <summary>
+    /// Compile every .c file under the mudlib ahead of time, in parallel.
+    /// Files are parsed concurrently, then built a level of the inheritance
+    /// DAG at a time (a program only after all of its parents). Nothing is
+    /// loaded: blueprints are still created, and create() still runs, on the
+    /// first LoadObject, which now picks up the finished program instead of
+    /// compiling. Files that fail are reported and left to compile lazily.
+    /// </summary>
+    /// <param name="root">Mudlib directory to walk, e.g. "/" or "/world"</param>
+    /// <param name="maxParallelism">Worker count (defaults to the processor count)</param>
+    public PrecompileReport Precompile(string root = "/", int maxParallelism = 0)
+    {
+        var total = System.Diagnostics.Stopwatch.StartNew();
+        var options = new ParallelOptions
+        {
+            MaxDegreeOfParallelism = maxParallelism > 0 ? maxParallelism : Environment.ProcessorCount
+        };
+
+        var rootDir = Path.Combine(MudlibPath, root.Trim('/'));
+        var paths = Directory.Exists(rootDir)
+            ? Directory.EnumerateFiles(rootDir, "*.c", SearchOption.AllDirectories)
+                .Select(file => NormalizePath("/" + Path.GetRelativePath(MudlibPath, file).Replace(Path.DirectorySeparatorChar, '/')))
+                .Where(path => !PublishedBlueprints.ContainsKey(path))
+                .ToList()
+            : new List<string>();
+
+        var results = new ConcurrentDictionary<string, PrecompiledFile>();
+        var parsed = new ConcurrentDictionary<string, (string Source, string Preprocessed, SourceMap LineMap, List<Statement> Statements, List<string> Includes, double Ms)>();
+
+        // Parse phase: each worker gets its own preprocessor
+        Parallel.ForEach(paths, options, () => _preprocessor.Fork(), (path, _, preprocessor) =>
+        {
+            var sw = System.Diagnostics.Stopwatch.StartNew();
+            try
             {
-                _inheritanceChildren[parentPath] = new HashSet<string>();
+                var source = File.ReadAllText(Path.Combine(MudlibPath, path.TrimStart('/') + ".c"));
+                var (preprocessed, lineMap, statements, includes) = ParseCached(path, source, preprocessor);
+                parsed[path] = (source, preprocessed, lineMap, statements, includes, sw.Elapsed.TotalMilliseconds);
             }
-            _inheritanceChildren[parentPath].Add(childPath);
+            catch (Exception ex)
+            {
+                results[path] = new PrecompiledFile(path, sw.Elapsed.TotalMilliseconds, ex.Message);
+            }
+            return preprocessor;
+        }, _ => { });
+
+        // Order by inheritance and group into levels whose members only depend on earlier levels
+        var parentMap = parsed.ToDictionary(
+            entry => entry.Key,
+            entry => entry.Value.Statements.OfType<InheritStatement>()
+                .Select(inherit => NormalizePath(inherit.Path))
+                .Where(parsed.ContainsKey)
+                .ToHashSet());
+        var level = new Dictionary<string, int>();
+        foreach (var path in TopologicalSort(parentMap))
+        {
+            level[path] = parentMap[path].Select(parent => level.GetValueOrDefault(parent) + 1).DefaultIfEmpty(0).Max();
+        }
+
+        // Build phase, one level at a time
+        var programs = new ConcurrentDictionary<string, LpcProgram>();
+        var includeHashes = new ConcurrentDictionary<string, string>();
+        foreach (var wave in level.GroupBy(entry => entry.Value).OrderBy(group => group.Key))
+        {
+            Parallel.ForEach(wave.Select(entry => entry.Key), options, path =>
+            {
+                var (source, preprocessed, lineMap, statements, includes, parseMs) = parsed[path];
+                var sw = System.Diagnostics.Stopwatch.StartNew();
+                var parentPaths = new List<string>();
+                try
+                {
+                    var program = BuildProgram(path, preprocessed, lineMap, statements, parentPath =>
+                    {
+                        parentPath = NormalizePath(parentPath);
+                        parentPaths.Add(parentPath);
+                        if (programs.TryGetValue(parentPath, out var parent))
+                        {
+                            return parent;
+                        }
+                        if (PublishedBlueprints.TryGetValue(parentPath, out var loaded))
+                        {
+                            return loaded.Program;
+                        }
+                        throw new ObjectManagerException($"Inherited program {parentPath} was not precompiled");
+                    });
+
+                    program.IncludedFiles = includes;
+                    programs[path] = program;
+                    _precompiled[path] = new PrecompiledProgram(program, source, parentPaths, HashIncludes(includes, includeHashes));
+                    results[path] = new PrecompiledFile(path, parseMs + sw.Elapsed.TotalMilliseconds, null);
+                }
+                catch (Exception ex)
+                {
+                    results[path] = new PrecompiledFile(path, parseMs + sw.Elapsed.TotalMilliseconds, ex.Message);
+                }
+            });
         }
+
+        var files = results.Values.OrderBy(file => file.Path, StringComparer.Ordinal).ToList();
+        return new PrecompileReport(files, total.Elapsed.TotalMilliseconds);
     }
 
     /// <summary>
-    /// Get all objects that inherit from a given path.
-    /// Used for future hot-reload to find what needs recompiling.
+    /// Claim a precompiled program for path if it still matches the source on
+    /// disk, the headers it includes and the programs its parents have actually
+    /// loaded with.
     /// </summary>
-    public HashSet<string> GetInheritanceChildren(string path)
+    private LpcProgram? TakePrecompiled(string path, string sourceCode)
     {
-        lock (_inheritanceLock)
+        if (!_precompiled.TryRemove(path, out var entry) || entry.SourceCode != sourceCode || !entry.IncludesUnchanged)
         {
-            if (_inheritanceChildren.TryGetValue(path, out var children))
-            {
-                return new HashSet<string>(children);
-            }
-            return new HashSet<string>();
+            return null;
+        }
+
+        // Parents load (and run create()) first, exactly as on the compile path
+        bool current = true;
+        for (int i = 0; i < entry.ParentPaths.Count; i++)
+        {
+            var parent = LoadObject(entry.ParentPaths[i]);
+            TrackInheritance(path, entry.ParentPaths[i]);
+            current &= ReferenceEquals(parent.Program, entry.Program.InheritedPrograms[i]);
         }
+
+        return current ? entry.Program : null;
     }
 
+    #endregion
+
     #region Hot-Reload System
 
     /// <summary>
     /// Update (hot-reload) an object and all objects that depend on it.
-    /// This recompiles the blueprint from source and updates the inheritance chain.
-    /// Existing clones automatically get the new code (they dynamically reference
-    /// their blueprint's program).
+    /// The object itself is recompiled from source; functions whose text is
+    /// unchanged keep their definitions and bytecode. Descendants whose files
+    /// haven't changed since they were compiled are not re-read or re-parsed,
+    /// just rebuilt onto the new parent programs. Existing clones automatically
+    /// get the new code (they dynamically reference their blueprint's program);
+    /// their variables move to the new layout only if it actually changed.
     /// Returns the number of objects successfully updated.
     /// </summary>
     public int UpdateObject(string path)
@@ -385,6 +989,12 @@ public class ObjectManager
         // Get all objects that need to be reloaded (this + all descendants in inheritance tree)
         var toUpdate = GetDependencyChain(path);
 
+        // Anything precompiled against the old code is out of date
+        foreach (var objPath in toUpdate)
+        {
+            _precompiled.TryRemove(objPath, out _);
+        }
+
         // Sort so parents are updated before children (topological sort)
         var sorted = TopologicalSort(toUpdate);
 
@@ -396,15 +1006,7 @@ public class ObjectManager
             {
                 // Get old blueprint if it exists
                 _blueprints.TryGetValue(objPath, out var oldBlueprint);
-
-                // Remove inheritance tracking for this path (will be re-added on compile)
-                lock (_inheritanceLock)
-                {
-                    foreach (var children in _inheritanceChildren.Values)
-                    {
-                        children.Remove(objPath);
-                    }
-                }
+                var oldProgram = oldBlueprint?.Program;
 
                 // Construct full file path
                 var fileName = objPath.TrimStart('/');
@@ -416,35 +1018,26 @@ public class ObjectManager
                     continue;
                 }
 
-                // Read and compile the new source
-                var sourceCode = File.ReadAllText(fullPath);
-                var newProgram = CompileProgram(objPath, sourceCode);
-
-                if (oldBlueprint != null)
+                LpcProgram newProgram;
+                if (objPath != path && oldProgram != null &&
+                    File.GetLastWriteTimeUtc(fullPath) <= oldProgram.CompiledAt)
                 {
-                    // Update the existing blueprint's program (clones will automatically use it)
-                    oldBlueprint.UpdateProgram(newProgram);
-
-                    // Add any new variables to the blueprint and all its clones
-                    var newVarNames = newProgram.GetAllVariableNames();
-                    foreach (var varName in newVarNames)
-                    {
-                        // Add to blueprint if missing
-                        if (!oldBlueprint.Variables.ContainsKey(varName))
-                        {
-                            oldBlueprint.Variables[varName] = 0;
-                        }
+                    // Same source, new parents: only the dispatch table changes
+                    newProgram = RebuildProgram(oldProgram);
+                }
+                else
+                {
+                    // Remove inheritance tracking for this path (will be re-added on compile)
+                    UntrackInheritance(objPath);
 
-                        // Add to all clones if missing
-                        foreach (var clone in oldBlueprint.Clones)
-                        {
-                            if (!clone.IsDestructed && !clone.Variables.ContainsKey(varName))
-                            {
-                                clone.Variables[varName] = 0;
-                            }
-                        }
-                    }
+                    // Use a program the source watcher already built, if it is still current
+                    var sourceCode = File.ReadAllText(fullPath);
+                    newProgram = TakeStaged(objPath, sourceCode) ?? CompileProgram(objPath, sourceCode, oldProgram);
+                }
 
+                if (oldBlueprint != null)
+                {
+                    SwapProgram(oldBlueprint, oldProgram!, newProgram);
                     updated++;
                     Logger.Debug($"Hot-reloaded: {objPath}", LogCategory.Object);
                 }
@@ -452,8 +1045,12 @@ public class ObjectManager
                 {
                     // No existing blueprint - create a new one
                     var newBlueprint = new MudObject(newProgram);
-                    _blueprints[objPath] = newBlueprint;
-                    _allObjects[newBlueprint.ObjectName] = newBlueprint;
+                    if (_retiredCloneCounters.Remove(objPath, out var lastCloneNumber))
+                    {
+                        newBlueprint.ContinueCloneNumbers(lastCloneNumber);
+                    }
+                    AddBlueprint(objPath, newBlueprint);
+                    AddObject(newBlueprint);
 
                     if (_interpreter != null)
                     {
@@ -470,9 +1067,203 @@ public class ObjectManager
             }
         }
 
+        // Inline caches keyed on the replaced programs can never hit again; let them go
+        CallSiteCache.InvalidateAll();
+
         return updated;
     }
 
+    /// <summary>
+    /// Put a loaded blueprint onto a new program. Clones follow automatically
+    /// (they reference their blueprint's program); the blueprint and its
+    /// clones move onto the new variable layout, keeping values by name.
+    /// </summary>
+    private static void SwapProgram(MudObject blueprint, LpcProgram oldProgram, LpcProgram newProgram)
+    {
+        blueprint.UpdateProgram(newProgram);
+        if (oldProgram.HasInit != newProgram.HasInit)
+        {
+            blueprint.RefreshInitListing();
+            foreach (var clone in blueprint.Clones)
+            {
+                clone.RefreshInitListing();
+            }
+        }
+
+        // One slot map shared by all of them (nothing to do if the layout was kept)
+        var oldLayout = oldProgram.VariableLayout;
+        var newLayout = newProgram.VariableLayout;
+        if (!ReferenceEquals(oldLayout, newLayout))
+        {
+            var slotMap = newLayout.MapFrom(oldLayout);
+            blueprint.MigrateVariables(oldLayout, newLayout, slotMap);
+            foreach (var clone in blueprint.Clones)
+            {
+                if (!clone.IsDestructed)
+                {
+                    clone.MigrateVariables(oldLayout, newLayout, slotMap);
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Compile sourceCode as the program at path, with no file behind it.
+    /// The first time, the blueprint is loaded (and created) as usual; after
+    /// that the new program is swapped into it as update would, keeping its
+    /// variables by name. The --eval/--repl scratch object lives this way.
+    /// </summary>
+    public MudObject LoadSource(string path, string sourceCode)
+    {
+        path = NormalizePath(path);
+        _blueprints.TryGetValue(path, out var blueprint);
+        var oldProgram = blueprint?.Program;
+
+        UntrackInheritance(path);
+        var program = CompileProgram(path, sourceCode, oldProgram);
+        if (blueprint == null)
+        {
+            blueprint = new MudObject(program);
+            AddBlueprint(path, blueprint);
+            AddObject(blueprint);
+            if (_interpreter != null)
+            {
+                CallCreate(blueprint);
+            }
+            return blueprint;
+        }
+
+        SwapProgram(blueprint, oldProgram!, program);
+        CallSiteCache.InvalidateAll();
+        return blueprint;
+    }
+
+    /// <summary>
+    /// Programs compiled off the game thread for a source file that changed
+    /// (see SourceWatcher), waiting for ApplyStagedReloads() to swap them in.
+    /// </summary>
+    private readonly ConcurrentDictionary<string, PrecompiledProgram> _staged = new();
+    private readonly ConcurrentQueue<string> _stagedOrder = new();
+
+    /// <summary>
+    /// Number of staged programs not yet applied.
+    /// </summary>
+    public int StagedReloadCount => _staged.Count;
+
+    /// <summary>
+    /// Compile a loaded blueprint's changed source against its parents'
+    /// current programs, without touching any object, and queue the result for
+    /// ApplyStagedReloads(). Safe to call from any thread. A path that isn't
+    /// loaded but is #included by loaded programs stages each of them instead.
+    /// Returns false (and logs why) if nothing was staged or the file doesn't
+    /// compile; a file with an error is left for an explicit update to report.
+    /// </summary>
+    public bool StageReload(string path)
+    {
+        path = NormalizePath(path);
+        var blueprints = PublishedBlueprints;
+        if (!blueprints.TryGetValue(path, out var blueprint))
+        {
+            var headerPath = Path.GetFullPath(Path.Combine(MudlibPath, path.TrimStart('/') + ".c"));
+            bool staged = false;
+            foreach (var includer in GetIncluders(blueprints, headerPath))
+            {
+                staged |= StageReload(includer);
+            }
+            return staged;
+        }
+
+        try
+        {
+            var fullPath = Path.Combine(MudlibPath, path.TrimStart('/') + ".c");
+            AsyncFileWriter.Shared.Settle(fullPath);
+            var source = File.ReadAllText(fullPath);
+            var (preprocessed, lineMap, statements, includes) = ParseCached(path, source, _preprocessor.Fork());
+
+            var parentPaths = new List<string>();
+            var program = BuildProgram(path, preprocessed, lineMap, statements, parentPath =>
+            {
+                parentPath = NormalizePath(parentPath);
+                parentPaths.Add(parentPath);
+                if (blueprints.TryGetValue(parentPath, out var parent))
+                {
+                    return parent.Program;
+                }
+                throw new ObjectManagerException($"Inherited program {parentPath} is not loaded");
+            }, blueprint.Program);
+            program.IncludedFiles = includes;
+
+            _staged[path] = new PrecompiledProgram(program, source, parentPaths, HashIncludes(includes));
+            _stagedOrder.Enqueue(path);
+            return true;
+        }
+        catch (Exception ex)
+        {
+            Logger.Warning($"Not reloading {path}: {ex.Message}", LogCategory.Object);
+            return false;
+        }
+    }
+
+    /// <summary>
+    /// Paths of the loaded programs whose source #includes fullPath.
+    /// </summary>
+    private static List<string> GetIncluders(ImmutableDictionary<string, MudObject> blueprints, string fullPath)
+    {
+        return blueprints.Values
+            .Where(blueprint => blueprint.Program.IncludedFiles.Contains(fullPath))
+            .Select(blueprint => blueprint.FilePath)
+            .ToList();
+    }
+
+    /// <summary>
+    /// Swap in every staged program (and rebuild its descendants). Called by the
+    /// game loop between ticks. Returns the paths updated.
+    /// </summary>
+    public List<string> ApplyStagedReloads()
+    {
+        var applied = new List<string>();
+        while (_stagedOrder.TryDequeue(out var path))
+        {
+            // Already taken by an earlier update in this batch, or queued twice
+            if (!_staged.ContainsKey(path)) continue;
+
+            int updated = UpdateObject(path);
+            if (updated > 0)
+            {
+                applied.Add(path);
+                Logger.Info($"Auto-reloaded {path} ({updated} object(s))", LogCategory.Object);
+            }
+        }
+        return applied;
+    }
+
+    /// <summary>
+    /// Claim the staged program for path if it was built from sourceCode, the
+    /// headers as they are now and against the programs its parents have now.
+    /// </summary>
+    private LpcProgram? TakeStaged(string path, string sourceCode)
+    {
+        if (!_staged.TryRemove(path, out var entry) || entry.SourceCode != sourceCode || !entry.IncludesUnchanged)
+        {
+            return null;
+        }
+
+        for (int i = 0; i < entry.ParentPaths.Count; i++)
+        {
+            if (!_blueprints.TryGetValue(entry.ParentPaths[i], out var parent) ||
+                !ReferenceEquals(parent.Program, entry.Program.InheritedPrograms[i]))
+            {
+                return null;
+            }
+        }
+
+        foreach (var parentPath in entry.ParentPaths)
+        {
+            TrackInheritance(path, parentPath);
+        }
+        return entry.Program;
+    }
+
     /// <summary>
     /// Get all objects that depend on the given path (including the path itself).
     /// This traverses the inheritance tree to find all descendants.
@@ -505,38 +1296,50 @@ public class ObjectManager
     /// </summary>
     private List<string> TopologicalSort(HashSet<string> objects)
     {
-        // For each object, count how many of its parents are in the set
-        var inDegree = new Dictionary<string, int>();
         var parentMap = new Dictionary<string, HashSet<string>>();
-
         foreach (var obj in objects)
         {
-            inDegree[obj] = 0;
             parentMap[obj] = new HashSet<string>();
         }
 
         // Build parent relationships
-        lock (_inheritanceLock)
+        foreach (var obj in objects)
+        {
+            if (_inheritanceParents.TryGetValue(obj, out var parents))
+            {
+                parentMap[obj].UnionWith(parents.Where(objects.Contains));
+            }
+        }
+
+        return TopologicalSort(parentMap);
+    }
+
+    /// <summary>
+    /// Topological sort over an explicit parent map (object -> parents in the set).
+    /// Objects caught in a cycle are appended at the end.
+    /// </summary>
+    private static List<string> TopologicalSort(Dictionary<string, HashSet<string>> parentMap)
+    {
+        // For each object, count how many of its parents are in the set
+        var inDegree = new Dictionary<string, int>();
+        var childMap = new Dictionary<string, List<string>>();
+
+        foreach (var (obj, parents) in parentMap)
         {
-            foreach (var (parent, children) in _inheritanceChildren)
+            inDegree[obj] = parents.Count;
+            foreach (var parent in parents)
             {
-                if (objects.Contains(parent))
+                if (!childMap.TryGetValue(parent, out var children))
                 {
-                    foreach (var child in children)
-                    {
-                        if (objects.Contains(child))
-                        {
-                            inDegree[child]++;
-                            parentMap[child].Add(parent);
-                        }
-                    }
+                    childMap[parent] = children = new List<string>();
                 }
+                children.Add(obj);
             }
         }
 
         // Process objects with no dependencies first
         var result = new List<string>();
-        var ready = new Queue<string>(objects.Where(o => inDegree[o] == 0));
+        var ready = new Queue<string>(parentMap.Keys.Where(o => inDegree[o] == 0));
 
         while (ready.Count > 0)
         {
@@ -544,10 +1347,9 @@ public class ObjectManager
             result.Add(current);
 
             // Decrease in-degree for all children
-            var children = GetInheritanceChildren(current);
-            foreach (var child in children)
+            if (childMap.TryGetValue(current, out var children))
             {
-                if (inDegree.ContainsKey(child))
+                foreach (var child in children)
                 {
                     inDegree[child]--;
                     if (inDegree[child] == 0)
@@ -559,12 +1361,13 @@ public class ObjectManager
         }
 
         // If result doesn't contain all objects, there's a cycle (shouldn't happen)
-        if (result.Count < objects.Count)
+        if (result.Count < parentMap.Count)
         {
             // Just add remaining objects at the end
-            foreach (var obj in objects)
+            var sorted = result.ToHashSet();
+            foreach (var obj in parentMap.Keys)
             {
-                if (!result.Contains(obj))
+                if (!sorted.Contains(obj))
                 {
                     result.Add(obj);
                 }
@@ -598,6 +1401,53 @@ public class ObjectManager
 
     #endregion
 
+    /// <summary>
+    /// Add a blueprint under path, or keep the one already there (one
+    /// loaded while path's own create() ran), and publish it.
+    /// </summary>
+    private MudObject AddBlueprint(string path, MudObject blueprint)
+    {
+        if (_blueprints.TryAdd(path, blueprint))
+        {
+            _publishedBlueprints = _publishedBlueprints.SetItem(path, blueprint);
+        }
+        return _paths.Get(path).Blueprint = _blueprints[path];
+    }
+
+    private void AddObject(MudObject obj)
+    {
+        _allObjects[Key(obj)] = obj;
+        _version++;
+    }
+
+    private static (string Path, int Clone) Key(MudObject obj) => (obj.FilePath, obj.CloneNumber ?? 0);
+
+    /// <summary>
+    /// The loaded blueprints by path, for threads other than the game
+    /// thread: an immutable copy that is current as of the last load or
+    /// destruct of a blueprint.
+    /// </summary>
+    public ImmutableDictionary<string, MudObject> PublishedBlueprints => _publishedBlueprints;
+
+    /// <summary>
+    /// Object counts as of the last PublishSnapshot(), for threads other than
+    /// the game thread.
+    /// </summary>
+    public ObjectStoreSnapshot Snapshot => _snapshot;
+
+    /// <summary>
+    /// Publish the current counts as Snapshot, if anything changed since the
+    /// last time, and return it. The game loop calls this between ticks.
+    /// </summary>
+    public ObjectStoreSnapshot PublishSnapshot()
+    {
+        if (_snapshot.Version != _version)
+        {
+            _snapshot = new ObjectStoreSnapshot(_version, GetStats(), GetCloneCounts());
+        }
+        return _snapshot;
+    }
+
     /// <summary>
     /// Get all loaded blueprints (for debugging/admin commands).
     /// </summary>
@@ -627,6 +1477,22 @@ public class ObjectManager
         };
     }
 
+    /// <summary>
+    /// Live clones of each blueprint that has any, by blueprint name.
+    /// </summary>
+    public Dictionary<string, int> GetCloneCounts()
+    {
+        var counts = new Dictionary<string, int>();
+        foreach (var obj in _allObjects.Values)
+        {
+            if (obj.Blueprint is { } blueprint)
+            {
+                counts[blueprint.ObjectName] = counts.GetValueOrDefault(blueprint.ObjectName) + 1;
+            }
+        }
+        return counts;
+    }
+
     /// <summary>
     /// Reload all loaded LPC blueprints from disk.
     /// This hot-reloads all mudlib code without restarting the server.
@@ -672,83 +1538,101 @@ public class ObjectManager
     /// </summary>
     public void SetLivingName(MudObject obj, string? name)
     {
-        lock (_livingNamesLock)
+        if (obj.LivingName != null)
         {
-            // Remove old living name if present
-            if (obj.LivingName != null)
-            {
-                var oldKey = obj.LivingName.ToLowerInvariant();
-                if (_livingNames.TryGetValue(oldKey, out var existing) && existing == obj)
-                {
-                    _livingNames.Remove(oldKey);
-                }
-            }
-
-            // Set new living name
-            obj.LivingName = name;
+            _livingNames.Remove(obj.LivingName, obj);
+        }
 
-            // Register in lookup table if name is provided
-            if (name != null)
-            {
-                var key = name.ToLowerInvariant();
-                _livingNames[key] = obj;
-            }
+        obj.LivingName = name;
+        if (name != null)
+        {
+            _livingNames.Add(name, obj);
         }
     }
 
     /// <summary>
-    /// Find a living object by its living name.
+    /// Find a living object by its living name, the latest to take it.
     /// Returns null if not found.
     /// </summary>
     public MudObject? FindLiving(string name)
     {
-        var key = name.ToLowerInvariant();
-        lock (_livingNamesLock)
-        {
-            if (_livingNames.TryGetValue(key, out var obj) && !obj.IsDestructed)
-            {
-                return obj;
-            }
-            return null;
-        }
+        return Latest(_livingNames.Find(name), playersOnly: false);
     }
 
     /// <summary>
-    /// Find an interactive player by name (looks at living name).
+    /// Find an interactive player by living name.
     /// Returns null if not found or not interactive.
     /// </summary>
     public MudObject? FindPlayer(string name)
     {
-        var obj = FindLiving(name);
-        if (obj != null && obj.IsInteractive)
+        return Latest(_livingNames.Find(name), playersOnly: true);
+    }
+
+    /// <summary>
+    /// Livings (or only players) whose names begin with prefix, in name order.
+    /// </summary>
+    public List<MudObject> MatchLivings(string prefix, bool playersOnly, int limit = int.MaxValue)
+    {
+        return _livingNames.WithPrefix(prefix, obj => IsLiving(obj, playersOnly), limit);
+    }
+
+    /// <summary>
+    /// Resolve an abbreviated name, as "tell bo hi" does: a living of exactly
+    /// that name wins, then the only one whose name begins with it. Otherwise
+    /// Match is null and Candidates lists the names it could mean (none, or
+    /// several).
+    /// </summary>
+    public (MudObject? Match, List<MudObject> Candidates) ResolveLiving(string abbreviation, bool playersOnly)
+    {
+        if (Latest(_livingNames.Find(abbreviation), playersOnly) is { } exact)
         {
-            return obj;
+            return (exact, new List<MudObject> { exact });
         }
 
-        // Also try searching all interactive objects
-        foreach (var candidate in _allObjects.Values)
+        var candidates = MatchLivings(abbreviation, playersOnly);
+        return (candidates.Count == 1 ? candidates[0] : null, candidates);
+    }
+
+    private static MudObject? Latest(ReadOnlySpan<MudObject> named, bool playersOnly)
+    {
+        for (int i = named.Length - 1; i >= 0; i--)
         {
-            if (candidate.IsInteractive && !candidate.IsDestructed)
-            {
-                // Check if living name matches
-                if (candidate.LivingName?.Equals(name, StringComparison.OrdinalIgnoreCase) == true)
-                {
-                    return candidate;
-                }
-            }
+            if (IsLiving(named[i], playersOnly)) return named[i];
         }
-
         return null;
     }
 
+    private static bool IsLiving(MudObject obj, bool playersOnly)
+    {
+        return !obj.IsDestructed && (!playersOnly || obj.IsInteractive);
+    }
+
     /// <summary>
     /// Get all interactive (connected) players.
     /// </summary>
     public List<MudObject> GetUsers()
     {
-        return _allObjects.Values
-            .Where(o => o.IsInteractive && !o.IsDestructed)
-            .ToList();
+        return _users.Where(o => !o.IsDestructed).ToList();
+    }
+
+    /// <summary>
+    /// Mark an object connected or not, keeping the users() registry in step.
+    /// GameLoop calls this at login, reconnect, linkdeath and logout.
+    /// Disconnecting emits the "logout" event first (login is emitted by
+    /// GameLoop once the player is in the world).
+    /// </summary>
+    public void SetInteractive(MudObject obj, bool interactive)
+    {
+        if (obj.IsInteractive && !interactive)
+        {
+            _interpreter?.EmitEvent(obj, "logout");
+        }
+        obj.IsInteractive = interactive;
+        _users.Remove(obj);
+        if (interactive)
+        {
+            _users.Add(obj);
+        }
     }
 
     /// <summary>
@@ -758,14 +1642,7 @@ public class ObjectManager
     {
         if (obj.LivingName == null) return;
 
-        lock (_livingNamesLock)
-        {
-            var key = obj.LivingName.ToLowerInvariant();
-            if (_livingNames.TryGetValue(key, out var existing) && existing == obj)
-            {
-                _livingNames.Remove(key);
-            }
-        }
+        _livingNames.Remove(obj.LivingName, obj);
     }
 
     #endregion
@@ -774,7 +1651,10 @@ public class ObjectManager
     /// Call the create() lifecycle hook on an object.
     /// Executes variable initializers, the create() function, and then reset().
     /// </summary>
-    private void CallCreate(MudObject obj)
+    /// <param name="obj">The new object</param>
+    /// <param name="usePrototype">For a clone: start from the program's ClonePrototype
+    /// when create() is declarative, capturing it on the first clone</param>
+    private void CallCreate(MudObject obj, bool usePrototype = false)
     {
         if (_interpreter == null)
         {
@@ -783,12 +1663,28 @@ public class ObjectManager
 
         try
         {
-            // First, execute variable initializers from the program
-            ExecuteVariableInitializers(obj);
+            var program = obj.Program;
+            var prototype = usePrototype ? program.Prototype : null;
+            if (prototype != null)
+            {
+                prototype.Apply(obj);
+            }
+            else
+            {
+                // First, execute variable initializers from the program
+                ExecuteVariableInitializers(obj);
 
-            // Then call create() if it exists, using proper function call mechanism
-            // This ensures the executing program is tracked for correct :: behavior
-            _interpreter.CallFunctionOnObjectInit(obj, "create");
+                // Then call create() if it exists, using proper function call mechanism
+                // This ensures the executing program is tracked for correct :: behavior
+                _interpreter.CallFunctionOnObjectInit(obj, "create");
+
+                // Two clones racing to capture both get the same state; either may win
+                if (usePrototype && !program.PrototypeRefused && program.HasDeclarativeCreate)
+                {
+                    program.Prototype = ClonePrototype.Capture(obj);
+                    program.PrototypeRefused = program.Prototype == null;
+                }
+            }
 
             // Call reset() immediately after create() completes
             // This is standard LPMud behavior for initial object setup
@@ -803,25 +1699,19 @@ public class ObjectManager
     /// <summary>
     /// Execute variable initializers for an object.
     /// In LPC, variable declarations can have initializers: int damage = 10;
-    /// These are executed before create().
+    /// These are executed before create(). Constant ones are already in the
+    /// object's slots (LpcProgram.InitialVariables); only the rest run here.
     /// </summary>
     private void ExecuteVariableInitializers(MudObject obj)
     {
-        if (_interpreter == null || obj.Program.Ast == null)
+        if (_interpreter == null)
         {
             return;
         }
 
-        // Find all variable declarations in the program's AST
-        if (obj.Program.Ast is BlockStatement block)
+        foreach (var varDecl in obj.Program.DynamicInitializers)
         {
-            foreach (var stmt in block.Statements)
-            {
-                if (stmt is VariableDeclaration varDecl && varDecl.Initializer != null)
-                {
-                    _interpreter.ExecuteInObject(obj, varDecl);
-                }
-            }
+            _interpreter.ExecuteInObject(obj, varDecl);
         }
     }
 }
@@ -836,6 +1726,27 @@ public record ObjectManagerStats
     public int CloneCount { get; init; }
 }
 
+/// <summary>
+/// The object store's figures at one moment, published for other threads.
+/// Version counts changes to the store.
+/// </summary>
+public sealed record ObjectStoreSnapshot(long Version, ObjectManagerStats Stats, IReadOnlyDictionary<string, int> CloneCounts);
+
+/// <summary>
+/// One file's result from ObjectManager.Precompile().
+/// Error is null when the program compiled.
+/// </summary>
+public record PrecompiledFile(string Path, double Milliseconds, string? Error);
+
+/// <summary>
+/// Outcome of a boot-time precompile: per-file timings and the wall-clock total.
+/// </summary>
+public record PrecompileReport(List<PrecompiledFile> Files, double TotalMilliseconds)
+{
+    public int Compiled => Files.Count(file => file.Error == null);
+    public int Failed => Files.Count(file => file.Error != null);
+}
+
 /// <summary>
 /// Exception thrown by ObjectManager.
 /// </summary>
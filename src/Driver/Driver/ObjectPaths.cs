@@ -0,0 +1,90 @@
+namespace Driver;
+
+/// <summary>
+/// One canonical object path ("/std/weapon"), shared by every spelling of it
+/// that has been looked up ("std/weapon", "/std/weapon.c"). It remembers the
+/// blueprint loaded from it, so load_object() and clone_object() of a loaded
+/// path cost one dictionary probe.
+/// </summary>
+public sealed class ObjectPath
+{
+    /// <summary>
+    /// The canonical path: leading '/', no ".c".
+    /// </summary>
+    public string Name { get; }
+
+    /// <summary>
+    /// The blueprint loaded from this path, kept in step with the blueprint
+    /// table by ObjectManager. Null while none is loaded.
+    /// </summary>
+    internal MudObject? Blueprint { get; set; }
+
+    internal ObjectPath(string name)
+    {
+        Name = name;
+    }
+}
+
+/// <summary>
+/// Interned object paths: each distinct path string an efun is given is
+/// normalized once, and maps to the ObjectPath for its canonical form after
+/// that. Paths come mostly from string literals in mudlib code, so the table
+/// stays small; past MaxEntries new spellings are normalized without being
+/// remembered. Game thread only, like the rest of the object store.
+/// </summary>
+public sealed class ObjectPathTable
+{
+    public const int MaxEntries = 1 << 16;
+
+    private readonly Dictionary<string, ObjectPath> _paths = new();
+
+    /// <summary>
+    /// Spellings remembered, canonical ones included.
+    /// </summary>
+    public int Count => _paths.Count;
+
+    /// <summary>
+    /// The ObjectPath for path, which may be spelled any way Normalize accepts.
+    /// </summary>
+    public ObjectPath Get(string path)
+    {
+        if (_paths.TryGetValue(path, out var known))
+        {
+            return known;
+        }
+
+        var name = Normalize(path);
+        if (!_paths.TryGetValue(name, out var canonical))
+        {
+            if (_paths.Count >= MaxEntries) return new ObjectPath(name);
+            canonical = new ObjectPath(name);
+            _paths[name] = canonical;
+        }
+        if (_paths.Count < MaxEntries)
+        {
+            _paths[path] = canonical;
+        }
+        return canonical;
+    }
+
+    /// <summary>
+    /// Normalize an object path:
+    /// - Remove .c extension if present
+    /// - Ensure leading /
+    /// Safe on any thread.
+    /// </summary>
+    public static string Normalize(string path)
+    {
+        if (path.EndsWith(".c", StringComparison.Ordinal))
+        {
+            path = path[..^2];
+        }
+
+        if (!path.StartsWith('/'))
+        {
+            path = "/" + path;
+        }
+
+        return path;
+    }
+}
@@ -0,0 +1,170 @@
+using System.Net.Sockets;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// Outbound network requests for the http_request() and tcp_request()
+/// efuns: web lookups, chat bridges, stats pushes.
+///
+/// A request runs as async I/O on the thread pool, never on the game thread.
+/// Its result comes back as a zero-delay call_out of the object's callback,
+/// posted to the game thread, so a slow or dead remote end costs the tick
+/// nothing. Each object may have MaxPerObject requests in flight; past that a
+/// request isn't started. Every request has a timeout (at most MaxTimeout)
+/// and a cap on the response it reads. A result for an object destructed in
+/// the meantime is dropped.
+///
+/// Results are LPC mappings: ([ "status", "body", "headers" ]) for HTTP,
+/// ([ "data" ]) for TCP, or ([ "error" ]) when the request failed or timed out.
+/// </summary>
+public sealed class OutboundRequests
+{
+    public static readonly TimeSpan DefaultTimeout = TimeSpan.FromSeconds(10);
+    public static readonly TimeSpan MaxTimeout = TimeSpan.FromSeconds(60);
+
+    /// <summary>
+    /// Requests one object may have in flight.
+    /// </summary>
+    public int MaxPerObject { get; set; } = 4;
+
+    /// <summary>
+    /// Most bytes of a response read; a longer one is an error.
+    /// </summary>
+    public int MaxResponseBytes { get; set; } = 1024 * 1024;
+
+    // No HttpClient timeout: each request brings its own
+    private static readonly HttpClient Client = new(new SocketsHttpHandler
+    {
+        PooledConnectionLifetime = TimeSpan.FromMinutes(5),
+        AllowAutoRedirect = true
+    })
+    {
+        Timeout = Timeout.InfiniteTimeSpan
+    };
+
+    private readonly Dictionary<MudObject, int> _inFlight = new();
+    private int _nextId;
+
+    /// <summary>
+    /// Requests in flight, over all objects.
+    /// </summary>
+    public int InFlight
+    {
+        get
+        {
+            lock (_inFlight)
+            {
+                return _inFlight.Values.Sum();
+            }
+        }
+    }
+
+    /// <summary>
+    /// Send request for owner. done gets the result mapping on a pool thread.
+    /// Returns the request's id, or 0 without starting it if owner is at its
+    /// limit.
+    /// </summary>
+    public int Http(MudObject owner, HttpRequestMessage request, TimeSpan timeout, Action<int, LpcMapping> done)
+    {
+        return Start(owner, timeout, done, async cancel =>
+        {
+            using var owned = request;
+            using var response = await Client.SendAsync(request, HttpCompletionOption.ResponseHeadersRead, cancel);
+            var headers = new LpcMapping();
+            foreach (var (name, values) in response.Headers.Concat(response.Content.Headers))
+            {
+                headers[name.ToLowerInvariant()] = string.Join(", ", values);
+            }
+            var body = await ReadLimited(await response.Content.ReadAsStreamAsync(cancel), cancel);
+            return new LpcMapping
+            {
+                ["status"] = (long)response.StatusCode,
+                ["body"] = body,
+                ["headers"] = headers
+            };
+        });
+    }
+
+    /// <summary>
+    /// Connect to host:port for owner, send data, then read until the other
+    /// end closes. done gets the result mapping on a pool thread. Returns the
+    /// request's id, or 0 without starting it if owner is at its limit.
+    /// </summary>
+    public int Tcp(MudObject owner, string host, int port, string data, TimeSpan timeout, Action<int, LpcMapping> done)
+    {
+        return Start(owner, timeout, done, async cancel =>
+        {
+            using var client = new TcpClient();
+            await client.ConnectAsync(host, port, cancel);
+            var stream = client.GetStream();
+            await stream.WriteAsync(Encoding.UTF8.GetBytes(data), cancel);
+            client.Client.Shutdown(SocketShutdown.Send);
+            return new LpcMapping { ["data"] = await ReadLimited(stream, cancel) };
+        });
+    }
+
+    private int Start(MudObject owner, TimeSpan timeout, Action<int, LpcMapping> done,
+        Func<CancellationToken, Task<LpcMapping>> work)
+    {
+        int id;
+        lock (_inFlight)
+        {
+            int running = _inFlight.GetValueOrDefault(owner);
+            if (running >= MaxPerObject) return 0;
+            _inFlight[owner] = running + 1;
+            id = ++_nextId;
+        }
+
+        _ = Task.Run(async () =>
+        {
+            LpcMapping result;
+            using var cancel = new CancellationTokenSource(timeout);
+            try
+            {
+                result = await work(cancel.Token);
+            }
+            catch (OperationCanceledException) when (cancel.IsCancellationRequested)
+            {
+                result = new LpcMapping { ["error"] = "timed out" };
+            }
+            catch (Exception ex)
+            {
+                result = new LpcMapping { ["error"] = ex.Message };
+            }
+
+            try
+            {
+                done(id, result);
+            }
+            catch (Exception ex)
+            {
+                Logger.Error($"Outbound request completion failed: {ex.Message}", LogCategory.System);
+            }
+            lock (_inFlight)
+            {
+                if (--_inFlight[owner] == 0) _inFlight.Remove(owner);
+            }
+        });
+        return id;
+    }
+
+    /// <summary>
+    /// Read stream to the end as UTF-8, failing past MaxResponseBytes.
+    /// </summary>
+    private async Task<string> ReadLimited(Stream stream, CancellationToken cancel)
+    {
+        var buffer = new MemoryStream();
+        var chunk = new byte[8192];
+        int read;
+        while ((read = await stream.ReadAsync(chunk, cancel)) > 0)
+        {
+            if (buffer.Length + read > MaxResponseBytes)
+            {
+                throw new InvalidDataException($"response over {MaxResponseBytes} bytes");
+            }
+            buffer.Write(chunk, 0, read);
+        }
+        return Encoding.UTF8.GetString(buffer.GetBuffer(), 0, (int)buffer.Length);
+    }
+}
@@ -0,0 +1,43 @@
+namespace Driver;
+
+/// <summary>
+/// What a connection does when a client stops reading and its output queue
+/// reaches the limit.
+/// </summary>
+public enum OutputOverflowPolicy
+{
+    /// <summary>
+    /// Discard the oldest unsent output to make room; the player stays connected.
+    /// </summary>
+    DropOldest,
+
+    /// <summary>
+    /// Close the socket and let the player go linkdead, as if they hung up.
+    /// </summary>
+    Linkdead,
+
+    /// <summary>
+    /// Close the socket and log the player out (saved, not linkdead).
+    /// </summary>
+    Disconnect
+}
+
+/// <summary>
+/// Per-connection bound on output that has been written but not yet accepted
+/// by the client's socket.
+/// </summary>
+/// <param name="MaxQueuedBytes">Bytes allowed in the send queue</param>
+/// <param name="Policy">What happens when a write would exceed it</param>
+public record OutputLimits(int MaxQueuedBytes, OutputOverflowPolicy Policy)
+{
+    /// <summary>
+    /// 256 KB is many screens of scrollback; well-behaved clients never get
+    /// near it. Slow clients go linkdead so they can reconnect.
+    /// </summary>
+    public static OutputLimits Default { get; } = new(256 * 1024, OutputOverflowPolicy.Linkdead);
+}
+
+/// <summary>
+/// Output counters summed over all open connections.
+/// </summary>
+public record OutputStats(int Connections, long QueuedBytes, long BytesSent, long BytesDropped, long Overflows);
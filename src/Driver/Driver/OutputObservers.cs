@@ -0,0 +1,147 @@
+namespace Driver;
+
+/// <summary>
+/// Snoop: connections that get a copy of other connections' output. The
+/// server thread hands an observer the very string it gave the target, so
+/// a broadcast is still rendered once per color class and watching a player
+/// costs no interpreted code and no string building. Before a run of
+/// output from one target, an observer gets that target's Header line, so
+/// it can tell twenty players' output apart.
+///
+/// Changes (snoop(), a disconnect) are rare and happen under a lock; the
+/// server thread reads a snapshot that is swapped whole, without locking,
+/// for every message it delivers.
+/// </summary>
+public sealed class OutputObservers
+{
+    /// <summary>
+    /// An observer of one target: its connection and the line it gets
+    /// before that target's output.
+    /// </summary>
+    public readonly record struct Observer(string ConnectionId, string Header);
+
+    private readonly object _lock = new();
+    private volatile Dictionary<string, Observer[]> _byTarget = new(StringComparer.Ordinal);
+
+    /// <summary>
+    /// Observations in place, over all targets.
+    /// </summary>
+    public int Count
+    {
+        get
+        {
+            int count = 0;
+            foreach (var observers in _byTarget.Values)
+            {
+                count += observers.Length;
+            }
+            return count;
+        }
+    }
+
+    /// <summary>
+    /// The observers of target's output; empty if there are none (server thread, lock-free).
+    /// </summary>
+    public ReadOnlySpan<Observer> For(string target)
+    {
+        var byTarget = _byTarget;
+        return byTarget.Count != 0 && byTarget.TryGetValue(target, out var observers) ? observers : default;
+    }
+
+    /// <summary>
+    /// Start copying target's output to observer. False if it already is,
+    /// or the two are the same connection.
+    /// </summary>
+    public bool Add(string target, string observer, string header)
+    {
+        if (target == observer) return false;
+
+        lock (_lock)
+        {
+            var current = _byTarget.TryGetValue(target, out var existing) ? existing : Array.Empty<Observer>();
+            foreach (var entry in current)
+            {
+                if (entry.ConnectionId == observer) return false;
+            }
+
+            var next = new Dictionary<string, Observer[]>(_byTarget, StringComparer.Ordinal)
+            {
+                [target] = current.Append(new Observer(observer, header)).ToArray()
+            };
+            _byTarget = next;
+            return true;
+        }
+    }
+
+    /// <summary>
+    /// Stop copying output to observer: target's, or everyone's if target
+    /// is null. Returns how many observations ended.
+    /// </summary>
+    public int Remove(string observer, string? target = null)
+    {
+        lock (_lock)
+        {
+            return Rebuild((entryTarget, entry) =>
+                entry.ConnectionId == observer && (target == null || entryTarget == target));
+        }
+    }
+
+    /// <summary>
+    /// A connection has closed: it neither observes nor is observed any more.
+    /// </summary>
+    public void RemoveConnection(string connectionId)
+    {
+        lock (_lock)
+        {
+            if (_byTarget.Count == 0) return;
+            Rebuild((entryTarget, entry) => entryTarget == connectionId || entry.ConnectionId == connectionId);
+        }
+    }
+
+    /// <summary>
+    /// Connections observing target.
+    /// </summary>
+    public List<string> ObserversOf(string target)
+    {
+        var result = new List<string>();
+        foreach (var entry in For(target))
+        {
+            result.Add(entry.ConnectionId);
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Connections observer is watching.
+    /// </summary>
+    public List<string> TargetsOf(string observer)
+    {
+        var result = new List<string>();
+        foreach (var (target, observers) in _byTarget)
+        {
+            foreach (var entry in observers)
+            {
+                if (entry.ConnectionId == observer) result.Add(target);
+            }
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Publish a snapshot without the observations drop matches; returns
+    /// how many were dropped (caller holds _lock).
+    /// </summary>
+    private int Rebuild(Func<string, Observer, bool> drop)
+    {
+        var next = new Dictionary<string, Observer[]>(StringComparer.Ordinal);
+        int dropped = 0;
+        foreach (var (target, observers) in _byTarget)
+        {
+            var kept = observers.Where(entry => !drop(target, entry)).ToArray();
+            dropped += observers.Length - kept.Length;
+            if (kept.Length > 0) next[target] = kept;
+        }
+        if (dropped > 0) _byTarget = next;
+        return dropped;
+    }
+}
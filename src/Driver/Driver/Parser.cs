@@ -6,12 +6,44 @@ namespace Driver;
 /// </summary>
 public class Parser
 {
-    private readonly List<Token> _tokens;
+    /// <summary>
+    /// How many tokens are kept: the parser looks at most a few ahead and one
+    /// behind, so tokens are read into a small ring rather than all at once.
+    /// </summary>
+    private const int WindowSize = 16;
+
+    private readonly Lexer? _lexer;
+    private readonly List<Token>? _list;
+    private readonly Token[] _window = new Token[WindowSize];
+    private int _read;
+    private bool _ended;
     private int _position;
 
     public Parser(List<Token> tokens)
     {
-        _tokens = tokens;
+        _list = tokens;
+    }
+
+    /// <summary>
+    /// Lazy parsing: when parsing from a lexer, ParseProgram() reads each
+    /// function's signature but only skips over its body, matching braces,
+    /// and leaves it as a DeferredBody to be parsed the first time it is
+    /// needed. Syntax errors inside a body surface then, instead of at load.
+    /// </summary>
+    public bool DeferBodies { get; init; }
+
+    /// <summary>
+    /// Mudlib path of the file being parsed, named in the syntax errors of
+    /// deferred bodies.
+    /// </summary>
+    public string FilePath { get; init; } = "";
+
+    /// <summary>
+    /// Parse straight from a lexer, reading tokens only as they are needed.
+    /// </summary>
+    public Parser(Lexer lexer)
+    {
+        _lexer = lexer;
     }
 
     /// <summary>
@@ -126,34 +158,34 @@ public class Parser
         // Function definition pattern: [visibility...] [varargs] type [*] identifier(
         // Skip any visibility modifiers and varargs first
         var offset = 0;
-        while (_position + offset < _tokens.Count &&
-               (IsVisibilityModifier(_tokens[_position + offset].Type) ||
-                _tokens[_position + offset].Type == TokenType.Varargs))
+        while (Has(_position + offset) &&
+               (IsVisibilityModifier(At(_position + offset).Type) ||
+                At(_position + offset).Type == TokenType.Varargs))
         {
             offset++;
         }
 
         // Now check for type name
-        if (_position + offset >= _tokens.Count || !IsTypeName(_tokens[_position + offset].Type))
+        if (!Has(_position + offset) || !IsTypeName(At(_position + offset).Type))
         {
             return false;
         }
         offset++; // Move past the type
 
         // Check for array return type: type *identifier(
-        if (_position + offset < _tokens.Count && _tokens[_position + offset].Type == TokenType.Star)
+        if (Has(_position + offset) && At(_position + offset).Type == TokenType.Star)
         {
             offset++; // Move past the *
         }
 
         // Look ahead for identifier followed by (
-        if (_position + offset + 1 >= _tokens.Count)
+        if (!Has(_position + offset + 1))
         {
             return false;
         }
 
-        var identToken = _tokens[_position + offset];
-        var parenToken = _tokens[_position + offset + 1];
+        var identToken = At(_position + offset);
+        var parenToken = At(_position + offset + 1);
 
         return identToken.Type == TokenType.Identifier && parenToken.Type == TokenType.LeftParen;
     }
@@ -179,13 +211,13 @@ public class Parser
     private bool IsLocalVariableDeclaration()
     {
         // Need at least 2 tokens ahead
-        if (_position + 1 >= _tokens.Count)
+        if (!Has(_position + 1))
         {
             return false;
         }
 
         var current = Current();
-        var next = _tokens[_position + 1];
+        var next = At(_position + 1);
 
         // Must start with a type keyword (not just any identifier, to avoid ambiguity)
         // We check for actual type keywords, not identifiers which could be function calls
@@ -201,19 +233,19 @@ public class Parser
         if (next.Type == TokenType.Star)
         {
             // Need one more token for the identifier
-            if (_position + 2 >= _tokens.Count)
+            if (!Has(_position + 2))
             {
                 return false;
             }
-            var afterStar = _tokens[_position + 2];
+            var afterStar = At(_position + 2);
             if (afterStar.Type != TokenType.Identifier)
             {
                 return false;
             }
             // Make sure it's not a function: type *func()
-            if (_position + 3 < _tokens.Count)
+            if (Has(_position + 3))
             {
-                var fourth = _tokens[_position + 3];
+                var fourth = At(_position + 3);
                 if (fourth.Type == TokenType.LeftParen)
                 {
                     return false;
@@ -229,9 +261,9 @@ public class Parser
         }
 
         // If there's a third token, make sure it's not '(' (which would make this a function)
-        if (_position + 2 < _tokens.Count)
+        if (Has(_position + 2))
         {
-            var third = _tokens[_position + 2];
+            var third = At(_position + 2);
             if (third.Type == TokenType.LeftParen)
             {
                 return false; // This is a function definition, not a variable
@@ -324,24 +356,28 @@ public class Parser
         }
 
         var parameters = new List<string>();
+        var parameterTypes = new List<string>();
         if (!Check(TokenType.RightParen))
         {
             do
             {
-                // Skip parameter type if present (handles "type name", "type *name", or just "name")
-                if (IsTypeName(Current().Type) && _position + 1 < _tokens.Count)
+                // Parameter type if present (handles "type name", "type *name", or just "name")
+                var paramType = "mixed";
+                if (IsTypeName(Current().Type) && Has(_position + 1))
                 {
-                    var next = _tokens[_position + 1];
+                    var next = At(_position + 1);
                     // Pattern: type *name (array parameter)
-                    if (next.Type == TokenType.Star && _position + 2 < _tokens.Count
-                        && _tokens[_position + 2].Type == TokenType.Identifier)
+                    if (next.Type == TokenType.Star && Has(_position + 2)
+                        && At(_position + 2).Type == TokenType.Identifier)
                     {
+                        paramType = Current().Lexeme + " *";
                         Advance(); // Skip type
                         Advance(); // Skip *
                     }
                     // Pattern: type name (typed parameter)
                     else if (next.Type == TokenType.Identifier)
                     {
+                        paramType = Current().Lexeme;
                         Advance(); // Skip type
                     }
                     // Otherwise, current identifier IS the parameter name (no type)
@@ -352,6 +388,7 @@ public class Parser
                     throw new ParserException("Expected parameter name", Current());
                 }
                 parameters.Add(Previous().Lexeme);
+                parameterTypes.Add(paramType);
             } while (Match(TokenType.Comma));
         }
 
@@ -365,15 +402,61 @@ public class Parser
         {
             throw new ParserException("Expected '{' before function body", Current());
         }
+
+        if (DeferBodies && _lexer != null)
+        {
+            var openBrace = Previous();
+            SkipBlock();
+            return new FunctionDefinition(returnType, name, parameters, null!, visibility, isVarargs, parameterTypes)
+            {
+                Line = startToken.Line,
+                Column = startToken.Column
+            }.Defer(new DeferredBody(_lexer.Source, openBrace.Offset, openBrace.Line, openBrace.Column, name, FilePath));
+        }
+
         var body = ParseBlockStatement();
 
-        return new FunctionDefinition(returnType, name, parameters, body, visibility, isVarargs)
+        return new FunctionDefinition(returnType, name, parameters, body, visibility, isVarargs, parameterTypes)
         {
             Line = startToken.Line,
             Column = startToken.Column
         };
     }
 
+    /// <summary>
+    /// Parse one function body, '{' to its '}', as DeferredBody.Parse() does.
+    /// </summary>
+    public BlockStatement ParseFunctionBody()
+    {
+        if (!Match(TokenType.LeftBrace))
+        {
+            throw new ParserException("Expected '{' before function body", Current());
+        }
+        return ParseBlockStatement();
+    }
+
+    /// <summary>
+    /// Skip to just past the '}' closing the block whose '{' was the last
+    /// token read. "({" opens a brace too: its "})" is lexed as '}' ')'.
+    /// </summary>
+    private void SkipBlock()
+    {
+        int depth = 1;
+        while (!IsAtEnd())
+        {
+            var type = Advance().Type;
+            if (type == TokenType.LeftBrace || type == TokenType.ArrayStart)
+            {
+                depth++;
+            }
+            else if (type == TokenType.RightBrace && --depth == 0)
+            {
+                return;
+            }
+        }
+        throw new ParserException("Expected '}' after block", Current());
+    }
+
     private InheritStatement ParseInheritStatement()
     {
         var inheritToken = Current();
@@ -583,6 +666,16 @@ public class Parser
         }
         var variable = Previous().Lexeme;
 
+        string? valueVariable = null;
+        if (Match(TokenType.Comma))
+        {
+            if (!Match(TokenType.Identifier))
+            {
+                throw new ParserException("Expected value variable name after ',' in foreach", Current());
+            }
+            valueVariable = Previous().Lexeme;
+        }
+
         if (!Match(TokenType.In))
         {
             throw new ParserException("Expected 'in' after foreach variable", Current());
@@ -597,7 +690,7 @@ public class Parser
 
         var body = ParseStatement();
 
-        return new ForEachStatement(variable, collection, body)
+        return new ForEachStatement(variable, collection, body, valueVariable)
         {
             Line = foreachToken.Line,
             Column = foreachToken.Column
@@ -1309,7 +1402,7 @@ public class Parser
         if (Match(TokenType.String))
         {
             var token = Previous();
-            return new StringLiteral(token.Lexeme)
+            return new StringLiteral(StringPool.Intern(token.Lexeme))
             {
                 Line = token.Line,
                 Column = token.Column
@@ -1483,21 +1576,62 @@ public class Parser
 
     private Token Current()
     {
-        if (_position >= _tokens.Count)
-        {
-            return _tokens[^1]; // Return EOF token
-        }
-        return _tokens[_position];
+        return At(_position);
     }
 
     private Token Previous()
     {
-        return _tokens[_position - 1];
+        return At(_position - 1);
     }
 
     private bool IsAtEnd()
     {
-        return _position >= _tokens.Count || Current().Type == TokenType.Eof;
+        return !Has(_position) || Current().Type == TokenType.Eof;
+    }
+
+    /// <summary>
+    /// Whether there is a token at index, reading up to it if need be.
+    /// </summary>
+    private bool Has(int index)
+    {
+        while (index >= _read && !_ended)
+        {
+            Token token;
+            if (_lexer != null)
+            {
+                token = _lexer.NextToken() ?? _lexer.EndToken();
+            }
+            else if (_read < _list!.Count)
+            {
+                token = _list[_read];
+            }
+            else
+            {
+                _ended = true;
+                break;
+            }
+
+            _window[_read % WindowSize] = token;
+            _read++;
+            _ended = token.Type == TokenType.Eof;
+        }
+        return index < _read;
+    }
+
+    /// <summary>
+    /// The token at index; past the end, the last one (Eof).
+    /// </summary>
+    private Token At(int index)
+    {
+        if (!Has(index))
+        {
+            index = _read - 1;
+        }
+        if (index <= _read - WindowSize)
+        {
+            throw new InvalidOperationException($"Parser looked back to token {index}, which has left its window");
+        }
+        return _window[index % WindowSize];
     }
 
     private bool Check(TokenType type)
@@ -1506,6 +1640,21 @@ public class Parser
         return Current().Type == type;
     }
 
+    private bool Match(TokenType type)
+    {
+        if (Check(type))
+        {
+            Advance();
+            return true;
+        }
+        return false;
+    }
+
+    private bool Match(TokenType first, TokenType second)
+    {
+        return Match(first) || Match(second);
+    }
+
     private bool Match(params TokenType[] types)
     {
         foreach (var type in types)
@@ -1531,6 +1680,53 @@ public class Parser
     #endregion
 }
 
+/// <summary>
+/// A function body left unparsed by lazy parsing (Parser.DeferBodies): the
+/// file's preprocessed source and where the body's '{' is in it. Parse()
+/// lexes and parses just that body, then folds constants as a whole-file
+/// parse would, so the tree's lines are the same as if it had been parsed at
+/// load. A syntax error is reported as a runtime error naming the function,
+/// whichever engine asked for the body.
+/// </summary>
+public sealed class DeferredBody
+{
+    private readonly string _source;
+    private readonly int _offset;
+    private readonly string _functionName;
+    private readonly string _filePath;
+
+    public DeferredBody(string source, int offset, int line, int column, string functionName, string filePath)
+    {
+        _source = source;
+        _offset = offset;
+        Line = line;
+        Column = column;
+        _functionName = functionName;
+        _filePath = filePath;
+    }
+
+    /// <summary>
+    /// Line of the body's '{'.
+    /// </summary>
+    public int Line { get; }
+
+    public int Column { get; }
+
+    public Statement Parse()
+    {
+        try
+        {
+            var parser = new Parser(new Lexer(_source, _offset, Line, Column));
+            return AstOptimizer.OptimizeBody(parser.ParseFunctionBody());
+        }
+        catch (Exception ex) when (ex is ParserException or LexerException)
+        {
+            // Lazy parsing: this is where the body's syntax is first checked
+            throw new ObjectInterpreterException($"Syntax error in {_functionName}() of {_filePath}: {ex.Message}", ex);
+        }
+    }
+}
+
 public class ParserException : Exception
 {
     public int Line { get; }
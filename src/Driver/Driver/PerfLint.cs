@@ -0,0 +1,196 @@
+namespace Driver;
+
+/// <summary>
+/// A costly pattern PerfLint found, at a line of the file it is in.
+/// </summary>
+public sealed record PerfWarning(string File, int Line, string Function, string Message)
+{
+    public override string ToString() => $"{File}:{Line}: {Message} (in {Function}())";
+}
+
+/// <summary>
+/// Looks through a program's functions at compile time for the patterns
+/// that make mudlib code slow as the world grows:
+///   - "x = x + ({ ... })" (or a mapping) in a loop, where x is an object
+///     variable, which copies x on every pass, so building n elements costs
+///     O(n^2). A local is grown in place by the VM (see AppendLocal);
+///   - a for condition that calls a function, which runs again on every
+///     pass ("i &lt; sizeof(all_inventory(room))"). sizeof() or strlen() of
+///     a variable is left alone: that is O(1) here;
+///   - call_other inside a loop nested in another, where either loop walks
+///     all_inventory() or deep_inventory(): O(n*m) calls per pass.
+/// The warnings are kept on the program (LpcProgram.PerfWarnings) for
+/// perf_warnings() and the update and load commands to show. They don't
+/// stop anything from compiling.
+/// </summary>
+public static class PerfLint
+{
+    private static readonly HashSet<string> InventoryEfuns = new() { "all_inventory", "deep_inventory" };
+    private static readonly HashSet<string> ConstantTimeEfuns = new() { "sizeof", "strlen" };
+
+    /// <summary>
+    /// Check the functions among a program's top-level statements. Lines are
+    /// resolved through lineMap when there is one, so a warning in an
+    /// #included file names that file.
+    /// </summary>
+    public static List<PerfWarning> Check(string path, List<Statement> statements, SourceMap? lineMap)
+    {
+        var warnings = new List<PerfWarning>();
+        // Bodies left for lazy parsing aren't looked at
+        foreach (var function in statements.OfType<FunctionDefinition>().Where(function => !function.IsDeferred))
+        {
+            new Walker(path, function, lineMap, warnings).Statement(function.Body);
+        }
+        return warnings;
+    }
+
+    private sealed class Walker
+    {
+        private readonly string _path;
+        private readonly string _function;
+        private readonly SourceMap? _lineMap;
+        private readonly List<PerfWarning> _warnings;
+
+        // Parameters and the locals declared so far
+        private readonly HashSet<string> _locals;
+
+        // Enclosing loops, innermost last: whether each walks an inventory,
+        // and whether a call_other in it has been reported
+        private readonly List<(bool OverInventory, bool Reported)> _loops = new();
+
+        public Walker(string path, FunctionDefinition function, SourceMap? lineMap, List<PerfWarning> warnings)
+        {
+            _path = path;
+            _function = function.Name;
+            _locals = new HashSet<string>(function.Parameters);
+            _lineMap = lineMap;
+            _warnings = warnings;
+        }
+
+        public void Statement(Statement? stmt)
+        {
+            switch (stmt)
+            {
+                case BlockStatement block:
+                    foreach (var inner in block.Statements) Statement(inner);
+                    break;
+                case ExpressionStatement exprStmt:
+                    Expression(exprStmt.Expression);
+                    break;
+                case VariableDeclaration decl:
+                    _locals.Add(decl.Name);
+                    Expression(decl.Initializer);
+                    break;
+                case ReturnStatement ret:
+                    Expression(ret.Value);
+                    break;
+                case IfStatement ifStmt:
+                    Expression(ifStmt.Condition);
+                    Statement(ifStmt.ThenBranch);
+                    Statement(ifStmt.ElseBranch);
+                    break;
+                case SwitchStatement switchStmt:
+                    Expression(switchStmt.Value);
+                    foreach (var switchCase in switchStmt.Cases)
+                    {
+                        foreach (var inner in switchCase.Statements) Statement(inner);
+                    }
+                    break;
+                case WhileStatement whileStmt:
+                    Loop(whileStmt.Body, CallsInventory(whileStmt.Condition), whileStmt.Condition);
+                    break;
+                case ForEachStatement forEach:
+                    Expression(forEach.Collection);
+                    Loop(forEach.Body, CallsInventory(forEach.Collection));
+                    break;
+                case ForStatement forStmt:
+                    Expression(forStmt.Init);
+                    if (forStmt.Condition != null && FirstCall(forStmt.Condition) is { } call)
+                    {
+                        Warn(call.Line, $"the for condition calls {CallName(call)} on every pass; " +
+                                        "compute it once before the loop");
+                    }
+                    Loop(forStmt.Body, CallsInventory(forStmt.Init) || CallsInventory(forStmt.Condition),
+                        forStmt.Condition, forStmt.Increment);
+                    break;
+            }
+        }
+
+        /// <summary>
+        /// Walk a loop's body and the parts of its header that run on every pass.
+        /// </summary>
+        private void Loop(Statement body, bool overInventory, params Expression?[] perPass)
+        {
+            _loops.Add((overInventory, false));
+            foreach (var expr in perPass) Expression(expr);
+            Statement(body);
+            _loops.RemoveAt(_loops.Count - 1);
+        }
+
+        private void Expression(Expression? expr)
+        {
+            if (expr == null) return;
+
+            if (_loops.Count > 0 && expr is Assignment { Value: BinaryOp { Operator: BinaryOperator.Add } add } assign &&
+                add.Left is Identifier self && self.Name == assign.Name && !_locals.Contains(self.Name) &&
+                add.Right is ArrayLiteral or MappingLiteral)
+            {
+                var kind = add.Right is ArrayLiteral ? "({ ... })" : "([ ... ])";
+                Warn(assign.Line, $"{assign.Name} = {assign.Name} + {kind} in a loop copies {assign.Name} " +
+                                  "on every pass, O(n^2) in all");
+            }
+
+            if (expr is ArrowCall or FunctionCall { Name: "call_other" })
+            {
+                CallOther(expr.Line);
+            }
+
+            foreach (var child in ExpressionTree.Children(expr)) Expression(child);
+        }
+
+        private void CallOther(int line)
+        {
+            if (_loops.Count < 2 || _loops[^1].Reported || !_loops.Any(loop => loop.OverInventory)) return;
+            _loops[^1] = (_loops[^1].OverInventory, true);
+            Warn(line, "call_other in nested loops over an inventory makes O(n*m) calls on every pass");
+        }
+
+        private void Warn(int line, string message)
+        {
+            var (file, fileLine) = _lineMap?.Resolve(line) ?? (_path, line);
+            _warnings.Add(new PerfWarning(file, fileLine, _function, message));
+        }
+    }
+
+    /// <summary>
+    /// The first call in expr that runs on every evaluation, other than
+    /// sizeof() or strlen() of a variable.
+    /// </summary>
+    private static Expression? FirstCall(Expression expr)
+    {
+        if (expr is FunctionCall { Arguments: [Identifier] } constant && ConstantTimeEfuns.Contains(constant.Name))
+        {
+            return null;
+        }
+        if (expr is FunctionCall or ArrowCall) return expr;
+        foreach (var child in ExpressionTree.Children(expr))
+        {
+            if (FirstCall(child) is { } call) return call;
+        }
+        return null;
+    }
+
+    private static string CallName(Expression call) => call switch
+    {
+        FunctionCall { Name: "sizeof", Arguments: [FunctionCall inner] } => $"sizeof({inner.Name}())",
+        FunctionCall function => function.Name + "()",
+        ArrowCall arrow => "->" + arrow.FunctionName + "()",
+        _ => "a function"
+    };
+
+    private static bool CallsInventory(Expression? expr)
+    {
+        return expr != null &&
+               ExpressionTree.Any(expr, node => node is FunctionCall call && InventoryEfuns.Contains(call.Name));
+    }
+}
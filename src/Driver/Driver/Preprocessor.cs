@@ -1,18 +1,46 @@
+using System.Collections.Concurrent;
+
 namespace Driver;
 
 /// <summary>
 /// C-style preprocessor for LPC files.
 /// Handles #include, #define, #undef, #ifdef, #ifndef, #else, #endif.
+///
+/// Included files are read and split into lines once and shared by every
+/// preprocessor (they are reused until the file's size or write time
+/// changes), so a header pulled in by hundreds of files is loaded once.
+/// Macros are expanded in one pass over each line's words, skipping string
+/// and character literals, rather than by a search per defined name.
 /// </summary>
 public class Preprocessor
 {
+    /// <summary>
+    /// A source line, with whether it is a directive worked out once.
+    /// </summary>
+    private readonly record struct SourceLine(string Text, string? Directive);
+
+    /// <summary>
+    /// An included file's lines as of its size and write time.
+    /// </summary>
+    private sealed record IncludeFile(DateTime WriteTime, long Length, SourceLine[] Lines);
+
+    private static readonly ConcurrentDictionary<string, IncludeFile> IncludeCache = new();
+
     private readonly string _mudlibPath;
     private readonly Dictionary<string, string> _defines = new();
+    private readonly Dictionary<string, string> _predefines = new();
     private readonly HashSet<string> _includedFiles = new();
     private readonly Stack<bool> _conditionStack = new();
     private int _currentLine;
     private string _currentFile = "";
 
+    // Where each stretch of output came from, and how far OutputLine() has
+    // counted the output so far
+    private SourceMap.Builder _lineMap = new();
+    private string _lineMapFile = "";
+    private int _countedChars;
+    private int _countedLines;
+
     /// <summary>
     /// Maximum include depth to prevent infinite recursion.
     /// </summary>
@@ -28,9 +56,49 @@ public class Preprocessor
     /// </summary>
     public void Define(string name, string value = "1")
     {
+        _predefines[name] = value;
         _defines[name] = value;
     }
 
+    /// <summary>
+    /// A new preprocessor with the same mudlib root and predefined symbols,
+    /// for processing files on another thread.
+    /// </summary>
+    public Preprocessor Fork()
+    {
+        var fork = new Preprocessor(_mudlibPath) { MaxIncludeDepth = MaxIncludeDepth };
+        foreach (var (name, value) in _predefines)
+        {
+            fork.Define(name, value);
+        }
+        return fork;
+    }
+
+    /// <summary>
+    /// Full paths of the files #included by the last Process call.
+    /// The program cache hashes these to know when a cached parse goes stale.
+    /// </summary>
+    public IReadOnlyCollection<string> IncludedFiles => _includedFiles;
+
+    /// <summary>
+    /// Where the lines of the last Process call's output came from.
+    /// </summary>
+    public SourceMap LineMap { get; private set; } = new SourceMap.Builder().Build();
+
+    /// <summary>
+    /// Stable text form of the predefined symbols. The program cache folds this
+    /// into its key so a cached parse is never reused under different predefines.
+    /// </summary>
+    public string PredefinesFingerprint()
+    {
+        var builder = new System.Text.StringBuilder();
+        foreach (var (name, value) in _predefines.OrderBy(d => d.Key, StringComparer.Ordinal))
+        {
+            builder.Append(name).Append('=').Append(value).Append('\n');
+        }
+        return builder.ToString();
+    }
+
     /// <summary>
     /// Process a source file and return the preprocessed source.
     /// </summary>
@@ -40,23 +108,43 @@ public class Preprocessor
         _currentLine = 1;
         _conditionStack.Clear();
         _includedFiles.Clear();
+        _lineMap = new SourceMap.Builder();
+        _lineMapFile = filePath;
+        _lineMap.Add(1, filePath, 1);
+        _countedChars = _countedLines = 0;
+
+        // Each file starts from the predefined symbols only, so its output
+        // doesn't depend on which files happened to be processed before it
+        _defines.Clear();
+        foreach (var (name, value) in _predefines)
+        {
+            _defines[name] = value;
+        }
 
-        var result = new System.Text.StringBuilder();
-        var lines = source.Split('\n');
+        var result = new System.Text.StringBuilder(source.Length + 64);
+        ProcessLines(SplitLines(source), result, 0);
 
-        foreach (var rawLine in lines)
+        if (_conditionStack.Count > 0)
         {
-            var line = rawLine.TrimEnd('\r');
-            var trimmed = line.TrimStart();
+            throw new PreprocessorException($"Unterminated #ifdef/#ifndef", _currentFile, _currentLine);
+        }
+
+        LineMap = _lineMap.Build();
+        return result.ToString();
+    }
 
-            if (trimmed.StartsWith("#"))
+    private void ProcessLines(SourceLine[] lines, System.Text.StringBuilder result, int includeDepth)
+    {
+        foreach (var line in lines)
+        {
+            if (line.Directive != null)
             {
-                ProcessDirective(trimmed, result, 0);
+                ProcessDirective(line.Directive, result, includeDepth);
             }
             else if (IsOutputEnabled())
             {
                 // Apply macro substitution
-                result.AppendLine(SubstituteMacros(line));
+                result.AppendLine(SubstituteMacros(line.Text));
             }
             else
             {
@@ -66,13 +154,39 @@ public class Preprocessor
 
             _currentLine++;
         }
+    }
 
-        if (_conditionStack.Count > 0)
+    private static SourceLine[] SplitLines(string source)
+    {
+        var rawLines = source.Split('\n');
+        var lines = new SourceLine[rawLines.Length];
+        for (int i = 0; i < rawLines.Length; i++)
         {
-            throw new PreprocessorException($"Unterminated #ifdef/#ifndef", _currentFile, _currentLine);
+            var line = rawLines[i].TrimEnd('\r');
+            var trimmed = line.AsSpan().TrimStart();
+            lines[i] = new SourceLine(line, trimmed.StartsWith("#") ? trimmed.ToString() : null);
         }
+        return lines;
+    }
 
-        return result.ToString();
+    /// <summary>
+    /// The lines of an included file, from the shared cache when the file
+    /// hasn't changed since it was read. Null if the file doesn't exist.
+    /// </summary>
+    private static SourceLine[]? LoadInclude(string fullPath)
+    {
+        var info = new FileInfo(fullPath);
+        if (!info.Exists) return null;
+
+        if (IncludeCache.TryGetValue(fullPath, out var cached) &&
+            cached.WriteTime == info.LastWriteTimeUtc && cached.Length == info.Length)
+        {
+            return cached.Lines;
+        }
+
+        var lines = SplitLines(File.ReadAllText(fullPath));
+        IncludeCache[fullPath] = new IncludeFile(info.LastWriteTimeUtc, info.Length, lines);
+        return lines;
     }
 
     private void ProcessDirective(string line, System.Text.StringBuilder result, int includeDepth)
@@ -171,47 +285,34 @@ public class Preprocessor
             return;
         }
 
-        if (!File.Exists(fullPath))
+        try
         {
-            throw new PreprocessorException($"Include file not found: {includePath}", _currentFile, _currentLine);
-        }
+            var includeLines = LoadInclude(normalizedPath);
+            if (includeLines == null)
+            {
+                throw new PreprocessorException($"Include file not found: {includePath}", _currentFile, _currentLine);
+            }
 
-        _includedFiles.Add(normalizedPath);
+            _includedFiles.Add(normalizedPath);
 
-        try
-        {
-            var includeSource = File.ReadAllText(fullPath);
             var savedFile = _currentFile;
             var savedLine = _currentLine;
+            var savedMapFile = _lineMapFile;
 
             _currentFile = includePath;
             _currentLine = 1;
+            _lineMapFile = resolvedPath;
+            _lineMap.Add(OutputLine(result), resolvedPath, 1);
 
             // Process the included file
-            var includeLines = includeSource.Split('\n');
-            foreach (var rawLine in includeLines)
-            {
-                var incLine = rawLine.TrimEnd('\r');
-                var trimmed = incLine.TrimStart();
-
-                if (trimmed.StartsWith("#"))
-                {
-                    ProcessDirective(trimmed, result, includeDepth + 1);
-                }
-                else if (IsOutputEnabled())
-                {
-                    result.AppendLine(SubstituteMacros(incLine));
-                }
-                else
-                {
-                    result.AppendLine();
-                }
-
-                _currentLine++;
-            }
+            ProcessLines(includeLines, result, includeDepth + 1);
 
             _currentFile = savedFile;
             _currentLine = savedLine;
+            _lineMapFile = savedMapFile;
+
+            // The #include line itself produced no output
+            _lineMap.Add(OutputLine(result), _lineMapFile, savedLine + 1);
         }
         catch (IOException ex)
         {
@@ -219,6 +320,26 @@ public class Preprocessor
         }
     }
 
+    /// <summary>
+    /// The number the next line written to result will have. Counts only
+    /// what was added since the last call.
+    /// </summary>
+    private int OutputLine(System.Text.StringBuilder result)
+    {
+        int offset = 0;
+        foreach (var chunk in result.GetChunks())
+        {
+            var span = chunk.Span;
+            if (offset + span.Length > _countedChars)
+            {
+                _countedLines += span[Math.Max(0, _countedChars - offset)..].Count('\n');
+            }
+            offset += span.Length;
+        }
+        _countedChars = offset;
+        return _countedLines + 1;
+    }
+
     private void ProcessDefine(string args)
     {
         var parts = args.Split(new[] { ' ', '\t' }, 2, StringSplitOptions.RemoveEmptyEntries);
@@ -315,17 +436,70 @@ public class Preprocessor
     {
         if (_defines.Count == 0) return line;
 
-        // Simple word-boundary substitution
-        foreach (var kvp in _defines)
+        System.Text.StringBuilder? result = null;
+        ExpandMacros(line, ref result, null);
+        return result?.ToString() ?? line;
+    }
+
+    /// <summary>
+    /// Scan text a word at a time, replacing defined names with their values
+    /// (which are themselves expanded, except for names already being
+    /// expanded). result stays null until the first replacement, so lines
+    /// without macros are returned as they are.
+    /// </summary>
+    private void ExpandMacros(string text, ref System.Text.StringBuilder? result, HashSet<string>? expanding)
+    {
+        int copied = 0;
+        int i = 0;
+        while (i < text.Length)
         {
-            // Use word boundaries to avoid replacing partial matches
-            var pattern = $@"\b{System.Text.RegularExpressions.Regex.Escape(kvp.Key)}\b";
-            line = System.Text.RegularExpressions.Regex.Replace(line, pattern, kvp.Value);
+            char c = text[i];
+            if (c is '"' or '\'')
+            {
+                // Leave string and character literals alone
+                i++;
+                while (i < text.Length && text[i] != c)
+                {
+                    i += text[i] == '\\' ? 2 : 1;
+                }
+                i++;
+                continue;
+            }
+
+            if (!IsWordChar(c))
+            {
+                i++;
+                continue;
+            }
+
+            int start = i;
+            while (i < text.Length && IsWordChar(text[i])) i++;
+            if (char.IsAsciiDigit(c)) continue;
+
+            var word = text.Substring(start, i - start);
+            if (!_defines.TryGetValue(word, out var value) || (expanding != null && expanding.Contains(word)))
+            {
+                continue;
+            }
+
+            result ??= new System.Text.StringBuilder(text.Length + value.Length);
+            result.Append(text, copied, start - copied);
+            copied = i;
+
+            expanding ??= new HashSet<string>();
+            expanding.Add(word);
+            ExpandMacros(value, ref result, expanding);
+            expanding.Remove(word);
         }
 
-        return line;
+        if (result != null)
+        {
+            result.Append(text, copied, text.Length - copied);
+        }
     }
 
+    private static bool IsWordChar(char c) => char.IsAsciiLetterOrDigit(c) || c == '_';
+
     private string ResolvePath(string path)
     {
         // If path starts with /, it's absolute
@@ -1,3 +1,4 @@
+using System.IO.Compression;
 using Driver;
 
 if (args.Length == 0)
@@ -12,8 +13,15 @@ try
     {
         "--tokenize" => Tokenize(args),
         "--eval" => Eval(args),
-        "--repl" => Repl(),
+        "--repl" => Repl(args),
         "--server" => Server(args),
+        "--convert-saves" => ConvertSaves(args),
+        "--import-saves" => ImportSaves(args),
+        "--loadgen" => LoadGen(args),
+        "--router" => Router(args),
+        "--replay" => Replay(args),
+        "--bench" => Bench(args),
+        "--test" => Test(args),
         "--help" or "-h" => PrintUsage(),
         _ => UnknownCommand(args[0])
     };
@@ -46,9 +54,22 @@ int PrintUsage()
 
         Usage:
           driver --tokenize <file>     Tokenize an LPC file and print tokens
-          driver --eval "<expression>" Evaluate an LPC expression
-          driver --repl                Start interactive REPL
+          driver --eval "<expression>" [--mudlib <path>]
+                                       Evaluate LPC on the server's engine, in a scratch object
+          driver --repl [--mudlib <path>]
+                                       Start interactive REPL (same engine; globals and functions persist)
+          driver --bench <file.c> <function> [iterations] [--mudlib <path>]
+                                       Time an LPC function: ns, bytes allocated and instructions per call
+          driver --test <dir> [--mudlib <path>] [--iterations <n>] [--verbose]
+                                       Run each file's run_tests() and time its bench_* functions
           driver --server [options]    Start telnet server
+          driver --convert-saves <text|binary> <path>...
+                                       Rewrite save_object() files (or directories of them) in a format
+          driver --loadgen <script> [options]
+                                       Run scripted telnet bots against a server and report latencies
+          driver --router <config>     Front a cluster of driver processes: route players and relay messages
+          driver --replay <recording> [options]
+                                       Re-run a --record command stream as fast as possible and report ticks/sec
           driver --help                Show this help message
 
         Server options:
@@ -56,13 +77,66 @@ int PrintUsage()
           --mudlib <path>              Mudlib directory (default: ./mudlib)
           --log-level <level>          Log level: debug, info, warning, error (default: info)
           --log-file <path>            Log to file in addition to console
+          --log-json                   Write the log file as JSON lines
+          --no-bytecode                Run LPC on the tree-walking interpreter (debugging)
+          --no-jit                     Keep hot functions on the bytecode VM instead of compiling them to IL
+          --no-memoize                 Always run pure query functions instead of reusing their last result
+          --program-cache <path>       Parsed program cache directory (default: .lpcache beside the mudlib)
+          --no-program-cache           Always preprocess and parse from source
+          --lazy-parse                 Parse function bodies on first call (no program cache)
+          --precompile                 Compile the whole mudlib in parallel at boot
+          --no-watch                   Don't recompile edited files in the background
+          --dormant-heartbeats         Suspend heart_beat() and reset() in rooms with no players
+          --gc-idle                    Collect garbage in the sleep between ticks, gen2 in the background
+          --logins-per-tick <n>        Players let into the game per tick; the rest queue (default: 4)
+          --region-threads <n>         Run heartbeats of world areas on n threads (default: 0, off)
+          --clean-up <seconds>         Offer clean_up() to objects idle this long (default: 3600, 0 = off)
+          --parallel-heartbeats        Run self-contained heart_beat()s in parallel, replaying their messages
+          --cpu-budget <n>             Slow the heart_beat() of objects over n instructions a minute (default: 0, off)
+          --slow-command <ms>          Log commands slower than this end to end, with their LPC calls (default: 1000, 0 = off)
+          --binary-saves               Write save_object() files in the compact binary format
+          --output-limit <KB>          Unsent output allowed per connection (default: 256)
+          --output-policy <policy>     When a client falls behind: drop, linkdead, disconnect (default: linkdead)
+          --compression <level>        MCCP2 output compression: off, fastest, optimal, smallest (default: optimal)
+          --websocket-port <port>      Also take WebSocket (browser) clients on this port
+          --metrics-port <port>        Serve Prometheus metrics at http://<host>:<port>/metrics
+                                       and a JSON status view at /status
+          --snapshot <path>            Snapshot the world to path every 5 minutes and restore it at boot
+          --save-store <path>          Keep player saves and accounts in one store file, committed each tick
+          --record <path>              Record logins, in-game input and disconnects for --replay
+          --copyover <state>           Take over sockets from a driver that ran copyover (set by the driver)
+          --cluster <config> --node <name>
+                                       Run as node name of a cluster, on its port, behind --router
+
+        Load generator options:
+          --host <host>                Server to connect to (default: 127.0.0.1)
+          --port <port>                Server port (default: 4000)
+          --bots <n>                   Connections to open (default: 100)
+          --ramp <seconds>             Spread the bots' logins over this long (default: 10)
+          --duration <seconds>         Length of the run, ramp included (default: 60)
+          --prefix <name>              Bot account name prefix, must contain "test" (default: testbot)
+          --admin <name>:<password>    Admin account for reading tick overruns before and after
+          --json <path>                Also write the report as JSON
+
+        Replay options:
+          --mudlib <path>              Mudlib to replay against, a copy taken when recording began (saves go to it)
+          --snapshot <path>            World snapshot to restore first
+          --json <path>                Also write the report as JSON
 
         Examples:
           driver --tokenize test.c
           driver --eval "5 + 3 * 2"
+          driver --bench /std/living.c query_level 100000
+          driver --test lpc-tests --mudlib ./mudlib
           driver --server
           driver --server --port 4000 --mudlib ./mudlib
           driver --server --log-level debug --log-file game.log
+          driver --convert-saves binary ./mudlib/secure/players
+          driver --import-saves ./mudlib saves.db
+          driver --loadgen loadtest/town.txt --bots 1000 --ramp 30 --duration 120
+          driver --router cluster.json
+          driver --replay evening.rec --mudlib ./mudlib-copy --json replay.json
+          driver --server --cluster cluster.json --node forest
         """);
     return 0;
 }
@@ -95,53 +169,385 @@ int Tokenize(string[] args)
     return 0;
 }
 
-int Eval(string[] args)
+int ConvertSaves(string[] args)
 {
-    if (args.Length < 2)
+    if (args.Length < 3 || args[1] is not ("text" or "binary"))
     {
-        Console.Error.WriteLine("Error: --eval requires an expression or statement");
+        Console.Error.WriteLine("Error: --convert-saves requires a format (text or binary) and at least one path");
         return 1;
     }
 
-    string input = args[1];
-    var lexer = new Lexer(input);
-    var tokens = lexer.Tokenize();
-    var parser = new Parser(tokens);
-    var parsed = parser.ParseStatementOrExpression();
-    var interpreter = new Interpreter();
+    bool binary = args[1] == "binary";
+    int converted = 0;
+    foreach (var path in args.Skip(2))
+    {
+        var files = Directory.Exists(path)
+            ? Directory.EnumerateFiles(path, "*.o", SearchOption.AllDirectories)
+            : File.Exists(path) ? new[] { path } : null;
+        if (files == null)
+        {
+            Console.Error.WriteLine($"Error: File not found: {path}");
+            return 1;
+        }
+
+        foreach (var file in files)
+        {
+            var data = File.ReadAllBytes(file);
+            if (SaveFormat.IsBinary(data) == binary) continue;
+
+            var temp = file + ".tmp";
+            File.WriteAllBytes(temp, SaveFormat.Convert(data, binary));
+            File.Move(temp, file, overwrite: true);
+            converted++;
+        }
+    }
+
+    Console.WriteLine($"Converted {converted} file(s) to {args[1]}");
+    return 0;
+}
+
+int ImportSaves(string[] args)
+{
+    if (args.Length != 3 || !Directory.Exists(args[1]))
+    {
+        Console.Error.WriteLine("Error: --import-saves requires a mudlib directory and a store path");
+        return 1;
+    }
+
+    // Save files anywhere in the mudlib, and the account files
+    var mudlib = Path.GetFullPath(args[1]);
+    var accounts = Path.Combine(mudlib, "secure", "accounts");
+    var files = Directory.EnumerateFiles(mudlib, "*.o", SearchOption.AllDirectories)
+        .Concat(Directory.Exists(accounts) ? Directory.EnumerateFiles(accounts, "*.json") : Enumerable.Empty<string>());
 
-    object? result;
-    if (parsed is Statement stmt)
+    using var store = new SaveStore(args[2]);
+    int imported = 0;
+    foreach (var file in files)
     {
-        try
+        store.Put(SaveStore.KeyFor(mudlib, file), File.ReadAllBytes(file));
+        imported++;
+    }
+    store.Flush();
+
+    Console.WriteLine($"Imported {imported} file(s) into {store.Path}");
+    return 0;
+}
+
+int Router(string[] args)
+{
+    if (args.Length != 2 || !File.Exists(args[1]))
+    {
+        Console.Error.WriteLine("Error: --router requires a cluster config file");
+        return 1;
+    }
+
+    using var router = new ClusterRouter(ClusterConfig.Load(args[1]));
+    var run = router.RunAsync();
+    Console.CancelKeyPress += (_, e) =>
+    {
+        e.Cancel = true;
+        router.Dispose();
+    };
+    run.Wait();
+    Logger.Close();
+    return 0;
+}
+
+int Bench(string[] args)
+{
+    if (args.Length < 3)
+    {
+        Console.Error.WriteLine("Error: --bench requires a file and a function");
+        return 1;
+    }
+
+    string mudlibPath = "./mudlib";
+    long iterations = 100_000;
+    int next = 3;
+    if (args.Length > 3 && !args[3].StartsWith("--"))
+    {
+        if (!long.TryParse(args[3], out iterations) || iterations < 1)
+        {
+            Console.Error.WriteLine($"Error: Invalid iteration count: {args[3]}");
+            return 1;
+        }
+        next = 4;
+    }
+    for (int i = next; i < args.Length; i++)
+    {
+        if (args[i] == "--mudlib" && i + 1 < args.Length)
+        {
+            mudlibPath = args[++i];
+        }
+        else
         {
-            result = interpreter.Execute(stmt);
+            Console.Error.WriteLine($"Error: Invalid option: {args[i]}");
+            return 1;
         }
-        catch (ReturnException ret)
+    }
+
+    if (!Directory.Exists(mudlibPath))
+    {
+        Console.Error.WriteLine($"Error: Mudlib directory not found: {mudlibPath}");
+        return 1;
+    }
+
+    // A file named on disk is found by its place in the mudlib
+    var file = args[1];
+    if (!file.StartsWith('/') || File.Exists(file))
+    {
+        var full = Path.GetFullPath(file);
+        var root = Path.GetFullPath(mudlibPath);
+        if (full.StartsWith(root, StringComparison.Ordinal))
         {
-            result = ret.Value;
+            file = SaveStore.KeyFor(root, full);
         }
     }
-    else if (parsed is Expression expr)
+
+    Logger.MinLevel = LogLevel.Warning;
+    var objectManager = new ObjectManager(mudlibPath);
+    objectManager.InitializeInterpreter();
+    try
+    {
+        Console.Write(LpcBenchmark.Run(objectManager, file, args[2], iterations));
+    }
+    catch (Exception ex) when (ex is not OutOfMemoryException)
     {
-        result = interpreter.Evaluate(expr);
+        Console.Error.WriteLine($"Error: {ex.Message}");
+        return 1;
     }
-    else
+    finally
+    {
+        Logger.Close();
+    }
+    return 0;
+}
+
+int Test(string[] args)
+{
+    if (args.Length < 2 || args[1].StartsWith("--"))
+    {
+        Console.Error.WriteLine("Error: --test requires a directory of test files");
+        return 1;
+    }
+
+    string mudlibPath = "./mudlib";
+    long iterations = 10_000;
+    bool verbose = false;
+    for (int i = 2; i < args.Length; i++)
+    {
+        if (args[i] == "--mudlib" && i + 1 < args.Length)
+        {
+            mudlibPath = args[++i];
+        }
+        else if (args[i] == "--iterations" && i + 1 < args.Length)
+        {
+            if (!long.TryParse(args[++i], out iterations) || iterations < 1)
+            {
+                Console.Error.WriteLine($"Error: Invalid iteration count: {args[i]}");
+                return 1;
+            }
+        }
+        else if (args[i] == "--verbose")
+        {
+            verbose = true;
+        }
+        else
+        {
+            Console.Error.WriteLine($"Error: Invalid option: {args[i]}");
+            return 1;
+        }
+    }
+
+    if (!Directory.Exists(args[1]))
+    {
+        Console.Error.WriteLine($"Error: Test directory not found: {args[1]}");
+        return 1;
+    }
+    if (!Directory.Exists(mudlibPath))
+    {
+        Console.Error.WriteLine($"Error: Mudlib directory not found: {mudlibPath}");
+        return 1;
+    }
+
+    // What the tests write() only gets in the way of the table, unless asked for
+    Logger.MinLevel = LogLevel.Warning;
+    var objectManager = new ObjectManager(mudlibPath);
+    objectManager.InitializeInterpreter(verbose ? Console.Out : TextWriter.Null);
+    try
+    {
+        var report = LpcTestRunner.Run(objectManager, args[1], iterations);
+        Console.Write(report);
+        return report.Failed == 0 ? 0 : 1;
+    }
+    finally
+    {
+        Logger.Close();
+    }
+}
+
+int Replay(string[] args)
+{
+    if (args.Length < 2 || !File.Exists(args[1]))
+    {
+        Console.Error.WriteLine("Error: --replay requires a recording file");
+        return 1;
+    }
+
+    string mudlibPath = "./mudlib";
+    string? snapshotPath = null;
+    string? jsonPath = null;
+    for (int i = 2; i < args.Length; i++)
+    {
+        if (i + 1 >= args.Length)
+        {
+            Console.Error.WriteLine($"Error: {args[i]} requires a value");
+            return 1;
+        }
+
+        var value = args[++i];
+        switch (args[i - 1])
+        {
+            case "--mudlib": mudlibPath = value; break;
+            case "--snapshot": snapshotPath = value; break;
+            case "--json": jsonPath = value; break;
+            default:
+                Console.Error.WriteLine($"Error: Invalid option: {args[i - 1]} {value}");
+                return 1;
+        }
+    }
+
+    if (!Directory.Exists(mudlibPath))
+    {
+        Console.Error.WriteLine($"Error: Mudlib directory not found: {mudlibPath}");
+        return 1;
+    }
+
+    CommandRecording recording;
+    try
+    {
+        recording = CommandRecording.Load(args[1]);
+    }
+    catch (InvalidDataException ex)
+    {
+        Console.Error.WriteLine($"Error: {ex.Message}");
+        return 1;
+    }
+
+    Logger.MinLevel = LogLevel.Warning;
+    var objectManager = new ObjectManager(mudlibPath);
+    objectManager.InitializeInterpreter();
+    var gameLoop = new GameLoop(objectManager, new AccountManager(mudlibPath));
+    gameLoop.InitializeInterpreter(new ObjectInterpreter(objectManager));
+    if (snapshotPath != null)
+    {
+        WorldSnapshot.Restore(snapshotPath, objectManager, gameLoop);
+    }
+    objectManager.WorldGraph.Build(objectManager);
+
+    Console.WriteLine($"Replaying {recording.Events.Count} events against {Path.GetFullPath(mudlibPath)}...");
+    var report = CommandReplay.Run(gameLoop, recording);
+    Console.Write(report);
+
+    if (jsonPath != null)
+    {
+        File.WriteAllText(jsonPath, report.ToJson());
+    }
+    AsyncFileWriter.Shared.Flush();
+    Logger.Close();
+    return 0;
+}
+
+int LoadGen(string[] args)
+{
+    if (args.Length < 2 || !File.Exists(args[1]))
+    {
+        Console.Error.WriteLine("Error: --loadgen requires a script file");
+        return 1;
+    }
+
+    var script = LoadScript.Parse(File.ReadAllText(args[1]));
+    var options = new LoadOptions();
+    string? jsonPath = null;
+
+    for (int i = 2; i < args.Length; i++)
+    {
+        if (i + 1 >= args.Length)
+        {
+            Console.Error.WriteLine($"Error: {args[i]} requires a value");
+            return 1;
+        }
+
+        var value = args[++i];
+        switch (args[i - 1])
+        {
+            case "--host": options = options with { Host = value }; break;
+            case "--port" when int.TryParse(value, out var port) && port is >= 1 and <= 65535:
+                options = options with { Port = port };
+                break;
+            case "--bots" when int.TryParse(value, out var bots) && bots > 0:
+                options = options with { Bots = bots };
+                break;
+            case "--ramp" when double.TryParse(value, out var ramp) && ramp >= 0:
+                options = options with { Ramp = TimeSpan.FromSeconds(ramp) };
+                break;
+            case "--duration" when double.TryParse(value, out var duration) && duration > 0:
+                options = options with { Duration = TimeSpan.FromSeconds(duration) };
+                break;
+            case "--prefix": options = options with { NamePrefix = value }; break;
+            case "--admin" when value.Contains(':'):
+                var credentials = value.Split(':', 2);
+                options = options with { AdminName = credentials[0], AdminPassword = credentials[1] };
+                break;
+            case "--json": jsonPath = value; break;
+            default:
+                Console.Error.WriteLine($"Error: Invalid option: {args[i - 1]} {value}");
+                return 1;
+        }
+    }
+
+    Console.WriteLine($"Running {options.Bots} bots against {options.Host}:{options.Port} for {options.Duration.TotalSeconds:F0}s...");
+    var report = new LoadGenerator(script, options).RunAsync().GetAwaiter().GetResult();
+    Console.Write(report);
+
+    if (jsonPath != null)
+    {
+        File.WriteAllText(jsonPath, report.ToJson());
+    }
+    return report.Errors == 0 ? 0 : 1;
+}
+
+int Eval(string[] args)
+{
+    if (args.Length < 2)
+    {
+        Console.Error.WriteLine("Error: --eval requires an expression or statement");
+        return 1;
+    }
+
+    var evaluator = CreateEvaluator(args, 2);
+    if (evaluator == null)
     {
-        result = null;
+        return 1;
     }
 
+    var result = evaluator.Evaluate(args[1]);
     if (result != null)
     {
-        Console.WriteLine(result);
+        Console.WriteLine(ScratchEvaluator.Format(result));
     }
     return 0;
 }
 
-int Repl()
+int Repl(string[] args)
 {
-    Console.WriteLine("LPSharp REPL - Type expressions or statements, 'quit' to exit");
-    var interpreter = new Interpreter();
+    var evaluator = CreateEvaluator(args, 1);
+    if (evaluator == null)
+    {
+        return 1;
+    }
+
+    Console.WriteLine("LPSharp REPL - Type expressions, statements or declarations, 'quit' to exit");
 
     while (true)
     {
@@ -160,45 +566,12 @@ int Repl()
 
         try
         {
-            var lexer = new Lexer(line);
-            var tokens = lexer.Tokenize();
-            var parser = new Parser(tokens);
-            var parsed = parser.ParseStatementOrExpression();
-
-            object? result;
-            if (parsed is Statement stmt)
-            {
-                result = interpreter.Execute(stmt);
-            }
-            else if (parsed is Expression expr)
-            {
-                result = interpreter.Evaluate(expr);
-            }
-            else
-            {
-                result = null;
-            }
-
+            var result = evaluator.Evaluate(line);
             if (result != null)
             {
-                Console.WriteLine(result);
-            }
-        }
-        catch (ReturnException ret)
-        {
-            if (ret.Value != null)
-            {
-                Console.WriteLine(ret.Value);
+                Console.WriteLine(ScratchEvaluator.Format(result));
             }
         }
-        catch (BreakException)
-        {
-            Console.Error.WriteLine("Error: break outside of loop");
-        }
-        catch (ContinueException)
-        {
-            Console.Error.WriteLine("Error: continue outside of loop");
-        }
         catch (LexerException ex)
         {
             Console.Error.WriteLine($"Lexer error: {ex.Message}");
@@ -207,7 +580,11 @@ int Repl()
         {
             Console.Error.WriteLine($"Parse error: {ex.Message}");
         }
-        catch (InterpreterException ex)
+        catch (ObjectManagerException ex)
+        {
+            Console.Error.WriteLine($"Compile error: {ex.Message}");
+        }
+        catch (Exception ex)
         {
             Console.Error.WriteLine($"Runtime error: {ex.Message}");
         }
@@ -216,11 +593,67 @@ int Repl()
     return 0;
 }
 
+// --eval and --repl run on the server's engine, in a scratch object of the
+// mudlib (--mudlib, else ./mudlib if there is one), so load_object() and
+// friends work and timings match the server's
+ScratchEvaluator? CreateEvaluator(string[] args, int first)
+{
+    string mudlibPath = Directory.Exists("./mudlib") ? "./mudlib" : ".";
+    for (int i = first; i < args.Length; i++)
+    {
+        if (args[i] == "--mudlib" && i + 1 < args.Length)
+        {
+            mudlibPath = args[++i];
+        }
+        else
+        {
+            Console.Error.WriteLine($"Error: Invalid option: {args[i]}");
+            return null;
+        }
+    }
+
+    if (!Directory.Exists(mudlibPath))
+    {
+        Console.Error.WriteLine($"Error: Mudlib directory not found: {mudlibPath}");
+        return null;
+    }
+
+    var objectManager = new ObjectManager(mudlibPath);
+    objectManager.InitializeInterpreter(Console.Out);
+    return new ScratchEvaluator(objectManager);
+}
+
 int Server(string[] args)
 {
     int port = 4000; // Default port
     string mudlibPath = "./mudlib"; // Default mudlib path
     string? logFile = null;
+    bool useBytecode = true;
+    bool useJit = true;
+    bool memoize = true;
+    string? programCacheDir = null;
+    bool useProgramCache = true;
+    bool lazyParse = false;
+    bool precompile = false;
+    bool watchSources = true;
+    bool dormantHeartbeats = false;
+    bool gcIdle = false;
+    int loginsPerTick = 4;
+    long cpuBudget = 0;
+    int regionThreads = 0;
+    int cleanUpIdleSeconds = 3600;
+    int slowCommandMs = 1000;
+    bool parallelHeartbeats = false;
+    var outputLimits = OutputLimits.Default;
+    CompressionLevel? compression = CompressionLevel.Optimal;
+    int? metricsPort = null;
+    int? webSocketPort = null;
+    string? copyoverState = null;
+    string? snapshotPath = null;
+    string? saveStorePath = null;
+    string? recordPath = null;
+    string? clusterPath = null;
+    string? nodeName = null;
 
     // Parse arguments
     for (int i = 1; i < args.Length; i++)
@@ -253,6 +686,178 @@ int Server(string[] args)
         {
             logFile = args[++i];
         }
+        else if (args[i] == "--log-json")
+        {
+            Logger.JsonLines = true;
+        }
+        else if (args[i] == "--no-bytecode")
+        {
+            useBytecode = false;
+        }
+        else if (args[i] == "--no-jit")
+        {
+            useJit = false;
+        }
+        else if (args[i] == "--no-memoize")
+        {
+            memoize = false;
+        }
+        else if (args[i] == "--program-cache" && i + 1 < args.Length)
+        {
+            programCacheDir = args[++i];
+        }
+        else if (args[i] == "--no-program-cache")
+        {
+            useProgramCache = false;
+        }
+        else if (args[i] == "--lazy-parse")
+        {
+            lazyParse = true;
+        }
+        else if (args[i] == "--precompile")
+        {
+            precompile = true;
+        }
+        else if (args[i] == "--no-watch")
+        {
+            watchSources = false;
+        }
+        else if (args[i] == "--dormant-heartbeats")
+        {
+            dormantHeartbeats = true;
+        }
+        else if (args[i] == "--gc-idle")
+        {
+            gcIdle = true;
+        }
+        else if (args[i] == "--parallel-heartbeats")
+        {
+            parallelHeartbeats = true;
+        }
+        else if (args[i] == "--binary-saves")
+        {
+            SaveFormat.Binary = true;
+        }
+        else if (args[i] == "--logins-per-tick" && i + 1 < args.Length)
+        {
+            if (!int.TryParse(args[++i], out loginsPerTick) || loginsPerTick < 1)
+            {
+                Console.Error.WriteLine($"Error: Invalid logins per tick: {args[i]}");
+                return 1;
+            }
+        }
+        else if (args[i] == "--region-threads" && i + 1 < args.Length)
+        {
+            if (!int.TryParse(args[++i], out regionThreads) || regionThreads < 0 || regionThreads > 256)
+            {
+                Console.Error.WriteLine($"Error: Invalid region thread count: {args[i]}");
+                return 1;
+            }
+        }
+        else if (args[i] == "--cpu-budget" && i + 1 < args.Length)
+        {
+            if (!long.TryParse(args[++i], out cpuBudget) || cpuBudget < 0)
+            {
+                Console.Error.WriteLine($"Error: Invalid CPU budget: {args[i]}");
+                return 1;
+            }
+        }
+        else if (args[i] == "--clean-up" && i + 1 < args.Length)
+        {
+            if (!int.TryParse(args[++i], out cleanUpIdleSeconds) || cleanUpIdleSeconds < 0)
+            {
+                Console.Error.WriteLine($"Error: Invalid clean_up idle time: {args[i]}");
+                return 1;
+            }
+        }
+        else if (args[i] == "--slow-command" && i + 1 < args.Length)
+        {
+            if (!int.TryParse(args[++i], out slowCommandMs) || slowCommandMs < 0)
+            {
+                Console.Error.WriteLine($"Error: Invalid slow command threshold: {args[i]}");
+                return 1;
+            }
+        }
+        else if (args[i] == "--output-limit" && i + 1 < args.Length)
+        {
+            if (!int.TryParse(args[++i], out var limitKb) || limitKb < 1 || limitKb > 1024 * 1024)
+            {
+                Console.Error.WriteLine($"Error: Invalid output limit: {args[i]}");
+                return 1;
+            }
+            outputLimits = outputLimits with { MaxQueuedBytes = limitKb * 1024 };
+        }
+        else if (args[i] == "--output-policy" && i + 1 < args.Length)
+        {
+            OutputOverflowPolicy? policy = args[++i].ToLowerInvariant() switch
+            {
+                "drop" => OutputOverflowPolicy.DropOldest,
+                "linkdead" => OutputOverflowPolicy.Linkdead,
+                "disconnect" => OutputOverflowPolicy.Disconnect,
+                _ => null
+            };
+            if (policy == null)
+            {
+                Console.Error.WriteLine($"Error: Invalid output policy. Use: drop, linkdead, disconnect");
+                return 1;
+            }
+            outputLimits = outputLimits with { Policy = policy.Value };
+        }
+        else if (args[i] == "--compression" && i + 1 < args.Length)
+        {
+            switch (args[++i].ToLowerInvariant())
+            {
+                case "off": compression = null; break;
+                case "fastest": compression = CompressionLevel.Fastest; break;
+                case "optimal": compression = CompressionLevel.Optimal; break;
+                case "smallest": compression = CompressionLevel.SmallestSize; break;
+                default:
+                    Console.Error.WriteLine($"Error: Invalid compression level. Use: off, fastest, optimal, smallest");
+                    return 1;
+            }
+        }
+        else if (args[i] == "--metrics-port" && i + 1 < args.Length)
+        {
+            if (!int.TryParse(args[++i], out var parsedMetricsPort) || parsedMetricsPort < 1 || parsedMetricsPort > 65535)
+            {
+                Console.Error.WriteLine($"Error: Invalid metrics port: {args[i]}");
+                return 1;
+            }
+            metricsPort = parsedMetricsPort;
+        }
+        else if (args[i] == "--snapshot" && i + 1 < args.Length)
+        {
+            snapshotPath = args[++i];
+        }
+        else if (args[i] == "--save-store" && i + 1 < args.Length)
+        {
+            saveStorePath = args[++i];
+        }
+        else if (args[i] == "--record" && i + 1 < args.Length)
+        {
+            recordPath = args[++i];
+        }
+        else if (args[i] == "--cluster" && i + 1 < args.Length)
+        {
+            clusterPath = args[++i];
+        }
+        else if (args[i] == "--node" && i + 1 < args.Length)
+        {
+            nodeName = args[++i];
+        }
+        else if (args[i] == "--websocket-port" && i + 1 < args.Length)
+        {
+            if (!int.TryParse(args[++i], out var parsedWebSocketPort) || parsedWebSocketPort < 1 || parsedWebSocketPort > 65535)
+            {
+                Console.Error.WriteLine($"Error: Invalid WebSocket port: {args[i]}");
+                return 1;
+            }
+            webSocketPort = parsedWebSocketPort;
+        }
+        else if (args[i] == "--copyover" && i + 1 < args.Length)
+        {
+            copyoverState = args[++i];
+        }
         else if (int.TryParse(args[i], out var parsedPort) && parsedPort >= 1 && parsedPort <= 65535)
         {
             port = parsedPort;
@@ -272,6 +877,28 @@ int Server(string[] args)
         return 1;
     }
 
+    // A cluster node listens on its own port, for the router only. Saves are shared
+    // through the mudlib's files, and streams aren't compressed so they can be moved.
+    ClusterNode? clusterNode = null;
+    if (clusterPath != null)
+    {
+        if (nodeName == null)
+        {
+            Console.Error.WriteLine("Error: --cluster requires --node <name>");
+            return 1;
+        }
+        if (saveStorePath != null)
+        {
+            Console.Error.WriteLine("Error: --save-store can't be shared by cluster nodes");
+            return 1;
+        }
+        var clusterConfig = ClusterConfig.Load(clusterPath);
+        clusterNode = new ClusterNode(clusterConfig, nodeName);
+        port = clusterConfig.Find(nodeName)!.Port;
+        compression = null;
+        webSocketPort = null;
+    }
+
     Logger.Info("Starting LPMud Revival...", LogCategory.System);
     Logger.Info($"  Mudlib: {Path.GetFullPath(mudlibPath)}", LogCategory.System);
     Logger.Info($"  Port: {port}", LogCategory.System);
@@ -279,34 +906,140 @@ int Server(string[] args)
     // Create object manager
     var objectManager = new ObjectManager(mudlibPath);
     objectManager.InitializeInterpreter();
+    objectManager.Interpreter!.UseBytecode = useBytecode;
+    objectManager.Interpreter.UseJit = useJit;
+    objectManager.Interpreter.MemoizeQueries = memoize;
+
+    if (lazyParse)
+    {
+        objectManager.LazyParse = true;
+        Logger.Info("  Lazy parsing: function bodies are parsed on first call", LogCategory.System);
+    }
+    else if (useProgramCache)
+    {
+        // Defaults to a directory beside the mudlib so the cache is never visible to LPC code
+        programCacheDir ??= Path.Combine(Path.GetDirectoryName(objectManager.MudlibPath.TrimEnd(Path.DirectorySeparatorChar)) ?? ".", ".lpcache");
+        objectManager.ProgramCache = new ProgramCache(programCacheDir);
+        Logger.Info($"  Program cache: {objectManager.ProgramCache.Directory}", LogCategory.System);
+    }
+
+    if (precompile)
+    {
+        var report = objectManager.Precompile();
+        foreach (var file in report.Files)
+        {
+            if (file.Error == null)
+            {
+                Logger.Info($"  Precompiled {file.Path} ({file.Milliseconds:F1} ms)", LogCategory.System);
+            }
+            else
+            {
+                Logger.Warning($"  Precompile failed {file.Path} ({file.Milliseconds:F1} ms): {file.Error}", LogCategory.System);
+            }
+        }
+        Logger.Info($"Precompiled {report.Compiled} programs in {report.TotalMilliseconds:F0} ms ({report.Failed} failed)", LogCategory.System);
+    }
+
+    // Player saves and accounts go to the store when there is one, and to files otherwise
+    using var saveStore = saveStorePath != null ? new SaveStore(saveStorePath) : null;
+    if (saveStore != null)
+    {
+        objectManager.SaveStore = saveStore;
+        Logger.Info($"  Save store: {saveStore.Path} ({saveStore.Count} saves)", LogCategory.System);
+    }
 
     // Create account manager
-    var accountManager = new AccountManager(mudlibPath);
+    var accountManager = new AccountManager(mudlibPath, saveStore);
 
     // Create game loop
-    var gameLoop = new GameLoop(objectManager, accountManager);
+    var gameLoop = new GameLoop(objectManager, accountManager)
+    {
+        HeartbeatDormancy = dormantHeartbeats,
+        IdleCollector = gcIdle ? new IdleCollector() : null,
+        MaxLoginsPerTick = loginsPerTick,
+        RegionThreads = regionThreads,
+        ParallelHeartbeats = parallelHeartbeats,
+        CleanUpIdleSeconds = cleanUpIdleSeconds
+    };
+    gameLoop.Cpu.Budget = cpuBudget;
+    gameLoop.Latency.SlowThresholdMs = slowCommandMs;
+    using var recorder = recordPath != null ? new CommandRecorder(recordPath) : null;
+    if (recorder != null)
+    {
+        gameLoop.Recorder = recorder;
+        Logger.Info($"  Recording commands: {recorder.Path} (seed {recorder.Seed})", LogCategory.System);
+    }
+    if (clusterNode != null)
+    {
+        gameLoop.Cluster = clusterNode;
+        clusterNode.Start();
+        Logger.Info($"  Cluster node: {clusterNode.Name}, router link {clusterNode.Config.RouterHost}:{clusterNode.Config.LinkPort}", LogCategory.System);
+    }
 
     // Get the interpreter from ObjectManager and pass it to GameLoop
     // We need to access it via reflection or add a property
     // For now, let's create our own interpreter instance
-    var interpreter = new ObjectInterpreter(objectManager);
+    var interpreter = new ObjectInterpreter(objectManager) { UseBytecode = useBytecode, UseJit = useJit, MemoizeQueries = memoize };
     gameLoop.InitializeInterpreter(interpreter);
 
+    // Bring the world back as the last snapshot left it
+    if (snapshotPath != null)
+    {
+        gameLoop.Snapshot = new WorldSnapshot(snapshotPath, objectManager);
+        Logger.Info($"  World snapshot: {gameLoop.Snapshot.Path}", LogCategory.System);
+        if (File.Exists(gameLoop.Snapshot.Path))
+        {
+            try
+            {
+                WorldSnapshot.Restore(gameLoop.Snapshot.Path, objectManager, gameLoop);
+            }
+            catch (Exception ex) when (ex is IOException or InvalidDataException)
+            {
+                Logger.Error($"World snapshot not restored: {ex.Message}", LogCategory.System);
+            }
+        }
+    }
+
+    // Map the world's exits for find_path() and rooms_within()
+    var graphTime = System.Diagnostics.Stopwatch.StartNew();
+    objectManager.WorldGraph.Build(objectManager);
+    Logger.Info($"  World graph: {objectManager.WorldGraph.RoomCount} rooms, {objectManager.WorldGraph.ExitCount} exits in {graphTime.Elapsed.TotalMilliseconds:F0} ms", LogCategory.System);
+
+    // Help files are read once here and again whenever /help changes
+    using var helpIndex = new HelpIndex(objectManager.MudlibPath, watch: watchSources);
+    objectManager.Help = helpIndex;
+
+    // Recompile edited files in the background; the game loop swaps them in
+    using var sourceWatcher = watchSources ? new SourceWatcher(objectManager) : null;
+    if (sourceWatcher != null)
+    {
+        Logger.Info("  Watching mudlib for changes", LogCategory.System);
+    }
+
     // Start game loop
     gameLoop.Start();
 
-    // Create and start telnet server
-    using var server = new TelnetServer(port, gameLoop);
+    // Create and start telnet server, or take over the previous process's sockets after a copyover
+    using var server = copyoverState != null
+        ? new TelnetServer(Copyover.Load(copyoverState), gameLoop, outputLimits, compression) { WebSocketPort = webSocketPort }
+        : new TelnetServer(port, gameLoop, outputLimits, compression) { WebSocketPort = webSocketPort };
+
+    using var metricsServer = metricsPort != null ? new MetricsServer(metricsPort.Value, gameLoop, objectManager, server) : null;
+    if (metricsServer != null)
+    {
+        metricsServer.Start();
+        Logger.Info($"  Metrics: http://localhost:{metricsPort}/metrics", LogCategory.System);
+    }
 
     // Start console command handler on background thread
-    var consoleThread = new Thread(() => ConsoleCommandLoop(objectManager, server))
+    var consoleThread = new Thread(() => ConsoleCommandLoop(objectManager, gameLoop, server))
     {
         IsBackground = true,
         Name = "ConsoleCommands"
     };
     consoleThread.Start();
 
-    Logger.Info("Console commands: reload, status, quit, help", LogCategory.System);
+    Logger.Info("Console commands: reload, status, connections, copyover, quit, help", LogCategory.System);
 
     try
     {
@@ -316,12 +1049,14 @@ int Server(string[] args)
     {
         // Cleanup
         gameLoop.Stop();
+        clusterNode?.Dispose();
+        Logger.Close();
     }
 
     return 0;
 }
 
-void ConsoleCommandLoop(ObjectManager objectManager, TelnetServer server)
+void ConsoleCommandLoop(ObjectManager objectManager, GameLoop gameLoop, TelnetServer server)
 {
     while (true)
     {
@@ -335,29 +1070,49 @@ void ConsoleCommandLoop(ObjectManager objectManager, TelnetServer server)
         switch (cmd)
         {
             case "reload":
-                if (parts.Length > 1)
+                // Reloading changes the world, so it runs on the game thread
+                var reloadPath = parts.Length > 1 ? (parts[1].StartsWith("/") ? parts[1] : "/" + parts[1]) : null;
+                gameLoop.Post(() =>
                 {
-                    var path = parts[1].StartsWith("/") ? parts[1] : "/" + parts[1];
-                    try
+                    if (reloadPath != null)
                     {
-                        int n = objectManager.UpdateObject(path);
-                        Console.WriteLine($"Reloaded {n} object(s).");
+                        try
+                        {
+                            int n = objectManager.UpdateObject(reloadPath);
+                            Console.WriteLine($"Reloaded {n} object(s).");
+                        }
+                        catch (Exception ex)
+                        {
+                            Console.WriteLine($"Error: {ex.Message}");
+                        }
                     }
-                    catch (Exception ex)
+                    else
                     {
-                        Console.WriteLine($"Error: {ex.Message}");
+                        var (ok, fail) = objectManager.ReloadAll();
+                        Console.WriteLine($"Reloaded {ok} objects ({fail} failed).");
                     }
-                }
-                else
-                {
-                    var (ok, fail) = objectManager.ReloadAll();
-                    Console.WriteLine($"Reloaded {ok} objects ({fail} failed).");
-                }
+                });
                 break;
 
             case "status":
-                var stats = objectManager.GetStats();
+                var stats = objectManager.Snapshot.Stats;
                 Console.WriteLine($"Connections: {server.ConnectionCount}  Blueprints: {stats.BlueprintCount}  Clones: {stats.CloneCount}");
+                var output = server.GetOutputStats();
+                var heartbeats = gameLoop.GetHeartbeatBucketSizes();
+                Console.WriteLine($"Heartbeats: {heartbeats.Sum()} objects, at most {heartbeats.Max()} per tick  Timers: {gameLoop.PendingTimerCount}");
+                Console.WriteLine($"Output: {output.BytesSent / 1024} KB sent  {output.QueuedBytes / 1024} KB queued  {output.BytesDropped / 1024} KB dropped  {output.Overflows} overflows");
+                break;
+
+            case "connections":
+                foreach (var conn in server.GetConnections())
+                {
+                    var compressed = conn.IsCompressing ? $"MCCP2 {conn.CompressionRatio:F1}:1" : "uncompressed";
+                    Console.WriteLine($"  {conn.Id}  {conn.BytesSent / 1024} KB sent  {conn.QueuedBytes / 1024} KB queued  {compressed}");
+                }
+                break;
+
+            case "copyover":
+                server.RequestCopyover();
                 break;
 
             case "quit":
@@ -366,7 +1121,7 @@ void ConsoleCommandLoop(ObjectManager objectManager, TelnetServer server)
                 return;
 
             case "help":
-                Console.WriteLine("Commands: reload [path], status, quit, help");
+                Console.WriteLine("Commands: reload [path], status, connections, copyover, quit, help");
                 break;
 
             default:
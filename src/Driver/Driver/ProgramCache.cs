@@ -0,0 +1,184 @@
+using System.Security.Cryptography;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// On-disk cache of parsed programs, so a restart doesn't preprocess, lex and
+/// parse every file in the mudlib again.
+///
+/// Each entry holds the preprocessed source, its line map and the top-level
+/// statements of one file, keyed by a hash of its source text plus a hash of every file it
+/// #included (and the preprocessor's predefined symbols). An entry is only
+/// used when all of those still match, so editing a file or any header it
+/// includes forces a recompile. Inherits are not baked in: the
+/// statements are processed by ObjectManager as usual, which loads parents
+/// and lowers bytecode on every start.
+///
+/// Cache files are per program path under Directory. A corrupt, truncated or
+/// older-format file is treated as a miss and rewritten on the next compile.
+/// </summary>
+public class ProgramCache
+{
+    private const uint Magic = 0x4343504C; // "LPCC"
+
+    /// <summary>
+    /// Directory holding the cache files.
+    /// </summary>
+    public string Directory { get; }
+
+    /// <summary>
+    /// Loads served from the cache since startup.
+    /// </summary>
+    public int Hits => _hits;
+
+    /// <summary>
+    /// Loads that had to compile (no entry, or a stale one).
+    /// </summary>
+    public int Misses => _misses;
+
+    private int _hits;
+    private int _misses;
+
+    /// <summary>
+    /// A cache hit: what the preprocessor and parser would have produced,
+    /// and the files that were included to produce it.
+    /// </summary>
+    public record CachedParse(string PreprocessedSource, SourceMap LineMap, List<Statement> Statements, List<string> IncludedFiles);
+
+    public ProgramCache(string directory)
+    {
+        Directory = Path.GetFullPath(directory);
+        System.IO.Directory.CreateDirectory(Directory);
+    }
+
+    /// <summary>
+    /// Look up the parse for a program, or null when there is no usable entry.
+    /// </summary>
+    public CachedParse? TryLoad(string programPath, string sourceCode, string predefines)
+    {
+        var cacheFile = GetCacheFile(programPath);
+        if (!File.Exists(cacheFile))
+        {
+            Interlocked.Increment(ref _misses);
+            return null;
+        }
+
+        try
+        {
+            using var stream = File.OpenRead(cacheFile);
+            using var reader = new BinaryReader(stream, Encoding.UTF8);
+
+            if (reader.ReadUInt32() != Magic || reader.ReadInt32() != AstSerializer.FormatVersion)
+            {
+                Interlocked.Increment(ref _misses);
+                return null;
+            }
+
+            bool valid = reader.ReadString() == programPath
+                && reader.ReadString() == Hash(sourceCode)
+                && reader.ReadString() == Hash(predefines);
+
+            int includeCount = reader.ReadInt32();
+            var includes = new List<string>();
+            for (int i = 0; i < includeCount && valid; i++)
+            {
+                var includePath = reader.ReadString();
+                var includeHash = reader.ReadString();
+                valid = File.Exists(includePath) && HashFile(includePath) == includeHash;
+                includes.Add(includePath);
+            }
+
+            if (!valid)
+            {
+                Interlocked.Increment(ref _misses);
+                return null;
+            }
+
+            var preprocessed = reader.ReadString();
+            var lineMap = SourceMap.Read(reader);
+            var statements = AstSerializer.ReadStatements(reader);
+
+            Interlocked.Increment(ref _hits);
+            return new CachedParse(preprocessed, lineMap, statements, includes);
+        }
+        catch (Exception ex) when (ex is IOException or InvalidDataException or EndOfStreamException or UnauthorizedAccessException)
+        {
+            Logger.Debug($"Ignoring unreadable program cache entry {cacheFile}: {ex.Message}", LogCategory.Object);
+            Interlocked.Increment(ref _misses);
+            return null;
+        }
+    }
+
+    /// <summary>
+    /// Record a fresh parse. Failures are logged and otherwise ignored; the
+    /// cache is only ever an optimization.
+    /// </summary>
+    public void Store(string programPath, string sourceCode, string predefines,
+        IEnumerable<string> includedFiles, string preprocessedSource, SourceMap lineMap, List<Statement> statements)
+    {
+        var cacheFile = GetCacheFile(programPath);
+        var tempFile = cacheFile + "." + Environment.CurrentManagedThreadId + ".tmp";
+
+        try
+        {
+            using (var stream = File.Create(tempFile))
+            using (var writer = new BinaryWriter(stream, Encoding.UTF8))
+            {
+                writer.Write(Magic);
+                writer.Write(AstSerializer.FormatVersion);
+                writer.Write(programPath);
+                writer.Write(Hash(sourceCode));
+                writer.Write(Hash(predefines));
+
+                var includes = includedFiles.ToList();
+                writer.Write(includes.Count);
+                foreach (var includePath in includes)
+                {
+                    writer.Write(includePath);
+                    writer.Write(HashFile(includePath));
+                }
+
+                writer.Write(preprocessedSource);
+                lineMap.Write(writer);
+                AstSerializer.WriteStatements(writer, statements);
+            }
+
+            // Rename into place so a reader never sees a half-written entry
+            File.Move(tempFile, cacheFile, overwrite: true);
+        }
+        catch (Exception ex) when (ex is IOException or NotSupportedException or UnauthorizedAccessException)
+        {
+            Logger.Warning($"Could not write program cache entry for {programPath}: {ex.Message}", LogCategory.Object);
+            try { File.Delete(tempFile); } catch (IOException) { }
+        }
+    }
+
+    /// <summary>
+    /// Delete every cache file.
+    /// </summary>
+    public void Clear()
+    {
+        foreach (var file in System.IO.Directory.EnumerateFiles(Directory, "*.lpcc"))
+        {
+            File.Delete(file);
+        }
+    }
+
+    private string GetCacheFile(string programPath)
+    {
+        // "/std/room" -> "std~room.lpcc"
+        var name = programPath.TrimStart('/').Replace('/', '~');
+        return Path.Combine(Directory, name + ".lpcc");
+    }
+
+    private static string Hash(string text)
+    {
+        return Convert.ToHexString(SHA256.HashData(Encoding.UTF8.GetBytes(text)));
+    }
+
+    internal static string HashFile(string path)
+    {
+        return Convert.ToHexString(SHA256.HashData(File.ReadAllBytes(path)));
+    }
+}
@@ -0,0 +1,139 @@
+namespace Driver;
+
+/// <summary>
+/// Which calls of a compiled function QueryMemo may answer.
+/// </summary>
+public enum QueryMemoKind
+{
+    /// <summary>
+    /// Not a pure query: always run.
+    /// </summary>
+    None,
+
+    /// <summary>
+    /// return variable; - any result is the variable's value.
+    /// </summary>
+    Getter,
+
+    /// <summary>
+    /// A computation over the object's variables: int, float and string
+    /// results are kept, arrays and mappings (which would be shared) aren't.
+    /// </summary>
+    Scalar
+}
+
+/// <summary>
+/// Memoized results of one object's pure query functions.
+///
+/// query_short(), query_name() and the like are called from everywhere
+/// (look, who, combat messages, GameLoop.GetPlayerName) and nearly always
+/// just return a variable. The bytecode compiler marks a function as a pure
+/// query (Classify) when it takes no arguments and its body is only if and
+/// return over literals, object variables and operators: no calls, no
+/// indexing, no assignments. Its result then depends on nothing but the
+/// object's variables, so a call can be answered from the last result while
+/// the object's StateVersion, which every variable write bumps, is the same
+/// as when it was computed. No call, sizeof() or index means an array a
+/// query reads can't be changed in place under it without a variable write.
+///
+/// A hit skips the frame, the VM and the instruction charge. Calls aren't
+/// memoized while the function profiler or a call trace is on, so they see
+/// every call. Only touched by the thread running the object's code.
+/// </summary>
+internal sealed class QueryMemo
+{
+    /// <summary>
+    /// Results kept per object; past this the oldest is replaced.
+    /// </summary>
+    private const int Capacity = 8;
+
+    private struct Entry
+    {
+        public CompiledFunction Function;
+        public long Version;
+        public object? Value;
+    }
+
+    private readonly Entry[] _entries = new Entry[Capacity];
+    private int _count;
+    private int _next;
+
+    public bool TryGet(CompiledFunction function, long version, out object? value)
+    {
+        for (int i = 0; i < _count; i++)
+        {
+            ref var entry = ref _entries[i];
+            if (ReferenceEquals(entry.Function, function))
+            {
+                value = entry.Value;
+                return entry.Version == version;
+            }
+        }
+        value = null;
+        return false;
+    }
+
+    /// <summary>
+    /// Keep result of function as of version, if its kind allows.
+    /// </summary>
+    public void Store(CompiledFunction function, long version, object? result)
+    {
+        if (function.Memo == QueryMemoKind.Scalar && result is not (null or long or int or double or string)) return;
+
+        int index = Array.FindIndex(_entries, 0, _count, entry => ReferenceEquals(entry.Function, function));
+        if (index < 0)
+        {
+            if (_count < Capacity)
+            {
+                index = _count++;
+            }
+            else
+            {
+                index = _next;
+                _next = (_next + 1) % Capacity;
+            }
+        }
+        _entries[index] = new Entry { Function = function, Version = version, Value = result };
+    }
+
+    #region Analysis
+
+    /// <summary>
+    /// Whether function, with the given body, is a pure query and how its
+    /// results may be kept.
+    /// </summary>
+    public static QueryMemoKind Classify(FunctionDefinition function, Statement body)
+    {
+        if (function.Parameters.Count != 0 || function.Varargs) return QueryMemoKind.None;
+        if (body is BlockStatement { Statements: [ReturnStatement { Value: Identifier }] }) return QueryMemoKind.Getter;
+        return Statement(body) ? QueryMemoKind.Scalar : QueryMemoKind.None;
+    }
+
+    private static bool Statement(Statement? statement)
+    {
+        return statement switch
+        {
+            null => true,
+            BlockStatement block => block.Statements.TrueForAll(Statement),
+            ReturnStatement r => r.Value != null && Expression(r.Value),
+            IfStatement i => Expression(i.Condition) && Statement(i.ThenBranch) && Statement(i.ElseBranch),
+            _ => false
+        };
+    }
+
+    private static bool Expression(Expression expression)
+    {
+        return expression switch
+        {
+            NumberLiteral or StringLiteral or Identifier => true,
+            BinaryOp b => Expression(b.Left) && Expression(b.Right),
+            UnaryOp u => u.Operator is UnaryOperator.Negate or UnaryOperator.LogicalNot or UnaryOperator.BitwiseNot &&
+                         Expression(u.Operand),
+            GroupedExpression g => Expression(g.Inner),
+            TernaryOp t => Expression(t.Condition) && Expression(t.ThenBranch) && Expression(t.ElseBranch),
+            _ => false
+        };
+    }
+
+    #endregion
+}
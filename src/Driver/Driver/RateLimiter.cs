@@ -1,8 +1,16 @@
+using System.Diagnostics;
+
 namespace Driver;
 
 /// <summary>
 /// Rate limiter for preventing command flooding and abuse.
-/// Uses a sliding window algorithm to track command rates.
+///
+/// Command rates are a token bucket kept on each session (a CommandRate),
+/// so checking one is a compare-and-swap on a single long: no lock, no
+/// allocation, nothing shared between connections. A connection may burst
+/// MaxCommandsPerWindow commands and then gets one more every
+/// WindowSeconds / MaxCommandsPerWindow. Login attempts are rare and stay in
+/// locked dictionaries.
 /// </summary>
 public class RateLimiter
 {
@@ -31,83 +39,58 @@ public class RateLimiter
     /// </summary>
     public bool Enabled { get; set; } = true;
 
-    // Track command timestamps per connection
-    private readonly Dictionary<string, Queue<DateTime>> _commandHistory = new();
-    private readonly object _commandLock = new();
-
     // Track login attempts per IP/connection
     private readonly Dictionary<string, List<DateTime>> _loginAttempts = new();
     private readonly Dictionary<string, DateTime> _loginLockouts = new();
     private readonly object _loginLock = new();
 
     /// <summary>
-    /// Check if a command is allowed for this connection.
+    /// Check if a command is allowed, and if so take it from the bucket.
     /// Returns true if allowed, false if rate limited.
     /// </summary>
-    public bool AllowCommand(string connectionId)
+    public bool AllowCommand(CommandRate rate)
     {
         if (!Enabled)
             return true;
 
-        var now = DateTime.UtcNow;
-        var windowStart = now.AddSeconds(-WindowSeconds);
+        long window = WindowTicks;
+        long interval = window / Math.Max(1, MaxCommandsPerWindow);
+        long now = Stopwatch.GetTimestamp();
 
-        lock (_commandLock)
+        while (true)
         {
-            if (!_commandHistory.TryGetValue(connectionId, out var history))
-            {
-                history = new Queue<DateTime>();
-                _commandHistory[connectionId] = history;
-            }
+            long due = Volatile.Read(ref rate.Due);
+            long next = Math.Max(due, now) + interval;
 
-            // Remove old entries outside the window
-            while (history.Count > 0 && history.Peek() < windowStart)
+            // Over the limit once the backlog would exceed the window
+            if (next - now > window)
             {
-                history.Dequeue();
+                return false;
             }
 
-            // Check if we're at the limit
-            if (history.Count >= MaxCommandsPerWindow)
+            if (Interlocked.CompareExchange(ref rate.Due, next, due) == due)
             {
-                return false;
+                return true;
             }
-
-            // Add this command
-            history.Enqueue(now);
-            return true;
         }
     }
 
     /// <summary>
     /// Get remaining commands allowed in current window.
     /// </summary>
-    public int GetRemainingCommands(string connectionId)
+    public int GetRemainingCommands(CommandRate rate)
     {
         if (!Enabled)
             return int.MaxValue;
 
-        var now = DateTime.UtcNow;
-        var windowStart = now.AddSeconds(-WindowSeconds);
-
-        lock (_commandLock)
-        {
-            if (!_commandHistory.TryGetValue(connectionId, out var history))
-            {
-                return MaxCommandsPerWindow;
-            }
-
-            // Count commands in window
-            int count = 0;
-            foreach (var time in history)
-            {
-                if (time >= windowStart)
-                    count++;
-            }
-
-            return Math.Max(0, MaxCommandsPerWindow - count);
-        }
+        long window = WindowTicks;
+        long interval = window / Math.Max(1, MaxCommandsPerWindow);
+        long backlog = Math.Max(0, Volatile.Read(ref rate.Due) - Stopwatch.GetTimestamp());
+        return (int)Math.Clamp((window - backlog) / interval, 0, MaxCommandsPerWindow);
     }
 
+    private long WindowTicks => (long)WindowSeconds * Stopwatch.Frequency;
+
     /// <summary>
     /// Record a failed login attempt for a connection.
     /// </summary>
@@ -206,11 +189,6 @@ public class RateLimiter
     /// </summary>
     public void RemoveConnection(string connectionId)
     {
-        lock (_commandLock)
-        {
-            _commandHistory.Remove(connectionId);
-        }
-
         lock (_loginLock)
         {
             _loginAttempts.Remove(connectionId);
@@ -219,38 +197,13 @@ public class RateLimiter
     }
 
     /// <summary>
-    /// Clean up old entries (call periodically).
+    /// Clean up old login entries (call periodically).
     /// </summary>
     public void Cleanup()
     {
         var now = DateTime.UtcNow;
-        var windowStart = now.AddSeconds(-WindowSeconds);
         var loginWindowStart = now.AddSeconds(-LoginLockoutSeconds * 2);
 
-        lock (_commandLock)
-        {
-            var toRemove = new List<string>();
-            foreach (var kvp in _commandHistory)
-            {
-                // Remove old entries
-                while (kvp.Value.Count > 0 && kvp.Value.Peek() < windowStart)
-                {
-                    kvp.Value.Dequeue();
-                }
-
-                // Mark empty histories for removal
-                if (kvp.Value.Count == 0)
-                {
-                    toRemove.Add(kvp.Key);
-                }
-            }
-
-            foreach (var key in toRemove)
-            {
-                _commandHistory.Remove(key);
-            }
-        }
-
         lock (_loginLock)
         {
             // Clean up old login attempts
@@ -286,3 +239,12 @@ public class RateLimiter
         }
     }
 }
+
+/// <summary>
+/// A connection's command token bucket, as the time its bucket is next full
+/// (Stopwatch ticks). Updated in place by RateLimiter.AllowCommand.
+/// </summary>
+public sealed class CommandRate
+{
+    internal long Due;
+}
@@ -0,0 +1,70 @@
+using System.Text.RegularExpressions;
+
+namespace Driver;
+
+/// <summary>
+/// Compiled patterns for the regex efuns.
+///
+/// Command parsing calls regexp() and friends with the same few patterns
+/// over and over; parsing each one afresh was most of their cost. Patterns
+/// are kept here, least recently used dropped first once there are Capacity
+/// of them. A pattern used HotUses times is rebuilt with
+/// RegexOptions.Compiled, which is slow to build but matches faster.
+///
+/// Every pattern gets MatchTimeout, so a pathological pattern fails its
+/// efun with an error instead of stalling the tick.
+/// </summary>
+public static class RegexCache
+{
+    /// <summary>
+    /// Most patterns kept.
+    /// </summary>
+    public const int Capacity = 256;
+
+    /// <summary>
+    /// Uses after which a pattern is compiled to IL.
+    /// </summary>
+    public const int HotUses = 64;
+
+    /// <summary>
+    /// Longest a single match may run.
+    /// </summary>
+    public static readonly TimeSpan MatchTimeout = TimeSpan.FromMilliseconds(100);
+
+    private sealed class Entry
+    {
+        public required Regex Regex;
+        public int Uses;
+    }
+
+    private static readonly LruCache<(string, RegexOptions), Entry> Entries = new(Capacity);
+
+    /// <summary>
+    /// Number of patterns cached.
+    /// </summary>
+    public static int Count => Entries.Count;
+
+    /// <summary>
+    /// The compiled form of pattern. Throws ArgumentException for a bad
+    /// pattern, which is not cached.
+    /// </summary>
+    public static Regex Get(string pattern, RegexOptions options = RegexOptions.None)
+    {
+        var entry = Entries.GetOrAdd((pattern, options),
+            key => new Entry { Regex = new Regex(key.Item1, key.Item2, MatchTimeout) });
+
+        if (Interlocked.Increment(ref entry.Uses) == HotUses)
+        {
+            entry.Regex = new Regex(pattern, options | RegexOptions.Compiled, MatchTimeout);
+        }
+        return entry.Regex;
+    }
+
+    /// <summary>
+    /// Drop every cached pattern.
+    /// </summary>
+    public static void Clear()
+    {
+        Entries.Clear();
+    }
+}
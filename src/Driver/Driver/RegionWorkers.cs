@@ -0,0 +1,336 @@
+namespace Driver;
+
+/// <summary>
+/// Keeps one worker's LPC inside its own region while heartbeats run in
+/// parallel.
+///
+/// A region is an area of the world: everything whose outermost environment
+/// is a room under /world/rooms/&lt;area&gt;/. Each worker interpreter runs one
+/// region's heartbeats at a time, holding the shared world lock in read mode.
+/// All the objects it touches freely are in that region, so no other thread
+/// touches them.
+///
+/// Anything that reaches outside the region takes the world lock in write
+/// mode for its duration, after every other worker has reached a safe point
+/// (between two heartbeats, or waiting for the lock itself). That covers a
+/// call into another region's object, an efun on a foreign object, and any
+/// efun that isn't known to be region-local (clone_object, users(),
+/// set_heart_beat, ...). Arguments and results of a cross-region call are
+/// deep-copied, so no array or mapping is shared between regions.
+///
+/// If the lock is released with an object on the LPC call stack no longer in
+/// the region (it moved itself out, say), the worker keeps the write lock
+/// until the heartbeat returns.
+/// </summary>
+public sealed class RegionGuard
+{
+    /// <summary>
+    /// Efuns that only compute on their arguments or on thread-local context.
+    /// call_other, filter_array and map_array are here because the calls they
+    /// make are checked one by one.
+    /// </summary>
+    private static readonly HashSet<string> PureEfuns = new()
+    {
+        "typeof", "strlen", "sizeof", "to_string", "to_int", "this_player", "random", "abs", "min", "max", "sum",
+        "member_array", "sprintf", "explode", "implode", "lower_case", "upper_case", "capitalize", "time",
+        "ctime", "localtime", "regexp", "regmatch", "regexplode", "sort_array", "unique_array", "m_indices",
+        "m_values", "m_delete", "mkmapping", "keys", "values", "strsrch", "member", "intp", "stringp",
+        "objectp", "pointerp", "arrayp", "mappingp", "allocate", "copy", "replace_string", "trim", "write",
+        "log_console", "this_object", "call_other", "call_other_many", "map_call", "filter_array", "map_array", "throw", "syslog",
+        "query_verb", "notify_fail", "previous_object", "query_dormant_elapsed", "find_path", "rooms_within"
+    };
+
+    /// <summary>
+    /// Efuns that only touch the objects they are given (and this_object()).
+    /// They run freely when all of those are in the region.
+    /// </summary>
+    private static readonly HashSet<string> LocalEfuns = new()
+    {
+        "environment", "all_inventory", "all_livings", "all_interactive", "first_inventory", "next_inventory",
+        "tell_object", "tell_room", "send_gmcp", "has_gmcp", "present", "move_object", "object_name", "file_name", "living",
+        "interactive", "clonep",
+        "query_heart_beat", "inherits", "set_attacking", "query_attacking", "query_attackers", "hostile_in_room",
+        "room_render", "set_room_render", "description_changed", "tell_room_tmpl"
+    };
+
+    private readonly ReaderWriterLockSlim _world;
+    private int _exclusiveDepth;
+    private bool _sticky;
+
+    internal RegionGuard(ReaderWriterLockSlim world)
+    {
+        _world = world;
+    }
+
+    /// <summary>
+    /// The region this worker is running.
+    /// </summary>
+    public string? Region { get; internal set; }
+
+    /// <summary>
+    /// Times this worker had to stop the other workers.
+    /// </summary>
+    public long ExclusiveSections { get; private set; }
+
+    /// <summary>
+    /// The area of a room path: /world/rooms/town/square is in "town". Null
+    /// for anything else.
+    /// </summary>
+    public static string? AreaOf(string filePath)
+    {
+        const string Prefix = "/world/rooms/";
+        if (!filePath.StartsWith(Prefix, StringComparison.Ordinal)) return null;
+
+        int end = filePath.IndexOf('/', Prefix.Length);
+        return end > Prefix.Length ? filePath[Prefix.Length..end] : null;
+    }
+
+    /// <summary>
+    /// The region obj belongs to: the area of its outermost environment (or
+    /// of obj itself when it has none). Null for objects outside any area,
+    /// such as daemons and things not yet moved anywhere.
+    /// </summary>
+    public static string? RegionOf(MudObject obj)
+    {
+        var top = obj;
+        while (top.Environment != null)
+        {
+            top = top.Environment;
+        }
+        return top.Area;
+    }
+
+    /// <summary>
+    /// Whether this worker may touch obj without stopping the others.
+    /// </summary>
+    public bool IsLocal(MudObject obj)
+    {
+        return !obj.IsDestructed && Region != null && RegionOf(obj) == Region;
+    }
+
+    /// <summary>
+    /// Whether an efun call can run without stopping the other workers.
+    /// </summary>
+    public bool AllowsEfun(string name, List<object> args)
+    {
+        if (_exclusiveDepth > 0 || _sticky || PureEfuns.Contains(name)) return true;
+        if (!LocalEfuns.Contains(name)) return false;
+
+        foreach (var arg in args)
+        {
+            if (arg is MudObject obj && !IsLocal(obj)) return false;
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Whether this worker is already running alone.
+    /// </summary>
+    public bool IsExclusive => _exclusiveDepth > 0 || _sticky;
+
+    /// <summary>
+    /// Start a top-level call (one heartbeat).
+    /// </summary>
+    internal void BeginCall()
+    {
+        _world.EnterReadLock();
+    }
+
+    /// <summary>
+    /// Finish the top-level call started by BeginCall().
+    /// </summary>
+    internal void EndCall()
+    {
+        if (_sticky)
+        {
+            _sticky = false;
+            _world.ExitWriteLock();
+        }
+        else
+        {
+            _world.ExitReadLock();
+        }
+    }
+
+    /// <summary>
+    /// Run an operation that reaches outside the region with every other
+    /// worker stopped. stillLocal reports afterwards whether the interpreter's
+    /// call stack is all in the region again.
+    /// </summary>
+    internal T RunExclusive<T>(Func<T> operation, Func<bool> stillLocal)
+    {
+        if (IsExclusive)
+        {
+            return operation();
+        }
+
+        _world.ExitReadLock();
+        _world.EnterWriteLock();
+        _exclusiveDepth++;
+        ExclusiveSections++;
+        try
+        {
+            return operation();
+        }
+        finally
+        {
+            _exclusiveDepth--;
+            if (stillLocal())
+            {
+                _world.ExitWriteLock();
+                _world.EnterReadLock();
+            }
+            else
+            {
+                _sticky = true;
+            }
+        }
+    }
+}
+
+/// <summary>
+/// A pool of threads, each with its own interpreter, that run groups of
+/// objects region by region.
+///
+/// Run() hands out the groups and blocks until every group is done. Each group
+/// runs on one worker, in order, with the worker's guard set to its region.
+/// </summary>
+public sealed class RegionWorkers : IDisposable
+{
+    private sealed class Worker
+    {
+        public required ObjectInterpreter Interpreter;
+        public required RegionGuard Guard;
+        public required Thread Thread;
+    }
+
+    private readonly ReaderWriterLockSlim _world = new(LockRecursionPolicy.NoRecursion);
+    private readonly List<Worker> _workers = new();
+    private readonly object _lock = new();
+    private readonly Queue<(string Region, List<MudObject> Objects)> _pending = new();
+    private Action<ObjectInterpreter, MudObject>? _body;
+    private int _outstanding;
+    private bool _disposed;
+
+    public RegionWorkers(int threads, Func<ObjectInterpreter> createInterpreter)
+    {
+        for (int i = 0; i < threads; i++)
+        {
+            var interpreter = createInterpreter();
+            var guard = new RegionGuard(_world);
+            interpreter.RegionGuard = guard;
+
+            var worker = new Worker
+            {
+                Interpreter = interpreter,
+                Guard = guard,
+                Thread = new Thread(WorkerLoop) { Name = $"Region-{i}", IsBackground = true }
+            };
+            _workers.Add(worker);
+            worker.Thread.Start(worker);
+        }
+    }
+
+    /// <summary>
+    /// Number of worker threads.
+    /// </summary>
+    public int Count => _workers.Count;
+
+    /// <summary>
+    /// Cross-region sections run so far, across all workers.
+    /// </summary>
+    public long ExclusiveSections => _workers.Sum(w => w.Guard.ExclusiveSections);
+
+    /// <summary>
+    /// Run body on every object, the groups in parallel. Exceptions from body
+    /// are the caller's to catch; one that escapes stops its group.
+    /// </summary>
+    public void Run(IEnumerable<(string Region, List<MudObject> Objects)> groups, Action<ObjectInterpreter, MudObject> body)
+    {
+        lock (_lock)
+        {
+            _body = body;
+            foreach (var group in groups)
+            {
+                _pending.Enqueue(group);
+                _outstanding++;
+            }
+            Monitor.PulseAll(_lock);
+
+            while (_outstanding > 0)
+            {
+                Monitor.Wait(_lock);
+            }
+            _body = null;
+        }
+    }
+
+    private void WorkerLoop(object? state)
+    {
+        var worker = (Worker)state!;
+        while (true)
+        {
+            (string Region, List<MudObject> Objects) group;
+            Action<ObjectInterpreter, MudObject> body;
+            lock (_lock)
+            {
+                while (_pending.Count == 0 && !_disposed)
+                {
+                    Monitor.Wait(_lock);
+                }
+                if (_disposed)
+                {
+                    worker.Interpreter.ReleaseThread();
+                    return;
+                }
+
+                group = _pending.Dequeue();
+                body = _body!;
+            }
+
+            worker.Guard.Region = group.Region;
+            try
+            {
+                foreach (var obj in group.Objects)
+                {
+                    worker.Guard.BeginCall();
+                    try
+                    {
+                        body(worker.Interpreter, obj);
+                    }
+                    finally
+                    {
+                        worker.Guard.EndCall();
+                    }
+                }
+            }
+            catch (Exception ex)
+            {
+                Logger.Error($"Region {group.Region} worker failed: {ex.Message}", LogCategory.System);
+            }
+            finally
+            {
+                worker.Guard.Region = null;
+                lock (_lock)
+                {
+                    _outstanding--;
+                    Monitor.PulseAll(_lock);
+                }
+            }
+        }
+    }
+
+    public void Dispose()
+    {
+        lock (_lock)
+        {
+            _disposed = true;
+            Monitor.PulseAll(_lock);
+        }
+        foreach (var worker in _workers)
+        {
+            worker.Thread.Join(TimeSpan.FromSeconds(5));
+        }
+        _world.Dispose();
+    }
+}
@@ -0,0 +1,98 @@
+using System.Collections.Concurrent;
+
+namespace Driver;
+
+/// <summary>
+/// Save files read and decoded on the thread pool ahead of the
+/// restore_object() that will want them, so the game thread only copies the
+/// values in. The login queue prefetches a player's save while they wait.
+///
+/// An entry is taken once. save_object() to the same file drops it, and a
+/// prefetch still running when that happens finds its slot gone and throws
+/// its result away, so a restore never sees data older than the last save.
+/// </summary>
+public sealed class RestorePrefetcher
+{
+    private readonly Func<string, byte[]?> _read;
+    private readonly ConcurrentDictionary<string, object> _prepared = new(StringComparer.Ordinal);
+    private long _hits;
+    private int _pending;
+
+    /// <param name="read">Reads a save file's bytes by full path, or null if there is none.</param>
+    public RestorePrefetcher(Func<string, byte[]?> read)
+    {
+        _read = read;
+    }
+
+    /// <summary>
+    /// Restores served from a prefetched entry.
+    /// </summary>
+    public long Hits => Interlocked.Read(ref _hits);
+
+    /// <summary>
+    /// Entries waiting to be taken, finished or not.
+    /// </summary>
+    public int Count => _prepared.Count;
+
+    /// <summary>
+    /// Prefetches still reading or decoding.
+    /// </summary>
+    public int Pending => Volatile.Read(ref _pending);
+
+    /// <summary>
+    /// Start reading and decoding fullPath on the pool, unless that is already under way.
+    /// </summary>
+    public void Prefetch(string fullPath)
+    {
+        var slot = new object();
+        if (!_prepared.TryAdd(fullPath, slot)) return;
+
+        Interlocked.Increment(ref _pending);
+        Task.Run(() =>
+        {
+            List<KeyValuePair<string, object>>? entries = null;
+            try
+            {
+                var data = _read(fullPath);
+                if (data != null) entries = SaveFormat.Read(data);
+            }
+            catch (Exception ex)
+            {
+                Logger.Debug($"Could not prefetch {fullPath}: {ex.Message}", LogCategory.Object);
+            }
+
+            if (entries == null)
+            {
+                _prepared.TryRemove(KeyValuePair.Create(fullPath, slot));
+            }
+            else
+            {
+                _prepared.TryUpdate(fullPath, entries, slot);
+            }
+            Interlocked.Decrement(ref _pending);
+        });
+    }
+
+    /// <summary>
+    /// The decoded variables for fullPath if a prefetch has finished, else
+    /// null. Either way the entry is gone afterwards.
+    /// </summary>
+    public List<KeyValuePair<string, object>>? Take(string fullPath)
+    {
+        if (!_prepared.TryRemove(fullPath, out var prepared) ||
+            prepared is not List<KeyValuePair<string, object>> entries)
+        {
+            return null;
+        }
+        Interlocked.Increment(ref _hits);
+        return entries;
+    }
+
+    /// <summary>
+    /// Drop any entry for fullPath: it has been saved over, or nobody will restore it.
+    /// </summary>
+    public void Invalidate(string fullPath)
+    {
+        _prepared.TryRemove(fullPath, out _);
+    }
+}
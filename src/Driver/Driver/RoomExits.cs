@@ -0,0 +1,113 @@
+namespace Driver;
+
+/// <summary>
+/// A room's exits: direction to destination path, hidden or not, with the
+/// destination room kept once it has been loaded.
+///
+/// /std/room.c used to hold one string variable per compass direction and
+/// go.c asked it through three call_others and a load_object() per step.
+/// The table lives on the room's MudObject instead, set with set_exit() and
+/// read with the exit_*() efuns, so a step is a dictionary lookup and, once
+/// the destination has loaded, an object reference. Any direction works, not
+/// just the ten compass ones.
+///
+/// "n", "ne", "u" and the other short forms are stored as their long names.
+/// Exits are listed compass directions first, in the order look has always
+/// shown them, then any others in the order they were added.
+/// </summary>
+public sealed class RoomExits
+{
+    private static readonly string[] CompassOrder =
+    {
+        "north", "south", "east", "west", "northeast", "northwest", "southeast", "southwest", "up", "down"
+    };
+
+    private static readonly Dictionary<string, string> ShortForms = new()
+    {
+        ["n"] = "north", ["s"] = "south", ["e"] = "east", ["w"] = "west",
+        ["ne"] = "northeast", ["nw"] = "northwest", ["se"] = "southeast", ["sw"] = "southwest",
+        ["u"] = "up", ["d"] = "down"
+    };
+
+    public sealed class Exit
+    {
+        public required string Direction { get; init; }
+        public required string Path { get; init; }
+        public required bool Hidden { get; init; }
+
+        /// <summary>
+        /// The destination, once loaded. Dropped when it's destructed, so a
+        /// room that was cleaned up is loaded again on the next step.
+        /// </summary>
+        internal MudObject? Destination;
+    }
+
+    private readonly Dictionary<string, Exit> _exits = new();
+    private readonly List<Exit> _ordered = new();
+
+    /// <summary>
+    /// The long name of a direction: "n" is "north", anything else is itself.
+    /// </summary>
+    public static string Canonical(string direction)
+    {
+        return ShortForms.TryGetValue(direction, out var full) ? full : direction;
+    }
+
+    public int Count => _exits.Count;
+
+    /// <summary>
+    /// All exits, hidden ones included, in listing order.
+    /// </summary>
+    public IReadOnlyList<Exit> All => _ordered;
+
+    /// <summary>
+    /// Add an exit, or replace the one already in that direction.
+    /// </summary>
+    public void Set(string direction, string path, bool hidden)
+    {
+        direction = Canonical(direction);
+        Remove(direction);
+
+        var exit = new Exit { Direction = direction, Path = path, Hidden = hidden };
+        _exits[direction] = exit;
+
+        int rank = Rank(direction);
+        int index = _ordered.FindIndex(e => Rank(e.Direction) > rank);
+        _ordered.Insert(index < 0 ? _ordered.Count : index, exit);
+    }
+
+    public bool Remove(string direction)
+    {
+        if (!_exits.Remove(Canonical(direction), out var exit)) return false;
+        _ordered.Remove(exit);
+        return true;
+    }
+
+    public Exit? Find(string direction)
+    {
+        return _exits.GetValueOrDefault(Canonical(direction));
+    }
+
+    /// <summary>
+    /// Where an exit leads, loading the room the first time. Null if there
+    /// is no exit that way; load failures are thrown.
+    /// </summary>
+    public MudObject? Destination(string direction, ObjectManager objectManager)
+    {
+        var exit = Find(direction);
+        if (exit == null) return null;
+
+        if (exit.Destination == null || exit.Destination.IsDestructed)
+        {
+            exit.Destination = objectManager.LoadObject(exit.Path);
+        }
+        return exit.Destination;
+    }
+
+    // Compass directions by their place in CompassOrder, others after them
+    private static int Rank(string direction)
+    {
+        int index = Array.IndexOf(CompassOrder, direction);
+        return index < 0 ? CompassOrder.Length : index;
+    }
+}
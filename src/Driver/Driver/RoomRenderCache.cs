@@ -0,0 +1,108 @@
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// What look shows in each room, kept between looks.
+///
+/// look runs on every command that moves a player, and rendering a room
+/// means asking it for its short, long and exits and every object in it for
+/// its short and more. Rooms rarely change from one look to the next, so
+/// look stores what it rendered with set_room_render() and the next look
+/// takes it from room_render() until something changes.
+///
+/// An entry holds the room's heading and one line per object, in order. It
+/// is good while the room's contents version (bumped by every move in or out,
+/// destruct included) and the description versions of the room and of each
+/// object listed are what they were when it was stored. The mudlib bumps a
+/// description version with description_changed() whenever an object would
+/// now describe itself differently.
+///
+/// Lines are stored for every object, so one entry serves every viewer:
+/// room_render() leaves out the viewer's own line. Thread-safe.
+/// </summary>
+public sealed class RoomRenderCache
+{
+    private sealed record Entry(
+        long DescriptionVersion,
+        int ContentsVersion,
+        string Heading,
+        MudObject[] Objects,
+        long[] ObjectVersions,
+        string[] Lines);
+
+    private readonly LruCache<MudObject, Entry> _entries;
+    private long _hits;
+    private long _misses;
+
+    public RoomRenderCache(int capacity = 1024)
+    {
+        _entries = new LruCache<MudObject, Entry>(capacity);
+    }
+
+    /// <summary>
+    /// Looks answered from the cache and looks that had to render.
+    /// </summary>
+    public long Hits => Interlocked.Read(ref _hits);
+    public long Misses => Interlocked.Read(ref _misses);
+
+    public int Count => _entries.Count;
+
+    /// <summary>
+    /// The room as viewer sees it: the heading, then each object's line
+    /// except viewer's, joined with "\n". Null if nothing is stored for the
+    /// room or anything in it has changed since.
+    /// </summary>
+    public string? Render(MudObject room, MudObject? viewer)
+    {
+        if (!_entries.TryGet(room, out var entry) || !IsCurrent(room, entry))
+        {
+            Interlocked.Increment(ref _misses);
+            return null;
+        }
+        Interlocked.Increment(ref _hits);
+
+        var text = new StringBuilder(entry.Heading);
+        for (int i = 0; i < entry.Lines.Length; i++)
+        {
+            if (entry.Objects[i] == viewer) continue;
+            text.Append('\n').Append(entry.Lines[i]);
+        }
+        return text.ToString();
+    }
+
+    /// <summary>
+    /// Keep a room's rendering: its heading and, for each object listed, the
+    /// line it shows as. Versions are taken now.
+    /// </summary>
+    public void Store(MudObject room, string heading, IReadOnlyList<MudObject> objects, IReadOnlyList<string> lines)
+    {
+        if (objects.Count != lines.Count)
+        {
+            throw new ArgumentException("Every object listed needs exactly one line");
+        }
+
+        var listed = objects.ToArray();
+        var versions = new long[listed.Length];
+        for (int i = 0; i < listed.Length; i++)
+        {
+            versions[i] = listed[i].DescriptionVersion;
+        }
+        _entries.Set(room, new Entry(room.DescriptionVersion, room.ContentsVersion, heading, listed, versions, lines.ToArray()));
+    }
+
+    public void Clear() => _entries.Clear();
+
+    private static bool IsCurrent(MudObject room, Entry entry)
+    {
+        if (room.IsDestructed || entry.DescriptionVersion != room.DescriptionVersion || entry.ContentsVersion != room.ContentsVersion)
+        {
+            return false;
+        }
+        for (int i = 0; i < entry.Objects.Length; i++)
+        {
+            if (entry.Objects[i].DescriptionVersion != entry.ObjectVersions[i]) return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,480 @@
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// Reader and writer for save_object() files.
+///
+/// The text format is one "name value" line per variable, with values in
+/// LPC literal syntax: 42, "escaped\nstring", ({ 1,2 }), ([ "k":1 ]).
+/// Object references are written as their object name and read back as
+/// strings. Both directions run in one pass over the data: the writer appends
+/// straight into a single StringBuilder, and the reader walks the text with a
+/// cursor, slicing strings that have no escapes.
+///
+/// The binary format holds the same values tagged and length-prefixed behind
+/// a magic number. It is written only when Binary is set; Read() accepts
+/// either, so a mudlib can switch formats without converting its files.
+/// </summary>
+public static class SaveFormat
+{
+    public const int FormatVersion = 1;
+
+    private const uint Magic = 0x4F53504C; // "LPSO"
+
+    private enum Tag : byte
+    {
+        Int,
+        String,
+        Array,
+        Mapping,
+        Object,
+    }
+
+    /// <summary>
+    /// Write new saves in the binary format (--binary-saves).
+    /// </summary>
+    public static bool Binary { get; set; }
+
+    // ========================================================================
+    // Writing
+    // ========================================================================
+
+    /// <summary>
+    /// Encode variables in the text or binary format.
+    /// </summary>
+    public static byte[] Encode(IEnumerable<KeyValuePair<string, object?>> variables, bool binary)
+    {
+        return binary ? ToBinary(variables) : Encoding.UTF8.GetBytes(ToText(variables));
+    }
+
+    /// <summary>
+    /// The text form of a set of variables.
+    /// </summary>
+    public static string ToText(IEnumerable<KeyValuePair<string, object?>> variables)
+    {
+        var sb = new StringBuilder();
+        foreach (var (name, value) in variables)
+        {
+            sb.Append(name);
+            sb.Append(' ');
+            WriteValue(sb, value);
+            sb.Append('\n');
+        }
+        return sb.ToString();
+    }
+
+    /// <summary>
+    /// Append one value in text form.
+    /// </summary>
+    public static void WriteValue(StringBuilder sb, object? value)
+    {
+        switch (value)
+        {
+            case null:
+                sb.Append('0');
+                break;
+            case long l:
+                sb.Append(l);
+                break;
+            case int i:
+                sb.Append(i);
+                break;
+            case string s:
+                WriteString(sb, s);
+                break;
+            case List<object> arr:
+                sb.Append("({");
+                for (int i = 0; i < arr.Count; i++)
+                {
+                    if (i > 0) sb.Append(',');
+                    WriteValue(sb, arr[i]);
+                }
+                sb.Append("})");
+                break;
+            case Dictionary<object, object> map:
+                sb.Append("([");
+                bool first = true;
+                foreach (var (key, item) in map)
+                {
+                    if (!first) sb.Append(',');
+                    first = false;
+                    WriteValue(sb, key);
+                    sb.Append(':');
+                    WriteValue(sb, item);
+                }
+                sb.Append("])");
+                break;
+            case MudObject obj:
+                sb.Append(obj.ObjectName);
+                break;
+            default:
+                sb.Append(value.ToString() ?? "0");
+                break;
+        }
+    }
+
+    private static void WriteString(StringBuilder sb, string s)
+    {
+        sb.Append('"');
+        int start = 0;
+        for (int i = 0; i < s.Length; i++)
+        {
+            char escaped = s[i] switch
+            {
+                '\\' => '\\',
+                '"' => '"',
+                '\n' => 'n',
+                '\r' => 'r',
+                '\t' => 't',
+                _ => '\0'
+            };
+            if (escaped == '\0') continue;
+
+            sb.Append(s, start, i - start);
+            sb.Append('\\');
+            sb.Append(escaped);
+            start = i + 1;
+        }
+        sb.Append(s, start, s.Length - start);
+        sb.Append('"');
+    }
+
+    /// <summary>
+    /// The binary form of a set of variables.
+    /// </summary>
+    public static byte[] ToBinary(IEnumerable<KeyValuePair<string, object?>> variables)
+    {
+        using var stream = new MemoryStream();
+        using (var writer = new BinaryWriter(stream, Encoding.UTF8, leaveOpen: true))
+        {
+            writer.Write(Magic);
+            writer.Write(FormatVersion);
+            foreach (var (name, value) in variables)
+            {
+                writer.Write(true);
+                writer.Write(name);
+                WriteBinaryValue(writer, value);
+            }
+            writer.Write(false);
+        }
+        return stream.ToArray();
+    }
+
+    /// <summary>
+    /// Append one value in binary form (also used by WorldSnapshot).
+    /// </summary>
+    internal static void WriteBinaryValue(BinaryWriter writer, object? value)
+    {
+        switch (value)
+        {
+            case null:
+                WriteInt(writer, 0);
+                break;
+            case long l:
+                WriteInt(writer, l);
+                break;
+            case int i:
+                WriteInt(writer, i);
+                break;
+            case string s:
+                writer.Write((byte)Tag.String);
+                writer.Write(s);
+                break;
+            case List<object> arr:
+                writer.Write((byte)Tag.Array);
+                writer.Write7BitEncodedInt(arr.Count);
+                foreach (var item in arr)
+                {
+                    WriteBinaryValue(writer, item);
+                }
+                break;
+            case Dictionary<object, object> map:
+                writer.Write((byte)Tag.Mapping);
+                writer.Write7BitEncodedInt(map.Count);
+                foreach (var (key, item) in map)
+                {
+                    WriteBinaryValue(writer, key);
+                    WriteBinaryValue(writer, item);
+                }
+                break;
+            case MudObject obj:
+                writer.Write((byte)Tag.Object);
+                writer.Write(obj.ObjectName);
+                break;
+            default:
+                writer.Write((byte)Tag.String);
+                writer.Write(value.ToString() ?? "0");
+                break;
+        }
+    }
+
+    private static void WriteInt(BinaryWriter writer, long value)
+    {
+        // Zigzag, so small negative numbers stay short too
+        writer.Write((byte)Tag.Int);
+        writer.Write7BitEncodedInt64((value << 1) ^ (value >> 63));
+    }
+
+    // ========================================================================
+    // Reading
+    // ========================================================================
+
+    /// <summary>
+    /// Whether data is in the binary format.
+    /// </summary>
+    public static bool IsBinary(ReadOnlySpan<byte> data)
+    {
+        return data.Length >= 4 && BitConverter.ToUInt32(data[..4]) == Magic;
+    }
+
+    /// <summary>
+    /// Decode a save file in either format.
+    /// </summary>
+    public static List<KeyValuePair<string, object>> Read(byte[] data)
+    {
+        return IsBinary(data) ? ReadBinary(data) : ReadText(Encoding.UTF8.GetString(data));
+    }
+
+    /// <summary>
+    /// Decode the text format. Blank and malformed lines are skipped, and a
+    /// value that isn't an LPC literal comes back as its raw text.
+    /// </summary>
+    public static List<KeyValuePair<string, object>> ReadText(string text)
+    {
+        var result = new List<KeyValuePair<string, object>>();
+        int pos = 0;
+        while (pos < text.Length)
+        {
+            int lineEnd = text.IndexOf('\n', pos);
+            if (lineEnd < 0) lineEnd = text.Length;
+
+            int space = text.IndexOf(' ', pos, lineEnd - pos);
+            if (space > pos)
+            {
+                var name = text[pos..space];
+                var cursor = new Cursor(text, space + 1, lineEnd);
+                result.Add(new(name, cursor.ReadValue()));
+            }
+            pos = lineEnd + 1;
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Decode one value in text form.
+    /// </summary>
+    public static object ParseValue(string text)
+    {
+        return new Cursor(text, 0, text.Length).ReadValue();
+    }
+
+    /// <summary>
+    /// A position in one line of a text save file.
+    /// </summary>
+    private ref struct Cursor
+    {
+        private readonly string _text;
+        private readonly int _end;
+        private int _pos;
+
+        public Cursor(string text, int start, int end)
+        {
+            _text = text;
+            _pos = start;
+            _end = end;
+        }
+
+        private char Peek => _pos < _end ? _text[_pos] : '\0';
+
+        private void SkipSpace()
+        {
+            while (_pos < _end && char.IsWhiteSpace(_text[_pos])) _pos++;
+        }
+
+        private bool TryTake(char first, char second)
+        {
+            if (_pos + 1 < _end && _text[_pos] == first && _text[_pos + 1] == second)
+            {
+                _pos += 2;
+                return true;
+            }
+            return false;
+        }
+
+        public object ReadValue()
+        {
+            SkipSpace();
+            if (Peek == '"') return ReadString();
+            if (TryTake('(', '{')) return ReadArray();
+            if (TryTake('(', '[')) return ReadMapping();
+            return ReadBare();
+        }
+
+        private string ReadString()
+        {
+            int start = ++_pos;
+            while (_pos < _end && _text[_pos] != '"' && _text[_pos] != '\\') _pos++;
+            if (_pos >= _end || _text[_pos] == '"')
+            {
+                // No escapes: the common case is one slice
+                var plain = _text[start.._pos];
+                if (_pos < _end) _pos++;
+                return plain;
+            }
+
+            var sb = new StringBuilder();
+            sb.Append(_text, start, _pos - start);
+            while (_pos < _end && _text[_pos] != '"')
+            {
+                char c = _text[_pos++];
+                if (c == '\\' && _pos < _end)
+                {
+                    c = _text[_pos++] switch
+                    {
+                        'n' => '\n',
+                        'r' => '\r',
+                        't' => '\t',
+                        var other => other
+                    };
+                }
+                sb.Append(c);
+            }
+            if (_pos < _end) _pos++;
+            return sb.ToString();
+        }
+
+        private List<object> ReadArray()
+        {
+            var result = new List<object>();
+            while (true)
+            {
+                SkipSpace();
+                if (TryTake('}', ')') || _pos >= _end) return result;
+
+                result.Add(ReadValue());
+                SkipSpace();
+                if (Peek != ',')
+                {
+                    TryTake('}', ')');
+                    return result;
+                }
+                _pos++;
+            }
+        }
+
+        private Dictionary<object, object> ReadMapping()
+        {
+            var result = new LpcMapping();
+            while (true)
+            {
+                SkipSpace();
+                if (TryTake(']', ')') || _pos >= _end) return result;
+
+                var key = ReadValue();
+                if (key is string name) key = StringPool.Intern(name);
+                SkipSpace();
+                object value = 0L;
+                if (Peek == ':')
+                {
+                    _pos++;
+                    value = ReadValue();
+                }
+                result[key] = value;
+                SkipSpace();
+                if (Peek != ',')
+                {
+                    TryTake(']', ')');
+                    return result;
+                }
+                _pos++;
+            }
+        }
+
+        /// <summary>
+        /// A number, or anything else up to the next delimiter (an object
+        /// name, as written for object references).
+        /// </summary>
+        private object ReadBare()
+        {
+            int start = _pos;
+            while (_pos < _end && _text[_pos] is not (',' or ':' or '}' or ']' or ')' or '\r')) _pos++;
+
+            var token = _text.AsSpan(start, _pos - start).Trim();
+            if (token.IsEmpty) return 0L;
+            return long.TryParse(token, out var number) ? number : token.ToString();
+        }
+    }
+
+    /// <summary>
+    /// Decode the binary format.
+    /// </summary>
+    public static List<KeyValuePair<string, object>> ReadBinary(byte[] data)
+    {
+        using var reader = new BinaryReader(new MemoryStream(data), Encoding.UTF8);
+        if (reader.ReadUInt32() != Magic || reader.ReadInt32() != FormatVersion)
+        {
+            throw new InvalidDataException("Not a binary save file of this version");
+        }
+
+        var result = new List<KeyValuePair<string, object>>();
+        while (reader.ReadBoolean())
+        {
+            var name = reader.ReadString();
+            result.Add(new(name, ReadBinaryValue(reader, null)));
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Read one value in binary form. Object references come back as their
+    /// names, or through resolveObject when it is given.
+    /// </summary>
+    internal static object ReadBinaryValue(BinaryReader reader, Func<string, object>? resolveObject)
+    {
+        switch ((Tag)reader.ReadByte())
+        {
+            case Tag.Int:
+                long zigzag = reader.Read7BitEncodedInt64();
+                return (long)((ulong)zigzag >> 1) ^ -(zigzag & 1);
+            case Tag.String:
+                return reader.ReadString();
+            case Tag.Object:
+                var name = reader.ReadString();
+                return resolveObject != null ? resolveObject(name) : name;
+            case Tag.Array:
+            {
+                int count = reader.Read7BitEncodedInt();
+                var arr = new List<object>(count);
+                for (int i = 0; i < count; i++)
+                {
+                    arr.Add(ReadBinaryValue(reader, resolveObject));
+                }
+                return arr;
+            }
+            case Tag.Mapping:
+            {
+                int count = reader.Read7BitEncodedInt();
+                var map = new LpcMapping(count);
+                for (int i = 0; i < count; i++)
+                {
+                    var key = ReadBinaryValue(reader, resolveObject);
+                    if (key is string keyName) key = StringPool.Intern(keyName);
+                    map[key] = ReadBinaryValue(reader, resolveObject);
+                }
+                return map;
+            }
+            case var tag:
+                throw new InvalidDataException($"Unknown save value tag {tag}");
+        }
+    }
+
+    /// <summary>
+    /// Re-encode a save file in the given format.
+    /// </summary>
+    public static byte[] Convert(byte[] data, bool binary)
+    {
+        var variables = Read(data).Select(pair => new KeyValuePair<string, object?>(pair.Key, pair.Value));
+        return Encode(variables, binary);
+    }
+}
@@ -0,0 +1,385 @@
+using System.Security.Cryptography;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// An embedded key-value store for player saves and accounts: one file in
+/// place of a file per player and per account.
+///
+/// Keys are mudlib paths ("/secure/players/bob.o", "/secure/accounts/bob.json")
+/// and values the bytes that would have gone in those files. Everything is
+/// kept in memory for reads. Put() and Delete() take effect for readers at
+/// once and join the pending batch; the game loop calls Commit() once a tick,
+/// and a background thread appends the batch to the log and fsyncs it. A batch
+/// is written as one checksummed record, so after a crash the store holds
+/// every batch that was synced and nothing of one that wasn't: opening it
+/// drops a torn or corrupt record at the end.
+///
+/// The log is rewritten (through a temp file and a rename) once it is four
+/// times the size of the live data. Keys missing from the store are looked
+/// up in the old files by callers, so a mudlib moves over as players save;
+/// --import-saves copies everything over at once.
+/// </summary>
+public sealed class SaveStore : IDisposable
+{
+    private const ulong Magic = 0x3145524F5453504C; // "LPSTORE1"
+
+    private static readonly Encoding Utf8 = new UTF8Encoding(false);
+
+    private readonly object _lock = new();
+    private readonly Dictionary<string, byte[]> _values = new(StringComparer.Ordinal);
+    private Dictionary<string, byte[]?> _pending = new(StringComparer.Ordinal);
+    private readonly Queue<Dictionary<string, byte[]?>> _batches = new();
+    private bool _writing;
+    private bool _disposed;
+
+    // Owned by the writer thread once open: what the log on disk holds
+    private readonly Dictionary<string, byte[]> _durable = new(StringComparer.Ordinal);
+    private FileStream _log;
+    private long _liveBytes;
+    private Thread? _thread;
+
+    private long _commits;
+    private long _compactions;
+
+    /// <summary>
+    /// The store's file.
+    /// </summary>
+    public string Path { get; }
+
+    /// <summary>
+    /// Keys stored.
+    /// </summary>
+    public int Count
+    {
+        get
+        {
+            lock (_lock)
+            {
+                return _values.Count;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Batches written since the store was opened, and log rewrites.
+    /// </summary>
+    public long Commits => Interlocked.Read(ref _commits);
+    public long Compactions => Interlocked.Read(ref _compactions);
+
+    /// <summary>
+    /// The log isn't rewritten while it is smaller than this.
+    /// </summary>
+    public long CompactMinBytes { get; set; } = 1 << 20;
+
+    /// <summary>
+    /// Size of the log on disk.
+    /// </summary>
+    public long LogBytes
+    {
+        get
+        {
+            lock (_lock)
+            {
+                return _log.Length;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Open the store at path, creating it if there is none.
+    /// </summary>
+    public SaveStore(string path)
+    {
+        Path = System.IO.Path.GetFullPath(path);
+        var dir = System.IO.Path.GetDirectoryName(Path);
+        if (!string.IsNullOrEmpty(dir))
+        {
+            Directory.CreateDirectory(dir);
+        }
+
+        _log = new FileStream(Path, FileMode.OpenOrCreate, FileAccess.ReadWrite, FileShare.Read);
+        Replay();
+        foreach (var (key, value) in _durable)
+        {
+            _values[key] = value;
+        }
+    }
+
+    /// <summary>
+    /// The value stored for key, or null.
+    /// </summary>
+    public byte[]? Get(string key)
+    {
+        lock (_lock)
+        {
+            return _values.GetValueOrDefault(key);
+        }
+    }
+
+    /// <summary>
+    /// Whether any key starts with prefix.
+    /// </summary>
+    public bool Any(string prefix)
+    {
+        lock (_lock)
+        {
+            return _values.Keys.Any(key => key.StartsWith(prefix, StringComparison.Ordinal));
+        }
+    }
+
+    /// <summary>
+    /// Store value under key, in the next batch.
+    /// </summary>
+    public void Put(string key, byte[] value)
+    {
+        lock (_lock)
+        {
+            _values[key] = value;
+            _pending[key] = value;
+        }
+    }
+
+    /// <summary>
+    /// Remove key, in the next batch.
+    /// </summary>
+    public void Delete(string key)
+    {
+        lock (_lock)
+        {
+            if (_values.Remove(key))
+            {
+                _pending[key] = null;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Hand the changes made since the last call to the writer as one batch.
+    /// Called once a tick.
+    /// </summary>
+    public void Commit()
+    {
+        lock (_lock)
+        {
+            if (_pending.Count == 0 || _disposed) return;
+
+            _batches.Enqueue(_pending);
+            _pending = new Dictionary<string, byte[]?>(StringComparer.Ordinal);
+            if (_thread == null)
+            {
+                _thread = new Thread(WriterLoop) { Name = "SaveStore", IsBackground = true };
+                _thread.Start();
+            }
+            Monitor.PulseAll(_lock);
+        }
+    }
+
+    /// <summary>
+    /// Commit, and block until everything committed is on disk.
+    /// </summary>
+    public void Flush()
+    {
+        Commit();
+        lock (_lock)
+        {
+            while (_batches.Count > 0 || _writing)
+            {
+                Monitor.Wait(_lock);
+            }
+        }
+    }
+
+    public void Dispose()
+    {
+        Flush();
+        lock (_lock)
+        {
+            _disposed = true;
+            _log.Dispose();
+            Monitor.PulseAll(_lock);
+        }
+    }
+
+    /// <summary>
+    /// The mudlib path a save file is kept under: fullPath relative to mudlibPath.
+    /// </summary>
+    public static string KeyFor(string mudlibPath, string fullPath)
+    {
+        var relative = System.IO.Path.GetRelativePath(mudlibPath, fullPath).Replace(System.IO.Path.DirectorySeparatorChar, '/');
+        return "/" + relative;
+    }
+
+    private void WriterLoop()
+    {
+        while (true)
+        {
+            var batch = new Dictionary<string, byte[]?>(StringComparer.Ordinal);
+            lock (_lock)
+            {
+                while (_batches.Count == 0 && !_disposed)
+                {
+                    Monitor.Wait(_lock);
+                }
+                if (_disposed) return;
+
+                // Batches that queued up while the last write ran go out as one
+                while (_batches.Count > 0)
+                {
+                    foreach (var (key, value) in _batches.Dequeue())
+                    {
+                        batch[key] = value;
+                    }
+                }
+                _writing = true;
+            }
+
+            try
+            {
+                Append(batch);
+                if (_log.Length > CompactMinBytes && _log.Length > 4 * _liveBytes)
+                {
+                    Compact();
+                }
+            }
+            catch (IOException ex)
+            {
+                Logger.Error($"Save store write to {Path} failed: {ex.Message}", LogCategory.System);
+            }
+            finally
+            {
+                lock (_lock)
+                {
+                    _writing = false;
+                    Monitor.PulseAll(_lock);
+                }
+            }
+        }
+    }
+
+    private void Append(Dictionary<string, byte[]?> batch)
+    {
+        var record = EncodeRecord(batch);
+        _log.Seek(0, SeekOrigin.End);
+        _log.Write(record);
+        _log.Flush(flushToDisk: true);
+
+        foreach (var (key, value) in batch)
+        {
+            Apply(key, value);
+        }
+        Interlocked.Increment(ref _commits);
+    }
+
+    /// <summary>
+    /// Rewrite the log as one record holding what is live.
+    /// </summary>
+    private void Compact()
+    {
+        var temp = Path + ".tmp";
+        using (var output = new FileStream(temp, FileMode.Create, FileAccess.Write))
+        {
+            output.Write(BitConverter.GetBytes(Magic));
+            output.Write(EncodeRecord(_durable.ToDictionary(entry => entry.Key, entry => (byte[]?)entry.Value)));
+            output.Flush(flushToDisk: true);
+        }
+
+        lock (_lock)
+        {
+            _log.Dispose();
+            File.Move(temp, Path, overwrite: true);
+            _log = new FileStream(Path, FileMode.Open, FileAccess.ReadWrite, FileShare.Read);
+        }
+        Interlocked.Increment(ref _compactions);
+    }
+
+    private void Apply(string key, byte[]? value)
+    {
+        if (_durable.Remove(key, out var old))
+        {
+            _liveBytes -= key.Length + old.Length;
+        }
+        if (value != null)
+        {
+            _durable[key] = value;
+            _liveBytes += key.Length + value.Length;
+        }
+    }
+
+    /// <summary>
+    /// A record: payload length, the first 8 bytes of its SHA-256, then the
+    /// payload (entry count, then key and value length and bytes for each;
+    /// length -1 is a delete).
+    /// </summary>
+    private static byte[] EncodeRecord(IReadOnlyDictionary<string, byte[]?> entries)
+    {
+        using var payload = new MemoryStream();
+        using (var writer = new BinaryWriter(payload, Utf8, leaveOpen: true))
+        {
+            writer.Write(entries.Count);
+            foreach (var (key, value) in entries)
+            {
+                writer.Write(key);
+                writer.Write(value?.Length ?? -1);
+                if (value != null) writer.Write(value);
+            }
+        }
+
+        var body = payload.GetBuffer().AsSpan(0, (int)payload.Length);
+        var record = new byte[12 + body.Length];
+        BitConverter.TryWriteBytes(record.AsSpan(0, 4), body.Length);
+        SHA256.HashData(body)[..8].CopyTo(record, 4);
+        body.CopyTo(record.AsSpan(12));
+        return record;
+    }
+
+    /// <summary>
+    /// Load the log into _durable, cutting it at the first record that is
+    /// torn or doesn't match its checksum.
+    /// </summary>
+    private void Replay()
+    {
+        if (_log.Length == 0)
+        {
+            _log.Write(BitConverter.GetBytes(Magic));
+            _log.Flush(flushToDisk: true);
+            return;
+        }
+
+        var data = new byte[_log.Length];
+        _log.ReadExactly(data);
+        if (data.Length < 8 || BitConverter.ToUInt64(data, 0) != Magic)
+        {
+            throw new InvalidDataException($"{Path} is not a save store");
+        }
+
+        int offset = 8;
+        while (offset < data.Length)
+        {
+            if (data.Length - offset < 12) break;
+            int length = BitConverter.ToInt32(data, offset);
+            if (length < 0 || length > data.Length - offset - 12) break;
+
+            var body = data.AsSpan(offset + 12, length);
+            if (!SHA256.HashData(body)[..8].AsSpan().SequenceEqual(data.AsSpan(offset + 4, 8))) break;
+
+            using var reader = new BinaryReader(new MemoryStream(data, offset + 12, length), Utf8);
+            int count = reader.ReadInt32();
+            for (int i = 0; i < count; i++)
+            {
+                var key = reader.ReadString();
+                int size = reader.ReadInt32();
+                Apply(key, size < 0 ? null : reader.ReadBytes(size));
+            }
+            offset += 12 + length;
+        }
+
+        if (offset < data.Length)
+        {
+            Logger.Warning($"Save store {Path}: dropped {data.Length - offset} bytes of an unfinished write", LogCategory.System);
+            _log.SetLength(offset);
+            _log.Flush(flushToDisk: true);
+        }
+    }
+}
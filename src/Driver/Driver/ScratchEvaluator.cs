@@ -0,0 +1,192 @@
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// Runs --eval and --repl input on the server's own engine (ObjectInterpreter,
+/// with its bytecode VM and JIT) in a scratch object, so what the REPL times
+/// and shows is what the server does.
+///
+/// Each input becomes the body of a function in the scratch object's
+/// program, which is recompiled and swapped in (as update does) before the
+/// function is called:
+///   - an expression is returned, and its value shown;
+///   - a statement runs, and shows a value only if it returns a non-zero one;
+///   - a declaration (a function, "int x = 5;", an inherit) is added to the
+///     program; a later one of the same name replaces it;
+///   - assigning to a name nobody declared declares it as a mixed global,
+///     so "x = 5" then "x + 1" works.
+/// Globals are the scratch object's variables, so they keep their values
+/// from one input to the next. Input that doesn't compile leaves the
+/// program as it was.
+/// </summary>
+public sealed class ScratchEvaluator
+{
+    public const string ScratchPath = "/__scratch";
+    private const string EvalFunction = "__eval";
+
+    private static readonly HashSet<TokenType> DeclarationStarts = new()
+    {
+        TokenType.Int, TokenType.StringType, TokenType.Object, TokenType.Mapping, TokenType.Mixed, TokenType.Void,
+        TokenType.Public, TokenType.Private, TokenType.Protected, TokenType.Static, TokenType.Nomask,
+        TokenType.Varargs, TokenType.Inherit
+    };
+
+    private static readonly HashSet<TokenType> Assignments = new()
+    {
+        TokenType.Equal, TokenType.PlusEqual, TokenType.MinusEqual, TokenType.StarEqual, TokenType.SlashEqual,
+        TokenType.PercentEqual, TokenType.AmpEqual, TokenType.PipeEqual, TokenType.CaretEqual,
+        TokenType.LessLessEqual, TokenType.GreaterGreaterEqual
+    };
+
+    private readonly ObjectManager _objectManager;
+
+    // Declarations by name, in the order first given: inherits, then globals, then functions
+    private readonly Dictionary<string, string> _inherits = new();
+    private readonly Dictionary<string, string> _globals = new();
+    private readonly Dictionary<string, string> _functions = new();
+
+    /// <param name="objectManager">Its interpreter runs the input; load_object() and the like resolve against its mudlib.</param>
+    public ScratchEvaluator(ObjectManager objectManager)
+    {
+        _objectManager = objectManager;
+    }
+
+    /// <summary>
+    /// The scratch object, once something has been evaluated.
+    /// </summary>
+    public MudObject? Scratch => _objectManager.FindObject(ScratchPath);
+
+    /// <summary>
+    /// Run one line of input and return the value to show, or null for none.
+    /// Throws LexerException or ParserException for bad input,
+    /// ObjectManagerException if the program doesn't compile, and whatever
+    /// the interpreter throws for a runtime error.
+    /// </summary>
+    public object? Evaluate(string input)
+    {
+        input = input.Trim();
+        var tokens = new Lexer(input).Tokenize();
+        if (tokens.Count == 0 || tokens[0].Type == TokenType.Eof) return null;
+
+        var inherits = new Dictionary<string, string>(_inherits);
+        var globals = new Dictionary<string, string>(_globals);
+        var functions = new Dictionary<string, string>(_functions);
+        string body;
+        bool expression = false;
+
+        if (DeclarationStarts.Contains(tokens[0].Type))
+        {
+            var declarations = new Parser(tokens).ParseProgram();
+            if (declarations.Count != 1)
+            {
+                throw new ParserException("Give one declaration at a time", tokens[0]);
+            }
+
+            switch (declarations[0])
+            {
+                case InheritStatement inherit:
+                    inherits[inherit.Path] = input;
+                    body = "return 0;";
+                    break;
+                case FunctionDefinition function:
+                    functions[function.Name] = input;
+                    body = "return 0;";
+                    break;
+                case VariableDeclaration variable:
+                    globals[variable.Name] = $"{variable.Type} {variable.Name};";
+                    body = variable.Initializer == null
+                        ? "return 0;"
+                        : $"return {variable.Name} = {Initializer(input)};";
+                    expression = variable.Initializer != null;
+                    break;
+                default:
+                    throw new ParserException("Expected a declaration", tokens[0]);
+            }
+        }
+        else
+        {
+            var parsed = new Parser(tokens).ParseStatementOrExpression();
+            expression = parsed is Expression or ExpressionStatement;
+            body = expression ? $"return ({input.TrimEnd(';')});" : input;
+            DeclareAssigned(tokens, globals, functions);
+        }
+
+        var scratch = _objectManager.LoadSource(ScratchPath, Source(inherits, globals, functions, body));
+        Replace(_inherits, inherits);
+        Replace(_globals, globals);
+        Replace(_functions, functions);
+
+        var interpreter = _objectManager.Interpreter!;
+        interpreter.ResetInstructionCount();
+        var result = interpreter.CallFunctionOnObject(scratch, EvalFunction, new List<object>());
+        if (expression) return result ?? 0L;
+        return result is null or 0L ? null : result;
+    }
+
+    /// <summary>
+    /// How the REPL prints a value: strings as they are, anything else as sprintf's %O would.
+    /// </summary>
+    public static string Format(object value)
+    {
+        return value is string text ? text : SprintfFormat.FormatValue(value);
+    }
+
+    /// <summary>
+    /// The text after the '=' of a declaration, without its semicolon.
+    /// </summary>
+    private static string Initializer(string declaration)
+    {
+        var initializer = declaration[(declaration.IndexOf('=') + 1)..].Trim();
+        return initializer.TrimEnd(';').TrimEnd();
+    }
+
+    /// <summary>
+    /// Declare as mixed any name the input assigns to, or loops over with
+    /// foreach, that isn't declared yet. A name just after a type is a local
+    /// declaration and is left alone, as is a member after ->.
+    /// </summary>
+    private static void DeclareAssigned(List<Token> tokens, Dictionary<string, string> globals,
+        Dictionary<string, string> functions)
+    {
+        for (int i = 0; i + 1 < tokens.Count; i++)
+        {
+            if (tokens[i].Type != TokenType.Identifier) continue;
+
+            bool assigned = Assignments.Contains(tokens[i + 1].Type) &&
+                            (i == 0 || (tokens[i - 1].Type != TokenType.Arrow &&
+                                        !DeclarationStarts.Contains(tokens[i - 1].Type) &&
+                                        tokens[i - 1].Type != TokenType.Star));
+            bool looped = i >= 2 && tokens[i - 1].Type is TokenType.LeftParen or TokenType.Comma &&
+                          (tokens[i - 2].Type == TokenType.Foreach ||
+                           (i >= 4 && tokens[i - 4].Type == TokenType.Foreach)) &&
+                          tokens[i + 1].Type is TokenType.In or TokenType.Comma;
+            if (!assigned && !looped) continue;
+
+            var name = tokens[i].Lexeme;
+            if (!globals.ContainsKey(name) && !functions.ContainsKey(name))
+            {
+                globals[name] = $"mixed {name};";
+            }
+        }
+    }
+
+    private static string Source(Dictionary<string, string> inherits, Dictionary<string, string> globals,
+        Dictionary<string, string> functions, string body)
+    {
+        var source = new StringBuilder();
+        foreach (var declaration in inherits.Values) source.AppendLine(declaration);
+        foreach (var declaration in globals.Values) source.AppendLine(declaration);
+        foreach (var declaration in functions.Values) source.AppendLine(declaration);
+        source.Append("mixed ").Append(EvalFunction).AppendLine("() {");
+        source.AppendLine(body);
+        source.AppendLine("}");
+        return source.ToString();
+    }
+
+    private static void Replace(Dictionary<string, string> target, Dictionary<string, string> source)
+    {
+        target.Clear();
+        foreach (var (name, declaration) in source) target[name] = declaration;
+    }
+}
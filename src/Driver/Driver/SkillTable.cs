@@ -0,0 +1,228 @@
+using System.Collections.Concurrent;
+
+namespace Driver;
+
+/// <summary>
+/// A living's skills: the level of each one it has learned, and the ones it
+/// may advance (granted by its guilds).
+///
+/// These used to be a mapping and an array in /std/living.c. Checking a
+/// skill was allowed scanned the array, granting or revoking one rebuilt it,
+/// and every attack asked the defender for its dodge through call_other().
+/// Skill names are interned here to small ids shared by every table, so a
+/// table is an array of levels and a bit set, both indexed by id: a lookup,
+/// a change and an allowed check are each an index, and another object's
+/// skill is read without calling into it.
+///
+/// save_object() and world snapshots store a table as two entries beside
+/// the variables (LevelsKey and AllowedKey), with only learned skills in
+/// the levels.
+///
+/// A table belongs to one object and is used by whichever thread runs it.
+/// </summary>
+public sealed class SkillTable
+{
+    /// <summary>
+    /// Save entry holding the learned skills, as a mapping of name to level.
+    /// </summary>
+    public const string LevelsKey = "#skills";
+
+    /// <summary>
+    /// Save entry holding the allowed skills, as an array of names.
+    /// </summary>
+    public const string AllowedKey = "#skills_allowed";
+
+    private static readonly ConcurrentDictionary<string, int> Ids = new(StringComparer.Ordinal);
+    private static readonly object InternLock = new();
+    private static volatile string[] _names = Array.Empty<string>();
+
+    private int[] _levels = Array.Empty<int>();
+    private ulong[] _allowed = Array.Empty<ulong>();
+
+    /// <summary>
+    /// Skills with a level above 0.
+    /// </summary>
+    public int LearnedCount { get; private set; }
+
+    /// <summary>
+    /// Skills allowed.
+    /// </summary>
+    public int AllowedCount { get; private set; }
+
+    /// <summary>
+    /// Level of skill, 0 if not learned.
+    /// </summary>
+    public int Get(string skill)
+    {
+        return Ids.TryGetValue(skill, out int id) && id < _levels.Length ? _levels[id] : 0;
+    }
+
+    /// <summary>
+    /// Set the level of skill; 0 or less forgets it.
+    /// </summary>
+    public void Set(string skill, int level)
+    {
+        level = Math.Max(level, 0);
+        if (level == 0 && !Ids.ContainsKey(skill)) return;
+
+        int id = Intern(skill);
+        if (id >= _levels.Length)
+        {
+            if (level == 0) return;
+            Array.Resize(ref _levels, Math.Max(id + 1, _levels.Length * 2));
+        }
+
+        LearnedCount += (level > 0 ? 1 : 0) - (_levels[id] > 0 ? 1 : 0);
+        _levels[id] = level;
+    }
+
+    /// <summary>
+    /// Whether skill is allowed.
+    /// </summary>
+    public bool IsAllowed(string skill)
+    {
+        return Ids.TryGetValue(skill, out int id) && id / 64 < _allowed.Length && (_allowed[id / 64] & (1UL << id)) != 0;
+    }
+
+    /// <summary>
+    /// Allow skill, or stop allowing it.
+    /// </summary>
+    public void SetAllowed(string skill, bool allowed)
+    {
+        if (IsAllowed(skill) == allowed) return;
+
+        int id = Intern(skill);
+        if (id / 64 >= _allowed.Length)
+        {
+            Array.Resize(ref _allowed, id / 64 + 1);
+        }
+
+        _allowed[id / 64] ^= 1UL << id;
+        AllowedCount += allowed ? 1 : -1;
+    }
+
+    /// <summary>
+    /// Stop allowing every skill.
+    /// </summary>
+    public void ClearAllowed()
+    {
+        Array.Clear(_allowed);
+        AllowedCount = 0;
+    }
+
+    /// <summary>
+    /// A copy of this table.
+    /// </summary>
+    public SkillTable Copy()
+    {
+        var copy = new SkillTable();
+        copy.CopyFrom(this);
+        return copy;
+    }
+
+    /// <summary>
+    /// Make this table the same as other.
+    /// </summary>
+    public void CopyFrom(SkillTable other)
+    {
+        _levels = (int[])other._levels.Clone();
+        _allowed = (ulong[])other._allowed.Clone();
+        LearnedCount = other.LearnedCount;
+        AllowedCount = other.AllowedCount;
+    }
+
+    /// <summary>
+    /// The learned skills and their levels, in the order skills were first seen.
+    /// </summary>
+    public LpcMapping Levels()
+    {
+        var names = _names;
+        var levels = new LpcMapping();
+        for (int id = 0; id < _levels.Length; id++)
+        {
+            if (_levels[id] > 0) levels[names[id]] = (long)_levels[id];
+        }
+        return levels;
+    }
+
+    /// <summary>
+    /// The allowed skills, in the order skills were first seen.
+    /// </summary>
+    public List<object> Allowed()
+    {
+        var names = _names;
+        var allowed = new List<object>(AllowedCount);
+        for (int word = 0; word < _allowed.Length; word++)
+        {
+            for (ulong bits = _allowed[word]; bits != 0; bits &= bits - 1)
+            {
+                allowed.Add(names[word * 64 + System.Numerics.BitOperations.TrailingZeroCount(bits)]);
+            }
+        }
+        return allowed;
+    }
+
+    /// <summary>
+    /// The save entries for this table; none for an empty one.
+    /// </summary>
+    public IEnumerable<KeyValuePair<string, object?>> SaveEntries()
+    {
+        if (LearnedCount > 0) yield return new(LevelsKey, Levels());
+        if (AllowedCount > 0) yield return new(AllowedKey, Allowed());
+    }
+
+    /// <summary>
+    /// Load a save entry written by SaveEntries(). Returns false if name
+    /// isn't one of its keys.
+    /// </summary>
+    public bool Restore(string name, object? value)
+    {
+        switch (name)
+        {
+            case LevelsKey:
+                Array.Clear(_levels);
+                LearnedCount = 0;
+                if (value is Dictionary<object, object> levels)
+                {
+                    foreach (var (skill, level) in levels)
+                    {
+                        if (skill is string s && level is long or int) Set(s, (int)Convert.ToInt64(level));
+                    }
+                }
+                return true;
+            case AllowedKey:
+                ClearAllowed();
+                if (value is List<object> allowed)
+                {
+                    foreach (var skill in allowed)
+                    {
+                        if (skill is string s) SetAllowed(s, true);
+                    }
+                }
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    private static int Intern(string skill)
+    {
+        if (Ids.TryGetValue(skill, out int id)) return id;
+
+        lock (InternLock)
+        {
+            if (Ids.TryGetValue(skill, out id)) return id;
+
+            var names = _names;
+            id = names.Length;
+            var grown = new string[id + 1];
+            names.CopyTo(grown, 0);
+            grown[id] = skill;
+
+            // Publish the name before the id, so a reader with the id finds it
+            _names = grown;
+            Ids[skill] = id;
+            return id;
+        }
+    }
+}
@@ -0,0 +1,117 @@
+namespace Driver;
+
+/// <summary>
+/// Maps lines of a program's preprocessed source back to the files and lines
+/// they came from.
+///
+/// The preprocessor keeps one output line per source line, but #include
+/// splices a header's lines in, so after the first include the line numbers
+/// the parser records no longer match the file's. Runtime errors and stack
+/// traces go through this to name the real file and line, which is all that
+/// is kept of the source once a program is compiled.
+///
+/// Stored as runs: run i starts at preprocessed line Starts[i] and continues
+/// Files[i] from FileLines[i]. A file without includes is a single run.
+/// </summary>
+public sealed class SourceMap
+{
+    private readonly int[] _starts;
+    private readonly string[] _files;
+    private readonly int[] _fileLines;
+
+    private SourceMap(int[] starts, string[] files, int[] fileLines)
+    {
+        _starts = starts;
+        _files = files;
+        _fileLines = fileLines;
+    }
+
+    /// <summary>
+    /// Number of runs.
+    /// </summary>
+    public int RunCount => _starts.Length;
+
+    /// <summary>
+    /// The file and line a preprocessed line came from. Lines before the
+    /// first run (or 0, for nodes without a line) are returned unchanged
+    /// against the first run's file.
+    /// </summary>
+    public (string File, int Line) Resolve(int line)
+    {
+        int run = Array.BinarySearch(_starts, line);
+        if (run < 0) run = ~run - 1;
+        if (run < 0) return (_files[0], line);
+        return (_files[run], _fileLines[run] + (line - _starts[run]));
+    }
+
+    public void Write(BinaryWriter writer)
+    {
+        writer.Write(_starts.Length);
+        for (int i = 0; i < _starts.Length; i++)
+        {
+            writer.Write(_starts[i]);
+            writer.Write(_files[i]);
+            writer.Write(_fileLines[i]);
+        }
+    }
+
+    public static SourceMap Read(BinaryReader reader)
+    {
+        int count = reader.ReadInt32();
+        if (count < 1 || count > 1_000_000)
+        {
+            throw new InvalidDataException($"Bad source map run count {count}");
+        }
+
+        var builder = new Builder();
+        for (int i = 0; i < count; i++)
+        {
+            int start = reader.ReadInt32();
+            var file = reader.ReadString();
+            builder.Add(start, file, reader.ReadInt32());
+        }
+        return builder.Build();
+    }
+
+    /// <summary>
+    /// Collects runs in preprocessed-line order.
+    /// </summary>
+    public sealed class Builder
+    {
+        private readonly List<int> _starts = new();
+        private readonly List<string> _files = new();
+        private readonly List<int> _fileLines = new();
+
+        /// <summary>
+        /// From preprocessed line start on, lines come from file starting at
+        /// fileLine. A run starting where the previous one does replaces it
+        /// (an include that produced no lines).
+        /// </summary>
+        public void Add(int start, string file, int fileLine)
+        {
+            int last = _starts.Count - 1;
+            if (last >= 0 && _starts[last] == start)
+            {
+                _starts.RemoveAt(last);
+                _files.RemoveAt(last);
+                _fileLines.RemoveAt(last);
+                last--;
+            }
+
+            // Lines carrying on where the last run would have got to anyway
+            if (last >= 0 && _files[last] == file && _fileLines[last] + (start - _starts[last]) == fileLine)
+            {
+                return;
+            }
+
+            _starts.Add(start);
+            _files.Add(file);
+            _fileLines.Add(fileLine);
+        }
+
+        public SourceMap Build()
+        {
+            return new SourceMap(_starts.ToArray(), _files.ToArray(), _fileLines.ToArray());
+        }
+    }
+}
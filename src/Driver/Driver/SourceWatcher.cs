@@ -0,0 +1,87 @@
+using System.Collections.Concurrent;
+
+namespace Driver;
+
+/// <summary>
+/// Recompiles edited mudlib files in the background.
+///
+/// A FileSystemWatcher reports writes to .c files. Once a file has been
+/// quiet for QuietPeriod (editors often write in several steps), its new
+/// program is built on a worker thread by ObjectManager.StageReload, and the
+/// game loop swaps it in between ticks with ApplyStagedReloads. The only work
+/// left on the game thread is confirming the staged program is still current,
+/// rebuilding descendants onto it and migrating variables. An edited file
+/// that isn't loaded itself recompiles the loaded programs that #include it
+/// (see LpcProgram.IncludedFiles); others are ignored and compile normally
+/// when first used.
+/// </summary>
+public sealed class SourceWatcher : IDisposable
+{
+    private readonly ObjectManager _objectManager;
+    private readonly FileSystemWatcher _watcher;
+    private readonly Timer _timer;
+    private readonly ConcurrentDictionary<string, DateTime> _pending = new();
+    private int _staging;
+
+    /// <summary>
+    /// How long a file must go without changes before it is compiled.
+    /// </summary>
+    public TimeSpan QuietPeriod { get; }
+
+    public SourceWatcher(ObjectManager objectManager, TimeSpan? quietPeriod = null)
+    {
+        _objectManager = objectManager;
+        QuietPeriod = quietPeriod ?? TimeSpan.FromMilliseconds(250);
+
+        _watcher = new FileSystemWatcher(objectManager.MudlibPath, "*.c")
+        {
+            IncludeSubdirectories = true,
+            NotifyFilter = NotifyFilters.LastWrite | NotifyFilters.FileName | NotifyFilters.Size
+        };
+        _watcher.Changed += (_, e) => Touch(e.FullPath);
+        _watcher.Created += (_, e) => Touch(e.FullPath);
+        _watcher.Renamed += (_, e) => Touch(e.FullPath);
+
+        var interval = QuietPeriod / 2;
+        _timer = new Timer(_ => StageQuietFiles(), null, interval, interval);
+        _watcher.EnableRaisingEvents = true;
+    }
+
+    /// <summary>
+    /// Files changed but not yet compiled.
+    /// </summary>
+    public int PendingCount => _pending.Count;
+
+    private void Touch(string fullPath)
+    {
+        if (!fullPath.EndsWith(".c", StringComparison.Ordinal)) return;
+        _pending[fullPath] = DateTime.UtcNow;
+    }
+
+    private void StageQuietFiles()
+    {
+        // Timer callbacks can overlap if a compile runs long; one at a time
+        if (Interlocked.Exchange(ref _staging, 1) == 1) return;
+        try
+        {
+            var cutoff = DateTime.UtcNow - QuietPeriod;
+            foreach (var (fullPath, changed) in _pending)
+            {
+                if (changed > cutoff || !_pending.TryRemove(KeyValuePair.Create(fullPath, changed))) continue;
+
+                var relative = Path.GetRelativePath(_objectManager.MudlibPath, fullPath);
+                _objectManager.StageReload("/" + relative.Replace(Path.DirectorySeparatorChar, '/'));
+            }
+        }
+        finally
+        {
+            Volatile.Write(ref _staging, 0);
+        }
+    }
+
+    public void Dispose()
+    {
+        _watcher.Dispose();
+        _timer.Dispose();
+    }
+}
@@ -0,0 +1,256 @@
+namespace Driver;
+
+/// <summary>
+/// The monsters each room keeps stocked: for every room, which blueprints
+/// it spawns, how many of each, and the clones it spawned that are still
+/// alive.
+///
+/// A room's reset() used to look through its contents for each spawn to
+/// decide what was missing, which is interpreted work for every spawn times
+/// every object in the room on every reset. Here the driver keeps the live
+/// clones per spawn, dropping each as it is destructed (Forget), so what is
+/// missing is a count. A spawned monster that wanders off still counts until
+/// it dies.
+///
+/// Refills are queued by Request() and carried out by the game loop a batch
+/// of clones at a time, so a wave of resets is spread across ticks; Refill()
+/// stocks a room at once, for a room being loaded.
+///
+/// Thread-safe.
+/// </summary>
+public sealed class SpawnRegistry
+{
+    private sealed class Spawn
+    {
+        public Spawn(MudObject room, string path, int count)
+        {
+            Room = room;
+            Path = path;
+            Count = count;
+        }
+
+        public MudObject Room { get; }
+        public string Path { get; }
+        public int Count { get; set; }
+        public List<MudObject> Live { get; } = new();
+    }
+
+    private readonly object _lock = new();
+    private readonly Dictionary<MudObject, List<Spawn>> _rooms = new();
+    private readonly Dictionary<MudObject, Spawn> _spawnedBy = new();
+    private readonly Queue<MudObject> _pending = new();
+    private readonly HashSet<MudObject> _queued = new();
+
+    /// <summary>
+    /// Rooms waiting for a refill.
+    /// </summary>
+    public int PendingRooms
+    {
+        get { lock (_lock) return _pending.Count; }
+    }
+
+    /// <summary>
+    /// Rooms with spawns.
+    /// </summary>
+    public int RoomCount
+    {
+        get { lock (_lock) return _rooms.Count; }
+    }
+
+    /// <summary>
+    /// Keep count clones of path in room; 0 stops spawning it. Clones already
+    /// spawned stay either way.
+    /// </summary>
+    public void Set(MudObject room, string path, int count)
+    {
+        path = Normalize(path);
+        lock (_lock)
+        {
+            if (!_rooms.TryGetValue(room, out var spawns))
+            {
+                if (count <= 0) return;
+                _rooms[room] = spawns = new List<Spawn>();
+            }
+
+            var spawn = spawns.Find(s => s.Path == path);
+            if (spawn == null)
+            {
+                if (count > 0) spawns.Add(new Spawn(room, path, count));
+                return;
+            }
+
+            spawn.Count = Math.Max(count, 0);
+            if (count > 0) return;
+
+            foreach (var clone in spawn.Live) _spawnedBy.Remove(clone);
+            spawns.Remove(spawn);
+            if (spawns.Count == 0) _rooms.Remove(room);
+        }
+    }
+
+    /// <summary>
+    /// Live clones room spawned, of path or of every spawn.
+    /// </summary>
+    public List<MudObject> Live(MudObject room, string? path = null)
+    {
+        if (path != null) path = Normalize(path);
+        lock (_lock)
+        {
+            var live = new List<MudObject>();
+            if (!_rooms.TryGetValue(room, out var spawns)) return live;
+
+            foreach (var spawn in spawns)
+            {
+                if (path != null && spawn.Path != path) continue;
+                Prune(spawn);
+                live.AddRange(spawn.Live);
+            }
+            return live;
+        }
+    }
+
+    /// <summary>
+    /// Clones room is short of.
+    /// </summary>
+    public int Missing(MudObject room)
+    {
+        lock (_lock)
+        {
+            if (!_rooms.TryGetValue(room, out var spawns)) return 0;
+
+            int missing = 0;
+            foreach (var spawn in spawns)
+            {
+                Prune(spawn);
+                missing += Math.Max(0, spawn.Count - spawn.Live.Count);
+            }
+            return missing;
+        }
+    }
+
+    /// <summary>
+    /// Queue room for a refill if it is short of anything. Returns how many
+    /// clones it is short of.
+    /// </summary>
+    public int Request(MudObject room)
+    {
+        int missing = Missing(room);
+        if (missing == 0) return 0;
+
+        lock (_lock)
+        {
+            if (_queued.Add(room)) _pending.Enqueue(room);
+        }
+        return missing;
+    }
+
+    /// <summary>
+    /// Clone what room is missing, up to limit clones, with spawn (which
+    /// clones a path into the room). Returns how many were made; a spawn
+    /// whose clone fails is skipped until the next refill.
+    /// </summary>
+    public int Refill(MudObject room, int limit, Func<string, MudObject, MudObject> spawn)
+    {
+        Spawn[] spawns;
+        lock (_lock)
+        {
+            if (!_rooms.TryGetValue(room, out var list)) return 0;
+            spawns = list.ToArray();
+        }
+
+        // Cloning runs create(), which may come back here, so no lock is held
+        int made = 0;
+        foreach (var entry in spawns)
+        {
+            while (made < limit && !room.IsDestructed)
+            {
+                lock (_lock)
+                {
+                    Prune(entry);
+                    if (entry.Live.Count >= entry.Count) break;
+                }
+
+                MudObject clone;
+                try
+                {
+                    clone = spawn(entry.Path, room);
+                }
+                catch (Exception ex)
+                {
+                    Logger.Warning($"Spawn of {entry.Path} in {room.ObjectName} failed: {ex.Message}", LogCategory.LPC);
+                    break;
+                }
+
+                made++;
+                lock (_lock)
+                {
+                    entry.Live.Add(clone);
+                    _spawnedBy[clone] = entry;
+                }
+            }
+        }
+        return made;
+    }
+
+    /// <summary>
+    /// Refill queued rooms, oldest first, making at most limit clones. A room
+    /// the limit cuts short stays first in line.
+    /// </summary>
+    public int RunQueued(int limit, Func<string, MudObject, MudObject> spawn)
+    {
+        int made = 0;
+        while (made < limit)
+        {
+            MudObject room;
+            lock (_lock)
+            {
+                if (!_pending.TryPeek(out room!)) break;
+            }
+
+            made += Refill(room, limit - made, spawn);
+            if (made >= limit && Missing(room) > 0) break;
+
+            lock (_lock)
+            {
+                _pending.Dequeue();
+                _queued.Remove(room);
+            }
+        }
+        return made;
+    }
+
+    /// <summary>
+    /// A destructed object leaves its spawn, and a destructed room's spawns
+    /// are dropped (its monsters are left where they are).
+    /// </summary>
+    public void Forget(MudObject obj)
+    {
+        lock (_lock)
+        {
+            if (_spawnedBy.Remove(obj, out var spawn))
+            {
+                spawn.Live.Remove(obj);
+            }
+
+            if (_rooms.Remove(obj, out var spawns))
+            {
+                foreach (var entry in spawns)
+                {
+                    foreach (var clone in entry.Live) _spawnedBy.Remove(clone);
+                }
+            }
+        }
+    }
+
+    // Clones destructed this tick are still in Live until Forget()
+    private static void Prune(Spawn spawn)
+    {
+        spawn.Live.RemoveAll(clone => clone.IsDestructed);
+    }
+
+    private static string Normalize(string path)
+    {
+        if (path.EndsWith(".c", StringComparison.Ordinal)) path = path[..^2];
+        return path.StartsWith('/') ? path : "/" + path;
+    }
+}
@@ -0,0 +1,228 @@
+using System.Runtime.CompilerServices;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// A sprintf() format string parsed once into literal text and conversions.
+///
+/// Commands like score and who call sprintf in loops with the same constant
+/// formats, so the parse is kept. The bytecode compiler precompiles every
+/// literal format it sees passed to sprintf and attaches the plan to that
+/// literal's string instance, so those calls find their plan with a
+/// reference lookup. Formats built at run time go through a small LRU keyed
+/// by their text.
+/// </summary>
+public sealed class SprintfFormat
+{
+    /// <summary>
+    /// Most run-time formats kept.
+    /// </summary>
+    public const int Capacity = 256;
+
+    /// <summary>
+    /// Literal text (Spec is '\0'), or one conversion such as %-10s.
+    /// </summary>
+    private readonly record struct Segment(string? Text, char Spec, bool LeftAlign, bool ZeroPad, int Width);
+
+    private static readonly ConditionalWeakTable<string, SprintfFormat> Literals = new();
+    private static readonly LruCache<string, SprintfFormat> Dynamic = new(Capacity);
+
+    private readonly Segment[] _segments;
+
+    private SprintfFormat(Segment[] segments)
+    {
+        _segments = segments;
+    }
+
+    /// <summary>
+    /// The plan for format, parsing it if it hasn't been seen.
+    /// </summary>
+    public static SprintfFormat Get(string format)
+    {
+        if (Literals.TryGetValue(format, out var plan)) return plan;
+        return Dynamic.GetOrAdd(format, Parse);
+    }
+
+    /// <summary>
+    /// Parse a format that appears as a literal in compiled code, tying the
+    /// plan to that string instance for as long as the program holds it.
+    /// </summary>
+    public static void Precompile(string literal)
+    {
+        Literals.GetValue(literal, Parse);
+    }
+
+    /// <summary>
+    /// Whether a string instance has a precompiled plan.
+    /// </summary>
+    public static bool IsPrecompiled(string literal) => Literals.TryGetValue(literal, out _);
+
+    private static SprintfFormat Parse(string format)
+    {
+        var segments = new List<Segment>();
+        var text = new StringBuilder();
+        int i = 0;
+
+        void FlushText()
+        {
+            if (text.Length == 0) return;
+            segments.Add(new Segment(text.ToString(), '\0', false, false, 0));
+            text.Clear();
+        }
+
+        while (i < format.Length)
+        {
+            if (format[i] != '%')
+            {
+                text.Append(format[i++]);
+                continue;
+            }
+
+            i++; // Skip '%'
+            if (i >= format.Length) break;
+
+            if (format[i] == '%')
+            {
+                text.Append('%');
+                i++;
+                continue;
+            }
+
+            // Flags: one of - (left-align) or 0 (zero-pad)
+            bool leftAlign = false;
+            bool zeroPad = false;
+            if (format[i] == '-')
+            {
+                leftAlign = true;
+                i++;
+            }
+            else if (format[i] == '0')
+            {
+                zeroPad = true;
+                i++;
+            }
+
+            int width = 0;
+            while (i < format.Length && char.IsDigit(format[i]))
+            {
+                width = width * 10 + (format[i] - '0');
+                i++;
+            }
+
+            if (i >= format.Length) break;
+
+            FlushText();
+            segments.Add(new Segment(null, format[i++], leftAlign, zeroPad, width));
+        }
+
+        FlushText();
+        return new SprintfFormat(segments.ToArray());
+    }
+
+    /// <summary>
+    /// Format args[first..] by this plan. Conversions past the last argument
+    /// produce nothing.
+    /// </summary>
+    public string Format(List<object> args, int first)
+    {
+        var result = new StringBuilder();
+        int argIndex = first;
+
+        foreach (var segment in _segments)
+        {
+            if (segment.Spec == '\0')
+            {
+                result.Append(segment.Text);
+                continue;
+            }
+
+            if (argIndex >= args.Count) continue;
+
+            var formatted = Convert(segment.Spec, args[argIndex++]);
+            int pad = segment.Width - formatted.Length;
+            if (pad <= 0)
+            {
+                result.Append(formatted);
+            }
+            else if (segment.LeftAlign)
+            {
+                result.Append(formatted).Append(' ', pad);
+            }
+            else
+            {
+                bool zero = segment.ZeroPad && segment.Spec is 'd' or 'i' or 'o' or 'x' or 'X';
+                result.Append(zero ? '0' : ' ', pad).Append(formatted);
+            }
+        }
+
+        return result.ToString();
+    }
+
+    private static string Convert(char spec, object arg)
+    {
+        switch (spec)
+        {
+            case 's':
+                return arg switch
+                {
+                    string s => s,
+                    long n => n.ToString(),
+                    int n => n.ToString(),
+                    _ => arg?.ToString() ?? ""
+                };
+            case 'd':
+            case 'i':
+                return arg switch
+                {
+                    long n => n.ToString(),
+                    int n => n.ToString(),
+                    string s when long.TryParse(s, out var n) => n.ToString(),
+                    _ => "0"
+                };
+            case 'o':
+                return arg switch
+                {
+                    long n => System.Convert.ToString(n, 8),
+                    int n => System.Convert.ToString(n, 8),
+                    _ => "0"
+                };
+            case 'x':
+                return arg switch
+                {
+                    long n => System.Convert.ToString(n, 16),
+                    int n => System.Convert.ToString(n, 16),
+                    _ => "0"
+                };
+            case 'X':
+                return arg switch
+                {
+                    long n => System.Convert.ToString(n, 16).ToUpper(),
+                    int n => System.Convert.ToString(n, 16).ToUpper(),
+                    _ => "0"
+                };
+            case 'O':
+                // %O is LPC's "object" format - dump the value
+                return FormatValue(arg);
+            default:
+                return arg?.ToString() ?? "";
+        }
+    }
+
+    /// <summary>
+    /// Format a value for %O (object dump) output.
+    /// </summary>
+    internal static string FormatValue(object value)
+    {
+        return value switch
+        {
+            null => "0",
+            int i => i.ToString(),
+            string s => $"\"{s}\"",
+            List<object> arr => "({ " + string.Join(", ", arr.Select(FormatValue)) + " })",
+            Dictionary<object, object> dict => "([ " + string.Join(", ", dict.Select(kv => $"{FormatValue(kv.Key)}: {FormatValue(kv.Value)}")) + " ])",
+            MudObject obj => obj.FilePath,
+            _ => value.ToString() ?? "0"
+        };
+    }
+}
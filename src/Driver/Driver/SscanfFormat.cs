@@ -0,0 +1,204 @@
+using System.Globalization;
+using System.Runtime.CompilerServices;
+
+namespace Driver;
+
+/// <summary>
+/// A sscanf() format string compiled once into a matcher plan.
+///
+/// Command parsers call sscanf(args, "%s with %s", a, b) on every command,
+/// so formats are kept the way SprintfFormat keeps them: the bytecode
+/// compiler and the tree walker tie a literal format's plan to the literal's
+/// string instance, and formats built at run time share a small LRU.
+///
+/// A plan is a literal prefix followed by conversions. Each conversion
+/// carries the literal text after it (its delimiter) and what ends a %s
+/// with no delimiter: the next digit before a %d, whitespace before another
+/// %s, or the end of the input. Matching walks the input as a span and only
+/// allocates the strings it captures.
+/// </summary>
+public sealed class SscanfFormat
+{
+    /// <summary>
+    /// Most run-time formats kept.
+    /// </summary>
+    public const int Capacity = 256;
+
+    private enum StringEnd : byte
+    {
+        Delimiter,
+        Digit,
+        Whitespace,
+        Input
+    }
+
+    /// <summary>
+    /// Literal text to match (Spec is '\0'), or one conversion such as %*d.
+    /// A '\0' segment with no text stops matching (a format ending in "%*").
+    /// </summary>
+    private readonly record struct Segment(string? Text, char Spec, bool Skip, StringEnd End);
+
+    private static readonly ConditionalWeakTable<string, SscanfFormat> Literals = new();
+    private static readonly LruCache<string, SscanfFormat> Dynamic = new(Capacity);
+
+    private readonly Segment[] _segments;
+
+    private SscanfFormat(Segment[] segments, int captures)
+    {
+        _segments = segments;
+        Captures = captures;
+    }
+
+    /// <summary>
+    /// Conversions that produce a value (all but %*s and %*d): the most
+    /// results Match() can give.
+    /// </summary>
+    public int Captures { get; }
+
+    /// <summary>
+    /// The plan for format, parsing it if it hasn't been seen.
+    /// </summary>
+    public static SscanfFormat Get(string format)
+    {
+        if (Literals.TryGetValue(format, out var plan)) return plan;
+        return Dynamic.GetOrAdd(format, Parse);
+    }
+
+    /// <summary>
+    /// The plan for a format that appears as a literal in code, tied to that
+    /// string instance for as long as the program holds it.
+    /// </summary>
+    public static SscanfFormat Precompile(string literal) => Literals.GetValue(literal, Parse);
+
+    private static SscanfFormat Parse(string format)
+    {
+        var segments = new List<Segment>();
+        int captures = 0;
+        int pos = 0;
+
+        while (pos < format.Length)
+        {
+            if (format[pos] != '%' || pos + 1 == format.Length)
+            {
+                // Literal text, up to the next '%' that starts a conversion
+                int start = pos++;
+                while (pos < format.Length && !(format[pos] == '%' && pos + 1 < format.Length)) pos++;
+                segments.Add(new Segment(format[start..pos], '\0', false, StringEnd.Input));
+                continue;
+            }
+
+            pos++;
+            bool skip = format[pos] == '*';
+            if (skip) pos++;
+            if (pos >= format.Length)
+            {
+                segments.Add(new Segment(null, '\0', true, StringEnd.Input));
+                break;
+            }
+
+            char spec = format[pos++];
+            int next = format.IndexOf('%', pos);
+            if (next < 0) next = format.Length;
+            var delimiter = next > pos ? format[pos..next] : null;
+
+            var end = delimiter != null ? StringEnd.Delimiter
+                : next == format.Length ? StringEnd.Input
+                : next + 1 < format.Length && format[next + 1] == 'd' ? StringEnd.Digit
+                : StringEnd.Whitespace;
+            segments.Add(new Segment(delimiter, spec, skip, end));
+            if (!skip) captures++;
+
+            // A delimiter is consumed with its conversion
+            pos = next;
+        }
+
+        return new SscanfFormat(segments.ToArray(), captures);
+    }
+
+    /// <summary>
+    /// Match input against this plan, storing the captured values (strings
+    /// and ints) in order in results, which must hold Captures values.
+    /// Returns how many were stored; matching stops at the first thing that
+    /// doesn't fit.
+    /// </summary>
+    public int Match(string input, object?[] results)
+    {
+        var text = input.AsSpan();
+        int pos = 0;
+        int count = 0;
+
+        foreach (var segment in _segments)
+        {
+            if (segment.Spec == '\0')
+            {
+                if (segment.Text == null || !text[pos..].StartsWith(segment.Text, StringComparison.Ordinal)) break;
+                pos += segment.Text.Length;
+                continue;
+            }
+
+            switch (segment.Spec)
+            {
+                case 's':
+                {
+                    int end = segment.End switch
+                    {
+                        StringEnd.Delimiter => text[pos..].IndexOf(segment.Text, StringComparison.Ordinal),
+                        StringEnd.Digit => IndexOfDigit(text[pos..]),
+                        StringEnd.Whitespace => IndexOfWhitespace(text[pos..]),
+                        _ => -1
+                    };
+                    end = end < 0 ? text.Length : pos + end;
+
+                    if (!segment.Skip) results[count++] = input[pos..end];
+                    pos = end;
+                    break;
+                }
+
+                case 'd':
+                {
+                    while (pos < text.Length && char.IsWhiteSpace(text[pos])) pos++;
+
+                    int start = pos;
+                    if (pos < text.Length && (text[pos] == '-' || text[pos] == '+')) pos++;
+                    while (pos < text.Length && char.IsDigit(text[pos])) pos++;
+
+                    if (!int.TryParse(text[start..pos], NumberStyles.AllowLeadingSign, CultureInfo.InvariantCulture, out int value))
+                    {
+                        return count;
+                    }
+                    if (!segment.Skip) results[count++] = value;
+                    break;
+                }
+
+                default:
+                    throw new ObjectInterpreterException($"sscanf() unknown format specifier '%{segment.Spec}'");
+            }
+
+            if (segment.Text != null)
+            {
+                if (!text[pos..].StartsWith(segment.Text, StringComparison.Ordinal)) break;
+                pos += segment.Text.Length;
+            }
+        }
+
+        return count;
+    }
+
+    private static int IndexOfDigit(ReadOnlySpan<char> text)
+    {
+        for (int i = 0; i < text.Length; i++)
+        {
+            if (char.IsDigit(text[i])) return i;
+        }
+        return -1;
+    }
+
+    private static int IndexOfWhitespace(ReadOnlySpan<char> text)
+    {
+        for (int i = 0; i < text.Length; i++)
+        {
+            if (char.IsWhiteSpace(text[i])) return i;
+        }
+        return -1;
+    }
+}
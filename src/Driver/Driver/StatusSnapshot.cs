@@ -0,0 +1,46 @@
+using System.Text.Json;
+using System.Text.Json.Serialization;
+
+namespace Driver;
+
+/// <summary>
+/// The driver's state as of the end of one tick, for the read-only /status
+/// API. The game thread builds a new one every tick (GameLoop.Status) and
+/// never changes it afterwards, so a poller reads it without locks and
+/// without running LPC, however often it asks.
+/// </summary>
+public sealed record StatusSnapshot(
+    DateTime Taken,
+    double UptimeSeconds,
+    long Ticks,
+    long LagMs,
+    int Objects,
+    int Blueprints,
+    int Heartbeats,
+    int CalloutsPending,
+    int Coroutines,
+    IReadOnlyList<StatusPlayer> Players)
+{
+    /// <summary>
+    /// Before the first tick.
+    /// </summary>
+    public static readonly StatusSnapshot Empty = new(DateTime.UtcNow, 0, 0, 0, 0, 0, 0, 0, 0, Array.Empty<StatusPlayer>());
+
+    public byte[] ToJson() => JsonSerializer.SerializeToUtf8Bytes(this, StatusJsonContext.Default.StatusSnapshot);
+}
+
+/// <summary>
+/// One player in the game, linkdead or not. Location is the object name of
+/// their environment, null in the void.
+/// </summary>
+public sealed record StatusPlayer(string Name, string? Location, AccessLevel Level, long IdleSeconds, bool Linkdead);
+
+/// <summary>
+/// Source-generated serializer for the /status body.
+/// </summary>
+[JsonSourceGenerationOptions(PropertyNamingPolicy = JsonKnownNamingPolicy.SnakeCaseLower,
+    UseStringEnumConverter = true)]
+[JsonSerializable(typeof(StatusSnapshot))]
+internal partial class StatusJsonContext : JsonSerializerContext
+{
+}
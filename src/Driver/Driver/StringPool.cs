@@ -0,0 +1,45 @@
+using System.Collections.Concurrent;
+
+namespace Driver;
+
+/// <summary>
+/// Shares one instance of each short string the driver sees over and over:
+/// string literals in compiled programs, command verbs and mapping keys read
+/// from save files. Equal pooled strings are the same object, so comparing
+/// them stops at the reference check, and a few hundred players' copies of
+/// "sword" take the space of one.
+///
+/// Unlike string.Intern the pool is bounded: long strings, and anything once
+/// it is full, are returned unpooled, so player input can't grow it without
+/// limit.
+/// </summary>
+public static class StringPool
+{
+    /// <summary>
+    /// Longest string pooled.
+    /// </summary>
+    public const int MaxLength = 32;
+
+    /// <summary>
+    /// Most strings pooled.
+    /// </summary>
+    public const int MaxCount = 65536;
+
+    private static readonly ConcurrentDictionary<string, string> Pool = new(StringComparer.Ordinal);
+
+    /// <summary>
+    /// The pooled instance equal to s, or s itself.
+    /// </summary>
+    public static string Intern(string s)
+    {
+        if (s.Length > MaxLength) return s;
+        if (Pool.TryGetValue(s, out var pooled)) return pooled;
+        if (Pool.Count >= MaxCount) return s;
+        return Pool.GetOrAdd(s, s);
+    }
+
+    /// <summary>
+    /// Number of pooled strings.
+    /// </summary>
+    public static int Count => Pool.Count;
+}
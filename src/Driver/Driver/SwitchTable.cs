@@ -0,0 +1,159 @@
+namespace Driver;
+
+/// <summary>
+/// Case dispatch for a switch statement whose labels are all literals
+/// (see <see cref="SwitchStatement.GetTable"/>). Built once per statement, so
+/// finding the case costs the same however many cases there are.
+///
+/// String labels go in a hash table. Int labels go in a dense array indexed by
+/// value when they are close together, otherwise in a sorted array searched by
+/// bisection. As with the linear scan, the first of duplicate labels wins, the
+/// last default is the one used, and a value that is neither an int nor a
+/// string matches no label.
+/// </summary>
+public sealed class SwitchTable
+{
+    /// <summary>
+    /// Largest dense array built, and how sparse it may be relative to the label count.
+    /// </summary>
+    private const int MaxDenseSize = 4096;
+    private const int DenseSlack = 8;
+
+    private readonly Dictionary<string, int>? _strings;
+
+    // Dense: _dense[value - _denseBase] is the case index + 1, 0 for no label
+    private readonly int[]? _dense;
+    private readonly long _denseBase;
+
+    // Sparse: sorted labels with their case indexes
+    private readonly long[]? _keys;
+    private readonly int[]? _keyCases;
+
+    /// <summary>
+    /// The cases this table was built from (so a copied statement can tell it isn't its own).
+    /// </summary>
+    public List<SwitchCase> Cases { get; }
+
+    /// <summary>
+    /// False when some label isn't a literal; such a switch is matched case by case.
+    /// </summary>
+    public bool IsConstant { get; }
+
+    /// <summary>
+    /// Index of the default case, or -1.
+    /// </summary>
+    public int DefaultIndex { get; } = -1;
+
+    /// <summary>
+    /// Number of labels of each kind (for tests and disassembly).
+    /// </summary>
+    public int IntLabels { get; }
+    public int StringLabels => _strings?.Count ?? 0;
+    public bool IsDense => _dense != null;
+
+    private SwitchTable(List<SwitchCase> cases)
+    {
+        Cases = cases;
+        IsConstant = true;
+
+        var ints = new Dictionary<long, int>();
+        for (int i = 0; i < cases.Count; i++)
+        {
+            switch (cases[i].Value)
+            {
+                case null:
+                    DefaultIndex = i;
+                    break;
+                case NumberLiteral num:
+                    ints.TryAdd(num.Value, i);
+                    break;
+                case StringLiteral str:
+                    (_strings ??= new Dictionary<string, int>()).TryAdd(str.Value, i);
+                    break;
+                default:
+                    IsConstant = false;
+                    return;
+            }
+        }
+
+        IntLabels = ints.Count;
+        if (ints.Count == 0) return;
+
+        long min = ints.Keys.Min();
+        long max = ints.Keys.Max();
+        ulong range = (ulong)(max - min);
+        if (range < MaxDenseSize && range < (ulong)(ints.Count * 2 + DenseSlack))
+        {
+            _denseBase = min;
+            _dense = new int[range + 1];
+            foreach (var (value, caseIndex) in ints)
+            {
+                _dense[value - min] = caseIndex + 1;
+            }
+        }
+        else
+        {
+            _keys = ints.Keys.ToArray();
+            _keyCases = ints.Values.ToArray();
+            Array.Sort(_keys, _keyCases);
+        }
+    }
+
+    /// <summary>
+    /// Build the table for a switch's cases. Check IsConstant before using it.
+    /// </summary>
+    public static SwitchTable Build(List<SwitchCase> cases) => new(cases);
+
+    /// <summary>
+    /// Index of the case to start executing at: the matching label, else
+    /// default, else -1.
+    /// </summary>
+    public int Lookup(object? value)
+    {
+        return value switch
+        {
+            long l => LookupInt(l),
+            int i => LookupInt(i),
+            string s => LookupString(s),
+            _ => DefaultIndex
+        };
+    }
+
+    /// <summary>
+    /// Lookup for a VM value, without boxing ints.
+    /// </summary>
+    public int Lookup(in LpcValue value)
+    {
+        return value.Kind switch
+        {
+            LpcValueKind.Int => LookupInt(value.Int),
+            LpcValueKind.String => LookupString((string)value.Ref!),
+            _ => DefaultIndex
+        };
+    }
+
+    private int LookupInt(long value)
+    {
+        if (_dense != null)
+        {
+            ulong offset = (ulong)(value - _denseBase);
+            if (offset < (ulong)_dense.Length && _dense[offset] != 0)
+            {
+                return _dense[offset] - 1;
+            }
+            return DefaultIndex;
+        }
+
+        if (_keys != null)
+        {
+            int index = Array.BinarySearch(_keys, value);
+            if (index >= 0) return _keyCases![index];
+        }
+        return DefaultIndex;
+    }
+
+    private int LookupString(string value)
+    {
+        return _strings != null && _strings.TryGetValue(value, out var caseIndex) ? caseIndex : DefaultIndex;
+    }
+}
@@ -0,0 +1,234 @@
+using System.Buffers;
+
+namespace Driver;
+
+/// <summary>
+/// Receives one complete input line (without its terminator).
+/// The span is only valid for the duration of the call.
+/// </summary>
+public delegate void TelnetLineHandler(ReadOnlySpan<byte> line);
+
+/// <summary>
+/// Receives an option negotiation: command is WILL, WONT, DO or DONT.
+/// </summary>
+public delegate void TelnetNegotiationHandler(byte command, byte option);
+
+/// <summary>
+/// Receives a complete subnegotiation (IAC SB option ... IAC SE), with
+/// doubled IACs in the payload already collapsed.
+/// The span is only valid for the duration of the call.
+/// </summary>
+public delegate void TelnetSubnegotiationHandler(byte option, ReadOnlySpan<byte> data);
+
+/// <summary>
+/// Incremental telnet input parser.
+///
+/// Bytes can arrive split anywhere - in the middle of an IAC sequence or a
+/// subnegotiation - and the parser carries its state across Feed() calls.
+/// The line editor matches what players expect from a MUD: backspace/DEL
+/// erase, CR is ignored, LF ends the line, and only printable ASCII is kept.
+///
+/// Lines and subnegotiation payloads are gathered in pooled buffers and handed
+/// to the handlers as spans, so parsing itself doesn't allocate.
+/// </summary>
+public sealed class TelnetParser : IDisposable
+{
+    // Telnet protocol bytes
+    public const byte IAC = 255;
+    public const byte DONT = 254;
+    public const byte DO = 253;
+    public const byte WONT = 252;
+    public const byte WILL = 251;
+    public const byte SB = 250;
+    public const byte SE = 240;
+
+    /// <summary>
+    /// Characters kept per line; anything past this is dropped until the next LF.
+    /// </summary>
+    public const int MaxLineLength = 4096;
+
+    /// <summary>
+    /// Subnegotiation payload kept; anything past this is dropped until IAC SE.
+    /// </summary>
+    public const int MaxSubnegotiationLength = 4096;
+
+    private enum State : byte
+    {
+        Data,
+        Iac,              // Saw IAC
+        Negotiation,      // Saw IAC WILL/WONT/DO/DONT, waiting for the option
+        SubnegotiationOption,  // Saw IAC SB, waiting for the option
+        Subnegotiation,   // Inside SB payload
+        SubnegotiationIac // Saw IAC inside SB payload
+    }
+
+    private readonly TelnetLineHandler _onLine;
+    private readonly TelnetNegotiationHandler? _onNegotiation;
+    private readonly TelnetSubnegotiationHandler? _onSubnegotiation;
+
+    private State _state = State.Data;
+    private byte _negotiationCommand;
+    private byte _subnegotiationOption;
+
+    private byte[] _line;
+    private int _lineLength;
+    private byte[] _subnegotiation;
+    private int _subnegotiationLength;
+
+    public TelnetParser(TelnetLineHandler onLine,
+        TelnetNegotiationHandler? onNegotiation = null,
+        TelnetSubnegotiationHandler? onSubnegotiation = null)
+    {
+        _onLine = onLine;
+        _onNegotiation = onNegotiation;
+        _onSubnegotiation = onSubnegotiation;
+        _line = ArrayPool<byte>.Shared.Rent(256);
+        _subnegotiation = ArrayPool<byte>.Shared.Rent(64);
+    }
+
+    /// <summary>
+    /// Parse the next chunk of received bytes.
+    /// </summary>
+    public void Feed(ReadOnlySpan<byte> data)
+    {
+        foreach (var b in data)
+        {
+            switch (_state)
+            {
+                case State.Data:
+                    if (b == IAC)
+                    {
+                        _state = State.Iac;
+                    }
+                    else
+                    {
+                        EditLine(b);
+                    }
+                    break;
+
+                case State.Iac:
+                    if (b >= WILL && b <= DONT)
+                    {
+                        _negotiationCommand = b;
+                        _state = State.Negotiation;
+                    }
+                    else if (b == SB)
+                    {
+                        _state = State.SubnegotiationOption;
+                    }
+                    else
+                    {
+                        // IAC IAC is a literal 255, which the line editor drops anyway;
+                        // other two-byte commands (NOP, GA, AYT, ...) are ignored
+                        _state = State.Data;
+                    }
+                    break;
+
+                case State.Negotiation:
+                    _onNegotiation?.Invoke(_negotiationCommand, b);
+                    _state = State.Data;
+                    break;
+
+                case State.SubnegotiationOption:
+                    _subnegotiationOption = b;
+                    _subnegotiationLength = 0;
+                    _state = State.Subnegotiation;
+                    break;
+
+                case State.Subnegotiation:
+                    if (b == IAC)
+                    {
+                        _state = State.SubnegotiationIac;
+                    }
+                    else
+                    {
+                        AppendSubnegotiation(b);
+                    }
+                    break;
+
+                case State.SubnegotiationIac:
+                    if (b == SE)
+                    {
+                        _onSubnegotiation?.Invoke(_subnegotiationOption,
+                            _subnegotiation.AsSpan(0, _subnegotiationLength));
+                        _state = State.Data;
+                    }
+                    else
+                    {
+                        // IAC IAC inside the payload is a literal 255
+                        if (b == IAC)
+                        {
+                            AppendSubnegotiation(b);
+                        }
+                        _state = State.Subnegotiation;
+                    }
+                    break;
+            }
+        }
+    }
+
+    private void EditLine(byte b)
+    {
+        // Handle backspace
+        if (b == 8 || b == 127)
+        {
+            if (_lineLength > 0)
+            {
+                _lineLength--;
+            }
+            return;
+        }
+
+        // Handle newline - emit complete line
+        if (b == '\n')
+        {
+            _onLine(_line.AsSpan(0, _lineLength));
+            _lineLength = 0;
+            return;
+        }
+
+        // Regular character (CR and other control bytes are dropped)
+        if (b >= 32 && b < 127 && _lineLength < MaxLineLength)
+        {
+            if (_lineLength == _line.Length)
+            {
+                _line = Grow(_line);
+            }
+            _line[_lineLength++] = b;
+        }
+    }
+
+    private void AppendSubnegotiation(byte b)
+    {
+        if (_subnegotiationLength >= MaxSubnegotiationLength)
+        {
+            return;
+        }
+
+        if (_subnegotiationLength == _subnegotiation.Length)
+        {
+            _subnegotiation = Grow(_subnegotiation);
+        }
+        _subnegotiation[_subnegotiationLength++] = b;
+    }
+
+    private static byte[] Grow(byte[] buffer)
+    {
+        var larger = ArrayPool<byte>.Shared.Rent(Math.Max(64, buffer.Length * 2));
+        buffer.CopyTo(larger, 0);
+        ArrayPool<byte>.Shared.Return(buffer);
+        return larger;
+    }
+
+    public void Dispose()
+    {
+        if (_line.Length == 0) return;
+
+        ArrayPool<byte>.Shared.Return(_line);
+        ArrayPool<byte>.Shared.Return(_subnegotiation);
+        _line = Array.Empty<byte>();
+        _subnegotiation = Array.Empty<byte>();
+        _lineLength = 0;
+        _subnegotiationLength = 0;
+    }
+}
@@ -1,35 +1,124 @@
+using System.Collections.Concurrent;
+using System.IO.Compression;
 using System.Net;
 using System.Net.Sockets;
+using System.Net.WebSockets;
 
 namespace Driver;
 
 /// <summary>
 /// Telnet server that accepts multiple concurrent connections.
 /// Commands are queued to the GameLoop for single-threaded processing.
+///
+/// Network I/O is event-driven: accepts and reads are async, so each
+/// connection's receive loop only runs when its socket has data and pushes
+/// complete lines straight into GameLoop.QueueCommand. The server thread
+/// sleeps until there is output to deliver or a connection to close; it never
+/// walks the connection list looking for input.
+///
+/// With WebSocketPort set, a second listener takes WebSocket connections from
+/// browser clients. After the handshake they are Connections like any other,
+/// with the same output path, limits and game loop session.
 /// </summary>
 public class TelnetServer : IDisposable
 {
-    private readonly TcpListener _listener;
-    private readonly List<Connection> _connections = new();
+    private readonly Socket _listener;
+    /// <summary>
+    /// Open connections keyed by ID, so routing each output message is one lookup.
+    /// </summary>
+    private readonly ConcurrentDictionary<string, Connection> _connections = new();
     private readonly int _port;
     private readonly object _lock = new();
 
     private readonly GameLoop _gameLoop;
 
-    private bool _running;
+    private volatile bool _running;
     private bool _disposed;
 
+    /// <summary>
+    /// Signalled when the server thread has work: output queued, a connection
+    /// closed or marked for disconnect, or shutdown.
+    /// </summary>
+    private readonly AutoResetEvent _wake = new(false);
+
+    /// <summary>
+    /// Connections whose receive loop has ended (client hung up).
+    /// </summary>
+    private readonly ConcurrentQueue<Connection> _closedConnections = new();
+
+    /// <summary>
+    /// Connections that hit their output limit under Linkdead or Disconnect.
+    /// </summary>
+    private readonly ConcurrentQueue<Connection> _overflowedConnections = new();
+
+    private readonly CancellationTokenSource _acceptCancellation = new();
+
+    private readonly OutputLimits _outputLimits;
+
+    /// <summary>
+    /// MCCP2 level offered to every new connection; null to not offer it.
+    /// </summary>
+    private readonly CompressionLevel? _compression;
+
+    /// <summary>
+    /// Output overflows since startup, including connections already closed.
+    /// </summary>
+    private long _overflowCount;
+
+    /// <summary>
+    /// Bytes sent and dropped by connections already closed, so the totals
+    /// in GetOutputStats() cover the whole run.
+    /// </summary>
+    private long _closedBytesSent;
+    private long _closedBytesDropped;
+
+    /// <summary>
+    /// Connections with buffered output during a drain (server thread only).
+    /// </summary>
+    private readonly List<Connection> _flushList = new();
+    private readonly ColorRenderer _colors = new();
+
+    /// <summary>
+    /// Connections whose player has been handed off to another cluster node;
+    /// their output is dropped (server thread only).
+    /// </summary>
+    private readonly HashSet<string> _handedOff = new();
+
+    /// <summary>
+    /// Upper bound on how long the server thread sleeps with nothing to do.
+    /// </summary>
+    private const int IdleWakeMs = 1000;
+
     public int Port => _port;
-    public int ConnectionCount
-    {
-        get
-        {
-            lock (_lock)
-            {
-                return _connections.Count;
-            }
-        }
-    }
+
+    /// <summary>
+    /// Port to take WebSocket clients on, or null for none. Set before Run().
+    /// 0 picks a free port.
+    /// </summary>
+    public int? WebSocketPort { get; init; }
+
+    private Socket? _webSocketListener;
+
+    /// <summary>
+    /// The WebSocket port actually bound, once Run() has started.
+    /// </summary>
+    public int WebSocketLocalPort => ((IPEndPoint)_webSocketListener!.LocalEndPoint!).Port;
+
+    /// <summary>
+    /// How long a WebSocket client has to finish its handshake.
+    /// </summary>
+    private static readonly TimeSpan HandshakeTimeout = TimeSpan.FromSeconds(10);
+
+    /// <summary>
+    /// The port actually bound (differs from Port when constructed with port 0).
+    /// </summary>
+    public int LocalPort => ((IPEndPoint)_listener.LocalEndPoint!).Port;
+
+    /// <summary>
+    /// Set once Run() has started listening.
+    /// </summary>
+    public ManualResetEventSlim Listening { get; } = new(false);
+    public int ConnectionCount => _connections.Count;
 
     /// <summary>
     /// Connections pending disconnection (set by game loop when player is destructed).
@@ -37,12 +126,43 @@ public class TelnetServer : IDisposable
     private readonly HashSet<string> _pendingDisconnect = new();
     private readonly object _disconnectLock = new();
 
-    public TelnetServer(int port, GameLoop gameLoop)
+    /// <summary>
+    /// Connections inherited from the driver process before a copyover,
+    /// taken on when Run() starts. Null for a server that binds its own port.
+    /// </summary>
+    private readonly List<CopyoverConnection>? _inherited;
+
+    private volatile bool _copyoverRequested;
+
+    /// <param name="outputLimits">Per-connection output bound (defaults to OutputLimits.Default)</param>
+    /// <param name="compression">MCCP2 compression level to offer clients; null disables it</param>
+    public TelnetServer(int port, GameLoop gameLoop, OutputLimits? outputLimits = null, CompressionLevel? compression = null)
     {
         _port = port;
         _gameLoop = gameLoop;
-        _listener = new TcpListener(IPAddress.Any, port);
+        _outputLimits = outputLimits ?? OutputLimits.Default;
+        _compression = compression;
+        _listener = new Socket(AddressFamily.InterNetwork, SocketType.Stream, ProtocolType.Tcp);
+        HookGameLoop();
+    }
+
+    /// <summary>
+    /// Take over from the driver process that ran before a copyover: its
+    /// listening socket and connections, as described by state.
+    /// </summary>
+    public TelnetServer(CopyoverState state, GameLoop gameLoop, OutputLimits? outputLimits = null, CompressionLevel? compression = null)
+    {
+        _port = state.Port;
+        _gameLoop = gameLoop;
+        _outputLimits = outputLimits ?? OutputLimits.Default;
+        _compression = compression;
+        _listener = Copyover.Adopt(state.ListenerHandle);
+        _inherited = state.Connections;
+        HookGameLoop();
+    }
 
+    private void HookGameLoop()
+    {
         // Set up callback for when players should be disconnected
         _gameLoop.OnPlayerDisconnect = connectionId =>
         {
@@ -50,14 +170,21 @@ public class TelnetServer : IDisposable
             {
                 _pendingDisconnect.Add(connectionId);
             }
+            _wake.Set();
         };
 
+        // Wake the server thread when a tick has produced output
+        _gameLoop.OnOutputReady = () => _wake.Set();
+
         // Set up callback for echo mode changes (password input)
         _gameLoop.OnSetEchoMode = (connectionId, enabled) =>
         {
             var conn = FindConnection(connectionId);
             conn?.SetEchoMode(enabled);
         };
+        _gameLoop.OnSetColor = (connectionId, color) => FindConnection(connectionId)?.ForceColor(color);
+
+        _gameLoop.OnCopyoverRequested = RequestCopyover;
     }
 
     /// <summary>
@@ -66,10 +193,29 @@ public class TelnetServer : IDisposable
     /// </summary>
     public void Run()
     {
-        _listener.Start();
+        if (_inherited == null)
+        {
+            _listener.Bind(new IPEndPoint(IPAddress.Any, _port));
+            _listener.Listen();
+        }
+        else
+        {
+            AdoptInherited(_inherited);
+        }
+        if (WebSocketPort != null)
+        {
+            _webSocketListener = new Socket(AddressFamily.InterNetwork, SocketType.Stream, ProtocolType.Tcp);
+            _webSocketListener.Bind(new IPEndPoint(IPAddress.Any, WebSocketPort.Value));
+            _webSocketListener.Listen();
+        }
         _running = true;
+        Listening.Set();
 
         Logger.Info($"LPMud Revival listening on port {_port}", LogCategory.Network);
+        if (_webSocketListener != null)
+        {
+            Logger.Info($"WebSocket clients on port {WebSocketLocalPort}", LogCategory.Network);
+        }
 
         // Handle Ctrl+C
         Console.CancelKeyPress += (_, e) =>
@@ -78,18 +224,30 @@ public class TelnetServer : IDisposable
             Stop();
         };
 
+        _ = AcceptLoopAsync(_acceptCancellation.Token);
+        if (_webSocketListener != null)
+        {
+            _ = AcceptWebSocketsAsync(_webSocketListener, _acceptCancellation.Token);
+        }
+
         while (_running)
         {
             try
             {
-                // Accept new connections (non-blocking check)
-                AcceptPendingConnections();
-
-                // Process all connections (read input, drain output)
+                // Deliver output and close connections that hung up or were disconnected
                 ProcessConnections();
 
-                // Small sleep to avoid busy-waiting
-                Thread.Sleep(10);
+                if (_copyoverRequested)
+                {
+                    _copyoverRequested = false;
+                    PerformCopyover();
+                }
+
+                // Closing sessions can queue output (linkdead announcements); deliver it right away
+                if (!_gameLoop.HasPendingOutput)
+                {
+                    _wake.WaitOne(IdleWakeMs);
+                }
             }
             catch (Exception ex) when (_running)
             {
@@ -111,26 +269,44 @@ public class TelnetServer : IDisposable
         _gameLoop.GracefulShutdown();
 
         _running = false;
+        _acceptCancellation.Cancel();
+        _wake.Set();
     }
 
-    private void AcceptPendingConnections()
+    private async Task AcceptLoopAsync(CancellationToken cancellationToken)
     {
-        while (_listener.Pending())
+        while (!cancellationToken.IsCancellationRequested)
         {
+            TcpClient client;
             try
             {
-                var client = _listener.AcceptTcpClient();
-                var connection = new Connection(client, _gameLoop);
+                client = new TcpClient { Client = await _listener.AcceptAsync(cancellationToken) };
+            }
+            catch (Exception ex) when (ex is OperationCanceledException or ObjectDisposedException)
+            {
+                break;
+            }
+            catch (SocketException ex)
+            {
+                Logger.Error($"Error accepting connection: {ex.Message}", LogCategory.Network);
+                continue;
+            }
 
-                lock (_lock)
-                {
-                    _connections.Add(connection);
-                }
+            // A cluster node only takes connections from the router
+            if (_gameLoop.Cluster != null)
+            {
+                _ = AcceptRoutedAsync(client, cancellationToken);
+                continue;
+            }
 
+            try
+            {
+                var connection = AddConnection(client);
                 Logger.Info($"New connection: {connection.Id} from {client.Client.RemoteEndPoint}", LogCategory.Network);
 
                 // Create player session in game loop (sends welcome banner)
-                _gameLoop.CreatePlayerSession(connection.Id);
+                _gameLoop.CreatePlayerSession(connection.Id, connection.RemoteAddress);
+                StartReceiving(connection);
             }
             catch (Exception ex)
             {
@@ -139,18 +315,233 @@ public class TelnetServer : IDisposable
         }
     }
 
-    private void ProcessConnections()
+    private async Task AcceptWebSocketsAsync(Socket listener, CancellationToken cancellationToken)
     {
-        List<Connection> toRemove = new();
-        List<Connection> snapshot;
+        while (!cancellationToken.IsCancellationRequested)
+        {
+            Socket socket;
+            try
+            {
+                socket = await listener.AcceptAsync(cancellationToken);
+            }
+            catch (Exception ex) when (ex is OperationCanceledException or ObjectDisposedException)
+            {
+                break;
+            }
+            catch (SocketException ex)
+            {
+                Logger.Error($"Error accepting WebSocket connection: {ex.Message}", LogCategory.Network);
+                continue;
+            }
 
-        lock (_lock)
+            // The handshake waits on the client, so it doesn't hold up the next accept
+            _ = HandshakeAsync(new TcpClient { Client = socket }, cancellationToken);
+        }
+    }
+
+    private async Task HandshakeAsync(TcpClient client, CancellationToken cancellationToken)
+    {
+        try
+        {
+            using var timeout = CancellationTokenSource.CreateLinkedTokenSource(cancellationToken);
+            timeout.CancelAfter(HandshakeTimeout);
+
+            var webSocket = await WebSocketHandshake.AcceptAsync(client.GetStream(), _compression != null, timeout.Token);
+            if (webSocket == null)
+            {
+                client.Dispose();
+                return;
+            }
+
+            var connection = AddConnection(client, webSocket);
+            Logger.Info($"New WebSocket connection: {connection.Id} from {client.Client.RemoteEndPoint}", LogCategory.Network);
+
+            _gameLoop.CreatePlayerSession(connection.Id, connection.RemoteAddress);
+            StartReceiving(connection);
+        }
+        catch (Exception ex)
         {
-            snapshot = _connections.ToList();
+            Logger.Debug($"WebSocket handshake failed: {ex.Message}", LogCategory.Network);
+            client.Dispose();
         }
+    }
+
+    /// <summary>
+    /// A connection from the cluster router: read its route line, then start
+    /// a login, or log in a player the router is handing over from another
+    /// node. Anything without a valid route line is closed.
+    /// </summary>
+    private async Task AcceptRoutedAsync(TcpClient client, CancellationToken cancellationToken)
+    {
+        var cluster = _gameLoop.Cluster!;
+        try
+        {
+            using var timeout = CancellationTokenSource.CreateLinkedTokenSource(cancellationToken);
+            timeout.CancelAfter(HandshakeTimeout);
+
+            // Byte at a time, so nothing after the line is taken from the connection
+            var line = new List<byte>();
+            var one = new byte[1];
+            while (line.Count < 512 && await client.Client.ReceiveAsync(one, SocketFlags.None, timeout.Token) == 1 && one[0] != (byte)'\n')
+            {
+                line.Add(one[0]);
+            }
+
+            var route = cluster.ParseRoute(System.Text.Encoding.UTF8.GetString(line.ToArray()));
+            if (route == null)
+            {
+                Logger.Warning($"Refused a connection without a route from {client.Client.RemoteEndPoint}", LogCategory.Network);
+                client.Dispose();
+                return;
+            }
+
+            var connection = AddConnection(client);
+            cluster.Routed(connection.Id, route.RouteId);
+            Logger.Info($"New connection: {connection.Id} from {route.Address} (route {route.RouteId})", LogCategory.Network);
+
+            if (route.User != null)
+            {
+                _gameLoop.ResumePlayerSession(connection.Id, route.Address, route.User, route.Room);
+            }
+            else
+            {
+                _gameLoop.CreatePlayerSession(connection.Id, route.Address);
+            }
+            StartReceiving(connection);
+        }
+        catch (Exception ex)
+        {
+            Logger.Debug($"Routed connection failed: {ex.Message}", LogCategory.Network);
+            client.Dispose();
+        }
+    }
+
+    private Connection AddConnection(TcpClient client, WebSocket? webSocket = null)
+    {
+        var connection = new Connection(client, _gameLoop, _outputLimits, overflowed =>
+        {
+            Interlocked.Increment(ref _overflowCount);
+            _overflowedConnections.Enqueue(overflowed);
+            _wake.Set();
+        }, _compression, webSocket);
+
+        _connections[connection.Id] = connection;
+        return connection;
+    }
+
+    private void StartReceiving(Connection connection)
+    {
+        _wake.Set();
+        _ = connection.StartReceiving(closed =>
+        {
+            _closedConnections.Enqueue(closed);
+            _wake.Set();
+        });
+    }
+
+    /// <summary>
+    /// Ask for a copyover; the server thread carries it out. Safe from any thread.
+    /// </summary>
+    public void RequestCopyover()
+    {
+        _copyoverRequested = true;
+        _wake.Set();
+    }
+
+    /// <summary>
+    /// Hand the listening socket and every connection to a new driver process
+    /// (see Copyover). Holds the game thread while players are saved and the
+    /// sockets are passed on; if anything goes wrong before exec() the game
+    /// just carries on here.
+    /// </summary>
+    private void PerformCopyover()
+    {
+        if (!Copyover.IsSupported)
+        {
+            _gameLoop.CopyoverFailed("not supported on this platform");
+            return;
+        }
+        if (!_gameLoop.Pause(TimeSpan.FromSeconds(5)))
+        {
+            _gameLoop.Resume();
+            _gameLoop.CopyoverFailed("the game thread didn't stop");
+            return;
+        }
+
+        Logger.Info($"Copyover: handing {_connections.Count} connection(s) to a new driver process", LogCategory.System);
+        var inherited = new List<long>();
+        try
+        {
+            var players = _gameLoop.PrepareCopyover();
+            DrainOutputQueue();
+
+            long listener = Copyover.Inherit(_listener);
+            inherited.Add(listener);
+
+            var connections = new List<CopyoverConnection>();
+            foreach (var conn in _connections.Values)
+            {
+                // A WebSocket's framing and deflate state can't be carried
+                // over; its player is saved and logs back in after the restart
+                if (conn.IsWebSocket)
+                {
+                    continue;
+                }
+
+                conn.EndCompression();
+                conn.WaitForSends(TimeSpan.FromSeconds(1));
+
+                long handle = Copyover.Inherit(conn.Socket);
+                inherited.Add(handle);
+                connections.Add(new CopyoverConnection(handle, conn.RemoteAddress, players.GetValueOrDefault(conn.Id)));
+            }
+
+            var statePath = Path.Combine(Path.GetTempPath(), $"lpmud-copyover-{Environment.ProcessId}.json");
+            Copyover.Save(new CopyoverState(_port, listener, connections), statePath);
+            Copyover.Exec(Copyover.RestartArguments(statePath));
+        }
+        catch (Exception ex)
+        {
+            foreach (var handle in inherited)
+            {
+                Copyover.Release(handle);
+            }
+            _gameLoop.CopyoverFailed(ex.Message);
+            _gameLoop.Resume();
+        }
+    }
+
+    /// <summary>
+    /// Take on the connections a copyover passed in: players go straight back
+    /// into the game, anyone who was logging in gets the banner again.
+    /// </summary>
+    private void AdoptInherited(List<CopyoverConnection> inherited)
+    {
+        foreach (var entry in inherited)
+        {
+            try
+            {
+                var connection = AddConnection(new TcpClient { Client = Copyover.Adopt(entry.Handle) });
+
+                // It may have been typing a password with echo off
+                connection.SetEchoMode(true);
+                _gameLoop.ResumePlayerSession(connection.Id, entry.RemoteAddress, entry.Username);
+                StartReceiving(connection);
+            }
+            catch (Exception ex)
+            {
+                Logger.Error($"Copyover: could not take over connection {entry.Handle}: {ex.Message}", LogCategory.Network);
+            }
+        }
+        Logger.Info($"Copyover: took over {_connections.Count} connection(s)", LogCategory.Network);
+    }
+
+    private void ProcessConnections()
+    {
+        List<Connection> toRemove = new();
 
         // Drain output queue and send to connections
-        DrainOutputQueue(snapshot);
+        DrainOutputQueue();
 
         // Check for pending disconnects from game loop
         HashSet<string> disconnectSet;
@@ -160,34 +551,34 @@ public class TelnetServer : IDisposable
             _pendingDisconnect.Clear();
         }
 
-        // Process input from connections
-        foreach (var conn in snapshot)
+        foreach (var connectionId in disconnectSet)
         {
-            // Check if marked for disconnection
-            if (disconnectSet.Contains(conn.Id))
+            if (_connections.TryGetValue(connectionId, out var conn))
             {
                 toRemove.Add(conn);
-                continue;
             }
+        }
 
-            if (!conn.IsConnected)
+        // Connections whose client hung up
+        while (_closedConnections.TryDequeue(out var closed))
+        {
+            if (!toRemove.Contains(closed))
             {
-                toRemove.Add(conn);
-                continue;
+                toRemove.Add(closed);
             }
+        }
 
-            try
+        // Connections whose client stopped reading. Linkdead goes through the
+        // normal removal below; Disconnect logs the player out first.
+        while (_overflowedConnections.TryDequeue(out var overflowed))
+        {
+            if (_outputLimits.Policy == OutputOverflowPolicy.Disconnect)
             {
-                var lines = conn.ReadAvailableLines();
-                foreach (var line in lines)
-                {
-                    conn.ProcessLine(line);
-                }
+                _gameLoop.DisconnectSession(overflowed.Id);
             }
-            catch (Exception ex)
+            if (!toRemove.Contains(overflowed))
             {
-                Logger.Error($"Error processing {conn.Id}: {ex.Message}", LogCategory.Network);
-                toRemove.Add(conn);
+                toRemove.Add(overflowed);
             }
         }
 
@@ -198,12 +589,21 @@ public class TelnetServer : IDisposable
             {
                 foreach (var conn in toRemove)
                 {
+                    // Already removed (closed by both sides, or during shutdown)
+                    if (!_connections.TryRemove(conn.Id, out _))
+                    {
+                        continue;
+                    }
+
                     Logger.Debug($"Connection closed: {conn.Id}", LogCategory.Network);
 
                     // Remove player session from game loop
                     _gameLoop.RemovePlayerSession(conn.Id);
+                    _gameLoop.Cluster?.Unrouted(conn.Id);
+                    _handedOff.Remove(conn.Id);
 
-                    _connections.Remove(conn);
+                    Interlocked.Add(ref _closedBytesSent, conn.BytesSent);
+                    Interlocked.Add(ref _closedBytesDropped, conn.BytesDropped);
                     conn.Dispose();
                 }
             }
@@ -211,44 +611,143 @@ public class TelnetServer : IDisposable
     }
 
     /// <summary>
-    /// Drain output queue and send messages to appropriate connections.
+    /// Output counters for the status command: bytes currently queued across
+    /// open connections, and totals sent, dropped and overflowed since startup.
+    /// </summary>
+    public OutputStats GetOutputStats()
+    {
+        long queued = 0, sent = Interlocked.Read(ref _closedBytesSent), dropped = Interlocked.Read(ref _closedBytesDropped);
+        int count = 0;
+        foreach (var conn in _connections.Values)
+        {
+            count++;
+            queued += conn.QueuedBytes;
+            sent += conn.BytesSent;
+            dropped += conn.BytesDropped;
+        }
+        return new OutputStats(count, queued, sent, dropped, Interlocked.Read(ref _overflowCount));
+    }
+
+    /// <summary>
+    /// Drain output queue into each connection's buffer, then flush every
+    /// connection that received something with a single write. The server
+    /// wakes once per game tick, so a tick's output for a player goes out in
+    /// one write instead of one per message.
     /// </summary>
-    private void DrainOutputQueue(List<Connection> connections)
+    private void DrainOutputQueue()
     {
         while (_gameLoop.TryDequeueOutput(out var output))
         {
             if (output == null) continue;
 
-            var conn = connections.Find(c => c.Id == output.ConnectionId);
-            conn?.Send(output.Content);
+            if (_handedOff.Contains(output.ConnectionId)) continue;
+
+            if (_connections.TryGetValue(output.ConnectionId, out var conn))
+            {
+                if (output.Handoff != null)
+                {
+                    // Out before the router switches the client over
+                    conn.FlushOutput();
+                    _handedOff.Add(conn.Id);
+                    _gameLoop.Cluster?.Send(output.Handoff);
+                    continue;
+                }
+                if (output.Trace != null)
+                {
+                    // The command's output is all ahead of here; it goes out with the flush
+                    output.Trace.Reached(CommandStage.Send);
+                    if (!conn.HasPendingOutput)
+                    {
+                        // Listed twice at worst, and a second flush has nothing to do
+                        _flushList.Add(conn);
+                    }
+                    conn.TraceSend(output.Trace);
+                    continue;
+                }
+                if (output.Gmcp)
+                {
+                    conn.QueueGmcp(output.Content);
+                    continue;
+                }
+                Deliver(conn, output.Content, null);
+
+                foreach (var observer in _gameLoop.Observers.For(output.ConnectionId))
+                {
+                    if (_connections.TryGetValue(observer.ConnectionId, out var watcher))
+                    {
+                        Deliver(watcher, output.Content, observer);
+                    }
+                }
+            }
+        }
+        _colors.Clear();
+
+        foreach (var conn in _flushList)
+        {
+            conn.FlushOutput();
         }
+        _flushList.Clear();
     }
 
-    private Connection? FindConnection(string connectionId)
+    /// <summary>
+    /// Queue a message on a connection, rendered for its color class: its own
+    /// output, or a copy of another connection's for an observer. An
+    /// observer gets the target's header line first when the output it is
+    /// given switches to that target.
+    /// </summary>
+    private void Deliver(Connection conn, string content, OutputObservers.Observer? observing)
     {
-        lock (_lock)
+        if (!conn.HasPendingOutput)
         {
-            return _connections.Find(c => c.Id == connectionId);
+            _flushList.Add(conn);
         }
+
+        var source = observing?.Header;
+        if (!ReferenceEquals(conn.ObservedSource, source))
+        {
+            conn.ObservedSource = source;
+            if (source != null)
+            {
+                conn.QueueOutput(_colors.Render(source, conn.Color));
+            }
+        }
+        conn.QueueOutput(_colors.Render(content, conn.Color));
+    }
+
+    /// <summary>
+    /// Snapshot of the open connections, for per-connection stats.
+    /// </summary>
+    public List<Connection> GetConnections()
+    {
+        return _connections.Values.ToList();
+    }
+
+    private Connection? FindConnection(string connectionId)
+    {
+        return _connections.TryGetValue(connectionId, out var conn) ? conn : null;
     }
 
     private void Cleanup()
     {
         lock (_lock)
         {
-            foreach (var conn in _connections)
+            foreach (var conn in _connections.Values)
             {
                 conn.SendLine("Server shutting down. Goodbye!");
 
                 // Remove player session from game loop
                 _gameLoop.RemovePlayerSession(conn.Id);
 
+                // Give the goodbye a moment to reach clients that are reading
+                conn.WaitForSends(TimeSpan.FromMilliseconds(200));
+
                 conn.Dispose();
             }
             _connections.Clear();
         }
 
-        _listener.Stop();
+        _listener.Dispose();
+        _webSocketListener?.Dispose();
         Logger.Info("Server stopped", LogCategory.Network);
     }
 
@@ -258,11 +757,12 @@ public class TelnetServer : IDisposable
         _disposed = true;
 
         Stop();
-        _listener.Stop();
+        _listener.Dispose();
+        _webSocketListener?.Dispose();
 
         lock (_lock)
         {
-            foreach (var conn in _connections)
+            foreach (var conn in _connections.Values)
             {
                 _gameLoop.RemovePlayerSession(conn.Id);
                 conn.Dispose();
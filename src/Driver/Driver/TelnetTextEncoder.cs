@@ -0,0 +1,130 @@
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// Turns a connection's batch of output text into the bytes sent to it:
+/// \n becomes \r\n unless it already follows \r, anything outside ASCII
+/// becomes '?', and with a Width the text is word wrapped to fit the
+/// client's window (from NAWS).
+///
+/// Wrapping breaks at the last space before the edge, or mid-word if a word
+/// is wider than the window. Escape sequences (color) take no columns and
+/// are never split. The column carries over between batches, so a line built
+/// from several messages wraps as one; a line already sent can't be broken
+/// again, so the break then goes at the edge.
+/// </summary>
+public sealed class TelnetTextEncoder
+{
+    /// <summary>
+    /// Narrower windows aren't wrapped for: the numbers are more likely junk
+    /// than a real terminal.
+    /// </summary>
+    public const int MinimumWidth = 20;
+
+    private const char Escape = '\u001b';
+
+    private volatile int _width;
+    private int _column;
+    private int _escape; // 0 outside an escape sequence, 1 after ESC, 2 inside ESC [ ...
+
+    /// <summary>
+    /// Columns to wrap at; 0 (the default, or anything under MinimumWidth) for no wrapping.
+    /// Set from the receive thread as NAWS reports arrive.
+    /// </summary>
+    public int Width
+    {
+        get => _width;
+        set => _width = value >= MinimumWidth ? value : 0;
+    }
+
+    /// <summary>
+    /// A buffer for Encode() this long always has room for chars characters.
+    /// </summary>
+    public static int MaxEncodedLength(int chars) => chars * 3 + 2;
+
+    /// <summary>
+    /// Encode text into buffer (at least MaxEncodedLength(text.Length) long)
+    /// and return the number of bytes written.
+    /// </summary>
+    public int Encode(StringBuilder text, byte[] buffer)
+    {
+        int width = _width;
+        int length = 0;
+        int lastSpace = -1;
+        int spaceColumn = 0;
+        char previous = '\0';
+
+        foreach (var chunk in text.GetChunks())
+        {
+            foreach (var c in chunk.Span)
+            {
+                if (_escape != 0 || c == Escape)
+                {
+                    buffer[length++] = c < 128 ? (byte)c : (byte)'?';
+                    _escape = c == Escape ? 1
+                        : _escape == 1 && c == '[' ? 2
+                        : _escape == 2 && (c < '@' || c > '~') ? 2
+                        : 0;
+                    previous = c;
+                    continue;
+                }
+
+                if (c == '\n' || c == '\r')
+                {
+                    if (c == '\n' && previous != '\r')
+                    {
+                        buffer[length++] = (byte)'\r';
+                    }
+                    buffer[length++] = (byte)c;
+                    _column = 0;
+                    lastSpace = -1;
+                    previous = c;
+                    continue;
+                }
+
+                if (width > 0 && _column >= width)
+                {
+                    if (c == ' ')
+                    {
+                        // The space falls at the edge: the line break replaces it
+                        buffer[length++] = (byte)'\r';
+                        buffer[length++] = (byte)'\n';
+                        _column = 0;
+                        lastSpace = -1;
+                        previous = '\n';
+                        continue;
+                    }
+
+                    if (lastSpace >= 0)
+                    {
+                        // Turn the last space into \r\n and carry the word after it down
+                        buffer.AsSpan(lastSpace + 1, length - lastSpace - 1).CopyTo(buffer.AsSpan(lastSpace + 2));
+                        buffer[lastSpace] = (byte)'\r';
+                        buffer[lastSpace + 1] = (byte)'\n';
+                        length++;
+                        _column -= spaceColumn;
+                    }
+                    else
+                    {
+                        buffer[length++] = (byte)'\r';
+                        buffer[length++] = (byte)'\n';
+                        _column = 0;
+                    }
+                    lastSpace = -1;
+                }
+
+                buffer[length++] = c < 128 ? (byte)c : (byte)'?';
+                _column++;
+                if (c == ' ')
+                {
+                    lastSpace = length - 1;
+                    spaceColumn = _column;
+                }
+                previous = c;
+            }
+        }
+
+        return length;
+    }
+}
@@ -0,0 +1,123 @@
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// What a client's terminal can show, from the least to the most colorful.
+/// Output is rendered once per class (see ColorRenderer).
+/// </summary>
+public enum ColorSupport
+{
+    /// <summary>
+    /// No escape codes: markup is stripped.
+    /// </summary>
+    None,
+
+    /// <summary>
+    /// The 16 ANSI colors; xterm color numbers map to the nearest one.
+    /// </summary>
+    Ansi,
+
+    /// <summary>
+    /// The xterm 256-color palette.
+    /// </summary>
+    Xterm256
+}
+
+/// <summary>
+/// A client's answers to TTYPE: its name, its terminal type and, for clients
+/// that follow MTTS, the MTTS capability bits (0 if it didn't send them).
+/// </summary>
+public sealed record TerminalInfo(string Client, string Terminal, int Mtts)
+{
+    public const int MttsAnsi = 1;
+    public const int MttsUtf8 = 4;
+    public const int Mtts256Colors = 8;
+    public const int MttsScreenReader = 64;
+    public const int MttsTrueColor = 256;
+
+    /// <summary>
+    /// The color class this terminal gets. MTTS bits decide when present;
+    /// otherwise the terminal type, then the client name: anything naming
+    /// 256 colors, and MUD clients known to have them, get xterm colors,
+    /// a dumb terminal gets none, and the rest the 16 ANSI colors.
+    /// </summary>
+    public ColorSupport Color
+    {
+        get
+        {
+            if (Mtts != 0)
+            {
+                if ((Mtts & (Mtts256Colors | MttsTrueColor)) != 0) return ColorSupport.Xterm256;
+                return (Mtts & MttsAnsi) != 0 ? ColorSupport.Ansi : ColorSupport.None;
+            }
+
+            var terminal = Terminal.ToUpperInvariant();
+            if (terminal.Contains("256COLOR") || terminal.Contains("TRUECOLOR")) return ColorSupport.Xterm256;
+            if (terminal is "DUMB" or "UNKNOWN" or "VT100") return ColorSupport.None;
+
+            return Client.ToUpperInvariant() switch
+            {
+                "MUDLET" or "TINTIN++" or "MUSHCLIENT" or "BLOWTORCH" => ColorSupport.Xterm256,
+                _ => ColorSupport.Ansi
+            };
+        }
+    }
+}
+
+/// <summary>
+/// TTYPE (telnet option 24) with the MTTS convention: the server asks for
+/// the terminal type up to three times, and the answers are the client
+/// name, the terminal type and "MTTS n". A client that repeats an answer
+/// has nothing more to say. The connection sends TTYPE SEND while
+/// Reply() asks for more.
+/// </summary>
+public sealed class TerminalTypeNegotiation
+{
+    public const byte Option = 24;
+    private const byte Is = 0;
+    private const byte Send = 1;
+
+    /// <summary>
+    /// IAC SB TTYPE SEND IAC SE.
+    /// </summary>
+    public static readonly byte[] SendRequest =
+        { TelnetParser.IAC, TelnetParser.SB, Option, Send, TelnetParser.IAC, TelnetParser.SE };
+
+    private readonly List<string> _answers = new(3);
+
+    /// <summary>
+    /// The result once negotiation is over; null until then.
+    /// </summary>
+    public TerminalInfo? Result { get; private set; }
+
+    /// <summary>
+    /// Take the payload of an IAC SB TTYPE ... IAC SE from the client.
+    /// Returns true to ask again, false once Result is set (or the payload
+    /// isn't an IS answer).
+    /// </summary>
+    public bool Reply(ReadOnlySpan<byte> data)
+    {
+        if (Result != null || data.Length == 0 || data[0] != Is) return false;
+
+        var answer = Encoding.ASCII.GetString(data[1..]).Trim();
+        bool repeated = _answers.Count > 0 && answer == _answers[^1];
+        if (!repeated)
+        {
+            _answers.Add(answer);
+        }
+
+        int mtts = 0;
+        bool isMtts = answer.StartsWith("MTTS ", StringComparison.OrdinalIgnoreCase) &&
+                      int.TryParse(answer.AsSpan(5), out mtts);
+        if (!repeated && !isMtts && _answers.Count < 3) return true;
+
+        // "MTTS n" is the third answer; a client that stops early has just a name or a name and a type
+        var client = _answers[0];
+        var terminal = _answers.Count > 1 && !IsMtts(_answers[1]) ? _answers[1] : client;
+        Result = new TerminalInfo(client, terminal, isMtts ? mtts : 0);
+        return false;
+    }
+
+    private static bool IsMtts(string answer) => answer.StartsWith("MTTS ", StringComparison.OrdinalIgnoreCase);
+}
@@ -0,0 +1,160 @@
+namespace Driver;
+
+/// <summary>
+/// How a tick spends its time when there is more work than fits.
+///
+/// Work runs in order of how much a player would notice it waiting: commands
+/// first, then callouts (a spell's delayed effect, a door closing), then
+/// heartbeats, then resets, saves and clean-up. Once the tick has used
+/// BackgroundShare of its interval, the deferrable work waits for a later
+/// tick instead of making this one late:
+///
+/// - A heartbeat turn (one bucket of the rotation) is owed every tick and
+///   run when there is room. Turns left owed make every object's period
+///   longer rather than dropping beats; a quiet tick catches up several at
+///   once. However busy the loop, a turn runs at least every
+///   MaxHeartbeatStretch ticks, and no more than a full rotation is ever
+///   owed.
+/// - Resets and periodic jobs run when there is room, or once they have
+///   waited MaxDeferTicks.
+///
+/// Lag is how late ticks are ending, smoothed, plus the heartbeat turns
+/// owed, so players can see when the world is running slow.
+///
+/// Used on the game thread only.
+/// </summary>
+public sealed class TickBudget
+{
+    /// <summary>
+    /// Most ticks in a row without a heartbeat turn.
+    /// </summary>
+    public const int MaxHeartbeatStretch = 2;
+
+    /// <summary>
+    /// Most heartbeat turns one tick runs when catching up.
+    /// </summary>
+    public const int MaxHeartbeatTurnsPerTick = 4;
+
+    /// <summary>
+    /// Longest a deferrable job waits for room, in ticks.
+    /// </summary>
+    public const int MaxDeferTicks = 50;
+
+    private readonly int _tickMs;
+    private readonly int _heartbeatRotation;
+    private readonly Func<double> _clockMs;
+    private double _tickStart;
+    private int _heartbeatsOwed;
+    private int _turnsThisTick;
+    private int _ticksWithoutTurn;
+    private double _lateMs;
+
+    /// <param name="tickMs">The tick interval</param>
+    /// <param name="heartbeatRotation">Heartbeat turns in a full rotation</param>
+    /// <param name="clockMs">Milliseconds on a monotonic clock</param>
+    public TickBudget(int tickMs, int heartbeatRotation, Func<double> clockMs)
+    {
+        _tickMs = tickMs;
+        _heartbeatRotation = heartbeatRotation;
+        _clockMs = clockMs;
+    }
+
+    /// <summary>
+    /// Share of the tick interval after which deferrable work waits.
+    /// </summary>
+    public double BackgroundShare { get; set; } = 0.7;
+
+    /// <summary>
+    /// Whether this tick has time left for deferrable work.
+    /// </summary>
+    public bool HasRoom => Elapsed < _tickMs * BackgroundShare;
+
+    /// <summary>
+    /// Milliseconds since this tick began.
+    /// </summary>
+    public double Elapsed => _clockMs() - _tickStart;
+
+    /// <summary>
+    /// Heartbeat turns owed but not yet run.
+    /// </summary>
+    public int HeartbeatsOwed => _heartbeatsOwed;
+
+    /// <summary>
+    /// Heartbeat turns owed from earlier ticks, not counting this one's.
+    /// </summary>
+    public int HeartbeatsBehind => Math.Max(0, _heartbeatsOwed - 1);
+
+    /// <summary>
+    /// Heartbeat turns given up for being more than a rotation behind.
+    /// </summary>
+    public long HeartbeatTurnsDropped { get; private set; }
+
+    /// <summary>
+    /// Deferrable jobs put off to a later tick.
+    /// </summary>
+    public long Deferrals { get; private set; }
+
+    /// <summary>
+    /// How far behind the world is running, in milliseconds: smoothed tick
+    /// lateness plus the heartbeat time owed.
+    /// </summary>
+    public long LagMs => (long)_lateMs + (long)HeartbeatsBehind * _tickMs;
+
+    /// <summary>
+    /// Start a tick; it owes one more heartbeat turn.
+    /// </summary>
+    public void BeginTick()
+    {
+        _tickStart = _clockMs();
+        _turnsThisTick = 0;
+        if (_heartbeatsOwed < _heartbeatRotation)
+        {
+            _heartbeatsOwed++;
+        }
+        else
+        {
+            HeartbeatTurnsDropped++;
+        }
+    }
+
+    /// <summary>
+    /// Whether to run another heartbeat turn now. Call until false.
+    /// </summary>
+    public bool NextHeartbeatTurn()
+    {
+        if (_heartbeatsOwed == 0 || _turnsThisTick == MaxHeartbeatTurnsPerTick) return false;
+
+        bool overdue = _turnsThisTick == 0 && _ticksWithoutTurn + 1 >= MaxHeartbeatStretch;
+        if (!HasRoom && !overdue)
+        {
+            if (_turnsThisTick == 0) Deferrals++;
+            return false;
+        }
+
+        _heartbeatsOwed--;
+        _turnsThisTick++;
+        return true;
+    }
+
+    /// <summary>
+    /// Whether a deferrable job that has waited waitedTicks may run now.
+    /// </summary>
+    public bool MayRun(long waitedTicks)
+    {
+        if (HasRoom || waitedTicks >= MaxDeferTicks) return true;
+        Deferrals++;
+        return false;
+    }
+
+    /// <summary>
+    /// Finish the tick, before sleeping until the next one.
+    /// </summary>
+    public void EndTick()
+    {
+        _ticksWithoutTurn = _turnsThisTick > 0 ? 0 : _ticksWithoutTurn + 1;
+
+        // Smoothed over about ten ticks, so one slow tick doesn't read as lag
+        double late = Math.Max(0, Elapsed - _tickMs);
+        _lateMs += (late - _lateMs) * 0.1;
+    }
+}
@@ -0,0 +1,462 @@
+using System.Diagnostics;
+
+namespace Driver;
+
+/// <summary>
+/// The parts of a game tick the profiler times separately.
+/// </summary>
+public enum TickPhase
+{
+    Commands,
+    Heartbeats,
+    Timers,
+    Saves,
+    Reloads
+}
+
+/// <summary>
+/// Built-in game loop instrumentation.
+///
+/// Every tick records how long each phase took into log2 histograms, counts
+/// ticks that ran past their budget, and remembers the LPC calls it made
+/// (command, heart_beat, callout, reset). When a tick overruns, the calls are
+/// summed by object and function and the worst few are kept as a slow-tick
+/// report, so a lag spike can be traced to the code that caused it.
+///
+/// Allocations are counted the same way, from the allocating thread's own
+/// counter: bytes per phase (the game thread's), bytes per call (wherever
+/// the call ran), and totals per program and function for the top
+/// allocators. Garbage collections that happened during a tick are counted
+/// by generation, so spikes can be lined up with gen2 collections.
+///
+/// Recording happens on the game thread without locks; results are published
+/// once per tick under a lock so other threads can read a consistent snapshot.
+/// </summary>
+public sealed class TickProfiler
+{
+    /// <summary>
+    /// Histogram bucket i counts samples under 2^i microseconds; the last
+    /// bucket takes everything from ~0.5s up.
+    /// </summary>
+    public const int HistogramBuckets = 20;
+
+    /// <summary>
+    /// Slow-tick reports kept (oldest dropped first).
+    /// </summary>
+    public const int MaxSlowTicks = 10;
+
+    /// <summary>
+    /// Calls named per slow-tick report.
+    /// </summary>
+    public const int TopCalls = 5;
+
+    /// <summary>
+    /// Verbs given their own command latency histogram; any more share "other".
+    /// </summary>
+    public const int MaxCommandVerbs = 200;
+
+    /// <summary>
+    /// Program and function pairs whose allocations are totalled; any more
+    /// share "other".
+    /// </summary>
+    public const int MaxAllocators = 500;
+
+    private static readonly int PhaseCount = Enum.GetValues<TickPhase>().Length;
+
+    /// <summary>
+    /// Timing distribution of one measurement, in microseconds.
+    /// </summary>
+    public sealed class Histogram
+    {
+        private readonly long[] _buckets = new long[HistogramBuckets];
+
+        public long Count { get; private set; }
+        public long TotalMicroseconds { get; private set; }
+        public long MaxMicroseconds { get; private set; }
+
+        public long AverageMicroseconds => Count == 0 ? 0 : TotalMicroseconds / Count;
+
+        public void Record(long microseconds)
+        {
+            int bucket = microseconds <= 0 ? 0 : Math.Min(HistogramBuckets - 1, 64 - (int)long.LeadingZeroCount(microseconds));
+            _buckets[bucket]++;
+            Count++;
+            TotalMicroseconds += microseconds;
+            MaxMicroseconds = Math.Max(MaxMicroseconds, microseconds);
+        }
+
+        /// <summary>
+        /// Upper bound of the bucket holding the given percentile (0-100).
+        /// </summary>
+        public long Percentile(double percentile)
+        {
+            if (Count == 0) return 0;
+
+            long target = (long)Math.Ceiling(Count * percentile / 100.0);
+            long seen = 0;
+            for (int i = 0; i < HistogramBuckets; i++)
+            {
+                seen += _buckets[i];
+                if (seen >= target)
+                {
+                    return i == HistogramBuckets - 1 ? MaxMicroseconds : Math.Min(1L << i, MaxMicroseconds);
+                }
+            }
+            return MaxMicroseconds;
+        }
+
+        /// <summary>
+        /// Samples in bucket i: under 2^i microseconds, and at least 2^(i-1)
+        /// except in bucket 0.
+        /// </summary>
+        public long BucketCount(int bucket) => _buckets[bucket];
+
+        public void Clear()
+        {
+            Array.Clear(_buckets);
+            Count = 0;
+            TotalMicroseconds = 0;
+            MaxMicroseconds = 0;
+        }
+    }
+
+    /// <summary>
+    /// Time spent in one object's function during a slow tick.
+    /// </summary>
+    public record CallCost(string Object, string Function, int Calls, long Microseconds, long Bytes = 0);
+
+    /// <summary>
+    /// Bytes a program's function allocated since startup, over all objects.
+    /// </summary>
+    public record Allocator(string Program, string Function, long Calls, long Bytes);
+
+    /// <summary>
+    /// Garbage collections that ran during ticks, by generation, and ticks
+    /// that had a gen2 collection.
+    /// </summary>
+    public record GcCounts(long Gen0, long Gen1, long Gen2, long Gen2Ticks);
+
+    /// <summary>
+    /// A tick that overran its budget.
+    /// </summary>
+    public record SlowTick(DateTime When, long Microseconds, long[] PhaseMicroseconds, List<CallCost> TopCalls,
+        long[] PhaseBytes, int[] Collections);
+
+    private readonly struct CallSample
+    {
+        public readonly string Object;
+        public readonly string Function;
+        public readonly long Elapsed;
+        public readonly long Bytes;
+
+        public CallSample(string obj, string function, long elapsed, long bytes)
+        {
+            Object = obj;
+            Function = function;
+            Elapsed = elapsed;
+            Bytes = bytes;
+        }
+    }
+
+    private readonly object _lock = new();
+    private readonly Histogram _tick = new();
+    private readonly Histogram[] _phases;
+    private readonly Queue<SlowTick> _slowTicks = new();
+    private readonly Dictionary<string, Histogram> _commands = new();
+    private readonly long[] _phaseBytesTotal;
+    private readonly Dictionary<(string, string), (long Calls, long Bytes)> _allocators = new();
+    private readonly long[] _collections = new long[3];
+    private long _gen2Ticks;
+    private long _ticks;
+    private long _overruns;
+
+    // Current tick (game thread only)
+    private long _tickStart;
+    private readonly long[] _phaseElapsed;
+    private readonly long[] _phaseBytes;
+    private long _phaseAllocStart;
+    private readonly int[] _collectionsAtStart = new int[3];
+    private readonly List<CallSample> _calls = new();
+
+    /// <summary>
+    /// Tick budget; a tick that takes longer counts as an overrun.
+    /// </summary>
+    public long BudgetMicroseconds { get; }
+
+    public TickProfiler(int tickIntervalMs)
+    {
+        BudgetMicroseconds = tickIntervalMs * 1000L;
+        _phases = new Histogram[PhaseCount];
+        for (int i = 0; i < PhaseCount; i++)
+        {
+            _phases[i] = new Histogram();
+        }
+        _phaseElapsed = new long[PhaseCount];
+        _phaseBytes = new long[PhaseCount];
+        _phaseBytesTotal = new long[PhaseCount];
+    }
+
+    private static long ToMicroseconds(long elapsedTimestamp)
+    {
+        return elapsedTimestamp * 1_000_000 / Stopwatch.Frequency;
+    }
+
+    /// <summary>
+    /// Start timing a tick. Returns the timestamp the first phase starts from.
+    /// </summary>
+    public long BeginTick()
+    {
+        _tickStart = Stopwatch.GetTimestamp();
+        Array.Clear(_phaseElapsed);
+        Array.Clear(_phaseBytes);
+        _calls.Clear();
+        for (int generation = 0; generation < 3; generation++)
+        {
+            _collectionsAtStart[generation] = GC.CollectionCount(generation);
+        }
+        _phaseAllocStart = GC.GetAllocatedBytesForCurrentThread();
+        return _tickStart;
+    }
+
+    /// <summary>
+    /// Charge the time since phaseStart to a phase. Returns the current
+    /// timestamp, which is where the next phase starts.
+    /// </summary>
+    public long EndPhase(TickPhase phase, long phaseStart)
+    {
+        var now = Stopwatch.GetTimestamp();
+        _phaseElapsed[(int)phase] += now - phaseStart;
+        long allocated = GC.GetAllocatedBytesForCurrentThread();
+        _phaseBytes[(int)phase] += allocated - _phaseAllocStart;
+        _phaseAllocStart = allocated;
+        return now;
+    }
+
+    /// <summary>
+    /// Record a top-level LPC call the game loop made this tick (a command,
+    /// heart_beat, callout or reset); callStart is
+    /// Stopwatch.GetTimestamp() from just before the call.
+    /// </summary>
+    public void RecordCall(string objectName, string function, long callStart)
+    {
+        RecordCall(objectName, function, callStart, Stopwatch.GetTimestamp());
+    }
+
+    /// <summary>
+    /// Record a call timed elsewhere (on a region worker), from and to
+    /// Stopwatch timestamps, that allocated bytes on the thread it ran on.
+    /// </summary>
+    public void RecordCall(string objectName, string function, long callStart, long callEnd, long bytes = 0)
+    {
+        _calls.Add(new CallSample(objectName, function, callEnd - callStart, bytes));
+    }
+
+    /// <summary>
+    /// Finish the tick: publish its timings and, if it overran, a slow-tick
+    /// report. Returns that report, or null for a tick within budget.
+    /// </summary>
+    public SlowTick? EndTick()
+    {
+        long total = ToMicroseconds(Stopwatch.GetTimestamp() - _tickStart);
+        SlowTick? slow = null;
+
+        var collections = new int[3];
+        for (int generation = 0; generation < 3; generation++)
+        {
+            collections[generation] = GC.CollectionCount(generation) - _collectionsAtStart[generation];
+        }
+
+        if (total > BudgetMicroseconds)
+        {
+            var phases = new long[PhaseCount];
+            for (int i = 0; i < PhaseCount; i++)
+            {
+                phases[i] = ToMicroseconds(_phaseElapsed[i]);
+            }
+            slow = new SlowTick(DateTime.UtcNow, total, phases, SummarizeCalls(), (long[])_phaseBytes.Clone(), collections);
+        }
+
+        lock (_lock)
+        {
+            _ticks++;
+            _tick.Record(total);
+            for (int i = 0; i < PhaseCount; i++)
+            {
+                _phases[i].Record(ToMicroseconds(_phaseElapsed[i]));
+                _phaseBytesTotal[i] += _phaseBytes[i];
+            }
+            for (int generation = 0; generation < 3; generation++)
+            {
+                _collections[generation] += collections[generation];
+            }
+            if (collections[2] > 0)
+            {
+                _gen2Ticks++;
+            }
+            foreach (var call in _calls)
+            {
+                if (call.Bytes > 0)
+                {
+                    AddAllocation(call);
+                }
+            }
+
+            if (slow != null)
+            {
+                _overruns++;
+                _slowTicks.Enqueue(slow);
+                if (_slowTicks.Count > MaxSlowTicks)
+                {
+                    _slowTicks.Dequeue();
+                }
+            }
+        }
+
+        return slow;
+    }
+
+    private List<CallCost> SummarizeCalls()
+    {
+        var byCall = new Dictionary<(string, string), (int Calls, long Elapsed, long Bytes)>();
+        foreach (var call in _calls)
+        {
+            byCall.TryGetValue((call.Object, call.Function), out var sum);
+            byCall[(call.Object, call.Function)] = (sum.Calls + 1, sum.Elapsed + call.Elapsed, sum.Bytes + call.Bytes);
+        }
+
+        return byCall
+            .OrderByDescending(kvp => kvp.Value.Elapsed)
+            .Take(TopCalls)
+            .Select(kvp => new CallCost(kvp.Key.Item1, kvp.Key.Item2, kvp.Value.Calls, ToMicroseconds(kvp.Value.Elapsed), kvp.Value.Bytes))
+            .ToList();
+    }
+
+    /// <summary>
+    /// Add a call's bytes to its program's total: clones count as their
+    /// blueprint, commands by verb. Caller holds _lock.
+    /// </summary>
+    private void AddAllocation(CallSample call)
+    {
+        int hash = call.Object.IndexOf('#');
+        var key = (hash < 0 ? call.Object : call.Object[..hash], call.Function);
+        if (!_allocators.ContainsKey(key) && _allocators.Count >= MaxAllocators)
+        {
+            key = ("other", "other");
+        }
+        _allocators.TryGetValue(key, out var sum);
+        _allocators[key] = (sum.Calls + 1, sum.Bytes + call.Bytes);
+    }
+
+    /// <summary>
+    /// Bytes the game thread allocated in each phase since startup, indexed by TickPhase.
+    /// </summary>
+    public long[] PhaseBytes
+    {
+        get { lock (_lock) { return (long[])_phaseBytesTotal.Clone(); } }
+    }
+
+    /// <summary>
+    /// Collections during ticks since startup.
+    /// </summary>
+    public GcCounts Collections
+    {
+        get { lock (_lock) { return new GcCounts(_collections[0], _collections[1], _collections[2], _gen2Ticks); } }
+    }
+
+    /// <summary>
+    /// The count programs and functions that allocated the most since startup.
+    /// </summary>
+    public List<Allocator> TopAllocators(int count)
+    {
+        lock (_lock)
+        {
+            return _allocators
+                .OrderByDescending(kvp => kvp.Value.Bytes)
+                .Take(count)
+                .Select(kvp => new Allocator(kvp.Key.Item1, kvp.Key.Item2, kvp.Value.Calls, kvp.Value.Bytes))
+                .ToList();
+        }
+    }
+
+    /// <summary>
+    /// Ticks timed since startup (or the last Clear).
+    /// </summary>
+    public long Ticks
+    {
+        get { lock (_lock) { return _ticks; } }
+    }
+
+    /// <summary>
+    /// Ticks that ran past BudgetMicroseconds.
+    /// </summary>
+    public long Overruns
+    {
+        get { lock (_lock) { return _overruns; } }
+    }
+
+    /// <summary>
+    /// Read the stats under the profiler's lock. The histograms passed to the
+    /// callback must not be kept.
+    /// </summary>
+    public T Read<T>(Func<Histogram, IReadOnlyList<Histogram>, IReadOnlyCollection<SlowTick>, T> reader)
+    {
+        lock (_lock)
+        {
+            return reader(_tick, _phases, _slowTicks);
+        }
+    }
+
+    /// <summary>
+    /// Record a player command's latency, from being queued to having run.
+    /// </summary>
+    public void RecordCommand(string verb, TimeSpan latency)
+    {
+        lock (_lock)
+        {
+            if (!_commands.TryGetValue(verb, out var histogram))
+            {
+                if (_commands.Count >= MaxCommandVerbs) verb = "other";
+                if (!_commands.TryGetValue(verb, out histogram))
+                {
+                    _commands[verb] = histogram = new Histogram();
+                }
+            }
+            histogram.Record((long)latency.TotalMicroseconds);
+        }
+    }
+
+    /// <summary>
+    /// Read the per-verb command latencies under the profiler's lock. The
+    /// histograms passed to the callback must not be kept.
+    /// </summary>
+    public T ReadCommands<T>(Func<IReadOnlyDictionary<string, Histogram>, T> reader)
+    {
+        lock (_lock)
+        {
+            return reader(_commands);
+        }
+    }
+
+    /// <summary>
+    /// Forget everything recorded so far.
+    /// </summary>
+    public void Clear()
+    {
+        lock (_lock)
+        {
+            _ticks = 0;
+            _overruns = 0;
+            _tick.Clear();
+            foreach (var phase in _phases)
+            {
+                phase.Clear();
+            }
+            _slowTicks.Clear();
+            _commands.Clear();
+            Array.Clear(_phaseBytesTotal);
+            Array.Clear(_collections);
+            _gen2Ticks = 0;
+            _allocators.Clear();
+        }
+    }
+}
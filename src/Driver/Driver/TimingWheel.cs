@@ -0,0 +1,266 @@
+namespace Driver;
+
+/// <summary>
+/// Hierarchical timing wheel keyed by game tick.
+///
+/// Timers live in intrusive linked lists hung off wheel slots, so scheduling
+/// and cancelling are O(1) and a tick with nothing due costs one empty-slot
+/// check. The innermost wheel has one slot per tick for the next 256 ticks;
+/// each outer wheel has 64 slots, each covering a whole turn of the wheel
+/// inside it. When an inner wheel wraps, the next outer slot is cascaded down.
+/// With 10 ticks per second the wheels cover ~25s, ~27m, ~29h and ~77d; later
+/// due times are clamped to the outermost wheel's range.
+///
+/// Not thread-safe: callers hold their own lock.
+/// </summary>
+public sealed class TimingWheel<T>
+{
+    private const int RootBits = 8;
+    private const int LevelBits = 6;
+    private const int RootSize = 1 << RootBits;
+    private const int LevelSize = 1 << LevelBits;
+    private const int OuterLevels = 4;
+    private const long MaxDelay = (1L << (RootBits + OuterLevels * LevelBits)) - 1;
+
+    /// <summary>
+    /// A scheduled value. Handles stay valid after firing or cancelling and can
+    /// be rescheduled.
+    /// </summary>
+    public sealed class Timer
+    {
+        public T Value { get; }
+
+        /// <summary>
+        /// Tick the timer fires on (meaningful while IsScheduled).
+        /// </summary>
+        public long DueTick { get; internal set; }
+
+        public bool IsScheduled => _slot != null;
+
+        internal Timer? _next;
+        internal Timer? _previous;
+        internal Slot? _slot;
+        internal long _sequence;
+
+        internal Timer(T value)
+        {
+            Value = value;
+        }
+    }
+
+    internal sealed class Slot
+    {
+        public Timer? Head;
+        public Timer? Tail;
+    }
+
+    private readonly Slot[] _root = CreateSlots(RootSize);
+    private readonly Slot[][] _levels = new Slot[OuterLevels][];
+    private readonly List<Timer> _cascade = new();
+    private readonly List<Timer> _firing = new();
+    private long _nextSequence;
+
+    /// <summary>
+    /// The next tick Advance() will process. Timers due before it fire on it.
+    /// </summary>
+    public long CurrentTick { get; private set; }
+
+    /// <summary>
+    /// Number of scheduled timers.
+    /// </summary>
+    public int Count { get; private set; }
+
+    public TimingWheel(long startTick = 0)
+    {
+        CurrentTick = startTick;
+        for (int i = 0; i < OuterLevels; i++)
+        {
+            _levels[i] = CreateSlots(LevelSize);
+        }
+    }
+
+    private static Slot[] CreateSlots(int count)
+    {
+        var slots = new Slot[count];
+        for (int i = 0; i < count; i++)
+        {
+            slots[i] = new Slot();
+        }
+        return slots;
+    }
+
+    /// <summary>
+    /// Schedule a value to fire on dueTick.
+    /// </summary>
+    public Timer Schedule(T value, long dueTick)
+    {
+        var timer = new Timer(value);
+        Reschedule(timer, dueTick);
+        return timer;
+    }
+
+    /// <summary>
+    /// Move a timer to a new due tick, scheduling it if it had fired or been cancelled.
+    /// </summary>
+    public void Reschedule(Timer timer, long dueTick)
+    {
+        Cancel(timer);
+        timer.DueTick = Math.Max(dueTick, CurrentTick);
+        timer._sequence = _nextSequence++;
+        Insert(timer);
+        Count++;
+    }
+
+    /// <summary>
+    /// Unschedule a timer. Returns false if it wasn't scheduled.
+    /// </summary>
+    public bool Cancel(Timer timer)
+    {
+        if (timer._slot == null) return false;
+
+        Unlink(timer);
+        Count--;
+        return true;
+    }
+
+    /// <summary>
+    /// Process every tick up to and including nowTick, appending the values
+    /// that fired to due in firing order (by due tick, then scheduling order).
+    /// </summary>
+    public void Advance(long nowTick, List<T> due)
+    {
+        while (CurrentTick <= nowTick)
+        {
+            // Nothing scheduled: jump straight to nowTick
+            if (Count == 0)
+            {
+                CurrentTick = nowTick + 1;
+                return;
+            }
+
+            int index = (int)(CurrentTick & (RootSize - 1));
+            if (index == 0)
+            {
+                Cascade();
+            }
+
+            var slot = _root[index];
+            if (slot.Head != null)
+            {
+                for (var timer = slot.Head; timer != null; timer = timer._next)
+                {
+                    _firing.Add(timer);
+                }
+                foreach (var timer in _firing)
+                {
+                    Unlink(timer);
+                }
+                Count -= _firing.Count;
+
+                // Cascaded timers join the slot after directly scheduled ones
+                if (_firing.Count > 1)
+                {
+                    _firing.Sort(static (a, b) => a._sequence.CompareTo(b._sequence));
+                }
+                foreach (var timer in _firing)
+                {
+                    due.Add(timer.Value);
+                }
+                _firing.Clear();
+            }
+
+            CurrentTick++;
+        }
+    }
+
+    /// <summary>
+    /// The root wheel wrapped: pull the next slot of each outer wheel that
+    /// also wrapped down into the wheels inside it.
+    /// </summary>
+    private void Cascade()
+    {
+        for (int level = 0; level < OuterLevels; level++)
+        {
+            int shift = RootBits + level * LevelBits;
+            int index = (int)((CurrentTick >> shift) & (LevelSize - 1));
+
+            var slot = _levels[level][index];
+            for (var timer = slot.Head; timer != null; timer = timer._next)
+            {
+                _cascade.Add(timer);
+            }
+            foreach (var timer in _cascade)
+            {
+                Unlink(timer);
+                Insert(timer);
+            }
+            _cascade.Clear();
+
+            // Only carry on outwards when this wheel wrapped too
+            if (index != 0) break;
+        }
+    }
+
+    private void Insert(Timer timer)
+    {
+        long delay = timer.DueTick - CurrentTick;
+        if (delay > MaxDelay)
+        {
+            timer.DueTick = CurrentTick + MaxDelay;
+            delay = MaxDelay;
+        }
+
+        Slot slot;
+        if (delay < RootSize)
+        {
+            slot = _root[timer.DueTick & (RootSize - 1)];
+        }
+        else
+        {
+            int level = 0;
+            while (level < OuterLevels - 1 && delay >= 1L << (RootBits + (level + 1) * LevelBits))
+            {
+                level++;
+            }
+            int shift = RootBits + level * LevelBits;
+            slot = _levels[level][(timer.DueTick >> shift) & (LevelSize - 1)];
+        }
+
+        timer._slot = slot;
+        timer._next = null;
+        timer._previous = slot.Tail;
+        if (slot.Tail != null)
+        {
+            slot.Tail._next = timer;
+        }
+        else
+        {
+            slot.Head = timer;
+        }
+        slot.Tail = timer;
+    }
+
+    private static void Unlink(Timer timer)
+    {
+        var slot = timer._slot!;
+        if (timer._previous != null)
+        {
+            timer._previous._next = timer._next;
+        }
+        else
+        {
+            slot.Head = timer._next;
+        }
+        if (timer._next != null)
+        {
+            timer._next._previous = timer._previous;
+        }
+        else
+        {
+            slot.Tail = timer._previous;
+        }
+        timer._next = null;
+        timer._previous = null;
+        timer._slot = null;
+    }
+}
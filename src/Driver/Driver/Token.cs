@@ -113,8 +113,16 @@ public enum TokenType
     Eof,
 }
 
-public record Token(TokenType Type, string Lexeme, int Line, int Column)
+/// <summary>
+/// One token. A struct, so the lexer's output is a flat array rather than an
+/// object per token. Lexeme is shared: punctuation uses constant strings and
+/// each distinct identifier, keyword or number text is allocated once per
+/// file. Offset is where the token starts in the source.
+/// </summary>
+public readonly record struct Token(TokenType Type, string Lexeme, int Line, int Column)
 {
+    public int Offset { get; init; }
+
     public override string ToString() => Type switch
     {
         TokenType.Number => $"NUMBER({Lexeme})",
@@ -0,0 +1,234 @@
+using System.Collections.Concurrent;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// The execution state of one LPC call chain: this_object(), the call and
+/// scope stacks, error position and instruction counts.
+///
+/// An ObjectInterpreter keeps one VmThread per OS thread that runs LPC on it,
+/// so several threads can be inside the same interpreter (and the same
+/// compiled programs) at once without seeing each other's frames. VmThreads
+/// come from a shared pool and go back to it when a thread is done with LPC,
+/// along with the scope dictionaries they cached.
+/// </summary>
+public sealed class VmThread
+{
+    /// <summary>
+    /// Idle VmThreads kept for reuse.
+    /// </summary>
+    private const int MaxPooled = 64;
+
+    /// <summary>
+    /// Scope dictionaries kept per VmThread for tree-walked calls.
+    /// </summary>
+    private const int MaxPooledScopes = 32;
+
+    /// <summary>
+    /// Capacity Builder is cut back to after a long string.
+    /// </summary>
+    private const int MaxBuilderCapacity = 4096;
+
+    private static readonly ConcurrentBag<VmThread> Pool = new();
+
+    private readonly Stack<Dictionary<string, object?>> _freeScopes = new();
+
+    /// <summary>
+    /// The current object whose code is being executed.
+    /// This is the "this_object()" context.
+    /// </summary>
+    public MudObject CurrentObject = null!;
+
+    /// <summary>
+    /// Call stack for tracking function calls across objects.
+    /// Top of stack is the most recent caller.
+    /// Used for previous_object() efun.
+    /// </summary>
+    public readonly Stack<MudObject> CallStack = new();
+
+    /// <summary>
+    /// Local variable scopes for function parameters and local variables.
+    /// Stack of dictionaries - one per function call depth.
+    /// Top of stack is the current function's local scope.
+    /// </summary>
+    public readonly Stack<Dictionary<string, object?>> LocalScopes = new();
+
+    /// <summary>
+    /// One entry per LPC function call in flight, innermost on top. This is
+    /// the only per-call bookkeeping: the current file, the program :: calls
+    /// search from, the recursion depth and the stack trace are all read off
+    /// it when needed.
+    /// </summary>
+    public readonly Stack<CallFrame> Frames = new();
+
+    /// <summary>
+    /// Program of the innermost executing function, or null outside any call.
+    /// Used for correct :: (parent call) behavior in inheritance chains: when
+    /// function A from program X calls ::foo(), we search from X's
+    /// inheritance chain, not from CurrentObject's program.
+    /// </summary>
+    public LpcProgram? ExecutingProgram
+    {
+        get
+        {
+            foreach (var frame in Frames)
+            {
+                if (frame.Program != null) return frame.Program;
+            }
+            return null;
+        }
+    }
+
+    /// <summary>
+    /// File and line to report for a line of the innermost executing
+    /// function (for error messages).
+    /// </summary>
+    public (string File, int Line) Locate(int line) =>
+        Frames.TryPeek(out var frame) ? frame.Locate(line) : ("", line);
+
+    /// <summary>
+    /// Current instruction count for this execution context.
+    /// Reset at the start of each top-level command execution.
+    /// </summary>
+    public int InstructionCount;
+
+    /// <summary>
+    /// Instructions executed since this VmThread was created; never reset, so
+    /// the profiler can take differences across nested calls.
+    /// </summary>
+    public long InstructionsExecuted;
+
+    /// <summary>
+    /// Where the calls this thread makes are noted while a traced command
+    /// runs (see CommandLatency); null otherwise.
+    /// </summary>
+    public CallTrace? CallTrace;
+
+    // Share of InstructionsExecuted already added to _totalInstructions
+    private long _publishedInstructions;
+    private static long _totalInstructions;
+
+    /// <summary>
+    /// Set while this thread runs a heart_beat() speculatively (see
+    /// HeartbeatSandbox).
+    /// </summary>
+    public HeartbeatSandbox? Sandbox;
+
+    /// <summary>
+    /// Reused by the VM to join a chain of string +s.
+    /// </summary>
+    public readonly StringBuilder Builder = new();
+
+    private VmThread()
+    {
+    }
+
+    /// <summary>
+    /// A clean VmThread from the pool, or a new one.
+    /// </summary>
+    public static VmThread Rent()
+    {
+        return Pool.TryTake(out var vm) ? vm : new VmThread();
+    }
+
+    /// <summary>
+    /// Give a VmThread back to the pool. It must not be inside a call.
+    /// </summary>
+    public static void Return(VmThread vm)
+    {
+        if (vm.Frames.Count != 0)
+        {
+            throw new InvalidOperationException("Cannot return a VmThread with calls in flight");
+        }
+
+        vm.PublishInstructions();
+        vm.CurrentObject = null!;
+        vm.CallStack.Clear();
+        vm.LocalScopes.Clear();
+        vm.InstructionCount = 0;
+        vm.Sandbox = null;
+        vm.CallTrace = null;
+
+        if (Pool.Count < MaxPooled)
+        {
+            Pool.Add(vm);
+        }
+    }
+
+    /// <summary>
+    /// Instructions executed on every VmThread, up to the start of each one's
+    /// current top-level call (for metrics).
+    /// </summary>
+    public static long TotalInstructions => Interlocked.Read(ref _totalInstructions);
+
+    /// <summary>
+    /// Add the instructions run since the last call to TotalInstructions.
+    /// Done once per top-level call, so the hot path never touches the shared counter.
+    /// </summary>
+    public void PublishInstructions()
+    {
+        long executed = InstructionsExecuted;
+        if (executed != _publishedInstructions)
+        {
+            Interlocked.Add(ref _totalInstructions, executed - _publishedInstructions);
+            _publishedInstructions = executed;
+        }
+    }
+
+    /// <summary>
+    /// Number of idle VmThreads in the pool.
+    /// </summary>
+    public static int PooledCount => Pool.Count;
+
+    /// <summary>
+    /// Let go of a builder that grew big joining one long string.
+    /// </summary>
+    public void TrimBuilder()
+    {
+        if (Builder.Capacity > MaxBuilderCapacity)
+        {
+            Builder.Clear();
+            Builder.Capacity = MaxBuilderCapacity;
+        }
+    }
+
+    /// <summary>
+    /// An empty scope dictionary for a tree-walked call.
+    /// </summary>
+    public Dictionary<string, object?> RentScope()
+    {
+        return _freeScopes.TryPop(out var scope) ? scope : new Dictionary<string, object?>();
+    }
+
+    /// <summary>
+    /// Hand back a scope popped off LocalScopes.
+    /// </summary>
+    public void ReturnScope(Dictionary<string, object?> scope)
+    {
+        if (_freeScopes.Count < MaxPooledScopes)
+        {
+            scope.Clear();
+            _freeScopes.Push(scope);
+        }
+    }
+}
+
+/// <summary>
+/// A function call in flight: the function, the program that defines it
+/// (null for the legacy lookup path) and the object it runs on.
+/// </summary>
+public readonly record struct CallFrame(FunctionDefinition Function, LpcProgram? Program, MudObject Object)
+{
+    /// <summary>
+    /// The file reported in errors and traces: the defining program's, else the object's name.
+    /// </summary>
+    public string File => Program?.FilePath ?? Object.ObjectName;
+
+    /// <summary>
+    /// Where a line of this function's program really is: lines that came
+    /// from an #include are reported against the included file.
+    /// </summary>
+    public (string File, int Line) Locate(int line) =>
+        Program?.LineMap?.Resolve(line) ?? (File, line);
+}
@@ -0,0 +1,173 @@
+using System.Net.WebSockets;
+using System.Security.Cryptography;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// The server side of the WebSocket opening handshake (RFC 6455 section 4),
+/// so browser clients can connect to the driver directly instead of through
+/// a telnet proxy.
+///
+/// Reads the client's HTTP upgrade request off the stream, answers 101 and
+/// hands the stream to .NET's WebSocket. When asked to and the client offers
+/// it, permessage-deflate (RFC 7692) is agreed on; WebSocket then compresses
+/// every message, keeping the deflate context from one message to the next
+/// the way MCCP2 does for telnet.
+/// </summary>
+public static class WebSocketHandshake
+{
+    private const string AcceptGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+    /// <summary>
+    /// Longest request header accepted.
+    /// </summary>
+    public const int MaxRequestLength = 8192;
+
+    /// <summary>
+    /// Complete the handshake on stream. Returns the server-side WebSocket,
+    /// or null after answering a request that isn't a WebSocket upgrade.
+    /// </summary>
+    public static async Task<WebSocket?> AcceptAsync(Stream stream, bool offerDeflate, CancellationToken cancellationToken)
+    {
+        var headers = await ReadRequestAsync(stream, cancellationToken);
+        if (headers == null ||
+            !headers.TryGetValue("upgrade", out var upgrade) || !upgrade.Equals("websocket", StringComparison.OrdinalIgnoreCase) ||
+            !headers.TryGetValue("sec-websocket-key", out var key) ||
+            headers.GetValueOrDefault("sec-websocket-version") != "13")
+        {
+            await WriteAsync(stream, "HTTP/1.1 400 Bad Request\r\nSec-WebSocket-Version: 13\r\nConnection: close\r\nContent-Length: 0\r\n\r\n", cancellationToken);
+            return null;
+        }
+
+        var response = new StringBuilder();
+        response.Append("HTTP/1.1 101 Switching Protocols\r\n");
+        response.Append("Upgrade: websocket\r\n");
+        response.Append("Connection: Upgrade\r\n");
+        response.Append("Sec-WebSocket-Accept: ").Append(AcceptKey(key)).Append("\r\n");
+
+        WebSocketDeflateOptions? deflate = null;
+        if (offerDeflate && headers.TryGetValue("sec-websocket-extensions", out var extensions))
+        {
+            var agreed = NegotiateDeflate(extensions);
+            if (agreed != null)
+            {
+                deflate = agreed.Value.Options;
+                response.Append("Sec-WebSocket-Extensions: ").Append(agreed.Value.Response).Append("\r\n");
+            }
+        }
+        response.Append("\r\n");
+        await WriteAsync(stream, response.ToString(), cancellationToken);
+
+        return WebSocket.CreateFromStream(stream, new WebSocketCreationOptions
+        {
+            IsServer = true,
+            KeepAliveInterval = TimeSpan.FromSeconds(30),
+            DangerousDeflateOptions = deflate
+        });
+    }
+
+    /// <summary>
+    /// Sec-WebSocket-Accept for a client's Sec-WebSocket-Key.
+    /// </summary>
+    public static string AcceptKey(string key)
+    {
+        return Convert.ToBase64String(SHA1.HashData(Encoding.ASCII.GetBytes(key.Trim() + AcceptGuid)));
+    }
+
+    /// <summary>
+    /// Pick the first permessage-deflate offer in a Sec-WebSocket-Extensions
+    /// header that can be met. Returns the options to run with and the
+    /// extension to answer with, or null if there is none.
+    /// </summary>
+    public static (WebSocketDeflateOptions Options, string Response)? NegotiateDeflate(string extensions)
+    {
+        foreach (var offer in extensions.Split(','))
+        {
+            var parameters = offer.Split(';', StringSplitOptions.TrimEntries | StringSplitOptions.RemoveEmptyEntries);
+            if (parameters.Length == 0 || parameters[0] != "permessage-deflate") continue;
+
+            var options = new WebSocketDeflateOptions();
+            var response = new StringBuilder("permessage-deflate");
+            bool acceptable = true;
+
+            foreach (var parameter in parameters.Skip(1))
+            {
+                var (name, value) = parameter.IndexOf('=') is var eq and >= 0
+                    ? (parameter[..eq].Trim(), parameter[(eq + 1)..].Trim().Trim('"'))
+                    : (parameter, null);
+
+                switch (name)
+                {
+                    case "server_no_context_takeover":
+                        options.ServerContextTakeover = false;
+                        response.Append("; server_no_context_takeover");
+                        break;
+                    case "client_no_context_takeover":
+                        options.ClientContextTakeover = false;
+                        response.Append("; client_no_context_takeover");
+                        break;
+                    case "server_max_window_bits" when int.TryParse(value, out var bits) && bits is >= 9 and <= 15:
+                        options.ServerMaxWindowBits = bits;
+                        response.Append("; server_max_window_bits=").Append(bits);
+                        break;
+                    case "client_max_window_bits" when value == null:
+                        // The client can take a limit; it doesn't need one
+                        break;
+                    case "client_max_window_bits" when int.TryParse(value, out var bits) && bits is >= 9 and <= 15:
+                        options.ClientMaxWindowBits = bits;
+                        response.Append("; client_max_window_bits=").Append(bits);
+                        break;
+                    default:
+                        acceptable = false;
+                        break;
+                }
+            }
+
+            if (acceptable)
+            {
+                return (options, response.ToString());
+            }
+        }
+        return null;
+    }
+
+    /// <summary>
+    /// Read the request line and headers, a byte at a time so nothing after
+    /// them is consumed. Header names are lowercased. Null if the client hung
+    /// up or sent too much or something other than a GET.
+    /// </summary>
+    private static async Task<Dictionary<string, string>?> ReadRequestAsync(Stream stream, CancellationToken cancellationToken)
+    {
+        var request = new byte[MaxRequestLength];
+        int length = 0;
+        while (length < 4 || !request.AsSpan(length - 4, 4).SequenceEqual("\r\n\r\n"u8))
+        {
+            if (length == request.Length) return null;
+            if (await stream.ReadAsync(request.AsMemory(length, 1), cancellationToken) == 0) return null;
+            length++;
+        }
+
+        var lines = Encoding.ASCII.GetString(request, 0, length).Split("\r\n");
+        if (!lines[0].StartsWith("GET ", StringComparison.Ordinal)) return null;
+
+        var headers = new Dictionary<string, string>();
+        foreach (var line in lines.Skip(1))
+        {
+            int colon = line.IndexOf(':');
+            if (colon <= 0) continue;
+
+            var name = line[..colon].Trim().ToLowerInvariant();
+            var value = line[(colon + 1)..].Trim();
+            // Repeated headers combine as a list
+            headers[name] = headers.TryGetValue(name, out var earlier) ? earlier + ", " + value : value;
+        }
+        return headers;
+    }
+
+    private static async Task WriteAsync(Stream stream, string text, CancellationToken cancellationToken)
+    {
+        await stream.WriteAsync(Encoding.ASCII.GetBytes(text), cancellationToken);
+        await stream.FlushAsync(cancellationToken);
+    }
+}
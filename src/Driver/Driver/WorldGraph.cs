@@ -0,0 +1,206 @@
+namespace Driver;
+
+/// <summary>
+/// The map of the world: which room each exit leads to, kept by the driver
+/// so route finding doesn't walk exits in LPC.
+///
+/// Built at boot from every room under /world/rooms. A room that is loaded
+/// contributes its exit table; one that isn't contributes the visible exits
+/// its create() sets with literal add_exit()/set_exit() calls, read from the
+/// parsed source without loading the room. After that the
+/// graph follows set_exit(), so rooms loaded or changed later update their
+/// own edges. A room that is cleaned up keeps its edges; routes still pass
+/// through it.
+///
+/// Edges are unweighted, so a breadth-first search finds shortest routes.
+/// Each search from a room to a depth is cached and serves every find_path()
+/// and rooms_within() from there until an exit changes anywhere. Hidden exits
+/// are kept out of routes. Thread-safe.
+/// </summary>
+public sealed class WorldGraph
+{
+    public const string DefaultRoot = "/world/rooms";
+
+    private static readonly HashSet<string> ExitSetters = new() { "add_exit", "set_exit" };
+
+    /// <summary>
+    /// Where a search reached: each room's distance and the room and
+    /// direction it was reached from, and the rooms in the order found.
+    /// </summary>
+    private sealed record Reach(Dictionary<string, (string? From, string? Direction, int Distance)> Rooms, List<string> Order);
+
+    private readonly object _lock = new();
+    private readonly Dictionary<string, List<(string Direction, string Destination)>> _edges = new();
+    private readonly LruCache<(string From, int Depth, int Version), Reach> _searches = new(256);
+    private int _version;
+
+    /// <summary>
+    /// Rooms with at least one visible exit.
+    /// </summary>
+    public int RoomCount
+    {
+        get { lock (_lock) return _edges.Count; }
+    }
+
+    public int ExitCount
+    {
+        get { lock (_lock) return _edges.Values.Sum(exits => exits.Count); }
+    }
+
+    /// <summary>
+    /// Read every room under root: loaded ones from their exit tables, the
+    /// rest from their source. Files that don't parse are skipped.
+    /// </summary>
+    public void Build(ObjectManager objectManager, string root = DefaultRoot)
+    {
+        var rootDir = Path.Combine(objectManager.MudlibPath, root.Trim('/'));
+        if (!Directory.Exists(rootDir)) return;
+
+        foreach (var file in Directory.EnumerateFiles(rootDir, "*.c", SearchOption.AllDirectories))
+        {
+            var path = "/" + Path.GetRelativePath(objectManager.MudlibPath, file).Replace(Path.DirectorySeparatorChar, '/')[..^2];
+            var loaded = objectManager.FindObject(path);
+            if (loaded?.Exits != null)
+            {
+                Update(loaded);
+                continue;
+            }
+
+            try
+            {
+                SetExits(path, DeclaredExits(objectManager.ParseFile(path)));
+            }
+            catch (Exception ex)
+            {
+                Logger.Debug($"World graph: skipping {path}: {ex.Message}", LogCategory.Object);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Take a room's edges from its exit table.
+    /// </summary>
+    public void Update(MudObject room)
+    {
+        var exits = room.Exits?.All ?? Array.Empty<RoomExits.Exit>();
+        SetExits(room.ObjectName, exits.Where(exit => !exit.Hidden).Select(exit => (exit.Direction, exit.Path)));
+    }
+
+    /// <summary>
+    /// Replace a room's visible exits.
+    /// </summary>
+    public void SetExits(string room, IEnumerable<(string Direction, string Destination)> exits)
+    {
+        var list = exits.Select(exit => (exit.Direction, Normalize(exit.Destination))).ToList();
+        lock (_lock)
+        {
+            room = Normalize(room);
+            if (_edges.TryGetValue(room, out var old) && old.SequenceEqual(list)) return;
+
+            if (list.Count == 0) _edges.Remove(room);
+            else _edges[room] = list;
+            _version++;
+            _searches.Clear();
+        }
+    }
+
+    /// <summary>
+    /// The directions to walk from one room to another by the fewest steps,
+    /// at most maxDepth of them. Empty when from is to; null if there is no
+    /// such route.
+    /// </summary>
+    public List<string>? FindPath(string from, string to, int maxDepth)
+    {
+        from = Normalize(from);
+        to = Normalize(to);
+        var reach = Search(from, maxDepth);
+        if (!reach.Rooms.ContainsKey(to)) return null;
+
+        var directions = new List<string>();
+        for (var room = to; room != from;)
+        {
+            var (previous, direction, _) = reach.Rooms[room];
+            directions.Add(direction!);
+            room = previous!;
+        }
+        directions.Reverse();
+        return directions;
+    }
+
+    /// <summary>
+    /// Rooms within steps of room, nearest first, not counting room itself.
+    /// </summary>
+    public List<string> Within(string room, int steps)
+    {
+        var reach = Search(Normalize(room), steps);
+        return reach.Order.Skip(1).ToList();
+    }
+
+    private Reach Search(string from, int maxDepth)
+    {
+        maxDepth = Math.Max(maxDepth, 0);
+        int version;
+        lock (_lock) version = _version;
+
+        // A search that races a change is stored under the old version and never used
+        return _searches.GetOrAdd((from, maxDepth, version), key =>
+        {
+            var rooms = new Dictionary<string, (string?, string?, int)> { [key.From] = (null, null, 0) };
+            var order = new List<string> { key.From };
+            lock (_lock)
+            {
+                for (int i = 0; i < order.Count; i++)
+                {
+                    var room = order[i];
+                    int distance = rooms[room].Item3;
+                    if (distance == key.Depth || !_edges.TryGetValue(room, out var exits)) continue;
+
+                    foreach (var (direction, destination) in exits)
+                    {
+                        if (rooms.TryAdd(destination, (room, direction, distance + 1)))
+                        {
+                            order.Add(destination);
+                        }
+                    }
+                }
+            }
+            return new Reach(rooms, order);
+        });
+    }
+
+    /// <summary>
+    /// The visible exits set in a room's create() with literal arguments.
+    /// </summary>
+    public static IEnumerable<(string Direction, string Destination)> DeclaredExits(List<Statement> statements)
+    {
+        var create = statements.OfType<FunctionDefinition>().FirstOrDefault(function => function.Name == "create");
+        return create == null ? Array.Empty<(string, string)>() : CallsIn(create.Body);
+    }
+
+    private static IEnumerable<(string, string)> CallsIn(Statement statement)
+    {
+        switch (statement)
+        {
+            case BlockStatement block:
+                foreach (var inner in block.Statements)
+                {
+                    foreach (var exit in CallsIn(inner)) yield return exit;
+                }
+                break;
+            case ExpressionStatement { Expression: FunctionCall { IsParentCall: false } call }
+                when ExitSetters.Contains(call.Name) &&
+                     call.Arguments.Count >= 2 &&
+                     call.Arguments[0] is StringLiteral direction &&
+                     call.Arguments[1] is StringLiteral destination &&
+                     !(call.Arguments.Count >= 3 && call.Arguments[2] is not NumberLiteral { Value: 0 }):
+                yield return (RoomExits.Canonical(direction.Value), destination.Value);
+                break;
+        }
+    }
+
+    private static string Normalize(string path)
+    {
+        if (path.EndsWith(".c", StringComparison.Ordinal)) path = path[..^2];
+        return path.StartsWith('/') ? path : "/" + path;
+    }
+}
@@ -0,0 +1,451 @@
+using System.IO.MemoryMappedFiles;
+using System.Text;
+
+namespace Driver;
+
+/// <summary>
+/// A periodic picture of the world, so a restart comes back to the rooms,
+/// NPCs and items as they were rather than to a freshly created world.
+///
+/// What is kept: every loaded object but players, what they carry and
+/// shadows (players come back from their own save files); each object's
+/// variables and skills, environment, living name, declared ids, exits and heartbeat, reset
+/// and clean_up settings; and the pending callouts, effects and event
+/// subscriptions of the objects kept.
+///
+/// Capture runs on the game thread, so it sees one consistent world; the
+/// file itself is written by AsyncFileWriter. Most objects don't change
+/// between snapshots, so each object's variables and environment are kept
+/// encoded with the StateVersion they were encoded at and reused while it
+/// is unchanged. StateVersion doesn't see an array or mapping changed in
+/// place by another object's code, so every FullRewriteEvery-th snapshot
+/// encodes everything afresh.
+///
+/// Restore runs at boot, before the game loop starts. The file is mapped
+/// rather than read, and restored in two passes: the first makes every
+/// object (blueprints loaded without create(), clones under their old
+/// numbers), the second fills in variables, which may point at any of
+/// them, and moves each object into its environment. create() and reset()
+/// don't run; the objects already hold what they had set up.
+///
+/// Layout: "LPWS", version, object count, then per object (environments
+/// before their contents, contents in order) its name, flags, reset
+/// interval, living name, declared ids, room exits and a length-prefixed block of
+/// environment and variables in SaveFormat's binary encoding; then the
+/// callouts, each with its target, function, seconds left and arguments;
+/// then the effects, each with its target, owner, id, functions, interval
+/// and seconds left; then the event subscriptions, each with its source
+/// ("" for any source), event, subscriber and function.
+/// </summary>
+public sealed class WorldSnapshot
+{
+    private const uint Magic = 0x5357504C; // "LPWS"
+    public const int FormatVersion = 4;
+
+    [Flags]
+    private enum ObjectFlags : byte
+    {
+        Living = 1,
+        Commands = 2,
+        Heartbeat = 4,
+        NoCleanUp = 8
+    }
+
+    private readonly ObjectManager _objectManager;
+    private Dictionary<MudObject, (long Version, byte[] Block)> _blocks = new();
+    private int _sinceFullRewrite;
+
+    public WorldSnapshot(string path, ObjectManager objectManager)
+    {
+        Path = System.IO.Path.GetFullPath(path);
+        _objectManager = objectManager;
+    }
+
+    /// <summary>
+    /// Where the snapshot is written.
+    /// </summary>
+    public string Path { get; }
+
+    /// <summary>
+    /// How often the game loop takes a snapshot.
+    /// </summary>
+    public TimeSpan Interval { get; set; } = TimeSpan.FromMinutes(5);
+
+    /// <summary>
+    /// Encode every object afresh on every this many snapshots.
+    /// </summary>
+    public int FullRewriteEvery { get; set; } = 12;
+
+    /// <summary>
+    /// Objects in the last snapshot, and how many of them were reused from
+    /// the one before.
+    /// </summary>
+    public int LastObjectCount { get; private set; }
+    public int LastReusedCount { get; private set; }
+
+    /// <summary>
+    /// Take a snapshot and queue it to be written. Game thread only.
+    /// </summary>
+    public void Write(GameLoop gameLoop)
+    {
+        var data = Capture(gameLoop);
+        AsyncFileWriter.Shared.Write(Path, data, ok =>
+        {
+            if (!ok) Logger.Error($"World snapshot: failed to write {Path}", LogCategory.System);
+        });
+    }
+
+    /// <summary>
+    /// Encode the world as it is now. Game thread only.
+    /// </summary>
+    public byte[] Capture(GameLoop gameLoop)
+    {
+        var players = new HashSet<MudObject>();
+        foreach (var session in gameLoop.GetAllSessions().Concat(gameLoop.GetLinkdeadSessions()))
+        {
+            if (session.PlayerObject != null) players.Add(session.PlayerObject);
+        }
+
+        var objects = new List<MudObject>();
+        var pending = new Stack<MudObject>();
+        var contents = new List<MudObject>();
+        foreach (var root in _objectManager.GetAllObjects())
+        {
+            if (root.Environment != null) continue;
+            pending.Push(root);
+            while (pending.Count > 0)
+            {
+                var obj = pending.Pop();
+                if (obj.IsDestructed || obj.Shadowing != null || players.Contains(obj)) continue;
+                objects.Add(obj);
+
+                // Pushed last to first so they come off in order
+                contents.Clear();
+                foreach (var item in obj.Contents) contents.Add(item);
+                for (int i = contents.Count - 1; i >= 0; i--)
+                {
+                    pending.Push(contents[i]);
+                }
+            }
+        }
+
+        bool full = ++_sinceFullRewrite >= FullRewriteEvery;
+        if (full) _sinceFullRewrite = 0;
+
+        var blocks = new Dictionary<MudObject, (long, byte[])>(objects.Count);
+        int reused = 0;
+
+        using var stream = new MemoryStream();
+        using var writer = new BinaryWriter(stream, Encoding.UTF8);
+        writer.Write(Magic);
+        writer.Write(FormatVersion);
+        writer.Write(objects.Count);
+
+        foreach (var obj in objects)
+        {
+            writer.Write(obj.ObjectName);
+
+            var flags = (obj.IsLiving ? ObjectFlags.Living : 0) |
+                        (obj.CommandsEnabled ? ObjectFlags.Commands : 0) |
+                        (obj.HeartbeatEnabled ? ObjectFlags.Heartbeat : 0) |
+                        (obj.NoCleanUp ? ObjectFlags.NoCleanUp : 0);
+            writer.Write((byte)flags);
+            writer.Write(obj.ResetInterval);
+            writer.Write(obj.LivingName ?? "");
+
+            if (obj.DeclaredIds is var (ids, text))
+            {
+                writer.Write(ids.Length);
+                foreach (var id in ids) writer.Write(id);
+                writer.Write(text ?? "");
+            }
+            else
+            {
+                writer.Write(-1);
+            }
+
+            var exits = obj.Exits?.All ?? Array.Empty<RoomExits.Exit>();
+            writer.Write(exits.Count);
+            foreach (var exit in exits)
+            {
+                writer.Write(exit.Direction);
+                writer.Write(exit.Path);
+                writer.Write(exit.Hidden);
+            }
+
+            byte[] block;
+            if (!full && _blocks.TryGetValue(obj, out var cached) && cached.Version == obj.StateVersion)
+            {
+                block = cached.Block;
+                reused++;
+            }
+            else
+            {
+                block = EncodeBlock(obj);
+            }
+            blocks[obj] = (obj.StateVersion, block);
+            writer.Write(block.Length);
+            writer.Write(block);
+        }
+
+        var kept = blocks;
+        var callouts = gameLoop.PendingCallouts().Where(c => kept.ContainsKey(c.Target)).ToList();
+        writer.Write(callouts.Count);
+        foreach (var (target, function, args, seconds) in callouts)
+        {
+            writer.Write(target.ObjectName);
+            writer.Write(function);
+            writer.Write(seconds);
+            SaveFormat.WriteBinaryValue(writer, args);
+        }
+
+        var effects = gameLoop.PendingEffects().Where(e => kept.ContainsKey(e.Target) && kept.ContainsKey(e.Owner)).ToList();
+        writer.Write(effects.Count);
+        foreach (var effect in effects)
+        {
+            writer.Write(effect.Target.ObjectName);
+            writer.Write(effect.Owner.ObjectName);
+            writer.Write(effect.Id);
+            writer.Write(effect.TickFunction ?? "");
+            writer.Write(effect.ExpireFunction ?? "");
+            writer.Write(effect.IntervalSeconds);
+            writer.Write(effect.Seconds);
+        }
+
+        var subscriptions = _objectManager.Events.All()
+            .Where(s => kept.ContainsKey(s.Subscriber) && (s.Source == null || kept.ContainsKey(s.Source)))
+            .ToList();
+        writer.Write(subscriptions.Count);
+        foreach (var (source, eventName, subscriber, function) in subscriptions)
+        {
+            writer.Write(source?.ObjectName ?? "");
+            writer.Write(eventName);
+            writer.Write(subscriber.ObjectName);
+            writer.Write(function);
+        }
+
+        // Objects gone since the last snapshot drop out of the cache here
+        _blocks = blocks;
+        LastObjectCount = objects.Count;
+        LastReusedCount = reused;
+
+        writer.Flush();
+        return stream.ToArray();
+    }
+
+    private static byte[] EncodeBlock(MudObject obj)
+    {
+        using var stream = new MemoryStream();
+        using var writer = new BinaryWriter(stream, Encoding.UTF8);
+        writer.Write(obj.Environment?.ObjectName ?? "");
+        var entries = obj.SaveEntries().ToList();
+        writer.Write(entries.Count);
+        foreach (var (name, value) in entries)
+        {
+            writer.Write(name);
+            SaveFormat.WriteBinaryValue(writer, value);
+        }
+        writer.Flush();
+        return stream.ToArray();
+    }
+
+    private sealed record Entry(
+        string Name,
+        ObjectFlags Flags,
+        int ResetInterval,
+        string LivingName,
+        string[]? Ids,
+        string? IdText,
+        RoomExits? Exits,
+        long BlockOffset,
+        MudObject? Object);
+
+    /// <summary>
+    /// Rebuild the world from a snapshot file. Objects that fail to compile
+    /// or load are skipped, along with everything inside them. Returns the
+    /// number of objects restored.
+    /// </summary>
+    public static int Restore(string path, ObjectManager objectManager, GameLoop gameLoop)
+    {
+        var length = new FileInfo(path).Length;
+        if (length == 0) throw new InvalidDataException($"Empty world snapshot: {path}");
+
+        using var file = MemoryMappedFile.CreateFromFile(path, FileMode.Open, null, 0, MemoryMappedFileAccess.Read);
+        using var view = file.CreateViewStream(0, length, MemoryMappedFileAccess.Read);
+        using var reader = new BinaryReader(view, Encoding.UTF8);
+
+        if (reader.ReadUInt32() != Magic || reader.ReadInt32() != FormatVersion)
+        {
+            throw new InvalidDataException($"Not a world snapshot, or from another driver version: {path}");
+        }
+
+        // Pass 1: make every object
+        int count = reader.ReadInt32();
+        var entries = new List<Entry>(count);
+        for (int i = 0; i < count; i++)
+        {
+            var name = reader.ReadString();
+            var flags = (ObjectFlags)reader.ReadByte();
+            int resetInterval = reader.ReadInt32();
+            var livingName = reader.ReadString();
+
+            string[]? ids = null;
+            string? idText = null;
+            int idCount = reader.ReadInt32();
+            if (idCount >= 0)
+            {
+                ids = new string[idCount];
+                for (int j = 0; j < idCount; j++) ids[j] = reader.ReadString();
+                idText = reader.ReadString();
+            }
+
+            RoomExits? exits = null;
+            int exitCount = reader.ReadInt32();
+            for (int j = 0; j < exitCount; j++)
+            {
+                exits ??= new RoomExits();
+                exits.Set(reader.ReadString(), reader.ReadString(), reader.ReadBoolean());
+            }
+
+            int blockLength = reader.ReadInt32();
+            long blockOffset = view.Position;
+            view.Seek(blockLength, SeekOrigin.Current);
+
+            entries.Add(new Entry(name, flags, resetInterval, livingName, ids, idText, exits, blockOffset,
+                CreateObject(name, objectManager)));
+        }
+        long calloutsOffset = view.Position;
+
+        // Pass 2: variables, environments and the rest
+        object Resolve(string name) => (object?)objectManager.FindObject(name) ?? 0L;
+
+        int restored = 0;
+        foreach (var entry in entries)
+        {
+            var obj = entry.Object;
+            if (obj == null) continue;
+
+            view.Position = entry.BlockOffset;
+            var environmentName = reader.ReadString();
+            if (environmentName.Length > 0)
+            {
+                var environment = objectManager.FindObject(environmentName);
+                if (environment == null || environment.IsDestructed)
+                {
+                    // Its environment didn't come back, so neither does it
+                    objectManager.DestructObject(obj);
+                    continue;
+                }
+                obj.IsLiving = entry.Flags.HasFlag(ObjectFlags.Living);
+                obj.MoveTo(environment);
+            }
+            else
+            {
+                obj.IsLiving = entry.Flags.HasFlag(ObjectFlags.Living);
+            }
+
+            int variableCount = reader.ReadInt32();
+            for (int i = 0; i < variableCount; i++)
+            {
+                var name = reader.ReadString();
+                obj.RestoreEntry(name, SaveFormat.ReadBinaryValue(reader, Resolve));
+            }
+
+            obj.Exits = entry.Exits;
+            if (entry.Exits != null) objectManager.WorldGraph.Update(obj);
+            obj.CommandsEnabled = entry.Flags.HasFlag(ObjectFlags.Commands);
+            obj.NoCleanUp = entry.Flags.HasFlag(ObjectFlags.NoCleanUp);
+            if (entry.LivingName.Length > 0)
+            {
+                objectManager.SetLivingName(obj, entry.LivingName);
+            }
+            if (entry.Ids != null)
+            {
+                obj.DeclareIds(entry.Ids, entry.IdText, obj.Program.FindFunctionWithProgram("id").OwningProgram!);
+            }
+            if (entry.Flags.HasFlag(ObjectFlags.Heartbeat))
+            {
+                obj.HeartbeatEnabled = true;
+                gameLoop.RegisterHeartbeat(obj);
+            }
+            if (entry.ResetInterval > 0)
+            {
+                gameLoop.RegisterReset(obj, entry.ResetInterval);
+            }
+            restored++;
+        }
+
+        view.Position = calloutsOffset;
+        int calloutCount = reader.ReadInt32();
+        for (int i = 0; i < calloutCount; i++)
+        {
+            var target = objectManager.FindObject(reader.ReadString());
+            var function = reader.ReadString();
+            int seconds = reader.ReadInt32();
+            var args = (List<object>)SaveFormat.ReadBinaryValue(reader, Resolve);
+            if (target != null && !target.IsDestructed)
+            {
+                gameLoop.ScheduleCallout(target, function, args, seconds);
+            }
+        }
+
+        int effectCount = reader.ReadInt32();
+        for (int i = 0; i < effectCount; i++)
+        {
+            var target = objectManager.FindObject(reader.ReadString());
+            var owner = objectManager.FindObject(reader.ReadString());
+            var id = reader.ReadString();
+            var tickFunction = reader.ReadString();
+            var expireFunction = reader.ReadString();
+            int interval = reader.ReadInt32();
+            int seconds = reader.ReadInt32();
+            if (target is { IsDestructed: false } && owner is { IsDestructed: false })
+            {
+                gameLoop.AddEffect(target, owner, id, seconds, tickFunction.Length > 0 ? tickFunction : null,
+                    expireFunction.Length > 0 ? expireFunction : null, interval);
+            }
+        }
+
+        int subscriptionCount = reader.ReadInt32();
+        for (int i = 0; i < subscriptionCount; i++)
+        {
+            var sourceName = reader.ReadString();
+            var source = sourceName.Length > 0 ? objectManager.FindObject(sourceName) : null;
+            var eventName = reader.ReadString();
+            var subscriber = objectManager.FindObject(reader.ReadString());
+            var function = reader.ReadString();
+            if (subscriber is { IsDestructed: false } && (sourceName.Length == 0 || source is { IsDestructed: false }))
+            {
+                objectManager.Events.Subscribe(source, eventName, subscriber, function);
+            }
+        }
+
+        Logger.Info($"World snapshot: restored {restored} of {count} objects, {calloutCount} callouts, {effectCount} effects " +
+                    $"and {subscriptionCount} subscriptions from {path}", LogCategory.System);
+        return restored;
+    }
+
+    /// <summary>
+    /// Load a blueprint, or remake a clone under its old number, without
+    /// create(). Null if it can't be loaded.
+    /// </summary>
+    private static MudObject? CreateObject(string name, ObjectManager objectManager)
+    {
+        try
+        {
+            int hash = name.LastIndexOf('#');
+            if (hash < 0)
+            {
+                return objectManager.LoadForRestore(name);
+            }
+
+            var blueprint = objectManager.LoadForRestore(name[..hash]);
+            return objectManager.FindObject(name) ?? objectManager.RestoreClone(blueprint, int.Parse(name[(hash + 1)..]));
+        }
+        catch (Exception ex)
+        {
+            Logger.Warning($"World snapshot: can't restore {name}: {ex.Message}", LogCategory.System);
+            return null;
+        }
+    }
+}